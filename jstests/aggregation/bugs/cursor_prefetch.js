@@ -0,0 +1,53 @@
+/**
+ * With internalDocumentSourceCursorPrefetch set, a $cursor stage loads each next batch on a
+ * helper thread. This test asserts that pipelines reading many batches return the same results
+ * either way.
+ */
+
+load("jstests/aggregation/extras/utils.js");  // For resultsEq.
+
+(function() {
+    "use strict";
+    var coll = db.cursor_prefetch;
+    coll.drop();
+
+    // Large enough documents that the $cursor stage loads its input in several batches.
+    var bigString = new Array(64 * 1024).toString();
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, a: i % 7, big: bigString});
+    }
+    assert.writeOK(bulk.execute());
+
+    var pipelines = [
+        [{$group: {_id: "$a", n: {$sum: 1}, ids: {$push: "$_id"}}}],
+        [{$match: {a: {$gt: 2}}}, {$project: {a: 1}}],
+        [{$sort: {_id: -1}}, {$limit: 500}, {$project: {_id: 1}}],
+    ];
+
+    function runAll() {
+        return pipelines.map(function(pipeline) {
+            return coll.aggregate(pipeline, {cursor: {batchSize: 10}}).toArray();
+        });
+    }
+
+    var getParameterResult = assert.commandWorked(
+        db.adminCommand({getParameter: 1, internalDocumentSourceCursorPrefetch: 1}));
+    var original = getParameterResult.internalDocumentSourceCursorPrefetch;
+    try {
+        assert.commandWorked(
+            db.adminCommand({setParameter: 1, internalDocumentSourceCursorPrefetch: false}));
+        var expected = runAll();
+
+        assert.commandWorked(
+            db.adminCommand({setParameter: 1, internalDocumentSourceCursorPrefetch: true}));
+        var actual = runAll();
+    } finally {
+        assert.commandWorked(
+            db.adminCommand({setParameter: 1, internalDocumentSourceCursorPrefetch: original}));
+    }
+
+    for (var j = 0; j < pipelines.length; j++) {
+        assert(resultsEq(expected[j], actual[j]), tojson(pipelines[j]));
+    }
+}());
@@ -0,0 +1,53 @@
+/**
+ * A $group directly after a $sort on its _id fields streams its groups in sort order. This test
+ * asserts that it returns the same groups as a blocking $group, whether the order comes from an
+ * in-memory sort or from an index, including a multikey one that returns array keys out of order.
+ */
+
+load("jstests/aggregation/extras/utils.js");  // For resultsEq.
+
+(function() {
+    "use strict";
+    var coll = db.group_streaming;
+    coll.drop();
+
+    var docs = [
+        {_id: 0, a: 1, b: 1},
+        {_id: 1, a: [1, 3], b: 2},
+        {_id: 2, a: 1, b: 3},
+        {_id: 3, a: [1, 3], b: 4},
+        {_id: 4, a: 2, b: 5},
+        {_id: 5, b: 6},
+        {_id: 6, a: null, b: 7},
+        {_id: 7, a: 3, b: 8},
+        {_id: 8, a: {x: 1}, b: 9},
+    ];
+    docs.forEach(function(doc) {
+        assert.writeOK(coll.insert(doc));
+    });
+
+    var pipelines = [
+        [{$sort: {a: 1}}, {$group: {_id: "$a", total: {$sum: "$b"}, ids: {$push: "$_id"}}}],
+        [{$sort: {a: -1, b: 1}}, {$group: {_id: "$a", first: {$first: "$b"}}}],
+        [{$sort: {b: 1, a: 1}}, {$group: {_id: {a: "$a", b: "$b"}, n: {$sum: 1}}}],
+    ];
+
+    function assertSameAsBlockingGroup(pipeline) {
+        // A $project between the $sort and the $group keeps the $group from streaming.
+        var blocking = [pipeline[0], {$project: {a: 1, b: 1}}, pipeline[1]];
+        var expected = coll.aggregate(blocking).toArray();
+        var actual = coll.aggregate(pipeline).toArray();
+        assert(resultsEq(expected, actual),
+               tojson(pipeline) + " returned " + tojson(actual) + ", expected " + tojson(expected));
+    }
+
+    pipelines.forEach(assertSameAsBlockingGroup);
+
+    assert.commandWorked(coll.ensureIndex({a: 1, b: 1}));
+    assert.commandWorked(coll.ensureIndex({b: 1, a: 1}));
+    pipelines.forEach(assertSameAsBlockingGroup);
+
+    // A $limit after a streaming $group returns the first groups in sort order.
+    var limited = coll.aggregate([{$sort: {a: 1}}, {$group: {_id: "$a"}}, {$limit: 2}]).toArray();
+    assert.eq([{_id: null}, {_id: 1}], limited, tojson(limited));
+}());
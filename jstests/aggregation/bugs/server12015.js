@@ -7,6 +7,7 @@
  */
 
 load("jstests/aggregation/extras/utils.js");  // For orderedArrayEq.
+load("jstests/libs/analyze_plan.js");         // For isIndexOnly.
 
 (function (){
     "use strict";
@@ -68,4 +69,29 @@ load("jstests/aggregation/extras/utils.js");  // For orderedArrayEq.
     // Blocking $sort, covered $project.
     assertResultsMatch([{$sort: {b: 1, a: -1}}, {$project: {_id: 0, a: 1, b: 1}}]);
     assertResultsMatch([{$sort: {b: 1, a: -1}}, {$group: {_id: "$b", arr: {$push: "$a"}}}]);
+
+    // Pipelines which need only fields of the documents that an index has, even dotted ones, or no
+    // fields at all, run on index-only plans.
+    coll.drop();
+    indexSpec = {a: 1, "b.c": 1, "b.d": 1};
+    assert.writeOK(coll.insert({_id: 0, a: 0, b: {c: 0, d: 1}}));
+    assert.writeOK(coll.insert({_id: 1, a: 0, b: {c: 1, d: 1}}));
+    assert.writeOK(coll.insert({_id: 2, a: 1, b: {c: 0, d: 0}}));
+    assert.writeOK(coll.insert({_id: 3, a: 1, b: {c: 1, d: 0}}));
+
+    var coveredPipelines = [
+        [{$group: {_id: "$b.c", n: {$sum: 1}}}, {$sort: {_id: 1}}],
+        [{$group: {_id: "$a", c: {$sum: "$b.c"}, d: {$sum: "$b.d"}}}, {$sort: {_id: 1}}],
+        [{$project: {_id: 0, a: 1, "b.c": 1}}, {$sort: {a: 1, "b.c": 1}}],
+        [{$group: {_id: null, n: {$sum: 1}}}],
+    ];
+    coveredPipelines.forEach(function(pipeline) {
+        assertResultsMatch(pipeline);
+
+        assert.commandWorked(coll.ensureIndex(indexSpec));
+        var explain = coll.aggregate([{$match: {a: {$gte: 0}}}].concat(pipeline),
+                                     {explain: true});
+        assert(isIndexOnly(explain.stages[0].$cursor.queryPlanner.winningPlan), tojson(explain));
+        assert.commandWorked(coll.dropIndex(indexSpec));
+    });
 }());
@@ -86,6 +86,16 @@ test(input,
      [{$project: {c: {$concat: ["hello there ", "_id"]}}}],
      [{_id:1, c:"hello there _id"}, {_id:2, c:"hello there _id"}, {_id:3, c:"hello there _id"}]);
 
+// test with a unique index, which $out builds after inserting all of its output
+output.ensureIndex({d: 1}, {unique: true});
+assert.eq(output.getIndexes().length, 5);
+test(input,
+     [{$project: {d: "$_id"}}],
+     [{_id:1, d:1}, {_id:2, d:2}, {_id:3, d:3}]);
+assertErrorCode(input, [{$project: {d: {$literal: 1}}}, {$out: output.getName()}], 16995);
+assert.eq(output.find().sort({_id: 1}).toArray(), [{_id:1, d:1}, {_id:2, d:2}, {_id:3, d:3}]);
+assert.eq(output.getIndexes().length, 5);
+
 // test with capped collection
 cappedOutput.drop();
 db.createCollection(cappedOutput.getName(), {capped: true, size: 2});
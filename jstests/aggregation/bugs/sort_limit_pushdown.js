@@ -0,0 +1,36 @@
+/**
+ * When an index provides a $sort, the $limit coalesced into it (including the documents of any
+ * $skip that follows) is pushed into the query plan as well, so the plan stops early.
+ */
+
+load("jstests/libs/analyze_plan.js");  // For getPlanStage.
+
+(function() {
+    "use strict";
+    var coll = db.sort_limit_pushdown;
+    coll.drop();
+
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(coll.insert({_id: i, a: i % 50, b: i}));
+    }
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+
+    var pipeline = [{$sort: {a: 1}}, {$skip: 10}, {$limit: 5}, {$project: {_id: 0, a: 1}}];
+    var results = coll.aggregate(pipeline).toArray();
+    assert.eq([{a: 5}, {a: 5}, {a: 6}, {a: 6}, {a: 7}], results, tojson(results));
+
+    var explain = db.runCommand({aggregate: coll.getName(), pipeline: pipeline, explain: true});
+    assert.commandWorked(explain);
+    var limitStage = getPlanStage(explain.stages[0].$cursor.queryPlanner.winningPlan, "LIMIT");
+    assert.neq(null, limitStage, tojson(explain));
+    assert.eq(15, limitStage.limitAmount, tojson(explain));
+
+    // Without an index for the sort, the $sort keeps the top 15 itself.
+    assert.commandWorked(coll.dropIndex({a: 1}));
+    results = coll.aggregate(pipeline).toArray();
+    assert.eq([{a: 5}, {a: 5}, {a: 6}, {a: 6}, {a: 7}], results, tojson(results));
+
+    explain = db.runCommand({aggregate: coll.getName(), pipeline: pipeline, explain: true});
+    assert.commandWorked(explain);
+    assert.eq(15, explain.stages[1].$sort.limit, tojson(explain));
+}());
@@ -0,0 +1,48 @@
+/**
+ * A $unwind directly before a $group is absorbed into the $group, which unwinds each document
+ * itself. This test asserts that it returns the same groups as a separate $unwind stage.
+ */
+
+load("jstests/aggregation/extras/utils.js");  // For resultsEq.
+
+(function() {
+    "use strict";
+    var coll = db.unwind_group_fusion;
+    coll.drop();
+
+    var docs = [
+        {_id: 0, tags: ["a", "b", "a"], n: 1},
+        {_id: 1, tags: [], n: 2},
+        {_id: 2, tags: null, n: 3},
+        {_id: 3, n: 4},
+        {_id: 4, tags: "b", n: 5},
+        {_id: 5, tags: [["a"], {x: 1}], n: 6},
+        {_id: 6, sub: {tags: [1, 2]}, n: 7},
+    ];
+    docs.forEach(function(doc) {
+        assert.writeOK(coll.insert(doc));
+    });
+
+    var pipelines = [
+        [{$unwind: "$tags"}, {$group: {_id: "$tags", count: {$sum: 1}}}],
+        [{$unwind: "$tags"}, {$group: {_id: null, total: {$sum: "$n"}, ids: {$push: "$_id"}}}],
+        [{$unwind: "$tags"}, {$group: {_id: "$_id", docs: {$push: "$$ROOT"}}}],
+        [{$unwind: "$sub.tags"}, {$group: {_id: "$sub.tags", first: {$first: "$sub"}}}],
+        [{$match: {n: {$gt: 0}}}, {$unwind: "$tags"}, {$group: {_id: "$tags"}}],
+    ];
+
+    pipelines.forEach(function(pipeline) {
+        // A $project between the $unwind and the $group keeps the $unwind as its own stage.
+        var groupIndex = pipeline.length - 1;
+        var separate = pipeline.slice(0, groupIndex)
+                           .concat([{$project: {tags: 1, n: 1, sub: 1}}, pipeline[groupIndex]]);
+        var expected = coll.aggregate(separate).toArray();
+        var actual = coll.aggregate(pipeline).toArray();
+        assert(resultsEq(expected, actual),
+               tojson(pipeline) + " returned " + tojson(actual) + ", expected " + tojson(expected));
+    });
+
+    var explain = coll.explain().aggregate(pipelines[0]);
+    var stages = explain.stages || explain.shards[Object.keys(explain.shards)[0]].stages;
+    assert.eq("$tags", stages[stages.length - 1].$group.$unwind, tojson(explain));
+}());
@@ -0,0 +1,68 @@
+// Test benchRun's open loop at a target rate, with a warmup, weighted ops on several namespaces
+// and the latency percentiles of each op type and named op.
+(function() {
+    "use strict";
+
+    var a = db.bench_test_open_loop_a;
+    var b = db.bench_test_open_loop_b;
+    a.drop();
+    b.drop();
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(a.insert({_id: i}));
+        assert.writeOK(b.insert({_id: i}));
+    }
+
+    var benchArgs = {
+        ops: [
+            {
+              name: "findById",
+              ns: [a.getFullName(), b.getFullName()],
+              op: "findOne",
+              query: {_id: {"#RAND_INT": [0, 100]}},
+              weight: 3
+            },
+            {
+              name: "write",
+              ns: a.getFullName(),
+              op: "update",
+              query: {_id: {"#RAND_INT": [0, 100]}},
+              update: {$inc: {x: 1}},
+              writeCmd: true,
+              weight: 1
+            }
+        ],
+        parallel: 2,
+        seconds: 2,
+        warmupSeconds: 0.5,
+        targetOpsPerSec: 200,
+        host: db.getMongo().host
+    };
+
+    if (jsTest.options().auth) {
+        benchArgs['db'] = 'admin';
+        benchArgs['username'] = jsTest.options().adminUser;
+        benchArgs['password'] = jsTest.options().adminPassword;
+    }
+
+    var res = benchRun(benchArgs);
+    printjson(res);
+
+    assert.eq(0, res.errCount, tojson(res));
+    assert.eq(200, res.targetOpsPerSec, tojson(res));
+    // The open loop holds the throughput at the target rather than running as fast as it can.
+    assert.lt(res["totalOps/s"], 400, tojson(res));
+    assert.gt(res["totalOps/s"], 50, tojson(res));
+
+    var percentiles = res.latencyPercentilesMicros;
+    assert.gt(percentiles.findOne.ops, percentiles.update.ops, tojson(res));
+    assert.lte(percentiles.findOne.p50, percentiles.findOne.p99, tojson(res));
+    assert.lte(percentiles.findOne.p99, percentiles.findOne.max, tojson(res));
+
+    var named = res.namedOpLatencyPercentilesMicros;
+    assert.eq(percentiles.findOne.ops, named.findById.ops, tojson(res));
+    assert.eq(percentiles.update.ops, named.write.ops, tojson(res));
+
+    assert.throws(function() {
+        benchRun({ops: [{ns: a.getFullName(), op: "nop", weight: -1}], seconds: 0.1});
+    });
+}());
@@ -0,0 +1,47 @@
+// A queue-style findAndModify, which takes the highest priority pending document, is answered by a
+// single update or delete plan. Its plan is cached, so later calls do not have to plan again.
+(function() {
+    "use strict";
+    var coll = db.find_and_modify_queue;
+    coll.drop();
+
+    for (var i = 0; i < 20; i++) {
+        assert.writeOK(coll.insert({_id: i, state: "pending", priority: i % 5, n: i}));
+    }
+    assert.commandWorked(coll.ensureIndex({state: 1, priority: -1}));
+    assert.commandWorked(coll.ensureIndex({priority: 1}));
+
+    var query = {state: "pending", priority: {$gte: 0}};
+    var sort = {priority: -1, n: 1};
+
+    var res = coll.runCommand("findAndModify",
+                              {query: query, sort: sort, update: {$set: {state: "running"}}});
+    assert.commandWorked(res);
+    assert.eq({_id: 4, state: "pending", priority: 4, n: 4}, res.value);
+    assert.eq({updatedExisting: true, n: 1}, res.lastErrorObject);
+
+    res = coll.runCommand(
+        "findAndModify",
+        {query: query, sort: sort, update: {$set: {state: "running"}}, new: true, fields: {n: 1}});
+    assert.commandWorked(res);
+    assert.eq({_id: 9, n: 9}, res.value);
+    assert.eq({updatedExisting: true, n: 1}, res.lastErrorObject);
+
+    assert.neq(0, coll.getPlanCache().getPlansByQuery(query, {}, sort).length);
+
+    res = coll.runCommand("findAndModify", {query: query, sort: sort, remove: true});
+    assert.commandWorked(res);
+    assert.eq({_id: 14, state: "pending", priority: 4, n: 14}, res.value);
+    assert.eq({n: 1}, res.lastErrorObject);
+
+    res = coll.runCommand("findAndModify", {query: {state: "done"}, sort: sort, remove: true});
+    assert.commandWorked(res);
+    assert.eq(null, res.value);
+    assert.eq({n: 0}, res.lastErrorObject);
+
+    res = coll.runCommand(
+        "findAndModify",
+        {query: {_id: 100}, update: {$set: {state: "pending"}}, upsert: true, new: true});
+    assert.commandWorked(res);
+    assert.eq({updatedExisting: false, n: 1, upserted: 100}, res.lastErrorObject);
+}());
@@ -0,0 +1,57 @@
+// Integration tests for version 4 text index, ensuring that it matches the documents a version 3
+// text index matches, with their scores rounded to 1/10000ths.
+
+(function() {
+    "use strict";
+    var coll3 = db.fts_index_version4_v3;
+    var coll4 = db.fts_index_version4_v4;
+
+    coll3.drop();
+    coll4.drop();
+
+    var docs = [
+        {_id: 0, a: "O próximo Vôo à Noite sobre o Atlântico, Põe Freqüentemente o único Médico."},
+        {_id: 1, a: "the quick brown fox jumps over the lazy dog", b: "fox"},
+        {_id: 2, a: "a fox, a dog and a brown cat", b: "cat cat"},
+        {_id: 3, a: "dogs and cats and foxes", b: "dog"}
+    ];
+    docs.forEach(function(doc) {
+        assert.writeOK(coll3.insert(doc));
+        assert.writeOK(coll4.insert(doc));
+    });
+
+    var keys = {a: "text", b: "text"};
+    var options = {weights: {a: 3, b: 7}};
+    assert.commandWorked(coll3.ensureIndex(keys, Object.extend({textIndexVersion: 3}, options)));
+    assert.commandWorked(coll4.ensureIndex(keys, Object.extend({textIndexVersion: 4}, options)));
+
+    var indexes = coll4.getIndexes().filter(function(index) {
+        return index.textIndexVersion !== undefined;
+    });
+    assert.eq(1, indexes.length, tojson(indexes));
+    assert.eq(4, indexes[0].textIndexVersion, tojson(indexes));
+
+    function scores(coll, search) {
+        var result = {};
+        coll.find({$text: {$search: search}}, {score: {$meta: "textScore"}}).forEach(function(doc) {
+            result[doc._id] = doc.score;
+        });
+        return result;
+    }
+
+    ["fox", "dog cat", "brown -cat", "\"lazy dog\"", "atlântico médico", "missing"].forEach(
+        function(search) {
+            var expected = scores(coll3, search);
+            var actual = scores(coll4, search);
+            assert.eq(Object.keys(expected).sort(), Object.keys(actual).sort(), search);
+            Object.keys(expected).forEach(function(id) {
+                assert.close(expected[id], actual[id], search, 3);
+                var units = actual[id] * 10000;
+                assert.close(Math.round(units), units, search, 6);
+            });
+        });
+
+    var collBad = db.fts_index_version4_bad;
+    collBad.drop();
+    assert.commandFailed(collBad.ensureIndex({a: "text"}, {textIndexVersion: 5}));
+})();
@@ -17,7 +17,7 @@ res = coll.ensureIndex({geo: "2dsphere"}, {"2dsphereIndexVersion": 0});
 assert.commandFailed(res);
 coll.drop();
 
-res = coll.ensureIndex({geo: "2dsphere"}, {"2dsphereIndexVersion": 4});
+res = coll.ensureIndex({geo: "2dsphere"}, {"2dsphereIndexVersion": 5});
 assert.commandFailed(res);
 coll.drop();
 
@@ -65,6 +65,10 @@ res = coll.ensureIndex({geo: "2dsphere"}, {"2dsphereIndexVersion": NumberLong(2)
 assert.commandWorked(res);
 coll.drop();
 
+res = coll.ensureIndex({geo: "2dsphere"}, {"2dsphereIndexVersion": 4});
+assert.commandWorked(res);
+coll.drop();
+
 //
 // {2dsphereIndexVersion: 3} should be the default for new indexes.
 //
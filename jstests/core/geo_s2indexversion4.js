@@ -0,0 +1,92 @@
+// Test that a version 4 2dsphere index, which covers geometries with many vertices through their
+// bounding rectangle, finds the same documents as a version 3 index, and that documents indexed
+// that way can be updated and removed.
+(function() {
+    "use strict";
+    var coll3 = db.geo_s2indexversion4_v3;
+    var coll4 = db.geo_s2indexversion4_v4;
+    coll3.drop();
+    coll4.drop();
+
+    // A closed ring of 'numVertices' vertices around [lng, lat].
+    function ring(lng, lat, radius, numVertices) {
+        var coords = [];
+        for (var i = 0; i < numVertices; i++) {
+            var angle = 2 * Math.PI * i / numVertices;
+            coords.push([lng + radius * Math.cos(angle), lat + radius * Math.sin(angle)]);
+        }
+        coords.push(coords[0]);
+        return coords;
+    }
+
+    var docs = [
+        {_id: 0, geo: {type: "Polygon", coordinates: [ring(0, 0, 1, 1000)]}},
+        {_id: 1, geo: {type: "Polygon", coordinates: [ring(10, 10, 1, 10)]}},
+        {_id: 2, geo: {type: "Polygon", coordinates: [ring(20, 0, 2, 500), ring(20, 0, 1, 500)]}},
+        {_id: 3, geo: {type: "LineString", coordinates: ring(-20, 0, 1, 400).slice(0, 300)}},
+        {_id: 4, geo: {type: "Point", coordinates: [0.5, 0.5]}},
+        {
+          _id: 5,
+          geo: {
+              type: "MultiPolygon",
+              coordinates: [[ring(-10, -10, 0.5, 200)], [ring(-12, -10, 0.5, 200)]]
+          }
+        }
+    ];
+    docs.forEach(function(doc) {
+        assert.writeOK(coll3.insert(doc));
+        assert.writeOK(coll4.insert(doc));
+    });
+
+    assert.commandWorked(coll3.ensureIndex({geo: "2dsphere"}, {"2dsphereIndexVersion": 3}));
+    assert.commandWorked(coll4.ensureIndex({geo: "2dsphere"}, {"2dsphereIndexVersion": 4}));
+
+    function ids(coll, query) {
+        return coll.find(query, {_id: 1}).sort({_id: 1}).toArray().map(function(doc) {
+            return doc._id;
+        });
+    }
+
+    function box(minLng, minLat, maxLng, maxLat) {
+        return {
+            type: "Polygon",
+            coordinates: [[
+                [minLng, minLat],
+                [maxLng, minLat],
+                [maxLng, maxLat],
+                [minLng, maxLat],
+                [minLng, minLat]
+            ]]
+        };
+    }
+
+    var queries = [
+        {geo: {$geoIntersects: {$geometry: {type: "Point", coordinates: [0.2, 0.2]}}}},
+        {geo: {$geoIntersects: {$geometry: {type: "Point", coordinates: [20, 0]}}}},
+        {geo: {$geoIntersects: {$geometry: {type: "Point", coordinates: [20, 1.5]}}}},
+        {geo: {$geoIntersects: {$geometry: box(0.9, 0.9, 1.1, 1.1)}}},
+        {geo: {$geoIntersects: {$geometry: box(-30, -30, 30, 30)}}},
+        {geo: {$geoWithin: {$geometry: box(-2, -2, 2, 2)}}},
+        {geo: {$geoWithin: {$geometry: box(-13, -11, -9, -9)}}},
+        {geo: {$near: {$geometry: {type: "Point", coordinates: [5, 5]}, $maxDistance: 2000000}}}
+    ];
+
+    function checkQueries() {
+        queries.forEach(function(query) {
+            assert.eq(ids(coll3, query), ids(coll4, query), tojson(query));
+        });
+    }
+
+    checkQueries();
+
+    // Changing and removing the geometries must remove their old keys.
+    assert.writeOK(coll3.update({_id: 0}, {$set: {geo: docs[1].geo}}));
+    assert.writeOK(coll4.update({_id: 0}, {$set: {geo: docs[1].geo}}));
+    assert.writeOK(coll3.remove({_id: 2}));
+    assert.writeOK(coll4.remove({_id: 2}));
+    checkQueries();
+
+    var validate = coll4.validate(true);
+    assert(validate.valid, tojson(validate));
+    assert.eq(0, coll4.find({geo: {$geoIntersects: {$geometry: box(19, -1, 21, 1)}}}).itcount());
+})();
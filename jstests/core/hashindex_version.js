@@ -0,0 +1,36 @@
+// A hashed index with hashVersion 1 hashes its keys with MurmurHash3 instead of MD5. Queries use
+// the hash function of the index they scan.
+(function() {
+    "use strict";
+    var coll = db.hashindex_version;
+    coll.drop();
+
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(coll.insert({_id: i, a: (i % 10 == 0) ? "s" + i : i}));
+    }
+    assert.writeOK(coll.insert({_id: "noA"}));
+
+    assert.commandWorked(coll.ensureIndex({a: "hashed"}, {hashVersion: 1}));
+    assert.commandFailed(coll.ensureIndex({b: "hashed"}, {hashVersion: 2}));
+
+    function hash(value, hashVersion) {
+        var res = db.runCommand({_hashBSONElement: value, hashVersion: hashVersion});
+        assert.commandWorked(res);
+        return res.out;
+    }
+    assert.neq(hash(42, 0), hash(42, 1));
+    assert.eq(hash(42, 1), hash(NumberLong(42), 1));
+    assert.eq(hash(42, 0), hash(42));
+
+    [5, "s10", 10, null].forEach(function(value) {
+        var query = {a: value};
+        var expected = coll.find(query).hint({$natural: 1}).sort({_id: 1}).toArray();
+        assert.eq(expected, coll.find(query).hint({a: "hashed"}).sort({_id: 1}).toArray());
+    });
+    var inQuery = {a: {$in: [1, 2, "s20"]}};
+    assert.eq(3, coll.find(inQuery).hint({a: "hashed"}).itcount());
+
+    // Keys are the MurmurHash3 hashes of the values.
+    var keys = coll.find({a: 5}, {_id: 0, a: 1}).hint({a: "hashed"}).returnKey().toArray();
+    assert.eq([{a: hash(5, 1)}], keys);
+}());
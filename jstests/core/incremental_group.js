@@ -0,0 +1,78 @@
+// Tests the createIncrementalGroup, readIncrementalGroup and dropIncrementalGroup commands.
+
+load("jstests/aggregation/extras/utils.js");  // For resultsEq.
+
+(function() {
+    "use strict";
+    var source = db.incremental_group_source;
+    var target = db.incremental_group_target;
+    source.drop();
+    target.drop();
+
+    var pipeline = [
+        {$match: {b: {$gte: 0}}},
+        {$group: {_id: "$a", total: {$sum: "$b"}, mean: {$avg: "$b"}, top: {$max: "$b"}}}
+    ];
+
+    function assertMatchesAggregate() {
+        var res = assert.commandWorked(db.runCommand({readIncrementalGroup: target.getName()}));
+        var expected = source.aggregate(pipeline).toArray();
+        assert(resultsEq(expected, res.result),
+               tojson(res.result) + " should be " + tojson(expected));
+    }
+
+    for (var i = 0; i < 10; i++) {
+        assert.writeOK(source.insert({_id: i, a: i % 3, b: i % 4 ? i : -i}));
+    }
+
+    assert.commandWorked(db.runCommand(
+        {createIncrementalGroup: source.getName(), pipeline: pipeline, out: target.getName()}));
+    assertMatchesAggregate();
+
+    // Inserts are merged into the stored partial results.
+    for (i = 10; i < 30; i++) {
+        assert.writeOK(source.insert({_id: i, a: i % 5, b: i}));
+    }
+    assert.eq(5, target.count());
+    assertMatchesAggregate();
+
+    // Updates and deletes make the next read rebuild the results.
+    assert.writeOK(source.update({a: 1}, {$inc: {b: 100}}, {multi: true}));
+    assertMatchesAggregate();
+    assert.writeOK(source.remove({a: 2}));
+    assertMatchesAggregate();
+
+    // A group whose results cannot be stored, because its _id is an array, is left stale, and
+    // the read that tries to rebuild it reports why.
+    assert.writeOK(source.insert({_id: 100, a: [1, 2], b: 1}));
+    assert.commandFailed(db.runCommand({readIncrementalGroup: target.getName()}));
+    assert.writeOK(source.remove({_id: 100}));
+    assertMatchesAggregate();
+
+    // Invalid definitions.
+    assert.commandFailed(db.runCommand({
+        createIncrementalGroup: source.getName(),
+        pipeline: [{$project: {a: 1}}, {$group: {_id: "$a"}}],
+        out: "incremental_group_other"
+    }));
+    assert.commandFailed(db.runCommand({
+        createIncrementalGroup: source.getName(),
+        pipeline: [{$match: {a: 1}}],
+        out: "incremental_group_other"
+    }));
+    assert.commandFailed(db.runCommand(
+        {createIncrementalGroup: source.getName(), pipeline: pipeline, out: source.getName()}));
+
+    // Dropping the view stops maintaining the target, but leaves it in place.
+    assert.commandWorked(db.runCommand({dropIncrementalGroup: target.getName()}));
+    assert.commandFailed(db.runCommand({readIncrementalGroup: target.getName()}));
+    assert.writeOK(source.insert({_id: 200, a: 7, b: 1}));
+    assert.eq(0, target.count({_id: 7}));
+    assert.eq(4, target.count());
+
+    // Dropping the source drops the view too.
+    assert.commandWorked(db.runCommand(
+        {createIncrementalGroup: source.getName(), pipeline: pipeline, out: target.getName()}));
+    source.drop();
+    assert.commandFailed(db.runCommand({readIncrementalGroup: target.getName()}));
+}());
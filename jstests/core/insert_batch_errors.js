@@ -0,0 +1,38 @@
+/**
+ * Inserts of a batch are written in groups, and a group that fails is retried one document at a
+ * time. This test asserts that each document still gets its own error, and that the documents
+ * around a failed one are inserted.
+ */
+(function() {
+    "use strict";
+    var coll = db.insert_batch_errors;
+
+    function makeDocs(dupIndexes) {
+        var docs = [];
+        for (var i = 0; i < 300; i++) {
+            docs.push({_id: dupIndexes.indexOf(i) >= 0 ? 0 : i, x: i});
+        }
+        return docs;
+    }
+
+    // Unordered inserts report every duplicate and insert everything else.
+    coll.drop();
+    var res = coll.insert(makeDocs([70, 71, 250]), {ordered: false});
+    assert.eq(297, res.nInserted, tojson(res));
+    var errors = res.getWriteErrors();
+    assert.eq([70, 71, 250],
+              errors.map(function(e) {
+                  return e.index;
+              }),
+              tojson(res));
+    assert.eq(297, coll.count());
+
+    // Ordered inserts stop at the first duplicate.
+    coll.drop();
+    res = coll.insert(makeDocs([130]), {ordered: true});
+    assert.eq(130, res.nInserted, tojson(res));
+    assert.eq(1, res.getWriteErrors().length, tojson(res));
+    assert.eq(130, res.getWriteErrors()[0].index, tojson(res));
+    assert.eq(130, coll.count());
+    assert.eq(129, coll.find().sort({_id: -1}).limit(1).next()._id);
+}());
@@ -78,5 +78,21 @@ assert.eq(1, getShapes().length, 'plan cache should not be empty after query');
 t.ensureIndex({b: 1});
 assert.eq(0, getShapes().length, 'plan cache should be empty after adding index');
 
+// Case 2b: You add or drop an index the cached shape has no use for.
+// Steps:
+//     Populate the cache with 1 entry.
+//     Add and drop an index on a field the query does not mention.
+//     Confirm that the entry is still cached.
+//     Drop an index used by one of the entry's candidate plans.
+//     Confirm that cache is empty.
+assert.eq(1, t.find({a: 1, b: 1}).itcount(), 'unexpected document count');
+assert.eq(1, getShapes().length, 'plan cache should not be empty after query');
+t.ensureIndex({c: 1});
+assert.eq(1, getShapes().length, 'plan cache should keep entry after adding unrelated index');
+assert.commandWorked(t.dropIndex({c: 1}));
+assert.eq(1, getShapes().length, 'plan cache should keep entry after dropping unrelated index');
+assert.commandWorked(t.dropIndex({b: 1}));
+assert.eq(0, getShapes().length, 'plan cache should be empty after dropping index used by plan');
+
 // Case 3: The mongod process restarts
 // Not applicable.
@@ -0,0 +1,43 @@
+// Upserts with a query on _id alone run through the IDHACK stage, skipping query planning, both
+// when they update an existing document and when they insert a new one.
+
+load("jstests/libs/analyze_plan.js");  // For isIdhack.
+
+(function() {
+    "use strict";
+    var t = db.upsert_idhack;
+    t.drop();
+    assert.writeOK(t.insert({_id: 0, a: 0}));
+
+    function assertIdhackUpsert(query, update) {
+        var explain = t.explain("executionStats").update(query, update, {upsert: true});
+        assert.commandWorked(explain);
+        var winningPlan = explain.queryPlanner.winningPlan;
+        assert.eq("UPDATE", winningPlan.stage, tojson(explain));
+        assert(isIdhack(winningPlan), tojson(explain));
+        assert.lte(explain.executionStats.totalKeysExamined, 1, tojson(explain));
+    }
+
+    // Inserting a new document.
+    assertIdhackUpsert({_id: 1}, {$set: {a: 1}});
+    assertIdhackUpsert({_id: 1}, {a: 1});
+    var res = t.update({_id: 1}, {$set: {a: 1}, $setOnInsert: {b: 1}}, {upsert: true});
+    assert.writeOK(res);
+    assert.eq(1, res.nUpserted, tojson(res));
+    assert.eq({_id: 1, a: 1, b: 1}, t.findOne({_id: 1}));
+
+    res = t.update({_id: 2}, {a: 2}, {upsert: true});
+    assert.eq(1, res.nUpserted, tojson(res));
+    assert.eq({_id: 2, a: 2}, t.findOne({_id: 2}));
+
+    // Updating the existing document.
+    assertIdhackUpsert({_id: 0}, {$inc: {a: 1}});
+    res = t.update({_id: 0}, {$inc: {a: 1}, $setOnInsert: {b: 1}}, {upsert: true});
+    assert.eq(0, res.nUpserted, tojson(res));
+    assert.eq(1, res.nModified, tojson(res));
+    assert.eq({_id: 0, a: 1}, t.findOne({_id: 0}));
+
+    // The inserted document keeps the _id of the query.
+    assert.writeError(t.update({_id: 3}, {_id: 0, a: 3}, {upsert: true}));
+    assert.eq(3, t.count());
+}());
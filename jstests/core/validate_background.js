@@ -0,0 +1,25 @@
+// Test the background and maxBytesPerSec options of the validate command.
+(function() {
+    "use strict";
+    var coll = db.validate_background;
+    coll.drop();
+
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(coll.insert({_id: i, a: i, b: [i, i + 1]}));
+    }
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+    assert.commandWorked(coll.ensureIndex({b: 1}, {sparse: true}));
+
+    var res = assert.commandWorked(coll.validate({background: true}));
+    assert(res.valid, tojson(res));
+    assert.eq(100, res.nrecords, tojson(res));
+    assert.eq(3, res.nIndexes, tojson(res));
+    assert.eq(200, res.keysPerIndex[coll.getFullName() + ".$b_1"], tojson(res));
+
+    res = assert.commandWorked(coll.validate({background: true, maxBytesPerSec: 1024 * 1024}));
+    assert(res.valid, tojson(res));
+
+    assert.commandFailed(coll.validate({background: true, full: true}));
+    assert.commandFailed(coll.validate({background: true, maxBytesPerSec: -1}));
+    assert.commandFailed(coll.validate({maxBytesPerSec: 1024}));
+})();
@@ -0,0 +1,74 @@
+// Test that $where, mapReduce and group read nested objects and arrays of objects correctly, and
+// that subobjects kept by the JS code outlive the document they were read from.
+(function() {
+    "use strict";
+    var coll = db.where_subobjects;
+    coll.drop();
+
+    for (var i = 0; i < 20; i++) {
+        assert.writeOK(coll.insert({
+            _id: i,
+            a: {b: {c: i, d: [{e: i * 2}, {e: i * 3}]}},
+            f: [{g: {h: "x" + i}}, [{k: i}]],
+            r: new DBRef("other", {nested: i})
+        }));
+    }
+
+    assert.eq(1, coll.find({$where: "this.a.b.c == 7 && this.a.b.d[1].e == 21"}).itcount());
+    assert.eq(1, coll.find({$where: "this.f[0].g.h == 'x5' && this.f[1][0].k == 5"}).itcount());
+    assert.eq(1, coll.find({$where: "this.r.$id.nested == 9"}).itcount());
+    assert.eq([{_id: 3}],
+              coll.find({$where: "tojson(this.a) == tojson({b: {c: 3, d: [{e: 6}, {e: 9}]}})"},
+                        {_id: 1})
+                  .toArray());
+
+    // Keep a subobject of every document in a global, and check the earlier ones are still intact
+    // while later documents are read.
+    assert.eq(20,
+              coll.find({
+                      $where: function() {
+                          if (typeof kept === "undefined") {
+                              kept = [];
+                          }
+                          kept.push(this.a.b);
+                          for (var j = 0; j < kept.length; j++) {
+                              if (kept[j].d[0].e != kept[j].c * 2) {
+                                  return false;
+                              }
+                          }
+                          return true;
+                      }
+                  })
+                  .itcount());
+
+    var res = coll.mapReduce(
+        function() {
+            emit(this._id % 2, {sum: this.a.b.d[0].e, h: [this.f[0].g.h]});
+        },
+        function(key, values) {
+            var out = {sum: 0, h: []};
+            values.forEach(function(v) {
+                out.sum += v.sum;
+                out.h = out.h.concat(v.h);
+            });
+            return out;
+        },
+        {out: {inline: 1}});
+    assert.commandWorked(res);
+    var sums = {};
+    res.results.forEach(function(r) {
+        sums[r._id] = r.value.sum;
+        assert.eq(10, r.value.h.length, tojson(r));
+    });
+    assert.eq({0: 180, 1: 200}, sums, tojson(res));
+
+    var groups = coll.group({
+        key: {},
+        cond: {},
+        initial: {total: 0},
+        reduce: function(doc, out) {
+            out.total += doc.a.b.d[1].e + doc.f[1][0].k;
+        }
+    });
+    assert.eq([{total: 760}], groups);
+})();
@@ -133,4 +133,26 @@
         assert.gt(cmdRes.cursor.id, NumberLong(0));
         assert.eq(cmdRes.cursor.ns, oplogColl.getFullName());
     }
+
+    // Check that a getMore waiting for data wakes up as soon as another client inserts into the
+    // capped collection, rather than when its maxTimeMS expires.
+    cmdRes = db.runCommand({find: collName, batchSize: 100, awaitData: true, tailable: true});
+    assert.commandWorked(cmdRes);
+    cursorId = cmdRes.cursor.id;
+    assert.gt(cursorId, NumberLong(0));
+
+    var insertShell =
+        startParallelShell("sleep(1000); assert.writeOK(db." + collName + ".insert({a: 'new'}));",
+                           mongo.port);
+    var start = new Date();
+    cmdRes = db.runCommand({getMore: cursorId, collection: collName, maxTimeMS: 60 * 1000});
+    var elapsed = new Date() - start;
+    insertShell();
+    assert.commandWorked(cmdRes);
+    assert.eq([{a: 'new'}],
+              cmdRes.cursor.nextBatch.map(function(doc) {
+                  return {a: doc.a};
+              }),
+              tojson(cmdRes));
+    assert.lt(elapsed, 30 * 1000, tojson(cmdRes));
 })();
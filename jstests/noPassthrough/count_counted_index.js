@@ -0,0 +1,75 @@
+// Test that counts of documents with a given value of the first field of a "counted" index, or
+// matching the filter of a counted partial index, are answered from the index's document counts,
+// that the counts follow inserts, updates and deletes, and that they are rebuilt on restart.
+load("jstests/libs/analyze_plan.js");
+
+(function() {
+    "use strict";
+    var dbpath = MongoRunner.dataPath + "count_counted_index/";
+    var conn = MongoRunner.runMongod({dbpath: dbpath});
+    var coll = conn.getDB("test").count_counted_index;
+    coll.drop();
+
+    function countedIndexOf(query) {
+        var explain = coll.explain().count(query);
+        var count = getPlanStage(explain.queryPlanner.winningPlan, "COUNT");
+        return count.countedIndex;
+    }
+
+    // The count of 'query' by scanning the collection.
+    function scannedCount(query) {
+        var res = coll.runCommand("count", {query: query, hint: {$natural: 1}});
+        assert.commandWorked(res);
+        return res.n;
+    }
+
+    function checkCounts() {
+        [0, 1, 2, 3, "a", 99].forEach(function(tenant) {
+            assert.eq(scannedCount({tenant: tenant}), coll.count({tenant: tenant}), tenant);
+        });
+        assert.eq(scannedCount({size: {$gt: 5}}), coll.count({size: {$gt: 5}}));
+    }
+
+    assert.commandFailed(coll.ensureIndex({tenant: 1}, {counted: "yes"}));
+    assert.commandFailed(coll.ensureIndex({tenant: "hashed"}, {counted: true}));
+
+    for (var i = 0; i < 100; i++) {
+        // Some documents are in several tenants, and some in the same tenant several times.
+        var tenant = (i % 10 == 0) ? [i % 3, "a"] : (i % 10 == 1) ? [1, 1] : i % 3;
+        assert.writeOK(coll.insert({_id: i, tenant: tenant, x: [i, i + 1], size: i % 10}));
+    }
+
+    assert.commandWorked(coll.ensureIndex({tenant: 1, x: 1}, {counted: true}));
+    assert.commandWorked(coll.ensureIndex(
+        {size: 1}, {counted: true, partialFilterExpression: {size: {$gt: 5}}}));
+
+    assert.eq("tenant_1_x_1", countedIndexOf({tenant: 1}));
+    assert.eq("size_1", countedIndexOf({size: {$gt: 5}}));
+    assert.eq(undefined, countedIndexOf({tenant: {$gt: 1}}));
+    assert.eq(undefined, countedIndexOf({tenant: null}));
+    assert.eq(undefined, countedIndexOf({tenant: 1, size: 2}));
+    checkCounts();
+    assert.eq(40, coll.count({size: {$gt: 5}}));
+
+    // Skip and limit apply to the count.
+    var n = coll.count({tenant: 1});
+    assert.eq(n - 5, coll.find({tenant: 1}).skip(5).count(true));
+    assert.eq(3, coll.find({tenant: 1}).limit(3).count(true));
+
+    assert.writeOK(coll.update({tenant: 0}, {$set: {tenant: 3}}, {multi: true}));
+    assert.writeOK(coll.update({_id: 5}, {$set: {tenant: ["a", 2], size: 9}}));
+    assert.writeOK(coll.update({size: 7}, {$set: {size: 1}}, {multi: true}));
+    assert.writeOK(coll.remove({_id: {$lt: 20}}));
+    assert.writeOK(coll.insert({_id: "new", tenant: 2, size: 6}));
+    checkCounts();
+
+    MongoRunner.stopMongod(conn);
+
+    // The counts are rebuilt when the collection is opened again.
+    conn = MongoRunner.runMongod({dbpath: dbpath, restart: true});
+    coll = conn.getDB("test").count_counted_index;
+    assert.eq("tenant_1_x_1", countedIndexOf({tenant: 2}));
+    checkCounts();
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,58 @@
+// Test that with deferDatabaseOpenAtStartup set, startup leaves databases closed until they are
+// first used, and that they then behave as if they had been opened at startup.
+(function() {
+    "use strict";
+    var dbpath = MongoRunner.dataPath + "defer_database_open/";
+    var conn = MongoRunner.runMongod({dbpath: dbpath});
+    if (conn.getDB("admin").serverStatus().storageEngine.name == "mmapv1") {
+        MongoRunner.stopMongod(conn);
+        return;
+    }
+
+    for (var i = 0; i < 3; i++) {
+        var testColl = conn.getDB("defer_open_" + i).coll;
+        for (var j = 0; j < 10; j++) {
+            assert.writeOK(testColl.insert({_id: j, x: j}));
+        }
+        assert.commandWorked(testColl.ensureIndex({x: 1}));
+    }
+    var ttlColl = conn.getDB("defer_open_ttl").coll;
+    assert.writeOK(ttlColl.insert({_id: 0, expireAt: new Date(0)}));
+    assert.commandWorked(ttlColl.ensureIndex({expireAt: 1}, {expireAfterSeconds: 0}));
+    MongoRunner.stopMongod(conn);
+
+    conn = MongoRunner.runMongod(
+        {dbpath: dbpath, restart: true, setParameter: "deferDatabaseOpenAtStartup=true"});
+    function catalogMetrics() {
+        return conn.getDB("admin").serverStatus().metrics.catalog;
+    }
+    var before = catalogMetrics();
+    assert.gte(before.deferredDatabases, 3, tojson(before));
+
+    // Reading a database opens it, with its collections and indexes.
+    var coll = conn.getDB("defer_open_0").coll;
+    assert.eq(10, coll.find().itcount());
+    assert.eq(1, coll.find({x: 5}).hint({x: 1}).itcount());
+    var after = catalogMetrics();
+    assert.eq(before.deferredDatabases - 1, after.deferredDatabases, tojson(after));
+    assert.eq(before.databaseOpens + 1, after.databaseOpens, tojson(after));
+
+    // So does writing to one.
+    assert.writeOK(conn.getDB("defer_open_1").coll.insert({_id: 10, x: 10}));
+    assert.eq(11, conn.getDB("defer_open_1").coll.count());
+
+    // A database which is still closed is known to the server, and listing it doesn't open it.
+    before = catalogMetrics();
+    assert.contains("defer_open_2", conn.getDBNames());
+    assert.eq(before.deferredDatabases, catalogMetrics().deferredDatabases);
+    assert.writeError(conn.getDB("DEFER_OPEN_2").coll.insert({}));
+    assert.eq(10, conn.getDB("defer_open_2").coll.count());
+
+    // The TTL monitor opens the databases with TTL indexes.
+    assert.commandWorked(conn.getDB("admin").runCommand({setParameter: 1, ttlMonitorSleepSecs: 1}));
+    assert.soon(function() {
+        return conn.getDB("defer_open_ttl").coll.count() == 0;
+    }, "TTL monitor didn't delete the expired document", 2 * 60 * 1000);
+
+    MongoRunner.stopMongod(conn);
+})();
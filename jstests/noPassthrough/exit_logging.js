@@ -81,6 +81,20 @@
         });
     }());
 
+    (function testMongodWithAsyncLogging() {
+        print("********************\nTesting exit logging in mongod with asyncLogging\n" +
+              "********************");
+
+        runAllTests({
+            start: function (opts) {
+                var actualOpts = { nojournal: "", setParameter: "asyncLogging=true" };
+                Object.extend(actualOpts, opts);
+                return MongoRunner.runMongod(actualOpts);
+            },
+            stop: MongoRunner.stopMongod
+        });
+    }());
+
     (function testMongos() {
         print("********************\nTesting exit logging in mongos\n********************");
 
@@ -0,0 +1,47 @@
+// Test that serverStatus reports the memory held by the caches registered with the memory budget,
+// and that with memoryBudgetMB set the plan caches are shrunk to stay within it.
+(function() {
+    "use strict";
+    var conn = MongoRunner.runMongod({});
+    var db = conn.getDB("test");
+    function memoryBudget() {
+        return db.serverStatus().memoryBudget;
+    }
+
+    var status = memoryBudget();
+    assert.eq(0, status.limitBytes, tojson(status));
+    if (db.serverStatus().storageEngine.name == "wiredTiger") {
+        assert.gt(status.consumers.wiredTigerCache, 0, tojson(status));
+    }
+
+    // Fill a plan cache with many query shapes, each with two indexes to choose from.
+    var coll = db.memory_budget;
+    coll.drop();
+    assert.writeOK(coll.insert({_id: 0}));
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+    assert.commandWorked(coll.ensureIndex({b: 1}));
+    for (var i = 0; i < 200; i++) {
+        var query = {a: 1, b: 1};
+        query["c" + i] = 1;
+        assert.eq(0, coll.find(query).itcount());
+    }
+    var numCached = coll.getPlanCache().listQueryShapes().length;
+    assert.gt(numCached, 0);
+    status = memoryBudget();
+    assert.gt(status.consumers.planCache, 0, tojson(status));
+
+    // A budget below what the caches hold makes the monitor evict plan cache entries.
+    assert.commandWorked(db.adminCommand({setParameter: 1, memoryBudgetMB: 1}));
+    assert.soon(function() {
+        status = memoryBudget();
+        return status.limitBytes == 1024 * 1024 && status.bytesFreed > 0;
+    }, "memory budget monitor never shrank the caches");
+    assert.lt(coll.getPlanCache().listQueryShapes().length, numCached);
+
+    assert.commandWorked(db.adminCommand({setParameter: 1, memoryBudgetMB: 0}));
+    assert.soon(function() {
+        return memoryBudget().limitBytes == 0;
+    });
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,48 @@
+// Test that with wiredTigerOplogStonesTrackNamespaces set, oplogReplay queries on a single
+// namespace return the same entries while skipping the oplog stones without that namespace.
+(function() {
+    "use strict";
+    var runner = MongoRunner.runMongod(
+        {master: "", oplogSize: 1, setParameter: "wiredTigerOplogStonesTrackNamespaces=true"});
+    var db = runner.getDB("test");
+    if (db.serverStatus().storageEngine.name != "wiredTiger") {
+        MongoRunner.stopMongod(runner);
+        return;
+    }
+    var oplog = runner.getDB("local").oplog.$main;
+
+    // A 1MB oplog is split into stones of about 100KB. Fill a few with inserts into one
+    // collection, then insert into another.
+    var str = new Array(500).join("x");
+    var bulk = db.busy.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, str: str});
+    }
+    assert.writeOK(bulk.execute());
+    for (i = 0; i < 10; i++) {
+        assert.writeOK(db.quiet.insert({_id: i}));
+    }
+
+    var start = oplog.find({ns: "test.busy"}).sort({$natural: 1}).limit(1).next().ts;
+    function stonesSkipped() {
+        return db.serverStatus().wiredTiger.oplogTruncation.stonesSkippedByNamespace;
+    }
+    function replay(ns) {
+        return oplog.find({ts: {$gt: start}, ns: ns})
+            .addOption(DBQuery.Option.oplogReplay)
+            .itcount();
+    }
+
+    var before = stonesSkipped();
+    assert.eq(10, replay("test.quiet"));
+    assert.gte(stonesSkipped() - before, 3);
+
+    before = stonesSkipped();
+    assert.eq(0, replay("test.missing"));
+    assert.gte(stonesSkipped() - before, 3);
+
+    // Stones with the namespace are still read.
+    assert.eq(999, replay("test.busy"));
+
+    MongoRunner.stopMongod(runner);
+})();
@@ -0,0 +1,44 @@
+// Test that the TTL monitor deletes expired documents in batches of ttlMonitorBatchSize, at no more
+// than ttlMonitorMaxDeletesPerSecondPerIndex, and reports indexes it couldn't catch up on.
+(function() {
+    "use strict";
+    var runner = MongoRunner.runMongod({setParameter: "ttlMonitorSleepSecs=1"});
+    var db = runner.getDB("test");
+    assert.commandWorked(db.adminCommand(
+        {setParameter: 1, ttlMonitorBatchSize: 10, ttlMonitorMaxDeletesPerSecondPerIndex: 50}));
+    var coll = db.ttl_batched_deletes;
+    coll.drop();
+
+    var numDocs = 500;
+    var past = new Date(new Date().getTime() - 3600 * 1000);
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        bulk.insert({_id: i, x: past});
+    }
+    assert.writeOK(bulk.execute());
+    assert.writeOK(coll.insert({_id: "live", x: new Date(new Date().getTime() + 3600 * 1000)}));
+
+    var before = db.serverStatus().metrics.ttl;
+    assert.commandWorked(coll.ensureIndex({x: 1}, {expireAfterSeconds: 0}));
+
+    // Each pass may delete at most 50 documents, so the first few leave a backlog behind.
+    assert.soon(function() {
+        return db.serverStatus().metrics.ttl.indexesWithBacklog == 1;
+    }, "TTL monitor never reported a backlog");
+    assert.gt(coll.count(), numDocs / 2);
+
+    assert.soon(function() {
+        return coll.count() == 1;
+    }, "TTL monitor didn't delete the expired documents", 60 * 1000);
+    assert.eq(1, coll.find({_id: "live"}).itcount());
+
+    var after = db.serverStatus().metrics.ttl;
+    assert.eq(numDocs, after.deletedDocuments - before.deletedDocuments, tojson(after));
+    assert.gte(after.batches - before.batches, numDocs / 10, tojson(after));
+
+    assert.soon(function() {
+        return db.serverStatus().metrics.ttl.indexesWithBacklog == 0;
+    }, "TTL monitor still reports a backlog");
+
+    MongoRunner.stopMongod(runner);
+})();
@@ -0,0 +1,39 @@
+// Test that dbHash with perCollectionLocks returns the same hashes as with the default database
+// lock, whatever the number of threads hashing collections.
+(function() {
+    "use strict";
+    var testDB = db.getSiblingDB("dbhash_per_collection_locks");
+    testDB.dropDatabase();
+
+    for (var i = 0; i < 10; i++) {
+        var coll = testDB["coll" + i];
+        for (var j = 0; j < i * 10; j++) {
+            assert.writeOK(coll.insert({_id: j, x: "value" + i + "_" + j}));
+        }
+    }
+    assert.commandWorked(testDB.createCollection("capped", {capped: true, size: 4096}));
+    assert.writeOK(testDB.capped.insert({a: 1}));
+
+    var expected = assert.commandWorked(testDB.runCommand({dbHash: 1}));
+    assert.eq(11, Object.keys(expected.collections).length, tojson(expected));
+
+    var originalThreads =
+        assert.commandWorked(db.adminCommand({getParameter: 1, dbHashMaxThreads: 1}))
+            .dbHashMaxThreads;
+    [1, 3, 16].forEach(function(numThreads) {
+        assert.commandWorked(db.adminCommand({setParameter: 1, dbHashMaxThreads: numThreads}));
+        var res = assert.commandWorked(testDB.runCommand({dbHash: 1, perCollectionLocks: true}));
+        assert.eq(expected.md5, res.md5, tojson(res));
+        assert.eq(expected.collections, res.collections, tojson(res));
+        assert.eq(expected.numCollections, res.numCollections, tojson(res));
+    });
+
+    var subset = assert.commandWorked(
+        testDB.runCommand({dbHash: 1, perCollectionLocks: true, collections: ["coll3", "coll7"]}));
+    assert.eq({coll3: expected.collections.coll3, coll7: expected.collections.coll7},
+              subset.collections,
+              tojson(subset));
+
+    assert.commandWorked(db.adminCommand({setParameter: 1, dbHashMaxThreads: originalThreads}));
+    testDB.dropDatabase();
+})();
@@ -0,0 +1,48 @@
+// Test that the execution stats of an explain report the precise time of each stage and the bytes
+// of the documents it examined, and include a Chrome trace of the stages when
+// explainExecutionTrace is set.
+(function() {
+    "use strict";
+
+    var coll = db.explain_execution_trace;
+    coll.drop();
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(coll.insert({a: i, b: i % 10}));
+    }
+
+    function checkStages(stage) {
+        assert(stage.hasOwnProperty("executionTimeNanos"), tojson(stage));
+        assert.gte(stage.executionTimeNanos, 0, tojson(stage));
+        if (stage.stage === "FETCH" || stage.stage === "COLLSCAN") {
+            assert.gt(stage.docBytesExamined, 0, tojson(stage));
+        }
+        (stage.inputStages || (stage.inputStage ? [stage.inputStage] : [])).forEach(checkStages);
+    }
+
+    var collScan = coll.find({b: 3}).explain("executionStats").executionStats;
+    assert.eq(10, collScan.nReturned, tojson(collScan));
+    assert.eq("COLLSCAN", collScan.executionStages.stage, tojson(collScan));
+    checkStages(collScan.executionStages);
+    assert(!collScan.hasOwnProperty("executionTrace"), tojson(collScan));
+
+    assert.commandWorked(db.adminCommand({setParameter: 1, explainExecutionTrace: true}));
+    try {
+        var ixScan = coll.find({a: {$lt: 20}, b: 3}).explain("executionStats").executionStats;
+        assert.eq(2, ixScan.nReturned, tojson(ixScan));
+        checkStages(ixScan.executionStages);
+
+        var events = ixScan.executionTrace.traceEvents;
+        assert.eq("FETCH", events[0].name, tojson(ixScan.executionTrace));
+        assert.eq("IXSCAN", events[1].name, tojson(ixScan.executionTrace));
+        assert.eq(0, events[0].ts, tojson(events));
+        events.forEach(function(event) {
+            // The children are nested in the event of their parent.
+            assert.eq("X", event.ph, tojson(event));
+            assert.lte(event.ts + event.dur, events[0].dur + 1, tojson(events));
+        });
+        assert.eq(ixScan.executionStages.works, events[0].args.works, tojson(events));
+    } finally {
+        assert.commandWorked(db.adminCommand({setParameter: 1, explainExecutionTrace: false}));
+    }
+}());
@@ -21,6 +21,8 @@
     assert.eq(getparam("diagnosticDataCollectionFileSizeMb"), 10);
     assert.eq(getparam("diagnosticDataCollectionSamplesPerChunk"), 300);
     assert.eq(getparam("diagnosticDataCollectionSamplesPerInterimUpdate"), 10);
+    assert.eq(getparam("diagnosticDataCollectionRingDurationSecs"), 0);
+    assert.eq(getparam("diagnosticDataCollectionRingPeriodMillis"), 100);
 
     function setparam(obj) {
         var ret = admin.runCommand( Object.extend({ setParameter : 1 }, obj));
@@ -33,10 +35,22 @@
     assert.commandWorked(setparam({"diagnosticDataCollectionFileSizeMb": 1}));
     assert.commandWorked(setparam({"diagnosticDataCollectionSamplesPerChunk": 1}));
     assert.commandWorked(setparam({"diagnosticDataCollectionSamplesPerInterimUpdate": 1}));
+    assert.commandWorked(setparam({"diagnosticDataCollectionRingPeriodMillis": 10}));
+    assert.commandWorked(setparam({"diagnosticDataCollectionRingDurationSecs": 60}));
+
+    // The ring has samples once enabled
+    assert.soon(function() {
+        var ret = assert.commandWorked(admin.runCommand({getDiagnosticDataRing: 1}));
+        assert.eq(ret.truncated, false);
+        return ret.chunks.length > 0;
+    });
+    assert.commandWorked(setparam({"diagnosticDataCollectionRingDurationSecs": 0}));
 
     // Negative tests - set values below minimums
     assert.commandFailed(setparam({"diagnosticDataCollectionPeriodMillis": 1}));
     assert.commandFailed(setparam({"diagnosticDataCollectionDirectorySizeMb": 1}));
+    assert.commandFailed(setparam({"diagnosticDataCollectionRingPeriodMillis": 1}));
+    assert.commandFailed(setparam({"diagnosticDataCollectionRingDurationSecs": -1}));
 
     // Negative test - set file size bigger then directory size
     assert.commandWorked(setparam({"diagnosticDataCollectionDirectorySizeMb": 10}));
@@ -53,4 +67,5 @@
     assert.commandWorked(setparam({"diagnosticDataCollectionPeriodMillis": 1000}));
     assert.commandWorked(setparam({"diagnosticDataCollectionSamplesPerChunk": 300}));
     assert.commandWorked(setparam({"diagnosticDataCollectionSamplesPerInterimUpdate": 10}));
+    assert.commandWorked(setparam({"diagnosticDataCollectionRingPeriodMillis": 100}));
 }) ();
@@ -0,0 +1,90 @@
+// Test that a $text search sorted by the text score with a limit returns the same top results as
+// without the limit, and that TEXT_OR stops reading the text index once no other document can
+// make the cut.
+load("jstests/libs/analyze_plan.js");
+
+(function() {
+    "use strict";
+
+    var coll = db.fts_score_sort_limit;
+    coll.drop();
+    assert.commandWorked(coll.ensureIndex({t: "text"}, {default_language: "none"}));
+
+    // Every document contains "common", only the first few contain "rare" as well, and score high
+    // for both.
+    var numDocs = 2000;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        var text;
+        if (i < 30) {
+            text = "common common common rare rare filler" + i;
+        } else {
+            text = "common filler" + i + " filler" + (i % 7) + " filler" + (i % 11) + " other";
+        }
+        bulk.insert({_id: i, t: text, group: i % 2});
+    }
+    assert.writeOK(bulk.execute());
+
+    var scoreProj = {score: {$meta: "textScore"}};
+    var scoreSort = {score: {$meta: "textScore"}};
+
+    function allScores(filter) {
+        var scores = {};
+        coll.find(filter, scoreProj).forEach(function(doc) {
+            scores[doc._id] = doc.score;
+        });
+        return scores;
+    }
+
+    function checkTopResults(filter, skip, limit) {
+        var scores = allScores(filter);
+        var expected = Object.keys(scores).map(function(id) {
+            return scores[id];
+        });
+        expected.sort(function(a, b) {
+            return b - a;
+        });
+        expected = expected.slice(skip, skip + limit);
+
+        var results = coll.find(filter, scoreProj).sort(scoreSort).skip(skip).limit(limit).toArray();
+        assert.eq(expected,
+                  results.map(function(doc) {
+                      return doc.score;
+                  }),
+                  tojson(filter));
+        results.forEach(function(doc) {
+            assert.eq(scores[doc._id], doc.score, tojson(doc));
+        });
+    }
+
+    checkTopResults({$text: {$search: "common rare"}}, 0, 10);
+    checkTopResults({$text: {$search: "common rare"}}, 5, 10);
+    checkTopResults({$text: {$search: "common rare"}}, 0, 100);
+    checkTopResults({$text: {$search: "common rare"}, group: 1}, 0, 10);
+    checkTopResults({$text: {$search: "rare filler3"}}, 0, 10);
+    checkTopResults({$text: {$search: "common"}}, 0, 10);
+    checkTopResults({$text: {$search: "common rare -filler3"}}, 0, 10);
+
+    var explain = coll.find({$text: {$search: "common rare"}}, scoreProj)
+                      .sort(scoreSort)
+                      .limit(10)
+                      .explain("executionStats");
+    var textOr = getPlanStage(explain.executionStats.executionStages, "TEXT_OR");
+    assert.neq(null, textOr, tojson(explain));
+    assert.eq(10, textOr.limitAmount, tojson(textOr));
+    assert(textOr.stoppedEarly, tojson(textOr));
+    var keysExamined = 0;
+    textOr.inputStages.forEach(function(ixscan) {
+        keysExamined += ixscan.keysExamined;
+    });
+    assert.lt(keysExamined, numDocs, tojson(textOr));
+    assert.eq(10, explain.executionStats.nReturned, tojson(explain));
+
+    // Negated terms can drop documents after TEXT_OR, so it has to return all of them.
+    explain = coll.find({$text: {$search: "common rare -filler3"}}, scoreProj)
+                  .sort(scoreSort)
+                  .limit(10)
+                  .explain("executionStats");
+    textOr = getPlanStage(explain.executionStats.executionStages, "TEXT_OR");
+    assert.eq(undefined, textOr.limitAmount, tojson(textOr));
+}());
@@ -0,0 +1,72 @@
+// Test that $nearSphere over a 2dsphere index returns the same documents, ordered by distance,
+// whatever the size of its search annuli and whether their coverings come from the covering cache,
+// and that sparse data is not searched in many small annuli.
+(function() {
+    "use strict";
+
+    var coll = db.geo_s2near_adaptive_intervals;
+    coll.drop();
+    assert.commandWorked(coll.ensureIndex({loc: "2dsphere"}));
+
+    // A dense cluster around the query point and sparse points far from it.
+    Random.setRandomSeed();
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 2000; i++) {
+        bulk.insert({_id: i, loc: [Random.rand() * 0.02 - 0.01, Random.rand() * 0.02 - 0.01]});
+    }
+    for (var i = 2000; i < 2500; i++) {
+        bulk.insert({_id: i, loc: [Random.rand() * 100 - 50, Random.rand() * 100 - 50]});
+    }
+    assert.writeOK(bulk.execute());
+
+    var query = {loc: {$nearSphere: {$geometry: {type: "Point", coordinates: [0, 0]}}}};
+
+    function nearIds() {
+        return coll.find(query, {_id: 1}).toArray().map(function(doc) {
+            return doc._id;
+        });
+    }
+
+    function setParams(params) {
+        assert.commandWorked(db.adminCommand(Object.extend({setParameter: 1}, params)));
+    }
+
+    function numIntervals() {
+        var explain = coll.find(query).explain("executionStats");
+        var stage = explain.executionStats.executionStages;
+        while (stage.stage !== "GEO_NEAR_2DSPHERE") {
+            stage = stage.inputStage;
+        }
+        return stage.searchIntervals.length;
+    }
+
+    var defaults = assert.commandWorked(db.adminCommand({
+        getParameter: 1,
+        internalQueryS2GeoNearTargetIntervalResults: 1,
+        internalQueryS2GeoNearCoveringCacheSize: 1
+    }));
+
+    try {
+        setParams({internalQueryS2GeoNearCoveringCacheSize: 0});
+        var expected = nearIds();
+        assert.eq(2500, expected.length);
+
+        // With the covering cache, on both a cold and a warm cache.
+        setParams({internalQueryS2GeoNearCoveringCacheSize: 1024});
+        assert.eq(expected, nearIds());
+        assert.eq(expected, nearIds());
+
+        // With much smaller and much larger annuli.
+        [10, 100000].forEach(function(target) {
+            setParams({internalQueryS2GeoNearTargetIntervalResults: target});
+            assert.eq(expected, nearIds(), "target " + target);
+        });
+
+        // The annuli grow quickly through the sparse points once the cluster is behind them.
+        setParams({internalQueryS2GeoNearTargetIntervalResults: 400});
+        assert.lt(numIntervals(), 30);
+    } finally {
+        delete defaults.ok;
+        setParams(defaults);
+    }
+}());
@@ -0,0 +1,67 @@
+// Test that with internalQueryGetMorePrefetchBytes set, getMores return the same results as
+// without, with a helper thread loading each next batch, and that prefetched cursors can be
+// killed.
+(function() {
+    "use strict";
+    var coll = db.getmore_prefetch;
+    coll.drop();
+
+    var str = new Array(1000).join("x");
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 2000; i++) {
+        bulk.insert({_id: i, a: i % 10, str: str});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+
+    function runAll() {
+        return [
+            coll.find().sort({_id: 1}).batchSize(100).toArray(),
+            coll.find({a: {$gte: 5}}, {str: 0}).batchSize(50).toArray(),
+            coll.find({a: 3}).hint({a: 1}).batchSize(20).toArray(),
+        ];
+    }
+
+    function prefetchMetrics() {
+        return db.serverStatus().metrics.getMorePrefetch;
+    }
+
+    var getParameterResult = assert.commandWorked(
+        db.adminCommand({getParameter: 1, internalQueryGetMorePrefetchBytes: 1}));
+    var original = getParameterResult.internalQueryGetMorePrefetchBytes;
+    try {
+        assert.commandWorked(
+            db.adminCommand({setParameter: 1, internalQueryGetMorePrefetchBytes: 0}));
+        var expected = runAll();
+
+        assert.commandWorked(
+            db.adminCommand({setParameter: 1, internalQueryGetMorePrefetchBytes: 256 * 1024}));
+        var before = prefetchMetrics();
+        var actual = runAll();
+        var after = prefetchMetrics();
+
+        // Kill a cursor part way through, while its next batch may still be loading.
+        var openBefore = db.serverStatus().metrics.cursor.open.total;
+        var res = assert.commandWorked(db.runCommand({find: coll.getName(), batchSize: 10}));
+        var cursorId = res.cursor.id;
+        assert.commandWorked(
+            db.runCommand({getMore: cursorId, collection: coll.getName(), batchSize: 10}));
+        res = assert.commandWorked(
+            db.runCommand({killCursors: coll.getName(), cursors: [cursorId]}));
+        assert.eq([cursorId], res.cursorsKilled, tojson(res));
+        assert.eq(openBefore, db.serverStatus().metrics.cursor.open.total);
+    } finally {
+        assert.commandWorked(
+            db.adminCommand({setParameter: 1, internalQueryGetMorePrefetchBytes: original}));
+    }
+
+    for (var j = 0; j < expected.length; j++) {
+        assert.eq(expected[j], actual[j], "query " + j);
+    }
+
+    // Prefetching is only done on storage engines with document-level locking.
+    if (db.serverStatus().storageEngine.name == "wiredTiger") {
+        assert.gt(after.batches, before.batches, tojson(after));
+        assert.gt(after.documents, before.documents, tojson(after));
+    }
+})();
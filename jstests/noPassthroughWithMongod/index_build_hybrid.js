@@ -0,0 +1,53 @@
+/**
+ * A background index build bulk loads its sorted keys while concurrent writes are kept in a
+ * side table, then applies them. This test asserts that the index matches the documents whether
+ * the writes came before or after the scan reached them.
+ */
+(function() {
+    "use strict";
+    var coll = db.index_build_hybrid;
+    coll.drop();
+
+    var numDocs = 20000;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        bulk.insert({_id: i, a: i, b: [i, -i]});
+    }
+    assert.writeOK(bulk.execute());
+
+    // Updates, moves, removes and inserts spread over the whole collection during the build.
+    var writer = startParallelShell(function() {
+        var coll = db.index_build_hybrid;
+        var numDocs = 20000;
+        while (db.index_build_hybrid_done.count() == 0) {
+            var i = Random.randInt(numDocs);
+            coll.update({_id: i}, {$set: {a: -i, pad: "x".repeat(Random.randInt(500))}});
+            coll.update({_id: Random.randInt(numDocs)}, {$push: {b: 1}});
+            coll.remove({_id: Random.randInt(numDocs)});
+            coll.insert({_id: numDocs + Random.randInt(numDocs), a: -1, b: [-1]});
+        }
+    });
+
+    try {
+        assert.commandWorked(coll.ensureIndex({a: 1}, {background: true}));
+        assert.commandWorked(coll.ensureIndex({b: 1, a: 1}, {background: true}));
+    } finally {
+        assert.writeOK(db.index_build_hybrid_done.insert({}));
+        writer();
+        db.index_build_hybrid_done.drop();
+    }
+
+    var validate = coll.validate(true);
+    assert(validate.valid, tojson(validate));
+    [{a: 1}, {b: 1, a: 1}].forEach(function(spec) {
+        var indexed = coll.find({}, {_id: 1}).hint(spec).sort({_id: 1}).toArray();
+        var scanned = coll.find({}, {_id: 1}).hint({$natural: 1}).sort({_id: 1}).toArray();
+        assert.eq(scanned.length, indexed.length, tojson(spec));
+    });
+    coll.find().forEach(function(doc) {
+        assert.eq(1, coll.find({a: doc.a, _id: doc._id}).hint({a: 1}).itcount(), tojson(doc));
+    });
+
+    // Unique indexes still check every key as it is inserted.
+    assert.commandWorked(coll.ensureIndex({_id: 1, a: 1}, {unique: true, background: true}));
+}());
@@ -0,0 +1,43 @@
+/**
+ * A foreground index build with maxIndexBuildThreads > 1 generates keys on several threads and
+ * merges their sorted runs. This test asserts that it builds the same indexes as a single thread.
+ */
+(function() {
+    "use strict";
+    var coll = db.index_build_threads;
+    coll.drop();
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 10000; i++) {
+        bulk.insert({_id: i, a: i % 97, b: [i, -i], c: (i % 2 == 0) ? "even" : "odd"});
+    }
+    assert.writeOK(bulk.execute());
+
+    var specs = [{a: 1}, {b: 1}, {c: 1, a: -1}];
+    function buildAndDump(numThreads) {
+        assert.commandWorked(db.adminCommand({setParameter: 1, maxIndexBuildThreads: numThreads}));
+        coll.dropIndexes();
+        specs.forEach(function(spec) {
+            assert.commandWorked(coll.ensureIndex(spec));
+        });
+        return specs.map(function(spec) {
+            return coll.find({}, {_id: 1}).hint(spec).toArray();
+        });
+    }
+
+    var original = db.adminCommand({getParameter: 1, maxIndexBuildThreads: 1});
+    assert.commandWorked(original);
+    try {
+        var expected = buildAndDump(1);
+        assert.eq(expected, buildAndDump(4));
+        var validate = coll.validate(true);
+        assert(validate.valid, tojson(validate));
+
+        // A key generation error on a worker thread fails the build.
+        assert.writeOK(coll.insert({_id: "parallel", d: [1, 2], e: [1, 2]}));
+        assert.commandFailed(coll.ensureIndex({d: 1, e: 1}));
+    } finally {
+        assert.commandWorked(db.adminCommand(
+            {setParameter: 1, maxIndexBuildThreads: original.maxIndexBuildThreads}));
+    }
+}());
@@ -0,0 +1,48 @@
+// Updates leave alone the indexes whose key and partial filter paths they do not touch, and
+// evaluate an untouched partial filter only against the old document.
+(function() {
+    "use strict";
+    var coll = db.index_update_skip;
+    coll.drop();
+
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+    assert.commandWorked(coll.ensureIndex({b: 1}, {partialFilterExpression: {c: {$gt: 0}}}));
+    assert.writeOK(coll.insert({_id: 0, a: 1, b: 1, c: 1, d: 1}));
+    assert.writeOK(coll.insert({_id: 1, a: 1, b: 1, c: -1, d: 1}));
+
+    function metrics() {
+        return db.serverStatus().metrics.index.update;
+    }
+
+    function assertIndexed(query, hint, ids) {
+        var found = coll.find(query).hint(hint).toArray().map(function(doc) {
+            return doc._id;
+        });
+        assert.eq(ids, found.sort(), tojson(query) + " hinting " + tojson(hint));
+    }
+
+    // Touches no indexed path: both secondary indexes are skipped for both documents.
+    var before = metrics();
+    assert.writeOK(coll.update({}, {$inc: {d: 1}, $set: {pad: "x".repeat(1000)}}, {multi: true}));
+    var after = metrics();
+    assert.gte(after.skipped - before.skipped, 4, tojson(after));
+
+    // Changes a key of the partial index: the filter is read from the old document only.
+    before = metrics();
+    assert.writeOK(coll.update({}, {$set: {b: 2}}, {multi: true}));
+    after = metrics();
+    assert.gte(after.filterChecksSkipped - before.filterChecksSkipped, 2, tojson(after));
+    assertIndexed({b: 2, c: {$gt: 0}}, {b: 1}, [0]);
+
+    // Changes the filter path: documents move in and out of the partial index.
+    assert.writeOK(coll.update({_id: 0}, {$set: {c: -1}}));
+    assert.writeOK(coll.update({_id: 1}, {$set: {c: 1}}));
+    assertIndexed({b: 2, c: {$gt: 0}}, {b: 1}, [1]);
+
+    // A replacement may change any path, so it updates every index.
+    assert.writeOK(coll.update({_id: 1}, {a: 3, b: 3, c: 1}));
+    assertIndexed({a: 3}, {a: 1}, [1]);
+    assertIndexed({b: 3, c: {$gt: 0}}, {b: 1}, [1]);
+
+    assert(coll.validate(true).valid);
+}());
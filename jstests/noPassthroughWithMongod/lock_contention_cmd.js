@@ -0,0 +1,42 @@
+/**
+ * The lockContention command reports the resources with the longest lock wait times. This test
+ * makes a database lock wait and asserts that the database is reported under its name.
+ */
+(function() {
+    "use strict";
+    var coll = db.lock_contention_cmd;
+    coll.drop();
+    assert.writeOK(coll.insert({_id: 0}));
+
+    // A $where that sleeps holds the database lock in intent mode, so the exclusive database lock
+    // of the collMod below waits for it.
+    var awaitShell = startParallelShell(
+        "db.lock_contention_cmd.find({$where: 'sleep(2000); return true;'}).itcount();");
+    assert.soon(function() {
+        return db.currentOp({ns: coll.getFullName(), op: "query"}).inprog.length > 0;
+    });
+    assert.commandWorked(db.runCommand({collMod: coll.getName(), usePowerOf2Sizes: true}));
+    awaitShell();
+
+    var res = db.adminCommand({lockContention: 1, limit: 512});
+    assert.commandWorked(res);
+    assert.eq("all times in microseconds", res.note, tojson(res));
+    var entries = res.resources.filter(function(resource) {
+        return resource.resource === db.getName();
+    });
+    assert.eq(1, entries.length, tojson(res));
+    assert.eq("Database", entries[0].type, tojson(entries[0]));
+    assert.gt(entries[0].modes.W.acquireWaitCount, 0, tojson(entries[0]));
+    assert.gt(entries[0].timeAcquiringMicros, 0, tojson(entries[0]));
+
+    // Resources are in descending order of wait time.
+    for (var i = 1; i < res.resources.length; i++) {
+        assert.gte(res.resources[i - 1].timeAcquiringMicros,
+                   res.resources[i].timeAcquiringMicros,
+                   tojson(res));
+    }
+
+    assert.commandFailed(db.adminCommand({lockContention: 1, limit: 0}));
+    assert.commandFailed(db.adminCommand({lockContention: 1, limit: "all"}));
+    assert.commandFailed(db.runCommand({lockContention: 1}));
+}());
@@ -0,0 +1,132 @@
+// Test that mapReduce gives the same results whether it runs the map and reduce functions it
+// recognizes natively or in JavaScript, including for documents and values only JavaScript can
+// handle.
+(function() {
+    "use strict";
+
+    var coll = db.mr_native_functions;
+    coll.drop();
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, k: i % 13, v: i / 4, n: {k: "k" + (i % 7), v: NumberInt(i)}});
+    }
+    // Keys and values that the native functions leave to JavaScript.
+    bulk.insert({_id: "long", k: NumberLong(3), v: NumberLong(5), n: {k: "k1", v: "str"}});
+    bulk.insert({_id: "missing", n: {}});
+    bulk.insert({_id: "object", k: {a: 1}, v: -0, n: 5});
+    bulk.insert({_id: "array", k: [1, 2], v: NaN, n: [{k: "k2"}]});
+    assert.writeOK(bulk.execute());
+
+    var functions = [
+        {
+          map: function() {
+              emit(this.k, this.v);
+          },
+          reduce: function(key, values) {
+              return Array.sum(values);
+          }
+        },
+        {
+          map: function() {
+              emit(this.n.k, this.n.v);
+          },
+          reduce: function(key, values) {
+              var total = 0;
+              for (var i = 0; i < values.length; i++) {
+                  total += values[i];
+              }
+              return total;
+          }
+        },
+        {
+          map: function() {
+              emit(this.k, 1);
+          },
+          reduce: function(key, values) {
+              return Math.max.apply(Math, values);
+          }
+        },
+        {
+          map: function() {
+              emit(this.n.k, this.v);
+          },
+          reduce: function(key, values) {
+              return Math.min.apply(Math, values);
+          }
+        }
+    ];
+
+    function setNative(enabled) {
+        assert.commandWorked(
+            db.adminCommand({setParameter: 1, mapReduceUseNativeFunctions: enabled}));
+    }
+
+    function run(fns, out, finalize) {
+        var cmd = {mapReduce: coll.getName(), map: fns.map, reduce: fns.reduce, out: out};
+        if (finalize) {
+            cmd.finalize = finalize;
+        }
+        cmd.verbose = true;
+        return assert.commandWorked(db.runCommand(cmd));
+    }
+
+    function sorted(results) {
+        return results.sort(function(a, b) {
+            return tojson(a._id) < tojson(b._id) ? -1 : 1;
+        });
+    }
+
+    var outColl = db.mr_native_functions_out;
+    try {
+        functions.forEach(function(fns) {
+            [{inline: 1}, outColl.getName()].forEach(function(out) {
+                var finalizes = [
+                    null,
+                    function(key, value) {
+                        return {total: value};
+                    }
+                ];
+                finalizes.forEach(function(finalize) {
+                    setNative(false);
+                    var js = run(fns, out, finalize);
+                    var expected = js.results ? js.results : outColl.find().toArray();
+                    assert(!js.timing.nativeMap && !js.timing.nativeReduce, tojson(js));
+
+                    setNative(true);
+                    var natively = run(fns, out, finalize);
+                    var actual = natively.results ? natively.results : outColl.find().toArray();
+                    assert(natively.timing.nativeMap && natively.timing.nativeReduce,
+                           tojson(natively));
+
+                    assert.eq(sorted(expected), sorted(actual), tojson(fns));
+                    assert.eq(js.counts, natively.counts, tojson(fns));
+                });
+            });
+        });
+
+        // Reducing into an existing collection.
+        setNative(false);
+        run(functions[0], outColl.getName());
+        run(functions[0], {reduce: outColl.getName()});
+        var expected = outColl.find().toArray();
+        setNative(true);
+        run(functions[0], outColl.getName());
+        run(functions[0], {reduce: outColl.getName()});
+        assert.eq(sorted(expected), sorted(outColl.find().toArray()));
+
+        // Functions it does not recognize run in JavaScript.
+        var otherFunctions = {
+            map: function() {
+                emit(this.k, {v: this.v});
+            },
+            reduce: function(key, values) {
+                return values[0];
+            }
+        };
+        var other = run(otherFunctions, {inline: 1});
+        assert(!other.timing.nativeMap && !other.timing.nativeReduce, tojson(other));
+    } finally {
+        setNative(true);
+    }
+}());
@@ -0,0 +1,50 @@
+/**
+ * With internalQueryExecWriteBatchSize above 1, multi-updates and multi-deletes modify several
+ * documents per storage transaction. This test asserts that they still modify exactly the
+ * matching documents, and that an update error leaves the documents before it updated.
+ */
+(function() {
+    "use strict";
+    var coll = db.multi_write_batching;
+    coll.drop();
+
+    var res = db.adminCommand({getParameter: 1, internalQueryExecWriteBatchSize: 1});
+    assert.commandWorked(res);
+    var originalBatchSize = res.internalQueryExecWriteBatchSize;
+    assert.commandWorked(db.adminCommand({setParameter: 1, internalQueryExecWriteBatchSize: 7}));
+
+    try {
+        var bulk = coll.initializeUnorderedBulkOp();
+        for (var i = 0; i < 500; i++) {
+            bulk.insert({_id: i, a: i % 10, x: 0});
+        }
+        assert.writeOK(bulk.execute());
+        assert.commandWorked(coll.ensureIndex({a: 1}));
+
+        // An indexed field that moves documents forward in the index is only updated once.
+        res = coll.update({a: {$gte: 5}}, {$inc: {a: 10}}, {multi: true});
+        assert.eq(250, res.nMatched, tojson(res));
+        assert.eq(250, coll.count({a: {$gte: 15}}));
+
+        res = coll.update({}, {$set: {x: 1}}, {multi: true});
+        assert.eq(500, res.nModified, tojson(res));
+
+        res = coll.remove({a: {$lt: 3}});
+        assert.eq(150, res.nRemoved, tojson(res));
+        assert.eq(350, coll.count());
+        assert.eq(0, coll.count({a: {$lt: 3}}));
+
+        // An update that fails part way through still updates the documents before the failure.
+        coll.drop();
+        for (i = 0; i < 40; i++) {
+            assert.writeOK(coll.insert({_id: i, x: i === 25 ? "not a number" : 0}));
+        }
+        res = coll.update({}, {$inc: {x: 1}}, {multi: true});
+        assert.writeError(res);
+        assert.eq(25, coll.count({x: 1}));
+        assert.eq(14, coll.count({x: 0}));
+    } finally {
+        assert.commandWorked(db.adminCommand(
+            {setParameter: 1, internalQueryExecWriteBatchSize: originalBatchSize}));
+    }
+}());
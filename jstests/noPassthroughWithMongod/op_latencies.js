@@ -0,0 +1,42 @@
+// Test that operation latencies are reported by kind in serverStatus, by namespace in top and by
+// command in serverStatus metrics.
+(function() {
+    "use strict";
+
+    var coll = db.op_latencies;
+    coll.drop();
+
+    function opLatencies() {
+        return db.serverStatus({opLatencies: {histograms: true}}).opLatencies;
+    }
+
+    var before = opLatencies();
+    for (var i = 0; i < 10; i++) {
+        assert.writeOK(coll.insert({_id: i}));
+    }
+    assert.eq(10, coll.find().batchSize(3).itcount());
+    assert.eq(10, coll.count());
+
+    var after = opLatencies();
+    ["reads", "writes", "commands"].forEach(function(kind) {
+        var stats = after[kind];
+        assert.gt(stats.ops, before[kind].ops, kind + ": " + tojson(after));
+        assert.lte(stats.p50, stats.p95, tojson(stats));
+        assert.lte(stats.p95, stats.p99, tojson(stats));
+
+        var total = 0;
+        stats.histogram.forEach(function(bucket) {
+            total += bucket.count;
+        });
+        assert.eq(stats.ops, total, tojson(stats));
+    });
+    assert(!db.serverStatus().opLatencies.reads.hasOwnProperty("histogram"));
+
+    var top = assert.commandWorked(db.adminCommand({top: 1})).totals[coll.getFullName()];
+    assert.gte(top.latencyStats.writes.ops, 10, tojson(top));
+    assert.gte(top.latencyStats.reads.ops, 1, tojson(top));
+
+    var countStats = db.serverStatus().metrics.commands.count;
+    assert.gte(countStats.latency.ops, 1, tojson(countStats));
+    assert.gte(countStats.total, countStats.latency.ops, tojson(countStats));
+}());
@@ -0,0 +1,28 @@
+// Test that planning a query with several candidate indexes allocates the plan enumerator's memo
+// from the operation's arena, using far fewer blocks than allocations.
+(function() {
+    "use strict";
+    var coll = db.operation_arena;
+    coll.drop();
+    assert.writeOK(coll.insert({a: 1, b: 1, c: 1}));
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+    assert.commandWorked(coll.ensureIndex({b: 1}));
+    assert.commandWorked(coll.ensureIndex({c: 1}));
+
+    function arenaMetrics() {
+        return db.serverStatus().metrics.operationArena;
+    }
+
+    var before = arenaMetrics();
+    for (var i = 0; i < 20; i++) {
+        var query = {a: 1, b: 1, c: 1};
+        query["d" + i] = {$exists: false};
+        assert.eq(1, coll.find(query).itcount());
+    }
+    var after = arenaMetrics();
+
+    var allocations = after.allocations - before.allocations;
+    var blocks = after.blockAllocations - before.blockAllocations;
+    assert.gt(allocations, 0, tojson(after));
+    assert.lt(blocks, allocations, tojson(after));
+})();
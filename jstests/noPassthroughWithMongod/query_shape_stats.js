@@ -0,0 +1,58 @@
+// Test that sampled operations are aggregated by query shape and reported by queryShapeStats.
+(function() {
+    "use strict";
+
+    var coll = db.query_shape_stats;
+    coll.drop();
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+    for (var i = 0; i < 20; i++) {
+        assert.writeOK(coll.insert({_id: i, a: i, b: i % 2}));
+    }
+
+    function shapes() {
+        return assert.commandWorked(db.adminCommand(
+                                        {queryShapeStats: 1, ns: coll.getFullName()}))
+            .shapes;
+    }
+
+    assert.commandWorked(db.adminCommand({queryShapeStats: 1, reset: true}));
+    assert.eq([], shapes());
+
+    assert.commandWorked(db.adminCommand({setParameter: 1, queryShapeSampleEvery: 1}));
+    try {
+        for (var i = 0; i < 10; i++) {
+            assert.eq(1, coll.find({a: i}).itcount());
+            assert.eq(10, coll.find({b: i % 2}).itcount());
+        }
+        assert.writeOK(coll.update({a: 3}, {$set: {c: 1}}));
+    } finally {
+        assert.commandWorked(db.adminCommand({setParameter: 1, queryShapeSampleEvery: 0}));
+    }
+
+    var res = shapes();
+    var byPlan = {};
+    res.forEach(function(shape) {
+        assert.eq(coll.getFullName(), shape.ns, tojson(shape));
+        byPlan[shape.planSummary] = shape;
+    });
+
+    var indexed = byPlan["IXSCAN { a: 1.0 }"];
+    assert(indexed, tojson(res));
+    assert.gte(indexed.latencyStats.ops, 10, tojson(indexed));
+    assert.gte(indexed.keysExamined, 10, tojson(indexed));
+
+    var scanned = byPlan["COLLSCAN"];
+    assert(scanned, tojson(res));
+    assert.eq(10, scanned.latencyStats.ops, tojson(scanned));
+    assert.eq(200, scanned.docsExamined, tojson(scanned));
+    assert.eq(100, scanned.nreturned, tojson(scanned));
+
+    // Nothing is sampled once sampling is disabled.
+    coll.find({b: 1}).itcount();
+    assert.eq(10, shapes().filter(function(shape) {
+        return shape.planSummary === "COLLSCAN";
+    })[0].latencyStats.ops);
+
+    assert.commandFailed(db.adminCommand({setParameter: 1, queryShapeSampleRate: 2}));
+    assert.commandWorked(db.adminCommand({queryShapeStats: 1, reset: true}));
+}());
@@ -0,0 +1,37 @@
+// Test that resourceUsage accounts the operations run against a database, including the CPU time
+// and the bytes sent, and that the usage can be filtered and reset.
+(function() {
+    "use strict";
+
+    var coll = db.getSiblingDB("resource_usage").coll;
+    coll.drop();
+    assert.commandWorked(db.adminCommand({resourceUsage: 1, reset: true}));
+
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(coll.insert({_id: i, pad: new Array(100).join("x")}));
+    }
+    assert.eq(100, coll.find().itcount());
+
+    var res = assert.commandWorked(db.adminCommand({resourceUsage: 1, db: "resource_usage"}));
+    assert.eq(1, res.usage.length, tojson(res));
+    var usage = res.usage[0];
+    assert.eq("resource_usage", usage.db, tojson(res));
+    assert.gte(usage.ops, 101, tojson(res));
+    assert.gte(usage.cpuMicros, 0, tojson(res));
+    assert.gte(usage.latencyMicros, 0, tojson(res));
+    assert.gte(usage.docsExamined, 100, tojson(res));
+    assert.gt(usage.bytesSent, 100 * 100, tojson(res));
+    if (db.serverStatus().storageEngine.name === "wiredTiger") {
+        assert.gt(usage.bytesWritten, 100 * 100, tojson(res));
+        assert.gt(usage.bytesRead, 100 * 100, tojson(res));
+    }
+
+    res = assert.commandWorked(db.adminCommand({resourceUsage: 1, db: "resource_usage_none"}));
+    assert.eq([], res.usage, tojson(res));
+
+    assert.commandFailed(db.adminCommand({resourceUsage: 1, user: 1}));
+
+    assert.commandWorked(db.adminCommand({resourceUsage: 1, reset: true}));
+    res = assert.commandWorked(db.adminCommand({resourceUsage: 1, db: "resource_usage"}));
+    assert.eq([], res.usage, tojson(res));
+}());
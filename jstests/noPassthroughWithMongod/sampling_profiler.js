@@ -0,0 +1,39 @@
+// Test that the sampling profiler counts samples by stack and by operation once enabled with the
+// samplingProfilerHz parameter.
+(function() {
+    "use strict";
+    var admin = db.getSiblingDB("admin");
+
+    var res = assert.commandWorked(admin.runCommand({samplingProfile: 1, reset: true}));
+    if (!res.supported) {
+        print("Skipping sampling_profiler.js since this platform cannot sample stacks");
+        return;
+    }
+
+    assert.commandFailed(admin.runCommand({setParameter: 1, samplingProfilerHz: -1}));
+    assert.commandFailed(admin.runCommand({setParameter: 1, samplingProfilerHz: 100000}));
+
+    var coll = db.sampling_profiler;
+    coll.drop();
+    for (var i = 0; i < 1000; i++) {
+        assert.writeOK(coll.insert({x: i, s: "" + i}));
+    }
+
+    assert.commandWorked(admin.runCommand({setParameter: 1, samplingProfilerHz: 1000}));
+    try {
+        assert.soon(function() {
+            // Unindexed regular expression queries keep the server busy.
+            coll.find({s: /^9.*9$/}).itcount();
+            res = assert.commandWorked(admin.runCommand({samplingProfile: 1, top: 5}));
+            return res.stacks.length > 0 && res.ops.some(function(op) {
+                return op.op === "query" && op.ns === coll.getFullName();
+            });
+        }, "no samples of the queries", 60 * 1000, 10);
+
+        assert.lte(res.stacks.length, 5, tojson(res));
+        assert.gt(res.stacks[0].frames.length, 0, tojson(res));
+        assert.gte(res.samples, res.stacks[0].count, tojson(res));
+    } finally {
+        assert.commandWorked(admin.runCommand({setParameter: 1, samplingProfilerHz: 0}));
+    }
+}());
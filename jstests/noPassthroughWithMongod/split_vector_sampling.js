@@ -0,0 +1,72 @@
+// Test that splitVector estimates split points from a random sample of the chunk when
+// splitVectorSampleSize is set, and that the estimated points are ordered, distinct and inside the
+// requested range.
+(function() {
+    "use strict";
+
+    if (db.serverStatus().storageEngine.name !== "wiredTiger") {
+        print("Skipping split_vector_sampling.js since this storage engine cannot sample");
+        return;
+    }
+
+    var coll = db.split_vector_sampling;
+    coll.drop();
+    assert.commandWorked(coll.ensureIndex({x: 1}));
+
+    var numDocs = 20000;
+    var pad = new Array(100).join("x");
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        bulk.insert({x: i, pad: pad});
+    }
+    assert.writeOK(bulk.execute());
+
+    var avgObjSize = coll.stats().avgObjSize;
+    var chunkDocs = 2000;
+    function splitVector(min, max) {
+        var cmd = {
+            splitVector: coll.getFullName(),
+            keyPattern: {x: 1},
+            maxChunkSizeBytes: 2 * chunkDocs * avgObjSize
+        };
+        if (min) {
+            cmd.min = min;
+            cmd.max = max;
+        }
+        return assert.commandWorked(db.runCommand(cmd));
+    }
+
+    function checkSplitKeys(res, min, max, expectedNumKeys) {
+        var keys = res.splitKeys;
+        assert(Math.abs(keys.length - expectedNumKeys) <= expectedNumKeys / 2, tojson(res));
+        for (var i = 0; i < keys.length; i++) {
+            assert.gt(keys[i].x, min, tojson(res));
+            assert.lt(keys[i].x, max, tojson(res));
+            if (i > 0) {
+                assert.lt(keys[i - 1].x, keys[i].x, tojson(res));
+            }
+        }
+    }
+
+    var exact = splitVector();
+    assert(!exact.sampled, tojson(exact));
+
+    assert.commandWorked(db.adminCommand({setParameter: 1, splitVectorSampleSize: 1000}));
+    try {
+        var sampled = splitVector();
+        assert(sampled.sampled, tojson(sampled));
+        checkSplitKeys(sampled, -1, numDocs, exact.splitKeys.length);
+
+        // Half of the documents sampled from the whole collection fall in this chunk.
+        var sampledRange = splitVector({x: 5000}, {x: 15000});
+        assert(sampledRange.sampled, tojson(sampledRange));
+        checkSplitKeys(sampledRange, 5000, 15000, exact.splitKeys.length / 2);
+
+        // Too few of the sampled documents fall in a tiny chunk, so the index is scanned.
+        var smallRange = splitVector({x: 100}, {x: 102});
+        assert(!smallRange.sampled, tojson(smallRange));
+        assert.eq([], smallRange.splitKeys, tojson(smallRange));
+    } finally {
+        assert.commandWorked(db.adminCommand({setParameter: 1, splitVectorSampleSize: 0}));
+    }
+}());
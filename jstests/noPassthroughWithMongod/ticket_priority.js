@@ -0,0 +1,43 @@
+/**
+ * Commands accept a $priority option, which sets the priority with which the operation queues for
+ * storage engine tickets. This test asserts that the option is validated and that WiredTiger
+ * reports the depth of its ticket queues per priority.
+ */
+(function() {
+    "use strict";
+    var coll = db.ticket_priority;
+    coll.drop();
+    assert.writeOK(coll.insert({_id: 0}));
+
+    ["low", "normal", "high"].forEach(function(priority) {
+        var res = db.runCommand({find: coll.getName(), filter: {}, $priority: priority});
+        assert.commandWorked(res);
+        assert.eq([{_id: 0}], res.cursor.firstBatch, tojson(res));
+        assert.commandWorked(db.runCommand({count: coll.getName(), $priority: priority}));
+    });
+
+    assert.commandFailedWithCode(db.runCommand({count: coll.getName(), $priority: "urgent"}),
+                                 ErrorCodes.InvalidOptions);
+    assert.commandFailedWithCode(db.runCommand({count: coll.getName(), $priority: 1}),
+                                 ErrorCodes.InvalidOptions);
+
+    var serverStatus = db.serverStatus();
+    if (serverStatus.storageEngine.name !== "wiredTiger") {
+        return;
+    }
+
+    ["read", "write"].forEach(function(pool) {
+        var queueDepth = serverStatus.wiredTiger.concurrentTransactions[pool].queueDepth;
+        assert.eq(["low", "normal", "high"], Object.keys(queueDepth), tojson(queueDepth));
+    });
+
+    var original = assert.commandWorked(
+        db.adminCommand({getParameter: 1, wiredTigerLowPriorityTicketsAfterMillis: 1}));
+    assert.commandWorked(
+        db.adminCommand({setParameter: 1, wiredTigerLowPriorityTicketsAfterMillis: 100}));
+    assert.eq(1, coll.find().itcount());
+    assert.commandWorked(db.adminCommand({
+        setParameter: 1,
+        wiredTigerLowPriorityTicketsAfterMillis: original.wiredTigerLowPriorityTicketsAfterMillis
+    }));
+}());
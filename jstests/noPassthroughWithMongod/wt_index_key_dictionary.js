@@ -0,0 +1,64 @@
+/**
+ * A WiredTiger index created with a keyDictionary encodes the listed strings of a key field as
+ * single bytes. This test asserts that queries over the index return the same results, in the
+ * same order, as over an index without a dictionary, including covered queries that decode keys.
+ */
+(function() {
+    "use strict";
+
+    if (db.serverStatus().storageEngine.name !== "wiredTiger") {
+        print("Skipping wt_index_key_dictionary.js since this server does not use WiredTiger");
+        return;
+    }
+
+    var plain = db.wt_index_key_dictionary_plain;
+    var coded = db.wt_index_key_dictionary_coded;
+    plain.drop();
+    coded.drop();
+
+    var statuses = ["active", "deleted", "pending", "archived", "", "zzz", 5, null, ["active", 1]];
+    for (var i = 0; i < 200; i++) {
+        var doc = {_id: i, status: statuses[i % statuses.length], n: i % 7};
+        assert.writeOK(plain.insert(doc));
+        assert.writeOK(coded.insert(doc));
+    }
+
+    assert.commandWorked(plain.ensureIndex({status: 1, n: -1}));
+    assert.commandWorked(coded.ensureIndex(
+        {status: 1, n: -1},
+        {storageEngine: {wiredTiger: {keyDictionary: {status: ["pending", "active", "deleted"]}}}}));
+
+    var queries = [
+        {},
+        {status: "active"},
+        {status: {$gt: "active"}},
+        {status: {$gte: "b", $lt: "pending"}},
+        {status: {$in: ["deleted", "zzz", 5]}},
+        {status: "active", n: {$lte: 3}},
+    ];
+    queries.forEach(function(query) {
+        [1, -1].forEach(function(dir) {
+            var sort = {status: dir, n: -dir};
+            var projection = {_id: 0, status: 1, n: 1};
+            var expected =
+                plain.find(query, projection).sort(sort).hint({status: 1, n: -1}).toArray();
+            var actual =
+                coded.find(query, projection).sort(sort).hint({status: 1, n: -1}).toArray();
+            assert.eq(expected, actual, tojson(query));
+        });
+    });
+
+    // Removing and updating documents removes their old keys.
+    assert.writeOK(plain.remove({status: "deleted"}));
+    assert.writeOK(coded.remove({status: "deleted"}));
+    assert.writeOK(plain.update({status: "pending"}, {$set: {status: "active"}}, {multi: true}));
+    assert.writeOK(coded.update({status: "pending"}, {$set: {status: "active"}}, {multi: true}));
+    assert.eq(plain.find({status: "active"}, {_id: 0, status: 1}).toArray(),
+              coded.find({status: "active"}, {_id: 0, status: 1}).toArray());
+    assert.eq(0, coded.find({status: {$in: ["deleted", "pending"]}}).itcount());
+    assert(coded.validate(true).valid);
+
+    // The dictionary must only name fields of the key pattern.
+    assert.commandFailed(coded.ensureIndex(
+        {n: 1}, {storageEngine: {wiredTiger: {keyDictionary: {status: ["active"]}}}}));
+}());
@@ -0,0 +1,43 @@
+// Test that a secondary which applies runs of inserts with one batched insert ends up with the
+// same data as the primary, including for a capped collection, whose ops are not split across
+// writers.
+(function() {
+    "use strict";
+    var name = "group_inserts";
+    var replTest = new ReplSetTest({name: name, nodes: 2});
+    replTest.startSet();
+    replTest.initiate();
+
+    var master = replTest.getMaster();
+    var testDB = master.getDB("test");
+    assert.commandWorked(testDB.runCommand({create: "capped", capped: true, size: 64 * 1024}));
+    assert.commandWorked(testDB.coll.ensureIndex({a: 1}));
+
+    var id = 0;
+    for (var round = 0; round < 5; round++) {
+        var bulk = testDB.coll.initializeOrderedBulkOp();
+        var cappedBulk = testDB.capped.initializeOrderedBulkOp();
+        for (var i = 0; i < 500; i++) {
+            bulk.insert({_id: id, a: round, pad: new Array(100).join("x")});
+            cappedBulk.insert({_id: id, round: round});
+            id++;
+        }
+        bulk.find({a: round}).update({$set: {b: 1}});
+        assert.writeOK(bulk.execute());
+        assert.writeOK(cappedBulk.execute());
+        assert.writeOK(testDB.coll.remove({_id: {$lt: 10 * round}}));
+    }
+    replTest.awaitReplication();
+
+    var slave = replTest.liveNodes.slaves[0];
+    slave.setSlaveOk();
+    assert.eq(testDB.runCommand({dbhash: 1}).md5, slave.getDB("test").runCommand({dbhash: 1}).md5);
+    assert.eq(testDB.capped.find().sort({$natural: 1}).toArray(),
+              slave.getDB("test").capped.find().sort({$natural: 1}).toArray());
+
+    var applyMetrics = slave.getDB("admin").serverStatus().metrics.repl.apply;
+    assert.gt(applyMetrics.insertGroups, 0, tojson(applyMetrics));
+    assert.gte(applyMetrics.groupedInserts, 2 * applyMetrics.insertGroups, tojson(applyMetrics));
+
+    replTest.stopSet();
+}());
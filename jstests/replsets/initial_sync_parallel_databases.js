@@ -0,0 +1,43 @@
+// Test that a node which clones several databases at once during initial sync ends up with the
+// same data and indexes as the primary.
+(function() {
+    "use strict";
+    var name = "initial_sync_parallel_databases";
+    var replTest = new ReplSetTest({name: name, nodes: 1});
+    replTest.startSet();
+    replTest.initiate();
+
+    var master = replTest.getMaster();
+    var dbNames = ["admin"];
+    for (var d = 0; d < 6; d++) {
+        var dbName = name + d;
+        dbNames.push(dbName);
+        var testDB = master.getDB(dbName);
+        for (var c = 0; c < 3; c++) {
+            var bulk = testDB["coll" + c].initializeUnorderedBulkOp();
+            for (var i = 0; i < 200; i++) {
+                bulk.insert({_id: i, a: i % 10, db: d});
+            }
+            assert.writeOK(bulk.execute());
+            assert.commandWorked(testDB["coll" + c].ensureIndex({a: 1}));
+        }
+    }
+    assert.writeOK(master.getDB("admin").foo.insert({x: 1}));
+
+    var slave = replTest.add({setParameter: "initialSyncDatabaseCloners=4"});
+    replTest.reInitiate();
+    replTest.awaitSecondaryNodes();
+    replTest.awaitReplication();
+
+    slave.setSlaveOk();
+    dbNames.forEach(function(dbName) {
+        assert.eq(master.getDB(dbName).runCommand({dbhash: 1}).md5,
+                  slave.getDB(dbName).runCommand({dbhash: 1}).md5,
+                  dbName);
+        if (dbName !== "admin") {
+            assert.eq(2, slave.getDB(dbName).coll0.getIndexes().length, dbName);
+        }
+    });
+
+    replTest.stopSet();
+}());
@@ -0,0 +1,41 @@
+// Test that a secondary reports the latencies of the phases of the oplog batches it applies and of
+// their ops in serverStatus.repl.apply, and logs the ops which are slower than slowms to apply.
+(function() {
+    "use strict";
+    var replTest = new ReplSetTest({name: "oplog_applier_stats", nodes: 2});
+    replTest.startSet();
+    replTest.initiate();
+
+    var master = replTest.getMaster();
+    var slave = replTest.liveNodes.slaves[0];
+    var coll = master.getDB("test").oplog_applier_stats;
+
+    // Every op is slow with a negative threshold.
+    assert.commandWorked(slave.getDB("test").runCommand({profile: 0, slowms: -1}));
+
+    assert.writeOK(coll.insert({_id: 0}, {writeConcern: {w: 2}}));
+    assert.writeOK(coll.update({_id: 0}, {$set: {a: 1}}, {writeConcern: {w: 2}}));
+
+    var apply = slave.getDB("admin").serverStatus({repl: {histograms: true}}).repl.apply;
+    ["fetch", "partition", "apply", "oplogWrite"].forEach(function(phase) {
+        assert.gt(apply.phases[phase].ops, 0, tojson(apply));
+    });
+    assert.gt(apply.writers.ops, 0, tojson(apply));
+    assert.gte(apply.ops.ops, 2, tojson(apply));
+    assert.eq(apply.ops.ops,
+              apply.ops.histogram.reduce(function(total, bucket) {
+                  return total + bucket.count;
+              }, 0),
+              tojson(apply));
+    assert.gte(apply.slowOps, 2, tojson(apply));
+
+    var log = slave.adminCommand({getLog: "global"}).log;
+    assert(log.some(function(line) {
+        return line.indexOf("applied op: i ns: test.oplog_applier_stats _id: 0") >= 0;
+    }), tojson(log));
+    assert(log.some(function(line) {
+        return line.indexOf("applied op: u ns: test.oplog_applier_stats o2: { _id: 0 }") >= 0;
+    }), tojson(log));
+
+    replTest.stopSet();
+}());
@@ -0,0 +1,38 @@
+// Test that a secondary which writes each oplog batch while applying it ends up with the same
+// data and oplog as the primary.
+(function() {
+    "use strict";
+    var name = "pipeline_oplog_writes";
+    var replTest = new ReplSetTest(
+        {name: name, nodes: 2, nodeOptions: {setParameter: "replPipelineOplogWrites=true"}});
+    replTest.startSet();
+    replTest.initiate();
+
+    var master = replTest.getMaster();
+    var coll = master.getDB("test").coll;
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+
+    for (var round = 0; round < 5; round++) {
+        var bulk = coll.initializeUnorderedBulkOp();
+        for (var i = 0; i < 500; i++) {
+            bulk.find({_id: i}).upsert().updateOne({$inc: {a: 1}, $set: {round: round}});
+        }
+        assert.writeOK(bulk.execute());
+        assert.writeOK(coll.remove({_id: {$gte: 490 - round}}));
+        // A command ends a batch and is applied without pipelining.
+        assert.commandWorked(master.getDB("test").runCommand({create: "other" + round}));
+    }
+    replTest.awaitReplication();
+
+    var slave = replTest.liveNodes.slaves[0];
+    slave.setSlaveOk();
+    assert.eq(master.getDB("test").runCommand({dbhash: 1}).md5,
+              slave.getDB("test").runCommand({dbhash: 1}).md5);
+
+    var masterOplog = master.getDB("local").oplog.rs;
+    var slaveOplog = slave.getDB("local").oplog.rs;
+    assert.eq(masterOplog.find().sort({$natural: -1}).limit(1).next(),
+              slaveOplog.find().sort({$natural: -1}).limit(1).next());
+
+    replTest.stopSet();
+}());
@@ -0,0 +1,37 @@
+// Test that the oplog application prefetch phase can be enabled for every storage engine and that
+// a secondary applying prefetched batches ends up with the same data as the primary.
+(function() {
+    "use strict";
+    var name = "prefetch_all_storage_engines";
+    var replTest = new ReplSetTest(
+        {name: name, nodes: 2, nodeOptions: {setParameter: "replPrefetchAllStorageEngines=true"}});
+    replTest.startSet();
+    replTest.initiate();
+
+    var master = replTest.getMaster();
+    var coll = master.getDB("test").prefetch;
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+    assert.commandWorked(coll.ensureIndex({b: 1, c: 1}));
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, a: i % 10, b: i, c: [i, i + 1]});
+    }
+    assert.writeOK(bulk.execute());
+    assert.writeOK(coll.update({a: {$lt: 5}}, {$inc: {b: 1}, $set: {c: "x"}}, {multi: true}));
+    assert.writeOK(coll.remove({a: 9}));
+    replTest.awaitReplication();
+
+    var slave = replTest.liveNodes.slaves[0];
+    slave.setSlaveOk();
+    var slaveColl = slave.getDB("test").prefetch;
+    assert.eq(coll.find().sort({_id: 1}).toArray(), slaveColl.find().sort({_id: 1}).toArray());
+    assert.eq(coll.find({b: {$gt: 500}}, {_id: 0, b: 1}).hint({b: 1, c: 1}).itcount(),
+              slaveColl.find({b: {$gt: 500}}, {_id: 0, b: 1}).hint({b: 1, c: 1}).itcount());
+
+    var preload = slave.getDB("admin").serverStatus().metrics.repl.preload;
+    assert.gt(preload.docs.num, 0, tojson(preload));
+    assert.gt(preload.indexes.num, 0, tojson(preload));
+
+    replTest.stopSet();
+}());
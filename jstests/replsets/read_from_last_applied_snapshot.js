@@ -0,0 +1,56 @@
+// Test that a secondary started with readFromLastAppliedSnapshotOnSecondaries serves reads from the
+// snapshot of its last applied oplog batch, including for collections and indexes that are newer
+// than that snapshot.
+(function() {
+    "use strict";
+    var name = "read_from_last_applied_snapshot";
+    var replTest = new ReplSetTest({
+        name: name,
+        nodes: 2,
+        nodeOptions: {setParameter: "readFromLastAppliedSnapshotOnSecondaries=true"}
+    });
+    replTest.startSet();
+    replTest.initiate();
+
+    var master = replTest.getMaster();
+    if (master.getDB("admin").serverStatus().storageEngine.name !== "wiredTiger") {
+        print("Skipping " + name + " since this server does not use WiredTiger");
+        replTest.stopSet();
+        return;
+    }
+
+    var slave = replTest.liveNodes.slaves[0];
+    slave.setSlaveOk();
+    var slaveDB = slave.getDB("test");
+
+    for (var batch = 0; batch < 10; batch++) {
+        var bulk = master.getDB("test").coll.initializeUnorderedBulkOp();
+        for (var i = 0; i < 100; i++) {
+            bulk.insert({_id: batch * 100 + i, batch: batch});
+        }
+        assert.writeOK(bulk.execute({w: 2}));
+
+        // The named snapshot of the batch is taken shortly after the batch is applied.
+        assert.soon(function() {
+            return slaveDB.coll.find({batch: batch}).itcount() == 100;
+        });
+    }
+
+    // A collection created after the last snapshot is readable, from the latest data if need be.
+    assert.writeOK(master.getDB("test").newColl.insert({_id: 1}, {writeConcern: {w: 2}}));
+    assert.eq([{_id: 1}], slaveDB.newColl.find().toArray());
+
+    assert.commandWorked(master.getDB("test").coll.ensureIndex({batch: 1}));
+    replTest.awaitReplication();
+    assert.soon(function() {
+        // The index is hidden from reads on a snapshot that predates it.
+        try {
+            return slaveDB.coll.find({batch: 3}).hint({batch: 1}).itcount() == 100;
+        } catch (e) {
+            return false;
+        }
+    });
+    assert.eq(1000, slaveDB.coll.find().itcount());
+
+    replTest.stopSet();
+}());
@@ -0,0 +1,30 @@
+// Test that a set whose secondaries coalesce their position updates still satisfies write concern,
+// with a non-voting member in the set, and that heartbeat processing is reported in serverStatus.
+(function() {
+    "use strict";
+    var name = "update_position_interval";
+    var replTest = new ReplSetTest({
+        name: name,
+        nodes: 3,
+        nodeOptions: {setParameter: "replUpdatePositionMinIntervalMillis=200"}
+    });
+    var nodes = replTest.startSet();
+    var config = replTest.getReplSetConfig();
+    config.members[2].votes = 0;
+    config.members[2].priority = 0;
+    replTest.initiate(config);
+
+    var master = replTest.getMaster();
+    var testDB = master.getDB("test");
+    for (var i = 0; i < 20; i++) {
+        assert.writeOK(testDB.coll.insert({_id: i}, {writeConcern: {w: 3, wtimeout: 60 * 1000}}));
+    }
+
+    nodes.forEach(function(node) {
+        var heartbeats = node.getDB("admin").serverStatus().metrics.repl.heartbeats;
+        assert.gt(heartbeats.responses, 0, tojson(heartbeats));
+        assert.gte(heartbeats.processingMicros, 0, tojson(heartbeats));
+    });
+
+    replTest.stopSet();
+}());
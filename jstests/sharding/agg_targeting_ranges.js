@@ -0,0 +1,61 @@
+// Test that an aggregation whose first $match selects several shard key ranges is only sent to the
+// shards owning them, and is not split when they all live on the same shard.
+(function() {
+    "use strict";
+    var st = new ShardingTest({shards: 2, mongos: 1, other: {mongosOptions: {noAutoSplit: ""}}});
+    st.stopBalancer();
+
+    var admin = st.s0.getDB("admin");
+    var coll = st.s0.getCollection("test.agg_targeting_ranges");
+    assert.commandWorked(admin.runCommand({enableSharding: coll.getDB() + ""}));
+    st.ensurePrimaryShard(coll.getDB() + "", "shard0000");
+    assert.commandWorked(admin.runCommand({shardCollection: coll + "", key: {x: 1}}));
+
+    // shard0000 owns [MinKey, 10) and [20, 30), shard0001 owns [10, 20) and [30, MaxKey).
+    [10, 20, 30].forEach(function(x) {
+        assert.commandWorked(admin.runCommand({split: coll + "", middle: {x: x}}));
+    });
+    [10, 30].forEach(function(x) {
+        assert.commandWorked(
+            admin.runCommand({moveChunk: coll + "", find: {x: x}, to: "shard0001"}));
+    });
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 40; i++) {
+        bulk.insert({x: i});
+    }
+    assert.writeOK(bulk.execute());
+
+    function explain(match) {
+        return assert.commandWorked(coll.getDB().runCommand(
+            {aggregate: coll.getName(), pipeline: [{$match: match}], explain: true}));
+    }
+
+    function count(match) {
+        return coll.aggregate([{$match: match}, {$group: {_id: null, n: {$sum: 1}}}])
+            .toArray()[0]
+            .n;
+    }
+
+    // Two ranges, both on shard0000: the whole pipeline runs there.
+    var twoRangesOneShard = {$or: [{x: {$gte: 2, $lt: 5}}, {x: {$gte: 22, $lt: 25}}]};
+    var res = explain(twoRangesOneShard);
+    assert.eq(null, res.splitPipeline, tojson(res));
+    assert.eq(["shard0000"], Object.keys(res.shards), tojson(res));
+    assert.eq(6, count(twoRangesOneShard));
+
+    var inOneShard = {x: {$in: [1, 25, 3]}};
+    res = explain(inOneShard);
+    assert.eq(null, res.splitPipeline, tojson(res));
+    assert.eq(3, count(inOneShard));
+
+    // Ranges on both shards: the pipeline is split and merged.
+    var twoShards = {x: {$in: [5, 15, 35]}};
+    res = explain(twoShards);
+    assert.neq(null, res.splitPipeline, tojson(res));
+    assert.eq(2, Object.keys(res.shards).length, tojson(res));
+    assert.eq(3, count(twoShards));
+    assert.eq(40, coll.aggregate([{$match: {}}]).itcount());
+
+    st.stop();
+}());
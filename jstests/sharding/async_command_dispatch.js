@@ -0,0 +1,42 @@
+// Test that count, distinct and aggregate on a sharded collection return the same results when
+// they are sent to all shards at once through the task executor, including after another mongos
+// moved a chunk and the first one has to retarget on a stale shard version.
+(function() {
+    "use strict";
+    var st = new ShardingTest({shards: 2, mongos: 2, other: {mongosOptions: {noAutoSplit: ""}}});
+    st.stopBalancer();
+
+    var mongos = st.s0;
+    var admin = mongos.getDB("admin");
+    var coll = mongos.getCollection("test.async_command_dispatch");
+    assert.commandWorked(admin.runCommand({enableSharding: coll.getDB() + ""}));
+    st.ensurePrimaryShard(coll.getDB() + "", "shard0000");
+    assert.commandWorked(admin.runCommand({shardCollection: coll + "", key: {_id: 1}}));
+    assert.commandWorked(admin.runCommand({split: coll + "", middle: {_id: 50}}));
+    assert.commandWorked(
+        admin.runCommand({moveChunk: coll + "", find: {_id: 50}, to: "shard0001"}));
+
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(coll.insert({_id: i, tag: i % 3}));
+    }
+
+    function runCommands() {
+        return {
+            count: coll.count({tag: 1}),
+            distinct: coll.distinct("tag").sort(),
+            aggregate: coll.aggregate([{$group: {_id: "$tag", n: {$sum: 1}}}, {$sort: {_id: 1}}])
+                           .toArray()
+        };
+    }
+
+    var expected = runCommands();
+    assert.commandWorked(admin.runCommand({setParameter: 1, useAsyncCommandDispatch: true}));
+    assert.eq(expected, runCommands());
+
+    // Move a chunk through the other mongos, so the first one has a stale routing table.
+    assert.commandWorked(st.s1.getDB("admin").runCommand(
+        {moveChunk: coll + "", find: {_id: 0}, to: "shard0001"}));
+    assert.eq(expected, runCommands());
+
+    st.stop();
+}());
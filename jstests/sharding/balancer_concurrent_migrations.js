@@ -0,0 +1,51 @@
+// Test that with balancerMaxConcurrentMigrations set, a balancing round plans several moves for a
+// collection with no shard in two of them, runs them together and reports it in config.actionlog.
+(function() {
+    "use strict";
+    var st = new ShardingTest({shards: 4, mongos: 1, other: {mongosOptions: {noAutoSplit: ""}}});
+    st.stopBalancer();
+
+    var admin = st.s0.getDB("admin");
+    var config = st.s0.getDB("config");
+    var coll = st.s0.getCollection("test.balancer_concurrent_migrations");
+    assert.commandWorked(admin.runCommand({enableSharding: coll.getDB() + ""}));
+    st.ensurePrimaryShard(coll.getDB() + "", "shard0000");
+    assert.commandWorked(admin.runCommand({shardCollection: coll + "", key: {_id: 1}}));
+
+    // Two donors with 10 chunks each and two empty shards.
+    for (var i = 0; i < 20; i++) {
+        assert.writeOK(coll.insert({_id: i}));
+        assert.commandWorked(admin.runCommand({split: coll + "", middle: {_id: i}}));
+    }
+    for (var i = 10; i < 20; i++) {
+        assert.commandWorked(
+            admin.runCommand({moveChunk: coll + "", find: {_id: i}, to: "shard0001"}));
+    }
+
+    assert.commandWorked(admin.runCommand({setParameter: 1, balancerMaxConcurrentMigrations: 2}));
+
+    var res = assert.commandWorked(admin.runCommand({balancerDryRun: 1}));
+    var shards = {};
+    res.moves.forEach(function(move) {
+        assert.eq(coll + "", move.ns, tojson(res));
+        assert(!shards[move.from] && !shards[move.to], tojson(res));
+        shards[move.from] = shards[move.to] = true;
+    });
+    assert.eq(2, res.moves.length, tojson(res));
+
+    st.startBalancer();
+    assert.soon(function() {
+        return config.actionlog.findOne({
+            what: "balancer.round",
+            "details.chunksMoved": 2,
+            "details.migrationWaves": 1
+        }) != null;
+    }, "no balancing round moved two chunks in one wave", 5 * 60 * 1000);
+    st.stopBalancer();
+
+    var round = config.actionlog.findOne({what: "balancer.round", "details.migrationWaves": 1});
+    assert.gte(round.details.executionTimeMillis, round.details.migrationTimeMillis, tojson(round));
+    assert.eq(20, coll.find().itcount());
+
+    st.stop();
+}());
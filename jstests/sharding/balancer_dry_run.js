@@ -0,0 +1,41 @@
+// Test that balancerDryRun reports the migration the balancer would start for an unbalanced
+// collection, under both balancing policies, without moving anything.
+(function() {
+    "use strict";
+    var st = new ShardingTest({shards: 2, mongos: 1, other: {mongosOptions: {noAutoSplit: ""}}});
+    st.stopBalancer();
+
+    var admin = st.s0.getDB("admin");
+    var coll = st.s0.getCollection("test.balancer_dry_run");
+    assert.commandWorked(admin.runCommand({enableSharding: coll.getDB() + ""}));
+    st.ensurePrimaryShard(coll.getDB() + "", "shard0000");
+    assert.commandWorked(admin.runCommand({shardCollection: coll + "", key: {_id: 1}}));
+
+    var pad = new Array(64 * 1024).join("x");
+    for (var i = 0; i < 20; i++) {
+        assert.writeOK(coll.insert({_id: i, pad: pad}));
+        assert.commandWorked(admin.runCommand({split: coll + "", middle: {_id: i}}));
+    }
+
+    function plannedMove(policy) {
+        var res = assert.commandWorked(admin.runCommand({balancerDryRun: 1}));
+        assert.eq(policy, res.policy, tojson(res));
+        var moves = res.moves.filter(function(move) {
+            return move.ns == coll + "";
+        });
+        assert.eq(1, moves.length, tojson(res));
+        assert.eq("shard0000", moves[0].from, tojson(res));
+        assert.eq("shard0001", moves[0].to, tojson(res));
+    }
+
+    plannedMove("chunkCount");
+
+    assert.commandWorked(admin.runCommand({setParameter: 1, balancerLoadAware: true}));
+    plannedMove("load");
+    assert.commandWorked(admin.runCommand({setParameter: 1, balancerLoadAware: false}));
+
+    var config = st.s0.getDB("config");
+    assert.eq(0, config.chunks.count({ns: coll + "", shard: "shard0001"}));
+
+    st.stop();
+}());
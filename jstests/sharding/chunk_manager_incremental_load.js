@@ -0,0 +1,29 @@
+// Test that mongos reloads its routing table from the previous one after a split, copying the
+// unchanged chunks and reading only the split ones from the config server.
+(function() {
+    "use strict";
+    var st = new ShardingTest({shards: 1, mongos: 1, other: {mongosOptions: {noAutoSplit: ""}}});
+    st.stopBalancer();
+
+    var admin = st.s0.getDB("admin");
+    var coll = st.s0.getCollection("test.chunk_manager_incremental_load");
+    assert.commandWorked(admin.runCommand({enableSharding: coll.getDB() + ""}));
+    assert.commandWorked(admin.runCommand({shardCollection: coll + "", key: {_id: 1}}));
+    for (var i = 0; i < 20; i++) {
+        assert.commandWorked(admin.runCommand({split: coll + "", middle: {_id: i * 10}}));
+    }
+
+    var before = admin.serverStatus().metrics.chunkManager;
+    assert.commandWorked(admin.runCommand({split: coll + "", middle: {_id: 5}}));
+    assert.writeOK(coll.insert({_id: 5}));
+    var after = admin.serverStatus().metrics.chunkManager;
+
+    assert.gt(after.loads, before.loads, tojson(after));
+    assert.gte(after.loadMillis, before.loadMillis, tojson(after));
+    assert.gte(after.chunksCopied - before.chunksCopied, 19, tojson(after));
+    assert.lte(after.chunksLoaded - before.chunksLoaded, 3 * (after.loads - before.loads),
+               tojson(after));
+    assert.eq(1, coll.find({_id: 5}).itcount());
+
+    st.stop();
+}());
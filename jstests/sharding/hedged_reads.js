@@ -0,0 +1,43 @@
+// Test that finds with a read preference which may use any secondary return the same results when
+// mongos hedges them to a second member of each shard, and that hedges are reported in
+// serverStatus.
+(function() {
+    "use strict";
+    var st = new ShardingTest({
+        shards: {rs0: {nodes: 3}, rs1: {nodes: 3}},
+        mongos: 1,
+        other: {mongosOptions: {noAutoSplit: ""}}
+    });
+    st.stopBalancer();
+
+    var admin = st.s0.getDB("admin");
+    var coll = st.s0.getCollection("test.hedged_reads");
+    assert.commandWorked(admin.runCommand({enableSharding: coll.getDB() + ""}));
+    st.ensurePrimaryShard(coll.getDB() + "", "test-rs0");
+    assert.commandWorked(admin.runCommand({shardCollection: coll + "", key: {_id: 1}}));
+    assert.commandWorked(admin.runCommand({split: coll + "", middle: {_id: 50}}));
+    assert.commandWorked(
+        admin.runCommand({moveChunk: coll + "", find: {_id: 50}, to: "test-rs1"}));
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 100; i++) {
+        bulk.insert({_id: i});
+    }
+    assert.writeOK(bulk.execute({w: 3}));
+
+    assert.commandWorked(admin.runCommand(
+        {setParameter: 1, useClusterClientCursor: true, readHedgingDelayMillis: 1}));
+
+    ["secondaryPreferred", "nearest", "secondary"].forEach(function(mode) {
+        for (var i = 0; i < 10; i++) {
+            assert.eq(100, coll.find().readPref(mode).batchSize(7).itcount(), mode);
+            assert.eq([{_id: 42}], coll.find({_id: 42}).readPref(mode).toArray(), mode);
+        }
+    });
+
+    var merger = admin.serverStatus().metrics.cursor.merger;
+    assert.gte(merger.hedgesIssued, merger.hedgesWon, tojson(merger));
+
+    assert.commandWorked(admin.runCommand({setParameter: 1, readHedgingDelayMillis: 0}));
+    st.stop();
+}());
@@ -0,0 +1,41 @@
+// Test that a chunk cloned in several batches, with the next batch fetched while the current one is
+// inserted in small groups, arrives complete and is reported in the recipient's serverStatus.
+(function() {
+    "use strict";
+    var st = new ShardingTest({shards: 2, mongos: 1, other: {mongosOptions: {noAutoSplit: ""}}});
+    st.stopBalancer();
+
+    var admin = st.s0.getDB("admin");
+    var coll = st.s0.getCollection("test.migration_clone_batching");
+    assert.commandWorked(admin.runCommand({enableSharding: coll.getDB() + ""}));
+    st.ensurePrimaryShard(coll.getDB() + "", "shard0000");
+    assert.commandWorked(admin.runCommand({shardCollection: coll + "", key: {_id: 1}}));
+
+    // Enough data for the donor to send it in more than one _migrateClone batch.
+    var pad = new Array(10 * 1024).join("x");
+    var numDocs = 3000;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        bulk.insert({_id: i, pad: pad});
+    }
+    assert.writeOK(bulk.execute());
+
+    var recipient = st.shard1.getDB("admin");
+    assert.commandWorked(recipient.runCommand(
+        {setParameter: 1, migrateCloneFetchAhead: true, migrateCloneInsertBatchSize: 7}));
+    var before = recipient.serverStatus().metrics.migration;
+
+    assert.commandWorked(admin.runCommand(
+        {moveChunk: coll + "", find: {_id: 0}, to: "shard0001", _waitForDelete: true}));
+
+    var after = recipient.serverStatus().metrics.migration;
+    assert.eq(numDocs, after.clonedDocs - before.clonedDocs, tojson(after));
+    assert.gt(after.clonedBytes - before.clonedBytes, numDocs * pad.length, tojson(after));
+    assert.gte(after.cloneMillis, before.cloneMillis, tojson(after));
+
+    assert.eq(numDocs, coll.find().itcount());
+    assert.eq(numDocs, st.shard1.getCollection(coll + "").count());
+    assert.eq(0, st.shard0.getCollection(coll + "").count());
+
+    st.stop();
+}());
@@ -0,0 +1,41 @@
+// Test that the donor of a migration deletes the moved range in batches of rangeDeleterBatchSize
+// documents and reports the batches and the deleted range in its serverStatus.
+(function() {
+    "use strict";
+    var st = new ShardingTest({shards: 2, mongos: 1, other: {mongosOptions: {noAutoSplit: ""}}});
+    st.stopBalancer();
+
+    var admin = st.s0.getDB("admin");
+    var coll = st.s0.getCollection("test.range_deleter_batching");
+    assert.commandWorked(admin.runCommand({enableSharding: coll.getDB() + ""}));
+    st.ensurePrimaryShard(coll.getDB() + "", "shard0000");
+    assert.commandWorked(admin.runCommand({shardCollection: coll + "", key: {_id: 1}}));
+
+    var numDocs = 1000;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        bulk.insert({_id: i});
+    }
+    assert.writeOK(bulk.execute());
+
+    var donor = st.shard0.getDB("admin");
+    assert.commandWorked(donor.runCommand(
+        {setParameter: 1, rangeDeleterBatchSize: 100, rangeDeleterBatchDelayMS: 1}));
+    var before = donor.serverStatus().metrics.rangeDeleter;
+
+    assert.commandWorked(admin.runCommand(
+        {moveChunk: coll + "", find: {_id: 0}, to: "shard0001", _waitForDelete: true}));
+
+    var after = donor.serverStatus().metrics.rangeDeleter;
+    assert.eq(numDocs, after.deletedDocs - before.deletedDocs, tojson(after));
+    assert.eq(numDocs / 100, after.batches - before.batches, tojson(after));
+    assert.eq(0, st.shard0.getCollection(coll + "").count());
+    assert.eq(numDocs, coll.find().itcount());
+
+    var lastDeleteStats = donor.serverStatus({rangeDeleter: 1}).rangeDeleter.lastDeleteStats;
+    var lastDelete = lastDeleteStats[lastDeleteStats.length - 1];
+    assert.eq(coll + "", lastDelete.ns, tojson(lastDeleteStats));
+    assert.eq(numDocs, lastDelete.deletedDocs, tojson(lastDeleteStats));
+
+    st.stop();
+}());
@@ -0,0 +1,60 @@
+// Test that the SHARDING_FILTER stage lets documents through unchecked when the bounds of the
+// index scan below it fall within one range of chunks owned by the shard, and still drops
+// orphaned documents otherwise.
+(function() {
+    "use strict";
+    load("jstests/libs/analyze_plan.js");
+
+    var st = new ShardingTest({shards: 2, mongos: 1, other: {mongosOptions: {noAutoSplit: ""}}});
+    st.stopBalancer();
+
+    var admin = st.s0.getDB("admin");
+    var coll = st.s0.getCollection("test.shard_filter_owned_range");
+    assert.commandWorked(admin.runCommand({enableSharding: coll.getDB() + ""}));
+    st.ensurePrimaryShard(coll.getDB() + "", "shard0000");
+    assert.commandWorked(admin.runCommand({shardCollection: coll + "", key: {x: 1}}));
+    assert.commandWorked(admin.runCommand({split: coll + "", middle: {x: 50}}));
+    assert.commandWorked(admin.runCommand({split: coll + "", middle: {x: 25}}));
+    assert.commandWorked(admin.runCommand(
+        {moveChunk: coll + "", find: {x: 50}, to: "shard0001", _waitForDelete: true}));
+
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(coll.insert({x: i}));
+    }
+
+    // An orphaned document, from the chunk shard0000 no longer owns.
+    assert.writeOK(st.shard0.getCollection(coll + "").insert({x: 70}));
+
+    function shardFilterStats(query) {
+        var res = coll.find(query).explain("executionStats");
+        var shards = res.executionStats.executionStages.shards;
+        assert.eq(1, shards.length, tojson(res));
+        assert.eq("shard0000", shards[0].shardName, tojson(res));
+        var stage = getPlanStage(shards[0].executionStages, "SHARDING_FILTER");
+        assert.neq(null, stage, tojson(res));
+        return stage;
+    }
+
+    // The chunks on both sides of 25 make one owned range.
+    var stage = shardFilterStats({x: {$gte: 10, $lt: 40}});
+    assert(stage.allKeysOwned, tojson(stage));
+    assert.eq(30, stage.nReturned, tojson(stage));
+
+    stage = shardFilterStats({x: {$in: [1, 30, 49]}});
+    assert(stage.allKeysOwned, tojson(stage));
+    assert.eq(3, stage.nReturned, tojson(stage));
+
+    // Scans reaching past the owned range still check every document.
+    assert.eq(51, coll.find({x: {$gte: 40, $lte: 90}}).itcount());
+    assert.eq(2, coll.find({x: {$in: [1, 70]}}).itcount());
+    var res = coll.find({x: {$in: [1, 70]}}).explain("executionStats");
+    res.executionStats.executionStages.shards.forEach(function(shard) {
+        var filter = getPlanStage(shard.executionStages, "SHARDING_FILTER");
+        assert(!filter.allKeysOwned, tojson(res));
+        if (shard.shardName == "shard0000") {
+            assert.eq(1, filter.chunkSkips, tojson(res));
+        }
+    });
+
+    st.stop();
+}());
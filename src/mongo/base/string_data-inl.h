@@ -86,11 +86,15 @@ inline size_t StringData::find(StringData needle) const {
     else if (needleSize > mx)
         return std::string::npos;
 
-    mx -= needleSize;
-
-    for (size_t i = 0; i <= mx; i++) {
-        if (memcmp(_data + i, needle._data, needleSize) == 0)
-            return i;
+    // Let memchr skip ahead to each candidate for the first character, and only compare the
+    // rest of the needle there.
+    const char* const last = _data + (mx - needleSize);
+    for (const char* pos = _data; pos <= last; ++pos) {
+        pos = static_cast<const char*>(memchr(pos, needle._data[0], last - pos + 1));
+        if (!pos)
+            break;
+        if (memcmp(pos + 1, needle._data + 1, needleSize - 1) == 0)
+            return pos - _data;
     }
     return std::string::npos;
 }
@@ -0,0 +1,84 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bson_field_offsets.h"
+
+#include <cstring>
+
+namespace mongo {
+
+BSONFieldOffsets::BSONFieldOffsets(const BSONObj& obj) : _obj(obj), _built(false) {}
+
+void BSONFieldOffsets::build() const {
+    _built = true;
+    BSONObjIterator it(_obj);
+    while (it.more()) {
+        BSONElement e = it.next();
+        // emplace() keeps the first of any fields with the same name, like getField().
+        _offsets.emplace(e.fieldNameStringData(), e.rawdata() - _obj.objdata());
+    }
+}
+
+BSONElement BSONFieldOffsets::getField(StringData name) const {
+    if (!_built) {
+        build();
+    }
+    auto it = _offsets.find(name);
+    if (it == _offsets.end()) {
+        return BSONElement();
+    }
+    return BSONElement(_obj.objdata() + it->second);
+}
+
+BSONElement BSONFieldOffsets::getFieldDottedOrArray(const char*& name) const {
+    const char* p = strchr(name, '.');
+
+    BSONElement sub;
+
+    if (p) {
+        sub = getField(StringData(name, p - name));
+        name = p + 1;
+    } else {
+        const size_t len = strlen(name);
+        sub = getField(StringData(name, len));
+        name = name + len;
+    }
+
+    if (sub.eoo())
+        return BSONElement();
+    else if (sub.type() == Array || name[0] == '\0')
+        return sub;
+    else if (sub.type() == Object)
+        return sub.embeddedObject().getFieldDottedOrArray(name);
+    else
+        return BSONElement();
+}
+
+}  // namespace mongo
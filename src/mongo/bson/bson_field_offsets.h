@@ -0,0 +1,74 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/platform/unordered_map.h"
+
+namespace mongo {
+
+/**
+ * Maps the top-level field names of one document to the offsets of their elements, so that code
+ * looking up many fields of the same document, such as the key generators of every index on a
+ * collection and their partial index filters, does not scan it from the start for each one.
+ *
+ * The map is built on the first lookup, with the same first-of-duplicates semantics as
+ * BSONObj::getField(). The document must not change while this object is in use.
+ */
+class BSONFieldOffsets {
+public:
+    explicit BSONFieldOffsets(const BSONObj& obj);
+
+    const BSONObj& obj() const {
+        return _obj;
+    }
+
+    /**
+     * Same as obj().getField(name).
+     */
+    BSONElement getField(StringData name) const;
+
+    /**
+     * Same as obj().getFieldDottedOrArray(name), except that the top-level field 'name' starts
+     * with is looked up here.
+     */
+    BSONElement getFieldDottedOrArray(const char*& name) const;
+
+private:
+    void build() const;
+
+    BSONObj _obj;
+
+    // Offsets from _obj.objdata(), keyed by field names that point into _obj.
+    mutable unordered_map<StringData, int, StringData::Hasher> _offsets;
+    mutable bool _built;
+};
+
+}  // namespace mongo
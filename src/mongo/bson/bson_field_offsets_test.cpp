@@ -0,0 +1,72 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bson_field_offsets.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+
+TEST(BSONFieldOffsetsTest, GetField) {
+    BSONObj obj = fromjson("{a: 1, b: 'x', c: {d: 2}, a: 3}");
+    BSONFieldOffsets offsets(obj);
+    ASSERT_EQUALS(obj.getField("a").rawdata(), offsets.getField("a").rawdata());
+    ASSERT_EQUALS(obj.getField("b").rawdata(), offsets.getField("b").rawdata());
+    ASSERT_EQUALS(obj.getField("c").rawdata(), offsets.getField("c").rawdata());
+    ASSERT_TRUE(offsets.getField("d").eoo());
+    ASSERT_TRUE(offsets.getField("").eoo());
+}
+
+TEST(BSONFieldOffsetsTest, EmptyObject) {
+    BSONFieldOffsets offsets((BSONObj()));
+    ASSERT_TRUE(offsets.getField("a").eoo());
+}
+
+TEST(BSONFieldOffsetsTest, GetFieldDottedOrArray) {
+    BSONObj obj = fromjson("{a: {b: {c: 1}}, x: [{y: 2}], n: 5}");
+    BSONFieldOffsets offsets(obj);
+
+    const char* paths[] = {
+        "a", "a.b", "a.b.c", "a.b.c.d", "a.z", "x", "x.y", "x.0.y", "n", "n.m", "q"};
+    for (const char* path : paths) {
+        const char* expectedRest = path;
+        const char* actualRest = path;
+        BSONElement expected = obj.getFieldDottedOrArray(expectedRest);
+        BSONElement actual = offsets.getFieldDottedOrArray(actualRest);
+        ASSERT_EQUALS(expected.rawdata(), actual.rawdata());
+        ASSERT_EQUALS(std::string(expectedRest), std::string(actualRest));
+    }
+}
+
+}  // namespace
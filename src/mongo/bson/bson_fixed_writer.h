@@ -0,0 +1,173 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstring>
+
+#include "mongo/base/data_view.h"
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsontypes.h"
+#include "mongo/bson/timestamp.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+/**
+ * Writes a document whose fields are known ahead of time straight into a buffer the caller has
+ * already sized, for hot paths such as oplog entries that build the same shape on every write.
+ *
+ * Field names are string literals, so their lengths are compile-time constants: each name is
+ * copied with one memcpy, without the strlen() and the growth checks BSONObjBuilder pays per
+ * field. The caller sums kDocumentOverhead and the matching *Size() function of every field to
+ * size the buffer, and done() checks that exactly that many bytes were written.
+ *
+ * Example:
+ *     const size_t size = BSONFixedWriter::kDocumentOverhead +
+ *         BSONFixedWriter::numberLongSize("h") + BSONFixedWriter::stringSize("op", op);
+ *     BSONFixedWriter writer(buf, size);
+ *     writer.appendNumberLong("h", hash);
+ *     writer.appendString("op", op);
+ *     writer.done();
+ */
+class BSONFixedWriter {
+    MONGO_DISALLOW_COPYING(BSONFixedWriter);
+
+public:
+    /**
+     * The leading length and the trailing EOO byte of every document.
+     */
+    static const size_t kDocumentOverhead = sizeof(int) + 1;
+
+    template <size_t N>
+    static size_t timestampSize(const char(&)[N]) {
+        return 1 + N + sizeof(unsigned long long);
+    }
+
+    template <size_t N>
+    static size_t numberLongSize(const char(&)[N]) {
+        return 1 + N + sizeof(long long);
+    }
+
+    template <size_t N>
+    static size_t numberIntSize(const char(&)[N]) {
+        return 1 + N + sizeof(int);
+    }
+
+    template <size_t N>
+    static size_t boolSize(const char(&)[N]) {
+        return 1 + N + 1;
+    }
+
+    template <size_t N>
+    static size_t stringSize(const char(&)[N], StringData value) {
+        return 1 + N + sizeof(int) + value.size() + 1;
+    }
+
+    template <size_t N>
+    static size_t objectSize(const char(&)[N], const BSONObj& value) {
+        return 1 + N + value.objsize();
+    }
+
+    /**
+     * 'buf' must have room for 'size' bytes.
+     */
+    BSONFixedWriter(char* buf, size_t size) : _start(buf), _pos(buf + sizeof(int)), _size(size) {}
+
+    template <size_t N>
+    void appendTimestamp(const char(&name)[N], Timestamp value) {
+        _appendFieldName(bsonTimestamp, name);
+        _appendNum(value.asULL());
+    }
+
+    template <size_t N>
+    void appendNumberLong(const char(&name)[N], long long value) {
+        _appendFieldName(NumberLong, name);
+        _appendNum(value);
+    }
+
+    template <size_t N>
+    void appendNumberInt(const char(&name)[N], int value) {
+        _appendFieldName(NumberInt, name);
+        _appendNum(value);
+    }
+
+    template <size_t N>
+    void appendBool(const char(&name)[N], bool value) {
+        _appendFieldName(Bool, name);
+        *_pos++ = value ? 1 : 0;
+    }
+
+    template <size_t N>
+    void appendString(const char(&name)[N], StringData value) {
+        _appendFieldName(String, name);
+        _appendNum(static_cast<int>(value.size() + 1));
+        value.copyTo(_pos, true);
+        _pos += value.size() + 1;
+    }
+
+    template <size_t N>
+    void appendObject(const char(&name)[N], const BSONObj& value) {
+        _appendFieldName(Object, name);
+        std::memcpy(_pos, value.objdata(), value.objsize());
+        _pos += value.objsize();
+    }
+
+    /**
+     * Terminates the document and fills in its length, which must be the size passed to the
+     * constructor.
+     */
+    void done() {
+        *_pos++ = EOO;
+        const size_t written = _pos - _start;
+        invariant(written == _size);
+        DataView(_start).write(tagLittleEndian(static_cast<int>(written)));
+    }
+
+private:
+    template <size_t N>
+    void _appendFieldName(BSONType type, const char(&name)[N]) {
+        *_pos++ = static_cast<char>(type);
+        std::memcpy(_pos, name, N);
+        _pos += N;
+    }
+
+    template <typename T>
+    void _appendNum(T value) {
+        DataView(_pos).write(tagLittleEndian(value));
+        _pos += sizeof(T);
+    }
+
+    char* const _start;
+    char* _pos;
+    const size_t _size;
+};
+
+}  // namespace mongo
@@ -0,0 +1,91 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bson_fixed_writer.h"
+
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+
+TEST(BSONFixedWriterTest, MatchesBSONObjBuilder) {
+    const BSONObj sub = BSON("a" << 1 << "b" << BSON_ARRAY("x"
+                                                             << "y"));
+    const Timestamp ts(1234, 5);
+    const std::string str("some string");
+
+    BSONObjBuilder bob;
+    bob.append("ts", ts);
+    bob.append("n", 7LL);
+    bob.append("i", -3);
+    bob.appendBool("yes", true);
+    bob.appendBool("no", false);
+    bob.append("str", str);
+    bob.append("empty", "");
+    bob.append("obj", sub);
+    const BSONObj expected = bob.obj();
+
+    const size_t size = BSONFixedWriter::kDocumentOverhead + BSONFixedWriter::timestampSize("ts") +
+        BSONFixedWriter::numberLongSize("n") + BSONFixedWriter::numberIntSize("i") +
+        BSONFixedWriter::boolSize("yes") + BSONFixedWriter::boolSize("no") +
+        BSONFixedWriter::stringSize("str", str) + BSONFixedWriter::stringSize("empty", "") +
+        BSONFixedWriter::objectSize("obj", sub);
+    ASSERT_EQUALS(static_cast<size_t>(expected.objsize()), size);
+
+    std::vector<char> buf(size);
+    BSONFixedWriter writer(buf.data(), size);
+    writer.appendTimestamp("ts", ts);
+    writer.appendNumberLong("n", 7LL);
+    writer.appendNumberInt("i", -3);
+    writer.appendBool("yes", true);
+    writer.appendBool("no", false);
+    writer.appendString("str", str);
+    writer.appendString("empty", "");
+    writer.appendObject("obj", sub);
+    writer.done();
+
+    const BSONObj actual(buf.data());
+    ASSERT_EQUALS(expected.objsize(), actual.objsize());
+    ASSERT_EQUALS(0, memcmp(expected.objdata(), actual.objdata(), expected.objsize()));
+}
+
+TEST(BSONFixedWriterTest, EmptyDocument) {
+    char buf[BSONFixedWriter::kDocumentOverhead];
+    BSONFixedWriter writer(buf, sizeof(buf));
+    writer.done();
+    ASSERT_EQUALS(BSONObj(), BSONObj(buf));
+    ASSERT_EQUALS(BSONObj().objsize(), BSONObj(buf).objsize());
+}
+
+}  // namespace
@@ -28,8 +28,8 @@
  */
 
 #include <cstring>
-#include <deque>
 #include <limits>
+#include <vector>
 
 #include "mongo/base/data_view.h"
 #include "mongo/bson/bson_validate.h"
@@ -169,6 +169,49 @@ private:
     int _startPosition;
 };
 
+/**
+ * The frames of the objects being validated, innermost last. Most documents nest only a few
+ * objects deep, so the first frames are held inline to spare each validateBSON() call a heap
+ * allocation. A reference returned by back() is invalidated by push_back() and pop_back().
+ */
+class ValidationFrameStack {
+public:
+    bool empty() const {
+        return _size == 0;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    ValidationObjectFrame& back() {
+        return _size > kInlineFrames ? _overflow.back() : _inline[_size - 1];
+    }
+
+    void push_back(const ValidationObjectFrame& frame) {
+        if (_size < kInlineFrames) {
+            _inline[_size] = frame;
+        } else {
+            _overflow.push_back(frame);
+        }
+        ++_size;
+    }
+
+    void pop_back() {
+        if (_size > kInlineFrames) {
+            _overflow.pop_back();
+        }
+        --_size;
+    }
+
+private:
+    static const size_t kInlineFrames = 32;
+
+    ValidationObjectFrame _inline[kInlineFrames];
+    std::vector<ValidationObjectFrame> _overflow;  // frames past the first kInlineFrames
+    size_t _size = 0;
+};
+
 /**
  * WARNING: only pass in a non-EOO idElem if it has been fully validated already!
  */
@@ -282,7 +325,7 @@ Status validateElementInfo(Buffer* buffer, ValidationState::State* nextState, BS
 }
 
 Status validateBSONIterative(Buffer* buffer) {
-    std::deque<ValidationObjectFrame> frames;
+    ValidationFrameStack frames;
     ValidationObjectFrame* curr = NULL;
     ValidationState::State state = ValidationState::BeginObj;
 
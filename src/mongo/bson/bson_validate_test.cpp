@@ -236,6 +236,28 @@ TEST(BSONValidateFast, NestedObject) {
     ASSERT_NOT_OK(validateBSON(x.objdata(), x.objsize() / 2));
 }
 
+TEST(BSONValidateFast, DeeplyNestedObject) {
+    // Deep enough to run past the frames the validator keeps inline.
+    const int depth = 100;
+    BSONObj x = BSON("x" << 1);
+    for (int i = 0; i < depth; i++) {
+        x = BSON("a" << x << "b" << BSON_ARRAY(i));
+    }
+    ASSERT_OK(validateBSON(x.objdata(), x.objsize()));
+    ASSERT_NOT_OK(validateBSON(x.objdata(), x.objsize() - 1));
+
+    // Corrupt the size of the innermost object, found by walking down the "a" fields.
+    const char* innermost = x.objdata();
+    while (BSONObj(innermost).hasField("a")) {
+        innermost = BSONObj(innermost)["a"].value();
+    }
+    const int innermostSize = BSONObj(innermost).objsize();
+    BufBuilder bb;
+    bb.appendBuf(x.objdata(), x.objsize());
+    DataView(bb.buf() + (innermost - x.objdata())).write(tagLittleEndian(innermostSize + 1));
+    ASSERT_NOT_OK(validateBSON(bb.buf(), bb.len()));
+}
+
 TEST(BSONValidateFast, ErrorWithId) {
     BufBuilder bb;
     BSONObjBuilder ob(bb);
@@ -51,14 +51,93 @@ using std::dec;
 using std::hex;
 using std::string;
 
+namespace {
+/**
+ * Appends 'str' to 's' escaped for a JSON string, as escape() returns it. Runs of characters that
+ * need no escaping are copied at once.
+ */
+void appendEscaped(StringBuilder& s, StringData str, bool escapeSlash) {
+    size_t unescapedStart = 0;
+    for (size_t i = 0; i < str.size(); ++i) {
+        const char c = str[i];
+        const char* escaped;
+        switch (c) {
+            case '"':
+                escaped = "\\\"";
+                break;
+            case '\\':
+                escaped = "\\\\";
+                break;
+            case '/':
+                if (!escapeSlash)
+                    continue;
+                escaped = "\\/";
+                break;
+            case '\b':
+                escaped = "\\b";
+                break;
+            case '\f':
+                escaped = "\\f";
+                break;
+            case '\n':
+                escaped = "\\n";
+                break;
+            case '\r':
+                escaped = "\\r";
+                break;
+            case '\t':
+                escaped = "\\t";
+                break;
+            default:
+                if (c < 0 || c > 0x1f)
+                    continue;
+                escaped = NULL;
+        }
+
+        s << str.substr(unescapedStart, i - unescapedStart);
+        if (escaped) {
+            s << escaped;
+        } else {
+            // TODO: these should be utf16 code-units not bytes
+            s << "\\u00" << toHexLower(&c, 1);
+        }
+        unescapedStart = i + 1;
+    }
+    s << str.substr(unescapedStart);
+}
+
+/**
+ * Appends 'number' as std::ostream would with a precision of 16, without the cost of a stream.
+ */
+void appendDouble(StringBuilder& s, double number) {
+    char buf[32];
+    const int len = snprintf(buf, sizeof(buf), "%.16g", number);
+    invariant(len > 0 && static_cast<size_t>(len) < sizeof(buf));
+    s << StringData(buf, len);
+}
+}  // namespace
+
 string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames, int pretty) const {
-    std::stringstream s;
-    if (includeFieldNames)
-        s << '"' << escape(fieldName()) << "\" : ";
+    StringBuilder s;
+    jsonStringBuffer(format, includeFieldNames, pretty, s);
+    return s.str();
+}
+
+void BSONElement::jsonStringBuffer(JsonStringFormat format,
+                                   bool includeFieldNames,
+                                   int pretty,
+                                   StringBuilder& s) const {
+    if (includeFieldNames) {
+        s << '"';
+        appendEscaped(s, fieldNameStringData(), false);
+        s << "\" : ";
+    }
     switch (type()) {
         case mongo::String:
         case Symbol:
-            s << '"' << escape(string(valuestr(), valuestrsize() - 1)) << '"';
+            s << '"';
+            appendEscaped(s, StringData(valuestr(), valuestrsize() - 1), false);
+            s << '"';
             break;
         case NumberLong:
             if (format == TenGen) {
@@ -75,8 +154,7 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
         case NumberDouble:
             if (number() >= -std::numeric_limits<double>::max() &&
                 number() <= std::numeric_limits<double>::max()) {
-                s.precision(16);
-                s << number();
+                appendDouble(s, number());
             }
             // This is not valid JSON, but according to RFC-4627, "Numeric values that cannot be
             // represented as sequences of digits (such as Infinity and NaN) are not permitted." so
@@ -125,7 +203,7 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
             }
             break;
         case Object:
-            s << embeddedObject().jsonString(format, pretty);
+            embeddedObject().jsonStringBuffer(format, pretty, false, s);
             break;
         case mongo::Array: {
             if (embeddedObject().isEmpty()) {
@@ -147,7 +225,7 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
                     if (strtol(e.fieldName(), 0, 10) > count) {
                         s << "undefined";
                     } else {
-                        s << e.jsonString(format, false, pretty ? pretty + 1 : 0);
+                        e.jsonStringBuffer(format, false, pretty ? pretty + 1 : 0, s);
                         e = i.next();
                     }
                     count++;
@@ -192,13 +270,9 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
             const int len = reader.readAndAdvance<LittleEndian<int>>();
             BinDataType type = static_cast<BinDataType>(reader.readAndAdvance<uint8_t>());
 
-            s << "{ \"$binary\" : \"";
-            base64::encode(s, reader.view(), len);
-            s << "\", \"$type\" : \"" << hex;
-            s.width(2);
-            s.fill('0');
-            s << type << dec;
-            s << "\" }";
+            const char typeByte = static_cast<char>(type);
+            s << "{ \"$binary\" : \"" << base64::encode(reader.view(), len) << "\", \"$type\" : \""
+              << toHexLower(&typeByte, 1) << "\" }";
             break;
         }
         case mongo::Date:
@@ -242,10 +316,13 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
             break;
         case RegEx:
             if (format == Strict) {
-                s << "{ \"$regex\" : \"" << escape(regex());
+                s << "{ \"$regex\" : \"";
+                appendEscaped(s, regex(), false);
                 s << "\", \"$options\" : \"" << regexFlags() << "\" }";
             } else {
-                s << "/" << escape(regex(), true) << "/";
+                s << "/";
+                appendEscaped(s, regex(), true);
+                s << "/";
                 // FIXME Worry about alpha order?
                 for (const char* f = regexFlags(); *f; ++f) {
                     switch (*f) {
@@ -263,14 +340,20 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
         case CodeWScope: {
             BSONObj scope = codeWScopeObject();
             if (!scope.isEmpty()) {
-                s << "{ \"$code\" : \"" << escape(_asCode()) << "\" , "
-                  << "\"$scope\" : " << scope.jsonString() << " }";
+                s << "{ \"$code\" : \"";
+                appendEscaped(s, _asCode(), false);
+                s << "\" , "
+                  << "\"$scope\" : ";
+                scope.jsonStringBuffer(Strict, 0, false, s);
+                s << " }";
                 break;
             }
         }
 
         case Code:
-            s << "\"" << escape(_asCode()) << "\"";
+            s << "\"";
+            appendEscaped(s, _asCode(), false);
+            s << "\"";
             break;
 
         case bsonTimestamp:
@@ -299,7 +382,6 @@ string BSONElement::jsonString(JsonStringFormat format, bool includeFieldNames,
             string message = ss.str();
             massert(10312, message.c_str(), false);
     }
-    return s.str();
 }
 
 namespace {
@@ -807,42 +889,7 @@ bool BSONObj::coerceVector(std::vector<T>* out) const {
 // used by jsonString()
 std::string escape(const std::string& s, bool escape_slash) {
     StringBuilder ret;
-    for (std::string::const_iterator i = s.begin(); i != s.end(); ++i) {
-        switch (*i) {
-            case '"':
-                ret << "\\\"";
-                break;
-            case '\\':
-                ret << "\\\\";
-                break;
-            case '/':
-                ret << (escape_slash ? "\\/" : "/");
-                break;
-            case '\b':
-                ret << "\\b";
-                break;
-            case '\f':
-                ret << "\\f";
-                break;
-            case '\n':
-                ret << "\\n";
-                break;
-            case '\r':
-                ret << "\\r";
-                break;
-            case '\t':
-                ret << "\\t";
-                break;
-            default:
-                if (*i >= 0 && *i <= 0x1f) {
-                    // TODO: these should be utf16 code-units not bytes
-                    char c = *i;
-                    ret << "\\u00" << toHexLower(&c, 1);
-                } else {
-                    ret << *i;
-                }
-        }
-    }
+    appendEscaped(ret, s, escape_slash);
     return ret.str();
 }
 
@@ -996,13 +1043,14 @@ int compareElementValues(const BSONElement& l, const BSONElement& r) {
     return -1;
 }
 
-size_t BSONElement::Hasher::operator()(const BSONElement& elem) const {
+namespace {
+size_t hashElement(const BSONElement& elem, bool considerFieldName) {
     size_t hash = 0;
 
     boost::hash_combine(hash, elem.canonicalType());
 
     const StringData fieldName = elem.fieldNameStringData();
-    if (!fieldName.empty()) {
+    if (considerFieldName && !fieldName.empty()) {
         boost::hash_combine(hash, StringData::Hasher()(fieldName));
     }
 
@@ -1100,5 +1148,14 @@ size_t BSONElement::Hasher::operator()(const BSONElement& elem) const {
     }
     return hash;
 }
+}  // namespace
+
+size_t BSONElement::Hasher::operator()(const BSONElement& elem) const {
+    return hashElement(elem, true);
+}
+
+size_t BSONElement::HasherWithoutField::operator()(const BSONElement& elem) const {
+    return hashElement(elem, false);
+}
 
 }  // namespace mongo
@@ -182,6 +182,14 @@ public:
     std::string jsonString(JsonStringFormat format,
                            bool includeFieldNames = true,
                            int pretty = 0) const;
+
+    /**
+     * Like jsonString(), but appends the JSON to 's' rather than returning it in a new string.
+     */
+    void jsonStringBuffer(JsonStringFormat format,
+                          bool includeFieldNames,
+                          int pretty,
+                          StringBuilder& s) const;
     operator std::string() const {
         return toString();
     }
@@ -497,6 +505,14 @@ public:
         size_t operator()(const BSONElement& elem) const;
     };
 
+    /**
+     * Like Hasher, but ignores the field name, so that elements which woCompare() equal with
+     * considerFieldName false hash the same. See BSONElementEqualWithoutField.
+     */
+    struct HasherWithoutField {
+        size_t operator()(const BSONElement& elem) const;
+    };
+
     const char* rawdata() const {
         return data;
     }
@@ -42,6 +42,12 @@ struct BSONElementCmpWithoutField {
     }
 };
 
+struct BSONElementEqualWithoutField {
+    bool operator()(const BSONElement& l, const BSONElement& r) const {
+        return l.woCompare(r, false) == 0;
+    }
+};
+
 class BSONObjCmp {
 public:
     BSONObjCmp(const BSONObj& order = BSONObj()) : _order(order) {}
@@ -116,6 +116,14 @@ public:
         : _objdata(ownedBuffer.get() ? ownedBuffer.get() : BSONObj().objdata()),
           _ownedBuffer(std::move(ownedBuffer)) {}
 
+    /** Construct an owned BSONObj from data that lies somewhere within 'holder', which may hold
+     *  other objects as well. The BSONObj and its copies keep all of 'holder' alive.
+     */
+    BSONObj(SharedBuffer holder, const char* bsonData) : _ownedBuffer(std::move(holder)) {
+        dassert(_ownedBuffer.get());
+        init(bsonData);
+    }
+
     /** Move construct a BSONObj */
     BSONObj(BSONObj&& other)
         : _objdata(std::move(other._objdata)), _ownedBuffer(std::move(other._ownedBuffer)) {
@@ -176,6 +184,14 @@ public:
         return _ownedBuffer.get() != 0;
     }
 
+    /**
+     * Returns the buffer holding this object's data if it is owned, or a null SharedBuffer if
+     * it is not. A copy of the returned buffer keeps the data alive.
+     */
+    const SharedBuffer& sharedBuffer() const {
+        return _ownedBuffer;
+    }
+
     /** assure the data buffer is under the control of this BSONObj and not a remote buffer
         @see isOwned()
     */
@@ -199,6 +215,13 @@ public:
                            int pretty = 0,
                            bool isArray = false) const;
 
+    /** Like jsonString(), but appends the JSON to 's' rather than returning it in a new string.
+    */
+    void jsonStringBuffer(JsonStringFormat format,
+                          int pretty,
+                          bool isArray,
+                          StringBuilder& s) const;
+
     /** note: addFields always adds _id even if not specified */
     int addFields(BSONObj& from, std::set<std::string>& fields); /* returns n added */
 
@@ -860,6 +860,16 @@ public:
         return _b.bb();
     }
 
+    /**
+     * Appends 'len' bytes holding 'count' already serialized elements, which must be named
+     * with the next 'count' indexes of this array.
+     */
+    BSONArrayBuilder& appendSerializedElements(const char* data, int len, int count) {
+        _b.bb().appendBuf(data, len);
+        _i += count;
+        return *this;
+    }
+
 private:
     std::string num() {
         return _b.numStr(_i++);
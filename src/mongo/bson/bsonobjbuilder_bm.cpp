@@ -0,0 +1,124 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/unittest/benchmark.h"
+
+namespace {
+
+using namespace mongo;
+using unittest::BenchmarkState;
+using unittest::doNotOptimizeAway;
+
+const int kNumFields = 20;
+
+std::vector<std::string> fieldNames() {
+    std::vector<std::string> names;
+    for (int i = 0; i < kNumFields; i++) {
+        names.push_back("field" + std::to_string(i));
+    }
+    return names;
+}
+
+MONGO_BENCHMARK(BSONObjBuilderAppendInts) {
+    const std::vector<std::string> names = fieldNames();
+    while (state.keepRunning()) {
+        BSONObjBuilder builder;
+        for (int i = 0; i < kNumFields; i++) {
+            builder.append(names[i], i);
+        }
+        doNotOptimizeAway(builder.obj());
+    }
+}
+
+MONGO_BENCHMARK(BSONObjBuilderAppendStrings) {
+    const std::vector<std::string> names = fieldNames();
+    const std::string value(32, 'x');
+    while (state.keepRunning()) {
+        BSONObjBuilder builder;
+        for (int i = 0; i < kNumFields; i++) {
+            builder.append(names[i], value);
+        }
+        doNotOptimizeAway(builder.obj());
+    }
+}
+
+MONGO_BENCHMARK(BSONObjBuilderAppendNested) {
+    const std::vector<std::string> names = fieldNames();
+    while (state.keepRunning()) {
+        BSONObjBuilder builder;
+        for (int i = 0; i < kNumFields; i++) {
+            BSONObjBuilder subBuilder(builder.subobjStart(names[i]));
+            subBuilder.append("a", i);
+            BSONArrayBuilder arrayBuilder(subBuilder.subarrayStart("b"));
+            arrayBuilder.append(i);
+            arrayBuilder.append(i + 1);
+            arrayBuilder.done();
+            subBuilder.done();
+        }
+        doNotOptimizeAway(builder.obj());
+    }
+}
+
+MONGO_BENCHMARK(BSONObjIterate) {
+    const std::vector<std::string> names = fieldNames();
+    BSONObjBuilder builder;
+    for (int i = 0; i < kNumFields; i++) {
+        builder.append(names[i], i);
+    }
+    const BSONObj obj = builder.obj();
+
+    while (state.keepRunning()) {
+        long long sum = 0;
+        for (BSONObjIterator it(obj); it.more();) {
+            sum += it.next().numberLong();
+        }
+        doNotOptimizeAway(sum);
+    }
+}
+
+MONGO_BENCHMARK(BSONObjGetField) {
+    const std::vector<std::string> names = fieldNames();
+    BSONObjBuilder builder;
+    for (int i = 0; i < kNumFields; i++) {
+        builder.append(names[i], i);
+    }
+    const BSONObj obj = builder.obj();
+
+    while (state.keepRunning()) {
+        doNotOptimizeAway(obj[names[kNumFields - 1]]);
+    }
+}
+
+}  // namespace
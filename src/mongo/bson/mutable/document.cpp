@@ -32,6 +32,8 @@
 #include <cstdlib>
 #include <cstring>
 #include <limits>
+#include <map>
+#include <utility>
 #include <vector>
 
 #include "mongo/bson/inline_decls.h"
@@ -557,7 +559,9 @@ public:
           _leafBuilder(_leafBuf),
           _fieldNameScratch(),
           _damages(),
-          _inPlaceMode(inPlaceMode) {
+          _inPlaceMode(inPlaceMode),
+          _unlinkedReps(),
+          _numMaterialized(0) {
         // We always have a BSONObj for the leaves, and we often have
         // one for our base document, so reserve 2.
         _objects.reserve(2);
@@ -597,6 +601,8 @@ public:
         _fieldNameScratch.clear();
         _damages.clear();
         _inPlaceMode = inPlaceMode;
+        _unlinkedReps.clear();
+        _numMaterialized = 0;
 
         // Ensure that we start in the same state as the ctor would leave us in.
         _objects.push_back(_leafBuilder.asTempObj());
@@ -781,6 +787,17 @@ public:
                                                : getObject(rep->objIdx)).firstElement();
 
         if (!childElt.eoo()) {
+            const uint32_t offset = getElementOffset(getObject(rep->objIdx), childElt);
+
+            // The first child may already have been realized out of order by
+            // resolveRightChild, in which case we only need to link it in.
+            const Element::RepIdx unlinked = takeUnlinkedRep(rep->objIdx, offset);
+            if (unlinked != Element::kInvalidRepIdx) {
+                getElementRep(unlinked).sibling.left = Element::kInvalidRepIdx;
+                rep->child.left = unlinked;
+                return unlinked;
+            }
+
             // Do this now before other writes so compiler can exploit knowing
             // that we are not eoo.
             const int32_t fieldNameSize = childElt.fieldNameSize();
@@ -790,10 +807,11 @@ public:
             // Calling makeNewRep invalidates rep since it may cause a reallocation of
             // the element vector. After calling insertElement, we reacquire rep.
             rep = &getElementRep(index);
+            ++_numMaterialized;
 
             newRep.serialized = true;
             newRep.objIdx = rep->objIdx;
-            newRep.offset = getElementOffset(getObject(rep->objIdx), childElt);
+            newRep.offset = offset;
             newRep.parent = index;
             newRep.sibling.right = Element::kOpaqueRepIdx;
             // If this new object has possible substructure, mark its children as opaque.
@@ -812,31 +830,79 @@ public:
         return rep->child.left;
     }
 
-    // Return the index of the right child of the Element with index 'index', resolving any
-    // opaque nodes. Note that this may require resolving all of the right siblings of the
-    // left child.
+    // Return the index of the right child of the Element with index 'index', resolving it
+    // if it is currently opaque. Rather than realizing every child to get there, the last
+    // serialized child is found by scanning the BSON and realized on its own, with an
+    // opaque left sibling. It is linked in when a walk from the left reaches it.
     Element::RepIdx resolveRightChild(Element::RepIdx index) {
         dassert(index != Element::kInvalidRepIdx);
         dassert(index != Element::kOpaqueRepIdx);
 
         Element::RepIdx current = getElementRep(index).child.right;
         if (current == Element::kOpaqueRepIdx) {
+            // Find the rightmost child that is reachable from the left. Everything to its
+            // right is either opaque or was realized out of order, and because our right
+            // child is still opaque, the last serialized child has not been realized yet.
             current = resolveLeftChild(index);
-            while (current != Element::kInvalidRepIdx) {
-                Element::RepIdx next = resolveRightSibling(current);
-                if (next == Element::kInvalidRepIdx)
+            if (current == Element::kInvalidRepIdx)
+                return current;
+            while (true) {
+                const Element::RepIdx next = getElementRep(current).sibling.right;
+                if (next == Element::kOpaqueRepIdx)
                     break;
+                dassert(next != Element::kInvalidRepIdx);
                 current = next;
             }
 
-            // The resolveRightSibling calls should have eventually updated this nodes right
-            // child pointer to point to the node we are about to return.
-            dassert(getElementRep(index).child.right == current);
+            const ElementRep& currentRep = getElementRep(current);
+            const BSONElement currentElt = getSerializedElement(currentRep);
+            BSONElement lastElt;
+            for (BSONElement elt(currentElt.rawdata() + currentElt.size()); !elt.eoo();
+                 elt = BSONElement(elt.rawdata() + elt.size())) {
+                lastElt = elt;
+            }
+
+            if (lastElt.eoo()) {
+                // We are already at the last child, and resolving its right sibling makes
+                // it our right child.
+                resolveRightSibling(current);
+                dassert(getElementRep(index).child.right == current);
+                return current;
+            }
+
+            const Element::RepIdx last = makeUnlinkedRep(currentRep.objIdx, lastElt, index);
+            getElementRep(last).sibling.right = Element::kInvalidRepIdx;
+            getElementRep(index).child.right = last;
+            current = last;
         }
 
         return current;
     }
 
+    // Return the index of the left sibling of the Element with index 'index'. Only an
+    // Element realized out of order by resolveRightChild can have an opaque left sibling;
+    // resolving it realizes the children of our parent from the left until we are reached.
+    Element::RepIdx resolveLeftSibling(Element::RepIdx index) {
+        dassert(index != Element::kInvalidRepIdx);
+        dassert(index != Element::kOpaqueRepIdx);
+
+        const ElementRep& rep = getElementRep(index);
+        if (rep.sibling.left != Element::kOpaqueRepIdx)
+            return rep.sibling.left;
+
+        Element::RepIdx current = resolveLeftChild(rep.parent);
+        while (current != index) {
+            Element::RepIdx next = resolveRightSibling(current);
+            dassert(next != Element::kInvalidRepIdx);
+            if (next == index)
+                break;
+            current = next;
+        }
+
+        dassert(getElementRep(index).sibling.left != Element::kOpaqueRepIdx);
+        return getElementRep(index).sibling.left;
+    }
+
     // Return the index of the right sibling of the Element with index 'index', resolving
     // the right sibling to a realized Element if it is currently opaque.
     Element::RepIdx resolveRightSibling(Element::RepIdx index) {
@@ -852,6 +918,17 @@ public:
         BSONElement rightElt(elt.rawdata() + elt.size());
 
         if (!rightElt.eoo()) {
+            const uint32_t offset = getElementOffset(getObject(rep->objIdx), rightElt);
+
+            // Our right sibling may already have been realized out of order by
+            // resolveRightChild, in which case we only need to link it in.
+            const Element::RepIdx unlinked = takeUnlinkedRep(rep->objIdx, offset);
+            if (unlinked != Element::kInvalidRepIdx) {
+                getElementRep(unlinked).sibling.left = index;
+                rep->sibling.right = unlinked;
+                return unlinked;
+            }
+
             // Do this now before other writes so compiler can exploit knowing
             // that we are not eoo.
             const int32_t fieldNameSize = rightElt.fieldNameSize();
@@ -861,10 +938,11 @@ public:
             // Calling makeNewRep invalidates rep since it may cause a reallocation of
             // the element vector. After calling insertElement, we reacquire rep.
             rep = &getElementRep(index);
+            ++_numMaterialized;
 
             newRep.serialized = true;
             newRep.objIdx = rep->objIdx;
-            newRep.offset = getElementOffset(getObject(rep->objIdx), rightElt);
+            newRep.offset = offset;
             newRep.parent = rep->parent;
             newRep.sibling.left = index;
             newRep.sibling.right = Element::kOpaqueRepIdx;
@@ -889,6 +967,79 @@ public:
         return rep->sibling.right;
     }
 
+    // Realize the serialized element 'elt' of the BSONObj with id 'objIdx' as a child of
+    // 'parent' whose left sibling is opaque, and remember it so that the walk from the left
+    // which reaches it links it in rather than realizing it a second time.
+    Element::RepIdx makeUnlinkedRep(ElementRep::ObjIdx objIdx,
+                                    const BSONElement& elt,
+                                    Element::RepIdx parent) {
+        const uint32_t offset = getElementOffset(getObject(objIdx), elt);
+
+        Element::RepIdx inserted;
+        ElementRep& newRep = makeNewRep(&inserted);
+        ++_numMaterialized;
+
+        newRep.serialized = true;
+        newRep.objIdx = objIdx;
+        newRep.offset = offset;
+        newRep.parent = parent;
+        newRep.sibling.left = Element::kOpaqueRepIdx;
+        newRep.sibling.right = Element::kOpaqueRepIdx;
+        if (!isLeaf(elt)) {
+            newRep.child.left = Element::kOpaqueRepIdx;
+            newRep.child.right = Element::kOpaqueRepIdx;
+        }
+        newRep.fieldNameSize = elt.fieldNameSize();
+
+        _unlinkedReps[std::make_pair(objIdx, offset)] = inserted;
+        return inserted;
+    }
+
+    // If the serialized element at 'offset' in the BSONObj with id 'objIdx' was realized
+    // by makeUnlinkedRep, forget it and return its index. Otherwise return kInvalidRepIdx.
+    Element::RepIdx takeUnlinkedRep(ElementRep::ObjIdx objIdx, uint32_t offset) {
+        if (_unlinkedReps.empty())
+            return Element::kInvalidRepIdx;
+        const UnlinkedReps::iterator it = _unlinkedReps.find(std::make_pair(objIdx, offset));
+        if (it == _unlinkedReps.end())
+            return Element::kInvalidRepIdx;
+        const Element::RepIdx result = it->second;
+        _unlinkedReps.erase(it);
+        return result;
+    }
+
+    // Return the index of the first child of 'parent' realized by makeUnlinkedRep from the
+    // serialized bytes in [begin, end) of the BSONObj with id 'objIdx', and set '*position'
+    // to the serialized element it was made from. If there is none, return kInvalidRepIdx
+    // and set '*position' to 'end'.
+    Element::RepIdx findUnlinkedRep(ElementRep::ObjIdx objIdx,
+                                    const char* begin,
+                                    const char* end,
+                                    Element::RepIdx parent,
+                                    const char** position) const {
+        *position = end;
+        if (_unlinkedReps.empty())
+            return Element::kInvalidRepIdx;
+        const char* const base = getObject(objIdx).objdata();
+        const UnlinkedRepKey endKey(objIdx, end - base);
+        for (UnlinkedReps::const_iterator it =
+                 _unlinkedReps.lower_bound(UnlinkedRepKey(objIdx, begin - base));
+             it != _unlinkedReps.end() && it->first < endKey;
+             ++it) {
+            if (getElementRep(it->second).parent == parent) {
+                *position = base + it->first.second;
+                return it->second;
+            }
+        }
+        return Element::kInvalidRepIdx;
+    }
+
+    // The number of ElementReps realized from serialized BSON since this Document was
+    // constructed or last reset.
+    size_t getNumMaterializedElements() const {
+        return _numMaterialized;
+    }
+
     // Find the ElementRep at index 'index', and mark it and all of its currently
     // serialized parents as non-serialized.
     void deserialize(Element::RepIdx index) {
@@ -1084,6 +1235,15 @@ private:
     // Queue of damage events and status bit for whether  in-place updates are possible.
     DamageVector _damages;
     Document::InPlaceMode _inPlaceMode;
+
+    // Elements realized by resolveRightChild ahead of their left siblings, keyed by the
+    // object id and offset of the serialized element they were made from. They are removed
+    // once a walk from the left links them in.
+    typedef std::pair<ElementRep::ObjIdx, uint32_t> UnlinkedRepKey;
+    typedef std::map<UnlinkedRepKey, Element::RepIdx> UnlinkedReps;
+    UnlinkedReps _unlinkedReps;
+
+    size_t _numMaterialized;
 };
 
 Status Element::addSiblingLeft(Element e) {
@@ -1092,19 +1252,23 @@ Status Element::addSiblingLeft(Element e) {
     verify(_doc == e._doc);
 
     Document::Impl& impl = getDocument().getImpl();
-    ElementRep& newRep = impl.getElementRep(e._repIdx);
 
     // check that new element roots a clean subtree.
-    if (!canAttach(e._repIdx, newRep))
-        return getAttachmentError(newRep);
-
-    ElementRep& thisRep = impl.getElementRep(_repIdx);
+    if (!canAttach(e._repIdx, impl.getElementRep(e._repIdx)))
+        return getAttachmentError(impl.getElementRep(e._repIdx));
 
-    dassert(thisRep.parent != kOpaqueRepIdx);
-    if (thisRep.parent == kInvalidRepIdx)
+    dassert(impl.getElementRep(_repIdx).parent != kOpaqueRepIdx);
+    if (impl.getElementRep(_repIdx).parent == kInvalidRepIdx)
         return Status(ErrorCodes::IllegalOperation,
                       "Attempt to add a sibling to an element without a parent");
 
+    // We need to realize any opaque left sibling, because we are going to need to set its
+    // right sibling. Do this before acquiring the reps since otherwise we would potentially
+    // invalidate them.
+    impl.resolveLeftSibling(_repIdx);
+
+    ElementRep& newRep = impl.getElementRep(e._repIdx);
+    ElementRep& thisRep = impl.getElementRep(_repIdx);
     ElementRep& parentRep = impl.getElementRep(thisRep.parent);
     dassert(!impl.isLeaf(parentRep));
 
@@ -1203,15 +1367,16 @@ Status Element::remove() {
     verify(ok());
     Document::Impl& impl = getDocument().getImpl();
 
-    // We need to realize any opaque right sibling, because we are going to need to set its
-    // left sibling. Do this before acquiring thisRep since otherwise we would potentially
-    // invalidate it.
+    if (impl.getElementRep(_repIdx).parent == kInvalidRepIdx)
+        return Status(ErrorCodes::IllegalOperation, "trying to remove a parentless element");
+
+    // We need to realize any opaque siblings, because we are going to need to set their
+    // links to each other. Do this before acquiring thisRep since otherwise we would
+    // potentially invalidate it.
     impl.resolveRightSibling(_repIdx);
+    impl.resolveLeftSibling(_repIdx);
 
     ElementRep& thisRep = impl.getElementRep(_repIdx);
-
-    if (thisRep.parent == kInvalidRepIdx)
-        return Status(ErrorCodes::IllegalOperation, "trying to remove a parentless element");
     impl.disableInPlaceUpdates();
 
     // If our right sibling is not the end of the object, then set its left sibling to be
@@ -1335,12 +1500,13 @@ bool Element::hasChildren() const {
 
 Element Element::leftSibling(size_t distance) const {
     verify(ok());
-    const Document::Impl& impl = getDocument().getImpl();
+
+    // As in rightSibling below, take Document::Impl by non-const ref so that an opaque
+    // left sibling can be lazily resolved.
+    Document::Impl& impl = _doc->getImpl();
     Element::RepIdx current = _repIdx;
-    while ((current != kInvalidRepIdx) && (distance-- != 0)) {
-        // We are (currently) never left opaque, so don't need to resolve.
-        current = impl.getElementRep(current).sibling.left;
-    }
+    while ((current != kInvalidRepIdx) && (distance-- != 0))
+        current = impl.resolveLeftSibling(current);
     return Element(_doc, current);
 }
 
@@ -1397,12 +1563,11 @@ Element Element::findElementNamed(StringData name) const {
 
 size_t Element::countSiblingsLeft() const {
     verify(ok());
-    const Document::Impl& impl = getDocument().getImpl();
+    Document::Impl& impl = _doc->getImpl();
     Element::RepIdx current = _repIdx;
     size_t result = 0;
     while (true) {
-        // We are (currently) never left opaque, so don't need to resolve.
-        current = impl.getElementRep(current).sibling.left;
+        current = impl.resolveLeftSibling(current);
         if (current == kInvalidRepIdx)
             break;
         ++result;
@@ -1432,7 +1597,25 @@ size_t Element::countChildren() const {
     size_t result = 0;
     while (current != kInvalidRepIdx) {
         ++result;
-        current = impl.resolveRightSibling(current);
+
+        const ElementRep& currentRep = impl.getElementRep(current);
+        if (currentRep.sibling.right != kOpaqueRepIdx) {
+            current = currentRep.sibling.right;
+            continue;
+        }
+
+        // Count the opaque region to our right in the serialized data rather than realizing
+        // it, up to the next child that was realized out of order, if any.
+        const BSONElement currentElt = impl.getSerializedElement(currentRep);
+        const BSONObj& obj = impl.getObject(currentRep.objIdx);
+        const char* pos = currentElt.rawdata() + currentElt.size();
+        const char* next = NULL;
+        current = impl.findUnlinkedRep(
+            currentRep.objIdx, pos, obj.objdata() + obj.objsize(), currentRep.parent, &next);
+        while ((pos != next) && (*pos != EOO)) {
+            ++result;
+            pos += BSONElement(pos).size();
+        }
     }
     return result;
 }
@@ -1953,12 +2136,9 @@ Status Element::addChild(Element e, bool front) {
         if (lc.ok())
             return lc.addSiblingLeft(e);
     } else {
-        // TODO: It is expensive to get the right child, since we have to build reps for
-        // all of the opaque children. But in principle, we don't really need them. Could
-        // we potentially add this element as a right child, leaving its left sibling
-        // opaque? We would at minimum need to update leftSibling, which currently assumes
-        // that your left sibling is never opaque. But adding new Elements to the end is a
-        // quite common operation, so it would be nice if we could do this efficiently.
+        // Getting the right child only builds reps for the first and last children,
+        // leaving the ones in between opaque, so adding to the end of a large array is
+        // cheap.
         Element rc = rightChild();
         if (rc.ok())
             return rc.addSiblingRight(e);
@@ -2085,6 +2265,39 @@ static void appendElement(BSONArrayBuilder* builder,
     builder->append(element);
 }
 
+// Helpers for Document::Impl::writeChildren below, which copy the serialized elements in
+// [begin, end) to 'builder' verbatim. An object can always take them as they are.
+static bool appendSerializedRun(BSONObjBuilder* builder, const char* begin, const char* end) {
+    builder->bb().appendBuf(begin, end - begin);
+    return true;
+}
+
+// Returns true if 'fieldName' is the decimal form of 'index', as an array would name it.
+static bool isArrayIndexName(StringData fieldName, int index) {
+    char digits[16];
+    size_t pos = sizeof(digits);
+    do {
+        digits[--pos] = '0' + (index % 10);
+        index /= 10;
+    } while (index != 0);
+    return fieldName == StringData(digits + pos, sizeof(digits) - pos);
+}
+
+// An array can only take the elements as they are if their field names are the indexes the
+// builder would give them, which is not the case if an earlier element was added or removed.
+// Returns false, appending nothing, if they are not.
+static bool appendSerializedRun(BSONArrayBuilder* builder, const char* begin, const char* end) {
+    int count = 0;
+    for (const char* pos = begin; pos != end; ++count) {
+        const BSONElement element(pos);
+        if (!isArrayIndexName(element.fieldNameStringData(), builder->arrSize() + count))
+            return false;
+        pos += element.size();
+    }
+    builder->appendSerializedElements(begin, end - begin, count);
+    return true;
+}
+
 }  // namespace
 
 template <typename Builder>
@@ -2117,15 +2330,6 @@ void Document::Impl::writeElement(Element::RepIdx repIdx,
 
 template <typename Builder>
 void Document::Impl::writeChildren(Element::RepIdx repIdx, Builder* builder) const {
-    // TODO: In theory, I think we can walk rightwards building a write region from all
-    // serialized embedded children that share an obj id and form a contiguous memory
-    // region. For arrays we would need to know something about how many elements we wrote
-    // that way so that the indexes would come out right.
-    //
-    // However, that involves walking the memory twice: once to build the copy region, and
-    // another time to actually copy it. It is unclear if this is better than just walking
-    // it once with the recursive solution.
-
     const ElementRep& rep = getElementRep(repIdx);
 
     // OK, need to resolve left if we haven't done that yet.
@@ -2137,9 +2341,9 @@ void Document::Impl::writeChildren(Element::RepIdx repIdx, Builder* builder) con
     while (current != Element::kInvalidRepIdx) {
         writeElement(current, builder);
 
-        // If we have an opaque region to the right, and we are not in an array, then we
-        // can bulk copy from the end of the element we just wrote to the end of our
-        // parent.
+        // If we have an opaque region to the right, then we can bulk copy from the end of
+        // the element we just wrote up to the next child that was realized out of order, or
+        // to the end of our parent if there is none.
         const ElementRep& currentRep = getElementRep(current);
 
         if (currentRep.sibling.right == Element::kOpaqueRepIdx) {
@@ -2147,28 +2351,27 @@ void Document::Impl::writeChildren(Element::RepIdx repIdx, Builder* builder) con
             // siblings.
             const ElementRep& parentRep = getElementRep(currentRep.parent);
 
-            // Bulk copying right only works on objects
-            if ((getType(parentRep) == mongo::Object) && (currentRep.objIdx != kInvalidObjIdx) &&
-                (currentRep.objIdx == parentRep.objIdx)) {
+            if ((currentRep.objIdx != kInvalidObjIdx) && (currentRep.objIdx == parentRep.objIdx)) {
                 BSONElement currentElt = getSerializedElement(currentRep);
-                const uint32_t currentSize = currentElt.size();
 
                 const BSONObj parentObj = (currentRep.parent == kRootRepIdx)
                     ? getObject(parentRep.objIdx)
                     : getSerializedElement(parentRep).Obj();
-                const uint32_t parentSize = parentObj.objsize();
-
-                const uint32_t currentEltOffset = getElementOffset(parentObj, currentElt);
-                const uint32_t nextEltOffset = currentEltOffset + currentSize;
-
-                const char* copyBegin = parentObj.objdata() + nextEltOffset;
-                const uint32_t copyBytes = parentSize - nextEltOffset;
 
+                const char* copyBegin = currentElt.rawdata() + currentElt.size();
                 // The -1 is because we don't want to copy in the terminal EOO.
-                builder->bb().appendBuf(copyBegin, copyBytes - 1);
-
-                // We are done with all children.
-                break;
+                const char* copyEnd = parentObj.objdata() + parentObj.objsize() - 1;
+                const Element::RepIdx next = findUnlinkedRep(
+                    currentRep.objIdx, copyBegin, copyEnd, currentRep.parent, &copyEnd);
+
+                if (appendSerializedRun(builder, copyBegin, copyEnd)) {
+                    // We are done with all children, or resume with the next one that was
+                    // realized out of order.
+                    if (next == Element::kInvalidRepIdx)
+                        break;
+                    current = next;
+                    continue;
+                }
             }
 
             // We couldn't bulk copy, and our right sibling is opaque. We need to
@@ -2220,6 +2423,10 @@ void Document::disableInPlaceUpdates() {
     return getImpl().disableInPlaceUpdates();
 }
 
+size_t Document::getNumMaterializedElements() const {
+    return getImpl().getNumMaterializedElements();
+}
+
 Document::InPlaceMode Document::getCurrentInPlaceMode() const {
     return getImpl().getCurrentInPlaceMode();
 }
@@ -437,6 +437,13 @@ public:
 
     inline std::string toString() const;
 
+    /** Returns the number of Elements realized from the serialized BSON backing this
+     *  document since it was constructed or last reset. Children which are never visited
+     *  stay opaque, so this measures how much of the document the mutations so far have
+     *  had to expand.
+     */
+    size_t getNumMaterializedElements() const;
+
     //
     // In-place API.
     //
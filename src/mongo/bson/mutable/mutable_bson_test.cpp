@@ -1230,6 +1230,98 @@ TEST(Document, AddRightSiblingToElementWithOpaqueRightSibling) {
     ASSERT_EQUALS(mongo::fromjson(outJson), outObj);
 }
 
+// Returns { a : [ 0, 1, ..., n - 1 ], b : 1 }.
+mongo::BSONObj makeArrayDocument(int n) {
+    mongo::BSONObjBuilder builder;
+    mongo::BSONArrayBuilder arrayBuilder(builder.subarrayStart("a"));
+    for (int i = 0; i < n; ++i)
+        arrayBuilder.append(i);
+    arrayBuilder.doneFast();
+    builder.append("b", 1);
+    return builder.obj();
+}
+
+TEST(Document, PushBackOnlyRealizesTheEndOfAnArray) {
+    mmb::Document doc(makeArrayDocument(1000));
+    mmb::Element a = doc.root().leftChild();
+    ASSERT_EQUALS("a", a.getFieldName());
+    ASSERT_OK(a.pushBack(doc.makeElementInt("", 1000)));
+
+    // The array, its first element, and its last element: the elements in between, and
+    // the rest of the document, stay opaque.
+    ASSERT_EQUALS(3U, doc.getNumMaterializedElements());
+
+    ASSERT_EQUALS(1001U, a.countChildren());
+    ASSERT_EQUALS(3U, doc.getNumMaterializedElements());
+
+    mongo::BSONObjBuilder expected;
+    mongo::BSONArrayBuilder expectedArray(expected.subarrayStart("a"));
+    for (int i = 0; i <= 1000; ++i)
+        expectedArray.append(i);
+    expectedArray.doneFast();
+    expected.append("b", 1);
+    ASSERT_EQUALS(expected.obj(), doc.getObject());
+    ASSERT_EQUALS(3U, doc.getNumMaterializedElements());
+}
+
+TEST(Document, LeftSiblingOfRightChildIsResolved) {
+    mmb::Document doc(mongo::fromjson("{ a : [ 0, 1, 2, 3 ] }"));
+    mmb::Element a = doc.root().leftChild();
+
+    mmb::Element last = a.rightChild();
+    ASSERT_EQUALS(3, last.getValueInt());
+    ASSERT_EQUALS(3U, last.countSiblingsLeft());
+    ASSERT_EQUALS(2, last.leftSibling().getValueInt());
+    ASSERT_EQUALS(0, last.leftSibling(3).getValueInt());
+    ASSERT_FALSE(last.leftSibling(4).ok());
+    ASSERT_EQUALS(last, a.findNthChild(3));
+    ASSERT_EQUALS(4U, a.countChildren());
+}
+
+TEST(Document, RemoveRightChild) {
+    mmb::Document doc(mongo::fromjson("{ a : [ 0, 1, 2, 3 ], b : { x : 1, y : 2, z : 3 } }"));
+    ASSERT_OK(doc.root().leftChild().rightChild().remove());
+    ASSERT_OK(doc.root().rightChild().rightChild().remove());
+    ASSERT_EQUALS(mongo::fromjson("{ a : [ 0, 1, 2 ], b : { x : 1, y : 2 } }"), doc.getObject());
+}
+
+TEST(Document, AddSiblingLeftOfRightChild) {
+    mmb::Document doc(mongo::fromjson("{ a : [ 0, 1, 2, 3 ] }"));
+    mmb::Element last = doc.root().leftChild().rightChild();
+    ASSERT_OK(last.addSiblingLeft(doc.makeElementString("", "x")));
+    ASSERT_EQUALS(mongo::fromjson("{ a : [ 0, 1, 2, 'x', 3 ] }"), doc.getObject());
+}
+
+TEST(Document, SerializeArrayRealizedFromBothEnds) {
+    mmb::Document doc(makeArrayDocument(10));
+    mmb::Element a = doc.root().leftChild();
+    ASSERT_OK(a.pushBack(doc.makeElementInt("", 10)));
+    ASSERT_OK(a.findNthChild(5).setValueInt(50));
+    ASSERT_EQUALS(mongo::fromjson("{ a : [ 0, 1, 2, 3, 4, 50, 6, 7, 8, 9, 10 ], b : 1 }"),
+                  doc.getObject());
+}
+
+TEST(Document, SerializeArrayWithRenumberedElements) {
+    // Removing the first element shifts the indexes of all of the others, so none of the
+    // serialized elements can be copied as they are.
+    mmb::Document doc(makeArrayDocument(10));
+    mmb::Element a = doc.root().leftChild();
+    ASSERT_OK(a.pushBack(doc.makeElementInt("", 10)));
+    ASSERT_OK(a.leftChild().remove());
+    ASSERT_EQUALS(mongo::fromjson("{ a : [ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 ], b : 1 }"),
+                  doc.getObject());
+    ASSERT_EQUALS(10U, a.countChildren());
+}
+
+TEST(Document, PushBackOntoRoot) {
+    mmb::Document doc(mongo::fromjson("{ a : 1, b : 2, c : 3 }"));
+    ASSERT_OK(doc.root().pushBack(doc.makeElementInt("d", 4)));
+    ASSERT_EQUALS(4U, doc.root().countChildren());
+    ASSERT_EQUALS(mongo::fromjson("{ a : 1, b : 2, c : 3, d : 4 }"), doc.getObject());
+    ASSERT_OK(doc.root().leftChild().rightSibling().remove());
+    ASSERT_EQUALS(mongo::fromjson("{ a : 1, c : 3, d : 4 }"), doc.getObject());
+}
+
 TEST(Document, ArrayIndexedAccessFromJson) {
     static const char inJson[] =
         "{"
@@ -65,6 +65,8 @@ void PoolForHost::clear() {
 }
 
 void PoolForHost::done(DBConnectionPool* pool, DBClientBase* c) {
+    returnReservation();
+
     bool isFailed = c->isFailed();
 
     // Remember that this host had a broken connection for later
@@ -107,7 +109,7 @@ DBClientBase* PoolForHost::get(DBConnectionPool* pool, double socketTimeout) {
         StoredConnection sc = _pool.top();
         _pool.pop();
 
-        if (!sc.ok(now)) {
+        if (!sc.ok(now, _maxIdleTime)) {
             pool->onDestroy(sc.conn);
             delete sc.conn;
             continue;
@@ -137,7 +139,7 @@ void PoolForHost::getStaleConnections(vector<DBClientBase*>& stale) {
         StoredConnection c = _pool.top();
         _pool.pop();
 
-        if (c.ok(now))
+        if (c.ok(now, _maxIdleTime))
             all.push_back(c);
         else
             stale.push_back(c.conn);
@@ -154,11 +156,48 @@ PoolForHost::StoredConnection::StoredConnection(DBClientBase* c) {
     when = time(0);
 }
 
-bool PoolForHost::StoredConnection::ok(time_t now) {
+bool PoolForHost::StoredConnection::ok(time_t now, Seconds maxIdleTime) {
+    if (maxIdleTime > Seconds::zero() && now - when >= maxIdleTime.count()) {
+        return false;
+    }
+
     // Poke the connection to see if we're still ok
     return conn->isStillConnected();
 }
 
+bool PoolForHost::reserve(stdx::unique_lock<stdx::mutex>& lk, Date_t deadline) {
+    const auto hasFreeSlot = [this] {
+        return _maxInUse < 0 || _checkedOut < _maxInUse;
+    };
+
+    if (_waiters.empty() && hasFreeSlot()) {
+        _checkedOut++;
+        return true;
+    }
+
+    const auto me = _waiters.insert(_waiters.end(), _nextWaiterId++);
+    const uint64_t myId = *me;
+    const bool reserved = _slotFreed.wait_until(lk, deadline.toSystemTimePoint(), [&] {
+        return _waiters.front() == myId && hasFreeSlot();
+    });
+    _waiters.erase(me);
+
+    if (reserved) {
+        _checkedOut++;
+    }
+
+    // Whether it got a slot or gave up, the next waiter in line may now be able to go
+    _slotFreed.notify_all();
+    return reserved;
+}
+
+void PoolForHost::returnReservation() {
+    if (_checkedOut > 0) {
+        _checkedOut--;
+        _slotFreed.notify_all();
+    }
+}
+
 void PoolForHost::createdOne(DBClientBase* base) {
     if (_created == 0)
         _type = base->type();
@@ -178,17 +217,36 @@ const int PoolForHost::kPoolSizeUnlimited(-1);
 DBConnectionPool::DBConnectionPool()
     : _name("dbconnectionpool"),
       _maxPoolSize(PoolForHost::kPoolSizeUnlimited),
+      _maxInUse(PoolForHost::kPoolSizeUnlimited),
+      _maxWaitTime(Milliseconds::zero()),
+      _maxIdleTime(Seconds::zero()),
       _hooks(new list<DBConnectionHook*>()) {}
 
 DBClientBase* DBConnectionPool::_get(const string& ident, double socketTimeout) {
     uassert(17382, "Can't use connection pool during shutdown", !inShutdown());
-    stdx::lock_guard<stdx::mutex> L(_mutex);
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
     PoolForHost& p = _pools[PoolKey(ident, socketTimeout)];
     p.setMaxPoolSize(_maxPoolSize);
+    p.setMaxInUse(_maxInUse);
+    p.setMaxIdleTime(_maxIdleTime);
     p.initializeHostName(ident);
+
+    if (!p.reserve(lk, Date_t::now() + _maxWaitTime)) {
+        uasserted(ErrorCodes::ExceededTimeLimit,
+                  str::stream() << _name << ": timed out after " << _maxWaitTime
+                                << " waiting for one of the " << p.numInUse()
+                                << " connections in use to " << ident << " to be released");
+    }
+
+    // Either hands out a pooled connection or leaves the reservation for the caller to create one
     return p.get(this, socketTimeout);
 }
 
+void DBConnectionPool::_returnReservation(const string& ident, double socketTimeout) {
+    stdx::lock_guard<stdx::mutex> L(_mutex);
+    _pools[PoolKey(ident, socketTimeout)].returnReservation();
+}
+
 DBClientBase* DBConnectionPool::_finishCreate(const string& host,
                                               double socketTimeout,
                                               DBClientBase* conn) {
@@ -204,7 +262,7 @@ DBClientBase* DBConnectionPool::_finishCreate(const string& host,
         onCreate(conn);
         onHandedOut(conn);
     } catch (std::exception&) {
-        delete conn;
+        discard(host, conn);
         throw;
     }
 
@@ -217,14 +275,23 @@ DBClientBase* DBConnectionPool::get(const ConnectionString& url, double socketTi
         try {
             onHandedOut(c);
         } catch (std::exception&) {
-            delete c;
+            discard(url.toString(), c);
             throw;
         }
         return c;
     }
 
     string errmsg;
-    c = url.connect(errmsg, socketTimeout);
+    try {
+        c = url.connect(errmsg, socketTimeout);
+    } catch (...) {
+        _returnReservation(url.toString(), socketTimeout);
+        throw;
+    }
+
+    if (!c) {
+        _returnReservation(url.toString(), socketTimeout);
+    }
     uassert(13328, _name + ": connect failed " + url.toString() + " : " + errmsg, c);
 
     return _finishCreate(url.toString(), socketTimeout, c);
@@ -236,21 +303,28 @@ DBClientBase* DBConnectionPool::get(const string& host, double socketTimeout) {
         try {
             onHandedOut(c);
         } catch (std::exception&) {
-            delete c;
+            discard(host, c);
             throw;
         }
         return c;
     }
 
-    const ConnectionString cs(uassertStatusOK(ConnectionString::parse(host)));
-
     string errmsg;
-    c = cs.connect(errmsg, socketTimeout);
-    if (!c)
+    try {
+        const ConnectionString cs(uassertStatusOK(ConnectionString::parse(host)));
+        c = cs.connect(errmsg, socketTimeout);
+    } catch (...) {
+        _returnReservation(host, socketTimeout);
+        throw;
+    }
+
+    if (!c) {
+        _returnReservation(host, socketTimeout);
         throw SocketException(SocketException::CONNECT_ERROR,
                               host,
                               11002,
                               str::stream() << _name << " error: " << errmsg);
+    }
     return _finishCreate(host, socketTimeout, c);
 }
 
@@ -271,6 +345,11 @@ void DBConnectionPool::release(const string& host, DBClientBase* c) {
     _pools[PoolKey(host, c->getSoTimeout())].done(this, c);
 }
 
+void DBConnectionPool::discard(const string& host, DBClientBase* c) {
+    _returnReservation(host, c->getSoTimeout());
+    delete c;
+}
+
 
 DBConnectionPool::~DBConnectionPool() {
     // connection closing is handled by ~PoolForHost
@@ -336,6 +415,7 @@ void DBConnectionPool::onDestroy(DBClientBase* conn) {
 }
 
 void DBConnectionPool::appendInfo(BSONObjBuilder& b) {
+    int inUse = 0;
     int avail = 0;
     long long created = 0;
 
@@ -352,10 +432,13 @@ void DBConnectionPool::appendInfo(BSONObjBuilder& b) {
             string s = str::stream() << i->first.ident << "::" << i->first.timeout;
 
             BSONObjBuilder temp(bb.subobjStart(s));
+            temp.append("inUse", i->second.numInUse());
             temp.append("available", i->second.numAvailable());
             temp.appendNumber("created", i->second.numCreated());
+            temp.append("waiting", i->second.numWaiting());
             temp.done();
 
+            inUse += i->second.numInUse();
             avail += i->second.numAvailable();
             created += i->second.numCreated();
 
@@ -380,6 +463,7 @@ void DBConnectionPool::appendInfo(BSONObjBuilder& b) {
         temp.done();
     }
 
+    b.append("totalInUse", inUse);
     b.append("totalAvailable", avail);
     b.appendNumber("totalCreated", created);
 }
@@ -485,6 +569,15 @@ void ScopedDbConnection::done() {
     _conn = NULL;
 }
 
+void ScopedDbConnection::kill() {
+    if (!_conn) {
+        return;
+    }
+
+    globalConnPool.discard(_host, _conn);
+    _conn = NULL;
+}
+
 void ScopedDbConnection::_setSocketTimeout() {
     if (!_conn)
         return;
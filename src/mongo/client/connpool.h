@@ -30,12 +30,15 @@
 #pragma once
 
 #include <cstdint>
+#include <list>
 #include <stack>
 
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/util/background.h"
 #include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -54,15 +57,24 @@ public:
         : _created(0),
           _minValidCreationTimeMicroSec(0),
           _type(ConnectionString::INVALID),
-          _maxPoolSize(kPoolSizeUnlimited) {}
+          _maxPoolSize(kPoolSizeUnlimited),
+          _maxInUse(kPoolSizeUnlimited),
+          _maxIdleTime(Seconds::zero()),
+          _checkedOut(0),
+          _nextWaiterId(0) {}
 
     PoolForHost(const PoolForHost& other)
         : _created(other._created),
           _minValidCreationTimeMicroSec(other._minValidCreationTimeMicroSec),
           _type(other._type),
-          _maxPoolSize(other._maxPoolSize) {
+          _maxPoolSize(other._maxPoolSize),
+          _maxInUse(other._maxInUse),
+          _maxIdleTime(other._maxIdleTime),
+          _checkedOut(0),
+          _nextWaiterId(0) {
         verify(_created == 0);
         verify(other._pool.size() == 0);
+        verify(other._checkedOut == 0);
     }
 
     ~PoolForHost();
@@ -81,10 +93,50 @@ public:
         _maxPoolSize = maxPoolSize;
     }
 
+    /**
+     * Sets the maximum number of connections to this host which may be checked out of the pool
+     * at the same time. kPoolSizeUnlimited means no limit.
+     */
+    void setMaxInUse(int maxInUse) {
+        _maxInUse = maxInUse;
+    }
+
+    /**
+     * Sets how long a connection may sit unused in the pool before it is discarded. Zero means
+     * connections are only discarded once they are found to be disconnected.
+     */
+    void setMaxIdleTime(Seconds maxIdleTime) {
+        _maxIdleTime = maxIdleTime;
+    }
+
     int numAvailable() const {
         return (int)_pool.size();
     }
 
+    int numInUse() const {
+        return _checkedOut;
+    }
+
+    int numWaiting() const {
+        return static_cast<int>(_waiters.size());
+    }
+
+    /**
+     * Reserves one of the in use slots for a connection to this host, waiting in line behind the
+     * callers which asked before if all of them are taken. The lock must be the one held on the
+     * owning DBConnectionPool's mutex, and is released while waiting.
+     *
+     * Returns false without reserving anything if no slot frees up before the deadline. Every
+     * successful reservation must be given back with done() or returnReservation().
+     */
+    bool reserve(stdx::unique_lock<stdx::mutex>& lk, Date_t deadline);
+
+    /**
+     * Gives back a reservation whose connection was never created or was destroyed without being
+     * returned to the pool.
+     */
+    void returnReservation();
+
     void createdOne(DBClientBase* base);
     long long numCreated() const {
         return _created;
@@ -130,7 +182,7 @@ private:
     struct StoredConnection {
         StoredConnection(DBClientBase* c);
 
-        bool ok(time_t now);
+        bool ok(time_t now, Seconds maxIdleTime);
 
         DBClientBase* conn;
         time_t when;
@@ -145,6 +197,19 @@ private:
 
     // The maximum number of connections we'll save in the pool
     int _maxPoolSize;
+
+    // The maximum number of connections checked out at once and how long an unused one is kept
+    int _maxInUse;
+    Seconds _maxIdleTime;
+
+    // Number of connections handed out (or being created) and not yet given back
+    int _checkedOut;
+
+    // Callers waiting for a connection to be given back, in the order they asked. A waiter may
+    // only take a free slot once it is at the front.
+    std::list<uint64_t> _waiters;
+    uint64_t _nextWaiterId;
+    stdx::condition_variable _slotFreed;
 };
 
 class DBConnectionHook {
@@ -201,6 +266,30 @@ public:
         _maxPoolSize = maxPoolSize;
     }
 
+    /**
+     * Sets the maximum number of connections per-host which may be checked out at the same time.
+     * Once a host reaches it, get() waits in line for a connection to that host to be given back
+     * and fails with ExceededTimeLimit if none is within the max wait time.
+     */
+    void setMaxInUse(int maxInUse) {
+        _maxInUse = maxInUse;
+    }
+
+    /**
+     * Sets how long get() waits for a connection to a host which has reached its max in use.
+     */
+    void setMaxWaitTime(Milliseconds maxWaitTime) {
+        _maxWaitTime = maxWaitTime;
+    }
+
+    /**
+     * Sets how long an unused pooled connection is kept before the cleaner task closes it. Zero
+     * keeps pooled connections until they are found to be disconnected.
+     */
+    void setMaxIdleTime(Seconds maxIdleTime) {
+        _maxIdleTime = maxIdleTime;
+    }
+
     void onCreate(DBClientBase* conn);
     void onHandedOut(DBClientBase* conn);
     void onDestroy(DBClientBase* conn);
@@ -213,6 +302,12 @@ public:
 
     void release(const std::string& host, DBClientBase* c);
 
+    /**
+     * Deletes a connection obtained from get() which won't be released back to the pool, and
+     * frees up its in use slot for other callers.
+     */
+    void discard(const std::string& host, DBClientBase* c);
+
     void addHook(DBConnectionHook* hook);  // we take ownership
     void appendInfo(BSONObjBuilder& b);
 
@@ -250,6 +345,8 @@ private:
 
     DBClientBase* _get(const std::string& ident, double socketTimeout);
 
+    void _returnReservation(const std::string& ident, double socketTimeout);
+
     DBClientBase* _finishCreate(const std::string& ident, double socketTimeout, DBClientBase* conn);
 
     struct PoolKey {
@@ -272,6 +369,12 @@ private:
     // 0 effectively disables the pool
     int _maxPoolSize;
 
+    // Limits on the connections per-host which are checked out and on how long get() waits for
+    // one of them, and the time after which unused connections are closed
+    int _maxInUse;
+    Milliseconds _maxWaitTime;
+    Seconds _maxIdleTime;
+
     PoolMap _pools;
 
     // pointers owned by me, right now they leak on shutdown
@@ -363,10 +466,7 @@ public:
     /** Force closure of the connection.  You should call this if you leave it in
         a bad state.  Destructor will do this too, but it is verbose.
     */
-    void kill() {
-        delete _conn;
-        _conn = 0;
-    }
+    void kill();
 
     /** Call this when you are done with the connection.
 
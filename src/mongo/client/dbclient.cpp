@@ -62,6 +62,7 @@
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/log.h"
+#include "mongo/util/net/message_compressor.h"
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/net/ssl_options.h"
 #include "mongo/util/password_digest.h"
@@ -860,9 +861,13 @@ StatusWith<executor::RemoteCommandResponse> initWireVersion(DBClientBase* conn)
         // where we reconnect to an older version of MongoDB running at the same host/port.
         ScopedForceOpQuery forceOpQuery{conn};
 
+        BSONObjBuilder isMasterCmd;
+        isMasterCmd.append("isMaster", 1);
+        appendMessageCompressionRequest(&isMasterCmd);
+
         Date_t start{Date_t::now()};
         auto result = conn->runCommandWithMetadata(
-            "admin", "isMaster", rpc::makeEmptyMetadata(), BSON("isMaster" << 1));
+            "admin", "isMaster", rpc::makeEmptyMetadata(), isMasterCmd.done());
         Date_t finish{Date_t::now()};
 
         BSONObj isMasterObj = result->getCommandReply().getOwned();
@@ -911,6 +916,8 @@ Status DBClientConnection::connect(const HostAndPort& serverAddress) {
 
     _setServerRPCProtocols(swProtocolSet.getValue());
 
+    _port->setMessageCompressor(getNegotiatedMessageCompressor(swIsMasterReply.getValue().data));
+
     if (_hook) {
         auto validationStatus = _hook(swIsMasterReply.getValue());
         if (!validationStatus.isOK()) {
@@ -45,6 +45,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/rpc/metadata/server_selection_metadata.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -125,6 +126,35 @@ ReadPreferenceSetting* _extractReadPref(const BSONObj& query, int queryOptions)
         : mongo::ReadPreference::PrimaryOnly;
     return new ReadPreferenceSetting(pref, TagSet());
 }
+
+/**
+ * Reports an operation sent to a member of the set to the set's ReplicaSetMonitor, so that its
+ * round trip time and the number of operations in flight on that member steer server selection.
+ * The operation counts as failed unless succeeded() is called before this goes out of scope.
+ */
+class ScopedOperationReport {
+    MONGO_DISALLOW_COPYING(ScopedOperationReport);
+
+public:
+    ScopedOperationReport(ReplicaSetMonitorPtr monitor, const HostAndPort& host)
+        : _monitor(std::move(monitor)), _host(host) {
+        _monitor->startedOperation(_host);
+    }
+
+    ~ScopedOperationReport() {
+        _monitor->finishedOperation(_host, _succeeded ? _timer.micros() : -1);
+    }
+
+    void succeeded() {
+        _succeeded = true;
+    }
+
+private:
+    const ReplicaSetMonitorPtr _monitor;
+    const HostAndPort _host;
+    Timer _timer;
+    bool _succeeded = false;
+};
 }  // namespace
 
 // --------------------------------
@@ -144,6 +174,8 @@ DBClientReplicaSet::DBClientReplicaSet(const string& name,
 DBClientReplicaSet::~DBClientReplicaSet() {
     if (_lastSlaveOkConn.get() == _master.get()) {
         _lastSlaveOkConn.release();
+    } else if (_lastSlaveOkConn) {
+        globalConnPool.discard(_lastSlaveOkHost.toString(), _lastSlaveOkConn.release());
     }
 }
 
@@ -516,10 +548,13 @@ unique_ptr<DBClientCursor> DBClientReplicaSet::query(const string& ns,
                     break;
                 }
 
+                ScopedOperationReport report(_getMonitor(), _lastSlaveOkHost);
                 unique_ptr<DBClientCursor> cursor = conn->query(
                     ns, query, nToReturn, nToSkip, fieldsToReturn, queryOptions, batchSize);
 
-                return checkSlaveQueryResult(std::move(cursor));
+                cursor = checkSlaveQueryResult(std::move(cursor));
+                report.succeeded();
+                return cursor;
             } catch (const DBException& dbExcep) {
                 StringBuilder errMsgBuilder;
                 errMsgBuilder << "can't query replica set node " << _lastSlaveOkHost.toString()
@@ -569,7 +604,10 @@ BSONObj DBClientReplicaSet::findOne(const string& ns,
                     break;
                 }
 
-                return conn->findOne(ns, query, fieldsToReturn, queryOptions);
+                ScopedOperationReport report(_getMonitor(), _lastSlaveOkHost);
+                BSONObj obj = conn->findOne(ns, query, fieldsToReturn, queryOptions);
+                report.succeeded();
+                return obj;
             } catch (const DBException& dbExcep) {
                 StringBuilder errMsgBuilder;
                 errMsgBuilder << "can't findone replica set node " << _lastSlaveOkHost.toString()
@@ -918,7 +956,10 @@ rpc::UniqueReply DBClientReplicaSet::runCommandWithMetadata(StringData database,
             }
             // We can't move database and command in case this throws
             // and we retry.
-            return conn->runCommandWithMetadata(database, command, metadata, commandArgs);
+            ScopedOperationReport report(_getMonitor(), _lastSlaveOkHost);
+            auto reply = conn->runCommandWithMetadata(database, command, metadata, commandArgs);
+            report.succeeded();
+            return reply;
         } catch (const DBException& ex) {
             log() << exceptionToStatus();
             invalidateLastSlaveOkCache();
@@ -963,7 +1004,12 @@ bool DBClientReplicaSet::call(Message& toSend,
                         *actualServer = conn->getServerAddress();
                     }
 
-                    return conn->call(toSend, response, assertOk);
+                    ScopedOperationReport report(_getMonitor(), _lastSlaveOkHost);
+                    if (!conn->call(toSend, response, assertOk)) {
+                        return false;
+                    }
+                    report.succeeded();
+                    return true;
                 } catch (const DBException& dbExcep) {
                     LOG(1) << "can't call replica set node " << _lastSlaveOkHost << ": "
                            << causedBy(dbExcep) << endl;
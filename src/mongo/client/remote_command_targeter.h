@@ -66,6 +66,17 @@ public:
      */
     virtual StatusWith<HostAndPort> findHost(const ReadPreferenceSetting& readPref) = 0;
 
+    /**
+     * Obtains a host other than 'excluded' which also matches readPref, to send a hedged copy of a
+     * read to. Only consults the targeter's cached view, since a hedge is only worth sending if it
+     * can be sent right away.
+     *
+     * Returns OK and a host and port or FailedToSatisfyReadPreference if there is no other
+     * matching host.
+     */
+    virtual StatusWith<HostAndPort> findHedgeHost(const ReadPreferenceSetting& readPref,
+                                                  const HostAndPort& excluded) = 0;
+
     /**
      * Reports to the targeter that a NotMaster response was received when communicating with
      * "host', and so it should update its bookkeeping to avoid giving out the host again on a
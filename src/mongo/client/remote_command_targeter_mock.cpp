@@ -36,7 +36,9 @@
 namespace mongo {
 
 RemoteCommandTargeterMock::RemoteCommandTargeterMock()
-    : _findHostReturnValue(Status(ErrorCodes::InternalError, "No return value set")) {}
+    : _findHostReturnValue(Status(ErrorCodes::InternalError, "No return value set")),
+      _findHedgeHostReturnValue(
+          Status(ErrorCodes::FailedToSatisfyReadPreference, "No return value set")) {}
 
 RemoteCommandTargeterMock::~RemoteCommandTargeterMock() = default;
 
@@ -55,6 +57,11 @@ StatusWith<HostAndPort> RemoteCommandTargeterMock::findHost(const ReadPreference
     return _findHostReturnValue;
 }
 
+StatusWith<HostAndPort> RemoteCommandTargeterMock::findHedgeHost(
+    const ReadPreferenceSetting& readPref, const HostAndPort& excluded) {
+    return _findHedgeHostReturnValue;
+}
+
 void RemoteCommandTargeterMock::markHostNotMaster(const HostAndPort& host) {}
 
 void RemoteCommandTargeterMock::setConnectionStringReturnValue(const ConnectionString returnValue) {
@@ -65,4 +72,9 @@ void RemoteCommandTargeterMock::setFindHostReturnValue(StatusWith<HostAndPort> r
     _findHostReturnValue = std::move(returnValue);
 }
 
+void RemoteCommandTargeterMock::setFindHedgeHostReturnValue(
+    StatusWith<HostAndPort> returnValue) {
+    _findHedgeHostReturnValue = std::move(returnValue);
+}
+
 }  // namespace mongo
@@ -78,6 +78,24 @@ StatusWith<HostAndPort> RemoteCommandTargeterRS::findHost(const ReadPreferenceSe
     return hostAndPort;
 }
 
+StatusWith<HostAndPort> RemoteCommandTargeterRS::findHedgeHost(
+    const ReadPreferenceSetting& readPref, const HostAndPort& excluded) {
+    if (!_rsMonitor) {
+        return Status(ErrorCodes::ReplicaSetNotFound,
+                      str::stream() << "unknown replica set " << _rsName);
+    }
+
+    HostAndPort hostAndPort = _rsMonitor->getHedgeHost(readPref, excluded);
+    if (hostAndPort.empty()) {
+        return Status(ErrorCodes::FailedToSatisfyReadPreference,
+                      str::stream() << "could not find a host other than " << excluded.toString()
+                                    << " matching read preference " << readPref.toString()
+                                    << " for set " << _rsName);
+    }
+
+    return hostAndPort;
+}
+
 void RemoteCommandTargeterRS::markHostNotMaster(const HostAndPort& host) {
     invariant(_rsMonitor);
 
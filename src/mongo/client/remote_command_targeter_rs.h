@@ -54,6 +54,9 @@ public:
 
     StatusWith<HostAndPort> findHost(const ReadPreferenceSetting& readPref) override;
 
+    StatusWith<HostAndPort> findHedgeHost(const ReadPreferenceSetting& readPref,
+                                          const HostAndPort& excluded) override;
+
     void markHostNotMaster(const HostAndPort& host) override;
 
 private:
@@ -32,6 +32,7 @@
 #include "mongo/client/remote_command_targeter_standalone.h"
 
 #include "mongo/base/status_with.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
@@ -47,6 +48,13 @@ StatusWith<HostAndPort> RemoteCommandTargeterStandalone::findHost(
     return _hostAndPort;
 }
 
+StatusWith<HostAndPort> RemoteCommandTargeterStandalone::findHedgeHost(
+    const ReadPreferenceSetting& readPref, const HostAndPort& excluded) {
+    return Status(ErrorCodes::FailedToSatisfyReadPreference,
+                  str::stream() << "standalone host " << _hostAndPort.toString()
+                                << " has no other member to hedge reads to");
+}
+
 void RemoteCommandTargeterStandalone::markHostNotMaster(const HostAndPort& host) {
     dassert(host == _hostAndPort);
 }
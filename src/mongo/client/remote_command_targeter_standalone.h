@@ -45,6 +45,12 @@ public:
 
     StatusWith<HostAndPort> findHost(const ReadPreferenceSetting& readPref) override;
 
+    /**
+     * A standalone host has nowhere else to send a hedged read, so always fails.
+     */
+    StatusWith<HostAndPort> findHedgeHost(const ReadPreferenceSetting& readPref,
+                                          const HostAndPort& excluded) override;
+
     void markHostNotMaster(const HostAndPort& host) override;
 
 private:
@@ -201,6 +201,17 @@ bool compareLatencies(const Node* lhs, const Node* rhs) {
     return lhs->latencyMicros < rhs->latencyMicros;
 }
 
+/**
+ * Returns whether 'lhs' should be preferred to 'rhs' for a new operation: the node with fewer
+ * operations outstanding, or if they have as many, the one with the lower tail latency.
+ */
+bool isLessLoaded(const Node* lhs, const Node* rhs) {
+    if (lhs->outstandingOps != rhs->outstandingOps) {
+        return lhs->outstandingOps < rhs->outstandingOps;
+    }
+    return lhs->tailLatencyMicros() < rhs->tailLatencyMicros();
+}
+
 bool hostsEqual(const Node& lhs, const HostAndPort& rhs) {
     return lhs.host == rhs;
 }
@@ -282,6 +293,12 @@ HostAndPort ReplicaSetMonitor::getHostOrRefresh(const ReadPreferenceSetting& cri
     return startOrContinueRefresh().refreshUntilMatches(criteria);
 }
 
+HostAndPort ReplicaSetMonitor::getHedgeHost(const ReadPreferenceSetting& criteria,
+                                             const HostAndPort& excluded) const {
+    stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+    return _state->getMatchingHost(criteria, excluded);
+}
+
 HostAndPort ReplicaSetMonitor::getMasterOrUassert() {
     const ReadPreferenceSetting masterOnly(ReadPreference::PrimaryOnly, TagSet());
     HostAndPort master = getHostOrRefresh(masterOnly);
@@ -307,6 +324,25 @@ void ReplicaSetMonitor::failedHost(const HostAndPort& host) {
     DEV _state->checkInvariants();
 }
 
+void ReplicaSetMonitor::startedOperation(const HostAndPort& host) {
+    stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+    Node* node = _state->findNode(host);
+    if (node)
+        node->outstandingOps++;
+}
+
+void ReplicaSetMonitor::finishedOperation(const HostAndPort& host, int64_t latencyMicros) {
+    stdx::lock_guard<stdx::mutex> lk(_state->mutex);
+    Node* node = _state->findNode(host);
+    if (!node)
+        return;
+
+    // The node may have been removed and re-added to the set while the operation was running.
+    if (node->outstandingOps > 0)
+        node->outstandingOps--;
+    node->addLatencySample(latencyMicros);
+}
+
 bool ReplicaSetMonitor::isPrimary(const HostAndPort& host) const {
     stdx::lock_guard<stdx::mutex> lk(_state->mutex);
     Node* node = _state->findNode(host);
@@ -393,6 +429,13 @@ void ReplicaSetMonitor::appendInfo(BSONObjBuilder& bsonObjBuilder) const {
         }
         builder.append("pingTimeMillis", pingTimeMillis);
 
+        const int64_t tailLatencyMicros = node.tailLatencyMicros();
+        if (tailLatencyMicros != Node::unknownLatency) {
+            builder.append("tailLatencyMillis",
+                           static_cast<long long>(tailLatencyMicros / 1000));
+        }
+        builder.append("outstandingOps", node.outstandingOps);
+
         if (!node.tags.isEmpty()) {
             builder.append("tags", node.tags);
         }
@@ -788,6 +831,7 @@ void IsMasterReply::parse(const BSONObj& obj) {
 }
 
 const int64_t Node::unknownLatency = numeric_limits<int64_t>::max();
+const size_t Node::kLatencySamples;
 
 bool Node::matches(const ReadPreference pref) const {
     if (!isUp)
@@ -836,9 +880,29 @@ void Node::update(const IsMasterReply& reply) {
             // update latency with smoothed moving average (1/4th the delta)
             latencyMicros += (reply.latencyMicros - latencyMicros) / 4;
         }
+        addLatencySample(reply.latencyMicros);
     }
 }
 
+void Node::addLatencySample(int64_t sampleMicros) {
+    if (sampleMicros < 0)
+        return;
+
+    latencySamples.push_back(sampleMicros);
+    if (latencySamples.size() > kLatencySamples)
+        latencySamples.pop_front();
+}
+
+int64_t Node::tailLatencyMicros() const {
+    if (latencySamples.empty())
+        return unknownLatency;
+
+    std::vector<int64_t> samples(latencySamples.begin(), latencySamples.end());
+    const size_t rank = (samples.size() * 9) / 10;
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    return samples[rank];
+}
+
 SetState::SetState(StringData name, const std::set<HostAndPort>& seedNodes)
     : name(name.toString()),
       consecutiveFailedScans(0),
@@ -864,33 +928,34 @@ SetState::SetState(StringData name, const std::set<HostAndPort>& seedNodes)
     DEV checkInvariants();
 }
 
-HostAndPort SetState::getMatchingHost(const ReadPreferenceSetting& criteria) const {
+HostAndPort SetState::getMatchingHost(const ReadPreferenceSetting& criteria,
+                                      const HostAndPort& excluded) const {
     switch (criteria.pref) {
         // "Prefered" read preferences are defined in terms of other preferences
         case ReadPreference::PrimaryPreferred: {
-            HostAndPort out =
-                getMatchingHost(ReadPreferenceSetting(ReadPreference::PrimaryOnly, criteria.tags));
+            HostAndPort out = getMatchingHost(
+                ReadPreferenceSetting(ReadPreference::PrimaryOnly, criteria.tags), excluded);
             // NOTE: the spec says we should use the primary even if tags don't match
             if (!out.empty())
                 return out;
             return getMatchingHost(
-                ReadPreferenceSetting(ReadPreference::SecondaryOnly, criteria.tags));
+                ReadPreferenceSetting(ReadPreference::SecondaryOnly, criteria.tags), excluded);
         }
 
         case ReadPreference::SecondaryPreferred: {
             HostAndPort out = getMatchingHost(
-                ReadPreferenceSetting(ReadPreference::SecondaryOnly, criteria.tags));
+                ReadPreferenceSetting(ReadPreference::SecondaryOnly, criteria.tags), excluded);
             if (!out.empty())
                 return out;
             // NOTE: the spec says we should use the primary even if tags don't match
             return getMatchingHost(
-                ReadPreferenceSetting(ReadPreference::PrimaryOnly, criteria.tags));
+                ReadPreferenceSetting(ReadPreference::PrimaryOnly, criteria.tags), excluded);
         }
 
         case ReadPreference::PrimaryOnly: {
             // NOTE: isMaster implies isUp
             Nodes::const_iterator it = std::find_if(nodes.begin(), nodes.end(), isMaster);
-            if (it == nodes.end())
+            if (it == nodes.end() || it->host == excluded)
                 return HostAndPort();
             return it->host;
         }
@@ -904,7 +969,8 @@ HostAndPort SetState::getMatchingHost(const ReadPreferenceSetting& criteria) con
 
                 std::vector<const Node*> matchingNodes;
                 for (size_t i = 0; i < nodes.size(); i++) {
-                    if (nodes[i].matches(criteria.pref) && nodes[i].matches(tag)) {
+                    if (nodes[i].host != excluded && nodes[i].matches(criteria.pref) &&
+                        nodes[i].matches(tag)) {
                         matchingNodes.push_back(&nodes[i]);
                     }
                 }
@@ -928,13 +994,24 @@ HostAndPort SetState::getMatchingHost(const ReadPreferenceSetting& criteria) con
                     }
                 }
 
-                // of the remaining nodes, pick one at random (or use round-robin)
+                if (matchingNodes.size() == 1)
+                    return matchingNodes.front()->host;
+
+                // of the remaining nodes, pick the less loaded of two chosen at random (or use
+                // round-robin). Comparing only two keeps concurrent callers from all herding onto
+                // whichever node looked least loaded at the time.
                 if (ReplicaSetMonitor::useDeterministicHostSelection) {
                     // only in tests
                     return matchingNodes[roundRobin++ % matchingNodes.size()]->host;
                 } else {
                     // normal case
-                    return matchingNodes[rand.nextInt32(matchingNodes.size())]->host;
+                    const size_t first = rand.nextInt32(matchingNodes.size());
+                    size_t second = rand.nextInt32(matchingNodes.size() - 1);
+                    if (second >= first)
+                        second++;
+                    return isLessLoaded(matchingNodes[second], matchingNodes[first])
+                        ? matchingNodes[second]->host
+                        : matchingNodes[first]->host;
                 };
             }
 
@@ -71,6 +71,14 @@ public:
      */
     HostAndPort getHostOrRefresh(const ReadPreferenceSetting& criteria);
 
+    /**
+     * Returns a host matching criteria other than 'excluded', or an empty HostAndPort if there is
+     * none. Used to pick the member a hedged read is sent to, so it only consults our cached view
+     * of the set and never refreshes it.
+     */
+    HostAndPort getHedgeHost(const ReadPreferenceSetting& criteria,
+                             const HostAndPort& excluded) const;
+
     /**
      * Returns the host we think is the current master or uasserts.
      *
@@ -95,6 +103,17 @@ public:
      */
     void failedHost(const HostAndPort& host);
 
+    /**
+     * Notifies this Monitor that an operation was sent to a host, or that an operation sent to it
+     * has completed. Hosts with fewer operations outstanding, then with lower recent latencies,
+     * are preferred when several hosts match a read preference.
+     *
+     * Pass a negative latency if the operation failed, as its duration is then not a meaningful
+     * round trip time. Every startedOperation() must be matched by one finishedOperation().
+     */
+    void startedOperation(const HostAndPort& host);
+    void finishedOperation(const HostAndPort& host, int64_t latencyMicros);
+
     /**
      * Returns true if this node is the master based ONLY on local data. Be careful, return may
      * be stale.
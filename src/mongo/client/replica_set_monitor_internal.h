@@ -83,7 +83,8 @@ struct ReplicaSetMonitor::SetState {
 public:
     // A single node in the replicaSet
     struct Node {
-        explicit Node(const HostAndPort& host) : host(host), latencyMicros(unknownLatency) {
+        explicit Node(const HostAndPort& host)
+            : host(host), latencyMicros(unknownLatency), outstandingOps(0) {
             markFailed();
         }
 
@@ -114,14 +115,34 @@ public:
          */
         void update(const IsMasterReply& reply);
 
+        /**
+         * Records the round trip time of an isMaster ping or of an operation sent to this host.
+         */
+        void addLatencySample(int64_t sampleMicros);
+
+        /**
+         * Returns the 90th percentile of the recent latency samples, or unknownLatency if there
+         * are none.
+         */
+        int64_t tailLatencyMicros() const;
+
         // Intentionally chosen to compare worse than all known latencies.
         static const int64_t unknownLatency;  // = numeric_limits<int64_t>::max()
 
+        // How many of the most recent latency samples are kept.
+        static const size_t kLatencySamples = 32;
+
         HostAndPort host;
         bool isUp;
         bool isMaster;          // implies isUp
         int64_t latencyMicros;  // unknownLatency if unknown
         BSONObj tags;           // owned
+
+        // The most recent latency samples, oldest first.
+        std::deque<int64_t> latencySamples;
+
+        // Number of operations sent to this host which have not completed yet.
+        int outstandingOps;
     };
 
     typedef std::vector<Node> Nodes;
@@ -132,11 +153,13 @@ public:
     SetState(StringData name, const std::set<HostAndPort>& seedNodes);
 
     /**
-     * Returns a host matching criteria or an empty host if no known host matches.
+     * Returns a host matching criteria or an empty host if no known host matches. Never returns
+     * 'excluded', if it is set.
      *
      * Note: Uses only local data and does not go over the network.
      */
-    HostAndPort getMatchingHost(const ReadPreferenceSetting& criteria) const;
+    HostAndPort getMatchingHost(const ReadPreferenceSetting& criteria,
+                                const HostAndPort& excluded = HostAndPort()) const;
 
     /**
      * Returns the Node with the given host, or NULL if no Node has that host.
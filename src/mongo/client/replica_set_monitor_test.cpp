@@ -730,6 +730,106 @@ TEST(ReplicaSetMonitor, GetMatchingDuringScan) {
     ASSERT(ns.host.empty());
 }
 
+/**
+ * Returns the state of a set whose seeds have all been scanned, with "a" as its primary and "b"
+ * and "c" as its secondaries.
+ */
+SetStatePtr makeScannedSetState() {
+    SetStatePtr state = std::make_shared<SetState>("name", basicSeedsSet);
+    Refresher refresher(state);
+
+    for (size_t i = 0; i < basicSeeds.size(); i++) {
+        NextStep ns = refresher.getNextStep();
+        ASSERT_EQUALS(ns.step, NextStep::CONTACT_HOST);
+
+        bool primary = ns.host.host() == "a";
+        refresher.receivedIsMaster(ns.host,
+                                   -1,
+                                   BSON("setName"
+                                        << "name"
+                                        << "ismaster" << primary << "secondary" << !primary
+                                        << "hosts" << BSON_ARRAY("a"
+                                                                 << "b"
+                                                                 << "c") << "ok" << true));
+    }
+    ASSERT_EQUALS(refresher.getNextStep().step, NextStep::DONE);
+    return state;
+}
+
+// Ensure getMatchingHost never returns the excluded host, as used when picking a hedge target
+TEST(ReplicaSetMonitor, GetMatchingHostExcluded) {
+    SetStatePtr state = makeScannedSetState();
+
+    const ReadPreferenceSetting primaryOnly(ReadPreference::PrimaryOnly, TagSet());
+    const ReadPreferenceSetting secondaryOnly(ReadPreference::SecondaryOnly, TagSet());
+    const ReadPreferenceSetting secondaryPreferred(ReadPreference::SecondaryPreferred, TagSet());
+    const ReadPreferenceSetting nearest(ReadPreference::Nearest, TagSet());
+
+    ASSERT(state->getMatchingHost(primaryOnly, HostAndPort("a")).empty());
+    ASSERT_EQUALS(state->getMatchingHost(primaryOnly, HostAndPort("b")), HostAndPort("a"));
+
+    for (int i = 0; i < 20; i++) {
+        ASSERT_EQUALS(state->getMatchingHost(secondaryOnly, HostAndPort("b")), HostAndPort("c"));
+        ASSERT_EQUALS(state->getMatchingHost(secondaryPreferred, HostAndPort("c")),
+                      HostAndPort("b"));
+
+        HostAndPort host = state->getMatchingHost(nearest, HostAndPort("a"));
+        ASSERT(host == HostAndPort("b") || host == HostAndPort("c"));
+    }
+}
+
+// Ensure the host with fewer operations outstanding, then with the lower tail latency, is selected
+TEST(ReplicaSetMonitor, GetMatchingHostPrefersLessLoaded) {
+    SetStatePtr state = makeScannedSetState();
+    ReplicaSetMonitor monitor(state);
+    const ReadPreferenceSetting secondaryOnly(ReadPreference::SecondaryOnly, TagSet());
+
+    // With only two matching hosts, both are always compared.
+    for (int i = 0; i < 3; i++) {
+        monitor.startedOperation(HostAndPort("b"));
+    }
+    for (int i = 0; i < 20; i++) {
+        ASSERT_EQUALS(state->getMatchingHost(secondaryOnly), HostAndPort("c"));
+    }
+
+    monitor.startedOperation(HostAndPort("c"));
+    for (int i = 0; i < 3; i++) {
+        monitor.finishedOperation(HostAndPort("b"), 100);
+    }
+    for (int i = 0; i < 20; i++) {
+        ASSERT_EQUALS(state->getMatchingHost(secondaryOnly), HostAndPort("b"));
+    }
+
+    // Now neither has an operation outstanding, and "c" has been slower.
+    monitor.finishedOperation(HostAndPort("c"), 5000);
+    ASSERT_EQUALS(state->findNode(HostAndPort("c"))->outstandingOps, 0);
+    for (int i = 0; i < 20; i++) {
+        ASSERT_EQUALS(state->getMatchingHost(secondaryOnly), HostAndPort("b"));
+    }
+
+    // A failed operation is not a latency sample.
+    monitor.startedOperation(HostAndPort("b"));
+    monitor.finishedOperation(HostAndPort("b"), -1);
+    ASSERT_EQUALS(state->findNode(HostAndPort("b"))->latencySamples.size(), 3U);
+}
+
+TEST(ReplicaSetMonitor, NodeTailLatency) {
+    Node node(HostAndPort("a"));
+    ASSERT_EQUALS(node.tailLatencyMicros(), Node::unknownLatency);
+
+    for (int64_t i = 1; i <= 10; i++) {
+        node.addLatencySample(i);
+    }
+    ASSERT_EQUALS(node.tailLatencyMicros(), 10);
+
+    // Only the most recent samples count.
+    for (size_t i = 0; i < Node::kLatencySamples; i++) {
+        node.addLatencySample(i % 2 ? 1000 : 1);
+    }
+    ASSERT_EQUALS(node.latencySamples.size(), Node::kLatencySamples);
+    ASSERT_EQUALS(node.tailLatencyMicros(), 1000);
+}
+
 // Ensure nothing breaks when out-of-band failedHost is called during scan
 TEST(ReplicaSetMonitor, OutOfBandFailedHost) {
     SetStatePtr state = std::make_shared<SetState>("name", basicSeedsSet);
@@ -34,6 +34,7 @@
 
 #include "mongo/base/parse_number.h"
 #include "mongo/client/sasl_client_session.h"
+#include "mongo/client/scram_sha1_client_cache.h"
 #include "mongo/platform/random.h"
 #include "mongo/util/base64.h"
 #include "mongo/util/mongoutils/str.h"
@@ -178,12 +179,19 @@ StatusWith<bool> SaslSCRAMSHA1ClientConversation::_secondStep(const std::vector<
         return StatusWith<bool>(ex.toStatus());
     }
 
-    scram::generateSaltedPassword(
-        _saslClientSession->getParameter(SaslClientSession::parameterPassword),
-        reinterpret_cast<const unsigned char*>(decodedSalt.c_str()),
-        decodedSalt.size(),
-        iterationCount,
-        _saltedPassword);
+    // The salted password is expensive to compute, so share it across conversations
+    StringData user = _saslClientSession->getParameter(SaslClientSession::parameterUser);
+    StringData password = _saslClientSession->getParameter(SaslClientSession::parameterPassword);
+    SCRAMSHA1ClientCache* cache = getGlobalSCRAMSHA1ClientCache();
+
+    if (!cache->getSaltedPassword(user, password, decodedSalt, iterationCount, _saltedPassword)) {
+        scram::generateSaltedPassword(password,
+                                      reinterpret_cast<const unsigned char*>(decodedSalt.c_str()),
+                                      decodedSalt.size(),
+                                      iterationCount,
+                                      _saltedPassword);
+        cache->setSaltedPassword(user, password, decodedSalt, iterationCount, _saltedPassword);
+    }
 
     std::string clientProof = scram::generateClientProof(_saltedPassword, _authMessage);
 
@@ -253,6 +253,8 @@ public:
         delete _dummyServer;
 
         globalConnPool.setMaxPoolSize(_maxPoolSizePerHost);
+        globalConnPool.setMaxInUse(PoolForHost::kPoolSizeUnlimited);
+        globalConnPool.setMaxIdleTime(Seconds::zero());
     }
 
 protected:
@@ -432,5 +434,78 @@ TEST_F(DummyServerFixture, DontReturnConnGoneBadToPool) {
     conn1Again.done();
 }
 
+TEST_F(DummyServerFixture, TimeOutWaitingForConnInUse) {
+    globalConnPool.setMaxInUse(2);
+    globalConnPool.setMaxWaitTime(Milliseconds(10));
+
+    ScopedDbConnection conn1(TARGET_HOST);
+    ScopedDbConnection conn2(TARGET_HOST);
+
+    try {
+        ScopedDbConnection conn3(TARGET_HOST);
+        FAIL("expected to time out waiting for a connection");
+    } catch (const UserException& ex) {
+        ASSERT_EQUALS(ErrorCodes::ExceededTimeLimit, ex.getCode());
+    }
+
+    DBClientBase* conn1Ptr = conn1.get();
+    conn1.done();
+
+    ScopedDbConnection conn3(TARGET_HOST);
+    ASSERT_EQUALS(conn1Ptr, conn3.get());
+
+    conn2.done();
+    conn3.done();
+}
+
+TEST_F(DummyServerFixture, KilledConnFreesInUseSlot) {
+    globalConnPool.setMaxInUse(1);
+    globalConnPool.setMaxWaitTime(Milliseconds(10));
+
+    {
+        ScopedDbConnection conn1(TARGET_HOST);
+        conn1.kill();
+    }
+
+    ScopedDbConnection conn2(TARGET_HOST);
+    conn2.done();
+}
+
+TEST_F(DummyServerFixture, WaiterGetsReleasedConn) {
+    globalConnPool.setMaxInUse(1);
+    globalConnPool.setMaxWaitTime(Milliseconds(30 * 1000));
+
+    ScopedDbConnection conn1(TARGET_HOST);
+    DBClientBase* conn1Ptr = conn1.get();
+
+    DBClientBase* waiterConnPtr = NULL;
+    stdx::thread waiter([&waiterConnPtr] {
+        ScopedDbConnection conn2(TARGET_HOST);
+        waiterConnPtr = conn2.get();
+        conn2.done();
+    });
+
+    sleepmillis(100);
+    conn1.done();
+    waiter.join();
+
+    ASSERT_EQUALS(conn1Ptr, waiterConnPtr);
+}
+
+TEST_F(DummyServerFixture, IdleConnIsNotReused) {
+    globalConnPool.setMaxIdleTime(Seconds(1));
+
+    ScopedDbConnection conn1(TARGET_HOST);
+    const uint64_t conn1CreationTime = conn1->getSockCreationMicroSec();
+    conn1.done();
+
+    sleepsecs(2);
+    globalConnPool.taskDoWork();
+
+    ScopedDbConnection conn2(TARGET_HOST);
+    ASSERT_GREATER_THAN(conn2->getSockCreationMicroSec(), conn1CreationTime);
+    conn2.done();
+}
+
 }  // namespace
 }  // namespace mongo
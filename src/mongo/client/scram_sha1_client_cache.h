@@ -0,0 +1,101 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <tuple>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/crypto/mechanism_scram.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+/**
+ * Cache of the SCRAM-SHA-1 salted passwords computed by the client side of the conversation.
+ *
+ * Computing the salted password takes thousands of HMAC iterations, but its result only depends
+ * on the password and on the salt and iteration count the server holds for the user, so it can
+ * be reused by every connection authenticating as the same user.
+ *
+ * An entry is only returned for the password it was computed from, so changing the password of
+ * a user implicitly invalidates its entries. This type is thread safe.
+ */
+class SCRAMSHA1ClientCache {
+    MONGO_DISALLOW_COPYING(SCRAMSHA1ClientCache);
+
+public:
+    SCRAMSHA1ClientCache() = default;
+    ~SCRAMSHA1ClientCache();
+
+    /**
+     * Copies the salted password of "user" for "salt" and "iterationCount" into
+     * "saltedPassword" and returns true, if one was stored for "hashedPassword".
+     */
+    bool getSaltedPassword(StringData user,
+                           StringData hashedPassword,
+                           StringData salt,
+                           int iterationCount,
+                           unsigned char saltedPassword[scram::hashSize]);
+
+    /**
+     * Stores the salted password of "user" for "salt" and "iterationCount", replacing any entry
+     * computed from a different password.
+     */
+    void setSaltedPassword(StringData user,
+                           StringData hashedPassword,
+                           StringData salt,
+                           int iterationCount,
+                           const unsigned char saltedPassword[scram::hashSize]);
+
+    /**
+     * Forgets all the stored salted passwords.
+     */
+    void clear();
+
+private:
+    using Key = std::tuple<std::string, std::string, int>;
+
+    struct Entry {
+        std::string hashedPassword;
+        unsigned char saltedPassword[scram::hashSize];
+    };
+
+    stdx::mutex _mutex;
+    std::map<Key, Entry> _entries;
+};
+
+/**
+ * The cache shared by all the SCRAM-SHA-1 client conversations of this process.
+ */
+SCRAMSHA1ClientCache* getGlobalSCRAMSHA1ClientCache();
+
+}  // namespace mongo
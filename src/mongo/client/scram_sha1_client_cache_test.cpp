@@ -0,0 +1,90 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <cstring>
+
+#include "mongo/client/scram_sha1_client_cache.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const unsigned char kSaltedPassword[scram::hashSize] = {
+    1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20};
+
+TEST(SCRAMSHA1ClientCache, ReturnsStoredSaltedPassword) {
+    SCRAMSHA1ClientCache cache;
+    unsigned char saltedPassword[scram::hashSize];
+
+    ASSERT_FALSE(cache.getSaltedPassword("user", "pwd", "salt", 10000, saltedPassword));
+
+    cache.setSaltedPassword("user", "pwd", "salt", 10000, kSaltedPassword);
+    ASSERT_TRUE(cache.getSaltedPassword("user", "pwd", "salt", 10000, saltedPassword));
+    ASSERT_EQUALS(0, memcmp(kSaltedPassword, saltedPassword, scram::hashSize));
+}
+
+TEST(SCRAMSHA1ClientCache, KeyedByUserSaltAndIterationCount) {
+    SCRAMSHA1ClientCache cache;
+    unsigned char saltedPassword[scram::hashSize];
+
+    cache.setSaltedPassword("user", "pwd", "salt", 10000, kSaltedPassword);
+
+    ASSERT_FALSE(cache.getSaltedPassword("other", "pwd", "salt", 10000, saltedPassword));
+    ASSERT_FALSE(cache.getSaltedPassword("user", "pwd", "pepper", 10000, saltedPassword));
+    ASSERT_FALSE(cache.getSaltedPassword("user", "pwd", "salt", 5000, saltedPassword));
+}
+
+TEST(SCRAMSHA1ClientCache, PasswordChangeInvalidates) {
+    SCRAMSHA1ClientCache cache;
+    unsigned char saltedPassword[scram::hashSize];
+
+    cache.setSaltedPassword("user", "pwd", "salt", 10000, kSaltedPassword);
+    ASSERT_FALSE(cache.getSaltedPassword("user", "newPwd", "salt", 10000, saltedPassword));
+
+    unsigned char newSaltedPassword[scram::hashSize];
+    memset(newSaltedPassword, 42, scram::hashSize);
+    cache.setSaltedPassword("user", "newPwd", "salt", 10000, newSaltedPassword);
+
+    ASSERT_FALSE(cache.getSaltedPassword("user", "pwd", "salt", 10000, saltedPassword));
+    ASSERT_TRUE(cache.getSaltedPassword("user", "newPwd", "salt", 10000, saltedPassword));
+    ASSERT_EQUALS(0, memcmp(newSaltedPassword, saltedPassword, scram::hashSize));
+}
+
+TEST(SCRAMSHA1ClientCache, Clear) {
+    SCRAMSHA1ClientCache cache;
+    unsigned char saltedPassword[scram::hashSize];
+
+    cache.setSaltedPassword("user", "pwd", "salt", 10000, kSaltedPassword);
+    cache.clear();
+    ASSERT_FALSE(cache.getSaltedPassword("user", "pwd", "salt", 10000, saltedPassword));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -93,6 +93,7 @@ Status AuthorizationSession::addAndAuthorizeUser(OperationContext* txn, const Us
     // If there are any users and roles in the impersonation data, clear it out.
     clearImpersonatedUserData();
 
+    _authorizedActionsCache.clear();
     _buildAuthenticatedRolesVector();
     return Status::OK();
 }
@@ -107,6 +108,7 @@ void AuthorizationSession::logoutDatabase(const std::string& dbname) {
         getAuthorizationManager().releaseUser(removedUser);
     }
     clearImpersonatedUserData();
+    _authorizedActionsCache.clear();
     _buildAuthenticatedRolesVector();
 }
 
@@ -131,6 +133,7 @@ std::string AuthorizationSession::getAuthenticatedUserNamesToken() {
 
 void AuthorizationSession::grantInternalAuthorization() {
     _authenticatedUsers.add(internalSecurity.user);
+    _authorizedActionsCache.clear();
     _buildAuthenticatedRolesVector();
 }
 
@@ -510,6 +513,7 @@ void AuthorizationSession::_refreshUserInfoAsNeeded(OperationContext* txn) {
                     // Success! Replace the old User object with the updated one.
                     fassert(17067, _authenticatedUsers.replaceAt(it, updatedUser) == user);
                     authMan.releaseUser(user);
+                    _authorizedActionsCache.clear();
                     LOG(1) << "Updated session cache of user information for " << name;
                     break;
                 }
@@ -517,6 +521,7 @@ void AuthorizationSession::_refreshUserInfoAsNeeded(OperationContext* txn) {
                     // User does not exist anymore; remove it from _authenticatedUsers.
                     fassert(17068, _authenticatedUsers.removeAt(it) == user);
                     authMan.releaseUser(user);
+                    _authorizedActionsCache.clear();
                     log() << "Removed deleted user " << name
                           << " from session cache of user information.";
                     continue;  // No need to advance "it" in this case.
@@ -549,23 +554,34 @@ void AuthorizationSession::_buildAuthenticatedRolesVector() {
 bool AuthorizationSession::_isAuthorizedForPrivilege(const Privilege& privilege) {
     const ResourcePattern& target(privilege.getResourcePattern());
 
+    // Default privileges come and go with the localhost exception, so they aren't cached.
+    if (_externalState->shouldAllowLocalhost()) {
+        return _getAuthorizedActions(target).isSupersetOf(privilege.getActions());
+    }
+
+    auto it = _authorizedActionsCache.find(target);
+    if (it == _authorizedActionsCache.end()) {
+        if (_authorizedActionsCache.size() >= kMaxAuthorizedActionsCacheSize) {
+            _authorizedActionsCache.clear();
+        }
+        it = _authorizedActionsCache.emplace(target, _getAuthorizedActions(target)).first;
+    }
+    return it->second.isSupersetOf(privilege.getActions());
+}
+
+ActionSet AuthorizationSession::_getAuthorizedActions(const ResourcePattern& target) {
     ResourcePattern resourceSearchList[resourceSearchListCapacity];
     const int resourceSearchListLength = buildResourceSearchList(target, resourceSearchList);
 
-    ActionSet unmetRequirements = privilege.getActions();
+    ActionSet actions;
 
     PrivilegeVector defaultPrivileges = getDefaultPrivileges();
     for (PrivilegeVector::iterator it = defaultPrivileges.begin(); it != defaultPrivileges.end();
          ++it) {
         for (int i = 0; i < resourceSearchListLength; ++i) {
-            if (!(it->getResourcePattern() == resourceSearchList[i]))
-                continue;
-
-            ActionSet userActions = it->getActions();
-            unmetRequirements.removeAllActionsFromSet(userActions);
-
-            if (unmetRequirements.empty())
-                return true;
+            if (it->getResourcePattern() == resourceSearchList[i]) {
+                actions.addAllActionsFromSet(it->getActions());
+            }
         }
     }
 
@@ -573,15 +589,11 @@ bool AuthorizationSession::_isAuthorizedForPrivilege(const Privilege& privilege)
          ++it) {
         User* user = *it;
         for (int i = 0; i < resourceSearchListLength; ++i) {
-            ActionSet userActions = user->getActionsForResource(resourceSearchList[i]);
-            unmetRequirements.removeAllActionsFromSet(userActions);
-
-            if (unmetRequirements.empty())
-                return true;
+            actions.addAllActionsFromSet(user->getActionsForResource(resourceSearchList[i]));
         }
     }
 
-    return false;
+    return actions;
 }
 
 void AuthorizationSession::setImpersonatedUserData(std::vector<UserName> usernames,
@@ -42,6 +42,7 @@
 #include "mongo/db/auth/user_name.h"
 #include "mongo/db/auth/user_set.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/platform/unordered_map.h"
 
 namespace mongo {
 class ClientBasic;
@@ -259,6 +260,10 @@ private:
     // lock on the admin database (to update out-of-date user privilege information).
     bool _isAuthorizedForPrivilege(const Privilege& privilege);
 
+    // Returns all the actions the authenticated users may perform on 'target', including those
+    // granted through ResourcePatterns which match it.
+    ActionSet _getAuthorizedActions(const ResourcePattern& target);
+
     std::unique_ptr<AuthzSessionExternalState> _externalState;
 
     // All Users who have been authenticated on this connection.
@@ -267,6 +272,12 @@ private:
     // users set is changed.
     std::vector<RoleName> _authenticatedRoleNames;
 
+    // The result of _getAuthorizedActions() for recently checked resources. It is cleared
+    // whenever _authenticatedUsers changes, and is not used while the localhost exception grants
+    // default privileges, as those disappear once the first user is created.
+    static const size_t kMaxAuthorizedActionsCacheSize = 256;
+    unordered_map<ResourcePattern, ActionSet> _authorizedActionsCache;
+
     // A vector of impersonated UserNames and a vector of those users' RoleNames.
     // These are used in the auditing system. They are not used for authz checks.
     std::vector<UserName> _impersonatedUserNames;
@@ -505,5 +505,47 @@ TEST_F(AuthorizationSessionTest, UseOldUserInfoInFaceOfConnectivityProblems) {
         authzSession->isAuthorizedForActionsOnResource(testFooCollResource, ActionType::insert));
 }
 
+TEST_F(AuthorizationSessionTest, LocalhostExceptionPrivilegesAreNotCached) {
+    sessionState->setReturnValueForShouldAllowLocalhost(true);
+    ASSERT_TRUE(
+        authzSession->isAuthorizedForActionsOnResource(adminDBResource, ActionType::createUser));
+
+    // The first user was created, which ends the localhost exception.
+    sessionState->setReturnValueForShouldAllowLocalhost(false);
+    ASSERT_FALSE(
+        authzSession->isAuthorizedForActionsOnResource(adminDBResource, ActionType::createUser));
+    ASSERT_FALSE(
+        authzSession->isAuthorizedForActionsOnResource(adminDBResource, ActionType::createUser));
+}
+
+TEST_F(AuthorizationSessionTest, ChecksOnManyResourcesStayCorrect) {
+    ASSERT_OK(managerState->insertPrivilegeDocument(&_txn,
+                                                    BSON("user"
+                                                         << "spencer"
+                                                         << "db"
+                                                         << "test"
+                                                         << "credentials" << BSON("MONGODB-CR"
+                                                                                  << "a") << "roles"
+                                                         << BSON_ARRAY(BSON("role"
+                                                                            << "readWrite"
+                                                                            << "db"
+                                                                            << "test"))),
+                                                    BSONObj()));
+    ASSERT_OK(authzSession->addAndAuthorizeUser(&_txn, UserName("spencer", "test")));
+
+    // Check more resources than the session remembers, twice over.
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < 1000; i++) {
+            const std::string coll = str::stream() << "coll" << i;
+            ASSERT_TRUE(authzSession->isAuthorizedForActionsOnResource(
+                ResourcePattern::forExactNamespace(NamespaceString("test", coll)),
+                ActionType::insert));
+            ASSERT_FALSE(authzSession->isAuthorizedForActionsOnResource(
+                ResourcePattern::forExactNamespace(NamespaceString("other", coll)),
+                ActionType::find));
+        }
+    }
+}
+
 }  // namespace
 }  // namespace mongo
@@ -53,12 +53,16 @@
 #include "mongo/db/ops/update_request.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage/mmap_v1/mmap_v1_options.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/db/storage/record_store.h"
 
 #include "mongo/db/auth/user_document_parser.h"  // XXX-ANDY
 #include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
+#include "third_party/murmurhash3/MurmurHash3.h"
 
 namespace mongo {
 
@@ -107,6 +111,9 @@ std::string CompactOptions::toString() const {
     }
 
     ss << " validateDocuments: " << validateDocuments;
+    if (online) {
+        ss << " online: true maxBytesPerSec: " << maxBytesPerSec;
+    }
 
     return ss.str();
 }
@@ -120,19 +127,18 @@ CappedInsertNotifier::CappedInsertNotifier() : _cappedInsertCount(0), _dead(fals
 void CappedInsertNotifier::notifyOfInsert(int count) {
     stdx::lock_guard<stdx::mutex> lk(_cappedNewDataMutex);
     if (!_dead) {
-        _cappedInsertCount += count;
+        _cappedInsertCount.fetchAndAdd(count);
     }
     _cappedNewDataNotifier.notify_all();
 }
 
 uint64_t CappedInsertNotifier::getCount() const {
-    stdx::lock_guard<stdx::mutex> lk(_cappedNewDataMutex);
-    return _cappedInsertCount;
+    return _cappedInsertCount.load();
 }
 
 void CappedInsertNotifier::waitForInsert(uint64_t referenceCount, Microseconds timeout) const {
     stdx::unique_lock<stdx::mutex> lk(_cappedNewDataMutex);
-    while (!_dead && referenceCount == _cappedInsertCount) {
+    while (!_dead && referenceCount == _cappedInsertCount.load()) {
         if (stdx::cv_status::timeout == _cappedNewDataNotifier.wait_for(lk, timeout)) {
             return;
         }
@@ -174,7 +180,7 @@ Collection::Collection(OperationContext* txn,
       _mustTakeCappedLockOnInsert(isCapped() && !_ns.isSystemDotProfile() && !_ns.isOplog()) {
     _magic = 1357924;
     _indexCatalog.init(txn);
-    if (isCapped())
+    if (_recordStore->needsCappedDeleteCallback())
         _recordStore->setCappedDeleteCallback(this);
 
     _infoCache.init(txn);
@@ -311,15 +317,49 @@ Status Collection::insertDocument(OperationContext* txn, const DocWriter* doc, b
     // we cannot call into the OpObserver here because the document being written is not present
     // fortunately, this is currently only used for adding entries to the oplog.
 
-    // If there is a notifier object and another thread is waiting on it, then we notify waiters
-    // of this document insert. Waiters keep a shared_ptr to '_cappedNotifier', so there are
-    // waiters if this Collection's shared_ptr is not unique.
-    if (_cappedNotifier && !_cappedNotifier.unique())
-        _cappedNotifier->notifyOfInsert(1);
+    _notifyCappedWaitersIfNeeded(txn, 1);
 
     return loc.getStatus();
 }
 
+Status Collection::insertDocuments(OperationContext* txn,
+                                   const std::vector<const DocWriter*>& docs,
+                                   bool enforceQuota) {
+    invariant(!_validator || documentValidationDisabled(txn));
+    dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IX));
+    invariant(!_indexCatalog.haveAnyIndexes());
+
+    if (_mustTakeCappedLockOnInsert)
+        synchronizeOnCappedInFlightResource(txn->lockState(), _ns);
+
+    // Write every document into one buffer so that they can be handed to the RecordStore as a
+    // batch of Records.
+    size_t totalSize = 0;
+    for (const DocWriter* doc : docs) {
+        totalSize += doc->documentSize();
+    }
+    std::unique_ptr<char[]> buffer(new char[totalSize]);
+
+    std::vector<Record> records;
+    records.reserve(docs.size());
+    char* pos = buffer.get();
+    for (const DocWriter* doc : docs) {
+        const size_t size = doc->documentSize();
+        doc->writeDocument(pos);
+        records.push_back(Record{RecordId(), RecordData(pos, size)});
+        pos += size;
+    }
+
+    Status status = _recordStore->insertRecords(txn, &records, _enforceQuota(enforceQuota));
+    if (!status.isOK())
+        return status;
+
+    // As in insertDocument() above, the OpObserver is not called for these documents.
+
+    _notifyCappedWaitersIfNeeded(txn, docs.size());
+
+    return Status::OK();
+}
 
 Status Collection::insertDocuments(OperationContext* txn,
                                    vector<BSONObj>::iterator begin,
@@ -351,17 +391,8 @@ Status Collection::insertDocuments(OperationContext* txn,
         return status;
     invariant(sid == txn->recoveryUnit()->getSnapshotId());
 
-    int inserted = 0;
-    for (vector<BSONObj>::iterator it = begin; it != end; it++) {  // TODO: vectorize
-        getGlobalServiceContext()->getOpObserver()->onInsert(txn, ns(), *it, fromMigrate);
-        inserted++;
-    }
-
-    // If there is a notifier object and another thread is waiting on it, then we notify
-    // waiters of this document insert. Waiters keep a shared_ptr to '_cappedNotifier', so
-    // there are waiters if this Collection's shared_ptr is not unique.
-    if (_cappedNotifier && !_cappedNotifier.unique())
-        _cappedNotifier->notifyOfInsert(inserted);
+    getGlobalServiceContext()->getOpObserver()->onInserts(txn, ns(), begin, end, fromMigrate);
+    _notifyCappedWaitersIfNeeded(txn, std::distance(begin, end));
 
     return Status::OK();
 }
@@ -402,16 +433,47 @@ Status Collection::insertDocument(OperationContext* txn,
 
     getGlobalServiceContext()->getOpObserver()->onInsert(txn, ns(), doc);
 
-    // If there is a notifier object and another thread is waiting on it, then we notify waiters
-    // of this document insert. Waiters keep a shared_ptr to '_cappedNotifier', so there are
-    // waiters if this Collection's shared_ptr is not unique.
-    if (_cappedNotifier && !_cappedNotifier.unique()) {
-        _cappedNotifier->notifyOfInsert(1);
-    }
+    _notifyCappedWaitersIfNeeded(txn, 1);
 
     return loc.getStatus();
 }
 
+namespace {
+/**
+ * Notifies the waiters on a capped collection of inserted documents once they are committed, so
+ * that a waiter which wakes up can read them.
+ */
+class CappedInsertNotifyChange final : public RecoveryUnit::Change {
+public:
+    CappedInsertNotifyChange(std::shared_ptr<CappedInsertNotifier> notifier, int count)
+        : _notifier(std::move(notifier)), _count(count) {}
+
+    void commit() final {
+        _notifier->notifyOfInsert(_count);
+    }
+
+    void rollback() final {}
+
+private:
+    const std::shared_ptr<CappedInsertNotifier> _notifier;
+    const int _count;
+};
+}  // namespace
+
+void Collection::_notifyCappedWaitersIfNeeded(OperationContext* txn, int count) {
+    // Waiters keep a shared_ptr to '_cappedNotifier', so there are waiters if this Collection's
+    // shared_ptr is not unique.
+    if (!_cappedNotifier || _cappedNotifier.unique()) {
+        return;
+    }
+
+    if (txn->lockState()->inAWriteUnitOfWork()) {
+        txn->recoveryUnit()->registerChange(new CappedInsertNotifyChange(_cappedNotifier, count));
+    } else {
+        _cappedNotifier->notifyOfInsert(count);
+    }
+}
+
 Status Collection::_insertDocuments(OperationContext* txn,
                                     vector<BSONObj>::iterator begin,
                                     vector<BSONObj>::iterator end,
@@ -422,20 +484,33 @@ Status Collection::_insertDocuments(OperationContext* txn,
     //       under the RecordStore, this feels broken since that should be a
     //       collection access method probably
 
-    // These will be vectorized (insertRecords, indexRecords) in a future patch
+    if (isCapped() && _indexCatalog.haveAnyIndexes() && std::distance(begin, end) > 1) {
+        // Inserts into indexed capped collections are done one at a time, since a later
+        // document could otherwise cause an earlier one to be deleted before it is indexed.
+        for (vector<BSONObj>::iterator it = begin; it != end; it++) {
+            Status status = _insertDocuments(txn, it, it + 1, enforceQuota);
+            if (!status.isOK())
+                return status;
+        }
+        return Status::OK();
+    }
+
+    std::vector<Record> records;
+    records.reserve(std::distance(begin, end));
     for (vector<BSONObj>::iterator it = begin; it != end; it++) {
-        StatusWith<RecordId> loc = _recordStore->insertRecord(
-            txn, it->objdata(), it->objsize(), _enforceQuota(enforceQuota));
-        if (!loc.isOK())
-            return loc.getStatus();
-        invariant(RecordId::min() < loc.getValue());
-        invariant(loc.getValue() < RecordId::max());
-
-        Status status = _indexCatalog.indexRecord(txn, *it, loc.getValue());
-        if (!status.isOK())
-            return status;
+        records.push_back(Record{RecordId(), RecordData(it->objdata(), it->objsize())});
     }
-    return Status::OK();
+
+    Status status = _recordStore->insertRecords(txn, &records, _enforceQuota(enforceQuota));
+    if (!status.isOK())
+        return status;
+
+    for (const Record& record : records) {
+        invariant(RecordId::min() < record.id);
+        invariant(record.id < RecordId::max());
+    }
+
+    return _indexCatalog.indexRecords(txn, records);
 }
 
 Status Collection::aboutToDeleteCapped(OperationContext* txn,
@@ -484,6 +559,17 @@ void Collection::deleteDocument(
 Counter64 moveCounter;
 ServerStatusMetricField<Counter64> moveCounterDisplay("record.moves", &moveCounter);
 
+// Index updates skipped because the update touched none of the index's key or filter paths.
+Counter64 indexUpdatesSkippedCounter;
+ServerStatusMetricField<Counter64> indexUpdatesSkippedDisplay("index.update.skipped",
+                                                              &indexUpdatesSkippedCounter);
+
+// Partial filters matched only against the old document because the update touched none of
+// the paths they read.
+Counter64 filterChecksSkippedCounter;
+ServerStatusMetricField<Counter64> filterChecksSkippedDisplay("index.update.filterChecksSkipped",
+                                                              &filterChecksSkippedCounter);
+
 StatusWith<RecordId> Collection::updateDocument(OperationContext* txn,
                                                 const RecordId& oldLocation,
                                                 const Snapshotted<BSONObj>& oldDoc,
@@ -491,7 +577,8 @@ StatusWith<RecordId> Collection::updateDocument(OperationContext* txn,
                                                 bool enforceQuota,
                                                 bool indexesAffected,
                                                 OpDebug* debug,
-                                                oplogUpdateEntryArgs& args) {
+                                                oplogUpdateEntryArgs& args,
+                                                const FieldRefSet* updatedFields) {
     {
         auto status = checkValidation(txn, newDoc);
         if (!status.isOK()) {
@@ -528,6 +615,28 @@ StatusWith<RecordId> Collection::updateDocument(OperationContext* txn,
             IndexDescriptor* descriptor = ii.next();
             IndexCatalogEntry* entry = ii.catalogEntry(descriptor);
             IndexAccessMethod* iam = ii.accessMethod(descriptor);
+            const MatchExpression* filter = entry->getFilterExpression();
+
+            const CollectionInfoCache::IndexPaths* paths =
+                updatedFields ? _infoCache.getIndexPaths(txn, descriptor->indexName()) : NULL;
+            if (paths) {
+                const bool filterAffected =
+                    filter && paths->filterPaths.mightBeIndexed(*updatedFields);
+                if (!filterAffected && !paths->keyPaths.mightBeIndexed(*updatedFields)) {
+                    indexUpdatesSkippedCounter.increment();
+                    continue;
+                }
+                if (filter && !filterAffected) {
+                    // The filter reads only paths the update left alone, so the new document
+                    // matches it exactly when the old one does.
+                    filterChecksSkippedCounter.increment();
+                    if (!filter->matchesBSON(oldDoc.value())) {
+                        indexUpdatesSkippedCounter.increment();
+                        continue;
+                    }
+                    filter = NULL;
+                }
+            }
 
             InsertDeleteOptions options;
             options.logIfError = false;
@@ -542,7 +651,7 @@ StatusWith<RecordId> Collection::updateDocument(OperationContext* txn,
                                              oldLocation,
                                              options,
                                              updateTicket,
-                                             entry->getFilterExpression());
+                                             filter);
             if (!ret.isOK()) {
                 return StatusWith<RecordId>(ret);
             }
@@ -589,8 +698,13 @@ StatusWith<RecordId> Collection::updateDocument(OperationContext* txn,
             IndexDescriptor* descriptor = ii.next();
             IndexAccessMethod* iam = ii.accessMethod(descriptor);
 
+            auto ticket = updateTickets.map().find(descriptor);
+            if (ticket == updateTickets.map().end()) {
+                continue;
+            }
+
             int64_t updatedKeys;
-            Status ret = iam->update(txn, *updateTickets.mutableMap()[descriptor], &updatedKeys);
+            Status ret = iam->update(txn, *ticket->second, &updatedKeys);
             if (!ret.isOK())
                 return StatusWith<RecordId>(ret);
             if (debug)
@@ -936,6 +1050,158 @@ Status Collection::validate(OperationContext* txn,
     return Status::OK();
 }
 
+namespace {
+
+/**
+ * Summary of a multiset of index entries, which doesn't depend on the order the entries are added
+ * in.
+ */
+struct IndexEntrySummary {
+    void add(const BSONObj& key, const RecordId& loc, Ordering ordering) {
+        const KeyString keyString(key, ordering, loc);
+        uint64_t hash[2];
+        MurmurHash3_x64_128(keyString.getBuffer(), keyString.getSize(), 0, hash);
+        hashSum += hash[0];
+        count++;
+    }
+
+    bool operator==(const IndexEntrySummary& other) const {
+        return count == other.count && hashSum == other.hashSum;
+    }
+
+    long long count = 0;
+    uint64_t hashSum = 0;
+};
+
+/**
+ * Sleeps as needed to read no more than "maxBytesPerSec" bytes per second, if positive, and
+ * checks for interrupts.
+ */
+class ValidateThrottle {
+public:
+    ValidateThrottle(OperationContext* txn, long long maxBytesPerSec)
+        : _txn(txn), _maxBytesPerSec(maxBytesPerSec) {}
+
+    void read(long long bytes) {
+        _bytesRead += bytes;
+        if (++_numReads % 128 != 0) {
+            return;
+        }
+        _txn->checkForInterrupt();
+        if (_maxBytesPerSec > 0) {
+            const long long targetMillis = _bytesRead * 1000 / _maxBytesPerSec;
+            const long long elapsedMillis = _timer.millis();
+            if (targetMillis > elapsedMillis)
+                sleepmillis(targetMillis - elapsedMillis);
+        }
+    }
+
+private:
+    OperationContext* const _txn;
+    const long long _maxBytesPerSec;
+    const Timer _timer;
+    long long _bytesRead = 0;
+    long long _numReads = 0;
+};
+
+}  // namespace
+
+Status Collection::validateInBackground(OperationContext* txn,
+                                        long long maxBytesPerSec,
+                                        ValidateResults* results,
+                                        BSONObjBuilder* output) {
+    dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IS));
+
+    struct IndexToValidate {
+        const IndexDescriptor* descriptor;
+        const IndexAccessMethod* iam;
+        const MatchExpression* filter;
+        Ordering ordering;
+        IndexEntrySummary fromDocuments;
+        IndexEntrySummary fromIndex;
+    };
+    std::vector<IndexToValidate> indexes;
+    IndexCatalog::IndexIterator ii = _indexCatalog.getIndexIterator(txn, false);
+    while (ii.more()) {
+        const IndexDescriptor* descriptor = ii.next();
+        indexes.push_back({descriptor,
+                           _indexCatalog.getIndex(descriptor),
+                           _indexCatalog.getEntry(descriptor)->getFilterExpression(),
+                           Ordering::make(descriptor->keyPattern()),
+                           IndexEntrySummary(),
+                           IndexEntrySummary()});
+    }
+
+    ValidateThrottle throttle(txn, maxBytesPerSec);
+
+    long long nrecords = 0;
+    long long dataSize = 0;
+    long long nInvalidDocuments = 0;
+    auto cursor = _recordStore->getCursor(txn);
+    while (auto record = cursor->next()) {
+        const BSONObj obj = record->data.releaseToBson();
+        throttle.read(obj.objsize());
+        nrecords++;
+        const Status status = validateBSON(obj.objdata(), obj.objsize());
+        if (!status.isOK()) {
+            if (nInvalidDocuments++ == 0) {
+                results->errors.push_back(str::stream() << "invalid document at "
+                                                        << record->id << ": " << status.reason());
+            }
+            results->valid = false;
+            continue;
+        }
+        dataSize += obj.objsize();
+
+        for (auto& index : indexes) {
+            if (index.filter && !index.filter->matchesBSON(obj)) {
+                continue;
+            }
+            BSONObjSet keys;
+            index.iam->getKeys(obj, &keys);
+            for (const auto& key : keys) {
+                index.fromDocuments.add(key, record->id, index.ordering);
+            }
+        }
+    }
+
+    BSONObjBuilder keysPerIndex;
+    for (auto& index : indexes) {
+        log(LogComponent::kIndex) << "validating index " << index.descriptor->indexNamespace()
+                                  << " in the background";
+        auto indexCursor = index.iam->newCursor(txn);
+        for (auto entry = indexCursor->seek(BSONObj(), true); entry; entry = indexCursor->next()) {
+            throttle.read(entry->key.objsize());
+            index.fromIndex.add(entry->key, entry->loc, index.ordering);
+        }
+
+        const std::string& indexNs = index.descriptor->indexNamespace();
+        keysPerIndex.appendNumber(indexNs, index.fromIndex.count);
+        if (index.fromIndex.count != index.fromDocuments.count) {
+            results->errors.push_back(str::stream() << "index " << indexNs << " has "
+                                                    << index.fromIndex.count
+                                                    << " entries, but the documents have "
+                                                    << index.fromDocuments.count << " keys");
+            results->valid = false;
+        } else if (!(index.fromIndex == index.fromDocuments)) {
+            results->errors.push_back(str::stream() << "entries of index " << indexNs
+                                                    << " don't match the keys of the documents");
+            results->valid = false;
+        }
+    }
+
+    if (nInvalidDocuments > 1) {
+        results->errors.push_back(str::stream() << nInvalidDocuments << " invalid documents");
+    }
+
+    output->appendNumber("nrecords", nrecords);
+    output->appendNumber("datasize", dataSize);
+    output->appendNumber("nInvalidDocuments", nInvalidDocuments);
+    output->append("nIndexes", static_cast<int>(indexes.size()));
+    output->append("keysPerIndex", keysPerIndex.obj());
+    return Status::OK();
+}
+
 Status Collection::touch(OperationContext* txn,
                          bool touchData,
                          bool touchIndexes,
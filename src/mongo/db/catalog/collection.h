@@ -48,6 +48,7 @@
 #include "mongo/db/storage/capped_callback.h"
 #include "mongo/db/storage/record_store.h"
 #include "mongo/db/storage/snapshot.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 
@@ -56,6 +57,7 @@ namespace mongo {
 class CollectionCatalogEntry;
 class DatabaseCatalogEntry;
 class ExtentManager;
+class FieldRefSet;
 class IndexCatalog;
 class MatchExpression;
 class MultiIndexBlock;
@@ -72,6 +74,8 @@ struct CompactOptions {
         validateDocuments = true;
         paddingFactor = 1;
         paddingBytes = 0;
+        online = false;
+        maxBytesPerSec = 0;
     }
 
     // padding
@@ -89,15 +93,26 @@ struct CompactOptions {
     // other
     bool validateDocuments;
 
+    // Online compaction moves records in small batches, releasing locks between batches, rather
+    // than rewriting the whole collection under an exclusive database lock.
+    bool online;
+    long long maxBytesPerSec;  // I/O budget for online compaction; 0 means unthrottled
+
     std::string toString() const;
 };
 
 struct CompactStats {
     CompactStats() {
         corruptDocuments = 0;
+        bytesMoved = 0;
+        extentsFreed = 0;
     }
 
     long long corruptDocuments;
+
+    // only maintained by online compaction
+    long long bytesMoved;
+    long long extentsFreed;
 };
 
 /**
@@ -139,14 +154,15 @@ private:
     // Signalled when a successful insert is made into a capped collection.
     mutable stdx::condition_variable _cappedNewDataNotifier;
 
-    // Mutex used with '_cappedNewDataNotifier'. Protects access to '_cappedInsertCount'.
+    // Mutex used with '_cappedNewDataNotifier'. Protects changes to '_cappedInsertCount'.
     mutable stdx::mutex _cappedNewDataMutex;
 
     // A counter, incremented on insertion of new data into the capped collection.
     //
     // The condition which '_cappedNewDataNotifier' is being notified of is an increment of this
-    // counter. Access to this counter is synchronized with '_cappedNewDataMutex'.
-    uint64_t _cappedInsertCount;
+    // counter. It only changes under '_cappedNewDataMutex', but getCount() reads it without
+    // taking the mutex, so that many tailing cursors don't contend with the inserts.
+    AtomicUInt64 _cappedInsertCount;
 
     // True once the notifier is dead.
     bool _dead;
@@ -259,6 +275,14 @@ public:
      */
     Status insertDocument(OperationContext* txn, const DocWriter* doc, bool enforceQuota);
 
+    /**
+     * Inserts the documents of all of 'docs', in order, with one call into the RecordStore.
+     * Has the same restrictions as the DocWriter version of insertDocument().
+     */
+    Status insertDocuments(OperationContext* txn,
+                           const std::vector<const DocWriter*>& docs,
+                           bool enforceQuota);
+
     Status insertDocument(OperationContext* txn,
                           const BSONObj& doc,
                           MultiIndexBlock* indexBlock,
@@ -269,6 +293,9 @@ public:
      * if the document fits in the old space, it is put there
      * if not, it is moved
      * @return the post update location of the doc (may or may not be the same as oldLocation)
+     *
+     * If 'updatedFields' is not null, it holds every path the update may have changed, and
+     * indexes whose key and partial filter paths are disjoint from it are left untouched.
      */
     StatusWith<RecordId> updateDocument(OperationContext* txn,
                                         const RecordId& oldLocation,
@@ -277,7 +304,8 @@ public:
                                         bool enforceQuota,
                                         bool indexesAffected,
                                         OpDebug* debug,
-                                        oplogUpdateEntryArgs& args);
+                                        oplogUpdateEntryArgs& args,
+                                        const FieldRefSet* updatedFields = NULL);
 
     bool updateWithDamagesSupported() const;
 
@@ -297,6 +325,17 @@ public:
 
     StatusWith<CompactStats> compact(OperationContext* txn, const CompactOptions* options);
 
+    /**
+     * Does at most about 'maxBytes' of online compaction work, updating indexes and cursors for
+     * every document that moves. The caller is expected to release its locks and call again until
+     * this returns true, meaning there is nothing left to compact. Progress is accumulated in
+     * 'stats'.
+     */
+    StatusWith<bool> compactOnline(OperationContext* txn,
+                                   const CompactOptions* options,
+                                   long long maxBytes,
+                                   CompactStats* stats);
+
     /**
      * removes all documents as fast as possible
      * indexes before and after will be the same
@@ -317,6 +356,22 @@ public:
                     ValidateResults* results,
                     BSONObjBuilder* output);
 
+    /**
+     * Checks every document and the entries of every ready index without blocking writers to the
+     * collection. Requires only an intent lock on the collection, and reads everything from the
+     * snapshot of "txn", so the documents and index entries it compares are consistent with each
+     * other. Instead of sorting, the keys the documents generate and the entries of each index are
+     * each summarized by a count and an order-independent sum of their hashes.
+     *
+     * Reads at most "maxBytesPerSec" bytes of documents and index keys per second, if positive.
+     * Does not run the storage engine's structural checks, for which validate() with full: true
+     * needs an exclusive lock.
+     */
+    Status validateInBackground(OperationContext* txn,
+                                long long maxBytesPerSec,
+                                ValidateResults* results,
+                                BSONObjBuilder* output);
+
     /**
      * forces data into cache
      */
@@ -421,6 +476,12 @@ private:
                             std::vector<BSONObj>::iterator end,
                             bool enforceQuota);
 
+    /**
+     * If any threads wait for inserts into this capped collection, wakes them up once 'txn'
+     * commits the 'count' documents it just inserted.
+     */
+    void _notifyCappedWaitersIfNeeded(OperationContext* txn, int count);
+
     bool _enforceQuota(bool userEnforeQuota) const;
 
     int _magic;
@@ -95,6 +95,45 @@ private:
 
     MultiIndexBlock* _multiIndexBlock;
 };
+
+/**
+ * Keeps the indexes and cursors of a collection consistent while online compaction moves its
+ * documents.
+ */
+class OnlineCompactAdaptor : public RecordStoreCompactAdaptor {
+public:
+    OnlineCompactAdaptor(OperationContext* txn, Collection* collection)
+        : _txn(txn), _collection(collection) {}
+
+    virtual bool isDataValid(const RecordData& recData) {
+        return recData.toBson().valid();
+    }
+
+    virtual size_t dataSize(const RecordData& recData) {
+        return recData.toBson().objsize();
+    }
+
+    virtual void inserted(const RecordData& recData, const RecordId& newLocation) {
+        invariant(false);
+    }
+
+    virtual void moved(const RecordData& recData,
+                       const RecordId& oldLocation,
+                       const RecordId& newLocation) {
+        const BSONObj doc = recData.toBson();
+        _collection->getCursorManager()->invalidateDocument(
+            _txn, oldLocation, INVALIDATION_DELETION);
+
+        // Unindex first so that unique indexes accept the new location.
+        IndexCatalog* indexCatalog = _collection->getIndexCatalog();
+        indexCatalog->unindexRecord(_txn, doc, oldLocation, false);
+        uassertStatusOK(indexCatalog->indexRecord(_txn, doc, newLocation));
+    }
+
+private:
+    OperationContext* _txn;
+    Collection* _collection;
+};
 }
 
 
@@ -190,4 +229,30 @@ StatusWith<CompactStats> Collection::compact(OperationContext* txn,
     return StatusWith<CompactStats>(stats);
 }
 
+StatusWith<bool> Collection::compactOnline(OperationContext* txn,
+                                           const CompactOptions* compactOptions,
+                                           long long maxBytes,
+                                           CompactStats* stats) {
+    dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_X));
+
+    if (!_recordStore->compactOnlineSupported())
+        return StatusWith<bool>(ErrorCodes::CommandNotSupported,
+                                str::stream()
+                                    << "cannot compact collection online with record store: "
+                                    << _recordStore->name());
+
+    if (_indexCatalog.numIndexesInProgress(txn))
+        return StatusWith<bool>(ErrorCodes::BadValue, "cannot compact when indexes in progress");
+
+    OnlineCompactAdaptor adaptor(txn, this);
+
+    bool done = false;
+    Status status =
+        _recordStore->compactOnline(txn, &adaptor, compactOptions, maxBytes, stats, &done);
+    if (!status.isOK())
+        return StatusWith<bool>(status);
+
+    return StatusWith<bool>(done);
+}
+
 }  // namespace mongo
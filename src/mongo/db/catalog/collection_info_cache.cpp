@@ -39,8 +39,10 @@
 #include "mongo/db/fts/fts_spec.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/index_legacy.h"
+#include "mongo/db/query/index_histogram.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/planner_ixselect.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/service_context.h"
 #include "mongo/util/clock_source.h"
 #include "mongo/util/debug_util.h"
@@ -53,6 +55,8 @@ CollectionInfoCache::CollectionInfoCache(Collection* collection)
       _keysComputed(false),
       _planCache(new PlanCache(collection->ns().ns())),
       _querySettings(new QuerySettings()),
+      _planRegressionTracker(new PlanRegressionTracker(
+          internalQueryCacheSize, Seconds(internalQueryAutoPinWindowSecs))),
       _indexUsageTracker(getGlobalServiceContext()->getClockSource()) {}
 
 
@@ -63,42 +67,53 @@ const UpdateIndexData& CollectionInfoCache::getIndexKeys(OperationContext* txn)
     return _indexedPaths;
 }
 
+const CollectionInfoCache::IndexPaths* CollectionInfoCache::getIndexPaths(
+    OperationContext* txn, StringData indexName) const {
+    dassert(txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_IS));
+    invariant(_keysComputed);
+    StringMap<IndexPaths>::const_iterator it = _pathsByIndex.find(indexName);
+    return it == _pathsByIndex.end() ? NULL : &it->second;
+}
+
 void CollectionInfoCache::computeIndexKeys(OperationContext* txn) {
     _indexedPaths.clear();
+    _pathsByIndex = StringMap<IndexPaths>();
 
     IndexCatalog::IndexIterator i = _collection->getIndexCatalog()->getIndexIterator(txn, true);
     while (i.more()) {
         IndexDescriptor* descriptor = i.next();
+        IndexPaths& indexPaths = _pathsByIndex[descriptor->indexName()];
 
         if (descriptor->getAccessMethodName() != IndexNames::TEXT) {
             BSONObj key = descriptor->keyPattern();
             BSONObjIterator j(key);
             while (j.more()) {
                 BSONElement e = j.next();
-                _indexedPaths.addPath(e.fieldName());
+                indexPaths.keyPaths.addPath(e.fieldName());
             }
         } else {
             fts::FTSSpec ftsSpec(descriptor->infoObj());
 
             if (ftsSpec.wildcard()) {
-                _indexedPaths.allPathsIndexed();
+                indexPaths.keyPaths.allPathsIndexed();
             } else {
                 for (size_t i = 0; i < ftsSpec.numExtraBefore(); ++i) {
-                    _indexedPaths.addPath(ftsSpec.extraBefore(i));
+                    indexPaths.keyPaths.addPath(ftsSpec.extraBefore(i));
                 }
                 for (fts::Weights::const_iterator it = ftsSpec.weights().begin();
                      it != ftsSpec.weights().end();
                      ++it) {
-                    _indexedPaths.addPath(it->first);
+                    indexPaths.keyPaths.addPath(it->first);
                 }
                 for (size_t i = 0; i < ftsSpec.numExtraAfter(); ++i) {
-                    _indexedPaths.addPath(ftsSpec.extraAfter(i));
+                    indexPaths.keyPaths.addPath(ftsSpec.extraAfter(i));
                 }
                 // Any update to a path containing "language" as a component could change the
                 // language of a subdocument.  Add the override field as a path component.
-                _indexedPaths.addPathComponent(ftsSpec.languageOverrideField());
+                indexPaths.keyPaths.addPathComponent(ftsSpec.languageOverrideField());
             }
         }
+        _indexedPaths.merge(indexPaths.keyPaths);
 
         // handle partial indexes
         const IndexCatalogEntry* entry = i.catalogEntry(descriptor);
@@ -107,8 +122,9 @@ void CollectionInfoCache::computeIndexKeys(OperationContext* txn) {
             unordered_set<std::string> paths;
             QueryPlannerIXSelect::getFields(filter, "", &paths);
             for (auto it = paths.begin(); it != paths.end(); ++it) {
-                _indexedPaths.addPath(*it);
+                indexPaths.filterPaths.addPath(*it);
             }
+            _indexedPaths.merge(indexPaths.filterPaths);
         }
     }
 
@@ -142,6 +158,10 @@ QuerySettings* CollectionInfoCache::getQuerySettings() const {
     return _querySettings.get();
 }
 
+PlanRegressionTracker* CollectionInfoCache::getPlanRegressionTracker() const {
+    return _planRegressionTracker.get();
+}
+
 void CollectionInfoCache::updatePlanCacheIndexEntries(OperationContext* txn) {
     std::vector<IndexEntry> indexEntries;
 
@@ -185,7 +205,21 @@ void CollectionInfoCache::addedIndex(OperationContext* txn, StringData indexName
     // Requires exclusive collection lock.
     invariant(txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_X));
 
-    rebuildIndexData(txn);
+    resetAutoPins();
+    _keysComputed = false;
+    computeIndexKeys(txn);
+    updatePlanCacheIndexEntries(txn);
+
+    // Only the cached plans of shapes which could use the new index need replanning.
+    const bool includeUnfinishedIndexes = true;
+    const IndexDescriptor* desc =
+        _collection->getIndexCatalog()->findIndexByName(txn, indexName, includeUnfinishedIndexes);
+    if (desc) {
+        _planCache->removeEntriesIndexableBy(desc->keyPattern());
+    } else {
+        clearQueryCache();
+    }
+
     _indexUsageTracker.registerIndex(indexName);
 }
 
@@ -193,12 +227,30 @@ void CollectionInfoCache::droppedIndex(OperationContext* txn, StringData indexNa
     // Requires exclusive collection lock.
     invariant(txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_X));
 
-    rebuildIndexData(txn);
+    resetAutoPins();
+    _keysComputed = false;
+    computeIndexKeys(txn);
+    updatePlanCacheIndexEntries(txn);
+
+    // Cached plans which don't use the dropped index are still valid.
+    _planCache->removeEntriesUsingIndex(indexName);
+
     _indexUsageTracker.unregisterIndex(indexName);
+    _indexHistograms.erase(indexName);
+}
+
+void CollectionInfoCache::resetAutoPins() {
+    // Automatic pins and the plans they were chosen from name indexes which may be gone now, or
+    // keep a new index from being tried.
+    for (AllowedIndexEntry* entry : _querySettings->clearAutoPinnedIndices()) {
+        delete entry;
+    }
+    _planRegressionTracker->clear();
 }
 
 void CollectionInfoCache::rebuildIndexData(OperationContext* txn) {
     clearQueryCache();
+    resetAutoPins();
 
     _keysComputed = false;
     computeIndexKeys(txn);
@@ -208,4 +260,23 @@ void CollectionInfoCache::rebuildIndexData(OperationContext* txn) {
 CollectionIndexUsageMap CollectionInfoCache::getIndexUsageStats() const {
     return _indexUsageTracker.getUsageStats();
 }
+
+std::shared_ptr<const IndexHistogram> CollectionInfoCache::getIndexHistogram(
+    StringData indexName) const {
+    auto it = _indexHistograms.find(indexName);
+    if (it == _indexHistograms.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+void CollectionInfoCache::setIndexHistogram(OperationContext* txn,
+                                            StringData indexName,
+                                            std::shared_ptr<const IndexHistogram> histogram) {
+    // Requires exclusive collection lock.
+    invariant(txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_X));
+
+    _indexHistograms[indexName] = std::move(histogram);
+    clearQueryCache();
+}
 }
@@ -30,14 +30,19 @@
 
 #pragma once
 
+#include <memory>
+
 #include "mongo/db/collection_index_usage_tracker.h"
 #include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_regression_tracker.h"
 #include "mongo/db/query/query_settings.h"
 #include "mongo/db/update_index_data.h"
+#include "mongo/util/string_map.h"
 
 namespace mongo {
 
 class Collection;
+class IndexHistogram;
 class OperationContext;
 
 /**
@@ -58,11 +63,32 @@ public:
      */
     QuerySettings* getQuerySettings() const;
 
+    /**
+     * Get the best plans observed for this collection's query shapes, which automatic pinning
+     * falls back to when a replan picks a worse plan.
+     */
+    PlanRegressionTracker* getPlanRegressionTracker() const;
+
     /* get set of index keys for this namespace.  handy to quickly check if a given
        field is indexed (Note it might be a secondary component of a compound index.)
     */
     const UpdateIndexData& getIndexKeys(OperationContext* txn) const;
 
+    /**
+     * The paths an update must touch to change the keys of a single index, and separately the
+     * paths its partial filter reads. 'filterPaths' is empty for an index without a filter.
+     */
+    struct IndexPaths {
+        UpdateIndexData keyPaths;
+        UpdateIndexData filterPaths;
+    };
+
+    /**
+     * Returns the paths of index 'indexName', or null if the index was not in the catalog when
+     * the cache was last rebuilt. Must be called while holding the collection lock in any mode.
+     */
+    const IndexPaths* getIndexPaths(OperationContext* txn, StringData indexName) const;
+
     /**
      * Returns cached index usage statistics for this collection.  The map returned will contain
      * entry for each index in the collection along with both a usage counter and a timestamp
@@ -72,6 +98,22 @@ public:
      */
     CollectionIndexUsageMap getIndexUsageStats() const;
 
+    /**
+     * Returns the histogram the analyze command last collected for index 'indexName', or null if
+     * there is none. Must be called while holding the collection lock in any mode.
+     */
+    std::shared_ptr<const IndexHistogram> getIndexHistogram(StringData indexName) const;
+
+    /**
+     * Replaces the histogram of index 'indexName' and clears the cached query plans, which were
+     * chosen without it.
+     *
+     * Must be called under exclusive collection lock.
+     */
+    void setIndexHistogram(OperationContext* txn,
+                           StringData indexName,
+                           std::shared_ptr<const IndexHistogram> histogram);
+
     /**
      * Builds internal cache state based on the current state of the Collection's IndexCatalog
      */
@@ -110,6 +152,7 @@ private:
     // ---  index keys cache
     bool _keysComputed;
     UpdateIndexData _indexedPaths;
+    StringMap<IndexPaths> _pathsByIndex;
 
     // A cache for query plans.
     std::unique_ptr<PlanCache> _planCache;
@@ -118,17 +161,30 @@ private:
     // Includes index filters.
     std::unique_ptr<QuerySettings> _querySettings;
 
+    // Best plans observed per query shape, used to pin indexes automatically.
+    std::unique_ptr<PlanRegressionTracker> _planRegressionTracker;
+
     // Tracks index usage statistics for this collection.
     CollectionIndexUsageTracker _indexUsageTracker;
 
+    // Histograms collected by the analyze command, by index name.
+    StringMap<std::shared_ptr<const IndexHistogram>> _indexHistograms;
+
     void computeIndexKeys(OperationContext* txn);
     void updatePlanCacheIndexEntries(OperationContext* txn);
 
     /**
-     * Rebuilds cached information that is dependent on index composition. Must be called
-     * when index composition changes.
+     * Rebuilds cached information that is dependent on index composition, discarding all
+     * cached plans. addedIndex() and droppedIndex() only discard the plans an index change
+     * affects.
      */
     void rebuildIndexData(OperationContext* txn);
+
+    /**
+     * Removes the automatically pinned index filters and the observed plans they are chosen
+     * from.
+     */
+    void resetAutoPins();
 };
 
 }  // namespace mongo
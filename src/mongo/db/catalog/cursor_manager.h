@@ -35,6 +35,7 @@
 #include "mongo/db/invalidation_type.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/record_id.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/unordered_set.h"
 #include "mongo/util/concurrency/mutex.h"
 
@@ -44,6 +45,16 @@ class OperationContext;
 class PseudoRandom;
 class PlanExecutor;
 
+/**
+ * Tracks the cursors and the yielding executors of a collection, or of no collection for the
+ * global cursor manager.
+ *
+ * Cursors and executors are spread over a fixed number of partitions, each with its own lock,
+ * so that concurrent operations rarely wait on one another. A cursor's partition is encoded in
+ * the low bits of its id and an executor's partition is derived from its address. Methods which
+ * look at everything visit the partitions one at a time, except invalidateAll(), which holds
+ * all of their locks.
+ */
 class CursorManager {
 public:
     CursorManager(StringData ns);
@@ -143,19 +154,34 @@ public:
     static std::size_t timeoutCursorsGlobal(OperationContext* txn, int millisSinceLastCall);
 
 private:
-    CursorId _allocateCursorId_inlock();
-    void _deregisterCursor_inlock(ClientCursor* cc);
+    typedef unordered_set<PlanExecutor*> ExecSet;
+    typedef std::map<CursorId, ClientCursor*> CursorMap;
+
+    struct Partition {
+        mutable SimpleMutex mutex;
+
+        // Used for the random part of the ids of the cursors registered in this partition.
+        std::unique_ptr<PseudoRandom> random;
+
+        ExecSet nonCachedExecutors;
+        CursorMap cursors;
+    };
+
+    // Number of partitions, a power of two.
+    static const unsigned kNumPartitions = 8;
+
+    Partition& _getCursorPartition(CursorId id) const;
+    Partition& _getExecutorPartition(PlanExecutor* exec) const;
+
+    CursorId _allocateCursorId_inlock(Partition* partition, unsigned partitionIndex);
+    void _deregisterCursor_inlock(Partition* partition, ClientCursor* cc);
 
     NamespaceString _nss;
     unsigned _collectionCacheRuntimeId;
-    std::unique_ptr<PseudoRandom> _random;
 
-    mutable SimpleMutex _mutex;
+    // Spreads new cursors over the partitions in turn.
+    AtomicUInt32 _nextCursorPartition;
 
-    typedef unordered_set<PlanExecutor*> ExecSet;
-    ExecSet _nonCachedExecutors;
-
-    typedef std::map<CursorId, ClientCursor*> CursorMap;
-    CursorMap _cursors;
+    std::unique_ptr<Partition[]> _partitions;
 };
 }
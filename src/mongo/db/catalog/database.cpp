@@ -224,6 +224,7 @@ string Database::duplicateUncasedName(const string& name, set<string>* duplicate
 
     set<string> allShortNames;
     dbHolder().getAllShortNames(allShortNames);
+    dbHolder().getDeferredNames(allShortNames);
 
     for (const auto& dbname : allShortNames) {
         if (strcasecmp(dbname.c_str(), name.c_str()))
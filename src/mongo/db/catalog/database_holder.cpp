@@ -32,6 +32,7 @@
 
 #include "mongo/db/catalog/database_holder.h"
 
+#include "mongo/base/counter.h"
 #include "mongo/db/audit.h"
 #include "mongo/db/auth/auth_index_d.h"
 #include "mongo/db/background.h"
@@ -39,10 +40,12 @@
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_catalog_entry.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/storage/storage_engine.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -70,6 +73,17 @@ StringData _todb(StringData ns) {
 
 DatabaseHolder _dbHolder;
 
+// Opens of databases which already existed, and how long they took.
+Counter64 databaseOpens;
+Counter64 databaseOpenMicros;
+Counter64 deferredDatabases;  // Not opened yet.
+
+ServerStatusMetricField<Counter64> databaseOpensDisplay("catalog.databaseOpens", &databaseOpens);
+ServerStatusMetricField<Counter64> databaseOpenMicrosDisplay("catalog.databaseOpenMicros",
+                                                             &databaseOpenMicros);
+ServerStatusMetricField<Counter64> deferredDatabasesDisplay("catalog.deferredDatabases",
+                                                            &deferredDatabases);
+
 }  // namespace
 
 
@@ -78,17 +92,71 @@ DatabaseHolder& dbHolder() {
 }
 
 
-Database* DatabaseHolder::get(OperationContext* txn, StringData ns) const {
+Database* DatabaseHolder::get(OperationContext* txn, StringData ns) {
     const StringData db = _todb(ns);
     invariant(txn->lockState()->isDbLockedForMode(db, MODE_IS));
 
-    stdx::lock_guard<SimpleMutex> lk(_m);
-    DBs::const_iterator it = _dbs.find(db);
-    if (it != _dbs.end()) {
-        return it->second;
+    {
+        stdx::lock_guard<SimpleMutex> lk(_m);
+        DBs::const_iterator it = _dbs.find(db);
+        if (it != _dbs.end()) {
+            return it->second;
+        }
+
+        if (_deferred.empty() || !_deferred.count(db.toString())) {
+            return NULL;
+        }
     }
 
-    return NULL;
+    return _openDeferred(txn, db);
+}
+
+Database* DatabaseHolder::_openDeferred(OperationContext* txn, StringData dbname) {
+    stdx::lock_guard<stdx::mutex> openLock(_openDeferredMutex);
+
+    {
+        stdx::lock_guard<SimpleMutex> lk(_m);
+        DBs::const_iterator it = _dbs.find(dbname);
+        if (it != _dbs.end()) {
+            return it->second;  // Another thread opened it first.
+        }
+        invariant(_deferred.count(dbname.toString()));
+    }
+
+    StorageEngine* storageEngine = getGlobalServiceContext()->getGlobalStorageEngine();
+    DatabaseCatalogEntry* entry = storageEngine->getDatabaseCatalogEntry(txn, dbname);
+    invariant(entry);
+
+    // Holders of an IS lock on the database cannot change its catalog, and other threads opening
+    // it wait on '_openDeferredMutex', so this is the only thread constructing it.
+    Timer timer;
+    Database* db = new Database(txn, dbname, entry);
+    databaseOpens.increment();
+    databaseOpenMicros.increment(timer.micros());
+    LOG(1) << "opened database " << dbname << ", whose opening was deferred at startup, in "
+           << timer.millis() << "ms";
+
+    stdx::lock_guard<SimpleMutex> lk(_m);
+    _deferred.erase(dbname.toString());
+    deferredDatabases.decrement();
+    _dbs[dbname] = db;
+
+    return db;
+}
+
+bool DatabaseHolder::isDeferred(OperationContext* txn, StringData dbName) const {
+    invariant(txn->lockState()->isDbLockedForMode(dbName, MODE_IS));
+
+    stdx::lock_guard<SimpleMutex> lk(_m);
+    return _deferred.count(dbName.toString());
+}
+
+void DatabaseHolder::deferOpen(StringData dbName) {
+    stdx::lock_guard<SimpleMutex> lk(_m);
+    invariant(_dbs.find(dbName) == _dbs.end());
+    if (_deferred.insert(dbName.toString()).second) {
+        deferredDatabases.increment();
+    }
 }
 
 Database* DatabaseHolder::openDb(OperationContext* txn, StringData ns, bool* justCreated) {
@@ -131,7 +199,12 @@ Database* DatabaseHolder::openDb(OperationContext* txn, StringData ns, bool* jus
     // operations which may block. Only one thread can be inside this method for the same DB
     // name, because of the requirement for X-lock on the database when we enter. So there is
     // no way we can insert two different databases for the same name.
+    Timer timer;
     db = new Database(txn, dbname, entry);
+    if (exists) {
+        databaseOpens.increment();
+        databaseOpenMicros.increment(timer.micros());
+    }
 
     stdx::lock_guard<SimpleMutex> lk(_m);
     _dbs[dbname] = db;
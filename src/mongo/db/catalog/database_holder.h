@@ -32,6 +32,7 @@
 
 #include "mongo/base/string_data.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/string_map.h"
 
@@ -49,9 +50,9 @@ public:
 
     /**
      * Retrieves an already opened database or returns NULL. Must be called with the database
-     * locked in at least IS-mode.
+     * locked in at least IS-mode. A database whose opening was deferred is opened here.
      */
-    Database* get(OperationContext* txn, StringData ns) const;
+    Database* get(OperationContext* txn, StringData ns);
 
     /**
      * Retrieves a database reference if it is already opened, or opens it if it hasn't been
@@ -62,6 +63,12 @@ public:
      */
     Database* openDb(OperationContext* txn, StringData ns, bool* justCreated = NULL);
 
+    /**
+     * Records that the existing database 'dbName' was not opened at startup, so that the first
+     * get() or openDb() for it opens it. The database must not be opened yet.
+     */
+    void deferOpen(StringData dbName);
+
     /**
      * Closes the specified database. Must be called with the database locked in X-mode.
      */
@@ -87,11 +94,33 @@ public:
         }
     }
 
+    /**
+     * Retrieves the names of the databases whose opening was deferred and which have not been
+     * opened since. The same locking caveats as for getAllShortNames() apply.
+     */
+    void getDeferredNames(std::set<std::string>& all) const {
+        stdx::lock_guard<SimpleMutex> lk(_m);
+        all.insert(_deferred.begin(), _deferred.end());
+    }
+
+    /**
+     * Returns true if the opening of 'dbName' was deferred and it has not been opened since. Must
+     * be called with the database locked in at least IS-mode.
+     */
+    bool isDeferred(OperationContext* txn, StringData dbName) const;
+
 private:
     typedef StringMap<Database*> DBs;
 
+    Database* _openDeferred(OperationContext* txn, StringData dbname);
+
     mutable SimpleMutex _m;
     DBs _dbs;
+    std::set<std::string> _deferred;  // Protected by '_m'.
+
+    // Serializes the opening of deferred databases, which only requires the database to be locked
+    // in IS-mode.
+    stdx::mutex _openDeferredMutex;
 };
 
 DatabaseHolder& dbHolder();
@@ -36,6 +36,7 @@
 
 #include <vector>
 
+#include "mongo/bson/bson_field_offsets.h"
 #include "mongo/db/audit.h"
 #include "mongo/db/background.h"
 #include "mongo/db/catalog/collection_catalog_entry.h"
@@ -50,18 +51,22 @@
 #include "mongo/db/service_context.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index/index_prefix_counts.h"
 #include "mongo/db/index_legacy.h"
 #include "mongo/db/index_names.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/keypattern.h"
 #include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/matchable.h"
 #include "mongo/db/ops/delete.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/storage/record_store.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -175,6 +180,10 @@ IndexCatalogEntry* IndexCatalog::_setupInMemoryStructures(OperationContext* txn,
     entry->init(txn,
                 _collection->_dbce->getIndex(txn, _collection->getCatalogEntry(), entry.get()));
 
+    if (entry->isReady(txn)) {
+        _initPrefixCounts(txn, entry.get());
+    }
+
     IndexCatalogEntry* save = entry.get();
     _entries.add(entry.release());
 
@@ -189,6 +198,35 @@ IndexCatalogEntry* IndexCatalog::_setupInMemoryStructures(OperationContext* txn,
     return save;
 }
 
+void IndexCatalog::_initPrefixCounts(OperationContext* txn, IndexCatalogEntry* entry) {
+    IndexPrefixCounts* prefixCounts = entry->prefixCounts();
+    if (!prefixCounts)
+        return;
+
+    invariant(txn->lockState()->isCollectionLockedForMode(_collection->ns().toString(), MODE_X));
+
+    Timer timer;
+    prefixCounts->reset();
+
+    const MatchExpression* filter = entry->getFilterExpression();
+    auto cursor = _collection->getCursor(txn);
+    while (auto record = cursor->next()) {
+        const BSONObj obj = record->data.releaseToBson();
+        if (filter && !filter->matchesBSON(obj))
+            continue;
+
+        BSONObjSet keys;
+        entry->accessMethod()->getKeys(obj, &keys);
+        prefixCounts->addDocument(keys);
+    }
+
+    prefixCounts->setInitialized();
+    LOG(timer.millis() > 1000 ? 0 : 1) << "counted " << prefixCounts->getTotal()
+                                       << " documents of index "
+                                       << entry->descriptor()->indexNamespace() << " in "
+                                       << timer.millis() << "ms";
+}
+
 bool IndexCatalog::ok() const {
     return (_magic == INDEX_CATALOG_INIT);
 }
@@ -445,6 +483,7 @@ void IndexCatalog::IndexBuildBlock::success() {
 
     _txn->recoveryUnit()->registerChange(new IndexCompletionChange(_txn, entry));
     entry->setIsReady(true);
+    _catalog->_initPrefixCounts(_txn, entry);
 
     _catalog->_collection->infoCache()->addedIndex(_txn, _indexName);
 }
@@ -585,6 +624,28 @@ Status IndexCatalog::_isSpecOk(const BSONObj& spec) const {
         }
     }
 
+    // Storage engines that can keep order statistics do so for indexes with this option. Others
+    // ignore it and count by scanning.
+    BSONElement rangeCountsElement = spec.getField("rangeCounts");
+    if (rangeCountsElement && !rangeCountsElement.isBoolean()) {
+        return Status(ErrorCodes::CannotCreateIndex,
+                      "\"rangeCounts\" for an index must be a boolean");
+    }
+
+    // Counted indexes keep the number of documents for each value of their first field, so that
+    // counts of documents with a given value don't have to scan them.
+    BSONElement countedElement = spec.getField("counted");
+    if (countedElement) {
+        if (!countedElement.isBoolean()) {
+            return Status(ErrorCodes::CannotCreateIndex,
+                          "\"counted\" for an index must be a boolean");
+        }
+        if (countedElement.boolean() && IndexNames::findPluginName(key) != IndexNames::BTREE) {
+            return Status(ErrorCodes::CannotCreateIndex,
+                          str::stream() << "only btree indexes can be counted, not " << key);
+        }
+    }
+
     if (IndexDescriptor::isIdIndexPattern(key)) {
         BSONElement uniqueElt = spec["unique"];
         if (uniqueElt && !uniqueElt.trueValue()) {
@@ -982,11 +1043,13 @@ void IndexCatalog::IndexIterator::_advance() {
 
         if (!_includeUnfinishedIndexes) {
             if (auto minSnapshot = entry->getMinimumVisibleSnapshot()) {
-                if (auto mySnapshot = _txn->recoveryUnit()->getMajorityCommittedSnapshot()) {
-                    if (mySnapshot < minSnapshot) {
-                        // This index isn't finished in my snapshot.
-                        continue;
-                    }
+                auto mySnapshot = _txn->recoveryUnit()->getMajorityCommittedSnapshot();
+                if (!mySnapshot) {
+                    mySnapshot = _txn->recoveryUnit()->getLastAppliedSnapshot();
+                }
+                if (mySnapshot && mySnapshot < minSnapshot) {
+                    // This index isn't finished in my snapshot.
+                    continue;
                 }
             }
 
@@ -1136,10 +1199,44 @@ bool isDupsAllowed(IndexDescriptor* desc) {
 
 Status IndexCatalog::_indexRecord(OperationContext* txn,
                                   IndexCatalogEntry* index,
-                                  const BSONObj& obj,
+                                  const BSONFieldOffsets& offsets,
                                   const RecordId& loc) {
     const MatchExpression* filter = index->getFilterExpression();
-    if (filter && !filter->matchesBSON(obj)) {
+    if (filter) {
+        BSONMatchableDocument doc(offsets);
+        if (!filter->matches(&doc)) {
+            return Status::OK();
+        }
+    }
+
+    InsertDeleteOptions options;
+    options.logIfError = false;
+    options.dupsAllowed = isDupsAllowed(index->descriptor());
+
+    int64_t inserted;
+    return index->accessMethod()->insert(txn, offsets.obj(), loc, options, &inserted, &offsets);
+}
+
+Status IndexCatalog::_indexRecords(OperationContext* txn,
+                                   IndexCatalogEntry* index,
+                                   const std::vector<Record>& records,
+                                   const std::vector<BSONFieldOffsets>& offsets) {
+    const MatchExpression* filter = index->getFilterExpression();
+    std::vector<Record> filtered;
+    std::vector<const BSONFieldOffsets*> toIndexOffsets;
+    toIndexOffsets.reserve(records.size());
+    for (size_t i = 0; i < records.size(); ++i) {
+        if (filter) {
+            BSONMatchableDocument doc(offsets[i]);
+            if (!filter->matches(&doc)) {
+                continue;
+            }
+            filtered.push_back(records[i]);
+        }
+        toIndexOffsets.push_back(&offsets[i]);
+    }
+    const std::vector<Record>& toIndex = filter ? filtered : records;
+    if (toIndex.empty()) {
         return Status::OK();
     }
 
@@ -1148,7 +1245,7 @@ Status IndexCatalog::_indexRecord(OperationContext* txn,
     options.dupsAllowed = isDupsAllowed(index->descriptor());
 
     int64_t inserted;
-    return index->accessMethod()->insert(txn, obj, loc, options, &inserted);
+    return index->accessMethod()->insertBatch(txn, toIndex, options, &inserted, &toIndexOffsets);
 }
 
 Status IndexCatalog::_unindexRecord(OperationContext* txn,
@@ -1178,9 +1275,27 @@ Status IndexCatalog::_unindexRecord(OperationContext* txn,
 
 
 Status IndexCatalog::indexRecord(OperationContext* txn, const BSONObj& obj, const RecordId& loc) {
+    const BSONFieldOffsets offsets(obj);
+    for (IndexCatalogEntryContainer::const_iterator i = _entries.begin(); i != _entries.end();
+         ++i) {
+        Status s = _indexRecord(txn, *i, offsets, loc);
+        if (!s.isOK())
+            return s;
+    }
+
+    return Status::OK();
+}
+
+Status IndexCatalog::indexRecords(OperationContext* txn, const std::vector<Record>& records) {
+    std::vector<BSONFieldOffsets> offsets;
+    offsets.reserve(records.size());
+    for (const Record& record : records) {
+        offsets.push_back(BSONFieldOffsets(record.data.toBson()));
+    }
+
     for (IndexCatalogEntryContainer::const_iterator i = _entries.begin(); i != _entries.end();
          ++i) {
-        Status s = _indexRecord(txn, *i, obj, loc);
+        Status s = _indexRecords(txn, *i, records, offsets);
         if (!s.isOK())
             return s;
     }
@@ -40,11 +40,13 @@
 
 namespace mongo {
 
+class BSONFieldOffsets;
 class Client;
 class Collection;
 
 class IndexDescriptor;
 class IndexAccessMethod;
+struct Record;
 
 /**
  * how many: 1 per Collection
@@ -265,6 +267,12 @@ public:
     // this throws for now
     Status indexRecord(OperationContext* txn, const BSONObj& obj, const RecordId& loc);
 
+    /**
+     * Indexes every document in 'records', which must already be in the collection. Each
+     * index receives the keys for the whole batch at once.
+     */
+    Status indexRecords(OperationContext* txn, const std::vector<Record>& records);
+
     void unindexRecord(OperationContext* txn, const BSONObj& obj, const RecordId& loc, bool noWarn);
 
     // ------- temp internal -------
@@ -294,11 +302,18 @@ private:
 
     void _checkMagic() const;
 
+    // 'offsets' are shared by every index a document goes into, so that their partial index
+    // filters and key generators look up its fields in one place.
     Status _indexRecord(OperationContext* txn,
                         IndexCatalogEntry* index,
-                        const BSONObj& obj,
+                        const BSONFieldOffsets& offsets,
                         const RecordId& loc);
 
+    Status _indexRecords(OperationContext* txn,
+                         IndexCatalogEntry* index,
+                         const std::vector<Record>& records,
+                         const std::vector<BSONFieldOffsets>& offsets);
+
     Status _unindexRecord(OperationContext* txn,
                           IndexCatalogEntry* index,
                           const BSONObj& obj,
@@ -323,6 +338,10 @@ private:
                                                 IndexDescriptor* descriptor,
                                                 bool initFromDisk);
 
+    // Counts the documents of 'entry' if it is a counted index, by scanning the collection. The
+    // caller must hold the collection exclusively so that no write is missed or counted twice.
+    void _initPrefixCounts(OperationContext* txn, IndexCatalogEntry* entry);
+
     // Apply a set of transformations to the user-provided index object 'spec' to make it
     // conform to the standard for insertion.  This function adds the 'v' field if it didn't
     // exist, removes the '_id' field if it exists, applies plugin-level transformations if
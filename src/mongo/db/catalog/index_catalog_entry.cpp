@@ -39,6 +39,7 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index/index_prefix_counts.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/operation_context.h"
@@ -81,6 +82,9 @@ IndexCatalogEntry::IndexCatalogEntry(StringData ns,
       _ordering(Ordering::make(descriptor->keyPattern())),
       _isReady(false) {
     _descriptor->_cachedEntry = this;
+    if (_descriptor->getInfoElement("counted").trueValue()) {
+        _prefixCounts.reset(new IndexPrefixCounts());
+    }
 }
 
 IndexCatalogEntry::~IndexCatalogEntry() {
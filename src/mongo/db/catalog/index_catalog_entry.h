@@ -44,6 +44,7 @@ class CollectionInfoCache;
 class HeadManager;
 class IndexAccessMethod;
 class IndexDescriptor;
+class IndexPrefixCounts;
 class MatchExpression;
 class OperationContext;
 
@@ -86,6 +87,14 @@ public:
         return _filterExpression.get();
     }
 
+    /**
+     * Returns the document counts of an index created with the "counted" option, or NULL for
+     * other indexes. IndexCatalog initializes them once the index is ready.
+     */
+    IndexPrefixCounts* prefixCounts() const {
+        return _prefixCounts.get();
+    }
+
     /// ---------------------
 
     const RecordId& head(OperationContext* txn) const;
@@ -142,6 +151,7 @@ private:
     // Owned here.
     HeadManager* _headManager;
     std::unique_ptr<MatchExpression> _filterExpression;
+    std::unique_ptr<IndexPrefixCounts> _prefixCounts;
 
     // cached stuff
 
@@ -47,7 +47,11 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/log.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/progress_meter.h"
@@ -58,6 +62,32 @@ using std::unique_ptr;
 using std::string;
 using std::endl;
 
+// The number of threads a foreground index build generates and sorts keys on. The collection is
+// still scanned by the thread running the build.
+MONGO_EXPORT_SERVER_PARAMETER(maxIndexBuildThreads, int, 1);
+
+// The memory the sorters of a foreground index build may hold before spilling to disk, shared by
+// all of the indexes built from one scan of the collection.
+MONGO_EXPORT_SERVER_PARAMETER(maxIndexBuildMemoryUsageMegabytes, int, 500);
+
+// Whether background builds of indexes that allow duplicate keys sort the keys and load them in
+// bulk, keeping the writes made meanwhile in a side table, rather than inserting every key into
+// the live index.
+MONGO_EXPORT_SERVER_PARAMETER(hybridBackgroundIndexBuilds, bool, true);
+
+namespace {
+// How many documents a partition takes between redistributing its memory budget.
+const size_t kDocsBetweenMemoryRebalances = 1000;
+
+// How many side table entries are applied to an index in one unit of work.
+const size_t kSideWritesPerBatch = 1000;
+
+// A background build stops applying side writes without the exclusive lock once no index has
+// more than this many left, or after this many passes if writers keep adding them faster.
+const size_t kSideWritesLeftForCommit = 1000;
+const int kMaxSideWritePasses = 10;
+}  // namespace
+
 /**
  * On rollback sets MultiIndexBlock::_needToCleanup to true.
  */
@@ -98,6 +128,8 @@ MultiIndexBlock::MultiIndexBlock(OperationContext* txn, Collection* collection)
       _buildInBackground(false),
       _allowInterruption(false),
       _ignoreUnique(false),
+      _useSideWrites(false),
+      _numBuildThreads(1),
       _needToCleanup(true) {}
 
 MultiIndexBlock::~MultiIndexBlock() {
@@ -164,6 +196,11 @@ Status MultiIndexBlock::init(const std::vector<BSONObj>& indexSpecs) {
         _buildInBackground = (_buildInBackground && info["background"].trueValue());
     }
 
+    // Background builds generate keys on the thread scanning the collection, which yields, so
+    // only foreground builds split key generation across threads.
+    _numBuildThreads = _buildInBackground ? 1 : std::max(1, maxIndexBuildThreads);
+    _docsSinceMemoryRebalance.assign(_numBuildThreads, 0);
+
     for (size_t i = 0; i < indexSpecs.size(); i++) {
         BSONObj info = indexSpecs[i];
         StatusWith<BSONObj> statusWithInfo =
@@ -187,7 +224,7 @@ Status MultiIndexBlock::init(const std::vector<BSONObj>& indexSpecs) {
         if (!_buildInBackground) {
             // Bulk build process requires foreground building as it assumes nothing is changing
             // under it.
-            index.bulk = index.real->initiateBulk();
+            index.bulk = index.real->initiateBulk(_numBuildThreads);
         }
 
         const IndexDescriptor* descriptor = index.block->getEntry()->descriptor();
@@ -208,13 +245,168 @@ Status MultiIndexBlock::init(const std::vector<BSONObj>& indexSpecs) {
         _indexes.push_back(std::move(index));
     }
 
-    if (_buildInBackground)
+    // The keys of a background build can still be sorted and loaded in bulk if writers record
+    // theirs in a side table meanwhile, to be applied once the index is loaded. This takes
+    // indexes that allow duplicate keys, since the same key may come from both the scan and
+    // the side table, so a unique index keeps checking each key as it is inserted.
+    _useSideWrites = _buildInBackground && hybridBackgroundIndexBuilds;
+    for (size_t i = 0; i < _indexes.size(); i++) {
+        _useSideWrites = _useSideWrites && _indexes[i].options.dupsAllowed;
+    }
+    if (_useSideWrites) {
+        log() << "\t building indexes using bulk method and a side table for concurrent writes";
+        for (size_t i = 0; i < _indexes.size(); i++) {
+            _indexes[i].bulk = _indexes[i].real->initiateBulk();
+            _indexes[i].sideWrites = std::make_shared<IndexBuildSideWrites>();
+            _indexes[i].real->setSideWrites(_indexes[i].sideWrites);
+        }
+    }
+
+    if (_buildInBackground) {
         _backgroundOperation.reset(new BackgroundOperation(ns));
+    }
+    if (!_buildInBackground || _useSideWrites) {
+        for (size_t partition = 0; partition < _numBuildThreads; partition++) {
+            _rebalanceBulkMemory(partition);
+        }
+    }
 
     wunit.commit();
     return Status::OK();
 }
 
+/**
+ * Generates the keys of the documents handed to add() on a pool of worker threads. Each worker
+ * inserts into its own partition of the bulk builders, so they never share a sorter.
+ */
+class MultiIndexBlock::ParallelInserter {
+    MONGO_DISALLOW_COPYING(ParallelInserter);
+
+public:
+    ParallelInserter(MultiIndexBlock* indexer, size_t numThreads, std::set<RecordId>* dupsOut)
+        : _indexer(indexer), _dupsOut(dupsOut), _maxQueuedBatches(2 * numThreads) {
+        for (size_t i = 0; i < numThreads; i++) {
+            _threads.emplace_back([this, i] { _run(i); });
+        }
+    }
+
+    ~ParallelInserter() {
+        _stop();
+    }
+
+    /**
+     * Queues a document for insertion, blocking while the workers are behind. Returns the first
+     * error a worker has hit, after which no more documents are accepted.
+     */
+    Status add(const BSONObj& doc, const RecordId& loc) {
+        _current.emplace_back(doc.getOwned(), loc);
+        if (_current.size() < kBatchSize)
+            return Status::OK();
+
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _notFull.wait(lk, [this] { return !_status.isOK() || _queue.size() < _maxQueuedBatches; });
+        if (!_status.isOK())
+            return _status;
+
+        _queue.push_back(std::move(_current));
+        _current.clear();
+        _notEmpty.notify_one();
+        return Status::OK();
+    }
+
+    /**
+     * Waits until every queued document has been inserted and returns the first error hit.
+     */
+    Status finish() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            if (!_current.empty()) {
+                _queue.push_back(std::move(_current));
+                _current.clear();
+            }
+        }
+        _stop();
+        return _status;
+    }
+
+private:
+    using Batch = std::vector<std::pair<BSONObj, RecordId>>;
+
+    static const size_t kBatchSize = 1000;
+
+    void _stop() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _done = true;
+        }
+        _notEmpty.notify_all();
+        for (auto&& thread : _threads) {
+            if (thread.joinable())
+                thread.join();
+        }
+    }
+
+    void _run(size_t partition) {
+        setThreadName(std::string(str::stream() << "indexBuilder-" << partition));
+        while (true) {
+            Batch batch;
+            {
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                _notEmpty.wait(lk, [this] { return _done || !_queue.empty(); });
+                if (_queue.empty() || !_status.isOK())
+                    return;
+                batch = std::move(_queue.front());
+                _queue.pop_front();
+            }
+            _notFull.notify_one();
+
+            Status status = _insertBatch(partition, batch);
+            if (!status.isOK()) {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                if (_status.isOK())
+                    _status = status;
+                _notFull.notify_all();
+                return;
+            }
+        }
+    }
+
+    Status _insertBatch(size_t partition, const Batch& batch) {
+        try {
+            for (auto&& doc : batch) {
+                Status status = _indexer->_insertIntoPartition(partition, doc.first, doc.second);
+                if (status.isOK())
+                    continue;
+                if (!_dupsOut || status.code() != ErrorCodes::DuplicateKey)
+                    return status;
+
+                // Like the serial build, only fail the insert that led to the DuplicateKey.
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                _dupsOut->insert(doc.second);
+            }
+        } catch (...) {
+            return exceptionToStatus();
+        }
+        return Status::OK();
+    }
+
+    MultiIndexBlock* const _indexer;
+    std::set<RecordId>* const _dupsOut;
+    const size_t _maxQueuedBatches;
+
+    // Only touched by the thread calling add().
+    Batch _current;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _notEmpty;
+    stdx::condition_variable _notFull;
+    std::deque<Batch> _queue;
+    bool _done = false;
+    Status _status = Status::OK();
+
+    std::vector<stdx::thread> _threads;
+};
+
 Status MultiIndexBlock::insertAllDocumentsInCollection(std::set<RecordId>* dupsOut) {
     const char* curopMessage = _buildInBackground ? "Index Build (background)" : "Index Build";
     const auto numRecords = _collection->numRecords(_txn);
@@ -235,6 +427,13 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(std::set<RecordId>* dupsO
         exec->setYieldPolicy(PlanExecutor::WRITE_CONFLICT_RETRY_ONLY);
     }
 
+    // The collection is scanned on this thread, since the cursor belongs to '_txn', but the
+    // keys are generated and sorted on worker threads.
+    std::unique_ptr<ParallelInserter> parallelInserter;
+    if (_numBuildThreads > 1) {
+        parallelInserter.reset(new ParallelInserter(this, _numBuildThreads, dupsOut));
+    }
+
     Snapshotted<BSONObj> objToIndex;
     RecordId loc;
     PlanExecutor::ExecState state;
@@ -256,6 +455,17 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(std::set<RecordId>* dupsO
             // Done before insert so we can retry document if it WCEs.
             progress->setTotalWhileRunning(_collection->numRecords(_txn));
 
+            if (parallelInserter) {
+                Status ret = parallelInserter->add(objToIndex.value(), loc);
+                if (!ret.isOK())
+                    return ret;
+
+                progress->hit();
+                n++;
+                retries = 0;
+                continue;
+            }
+
             WriteUnitOfWork wunit(_txn);
             Status ret = insert(objToIndex.value(), loc);
             if (ret.isOK()) {
@@ -296,14 +506,29 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(std::set<RecordId>* dupsO
         uasserted(28550, "Unable to complete index build as the collection is no longer readable");
     }
 
+    if (parallelInserter) {
+        Status ret = parallelInserter->finish();
+        if (!ret.isOK())
+            return ret;
+    }
+
     progress->finished();
 
     Status ret = doneInserting(dupsOut);
     if (!ret.isOK())
         return ret;
 
+    if (_useSideWrites) {
+        ret = _drainSideWrites();
+        if (!ret.isOK())
+            return ret;
+    }
+
+    const std::string threads = _numBuildThreads > 1
+        ? std::string(str::stream() << " using " << _numBuildThreads << " threads")
+        : std::string();
     log() << "build index done.  scanned " << n << " total records. " << t.seconds() << " secs"
-          << endl;
+          << threads << endl;
 
     return Status::OK();
 }
@@ -325,9 +550,66 @@ Status MultiIndexBlock::insert(const BSONObj& doc, const RecordId& loc) {
         if (!idxStatus.isOK())
             return idxStatus;
     }
+
+    if (!_buildInBackground || _useSideWrites)
+        _noteInsertedIntoPartition(0);
+    return Status::OK();
+}
+
+Status MultiIndexBlock::_insertIntoPartition(size_t partition,
+                                             const BSONObj& doc,
+                                             const RecordId& loc) {
+    for (size_t i = 0; i < _indexes.size(); i++) {
+        if (_indexes[i].filterExpression && !_indexes[i].filterExpression->matchesBSON(doc)) {
+            continue;
+        }
+
+        int64_t unused;
+        Status idxStatus = _indexes[i].bulk->insertIntoPartition(
+            partition, doc, loc, _indexes[i].options, &unused);
+        if (!idxStatus.isOK())
+            return idxStatus;
+    }
+
+    _noteInsertedIntoPartition(partition);
     return Status::OK();
 }
 
+void MultiIndexBlock::_noteInsertedIntoPartition(size_t partition) {
+    if (++_docsSinceMemoryRebalance[partition] < kDocsBetweenMemoryRebalances)
+        return;
+
+    _docsSinceMemoryRebalance[partition] = 0;
+    _rebalanceBulkMemory(partition);
+}
+
+void MultiIndexBlock::_rebalanceBulkMemory(size_t partition) {
+    if (_indexes.empty())
+        return;
+
+    const size_t budget =
+        static_cast<size_t>(std::max(1, maxIndexBuildMemoryUsageMegabytes)) * 1024 * 1024 /
+        _numBuildThreads;
+
+    // Every index keeps a quarter of an even share, so one that has produced no keys yet can
+    // still take some without spilling. The rest follows the bytes of keys each has produced.
+    const size_t minimum = budget / (4 * _indexes.size());
+    const size_t proportional = budget - minimum * _indexes.size();
+
+    int64_t totalKeyBytes = 0;
+    for (size_t i = 0; i < _indexes.size(); i++) {
+        totalKeyBytes += _indexes[i].bulk->keyBytesInserted(partition);
+    }
+
+    for (size_t i = 0; i < _indexes.size(); i++) {
+        const double fraction = totalKeyBytes
+            ? static_cast<double>(_indexes[i].bulk->keyBytesInserted(partition)) / totalKeyBytes
+            : 1.0 / _indexes.size();
+        _indexes[i].bulk->setMaxMemoryUsageBytes(
+            partition, minimum + static_cast<size_t>(proportional * fraction));
+    }
+}
+
 Status MultiIndexBlock::doneInserting(std::set<RecordId>* dupsOut) {
     for (size_t i = 0; i < _indexes.size(); i++) {
         if (_indexes[i].bulk == NULL)
@@ -347,12 +629,74 @@ Status MultiIndexBlock::doneInserting(std::set<RecordId>* dupsOut) {
     return Status::OK();
 }
 
+Status MultiIndexBlock::_drainSideWrites() {
+    for (int pass = 1;; pass++) {
+        size_t maxLeft = 0;
+        for (size_t i = 0; i < _indexes.size(); i++) {
+            IndexToBuild& index = _indexes[i];
+
+            // Only take on the entries there were at the start of the pass, so writers adding
+            // more as fast as they are applied cannot keep the build here.
+            size_t numToDrain = index.sideWrites->size();
+            while (numToDrain > 0) {
+                if (_allowInterruption)
+                    _txn->checkForInterrupt();
+
+                size_t numEntries = 0;
+                MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+                    WriteUnitOfWork wunit(_txn);
+                    Status status =
+                        index.real->drainSideWrites(_txn,
+                                                    index.sideWrites.get(),
+                                                    std::min(numToDrain, kSideWritesPerBatch),
+                                                    index.options,
+                                                    &numEntries);
+                    if (!status.isOK())
+                        return status;
+                    wunit.commit();
+                }
+                MONGO_WRITE_CONFLICT_RETRY_LOOP_END(
+                    _txn, "applying index build side writes", _collection->ns().ns());
+
+                if (numEntries == 0) {
+                    // The oldest entry is still being written.
+                    break;
+                }
+                numToDrain -= numEntries;
+            }
+
+            maxLeft = std::max(maxLeft, index.sideWrites->size());
+        }
+
+        if (maxLeft <= kSideWritesLeftForCommit || pass == kMaxSideWritePasses) {
+            LOG(1) << "\t applied index build side writes in " << pass << " passes, "
+                   << maxLeft << " left for commit";
+            return Status::OK();
+        }
+    }
+}
+
 void MultiIndexBlock::abortWithoutCleanup() {
     _indexes.clear();
     _needToCleanup = false;
 }
 
 void MultiIndexBlock::commit() {
+    if (_useSideWrites) {
+        // No writer can be in the middle of recording under the exclusive lock, so the rest of
+        // each side table goes to its index in this unit of work. Writes go to the index
+        // directly from now on.
+        for (size_t i = 0; i < _indexes.size(); i++) {
+            IndexToBuild& index = _indexes[i];
+            const size_t numLeft = index.sideWrites->size();
+            size_t numEntries;
+            uassertStatusOK(index.real->drainSideWrites(
+                _txn, index.sideWrites.get(), numLeft, index.options, &numEntries));
+            invariant(numEntries == numLeft);
+            index.real->setSideWrites(nullptr);
+        }
+    }
+
     for (size_t i = 0; i < _indexes.size(); i++) {
         _indexes[i].block->success();
     }
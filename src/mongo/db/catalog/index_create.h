@@ -38,6 +38,7 @@
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status.h"
 #include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_build_side_writes.h"
 #include "mongo/db/record_id.h"
 
 namespace mongo {
@@ -164,6 +165,9 @@ public:
      * logOp() should be called from the same unit of work as commit().
      *
      * Requires holding an exclusive database lock.
+     *
+     * A background build that kept the writes made during it in side tables applies the last of
+     * them here, and throws if that fails.
      */
     void commit();
 
@@ -190,6 +194,31 @@ public:
 private:
     class SetNeedToCleanupOnRollback;
     class CleanupIndexesVectorOnRollback;
+    class ParallelInserter;
+
+    /**
+     * Like insert(), but adds the keys to the given partition of each bulk builder. Only legal
+     * when every index is built in bulk. Does not use '_txn', so it may run on any thread.
+     */
+    Status _insertIntoPartition(size_t partition, const BSONObj& doc, const RecordId& loc);
+
+    /**
+     * Counts a document inserted into the given partition, periodically redistributing the
+     * memory budget of its sorters.
+     */
+    void _noteInsertedIntoPartition(size_t partition);
+
+    /**
+     * Divides the memory budget of the given partition between the sorters of the indexes, in
+     * proportion to the bytes of keys each index has generated into it so far.
+     */
+    void _rebalanceBulkMemory(size_t partition);
+
+    /**
+     * Applies the side writes recorded for each index while it was bulk loaded, without the
+     * exclusive lock, until few enough are left for commit() to apply the rest quickly.
+     */
+    Status _drainSideWrites();
 
     struct IndexToBuild {
 #if defined(_MSC_VER) && _MSC_VER < 1900  // MVSC++ <= 2013 can't generate default move operations
@@ -198,6 +227,7 @@ private:
             : block(std::move(other.block)),
               real(std::move(other.real)),
               bulk(std::move(other.bulk)),
+              sideWrites(std::move(other.sideWrites)),
               options(std::move(other.options)),
               filterExpression(std::move(other.filterExpression)) {}
 
@@ -206,6 +236,7 @@ private:
             real = std::move(other.real);
             filterExpression = std::move(other.filterExpression);
             bulk = std::move(other.bulk);
+            sideWrites = std::move(other.sideWrites);
             options = std::move(other.options);
             return *this;
         }
@@ -217,6 +248,9 @@ private:
         const MatchExpression* filterExpression;  // might be NULL, owned elsewhere
         std::unique_ptr<IndexAccessMethod::BulkBuilder> bulk;
 
+        // Shared with 'real' while concurrent writes are recorded in it.
+        std::shared_ptr<IndexBuildSideWrites> sideWrites;
+
         InsertDeleteOptions options;
     };
 
@@ -232,6 +266,17 @@ private:
     bool _allowInterruption;
     bool _ignoreUnique;
 
+    // Whether this background build loads the keys in bulk while concurrent writes are recorded
+    // in side tables.
+    bool _useSideWrites;
+
+    // The number of threads insertAllDocumentsInCollection() generates keys on, each into its
+    // own partition of the bulk builders.
+    size_t _numBuildThreads;
+
+    // Per partition, the documents inserted since its memory budget was last redistributed.
+    std::vector<size_t> _docsSinceMemoryRebalance;
+
     bool _needToCleanup;
 };
 
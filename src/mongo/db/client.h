@@ -75,6 +75,18 @@ public:
      */
     static void initThreadIfNotAlready();
 
+    /**
+     * Unbinds the Client from the current thread and returns it, leaving the current thread
+     * without a Client. Used by service executors which do not dedicate a thread to each
+     * connection, so the Client can be moved to whichever thread services the connection next.
+     */
+    static ServiceContext::UniqueClient releaseCurrent();
+
+    /**
+     * Binds "client" to the current thread, which must not already have a Client.
+     */
+    static void setCurrent(ServiceContext::UniqueClient client);
+
     std::string clientAddress(bool includePort = false) const;
     const std::string& desc() const {
         return _desc;
@@ -151,7 +163,7 @@ private:
     const std::string _desc;
 
     // OS id of the thread, which owns this client
-    const stdx::thread::id _threadId;
+    stdx::thread::id _threadId;
 
     // > 0 for things "conn", 0 otherwise
     const ConnectionId _connectionId;
@@ -119,9 +119,10 @@ struct Cloner::Fun {
     void operator()(DBClientCursorBatchIterator& i) {
         invariant(from_collection.coll() != "system.indexes");
 
-        // XXX: can probably take dblock instead
-        unique_ptr<ScopedTransaction> scopedXact(new ScopedTransaction(txn, MODE_X));
-        unique_ptr<Lock::GlobalWrite> globalWriteLock(new Lock::GlobalWrite(txn->lockState()));
+        // Only the target database is locked, so that databases can be cloned concurrently.
+        unique_ptr<ScopedTransaction> scopedXact(new ScopedTransaction(txn, MODE_IX));
+        unique_ptr<Lock::DBLock> dbWriteLock(
+            new Lock::DBLock(txn->lockState(), _dbName, MODE_X));
         uassert(ErrorCodes::NotMaster,
                 str::stream() << "Not primary while cloning collection " << from_collection.ns()
                               << " to " << to_collection.ns(),
@@ -169,13 +170,13 @@ struct Cloner::Fun {
                 }
 
                 if (_mayYield) {
+                    dbWriteLock.reset();
                     scopedXact.reset();
-                    globalWriteLock.reset();
 
                     CurOp::get(txn)->yielded();
 
-                    scopedXact.reset(new ScopedTransaction(txn, MODE_X));
-                    globalWriteLock.reset(new Lock::GlobalWrite(txn->lockState()));
+                    scopedXact.reset(new ScopedTransaction(txn, MODE_IX));
+                    dbWriteLock.reset(new Lock::DBLock(txn->lockState(), _dbName, MODE_X));
 
                     // Check if everything is still all right.
                     if (txn->writesAreReplicated()) {
@@ -209,7 +209,8 @@ void Command::htmlHelp(stringstream& ss) const {
 Command::Command(StringData _name, bool web, StringData oldName)
     : name(_name.toString()),
       _commandsExecutedMetric("commands." + _name.toString() + ".total", &_commandsExecuted),
-      _commandsFailedMetric("commands." + _name.toString() + ".failed", &_commandsFailed) {
+      _commandsFailedMetric("commands." + _name.toString() + ".failed", &_commandsFailed),
+      _latencyMetric("commands." + _name.toString() + ".latency", &_latency) {
     // register ourself.
     if (_commands == 0)
         _commands = new CommandMap();
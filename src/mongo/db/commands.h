@@ -41,6 +41,7 @@
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/explain.h"
+#include "mongo/db/stats/latency_histogram.h"
 #include "mongo/rpc/reply_builder_interface.h"
 #include "mongo/rpc/request_interface.h"
 #include "mongo/util/string_map.h"
@@ -279,9 +280,13 @@ protected:
     Counter64 _commandsExecuted;
     Counter64 _commandsFailed;
 
+    // Latencies of the executions of this command, including failed ones
+    LatencyHistogram _latency;
+
     // Pointers to hold the metrics tree references
     ServerStatusMetricField<Counter64> _commandsExecutedMetric;
     ServerStatusMetricField<Counter64> _commandsFailedMetric;
+    ServerStatusMetricField<LatencyHistogram> _latencyMetric;
 
 public:
     static const CommandMap* commandsByBestName() {
@@ -0,0 +1,206 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kCommand
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index_names.h"
+#include "mongo/db/query/index_histogram.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+using std::string;
+using std::stringstream;
+using std::vector;
+
+namespace {
+
+const long long kDefaultBuckets = 100;
+const long long kMaxBuckets = 10000;
+const long long kDefaultSampleSize = 10000;
+
+/**
+ * Reads the optional positive integer option 'fieldName' of 'cmdObj' into 'out'.
+ */
+Status parsePositiveOption(const BSONObj& cmdObj,
+                           StringData fieldName,
+                           long long maxValue,
+                           long long* out) {
+    BSONElement elt = cmdObj[fieldName];
+    if (elt.eoo()) {
+        return Status::OK();
+    }
+    if (!elt.isNumber() || elt.numberLong() <= 0 || elt.numberLong() > maxValue) {
+        return Status(ErrorCodes::BadValue,
+                      str::stream() << fieldName << " must be a number between 1 and "
+                                    << maxValue);
+    }
+    *out = elt.numberLong();
+    return Status::OK();
+}
+
+/**
+ * Scans the index behind 'iam', keeping the first key field of every so many keys so as to
+ * sample about 'sampleSize' of them, and builds a histogram from that sample.
+ */
+std::shared_ptr<const IndexHistogram> sampleIndex(OperationContext* txn,
+                                                  const IndexAccessMethod* iam,
+                                                  const BSONObj& keyPattern,
+                                                  long long numRecords,
+                                                  long long sampleSize,
+                                                  long long numBuckets) {
+    const long long stride = std::max(1LL, numRecords / sampleSize);
+
+    vector<BSONObj> sample;
+    long long numKeys = 0;
+    std::unique_ptr<SortedDataInterface::Cursor> cursor = iam->newCursor(txn);
+    const auto kWantKey = SortedDataInterface::Cursor::kWantKey;
+    for (auto entry = cursor->seek(BSONObj(), true, kWantKey); entry;
+         entry = cursor->next(kWantKey)) {
+        if (numKeys++ % stride == 0) {
+            sample.push_back(BSON("" << entry->key.firstElement()));
+        }
+    }
+
+    // The histogram wants the values in ascending order.
+    if (keyPattern.firstElement().number() < 0) {
+        std::reverse(sample.begin(), sample.end());
+    }
+
+    return std::make_shared<IndexHistogram>(sample, numBuckets, numKeys);
+}
+
+}  // namespace
+
+/**
+ * { analyze: <collection>, buckets: <int>, sampleSize: <int> }
+ */
+class AnalyzeCmd : public Command {
+public:
+    AnalyzeCmd() : Command("analyze") {}
+
+    virtual bool slaveOk() const {
+        return true;
+    }
+
+    virtual void help(stringstream& h) const {
+        h << "Sample the btree indexes of a collection into histograms that the query planner "
+             "uses to estimate the cost of candidate plans. Scans every index.\n"
+             "{ analyze: <collection>, buckets: <int>, sampleSize: <int> }";
+    }
+
+    virtual bool isWriteCommandForConfigServer() const {
+        return false;
+    }
+
+    virtual void addRequiredPrivileges(const std::string& dbname,
+                                       const BSONObj& cmdObj,
+                                       std::vector<Privilege>* out) {
+        ActionSet actions;
+        actions.addAction(ActionType::planCacheWrite);
+        out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
+    }
+
+    bool run(OperationContext* txn,
+             const string& dbname,
+             BSONObj& cmdObj,
+             int,
+             string& errmsg,
+             BSONObjBuilder& result) {
+        const NamespaceString nss(parseNs(dbname, cmdObj));
+
+        long long numBuckets = kDefaultBuckets;
+        Status status = parsePositiveOption(cmdObj, "buckets", kMaxBuckets, &numBuckets);
+        if (!status.isOK()) {
+            return appendCommandStatus(result, status);
+        }
+        long long sampleSize = kDefaultSampleSize;
+        status = parsePositiveOption(
+            cmdObj, "sampleSize", std::numeric_limits<int>::max(), &sampleSize);
+        if (!status.isOK()) {
+            return appendCommandStatus(result, status);
+        }
+
+        AutoGetDb ctx(txn, nss.db(), MODE_IX);
+        Lock::CollectionLock collLk(txn->lockState(), nss.ns(), MODE_X);
+        Collection* collection = ctx.getDb() ? ctx.getDb()->getCollection(nss) : NULL;
+        if (!collection) {
+            errmsg = "ns not found";
+            return false;
+        }
+
+        const long long numRecords = collection->numRecords(txn);
+        BSONArrayBuilder indexesBob(result.subarrayStart("indexes"));
+
+        IndexCatalog* indexCatalog = collection->getIndexCatalog();
+        IndexCatalog::IndexIterator ii = indexCatalog->getIndexIterator(txn, false);
+        while (ii.more()) {
+            const IndexDescriptor* desc = ii.next();
+            if (IndexNames::nameToType(desc->getAccessMethodName()) != INDEX_BTREE) {
+                continue;
+            }
+
+            std::shared_ptr<const IndexHistogram> histogram =
+                sampleIndex(txn,
+                            indexCatalog->getIndex(desc),
+                            desc->keyPattern(),
+                            numRecords,
+                            sampleSize,
+                            numBuckets);
+            collection->infoCache()->setIndexHistogram(txn, desc->indexName(), histogram);
+
+            BSONObjBuilder indexBob(indexesBob.subobjStart());
+            indexBob.append("name", desc->indexName());
+            indexBob.append("keys", histogram->numKeys());
+            histogram->appendBuckets("buckets", &indexBob);
+        }
+        indexesBob.doneFast();
+
+        LOG(1) << "analyze collected histograms for " << nss.ns();
+        return true;
+    }
+
+} analyzeCmd;
+
+}  // namespace mongo
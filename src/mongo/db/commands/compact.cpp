@@ -48,6 +48,8 @@
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -80,13 +82,85 @@ public:
                 "warning: this operation locks the database and is slow. you can cancel with "
                 "killOp()\n"
                 "{ compact : <collection_name>, [force:<bool>], [validate:<bool>],\n"
-                "  [paddingFactor:<num>], [paddingBytes:<num>] }\n"
+                "  [paddingFactor:<num>], [paddingBytes:<num>],\n"
+                "  [online:<bool>], [maxBytesPerSec:<num>] }\n"
                 "  force - allows to run on a replica set primary\n"
                 "  validate - check records are noncorrupt before adding to newly compacting "
-                "extents. slower but safer (defaults to true in this version)\n";
+                "extents. slower but safer (defaults to true in this version)\n"
+                "  online - move documents out of the most fragmented extents in small batches "
+                "without locking the database. cannot be combined with validate\n"
+                "  maxBytesPerSec - limits the rate at which online compaction works\n";
     }
     CompactCmd() : Command("compact") {}
 
+    /**
+     * Runs online compaction in batches, taking the locks afresh for every batch so that other
+     * operations on the database and collection can run in between.
+     */
+    bool runOnline(OperationContext* txn,
+                   const string& db,
+                   const NamespaceString& nss,
+                   const CompactOptions& compactOptions,
+                   string& errmsg,
+                   BSONObjBuilder& result) {
+        const long long kMaxBatchBytes = 1024 * 1024;
+        const long long batchBytes = compactOptions.maxBytesPerSec > 0
+            ? std::min(kMaxBatchBytes, compactOptions.maxBytesPerSec)
+            : kMaxBatchBytes;
+
+        log() << "compact " << nss.ns() << " begin, options: " << compactOptions.toString();
+
+        CompactStats stats;
+        Timer timer;
+        for (long long batches = 1;; batches++) {
+            txn->checkForInterrupt();
+
+            {
+                ScopedTransaction transaction(txn, MODE_IX);
+                AutoGetDb autoDb(txn, db, MODE_IX);
+                Lock::CollectionLock collLock(txn->lockState(), nss.ns(), MODE_X);
+                Database* const collDB = autoDb.getDb();
+                Collection* collection = collDB ? collDB->getCollection(nss) : NULL;
+
+                if (!collDB || !collection) {
+                    errmsg = "namespace does not exist";
+                    return false;
+                }
+
+                BackgroundOperation::assertNoBgOpInProgForNs(nss.ns());
+
+                if (collection->isCapped()) {
+                    errmsg = "cannot compact a capped collection";
+                    return false;
+                }
+
+                StatusWith<bool> status =
+                    collection->compactOnline(txn, &compactOptions, batchBytes, &stats);
+                if (!status.isOK())
+                    return appendCommandStatus(result, status.getStatus());
+
+                if (status.getValue())
+                    break;
+            }
+
+            if (compactOptions.maxBytesPerSec > 0) {
+                const long long targetMillis =
+                    batches * batchBytes * 1000 / compactOptions.maxBytesPerSec;
+                const long long elapsedMillis = timer.millis();
+                if (targetMillis > elapsedMillis)
+                    sleepmillis(targetMillis - elapsedMillis);
+            }
+        }
+
+        result.append("bytesMoved", stats.bytesMoved);
+        result.append("extentsFreed", stats.extentsFreed);
+
+        log() << "compact " << nss.ns() << " end, moved " << stats.bytesMoved << " bytes and freed "
+              << stats.extentsFreed << " extents";
+
+        return true;
+    }
+
     virtual bool run(OperationContext* txn,
                      const string& db,
                      BSONObj& cmdObj,
@@ -95,8 +169,10 @@ public:
                      BSONObjBuilder& result) {
         const std::string nsToCompact = parseNsCollectionRequired(db, cmdObj);
 
+        const bool online = cmdObj["online"].trueValue();
+
         repl::ReplicationCoordinator* replCoord = repl::getGlobalReplicationCoordinator();
-        if (replCoord->getMemberState().primary() && !cmdObj["force"].trueValue()) {
+        if (!online && replCoord->getMemberState().primary() && !cmdObj["force"].trueValue()) {
             errmsg =
                 "will not run compact on an active replica set primary as this is a slow blocking "
                 "operation. use force:true to force";
@@ -146,6 +222,26 @@ public:
         if (cmdObj.hasElement("validate"))
             compactOptions.validateDocuments = cmdObj["validate"].trueValue();
 
+        if (online) {
+            if (cmdObj["validate"].trueValue()) {
+                errmsg = "cannot mix online and validate";
+                return false;
+            }
+            compactOptions.online = true;
+            compactOptions.validateDocuments = false;
+            if (cmdObj.hasElement("maxBytesPerSec")) {
+                compactOptions.maxBytesPerSec = cmdObj["maxBytesPerSec"].numberLong();
+                if (compactOptions.maxBytesPerSec < 0) {
+                    errmsg = "invalid maxBytesPerSec";
+                    return false;
+                }
+            }
+            return runOnline(txn, db, nss, compactOptions, errmsg, result);
+        } else if (cmdObj.hasElement("maxBytesPerSec")) {
+            errmsg = "maxBytesPerSec requires online";
+            return false;
+        }
+
 
         ScopedTransaction transaction(txn, MODE_IX);
         AutoGetDb autoDb(txn, db, MODE_X);
@@ -32,14 +32,20 @@
 
 #include "mongo/db/commands/dbhash.h"
 
+#include <boost/optional.hpp>
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_catalog_entry.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/db_raii.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/log.h"
 #include "mongo/util/md5.hpp"
 #include "mongo/util/timer.h"
@@ -55,6 +61,10 @@ using std::vector;
 
 DBHashCmd dbhashCmd;
 
+// Maximum number of collections hashed at once by a dbHash command run with
+// perCollectionLocks: true.
+MONGO_EXPORT_SERVER_PARAMETER(dbHashMaxThreads, int, 4);
+
 
 void logOpForDbHash(OperationContext* txn, const char* ns) {
     dbhashCmd.wipeCacheForCollection(txn, ns);
@@ -73,7 +83,7 @@ void DBHashCmd::addRequiredPrivileges(const std::string& dbname,
 }
 
 std::string DBHashCmd::hashCollection(OperationContext* opCtx,
-                                      Database* db,
+                                      Collection* collection,
                                       const std::string& fullCollectionName,
                                       bool* fromCache) {
     stdx::unique_lock<stdx::mutex> cachedHashedLock(_cachedHashedMutex, stdx::defer_lock);
@@ -88,7 +98,6 @@ std::string DBHashCmd::hashCollection(OperationContext* opCtx,
     }
 
     *fromCache = false;
-    Collection* collection = db->getCollection(fullCollectionName);
     if (!collection)
         return "";
 
@@ -138,6 +147,64 @@ std::string DBHashCmd::hashCollection(OperationContext* opCtx,
     return hash;
 }
 
+Status DBHashCmd::hashCollectionsWithCollectionLocks(
+    OperationContext* txn,
+    const std::vector<std::string>& fullCollectionNames,
+    std::vector<CollectionHash>* hashes) {
+    hashes->assign(fullCollectionNames.size(), CollectionHash());
+
+    AtomicUInt32 nextCollection;
+    AtomicUInt32 stopRequested;
+    stdx::mutex errorMutex;
+    Status firstError = Status::OK();
+
+    const auto hashCollections = [&](OperationContext* opCtx) {
+        try {
+            while (!stopRequested.load()) {
+                const size_t i = nextCollection.fetchAndAdd(1);
+                if (i >= fullCollectionNames.size()) {
+                    return;
+                }
+                if (opCtx == txn) {
+                    txn->checkForInterrupt();
+                }
+
+                const NamespaceString nss(fullCollectionNames[i]);
+                ScopedTransaction scopedXact(opCtx, MODE_IS);
+                AutoGetDb autoDb(opCtx, nss.db(), MODE_IS);
+                Lock::CollectionLock collLock(opCtx->lockState(), nss.ns(), MODE_S);
+                Collection* collection =
+                    autoDb.getDb() ? autoDb.getDb()->getCollection(nss) : nullptr;
+                (*hashes)[i].hash = hashCollection(
+                    opCtx, collection, fullCollectionNames[i], &(*hashes)[i].fromCache);
+            }
+        } catch (const DBException& ex) {
+            stopRequested.store(1);
+            stdx::lock_guard<stdx::mutex> lk(errorMutex);
+            if (firstError.isOK()) {
+                firstError = ex.toStatus();
+            }
+        }
+    };
+
+    // The thread running the command hashes collections too, so that killOp stops the workers.
+    const size_t numThreads =
+        std::min(fullCollectionNames.size(), static_cast<size_t>(std::max(dbHashMaxThreads, 1)));
+    std::vector<stdx::thread> workers;
+    for (size_t i = 1; i < numThreads; ++i) {
+        workers.emplace_back([&hashCollections] {
+            Client::initThread("dbHashWorker");
+            auto opCtx = cc().makeOperationContext();
+            hashCollections(opCtx.get());
+        });
+    }
+    hashCollections(txn);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return firstError;
+}
+
 bool DBHashCmd::run(OperationContext* txn,
                     const string& dbname,
                     BSONObj& cmdObj,
@@ -159,14 +226,18 @@ bool DBHashCmd::run(OperationContext* txn,
         }
     }
 
+    // By default, we lock the entire database in S-mode in order to ensure that the contents
+    // will not change for the snapshot. With perCollectionLocks, each collection is a snapshot of
+    // its own, but writes to the other collections of the database can go on while it's hashed.
+    const bool perCollectionLocks = cmdObj["perCollectionLocks"].trueValue();
+
     list<string> colls;
     const string ns = parseNs(dbname, cmdObj);
 
-    // We lock the entire database in S-mode in order to ensure that the contents will not
-    // change for the snapshot.
     ScopedTransaction scopedXact(txn, MODE_IS);
-    AutoGetDb autoDb(txn, ns, MODE_S);
-    Database* db = autoDb.getDb();
+    boost::optional<AutoGetDb> autoDb;
+    autoDb.emplace(txn, ns, perCollectionLocks ? MODE_IS : MODE_S);
+    Database* db = autoDb->getDb();
     if (db) {
         db->getDatabaseCatalogEntry()->getCollectionNamespaces(&colls);
         colls.sort();
@@ -178,9 +249,7 @@ bool DBHashCmd::run(OperationContext* txn,
     md5_state_t globalState;
     md5_init(&globalState);
 
-    vector<string> cached;
-
-    BSONObjBuilder bb(result.subobjStart("collections"));
+    vector<string> toHash;
     for (list<string>::iterator i = colls.begin(); i != colls.end(); i++) {
         string fullCollectionName = *i;
         if (fullCollectionName.size() - 1 <= dbname.size()) {
@@ -195,14 +264,37 @@ bool DBHashCmd::run(OperationContext* txn,
         if (desiredCollections.size() > 0 && desiredCollections.count(shortCollectionName) == 0)
             continue;
 
-        bool fromCache = false;
-        string hash = hashCollection(txn, db, fullCollectionName, &fromCache);
+        toHash.push_back(fullCollectionName);
+    }
+
+    vector<CollectionHash> hashes;
+    if (perCollectionLocks) {
+        autoDb = boost::none;
+        Status status = hashCollectionsWithCollectionLocks(txn, toHash, &hashes);
+        if (!status.isOK()) {
+            return appendCommandStatus(result, status);
+        }
+    } else {
+        for (const auto& fullCollectionName : toHash) {
+            CollectionHash collectionHash;
+            collectionHash.hash = hashCollection(txn,
+                                                 db->getCollection(fullCollectionName),
+                                                 fullCollectionName,
+                                                 &collectionHash.fromCache);
+            hashes.push_back(std::move(collectionHash));
+        }
+    }
+
+    vector<string> cached;
 
-        bb.append(shortCollectionName, hash);
+    BSONObjBuilder bb(result.subobjStart("collections"));
+    for (size_t i = 0; i < toHash.size(); ++i) {
+        const string& hash = hashes[i].hash;
+        bb.append(toHash[i].substr(dbname.size() + 1), hash);
 
         md5_append(&globalState, (const md5_byte_t*)hash.c_str(), hash.size());
-        if (fromCache)
-            cached.push_back(fullCollectionName);
+        if (hashes[i].fromCache)
+            cached.push_back(toHash[i]);
     }
     bb.done();
 
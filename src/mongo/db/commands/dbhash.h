@@ -35,6 +35,8 @@
 
 namespace mongo {
 
+class Collection;
+
 void logOpForDbHash(OperationContext* txn, const char* ns);
 
 class DBHashCmd : public Command {
@@ -66,13 +68,27 @@ private:
      */
     class DBHashLogOpHandler;
 
+    struct CollectionHash {
+        std::string hash;
+        bool fromCache = false;
+    };
+
     bool isCachable(StringData ns) const;
 
     std::string hashCollection(OperationContext* opCtx,
-                               Database* db,
+                               Collection* collection,
                                const std::string& fullCollectionName,
                                bool* fromCache);
 
+    /**
+     * Hashes the collections named by "fullCollectionNames" on up to dbHashMaxThreads threads,
+     * holding only an intent lock on the database and a shared lock on the collection being
+     * hashed. Fills in "hashes" in the order of "fullCollectionNames".
+     */
+    Status hashCollectionsWithCollectionLocks(OperationContext* txn,
+                                              const std::vector<std::string>& fullCollectionNames,
+                                              std::vector<CollectionHash>* hashes);
+
     std::map<std::string, std::string> _cachedHashed;
     stdx::mutex _cachedHashedMutex;
 };
@@ -44,6 +44,7 @@
 #include "mongo/db/commands.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
+#include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/namespace_string.h"
@@ -68,26 +69,31 @@ namespace mongo {
 
 namespace {
 
-const UpdateStats* getUpdateStats(const PlanStageStats* stats) {
-    // The stats may refer to an update stage, or a projection stage wrapping an update stage.
-    if (StageType::STAGE_PROJECTION == stats->stageType) {
-        invariant(stats->children.size() == 1);
-        stats = stats->children[0];
+/**
+ * Returns the update or delete stage at the root of 'exec', which may be wrapped in a projection.
+ *
+ * The stats of the command are read directly from this stage rather than from
+ * PlanExecutor::getStats(), which copies the stats of the whole plan tree.
+ */
+const PlanStage* getWriteStage(const PlanExecutor* exec, StageType expectedType) {
+    const PlanStage* stage = exec->getRootStage();
+    if (StageType::STAGE_PROJECTION == stage->stageType()) {
+        invariant(stage->getChildren().size() == 1);
+        stage = stage->getChildren()[0].get();
     }
 
-    invariant(StageType::STAGE_UPDATE == stats->stageType);
-    return static_cast<UpdateStats*>(stats->specific.get());
+    invariant(expectedType == stage->stageType());
+    return stage;
 }
 
-const DeleteStats* getDeleteStats(const PlanStageStats* stats) {
-    // The stats may refer to a delete stage, or a projection stage wrapping a delete stage.
-    if (StageType::STAGE_PROJECTION == stats->stageType) {
-        invariant(stats->children.size() == 1);
-        stats = stats->children[0];
-    }
+const UpdateStats* getUpdateStats(const PlanExecutor* exec) {
+    return static_cast<const UpdateStats*>(
+        getWriteStage(exec, StageType::STAGE_UPDATE)->getSpecificStats());
+}
 
-    invariant(StageType::STAGE_DELETE == stats->stageType);
-    return static_cast<DeleteStats*>(stats->specific.get());
+const DeleteStats* getDeleteStats(const PlanExecutor* exec) {
+    return static_cast<const DeleteStats*>(
+        getWriteStage(exec, StageType::STAGE_DELETE)->getSpecificStats());
 }
 
 /**
@@ -164,13 +170,12 @@ void appendCommandResponse(PlanExecutor* exec,
                            bool isRemove,
                            const boost::optional<BSONObj>& value,
                            BSONObjBuilder& result) {
-    const std::unique_ptr<PlanStageStats> stats(exec->getStats());
     BSONObjBuilder lastErrorObjBuilder(result.subobjStart("lastErrorObject"));
 
     if (isRemove) {
-        lastErrorObjBuilder.appendNumber("n", getDeleteStats(stats.get())->docsDeleted);
+        lastErrorObjBuilder.appendNumber("n", getDeleteStats(exec)->docsDeleted);
     } else {
-        const UpdateStats* updateStats = getUpdateStats(stats.get());
+        const UpdateStats* updateStats = getUpdateStats(exec);
         lastErrorObjBuilder.appendBool("updatedExisting", updateStats->nMatched > 0);
         lastErrorObjBuilder.appendNumber("n", updateStats->inserted ? 1 : updateStats->nMatched);
         // Note we have to use the objInserted from the stats here, rather than 'value'
@@ -43,11 +43,13 @@
 #include "mongo/db/curop.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/getmore_prefetch.h"
 #include "mongo/db/global_timestamp.h"
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/find.h"
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/getmore_request.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/s/operation_shard_version.h"
@@ -155,6 +157,10 @@ public:
         // Disable shard version checking - getmore commands are always unversioned
         OperationShardVersion::get(txn).setShardVersion(request.nss, ChunkVersion::IGNORED());
 
+        // A helper thread may still be loading this batch on behalf of the previous getMore. It
+        // needs intent locks to finish, so wait for it before taking ours.
+        waitForGetMorePrefetch(request.cursorid);
+
         // Depending on the type of cursor being operated on, we hold locks for the whole
         // getMore, or none of the getMore, or part of the getMore.  The three cases in detail:
         //
@@ -353,6 +359,11 @@ public:
                 unpinDBLock.reset(new Lock::DBLock(txn->lockState(), request.nss.db(), MODE_IS));
                 unpinCollLock.reset(
                     new Lock::CollectionLock(txn->lockState(), request.nss.ns(), MODE_IS));
+            } else if (shouldPrefetch(cursor)) {
+                // The helper thread pins the cursor itself, so unpin it while we still hold the
+                // collection lock.
+                ccPin.release();
+                startGetMorePrefetch(request.nss, request.cursorid);
             }
         }
 
@@ -421,6 +432,18 @@ public:
         return Status::OK();
     }
 
+    /**
+     * Returns whether a helper thread should load the next batch of 'cursor' once this getMore
+     * has returned. Aggregation cursors manage their own locking, awaitData cursors mostly wait
+     * for new data rather than read it, and read committed cursors must read from the committed
+     * snapshot, so none of them is prefetched.
+     */
+    static bool shouldPrefetch(ClientCursor* cursor) {
+        return internalQueryGetMorePrefetchBytes > 0 && supportsDocLocking() &&
+            cursor->cursorManager() != CursorManager::getGlobalCursorManager() &&
+            !cursor->isAggCursor() && !isCursorAwaitData(cursor) && !cursor->isReadCommitted();
+    }
+
     /**
      * Called via a ScopeGuard on early return in order to ensure that the ClientCursor gets
      * cleaned up properly.
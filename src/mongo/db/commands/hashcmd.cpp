@@ -68,9 +68,9 @@ public:
     }
 
     /* CmdObj has the form {"hash" : <thingToHash>}
-     * or {"hash" : <thingToHash>, "seed" : <number> }
+     * or {"hash" : <thingToHash>, "seed" : <number>, "hashVersion" : <number> }
      * Result has the form
-     * {"key" : <thingTohash>, "seed" : <int>, "out": NumberLong(<hash>)}
+     * {"key" : <thingTohash>, "seed" : <int>, "hashVersion" : <int>, "out": NumberLong(<hash>)}
      *
      * Example use in the shell:
      *> db.runCommand({hash: "hashthis", seed: 1})
@@ -97,7 +97,18 @@ public:
         }
         result.append("seed", seed);
 
-        result.append("out", BSONElementHasher::hash64(cmdObj.firstElement(), seed));
+        int hashVersion = Hasher::kMD5Version;
+        if (cmdObj.hasField("hashVersion")) {
+            hashVersion = cmdObj["hashVersion"].numberInt();
+            if (!cmdObj["hashVersion"].isNumber() || !Hasher::isValidVersion(hashVersion)) {
+                errmsg += "hashVersion must be 0 or 1";
+                return false;
+            }
+        }
+        result.append("hashVersion", hashVersion);
+
+        result.append("out",
+                      BSONElementHasher::hash64(cmdObj.firstElement(), seed, hashVersion));
         return true;
     }
 };
@@ -0,0 +1,224 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/incremental_group_views.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/pipeline/incremental_group.h"
+#include "mongo/db/service_context.h"
+
+namespace mongo {
+namespace {
+
+using std::string;
+using std::stringstream;
+using std::vector;
+
+/**
+ * Base class for the commands that manage incremental groups, which all name a collection in the
+ * database they run on.
+ */
+class IncrementalGroupCommand : public Command {
+public:
+    explicit IncrementalGroupCommand(const char* name) : Command(name) {}
+
+    bool isWriteCommandForConfigServer() const override {
+        return false;
+    }
+
+    bool slaveOk() const override {
+        return false;
+    }
+
+protected:
+    static void addPrivilege(const NamespaceString& nss,
+                             ActionType action,
+                             vector<Privilege>* out) {
+        ActionSet actions;
+        actions.addAction(action);
+        out->push_back(Privilege(ResourcePattern::forExactNamespace(nss), actions));
+    }
+
+    static IncrementalGroupViews& views(OperationContext* txn) {
+        return IncrementalGroupViews::get(txn->getServiceContext());
+    }
+};
+
+class CreateIncrementalGroupCmd : public IncrementalGroupCommand {
+public:
+    CreateIncrementalGroupCmd() : IncrementalGroupCommand("createIncrementalGroup") {}
+
+    void help(stringstream& help) const override {
+        help << "{ createIncrementalGroup : <source collection>, pipeline : [ <$match>..., "
+                "<$group> ], out : <target collection> }\n"
+                "Stores the partial results of the pipeline in the target collection and keeps "
+                "them current as documents are inserted into the source. Read them with "
+                "readIncrementalGroup.";
+    }
+
+    void addRequiredPrivileges(const string& dbname,
+                               const BSONObj& cmdObj,
+                               vector<Privilege>* out) override {
+        addPrivilege(NamespaceString(parseNsCollectionRequired(dbname, cmdObj)),
+                     ActionType::find,
+                     out);
+
+        const NamespaceString target(dbname, cmdObj["out"].str());
+        addPrivilege(target, ActionType::insert, out);
+        addPrivilege(target, ActionType::update, out);
+        addPrivilege(target, ActionType::remove, out);
+        addPrivilege(target, ActionType::createCollection, out);
+    }
+
+    bool run(OperationContext* txn,
+             const string& dbname,
+             BSONObj& cmdObj,
+             int,
+             string& errmsg,
+             BSONObjBuilder& result) override {
+        const NamespaceString source(parseNsCollectionRequired(dbname, cmdObj));
+
+        BSONElement outElem = cmdObj["out"];
+        if (outElem.type() != String) {
+            return appendCommandStatus(
+                result,
+                Status(ErrorCodes::BadValue, "'out' must name the collection to maintain"));
+        }
+        const NamespaceString target(dbname, outElem.valueStringData());
+
+        BSONElement pipelineElem = cmdObj["pipeline"];
+        if (pipelineElem.type() != Array) {
+            return appendCommandStatus(
+                result, Status(ErrorCodes::BadValue, "'pipeline' must be an array of stages"));
+        }
+        vector<BSONObj> stages;
+        for (auto&& stage : pipelineElem.Obj()) {
+            if (stage.type() != Object) {
+                return appendCommandStatus(
+                    result, Status(ErrorCodes::BadValue, "each pipeline stage must be an object"));
+            }
+            stages.push_back(stage.Obj());
+        }
+
+        auto group = IncrementalGroup::parse(source, stages);
+        if (!group.isOK()) {
+            return appendCommandStatus(result, group.getStatus());
+        }
+
+        return appendCommandStatus(
+            result, views(txn).create(txn, source, target, std::move(group.getValue())));
+    }
+};
+
+class ReadIncrementalGroupCmd : public IncrementalGroupCommand {
+public:
+    ReadIncrementalGroupCmd() : IncrementalGroupCommand("readIncrementalGroup") {}
+
+    void help(stringstream& help) const override {
+        help << "{ readIncrementalGroup : <target collection> }\n"
+                "Returns the results of the pipeline an incremental group maintains in the target "
+                "collection, rebuilding them first if an update or delete made them stale.";
+    }
+
+    void addRequiredPrivileges(const string& dbname,
+                               const BSONObj& cmdObj,
+                               vector<Privilege>* out) override {
+        // A stale view is rebuilt with the privileges of whoever created it.
+        addPrivilege(NamespaceString(parseNsCollectionRequired(dbname, cmdObj)),
+                     ActionType::find,
+                     out);
+    }
+
+    bool run(OperationContext* txn,
+             const string& dbname,
+             BSONObj& cmdObj,
+             int,
+             string& errmsg,
+             BSONObjBuilder& result) override {
+        const NamespaceString target(parseNsCollectionRequired(dbname, cmdObj));
+
+        auto results = views(txn).read(txn, target);
+        if (!results.isOK()) {
+            return appendCommandStatus(result, results.getStatus());
+        }
+
+        BSONArrayBuilder resultArray(result.subarrayStart("result"));
+        for (auto&& doc : results.getValue()) {
+            BSONObjBuilder docBuilder(resultArray.subobjStart());
+            doc.toBson(&docBuilder);
+        }
+        resultArray.doneFast();
+        return true;
+    }
+};
+
+class DropIncrementalGroupCmd : public IncrementalGroupCommand {
+public:
+    DropIncrementalGroupCmd() : IncrementalGroupCommand("dropIncrementalGroup") {}
+
+    void help(stringstream& help) const override {
+        help << "{ dropIncrementalGroup : <target collection> }\n"
+                "Stops maintaining the target collection of an incremental group. The collection "
+                "itself is left as it is.";
+    }
+
+    void addRequiredPrivileges(const string& dbname,
+                               const BSONObj& cmdObj,
+                               vector<Privilege>* out) override {
+        addPrivilege(NamespaceString(parseNsCollectionRequired(dbname, cmdObj)),
+                     ActionType::update,
+                     out);
+    }
+
+    bool run(OperationContext* txn,
+             const string& dbname,
+             BSONObj& cmdObj,
+             int,
+             string& errmsg,
+             BSONObjBuilder& result) override {
+        const NamespaceString target(parseNsCollectionRequired(dbname, cmdObj));
+        return appendCommandStatus(result, views(txn).drop(target));
+    }
+};
+
+CreateIncrementalGroupCmd createIncrementalGroupCmd;
+ReadIncrementalGroupCmd readIncrementalGroupCmd;
+DropIncrementalGroupCmd dropIncrementalGroupCmd;
+
+}  // namespace
+}  // namespace mongo
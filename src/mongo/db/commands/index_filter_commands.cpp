@@ -106,10 +106,56 @@ MONGO_INITIALIZER_WITH_PREREQUISITES(SetupIndexFilterCommands,
     new ListFilters();
     new ClearFilters();
     new SetFilter();
+    new ListAutoPins();
+    new ClearAutoPins();
 
     return Status::OK();
 }
 
+/**
+ * Appends the entries of 'querySettings' to 'bob' as the "filters" array of
+ * planCacheListFilters. Only includes automatically pinned entries if 'autoPinnedOnly' is true.
+ */
+void appendFilters(const QuerySettings& querySettings, bool autoPinnedOnly, BSONObjBuilder* bob) {
+    // Format of BSON result:
+    //
+    // {
+    //     hints: [
+    //         {
+    //             query: <query>,
+    //             sort: <sort>,
+    //             projection: <projection>,
+    //             indexes: [<index1>, <index2>, <index3>, ...],
+    //             autoPinned: <bool>
+    //         }
+    //  }
+    BSONArrayBuilder hintsBuilder(bob->subarrayStart("filters"));
+    OwnedPointerVector<AllowedIndexEntry> entries;
+    entries.mutableVector() = querySettings.getAllAllowedIndices();
+    for (vector<AllowedIndexEntry*>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+        AllowedIndexEntry* entry = *i;
+        invariant(entry);
+        if (autoPinnedOnly && !entry->autoPinned) {
+            continue;
+        }
+
+        BSONObjBuilder hintBob(hintsBuilder.subobjStart());
+        hintBob.append("query", entry->query);
+        hintBob.append("sort", entry->sort);
+        hintBob.append("projection", entry->projection);
+        BSONArrayBuilder indexesBuilder(hintBob.subarrayStart("indexes"));
+        for (vector<BSONObj>::const_iterator j = entry->indexKeyPatterns.begin();
+             j != entry->indexKeyPatterns.end();
+             ++j) {
+            const BSONObj& index = *j;
+            indexesBuilder.append(index);
+        }
+        indexesBuilder.doneFast();
+        hintBob.append("autoPinned", entry->autoPinned);
+    }
+    hintsBuilder.doneFast();
+}
+
 }  // namespace
 
 namespace mongo {
@@ -197,38 +243,8 @@ Status ListFilters::runIndexFilterCommand(OperationContext* txn,
 Status ListFilters::list(const QuerySettings& querySettings, BSONObjBuilder* bob) {
     invariant(bob);
 
-    // Format of BSON result:
-    //
-    // {
-    //     hints: [
-    //         {
-    //             query: <query>,
-    //             sort: <sort>,
-    //             projection: <projection>,
-    //             indexes: [<index1>, <index2>, <index3>, ...]
-    //         }
-    //  }
-    BSONArrayBuilder hintsBuilder(bob->subarrayStart("filters"));
-    OwnedPointerVector<AllowedIndexEntry> entries;
-    entries.mutableVector() = querySettings.getAllAllowedIndices();
-    for (vector<AllowedIndexEntry*>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
-        AllowedIndexEntry* entry = *i;
-        invariant(entry);
-
-        BSONObjBuilder hintBob(hintsBuilder.subobjStart());
-        hintBob.append("query", entry->query);
-        hintBob.append("sort", entry->sort);
-        hintBob.append("projection", entry->projection);
-        BSONArrayBuilder indexesBuilder(hintBob.subarrayStart("indexes"));
-        for (vector<BSONObj>::const_iterator j = entry->indexKeyPatterns.begin();
-             j != entry->indexKeyPatterns.end();
-             ++j) {
-            const BSONObj& index = *j;
-            indexesBuilder.append(index);
-        }
-        indexesBuilder.doneFast();
-    }
-    hintsBuilder.doneFast();
+    const bool autoPinnedOnly = false;
+    appendFilters(querySettings, autoPinnedOnly, bob);
     return Status::OK();
 }
 
@@ -397,4 +413,108 @@ Status SetFilter::set(OperationContext* txn,
     return Status::OK();
 }
 
+ListAutoPins::ListAutoPins()
+    : IndexFilterCommand("planCacheListAutoPins",
+                         "Displays the index filters pinned automatically after query shapes "
+                         "were replanned to worse plans.") {}
+
+Status ListAutoPins::runIndexFilterCommand(OperationContext* txn,
+                                           const string& ns,
+                                           BSONObj& cmdObj,
+                                           BSONObjBuilder* bob) {
+    // This is a read lock. The query settings is owned by the collection.
+    AutoGetCollectionForRead ctx(txn, ns);
+
+    QuerySettings* querySettings;
+    PlanCache* unused;
+    Status status =
+        getQuerySettingsAndPlanCache(txn, ctx.getCollection(), ns, &querySettings, &unused);
+    if (!status.isOK()) {
+        // No collection - return empty array of filters.
+        BSONArrayBuilder hintsBuilder(bob->subarrayStart("filters"));
+        hintsBuilder.doneFast();
+        return Status::OK();
+    }
+    return list(*querySettings, bob);
+}
+
+// static
+Status ListAutoPins::list(const QuerySettings& querySettings, BSONObjBuilder* bob) {
+    invariant(bob);
+
+    const bool autoPinnedOnly = true;
+    appendFilters(querySettings, autoPinnedOnly, bob);
+    return Status::OK();
+}
+
+ClearAutoPins::ClearAutoPins()
+    : IndexFilterCommand("planCacheClearAutoPins",
+                         "Clears the automatic index filter pin for a single query shape or, "
+                         "if the query shape is omitted, all automatic pins for the collection.") {}
+
+Status ClearAutoPins::runIndexFilterCommand(OperationContext* txn,
+                                            const std::string& ns,
+                                            BSONObj& cmdObj,
+                                            BSONObjBuilder* bob) {
+    // This is a read lock. The query settings is owned by the collection.
+    AutoGetCollectionForRead ctx(txn, ns);
+
+    QuerySettings* querySettings;
+    PlanCache* planCache;
+    Status status =
+        getQuerySettingsAndPlanCache(txn, ctx.getCollection(), ns, &querySettings, &planCache);
+    if (!status.isOK()) {
+        // No collection - do nothing.
+        return Status::OK();
+    }
+    return clear(txn, querySettings, planCache, ns, cmdObj);
+}
+
+// static
+Status ClearAutoPins::clear(OperationContext* txn,
+                            QuerySettings* querySettings,
+                            PlanCache* planCache,
+                            const std::string& ns,
+                            const BSONObj& cmdObj) {
+    invariant(querySettings);
+
+    if (cmdObj.hasField("query")) {
+        auto statusWithCQ = PlanCacheCommand::canonicalize(txn, ns, cmdObj);
+        if (!statusWithCQ.isOK()) {
+            return statusWithCQ.getStatus();
+        }
+
+        unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+        if (querySettings->removeAutoPinnedIndices(planCache->computeKey(*cq))) {
+            planCache->remove(*cq);
+        }
+        return Status::OK();
+    }
+
+    // If query is not provided, make sure sort and projection are not in arguments.
+    if (cmdObj.hasField("sort") || cmdObj.hasField("projection")) {
+        return Status(ErrorCodes::BadValue, "sort or projection provided without query");
+    }
+
+    OwnedPointerVector<AllowedIndexEntry> entries;
+    entries.mutableVector() = querySettings->clearAutoPinnedIndices();
+
+    // Plans cached while the pins were in place were chosen from the pinned indexes only.
+    const NamespaceString nss(ns);
+    const WhereCallbackReal whereCallback(txn, nss.db());
+    for (vector<AllowedIndexEntry*>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+        AllowedIndexEntry* entry = *i;
+        invariant(entry);
+
+        auto statusWithCQ = CanonicalQuery::canonicalize(
+            nss, entry->query, entry->sort, entry->projection, whereCallback);
+        invariant(statusWithCQ.isOK());
+        std::unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+
+        planCache->remove(*cq);
+    }
+
+    return Status::OK();
+}
+
 }  // namespace mongo
@@ -183,4 +183,54 @@ public:
                       const BSONObj& cmdObj);
 };
 
+/**
+ * ListAutoPins
+ *
+ * { planCacheListAutoPins: <collection> }
+ *
+ */
+class ListAutoPins : public IndexFilterCommand {
+public:
+    ListAutoPins();
+
+    virtual Status runIndexFilterCommand(OperationContext* txn,
+                                         const std::string& ns,
+                                         BSONObj& cmdObj,
+                                         BSONObjBuilder* bob);
+
+    /**
+     * Looks up the index filters the server pinned automatically in collection's query
+     * settings. Inserts them into BSON builder in the format of planCacheListFilters.
+     */
+    static Status list(const QuerySettings& querySettings, BSONObjBuilder* bob);
+};
+
+/**
+ * ClearAutoPins
+ *
+ * { planCacheClearAutoPins: <collection>, query: <query>, sort: <sort>, projection: <projection> }
+ *
+ */
+class ClearAutoPins : public IndexFilterCommand {
+public:
+    ClearAutoPins();
+
+    virtual Status runIndexFilterCommand(OperationContext* txn,
+                                         const std::string& ns,
+                                         BSONObj& cmdObj,
+                                         BSONObjBuilder* bob);
+
+    /**
+     * If query shape is provided, clears the automatic pin for a query.
+     * Otherwise, clears all of the collection's automatic pins.
+     * Index filters set by planCacheSetFilter are left alone.
+     * Removes corresponding entries from plan cache.
+     */
+    static Status clear(OperationContext* txn,
+                        QuerySettings* querySettings,
+                        PlanCache* planCache,
+                        const std::string& ns,
+                        const BSONObj& cmdObj);
+};
+
 }  // namespace mongo
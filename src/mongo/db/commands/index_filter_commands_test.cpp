@@ -366,4 +366,108 @@ TEST(IndexFilterCommandsTest, SetAndClearFilters) {
     ASSERT_FALSE(planCacheContains(planCache, "{b: 1}", "{}", "{}"));
 }
 
+/**
+ * Tests for automatic pins
+ */
+
+/**
+ * Utility function to pin indexes automatically for a query shape.
+ */
+bool autoPin(QuerySettings* querySettings,
+             const PlanCache& planCache,
+             const char* queryStr,
+             const vector<BSONObj>& indexes) {
+    auto statusWithCQ = CanonicalQuery::canonicalize(nss, fromjson(queryStr));
+    ASSERT_OK(statusWithCQ.getStatus());
+    unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+    return querySettings->setAutoPinnedIndices(*cq, planCache.computeKey(*cq), indexes);
+}
+
+/**
+ * Utility function to get list of automatic pins from the query settings.
+ */
+vector<BSONElement> getAutoPins(const QuerySettings& querySettings, BSONObj* resultObj) {
+    BSONObjBuilder bob;
+    ASSERT_OK(ListAutoPins::list(querySettings, &bob));
+    *resultObj = bob.obj();
+    return resultObj->getField("filters").Array();
+}
+
+TEST(IndexFilterCommandsTest, AutoPinDoesNotReplaceIndexFilter) {
+    QuerySettings querySettings;
+    PlanCache planCache;
+    OperationContextNoop txn;
+
+    ASSERT_OK(SetFilter::set(&txn,
+                             &querySettings,
+                             &planCache,
+                             nss.ns(),
+                             fromjson("{query: {a: 1}, indexes: [{a: 1}]}")));
+    ASSERT_FALSE(autoPin(&querySettings, planCache, "{a: 1}", {BSON("b" << 1)}));
+
+    vector<BSONObj> filters = getFilters(querySettings);
+    ASSERT_EQUALS(filters.size(), 1U);
+    ASSERT_FALSE(filters[0].getBoolField("autoPinned"));
+    ASSERT_EQUALS(filters[0]["indexes"].Array()[0].Obj(), BSON("a" << 1));
+
+    // But an index filter replaces an automatic pin.
+    ASSERT_TRUE(autoPin(&querySettings, planCache, "{b: 1}", {BSON("b" << 1)}));
+    ASSERT_OK(SetFilter::set(&txn,
+                             &querySettings,
+                             &planCache,
+                             nss.ns(),
+                             fromjson("{query: {b: 1}, indexes: [{a: 1, b: 1}]}")));
+    BSONObj resultObj;
+    ASSERT_TRUE(getAutoPins(querySettings, &resultObj).empty());
+}
+
+TEST(IndexFilterCommandsTest, ListAndClearAutoPins) {
+    QuerySettings querySettings;
+    PlanCache planCache;
+    OperationContextNoop txn;
+
+    ASSERT_OK(SetFilter::set(&txn,
+                             &querySettings,
+                             &planCache,
+                             nss.ns(),
+                             fromjson("{query: {a: 1}, indexes: [{a: 1}]}")));
+    ASSERT_TRUE(autoPin(&querySettings, planCache, "{b: 1}", {BSON("b" << 1)}));
+    ASSERT_TRUE(autoPin(&querySettings, planCache, "{c: 1}", {BSON("c" << 1)}));
+    addQueryShapeToPlanCache(&planCache, "{b: 1}", "{}", "{}");
+    addQueryShapeToPlanCache(&planCache, "{c: 1}", "{}", "{}");
+
+    // planCacheListFilters shows every filter, planCacheListAutoPins only the automatic ones.
+    ASSERT_EQUALS(getFilters(querySettings).size(), 3U);
+    BSONObj resultObj;
+    vector<BSONElement> pins = getAutoPins(querySettings, &resultObj);
+    ASSERT_EQUALS(pins.size(), 2U);
+    for (const BSONElement& pin : pins) {
+        ASSERT_TRUE(pin.Obj().getBoolField("autoPinned"));
+    }
+
+    // Clearing the pin of a shape which only has an index filter does nothing.
+    ASSERT_OK(ClearAutoPins::clear(
+        &txn, &querySettings, &planCache, nss.ns(), fromjson("{query: {a: 1}}")));
+    ASSERT_EQUALS(getFilters(querySettings).size(), 3U);
+
+    // Clear single pin.
+    ASSERT_OK(ClearAutoPins::clear(
+        &txn, &querySettings, &planCache, nss.ns(), fromjson("{query: {b: 1}}")));
+    ASSERT_EQUALS(getAutoPins(querySettings, &resultObj).size(), 1U);
+    ASSERT_FALSE(planCacheContains(planCache, "{b: 1}", "{}", "{}"));
+    ASSERT_TRUE(planCacheContains(planCache, "{c: 1}", "{}", "{}"));
+
+    // Sort without query is rejected.
+    ASSERT_NOT_OK(ClearAutoPins::clear(
+        &txn, &querySettings, &planCache, nss.ns(), fromjson("{sort: {a: 1}}")));
+
+    // Clear all pins. The index filter stays.
+    ASSERT_OK(ClearAutoPins::clear(&txn, &querySettings, &planCache, nss.ns(), fromjson("{}")));
+    ASSERT_TRUE(getAutoPins(querySettings, &resultObj).empty());
+    ASSERT_FALSE(planCacheContains(planCache, "{c: 1}", "{}", "{}"));
+    vector<BSONObj> filters = getFilters(querySettings);
+    ASSERT_EQUALS(filters.size(), 1U);
+    ASSERT_EQUALS(filters[0].getObjectField("query"), fromjson("{a: 1}"));
+}
+
 }  // namespace
@@ -33,6 +33,7 @@
 #include "mongo/db/catalog/cursor_manager.h"
 #include "mongo/db/commands/killcursors_common.h"
 #include "mongo/db/db_raii.h"
+#include "mongo/db/getmore_prefetch.h"
 #include "mongo/db/query/killcursors_request.h"
 
 namespace mongo {
@@ -45,6 +46,9 @@ public:
 
 private:
     Status _killCursor(OperationContext* txn, const NamespaceString& nss, CursorId cursorId) final {
+        // A pinned cursor can't be killed, so let a getMore prefetch unpin it first.
+        waitForGetMorePrefetch(cursorId);
+
         std::unique_ptr<AutoGetCollectionForRead> ctx;
 
         CursorManager* cursorManager;
@@ -97,11 +97,16 @@ public:
                 ScopedTransaction transaction(txn, MODE_IS);
                 Lock::DBLock dbLock(txn->lockState(), dbname, MODE_IS);
 
-                Database* db = dbHolder().get(txn, dbname);
-                if (!db)
-                    continue;
-
-                const DatabaseCatalogEntry* entry = db->getDatabaseCatalogEntry();
+                const DatabaseCatalogEntry* entry;
+                if (dbHolder().isDeferred(txn, dbname)) {
+                    // Don't open a database just to report its size.
+                    entry = storageEngine->getDatabaseCatalogEntry(txn, dbname);
+                } else {
+                    Database* db = dbHolder().get(txn, dbname);
+                    if (!db)
+                        continue;
+                    entry = db->getDatabaseCatalogEntry();
+                }
                 invariant(entry);
 
                 int64_t size = entry->sizeOnDisk(txn);
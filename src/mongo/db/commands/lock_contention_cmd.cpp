@@ -0,0 +1,201 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/concurrency/lock_stats.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/stats/top.h"
+#include "mongo/platform/unordered_map.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+using std::string;
+using std::stringstream;
+using std::vector;
+
+namespace {
+
+const long long kDefaultLimit = 10;
+
+// The modes reported for every resource. Always reporting the same fields keeps the schema of
+// the diagnostic data stable.
+const LockMode kReportedModes[] = {MODE_IS, MODE_IX, MODE_S, MODE_X};
+
+/**
+ * Maps the ResourceIds of the databases and collections known to Top back to their names, which
+ * the lock manager only keeps as hashes.
+ */
+class ResourceNames {
+public:
+    ResourceNames(OperationContext* txn, const vector<LockContentionTable::ResourceStats>& stats) {
+        bool needsNames = false;
+        for (const auto& resourceStats : stats) {
+            const ResourceType type = resourceStats.resId.getType();
+            needsNames = needsNames || type == RESOURCE_DATABASE || type == RESOURCE_COLLECTION;
+        }
+        if (!needsNames) {
+            return;
+        }
+
+        Top::UsageMap usage;
+        Top::get(txn->getClient()->getServiceContext()).cloneMap(usage);
+        for (const auto& entry : usage) {
+            const StringData ns = entry.first;
+            const StringData db = nsToDatabaseSubstring(ns);
+            _names[ResourceId(RESOURCE_COLLECTION, ns)] = ns.toString();
+            _names[ResourceId(RESOURCE_DATABASE, db)] = db.toString();
+        }
+    }
+
+    string get(ResourceId resId) const {
+        const auto it = _names.find(resId);
+        if (it != _names.end()) {
+            return it->second;
+        }
+
+        switch (resId.getType()) {
+            case RESOURCE_GLOBAL:
+            case RESOURCE_MMAPV1_FLUSH:
+                return resourceTypeName(resId.getType());
+            default:
+                return resId.toString();
+        }
+    }
+
+private:
+    unordered_map<ResourceId, string> _names;
+};
+
+void appendModeStats(const LockContentionTable::CountersType& stats, BSONObjBuilder* builder) {
+    builder->append("acquireWaitCount", static_cast<long long>(stats.numWaits));
+    builder->append("timeAcquiringMicros", static_cast<long long>(stats.combinedWaitTimeMicros));
+    builder->append("deadlockCount", static_cast<long long>(stats.numDeadlocks));
+
+    BSONObjBuilder histogram(builder->subobjStart("acquireWaitTimeHistogram"));
+    for (int i = 0; i < kLockWaitHistogramBuckets; i++) {
+        histogram.append(lockWaitHistogramBucketName(i),
+                         static_cast<long long>(stats.waitTimeHistogram[i]));
+    }
+    histogram.doneFast();
+}
+
+}  // namespace
+
+/**
+ * { lockContention: 1, limit: <int> }
+ */
+class LockContentionCmd : public Command {
+public:
+    LockContentionCmd() : Command("lockContention", true) {}
+
+    virtual bool slaveOk() const {
+        return true;
+    }
+
+    virtual bool adminOnly() const {
+        return true;
+    }
+
+    virtual bool isWriteCommandForConfigServer() const {
+        return false;
+    }
+
+    virtual void help(stringstream& h) const {
+        h << "the resources with the longest lock wait time since startup, in micros\n"
+             "{ lockContention: 1, limit: <int> }";
+    }
+
+    virtual void addRequiredPrivileges(const std::string& dbname,
+                                       const BSONObj& cmdObj,
+                                       std::vector<Privilege>* out) {
+        ActionSet actions;
+        actions.addAction(ActionType::top);
+        out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+    }
+
+    bool run(OperationContext* txn,
+             const string& dbname,
+             BSONObj& cmdObj,
+             int,
+             string& errmsg,
+             BSONObjBuilder& result) {
+        long long limit = kDefaultLimit;
+        BSONElement limitElt = cmdObj["limit"];
+        if (!limitElt.eoo()) {
+            const long long maxLimit = LockContentionTable::kNumSlots;
+            if (!limitElt.isNumber() || limitElt.numberLong() <= 0 ||
+                limitElt.numberLong() > maxLimit) {
+                return appendCommandStatus(
+                    result,
+                    Status(ErrorCodes::BadValue,
+                           str::stream() << "limit must be a number between 1 and " << maxLimit));
+            }
+            limit = limitElt.numberLong();
+        }
+
+        const LockContentionTable& table = getGlobalLockContentionTable();
+        const vector<LockContentionTable::ResourceStats> mostContended =
+            table.getMostContended(limit);
+        const ResourceNames names(txn, mostContended);
+
+        result.append("note", "all times in microseconds");
+        result.append("untrackedWaits", static_cast<long long>(table.getNumUntrackedWaits()));
+
+        BSONArrayBuilder resources(result.subarrayStart("resources"));
+        for (const auto& resourceStats : mostContended) {
+            BSONObjBuilder resource(resources.subobjStart());
+            resource.append("resource", names.get(resourceStats.resId));
+            resource.append("type", resourceTypeName(resourceStats.resId.getType()));
+            resource.append("timeAcquiringMicros",
+                            static_cast<long long>(resourceStats.combinedWaitTimeMicros()));
+
+            BSONObjBuilder modes(resource.subobjStart("modes"));
+            for (LockMode mode : kReportedModes) {
+                BSONObjBuilder modeBuilder(modes.subobjStart(legacyModeName(mode)));
+                appendModeStats(resourceStats.modeStats[mode], &modeBuilder);
+            }
+        }
+        resources.doneFast();
+
+        return true;
+    }
+
+} lockContentionCmd;
+
+}  // namespace mongo
@@ -32,6 +32,10 @@
 
 #include "mongo/db/commands/mr.h"
 
+#include <cmath>
+#include <limits>
+#include <pcrecpp.h>
+
 #include "mongo/client/connpool.h"
 #include "mongo/client/parallel.h"
 #include "mongo/db/auth/authorization_session.h"
@@ -59,6 +63,7 @@
 #include "mongo/db/s/collection_metadata.h"
 #include "mongo/db/s/sharded_connection_info.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/catalog/catalog_cache.h"
 #include "mongo/s/chunk_manager.h"
 #include "mongo/s/config.h"
@@ -70,6 +75,7 @@
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/text.h"
 
 namespace mongo {
 
@@ -260,6 +266,329 @@ void JSReducer::_reduce(const BSONList& tuples, BSONObj& key, int& endSizeEstima
     _reduce(x, key, endSizeEstimate);
 }
 
+namespace {
+
+// Whether mapReduce runs the map and reduce functions NativeMapper and NativeReducer recognize
+// without JavaScript.
+MONGO_EXPORT_SERVER_PARAMETER(mapReduceUseNativeFunctions, bool, true);
+
+bool isIdentifierChar(char c) {
+    return isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+}
+
+/**
+ * Returns 'code' without the whitespace that does not change its meaning, which is all of it except
+ * for one space between identifier characters. Returns an empty string if 'code' has comments,
+ * string or regular expression literals, or a line break after a 'return', none of which are part
+ * of the functions NativeMapper and NativeReducer recognize.
+ */
+std::string canonicalizeJS(StringData code) {
+    std::string out;
+    bool sawSpace = false;
+    bool sawLineBreak = false;
+    for (const char c : code) {
+        if (c == '/' || c == '"' || c == '\'' || c == '`') {
+            return "";
+        }
+        if (isspace(static_cast<unsigned char>(c))) {
+            sawSpace = true;
+            sawLineBreak = sawLineBreak || c == '\n' || c == '\r';
+            continue;
+        }
+        if (sawLineBreak && StringData(out).endsWith("return") &&
+            (out.size() == 6 || !isIdentifierChar(out[out.size() - 7]))) {
+            return "";
+        }
+        if (sawSpace && !out.empty() && isIdentifierChar(out.back()) && isIdentifierChar(c)) {
+            out += ' ';
+        }
+        sawSpace = false;
+        sawLineBreak = false;
+        out += c;
+    }
+    return out;
+}
+
+// Splits the field path ".a.b" of 'this.a.b' into its fields.
+std::vector<std::string> splitThisPath(const std::string& path) {
+    std::vector<std::string> fields;
+    size_t start = 1;
+    while (start <= path.size()) {
+        const size_t end = std::min(path.find('.', start), path.size());
+        fields.push_back(path.substr(start, end - start));
+        start = end + 1;
+    }
+    return fields;
+}
+
+/**
+ * Sets 'out' to the field at 'path' in 'obj' and returns true, or returns false if the field is
+ * missing or the path crosses something other than an object. JavaScript may see inherited
+ * properties for missing fields, and properties of other types or an exception along the way.
+ */
+bool getThisPathElement(const BSONObj& obj,
+                        const std::vector<std::string>& path,
+                        BSONElement* out) {
+    BSONObj current = obj;
+    for (size_t i = 0; i + 1 < path.size(); ++i) {
+        const BSONElement elem = current[path[i]];
+        if (elem.type() != Object) {
+            return false;
+        }
+        current = elem.embeddedObject();
+    }
+    *out = current[path.back()];
+    return !out->eoo();
+}
+
+// Whether JavaScript emits 'key' unchanged, except for ints, which it emits as doubles.
+bool isNativeEmitKey(const BSONElement& key) {
+    // The range of a JavaScript Date.
+    const long long kMaxDateMillis = 8640000000000000LL;
+
+    switch (key.type()) {
+        case NumberDouble:
+        case NumberInt:
+        case Bool:
+        case jstNULL:
+        case jstOID:
+            return true;
+        case String:
+            return isValidUTF8(key.str());
+        case Date:
+            return std::abs(key.date().toMillisSinceEpoch()) <= kMaxDateMillis;
+        default:
+            return false;
+    }
+}
+
+}  // namespace
+
+NativeMapper::NativeMapper(const BSONElement& code,
+                           std::vector<std::string> keyPath,
+                           std::vector<std::string> valuePath,
+                           double valueConstant)
+    : _jsMapper(code),
+      _keyPath(std::move(keyPath)),
+      _valuePath(std::move(valuePath)),
+      _valueConstant(valueConstant) {}
+
+std::unique_ptr<NativeMapper> NativeMapper::parse(const BSONElement& code) {
+    static const pcrecpp::RE kMapFunction(
+        "function(?: [A-Za-z_$][\\w$]*)?\\(\\)\\{"
+        "emit\\(this((?:\\.[A-Za-z_$][\\w$]*)+),"
+        "(?:this((?:\\.[A-Za-z_$][\\w$]*)+)|(-?\\d+(?:\\.\\d+)?))\\);?\\}");
+
+    if (code.type() != String && code.type() != Code) {
+        return nullptr;
+    }
+
+    std::string keyPath;
+    std::string valuePath;
+    std::string valueConstant;
+    if (!kMapFunction.FullMatch(
+            canonicalizeJS(code.valueStringData()), &keyPath, &valuePath, &valueConstant)) {
+        return nullptr;
+    }
+
+    return std::unique_ptr<NativeMapper>(
+        new NativeMapper(code,
+                         splitThisPath(keyPath),
+                         valuePath.empty() ? std::vector<std::string>() : splitThisPath(valuePath),
+                         valuePath.empty() ? strtod(valueConstant.c_str(), NULL) : 0));
+}
+
+void NativeMapper::init(State* state) {
+    _jsMapper.init(state);
+    _state = state;
+}
+
+void NativeMapper::map(const BSONObj& o) {
+    const BSONObj tuple = emitFor(o);
+    if (tuple.isEmpty()) {
+        _jsMapper.map(o);
+        return;
+    }
+
+    uassert(13069,
+            "an emit can't be more than half max bson size",
+            tuple.objsize() < (BSONObjMaxUserSize / 2));
+    _state->emit(tuple);
+}
+
+BSONObj NativeMapper::emitFor(const BSONObj& o) const {
+    BSONElement key;
+    if (!getThisPathElement(o, _keyPath, &key) || !isNativeEmitKey(key)) {
+        return BSONObj();
+    }
+
+    double value = _valueConstant;
+    if (!_valuePath.empty()) {
+        BSONElement valueElem;
+        if (!getThisPathElement(o, _valuePath, &valueElem) ||
+            (valueElem.type() != NumberDouble && valueElem.type() != NumberInt)) {
+            return BSONObj();
+        }
+        value = valueElem.numberDouble();
+    }
+
+    BSONObjBuilder b;
+    if (key.type() == NumberInt) {
+        b.append("0", key.numberDouble());
+    } else {
+        b.appendAs(key, "0");
+    }
+    b.append("1", value);
+    return b.obj();
+}
+
+std::unique_ptr<NativeReducer> NativeReducer::parse(const BSONElement& code) {
+    static const char kReduceParams[] =
+        "function(?: [A-Za-z_$][\\w$]*)?\\(([A-Za-z_$][\\w$]*),([A-Za-z_$][\\w$]*)\\)\\{";
+    static const pcrecpp::RE kArraySumFunction(std::string(kReduceParams) +
+                                               "return Array\\.sum\\(\\2\\);?\\}");
+    static const pcrecpp::RE kMathFunction(
+        std::string(kReduceParams) + "return Math\\.(max|min)\\.apply\\((?:null|Math),\\2\\);?\\}");
+    static const pcrecpp::RE kLoopSumFunction(
+        std::string(kReduceParams) +
+        "var ([A-Za-z_$][\\w$]*)=0;"
+        "for\\(var ([A-Za-z_$][\\w$]*)=0;\\4<\\2\\.length;(?:\\4\\+\\+|\\+\\+\\4|\\4\\+=1)\\)"
+        "(?:\\{\\3\\+=\\2\\[\\4\\];?\\}|\\3\\+=\\2\\[\\4\\];)"
+        "return \\3;?\\}");
+
+    if (code.type() != String && code.type() != Code) {
+        return nullptr;
+    }
+
+    const std::string function = canonicalizeJS(code.valueStringData());
+    std::string key;
+    std::string values;
+    std::string total;
+    std::string index;
+    std::string mathFunction;
+
+    Operation operation;
+    if (kArraySumFunction.FullMatch(function, &key, &values)) {
+        operation = kArraySum;
+    } else if (kMathFunction.FullMatch(function, &key, &values, &mathFunction)) {
+        operation = mathFunction == "max" ? kMax : kMin;
+    } else if (kLoopSumFunction.FullMatch(function, &key, &values, &total, &index) &&
+               total != values && index != values && index != total) {
+        operation = kLoopSum;
+    } else {
+        return nullptr;
+    }
+
+    // The functions must see the global Array and Math.
+    if (key == values || key == "Array" || key == "Math" || values == "Array" ||
+        values == "Math") {
+        return nullptr;
+    }
+
+    return std::unique_ptr<NativeReducer>(new NativeReducer(code, operation));
+}
+
+void NativeReducer::init(State* state) {
+    _jsReducer.init(state);
+}
+
+bool NativeReducer::reduceValues(const BSONList& tuples, double* out) const {
+    if (tuples.empty()) {
+        return false;
+    }
+
+    double result = 0;
+    if (_operation == kMax) {
+        result = -std::numeric_limits<double>::infinity();
+    } else if (_operation == kMin) {
+        result = std::numeric_limits<double>::infinity();
+    }
+
+    bool sawNaN = false;
+    for (size_t i = 0; i < tuples.size(); ++i) {
+        BSONObjIterator it(tuples[i]);
+        if (!it.more()) {
+            return false;
+        }
+        it.next();
+        if (!it.more()) {
+            return false;
+        }
+        const BSONElement valueElem = it.next();
+        if (valueElem.type() != NumberDouble) {
+            return false;
+        }
+        const double value = valueElem._numberDouble();
+
+        switch (_operation) {
+            case kArraySum:
+                result = i == 0 ? value : result + value;
+                break;
+            case kLoopSum:
+                result += value;
+                break;
+            case kMax:
+                // Math.max() orders +0 above -0.
+                sawNaN = sawNaN || std::isnan(value);
+                if (value > result || (value == 0 && result == 0 && !std::signbit(value))) {
+                    result = value;
+                }
+                break;
+            case kMin:
+                // Math.min() orders -0 below +0.
+                sawNaN = sawNaN || std::isnan(value);
+                if (value < result || (value == 0 && result == 0 && std::signbit(value))) {
+                    result = value;
+                }
+                break;
+        }
+    }
+
+    *out = sawNaN ? std::numeric_limits<double>::quiet_NaN() : result;
+    return true;
+}
+
+BSONObj NativeReducer::reduce(const BSONList& tuples) {
+    if (tuples.size() <= 1)
+        return tuples[0];
+
+    double value;
+    if (!reduceValues(tuples, &value)) {
+        const long long jsReduces = _jsReducer.numReduces;
+        BSONObj res = _jsReducer.reduce(tuples);
+        numReduces += _jsReducer.numReduces - jsReduces;
+        return res;
+    }
+    ++numReduces;
+
+    BSONObjBuilder b;
+    b.appendAs(tuples[0].firstElement(), "0");
+    b.append("1", value);
+    return b.obj();
+}
+
+BSONObj NativeReducer::finalReduce(const BSONList& tuples, Finalizer* finalizer) {
+    double value;
+    if (tuples.size() == 1 || !reduceValues(tuples, &value)) {
+        const long long jsReduces = _jsReducer.numReduces;
+        BSONObj res = _jsReducer.finalReduce(tuples, finalizer);
+        numReduces += _jsReducer.numReduces - jsReduces;
+        return res;
+    }
+    ++numReduces;
+
+    BSONObjBuilder b;
+    b.appendAs(tuples[0].firstElement(), "_id");
+    b.append("value", value);
+    BSONObj res = b.obj();
+
+    if (finalizer) {
+        res = finalizer->finalize(res);
+    }
+
+    return res;
+}
+
 Config::Config(const string& _dbname, const BSONObj& cmdObj) {
     dbname = _dbname;
     ns = dbname + "." + cmdObj.firstElement().valuestrsafe();
@@ -301,14 +630,27 @@ Config::Config(const string& _dbname, const BSONObj& cmdObj) {
         if (cmdObj["scope"].type() == Object)
             scopeSetup = cmdObj["scope"].embeddedObjectUserCheck();
 
-        mapper.reset(new JSMapper(cmdObj["map"]));
-        reducer.reset(new JSReducer(cmdObj["reduce"]));
         if (cmdObj["finalize"].type() && cmdObj["finalize"].trueValue())
             finalizer.reset(new JSFinalizer(cmdObj["finalize"]));
 
         if (cmdObj["mapparams"].type() == Array) {
             mapParams = cmdObj["mapparams"].embeddedObjectUserCheck();
         }
+
+        // Functions run natively emit into the C++ map, so not in JS mode, and must not see
+        // anything the user put in their scope.
+        if (mapReduceUseNativeFunctions && !jsMode && scopeSetup.isEmpty() &&
+            mapParams.isEmpty()) {
+            mapper = NativeMapper::parse(cmdObj["map"]);
+            reducer = NativeReducer::parse(cmdObj["reduce"]);
+        }
+        nativeMapper = mapper != nullptr;
+        nativeReducer = reducer != nullptr;
+
+        if (!mapper)
+            mapper.reset(new JSMapper(cmdObj["map"]));
+        if (!reducer)
+            reducer.reset(new JSReducer(cmdObj["reduce"]));
     }
 
     {
@@ -1498,6 +1840,8 @@ public:
             countsBuilder.appendNumber("reduce", state.numReduces());
             timingBuilder.appendNumber("reduceTime", reduceTime / 1000);
             timingBuilder.append("mode", state.jsMode() ? "js" : "mixed");
+            timingBuilder.append("nativeMap", config.nativeMapper);
+            timingBuilder.append("nativeReduce", config.nativeReducer);
 
             long long finalCount = state.postProcessCollection(txn, op, pm);
             state.appendResults(result);
@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -174,6 +175,100 @@ private:
     JSFunction _func;
 };
 
+// ------------  native function implementations -----------
+
+/**
+ * A map function of the form
+ *     function() { emit(this.<path>, this.<path>); }
+ * or  function() { emit(this.<path>, <number>); }
+ * run without converting the document to JavaScript whenever its key and value can be emitted
+ * exactly as JavaScript would emit them, and run in JavaScript otherwise.
+ */
+class NativeMapper : public Mapper {
+public:
+    /**
+     * Returns a NativeMapper for 'code' if it is a map function of that form, or null.
+     */
+    static std::unique_ptr<NativeMapper> parse(const BSONElement& code);
+
+    virtual void init(State* state);
+    virtual void map(const BSONObj& o);
+
+    /**
+     * Returns the tuple (key, value) the map function emits for 'o', or an empty object if only
+     * JavaScript can tell.
+     */
+    BSONObj emitFor(const BSONObj& o) const;
+
+private:
+    NativeMapper(const BSONElement& code,
+                 std::vector<std::string> keyPath,
+                 std::vector<std::string> valuePath,
+                 double valueConstant);
+
+    JSMapper _jsMapper;
+    State* _state = nullptr;
+
+    const std::vector<std::string> _keyPath;
+    // Empty if the value emitted is '_valueConstant'.
+    const std::vector<std::string> _valuePath;
+    const double _valueConstant;
+};
+
+/**
+ * A reduce function which returns the sum, the maximum or the minimum of its values, in one of
+ * the forms
+ *     function(key, values) { return Array.sum(values); }
+ *     function(key, values) {
+ *         var total = 0;
+ *         for (var i = 0; i < values.length; i++) {
+ *             total += values[i];
+ *         }
+ *         return total;
+ *     }
+ *     function(key, values) { return Math.max.apply(Math, values); }
+ *     function(key, values) { return Math.min.apply(Math, values); }
+ * run without JavaScript whenever all the values are doubles, which is what JavaScript emits and
+ * reduces numbers to, and run in JavaScript otherwise.
+ */
+class NativeReducer : public Reducer {
+public:
+    enum Operation {
+        kArraySum,  // Array.sum(), which starts from the first value.
+        kLoopSum,   // Adds the values to 0.
+        kMax,
+        kMin,
+    };
+
+    /**
+     * Returns a NativeReducer for 'code' if it is a reduce function of one of those forms, or
+     * null.
+     */
+    static std::unique_ptr<NativeReducer> parse(const BSONElement& code);
+
+    virtual void init(State* state);
+
+    virtual BSONObj reduce(const BSONList& tuples);
+    virtual BSONObj finalReduce(const BSONList& tuples, Finalizer* finalizer);
+
+    /**
+     * Sets 'out' to what the reduce function returns for the values of 'tuples', and returns
+     * true, or returns false if only JavaScript can tell.
+     */
+    bool reduceValues(const BSONList& tuples, double* out) const;
+
+    Operation operation() const {
+        return _operation;
+    }
+
+private:
+    NativeReducer(const BSONElement& code, Operation operation)
+        : _jsReducer(code), _operation(operation) {}
+
+    JSReducer _jsReducer;
+    const Operation _operation;
+};
+
 // -----------------
 
 
@@ -214,6 +309,10 @@ public:
     std::unique_ptr<Reducer> reducer;
     std::unique_ptr<Finalizer> finalizer;
 
+    // Whether 'mapper' and 'reducer' are a NativeMapper and a NativeReducer.
+    bool nativeMapper;
+    bool nativeReducer;
+
     BSONObj mapParams;
     BSONObj scopeSetup;
 
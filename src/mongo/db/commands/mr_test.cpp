@@ -32,6 +32,8 @@
 
 #include "mongo/db/commands/mr.h"
 
+#include <cmath>
+#include <limits>
 #include <string>
 
 #include "mongo/db/json.h"
@@ -208,4 +210,156 @@ TEST(ConfigOutputOptionsTest, parseOutputOptions) {
                                   mr::Config::INMEMORY);
 }
 
+/**
+ * Tests for mr::NativeMapper and mr::NativeReducer
+ */
+
+BSONObj code(const std::string& function) {
+    return BSON("f" << BSONCode(function));
+}
+
+std::unique_ptr<mr::NativeMapper> parseMapper(const std::string& function) {
+    const BSONObj obj = code(function);
+    return mr::NativeMapper::parse(obj.firstElement());
+}
+
+std::unique_ptr<mr::NativeReducer> parseReducer(const std::string& function) {
+    const BSONObj obj = code(function);
+    return mr::NativeReducer::parse(obj.firstElement());
+}
+
+mr::BSONList tuples(const BSONObj& values) {
+    mr::BSONList list;
+    BSONObjIterator it(values);
+    while (it.more()) {
+        BSONObjBuilder b;
+        b.append("0", "key");
+        b.appendAs(it.next(), "1");
+        list.push_back(b.obj());
+    }
+    return list;
+}
+
+TEST(NativeMapperTest, ParsesEmitOfFieldPaths) {
+    ASSERT(parseMapper("function() { emit(this.a, this.b); }"));
+    ASSERT(parseMapper("function () {\n    emit(this.a.b, this.c.d.e);\n}"));
+    ASSERT(parseMapper("function map() { emit(this._id, 1) }"));
+    ASSERT(parseMapper("function(){emit(this.$a,-2.5);}"));
+}
+
+TEST(NativeMapperTest, DoesNotParseOtherFunctions) {
+    ASSERT_FALSE(parseMapper("function() { emit(this.a, this.b); emit(this.b, 1); }"));
+    ASSERT_FALSE(parseMapper("function() { emit(this.a, {x: this.b}); }"));
+    ASSERT_FALSE(parseMapper("function() { emit(this['a'], 1); }"));
+    ASSERT_FALSE(parseMapper("function() { emit(this.a, 1); } // comment"));
+    ASSERT_FALSE(parseMapper("function(x) { emit(this.a, 1); }"));
+    ASSERT_FALSE(parseMapper("function() { emit(this.a, this.b + 1); }"));
+}
+
+TEST(NativeMapperTest, EmitsKeysAndValuesAsJavaScriptWould) {
+    auto mapper = parseMapper("function() { emit(this.a.b, this.c); }");
+    ASSERT(mapper);
+    ASSERT_EQUALS(BSON("0" << 1.0 << "1" << 2.0),
+                  mapper->emitFor(BSON("a" << BSON("b" << 1) << "c" << 2)));
+    ASSERT_EQUALS(BSON("0"
+                       << "x"
+                       << "1" << 2.5),
+                  mapper->emitFor(BSON("a" << BSON("b"
+                                                   << "x") << "c" << 2.5)));
+    ASSERT_EQUALS(BSONType::NumberDouble,
+                  mapper->emitFor(BSON("a" << BSON("b" << 1) << "c" << 2)).firstElement().type());
+
+    auto constantMapper = parseMapper("function() { emit(this.a, 1); }");
+    ASSERT(constantMapper);
+    ASSERT_EQUALS(BSON("0" << true << "1" << 1.0), constantMapper->emitFor(BSON("a" << true)));
+}
+
+TEST(NativeMapperTest, LeavesDocumentsItCannotEmitToJavaScript) {
+    auto mapper = parseMapper("function() { emit(this.a.b, this.c); }");
+    ASSERT(mapper);
+    // Missing fields, paths through non-objects, and keys or values JavaScript converts.
+    ASSERT(mapper->emitFor(BSON("c" << 1)).isEmpty());
+    ASSERT(mapper->emitFor(BSON("a" << BSON("b" << 1))).isEmpty());
+    ASSERT(mapper->emitFor(BSON("a" << BSON_ARRAY(BSON("b" << 1)) << "c" << 1)).isEmpty());
+    ASSERT(mapper->emitFor(BSON("a" << BSON("b" << 1LL) << "c" << 1)).isEmpty());
+    ASSERT(mapper->emitFor(BSON("a" << BSON("b" << BSON("x" << 1)) << "c" << 1)).isEmpty());
+    ASSERT(mapper->emitFor(BSON("a" << BSON("b" << 1) << "c"
+                                    << "string")).isEmpty());
+    ASSERT(mapper->emitFor(BSON("a" << BSON("b" << 1) << "c" << 1LL)).isEmpty());
+}
+
+TEST(NativeReducerTest, ParsesSumMaxAndMin) {
+    auto reducer = parseReducer("function(key, values) { return Array.sum(values); }");
+    ASSERT(reducer);
+    ASSERT_EQUALS(mr::NativeReducer::kArraySum, reducer->operation());
+
+    reducer = parseReducer(
+        "function(k, vals) {\n"
+        "    var total = 0;\n"
+        "    for (var i = 0; i < vals.length; i++) {\n"
+        "        total += vals[i];\n"
+        "    }\n"
+        "    return total;\n"
+        "}");
+    ASSERT(reducer);
+    ASSERT_EQUALS(mr::NativeReducer::kLoopSum, reducer->operation());
+
+    reducer = parseReducer("function(k, v) { return Math.max.apply(Math, v); }");
+    ASSERT(reducer);
+    ASSERT_EQUALS(mr::NativeReducer::kMax, reducer->operation());
+
+    reducer = parseReducer("function(k, v) { return Math.min.apply(null, v); }");
+    ASSERT(reducer);
+    ASSERT_EQUALS(mr::NativeReducer::kMin, reducer->operation());
+}
+
+TEST(NativeReducerTest, DoesNotParseOtherFunctions) {
+    ASSERT_FALSE(parseReducer("function(key, values) { return values.length; }"));
+    ASSERT_FALSE(parseReducer("function(key, values) { return Array.sum(key); }"));
+    ASSERT_FALSE(parseReducer("function(key, values) { return\nArray.sum(values); }"));
+    ASSERT_FALSE(parseReducer("function(Array, values) { return Array.sum(values); }"));
+    ASSERT_FALSE(parseReducer(
+        "function(k, v) { var v = 0; for (var i = 0; i < v.length; i++) { v += v[i]; } "
+        "return v; }"));
+    ASSERT_FALSE(parseReducer("function(k, v) { return Math.max(v); }"));
+}
+
+TEST(NativeReducerTest, ReducesDoublesAsJavaScriptWould) {
+    double result;
+    auto reducer = parseReducer("function(key, values) { return Array.sum(values); }");
+    ASSERT(reducer->reduceValues(tuples(BSON_ARRAY(1.5 << 2.0 << -0.5)), &result));
+    ASSERT_EQUALS(3.0, result);
+    ASSERT(reducer->reduceValues(tuples(BSON_ARRAY(-0.0 << -0.0)), &result));
+    ASSERT(std::signbit(result));
+
+    reducer = parseReducer(
+        "function(k, v) { var t = 0; for (var i = 0; i < v.length; ++i) t += v[i]; return t; }");
+    ASSERT(reducer);
+    ASSERT(reducer->reduceValues(tuples(BSON_ARRAY(-0.0 << -0.0)), &result));
+    ASSERT_FALSE(std::signbit(result));
+
+    reducer = parseReducer("function(k, v) { return Math.max.apply(Math, v); }");
+    ASSERT(reducer->reduceValues(tuples(BSON_ARRAY(1.0 << 7.0 << -3.0)), &result));
+    ASSERT_EQUALS(7.0, result);
+    ASSERT(reducer->reduceValues(tuples(BSON_ARRAY(-0.0 << 0.0)), &result));
+    ASSERT_FALSE(std::signbit(result));
+    ASSERT(reducer->reduceValues(
+        tuples(BSON_ARRAY(1.0 << std::numeric_limits<double>::quiet_NaN() << 2.0)), &result));
+    ASSERT(std::isnan(result));
+
+    reducer = parseReducer("function(k, v) { return Math.min.apply(Math, v); }");
+    ASSERT(reducer->reduceValues(tuples(BSON_ARRAY(1.0 << 7.0 << -3.0)), &result));
+    ASSERT_EQUALS(-3.0, result);
+    ASSERT(reducer->reduceValues(tuples(BSON_ARRAY(0.0 << -0.0)), &result));
+    ASSERT(std::signbit(result));
+}
+
+TEST(NativeReducerTest, LeavesOtherValuesToJavaScript) {
+    double result;
+    auto reducer = parseReducer("function(key, values) { return Array.sum(values); }");
+    ASSERT_FALSE(reducer->reduceValues(tuples(BSON_ARRAY(1.0 << 2)), &result));
+    ASSERT_FALSE(reducer->reduceValues(tuples(BSON_ARRAY(1.0 << "a")), &result));
+    ASSERT_FALSE(reducer->reduceValues(tuples(BSON_ARRAY(1.0 << BSON("x" << 1.0))), &result));
+}
+
 }  // namespace
@@ -418,14 +418,21 @@ Status PlanCacheListPlans::list(OperationContext* txn,
         statsBob.doneFast();
         reasonBob.doneFast();
 
-        // BSON object for 'feedback' field shows scores from historical executions of the plan.
+        // BSON object for 'feedback' field shows scores and execution metrics from historical
+        // executions of the plan, along with the baseline they are compared against.
         BSONObjBuilder feedbackBob(planBob.subobjStart("feedback"));
         if (i == 0U) {
             feedbackBob.append("nfeedback", int(entry->feedback.size()));
+            feedbackBob.append("baselineCostPerResult", entry->decision->winnerCostPerResult);
             BSONArrayBuilder scoresBob(feedbackBob.subarrayStart("scores"));
             for (size_t i = 0; i < entry->feedback.size(); ++i) {
+                const PlanCacheEntryFeedback* fb = entry->feedback[i];
                 BSONObjBuilder scoreBob(scoresBob.subobjStart());
-                scoreBob.append("score", entry->feedback[i]->score);
+                scoreBob.append("score", fb->score);
+                scoreBob.appendNumber("nReturned", fb->nReturned);
+                scoreBob.appendNumber("keysExamined", fb->keysExamined);
+                scoreBob.appendNumber("docsExamined", fb->docsExamined);
+                scoreBob.appendNumber("executionTimeMillis", fb->executionTimeMillis);
             }
             scoresBob.doneFast();
         }
@@ -426,4 +426,48 @@ TEST(PlanCacheCommandsTest, planCacheListPlansOnlyOneSolutionFalse) {
     ASSERT_EQUALS(plans.size(), 2U);
 }
 
+TEST(PlanCacheCommandsTest, planCacheListPlansShowsExecutionFeedback) {
+    // Create a canonical query
+    auto statusWithCQ = CanonicalQuery::canonicalize(nss, fromjson("{a: 1}"));
+    ASSERT_OK(statusWithCQ.getStatus());
+    unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+
+    // Plan cache with one entry
+    PlanCache planCache;
+    QuerySolution qs;
+    qs.cacheData.reset(createSolutionCacheData());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+    PlanRankingDecision* decision = createDecision(1U);
+    decision->winnerCostPerResult = 3;
+    planCache.add(*cq, solns, decision);
+
+    // Report a run of the cached plan.
+    unique_ptr<PlanCacheEntryFeedback> feedback(new PlanCacheEntryFeedback());
+    feedback->stats.reset(new PlanStageStats(CommonStats("COLLSCAN"), STAGE_COLLSCAN));
+    feedback->score = 1.5;
+    feedback->nReturned = 4;
+    feedback->keysExamined = 10;
+    feedback->docsExamined = 6;
+    feedback->executionTimeMillis = 2;
+    ASSERT_OK(planCache.feedback(*cq, feedback.release()));
+
+    vector<BSONObj> plans = getPlans(
+        planCache, cq->getQueryObj(), cq->getParsed().getSort(), cq->getParsed().getProj());
+    ASSERT_EQUALS(plans.size(), 1U);
+
+    BSONObj feedbackObj = plans[0].getObjectField("feedback");
+    ASSERT_EQUALS(feedbackObj["nfeedback"].numberInt(), 1);
+    ASSERT_EQUALS(feedbackObj["baselineCostPerResult"].numberDouble(), 3.0);
+
+    vector<BSONElement> scores = feedbackObj["scores"].Array();
+    ASSERT_EQUALS(scores.size(), 1U);
+    BSONObj scoreObj = scores[0].Obj();
+    ASSERT_EQUALS(scoreObj["score"].numberDouble(), 1.5);
+    ASSERT_EQUALS(scoreObj["nReturned"].numberLong(), 4LL);
+    ASSERT_EQUALS(scoreObj["keysExamined"].numberLong(), 10LL);
+    ASSERT_EQUALS(scoreObj["docsExamined"].numberLong(), 6LL);
+    ASSERT_EQUALS(scoreObj["executionTimeMillis"].numberLong(), 2LL);
+}
+
 }  // namespace
@@ -0,0 +1,103 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/base/init.h"
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/stats/query_shape_stats.h"
+
+namespace {
+
+using namespace mongo;
+
+/**
+ * Reports the statistics QueryShapeStats aggregated from the sampled operations.
+ *
+ * { queryShapeStats: 1, ns: <optional namespace>, reset: <optional bool> }
+ *
+ * With 'reset', the statistics of every namespace are cleared once reported.
+ */
+class QueryShapeStatsCommand : public Command {
+public:
+    QueryShapeStatsCommand() : Command("queryShapeStats") {}
+
+    virtual bool slaveOk() const {
+        return true;
+    }
+    virtual bool adminOnly() const {
+        return true;
+    }
+    virtual bool isWriteCommandForConfigServer() const {
+        return false;
+    }
+    virtual void help(std::stringstream& help) const {
+        help << "statistics of the sampled operations by query shape, in micros.\n"
+             << "{ queryShapeStats: 1, ns: <optional namespace>, reset: <optional bool> }";
+    }
+    virtual void addRequiredPrivileges(const std::string& dbname,
+                                       const BSONObj& cmdObj,
+                                       std::vector<Privilege>* out) {
+        ActionSet actions;
+        actions.addAction(ActionType::top);
+        out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+    }
+    virtual bool run(OperationContext* txn,
+                     const std::string& db,
+                     BSONObj& cmdObj,
+                     int options,
+                     std::string& errmsg,
+                     BSONObjBuilder& result) {
+        const BSONElement nsElt = cmdObj["ns"];
+        if (!nsElt.eoo() && nsElt.type() != String) {
+            return appendCommandStatus(
+                result, Status(ErrorCodes::TypeMismatch, "'ns' must be of type String"));
+        }
+
+        auto& stats = QueryShapeStats::get(txn->getClient()->getServiceContext());
+        stats.append(nsElt.eoo() ? StringData() : nsElt.valueStringData(), &result);
+        if (cmdObj["reset"].trueValue()) {
+            stats.reset();
+        }
+        return true;
+    }
+};
+
+MONGO_INITIALIZER(RegisterQueryShapeStatsCommand)(InitializerContext* context) {
+    new QueryShapeStatsCommand();
+
+    return Status::OK();
+}
+
+}  // namespace
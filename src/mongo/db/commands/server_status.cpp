@@ -47,6 +47,9 @@
 #include "mongo/platform/process_id.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/listen.h"
+#include "mongo/util/net/message_buffer_pool.h"
+#include "mongo/util/net/message_compressor.h"
+#include "mongo/util/net/message_port.h"
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/ramlog.h"
@@ -275,6 +278,23 @@ public:
     BSONObj generateSection(OperationContext* txn, const BSONElement& configElement) const {
         BSONObjBuilder b;
         networkCounter.append(b);
+
+        const auto poolStats = MessageBufferPool::getStats();
+        BSONObjBuilder pool(b.subobjStart("bufferPool"));
+        pool.appendNumber("hits", static_cast<long long>(poolStats.hits));
+        pool.appendNumber("misses", static_cast<long long>(poolStats.misses));
+        pool.appendNumber("oversized", static_cast<long long>(poolStats.oversized));
+        pool.appendNumber("cachedBytes", static_cast<long long>(poolStats.cachedBytes));
+        pool.done();
+
+        BSONObjBuilder compression(b.subobjStart("compression"));
+        appendMessageCompressionStats(&compression);
+        compression.done();
+
+        BSONObjBuilder coalescing(b.subobjStart("writeCoalescing"));
+        appendWriteCoalescingStats(&coalescing);
+        coalescing.done();
+
         return b.obj();
     }
 
@@ -56,7 +56,9 @@ public:
     virtual void help(stringstream& h) const {
         h << "Validate contents of a namespace by scanning its data structures for correctness.  "
              "Slow.\n"
-             "Add full:true option to do a more thorough check";
+             "Add full:true option to do a more thorough check.\n"
+             "Add background:true to check the documents and the index keys without blocking "
+             "writes, and maxBytesPerSec:<num> to limit the rate at which it reads";
     }
 
     virtual bool isWriteCommandForConfigServer() const {
@@ -69,7 +71,8 @@ public:
         actions.addAction(ActionType::validate);
         out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
     }
-    //{ validate: "collectionnamewithoutthedbpart" [, scandata: <bool>] [, full: <bool> } */
+    //{ validate: "collectionnamewithoutthedbpart" [, scandata: <bool>] [, full: <bool> ]
+    //  [, background: <bool> [, maxBytesPerSec: <num>]] } */
 
     bool run(OperationContext* txn,
              const string& dbname,
@@ -82,18 +85,41 @@ public:
         NamespaceString ns_string(ns);
         const bool full = cmdObj["full"].trueValue();
         const bool scanData = full || cmdObj["scandata"].trueValue();
+        const bool background = cmdObj["background"].trueValue();
 
         if (!ns_string.isNormal() && full) {
             errmsg = "Can only run full validate on a regular collection";
             return false;
         }
 
+        long long maxBytesPerSec = 0;
+        if (background) {
+            if (full) {
+                errmsg = "cannot mix background and full";
+                return false;
+            }
+            if (cmdObj.hasElement("maxBytesPerSec")) {
+                maxBytesPerSec = cmdObj["maxBytesPerSec"].numberLong();
+                if (maxBytesPerSec < 0) {
+                    errmsg = "invalid maxBytesPerSec";
+                    return false;
+                }
+            }
+        } else if (cmdObj.hasElement("maxBytesPerSec")) {
+            errmsg = "maxBytesPerSec requires background";
+            return false;
+        }
+
         if (!serverGlobalParams.quiet) {
             LOG(0) << "CMD: validate " << ns << endl;
         }
 
-        AutoGetDb ctx(txn, ns_string.db(), MODE_IX);
-        Lock::CollectionLock collLk(txn->lockState(), ns_string.ns(), MODE_X);
+        // A background validation reads all it checks from one snapshot, so it only needs to keep
+        // the collection and its indexes from being dropped.
+        const LockMode collMode = background ? MODE_IS : MODE_X;
+        ScopedTransaction transaction(txn, background ? MODE_IS : MODE_IX);
+        AutoGetDb ctx(txn, ns_string.db(), background ? MODE_IS : MODE_IX);
+        Lock::CollectionLock collLk(txn->lockState(), ns_string.ns(), collMode);
         Collection* collection = ctx.getDb() ? ctx.getDb()->getCollection(ns_string) : NULL;
         if (!collection) {
             errmsg = "ns not found";
@@ -103,14 +129,20 @@ public:
         result.append("ns", ns);
 
         ValidateResults results;
-        Status status = collection->validate(txn, full, scanData, &results, &result);
+        Status status = background
+            ? collection->validateInBackground(txn, maxBytesPerSec, &results, &result)
+            : collection->validate(txn, full, scanData, &results, &result);
         if (!status.isOK())
             return appendCommandStatus(result, status);
 
         result.appendBool("valid", results.valid);
         result.append("errors", results.errors);
 
-        if (!full) {
+        if (background) {
+            result.append("warning",
+                          "Background validation skips the storage engine's structural checks. "
+                          "use {full:true} option to do more thorough scan.");
+        } else if (!full) {
             result.append(
                 "warning",
                 "Some checks omitted for speed. use {full:true} option to do more thorough scan.");
@@ -69,6 +69,7 @@
 #include "mongo/db/s/sharded_connection_info.h"
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/stats/counters.h"
+#include "mongo/db/stats/query_shape_stats.h"
 #include "mongo/db/stats/top.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/s/shard_key_pattern.h"
@@ -223,6 +224,14 @@ bool checkShardVersion(OperationContext* txn,
 // TODO: Determine queueing behavior we want here
 MONGO_EXPORT_SERVER_PARAMETER(queueForMigrationCommit, bool, true);
 
+// Maximum number of documents of an insert batch written in one WriteUnitOfWork. Values of 1 or
+// less insert every document in its own WriteUnitOfWork.
+MONGO_EXPORT_SERVER_PARAMETER(internalInsertMaxBatchSize, int, 64);
+
+// Maximum total size of the documents written in one WriteUnitOfWork, so that a group doesn't
+// hold its locks and storage transaction for too long.
+static const int kInsertGroupMaxBytes = 256 * 1024;
+
 WriteBatchExecutor::WriteBatchExecutor(OperationContext* txn, OpCounters* opCounters, LastError* le)
     : _txn(txn), _opCounters(opCounters), _le(le), _stats(new WriteBatchStats) {}
 
@@ -547,6 +556,7 @@ static void finishCurrentOp(OperationContext* txn, WriteErrorDetail* opError) {
     currentOp->done();
     int executionTime = currentOp->debug().executionTime = currentOp->totalTimeMillis();
     recordCurOpMetrics(txn);
+    QueryShapeStats::get(txn->getClient()->getServiceContext()).sample(txn);
     Top::get(txn->getClient()->getServiceContext())
         .record(currentOp->getNS(),
                 currentOp->getOp(),
@@ -592,6 +602,8 @@ static void singleInsert(OperationContext* txn,
                          Collection* collection,
                          WriteOpResult* result);
 
+static bool groupInsert(WriteBatchExecutor::ExecInsertsState* state, size_t count);
+
 static void singleCreateIndex(OperationContext* txn,
                               const BSONObj& indexDesc,
                               WriteOpResult* result);
@@ -744,6 +756,40 @@ void WriteBatchExecutor::bulkExecute(const BatchedCommandRequest& request,
     }
 }
 
+/**
+ * Returns the document to insert for the write at 'index', which must have been normalized.
+ */
+static const BSONObj& getInsertDoc(const WriteBatchExecutor::ExecInsertsState& state,
+                                   size_t index) {
+    const StatusWith<BSONObj>& normalizedInsert(state.normalizedInserts[index]);
+    return normalizedInsert.getValue().isEmpty()
+        ? state.request->getInsertRequest()->getDocumentsAt(index)
+        : normalizedInsert.getValue();
+}
+
+/**
+ * Returns how many inserts, starting at the current one, can be tried in one WriteUnitOfWork.
+ * Only documents that were normalized successfully are grouped.
+ */
+static size_t getInsertGroupSize(const WriteBatchExecutor::ExecInsertsState& state) {
+    if (state.request->isInsertIndexRequest() || internalInsertMaxBatchSize <= 1) {
+        return 1;
+    }
+
+    const size_t maxEnd = std::min(state.normalizedInserts.size(),
+                                   state.currIndex + internalInsertMaxBatchSize);
+    size_t end = state.currIndex;
+    int groupBytes = 0;
+    while (end < maxEnd && state.normalizedInserts[end].isOK()) {
+        groupBytes += getInsertDoc(state, end).objsize();
+        if (end > state.currIndex && groupBytes > kInsertGroupMaxBytes) {
+            break;
+        }
+        end++;
+    }
+    return end - state.currIndex;
+}
+
 // Goes over the request and preprocesses normalized versions of all the inserts in the request
 static void normalizeInserts(const BatchedCommandRequest& request,
                              vector<StatusWith<BSONObj>>* normalizedInserts) {
@@ -792,11 +838,11 @@ void WriteBatchExecutor::execInserts(const BatchedCommandRequest& request,
     // Yield frequency is based on the same constants used by PlanYieldPolicy.
     ElapsedTracker elapsedTracker(internalQueryExecYieldIterations, internalQueryExecYieldPeriodMS);
 
-    for (state.currIndex = 0; state.currIndex < state.request->sizeWriteOps(); ++state.currIndex) {
-        if (state.currIndex + 1 == state.request->sizeWriteOps()) {
-            setupSynchronousCommit(_txn);
-        }
+    // Inserts before this index are done one at a time, because the group they were part of
+    // failed.
+    size_t ungroupedUntil = 0;
 
+    for (state.currIndex = 0; state.currIndex < state.request->sizeWriteOps(); ++state.currIndex) {
         if (elapsedTracker.intervalHasElapsed()) {
             // Yield between inserts.
             if (state.hasLock()) {
@@ -814,6 +860,25 @@ void WriteBatchExecutor::execInserts(const BatchedCommandRequest& request,
             elapsedTracker.resetLastTime();
         }
 
+        if (state.currIndex >= ungroupedUntil) {
+            const size_t groupSize = getInsertGroupSize(state);
+            if (groupSize > 1) {
+                if (state.currIndex + groupSize == state.request->sizeWriteOps()) {
+                    setupSynchronousCommit(_txn);
+                }
+
+                if (execInsertGroup(&state, groupSize)) {
+                    state.currIndex += groupSize - 1;
+                    continue;
+                }
+                ungroupedUntil = state.currIndex + groupSize;
+            }
+        }
+
+        if (state.currIndex + 1 == state.request->sizeWriteOps()) {
+            setupSynchronousCommit(_txn);
+        }
+
         WriteErrorDetail* error = NULL;
         execOneInsert(&state, &error);
         if (error) {
@@ -993,9 +1058,7 @@ static void insertOne(WriteBatchExecutor::ExecInsertsState* state, WriteOpResult
         return;
     }
 
-    const BSONObj& insertDoc = normalizedInsert.getValue().isEmpty()
-        ? state->request->getInsertRequest()->getDocumentsAt(state->currIndex)
-        : normalizedInsert.getValue();
+    const BSONObj& insertDoc = getInsertDoc(*state, state->currIndex);
 
     int attempt = 0;
     while (true) {
@@ -1055,6 +1118,69 @@ void WriteBatchExecutor::execOneInsert(ExecInsertsState* state, WriteErrorDetail
     }
 }
 
+bool WriteBatchExecutor::execInsertGroup(ExecInsertsState* state, size_t count) {
+    CurOp currentOp(_txn);
+    beginCurrentOp(_txn, BatchItemRef(state->request, state->currIndex));
+
+    if (!groupInsert(state, count)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        BatchItemRef currInsertItem(state->request, state->currIndex + i);
+        incOpStats(currInsertItem);
+
+        WriteOpStats stats;
+        stats.n = 1;
+        incWriteStats(currInsertItem, stats, NULL, &currentOp);
+    }
+    finishCurrentOp(_txn, NULL);
+    return true;
+}
+
+/**
+ * Perform the next 'count' inserts of the batch in one WriteUnitOfWork, with their oplog entries
+ * written together.  Requires the inserts be preprocessed.
+ *
+ * Returns false if any of the inserts fails, in which case none of them are done and the write
+ * lock is released.  Interruptions are still thrown.
+ */
+static bool groupInsert(WriteBatchExecutor::ExecInsertsState* state, size_t count) {
+    OperationContext* const txn = state->txn;
+    invariant(!txn->lockState()->inAWriteUnitOfWork());
+
+    std::vector<BSONObj> docs;
+    docs.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        docs.push_back(getInsertDoc(*state, state->currIndex + i));
+    }
+
+    bool inserted = false;
+    try {
+        // Any error here is reported again when the documents are inserted one at a time.
+        WriteOpResult lockResult;
+        if (state->lockAndCheck(&lockResult)) {
+            WriteUnitOfWork wunit(txn);
+            Status status =
+                state->getCollection()->insertDocuments(txn, docs.begin(), docs.end(), true);
+            if (status.isOK()) {
+                wunit.commit();
+                inserted = true;
+            }
+        }
+    } catch (const DBException& ex) {
+        // Includes WriteConflictExceptions, which the one at a time inserts retry.
+        if (ErrorCodes::isInterruption(ex.toStatus().code()))
+            throw;
+    }
+
+    if (!inserted) {
+        txn->recoveryUnit()->abandonSnapshot();
+        state->unlock();
+    }
+    return inserted;
+}
+
 /**
  * Perform a single insert into a collection.  Requires the insert be preprocessed and the
  * collection already has been created.
@@ -97,6 +97,14 @@ private:
      */
     void execOneInsert(ExecInsertsState* state, WriteErrorDetail** error);
 
+    /**
+     * Executes the next 'count' inserts of a batch, starting at the current one, in a single
+     * WriteUnitOfWork. Returns false, having inserted none of them, if that fails for any reason
+     * other than an interruption. The caller should then insert them one at a time to get the
+     * error of each document.
+     */
+    bool execInsertGroup(ExecInsertsState* state, size_t count);
+
     /**
      * Executes an update item (which may update many documents or upsert), and returns the
      * upserted _id on upsert or error on failure.
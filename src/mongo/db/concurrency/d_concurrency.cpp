@@ -68,7 +68,9 @@ Lock::GlobalLock::GlobalLock(Locker* locker, LockMode lockMode, unsigned timeout
 
 
 void Lock::GlobalLock::_lock(LockMode lockMode, unsigned timeoutMs) {
-    if (!_locker->isBatchWriter()) {
+    const bool lockPBWM =
+        !_locker->isBatchWriter() && _locker->shouldConflictWithSecondaryBatchApplication();
+    if (lockPBWM) {
         _pbwm.lock(MODE_IS);
     }
 
@@ -77,7 +79,7 @@ void Lock::GlobalLock::_lock(LockMode lockMode, unsigned timeoutMs) {
         _result = _locker->lockGlobalComplete(timeoutMs);
     }
 
-    if (_result != LOCK_OK && !_locker->isBatchWriter()) {
+    if (_result != LOCK_OK && lockPBWM) {
         _pbwm.unlock();
     }
 }
@@ -128,6 +128,22 @@ TEST(DConcurrency, GlobalLockX_TimeoutDueToGlobalLockX) {
     ASSERT(!globalWriteTry.isLocked());
 }
 
+TEST(DConcurrency, GlobalLockS_NoTimeoutWhenNotConflictingWithBatchApplication) {
+    DefaultLockerImpl ls;
+    Lock::ParallelBatchWriterMode pbwm(&ls);
+
+    DefaultLockerImpl lsTry;
+    {
+        ShouldNotConflictWithSecondaryBatchApplicationBlock noConflict(&lsTry);
+        ASSERT(!lsTry.shouldConflictWithSecondaryBatchApplication());
+
+        Lock::GlobalLock globalReadTry(&lsTry, MODE_IS, 1);
+        ASSERT(globalReadTry.isLocked());
+        ASSERT_EQUALS(MODE_NONE, lsTry.getLockMode(resourceIdParallelBatchWriterMode));
+    }
+    ASSERT(lsTry.shouldConflictWithSecondaryBatchApplication());
+}
+
 TEST(DConcurrency, TempReleaseGlobalWrite) {
     MMAPV1LockerImpl ls;
     Lock::GlobalWrite globalWrite(&ls);
@@ -0,0 +1,93 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+
+#include "mongo/db/concurrency/lock_manager.h"
+#include "mongo/db/concurrency/lock_manager_test_help.h"
+#include "mongo/db/concurrency/lock_state.h"
+#include "mongo/unittest/benchmark.h"
+
+namespace {
+
+using namespace mongo;
+using unittest::BenchmarkState;
+
+/**
+ * A lock manager with a locker which acquires a collection lock.
+ */
+class LockManagerFixture : public unittest::BenchmarkFixture {
+protected:
+    LockManager lockMgr;
+    const ResourceId resId{RESOURCE_COLLECTION, std::string("TestDB.collection")};
+
+    DefaultLockerImpl locker;
+    TrackingLockGrantNotification notify;
+    LockRequest request;
+};
+
+MONGO_BENCHMARK_F(LockManagerFixture, LockUnlock) {
+    while (state.keepRunning()) {
+        // Like the Locker, which initializes the request of each new acquisition.
+        request.initNew(&locker, &notify);
+        invariant(LOCK_OK == lockMgr.lock(resId, &request, MODE_IX));
+        lockMgr.unlock(&request);
+    }
+}
+
+MONGO_BENCHMARK_F(LockManagerFixture, LockUnlockCompatibleHolder) {
+    // The request is granted with the resource already held in a compatible mode.
+    DefaultLockerImpl otherLocker;
+    TrackingLockGrantNotification otherNotify;
+    LockRequest otherRequest;
+    otherRequest.initNew(&otherLocker, &otherNotify);
+    invariant(LOCK_OK == lockMgr.lock(resId, &otherRequest, MODE_IS));
+
+    while (state.keepRunning()) {
+        request.initNew(&locker, &notify);
+        invariant(LOCK_OK == lockMgr.lock(resId, &request, MODE_IX));
+        lockMgr.unlock(&request);
+    }
+
+    lockMgr.unlock(&otherRequest);
+}
+
+MONGO_BENCHMARK_F(LockManagerFixture, LockerGlobalAndCollection) {
+    // The path of a read: the global, database and collection locks through a Locker.
+    const ResourceId dbId(RESOURCE_DATABASE, std::string("TestDB"));
+    while (state.keepRunning()) {
+        invariant(LOCK_OK == locker.lockGlobal(MODE_IS));
+        invariant(LOCK_OK == locker.lock(dbId, MODE_IS));
+        invariant(LOCK_OK == locker.lock(resId, MODE_IS));
+        locker.unlockAll();
+    }
+}
+
+}  // namespace
@@ -67,6 +67,10 @@ public:
         _get(id).recordWaitTime(resId, mode, waitMicros);
     }
 
+    void recordWaitEnd(LockerId id, ResourceId resId, LockMode mode, uint64_t waitMicros) {
+        _get(id).recordWaitEnd(resId, mode, waitMicros);
+    }
+
     void recordDeadlock(ResourceId resId, LockMode mode) {
         _get(resId).recordDeadlock(resId, mode);
     }
@@ -124,6 +128,9 @@ AtomicUInt64 idCounter(0);
 // Partitioned global lock statistics, so we don't hit the same bucket
 PartitionedInstanceWideLockStats globalStats;
 
+// Lock wait statistics per resource
+LockContentionTable globalContention;
+
 
 /**
  * Whether the particular lock's release should be held until the end of the operation. We
@@ -253,7 +260,8 @@ LockerImpl<IsForMMAPV1>::LockerImpl()
     : _id(idCounter.addAndFetch(1)),
       _requestStartTime(0),
       _wuowNestingLevel(0),
-      _batchWriter(false) {}
+      _batchWriter(false),
+      _shouldConflictWithSecondaryBatchApplication(true) {}
 
 template <bool IsForMMAPV1>
 LockerImpl<IsForMMAPV1>::~LockerImpl() {
@@ -672,6 +680,7 @@ LockResult LockerImpl<IsForMMAPV1>::lockComplete(ResourceId resId,
     }
 
     LockResult result;
+    uint64_t elapsedTimeMicros = 0;
 
     // Don't go sleeping without bound in order to be able to report long waits or wake up for
     // deadlock detection.
@@ -682,7 +691,7 @@ LockResult LockerImpl<IsForMMAPV1>::lockComplete(ResourceId resId,
         result = _notify.wait(waitTimeMs);
 
         // Account for the time spent waiting on the notification object
-        const uint64_t elapsedTimeMicros = curTimeMicros64() - _requestStartTime;
+        elapsedTimeMicros = curTimeMicros64() - _requestStartTime;
         globalStats.recordWaitTime(_id, resId, mode, elapsedTimeMicros);
         _stats.recordWaitTime(resId, mode, elapsedTimeMicros);
 
@@ -695,6 +704,7 @@ LockResult LockerImpl<IsForMMAPV1>::lockComplete(ResourceId resId,
                 warning() << "Deadlock found: " << wfg.toString();
 
                 globalStats.recordDeadlock(resId, mode);
+                globalContention.recordDeadlock(resId, mode);
                 _stats.recordDeadlock(resId, mode);
 
                 result = LOCK_DEADLOCK;
@@ -717,6 +727,10 @@ LockResult LockerImpl<IsForMMAPV1>::lockComplete(ResourceId resId,
         }
     }
 
+    globalStats.recordWaitEnd(_id, resId, mode, elapsedTimeMicros);
+    globalContention.recordWaitEnd(resId, mode, elapsedTimeMicros);
+    _stats.recordWaitEnd(resId, mode, elapsedTimeMicros);
+
     // Cleanup the state, since this is an unused lock now
     if (result != LOCK_OK) {
         LockRequestsMap::Iterator it = _requests.find(resId);
@@ -896,8 +910,13 @@ void reportGlobalLockingStats(SingleThreadedLockStats* outStats) {
     globalStats.report(outStats);
 }
 
+LockContentionTable& getGlobalLockContentionTable() {
+    return globalContention;
+}
+
 void resetGlobalLockStats() {
     globalStats.reset();
+    globalContention.reset();
 }
 
 
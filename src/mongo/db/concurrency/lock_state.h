@@ -248,10 +248,18 @@ public:
         return _batchWriter;
     }
 
+    virtual void setShouldConflictWithSecondaryBatchApplication(bool newValue) {
+        _shouldConflictWithSecondaryBatchApplication = newValue;
+    }
+    virtual bool shouldConflictWithSecondaryBatchApplication() const {
+        return _shouldConflictWithSecondaryBatchApplication;
+    }
+
     virtual bool hasStrongLocks() const;
 
 private:
     bool _batchWriter;
+    bool _shouldConflictWithSecondaryBatchApplication;
 };
 
 typedef LockerImpl<false> DefaultLockerImpl;
@@ -30,10 +30,18 @@
 
 #include "mongo/db/concurrency/lock_stats.h"
 
+#include <algorithm>
+
 #include "mongo/bson/bsonobjbuilder.h"
 
 namespace mongo {
 
+const char* lockWaitHistogramBucketName(int bucket) {
+    static const char* const bucketNames[kLockWaitHistogramBuckets] = {
+        "lt100us", "lt1ms", "lt10ms", "lt100ms", "lt1s", "lt10s", "ge10s"};
+    return bucketNames[bucket];
+}
+
 template <typename CounterType>
 LockStats<CounterType>::LockStats() {
     reset();
@@ -114,6 +122,34 @@ void LockStats<CounterType>::_report(BSONObjBuilder* builder,
         }
     }
 
+    // Histogram of wait times
+    {
+        std::unique_ptr<BSONObjBuilder> histogram;
+        for (int mode = 1; mode < LockModesCount; mode++) {
+            std::unique_ptr<BSONObjBuilder> modeHistogram;
+            for (int i = 0; i < kLockWaitHistogramBuckets; i++) {
+                const long long value = CounterOps::get(stat.modeStats[mode].waitTimeHistogram[i]);
+                if (value > 0) {
+                    if (!modeHistogram) {
+                        if (!histogram) {
+                            if (!section) {
+                                section.reset(
+                                    new BSONObjBuilder(builder->subobjStart(sectionName)));
+                            }
+
+                            histogram.reset(new BSONObjBuilder(
+                                section->subobjStart("acquireWaitTimeHistogram")));
+                        }
+
+                        modeHistogram.reset(new BSONObjBuilder(
+                            histogram->subobjStart(legacyModeName(static_cast<LockMode>(mode)))));
+                    }
+                    modeHistogram->append(lockWaitHistogramBucketName(i), value);
+                }
+            }
+        }
+    }
+
     // Deadlocks
     {
         std::unique_ptr<BSONObjBuilder> deadlockCount;
@@ -147,6 +183,129 @@ void LockStats<CounterType>::reset() {
 }
 
 
+//
+// LockContentionTable
+//
+
+namespace {
+
+// Number of slots, starting with the one the resource hashes to, which a resource may claim
+const size_t kMaxProbes = 16;
+
+// Rebuilds the ResourceId with the given full hash. Building a ResourceId masks off the type bits
+// of the hash id, so only the matching type reproduces the full hash.
+ResourceId resourceIdFromFullHash(uint64_t fullHash) {
+    for (int type = 0; type < ResourceTypesCount; type++) {
+        const ResourceId resId(static_cast<ResourceType>(type), fullHash);
+        if (static_cast<uint64_t>(resId) == fullHash) {
+            return resId;
+        }
+    }
+    return ResourceId();
+}
+
+}  // namespace
+
+const size_t LockContentionTable::kNumSlots;
+
+int64_t LockContentionTable::ResourceStats::combinedWaitTimeMicros() const {
+    int64_t total = 0;
+    for (int mode = 1; mode < LockModesCount; mode++) {
+        total += modeStats[mode].combinedWaitTimeMicros;
+    }
+    return total;
+}
+
+LockContentionTable::LockContentionTable() {
+    reset();
+}
+
+void LockContentionTable::recordWaitEnd(ResourceId resId, LockMode mode, uint64_t waitMicros) {
+    Slot* slot = _findOrInsert(resId);
+    if (!slot) {
+        _numUntrackedWaits.addAndFetch(1);
+        return;
+    }
+
+    LockStatCounters<AtomicInt64>& stats = slot->modeStats[mode];
+    stats.numWaits.addAndFetch(1);
+    stats.combinedWaitTimeMicros.addAndFetch(waitMicros);
+    stats.waitTimeHistogram[lockWaitHistogramBucket(waitMicros)].addAndFetch(1);
+}
+
+void LockContentionTable::recordDeadlock(ResourceId resId, LockMode mode) {
+    Slot* slot = _findOrInsert(resId);
+    if (slot) {
+        slot->modeStats[mode].numDeadlocks.addAndFetch(1);
+    }
+}
+
+std::vector<LockContentionTable::ResourceStats> LockContentionTable::getMostContended(
+    size_t limit) const {
+    std::vector<ResourceStats> all;
+    for (size_t i = 0; i < kNumSlots; i++) {
+        const Slot& slot = _slots[i];
+        const uint64_t fullHash = slot.resId.load();
+        if (fullHash == 0) {
+            continue;
+        }
+
+        ResourceStats stats;
+        stats.resId = resourceIdFromFullHash(fullHash);
+        bool hasWaits = false;
+        for (int mode = 0; mode < LockModesCount; mode++) {
+            stats.modeStats[mode].reset();
+            stats.modeStats[mode].append(slot.modeStats[mode]);
+            hasWaits = hasWaits || stats.modeStats[mode].numWaits > 0;
+        }
+
+        if (hasWaits) {
+            all.push_back(stats);
+        }
+    }
+
+    std::sort(all.begin(),
+              all.end(),
+              [](const ResourceStats& lhs, const ResourceStats& rhs) {
+                  return lhs.combinedWaitTimeMicros() > rhs.combinedWaitTimeMicros();
+              });
+
+    if (all.size() > limit) {
+        all.resize(limit);
+    }
+    return all;
+}
+
+void LockContentionTable::reset() {
+    for (size_t i = 0; i < kNumSlots; i++) {
+        for (int mode = 0; mode < LockModesCount; mode++) {
+            _slots[i].modeStats[mode].reset();
+        }
+    }
+    _numUntrackedWaits.store(0);
+}
+
+LockContentionTable::Slot* LockContentionTable::_findOrInsert(ResourceId resId) {
+    const uint64_t fullHash = resId;
+    for (size_t probe = 0; probe < kMaxProbes; probe++) {
+        Slot& slot = _slots[(fullHash + probe) % kNumSlots];
+        uint64_t current = slot.resId.load();
+        if (current == 0) {
+            current = slot.resId.compareAndSwap(0, fullHash);
+            if (current == 0) {
+                return &slot;
+            }
+        }
+
+        if (current == fullHash) {
+            return &slot;
+        }
+    }
+
+    return NULL;
+}
+
+
 // Ensures that there are instances compiled for LockStats for AtomicInt64 and int64_t
 template class LockStats<int64_t>;
 template class LockStats<AtomicInt64>;
@@ -28,6 +28,9 @@
 
 #pragma once
 
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
 #include "mongo/db/concurrency/lock_manager_defs.h"
 #include "mongo/platform/atomic_word.h"
 
@@ -70,6 +73,32 @@ struct CounterOps {
 };
 
 
+/**
+ * Lock waits are bucketed by their total duration into a histogram with these upper bounds, the
+ * last bucket holding all the waits longer than the largest bound.
+ */
+const int kLockWaitHistogramBuckets = 7;
+const uint64_t kLockWaitHistogramBoundsMicros[kLockWaitHistogramBuckets - 1] = {
+    100, 1000, 10 * 1000, 100 * 1000, 1000 * 1000, 10 * 1000 * 1000};
+
+/**
+ * Returns the index of the histogram bucket for a lock wait of the given duration.
+ */
+inline int lockWaitHistogramBucket(uint64_t waitMicros) {
+    int bucket = 0;
+    while (bucket < kLockWaitHistogramBuckets - 1 &&
+           waitMicros >= kLockWaitHistogramBoundsMicros[bucket]) {
+        bucket++;
+    }
+    return bucket;
+}
+
+/**
+ * Returns the name under which the given histogram bucket is reported.
+ */
+const char* lockWaitHistogramBucketName(int bucket);
+
+
 /**
  * Bundle of locking statistics values.
  */
@@ -81,6 +110,9 @@ struct LockStatCounters {
         CounterOps::add(numWaits, other.numWaits);
         CounterOps::add(combinedWaitTimeMicros, other.combinedWaitTimeMicros);
         CounterOps::add(numDeadlocks, other.numDeadlocks);
+        for (int i = 0; i < kLockWaitHistogramBuckets; i++) {
+            CounterOps::add(waitTimeHistogram[i], other.waitTimeHistogram[i]);
+        }
     }
 
     void reset() {
@@ -88,6 +120,9 @@ struct LockStatCounters {
         CounterOps::set(numWaits, 0);
         CounterOps::set(combinedWaitTimeMicros, 0);
         CounterOps::set(numDeadlocks, 0);
+        for (int i = 0; i < kLockWaitHistogramBuckets; i++) {
+            CounterOps::set(waitTimeHistogram[i], 0);
+        }
     }
 
 
@@ -95,6 +130,9 @@ struct LockStatCounters {
     CounterType numWaits;
     CounterType combinedWaitTimeMicros;
     CounterType numDeadlocks;
+
+    // Number of completed waits, whether granted or not, per bucket of total wait time
+    CounterType waitTimeHistogram[kLockWaitHistogramBuckets];
 };
 
 
@@ -125,6 +163,14 @@ public:
         CounterOps::add(get(resId, mode).combinedWaitTimeMicros, waitMicros);
     }
 
+    /**
+     * Records the total duration of a wait, once it has ended, in the wait time histogram.
+     */
+    void recordWaitEnd(ResourceId resId, LockMode mode, uint64_t waitMicros) {
+        CounterOps::add(get(resId, mode).waitTimeHistogram[lockWaitHistogramBucket(waitMicros)],
+                        1);
+    }
+
     void recordDeadlock(ResourceId resId, LockMode mode) {
         CounterOps::add(get(resId, mode).numDeadlocks, 1);
     }
@@ -190,11 +236,84 @@ typedef LockStats<int64_t> SingleThreadedLockStats;
 typedef LockStats<AtomicInt64> AtomicLockStats;
 
 
+/**
+ * Fixed-size table of lock wait statistics per individual resource, as opposed to per resource
+ * type as in LockStats, used to find the most contended databases and collections. Only waits
+ * are recorded, so lock acquisitions which are granted immediately never touch the table. It is
+ * thread-safe and does not allocate or take any mutexes.
+ *
+ * Resources claim a slot on their first wait and keep it until the process exits. The waits of
+ * resources, which find no free slot are only counted in total.
+ */
+class LockContentionTable {
+    MONGO_DISALLOW_COPYING(LockContentionTable);
+
+public:
+    typedef LockStatCounters<int64_t> CountersType;
+
+    /**
+     * Wait statistics of a single resource. The numAcquisitions counters are always zero.
+     */
+    struct ResourceStats {
+        ResourceId resId;
+        CountersType modeStats[LockModesCount];
+
+        int64_t combinedWaitTimeMicros() const;
+    };
+
+    static const size_t kNumSlots = 512;
+
+    LockContentionTable();
+
+    /**
+     * Records the end of a wait for the given resource, which lasted 'waitMicros' in total.
+     */
+    void recordWaitEnd(ResourceId resId, LockMode mode, uint64_t waitMicros);
+
+    void recordDeadlock(ResourceId resId, LockMode mode);
+
+    /**
+     * Returns the statistics of at most 'limit' resources in descending order of their combined
+     * wait time across all modes. Resources without any waits since the last reset are skipped.
+     */
+    std::vector<ResourceStats> getMostContended(size_t limit) const;
+
+    /**
+     * Returns how many waits were not recorded per resource, because the table was full.
+     */
+    int64_t getNumUntrackedWaits() const {
+        return _numUntrackedWaits.load();
+    }
+
+    /**
+     * Zeroes all counters. Resources keep their slots.
+     */
+    void reset();
+
+private:
+    struct Slot {
+        AtomicUInt64 resId;
+        LockStatCounters<AtomicInt64> modeStats[LockModesCount];
+    };
+
+    // Returns NULL if the resource has no slot and all of the slots it may use are taken
+    Slot* _findOrInsert(ResourceId resId);
+
+    Slot _slots[kNumSlots];
+    AtomicInt64 _numUntrackedWaits;
+};
+
+
 /**
  * Reports instance-wide locking statistics, which can then be converted to BSON or logged.
  */
 void reportGlobalLockingStats(SingleThreadedLockStats* outStats);
 
+/**
+ * Returns the instance-wide table of lock wait statistics per resource.
+ */
+LockContentionTable& getGlobalLockContentionTable();
+
 /**
  * Currently used for testing only.
  */
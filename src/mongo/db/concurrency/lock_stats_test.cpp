@@ -28,6 +28,10 @@
 
 #include "mongo/platform/basic.h"
 
+#include <limits>
+#include <memory>
+#include <vector>
+
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/concurrency/lock_manager_test_help.h"
 #include "mongo/unittest/unittest.h"
@@ -80,6 +84,95 @@ TEST(LockStats, Wait) {
     ASSERT_EQUALS(1, stats.get(resId, MODE_S).numAcquisitions);
     ASSERT_EQUALS(1, stats.get(resId, MODE_S).numWaits);
     ASSERT_GREATER_THAN(stats.get(resId, MODE_S).combinedWaitTimeMicros, 0);
+
+    // The wait of at least 1 millisecond ends up in exactly one histogram bucket past the first
+    int64_t numHistogramWaits = 0;
+    for (int i = 0; i < kLockWaitHistogramBuckets; i++) {
+        numHistogramWaits += stats.get(resId, MODE_S).waitTimeHistogram[i];
+        ASSERT_EQUALS(0, stats.get(resId, MODE_X).waitTimeHistogram[i]);
+    }
+    ASSERT_EQUALS(1, numHistogramWaits);
+    ASSERT_EQUALS(0, stats.get(resId, MODE_S).waitTimeHistogram[0]);
+}
+
+TEST(LockStats, WaitHistogramBuckets) {
+    ASSERT_EQUALS(0, lockWaitHistogramBucket(0));
+    ASSERT_EQUALS(0, lockWaitHistogramBucket(99));
+    ASSERT_EQUALS(1, lockWaitHistogramBucket(100));
+    ASSERT_EQUALS(2, lockWaitHistogramBucket(1000));
+    ASSERT_EQUALS(5, lockWaitHistogramBucket(9999999));
+    ASSERT_EQUALS(6, lockWaitHistogramBucket(10 * 1000 * 1000));
+    ASSERT_EQUALS(6, lockWaitHistogramBucket(std::numeric_limits<uint64_t>::max()));
+}
+
+TEST(LockStats, ContentionTableOrdersByWaitTime) {
+    const ResourceId resIdA(RESOURCE_COLLECTION, std::string("LockStats.ContentionA"));
+    const ResourceId resIdB(RESOURCE_COLLECTION, std::string("LockStats.ContentionB"));
+    const ResourceId resIdC(RESOURCE_DATABASE, std::string("LockStats"));
+
+    std::unique_ptr<LockContentionTable> table(new LockContentionTable());
+    table->recordWaitEnd(resIdA, MODE_X, 50);
+    table->recordWaitEnd(resIdB, MODE_IX, 1000);
+    table->recordWaitEnd(resIdB, MODE_S, 3000);
+    table->recordWaitEnd(resIdC, MODE_IS, 2000);
+    table->recordDeadlock(resIdB, MODE_S);
+
+    std::vector<LockContentionTable::ResourceStats> stats = table->getMostContended(2);
+    ASSERT_EQUALS(2U, stats.size());
+    ASSERT_EQUALS(resIdB, stats[0].resId);
+    ASSERT_EQUALS(4000, stats[0].combinedWaitTimeMicros());
+    ASSERT_EQUALS(1, stats[0].modeStats[MODE_IX].numWaits);
+    ASSERT_EQUALS(1, stats[0].modeStats[MODE_S].numWaits);
+    ASSERT_EQUALS(1, stats[0].modeStats[MODE_S].numDeadlocks);
+    ASSERT_EQUALS(1, stats[0].modeStats[MODE_S].waitTimeHistogram[2]);
+    ASSERT_EQUALS(0, stats[0].modeStats[MODE_X].numWaits);
+    ASSERT_EQUALS(resIdC, stats[1].resId);
+    ASSERT_EQUALS(RESOURCE_DATABASE, stats[1].resId.getType());
+
+    ASSERT_EQUALS(3U, table->getMostContended(10).size());
+    ASSERT_EQUALS(0, table->getNumUntrackedWaits());
+
+    // A reset keeps the slots, but resources without waits are not returned.
+    table->reset();
+    ASSERT_EQUALS(0U, table->getMostContended(10).size());
+    table->recordWaitEnd(resIdA, MODE_X, 10);
+    stats = table->getMostContended(10);
+    ASSERT_EQUALS(1U, stats.size());
+    ASSERT_EQUALS(resIdA, stats[0].resId);
+}
+
+TEST(LockStats, ContentionTableFull) {
+    std::unique_ptr<LockContentionTable> table(new LockContentionTable());
+    const int numResources = 2 * LockContentionTable::kNumSlots;
+    for (int i = 0; i < numResources; i++) {
+        table->recordWaitEnd(ResourceId(RESOURCE_COLLECTION, i), MODE_IX, 1);
+    }
+
+    const size_t numTracked = table->getMostContended(numResources).size();
+    ASSERT_LESS_THAN_OR_EQUALS(numTracked, LockContentionTable::kNumSlots);
+    ASSERT_EQUALS(numResources, static_cast<int64_t>(numTracked) + table->getNumUntrackedWaits());
+}
+
+TEST(LockStats, ContentionOfWait) {
+    const ResourceId resId(RESOURCE_COLLECTION, std::string("LockStats.ContentionOfWait"));
+
+    resetGlobalLockStats();
+
+    LockerForTests locker(MODE_IX);
+    locker.lock(resId, MODE_X);
+
+    {
+        LockerForTests lockerConflict(MODE_IX);
+        ASSERT_EQUALS(LOCK_WAITING, lockerConflict.lockBegin(resId, MODE_S));
+        ASSERT_EQUALS(LOCK_TIMEOUT, lockerConflict.lockComplete(resId, MODE_S, 1, false));
+    }
+
+    std::vector<LockContentionTable::ResourceStats> stats =
+        getGlobalLockContentionTable().getMostContended(1);
+    ASSERT_EQUALS(1U, stats.size());
+    ASSERT_EQUALS(resId, stats[0].resId);
+    ASSERT_EQUALS(1, stats[0].modeStats[MODE_S].numWaits);
+    ASSERT_GREATER_THAN(stats[0].modeStats[MODE_S].combinedWaitTimeMicros, 0);
 }
 
 TEST(LockStats, Reporting) {
@@ -284,6 +284,14 @@ public:
     virtual void setIsBatchWriter(bool newValue) = 0;
     virtual bool isBatchWriter() const = 0;
 
+    /**
+     * Readers that never observe a partially applied oplog batch, because they read from a
+     * snapshot taken between batches, turn this off so that taking the global lock does not
+     * also take the parallel batch writer lock and wait for the current batch. On by default.
+     */
+    virtual void setShouldConflictWithSecondaryBatchApplication(bool newValue) = 0;
+    virtual bool shouldConflictWithSecondaryBatchApplication() const = 0;
+
     /**
      * A string lock is MODE_X or MODE_S.
      * These are incompatible with other locks and therefore are strong.
@@ -294,4 +302,27 @@ protected:
     Locker() {}
 };
 
+/**
+ * Turns off conflicting with secondary oplog batch application for the lifetime of the object,
+ * restoring the previous setting on destruction.
+ */
+class ShouldNotConflictWithSecondaryBatchApplicationBlock {
+    MONGO_DISALLOW_COPYING(ShouldNotConflictWithSecondaryBatchApplicationBlock);
+
+public:
+    explicit ShouldNotConflictWithSecondaryBatchApplicationBlock(Locker* lockState)
+        : _lockState(lockState),
+          _originalShouldConflict(_lockState->shouldConflictWithSecondaryBatchApplication()) {
+        _lockState->setShouldConflictWithSecondaryBatchApplication(false);
+    }
+
+    ~ShouldNotConflictWithSecondaryBatchApplicationBlock() {
+        _lockState->setShouldConflictWithSecondaryBatchApplication(_originalShouldConflict);
+    }
+
+private:
+    Locker* const _lockState;
+    const bool _originalShouldConflict;
+};
+
 }  // namespace mongo
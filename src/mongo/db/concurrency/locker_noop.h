@@ -164,6 +164,14 @@ public:
         invariant(false);
     }
 
+    virtual void setShouldConflictWithSecondaryBatchApplication(bool newValue) {
+        invariant(false);
+    }
+
+    virtual bool shouldConflictWithSecondaryBatchApplication() const {
+        invariant(false);
+    }
+
     virtual bool hasStrongLocks() const {
         return false;
     }
@@ -40,6 +40,10 @@ namespace mongo {
 
 int ConnPoolOptions::maxConnsPerHost(200);
 int ConnPoolOptions::maxShardedConnsPerHost(200);
+int ConnPoolOptions::maxInUseConnsPerHost(PoolForHost::kPoolSizeUnlimited);
+int ConnPoolOptions::maxShardedInUseConnsPerHost(PoolForHost::kPoolSizeUnlimited);
+int ConnPoolOptions::maxWaitTimeMillis(20000);
+int ConnPoolOptions::maxIdleTimeSecs(0);
 
 namespace {
 
@@ -57,6 +61,34 @@ ExportedServerParameter<int>  //
                                     true,
                                     false /* can't change at runtime */);
 
+ExportedServerParameter<int>  //
+    maxInUseConnsPerHostParameter(ServerParameterSet::getGlobal(),
+                                  "connPoolMaxInUseConnsPerHost",
+                                  &ConnPoolOptions::maxInUseConnsPerHost,
+                                  true,
+                                  false /* can't change at runtime */);
+
+ExportedServerParameter<int>  //
+    maxShardedInUseConnsPerHostParameter(ServerParameterSet::getGlobal(),
+                                         "connPoolMaxShardedInUseConnsPerHost",
+                                         &ConnPoolOptions::maxShardedInUseConnsPerHost,
+                                         true,
+                                         false /* can't change at runtime */);
+
+ExportedServerParameter<int>  //
+    maxWaitTimeMillisParameter(ServerParameterSet::getGlobal(),
+                               "connPoolMaxWaitTimeMillis",
+                               &ConnPoolOptions::maxWaitTimeMillis,
+                               true,
+                               false /* can't change at runtime */);
+
+ExportedServerParameter<int>  //
+    maxIdleTimeSecsParameter(ServerParameterSet::getGlobal(),
+                             "connPoolMaxIdleTimeSecs",
+                             &ConnPoolOptions::maxIdleTimeSecs,
+                             true,
+                             false /* can't change at runtime */);
+
 MONGO_INITIALIZER(InitializeConnectionPools)(InitializerContext* context) {
     // Initialize the sharded and unsharded outgoing connection pools
     // NOTES:
@@ -66,9 +98,15 @@ MONGO_INITIALIZER(InitializeConnectionPools)(InitializerContext* context) {
 
     globalConnPool.setName("connection pool");
     globalConnPool.setMaxPoolSize(ConnPoolOptions::maxConnsPerHost);
+    globalConnPool.setMaxInUse(ConnPoolOptions::maxInUseConnsPerHost);
+    globalConnPool.setMaxWaitTime(Milliseconds(ConnPoolOptions::maxWaitTimeMillis));
+    globalConnPool.setMaxIdleTime(Seconds(ConnPoolOptions::maxIdleTimeSecs));
 
     shardConnectionPool.setName("sharded connection pool");
     shardConnectionPool.setMaxPoolSize(ConnPoolOptions::maxShardedConnsPerHost);
+    shardConnectionPool.setMaxInUse(ConnPoolOptions::maxShardedInUseConnsPerHost);
+    shardConnectionPool.setMaxWaitTime(Milliseconds(ConnPoolOptions::maxWaitTimeMillis));
+    shardConnectionPool.setMaxIdleTime(Seconds(ConnPoolOptions::maxIdleTimeSecs));
 
     return Status::OK();
 }
@@ -48,5 +48,23 @@ struct ConnPoolOptions {
      * Maximum connections per host the sharded conn pool should use
      */
     static int maxShardedConnsPerHost;
+
+    /**
+     * Maximum connections per host which may be checked out of either conn pool at once, or -1
+     * for no limit
+     */
+    static int maxInUseConnsPerHost;
+    static int maxShardedInUseConnsPerHost;
+
+    /**
+     * How long to wait for a connection to a host which has reached its max in use connections
+     */
+    static int maxWaitTimeMillis;
+
+    /**
+     * How long an unused connection is kept in either conn pool, or 0 to keep it until it is
+     * found to be disconnected
+     */
+    static int maxIdleTimeSecs;
 };
 }
@@ -272,6 +272,10 @@ void CurOp::reportState(BSONObjBuilder* builder) {
     }
 
     builder->append("numYields", _numYields);
+
+    if (debug().networkReceiveMicros >= 0) {
+        builder->append("networkReceiveMicros", debug().networkReceiveMicros);
+    }
 }
 
 void CurOp::setMaxTimeMicros(uint64_t maxTimeMicros) {
@@ -407,10 +411,16 @@ void OpDebug::reset() {
     keyUpdates = 0;  // unsigned, so -1 not possible
     writeConflicts = 0;
     planSummary = "";
+    queryShape.clear();
     execStats.reset();
 
     exceptionInfo.reset();
 
+    networkReceiveMicros = -1;
+    cpuMicros = -1;
+
+    storageStats = BSONObj();
+
     executionTime = 0;
     nreturned = -1;
     responseLength = -1;
@@ -499,6 +509,13 @@ string OpDebug::report(const CurOp& curop, const SingleThreadedLockStats& lockSt
 
     s << " numYields:" << curop.numYields();
 
+    OPDEBUG_TOSTRING_HELP(networkReceiveMicros);
+    OPDEBUG_TOSTRING_HELP(cpuMicros);
+
+    if (!storageStats.isEmpty()) {
+        s << " storage:" << storageStats.toString();
+    }
+
     OPDEBUG_TOSTRING_HELP(nreturned);
     if (responseLength > 0) {
         s << " reslen:" << responseLength;
@@ -689,6 +706,12 @@ void OpDebug::append(const CurOp& curop,
     OPDEBUG_APPEND_NUMBER(keyUpdates);
     OPDEBUG_APPEND_NUMBER(writeConflicts);
     b.appendNumber("numYield", curop.numYields());
+    OPDEBUG_APPEND_NUMBER(networkReceiveMicros);
+    OPDEBUG_APPEND_NUMBER(cpuMicros);
+
+    if (!storageStats.isEmpty()) {
+        b.append("storage", storageStats);
+    }
 
     {
         BSONObjBuilder locks(b.subobjStart("locks"));
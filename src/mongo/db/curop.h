@@ -177,6 +177,7 @@ public:
     int keyUpdates;
     long long writeConflicts;
     ThreadSafeString planSummary;  // a brief std::string describing the query solution
+    std::string queryShape;        // plan cache key of the first query planned by the operation
 
     // New Query Framework debugging/profiling info
     // TODO: should this really be an opaque BSONObj?  Not sure.
@@ -185,6 +186,15 @@ public:
     // error handling
     ExceptionInfo exceptionInfo;
 
+    // network info
+    long long networkReceiveMicros;  // time spent reading the request after its header arrived
+
+    // CPU time of the thread which ran the request, see curThreadCpuTimeMicros()
+    long long cpuMicros;
+
+    // storage engine info, see RecoveryUnit::appendOperationStats()
+    BSONObj storageStats;
+
     // response info
     int executionTime;
     long long nreturned;
@@ -29,7 +29,10 @@
 #include "mongo/base/counter.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/stats/latency_histogram.h"
+#include "mongo/util/net/message.h"
 
 namespace mongo {
 namespace {
@@ -60,10 +63,77 @@ ServerStatusMetricField<Counter64> displayFastMod("operation.fastmod", &fastmodC
 ServerStatusMetricField<Counter64> displayWriteConflicts("operation.writeConflicts",
                                                          &writeConflictsCounter);
 
+StripedLatencyHistogram readLatencies;
+StripedLatencyHistogram writeLatencies;
+StripedLatencyHistogram commandLatencies;
+
+/**
+ * Server status section for the latencies of all operations, by kind.
+ *
+ * Sample format:
+ *
+ * opLatencies: {
+ *   reads: {ops: 1024, latency: 96256, p50: 47, p95: 255, p99: 1279},
+ *   writes: {...},
+ *   commands: {...}
+ * }
+ *
+ * With {opLatencies: {histograms: true}}, each kind also has a 'histogram' array of the non-empty
+ * buckets, as {micros: <lower bound>, count: <operations>}. With
+ * {opLatencies: {denseHistograms: true}}, each kind has a 'buckets' array of the counts of all the
+ * buckets instead, as FTDC collects it.
+ */
+class OpLatenciesServerStatusSection : public ServerStatusSection {
+public:
+    OpLatenciesServerStatusSection() : ServerStatusSection("opLatencies") {}
+
+    bool includeByDefault() const final {
+        return true;
+    }
+
+    BSONObj generateSection(OperationContext* txn, const BSONElement& configElement) const final {
+        const bool isObject = configElement.type() == Object;
+        const bool includeHistograms = isObject && configElement.Obj()["histograms"].trueValue();
+        const bool denseHistograms = isObject && configElement.Obj()["denseHistograms"].trueValue();
+
+        BSONObjBuilder result;
+        append(&result, "reads", readLatencies, includeHistograms, denseHistograms);
+        append(&result, "writes", writeLatencies, includeHistograms, denseHistograms);
+        append(&result, "commands", commandLatencies, includeHistograms, denseHistograms);
+        return result.obj();
+    }
+
+private:
+    static void append(BSONObjBuilder* result,
+                       StringData name,
+                       const StripedLatencyHistogram& latencies,
+                       bool includeHistograms,
+                       bool denseHistograms) {
+        BSONObjBuilder builder(result->subobjStart(name));
+        const LatencyHistogram histogram = latencies.get();
+        histogram.append(&builder, includeHistograms && !denseHistograms);
+        if (denseHistograms) {
+            histogram.appendDenseBuckets(&builder);
+        }
+        builder.done();
+    }
+} opLatenciesServerStatusSection;
+
 }  // namespace
 
 void recordCurOpMetrics(OperationContext* opCtx) {
-    const OpDebug& debug = CurOp::get(opCtx)->debug();
+    CurOp* curOp = CurOp::get(opCtx);
+    const long long micros = curOp->totalTimeMicros();
+    if (curOp->isCommand() || curOp->getOp() == dbCommand) {
+        commandLatencies.increment(micros);
+    } else if (curOp->getOp() == dbQuery || curOp->getOp() == dbGetMore) {
+        readLatencies.increment(micros);
+    } else if (curOp->getOp() == dbInsert || curOp->getOp() == dbUpdate ||
+               curOp->getOp() == dbDelete) {
+        writeLatencies.increment(micros);
+    }
+
+    const OpDebug& debug = curOp->debug();
     if (debug.nreturned > 0)
         returnedCounter.increment(debug.nreturned);
     if (debug.ninserted > 0)
@@ -48,12 +48,14 @@
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_manager_global.h"
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/collection_catalog_entry.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_catalog_entry.h"
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/catalog/index_key_validate.h"
 #include "mongo/db/client.h"
 #include "mongo/db/clientcursor.h"
+#include "mongo/db/curop.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/db.h"
 #include "mongo/db/db_raii.h"
@@ -62,15 +64,18 @@
 #include "mongo/db/dbwebserver.h"
 #include "mongo/db/ftdc/ftdc_mongod.h"
 #include "mongo/db/index_names.h"
+#include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/index_rebuilder.h"
 #include "mongo/db/initialize_server_global_state.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/introspect.h"
 #include "mongo/db/json.h"
 #include "mongo/db/log_process_details.h"
+#include "mongo/db/memory_budget_monitor.h"
 #include "mongo/db/mongod_options.h"
 #include "mongo/db/op_observer.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/plan_cache_persistence.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/range_deleter_service.h"
 #include "mongo/db/repair_database.h"
@@ -150,12 +155,31 @@ ntservice::NtServiceDefaultStrings defaultServiceStrings = {
 Timer startupSrandTimer;
 
 class MyMessageHandler : public MessageHandler {
+    /**
+     * Carries the connection's Client between the threads servicing it.
+     */
+    struct ClientState : public ConnectionState {
+        explicit ClientState(ServiceContext::UniqueClient c) : client(std::move(c)) {}
+        ServiceContext::UniqueClient client;
+    };
+
 public:
     virtual void connected(AbstractMessagingPort* p) {
         Client::initThread("conn", p);
     }
 
+    virtual std::unique_ptr<ConnectionState> detach(AbstractMessagingPort* p) {
+        return stdx::make_unique<ClientState>(Client::releaseCurrent());
+    }
+
+    virtual void attach(AbstractMessagingPort* p, std::unique_ptr<ConnectionState> state) {
+        Client::setCurrent(std::move(static_cast<ClientState*>(state.get())->client));
+    }
+
     virtual void process(Message& m, AbstractMessagingPort* port) {
+        // Exhaust getMores are generated locally, so only the first message was read off the
+        // network.
+        bool receivedFromNetwork = true;
         while (true) {
             if (inShutdown()) {
                 log() << "got request after shutdown()" << endl;
@@ -165,13 +189,18 @@ public:
             DbResponse dbresponse;
             {
                 OperationContextImpl txn;
+                if (receivedFromNetwork) {
+                    stdx::lock_guard<Client> lk(*txn.getClient());
+                    CurOp::get(txn)->debug().networkReceiveMicros =
+                        durationCount<Microseconds>(port->getLastReceiveDuration());
+                }
                 assembleResponse(&txn, m, dbresponse, port->remote());
                 // txn must go out of scope here so that the operation cannot show up in
                 // currentOp results after the response reaches the client.
             }
 
             if (dbresponse.response) {
-                port->reply(m, *dbresponse.response, dbresponse.responseTo);
+                _reply(port, m, dbresponse);
                 if (dbresponse.exhaustNS.size() > 0) {
                     MsgData::View header = dbresponse.response->header();
                     QueryResult::View qr = header.view2ptr();
@@ -191,7 +220,10 @@ public:
                         b.appendNum(cursorid);
                         m.appendData(b.buf(), b.len());
                         b.decouple();
+                        // The next batch may wait for data, so don't hold this one back.
+                        port->flushWrites();
                         DEV log() << "exhaust=true sending more" << endl;
+                        receivedFromNetwork = false;
                         continue;  // this goes back to top loop
                     }
                 }
@@ -199,6 +231,23 @@ public:
             break;
         }
     }
+
+private:
+    /**
+     * Sends the response. The operation has already been logged and profiled by the time its
+     * response is written, so a slow write is reported on its own.
+     */
+    static void _reply(AbstractMessagingPort* port, Message& m, DbResponse& dbresponse) {
+        const unsigned long long start = curTimeMicros64();
+        port->reply(m, *dbresponse.response, dbresponse.responseTo);
+        const long long sendMillis = (curTimeMicros64() - start) / 1000;
+        if (sendMillis > serverGlobalParams.slowMS) {
+            log(LogComponent::kNetwork) << "slow response write to " << port->remote()
+                                        << ": responseTo:" << dbresponse.responseTo
+                                        << " reslen:" << dbresponse.response->size() << " "
+                                        << sendMillis << "ms";
+        }
+    }
 };
 
 static void logStartup() {
@@ -244,14 +293,33 @@ static void logStartup() {
     wunit.commit();
 }
 
-static void checkForIdIndexes(OperationContext* txn, Database* db) {
-    if (db->name() == "local") {
+// On storage engines other than MMAPv1, whether startup leaves the databases other than "local"
+// to be opened when they are first used, rather than opening every database and collection.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(deferDatabaseOpenAtStartup, bool, false);
+
+static bool hasIdIndex(OperationContext* txn, const CollectionCatalogEntry* cce) {
+    vector<string> indexNames;
+    cce->getAllIndexes(txn, &indexNames);
+    for (const auto& indexName : indexNames) {
+        if (cce->isIndexReady(txn, indexName) &&
+            IndexDescriptor::isIdIndexPattern(
+                cce->getIndexSpec(txn, indexName).getObjectField("key"))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void checkForIdIndexes(OperationContext* txn,
+                              const string& dbName,
+                              const DatabaseCatalogEntry* dbEntry) {
+    if (dbName == "local") {
         // we do not need an _id index on anything in the local database
         return;
     }
 
     list<string> collections;
-    db->getDatabaseCatalogEntry()->getCollectionNamespaces(&collections);
+    dbEntry->getCollectionNamespaces(&collections);
 
     // for each collection, ensure there is a $_id_ index
     for (list<string>::iterator i = collections.begin(); i != collections.end(); ++i) {
@@ -260,11 +328,11 @@ static void checkForIdIndexes(OperationContext* txn, Database* db) {
         if (ns.isSystem())
             continue;
 
-        Collection* coll = db->getCollection(collectionName);
-        if (!coll)
+        const CollectionCatalogEntry* cce = dbEntry->getCollectionCatalogEntry(collectionName);
+        if (!cce)
             continue;
 
-        if (coll->getIndexCatalog()->findIdIndex(txn))
+        if (hasIdIndex(txn, cce))
             continue;
 
         log() << "WARNING: the collection '" << *i << "' lacks a unique index on _id."
@@ -293,6 +361,44 @@ static unsigned long long checkIfReplMissingFromCommandLine(OperationContext* tx
     return 0;
 }
 
+/**
+ * Returns true if the database has to be opened at startup even when opening it could otherwise
+ * be deferred: it has temporary collections to drop, or indexes with counts, which are taken when
+ * the database is opened and need it locked in X-mode.
+ */
+static bool mustOpenAtStartup(OperationContext* txn,
+                              const DatabaseCatalogEntry* dbEntry,
+                              bool clearTmpCollections) {
+    list<string> collections;
+    dbEntry->getCollectionNamespaces(&collections);
+    for (const auto& ns : collections) {
+        const CollectionCatalogEntry* cce = dbEntry->getCollectionCatalogEntry(ns);
+        if (!cce)
+            continue;
+
+        if (clearTmpCollections && cce->getCollectionOptions(txn).temp)
+            return true;
+
+        vector<string> indexNames;
+        cce->getAllIndexes(txn, &indexNames);
+        for (const auto& indexName : indexNames) {
+            if (cce->getIndexSpec(txn, indexName)["counted"].trueValue())
+                return true;
+        }
+    }
+    return false;
+}
+
+static bool checkFilesCompatible(OperationContext* txn, const DatabaseCatalogEntry* dbEntry) {
+    if (dbEntry->currentFilesCompatible(txn))
+        return true;
+
+    log() << "****";
+    log() << "cannot do this upgrade without an upgrade in the middle";
+    log() << "please do a --repair with 2.6 and then start this version";
+    return false;
+}
+
 static void repairDatabasesAndCheckVersion() {
     LOG(1) << "enter repairDatabases (to check pdfile version #)" << endl;
 
@@ -325,19 +431,45 @@ static void repairDatabasesAndCheckVersion() {
         !(checkIfReplMissingFromCommandLine(&txn) || replSettings.usingReplSets() ||
           replSettings.slave == repl::SimpleSlave);
 
+    // MMAPv1 has to open a database to check its files and its system.indexes collection.
+    const bool deferOpen = deferDatabaseOpenAtStartup && !storageEngine->isMmapV1() &&
+        !storageGlobalParams.upgrade;
+
     for (vector<string>::const_iterator i = dbNames.begin(); i != dbNames.end(); ++i) {
         const string dbName = *i;
         LOG(1) << "    Recovering database: " << dbName << endl;
 
+        const bool clearTmpCollections = shouldClearNonLocalTmpCollections || dbName == "local";
+
+        if (deferOpen && dbName != "local") {
+            // Only check the catalog of the storage engine, and leave the database and its
+            // collections to be opened when first used.
+            const DatabaseCatalogEntry* dbEntry =
+                storageEngine->getDatabaseCatalogEntry(&txn, dbName);
+            invariant(dbEntry);
+
+            if (!mustOpenAtStartup(&txn, dbEntry, clearTmpCollections)) {
+                if (!checkFilesCompatible(&txn, dbEntry)) {
+                    dbexit(EXIT_NEED_UPGRADE);
+                    return;
+                }
+
+                if (replSettings.usingReplSets()) {
+                    checkForIdIndexes(&txn, dbName, dbEntry);
+                }
+
+                LOG(1) << "    Deferring opening database: " << dbName << endl;
+                dbHolder().deferOpen(dbName);
+                continue;
+            }
+        }
+
         Database* db = dbHolder().openDb(&txn, dbName);
         invariant(db);
 
         // First thing after opening the database is to check for file compatibility,
         // otherwise we might crash if this is a deprecated format.
-        if (!db->getDatabaseCatalogEntry()->currentFilesCompatible(&txn)) {
-            log() << "****";
-            log() << "cannot do this upgrade without an upgrade in the middle";
-            log() << "please do a --repair with 2.6 and then start this version";
+        if (!checkFilesCompatible(&txn, db->getDatabaseCatalogEntry())) {
             dbexit(EXIT_NEED_UPGRADE);
             return;
         }
@@ -381,10 +513,10 @@ static void repairDatabasesAndCheckVersion() {
 
         if (replSettings.usingReplSets()) {
             // We only care about the _id index if we are in a replset
-            checkForIdIndexes(&txn, db);
+            checkForIdIndexes(&txn, dbName, db->getDatabaseCatalogEntry());
         }
 
-        if (shouldClearNonLocalTmpCollections || dbName == "local") {
+        if (clearTmpCollections) {
             db->clearTmpCollections(&txn);
         }
     }
@@ -585,9 +717,12 @@ static void _initAndListen(int listenPort) {
         } else {
             startTTLBackgroundJob();
         }
+
+        startPlanCachePersistenceBackgroundJob();
     }
 
     startClientCursorMonitor();
+    startMemoryBudgetMonitor();
 
     PeriodicTask::startRunningPeriodicTasks();
 
@@ -748,6 +883,10 @@ MONGO_INITIALIZER_WITH_PREREQUISITES(CreateReplicationManager,
 (InitializerContext* context) {
     repl::TopologyCoordinatorImpl::Options topoCoordOptions;
     topoCoordOptions.maxSyncSourceLagSecs = Seconds(repl::maxSyncSourceLagSecs);
+    topoCoordOptions.syncSourceLagPenaltyPerSec =
+        Milliseconds(repl::syncSourceLagPenaltyMillisPerSec);
+    topoCoordOptions.syncSourceChangeHysteresis =
+        Milliseconds(repl::syncSourceChangeHysteresisMillis);
     topoCoordOptions.configServerMode = serverGlobalParams.configsvrMode;
     // TODO(SERVER-19739):  Rather than checking if the storage engine name is "wiredTiger"
     // we should be asking the global storage engine whether it supports readCommitted,
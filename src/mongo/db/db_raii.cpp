@@ -36,11 +36,18 @@
 #include "mongo/db/client.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/top.h"
 #include "mongo/s/d_state.h"
 
 namespace mongo {
 
+namespace {
+// When set, user reads on a secondary are served from the newest named snapshot, which is only
+// taken between oplog batches, instead of waiting for the batch being applied to finish.
+MONGO_EXPORT_SERVER_PARAMETER(readFromLastAppliedSnapshotOnSecondaries, bool, false);
+}  // namespace
+
 AutoGetDb::AutoGetDb(OperationContext* txn, StringData ns, LockMode mode)
     : _dbLock(txn->lockState(), ns, mode), _db(dbHolder().get(txn, ns)) {}
 
@@ -74,7 +81,7 @@ AutoGetCollectionForRead::AutoGetCollectionForRead(OperationContext* txn,
                                                    const NamespaceString& nss)
     : _txn(txn), _transaction(txn, MODE_IS) {
     {
-        _autoColl.emplace(txn, nss, MODE_IS);
+        _lockForRead(nss);
         auto curOp = CurOp::get(_txn);
         stdx::lock_guard<Client> lk(*_txn->getClient());
 
@@ -109,6 +116,47 @@ AutoGetCollectionForRead::~AutoGetCollectionForRead() {
                 currentOp->isCommand());
 }
 
+void AutoGetCollectionForRead::_lockForRead(const NamespaceString& nss) {
+    if (!_canReadFromLastAppliedSnapshot()) {
+        _autoColl.emplace(_txn, nss, MODE_IS);
+        return;
+    }
+
+    _noBatchConflict.emplace(_txn->lockState());
+    _autoColl.emplace(_txn, nss, MODE_IS);
+
+    // The catalog is always current, so a collection created by a batch that is being applied or
+    // is not yet in a snapshot cannot be read from the snapshot. Such reads wait for the batch.
+    boost::optional<SnapshotName> minSnapshot;
+    if (auto coll = _autoColl->getCollection()) {
+        minSnapshot = coll->getMinimumVisibleSnapshot();
+    }
+    if (_txn->recoveryUnit()->setReadFromLastAppliedSnapshot(minSnapshot).isOK()) {
+        return;
+    }
+
+    _autoColl = boost::none;
+    _noBatchConflict = boost::none;
+    _autoColl.emplace(_txn, nss, MODE_IS);
+}
+
+bool AutoGetCollectionForRead::_canReadFromLastAppliedSnapshot() const {
+    if (!readFromLastAppliedSnapshotOnSecondaries) {
+        return false;
+    }
+
+    // The parallel batch writer lock is taken before any other lock, so it can only be skipped by
+    // an operation that holds no locks yet. Internal operations keep waiting for batches.
+    const Locker* locker = _txn->lockState();
+    if (locker->isLocked() || locker->isBatchWriter() || locker->inAWriteUnitOfWork() ||
+        !_txn->getClient()->isFromUserConnection() ||
+        _txn->recoveryUnit()->isReadingFromMajorityCommittedSnapshot()) {
+        return false;
+    }
+
+    return repl::ReplicationCoordinator::get(_txn)->getMemberState().secondary();
+}
+
 void AutoGetCollectionForRead::_ensureMajorityCommittedSnapshotIsValid(const NamespaceString& nss) {
     while (true) {
         auto coll = _autoColl->getCollection();
@@ -154,9 +154,17 @@ private:
     void _init(const std::string& ns, StringData coll);
     void _ensureMajorityCommittedSnapshotIsValid(const NamespaceString& nss);
 
+    /**
+     * Locks the collection. On a secondary, if so configured, reads from the snapshot of the last
+     * applied oplog batch without waiting for the batch currently being applied.
+     */
+    void _lockForRead(const NamespaceString& nss);
+    bool _canReadFromLastAppliedSnapshot() const;
+
     const Timer _timer;
     OperationContext* const _txn;
     const ScopedTransaction _transaction;
+    boost::optional<ShouldNotConflictWithSecondaryBatchApplicationBlock> _noBatchConflict;
     boost::optional<AutoGetCollection> _autoColl;
 };
 
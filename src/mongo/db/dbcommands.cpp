@@ -99,6 +99,7 @@
 #include "mongo/util/md5.hpp"
 #include "mongo/util/print.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -1157,6 +1158,27 @@ private:
     bool maintenanceModeSet;
 };
 
+namespace {
+
+/**
+ * Parses the value of the $priority command option, one of the TicketHolder priority names.
+ */
+StatusWith<TicketHolder::Priority> parseTicketPriority(const BSONElement& elt) {
+    if (elt.type() == String) {
+        for (int i = 0; i < TicketHolder::kNumPriorities; i++) {
+            const TicketHolder::Priority priority = static_cast<TicketHolder::Priority>(i);
+            if (elt.valueStringData() == TicketHolder::priorityName(priority)) {
+                return priority;
+            }
+        }
+    }
+    return Status(ErrorCodes::InvalidOptions,
+                  str::stream() << "$priority must be one of \"low\", \"normal\" or \"high\", not "
+                                << elt.toString(false));
+}
+
+}  // namespace
+
 /**
  * this handles
  - auth
@@ -1251,6 +1273,12 @@ void Command::execCommand(OperationContext* txn,
 
         CurOp::get(txn)->setMaxTimeMicros(static_cast<unsigned long long>(maxTimeMS) * 1000);
 
+        // Handle command option $priority.
+        BSONElement priorityElt = request.getCommandArgs()["$priority"];
+        if (!priorityElt.eoo()) {
+            txn->setTicketPriority(uassertStatusOK(parseTicketPriority(priorityElt)));
+        }
+
         // Handle shard version that may have been sent along with the command.
         OperationShardVersion::get(txn).initializeFromCommand(
             NamespaceString(command->parseNs(dbname, request.getCommandArgs())),
@@ -1265,6 +1293,9 @@ void Command::execCommand(OperationContext* txn,
 
         command->_commandsExecuted.increment();
 
+        const Timer runTimer;
+        ON_BLOCK_EXIT([&] { command->_latency.increment(runTimer.micros()); });
+
         retval = command->run(txn, request, replyBuilder);
 
         dassert(replyBuilder->getState() == rpc::ReplyBuilderInterface::State::kOutputDocs);
@@ -1302,7 +1333,8 @@ bool Command::run(OperationContext* txn,
             // Only return an error if a non-nullish readConcern was parsed, but do not process
             // readConcern regardless.
             if (!readConcern.getOpTime().isNull() ||
-                readConcern.getLevel() != repl::ReadConcernLevel::kLocalReadConcern) {
+                readConcern.getLevel() != repl::ReadConcernLevel::kLocalReadConcern ||
+                readConcern.getMaxStaleness()) {
                 replyBuilder->setMetadata(rpc::makeEmptyMetadata())
                     .setCommandReply({ErrorCodes::InvalidOptions,
                                       str::stream()
@@ -1340,6 +1372,14 @@ bool Command::run(OperationContext* txn,
                     return false;
                 }
             }
+
+            if (auto maxStaleness = readConcern.getMaxStaleness()) {
+                Status status = txn->recoveryUnit()->setReadFromStaleSnapshot(*maxStaleness);
+                if (!status.isOK()) {
+                    replyBuilder->setMetadata(rpc::makeEmptyMetadata()).setCommandReply(status);
+                    return false;
+                }
+            }
         }
     }
 
@@ -163,7 +163,9 @@ struct Helpers {
      *
      * Returns -1 when no usable index exists
      *
-     * Does oplog the individual document deletions.
+     * Does oplog the individual document deletions. The documents are deleted in batches of
+     * the rangeDeleterBatchSize server parameter, waiting for replication after each batch and
+     * pausing rangeDeleterBatchDelayMS between two batches.
      * // TODO: Refactor this mechanism, it is growing too large
      */
     static long long removeRange(OperationContext* txn,
@@ -28,10 +28,15 @@
 
 #include "mongo/db/exec/and_hash.h"
 
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/and_common-inl.h"
+#include "mongo/db/exec/index_scan.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/exec/working_set.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/service_context.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/mongoutils/str.h"
 
@@ -59,6 +64,9 @@ AndHashStage::AndHashStage(OperationContext* opCtx, WorkingSet* ws, const Collec
       _collection(collection),
       _ws(ws),
       _hashingChildren(true),
+      _usingBitmaps(false),
+      _snapshotChanged(false),
+      _idRetrying(WorkingSet::INVALID_ID),
       _currentChild(0),
       _memUsage(0),
       _maxMemUsage(kDefaultMaxMemUsageBytes) {}
@@ -71,6 +79,9 @@ AndHashStage::AndHashStage(OperationContext* opCtx,
       _collection(collection),
       _ws(ws),
       _hashingChildren(true),
+      _usingBitmaps(false),
+      _snapshotChanged(false),
+      _idRetrying(WorkingSet::INVALID_ID),
       _currentChild(0),
       _memUsage(0),
       _maxMemUsage(maxMemUsage) {}
@@ -96,8 +107,13 @@ bool AndHashStage::isEOF() {
 
     // Or we're streaming in results from the last child.
 
+    // A survivor of the intersection is waiting to be fetched.
+    if (WorkingSet::INVALID_ID != _idRetrying) {
+        return false;
+    }
+
     // If there's nothing to probe against, we're EOF.
-    if (_dataMap.empty()) {
+    if (intersectionEmpty()) {
         return true;
     }
 
@@ -111,7 +127,7 @@ PlanStage::StageState AndHashStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     if (isEOF()) {
         return PlanStage::IS_EOF;
@@ -172,6 +188,10 @@ PlanStage::StageState AndHashStage::work(WorkingSetID* out) {
             }
         }
 
+        if (internalQueryExecAndHashUseRecordIdBitmaps && canUseBitmaps()) {
+            switchToBitmaps();
+        }
+
         // We did a bunch of work above, return NEED_TIME to be fair.
         return PlanStage::NEED_TIME;
     }
@@ -182,6 +202,12 @@ PlanStage::StageState AndHashStage::work(WorkingSetID* out) {
 
     // We read the first child into our hash table.
     if (_hashingChildren) {
+        // Rather than fail once the hash table outgrows the memory limit, we carry on with only
+        // the RecordIds if we can.
+        if (_memUsage > _maxMemUsage && !_usingBitmaps && canUseBitmaps()) {
+            switchToBitmaps();
+        }
+
         // Check memory usage of previously hashed results.
         if (_memUsage > _maxMemUsage) {
             mongoutils::str::stream ss;
@@ -207,8 +233,15 @@ PlanStage::StageState AndHashStage::work(WorkingSetID* out) {
     // Returning results.  We read from the last child and return the results that are in our
     // hash map.
 
+    // Retry the fetch of a survivor of the bitmap intersection, if we were asked to yield.
+    if (WorkingSet::INVALID_ID != _idRetrying) {
+        WorkingSetID id = _idRetrying;
+        _idRetrying = WorkingSet::INVALID_ID;
+        return fetchSurvivor(id, out);
+    }
+
     // We should be EOF if we're not hashing results and the dataMap is empty.
-    verify(!_dataMap.empty());
+    verify(!intersectionEmpty());
 
     // We probe _dataMap with the last child.
     verify(_currentChild == _children.size() - 1);
@@ -229,6 +262,16 @@ PlanStage::StageState AndHashStage::work(WorkingSetID* out) {
         return PlanStage::NEED_TIME;
     }
 
+    if (_usingBitmaps) {
+        if (!_bitmap.remove(member->loc)) {
+            _ws->free(*out);
+            ++_commonStats.needTime;
+            return PlanStage::NEED_TIME;
+        }
+        _memUsage = _bitmap.getMemUsage();
+        return fetchSurvivor(*out, out);
+    }
+
     DataMap::iterator it = _dataMap.find(member->loc);
     if (_dataMap.end() == it) {
         // Child's output wasn't in every previous child.  Throw it out.
@@ -276,6 +319,14 @@ PlanStage::StageState AndHashStage::readFirstChild(WorkingSetID* out) {
             return PlanStage::NEED_TIME;
         }
 
+        if (_usingBitmaps) {
+            _bitmap.add(member->loc);
+            _ws->free(id);
+            _memUsage = _bitmap.getMemUsage();
+            ++_commonStats.needTime;
+            return PlanStage::NEED_TIME;
+        }
+
         if (!_dataMap.insert(std::make_pair(member->loc, id)).second) {
             // Didn't insert because we already had this loc inside the map. This should only
             // happen if we're seeing a newer copy of the same doc in a more recent snapshot.
@@ -298,13 +349,13 @@ PlanStage::StageState AndHashStage::readFirstChild(WorkingSetID* out) {
         _currentChild = 1;
 
         // If our first child was empty, don't scan any others, no possible results.
-        if (_dataMap.empty()) {
+        if (intersectionEmpty()) {
             _hashingChildren = false;
             return PlanStage::IS_EOF;
         }
 
         ++_commonStats.needTime;
-        _specificStats.mapAfterChild.push_back(_dataMap.size());
+        _specificStats.mapAfterChild.push_back(_usingBitmaps ? _bitmap.size() : _dataMap.size());
 
         return PlanStage::NEED_TIME;
     } else if (PlanStage::FAILURE == childStatus || PlanStage::DEAD == childStatus) {
@@ -348,7 +399,12 @@ PlanStage::StageState AndHashStage::hashOtherChildren(WorkingSetID* out) {
         }
 
         verify(member->hasLoc());
-        if (_dataMap.end() == _dataMap.find(member->loc)) {
+        if (_usingBitmaps) {
+            if (_bitmap.contains(member->loc)) {
+                _seenBitmap.add(member->loc);
+                _memUsage = _bitmap.getMemUsage() + _seenBitmap.getMemUsage();
+            }
+        } else if (_dataMap.end() == _dataMap.find(member->loc)) {
             // Ignore.  It's not in any previous child.
         } else {
             // We have a hit.  Copy data into the WSM we already have.
@@ -369,6 +425,13 @@ PlanStage::StageState AndHashStage::hashOtherChildren(WorkingSetID* out) {
         // Finished with a child.
         ++_currentChild;
 
+        // Keep elements of _bitmap that are in _seenBitmap.
+        if (_usingBitmaps) {
+            _bitmap.intersectWith(_seenBitmap);
+            _seenBitmap.clear();
+            _memUsage = _bitmap.getMemUsage();
+        }
+
         // Keep elements of _dataMap that are in _seenMap.
         DataMap::iterator it = _dataMap.begin();
         while (it != _dataMap.end()) {
@@ -387,14 +450,14 @@ PlanStage::StageState AndHashStage::hashOtherChildren(WorkingSetID* out) {
             }
         }
 
-        _specificStats.mapAfterChild.push_back(_dataMap.size());
+        _specificStats.mapAfterChild.push_back(_usingBitmaps ? _bitmap.size() : _dataMap.size());
 
         _seenMap.clear();
 
         // _dataMap is now the intersection of the first _currentChild nodes.
 
         // If we have nothing to AND with after finishing any child, stop.
-        if (_dataMap.empty()) {
+        if (intersectionEmpty()) {
             _hashingChildren = false;
             return PlanStage::IS_EOF;
         }
@@ -430,6 +493,124 @@ PlanStage::StageState AndHashStage::hashOtherChildren(WorkingSetID* out) {
     }
 }
 
+bool AndHashStage::canUseBitmaps() const {
+    for (auto&& child : _children) {
+        if (STAGE_IXSCAN != child->stageType()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AndHashStage::switchToBitmaps() {
+    invariant(_hashingChildren);
+    invariant(!_usingBitmaps);
+
+    for (DataMap::const_iterator it = _dataMap.begin(); it != _dataMap.end(); ++it) {
+        _bitmap.add(it->first);
+        _ws->free(it->second);
+    }
+    for (SeenMap::const_iterator it = _seenMap.begin(); it != _seenMap.end(); ++it) {
+        _seenBitmap.add(*it);
+    }
+    _dataMap.clear();
+    _seenMap.clear();
+
+    _usingBitmaps = true;
+    _specificStats.usedRecordIdBitmaps = true;
+    _memUsage = _bitmap.getMemUsage() + _seenBitmap.getMemUsage();
+}
+
+bool AndHashStage::intersectionEmpty() const {
+    return _usingBitmaps ? _bitmap.empty() : _dataMap.empty();
+}
+
+PlanStage::StageState AndHashStage::fetchSurvivor(WorkingSetID id, WorkingSetID* out) {
+    WorkingSetMember* member = _ws->get(id);
+
+    // The RecordId was invalidated while we waited to retry the fetch. We can no longer tell
+    // whether the document is in the intersection, so it has to be matched later.
+    if (!member->hasLoc()) {
+        ++_specificStats.flaggedButPassed;
+        _ws->flagForReview(id);
+        return PlanStage::NEED_TIME;
+    }
+
+    if (!member->hasObj()) {
+        try {
+            if (!_cursor) {
+                _cursor = _collection->getCursor(getOpCtx());
+            }
+
+            if (auto fetcher = _cursor->fetcherForId(member->loc)) {
+                _idRetrying = id;
+                member->setFetcher(fetcher.release());
+                *out = id;
+                ++_commonStats.needYield;
+                return PlanStage::NEED_YIELD;
+            }
+
+            // This also checks the key data of the last child, if it is suspicious.
+            if (!WorkingSetCommon::fetch(getOpCtx(), _ws, id, _cursor)) {
+                _ws->free(id);
+                ++_commonStats.needTime;
+                return PlanStage::NEED_TIME;
+            }
+        } catch (const WriteConflictException& wce) {
+            _idRetrying = id;
+            *out = WorkingSet::INVALID_ID;
+            ++_commonStats.needYield;
+            return PlanStage::NEED_YIELD;
+        }
+    }
+
+    // We kept none of the other children's key data, so if the document may have changed since
+    // they produced its RecordId, ask them whether they still would.
+    if (_snapshotChanged) {
+        for (size_t i = 0; i < _children.size() - 1; ++i) {
+            const IndexScan* scan = static_cast<const IndexScan*>(_children[i].get());
+            if (!scan->wouldReturnDocument(member->obj.value())) {
+                _ws->free(id);
+                ++_commonStats.needTime;
+                return PlanStage::NEED_TIME;
+            }
+        }
+    }
+
+    ++_commonStats.advanced;
+    *out = id;
+    return PlanStage::ADVANCED;
+}
+
+void AndHashStage::doSaveState() {
+    // Storage engines with document-level locking may hand us a new snapshot after a yield.
+    if (supportsDocLocking()) {
+        _snapshotChanged = true;
+    }
+
+    if (_cursor) {
+        _cursor->saveUnpositioned();
+    }
+}
+
+void AndHashStage::doRestoreState() {
+    if (_cursor) {
+        _cursor->restore();
+    }
+}
+
+void AndHashStage::doDetachFromOperationContext() {
+    if (_cursor) {
+        _cursor->detachFromOperationContext();
+    }
+}
+
+void AndHashStage::doReattachToOperationContext() {
+    if (_cursor) {
+        _cursor->reattachToOperationContext(getOpCtx());
+    }
+}
+
 void AndHashStage::doInvalidate(OperationContext* txn, const RecordId& dl, InvalidationType type) {
     // TODO remove this since calling isEOF is illegal inside of doInvalidate().
     if (isEOF()) {
@@ -455,6 +636,31 @@ void AndHashStage::doInvalidate(OperationContext* txn, const RecordId& dl, Inval
     // If it's a mutation the predicates implied by the AND-ing may no longer be true.
     //
     // So, we flag and try to pick it up later.
+    if (WorkingSet::INVALID_ID != _idRetrying) {
+        WorkingSetMember* member = _ws->get(_idRetrying);
+        if (member->hasLoc() && member->loc == dl) {
+            WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
+        }
+    }
+
+    if (_usingBitmaps && _bitmap.remove(dl)) {
+        if (_hashingChildren) {
+            ++_specificStats.flaggedInProgress;
+        } else {
+            ++_specificStats.flaggedButPassed;
+        }
+        _seenBitmap.remove(dl);
+
+        // We kept nothing but the RecordId, so fetch the document into a new WSM to flag.
+        WorkingSetID id = _ws->allocate();
+        WorkingSetMember* member = _ws->get(id);
+        member->loc = dl;
+        _ws->transitionToLocAndIdx(id);
+        WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
+        _ws->flagForReview(id);
+        return;
+    }
+
     DataMap::iterator it = _dataMap.find(dl);
     if (_dataMap.end() != it) {
         WorkingSetID id = it->second;
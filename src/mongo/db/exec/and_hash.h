@@ -32,8 +32,10 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/record_id_bitmap.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/storage/record_store.h"
 #include "mongo/platform/unordered_set.h"
 
 namespace mongo {
@@ -48,6 +50,13 @@ namespace mongo {
  * is fetched and added to the WorkingSet as "flagged for further review."  Because this stage
  * operates with RecordIds, we are unable to evaluate the AND for the invalidated RecordId, and it
  * must be fully matched later.
+ *
+ * If every child is an index scan, the intersection can instead be computed over compressed
+ * RecordId bitmaps, which hold none of the children's data. This happens when the hash table
+ * outgrows the memory limit, or from the start if internalQueryExecAndHashUseRecordIdBitmaps is
+ * set. The surviving results of the last child are then fetched by this stage, and if the
+ * storage snapshot may have changed since the other children produced a RecordId, re-checked
+ * against those children.
  */
 class AndHashStage final : public PlanStage {
 public:
@@ -72,6 +81,10 @@ public:
     StageState work(WorkingSetID* out) final;
     bool isEOF() final;
 
+    void doSaveState() final;
+    void doRestoreState() final;
+    void doDetachFromOperationContext() final;
+    void doReattachToOperationContext() final;
     void doInvalidate(OperationContext* txn, const RecordId& dl, InvalidationType type) final;
 
     StageType stageType() const final {
@@ -91,6 +104,28 @@ private:
     StageState hashOtherChildren(WorkingSetID* out);
     StageState workChild(size_t childNo, WorkingSetID* out);
 
+    /**
+     * Returns true if all children are index scans, whose results can be re-checked by
+     * IndexScan::wouldReturnDocument() once we no longer hold their key data.
+     */
+    bool canUseBitmaps() const;
+
+    /**
+     * Replaces _dataMap and _seenMap with RecordId bitmaps, freeing the buffered results.
+     */
+    void switchToBitmaps();
+
+    /**
+     * Returns true if nothing survived the intersection of the children hashed so far.
+     */
+    bool intersectionEmpty() const;
+
+    /**
+     * Fetches a result of the last child which survived the bitmap intersection, re-checks it
+     * if needed, and returns it.
+     */
+    StageState fetchSurvivor(WorkingSetID id, WorkingSetID* out);
+
     // Not owned by us.
     const Collection* _collection;
 
@@ -115,6 +150,24 @@ private:
     // True if we're still intersecting _children[0..._children.size()-1].
     bool _hashingChildren;
 
+    // True if _bitmap and _seenBitmap have taken the place of _dataMap and _seenMap.
+    bool _usingBitmaps;
+
+    // The intersection of the children hashed so far, and the RecordIds of it which the child
+    // being hashed has produced. Only used if _usingBitmaps.
+    RecordIdBitmap _bitmap;
+    RecordIdBitmap _seenBitmap;
+
+    // True if a yield since we started may have changed the storage snapshot, so that results
+    // which survived the bitmap intersection have to be checked against the other children.
+    bool _snapshotChanged;
+
+    // Used to fetch results which survived the bitmap intersection.
+    std::unique_ptr<SeekableRecordCursor> _cursor;
+
+    // A result of the last child whose fetch we asked to be retried after a yield.
+    WorkingSetID _idRetrying;
+
     // Which child are we currently working on?
     size_t _currentChild;
 
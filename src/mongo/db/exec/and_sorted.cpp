@@ -67,7 +67,7 @@ PlanStage::StageState AndSortedStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     if (isEOF()) {
         return PlanStage::IS_EOF;
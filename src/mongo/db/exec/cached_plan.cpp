@@ -37,9 +37,11 @@
 #include "mongo/db/exec/multi_plan.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/operation_arena.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/query/plan_regression_tracker.h"
 #include "mongo/db/query/plan_yield_policy.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
@@ -50,6 +52,43 @@
 
 namespace mongo {
 
+namespace {
+
+/**
+ * Returns the key patterns of the indexes among 'indices' used by the plan whose stats are
+ * 'stats', in index name order.
+ */
+std::vector<BSONObj> getIndexKeyPatternsUsed(const PlanStageStats& stats,
+                                             const std::vector<IndexEntry>& indices) {
+    PlanSummaryStats summary;
+    Explain::getSummaryStats(stats, &summary);
+
+    std::vector<BSONObj> keyPatterns;
+    for (const std::string& indexName : summary.indexesUsed) {
+        for (const IndexEntry& index : indices) {
+            if (index.name == indexName) {
+                keyPatterns.push_back(index.keyPattern);
+                break;
+            }
+        }
+    }
+    return keyPatterns;
+}
+
+bool sameIndexKeyPatterns(const std::vector<BSONObj>& lhs, const std::vector<BSONObj>& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        if (lhs[i] != rhs[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
 // static
 const char* CachedPlanStage::kStageType = "CACHED_PLAN";
 
@@ -59,13 +98,15 @@ CachedPlanStage::CachedPlanStage(OperationContext* txn,
                                  CanonicalQuery* cq,
                                  const QueryPlannerParams& params,
                                  size_t decisionWorks,
+                                 double decisionCostPerResult,
                                  PlanStage* root)
     : PlanStage(kStageType, txn),
       _collection(collection),
       _ws(ws),
       _canonicalQuery(cq),
       _plannerParams(params),
-      _decisionWorks(decisionWorks) {
+      _decisionWorks(decisionWorks),
+      _decisionCostPerResult(decisionCostPerResult) {
     invariant(_collection);
     _children.emplace_back(root);
 }
@@ -74,7 +115,7 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
     // Adds the amount of time taken by pickBestPlan() to executionTimeMillis. There's lots of
     // execution work that happens here, so this is needed for the time accounting to
     // make sense.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     // If we work this many times during the trial period, then we will replan the
     // query from scratch.
@@ -160,8 +201,25 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
         }
     }
 
-    // If we're here, the trial period took more than 'maxWorksBeforeReplan' work cycles. This
-    // plan is taking too long, so we replan from scratch.
+    // If we're here, the trial period took more than 'maxWorksBeforeReplan' work cycles. If the
+    // plan is still as efficient per result as when it was cached, the data simply got larger
+    // and replanning would most likely pick the same plan again, so we keep it.
+    if (!costHasRegressed()) {
+        LOG(1) << "Execution of cached plan required " << maxWorksBeforeReplan
+               << " works, but its cost per result has not regressed. Keeping cached plan for"
+               << " query: " << _canonicalQuery->toStringShort()
+               << " plan summary: " << Explain::getPlanSummary(child().get());
+        updatePlanCache();
+        return Status::OK();
+    }
+
+    // The plan is taking too long, so we replan from scratch. What it managed during the trial
+    // is the latest word on how it performs.
+    if (!_results.empty()) {
+        std::unique_ptr<PlanStageStats> stats = child()->getStats();
+        recordObservedPlan(*stats, PlanRanker::costPerResult(stats.get()));
+    }
+
     LOG(1) << "Execution of cached plan required " << maxWorksBeforeReplan
            << " works, but was originally cached with only " << _decisionWorks
            << " works. Evicting cache entry and replanning query: "
@@ -202,6 +260,7 @@ Status CachedPlanStage::replan(PlanYieldPolicy* yieldPolicy, bool shouldCache) {
     _children.clear();
 
     // Use the query planning module to plan the whole query.
+    _plannerParams.arena = OperationArena::get(getOpCtx());
     std::vector<QuerySolution*> rawSolutions;
     Status status = QueryPlanner::plan(*_canonicalQuery, _plannerParams, &rawSolutions);
     if (!status.isOK()) {
@@ -257,7 +316,15 @@ Status CachedPlanStage::replan(PlanYieldPolicy* yieldPolicy, bool shouldCache) {
     }
 
     // Delegate to the MultiPlanStage's plan selection facility.
-    return multiPlanStage->pickBestPlan(yieldPolicy);
+    Status pickBestPlanStatus = multiPlanStage->pickBestPlan(yieldPolicy);
+    if (!pickBestPlanStatus.isOK()) {
+        return pickBestPlanStatus;
+    }
+
+    if (shouldCache) {
+        pinBestPlanIfRegressed(multiPlanStage);
+    }
+    return Status::OK();
 }
 
 bool CachedPlanStage::isEOF() {
@@ -268,7 +335,7 @@ PlanStage::StageState CachedPlanStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     if (isEOF()) {
         return PlanStage::IS_EOF;
@@ -333,6 +400,19 @@ void CachedPlanStage::updatePlanCache() {
     feedback->stats = getStats();
     feedback->score = PlanRanker::scoreTree(feedback->stats.get());
 
+    // Our own stats only cover the time spent choosing whether to replan, so summarize the
+    // cached plan itself.
+    invariant(1U == feedback->stats->children.size());
+    PlanSummaryStats summary;
+    Explain::getSummaryStats(*feedback->stats->children[0], &summary);
+    feedback->nReturned = summary.nReturned;
+    feedback->keysExamined = summary.totalKeysExamined;
+    feedback->docsExamined = summary.totalDocsExamined;
+    feedback->executionTimeMillis = summary.executionTimeMillis;
+
+    recordObservedPlan(*feedback->stats->children[0],
+                       PlanRanker::costPerResult(feedback->stats->children[0]));
+
     PlanCache* cache = _collection->infoCache()->getPlanCache();
     Status fbs = cache->feedback(*_canonicalQuery, feedback.release());
     if (!fbs.isOK()) {
@@ -345,4 +425,69 @@ void CachedPlanStage::updatePlanCache() {
     }
 }
 
+bool CachedPlanStage::costHasRegressed() {
+    if (internalQueryCacheCostRegressionRatio <= 0 || _decisionCostPerResult <= 0 ||
+        _results.empty()) {
+        return true;
+    }
+
+    const double observedCostPerResult = PlanRanker::costPerResult(child()->getStats().get());
+    return observedCostPerResult >
+        internalQueryCacheCostRegressionRatio * _decisionCostPerResult;
+}
+
+void CachedPlanStage::recordObservedPlan(const PlanStageStats& stats, double costPerResult) {
+    if (internalQueryAutoPinRegressionRatio <= 0 || _plannerParams.indexFiltersApplied) {
+        return;
+    }
+
+    CollectionInfoCache* infoCache = _collection->infoCache();
+    infoCache->getPlanRegressionTracker()->recordPlan(
+        infoCache->getPlanCache()->computeKey(*_canonicalQuery),
+        getIndexKeyPatternsUsed(stats, _plannerParams.indices),
+        costPerResult,
+        Date_t::now());
+}
+
+void CachedPlanStage::pinBestPlanIfRegressed(MultiPlanStage* multiPlanStage) {
+    // Index filters set by the user already decide which indexes the query may use.
+    if (internalQueryAutoPinRegressionRatio <= 0 || _plannerParams.indexFiltersApplied) {
+        return;
+    }
+
+    std::unique_ptr<PlanStageStats> winnerStats = multiPlanStage->getStats();
+    const double winnerCostPerResult = PlanRanker::costPerResult(winnerStats.get());
+    const std::vector<BSONObj> winnerIndexes =
+        getIndexKeyPatternsUsed(*winnerStats, _plannerParams.indices);
+
+    CollectionInfoCache* infoCache = _collection->infoCache();
+    PlanCache* planCache = infoCache->getPlanCache();
+    const PlanCacheKey key = planCache->computeKey(*_canonicalQuery);
+    PlanRegressionTracker* tracker = infoCache->getPlanRegressionTracker();
+    const Date_t now = Date_t::now();
+
+    // A plan which uses no indexes cannot be expressed as an index filter.
+    PlanRegressionTracker::ObservedPlan best;
+    if (!tracker->getBestPlan(key, now, &best) || best.indexKeyPatterns.empty() ||
+        best.costPerResult <= 0 || sameIndexKeyPatterns(best.indexKeyPatterns, winnerIndexes) ||
+        winnerCostPerResult <= internalQueryAutoPinRegressionRatio * best.costPerResult) {
+        tracker->recordPlan(key, winnerIndexes, winnerCostPerResult, now);
+        return;
+    }
+
+    if (!infoCache->getQuerySettings()->setAutoPinnedIndices(
+            *_canonicalQuery, key, best.indexKeyPatterns)) {
+        return;
+    }
+
+    // The winner has just been cached. Evict it so that the next run is planned with only the
+    // pinned indexes.
+    planCache->remove(*_canonicalQuery);
+
+    log() << "Replanning " << _canonicalQuery->toStringShort() << " picked a plan examining "
+          << winnerCostPerResult << " keys and documents per result, but a plan examining "
+          << best.costPerResult << " was observed " << (now - best.observedAt)
+          << " ago. Pinned the indexes of the earlier plan.";
+}
+
 }  // namespace mongo
@@ -42,6 +42,7 @@
 
 namespace mongo {
 
+class MultiPlanStage;
 class PlanYieldPolicy;
 
 /**
@@ -59,6 +60,7 @@ public:
                     CanonicalQuery* cq,
                     const QueryPlannerParams& params,
                     size_t decisionWorks,
+                    double decisionCostPerResult,
                     PlanStage* root);
 
     bool isEOF() final;
@@ -84,6 +86,11 @@ public:
      * Feedback from the trial period is passed to the plan cache. If the performance is lower
      * than expected, the old plan is evicted and a new plan is selected from scratch (again
      * yielding according to 'yieldPolicy'). Otherwise, the cached plan is run.
+     *
+     * Running out of works during the trial period only counts as lower than expected
+     * performance if the plan has not produced any results, or if it is examining more keys and
+     * documents per result than 'internalQueryCacheCostRegressionRatio' times the baseline
+     * recorded when the plan was cached.
      */
     Status pickBestPlan(PlanYieldPolicy* yieldPolicy);
 
@@ -96,6 +103,28 @@ private:
      */
     void updatePlanCache();
 
+    /**
+     * Returns true if the stats of the trial period show that the cached plan is examining
+     * significantly more keys and documents per result than it did when it was cached, or if
+     * there is no baseline or no results to compare against.
+     */
+    bool costHasRegressed();
+
+    /**
+     * Tells the collection's PlanRegressionTracker that the plan whose stats are 'stats' was
+     * observed to examine 'costPerResult' keys and documents per result. No-op unless automatic
+     * pinning is enabled.
+     */
+    void recordObservedPlan(const PlanStageStats& stats, double costPerResult);
+
+    /**
+     * Called once replanning has picked the best plan of 'multiPlanStage'. If the winner examines
+     * more than 'internalQueryAutoPinRegressionRatio' times the keys and documents per result of
+     * the best plan observed for the query shape within the tracking window, pins the indexes of
+     * that plan as an automatic index filter. Otherwise records the winner as an observed plan.
+     */
+    void pinBestPlanIfRegressed(MultiPlanStage* multiPlanStage);
+
     /**
      * Uses the QueryPlanner and the MultiPlanStage to re-generate candidate plans for this
      * query and select a new winner.
@@ -129,6 +158,10 @@ private:
     // cached.
     size_t _decisionWorks;
 
+    // The keys plus documents examined per result by the plan when it was first cached. Zero if
+    // unknown, in which case the works budget alone decides whether to replan.
+    double _decisionCostPerResult;
+
     // If we fall back to re-planning the query, and there is just one resulting query solution,
     // that solution is owned here.
     std::unique_ptr<QuerySolution> _replannedQs;
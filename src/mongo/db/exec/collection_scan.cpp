@@ -33,6 +33,7 @@
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/filter.h"
+#include "mongo/db/exec/parallel_record_scanner.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
@@ -68,12 +69,32 @@ CollectionScan::CollectionScan(OperationContext* txn,
     _specificStats.direction = params.direction;
 }
 
+CollectionScan::~CollectionScan() {}
+
 PlanStage::StageState CollectionScan::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
+
+    return doWork(out);
+}
+
+PlanStage::StageState CollectionScan::workBatch(size_t maxWorks,
+                                                std::vector<WorkingSetID>* results,
+                                                WorkingSetID* out) {
+    ScopedTimer timer(&_commonStats);
+
+    return runWorkBatch(_workingSet, maxWorks, false, results, out, [this](WorkingSetID* id) {
+        return doWork(id);
+    });
+}
+
+bool CollectionScan::supportsWorkBatch() const {
+    return true;
+}
 
+PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
     if (_isDead) {
         Status status(
             ErrorCodes::CappedPositionLost,
@@ -92,12 +113,33 @@ PlanStage::StageState CollectionScan::work(WorkingSetID* out) {
         return PlanStage::IS_EOF;
     }
 
+    if (_scanner) {
+        return doWorkParallel(out);
+    }
+
     boost::optional<Record> record;
     const bool needToMakeCursor = !_cursor;
     try {
         if (needToMakeCursor) {
+            if (canScanInParallel()) {
+                auto cursors = _params.collection->getManyCursors(getOpCtx());
+                if (cursors.size() > 1) {
+                    _scanner = make_unique<ParallelRecordScanner>(
+                        std::move(cursors), _params.parallelism, _filter);
+                    _specificStats.workers = _scanner->numWorkers();
+                    _commonStats.needTime++;
+                    return PlanStage::NEED_TIME;
+                }
+            }
+
             const bool forward = _params.direction == CollectionScanParams::FORWARD;
             _cursor = _params.collection->getCursor(getOpCtx(), forward);
+            if (_params.zoneMapPredicate) {
+                _cursor->setZoneMapPredicate(_params.zoneMapPredicate);
+            }
+            if (_params.readahead) {
+                _cursor->setReadahead(*_params.readahead);
+            }
 
             if (!_lastSeenId.isNull()) {
                 invariant(_params.tailable);
@@ -174,6 +216,7 @@ PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
                                                       WorkingSetID memberID,
                                                       WorkingSetID* out) {
     ++_specificStats.docsTested;
+    _specificStats.docBytesTested += member->obj.value().objsize();
 
     if (Filter::passes(member, _filter)) {
         *out = memberID;
@@ -186,6 +229,48 @@ PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
     }
 }
 
+bool CollectionScan::canScanInParallel() const {
+    // Workers read from snapshots of their own, so they cannot honor a majority read concern.
+    return _params.parallelism > 1 && _params.direction == CollectionScanParams::FORWARD &&
+        !_params.tailable && _params.start.isNull() && 0 == _params.maxScan &&
+        !_params.collection->isCapped() &&
+        !getOpCtx()->recoveryUnit()->isReadingFromMajorityCommittedSnapshot();
+}
+
+PlanStage::StageState CollectionScan::doWorkParallel(WorkingSetID* out) {
+    RecordId id;
+    BSONObj obj;
+    const ParallelRecordScanner::NextState state = _scanner->next(&id, &obj);
+    _specificStats.docsTested = _scanner->docsTested();
+    _specificStats.docBytesTested = _scanner->docBytesTested();
+
+    switch (state) {
+        case ParallelRecordScanner::ADVANCED: {
+            WorkingSetID wsid = _workingSet->allocate();
+            WorkingSetMember* member = _workingSet->get(wsid);
+            member->loc = id;
+            // The document comes from a worker's snapshot rather than ours, so it is not tagged
+            // with our snapshot id. Anything that needs it to be current will fetch it again.
+            member->obj = {SnapshotId(), obj};
+            _workingSet->transitionToLocAndObj(wsid);
+            *out = wsid;
+            ++_commonStats.advanced;
+            return PlanStage::ADVANCED;
+        }
+        case ParallelRecordScanner::NOT_READY:
+            ++_commonStats.needTime;
+            return PlanStage::NEED_TIME;
+        case ParallelRecordScanner::IS_EOF:
+            _commonStats.isEOF = true;
+            return PlanStage::IS_EOF;
+        case ParallelRecordScanner::FAILED:
+            *out = WorkingSetCommon::allocateStatusMember(_workingSet, _scanner->getStatus());
+            return PlanStage::FAILURE;
+    }
+
+    MONGO_UNREACHABLE;
+}
+
 bool CollectionScan::isEOF() {
     return _commonStats.isEOF || _isDead;
 }
@@ -205,6 +290,9 @@ void CollectionScan::doInvalidate(OperationContext* txn,
     if (_cursor) {
         _cursor->invalidate(id);
     }
+    if (_scanner) {
+        _scanner->invalidate(id);
+    }
 
     if (_params.tailable && id == _lastSeenId) {
         // This means that deletes have caught up to the reader. We want to error in this case
@@ -217,6 +305,9 @@ void CollectionScan::doSaveState() {
     if (_cursor) {
         _cursor->save();
     }
+    if (_scanner) {
+        _scanner->save();
+    }
 }
 
 void CollectionScan::doRestoreState() {
@@ -227,6 +318,9 @@ void CollectionScan::doRestoreState() {
             _isDead = true;
         }
     }
+    if (_scanner) {
+        _scanner->restore();
+    }
 }
 
 void CollectionScan::doDetachFromOperationContext() {
@@ -37,6 +37,7 @@
 
 namespace mongo {
 
+class ParallelRecordScanner;
 class SeekableRecordCursor;
 class WorkingSet;
 class OperationContext;
@@ -54,7 +55,13 @@ public:
                    WorkingSet* workingSet,
                    const MatchExpression* filter);
 
+    ~CollectionScan();
+
     StageState work(WorkingSetID* out) final;
+    StageState workBatch(size_t maxWorks,
+                         std::vector<WorkingSetID>* results,
+                         WorkingSetID* out) final;
+    bool supportsWorkBatch() const final;
     bool isEOF() final;
 
     void doInvalidate(OperationContext* txn, const RecordId& dl, InvalidationType type) final;
@@ -74,6 +81,21 @@ public:
     static const char* kStageType;
 
 private:
+    /**
+     * Does the work of work(), which adds the stats and timing common to work() and workBatch().
+     */
+    StageState doWork(WorkingSetID* out);
+
+    /**
+     * Returns true if this scan may be split across threads by a ParallelRecordScanner.
+     */
+    bool canScanInParallel() const;
+
+    /**
+     * Does the work of doWork() once the scan has been handed to _scanner.
+     */
+    StageState doWorkParallel(WorkingSetID* out);
+
     /**
      * If the member (with id memberID) passes our filter, set *out to memberID and return that
      * ADVANCED.  Otherwise, free memberID and return NEED_TIME.
@@ -88,6 +110,9 @@ private:
 
     std::unique_ptr<SeekableRecordCursor> _cursor;
 
+    // Set instead of _cursor if the scan is split across threads.
+    std::unique_ptr<ParallelRecordScanner> _scanner;
+
     CollectionScanParams _params;
 
     bool _isDead;
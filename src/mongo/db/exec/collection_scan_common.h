@@ -28,11 +28,15 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
+#include <memory>
+
 #include "mongo/db/record_id.h"
 
 namespace mongo {
 
 class Collection;
+class ZoneMapPredicate;
 
 struct CollectionScanParams {
     enum Direction {
@@ -41,7 +45,12 @@ struct CollectionScanParams {
     };
 
     CollectionScanParams()
-        : collection(NULL), start(RecordId()), direction(FORWARD), tailable(false), maxScan(0) {}
+        : collection(NULL),
+          start(RecordId()),
+          direction(FORWARD),
+          tailable(false),
+          maxScan(0),
+          parallelism(1) {}
 
     // What collection?
     // not owned
@@ -58,6 +67,20 @@ struct CollectionScanParams {
 
     // If non-zero, how many documents will we look at?
     size_t maxScan;
+
+    // How far ahead of the cursor the storage engine should read, in engine-specific units
+    // (extents on MMAPv1). If unset, the storage engine's default applies; 0 disables readahead.
+    boost::optional<int> readahead;
+
+    // If set, blocks of records that the collection's zone map proves cannot satisfy this are
+    // skipped. The filter must still be applied to every record scanned.
+    std::shared_ptr<const ZoneMapPredicate> zoneMapPredicate;
+
+    // If greater than one, a forward scan over a collection which is not capped may be split across
+    // up to this many threads, which return records in no particular order. The filter must not
+    // depend on state which is unsafe to share between threads. Scans which are split this way do
+    // not use the zone map or readahead.
+    size_t parallelism;
 };
 
 }  // namespace mongo
@@ -31,8 +31,13 @@
 #include "mongo/db/exec/count.h"
 
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/catalog/index_catalog_entry.h"
+#include "mongo/db/exec/count_scan.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index/index_prefix_counts.h"
 #include "mongo/stdx/memory.h"
 
 namespace mongo {
@@ -58,6 +63,19 @@ CountStage::CountStage(OperationContext* txn,
         _children.emplace_back(child);
 }
 
+CountStage::CountStage(OperationContext* txn,
+                       Collection* collection,
+                       const CountRequest& request,
+                       WorkingSet* ws,
+                       const IndexDescriptor* countedIndex,
+                       const BSONObj& value)
+    : CountStage(txn, collection, request, ws, nullptr) {
+    invariant(collection);
+    _countedIndex = countedIndex;
+    _countedValue = value.getOwned();
+    _specificStats.countedIndex = countedIndex->indexName();
+}
+
 bool CountStage::isEOF() {
     if (_specificStats.trivialCount) {
         return true;
@@ -72,7 +90,21 @@ bool CountStage::isEOF() {
 
 void CountStage::trivialCount() {
     invariant(_collection);
-    long long nCounted = _collection->numRecords(getOpCtx());
+    setCountFromTotal(_collection->numRecords(getOpCtx()));
+    _specificStats.trivialCount = true;
+}
+
+void CountStage::countFromCountedIndex() {
+    const IndexPrefixCounts* prefixCounts =
+        _collection->getIndexCatalog()->getEntry(_countedIndex)->prefixCounts();
+    setCountFromTotal(_countedValue.isEmpty()
+                          ? prefixCounts->getTotal()
+                          : prefixCounts->getCount(_countedValue.firstElement()));
+    _specificStats.trivialCount = true;
+}
+
+void CountStage::setCountFromTotal(long long nMatched) {
+    long long nCounted = nMatched;
 
     if (0 != _request.getSkip()) {
         nCounted -= _request.getSkip();
@@ -92,14 +124,13 @@ void CountStage::trivialCount() {
 
     _specificStats.nCounted = nCounted;
     _specificStats.nSkipped = _request.getSkip();
-    _specificStats.trivialCount = true;
 }
 
 PlanStage::StageState CountStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     // This stage never returns a working set member.
     *out = WorkingSet::INVALID_ID;
@@ -111,6 +142,11 @@ PlanStage::StageState CountStage::work(WorkingSetID* out) {
         return PlanStage::IS_EOF;
     }
 
+    if (_countedIndex) {
+        countFromCountedIndex();
+        return PlanStage::IS_EOF;
+    }
+
     if (isEOF()) {
         _commonStats.isEOF = true;
         return PlanStage::IS_EOF;
@@ -119,6 +155,22 @@ PlanStage::StageState CountStage::work(WorkingSetID* out) {
     // For non-trivial counts, we should always have a child stage from which we can retrieve
     // results.
     invariant(child());
+
+    // A COUNT_SCAN over an index that keeps order statistics can give us the whole count at
+    // once instead of a result at a time.
+    if (!_triedRangeCount) {
+        _triedRangeCount = true;
+        if (STAGE_COUNT_SCAN == child()->stageType()) {
+            boost::optional<long long> nMatched =
+                static_cast<CountScan*>(child().get())->countFromIndexStatistics();
+            if (nMatched) {
+                setCountFromTotal(*nMatched);
+                _commonStats.isEOF = true;
+                return PlanStage::IS_EOF;
+            }
+        }
+    }
+
     WorkingSetID id = WorkingSet::INVALID_ID;
     PlanStage::StageState state = child()->work(&id);
 
@@ -34,6 +34,8 @@
 
 namespace mongo {
 
+class IndexDescriptor;
+
 /**
  * Stage used by the count command. This stage sits at the root of a plan tree
  * and counts the number of results returned by its child stage.
@@ -53,6 +55,18 @@ public:
                WorkingSet* ws,
                PlanStage* child);
 
+    /**
+     * Answers the count from the document counts of 'countedIndex', without a child: the number
+     * of documents whose keys start with the only field of 'value', or all of the index's
+     * documents if 'value' is empty.
+     */
+    CountStage(OperationContext* txn,
+               Collection* collection,
+               const CountRequest& request,
+               WorkingSet* ws,
+               const IndexDescriptor* countedIndex,
+               const BSONObj& value);
+
     bool isEOF() final;
     StageState work(WorkingSetID* out) final;
 
@@ -73,6 +87,17 @@ private:
      */
     void trivialCount();
 
+    /**
+     * Computes the count from the counts of '_countedIndex', applying the skip and limit.
+     */
+    void countFromCountedIndex();
+
+    /**
+     * Stores 'nMatched' in '_specificStats' as the count after applying the request's skip and
+     * limit.
+     */
+    void setCountFromTotal(long long nMatched);
+
     // The collection over which we are counting.
     Collection* _collection;
 
@@ -81,6 +106,13 @@ private:
     // The number of documents that we still need to skip.
     long long _leftToSkip;
 
+    // Whether we have asked a COUNT_SCAN child to count from index statistics yet.
+    bool _triedRangeCount = false;
+
+    // If not NULL, the counted index to answer from, and the value to look up in it.
+    const IndexDescriptor* _countedIndex = nullptr;
+    BSONObj _countedValue;
+
     // The working set used to pass intermediate results between stages. Not owned
     // by us.
     WorkingSet* _ws;
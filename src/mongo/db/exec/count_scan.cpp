@@ -70,7 +70,7 @@ PlanStage::StageState CountScan::work(WorkingSetID* out) {
         return PlanStage::IS_EOF;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     boost::optional<IndexKeyEntry> entry;
     const bool needInit = !_cursor;
@@ -119,6 +119,28 @@ bool CountScan::isEOF() {
     return _commonStats.isEOF;
 }
 
+boost::optional<long long> CountScan::countFromIndexStatistics() {
+    invariant(!_cursor);
+    if (_commonStats.isEOF)
+        return boost::none;
+
+    // A multikey index may hold several keys for one document, and counting keys in a range
+    // cannot dedup them.
+    if (_shouldDedup)
+        return boost::none;
+
+    boost::optional<long long> count = _iam->countRange(getOpCtx(),
+                                                        _params.startKey,
+                                                        _params.startKeyInclusive,
+                                                        _params.endKey,
+                                                        _params.endKeyInclusive);
+    if (count) {
+        _specificStats.usedRangeCount = true;
+        _commonStats.isEOF = true;
+    }
+    return count;
+}
+
 void CountScan::doSaveState() {
     if (_cursor)
         _cursor->save();
@@ -84,6 +84,16 @@ public:
 
     const SpecificStats* getSpecificStats() const final;
 
+    /**
+     * Asks the index how many keys lie within the scan's bounds, which storage engines that keep
+     * order statistics can answer without walking the keys. If this returns a count, that is
+     * the number of results this stage would have produced and the stage is then EOF. Returns
+     * boost::none, leaving the stage untouched, if the scan has to be done by work().
+     *
+     * Must be called before the first call to work().
+     */
+    boost::optional<long long> countFromIndexStatistics();
+
     static const char* kStageType;
 
 private:
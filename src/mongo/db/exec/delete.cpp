@@ -39,6 +39,7 @@
 #include "mongo/db/service_context.h"
 #include "mongo/db/op_observer.h"
 #include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
@@ -50,6 +51,16 @@ using std::unique_ptr;
 using std::vector;
 using stdx::make_unique;
 
+namespace {
+size_t getBatchSize(const DeleteStageParams& params) {
+    if (!params.isMulti || params.returnDeleted || params.isExplain || !supportsDocLocking() ||
+        internalQueryExecWriteBatchSize <= 1) {
+        return 1;
+    }
+    return internalQueryExecWriteBatchSize;
+}
+}  // namespace
+
 // static
 const char* DeleteStage::kStageType = "DELETE";
 
@@ -63,6 +74,7 @@ DeleteStage::DeleteStage(OperationContext* txn,
       _ws(ws),
       _collection(collection),
       _idRetrying(WorkingSet::INVALID_ID),
+      _batchSize(getBatchSize(params)),
       _idReturning(WorkingSet::INVALID_ID) {
     _children.emplace_back(child);
 }
@@ -74,15 +86,18 @@ bool DeleteStage::isEOF() {
     if (!_params.isMulti && _specificStats.docsDeleted > 0) {
         return true;
     }
+    if (_params.limit > 0 && static_cast<long long>(_specificStats.docsDeleted) >= _params.limit) {
+        return true;
+    }
     return _idRetrying == WorkingSet::INVALID_ID && _idReturning == WorkingSet::INVALID_ID &&
-        child()->isEOF();
+        _batch.empty() && _idsRetrying.empty() && child()->isEOF();
 }
 
 PlanStage::StageState DeleteStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     if (isEOF()) {
         return PlanStage::IS_EOF;
@@ -107,12 +122,22 @@ PlanStage::StageState DeleteStage::work(WorkingSetID* out) {
     // Either retry the last WSM we worked on or get a new one from our child.
     WorkingSetID id;
     StageState status;
-    if (_idRetrying == WorkingSet::INVALID_ID) {
-        status = child()->work(&id);
-    } else {
+    bool fromChild = false;
+    if (_idRetrying != WorkingSet::INVALID_ID) {
         status = ADVANCED;
         id = _idRetrying;
         _idRetrying = WorkingSet::INVALID_ID;
+    } else if (!_idsRetrying.empty()) {
+        status = ADVANCED;
+        id = _idsRetrying.front();
+        _idsRetrying.pop_front();
+    } else {
+        status = child()->work(&id);
+        fromChild = true;
+    }
+
+    if (PlanStage::IS_EOF == status && !_batch.empty()) {
+        return deleteBatch(out);
     }
 
     if (PlanStage::ADVANCED == status) {
@@ -133,6 +158,21 @@ PlanStage::StageState DeleteStage::work(WorkingSetID* out) {
         // a fetch. We should always get fetched data, and never just key data.
         invariant(member->hasObj());
 
+        if (fromChild && _batchSize > 1) {
+            // The batch may be deleted after a yield, which is allowed to free the memory.
+            member->makeObjOwnedIfNeeded();
+            memberFreer.Dismiss();
+            _batch.push_back(id);
+            if (_batch.size() >= _batchSize ||
+                (_params.limit > 0 &&
+                 static_cast<long long>(_specificStats.docsDeleted + _batch.size()) >=
+                     _params.limit)) {
+                return deleteBatch(out);
+            }
+            ++_commonStats.needTime;
+            return PlanStage::NEED_TIME;
+        }
+
         try {
             // If the snapshot changed, then we have to make sure we have the latest copy of the
             // doc and that it still matches.
@@ -261,6 +301,74 @@ PlanStage::StageState DeleteStage::work(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState DeleteStage::deleteBatch(WorkingSetID* out) {
+    invariant(!_batch.empty());
+
+    try {
+        WorkingSetCommon::prepareForSnapshotChange(_ws);
+        child()->saveState();
+    } catch (const WriteConflictException& wce) {
+        std::terminate();
+    }
+
+    size_t numDeleted = 0;
+    try {
+        WriteUnitOfWork wunit(getOpCtx());
+        std::unique_ptr<SeekableRecordCursor> cursor;
+        for (WorkingSetID id : _batch) {
+            WorkingSetMember* member = _ws->get(id);
+
+            // If the snapshot changed since the document was read, make sure it still exists
+            // and still matches.
+            if (getOpCtx()->recoveryUnit()->getSnapshotId() != member->obj.snapshotId()) {
+                if (!cursor) {
+                    cursor = _collection->getCursor(getOpCtx());
+                }
+                if (!WorkingSetCommon::fetch(getOpCtx(), _ws, id, cursor)) {
+                    continue;
+                }
+                if (_params.canonicalQuery &&
+                    !_params.canonicalQuery->root()->matchesBSON(member->obj.value(), NULL)) {
+                    continue;
+                }
+            }
+
+            _collection->deleteDocument(getOpCtx(), member->loc);
+            ++numDeleted;
+        }
+        wunit.commit();
+    } catch (const WriteConflictException& wce) {
+        // Retry each document in its own WriteUnitOfWork: they are re-fetched after the yield.
+        for (WorkingSetID id : _batch) {
+            _ws->get(id)->makeObjOwnedIfNeeded();
+            _idsRetrying.push_back(id);
+        }
+        _batch.clear();
+        *out = WorkingSet::INVALID_ID;
+        _commonStats.needYield++;
+        return NEED_YIELD;
+    }
+
+    _specificStats.docsDeleted += numDeleted;
+    for (WorkingSetID id : _batch) {
+        _ws->free(id);
+    }
+    _batch.clear();
+
+    // Restore outside of the WriteUnitOfWork, as in the single document case.
+    try {
+        child()->restoreState();
+    } catch (const WriteConflictException& wce) {
+        // The deletes were committed, so there is nothing to retry.
+        *out = WorkingSet::INVALID_ID;
+        _commonStats.needYield++;
+        return NEED_YIELD;
+    }
+
+    ++_commonStats.needTime;
+    return PlanStage::NEED_TIME;
+}
+
 void DeleteStage::doRestoreState() {
     const NamespaceString& ns(_collection->ns());
     massert(28537,
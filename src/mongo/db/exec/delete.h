@@ -29,6 +29,9 @@
 #pragma once
 
 
+#include <deque>
+#include <vector>
+
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/jsobj.h"
 
@@ -44,6 +47,7 @@ struct DeleteStageParams {
           fromMigrate(false),
           isExplain(false),
           returnDeleted(false),
+          limit(0),
           canonicalQuery(NULL) {}
 
     // Should we delete all documents returned from the child (a "multi delete"), or at most one
@@ -60,6 +64,9 @@ struct DeleteStageParams {
     // Should we return the document we just deleted?
     bool returnDeleted;
 
+    // If positive, a multi delete stops once it has deleted this many documents.
+    long long limit;
+
     // The parsed query predicate for this delete. Not owned here.
     CanonicalQuery* canonicalQuery;
 };
@@ -69,6 +76,10 @@ struct DeleteStageParams {
  * document was requested to be returned, then ADVANCED is returned after deleting a document.
  * Otherwise, NEED_TIME is returned after deleting a document.
  *
+ * A multi delete on a storage engine with document-level locking collects up to
+ * internalQueryExecWriteBatchSize documents and deletes them in one WriteUnitOfWork. If that
+ * hits a WriteConflictException, the documents are retried one per WriteUnitOfWork.
+ *
  * Callers of work() must be holding a write lock (and, for replicated deletes, callers must have
  * had the replication coordinator approve the write).
  */
@@ -105,6 +116,12 @@ public:
     static long long getNumDeleted(const PlanExecutor& exec);
 
 private:
+    /**
+     * Deletes the documents in '_batch' in one WriteUnitOfWork, or moves them to
+     * '_idsRetrying' if that throws a WriteConflictException.
+     */
+    StageState deleteBatch(WorkingSetID* out);
+
     DeleteStageParams _params;
 
     // Not owned by us.
@@ -118,6 +135,17 @@ private:
     // If not WorkingSet::INVALID_ID, we use this rather than asking our child what to do next.
     WorkingSetID _idRetrying;
 
+    // How many documents to delete per WriteUnitOfWork. Only multi deletes that don't return
+    // the deleted documents use more than one.
+    const size_t _batchSize;
+
+    // Members from our child that are waiting to be deleted as a batch.
+    std::vector<WorkingSetID> _batch;
+
+    // Members of a batch that failed with a WriteConflictException. Each is retried on its own
+    // before we ask our child for more.
+    std::deque<WorkingSetID> _idsRetrying;
+
     // If not WorkingSet::INVALID_ID, we return this member to our caller.
     WorkingSetID _idReturning;
 
@@ -73,7 +73,7 @@ PlanStage::StageState DistinctScan::work(WorkingSetID* out) {
         return PlanStage::IS_EOF;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     boost::optional<IndexKeyEntry> kv;
     try {
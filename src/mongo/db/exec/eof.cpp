@@ -53,7 +53,7 @@ bool EOFStage::isEOF() {
 PlanStage::StageState EOFStage::work(WorkingSetID* out) {
     ++_commonStats.works;
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
     return PlanStage::IS_EOF;
 }
 
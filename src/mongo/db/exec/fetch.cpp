@@ -30,11 +30,14 @@
 
 #include "mongo/db/exec/fetch.h"
 
+#include <algorithm>
+
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
@@ -58,7 +61,8 @@ FetchStage::FetchStage(OperationContext* txn,
       _collection(collection),
       _ws(ws),
       _filter(filter),
-      _idRetrying(WorkingSet::INVALID_ID) {
+      _idRetrying(WorkingSet::INVALID_ID),
+      _batchSize(std::max(1, internalQueryExecFetchBatchSize)) {
     _children.emplace_back(child);
 }
 
@@ -71,24 +75,51 @@ bool FetchStage::isEOF() {
         return false;
     }
 
-    return child()->isEOF();
+    if (!_buffered.empty()) {
+        return false;
+    }
+
+    return childIsEOF();
 }
 
 PlanStage::StageState FetchStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
+
+    return doWork(out);
+}
+
+PlanStage::StageState FetchStage::workBatch(size_t maxWorks,
+                                            std::vector<WorkingSetID>* results,
+                                            WorkingSetID* out) {
+    ScopedTimer timer(&_commonStats);
+
+    pullChildBatch(maxWorks);
+    return runWorkBatch(_ws, maxWorks, true, results, out, [this](WorkingSetID* id) {
+        return doWork(id);
+    });
+}
 
+bool FetchStage::supportsWorkBatch() const {
+    return child()->supportsWorkBatch();
+}
+
+PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
     if (isEOF()) {
         return PlanStage::IS_EOF;
     }
 
+    if (_batchSize > 1) {
+        return doWorkBatched(out);
+    }
+
     // Either retry the last WSM we worked on or get a new one from our child.
     WorkingSetID id;
     StageState status;
     if (_idRetrying == WorkingSet::INVALID_ID) {
-        status = child()->work(&id);
+        status = workChild(&id);
     } else {
         status = ADVANCED;
         id = _idRetrying;
@@ -139,7 +170,129 @@ PlanStage::StageState FetchStage::work(WorkingSetID* out) {
         }
 
         return returnIfMatches(member, id, out);
-    } else if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
+    }
+
+    return passUpChildState(status, id, out);
+}
+
+PlanStage::StageState FetchStage::doWorkBatched(WorkingSetID* out) {
+    if (kReturning == _batchState) {
+        const WorkingSetID id = _buffered[_numReturned++];
+
+        // Start a new batch once this one has been handed out.
+        if (_numReturned == _buffered.size()) {
+            _buffered.clear();
+            _numReturned = 0;
+            _batchState = kFilling;
+        }
+
+        return returnIfMatches(_ws->get(id), id, out);
+    }
+
+    if (kFetching == _batchState) {
+        return fetchBuffered(out);
+    }
+
+    WorkingSetID id;
+    StageState status = workChild(&id);
+    if (PlanStage::ADVANCED == status) {
+        WorkingSetMember* member = _ws->get(id);
+        if (member->hasObj()) {
+            // The object must outlive our child moving on to its next result.
+            member->makeObjOwnedIfNeeded();
+            ++_specificStats.alreadyHasObj;
+        } else {
+            // We need a valid loc to fetch from and this is the only state that has one.
+            verify(WorkingSetMember::LOC_AND_IDX == member->getState());
+            verify(member->hasLoc());
+        }
+
+        _buffered.push_back(id);
+        if (_buffered.size() < _batchSize) {
+            ++_commonStats.needTime;
+            return PlanStage::NEED_TIME;
+        }
+    } else if (PlanStage::IS_EOF != status || _buffered.empty()) {
+        return passUpChildState(status, id, out);
+    }
+
+    // The batch is full, or there is nothing more to add to it. Look up everything which needs
+    // it in RecordId order.
+    for (size_t i = 0; i < _buffered.size(); ++i) {
+        if (!_ws->get(_buffered[i])->hasObj()) {
+            _fetchOrder.push_back(i);
+        }
+    }
+    std::sort(_fetchOrder.begin(), _fetchOrder.end(), [this](size_t lhs, size_t rhs) {
+        return _ws->get(_buffered[lhs])->loc < _ws->get(_buffered[rhs])->loc;
+    });
+
+    ++_specificStats.fetchBatches;
+    _batchState = kFetching;
+    return fetchBuffered(out);
+}
+
+PlanStage::StageState FetchStage::fetchBuffered(WorkingSetID* out) {
+    WorkingSetMember* member = NULL;
+    try {
+        if (!_cursor)
+            _cursor = _collection->getCursor(getOpCtx());
+
+        for (; _numFetched < _fetchOrder.size(); ++_numFetched) {
+            const size_t slot = _fetchOrder[_numFetched];
+            const WorkingSetID id = _buffered[slot];
+            member = _ws->get(id);
+
+            // An invalidation may have forced the fetch already.
+            if (member->hasObj()) {
+                continue;
+            }
+
+            if (auto fetcher = _cursor->fetcherForId(member->loc)) {
+                // Pass up a fetch request. We will try this member again afterwards.
+                member->setFetcher(fetcher.release());
+                *out = id;
+                _commonStats.needYield++;
+                return NEED_YIELD;
+            }
+
+            if (!WorkingSetCommon::fetch(getOpCtx(), _ws, id, _cursor)) {
+                _ws->free(id);
+                _buffered[slot] = WorkingSet::INVALID_ID;
+                continue;
+            }
+
+            // The next lookup reuses the cursor, which may invalidate an unowned object.
+            member->makeObjOwnedIfNeeded();
+        }
+    } catch (const WriteConflictException& wce) {
+        // Ensure that the BSONObj underlying the WorkingSetMember is owned because it may be
+        // freed when we yield. We will try this member again afterwards.
+        if (member) {
+            member->makeObjOwnedIfNeeded();
+        }
+        *out = WorkingSet::INVALID_ID;
+        _commonStats.needYield++;
+        return NEED_YIELD;
+    }
+
+    // Drop the slots of members which were deleted before we could look them up.
+    _buffered.erase(std::remove_if(_buffered.begin(),
+                                   _buffered.end(),
+                                   [](WorkingSetID id) { return WorkingSet::INVALID_ID == id; }),
+                    _buffered.end());
+    _fetchOrder.clear();
+    _numFetched = 0;
+    _batchState = _buffered.empty() ? kFilling : kReturning;
+
+    ++_commonStats.needTime;
+    return PlanStage::NEED_TIME;
+}
+
+PlanStage::StageState FetchStage::passUpChildState(StageState status,
+                                                   WorkingSetID id,
+                                                   WorkingSetID* out) {
+    if (PlanStage::FAILURE == status || PlanStage::DEAD == status) {
         *out = id;
         // If a stage fails, it may create a status WSM to indicate why it
         // failed, in which case 'id' is valid.  If ID is invalid, we
@@ -191,6 +344,21 @@ void FetchStage::doInvalidate(OperationContext* txn, const RecordId& dl, Invalid
             WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
         }
     }
+
+    // The same goes for any buffered results which we haven't returned yet...
+    for (size_t i = _numReturned; i < _buffered.size(); ++i) {
+        if (WorkingSet::INVALID_ID == _buffered[i]) {
+            continue;
+        }
+        WorkingSetMember* member = _ws->get(_buffered[i]);
+        if (member->hasLoc() && (member->loc == dl)) {
+            WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
+            ++_specificStats.forcedFetches;
+        }
+    }
+
+    // ...and for any of the child's batched results.
+    _childBatch.invalidate(txn, _ws, _collection, dl);
 }
 
 PlanStage::StageState FetchStage::returnIfMatches(WorkingSetMember* member,
@@ -211,6 +379,7 @@ PlanStage::StageState FetchStage::returnIfMatches(WorkingSetMember* member,
     // "restaurant". The planner will add a second fetch stage to filter by this non-geo
     // predicate.
     ++_specificStats.docsExamined;
+    _specificStats.docBytesExamined += member->obj.value().objsize();
 
     if (Filter::passes(member, _filter)) {
         *out = memberID;
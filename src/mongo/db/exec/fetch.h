@@ -29,6 +29,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/jsobj.h"
@@ -45,6 +46,10 @@ class SeekableRecordCursor;
  * In WorkingSetMember terms, it transitions from LOC_AND_IDX to LOC_AND_OBJ by reading
  * the record at the provided loc.  Returns verbatim any data that already has an object.
  *
+ * If internalQueryExecFetchBatchSize is greater than one, the stage buffers that many of its
+ * child's results, looks their RecordIds up in RecordId order so the storage engine reads them
+ * with as much locality as it can, and then returns them in the order the child produced them.
+ *
  * Preconditions: Valid RecordId.
  */
 class FetchStage : public PlanStage {
@@ -59,6 +64,10 @@ public:
 
     bool isEOF() final;
     StageState work(WorkingSetID* out) final;
+    StageState workBatch(size_t maxWorks,
+                         std::vector<WorkingSetID>* results,
+                         WorkingSetID* out) final;
+    bool supportsWorkBatch() const final;
 
     void doSaveState() final;
     void doRestoreState() final;
@@ -77,12 +86,44 @@ public:
     static const char* kStageType;
 
 private:
+    /**
+     * Does the work of work(), which adds the stats and timing common to work() and workBatch().
+     */
+    StageState doWork(WorkingSetID* out);
+
     /**
      * If the member (with id memberID) passes our filter, set *out to memberID and return that
      * ADVANCED.  Otherwise, free memberID and return NEED_TIME.
      */
     StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID, WorkingSetID* out);
 
+    /**
+     * Does the work of doWork() when lookups are batched.
+     */
+    StageState doWorkBatched(WorkingSetID* out);
+
+    /**
+     * Looks up the buffered members which don't have an object yet, in RecordId order. Picks up
+     * where it left off if it had to yield.
+     */
+    StageState fetchBuffered(WorkingSetID* out);
+
+    /**
+     * Passes a non-ADVANCED state of our child up to our parent.
+     */
+    StageState passUpChildState(StageState status, WorkingSetID id, WorkingSetID* out);
+
+    enum BatchState {
+        // Buffering results from the child.
+        kFilling,
+
+        // Looking up the buffered results.
+        kFetching,
+
+        // Returning the buffered results.
+        kReturning,
+    };
+
     // Collection which is used by this stage. Used to resolve record ids retrieved by child
     // stages. The lifetime of the collection must supersede that of the stage.
     const Collection* _collection;
@@ -98,6 +139,22 @@ private:
     // If not Null, we use this rather than asking our child what to do next.
     WorkingSetID _idRetrying;
 
+    // How many of the child's results to look up together. 1 disables batching.
+    const size_t _batchSize;
+
+    BatchState _batchState = kFilling;
+
+    // The buffered results, in the order the child produced them. While fetching, the slots of
+    // members which turned out to have been deleted are set to WorkingSet::INVALID_ID.
+    std::vector<WorkingSetID> _buffered;
+
+    // The slots of _buffered in RecordId order, and how many of them have been looked up.
+    std::vector<size_t> _fetchOrder;
+    size_t _numFetched = 0;
+
+    // How many slots of _buffered have been returned.
+    size_t _numReturned = 0;
+
     // Stats
     FetchStats _specificStats;
 };
@@ -50,6 +50,13 @@ public:
         return _wsm->obj.value();
     }
 
+    bool iteratesOverBSON(BSONObj* obj) const final {
+        if (!_wsm->hasObj())
+            return false;
+        *obj = _wsm->obj.value();
+        return true;
+    }
+
     ElementIterator* allocateIterator(const ElementPath* path) const final {
         // BSONElementIterator does some interesting things with arrays that I don't think
         // SimpleArrayElementIterator does.
@@ -45,9 +45,12 @@
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/query/expression_index.h"
 #include "mongo/db/query/expression_index_knobs.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/log.h"
 
 #include <algorithm>
+#include <map>
+#include <tuple>
 
 namespace mongo {
 
@@ -785,8 +788,111 @@ S2Region* buildS2Region(const R2Annulus& sphereBounds) {
     // Takes ownership of caps
     return new S2RegionIntersection(&regions);
 }
+
+/**
+ * Coverings of geoNear annuli, so that repeated queries around the same point, which search the
+ * same annuli as long as the data near it does not change, do not cover them again. The cache is
+ * emptied when it fills up.
+ */
+class S2CoveringCache {
+public:
+    bool get(const R2Annulus& bounds, std::vector<S2CellId>* cover) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        const auto it = _coverings.find(makeKey(bounds));
+        if (it == _coverings.end()) {
+            return false;
+        }
+        *cover = it->second;
+        return true;
+    }
+
+    void put(const R2Annulus& bounds, const std::vector<S2CellId>& cover) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_coverings.size() >= static_cast<size_t>(internalQueryS2GeoNearCoveringCacheSize)) {
+            _coverings.clear();
+        }
+        _coverings[makeKey(bounds)] = cover;
+    }
+
+private:
+    // The annulus and the knobs its covering was computed with.
+    typedef std::tuple<double, double, double, double, int, int, int> Key;
+
+    static Key makeKey(const R2Annulus& bounds) {
+        return std::make_tuple(bounds.center().x,
+                               bounds.center().y,
+                               bounds.getInner(),
+                               bounds.getOuter(),
+                               internalQueryS2GeoCoarsestLevel,
+                               internalQueryS2GeoFinestLevel,
+                               internalQueryS2GeoMaxCells);
+    }
+
+    stdx::mutex _mutex;
+    std::map<Key, std::vector<S2CellId>> _coverings;
+};
+
+S2CoveringCache s2CoveringCache;
+
+std::vector<S2CellId> getS2Covering(const R2Annulus& bounds, const S2Region& region) {
+    if (internalQueryS2GeoNearCoveringCacheSize <= 0) {
+        return ExpressionMapping::get2dsphereCovering(region);
+    }
+
+    std::vector<S2CellId> cover;
+    if (!s2CoveringCache.get(bounds, &cover)) {
+        cover = ExpressionMapping::get2dsphereCovering(region);
+        s2CoveringCache.put(bounds, cover);
+    }
+    return cover;
+}
+
+// The area of the spherical cap of the given radius, in square meters.
+double capArea(double radius) {
+    const double angle = std::min(radius / kRadiusOfEarthInMeters, M_PI);
+    return 2 * M_PI * kRadiusOfEarthInMeters * kRadiusOfEarthInMeters * (1 - cos(angle));
+}
+
+// The radius of the spherical cap of the given area, in meters.
+double capRadius(double area) {
+    const double cosAngle = 1 - area / (2 * M_PI * kRadiusOfEarthInMeters * kRadiusOfEarthInMeters);
+    return acos(std::max(-1.0, std::min(1.0, cosAngle))) * kRadiusOfEarthInMeters;
 }
 
+/**
+ * Returns how far past 'lastBounds' the next annulus should reach for it to hold about
+ * internalQueryS2GeoNearTargetIntervalResults documents, when the density of documents in
+ * 'lastBounds', in which 'lastIntervalStats' were found, carries on outwards.
+ *
+ * The increment grows at most 8 times over, and shrinks at most to 1/8th, the last increment
+ * 'boundsIncrement', so that an annulus holding very few documents does not throw the estimate
+ * off. The increment quadruples past an annulus without documents at all.
+ */
+double nextS2BoundsIncrement(const R2Annulus& lastBounds,
+                             const IntervalStats& lastIntervalStats,
+                             double boundsIncrement) {
+    const double kMaxChange = 8;
+
+    if (lastIntervalStats.numResultsBuffered <= 0) {
+        return boundsIncrement * 4;
+    }
+
+    const double inner = std::max(0.0, lastBounds.getInner());
+    const double outer = lastBounds.getOuter();
+    const double scannedArea = capArea(outer) - capArea(inner);
+    if (scannedArea <= 0) {
+        return boundsIncrement * 2;
+    }
+
+    const double density = lastIntervalStats.numResultsBuffered / scannedArea;
+    const double targetArea = std::max(1, internalQueryS2GeoNearTargetIntervalResults) / density;
+    const double increment = capRadius(capArea(outer) + targetArea) - outer;
+
+    return std::max(boundsIncrement / kMaxChange,
+                    std::min(boundsIncrement * kMaxChange, increment));
+}
+}  // namespace
+
 // Estimate the density of data by search the nearest cells level by level around center.
 class GeoNear2DSphereStage::DensityEstimator {
 public:
@@ -946,13 +1052,11 @@ StatusWith<NearStage::CoveredInterval*>  //
     //
 
     if (!_specificStats.intervalStats.empty()) {
-        const IntervalStats& lastIntervalStats = _specificStats.intervalStats.back();
-
-        // TODO: Generally we want small numbers of results fast, then larger numbers later
-        if (lastIntervalStats.numResultsReturned < 300)
-            _boundsIncrement *= 2;
-        else if (lastIntervalStats.numResultsReturned > 600)
-            _boundsIncrement /= 2;
+        // Size the next annulus after the density of documents in the last one, rather than
+        // doubling it, so that sparse data is not searched in many small annuli and dense data
+        // is not fetched in huge ones.
+        _boundsIncrement = nextS2BoundsIncrement(
+            _currBounds, _specificStats.intervalStats.back(), _boundsIncrement);
     }
 
     invariant(_boundsIncrement > 0.0);
@@ -983,9 +1087,11 @@ StatusWith<NearStage::CoveredInterval*>  //
     scanParams.bounds.fields[s2FieldPosition].intervals.clear();
     std::unique_ptr<S2Region> region(buildS2Region(_currBounds));
 
-    std::vector<S2CellId> cover = ExpressionMapping::get2dsphereCovering(*region);
+    std::vector<S2CellId> cover = getS2Covering(_currBounds, *region);
 
-    // Generate a covering that does not intersect with any previous coverings
+    // Generate a covering that does not intersect with any previous coverings. The cells of
+    // previous coverings that reach into this annulus have been scanned already, and the
+    // documents in them beyond the previous annuli are still buffered.
     S2CellUnion coverUnion;
     coverUnion.InitSwap(&cover);
     invariant(cover.empty());
@@ -199,7 +199,7 @@ StatusWith<BSONObj> GroupStage::finalizeResults() {
 PlanStage::StageState GroupStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     if (isEOF()) {
         return PlanStage::IS_EOF;
@@ -105,7 +105,7 @@ PlanStage::StageState IDHackStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     if (_done) {
         return PlanStage::IS_EOF;
@@ -32,6 +32,8 @@
 
 #include "mongo/db/exec/index_scan.h"
 
+#include <algorithm>
+
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
@@ -71,7 +73,11 @@ IndexScan::IndexScan(OperationContext* txn,
       _shouldDedup(true),
       _forward(params.direction == 1),
       _params(params),
-      _endKeyInclusive(false) {
+      _endKeyInclusive(false),
+      _numPointScansStarted(0),
+      _currentPointScan(NULL),
+      _currentPointScanTaken(false),
+      _cursorPointScan(NULL) {
     // We can't always access the descriptor in the call to getStats() so we pull
     // any info we need for stats reporting out here.
     _specificStats.keyPattern = _keyPattern;
@@ -81,9 +87,10 @@ IndexScan::IndexScan(OperationContext* txn,
     _specificStats.isSparse = _params.descriptor->isSparse();
     _specificStats.isPartial = _params.descriptor->isPartial();
     _specificStats.indexVersion = _params.descriptor->version();
+    _specificStats.isSkipScan = _params.skipScan;
 }
 
-boost::optional<IndexKeyEntry> IndexScan::initIndexScan() {
+void IndexScan::initIndexCursor() {
     if (_params.doNotDedup) {
         _shouldDedup = false;
     } else {
@@ -93,6 +100,10 @@ boost::optional<IndexKeyEntry> IndexScan::initIndexScan() {
 
     // Perform the possibly heavy-duty initialization of the underlying index cursor.
     _indexCursor = _iam->newCursor(getOpCtx(), _forward);
+}
+
+boost::optional<IndexKeyEntry> IndexScan::initIndexScan() {
+    initIndexCursor();
 
     if (_params.bounds.isSimpleRange) {
         // Start at one key, end at another.
@@ -125,7 +136,29 @@ PlanStage::StageState IndexScan::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
+
+    return doWork(out);
+}
+
+PlanStage::StageState IndexScan::workBatch(size_t maxWorks,
+                                           std::vector<WorkingSetID>* results,
+                                           WorkingSetID* out) {
+    ScopedTimer timer(&_commonStats);
+
+    return runWorkBatch(_workingSet, maxWorks, false, results, out, [this](WorkingSetID* id) {
+        return doWork(id);
+    });
+}
+
+bool IndexScan::supportsWorkBatch() const {
+    return true;
+}
+
+PlanStage::StageState IndexScan::doWork(WorkingSetID* out) {
+    if (_params.mergedPrefixFields > 0) {
+        return doMergedWork(out);
+    }
 
     // Get the next kv pair from the index, if any.
     boost::optional<IndexKeyEntry> kv;
@@ -175,6 +208,7 @@ PlanStage::StageState IndexScan::work(WorkingSetID* out) {
                 break;
 
             case IndexBoundsChecker::MUST_ADVANCE:
+                ++_specificStats.seeks;
                 _scanState = NEED_SEEK;
                 _commonStats.needTime++;
                 return PlanStage::NEED_TIME;
@@ -190,9 +224,13 @@ PlanStage::StageState IndexScan::work(WorkingSetID* out) {
 
     _scanState = GETTING_NEXT;
 
+    return returnKey(*kv, out);
+}
+
+PlanStage::StageState IndexScan::returnKey(const IndexKeyEntry& kv, WorkingSetID* out) {
     if (_shouldDedup) {
         ++_specificStats.dupsTested;
-        if (!_returned.insert(kv->loc).second) {
+        if (!_returned.insert(kv.loc).second) {
             // We've seen this RecordId before. Skip it this time.
             ++_specificStats.dupsDropped;
             ++_commonStats.needTime;
@@ -201,25 +239,22 @@ PlanStage::StageState IndexScan::work(WorkingSetID* out) {
     }
 
     if (_filter) {
-        if (!Filter::passes(kv->key, _keyPattern, _filter)) {
+        if (!Filter::passes(kv.key, _keyPattern, _filter)) {
             ++_commonStats.needTime;
             return PlanStage::NEED_TIME;
         }
     }
 
-    if (!kv->key.isOwned())
-        kv->key = kv->key.getOwned();
-
     // We found something to return, so fill out the WSM.
     WorkingSetID id = _workingSet->allocate();
     WorkingSetMember* member = _workingSet->get(id);
-    member->loc = kv->loc;
-    member->keyData.push_back(IndexKeyDatum(_keyPattern, kv->key, _iam));
+    member->loc = kv.loc;
+    member->keyData.push_back(IndexKeyDatum(_keyPattern, member->ownedCopy(kv.key), _iam));
     _workingSet->transitionToLocAndIdx(id);
 
     if (_params.addKeyMetadata) {
         BSONObjBuilder bob;
-        bob.appendKeys(_keyPattern, kv->key);
+        bob.appendKeys(_keyPattern, kv.key);
         member->addComputed(new IndexKeyComputedData(bob.obj()));
     }
 
@@ -228,6 +263,216 @@ PlanStage::StageState IndexScan::work(WorkingSetID* out) {
     return PlanStage::ADVANCED;
 }
 
+PlanStage::StageState IndexScan::doMergedWork(WorkingSetID* out) {
+    if (HIT_END == _scanState) {
+        return PlanStage::IS_EOF;
+    }
+
+    // Orders '_pointScanHeap' so that the scan whose next key comes first is at its front.
+    const auto comesAfter = [this](const PointScan* lhs, const PointScan* rhs) {
+        return compareMergedKeys(lhs->next->key, rhs->next->key) > 0;
+    };
+
+    try {
+        if (INITIALIZING == _scanState) {
+            initIndexCursor();
+            initPointScans();
+            _scanState = GETTING_NEXT;
+            ++_commonStats.needTime;
+            return PlanStage::NEED_TIME;
+        }
+
+        // Position the scans on their first entries, one scan per call.
+        if (_numPointScansStarted < _pointScans.size()) {
+            PointScan* scan = _pointScans[_numPointScansStarted].get();
+            boost::optional<IndexKeyEntry> kv;
+            _cursorPointScan = NULL;
+            if (scan->checker->getStartSeekPoint(&_seekPoint)) {
+                kv = _indexCursor->seek(_seekPoint);
+            }
+            advancePointScan(scan, kv);
+            ++_numPointScansStarted;
+            if (scan->next) {
+                _cursorPointScan = scan;
+                _pointScanHeap.push_back(scan);
+                std::push_heap(_pointScanHeap.begin(), _pointScanHeap.end(), comesAfter);
+            }
+            if (HIT_END != _scanState) {
+                ++_commonStats.needTime;
+                return PlanStage::NEED_TIME;
+            }
+        }
+
+        // Move the scan we took the last key from past it.
+        if (HIT_END != _scanState && _currentPointScanTaken) {
+            PointScan* scan = _currentPointScan;
+            const bool cursorOnScan = _cursorPointScan == scan;
+            _cursorPointScan = NULL;
+            advancePointScan(scan, cursorOnScan ? _indexCursor->next() : seekPastNext(*scan));
+            _currentPointScanTaken = false;
+            if (scan->next) {
+                _cursorPointScan = scan;
+            } else {
+                _currentPointScan = NULL;
+            }
+        }
+    } catch (const WriteConflictException& wce) {
+        // The cursor may be anywhere, so it must seek before we use it again.
+        _cursorPointScan = NULL;
+        *out = WorkingSet::INVALID_ID;
+        return PlanStage::NEED_YIELD;
+    }
+
+    // Take the next key from whichever scan's next key comes first.  Prefer the current scan
+    // if there's a tie, as the cursor is already on its next entry.
+    if (HIT_END != _scanState && !_pointScanHeap.empty() &&
+        (!_currentPointScan || comesAfter(_currentPointScan, _pointScanHeap.front()))) {
+        std::pop_heap(_pointScanHeap.begin(), _pointScanHeap.end(), comesAfter);
+        PointScan* scan = _pointScanHeap.back();
+        _pointScanHeap.pop_back();
+        if (_currentPointScan) {
+            _pointScanHeap.push_back(_currentPointScan);
+            std::push_heap(_pointScanHeap.begin(), _pointScanHeap.end(), comesAfter);
+        }
+        _currentPointScan = scan;
+    }
+
+    if (HIT_END == _scanState || !_currentPointScan) {
+        _scanState = HIT_END;
+        _commonStats.isEOF = true;
+        _indexCursor.reset();
+        _pointScans.clear();
+        _pointScanHeap.clear();
+        _currentPointScan = NULL;
+        _cursorPointScan = NULL;
+        return PlanStage::IS_EOF;
+    }
+
+    _currentPointScanTaken = true;
+    if (_currentPointScan->nextInvalidated) {
+        ++_commonStats.needTime;
+        return PlanStage::NEED_TIME;
+    }
+
+    return returnKey(*_currentPointScan->next, out);
+}
+
+void IndexScan::initPointScans() {
+    invariant(!_params.bounds.isSimpleRange);
+    const size_t numFields = _params.bounds.fields.size();
+    const size_t numPrefixFields = _params.mergedPrefixFields;
+    invariant(numPrefixFields < numFields);
+
+    BSONObjIterator kpIt(_keyPattern);
+    for (size_t i = 0; kpIt.more(); ++i) {
+        const int indexDirection = kpIt.next().number() >= 0 ? 1 : -1;
+        if (i >= numPrefixFields) {
+            _mergedFieldDirections.push_back(indexDirection * _params.direction);
+        }
+    }
+
+    for (size_t i = 0; i < numPrefixFields; ++i) {
+        if (_params.bounds.fields[i].intervals.empty()) {
+            // There are no points to scan.
+            return;
+        }
+    }
+
+    // Count through the combinations of points, with those of the last prefix field changing
+    // fastest.
+    std::vector<size_t> pointIndexes(numPrefixFields, 0);
+    while (true) {
+        std::unique_ptr<PointScan> scan = stdx::make_unique<PointScan>();
+        scan->bounds.fields.resize(numFields);
+        for (size_t i = 0; i < numFields; ++i) {
+            const OrderedIntervalList& oil = _params.bounds.fields[i];
+            if (i < numPrefixFields) {
+                scan->bounds.fields[i].name = oil.name;
+                scan->bounds.fields[i].intervals.push_back(oil.intervals[pointIndexes[i]]);
+            } else {
+                scan->bounds.fields[i] = oil;
+            }
+        }
+        scan->checker = stdx::make_unique<IndexBoundsChecker>(
+            &scan->bounds, _keyPattern, _params.direction);
+        _pointScans.push_back(std::move(scan));
+
+        size_t field = numPrefixFields;
+        while (field > 0 &&
+               ++pointIndexes[field - 1] == _params.bounds.fields[field - 1].intervals.size()) {
+            pointIndexes[field - 1] = 0;
+            --field;
+        }
+        if (0 == field) {
+            break;
+        }
+    }
+
+    _specificStats.mergedPointScans = _pointScans.size();
+}
+
+void IndexScan::advancePointScan(PointScan* scan, boost::optional<IndexKeyEntry> kv) {
+    while (kv) {
+        ++_specificStats.keysExamined;
+        if (_params.maxScan && _specificStats.keysExamined >= _params.maxScan) {
+            _scanState = HIT_END;
+            break;
+        }
+
+        switch (scan->checker->checkKey(kv->key, &_seekPoint)) {
+            case IndexBoundsChecker::VALID:
+                scan->next = IndexKeyEntry(kv->key.getOwned(), kv->loc);
+                scan->nextInvalidated = false;
+                return;
+
+            case IndexBoundsChecker::DONE:
+                kv = boost::none;
+                break;
+
+            case IndexBoundsChecker::MUST_ADVANCE:
+                ++_specificStats.seeks;
+                kv = _indexCursor->seek(_seekPoint);
+                break;
+        }
+    }
+
+    scan->next = boost::none;
+}
+
+boost::optional<IndexKeyEntry> IndexScan::seekPastNext(const PointScan& scan) {
+    const IndexKeyEntry& entry = *scan.next;
+    ++_specificStats.seeks;
+    boost::optional<IndexKeyEntry> kv = _indexCursor->seek(entry.key, /*inclusive*/ true);
+
+    // Entries with equal keys are in RecordId order.  Step over those up to and including
+    // 'entry', which may have been deleted since we read it.
+    while (kv && 0 == kv->key.woCompare(entry.key, BSONObj(), /*compareFieldNames*/ false)) {
+        if (_forward ? entry.loc < kv->loc : kv->loc < entry.loc) {
+            break;
+        }
+        ++_specificStats.keysExamined;
+        kv = _indexCursor->next();
+    }
+    return kv;
+}
+
+int IndexScan::compareMergedKeys(const BSONObj& lhs, const BSONObj& rhs) const {
+    BSONObjIterator lhsIt(lhs);
+    BSONObjIterator rhsIt(rhs);
+    for (size_t i = 0; i < _params.mergedPrefixFields; ++i) {
+        lhsIt.next();
+        rhsIt.next();
+    }
+
+    for (size_t i = 0; i < _mergedFieldDirections.size(); ++i) {
+        const int cmp = sgn(lhsIt.next().woCompare(rhsIt.next(), /*considerFieldName*/ false));
+        if (0 != cmp) {
+            return cmp * _mergedFieldDirections[i];
+        }
+    }
+    return 0;
+}
+
 bool IndexScan::isEOF() {
     return _commonStats.isEOF;
 }
@@ -241,6 +486,13 @@ void IndexScan::doSaveState() {
         return;
     }
 
+    if (_params.mergedPrefixFields > 0) {
+        // We seek back to the entry we need when we next use the cursor.
+        _cursorPointScan = NULL;
+        _indexCursor->saveUnpositioned();
+        return;
+    }
+
     _indexCursor->save();
 }
 
@@ -273,6 +525,50 @@ void IndexScan::doInvalidate(OperationContext* txn, const RecordId& dl, Invalida
         ++_specificStats.seenInvalidated;
         _returned.erase(it);
     }
+
+    // A merging scan mustn't return an entry it read before the document was deleted.
+    for (size_t i = 0; i < _pointScans.size(); ++i) {
+        PointScan* scan = _pointScans[i].get();
+        if (scan->next && scan->next->loc == dl && !scan->nextInvalidated) {
+            ++_specificStats.seenInvalidated;
+            scan->nextInvalidated = true;
+        }
+    }
+}
+
+bool IndexScan::wouldReturnDocument(const BSONObj& obj) const {
+    const Ordering ordering = Ordering::make(_keyPattern);
+    std::unique_ptr<IndexBoundsChecker> checker;
+    if (!_params.bounds.isSimpleRange) {
+        checker.reset(new IndexBoundsChecker(&_params.bounds, _keyPattern, _params.direction));
+    }
+
+    BSONObjSet keys;
+    _iam->getKeys(obj, &keys);
+    for (BSONObjSet::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+        const BSONObj& key = *it;
+        if (checker) {
+            if (!checker->isValidKey(key)) {
+                continue;
+            }
+        } else {
+            const int startCmp =
+                key.woCompare(_params.bounds.startKey, ordering, false) * _params.direction;
+            const int endCmp =
+                key.woCompare(_params.bounds.endKey, ordering, false) * _params.direction;
+            // An empty end key leaves the scan unbounded.
+            const bool pastEnd = !_params.bounds.endKey.isEmpty() &&
+                (endCmp > 0 || (endCmp == 0 && !_params.bounds.endKeyInclusive));
+            if (startCmp < 0 || pastEnd) {
+                continue;
+            }
+        }
+
+        if (!_filter || Filter::passes(key, _keyPattern, _filter)) {
+            return true;
+        }
+    }
+    return false;
 }
 
 std::unique_ptr<PlanStageStats> IndexScan::getStats() {
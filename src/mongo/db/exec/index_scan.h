@@ -39,6 +39,8 @@
 #include "mongo/db/storage/sorted_data_interface.h"
 #include "mongo/platform/unordered_set.h"
 
+#include <vector>
+
 namespace mongo {
 
 class IndexAccessMethod;
@@ -47,7 +49,13 @@ class WorkingSet;
 
 struct IndexScanParams {
     IndexScanParams()
-        : descriptor(NULL), direction(1), doNotDedup(false), maxScan(0), addKeyMetadata(false) {}
+        : descriptor(NULL),
+          direction(1),
+          doNotDedup(false),
+          maxScan(0),
+          addKeyMetadata(false),
+          skipScan(false),
+          mergedPrefixFields(0) {}
 
     const IndexDescriptor* descriptor;
 
@@ -62,6 +70,15 @@ struct IndexScanParams {
 
     // Do we want to add the key as metadata?
     bool addKeyMetadata;
+
+    // Were the bounds built to skip-scan over the index's unconstrained first field? Reported in
+    // stats only.
+    bool skipScan;
+
+    // If nonzero, the first 'mergedPrefixFields' fields of the bounds are unions of points.  The
+    // scan then merges its scans of each combination of those points, returning keys in the
+    // order of the remaining fields of the index rather than in index order.
+    size_t mergedPrefixFields;
 };
 
 /**
@@ -96,6 +113,10 @@ public:
               const MatchExpression* filter);
 
     StageState work(WorkingSetID* out) final;
+    StageState workBatch(size_t maxWorks,
+                         std::vector<WorkingSetID>* results,
+                         WorkingSetID* out) final;
+    bool supportsWorkBatch() const final;
     bool isEOF() final;
     void doSaveState() final;
     void doRestoreState() final;
@@ -103,6 +124,13 @@ public:
     void doReattachToOperationContext() final;
     void doInvalidate(OperationContext* txn, const RecordId& dl, InvalidationType type) final;
 
+    /**
+     * Returns true if 'obj' has a key which this scan would return, that is, one which is within
+     * its bounds and passes its filter. Lets a consumer which only kept the RecordIds of this
+     * scan's results re-check them against a newer version of the document.
+     */
+    bool wouldReturnDocument(const BSONObj& obj) const;
+
     StageType stageType() const final {
         return STAGE_IXSCAN;
     }
@@ -114,11 +142,70 @@ public:
     static const char* kStageType;
 
 private:
+    /**
+     * Does the work of work(), which adds the stats and timing common to work() and workBatch().
+     */
+    StageState doWork(WorkingSetID* out);
+
     /**
      * Initialize the underlying index Cursor, returning first result if any.
      */
     boost::optional<IndexKeyEntry> initIndexScan();
 
+    /**
+     * Decides whether to dedup and opens the index cursor.
+     */
+    void initIndexCursor();
+
+    /**
+     * Dedups and filters 'kv' and, if it's still wanted, returns it in a new WSM.
+     */
+    StageState returnKey(const IndexKeyEntry& kv, WorkingSetID* out);
+
+    /**
+     * One of the scans a merging scan merges: it covers a single combination of the points of
+     * the merged prefix, so its keys come in the order of the remaining fields.
+     */
+    struct PointScan {
+        // The points of the prefix followed by the bounds of the remaining fields.
+        IndexBounds bounds;
+        std::unique_ptr<IndexBoundsChecker> checker;
+
+        // The next entry the scan returns, with an owned key.  Unset once the scan is done.
+        boost::optional<IndexKeyEntry> next;
+
+        // Whether the document of 'next' has been deleted, so that we mustn't return it.
+        bool nextInvalidated = false;
+    };
+
+    /**
+     * Does the work of doWork() when '_params.mergedPrefixFields' is set.
+     */
+    StageState doMergedWork(WorkingSetID* out);
+
+    /**
+     * Creates a PointScan for each combination of the points of the merged prefix.
+     */
+    void initPointScans();
+
+    /**
+     * Moves 'scan' on to the first entry at or after 'kv', the entry the cursor is on, which
+     * is within its bounds, seeking as its checker asks.
+     */
+    void advancePointScan(PointScan* scan, boost::optional<IndexKeyEntry> kv);
+
+    /**
+     * Positions the cursor just past the entry 'scan' last returned and returns the entry
+     * there, for when the cursor has since moved on to other scans.
+     */
+    boost::optional<IndexKeyEntry> seekPastNext(const PointScan& scan);
+
+    /**
+     * Compares two keys on the fields after the merged prefix in the order we return them:
+     * negative if 'lhs' comes first.
+     */
+    int compareMergedKeys(const BSONObj& lhs, const BSONObj& rhs) const;
+
     // The WorkingSet we fill with results.  Not owned by us.
     WorkingSet* const _workingSet;
 
@@ -170,6 +257,37 @@ private:
 
     // Is the end key included in the range?
     bool _endKeyInclusive;
+
+    //
+    // 3) If '_params.mergedPrefixFields' is set, every combination of the points of the prefix
+    //    fields gets a PointScan.  The scans share the one index cursor, which moves to whichever
+    //    scan's next key comes first in the order of the remaining fields.
+    //
+
+    std::vector<std::unique_ptr<PointScan>> _pointScans;
+
+    // How many of '_pointScans' have been positioned on their first entry.  We start one per
+    // call to work().
+    size_t _numPointScansStarted;
+
+    // The started scans other than '_currentPointScan' which aren't done, as a heap with the
+    // scan whose next key comes first at its front.
+    std::vector<PointScan*> _pointScanHeap;
+
+    // The scan we last took a key from, which we keep taking keys from until another scan's
+    // next key comes before its own.  NULL if there is none.
+    PointScan* _currentPointScan;
+
+    // Whether '_currentPointScan' must move past its next entry, which we've taken.
+    bool _currentPointScanTaken;
+
+    // The scan whose next entry the cursor is positioned on, so that it can move on to the
+    // following entry without a seek.  NULL if the cursor isn't on any scan's next entry.
+    PointScan* _cursorPointScan;
+
+    // For each field after the merged prefix, the direction of the field times the direction
+    // of the scan.
+    std::vector<int> _mergedFieldDirections;
 };
 
 }  // namespace mongo
@@ -63,7 +63,7 @@ PlanStage::StageState KeepMutationsStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     // If we've returned as many results as we're limited to, isEOF will be true.
     if (isEOF()) {
@@ -28,6 +28,8 @@
 
 #include "mongo/db/exec/limit.h"
 
+#include <algorithm>
+
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/stdx/memory.h"
@@ -51,22 +53,41 @@ LimitStage::LimitStage(OperationContext* opCtx, long long limit, WorkingSet* ws,
 LimitStage::~LimitStage() {}
 
 bool LimitStage::isEOF() {
-    return (0 == _numToReturn) || child()->isEOF();
+    return (0 == _numToReturn) || childIsEOF();
 }
 
 PlanStage::StageState LimitStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
+
+    return doWork(out);
+}
+
+PlanStage::StageState LimitStage::workBatch(size_t maxWorks,
+                                            std::vector<WorkingSetID>* results,
+                                            WorkingSetID* out) {
+    ScopedTimer timer(&_commonStats);
+
+    pullChildBatch(std::min(maxWorks, static_cast<size_t>(_numToReturn)));
+    return runWorkBatch(_ws, maxWorks, true, results, out, [this](WorkingSetID* id) {
+        return doWork(id);
+    });
+}
+
+bool LimitStage::supportsWorkBatch() const {
+    return child()->supportsWorkBatch();
+}
 
+PlanStage::StageState LimitStage::doWork(WorkingSetID* out) {
     if (0 == _numToReturn) {
         // We've returned as many results as we're limited to.
         return PlanStage::IS_EOF;
     }
 
     WorkingSetID id = WorkingSet::INVALID_ID;
-    StageState status = child()->work(&id);
+    StageState status = workChild(&id);
 
     if (PlanStage::ADVANCED == status) {
         *out = id;
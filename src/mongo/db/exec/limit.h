@@ -49,6 +49,10 @@ public:
 
     bool isEOF() final;
     StageState work(WorkingSetID* out) final;
+    StageState workBatch(size_t maxWorks,
+                         std::vector<WorkingSetID>* results,
+                         WorkingSetID* out) final;
+    bool supportsWorkBatch() const final;
 
     StageType stageType() const final {
         return STAGE_LIMIT;
@@ -61,6 +65,11 @@ public:
     static const char* kStageType;
 
 private:
+    /**
+     * Does the work of work(), which adds the stats and timing common to work() and workBatch().
+     */
+    StageState doWork(WorkingSetID* out);
+
     WorkingSet* _ws;
 
     // We only return this many results.
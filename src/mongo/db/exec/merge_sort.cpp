@@ -73,7 +73,7 @@ PlanStage::StageState MergeSortStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     if (isEOF()) {
         return PlanStage::IS_EOF;
@@ -98,7 +98,7 @@ PlanStage::StageState MergeSortStage::work(WorkingSetID* out) {
                 } else {
                     ++_specificStats.dupsTested;
                     // ...and there's a diskloc and and we've seen the RecordId before
-                    if (_seen.end() != _seen.find(member->loc)) {
+                    if (_seen.contains(member->loc)) {
                         // ...drop it.
                         _ws->free(id);
                         ++_commonStats.needTime;
@@ -106,7 +106,7 @@ PlanStage::StageState MergeSortStage::work(WorkingSetID* out) {
                         return PlanStage::NEED_TIME;
                     } else {
                         // Otherwise, note that we've seen it.
-                        _seen.insert(member->loc);
+                        _seen.add(member->loc);
                         // We're going to use the result from the child, so we remove it from
                         // the queue of children without a result.
                         _noResultToMerge.pop();
@@ -208,7 +208,7 @@ void MergeSortStage::doInvalidate(OperationContext* txn,
     // If we see DL again it is not the same record as it once was so we still want to
     // return it.
     if (_dedup) {
-        _seen.erase(dl);
+        _seen.remove(dl);
     }
 }
 
@@ -33,6 +33,7 @@
 #include <vector>
 
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/record_id_bitmap.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/record_id.h"
@@ -90,8 +91,8 @@ private:
     // Are we deduplicating on RecordId?
     bool _dedup;
 
-    // Which RecordIds have we seen?
-    unordered_set<RecordId, RecordId::Hasher> _seen;
+    // Which RecordIds have we seen? Kept compressed since it grows with the result set.
+    RecordIdBitmap _seen;
 
     // In order to pick the next smallest value, we need each child work(...) until it produces
     // a result.  This is the queue of children that haven't given us a result yet.
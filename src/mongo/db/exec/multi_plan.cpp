@@ -49,6 +49,7 @@
 #include "mongo/stdx/memory.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -100,7 +101,7 @@ bool MultiPlanStage::isEOF() {
 
 PlanStage::StageState MultiPlanStage::work(WorkingSetID* out) {
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     if (_failure) {
         *out = _statusMemberId;
@@ -216,18 +217,41 @@ Status MultiPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
     // Adds the amount of time taken by pickBestPlan() to executionTimeMillis. There's lots of
     // execution work that happens here, so this is needed for the time accounting to
     // make sense.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     size_t numWorks = getTrialPeriodWorks(getOpCtx(), _collection);
     size_t numResults = getTrialPeriodNumToReturn(*_query);
 
+    // The trial period may also be bounded by its duration and by the works spent over all of
+    // the candidates. Every plan is worked at least once either way.
+    const int maxMillis = internalQueryPlanEvaluationMaxMillis;
+    const int maxTotalWorks = internalQueryPlanEvaluationMaxTotalWorks;
+    const double eliminationRatio = internalQueryPlanEvaluationEliminationRatio;
+    const size_t minWorksBeforeElimination =
+        std::max(static_cast<size_t>(1), std::min(numWorks, numResults) / 10);
+    Timer trialTimer;
+    size_t totalWorks = 0;
+
     // Work the plans, stopping when a plan hits EOF or returns some
     // fixed number of results.
     for (size_t ix = 0; ix < numWorks; ++ix) {
-        bool moreToDo = workAllPlans(numResults, yieldPolicy);
+        bool moreToDo = workAllPlans(numResults, yieldPolicy, &totalWorks);
         if (!moreToDo) {
             break;
         }
+
+        if (maxMillis > 0 && trialTimer.millis() >= maxMillis) {
+            LOG(2) << "Trial period ran out of time after " << ix + 1 << " works per plan";
+            break;
+        }
+        if (maxTotalWorks > 0 && totalWorks >= static_cast<size_t>(maxTotalWorks)) {
+            LOG(2) << "Trial period ran out of works after " << ix + 1 << " works per plan";
+            break;
+        }
+
+        if (eliminationRatio > 0 && ix + 1 >= minWorksBeforeElimination) {
+            eliminateLosingPlans(eliminationRatio);
+        }
     }
 
     if (_failure) {
@@ -265,6 +289,14 @@ Status MultiPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
         }
     }
 
+    // Only the buffered results of the winner and of the backup plan are ever returned, and only
+    // theirs are kept up to date by invalidations. The other candidates' results can go now.
+    for (size_t ix = 0; ix < _candidates.size(); ++ix) {
+        if (static_cast<int>(ix) != _bestPlanIdx && static_cast<int>(ix) != _backupPlanIdx) {
+            freeResults(&_candidates[ix]);
+        }
+    }
+
     // Even if the query is of a cacheable shape, the caller might have indicated that we shouldn't
     // write to the plan cache.
     //
@@ -360,12 +392,60 @@ vector<PlanStageStats*> MultiPlanStage::generateCandidateStats() {
     return candidateStats.release();
 }
 
-bool MultiPlanStage::workAllPlans(size_t numResults, PlanYieldPolicy* yieldPolicy) {
+void MultiPlanStage::freeResults(CandidatePlan* candidate) {
+    for (WorkingSetID id : candidate->results) {
+        candidate->ws->free(id);
+    }
+    candidate->results.clear();
+}
+
+void MultiPlanStage::eliminateLosingPlans(double ratio) {
+    // Like PlanRanker, measure productivity as the results produced per call to work().
+    vector<double> productivity(_candidates.size(), 0);
+    double bestProductivity = 0;
+    for (size_t ix = 0; ix < _candidates.size(); ++ix) {
+        const CandidatePlan& candidate = _candidates[ix];
+        if (candidate.failed || candidate.eliminated) {
+            continue;
+        }
+
+        const size_t works = candidate.root->getCommonStats()->works;
+        if (works > 0) {
+            productivity[ix] = static_cast<double>(candidate.results.size()) / works;
+        }
+        bestProductivity = std::max(bestProductivity, productivity[ix]);
+    }
+
+    if (bestProductivity == 0) {
+        // Nothing to compare against yet.
+        return;
+    }
+
+    for (size_t ix = 0; ix < _candidates.size(); ++ix) {
+        CandidatePlan& candidate = _candidates[ix];
+        // A plan with a blocking stage produces nothing until it's done, so it can't be judged
+        // by its results so far.
+        if (candidate.failed || candidate.eliminated || candidate.solution->hasBlockingStage) {
+            continue;
+        }
+
+        if (productivity[ix] * ratio < bestProductivity) {
+            LOG(5) << "Eliminating candidate " << ix << " from the trial period, productivity "
+                   << productivity[ix] << " vs. best " << bestProductivity;
+            candidate.eliminated = true;
+            freeResults(&candidate);
+        }
+    }
+}
+
+bool MultiPlanStage::workAllPlans(size_t numResults,
+                                  PlanYieldPolicy* yieldPolicy,
+                                  size_t* totalWorks) {
     bool doneWorking = false;
 
     for (size_t ix = 0; ix < _candidates.size(); ++ix) {
         CandidatePlan& candidate = _candidates[ix];
-        if (candidate.failed) {
+        if (candidate.failed || candidate.eliminated) {
             continue;
         }
 
@@ -376,6 +456,7 @@ bool MultiPlanStage::workAllPlans(size_t numResults, PlanYieldPolicy* yieldPolic
 
         WorkingSetID id = WorkingSet::INVALID_ID;
         PlanStage::StageState state = candidate.root->work(&id);
+        ++*totalWorks;
 
         if (PlanStage::ADVANCED == state) {
             // Save result for later.
@@ -169,9 +169,21 @@ private:
      * Calls work on each child plan in a round-robin fashion. We stop when any plan hits EOF
      * or returns 'numResults' results.
      *
-     * Returns true if we need to keep working the plans and false otherwise.
+     * Returns true if we need to keep working the plans and false otherwise. Adds the number of
+     * calls to work() made to '*totalWorks'.
      */
-    bool workAllPlans(size_t numResults, PlanYieldPolicy* yieldPolicy);
+    bool workAllPlans(size_t numResults, PlanYieldPolicy* yieldPolicy, size_t* totalWorks);
+
+    /**
+     * Stops working the candidates whose results per work() so far fall below 1 / 'ratio' of the
+     * best candidate's, other than those with a blocking stage.
+     */
+    void eliminateLosingPlans(double ratio);
+
+    /**
+     * Frees the results 'candidate' buffered during the trial period.
+     */
+    static void freeResults(CandidatePlan* candidate);
 
     /**
      * Checks whether we need to perform either a timing-based yield or a yield for a document
@@ -85,7 +85,7 @@ PlanStage::StageState NearStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     WorkingSetID toReturn = WorkingSet::INVALID_ID;
     Status error = Status::OK();
@@ -58,7 +58,7 @@ PlanStage::StageState OrStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     if (isEOF()) {
         return PlanStage::IS_EOF;
@@ -75,7 +75,7 @@ PlanStage::StageState OrStage::work(WorkingSetID* out) {
             ++_specificStats.dupsTested;
 
             // ...and we've seen the RecordId before
-            if (_seen.end() != _seen.find(member->loc)) {
+            if (_seen.contains(member->loc)) {
                 // ...drop it.
                 ++_specificStats.dupsDropped;
                 _ws->free(id);
@@ -83,7 +83,7 @@ PlanStage::StageState OrStage::work(WorkingSetID* out) {
                 return PlanStage::NEED_TIME;
             } else {
                 // Otherwise, note that we've seen it.
-                _seen.insert(member->loc);
+                _seen.add(member->loc);
             }
         }
 
@@ -141,10 +141,8 @@ void OrStage::doInvalidate(OperationContext* txn, const RecordId& dl, Invalidati
     // If we see DL again it is not the same record as it once was so we still want to
     // return it.
     if (_dedup && INVALIDATION_DELETION == type) {
-        unordered_set<RecordId, RecordId::Hasher>::iterator it = _seen.find(dl);
-        if (_seen.end() != it) {
+        if (_seen.remove(dl)) {
             ++_specificStats.locsForgotten;
-            _seen.erase(dl);
         }
     }
 }
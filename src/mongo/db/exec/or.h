@@ -29,10 +29,10 @@
 #pragma once
 
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/record_id_bitmap.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
-#include "mongo/platform/unordered_set.h"
 
 namespace mongo {
 
@@ -78,8 +78,8 @@ private:
     // True if we dedup on RecordId, false otherwise.
     bool _dedup;
 
-    // Which RecordIds have we returned?
-    unordered_set<RecordId, RecordId::Hasher> _seen;
+    // Which RecordIds have we returned? Kept compressed since it grows with the result set.
+    RecordIdBitmap _seen;
 
     // Stats
     OrStats _specificStats;
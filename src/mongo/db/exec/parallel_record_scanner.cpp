@@ -0,0 +1,279 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/parallel_record_scanner.h"
+
+#include <algorithm>
+
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/db/storage/recovery_unit.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+namespace {
+
+// How many records a worker scans between checks for a save(). Keeps yields responsive.
+const size_t kRecordsPerChunk = 128;
+
+// Workers stop scanning while this many matching documents are waiting for the owner.
+const size_t kMaxBufferedResults = 4096;
+
+// How long next() waits for a worker before telling the caller to come back later.
+const Milliseconds kMaxWaitForResults(1);
+
+}  // namespace
+
+ParallelRecordScanner::ParallelRecordScanner(std::vector<std::unique_ptr<RecordCursor>> cursors,
+                                             size_t parallelism,
+                                             const MatchExpression* filter)
+    : _filter(filter) {
+    invariant(parallelism > 0);
+
+    const size_t numWorkers = std::min(parallelism, cursors.size());
+    for (size_t i = 0; i < numWorkers; i++) {
+        _workers.push_back(stdx::make_unique<Worker>());
+    }
+
+    // The workers reattach the cursors to their own OperationContexts.
+    for (size_t i = 0; i < cursors.size(); i++) {
+        cursors[i]->save();
+        cursors[i]->detachFromOperationContext();
+        _workers[i % numWorkers]->cursors.push_back(std::move(cursors[i]));
+    }
+
+    for (auto&& worker : _workers) {
+        Worker* w = worker.get();
+        worker->thread = stdx::thread([this, w] { _workerMain(w); });
+    }
+}
+
+ParallelRecordScanner::~ParallelRecordScanner() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _stopping = true;
+    }
+    _workersCV.notify_all();
+
+    for (auto&& worker : _workers) {
+        worker->thread.join();
+    }
+}
+
+ParallelRecordScanner::NextState ParallelRecordScanner::next(RecordId* id, BSONObj* obj) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    if (_buffer.empty() && _status.isOK() && _numFinished < _workers.size()) {
+        _ownerCV.wait_for(lk, kMaxWaitForResults);
+    }
+
+    if (!_status.isOK()) {
+        return FAILED;
+    }
+
+    if (_buffer.empty()) {
+        return _numFinished == _workers.size() ? IS_EOF : NOT_READY;
+    }
+
+    const bool wasFull = _buffer.size() >= kMaxBufferedResults;
+    *id = _buffer.front().id;
+    *obj = std::move(_buffer.front().obj);
+    _buffer.pop_front();
+
+    if (wasFull) {
+        _workersCV.notify_all();
+    }
+    return ADVANCED;
+}
+
+void ParallelRecordScanner::save() {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _paused = true;
+    _workersCV.notify_all();
+
+    _ownerCV.wait(lk, [this] {
+        if (_numScanning > 0) {
+            return false;
+        }
+        for (auto&& worker : _workers) {
+            if (!worker->saved && !worker->cursors.empty()) {
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+void ParallelRecordScanner::restore() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _paused = false;
+    }
+    _workersCV.notify_all();
+}
+
+void ParallelRecordScanner::invalidate(const RecordId& id) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    _buffer.erase(std::remove_if(_buffer.begin(),
+                                 _buffer.end(),
+                                 [&id](const Result& result) { return result.id == id; }),
+                  _buffer.end());
+
+    for (auto&& worker : _workers) {
+        // A worker's cursors are only safe to touch from here while they are saved.
+        if (!worker->saved) {
+            continue;
+        }
+        for (auto&& cursor : worker->cursors) {
+            cursor->invalidate(id);
+        }
+    }
+}
+
+size_t ParallelRecordScanner::docsTested() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _docsTested;
+}
+
+long long ParallelRecordScanner::docBytesTested() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _docBytesTested;
+}
+
+Status ParallelRecordScanner::getStatus() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _status;
+}
+
+void ParallelRecordScanner::_workerMain(Worker* worker) {
+    Client::initThread("parallelCollectionScan");
+    auto txn = cc().makeOperationContext();
+
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    for (auto&& cursor : worker->cursors) {
+        cursor->reattachToOperationContext(txn.get());
+    }
+
+    while (!_stopping && !worker->cursors.empty()) {
+        if (_paused || _buffer.size() >= kMaxBufferedResults) {
+            // Never wait with a positioned cursor, so that save() does not have to wait for us.
+            if (!worker->saved) {
+                worker->cursors.front()->save();
+                txn->recoveryUnit()->abandonSnapshot();
+                worker->saved = true;
+                _ownerCV.notify_all();
+            }
+            _workersCV.wait(lk);
+            continue;
+        }
+
+        RecordCursor* cursor = worker->cursors.front().get();
+        const bool needRestore = worker->saved;
+        worker->saved = false;
+        ++_numScanning;
+        lk.unlock();
+
+        std::vector<Result> results;
+        size_t tested = 0;
+        long long testedBytes = 0;
+        bool exhausted = false;
+        bool writeConflict = false;
+        Status status = Status::OK();
+        try {
+            if (needRestore && !cursor->restore()) {
+                status = Status(ErrorCodes::OperationFailed,
+                                "Could not restore RecordCursor for parallel collection scan");
+            } else {
+                while (tested < kRecordsPerChunk) {
+                    auto record = cursor->next();
+                    if (!record) {
+                        exhausted = true;
+                        break;
+                    }
+
+                    ++tested;
+                    BSONObj obj = record->data.releaseToBson();
+                    testedBytes += obj.objsize();
+                    if (!_filter || _filter->matchesBSON(obj)) {
+                        results.push_back({record->id, obj.getOwned()});
+                    }
+                }
+            }
+        } catch (const WriteConflictException&) {
+            // We keep what we have read so far. The cursor picks up after the last record it
+            // returned once it is restored in a new snapshot.
+            writeConflict = true;
+        } catch (const DBException& ex) {
+            status = ex.toStatus();
+        }
+
+        lk.lock();
+        --_numScanning;
+
+        for (auto&& result : results) {
+            _buffer.push_back(std::move(result));
+        }
+        _docsTested += tested;
+        _docBytesTested += testedBytes;
+        _ownerCV.notify_all();
+
+        if (!status.isOK()) {
+            if (_status.isOK()) {
+                _status = status;
+            }
+            break;
+        }
+
+        if (writeConflict) {
+            cursor->save();
+            txn->recoveryUnit()->abandonSnapshot();
+            worker->saved = true;
+        } else if (exhausted) {
+            // The next cursor has not been used yet, so it is still saved.
+            worker->cursors.pop_front();
+            worker->saved = true;
+        }
+    }
+
+    // Release the cursors while their OperationContext still exists.
+    worker->cursors.clear();
+    ++_numFinished;
+    _ownerCV.notify_all();
+}
+
+}  // namespace mongo
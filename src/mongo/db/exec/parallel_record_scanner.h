@@ -0,0 +1,194 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/record_id.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+
+namespace mongo {
+
+class MatchExpression;
+class RecordCursor;
+
+/**
+ * Scans a set of disjoint RecordCursors, such as those returned by Collection::getManyCursors(),
+ * on a pool of worker threads. Each worker has its own Client and OperationContext, and so reads
+ * from its own RecoveryUnit snapshot. Workers apply the filter and buffer the matching documents
+ * for the owning thread, which consumes them through next() in no particular order.
+ *
+ * Workers never take locks of their own; they only touch storage while the owning operation holds
+ * its locks. The owner must therefore call save() before it releases its locks and restore() once
+ * it has them back, exactly as it would for a cursor of its own.
+ *
+ * This class is not thread safe with respect to its owner; all public methods must be called by
+ * the thread that owns the operation.
+ */
+class ParallelRecordScanner {
+    MONGO_DISALLOW_COPYING(ParallelRecordScanner);
+
+public:
+    enum NextState {
+        // 'id' and 'obj' hold a document which passed the filter.
+        ADVANCED,
+
+        // No document is ready yet. The caller should come back later.
+        NOT_READY,
+
+        // Every cursor has been exhausted and all buffered documents have been returned.
+        IS_EOF,
+
+        // A worker hit an error, available through getStatus().
+        FAILED,
+    };
+
+    /**
+     * Starts min(parallelism, cursors.size()) worker threads and hands out 'cursors' to them
+     * round-robin. The cursors must be attached to the caller's OperationContext, which must hold
+     * the locks needed to read them. 'filter', which may be NULL, is not owned and must outlive
+     * the scanner.
+     */
+    ParallelRecordScanner(std::vector<std::unique_ptr<RecordCursor>> cursors,
+                          size_t parallelism,
+                          const MatchExpression* filter);
+
+    /**
+     * Stops and joins all workers.
+     */
+    ~ParallelRecordScanner();
+
+    /**
+     * Returns the next buffered document in 'id' and 'obj', which is owned. Waits briefly for a
+     * worker to produce one if none is buffered.
+     */
+    NextState next(RecordId* id, BSONObj* obj);
+
+    /**
+     * Stops the workers from touching storage, returning once all of them have saved their
+     * cursors. Must be called before the owner releases its locks.
+     */
+    void save();
+
+    /**
+     * Lets the workers go again after a save(). The workers restore their cursors themselves.
+     */
+    void restore();
+
+    /**
+     * Passes a deletion of 'id' on to the cursors and drops any buffered copy of the document.
+     * Storage engines only deliver invalidations to operations which have yielded, so this is
+     * only expected between save() and restore().
+     */
+    void invalidate(const RecordId& id);
+
+    /**
+     * Returns the number of documents the workers have tested against the filter so far.
+     */
+    size_t docsTested() const;
+
+    /**
+     * Returns the total size of the documents the workers have tested against the filter so far.
+     */
+    long long docBytesTested() const;
+
+    /**
+     * Returns the number of worker threads.
+     */
+    size_t numWorkers() const {
+        return _workers.size();
+    }
+
+    /**
+     * Returns the error which made next() return FAILED, or OK.
+     */
+    Status getStatus() const;
+
+private:
+    struct Result {
+        RecordId id;
+        BSONObj obj;
+    };
+
+    struct Worker {
+        // The cursors left for this worker, scanned front to back. The front cursor is the only
+        // one which may be unsaved.
+        std::deque<std::unique_ptr<RecordCursor>> cursors;
+
+        // True while the front cursor is saved, and so must be restored before it is used.
+        bool saved = true;
+
+        stdx::thread thread;
+    };
+
+    /**
+     * The body of each worker thread.
+     */
+    void _workerMain(Worker* worker);
+
+    const MatchExpression* const _filter;
+
+    // Protects all of the state below, as well as the cursors owned by the workers.
+    mutable stdx::mutex _mutex;
+
+    // Signalled when the workers may have something to do: the scanner is restored or stopping,
+    // or the buffer has room again.
+    stdx::condition_variable _workersCV;
+
+    // Signalled when a worker produces results, saves its cursor, finishes or fails.
+    stdx::condition_variable _ownerCV;
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    // Matching documents which have not been returned by next() yet.
+    std::deque<Result> _buffer;
+
+    bool _paused = false;
+    bool _stopping = false;
+
+    // The number of workers currently touching storage without holding _mutex.
+    size_t _numScanning = 0;
+
+    // The number of workers which have no cursors left, or have failed.
+    size_t _numFinished = 0;
+
+    size_t _docsTested = 0;
+    long long _docBytesTested = 0;
+
+    Status _status = Status::OK();
+};
+
+}  // namespace mongo
@@ -101,7 +101,12 @@ void PipelineProxyStage::doInvalidate(OperationContext* txn,
     }
 }
 
+void PipelineProxyStage::doSaveState() {
+    finishChildPrefetch();
+}
+
 void PipelineProxyStage::doDetachFromOperationContext() {
+    finishChildPrefetch();
     _pipeline->getContext()->opCtx = NULL;
     if (auto child = getChildExecutor()) {
         child->detachFromOperationContext();
@@ -135,6 +140,12 @@ boost::optional<BSONObj> PipelineProxyStage::getNextBson() {
     return boost::none;
 }
 
+void PipelineProxyStage::finishChildPrefetch() {
+    if (auto cursor = dynamic_cast<DocumentSourceCursor*>(_pipeline->input())) {
+        cursor->finishPrefetch();
+    }
+}
+
 shared_ptr<PlanExecutor> PipelineProxyStage::getChildExecutor() {
     return _childExec.lock();
 }
@@ -61,6 +61,8 @@ public:
     void doDetachFromOperationContext() final;
     void doReattachToOperationContext() final;
 
+    void doSaveState() final;
+
     /**
      * Return a shared pointer to the PlanExecutor that feeds the pipeline. The returned
      * pointer may be NULL.
@@ -86,6 +88,12 @@ public:
 private:
     boost::optional<BSONObj> getNextBson();
 
+    /**
+     * Waits for the pipeline's $cursor stage, if it has one, to stop using the child executor
+     * on another thread.
+     */
+    void finishChildPrefetch();
+
     // Things in the _stash should be returned before pulling items from _pipeline.
     const boost::intrusive_ptr<Pipeline> _pipeline;
     std::vector<BSONObj> _stash;
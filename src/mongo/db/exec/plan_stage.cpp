@@ -32,8 +32,23 @@
 
 #include "mongo/db/exec/plan_stage.h"
 
+#include "mongo/db/exec/working_set_common.h"
+
 namespace mongo {
 
+PlanStage::StageState PlanStage::workBatch(size_t maxWorks,
+                                           std::vector<WorkingSetID>* results,
+                                           WorkingSetID* out) {
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    StageState state = work(&id);
+    if (ADVANCED == state) {
+        results->push_back(id);
+        return NEED_TIME;
+    }
+    *out = id;
+    return state;
+}
+
 void PlanStage::saveState() {
     ++_commonStats.yields;
     for (auto&& child : _children) {
@@ -83,4 +98,43 @@ void PlanStage::reattachToOperationContext(OperationContext* opCtx) {
     doReattachToOperationContext();
 }
 
+void PlanStage::enableTracing() {
+    _commonStats.traced = true;
+    for (auto&& child : _children) {
+        child->enableTracing();
+    }
+}
+
+void PlanStage::WorkBatch::fill(PlanStage* stage, size_t maxWorks) {
+    invariant(empty());
+    _results.clear();
+    _pos = 0;
+    _stateId = WorkingSet::INVALID_ID;
+    _state = stage->workBatch(maxWorks, &_results, &_stateId);
+    _hasState = (NEED_TIME != _state);
+}
+
+PlanStage::StageState PlanStage::WorkBatch::next(WorkingSetID* out) {
+    if (_pos < _results.size()) {
+        *out = _results[_pos++];
+        return ADVANCED;
+    }
+    invariant(_hasState);
+    _hasState = false;
+    *out = _stateId;
+    return _state;
+}
+
+void PlanStage::WorkBatch::invalidate(OperationContext* txn,
+                                      WorkingSet* ws,
+                                      const Collection* collection,
+                                      const RecordId& dl) {
+    for (size_t i = _pos; i < _results.size(); ++i) {
+        WorkingSetMember* member = ws->get(_results[i]);
+        if (member->hasLoc() && member->loc == dl) {
+            WorkingSetCommon::fetchAndInvalidateLoc(txn, member, collection);
+        }
+    }
+}
+
 }  // namespace mongo
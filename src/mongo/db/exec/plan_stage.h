@@ -192,6 +192,71 @@ public:
      */
     virtual bool isEOF() = 0;
 
+    /**
+     * Performs up to 'maxWorks' units of work, as if by calling work() that many times, and
+     * appends each result produced to 'results'. The caller owns the results as if each had
+     * been returned by work().
+     *
+     * Stops early and returns the first state other than ADVANCED or NEED_TIME, setting *out as
+     * work() would have. Results appended before it precede it in the output stream. Otherwise
+     * returns NEED_TIME.
+     *
+     * The default implementation performs a single unit of work. Stages for which
+     * supportsWorkBatch() is true override it so that a batch costs a single call down the tree
+     * rather than one call down the tree per result. Native implementations make the object of
+     * each result owned, so that it stays valid while later results are produced.
+     */
+    virtual StageState workBatch(size_t maxWorks,
+                                 std::vector<WorkingSetID>* results,
+                                 WorkingSetID* out);
+
+    /**
+     * Returns true if this stage and all of its descendants implement workBatch() natively.
+     */
+    virtual bool supportsWorkBatch() const {
+        return false;
+    }
+
+    /**
+     * The results of a call to workBatch(), handed out one at a time as if by work().
+     */
+    class WorkBatch {
+    public:
+        /**
+         * Returns true if neither results nor the state which ended the batch remain.
+         */
+        bool empty() const {
+            return _pos == _results.size() && !_hasState;
+        }
+
+        /**
+         * Pulls the next batch of up to 'maxWorks' units of work from 'stage'. Must be empty.
+         */
+        void fill(PlanStage* stage, size_t maxWorks);
+
+        /**
+         * Hands out the next result as ADVANCED, or else the state which ended the batch. Must
+         * not be empty.
+         */
+        StageState next(WorkingSetID* out);
+
+        /**
+         * Forces a fetch of 'dl' into any result which has not yet been handed out, since the
+         * consumer would otherwise see it only after the invalidation.
+         */
+        void invalidate(OperationContext* txn,
+                        WorkingSet* ws,
+                        const Collection* collection,
+                        const RecordId& dl);
+
+    private:
+        std::vector<WorkingSetID> _results;
+        size_t _pos = 0;
+        bool _hasState = false;
+        StageState _state = NEED_TIME;
+        WorkingSetID _stateId = WorkingSet::INVALID_ID;
+    };
+
     //
     // Yielding and isolation semantics:
     //
@@ -245,6 +310,15 @@ public:
      */
     void reattachToOperationContext(OperationContext* opCtx);
 
+    /**
+     * Makes the stage and its children count the precise time and the allocations of their work
+     * in their CommonStats, e.g. for the execution stats of an explain. The children which the
+     * stage creates afterwards, e.g. when replanning, are not traced.
+     *
+     * Propagates to all children.
+     */
+    void enableTracing();
+
     /**
      * Notifies a stage that a RecordId is going to be deleted (or in-place updated) so that the
      * stage can invalidate or modify any state required to continue processing without this
@@ -352,6 +426,64 @@ protected:
      */
     virtual void doInvalidate(OperationContext* txn, const RecordId& dl, InvalidationType type) {}
 
+    /**
+     * Produces the next result of the only child, from the batch pulled by the last call to
+     * pullChildBatch() while it lasts and from child()->work() after that. Stages which
+     * implement workBatch() natively call this wherever they would call child()->work().
+     */
+    StageState workChild(WorkingSetID* out) {
+        if (!_childBatch.empty()) {
+            return _childBatch.next(out);
+        }
+        return child()->work(out);
+    }
+
+    /**
+     * Like child()->isEOF(), but false while results of the child's batch remain.
+     */
+    bool childIsEOF() {
+        return _childBatch.empty() && child()->isEOF();
+    }
+
+    /**
+     * Pulls a batch of up to 'maxWorks' units of work from the only child if the last one has
+     * been consumed.
+     */
+    void pullChildBatch(size_t maxWorks) {
+        if (_childBatch.empty()) {
+            _childBatch.fill(child().get(), maxWorks);
+        }
+    }
+
+    /**
+     * Implements workBatch() in terms of 'doWork', which must do what work() does except for
+     * counting the work and timing it. Performs up to 'maxWorks' units of work, or if
+     * 'untilChildBatchConsumed' is set, as many as it takes to consume the child's batch, but
+     * always at least one.
+     */
+    template <typename DoWork>
+    StageState runWorkBatch(WorkingSet* ws,
+                            size_t maxWorks,
+                            bool untilChildBatchConsumed,
+                            std::vector<WorkingSetID>* results,
+                            WorkingSetID* out,
+                            DoWork doWork) {
+        size_t i = 0;
+        do {
+            ++_commonStats.works;
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            StageState state = doWork(&id);
+            if (ADVANCED == state) {
+                ws->get(id)->makeObjOwnedIfNeeded();
+                results->push_back(id);
+            } else if (NEED_TIME != state) {
+                *out = id;
+                return state;
+            }
+        } while (untilChildBatchConsumed ? !_childBatch.empty() : ++i < maxWorks);
+        return NEED_TIME;
+    }
+
     OperationContext* getOpCtx() const {
         return _opCtx;
     }
@@ -359,6 +491,10 @@ protected:
     Children _children;
     CommonStats _commonStats;
 
+    // Results of the only child which have been pulled by pullChildBatch() but not yet consumed
+    // by workChild().
+    WorkBatch _childBatch;
+
 private:
     OperationContext* _opCtx;
 };
@@ -65,6 +65,9 @@ struct CommonStats {
           needTime(0),
           needYield(0),
           executionTimeMillis(0),
+          traced(false),
+          executionTimeNanos(0),
+          bytesAllocated(0),
           isEOF(false) {}
     // String giving the type of the stage. Not owned.
     const char* stageTypeStr;
@@ -87,6 +90,14 @@ struct CommonStats {
     // Time elapsed while working inside this stage.
     long long executionTimeMillis;
 
+    // Whether the stage is traced, see PlanStage::enableTracing(). Traced stages also count the
+    // time elapsed while working inside them with the precision of the tick source, and the bytes
+    // the thread allocated meanwhile, if the AllocationCounter is enabled. Like
+    // executionTimeMillis, these include the work of the children.
+    bool traced;
+    long long executionTimeNanos;
+    long long bytesAllocated;
+
     // TODO: have some way of tracking WSM sizes (or really any series of #s).  We can measure
     // the size of our inputs and the size of our outputs.  We can do a lot with the WS here.
 
@@ -144,7 +155,12 @@ private:
 };
 
 struct AndHashStats : public SpecificStats {
-    AndHashStats() : flaggedButPassed(0), flaggedInProgress(0), memUsage(0), memLimit(0) {}
+    AndHashStats()
+        : flaggedButPassed(0),
+          flaggedInProgress(0),
+          memUsage(0),
+          memLimit(0),
+          usedRecordIdBitmaps(false) {}
 
     SpecificStats* clone() const final {
         AndHashStats* specific = new AndHashStats(*this);
@@ -171,6 +187,9 @@ struct AndHashStats : public SpecificStats {
 
     // What's our memory limit?
     size_t memLimit;
+
+    // Did we intersect RecordId bitmaps rather than hash the children's results?
+    bool usedRecordIdBitmaps;
 };
 
 struct AndSortedStats : public SpecificStats {
@@ -197,7 +216,7 @@ struct CachedPlanStats : public SpecificStats {
 };
 
 struct CollectionScanStats : public SpecificStats {
-    CollectionScanStats() : docsTested(0), direction(1) {}
+    CollectionScanStats() : docsTested(0), docBytesTested(0), direction(1), workers(0) {}
 
     SpecificStats* clone() const final {
         CollectionScanStats* specific = new CollectionScanStats(*this);
@@ -207,9 +226,15 @@ struct CollectionScanStats : public SpecificStats {
     // How many documents did we check against our filter?
     size_t docsTested;
 
+    // The total size of the documents checked against our filter.
+    long long docBytesTested;
+
     // >0 if we're traversing the collection forwards. <0 if we're traversing it
     // backwards.
     int direction;
+
+    // The number of threads the scan was split across, or 0 if it ran on the calling thread.
+    size_t workers;
 };
 
 struct CountStats : public SpecificStats {
@@ -229,6 +254,9 @@ struct CountStats : public SpecificStats {
     // A "trivial count" is one that we can answer by calling numRecords() on the
     // collection, without actually going through any query logic.
     bool trivialCount;
+
+    // The name of the counted index the count was answered from, if any.
+    std::string countedIndex;
 };
 
 struct CountScanStats : public SpecificStats {
@@ -238,7 +266,8 @@ struct CountScanStats : public SpecificStats {
           isPartial(false),
           isSparse(false),
           isUnique(false),
-          keysExamined(0) {}
+          keysExamined(0),
+          usedRangeCount(false) {}
 
     SpecificStats* clone() const final {
         CountScanStats* specific = new CountScanStats(*this);
@@ -259,6 +288,10 @@ struct CountScanStats : public SpecificStats {
     bool isUnique;
 
     size_t keysExamined;
+
+    // True if the count was answered from the index's order statistics rather than by
+    // scanning its keys.
+    bool usedRangeCount;
 };
 
 struct DeleteStats : public SpecificStats {
@@ -305,7 +338,12 @@ struct DistinctScanStats : public SpecificStats {
 };
 
 struct FetchStats : public SpecificStats {
-    FetchStats() : alreadyHasObj(0), forcedFetches(0), docsExamined(0) {}
+    FetchStats()
+        : alreadyHasObj(0),
+          forcedFetches(0),
+          docsExamined(0),
+          docBytesExamined(0),
+          fetchBatches(0) {}
 
     SpecificStats* clone() const final {
         FetchStats* specific = new FetchStats(*this);
@@ -320,6 +358,12 @@ struct FetchStats : public SpecificStats {
 
     // The total number of full documents touched by the fetch stage.
     size_t docsExamined;
+
+    // The total size of the documents touched by the fetch stage.
+    long long docBytesExamined;
+
+    // How many batches of RecordIds were looked up together, if batching is enabled.
+    size_t fetchBatches;
 };
 
 struct GroupStats : public SpecificStats {
@@ -362,7 +406,10 @@ struct IndexScanStats : public SpecificStats {
           dupsTested(0),
           dupsDropped(0),
           seenInvalidated(0),
-          keysExamined(0) {}
+          keysExamined(0),
+          isSkipScan(false),
+          mergedPointScans(0),
+          seeks(0) {}
 
     SpecificStats* clone() const final {
         IndexScanStats* specific = new IndexScanStats(*this);
@@ -405,6 +452,16 @@ struct IndexScanStats : public SpecificStats {
 
     // Number of entries retrieved from the index during the scan.
     size_t keysExamined;
+
+    // Whether the scan skips over the index's unconstrained first field.
+    bool isSkipScan;
+
+    // How many scans of the combinations of points of its leading fields the scan merged, or 0
+    // if it scanned its bounds in index order.
+    size_t mergedPointScans;
+
+    // Number of times the scan seeked forward to the next key within its bounds.
+    size_t seeks;
 };
 
 struct LimitStats : public SpecificStats {
@@ -462,7 +519,13 @@ struct ProjectionStats : public SpecificStats {
 };
 
 struct SortStats : public SpecificStats {
-    SortStats() : forcedFetches(0), memUsage(0), memLimit(0) {}
+    SortStats()
+        : forcedFetches(0),
+          memUsage(0),
+          memLimit(0),
+          allowDiskUse(false),
+          spills(0),
+          bytesSpilled(0) {}
 
     SpecificStats* clone() const final {
         SortStats* specific = new SortStats(*this);
@@ -483,6 +546,15 @@ struct SortStats : public SpecificStats {
 
     // The pattern according to which we are sorting.
     BSONObj sortPattern;
+
+    // Whether the sort may spill to disk.
+    bool allowDiskUse;
+
+    // How many times did we write buffered data out to a temporary file?
+    size_t spills;
+
+    // Approximately how many bytes of buffered data did those writes hold?
+    size_t bytesSpilled;
 };
 
 struct MergeSortStats : public SpecificStats {
@@ -504,7 +576,7 @@ struct MergeSortStats : public SpecificStats {
 };
 
 struct ShardingFilterStats : public SpecificStats {
-    ShardingFilterStats() : chunkSkips(0) {}
+    ShardingFilterStats() : chunkSkips(0), allKeysOwned(false) {}
 
     SpecificStats* clone() const final {
         ShardingFilterStats* specific = new ShardingFilterStats(*this);
@@ -512,6 +584,10 @@ struct ShardingFilterStats : public SpecificStats {
     }
 
     size_t chunkSkips;
+
+    // True if the child only returns documents whose shard key falls in one range of chunks
+    // owned by this shard, so that no document needs to be checked.
+    bool allKeysOwned;
 };
 
 struct SkipStats : public SpecificStats {
@@ -560,7 +636,8 @@ struct UpdateStats : public SpecificStats {
           fastmod(false),
           fastmodinsert(false),
           inserted(false),
-          nInvalidateSkips(0) {}
+          nInvalidateSkips(0),
+          nElementsMaterialized(0) {}
 
     SpecificStats* clone() const final {
         return new UpdateStats(*this);
@@ -595,6 +672,10 @@ struct UpdateStats : public SpecificStats {
     // be thrown out. The update stage skips over any results which do not have the
     // RecordId to update.
     size_t nInvalidateSkips;
+
+    // The number of elements of the matched documents which were expanded out of their
+    // serialized BSON in order to apply the mods. Untouched subtrees are never expanded.
+    size_t nElementsMaterialized;
 };
 
 struct TextStats : public SpecificStats {
@@ -626,7 +707,7 @@ struct TextMatchStats : public SpecificStats {
 };
 
 struct TextOrStats : public SpecificStats {
-    TextOrStats() : fetches(0) {}
+    TextOrStats() : fetches(0), limit(0), stoppedEarly(false) {}
 
     SpecificStats* clone() const final {
         TextOrStats* specific = new TextOrStats(*this);
@@ -634,6 +715,12 @@ struct TextOrStats : public SpecificStats {
     }
 
     size_t fetches;
+
+    // The number of highest scoring results the stage had to produce, or 0 if it returned all.
+    size_t limit;
+
+    // Whether the stage stopped reading the text index before the end of every term's keys.
+    bool stoppedEarly;
 };
 
 }  // namespace mongo
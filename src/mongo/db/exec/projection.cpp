@@ -49,6 +49,44 @@ using stdx::make_unique;
 
 static const char* kIdField = "_id";
 
+namespace {
+
+/**
+ * Appends the values in 'fields', each paired with the path of the field it's the value of, to
+ * 'bob'.  The values of dotted paths which share their first component go in one subobject.
+ */
+void appendNestedFields(const vector<std::pair<StringData, BSONElement>>& fields,
+                        BSONObjBuilder* bob) {
+    vector<bool> appended(fields.size(), false);
+    for (size_t i = 0; i < fields.size(); ++i) {
+        if (appended[i]) {
+            continue;
+        }
+
+        const StringData path = fields[i].first;
+        const size_t dot = path.find('.');
+        if (std::string::npos == dot) {
+            bob->appendAs(fields[i].second, path);
+            continue;
+        }
+
+        const StringData head = path.substr(0, dot);
+        vector<std::pair<StringData, BSONElement>> subfields;
+        for (size_t j = i; j < fields.size(); ++j) {
+            const StringData other = fields[j].first;
+            if (!appended[j] && other.size() > dot && '.' == other[dot] &&
+                other.substr(0, dot) == head) {
+                subfields.push_back(std::make_pair(other.substr(dot + 1), fields[j].second));
+                appended[j] = true;
+            }
+        }
+        BSONObjBuilder subBob(bob->subobjStart(head));
+        appendNestedFields(subfields, &subBob);
+    }
+}
+
+}  // namespace
+
 // static
 const char* ProjectionStage::kStageType = "PROJECTION";
 
@@ -56,7 +94,10 @@ ProjectionStage::ProjectionStage(OperationContext* opCtx,
                                  const ProjectionStageParams& params,
                                  WorkingSet* ws,
                                  PlanStage* child)
-    : PlanStage(kStageType, opCtx), _ws(ws), _projImpl(params.projImpl) {
+    : PlanStage(kStageType, opCtx),
+      _ws(ws),
+      _projImpl(params.projImpl),
+      _hasDottedField(false) {
     _children.emplace_back(child);
     _projObj = params.projObj;
 
@@ -96,6 +137,9 @@ ProjectionStage::ProjectionStage(OperationContext* opCtx,
                     // If we are including this key field store its field name.
                     _keyFieldNames.push_back(*fieldIt);
                     _includeKey.push_back(true);
+                    if (fieldIt->find('.') != std::string::npos) {
+                        _hasDottedField = true;
+                    }
                 }
             }
         } else {
@@ -163,8 +207,40 @@ Status ProjectionStage::transform(WorkingSetMember* member) {
         // If we got here because of SIMPLE_DOC the planner shouldn't have messed up.
         invariant(member->hasObj());
 
-        // Apply the SIMPLE_DOC projection.
-        transformSimpleInclusion(member->obj.value(), _includedFields, bob);
+        if (_hasDottedField) {
+            // Only the COVERED_ONE_INDEX path takes dotted fields, so the fields we want are
+            // those of the key.
+            const BSONObj& obj = member->obj.value();
+            vector<std::pair<StringData, BSONElement>> fields;
+            for (size_t i = 0; i < _keyFieldNames.size(); ++i) {
+                if (!_includeKey[i]) {
+                    continue;
+                }
+                BSONElement elt = obj.getFieldDotted(_keyFieldNames[i]);
+                if (!elt.eoo()) {
+                    fields.push_back(std::make_pair(_keyFieldNames[i], elt));
+                }
+            }
+            appendNestedFields(fields, &bob);
+        } else {
+            // Apply the SIMPLE_DOC projection.
+            transformSimpleInclusion(member->obj.value(), _includedFields, bob);
+        }
+    } else if (_hasDottedField) {
+        invariant(ProjectionStageParams::COVERED_ONE_INDEX == _projImpl);
+        // We're pulling data out of the key, and must nest the values of dotted fields.
+        invariant(1 == member->keyData.size());
+        vector<std::pair<StringData, BSONElement>> fields;
+        size_t keyIndex = 0;
+        BSONObjIterator keyIterator(member->keyData[0].keyData);
+        while (keyIterator.more()) {
+            BSONElement elt = keyIterator.next();
+            if (_includeKey[keyIndex]) {
+                fields.push_back(std::make_pair(_keyFieldNames[keyIndex], elt));
+            }
+            ++keyIndex;
+        }
+        appendNestedFields(fields, &bob);
     } else {
         invariant(ProjectionStageParams::COVERED_ONE_INDEX == _projImpl);
         // We're pulling data out of the key.
@@ -192,17 +268,36 @@ Status ProjectionStage::transform(WorkingSetMember* member) {
 }
 
 bool ProjectionStage::isEOF() {
-    return child()->isEOF();
+    return childIsEOF();
 }
 
 PlanStage::StageState ProjectionStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
+
+    return doWork(out);
+}
+
+PlanStage::StageState ProjectionStage::workBatch(size_t maxWorks,
+                                                 std::vector<WorkingSetID>* results,
+                                                 WorkingSetID* out) {
+    ScopedTimer timer(&_commonStats);
+
+    pullChildBatch(maxWorks);
+    return runWorkBatch(_ws, maxWorks, true, results, out, [this](WorkingSetID* id) {
+        return doWork(id);
+    });
+}
+
+bool ProjectionStage::supportsWorkBatch() const {
+    return child()->supportsWorkBatch();
+}
 
+PlanStage::StageState ProjectionStage::doWork(WorkingSetID* out) {
     WorkingSetID id = WorkingSet::INVALID_ID;
-    StageState status = child()->work(&id);
+    StageState status = workChild(&id);
 
     // Note that we don't do the normal if isEOF() return EOF thing here.  Our child might be a
     // tailable cursor and isEOF() would be true even if it had more data...
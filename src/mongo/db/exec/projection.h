@@ -82,6 +82,10 @@ public:
 
     bool isEOF() final;
     StageState work(WorkingSetID* out) final;
+    StageState workBatch(size_t maxWorks,
+                         std::vector<WorkingSetID>* results,
+                         WorkingSetID* out) final;
+    bool supportsWorkBatch() const final;
 
     StageType stageType() const final {
         return STAGE_PROJECTION;
@@ -113,6 +117,11 @@ public:
     static const char* kStageType;
 
 private:
+    /**
+     * Does the work of work(), which adds the stats and timing common to work() and workBatch().
+     */
+    StageState doWork(WorkingSetID* out);
+
     Status transform(WorkingSetMember* member);
 
     std::unique_ptr<ProjectionExec> _exec;
@@ -144,6 +153,10 @@ private:
 
     // If the i-th entry of _includeKey is true this is the field name for the i-th key field.
     std::vector<StringData> _keyFieldNames;
+
+    // Whether any of the key fields we include is dotted, so that we must nest its value in a
+    // subobject of the output.
+    bool _hasDottedField;
 };
 
 }  // namespace mongo
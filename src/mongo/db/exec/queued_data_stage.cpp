@@ -47,8 +47,26 @@ PlanStage::StageState QueuedDataStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
+    return doWork(out);
+}
+
+PlanStage::StageState QueuedDataStage::workBatch(size_t maxWorks,
+                                                 std::vector<WorkingSetID>* results,
+                                                 WorkingSetID* out) {
+    ScopedTimer timer(&_commonStats);
+
+    return runWorkBatch(_ws, maxWorks, false, results, out, [this](WorkingSetID* id) {
+        return doWork(id);
+    });
+}
+
+bool QueuedDataStage::supportsWorkBatch() const {
+    return true;
+}
+
+PlanStage::StageState QueuedDataStage::doWork(WorkingSetID* out) {
     if (isEOF()) {
         return PlanStage::IS_EOF;
     }
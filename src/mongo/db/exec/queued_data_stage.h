@@ -50,6 +50,10 @@ public:
     QueuedDataStage(OperationContext* opCtx, WorkingSet* ws);
 
     StageState work(WorkingSetID* out) final;
+    StageState workBatch(size_t maxWorks,
+                         std::vector<WorkingSetID>* results,
+                         WorkingSetID* out) final;
+    bool supportsWorkBatch() const final;
 
     bool isEOF() final;
 
@@ -90,6 +94,11 @@ public:
     static const char* kStageType;
 
 private:
+    /**
+     * Does the work of work(), which adds the stats and timing common to work() and workBatch().
+     */
+    StageState doWork(WorkingSetID* out);
+
     // We don't own this.
     WorkingSet* _ws;
 
@@ -106,4 +106,64 @@ TEST(QueuedDataStageTest, validateStats) {
     unique_ptr<PlanStageStats> allStats(mock->getStats());
     ASSERT_TRUE(stats->isEOF);
 }
+
+//
+// Test that a traced stage also counts the precise time of its work.
+//
+TEST(QueuedDataStageTest, tracingCountsPreciseTime) {
+    WorkingSet ws;
+    WorkingSetID wsID;
+    auto mock = make_unique<QueuedDataStage>(nullptr, &ws);
+    const CommonStats* stats = mock->getCommonStats();
+
+    mock->pushBack(PlanStage::NEED_TIME);
+    mock->work(&wsID);
+    ASSERT_FALSE(stats->traced);
+    ASSERT_EQUALS(stats->executionTimeNanos, 0);
+
+    mock->enableTracing();
+    ASSERT_TRUE(stats->traced);
+    mock->pushBack(PlanStage::NEED_TIME);
+    mock->work(&wsID);
+    ASSERT_GREATER_THAN(stats->executionTimeNanos, 0);
+
+    unique_ptr<PlanStageStats> allStats(mock->getStats());
+    ASSERT_TRUE(allStats->common.traced);
+    ASSERT_EQUALS(allStats->common.executionTimeNanos, stats->executionTimeNanos);
+}
+
+//
+// Test that workBatch() returns the results queued before the first state which isn't
+// ADVANCED or NEED_TIME, and resumes after it.
+//
+TEST(QueuedDataStageTest, workBatchStopsAtNeedYield) {
+    WorkingSet ws;
+    auto mock = make_unique<QueuedDataStage>(nullptr, &ws);
+    WorkingSetID first = ws.allocate();
+    WorkingSetID second = ws.allocate();
+    WorkingSetID third = ws.allocate();
+    mock->pushBack(first);
+    mock->pushBack(PlanStage::NEED_TIME);
+    mock->pushBack(second);
+    mock->pushBack(PlanStage::NEED_YIELD);
+    mock->pushBack(third);
+
+    std::vector<WorkingSetID> results;
+    WorkingSetID wsID = WorkingSet::INVALID_ID;
+    ASSERT_EQUALS(PlanStage::NEED_YIELD, mock->workBatch(10, &results, &wsID));
+    ASSERT_EQUALS(2U, results.size());
+    ASSERT_EQUALS(first, results[0]);
+    ASSERT_EQUALS(second, results[1]);
+
+    // Only one unit of work is left before EOF.
+    results.clear();
+    ASSERT_EQUALS(PlanStage::NEED_TIME, mock->workBatch(1, &results, &wsID));
+    ASSERT_EQUALS(1U, results.size());
+    ASSERT_EQUALS(third, results[0]);
+    ASSERT_EQUALS(PlanStage::IS_EOF, mock->workBatch(10, &results, &wsID));
+
+    const CommonStats* stats = mock->getCommonStats();
+    ASSERT_EQUALS(stats->works, 6U);
+    ASSERT_EQUALS(stats->advanced, 3U);
+}
 }
@@ -0,0 +1,249 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/record_id_bitmap.h"
+
+#include <algorithm>
+
+#include "mongo/platform/bits.h"
+
+namespace mongo {
+
+namespace {
+
+// A container switches from an array to a bitset once its array would take more space than the
+// 8KB bitset.
+const size_t kMaxArraySize = 4096;
+const size_t kBitsetWords = (1 << 16) / 64;
+
+// Rough per-container overhead of the std::map node.
+const size_t kContainerOverheadBytes = 64;
+
+int64_t highBits(const RecordId& id) {
+    return id.repr() >> 16;
+}
+
+uint16_t lowBits(const RecordId& id) {
+    return static_cast<uint16_t>(id.repr() & 0xFFFF);
+}
+
+}  // namespace
+
+void RecordIdBitmap::add(const RecordId& id) {
+    std::pair<ContainerMap::iterator, bool> inserted =
+        _containers.insert(std::make_pair(highBits(id), Container()));
+    Container& container = inserted.first->second;
+    if (inserted.second) {
+        _memUsage += kContainerOverheadBytes;
+    }
+
+    const size_t memUsageBefore = container.getMemUsage();
+    if (container.add(lowBits(id))) {
+        ++_size;
+        _memUsage += container.getMemUsage() - memUsageBefore;
+    }
+}
+
+bool RecordIdBitmap::remove(const RecordId& id) {
+    ContainerMap::iterator it = _containers.find(highBits(id));
+    if (it == _containers.end()) {
+        return false;
+    }
+
+    const size_t memUsageBefore = it->second.getMemUsage();
+    if (!it->second.remove(lowBits(id))) {
+        return false;
+    }
+    _memUsage -= memUsageBefore;
+
+    if (it->second.size() == 0) {
+        _memUsage -= kContainerOverheadBytes;
+        _containers.erase(it);
+    } else {
+        _memUsage += it->second.getMemUsage();
+    }
+    --_size;
+    return true;
+}
+
+bool RecordIdBitmap::contains(const RecordId& id) const {
+    ContainerMap::const_iterator it = _containers.find(highBits(id));
+    return it != _containers.end() && it->second.contains(lowBits(id));
+}
+
+void RecordIdBitmap::intersectWith(const RecordIdBitmap& other) {
+    _size = 0;
+    _memUsage = 0;
+    ContainerMap::iterator it = _containers.begin();
+    ContainerMap::const_iterator otherIt = other._containers.begin();
+    while (it != _containers.end()) {
+        while (otherIt != other._containers.end() && otherIt->first < it->first) {
+            ++otherIt;
+        }
+
+        if (otherIt == other._containers.end() || otherIt->first != it->first) {
+            it = _containers.erase(it);
+            continue;
+        }
+
+        it->second.intersectWith(otherIt->second);
+        if (it->second.size() == 0) {
+            it = _containers.erase(it);
+            continue;
+        }
+
+        _size += it->second.size();
+        _memUsage += kContainerOverheadBytes + it->second.getMemUsage();
+        ++it;
+    }
+}
+
+void RecordIdBitmap::clear() {
+    _containers.clear();
+    _size = 0;
+    _memUsage = 0;
+}
+
+bool RecordIdBitmap::Container::add(uint16_t low) {
+    if (isBitset()) {
+        uint64_t& word = _bits[low / 64];
+        const uint64_t mask = uint64_t(1) << (low % 64);
+        if (word & mask) {
+            return false;
+        }
+        word |= mask;
+        ++_size;
+        return true;
+    }
+
+    std::vector<uint16_t>::iterator it = std::lower_bound(_array.begin(), _array.end(), low);
+    if (it != _array.end() && *it == low) {
+        return false;
+    }
+    _array.insert(it, low);
+    ++_size;
+
+    if (_size > kMaxArraySize) {
+        convertToBitset();
+    }
+    return true;
+}
+
+bool RecordIdBitmap::Container::remove(uint16_t low) {
+    if (isBitset()) {
+        uint64_t& word = _bits[low / 64];
+        const uint64_t mask = uint64_t(1) << (low % 64);
+        if (!(word & mask)) {
+            return false;
+        }
+        word &= ~mask;
+        --_size;
+        return true;
+    }
+
+    std::vector<uint16_t>::iterator it = std::lower_bound(_array.begin(), _array.end(), low);
+    if (it == _array.end() || *it != low) {
+        return false;
+    }
+    _array.erase(it);
+    --_size;
+    return true;
+}
+
+bool RecordIdBitmap::Container::contains(uint16_t low) const {
+    if (isBitset()) {
+        return _bits[low / 64] & (uint64_t(1) << (low % 64));
+    }
+    return std::binary_search(_array.begin(), _array.end(), low);
+}
+
+void RecordIdBitmap::Container::intersectWith(const Container& other) {
+    if (isBitset() && other.isBitset()) {
+        _size = 0;
+        for (size_t i = 0; i < kBitsetWords; ++i) {
+            _bits[i] &= other._bits[i];
+            for (uint64_t word = _bits[i]; word; word &= word - 1) {
+                ++_size;
+            }
+        }
+        if (_size <= kMaxArraySize) {
+            convertToArray();
+        }
+        return;
+    }
+
+    if (isBitset()) {
+        // The result is no larger than 'other', so build it as an array.
+        std::vector<uint16_t> result;
+        for (uint16_t low : other._array) {
+            if (contains(low)) {
+                result.push_back(low);
+            }
+        }
+        _bits.clear();
+        _array.swap(result);
+        _size = _array.size();
+        return;
+    }
+
+    std::vector<uint16_t>::iterator out = _array.begin();
+    for (uint16_t low : _array) {
+        if (other.contains(low)) {
+            *out++ = low;
+        }
+    }
+    _array.erase(out, _array.end());
+    _size = _array.size();
+}
+
+size_t RecordIdBitmap::Container::getMemUsage() const {
+    return isBitset() ? kBitsetWords * sizeof(uint64_t) : _array.capacity() * sizeof(uint16_t);
+}
+
+void RecordIdBitmap::Container::convertToBitset() {
+    _bits.assign(kBitsetWords, 0);
+    for (uint16_t low : _array) {
+        _bits[low / 64] |= uint64_t(1) << (low % 64);
+    }
+    std::vector<uint16_t>().swap(_array);
+}
+
+void RecordIdBitmap::Container::convertToArray() {
+    _array.clear();
+    _array.reserve(_size);
+    for (size_t i = 0; i < kBitsetWords; ++i) {
+        for (uint64_t word = _bits[i]; word; word &= word - 1) {
+            _array.push_back(static_cast<uint16_t>(i * 64 + countTrailingZeros64(word)));
+        }
+    }
+    std::vector<uint64_t>().swap(_bits);
+}
+
+}  // namespace mongo
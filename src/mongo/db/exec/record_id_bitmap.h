@@ -0,0 +1,129 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "mongo/db/record_id.h"
+
+namespace mongo {
+
+/**
+ * A compressed set of RecordIds, laid out like a roaring bitmap. Each RecordId is split into its
+ * high 48 bits, which select a container, and its low 16 bits, which are stored in that
+ * container. A container holds a sorted array of the low bits while it is sparse, and switches
+ * to a bitset over all 2^16 values once the array would be larger than the bitset.
+ *
+ * Dense runs of RecordIds, such as those handed out by storage engines which number records
+ * sequentially, cost about one bit each.
+ */
+class RecordIdBitmap {
+public:
+    /**
+     * Adds 'id' to the set. Adding an id which is already present has no effect.
+     */
+    void add(const RecordId& id);
+
+    /**
+     * Removes 'id' from the set. Returns true if it was present.
+     */
+    bool remove(const RecordId& id);
+
+    bool contains(const RecordId& id) const;
+
+    /**
+     * Removes every id which is not also in 'other'.
+     */
+    void intersectWith(const RecordIdBitmap& other);
+
+    void clear();
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    /**
+     * Returns the number of ids in the set.
+     */
+    size_t size() const {
+        return _size;
+    }
+
+    /**
+     * Returns an estimate of the memory used by the set, in bytes.
+     */
+    size_t getMemUsage() const {
+        return sizeof(*this) + _memUsage;
+    }
+
+private:
+    class Container {
+    public:
+        bool add(uint16_t low);
+        bool remove(uint16_t low);
+        bool contains(uint16_t low) const;
+        void intersectWith(const Container& other);
+
+        size_t size() const {
+            return _size;
+        }
+
+        size_t getMemUsage() const;
+
+    private:
+        bool isBitset() const {
+            return !_bits.empty();
+        }
+
+        void convertToBitset();
+        void convertToArray();
+
+        // The low bits in the container, in ascending order, while it isn't a bitset.
+        std::vector<uint16_t> _array;
+
+        // One bit for each of the 2^16 possible low bits, or empty while the container is an
+        // array.
+        std::vector<uint64_t> _bits;
+
+        size_t _size = 0;
+    };
+
+    // Keyed on the high 48 bits of the ids in each container.
+    typedef std::map<int64_t, Container> ContainerMap;
+    ContainerMap _containers;
+
+    size_t _size = 0;
+
+    // The memory used by the containers, kept up to date as they change.
+    size_t _memUsage = 0;
+};
+
+}  // namespace mongo
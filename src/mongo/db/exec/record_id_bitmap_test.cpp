@@ -0,0 +1,125 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/exec/record_id_bitmap.cpp
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/record_id_bitmap.h"
+#include "mongo/unittest/unittest.h"
+
+using namespace mongo;
+
+namespace {
+
+TEST(RecordIdBitmapTest, AddRemoveContains) {
+    RecordIdBitmap bitmap;
+    ASSERT_TRUE(bitmap.empty());
+
+    bitmap.add(RecordId(5));
+    bitmap.add(RecordId(1 << 20));
+    bitmap.add(RecordId(5));
+    ASSERT_EQUALS(2U, bitmap.size());
+    ASSERT_TRUE(bitmap.contains(RecordId(5)));
+    ASSERT_TRUE(bitmap.contains(RecordId(1 << 20)));
+    ASSERT_FALSE(bitmap.contains(RecordId(6)));
+    ASSERT_FALSE(bitmap.contains(RecordId((1 << 20) + 5)));
+
+    ASSERT_TRUE(bitmap.remove(RecordId(5)));
+    ASSERT_FALSE(bitmap.remove(RecordId(5)));
+    ASSERT_FALSE(bitmap.remove(RecordId(7)));
+    ASSERT_EQUALS(1U, bitmap.size());
+    ASSERT_FALSE(bitmap.contains(RecordId(5)));
+
+    bitmap.clear();
+    ASSERT_TRUE(bitmap.empty());
+    ASSERT_FALSE(bitmap.contains(RecordId(1 << 20)));
+}
+
+TEST(RecordIdBitmapTest, DenseIdsAreCompact) {
+    const int64_t n = 100 * 1000;
+    RecordIdBitmap bitmap;
+    for (int64_t i = n; i > 0; --i) {
+        bitmap.add(RecordId(i));
+    }
+    ASSERT_EQUALS(static_cast<size_t>(n), bitmap.size());
+    for (int64_t i = 1; i <= n; ++i) {
+        ASSERT_TRUE(bitmap.contains(RecordId(i)));
+    }
+    ASSERT_FALSE(bitmap.contains(RecordId(n + 1)));
+
+    // A little over one bit per id.
+    ASSERT_LESS_THAN(bitmap.getMemUsage(), static_cast<size_t>(n / 4));
+}
+
+TEST(RecordIdBitmapTest, IntersectSparseAndDense) {
+    RecordIdBitmap evens;
+    RecordIdBitmap multiplesOfThree;
+    RecordIdBitmap sparse;
+    for (int64_t i = 1; i <= 200 * 1000; ++i) {
+        if (i % 2 == 0) {
+            evens.add(RecordId(i));
+        }
+        if (i % 3 == 0) {
+            multiplesOfThree.add(RecordId(i));
+        }
+        if (i % 1000 == 0) {
+            sparse.add(RecordId(i));
+        }
+    }
+    sparse.add(RecordId(300 * 1000));
+
+    // Bitset containers intersected with bitset containers.
+    evens.intersectWith(multiplesOfThree);
+    ASSERT_EQUALS(static_cast<size_t>(200 * 1000 / 6), evens.size());
+    ASSERT_TRUE(evens.contains(RecordId(6)));
+    ASSERT_FALSE(evens.contains(RecordId(4)));
+    ASSERT_FALSE(evens.contains(RecordId(9)));
+
+    // Bitset containers intersected with array containers, and containers of which the other
+    // set has none.
+    evens.intersectWith(sparse);
+    ASSERT_EQUALS(static_cast<size_t>(200 / 3), evens.size());
+    ASSERT_TRUE(evens.contains(RecordId(3000)));
+    ASSERT_FALSE(evens.contains(RecordId(2000)));
+    ASSERT_FALSE(evens.contains(RecordId(300 * 1000)));
+
+    // Array containers intersected with bitset containers.
+    sparse.intersectWith(multiplesOfThree);
+    ASSERT_EQUALS(static_cast<size_t>(200 / 3), sparse.size());
+    ASSERT_TRUE(sparse.contains(RecordId(3000)));
+
+    // Intersecting with an empty set leaves nothing.
+    sparse.intersectWith(RecordIdBitmap());
+    ASSERT_TRUE(sparse.empty());
+    ASSERT_FALSE(sparse.contains(RecordId(3000)));
+}
+
+}  // namespace
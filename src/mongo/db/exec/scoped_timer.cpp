@@ -30,16 +30,30 @@
 
 #include "mongo/db/exec/scoped_timer.h"
 
+#include "mongo/db/exec/plan_stats.h"
+#include "mongo/util/allocation_counter.h"
 #include "mongo/util/net/listen.h"
+#include "mongo/util/system_tick_source.h"
 
 namespace mongo {
 
-ScopedTimer::ScopedTimer(long long* counter)
-    : _counter(counter), _start(Listener::getElapsedTimeMillis()) {}
+ScopedTimer::ScopedTimer(CommonStats* stats)
+    : _stats(stats),
+      _start(Listener::getElapsedTimeMillis()),
+      _startTicks(stats->traced ? SystemTickSource::get()->getTicks() : 0),
+      _startBytesAllocated(stats->traced ? AllocationCounter::threadBytesAllocated() : 0) {}
 
 ScopedTimer::~ScopedTimer() {
     long long elapsed = Listener::getElapsedTimeMillis() - _start;
-    *_counter += elapsed;
+    _stats->executionTimeMillis += elapsed;
+
+    if (_stats->traced) {
+        TickSource* tickSource = SystemTickSource::get();
+        const TickSource::Tick elapsedTicks = tickSource->getTicks() - _startTicks;
+        _stats->executionTimeNanos += static_cast<long long>(
+            elapsedTicks * 1.0e9 / tickSource->getTicksPerSecond());
+        _stats->bytesAllocated += AllocationCounter::threadBytesAllocated() - _startBytesAllocated;
+    }
 }
 
 }  // namespace mongo
@@ -28,19 +28,24 @@
 
 #pragma once
 
+#include <cstdint>
+
 #include "mongo/base/disallow_copying.h"
 
 namespace mongo {
 
+struct CommonStats;
+
 /**
- * This class increments a counter by a rough estimate of the time elapsed since its
- * construction when it goes out of scope.
+ * This class increments the execution time of a stage by a rough estimate of the time elapsed
+ * since its construction when it goes out of scope. If the stage is traced, it also adds the
+ * precise time elapsed and the bytes the thread allocated meanwhile.
  */
 class ScopedTimer {
     MONGO_DISALLOW_COPYING(ScopedTimer);
 
 public:
-    ScopedTimer(long long* counter);
+    ScopedTimer(CommonStats* stats);
 
     ~ScopedTimer();
 
@@ -48,11 +53,16 @@ private:
     // Default constructor disallowed.
     ScopedTimer();
 
-    // Reference to the counter that we are incrementing with the elapsed time.
-    long long* _counter;
+    // The stats of the stage that we are timing.
+    CommonStats* _stats;
 
     // Time at which the timer was constructed.
     long long _start;
+
+    // Tick count and bytes allocated by the thread when the timer was constructed, if the stage
+    // is traced.
+    int64_t _startTicks;
+    uint64_t _startBytesAllocated;
 };
 
 }  // namespace mongo
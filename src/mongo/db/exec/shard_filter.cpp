@@ -53,9 +53,11 @@ const char* ShardFilterStage::kStageType = "SHARDING_FILTER";
 ShardFilterStage::ShardFilterStage(OperationContext* opCtx,
                                    const shared_ptr<CollectionMetadata>& metadata,
                                    WorkingSet* ws,
-                                   PlanStage* child)
+                                   PlanStage* child,
+                                   bool allKeysOwned)
     : PlanStage(kStageType, opCtx), _ws(ws), _metadata(metadata) {
     _children.emplace_back(child);
+    _specificStats.allKeysOwned = allKeysOwned;
 }
 
 ShardFilterStage::~ShardFilterStage() {}
@@ -68,7 +70,7 @@ PlanStage::StageState ShardFilterStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     // If we've returned as many results as we're limited to, isEOF will be true.
     if (isEOF()) {
@@ -81,7 +83,7 @@ PlanStage::StageState ShardFilterStage::work(WorkingSetID* out) {
         // If we're sharded make sure that we don't return data that is not owned by us,
         // including pending documents from in-progress migrations and orphaned documents from
         // aborted migrations
-        if (_metadata) {
+        if (_metadata && !_specificStats.allKeysOwned) {
             ShardKeyPattern shardKeyPattern(_metadata->getKeyPattern());
             WorkingSetMember* member = _ws->get(*out);
             WorkingSetMatchableDocument matchable(member);
@@ -112,7 +114,7 @@ PlanStage::StageState ShardFilterStage::work(WorkingSetID* out) {
                           << "document may have been inserted manually into shard";
             }
 
-            if (!_metadata->keyBelongsToMe(shardKey)) {
+            if (!_metadata->keyStringBelongsToMe(shardKey, &_shardKeyScratch)) {
                 _ws->free(*out);
                 ++_specificStats.chunkSkips;
                 return PlanStage::NEED_TIME;
@@ -29,6 +29,7 @@
 #pragma once
 
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/storage/key_string.h"
 
 namespace mongo {
 
@@ -71,10 +72,15 @@ class CollectionMetadata;
  */
 class ShardFilterStage final : public PlanStage {
 public:
+    /**
+     * 'allKeysOwned' tells that the child only returns documents from a range of shard keys
+     * which 'metadata' owns entirely, in which case documents pass through unchecked.
+     */
     ShardFilterStage(OperationContext* opCtx,
                      const std::shared_ptr<CollectionMetadata>& metadata,
                      WorkingSet* ws,
-                     PlanStage* child);
+                     PlanStage* child,
+                     bool allKeysOwned = false);
     ~ShardFilterStage();
 
     bool isEOF() final;
@@ -99,6 +105,9 @@ private:
     // Note: it is important that this is the metadata from the time this stage is constructed.
     // See class comment for details.
     const std::shared_ptr<CollectionMetadata> _metadata;
+
+    // Holds the encoding of the shard key of the document being checked
+    KeyString _shardKeyScratch;
 };
 
 }  // namespace mongo
@@ -49,17 +49,36 @@ SkipStage::SkipStage(OperationContext* opCtx, long long toSkip, WorkingSet* ws,
 SkipStage::~SkipStage() {}
 
 bool SkipStage::isEOF() {
-    return child()->isEOF();
+    return childIsEOF();
 }
 
 PlanStage::StageState SkipStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
+    return doWork(out);
+}
+
+PlanStage::StageState SkipStage::workBatch(size_t maxWorks,
+                                           std::vector<WorkingSetID>* results,
+                                           WorkingSetID* out) {
+    ScopedTimer timer(&_commonStats);
+
+    pullChildBatch(maxWorks);
+    return runWorkBatch(_ws, maxWorks, true, results, out, [this](WorkingSetID* id) {
+        return doWork(id);
+    });
+}
+
+bool SkipStage::supportsWorkBatch() const {
+    return child()->supportsWorkBatch();
+}
+
+PlanStage::StageState SkipStage::doWork(WorkingSetID* out) {
     WorkingSetID id = WorkingSet::INVALID_ID;
-    StageState status = child()->work(&id);
+    StageState status = workChild(&id);
 
     if (PlanStage::ADVANCED == status) {
         // If we're still skipping results...
@@ -42,6 +42,7 @@
 #include "mongo/db/query/lite_parsed_query.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/storage_options.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
 
@@ -68,6 +69,46 @@ bool SortStage::WorkingSetComparator::operator()(const SortableDataItem& lhs,
     return lhs.loc < rhs.loc;
 }
 
+void SortStage::SpilledMember::serializeForSorter(BufBuilder& buf) const {
+    obj.serializeForSorter(buf);
+    loc.serializeForSorter(buf);
+    computed.serializeForSorter(buf);
+}
+
+// static
+SortStage::SpilledMember SortStage::SpilledMember::deserializeForSorter(
+    BufReader& buf, const SorterDeserializeSettings&) {
+    SpilledMember member;
+    member.obj = BSONObj::deserializeForSorter(buf, BSONObj::SorterDeserializeSettings());
+    member.loc = RecordId::deserializeForSorter(buf, RecordId::SorterDeserializeSettings());
+    member.computed = BSONObj::deserializeForSorter(buf, BSONObj::SorterDeserializeSettings());
+    return member;
+}
+
+int SortStage::SpilledMember::memUsageForSorter() const {
+    return sizeof(SpilledMember) + obj.objsize() + computed.objsize();
+}
+
+SortStage::SpilledMember SortStage::SpilledMember::getOwned() const {
+    SpilledMember member;
+    member.obj = obj.getOwned();
+    member.loc = loc;
+    member.computed = computed.getOwned();
+    return member;
+}
+
+SortStage::SpillComparator::SpillComparator(BSONObj p) : pattern(p) {}
+
+int SortStage::SpillComparator::operator()(const SpillSorter::Data& lhs,
+                                            const SpillSorter::Data& rhs) const {
+    // False means ignore field names.
+    int result = lhs.first.woCompare(rhs.first, pattern, false);
+    if (0 != result) {
+        return result;
+    }
+    return lhs.second.loc.compare(rhs.second.loc);
+}
+
 SortStage::SortStage(OperationContext* opCtx,
                      const SortStageParams& params,
                      WorkingSet* ws,
@@ -77,6 +118,7 @@ SortStage::SortStage(OperationContext* opCtx,
       _ws(ws),
       _pattern(params.pattern),
       _limit(params.limit),
+      _allowDiskUse(params.allowDiskUse),
       _sorted(false),
       _resultIterator(_data.end()),
       _memUsage(0) {
@@ -85,11 +127,19 @@ SortStage::SortStage(OperationContext* opCtx,
     BSONObj sortComparator = FindCommon::transformSortSpec(_pattern);
     _sortKeyComparator = stdx::make_unique<WorkingSetComparator>(sortComparator);
 
-    // If limit > 1, we need to initialize _dataSet here to maintain ordered set of data items while
-    // fetching from the child stage.
+    if (_allowDiskUse) {
+        SortOptions opts;
+        opts.limit = _limit;
+        opts.maxMemoryUsageBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes);
+        opts.extSortAllowed = true;
+        opts.tempDir = storageGlobalParams.dbpath + "/_tmp";
+        _spillSorter.reset(SpillSorter::make(opts, SpillComparator(sortComparator)));
+        return;
+    }
+
+    // If limit > 1, the heap never holds more than 'limit' items.
     if (_limit > 1) {
-        const WorkingSetComparator& cmp = *_sortKeyComparator;
-        _dataSet.reset(new SortableDataItemSet(cmp));
+        _data.reserve(_limit);
     }
 }
 
@@ -98,17 +148,21 @@ SortStage::~SortStage() {}
 bool SortStage::isEOF() {
     // We're done when our child has no more results, we've sorted the child's results, and
     // we've returned all sorted results.
-    return child()->isEOF() && _sorted && (_data.end() == _resultIterator);
+    if (!child()->isEOF() || !_sorted) {
+        return false;
+    }
+    return _spillIterator ? !_spillIterator->more() : _data.end() == _resultIterator;
 }
 
 PlanStage::StageState SortStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
+    // An external sort stays within its memory limit by spilling instead.
     const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes);
-    if (_memUsage > maxBytes) {
+    if (!_allowDiskUse && _memUsage > maxBytes) {
         mongoutils::str::stream ss;
         ss << "Sort operation used more than the maximum " << maxBytes
            << " bytes of RAM. Add an index, or specify a smaller limit.";
@@ -132,11 +186,13 @@ PlanStage::StageState SortStage::work(WorkingSetID* out) {
             // the WorkingSet as quickly as possible to handle it.
             WorkingSetMember* member = _ws->get(id);
 
-            // Planner must put a fetch before we get here.
-            verify(member->hasObj());
+            // Planner must put a fetch before we get here, unless the sort key can be read from
+            // the index key and only the documents in the top results are fetched.
+            verify(member->hasObj() || (!_allowDiskUse && !member->keyData.empty()));
 
-            // We might be sorting something that was invalidated at some point.
-            if (member->hasLoc()) {
+            // We might be sorting something that was invalidated at some point. Members copied
+            // into the external sorter leave the working set right away, so need no entry.
+            if (!_allowDiskUse && member->hasLoc()) {
                 _wsidByDiskLoc[member->loc] = id;
             }
 
@@ -154,15 +210,30 @@ PlanStage::StageState SortStage::work(WorkingSetID* out) {
                 item.loc = member->loc;
             }
 
-            addToBuffer(item);
+            if (_allowDiskUse) {
+                addToSpillSorter(item);
+            } else {
+                addToBuffer(item);
+            }
 
             ++_commonStats.needTime;
             return PlanStage::NEED_TIME;
         } else if (PlanStage::IS_EOF == code) {
             // TODO: We don't need the lock for this.  We could ask for a yield and do this work
             // unlocked.  Also, this is performing a lot of work for one call to work(...)
-            sortBuffer();
-            _resultIterator = _data.begin();
+            if (_allowDiskUse) {
+                const int numFilesBefore = _spillSorter->numFiles();
+                const size_t memUsedBefore = _spillSorter->memUsed();
+                _spillIterator.reset(_spillSorter->done());
+                if (_spillSorter->numFiles() > numFilesBefore) {
+                    ++_specificStats.spills;
+                    _specificStats.bytesSpilled += memUsedBefore;
+                }
+                _spillSorter.reset();
+            } else {
+                sortBuffer();
+                _resultIterator = _data.begin();
+            }
             _sorted = true;
             ++_commonStats.needTime;
             return PlanStage::NEED_TIME;
@@ -189,6 +260,12 @@ PlanStage::StageState SortStage::work(WorkingSetID* out) {
     }
 
     // Returning results.
+    if (_spillIterator) {
+        *out = allocateFromSpillIterator();
+        ++_commonStats.advanced;
+        return PlanStage::ADVANCED;
+    }
+
     verify(_resultIterator != _data.end());
     verify(_sorted);
     *out = _resultIterator->wsid;
@@ -235,6 +312,7 @@ unique_ptr<PlanStageStats> SortStage::getStats() {
     _specificStats.memLimit = maxBytes;
     _specificStats.memUsage = _memUsage;
     _specificStats.limit = _limit;
+    _specificStats.allowDiskUse = _allowDiskUse;
     _specificStats.sortPattern = _pattern.getOwned();
 
     unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_SORT);
@@ -262,10 +340,11 @@ const SpecificStats* SortStage::getSpecificStats() const {
  *                     Updates memory usage if item was replaced.
  *     sortBuffer() - Does nothing.
  * limit > 1:
- *     addToBuffer() - Does not update vector. Adds item to set.
- *                     If size of set exceeds limit, remove item from set
- *                     with lowest key. Updates memory usage accordingly.
- *     sortBuffer() - Copies items from set to vectors.
+ *     addToBuffer() - Pushes item onto a max-heap in the vector.
+ *                     Once the heap holds limit items, an item is only
+ *                     taken if it sorts before the heap's front, which
+ *                     it then replaces. Updates memory usage accordingly.
+ *     sortBuffer() - Sorts the heap in place.
  */
 void SortStage::addToBuffer(const SortableDataItem& item) {
     // Holds ID of working set member to be freed at end of this function.
@@ -294,33 +373,28 @@ void SortStage::addToBuffer(const SortableDataItem& item) {
             _memUsage = member->getMemUsage();
         }
     } else {
-        // Update data item set instead of vector
-        // Limit not reached - insert and return
+        const WorkingSetComparator& cmp = *_sortKeyComparator;
+        // Limit not reached - push onto the heap and return
         vector<SortableDataItem>::size_type limit(_limit);
-        if (_dataSet->size() < limit) {
+        if (_data.size() < limit) {
             member->makeObjOwnedIfNeeded();
-            _dataSet->insert(item);
+            _data.push_back(item);
+            std::push_heap(_data.begin(), _data.end(), cmp);
             _memUsage += member->getMemUsage();
             return;
         }
-        // Limit will be exceeded - compare with item with lowest key
-        // If new item does not have a lower key value than last item,
-        // do nothing.
+        // Limit will be exceeded - compare with the Kth item, which is at the front of the heap.
+        // If new item does not have a lower key value than the Kth item, do nothing.
         wsidToFree = item.wsid;
-        SortableDataItemSet::const_iterator lastItemIt = --(_dataSet->end());
-        const SortableDataItem& lastItem = *lastItemIt;
-        const WorkingSetComparator& cmp = *_sortKeyComparator;
-        if (cmp(item, lastItem)) {
-            _memUsage -= _ws->get(lastItem.wsid)->getMemUsage();
+        if (cmp(item, _data.front())) {
+            const SortableDataItem& kthItem = _data.front();
+            _memUsage -= _ws->get(kthItem.wsid)->getMemUsage();
             _memUsage += member->getMemUsage();
-            wsidToFree = lastItem.wsid;
-            // According to std::set iterator validity rules,
-            // it does not matter which of erase()/insert() happens first.
-            // Here, we choose to erase first to release potential resources
-            // used by the last item and to keep the scope of the iterator to a minimum.
-            _dataSet->erase(lastItemIt);
+            wsidToFree = kthItem.wsid;
+            std::pop_heap(_data.begin(), _data.end(), cmp);
             member->makeObjOwnedIfNeeded();
-            _dataSet->insert(item);
+            _data.back() = item;
+            std::push_heap(_data.begin(), _data.end(), cmp);
         }
     }
 
@@ -343,13 +417,75 @@ void SortStage::sortBuffer() {
         // Buffer contains either 0 or 1 item so it is already in a sorted state.
         return;
     } else {
-        // Set already contains items in sorted order, so we simply copy the items
-        // from the set to the vector.
-        // Release the memory for the set after the copy.
-        vector<SortableDataItem> newData(_dataSet->begin(), _dataSet->end());
-        _data.swap(newData);
-        _dataSet.reset();
+        const WorkingSetComparator& cmp = *_sortKeyComparator;
+        std::sort_heap(_data.begin(), _data.end(), cmp);
+    }
+}
+
+void SortStage::addToSpillSorter(const SortableDataItem& item) {
+    WorkingSetMember* member = _ws->get(item.wsid);
+
+    SpilledMember spilled;
+    spilled.obj = member->obj.value();
+    spilled.loc = item.loc;
+
+    BSONObjBuilder computed;
+    if (member->hasComputed(WSM_COMPUTED_TEXT_SCORE)) {
+        const TextScoreComputedData* score = static_cast<const TextScoreComputedData*>(
+            member->getComputed(WSM_COMPUTED_TEXT_SCORE));
+        computed.append("textScore", score->getScore());
+    }
+    if (member->hasComputed(WSM_COMPUTED_GEO_DISTANCE)) {
+        const GeoDistanceComputedData* dist = static_cast<const GeoDistanceComputedData*>(
+            member->getComputed(WSM_COMPUTED_GEO_DISTANCE));
+        computed.append("geoDistance", dist->getDist());
     }
+    if (member->hasComputed(WSM_GEO_NEAR_POINT)) {
+        const GeoNearPointComputedData* point = static_cast<const GeoNearPointComputedData*>(
+            member->getComputed(WSM_GEO_NEAR_POINT));
+        computed.append("geoNearPoint", point->getPoint());
+    }
+    spilled.computed = computed.obj();
+
+    // The sorter takes owned copies of the key and member, so we are done with 'item.wsid'.
+    const int numFilesBefore = _spillSorter->numFiles();
+    const size_t memUsedBefore = _spillSorter->memUsed();
+    _spillSorter->add(item.sortKey, spilled);
+    _ws->free(item.wsid);
+
+    if (_spillSorter->numFiles() > numFilesBefore) {
+        ++_specificStats.spills;
+        _specificStats.bytesSpilled +=
+            memUsedBefore + item.sortKey.memUsageForSorter() + spilled.memUsageForSorter();
+    }
+    _memUsage = _spillSorter->memUsed();
+}
+
+WorkingSetID SortStage::allocateFromSpillIterator() {
+    const SpillSorter::Data data = _spillIterator->next();
+
+    WorkingSetID id = _ws->allocate();
+    WorkingSetMember* member = _ws->get(id);
+    member->obj = Snapshotted<BSONObj>(SnapshotId(), data.second.obj.getOwned());
+    _ws->transitionToOwnedObj(id);
+
+    member->addComputed(new SortKeyComputedData(data.first));
+
+    const BSONObj& computed = data.second.computed;
+    if (computed.hasField("textScore")) {
+        member->addComputed(new TextScoreComputedData(computed["textScore"].numberDouble()));
+    }
+    if (computed.hasField("geoDistance")) {
+        member->addComputed(new GeoDistanceComputedData(computed["geoDistance"].numberDouble()));
+    }
+    if (computed.hasField("geoNearPoint")) {
+        member->addComputed(new GeoNearPointComputedData(computed["geoNearPoint"].Obj()));
+    }
+
+    return id;
 }
 
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
@@ -37,6 +37,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/index_bounds.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/sorter/sorter.h"
 #include "mongo/platform/unordered_map.h"
 
 namespace mongo {
@@ -46,7 +47,7 @@ class BtreeKeyGenerator;
 // Parameters that must be provided to a SortStage
 class SortStageParams {
 public:
-    SortStageParams() : collection(NULL), limit(0) {}
+    SortStageParams() : collection(NULL), limit(0), allowDiskUse(false) {}
 
     // Used for resolving RecordIds to BSON
     const Collection* collection;
@@ -56,6 +57,9 @@ public:
 
     // Equal to 0 for no limit.
     size_t limit;
+
+    // If true, data beyond the memory limit is spilled to temporary files instead of failing.
+    bool allowDiskUse;
 };
 
 /**
@@ -106,6 +110,9 @@ private:
     // Equal to 0 for no limit.
     size_t _limit;
 
+    // Whether results are sorted by '_spillSorter' rather than in '_data'.
+    const bool _allowDiskUse;
+
     //
     // Data storage
     //
@@ -137,7 +144,7 @@ private:
     };
 
     /**
-     * Inserts one item into data buffer (vector or set).
+     * Inserts one item into the data buffer.
      * If limit is exceeded, remove item with lowest key.
      */
     void addToBuffer(const SortableDataItem& item);
@@ -145,8 +152,6 @@ private:
     /**
      * Sorts data buffer.
      * Assumes no more items will be added to buffer.
-     * If data is stored in set, copy set
-     * contents to vector and clear set.
      */
     void sortBuffer();
 
@@ -158,12 +163,10 @@ private:
     // _data will contain sorted data when all data is gathered
     // and sorted.
     // When _limit is greater than 1 and not all data has been gathered from child stage,
-    // _dataSet is used instead to maintain an ordered set of the incomplete data set.
-    // When the data set is complete, we copy the items from _dataSet to _data which will
-    // be used to provide the results of this stage through _resultIterator.
+    // _data is kept as a max-heap of at most _limit items, so that its front is the item
+    // with the greatest key among the best _limit seen so far. When the data set is
+    // complete, the heap is sorted in place.
     std::vector<SortableDataItem> _data;
-    typedef std::set<SortableDataItem, WorkingSetComparator> SortableDataItemSet;
-    std::unique_ptr<SortableDataItemSet> _dataSet;
 
     // Iterates through _data post-sort returning it.
     std::vector<SortableDataItem>::iterator _resultIterator;
@@ -176,6 +179,57 @@ private:
 
     // The usage in bytes of all buffered data that we're sorting.
     size_t _memUsage;
+
+    //
+    // External sort, used instead of the buffers above when '_allowDiskUse' is set
+    //
+
+    // A working set member in the form in which the external sorter holds it. The member is
+    // freed once it is copied in here and a new one in the OWNED_OBJ state is made on output,
+    // so invalidations are of no concern to the sorted data.
+    struct SpilledMember {
+        struct SorterDeserializeSettings {};
+
+        void serializeForSorter(BufBuilder& buf) const;
+        static SpilledMember deserializeForSorter(BufReader& buf,
+                                                  const SorterDeserializeSettings&);
+        int memUsageForSorter() const;
+        SpilledMember getOwned() const;
+
+        BSONObj obj;
+        // Only used to break ties between equal sort keys.
+        RecordId loc;
+        // The computed data, other than the sort key, which stages above us may ask for.
+        BSONObj computed;
+    };
+
+    // Sort key to member.
+    typedef Sorter<BSONObj, SpilledMember> SpillSorter;
+
+    // Orders like WorkingSetComparator.
+    struct SpillComparator {
+        explicit SpillComparator(BSONObj p);
+
+        int operator()(const SpillSorter::Data& lhs, const SpillSorter::Data& rhs) const;
+
+        BSONObj pattern;
+    };
+
+    /**
+     * Copies the member of 'item' into the external sorter and frees it from the working set.
+     */
+    void addToSpillSorter(const SortableDataItem& item);
+
+    /**
+     * Makes a working set member out of the next result of '_spillIterator'.
+     */
+    WorkingSetID allocateFromSpillIterator();
+
+    // Accepts data until our child is EOF.
+    std::unique_ptr<SpillSorter> _spillSorter;
+
+    // Returns the sorted data afterwards.
+    std::unique_ptr<SpillSorter::Iterator> _spillIterator;
 };
 
 }  // namespace mongo
@@ -111,7 +111,8 @@ SortKeyGenerator::SortKeyGenerator(const Collection* collection,
 Status SortKeyGenerator::getSortKey(const WorkingSetMember& member, BSONObj* objOut) const {
     BSONObj btreeKeyToUse;
 
-    Status btreeStatus = getBtreeKey(member.obj.value(), &btreeKeyToUse);
+    Status btreeStatus = member.hasObj() ? getBtreeKey(member.obj.value(), &btreeKeyToUse)
+                                         : getBtreeKeyFromIndexKeys(member, &btreeKeyToUse);
     if (!btreeStatus.isOK()) {
         return btreeStatus;
     }
@@ -147,6 +148,27 @@ Status SortKeyGenerator::getSortKey(const WorkingSetMember& member, BSONObj* obj
     return Status::OK();
 }
 
+Status SortKeyGenerator::getBtreeKeyFromIndexKeys(const WorkingSetMember& member,
+                                                  BSONObj* objOut) const {
+    // A document in an index that isn't multikey has exactly one key, so the sort key is just the
+    // sort fields of that key, with the field names dropped as they are for generated keys.
+    BSONObjBuilder keyBob;
+    BSONObjIterator it(_btreeObj);
+    while (it.more()) {
+        BSONElement sortElt = it.next();
+        BSONElement keyElt;
+        if (!member.getFieldDotted(sortElt.fieldName(), &keyElt)) {
+            return Status(ErrorCodes::InternalError,
+                          str::stream() << "sort field " << sortElt.fieldName()
+                                        << " is not in the index key");
+        }
+        keyBob.appendAs(keyElt, "");
+    }
+
+    *objOut = keyBob.obj();
+    return Status::OK();
+}
+
 Status SortKeyGenerator::getBtreeKey(const BSONObj& memberObj, BSONObj* objOut) const {
     // Not sorting by anything in the key, just bail out early.
     if (_btreeObj.isEmpty()) {
@@ -277,7 +299,7 @@ PlanStage::StageState SortKeyGeneratorStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     if (!_sortKeyGen) {
         _sortKeyGen = stdx::make_unique<SortKeyGenerator>(_collection, _sortSpec, _query);
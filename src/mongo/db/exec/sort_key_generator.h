@@ -58,13 +58,20 @@ public:
                      const BSONObj& queryObj);
 
     /**
-     * Returns the key used to sort 'member'.
+     * Returns the key used to sort 'member'. If 'member' has no object, the key is read out of
+     * its index key data, which must then hold every field of the sort pattern.
      */
     Status getSortKey(const WorkingSetMember& member, BSONObj* objOut) const;
 
 private:
     Status getBtreeKey(const BSONObj& memberObj, BSONObj* objOut) const;
 
+    /**
+     * Builds the btree part of the sort key from the index key data of 'member'. Only valid when
+     * the key data comes from an index which is not multikey.
+     */
+    Status getBtreeKeyFromIndexKeys(const WorkingSetMember& member, BSONObj* objOut) const;
+
     /**
      * In order to emulate the existing sort behavior we must make unindexed sort behavior as
      * consistent as possible with indexed sort behavior.  As such, we must only consider index
@@ -34,7 +34,10 @@
 
 #include "mongo/db/exec/queued_data_stage.h"
 #include "mongo/db/json.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/storage_options.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 
 using namespace mongo;
@@ -211,6 +214,14 @@ TEST(SortStageTest, SortDescendingWithLimit) {
     testWork("{a: -1}", "{}", 2, "{input: [{a: 2}, {a: 1}, {a: 3}]}", "{output: [{a: 3}, {a: 2}]}");
 }
 
+TEST(SortStageTest, SortWithLimitReplacesKthItem) {
+    testWork("{a: 1}",
+             "{}",
+             3,
+             "{input: [{a: 5}, {a: 9}, {a: 7}, {a: 3}, {a: 8}, {a: 1}, {a: 6}, {a: 3}]}",
+             "{output: [{a: 1}, {a: 3}, {a: 3}]}");
+}
+
 //
 // Sorting with limit > size of data set
 // Implementation should retain top N items
@@ -246,4 +257,109 @@ TEST(SortStageTest, SortDescendingWithLimitOfOne) {
     testWork("{a: -1}", "{}", 1, "{input: [{a: 2}, {a: 1}, {a: 3}]}", "{output: [{a: 3}]}");
 }
 
+//
+// Sorting with allowDiskUse
+// Implementation should spill to disk rather than fail once the memory limit is exceeded.
+//
+
+TEST(SortStageTest, SortSpillsToDiskWhenAllowed) {
+    unittest::TempDir tempDir("sort_stage_test");
+    const std::string oldDbpath = storageGlobalParams.dbpath;
+    const int oldMaxBytes = internalQueryExecMaxBlockingSortBytes;
+    storageGlobalParams.dbpath = tempDir.path();
+    internalQueryExecMaxBlockingSortBytes = 4 * 1024;
+
+    WorkingSet ws;
+    auto queuedDataStage = stdx::make_unique<QueuedDataStage>(nullptr, &ws);
+    const std::string padding(100, 'x');
+    const int nDocs = 500;
+    for (int i = 0; i < nDocs; i++) {
+        WorkingSetID id = ws.allocate();
+        WorkingSetMember* wsm = ws.get(id);
+        wsm->obj = Snapshotted<BSONObj>(SnapshotId(),
+                                        BSON("a" << (i * 7) % nDocs << "pad" << padding));
+        wsm->transitionToOwnedObj();
+        queuedDataStage->pushBack(id);
+    }
+
+    SortStageParams params;
+    params.pattern = BSON("a" << 1);
+    params.allowDiskUse = true;
+
+    auto sortKeyGen = stdx::make_unique<SortKeyGeneratorStage>(
+        nullptr, queuedDataStage.release(), &ws, nullptr, params.pattern, BSONObj());
+    SortStage sort(nullptr, params, &ws, sortKeyGen.release());
+
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    PlanStage::StageState state = PlanStage::NEED_TIME;
+    while (state == PlanStage::NEED_TIME) {
+        state = sort.work(&id);
+    }
+
+    int nReturned = 0;
+    while (state == PlanStage::ADVANCED) {
+        ASSERT_EQUALS(nReturned, ws.get(id)->obj.value()["a"].numberInt());
+        ASSERT(ws.get(id)->hasComputed(WSM_SORT_KEY));
+        nReturned++;
+        state = sort.work(&id);
+    }
+    ASSERT_EQUALS(state, PlanStage::IS_EOF);
+    ASSERT_EQUALS(nDocs, nReturned);
+
+    const SortStats* stats = static_cast<const SortStats*>(sort.getSpecificStats());
+    ASSERT_GREATER_THAN(stats->spills, 0U);
+    ASSERT_GREATER_THAN(stats->bytesSpilled, 0U);
+
+    storageGlobalParams.dbpath = oldDbpath;
+    internalQueryExecMaxBlockingSortBytes = oldMaxBytes;
+}
+
+//
+// Sorting index keys
+// A sort with a limit may take its keys from index key data, leaving the fetch to a later stage.
+//
+
+TEST(SortStageTest, SortIndexKeysWithLimit) {
+    WorkingSet ws;
+    auto queuedDataStage = stdx::make_unique<QueuedDataStage>(nullptr, &ws);
+    const BSONObj keyPattern = BSON("a" << 1 << "b" << 1);
+    const int nKeys = 100;
+    for (int i = 0; i < nKeys; i++) {
+        WorkingSetID id = ws.allocate();
+        WorkingSetMember* wsm = ws.get(id);
+        wsm->loc = RecordId(i + 1);
+        const BSONObj key = BSON("" << 1 << "" << (i * 7) % nKeys);
+        wsm->keyData.push_back(IndexKeyDatum(keyPattern, key, nullptr));
+        ws.transitionToLocAndIdx(id);
+        queuedDataStage->pushBack(id);
+    }
+
+    SortStageParams params;
+    params.pattern = BSON("b" << -1);
+    params.limit = 5;
+
+    auto sortKeyGen = stdx::make_unique<SortKeyGeneratorStage>(
+        nullptr, queuedDataStage.release(), &ws, nullptr, params.pattern, BSONObj());
+    SortStage sort(nullptr, params, &ws, sortKeyGen.release());
+
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    PlanStage::StageState state = PlanStage::NEED_TIME;
+    while (state == PlanStage::NEED_TIME) {
+        state = sort.work(&id);
+    }
+
+    int nReturned = 0;
+    while (state == PlanStage::ADVANCED) {
+        WorkingSetMember* member = ws.get(id);
+        ASSERT_FALSE(member->hasObj());
+        BSONElement b;
+        ASSERT(member->getFieldDotted("b", &b));
+        ASSERT_EQUALS(nKeys - 1 - nReturned, b.numberInt());
+        nReturned++;
+        state = sort.work(&id);
+    }
+    ASSERT_EQUALS(state, PlanStage::IS_EOF);
+    ASSERT_EQUALS(5, nReturned);
+}
+
 }  // namespace
@@ -32,17 +32,24 @@
 
 #include "mongo/db/exec/subplan.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/exec/multi_plan.h"
 #include "mongo/db/exec/scoped_timer.h"
+#include "mongo/db/operation_arena.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/query/planner_analysis.h"
 #include "mongo/db/query/planner_access.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/stage_builder.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -164,7 +171,7 @@ std::unique_ptr<MatchExpression> SubplanStage::rewriteToRootedOr(
 Status SubplanStage::planSubqueries() {
     // Adds the amount of time taken by planSubqueries() to executionTimeMillis. There's lots of
     // work that happens here, so this is needed for the time accounting to make sense.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     _orExpression = _query->root()->shallowClone();
     if (isContainedOr(_orExpression.get())) {
@@ -179,6 +186,11 @@ Status SubplanStage::planSubqueries() {
     }
 
     const WhereCallbackReal whereCallback(getOpCtx(), _collection->ns().db());
+    PlanCache* planCache = _collection->infoCache()->getPlanCache();
+
+    // The position of the first branch of each shape, and the branches which need planning.
+    std::unordered_map<PlanCacheKey, size_t> firstBranchOfShape;
+    std::vector<size_t> branchesToPlan;
 
     for (size_t i = 0; i < _orExpression->numChildren(); ++i) {
         // We need a place to shove the results from planning this branch.
@@ -198,14 +210,22 @@ Status SubplanStage::planSubqueries() {
 
         branchResult->canonicalQuery = std::move(statusWithCQ.getValue());
 
+        // A child with the same shape as an earlier child would end up with the same plan, so
+        // it borrows the index tags of the earlier child once those are chosen.
+        auto firstOfShape =
+            firstBranchOfShape.emplace(planCache->computeKey(*branchResult->canonicalQuery), i);
+        if (!firstOfShape.second) {
+            LOG(5) << "Subplanner: child " << i << " has the same shape as child "
+                   << firstOfShape.first->second;
+            branchResult->sameShapeAs = firstOfShape.first->second;
+            continue;
+        }
+
         // Plan the i-th child. We might be able to find a plan for the i-th child in the plan
         // cache. If there's no cached plan, then we generate and rank plans using the MPS.
         CachedSolution* rawCS;
         if (PlanCache::shouldCacheQuery(*branchResult->canonicalQuery) &&
-            _collection->infoCache()
-                ->getPlanCache()
-                ->get(*branchResult->canonicalQuery, &rawCS)
-                .isOK()) {
+            planCache->get(*branchResult->canonicalQuery, &rawCS).isOK()) {
             // We have a CachedSolution. Store it for later.
             LOG(5) << "Subplanner: cached plan found for child " << i << " of "
                    << _orExpression->numChildren();
@@ -214,30 +234,84 @@ Status SubplanStage::planSubqueries() {
         } else {
             // No CachedSolution found. We'll have to plan from scratch.
             LOG(5) << "Subplanner: planning child " << i << " of " << _orExpression->numChildren();
+            branchesToPlan.push_back(i);
+        }
+    }
+
+    return planBranches(branchesToPlan);
+}
 
-            // We don't set NO_TABLE_SCAN because peeking at the cache data will keep us from
-            // considering any plan that's a collscan.
-            Status status = QueryPlanner::plan(*branchResult->canonicalQuery,
-                                               _plannerParams,
-                                               &branchResult->solutions.mutableVector());
+Status SubplanStage::planBranch(const QueryPlannerParams& params,
+                                BranchPlanningResult* branchResult) const {
+    // We don't set NO_TABLE_SCAN because peeking at the cache data will keep us from
+    // considering any plan that's a collscan.
+    Status status = QueryPlanner::plan(
+        *branchResult->canonicalQuery, params, &branchResult->solutions.mutableVector());
 
+    if (!status.isOK()) {
+        mongoutils::str::stream ss;
+        ss << "Can't plan for subchild " << branchResult->canonicalQuery->toString() << " "
+           << status.reason();
+        return Status(ErrorCodes::BadValue, ss);
+    }
+    LOG(5) << "Subplanner: got " << branchResult->solutions.size() << " solutions";
+
+    if (0 == branchResult->solutions.size()) {
+        // If one child doesn't have an indexed solution, bail out.
+        mongoutils::str::stream ss;
+        ss << "No solutions for subchild " << branchResult->canonicalQuery->toString();
+        return Status(ErrorCodes::BadValue, ss);
+    }
+
+    return Status::OK();
+}
+
+Status SubplanStage::planBranches(const std::vector<size_t>& branchPositions) {
+    const size_t numThreads =
+        std::min(branchPositions.size(),
+                 static_cast<size_t>(std::max(1, internalQuerySubplanPlanningThreads)));
+
+    if (numThreads <= 1) {
+        for (size_t branchPosition : branchPositions) {
+            Status status = planBranch(_plannerParams, _branchResults[branchPosition]);
             if (!status.isOK()) {
-                mongoutils::str::stream ss;
-                ss << "Can't plan for subchild " << branchResult->canonicalQuery->toString() << " "
-                   << status.reason();
-                return Status(ErrorCodes::BadValue, ss);
+                return status;
             }
-            LOG(5) << "Subplanner: got " << branchResult->solutions.size() << " solutions";
+        }
+        return Status::OK();
+    }
 
-            if (0 == branchResult->solutions.size()) {
-                // If one child doesn't have an indexed solution, bail out.
-                mongoutils::str::stream ss;
-                ss << "No solutions for subchild " << branchResult->canonicalQuery->toString();
-                return Status(ErrorCodes::BadValue, ss);
+    // Each thread plans the next branch no thread has taken yet, until there are none left.
+    // Planning a branch only reads '_plannerParams' and the branch's own query, while the
+    // collection lock held by this thread keeps the indexes they describe in place. The
+    // operation's arena is not thread safe, so the threads plan with the global allocator.
+    QueryPlannerParams threadParams = _plannerParams;
+    threadParams.arena = nullptr;
+    std::vector<Status> statuses(branchPositions.size(), Status::OK());
+    AtomicUInt64 nextPosition(0);
+    std::vector<stdx::thread> threads;
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads.emplace_back([this, &threadParams, &branchPositions, &statuses, &nextPosition] {
+            for (size_t next = nextPosition.fetchAndAdd(1); next < branchPositions.size();
+                 next = nextPosition.fetchAndAdd(1)) {
+                try {
+                    statuses[next] =
+                        planBranch(threadParams, _branchResults[branchPositions[next]]);
+                } catch (const DBException& ex) {
+                    statuses[next] = ex.toStatus();
+                }
             }
-        }
+        });
+    }
+    for (stdx::thread& thread : threads) {
+        thread.join();
     }
 
+    for (const Status& status : statuses) {
+        if (!status.isOK()) {
+            return status;
+        }
+    }
     return Status::OK();
 }
 
@@ -293,19 +367,25 @@ Status SubplanStage::choosePlanForSubqueries(PlanYieldPolicy* yieldPolicy) {
         MatchExpression* orChild = _orExpression->getChild(i);
         BranchPlanningResult* branchResult = _branchResults[i];
 
-        if (branchResult->cachedSolution.get()) {
-            // We can get the index tags we need out of the cache.
+        if (branchResult->sameShapeAs) {
+            // Tag the child just like the earlier child of the same shape.
+            const BranchPlanningResult* firstOfShape = _branchResults[*branchResult->sameShapeAs];
             Status tagStatus = tagOrChildAccordingToCache(
-                cacheData.get(), branchResult->cachedSolution->plannerData[0], orChild, _indexMap);
+                cacheData.get(), firstOfShape->chosenCacheData.get(), orChild, _indexMap);
             if (!tagStatus.isOK()) {
                 return tagStatus;
             }
+            continue;
+        }
+
+        if (branchResult->cachedSolution.get()) {
+            // We can get the index tags we need out of the cache.
+            branchResult->chosenCacheData.reset(
+                branchResult->cachedSolution->plannerData[0]->clone());
         } else if (1 == branchResult->solutions.size()) {
             QuerySolution* soln = branchResult->solutions.front();
-            Status tagStatus = tagOrChildAccordingToCache(
-                cacheData.get(), soln->cacheData.get(), orChild, _indexMap);
-            if (!tagStatus.isOK()) {
-                return tagStatus;
+            if (soln->cacheData.get()) {
+                branchResult->chosenCacheData.reset(soln->cacheData->clone());
             }
         } else {
             // N solutions, rank them.
@@ -346,32 +426,15 @@ Status SubplanStage::choosePlanForSubqueries(PlanYieldPolicy* yieldPolicy) {
             }
 
             QuerySolution* bestSoln = multiPlanStage.bestSolution();
-
-            // Check that we have good cache data. For example, we don't cache things
-            // for 2d indices.
-            if (NULL == bestSoln->cacheData.get()) {
-                mongoutils::str::stream ss;
-                ss << "No cache data for subchild " << orChild->toString();
-                return Status(ErrorCodes::BadValue, ss);
-            }
-
-            if (SolutionCacheData::USE_INDEX_TAGS_SOLN != bestSoln->cacheData->solnType) {
-                mongoutils::str::stream ss;
-                ss << "No indexed cache data for subchild " << orChild->toString();
-                return Status(ErrorCodes::BadValue, ss);
-            }
-
-            // Add the index assignments to our original query.
-            Status tagStatus = QueryPlanner::tagAccordingToCache(
-                orChild, bestSoln->cacheData->tree.get(), _indexMap);
-
-            if (!tagStatus.isOK()) {
-                mongoutils::str::stream ss;
-                ss << "Failed to extract indices from subchild " << orChild->toString();
-                return Status(ErrorCodes::BadValue, ss);
+            if (bestSoln->cacheData.get()) {
+                branchResult->chosenCacheData.reset(bestSoln->cacheData->clone());
             }
+        }
 
-            cacheData->children.push_back(bestSoln->cacheData->tree->clone());
+        Status tagStatus = tagOrChildAccordingToCache(
+            cacheData.get(), branchResult->chosenCacheData.get(), orChild, _indexMap);
+        if (!tagStatus.isOK()) {
+            return tagStatus;
         }
     }
 
@@ -481,7 +544,9 @@ Status SubplanStage::choosePlanWholeQuery(PlanYieldPolicy* yieldPolicy) {
 Status SubplanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
     // Adds the amount of time taken by pickBestPlan() to executionTimeMillis. There's lots of
     // work that happens here, so this is needed for the time accounting to make sense.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
+
+    _plannerParams.arena = OperationArena::get(getOpCtx());
 
     // Plan each branch of the $or.
     Status subplanningStatus = planSubqueries();
@@ -509,7 +574,7 @@ PlanStage::StageState SubplanStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     if (isEOF()) {
         return PlanStage::IS_EOF;
@@ -540,6 +605,10 @@ bool SubplanStage::branchPlannedFromCache(size_t i) const {
     return NULL != _branchResults[i]->cachedSolution.get();
 }
 
+bool SubplanStage::branchPlannedFromEarlierBranch(size_t i) const {
+    return static_cast<bool>(_branchResults[i]->sameShapeAs);
+}
+
 const SpecificStats* SubplanStage::getSpecificStats() const {
     return NULL;
 }
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <string>
 
 #include "mongo/base/owned_pointer_vector.h"
@@ -62,7 +63,14 @@ class OperationContext;
  *   executions of C. These subsequent executions of shape C could be either as a clause in
  *   another rooted $or query, or shape C as its own query.
  *
+ *   --Clauses with the same shape as an earlier clause of the query are not planned again, but
+ *   use the index tags chosen for the earlier clause.
+ *
  *   --Plans for entire rooted $or queries are neither written to nor read from the plan cache.
+ *
+ * The candidate plans of the clauses which need planning can be enumerated by several threads
+ * at once (see internalQuerySubplanPlanningThreads). Ranking them always happens in the thread
+ * running the query.
  */
 class SubplanStage final : public PlanStage {
 public:
@@ -125,6 +133,12 @@ public:
      */
     bool branchPlannedFromCache(size_t i) const;
 
+    /**
+     * Returns true if the i-th branch has the same shape as an earlier branch, and so reuses the
+     * plan chosen for that branch, otherwise returns false.
+     */
+    bool branchPlannedFromEarlierBranch(size_t i) const;
+
 private:
     /**
      * A class used internally in order to keep track of the results of planning
@@ -147,8 +161,29 @@ private:
 
         // Query solutions resulting from planning the $or branch.
         OwnedPointerVector<QuerySolution> solutions;
+
+        // Set if an earlier branch has the same shape, to the position of the first such branch.
+        // The branch is then neither looked up in the cache nor planned.
+        boost::optional<size_t> sameShapeAs;
+
+        // The cache data of the plan chosen for the branch, kept so that branches of the same
+        // shape can be tagged with it.
+        std::unique_ptr<SolutionCacheData> chosenCacheData;
     };
 
+    /**
+     * Generates the candidate solutions for the branch with 'params', storing them in
+     * 'branchResult->solutions'. Safe to call for different branches concurrently, as long as
+     * the calls don't share the arena of their params.
+     */
+    Status planBranch(const QueryPlannerParams& params, BranchPlanningResult* branchResult) const;
+
+    /**
+     * Calls planBranch() for each of the branches in 'branchPositions', spreading them over up
+     * to internalQuerySubplanPlanningThreads threads.
+     */
+    Status planBranches(const std::vector<size_t>& branchPositions);
+
     /**
      * Plan each branch of the $or independently, and store the resulting
      * lists of query solutions in '_solutions'.
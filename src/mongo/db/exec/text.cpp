@@ -75,7 +75,7 @@ PlanStage::StageState TextStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     if (isEOF()) {
         return PlanStage::IS_EOF;
@@ -117,10 +117,20 @@ const SpecificStats* TextStage::getSpecificStats() const {
 unique_ptr<PlanStage> TextStage::buildTextTree(OperationContext* txn,
                                                WorkingSet* ws,
                                                const MatchExpression* filter) const {
-    auto textScorer = make_unique<TextOrStage>(txn, _params.spec, ws, filter, _params.index);
+    // The top results can only be picked by their text score when TEXT_MATCH returns every
+    // document with a positive term, that is for a query without negations or phrases which isn't
+    // case or diacritic sensitive.
+    const FTSQuery& query = _params.query;
+    const bool canLimit = query.getNegatedTerms().empty() && query.getPositivePhr().empty() &&
+        query.getNegatedPhr().empty() && !query.getCaseSensitive() &&
+        !query.getDiacriticSensitive() &&
+        query.getTermsForBounds().size() <= TextOrStage::kMaxTermsWithLimit;
+
+    auto textScorer = make_unique<TextOrStage>(
+        txn, _params.spec, ws, filter, _params.index, canLimit ? _params.limit : 0);
 
     // Get all the index scans for each term in our query.
-    for (const auto& term : _params.query.getTermsForBounds()) {
+    for (const auto& term : query.getTermsForBounds()) {
         IndexScanParams ixparams;
 
         ixparams.bounds.startKey = FTSIndexFormat::getIndexKey(
@@ -132,7 +142,7 @@ unique_ptr<PlanStage> TextStage::buildTextTree(OperationContext* txn,
         ixparams.descriptor = _params.index;
         ixparams.direction = -1;
 
-        textScorer->addChild(make_unique<IndexScan>(txn, ixparams, ws, nullptr));
+        textScorer->addChild(make_unique<IndexScan>(txn, ixparams, ws, nullptr), term);
     }
 
     auto fetcher = make_unique<FetchStage>(
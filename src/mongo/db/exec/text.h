@@ -62,6 +62,9 @@ struct TextStageParams {
 
     // The text query.
     FTSQuery query;
+
+    // If nonzero, only this many of the highest scoring results are needed.
+    size_t limit = 0;
 };
 
 /**
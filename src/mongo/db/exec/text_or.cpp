@@ -28,6 +28,7 @@
 
 #include "mongo/db/exec/text_or.h"
 
+#include <algorithm>
 #include <map>
 #include <vector>
 
@@ -37,6 +38,7 @@
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/exec/working_set_computed_data.h"
+#include "mongo/db/fts/fts_index_format.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/matchable.h"
 #include "mongo/db/query/internal_plans.h"
@@ -52,25 +54,43 @@ using stdx::make_unique;
 
 using fts::FTSSpec;
 
+namespace {
+
+// The fewest keys read with a limit between two checks of whether the reading can stop. The checks
+// go over every document read so far, so they are also spaced by at least that many keys.
+const size_t kMinKeysBetweenPruneChecks = 128;
+
+}  // namespace
+
 const char* TextOrStage::kStageType = "TEXT_OR";
 
+const size_t TextOrStage::kMaxTermsWithLimit;
+
 TextOrStage::TextOrStage(OperationContext* txn,
                          const FTSSpec& ftsSpec,
                          WorkingSet* ws,
                          const MatchExpression* filter,
-                         IndexDescriptor* index)
+                         IndexDescriptor* index,
+                         size_t limit)
     : PlanStage(kStageType, txn),
       _ftsSpec(ftsSpec),
       _ws(ws),
+      _limit(limit),
+      _keysUntilPruneCheck(kMinKeysBetweenPruneChecks),
       _scoreIterator(_scores.end()),
       _filter(filter),
       _idRetrying(WorkingSet::INVALID_ID),
-      _index(index) {}
+      _index(index) {
+    _specificStats.limit = _limit;
+}
 
 TextOrStage::~TextOrStage() {}
 
-void TextOrStage::addChild(unique_ptr<PlanStage> child) {
+void TextOrStage::addChild(unique_ptr<PlanStage> child, const std::string& term) {
+    invariant(!_limit || _children.size() < kMaxTermsWithLimit);
     _children.push_back(std::move(child));
+    _terms.push_back(term);
+    _scoreBounds.push_back(fts::MAX_WEIGHT);
 }
 
 bool TextOrStage::isEOF() {
@@ -137,7 +157,7 @@ PlanStage::StageState TextOrStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     if (isEOF()) {
         return PlanStage::IS_EOF;
@@ -212,9 +232,19 @@ PlanStage::StageState TextOrStage::readFromChildren(WorkingSetID* out) {
     }
 
     if (PlanStage::ADVANCED == childState) {
-        return addTerm(id, out);
+        StageState stageState = addTerm(id, out);
+        if (_limit && PlanStage::NEED_YIELD != stageState) {
+            advanceToNextChild();
+        }
+        return stageState;
     } else if (PlanStage::IS_EOF == childState) {
         // Done with this child.
+        if (_limit) {
+            _scoreBounds[_currentChild] = 0;
+            advanceToNextChild();
+            return PlanStage::NEED_TIME;
+        }
+
         ++_currentChild;
 
         if (_currentChild < _children.size()) {
@@ -223,9 +253,7 @@ PlanStage::StageState TextOrStage::readFromChildren(WorkingSetID* out) {
         }
 
         // If we're here we are done reading results.  Move to the next state.
-        _scoreIterator = _scores.begin();
-        _internalState = State::kReturningResults;
-
+        doneReading();
         return PlanStage::NEED_TIME;
     } else if (PlanStage::FAILURE == childState) {
         // If a stage fails, it may create a status WSM to indicate why it
@@ -247,6 +275,100 @@ PlanStage::StageState TextOrStage::readFromChildren(WorkingSetID* out) {
     }
 }
 
+void TextOrStage::advanceToNextChild() {
+    size_t nextChild = _currentChild;
+    do {
+        nextChild = (nextChild + 1) % _children.size();
+    } while (nextChild != _currentChild && _children[nextChild]->isEOF());
+
+    if (_children[nextChild]->isEOF()) {
+        // Every score is complete, so this only drops the documents which don't make the cut.
+        pruneToLimit();
+        doneReading();
+        return;
+    }
+    _currentChild = nextChild;
+
+    if (--_keysUntilPruneCheck == 0 && pruneToLimit()) {
+        _specificStats.stoppedEarly = true;
+        doneReading();
+    }
+}
+
+void TextOrStage::doneReading() {
+    _scoreIterator = _scores.begin();
+    _internalState = State::kReturningResults;
+}
+
+bool TextOrStage::pruneToLimit() {
+    std::vector<std::pair<double, ScoreMap::iterator>> candidates;
+    for (auto it = _scores.begin(); it != _scores.end(); ++it) {
+        // Skip the documents rejected by the filter.
+        if (it->second.score >= 0) {
+            candidates.emplace_back(it->second.score, it);
+        }
+    }
+
+    // Spacing the checks by as many keys as there are documents to go over keeps their cost
+    // proportional to the number of keys read.
+    _keysUntilPruneCheck = std::max(candidates.size(), kMinKeysBetweenPruneChecks);
+
+    if (candidates.size() <= _limit) {
+        return false;
+    }
+
+    const auto last = candidates.begin() + (_limit - 1);
+    std::nth_element(candidates.begin(),
+                     last,
+                     candidates.end(),
+                     [](const std::pair<double, ScoreMap::iterator>& lhs,
+                        const std::pair<double, ScoreMap::iterator>& rhs) {
+                         return lhs.first > rhs.first;
+                     });
+    const double minScore = last->first;
+
+    // A document none of whose keys were read yet can score as much as all of the terms can add.
+    if (unreadTermsScoreBound(0) > minScore) {
+        return false;
+    }
+    for (auto it = last + 1; it != candidates.end(); ++it) {
+        if (it->first + unreadTermsScoreBound(it->second->second.termsRead) > minScore) {
+            return false;
+        }
+    }
+
+    for (auto it = last + 1; it != candidates.end(); ++it) {
+        _ws->free(it->second->second.wsid);
+        _scores.erase(it->second);
+    }
+    return true;
+}
+
+double TextOrStage::unreadTermsScoreBound(uint64_t termsRead) const {
+    double bound = 0;
+    for (size_t i = 0; i < _scoreBounds.size(); ++i) {
+        if (!(termsRead & (1ULL << i))) {
+            bound += _scoreBounds[i];
+        }
+    }
+    return bound;
+}
+
+double TextOrStage::scoreDocument(const BSONObj& obj) const {
+    fts::TermFrequencyMap termFrequencies;
+    _ftsSpec.scoreDocument(obj, &termFrequencies);
+
+    double score = 0;
+    for (const auto& term : _terms) {
+        auto it = termFrequencies.find(term);
+        if (it != termFrequencies.end()) {
+            score += fts::FTSIndexFormat::getIndexedScore(it->second,
+                                                          _ftsSpec.getTextIndexVersion());
+        }
+    }
+    return score;
+}
+
 PlanStage::StageState TextOrStage::returnResults(WorkingSetID* out) {
     if (_scoreIterator == _scores.end()) {
         _internalState = State::kDone;
@@ -255,18 +377,43 @@ PlanStage::StageState TextOrStage::returnResults(WorkingSetID* out) {
 
     // Retrieve the record that contains the text score.
     TextRecordData textRecordData = _scoreIterator->second;
-    ++_scoreIterator;
 
     // Ignore non-matched documents.
     if (textRecordData.score < 0) {
         invariant(textRecordData.wsid == WorkingSet::INVALID_ID);
+        ++_scoreIterator;
         return PlanStage::NEED_TIME;
     }
 
     WorkingSetMember* wsm = _ws->get(textRecordData.wsid);
+    double score = textRecordData.score;
+
+    if (_limit && unreadTermsScoreBound(textRecordData.termsRead) > 0) {
+        // The reading stopped before reaching the keys of this document for some of the terms, so
+        // score it from its contents.
+        const bool wasFetched = wsm->hasObj();
+        try {
+            if (!WorkingSetCommon::fetchIfUnfetched(
+                    getOpCtx(), _ws, textRecordData.wsid, _recordCursor)) {
+                ++_specificStats.fetches;
+                _ws->free(textRecordData.wsid);
+                ++_scoreIterator;
+                return PlanStage::NEED_TIME;
+            }
+        } catch (const WriteConflictException& wce) {
+            *out = WorkingSet::INVALID_ID;
+            return PlanStage::NEED_YIELD;
+        }
+
+        if (!wasFetched) {
+            ++_specificStats.fetches;
+        }
+        score = scoreDocument(wsm->obj.value());
+    }
+    ++_scoreIterator;
 
     // Populate the working set member with the text score and return it.
-    wsm->addComputed(new TextScoreComputedData(textRecordData.score));
+    wsm->addComputed(new TextScoreComputedData(score));
     *out = textRecordData.wsid;
     return PlanStage::ADVANCED;
 }
@@ -352,6 +499,23 @@ PlanStage::StageState TextOrStage::addTerm(WorkingSetID wsid, WorkingSetID* out)
     invariant(1 == wsm->keyData.size());
     const IndexKeyDatum newKeyData = wsm->keyData.back();  // copy to keep it around.
 
+    // Locate score within possibly compound key: {prefix,term,score,suffix}.
+    BSONObjIterator keyIt(newKeyData.keyData);
+    for (unsigned i = 0; i < _ftsSpec.numExtraBefore(); i++) {
+        keyIt.next();
+    }
+
+    keyIt.next();  // Skip past 'term'.
+
+    BSONElement scoreElement = keyIt.next();
+    double documentTermScore =
+        fts::FTSIndexFormat::getScoreFromKey(scoreElement, _ftsSpec.getTextIndexVersion());
+
+    if (_limit) {
+        // The keys of the term come in descending score order.
+        _scoreBounds[_currentChild] = documentTermScore;
+    }
+
     TextRecordData* textRecordData = &_scores[wsm->loc];
     double* documentAggregateScore = &textRecordData->score;
 
@@ -413,19 +577,9 @@ PlanStage::StageState TextOrStage::addTerm(WorkingSetID wsid, WorkingSetID* out)
         return NEED_TIME;
     }
 
-    // Locate score within possibly compound key: {prefix,term,score,suffix}.
-    BSONObjIterator keyIt(newKeyData.keyData);
-    for (unsigned i = 0; i < _ftsSpec.numExtraBefore(); i++) {
-        keyIt.next();
-    }
-
-    keyIt.next();  // Skip past 'term'.
-
-    BSONElement scoreElement = keyIt.next();
-    double documentTermScore = scoreElement.number();
-
     // Aggregate relevance score, term keys.
     *documentAggregateScore += documentTermScore;
+    textRecordData->termsRead |= 1ULL << _currentChild;
     return NEED_TIME;
 }
 
@@ -53,6 +53,13 @@ class OperationContext;
  *
  * The WorkingSetMembers returned are in the LOC_AND_IDX state. If a filter is passed in, some
  * WorkingSetMembers may be returned in the LOC_AND_OBJ state.
+ *
+ * If a limit is passed in, only the 'limit' highest scoring documents are returned. Each child
+ * must then scan the keys of its term in descending score order, so the score of the last key
+ * read from it bounds the score of the term in every document it hasn't reached yet. The
+ * children are read in turn, and reading stops as soon as no document can score more than the
+ * 'limit' best ones found so far. The documents returned whose score may be missing the
+ * contribution of terms not read up to them are fetched and scored.
  */
 class TextOrStage final : public PlanStage {
 public:
@@ -73,14 +80,21 @@ public:
         kDone,
     };
 
+    // The most terms for which a limit is applied. Others read every key of every term.
+    static const size_t kMaxTermsWithLimit = 64;
+
     TextOrStage(OperationContext* txn,
                 const FTSSpec& ftsSpec,
                 WorkingSet* ws,
                 const MatchExpression* filter,
-                IndexDescriptor* index);
+                IndexDescriptor* index,
+                size_t limit);
     ~TextOrStage();
 
-    void addChild(unique_ptr<PlanStage> child);
+    /**
+     * Adds a child which returns the index keys of 'term'.
+     */
+    void addChild(unique_ptr<PlanStage> child, const std::string& term);
 
     bool isEOF() final;
 
@@ -121,6 +135,35 @@ private:
      */
     StageState addTerm(WorkingSetID wsid, WorkingSetID* out);
 
+    /**
+     * Helper called from readFromChildren when reading with a limit. Moves on to the next child
+     * which has keys left, and checks from time to time whether the reading can stop. Moves to
+     * kReturningResults if it can, or if no child has keys left.
+     */
+    void advanceToNextChild();
+
+    /**
+     * Moves to kReturningResults once we are done reading from the children.
+     */
+    void doneReading();
+
+    /**
+     * Returns true if no document outside of the 'limit' highest scoring ones read so far can
+     * score more than they do, and if so drops them.
+     */
+    bool pruneToLimit();
+
+    /**
+     * Returns the most the terms whose keys for the document described by 'termsRead' haven't
+     * been read can add to its score.
+     */
+    double unreadTermsScoreBound(uint64_t termsRead) const;
+
+    /**
+     * Returns the score of the document 'obj' for the terms of the children.
+     */
+    double scoreDocument(const BSONObj& obj) const;
+
     /**
      * Worker for kReturningResults. Returns a wsm with RecordID and Score.
      */
@@ -138,15 +181,33 @@ private:
     // Which of _children are we calling work(...) on now?
     size_t _currentChild = 0;
 
+    // The term of each child.
+    std::vector<std::string> _terms;
+
+    // If nonzero, the number of highest scoring documents to return.
+    size_t _limit;
+
+    // When reading with a limit, the score of the last key read from each child, or 0 once it is
+    // EOF. No key left in a child scores more.
+    std::vector<double> _scoreBounds;
+
+    // When reading with a limit, how many more keys to read before checking whether the reading
+    // can stop.
+    size_t _keysUntilPruneCheck;
+
     /**
      *  Temporary score data filled out by children.
      *  Maps from RecordID -> (aggregate score for doc, wsid).
      *  Map each buffered record id to this data.
      */
     struct TextRecordData {
-        TextRecordData() : wsid(WorkingSet::INVALID_ID), score(0.0) {}
+        TextRecordData() : wsid(WorkingSet::INVALID_ID), score(0.0), termsRead(0) {}
         WorkingSetID wsid;
         double score;
+
+        // When reading with a limit, bit i is set once the key of the document for the term of
+        // child i was read, so 'score' has its contribution.
+        uint64_t termsRead;
     };
 
     typedef unordered_map<RecordId, TextRecordData, RecordId::Hasher> ScoreMap;
@@ -40,6 +40,7 @@
 #include "mongo/db/op_observer.h"
 #include "mongo/db/ops/update_lifecycle.h"
 #include "mongo/db/query/explain.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
@@ -405,6 +406,15 @@ Status ensureIdAndFirst(mb::Document& doc) {
     return Status::OK();
 }
 
+size_t getBatchSize(const UpdateStageParams& params) {
+    const UpdateRequest* request = params.request;
+    if (!request->isMulti() || request->shouldReturnAnyDocs() || request->isExplain() ||
+        !supportsDocLocking() || internalQueryExecWriteBatchSize <= 1) {
+        return 1;
+    }
+    return internalQueryExecWriteBatchSize;
+}
+
 }  // namespace
 
 // static
@@ -420,6 +430,7 @@ UpdateStage::UpdateStage(OperationContext* txn,
       _ws(ws),
       _collection(collection),
       _idRetrying(WorkingSet::INVALID_ID),
+      _batchSize(getBatchSize(params)),
       _idReturning(WorkingSet::INVALID_ID),
       _updatedLocs(params.request->isMulti() ? new DiskLocSet() : NULL),
       _doc(params.driver->getDocument()) {
@@ -559,6 +570,9 @@ BSONObj UpdateStage::transformAndUpdate(const Snapshotted<BSONObj>& oldObj, Reco
                 args.update = logObj;
                 args.criteria = idQuery;
                 args.fromMigrate = request->isFromMigration();
+                // A replacement records no updated fields but may change any of them.
+                const FieldRefSet* updatedFieldsPtr =
+                    driver->isDocReplacement() ? NULL : &updatedFields;
                 StatusWith<RecordId> res = _collection->updateDocument(getOpCtx(),
                                                                        loc,
                                                                        oldObj,
@@ -566,7 +580,8 @@ BSONObj UpdateStage::transformAndUpdate(const Snapshotted<BSONObj>& oldObj, Reco
                                                                        true,
                                                                        driver->modsAffectIndices(),
                                                                        _params.opDebug,
-                                                                       args);
+                                                                       args,
+                                                                       updatedFieldsPtr);
                 uassertStatusOK(res.getStatus());
                 newLoc = res.getValue();
             }
@@ -594,6 +609,8 @@ BSONObj UpdateStage::transformAndUpdate(const Snapshotted<BSONObj>& oldObj, Reco
         _specificStats.nModified++;
     }
 
+    _specificStats.nElementsMaterialized += _doc.getNumMaterializedElements();
+
     return newObj;
 }
 
@@ -715,6 +732,7 @@ bool UpdateStage::doneUpdating() {
     // We're done updating if either the child has no more results to give us, or we've
     // already gotten a result back and we're not a multi-update.
     return _idRetrying == WorkingSet::INVALID_ID && _idReturning == WorkingSet::INVALID_ID &&
+        _batch.empty() && _idsRetrying.empty() &&
         (child()->isEOF() || (_specificStats.nMatched > 0 && !_params.request->isMulti()));
 }
 
@@ -734,7 +752,7 @@ PlanStage::StageState UpdateStage::work(WorkingSetID* out) {
     ++_commonStats.works;
 
     // Adds the amount of time taken by work() to executionTimeMillis.
-    ScopedTimer timer(&_commonStats.executionTimeMillis);
+    ScopedTimer timer(&_commonStats);
 
     if (isEOF()) {
         return PlanStage::IS_EOF;
@@ -794,12 +812,22 @@ PlanStage::StageState UpdateStage::work(WorkingSetID* out) {
     // Either retry the last WSM we worked on or get a new one from our child.
     WorkingSetID id;
     StageState status;
-    if (_idRetrying == WorkingSet::INVALID_ID) {
-        status = child()->work(&id);
-    } else {
+    bool fromChild = false;
+    if (_idRetrying != WorkingSet::INVALID_ID) {
         status = ADVANCED;
         id = _idRetrying;
         _idRetrying = WorkingSet::INVALID_ID;
+    } else if (!_idsRetrying.empty()) {
+        status = ADVANCED;
+        id = _idsRetrying.front();
+        _idsRetrying.pop_front();
+    } else {
+        status = child()->work(&id);
+        fromChild = true;
+    }
+
+    if (PlanStage::IS_EOF == status && !_batch.empty()) {
+        return updateBatch(out);
     }
 
     if (PlanStage::ADVANCED == status) {
@@ -833,6 +861,18 @@ PlanStage::StageState UpdateStage::work(WorkingSetID* out) {
             return PlanStage::NEED_TIME;
         }
 
+        if (fromChild && _batchSize > 1) {
+            // The batch may be updated after a yield, which is allowed to free the memory.
+            member->makeObjOwnedIfNeeded();
+            memberFreer.Dismiss();
+            _batch.push_back(id);
+            if (_batch.size() >= _batchSize) {
+                return updateBatch(out);
+            }
+            ++_commonStats.needTime;
+            return PlanStage::NEED_TIME;
+        }
+
         try {
             std::unique_ptr<SeekableRecordCursor> cursor;
             if (getOpCtx()->recoveryUnit()->getSnapshotId() != member->obj.snapshotId()) {
@@ -965,6 +1005,95 @@ PlanStage::StageState UpdateStage::work(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState UpdateStage::updateBatch(WorkingSetID* out) {
+    invariant(!_batch.empty());
+
+    try {
+        WorkingSetCommon::prepareForSnapshotChange(_ws);
+        child()->saveState();
+    } catch (const WriteConflictException& wce) {
+        std::terminate();
+    }
+
+    // Undone if the batch rolls back, along with any locs added to '_updatedLocs'.
+    const UpdateStats statsBefore = _specificStats;
+    std::vector<RecordId> updatedLocs;
+
+    bool committed = false;
+    try {
+        WriteUnitOfWork wunit(getOpCtx());
+        std::unique_ptr<SeekableRecordCursor> cursor;
+        for (WorkingSetID id : _batch) {
+            WorkingSetMember* member = _ws->get(id);
+            RecordId loc = member->loc;
+            if (_updatedLocs->count(loc) > 0) {
+                continue;
+            }
+
+            // If the snapshot changed since the document was read, make sure it still exists
+            // and still matches.
+            if (getOpCtx()->recoveryUnit()->getSnapshotId() != member->obj.snapshotId()) {
+                if (!cursor) {
+                    cursor = _collection->getCursor(getOpCtx());
+                }
+                if (!WorkingSetCommon::fetch(getOpCtx(), _ws, id, cursor)) {
+                    continue;
+                }
+                CanonicalQuery* cq = _params.canonicalQuery;
+                if (cq && !cq->root()->matchesBSON(member->obj.value(), NULL)) {
+                    continue;
+                }
+            }
+
+            updatedLocs.push_back(loc);
+            transformAndUpdate(member->obj, loc);
+            ++_specificStats.nMatched;
+        }
+        wunit.commit();
+        committed = true;
+    } catch (const WriteConflictException& wce) {
+        // Retried below.
+    } catch (const DBException& ex) {
+        if (ErrorCodes::isInterruption(ex.toStatus().code()))
+            throw;
+        // Retrying the documents one at a time reports this error once the documents before
+        // the one that caused it are updated.
+    }
+
+    if (!committed) {
+        _specificStats = statsBefore;
+        for (const RecordId& loc : updatedLocs) {
+            _updatedLocs->erase(loc);
+        }
+        for (WorkingSetID id : _batch) {
+            _ws->get(id)->makeObjOwnedIfNeeded();
+            _idsRetrying.push_back(id);
+        }
+        _batch.clear();
+        *out = WorkingSet::INVALID_ID;
+        _commonStats.needYield++;
+        return NEED_YIELD;
+    }
+
+    for (WorkingSetID id : _batch) {
+        _ws->free(id);
+    }
+    _batch.clear();
+
+    // Restore outside of the WriteUnitOfWork, as in the single document case.
+    try {
+        child()->restoreState();
+    } catch (const WriteConflictException& wce) {
+        // The updates were committed, so there is nothing to retry.
+        *out = WorkingSet::INVALID_ID;
+        _commonStats.needYield++;
+        return NEED_YIELD;
+    }
+
+    ++_commonStats.needTime;
+    return PlanStage::NEED_TIME;
+}
+
 Status UpdateStage::restoreUpdateState() {
     const UpdateRequest& request = *_params.request;
     const NamespaceString& nsString(request.getNamespaceString());
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <deque>
+#include <vector>
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/exec/plan_stage.h"
@@ -69,6 +71,11 @@ private:
  * returned after updating or inserting a document. Otherwise, NEED_TIME is returned after
  * updating or inserting a document.
  *
+ * A multi update on a storage engine with document-level locking collects up to
+ * internalQueryExecWriteBatchSize documents and updates them in one WriteUnitOfWork. If that
+ * fails, the documents are retried one per WriteUnitOfWork, so an error is only reported once
+ * every document before it is updated.
+ *
  * Callers of work() must be holding a write lock.
  */
 class UpdateStage final : public PlanStage {
@@ -148,6 +155,12 @@ private:
      */
     void doInsert();
 
+    /**
+     * Updates the documents in '_batch' in one WriteUnitOfWork, or moves them to '_idsRetrying'
+     * if that throws.
+     */
+    StageState updateBatch(WorkingSetID* out);
+
     /**
      * Have we performed all necessary updates? Even if this is true, we might not be EOF,
      * as we might still have to do an insert.
@@ -176,6 +189,17 @@ private:
     // If not WorkingSet::INVALID_ID, we use this rather than asking our child what to do next.
     WorkingSetID _idRetrying;
 
+    // How many documents to update per WriteUnitOfWork. Only multi updates that don't return
+    // documents use more than one.
+    const size_t _batchSize;
+
+    // Members from our child that are waiting to be updated as a batch.
+    std::vector<WorkingSetID> _batch;
+
+    // Members of a batch that failed. Each is retried on its own before we ask our child for
+    // more.
+    std::deque<WorkingSetID> _idsRetrying;
+
     // If not WorkingSet::INVALID_ID, we return this member to our caller.
     WorkingSetID _idReturning;
 
@@ -28,6 +28,8 @@
 
 #include "mongo/db/exec/working_set.h"
 
+#include <cstring>
+
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/record_fetcher.h"
@@ -36,6 +38,41 @@ namespace mongo {
 
 using std::string;
 
+//
+// WorkingSetArena
+//
+
+BSONObj WorkingSetArena::copy(const BSONObj& obj) {
+    const size_t size = obj.objsize();
+    ++_numCopies;
+    if (size > kMaxPackedObjBytes) {
+        ++_numAllocations;
+        return obj.copy();
+    }
+
+    if (!_block.get() || _blockUsed + size > kBlockBytes) {
+        _block = SharedBuffer::allocate(kBlockBytes);
+        _blockUsed = 0;
+        ++_numAllocations;
+    }
+
+    char* data = _block.get() + _blockUsed;
+    memcpy(data, obj.objdata(), size);
+
+    // Keep each object 8-byte aligned.
+    _blockUsed += (size + 7) & ~size_t(7);
+    return BSONObj(_block, data);
+}
+
+void WorkingSetArena::releaseBlock() {
+    _block = SharedBuffer();
+    _blockUsed = 0;
+}
+
+//
+// WorkingSet
+//
+
 WorkingSet::MemberHolder::MemberHolder() : member(NULL) {}
 WorkingSet::MemberHolder::~MemberHolder() {}
 
@@ -56,6 +93,7 @@ WorkingSetID WorkingSet::allocate() {
         _data.resize(_data.size() + 1);
         _data.back().nextFreeOrSelf = id;
         _data.back().member = new WorkingSetMember();
+        _data.back().member->_arena = &_arena;
         return id;
     }
 
@@ -171,10 +209,16 @@ bool WorkingSetMember::hasOwnedObj() const {
 
 void WorkingSetMember::makeObjOwnedIfNeeded() {
     if (supportsDocLocking() && _state == LOC_AND_OBJ && !obj.value().isOwned()) {
-        obj.setValue(obj.value().getOwned());
+        obj.setValue(ownedCopy(obj.value()));
     }
 }
 
+BSONObj WorkingSetMember::ownedCopy(const BSONObj& bson) {
+    if (bson.isOwned())
+        return bson;
+    return _arena ? _arena->copy(bson) : bson.getOwned();
+}
+
 bool WorkingSetMember::hasComputed(const WorkingSetComputedDataType type) const {
     return _computed[type].get();
 }
@@ -45,6 +45,55 @@ class WorkingSetMember;
 
 typedef size_t WorkingSetID;
 
+/**
+ * Makes the owned copies of documents and index keys that a WorkingSet's members hold. Rather
+ * than giving each copy its own heap allocation, small objects are packed into shared blocks.
+ * Every copy keeps a reference to its block, so a block is freed once all of the objects in it
+ * are, and the arena itself only holds on to the block it is filling.
+ */
+class WorkingSetArena {
+    MONGO_DISALLOW_COPYING(WorkingSetArena);
+
+public:
+    static const size_t kBlockBytes = 16 * 1024;
+
+    // Larger objects get a buffer of their own so that they do not leave most of a block unused.
+    static const size_t kMaxPackedObjBytes = 1024;
+
+    WorkingSetArena() = default;
+
+    /**
+     * Returns an owned copy of 'obj'.
+     */
+    BSONObj copy(const BSONObj& obj);
+
+    /**
+     * Stops filling the current block so that it is freed as soon as the objects in it are,
+     * rather than being held until it fills up. Called when the owning query yields or finishes
+     * a batch.
+     */
+    void releaseBlock();
+
+    /**
+     * The number of heap allocations made for copies so far: blocks, plus objects too large to
+     * pack. Compared with the number of results returned, this shows how well copies are packed.
+     */
+    size_t numAllocations() const {
+        return _numAllocations;
+    }
+
+    size_t numCopies() const {
+        return _numCopies;
+    }
+
+private:
+    SharedBuffer _block;
+    size_t _blockUsed = 0;
+
+    size_t _numAllocations = 0;
+    size_t _numCopies = 0;
+};
+
 /**
  * All data in use by a query.  Data is passed through the stage tree by referencing the ID of
  * an element of the working set.  Stages can add elements to the working set, delete elements
@@ -139,6 +188,13 @@ public:
      */
     std::vector<WorkingSetID> getAndClearYieldSensitiveIds();
 
+    /**
+     * The arena used by this working set's members for owned copies of their data.
+     */
+    WorkingSetArena* arena() {
+        return &_arena;
+    }
+
 private:
     struct MemberHolder {
         MemberHolder();
@@ -165,6 +221,8 @@ private:
 
     // Contains ids of WSMs that may need to be adjusted when we next yield.
     std::vector<WorkingSetID> _yieldSensitiveIds;
+
+    WorkingSetArena _arena;
 };
 
 /**
@@ -298,6 +356,12 @@ public:
      */
     void makeObjOwnedIfNeeded();
 
+    /**
+     * Returns 'bson' if it is owned, and otherwise an owned copy of it made in the working set's
+     * arena. Stages should use this for data they store in the member rather than getOwned().
+     */
+    BSONObj ownedCopy(const BSONObj& bson);
+
     //
     // Computed data
     //
@@ -336,6 +400,9 @@ private:
 
     MemberState _state = WorkingSetMember::INVALID;
 
+    // The arena of the WorkingSet that owns this member, if any. Not owned.
+    WorkingSetArena* _arena = nullptr;
+
     std::unique_ptr<WorkingSetComputedData> _computed[WSM_COMPUTED_NUM_TYPES];
 
     std::unique_ptr<RecordFetcher> _fetcher;
@@ -55,7 +55,7 @@ bool WorkingSetCommon::fetchAndInvalidateLoc(OperationContext* txn,
 
     // Do the fetch, invalidate the DL.
     member->obj = collection->docFor(txn, member->loc);
-    member->obj.setValue(member->obj.value().getOwned());
+    member->obj.setValue(member->ownedCopy(member->obj.value()));
     member->loc = RecordId();
     member->transitionToOwnedObj();
 
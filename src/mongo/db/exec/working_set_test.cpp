@@ -64,6 +64,49 @@ protected:
     WorkingSetMember* member;
 };
 
+TEST_F(WorkingSetFixture, ownedCopyPacksSmallObjects) {
+    const BSONObj unowned = BSON("a" << 1).getOwned();
+    const BSONObj view(unowned.objdata());
+    ASSERT_FALSE(view.isOwned());
+
+    std::vector<BSONObj> copies;
+    for (int i = 0; i < 100; i++) {
+        copies.push_back(member->ownedCopy(view));
+    }
+    for (const BSONObj& copy : copies) {
+        ASSERT_TRUE(copy.isOwned());
+        ASSERT_EQUALS(unowned, copy);
+        ASSERT_NOT_EQUALS(unowned.objdata(), copy.objdata());
+    }
+    ASSERT_EQUALS(100U, ws->arena()->numCopies());
+    ASSERT_EQUALS(1U, ws->arena()->numAllocations());
+
+    // Objects that are already owned are not copied.
+    ASSERT_EQUALS(unowned.objdata(), member->ownedCopy(unowned).objdata());
+    ASSERT_EQUALS(100U, ws->arena()->numCopies());
+}
+
+TEST_F(WorkingSetFixture, ownedCopyOfLargeObjectIsSeparate) {
+    const BSONObj big = BSON("a" << std::string(WorkingSetArena::kMaxPackedObjBytes, 'x'));
+    const BSONObj view(big.objdata());
+
+    member->ownedCopy(view);
+    member->ownedCopy(view);
+    ASSERT_EQUALS(2U, ws->arena()->numAllocations());
+}
+
+TEST_F(WorkingSetFixture, ownedCopiesOutliveArenaBlock) {
+    const BSONObj unowned = BSON("a" << 1).getOwned();
+    BSONObj copy = member->ownedCopy(BSONObj(unowned.objdata()));
+
+    ws->arena()->releaseBlock();
+    member->ownedCopy(BSONObj(unowned.objdata()));
+    ASSERT_EQUALS(2U, ws->arena()->numAllocations());
+
+    ws.reset();
+    ASSERT_EQUALS(unowned, copy);
+}
+
 TEST_F(WorkingSetFixture, noFieldToGet) {
     BSONElement elt;
 
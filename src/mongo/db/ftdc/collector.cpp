@@ -41,16 +41,30 @@
 
 namespace mongo {
 
-void FTDCCollectorCollection::add(std::unique_ptr<FTDCCollectorInterface> collector) {
+void FTDCCollectorCollection::add(std::unique_ptr<FTDCCollectorInterface> collector,
+                                  Milliseconds period) {
     // TODO: ensure the collectors all have unique names.
-    _collectors.emplace_back(std::move(collector));
+    CollectorEntry entry;
+    entry.collector = std::move(collector);
+    entry.period = period;
+    _collectors.emplace_back(std::move(entry));
 }
 
 BSONObj FTDCCollectorCollection::collect(Client* client) {
     BSONObjBuilder builder;
 
-    for (auto& collector : _collectors) {
-        BSONObjBuilder subObjBuilder(builder.subobjStart(collector->name()));
+    for (auto& entry : _collectors) {
+        auto& collector = entry.collector;
+        const Date_t now = client->getServiceContext()->getClockSource()->now();
+
+        // Repeat the last result of a collector which is not due yet.
+        if (entry.period != Milliseconds(0) && !entry.lastSample.isEmpty() &&
+            now < entry.lastCollected + entry.period) {
+            builder.append(collector->name(), entry.lastSample);
+            continue;
+        }
+
+        BSONObjBuilder subObjBuilder;
 
         // Add a Date_t before and after each BSON is collected so that we can track timing of the
         // collector.
@@ -67,6 +81,14 @@ BSONObj FTDCCollectorCollection::collect(Client* client) {
 
         subObjBuilder.appendDate(kFTDCCollectEndField,
                                  client->getServiceContext()->getClockSource()->now());
+
+        BSONObj sample = subObjBuilder.obj();
+        builder.append(collector->name(), sample);
+
+        if (entry.period != Milliseconds(0)) {
+            entry.lastCollected = now;
+            entry.lastSample = sample.getOwned();
+        }
     }
 
     return builder.obj();
@@ -32,6 +32,8 @@
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -84,8 +86,13 @@ public:
     /**
      * Add a metric collector to the collection.
      * Must be called before collect. Cannot be called after collect is called.
+     *
+     * A collector with a non-zero period is run at most once per period, for expensive sources.
+     * The samples collected in between repeat its last result, so that the schema of the samples
+     * does not change and its metrics compress to runs of zero deltas.
      */
-    void add(std::unique_ptr<FTDCCollectorInterface> collector);
+    void add(std::unique_ptr<FTDCCollectorInterface> collector,
+             Milliseconds period = Milliseconds(0));
 
     /**
      * Collect a sample from all collectors. Called after all adding is complete.
@@ -102,8 +109,19 @@ public:
     BSONObj collect(Client* client);
 
 private:
+    struct CollectorEntry {
+        std::unique_ptr<FTDCCollectorInterface> collector;
+
+        // Minimum time between two runs of the collector, or zero to run it for each sample
+        Milliseconds period;
+
+        // Time of the last run of a collector with a period, and the result of that run
+        Date_t lastCollected;
+        BSONObj lastSample;
+    };
+
     // collection of collectors
-    std::vector<std::unique_ptr<FTDCCollectorInterface>> _collectors;
+    std::vector<CollectorEntry> _collectors;
 };
 
 }  // namespace mongo
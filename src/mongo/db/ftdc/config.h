@@ -46,7 +46,9 @@ struct FTDCConfig {
           maxFileSizeBytes(kMaxFileSizeBytesDefault),
           period(kPeriodMillisDefault),
           maxSamplesPerArchiveMetricChunk(kMaxSamplesPerArchiveMetricChunkDefault),
-          maxSamplesPerInterimMetricChunk(kMaxSamplesPerInterimMetricChunkDefault) {}
+          maxSamplesPerInterimMetricChunk(kMaxSamplesPerInterimMetricChunkDefault),
+          ringDuration(kRingDurationSecsDefault),
+          ringPeriod(kRingPeriodMillisDefault) {}
 
     /**
      * True if FTDC is collecting data. False otherwise
@@ -83,6 +85,19 @@ struct FTDCConfig {
      */
     std::uint32_t maxSamplesPerInterimMetricChunk;
 
+    /**
+     * Length of the window of samples kept in memory at high resolution, or zero to keep none.
+     *
+     * While the ring is enabled, samples are collected every ringPeriod instead of every period,
+     * but only one sample per period is written to disk.
+     */
+    Seconds ringDuration;
+
+    /**
+     * Period at which to collect samples for the in memory ring.
+     */
+    Milliseconds ringPeriod;
+
     static const bool kEnabledDefault = true;
 
     static const std::uint64_t kPeriodMillisDefault;
@@ -93,6 +108,9 @@ struct FTDCConfig {
 
     static const std::uint32_t kMaxSamplesPerArchiveMetricChunkDefault = 300;
     static const std::uint32_t kMaxSamplesPerInterimMetricChunkDefault = 10;
+
+    static const std::uint64_t kRingDurationSecsDefault;
+    static const std::uint64_t kRingPeriodMillisDefault;
 };
 
 }  // namespace mongo
@@ -81,12 +81,25 @@ void FTDCController::setMaxSamplesPerInterimMetricChunk(size_t size) {
     _condvar.notify_one();
 }
 
-void FTDCController::addPeriodicCollector(std::unique_ptr<FTDCCollectorInterface> collector) {
+void FTDCController::setRingDuration(Seconds duration) {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    _configTemp.ringDuration = duration;
+    _condvar.notify_one();
+}
+
+void FTDCController::setRingPeriod(Milliseconds millis) {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    _configTemp.ringPeriod = millis;
+    _condvar.notify_one();
+}
+
+void FTDCController::addPeriodicCollector(std::unique_ptr<FTDCCollectorInterface> collector,
+                                          Milliseconds period) {
     {
         stdx::lock_guard<stdx::mutex> lock(_mutex);
         invariant(_state == State::kNotStarted);
 
-        _periodicCollectors.add(std::move(collector));
+        _periodicCollectors.add(std::move(collector), period);
     }
 }
 
@@ -146,6 +159,11 @@ void FTDCController::stop() {
     }
 }
 
+StatusWith<std::vector<BSONObj>> FTDCController::getRingChunks() {
+    stdx::lock_guard<stdx::mutex> lock(_ringMutex);
+    return _ring.getChunks();
+}
+
 void FTDCController::doLoop() {
     try {
         // Update config
@@ -161,13 +179,22 @@ void FTDCController::doLoop() {
 
         _mgr = uassertStatusOK(std::move(swMgr));
 
+        // Time at which the next sample is written to disk. While the ring is enabled, samples are
+        // collected more often than they are written.
+        Date_t nextDiskSample;
+
         while (true) {
             // Compute the next interval to run regardless of how we were woken up
             // Skipping an interval due to a race condition with a config signal is harmless.
             auto now = getGlobalServiceContext()->getClockSource()->now();
 
+            Milliseconds period = _config.period;
+            if (isRingEnabled() && _config.ringPeriod < period) {
+                period = _config.ringPeriod;
+            }
+
             // Get next time to run at
-            auto next_time = FTDCUtil::roundTime(now, _config.period);
+            auto next_time = FTDCUtil::roundTime(now, period);
 
             // Wait for the next run or signal to shutdown
             {
@@ -185,8 +212,13 @@ void FTDCController::doLoop() {
                 // if we were signalled, then we have a config update only or were asked to stop
                 if (status == stdx::cv_status::no_timeout) {
                     // Update the current configuration settings
+                    stdx::lock_guard<stdx::mutex> ringLock(_ringMutex);
                     _config = _configTemp;
 
+                    if (!isRingEnabled()) {
+                        _ring.reset();
+                    }
+
                     continue;
                 }
             }
@@ -196,9 +228,19 @@ void FTDCController::doLoop() {
             if (_config.enabled) {
                 BSONObj obj = _periodicCollectors.collect(client);
 
-                Status s = _mgr->writeSampleAndRotateIfNeeded(client, obj);
+                // Every sample is written when the ring does not shorten the period.
+                if (period == _config.period || next_time >= nextDiskSample) {
+                    Status s = _mgr->writeSampleAndRotateIfNeeded(client, obj);
 
-                uassertStatusOK(s);
+                    uassertStatusOK(s);
+
+                    nextDiskSample = FTDCUtil::roundTime(next_time, _config.period);
+                }
+
+                if (isRingEnabled()) {
+                    stdx::lock_guard<stdx::mutex> ringLock(_ringMutex);
+                    uassertStatusOK(_ring.addSample(obj, next_time));
+                }
             }
         }
     } catch (...) {
@@ -36,6 +36,7 @@
 #include "mongo/db/ftdc/collector.h"
 #include "mongo/db/ftdc/config.h"
 #include "mongo/db/ftdc/file_manager.h"
+#include "mongo/db/ftdc/ring_buffer.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
@@ -54,7 +55,7 @@ class FTDCController {
 
 public:
     FTDCController(const boost::filesystem::path path, FTDCConfig config)
-        : _path(path), _config(std::move(config)), _configTemp(_config) {}
+        : _path(path), _config(std::move(config)), _configTemp(_config), _ring(&_config) {}
 
     ~FTDCController() = default;
 
@@ -92,10 +93,25 @@ public:
      */
     void setMaxSamplesPerInterimMetricChunk(size_t size);
 
+    /**
+     * Set the length of the window of high resolution samples kept in memory. Zero disables the
+     * ring, and frees its samples.
+     */
+    void setRingDuration(Seconds duration);
+
+    /**
+     * Set the period for data collection into the in memory ring.
+     */
+    void setRingPeriod(Milliseconds millis);
+
     /**
      * Add a metric collector to collect periodically. i.e., serverStatus
+     *
+     * A non-zero period makes the collector run at most once per period, for expensive sources.
+     * See FTDCCollectorCollection::add.
      */
-    void addPeriodicCollector(std::unique_ptr<FTDCCollectorInterface> collector);
+    void addPeriodicCollector(std::unique_ptr<FTDCCollectorInterface> collector,
+                              Milliseconds period = Milliseconds(0));
 
     /**
      * Add a collector to collect on server start, and file rotation. i.e. hostInfo
@@ -118,12 +134,25 @@ public:
      */
     void stop();
 
+    /**
+     * Get the metric chunks of the in memory ring, oldest first. The list is empty if the ring is
+     * not enabled.
+     */
+    StatusWith<std::vector<BSONObj>> getRingChunks();
+
 private:
     /**
      * Do periodic statistics collection, and all other work on the background thread.
      */
     void doLoop();
 
+    /**
+     * Is the in memory ring collecting samples with the current configuration?
+     */
+    bool isRingEnabled() const {
+        return _config.ringDuration > Seconds(0);
+    }
+
 private:
     /**
     * Private enum to track state.
@@ -184,6 +213,12 @@ private:
 
     // Background collection and writing thread
     stdx::thread _thread;
+
+    // Mutex to protect the ring, which is read by the commands dumping it.
+    stdx::mutex _ringMutex;
+
+    // In memory ring of high resolution samples
+    FTDCRingBuffer _ring;
 };
 
 }  // namespace mongo
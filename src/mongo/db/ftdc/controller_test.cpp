@@ -41,7 +41,9 @@
 #include "mongo/db/ftdc/config.h"
 #include "mongo/db/ftdc/constants.h"
 #include "mongo/db/ftdc/controller.h"
+#include "mongo/db/ftdc/decompressor.h"
 #include "mongo/db/ftdc/ftdc_test.h"
+#include "mongo/db/ftdc/util.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/service_context.h"
 #include "mongo/unittest/temp_dir.h"
@@ -196,4 +198,58 @@ TEST(FTDCControllerTest, TestFull) {
     ValidateDocumentList(alog, allDocs);
 }
 
+// Test that the ring keeps the samples collected at its shorter period, and that a collector with
+// a long period is only run once
+TEST(FTDCControllerTest, TestRing) {
+    unittest::TempDir tempdir("metrics_testpath");
+    boost::filesystem::path dir(tempdir.path());
+
+    createDirectoryClean(dir);
+
+    FTDCConfig config;
+    config.enabled = true;
+    config.period = Milliseconds(60 * 1000);
+    config.ringDuration = Seconds(3600);
+    config.ringPeriod = Milliseconds(1);
+
+    FTDCController c(dir, config);
+
+    auto c1 = std::unique_ptr<FTDCMetricsCollectorMock2>(new FTDCMetricsCollectorMock2());
+    auto c2 = std::unique_ptr<FTDCMetricsCollectorMockRotate>(new FTDCMetricsCollectorMockRotate());
+    auto c3 = std::unique_ptr<FTDCMetricsCollectorMockRotate>(new FTDCMetricsCollectorMockRotate());
+
+    auto c1Ptr = c1.get();
+    auto c3Ptr = c3.get();
+
+    c1Ptr->setSignalOnCount(50);
+
+    c.addPeriodicCollector(std::move(c1));
+    c.addPeriodicCollector(std::move(c3), Milliseconds(60 * 60 * 1000));
+
+    c.addOnRotateCollector(std::move(c2));
+
+    c.start();
+
+    // Wait for 50 samples to have occured
+    c1Ptr->wait();
+
+    c.stop();
+
+    ASSERT_EQUALS(c3Ptr->getDocs().size(), 1UL);
+
+    auto swChunks = c.getRingChunks();
+    ASSERT_OK(swChunks.getStatus());
+
+    FTDCDecompressor decompressor;
+    std::vector<BSONObj> ringDocs;
+    for (const auto& chunk : swChunks.getValue()) {
+        auto swDocs = FTDCBSONUtil::getMetricsFromMetricDoc(chunk, &decompressor);
+        ASSERT_OK(swDocs.getStatus());
+        ringDocs.insert(ringDocs.end(), swDocs.getValue().begin(), swDocs.getValue().end());
+    }
+
+    ASSERT_EQUALS(ringDocs.size(), c1Ptr->getDocs().size());
+    ASSERT_GREATER_THAN_OR_EQUALS(ringDocs.size(), 50UL);
+}
+
 }  // namespace mongo
@@ -36,6 +36,9 @@
 #include "mongo/base/status.h"
 #include "mongo/bson/bsonobjbuilder.h"
 
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/ftdc/collector.h"
 #include "mongo/db/ftdc/config.h"
@@ -239,6 +242,65 @@ public:
 
 } exportedFTDCInterimChunkSizeParameter;
 
+std::int32_t localRingDurationSecs = FTDCConfig::kRingDurationSecsDefault;
+
+class ExportedFTDCRingDurationParameter : public ExportedServerParameter<std::int32_t> {
+public:
+    ExportedFTDCRingDurationParameter()
+        : ExportedServerParameter<std::int32_t>(ServerParameterSet::getGlobal(),
+                                                "diagnosticDataCollectionRingDurationSecs",
+                                                &localRingDurationSecs,
+                                                true,
+                                                true) {}
+
+    virtual Status validate(const std::int32_t& potentialNewValue) {
+        if (potentialNewValue < 0 || potentialNewValue > 3600) {
+            return Status(ErrorCodes::BadValue,
+                          "diagnosticDataCollectionRingDurationSecs must be between 0 and 3600");
+        }
+
+        auto controller = getGlobalFTDCController();
+        if (controller) {
+            controller->setRingDuration(Seconds(potentialNewValue));
+        }
+
+        return Status::OK();
+    }
+
+} exportedFTDCRingDurationParameter;
+
+std::int32_t localRingPeriodMillis = FTDCConfig::kRingPeriodMillisDefault;
+
+class ExportedFTDCRingPeriodParameter : public ExportedServerParameter<std::int32_t> {
+public:
+    ExportedFTDCRingPeriodParameter()
+        : ExportedServerParameter<std::int32_t>(ServerParameterSet::getGlobal(),
+                                                "diagnosticDataCollectionRingPeriodMillis",
+                                                &localRingPeriodMillis,
+                                                true,
+                                                true) {}
+
+    virtual Status validate(const std::int32_t& potentialNewValue) {
+        if (potentialNewValue < 10) {
+            return Status(
+                ErrorCodes::BadValue,
+                "diagnosticDataCollectionRingPeriodMillis must be greater than or equal to 10ms");
+        }
+
+        auto controller = getGlobalFTDCController();
+        if (controller) {
+            controller->setRingPeriod(Milliseconds(potentialNewValue));
+        }
+
+        return Status::OK();
+    }
+
+} exportedFTDCRingPeriodParameter;
+
+// The collection statistics are expensive to gather compared to the other metrics, so they are
+// collected at a lower resolution.
+const Milliseconds kCollStatsPeriod(10 * 1000);
+
 class FTDCSimpleInternalCommandCollector final : public FTDCCollectorInterface {
 public:
     FTDCSimpleInternalCommandCollector(StringData command,
@@ -254,7 +316,7 @@ public:
     }
 
     void collect(OperationContext* txn, BSONObjBuilder& builder) override {
-        BSONObj cmdObj;
+        BSONObj cmdObj = _param;
         std::string errmsg;
 
         bool ret = _command->run(txn, _ns, cmdObj, 0, errmsg, builder);
@@ -280,6 +342,84 @@ private:
     Command* _command;
 };
 
+/**
+ * Dumps the metric chunks of the in memory ring of high resolution samples.
+ *
+ * { getDiagnosticDataRing: 1 }
+ *
+ * The chunks have the format of the metric chunks in the diagnostic.data files. When they do not
+ * all fit in a reply, the oldest ones are left out, and 'truncated' is set.
+ */
+class CmdGetDiagnosticDataRing final : public Command {
+public:
+    CmdGetDiagnosticDataRing() : Command("getDiagnosticDataRing") {}
+
+    bool slaveOk() const override {
+        return true;
+    }
+
+    bool adminOnly() const override {
+        return true;
+    }
+
+    bool isWriteCommandForConfigServer() const override {
+        return false;
+    }
+
+    void help(std::stringstream& help) const override {
+        help << "dump the samples of the in memory ring of diagnostic data.\n"
+             << "{ getDiagnosticDataRing: 1 }";
+    }
+
+    void addRequiredPrivileges(const std::string& dbname,
+                               const BSONObj& cmdObj,
+                               std::vector<Privilege>* out) override {
+        ActionSet actions;
+        actions.addAction(ActionType::serverStatus);
+        out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+    }
+
+    bool run(OperationContext* txn,
+             const std::string& db,
+             BSONObj& cmdObj,
+             int options,
+             std::string& errmsg,
+             BSONObjBuilder& result) override {
+        auto controller = getGlobalFTDCController();
+        if (!controller) {
+            return appendCommandStatus(
+                result,
+                Status(ErrorCodes::IllegalOperation,
+                       "full-time diagnostic data capture is not running"));
+        }
+
+        auto swChunks = controller->getRingChunks();
+        if (!swChunks.isOK()) {
+            return appendCommandStatus(result, swChunks.getStatus());
+        }
+        const auto& chunks = swChunks.getValue();
+
+        // Keep the newest chunks which fit in the reply.
+        const int maxSize = BSONObjMaxUserSize - 64 * 1024;
+        int size = 0;
+        auto first = chunks.end();
+        while (first != chunks.begin() && size + (first - 1)->objsize() <= maxSize) {
+            --first;
+            size += first->objsize();
+        }
+
+        BSONArrayBuilder arr(result.subarrayStart("chunks"));
+        for (auto it = first; it != chunks.end(); ++it) {
+            arr.append(*it);
+        }
+        arr.done();
+
+        result.append("truncated", first != chunks.begin());
+        return true;
+    }
+
+} cmdGetDiagnosticDataRing;
+
 }  // namespace
 
 
@@ -299,6 +439,8 @@ void startFTDC() {
     config.maxDirectorySizeBytes = localMaxDirectorySizeMB * 1024 * 1024;
     config.maxSamplesPerArchiveMetricChunk = localMaxSamplesPerArchiveMetricChunk;
     config.maxSamplesPerInterimMetricChunk = localMaxSamplesPerInterimMetricChunk;
+    config.ringDuration = Seconds(localRingDurationSecs);
+    config.ringPeriod = Milliseconds(localRingPeriodMillis);
 
     auto controller = stdx::make_unique<FTDCController>(dir, config);
 
@@ -306,8 +448,18 @@ void startFTDC() {
     // These are collected on the period interval in FTDCConfig.
 
     // CmdServerStatus
+    // The operation latency histograms are collected with a fixed list of buckets, so that the
+    // compressor encodes them as deltas like the other metrics.
+    controller->addPeriodicCollector(stdx::make_unique<FTDCSimpleInternalCommandCollector>(
+        "serverStatus",
+        "serverStatus",
+        "",
+        BSON("serverStatus" << 1 << "tcMalloc" << true << "opLatencies"
+                            << BSON("denseHistograms" << true))));
+
+    // CmdLockContention
     controller->addPeriodicCollector(stdx::make_unique<FTDCSimpleInternalCommandCollector>(
-        "serverStatus", "serverStatus", "", BSON("tcMalloc" << true)));
+        "lockContention", "lockContention", "", BSONObj()));
 
     // These metrics are only collected if replication is enabled
     if (repl::getGlobalReplicationCoordinator()->getReplicationMode() !=
@@ -317,8 +469,10 @@ void startFTDC() {
             "replSetGetStatus", "replSetGetStatus", "", BSONObj()));
 
         // CollectionStats
-        controller->addPeriodicCollector(stdx::make_unique<FTDCSimpleInternalCommandCollector>(
-            "collStats", "local.oplog.rs.stats", "local.oplog.rs", BSONObj()));
+        controller->addPeriodicCollector(
+            stdx::make_unique<FTDCSimpleInternalCommandCollector>(
+                "collStats", "local.oplog.rs.stats", "local.oplog.rs", BSONObj()),
+            kCollStatsPeriod);
     }
 
     // Install file rotation collectors
@@ -0,0 +1,97 @@
+/**
+ * Copyright (C) 2015 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/ftdc/ring_buffer.h"
+
+#include "mongo/db/ftdc/util.h"
+
+namespace mongo {
+
+Status FTDCRingBuffer::addSample(const BSONObj& sample, Date_t now) {
+    auto ret = _compressor.addSample(sample);
+
+    if (!ret.isOK()) {
+        return ret.getStatus();
+    }
+
+    // A full chunk includes the new sample, while the chunk flushed on a schema change does not.
+    _hasPendingSamples = true;
+
+    if (ret.getValue().is_initialized()) {
+        if (std::get<1>(ret.getValue().get()) ==
+            FTDCCompressor::CompressorState::kCompressorFull) {
+            _hasPendingSamples = false;
+        }
+
+        Chunk chunk;
+        chunk.end = now;
+        chunk.doc = FTDCBSONUtil::createBSONMetricChunkDocument(std::get<0>(ret.getValue().get()));
+
+        _sizeBytes += chunk.doc.objsize();
+        _chunks.emplace_back(std::move(chunk));
+    }
+
+    const Date_t windowStart = now - _config->ringDuration;
+    while (!_chunks.empty() && _chunks.front().end < windowStart) {
+        _sizeBytes -= _chunks.front().doc.objsize();
+        _chunks.pop_front();
+    }
+
+    return Status::OK();
+}
+
+StatusWith<std::vector<BSONObj>> FTDCRingBuffer::getChunks() {
+    std::vector<BSONObj> chunks;
+    chunks.reserve(_chunks.size() + 1);
+
+    for (const auto& chunk : _chunks) {
+        chunks.push_back(chunk.doc);
+    }
+
+    if (_hasPendingSamples) {
+        auto swBuf = _compressor.getCompressedSamples();
+        if (!swBuf.isOK()) {
+            return swBuf.getStatus();
+        }
+
+        chunks.push_back(FTDCBSONUtil::createBSONMetricChunkDocument(swBuf.getValue()));
+    }
+
+    return {std::move(chunks)};
+}
+
+void FTDCRingBuffer::reset() {
+    _compressor.reset();
+    _chunks.clear();
+    _sizeBytes = 0;
+    _hasPendingSamples = false;
+}
+
+}  // namespace mongo
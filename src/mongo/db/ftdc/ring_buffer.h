@@ -0,0 +1,110 @@
+/**
+ * Copyright (C) 2015 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/base/status_with.h"
+#include "mongo/db/ftdc/compressor.h"
+#include "mongo/db/ftdc/config.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+/**
+ * FTDCRingBuffer keeps the samples of the last FTDCConfig::ringDuration in memory as compressed
+ * metric chunks, so that a window of high resolution samples can be dumped on demand without
+ * writing them to disk.
+ *
+ * The window is trimmed a chunk at a time, so it may hold up to one archive chunk of samples
+ * more than the configured duration.
+ *
+ * Not thread-safe.
+ */
+class FTDCRingBuffer {
+    MONGO_DISALLOW_COPYING(FTDCRingBuffer);
+
+public:
+    explicit FTDCRingBuffer(const FTDCConfig* config) : _config(config), _compressor(config) {}
+
+    /**
+     * Add a sample collected at the given time, and drop the chunks which ended before the start
+     * of the window.
+     */
+    Status addSample(const BSONObj& sample, Date_t now);
+
+    /**
+     * Get the metric chunk documents in the ring, oldest first, including a chunk for the samples
+     * not compressed into a full chunk yet. The documents have the same format as the metric
+     * chunks in the FTDC files.
+     */
+    StatusWith<std::vector<BSONObj>> getChunks();
+
+    /**
+     * Drop all the samples.
+     */
+    void reset();
+
+    /**
+     * Returns the total size of the completed chunks in bytes.
+     */
+    std::size_t getSizeBytes() const {
+        return _sizeBytes;
+    }
+
+private:
+    struct Chunk {
+        // Time of the sample which completed the chunk
+        Date_t end;
+
+        // Metric chunk document
+        BSONObj doc;
+    };
+
+    // Config
+    const FTDCConfig* const _config;
+
+    // Compressor for the samples which are not in a completed chunk yet
+    FTDCCompressor _compressor;
+
+    // Completed chunks, oldest first
+    std::deque<Chunk> _chunks;
+
+    // Sum of the sizes of the documents in _chunks
+    std::size_t _sizeBytes{0};
+
+    // True if the compressor has samples which are not in a completed chunk
+    bool _hasPendingSamples{false};
+};
+
+}  // namespace mongo
@@ -0,0 +1,113 @@
+/**
+ * Copyright (C) 2015 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/db/ftdc/config.h"
+#include "mongo/db/ftdc/decompressor.h"
+#include "mongo/db/ftdc/ftdc_test.h"
+#include "mongo/db/ftdc/ring_buffer.h"
+#include "mongo/db/ftdc/util.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+
+namespace {
+
+BSONObj makeSample(int i) {
+    return BSON("name"
+                << "joe"
+                << "key1" << (i * 37) << "key2" << (i % 7));
+}
+
+std::vector<BSONObj> uncompressChunks(FTDCRingBuffer* ring) {
+    auto swChunks = ring->getChunks();
+    ASSERT_OK(swChunks.getStatus());
+
+    FTDCDecompressor decompressor;
+    std::vector<BSONObj> docs;
+    for (const auto& chunk : swChunks.getValue()) {
+        auto swDocs = FTDCBSONUtil::getMetricsFromMetricDoc(chunk, &decompressor);
+        ASSERT_OK(swDocs.getStatus());
+        for (const auto& doc : swDocs.getValue()) {
+            docs.push_back(doc.getOwned());
+        }
+    }
+    return docs;
+}
+
+}  // namespace
+
+// Test that all the samples of the window are returned, including the ones not in a full chunk
+TEST(FTDCRingBufferTest, TestAllSamples) {
+    FTDCConfig config;
+    config.maxSamplesPerArchiveMetricChunk = 10;
+    config.ringDuration = Seconds(3600);
+
+    FTDCRingBuffer ring(&config);
+    std::vector<BSONObj> samples;
+    for (int i = 0; i < 35; i++) {
+        samples.push_back(makeSample(i));
+        ASSERT_OK(ring.addSample(samples.back(), Date_t::fromMillisSinceEpoch(i * 100)));
+    }
+
+    ASSERT_GREATER_THAN(ring.getSizeBytes(), 0UL);
+    ValidateDocumentList(uncompressChunks(&ring), samples);
+
+    ring.reset();
+    ASSERT_EQUALS(0UL, ring.getSizeBytes());
+    ASSERT_EQUALS(0UL, uncompressChunks(&ring).size());
+}
+
+// Test that the chunks which ended before the window are dropped
+TEST(FTDCRingBufferTest, TestTrim) {
+    FTDCConfig config;
+    config.maxSamplesPerArchiveMetricChunk = 10;
+    config.ringDuration = Seconds(3);
+
+    FTDCRingBuffer ring(&config);
+    std::vector<BSONObj> samples;
+    const int kSamples = 100;
+    for (int i = 0; i < kSamples; i++) {
+        samples.push_back(makeSample(i));
+        ASSERT_OK(ring.addSample(samples.back(), Date_t::fromMillisSinceEpoch(i * 100)));
+    }
+
+    // The samples of the last 3 seconds are kept, with at most one extra chunk of older ones.
+    auto docs = uncompressChunks(&ring);
+    ASSERT_GREATER_THAN_OR_EQUALS(docs.size(), 30UL);
+    ASSERT_LESS_THAN(docs.size(), 50UL);
+
+    std::vector<BSONObj> newest(samples.end() - docs.size(), samples.end());
+    ValidateDocumentList(docs, newest);
+}
+
+}  // namespace mongo
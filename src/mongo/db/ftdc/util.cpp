@@ -63,6 +63,8 @@ const char kFTDCCollectStartField[] = "start";
 const char kFTDCCollectEndField[] = "end";
 
 const std::uint64_t FTDCConfig::kPeriodMillisDefault = 1000;
+const std::uint64_t FTDCConfig::kRingDurationSecsDefault = 0;
+const std::uint64_t FTDCConfig::kRingPeriodMillisDefault = 100;
 
 const std::size_t kMaxRecursion = 10;
 
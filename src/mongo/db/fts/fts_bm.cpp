@@ -0,0 +1,94 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <memory>
+
+#include "mongo/db/fts/fts_language.h"
+#include "mongo/db/fts/fts_spec.h"
+#include "mongo/db/fts/fts_tokenizer.h"
+#include "mongo/db/fts/stemmer.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/benchmark.h"
+
+namespace {
+
+using namespace mongo;
+using namespace mongo::fts;
+using unittest::BenchmarkState;
+using unittest::doNotOptimizeAway;
+
+const char kText[] =
+    "The quick brown fox jumps over the lazy dog while the running dogs are chasing the "
+    "jumping foxes through the gardens, and the lazy cats are watching the chasing dogs";
+
+BSONObj makeSpec(int version) {
+    return FTSSpec::fixSpec(BSON("key" << BSON("title"
+                                               << "text"
+                                               << "body"
+                                               << "text") << "textIndexVersion" << version));
+}
+
+void runScoreDocument(BenchmarkState& state, int version) {
+    const FTSSpec spec(makeSpec(version));
+    const BSONObj doc = BSON("title"
+                             << "running dogs and foxes"
+                             << "body" << kText);
+
+    while (state.keepRunning()) {
+        TermFrequencyMap terms;
+        spec.scoreDocument(doc, &terms);
+        doNotOptimizeAway(terms);
+    }
+}
+
+// What inserting a document into a text index spends tokenizing and scoring it.
+MONGO_BENCHMARK(ScoreDocumentTextIndexVersion2) {
+    runScoreDocument(state, TEXT_INDEX_VERSION_2);
+}
+
+MONGO_BENCHMARK(ScoreDocumentTextIndexVersion3) {
+    runScoreDocument(state, TEXT_INDEX_VERSION_3);
+}
+
+MONGO_BENCHMARK(CreateTokenizer) {
+    while (state.keepRunning()) {
+        std::unique_ptr<FTSTokenizer> tokenizer = languageEnglishV2.createTokenizer();
+        doNotOptimizeAway(tokenizer);
+    }
+}
+
+MONGO_BENCHMARK(StemWord) {
+    const Stemmer stemmer(&languageEnglishV2);
+    while (state.keepRunning()) {
+        doNotOptimizeAway(stemmer.stem("chasing"));
+    }
+}
+
+}  // namespace
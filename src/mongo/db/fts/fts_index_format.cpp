@@ -30,6 +30,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include <cmath>
+#include <limits>
 #include <third_party/murmurhash3/MurmurHash3.h>
 
 #include "mongo/base/init.h"
@@ -74,6 +76,16 @@ const size_t termKeyPrefixLengthV3 = 224U;
 const size_t termKeySuffixLengthV3 = 32U;
 const size_t termKeyLengthV3 = termKeyPrefixLengthV3 + termKeySuffixLengthV3;
 
+// TextIndexVersion 4.
+// Terms are stored as in version 3. Scores are stored as a whole number of
+// 1/10000ths, which takes up a few bytes in an index key where a double
+// with a fractional part takes up to nine, plus its type bits.
+const double scoreUnitsV4 = 10000;
+
+long long quantizeScoreV4(double weight) {
+    return std::llround(weight * scoreUnitsV4);
+}
+
 /**
  * Returns size of buffer required to store term in index key.
  * In version 1, terms are stored verbatim in key.
@@ -90,7 +102,8 @@ int guessTermSize(const std::string& term, TextIndexVersion textIndexVersion) {
 
         return termKeyLengthV2;
     } else {
-        invariant(TEXT_INDEX_VERSION_3 == textIndexVersion);
+        invariant(TEXT_INDEX_VERSION_3 == textIndexVersion ||
+                  TEXT_INDEX_VERSION_4 == textIndexVersion);
         if (term.size() <= termKeyPrefixLengthV3) {
             return term.size();
         }
@@ -193,6 +206,21 @@ BSONObj FTSIndexFormat::getIndexKey(double weight,
     return b.obj();
 }
 
+double FTSIndexFormat::getIndexedScore(double weight, TextIndexVersion textIndexVersion) {
+    if (TEXT_INDEX_VERSION_4 == textIndexVersion) {
+        return quantizeScoreV4(weight) / scoreUnitsV4;
+    }
+    return weight;
+}
+
+double FTSIndexFormat::getScoreFromKey(const BSONElement& scoreElement,
+                                       TextIndexVersion textIndexVersion) {
+    if (TEXT_INDEX_VERSION_4 == textIndexVersion) {
+        return scoreElement.numberLong() / scoreUnitsV4;
+    }
+    return scoreElement.number();
+}
+
 void FTSIndexFormat::_appendIndexKey(BSONObjBuilder& b,
                                      double weight,
                                      const string& term,
@@ -221,7 +249,8 @@ void FTSIndexFormat::_appendIndexKey(BSONObjBuilder& b,
         }
         b.append("", weight);
     } else {
-        invariant(TEXT_INDEX_VERSION_3 == textIndexVersion);
+        invariant(TEXT_INDEX_VERSION_3 == textIndexVersion ||
+                  TEXT_INDEX_VERSION_4 == textIndexVersion);
         if (term.size() <= termKeyPrefixLengthV3) {
             b.append("", term);
         } else {
@@ -229,7 +258,17 @@ void FTSIndexFormat::_appendIndexKey(BSONObjBuilder& b,
             invariant(termKeySuffixLengthV3 == keySuffix.size());
             b.append("", term.substr(0, termKeyPrefixLengthV3) + keySuffix);
         }
-        b.append("", weight);
+
+        if (TEXT_INDEX_VERSION_3 == textIndexVersion) {
+            b.append("", weight);
+        } else {
+            const long long score = quantizeScoreV4(weight);
+            if (score <= std::numeric_limits<int>::max()) {
+                b.append("", static_cast<int>(score));
+            } else {
+                b.append("", score);
+            }
+        }
     }
 }
 }
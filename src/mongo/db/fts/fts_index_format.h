@@ -57,6 +57,17 @@ public:
                                const BSONObj& indexPrefix,
                                TextIndexVersion textIndexVersion);
 
+    /**
+     * Returns the score of a term read back from an index key built from 'weight'.
+     */
+    static double getIndexedScore(double weight, TextIndexVersion textIndexVersion);
+
+    /**
+     * Returns the score of a term held in the element 'scoreElement' of an index key.
+     */
+    static double getScoreFromKey(const BSONElement& scoreElement,
+                                  TextIndexVersion textIndexVersion);
+
 private:
     /**
      * Helper method to get return entry from the FTSIndex as a BSONObj
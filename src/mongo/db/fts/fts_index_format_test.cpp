@@ -255,5 +255,54 @@ TEST(FTSIndexFormat, LongWordTextIndexVersion3) {
 
     assertEqualsIndexKeys(expectedKeys, keys);
 }
+
+/**
+ * Tests keys using text index version 4.
+ * In version 4, terms are stored as in version 3 and scores are stored
+ * as integers, which read back as the scores rounded to 1/10000ths.
+ */
+TEST(FTSIndexFormat, IntegerScoresTextIndexVersion4) {
+    FTSSpec spec(FTSSpec::fixSpec(BSON("key" << BSON("data"
+                                                     << "text") << "textIndexVersion" << 4)));
+    BSONObj document = BSON("data"
+                            << "cat sat sat");
+    BSONObjSet keys;
+    FTSIndexFormat::getKeys(spec, document, &keys);
+
+    TermFrequencyMap scores;
+    spec.scoreDocument(document, &scores);
+
+    std::set<string> expectedKeys;
+    expectedKeys.insert("cat");
+    expectedKeys.insert("sat");
+    assertEqualsIndexKeys(expectedKeys, keys);
+
+    for (BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i) {
+        BSONObjIterator keyIt(*i);
+        const string term = keyIt.next().String();
+        BSONElement scoreElement = keyIt.next();
+        ASSERT_EQUALS(NumberInt, scoreElement.type());
+
+        const double score = FTSIndexFormat::getScoreFromKey(scoreElement, TEXT_INDEX_VERSION_4);
+        ASSERT_EQUALS(FTSIndexFormat::getIndexedScore(scores[term], TEXT_INDEX_VERSION_4), score);
+        ASSERT_APPROX_EQUAL(scores[term], score, 0.00005);
+    }
+}
+
+TEST(FTSIndexFormat, IndexedScoreTextIndexVersion4) {
+    ASSERT_EQUALS(1.5, FTSIndexFormat::getIndexedScore(1.5, TEXT_INDEX_VERSION_3));
+    ASSERT_EQUALS(1.0 / 3, FTSIndexFormat::getIndexedScore(1.0 / 3, TEXT_INDEX_VERSION_3));
+    ASSERT_EQUALS(0.3333, FTSIndexFormat::getIndexedScore(1.0 / 3, TEXT_INDEX_VERSION_4));
+    ASSERT_EQUALS(1.5, FTSIndexFormat::getIndexedScore(1.5, TEXT_INDEX_VERSION_4));
+
+    // The key of the highest weight doesn't fit in an int.
+    BSONObj maxKey =
+        FTSIndexFormat::getIndexKey(MAX_WEIGHT, "cat", BSONObj(), TEXT_INDEX_VERSION_4);
+    BSONObjIterator keyIt(maxKey);
+    keyIt.next();
+    BSONElement scoreElement = keyIt.next();
+    ASSERT_EQUALS(NumberLong, scoreElement.type());
+    ASSERT_EQUALS(MAX_WEIGHT, FTSIndexFormat::getScoreFromKey(scoreElement, TEXT_INDEX_VERSION_4));
+}
 }
 }
@@ -77,6 +77,7 @@ struct LanguageStringCompare {
 // FTSRegisterLanguageAliases.  For use with TEXT_INDEX_VERSION_2 text indexes and above.
 typedef std::map<std::string, const FTSLanguage*, LanguageStringCompare> LanguageMap;
 
+// Also used by TEXT_INDEX_VERSION_4, which tokenizes text the same way.
 LanguageMap languageMapV3;
 LanguageMap languageMapV2;
 
@@ -236,7 +237,7 @@ void FTSLanguage::registerLanguage(StringData languageName,
 
     if (textIndexVersion >= TEXT_INDEX_VERSION_2) {
         LanguageMap* languageMap =
-            (textIndexVersion == TEXT_INDEX_VERSION_3) ? &languageMapV3 : &languageMapV2;
+            (textIndexVersion >= TEXT_INDEX_VERSION_3) ? &languageMapV3 : &languageMapV2;
         (*languageMap)[languageName.toString()] = language;
     } else {
         // Legacy text index.
@@ -252,7 +253,7 @@ void FTSLanguage::registerLanguageAlias(const FTSLanguage* language,
                                         TextIndexVersion textIndexVersion) {
     if (textIndexVersion >= TEXT_INDEX_VERSION_2) {
         LanguageMap* languageMap =
-            (textIndexVersion == TEXT_INDEX_VERSION_3) ? &languageMapV3 : &languageMapV2;
+            (textIndexVersion >= TEXT_INDEX_VERSION_3) ? &languageMapV3 : &languageMapV2;
         (*languageMap)[alias.toString()] = language;
     } else {
         // Legacy text index.
@@ -273,7 +274,7 @@ const std::string& FTSLanguage::str() const {
 StatusWithFTSLanguage FTSLanguage::make(StringData langName, TextIndexVersion textIndexVersion) {
     if (textIndexVersion >= TEXT_INDEX_VERSION_2) {
         LanguageMap* languageMap =
-            (textIndexVersion == TEXT_INDEX_VERSION_3) ? &languageMapV3 : &languageMapV2;
+            (textIndexVersion >= TEXT_INDEX_VERSION_3) ? &languageMapV3 : &languageMapV2;
 
         LanguageMap::const_iterator it = languageMap->find(langName.toString());
 
@@ -73,10 +73,13 @@ FTSSpec::FTSSpec(const BSONObj& indexInfo) {
             "found invalid spec for text index, expected number for textIndexVersion",
             textIndexVersionElt.isNumber());
 
-    // We currently support TEXT_INDEX_VERSION_1 (deprecated), TEXT_INDEX_VERSION_2, and
-    // TEXT_INDEX_VERSION_3.
+    // We currently support TEXT_INDEX_VERSION_1 (deprecated), TEXT_INDEX_VERSION_2,
+    // TEXT_INDEX_VERSION_3 and TEXT_INDEX_VERSION_4.
     // Reject all other values.
     switch (textIndexVersionElt.numberInt()) {
+        case TEXT_INDEX_VERSION_4:
+            _textIndexVersion = TEXT_INDEX_VERSION_4;
+            break;
         case TEXT_INDEX_VERSION_3:
             _textIndexVersion = TEXT_INDEX_VERSION_3;
             break;
@@ -90,8 +93,9 @@ FTSSpec::FTSSpec(const BSONObj& indexInfo) {
             msgasserted(17364,
                         str::stream() << "attempt to use unsupported textIndexVersion "
                                       << textIndexVersionElt.numberInt()
-                                      << "; versions supported: " << TEXT_INDEX_VERSION_3 << ", "
-                                      << TEXT_INDEX_VERSION_2 << ", " << TEXT_INDEX_VERSION_1);
+                                      << "; versions supported: " << TEXT_INDEX_VERSION_4 << ", "
+                                      << TEXT_INDEX_VERSION_3 << ", " << TEXT_INDEX_VERSION_2
+                                      << ", " << TEXT_INDEX_VERSION_1);
     }
 
     // Initialize _defaultLanguage.  Note that the FTSLanguage constructor requires
@@ -430,7 +434,8 @@ BSONObj FTSSpec::fixSpec(const BSONObj& spec) {
             uassert(16730,
                     str::stream() << "bad textIndexVersion: " << textIndexVersion,
                     textIndexVersion == TEXT_INDEX_VERSION_2 ||
-                        textIndexVersion == TEXT_INDEX_VERSION_3);  // supported indexes
+                        textIndexVersion == TEXT_INDEX_VERSION_3 ||
+                        textIndexVersion == TEXT_INDEX_VERSION_4);  // supported indexes
 
         } else {
             b.append(e);
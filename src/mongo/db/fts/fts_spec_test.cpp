@@ -177,8 +177,11 @@ TEST(FTSSpec, FixTextIndexVersion1) {
     assertFixSuccess("{key: {a: 'text'}, textIndexVersion: 3.0}");
     assertFixSuccess("{key: {a: 'text'}, textIndexVersion: NumberInt(3)}}");
     assertFixSuccess("{key: {a: 'text'}, textIndexVersion: NumberLong(3)}}");
+    assertFixSuccess("{key: {a: 'text'}, textIndexVersion: 4.0}");
+    assertFixSuccess("{key: {a: 'text'}, textIndexVersion: NumberInt(4)}}");
+    assertFixSuccess("{key: {a: 'text'}, textIndexVersion: NumberLong(4)}}");
 
-    assertFixFailure("{key: {a: 'text'}, textIndexVersion: 4}");
+    assertFixFailure("{key: {a: 'text'}, textIndexVersion: 5}");
     assertFixFailure("{key: {a: 'text'}, textIndexVersion: '2'}");
     assertFixFailure("{key: {a: 'text'}, textIndexVersion: {}}");
 }
@@ -44,7 +44,8 @@ extern const std::string INDEX_NAME;
 enum TextIndexVersion {
     TEXT_INDEX_VERSION_1 = 1,  // Legacy index format.  Deprecated.
     TEXT_INDEX_VERSION_2 = 2,  // Index format with ASCII support and murmur hashing.
-    TEXT_INDEX_VERSION_3 = 3,  // Current index format with basic Unicode support.
+    TEXT_INDEX_VERSION_3 = 3,  // Default index format with basic Unicode support.
+    TEXT_INDEX_VERSION_4 = 4,  // Index format with version 3 terms and integer scores.
 };
 }
 }
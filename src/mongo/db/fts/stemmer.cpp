@@ -28,10 +28,15 @@
 *    it in the license file.
 */
 
+#include <boost/thread/tss.hpp>
 #include <cstdlib>
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "mongo/db/fts/stemmer.h"
+#include "mongo/platform/unordered_map.h"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
@@ -40,32 +45,114 @@ namespace fts {
 
 using std::string;
 
-Stemmer::Stemmer(const FTSLanguage* language) {
-    _stemmer = NULL;
-    if (language->str() != "none")
-        _stemmer = sb_stemmer_new(language->str().c_str(), "UTF_8");
+/**
+ * A libstemmer stemmer and the stems it has computed. Neither is thread safe, so a PooledStemmer
+ * belongs to one Stemmer at a time.
+ */
+struct Stemmer::PooledStemmer {
+    MONGO_DISALLOW_COPYING(PooledStemmer);
+
+public:
+    explicit PooledStemmer(const FTSLanguage* language)
+        : stemmer(sb_stemmer_new(language->str().c_str(), "UTF_8")) {}
+
+    ~PooledStemmer() {
+        if (stemmer) {
+            sb_stemmer_delete(stemmer);
+        }
+    }
+
+    struct sb_stemmer* const stemmer;
+    unordered_map<string, string> stems;
+
+    // Reused to look words up in 'stems' without allocating.
+    string word;
+};
+
+namespace {
+
+// The most released stemmers a thread keeps for each language.
+const size_t kMaxPooledStemmersPerLanguage = 4;
+
+typedef std::vector<std::unique_ptr<Stemmer::PooledStemmer>> PooledStemmers;
+typedef std::map<const FTSLanguage*, PooledStemmers> StemmerPool;
+
+/**
+ * Returns the calling thread's pool of released stemmers, which is freed when the thread exits.
+ * The thread_specific_ptr is never destroyed, so that Stemmers destroyed during static
+ * destruction can still return their stemmers to it.
+ */
+StemmerPool& threadStemmerPool() {
+    static boost::thread_specific_ptr<StemmerPool>* const pools =
+        new boost::thread_specific_ptr<StemmerPool>();
+
+    StemmerPool* pool = pools->get();
+    if (!pool) {
+        pool = new StemmerPool();
+        pools->reset(pool);
+    }
+    return *pool;
+}
+
+}  // namespace
+
+Stemmer::Stemmer(const FTSLanguage* language) : _language(language), _stemmer(NULL) {
+    if (language->str() == "none")
+        return;
+
+    PooledStemmers& pooled = threadStemmerPool()[language];
+    if (pooled.empty()) {
+        _stemmer = new PooledStemmer(language);
+    } else {
+        _stemmer = pooled.back().release();
+        pooled.pop_back();
+    }
 }
 
 Stemmer::~Stemmer() {
-    if (_stemmer) {
-        sb_stemmer_delete(_stemmer);
-        _stemmer = NULL;
+    if (!_stemmer)
+        return;
+
+    std::unique_ptr<PooledStemmer> stemmer(_stemmer);
+    _stemmer = NULL;
+
+    PooledStemmers& pooled = threadStemmerPool()[_language];
+    if (stemmer->stemmer && pooled.size() < kMaxPooledStemmersPerLanguage) {
+        pooled.push_back(std::move(stemmer));
     }
 }
 
 string Stemmer::stem(StringData word) const {
-    if (!_stemmer)
+    if (!_stemmer || !_stemmer->stemmer)
         return word.toString();
 
+    const bool cacheable = word.size() <= kMaxCachedWordSize;
+    if (cacheable) {
+        _stemmer->word.assign(word.rawData(), word.size());
+        unordered_map<string, string>::const_iterator it = _stemmer->stems.find(_stemmer->word);
+        if (it != _stemmer->stems.end()) {
+            return it->second;
+        }
+    }
+
     const sb_symbol* sb_sym =
-        sb_stemmer_stem(_stemmer, (const sb_symbol*)word.rawData(), word.size());
+        sb_stemmer_stem(_stemmer->stemmer, (const sb_symbol*)word.rawData(), word.size());
 
     if (sb_sym == NULL) {
         // out of memory
         invariant(false);
     }
 
-    return string((const char*)(sb_sym), sb_stemmer_length(_stemmer));
+    string stemmed((const char*)(sb_sym), sb_stemmer_length(_stemmer->stemmer));
+
+    if (cacheable) {
+        if (_stemmer->stems.size() >= kMaxCachedStems) {
+            _stemmer->stems.clear();
+        }
+        _stemmer->stems.insert(std::make_pair(_stemmer->word, stemmed));
+    }
+
+    return stemmed;
 }
 }
 }
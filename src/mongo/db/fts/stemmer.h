@@ -45,6 +45,11 @@ namespace fts {
  * maintains case
  * but works
  * running/Running -> run/Run
+ *
+ * Creating a libstemmer stemmer is expensive and a tokenizer, with its Stemmer, is created for
+ * every indexed field of every document, so each thread keeps the libstemmer stemmers its released
+ * Stemmers used, by language, for the next Stemmer of that language. Each pooled stemmer also
+ * caches a bounded number of the stems it has computed.
  */
 class Stemmer {
     MONGO_DISALLOW_COPYING(Stemmer);
@@ -55,8 +60,22 @@ public:
 
     std::string stem(StringData word) const;
 
+    /**
+     * The maximum number of stems cached by each pooled stemmer. The cache is emptied when it
+     * fills up.
+     */
+    static const size_t kMaxCachedStems = 4096;
+
+    /**
+     * Words longer than this, in bytes, are stemmed without going through the cache.
+     */
+    static const size_t kMaxCachedWordSize = 32;
+
+    struct PooledStemmer;
+
 private:
-    struct sb_stemmer* _stemmer;
+    const FTSLanguage* const _language;
+    PooledStemmer* _stemmer;
 };
 }
 }
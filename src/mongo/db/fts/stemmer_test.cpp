@@ -33,6 +33,7 @@
 
 #include "mongo/db/fts/fts_spec.h"
 #include "mongo/db/fts/stemmer.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 namespace fts {
@@ -48,5 +49,50 @@ TEST(English, Caps) {
     ASSERT_EQUALS("unit", s.stem("united"));
     ASSERT_EQUALS("Unite", s.stem("United"));
 }
+
+TEST(English, CachedStemsMatch) {
+    Stemmer s(&languageEnglishV2);
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQUALS("run", s.stem("running"));
+        ASSERT_EQUALS("Run", s.stem("Running"));
+        ASSERT_EQUALS("run", s.stem("runs"));
+    }
+
+    const std::string longWord = std::string(Stemmer::kMaxCachedWordSize, 'a') + "running";
+    ASSERT_EQUALS(std::string(Stemmer::kMaxCachedWordSize, 'a') + "run", s.stem(longWord));
+    ASSERT_EQUALS(std::string(Stemmer::kMaxCachedWordSize, 'a') + "run", s.stem(longWord));
+}
+
+TEST(English, CacheEmptiedWhenFull) {
+    Stemmer s(&languageEnglishV2);
+    for (size_t i = 0; i < 2 * Stemmer::kMaxCachedStems; i++) {
+        const std::string prefix = mongoutils::str::stream() << "word" << i;
+        ASSERT_EQUALS(prefix + "run", s.stem(prefix + "running"));
+    }
+    ASSERT_EQUALS("run", s.stem("running"));
+}
+
+TEST(Stemmer, PooledStemmersKeepTheirLanguage) {
+    {
+        Stemmer english(&languageEnglishV2);
+        Stemmer french(&languageFrenchV2);
+        ASSERT_EQUALS("run", english.stem("running"));
+        ASSERT_EQUALS("continuel", french.stem("continuellement"));
+    }
+
+    // These reuse the stemmers released above, and must not mix up their languages or caches.
+    Stemmer french(&languageFrenchV2);
+    Stemmer english(&languageEnglishV2);
+    ASSERT_EQUALS("continuel", french.stem("continuellement"));
+    ASSERT_EQUALS("running", french.stem("running"));
+    ASSERT_EQUALS("run", english.stem("running"));
+}
+
+TEST(Stemmer, NoneLanguageDoesNotStem) {
+    StatusWithFTSLanguage swl = FTSLanguage::make("none", TEXT_INDEX_VERSION_2);
+    ASSERT_OK(swl.getStatus());
+    Stemmer s(swl.getValue());
+    ASSERT_EQUALS("running", s.stem("running"));
+}
 }
 }
@@ -80,6 +80,75 @@ const S2Region& GeometryContainer::getS2Region() const {
     }
 }
 
+static size_t s2PolygonVertices(const S2Polygon& polygon) {
+    size_t numVertices = 0;
+    for (int i = 0; i < polygon.num_loops(); ++i) {
+        numVertices += polygon.loop(i)->num_vertices();
+    }
+    return numVertices;
+}
+
+static size_t s2PolygonWithCRSVertices(const PolygonWithCRS& polygon) {
+    if (polygon.s2Polygon) {
+        return s2PolygonVertices(*polygon.s2Polygon);
+    } else if (polygon.bigPolygon) {
+        return polygon.bigPolygon->GetLineBorder().num_vertices();
+    }
+    return polygon.oldPolygon.points().size();
+}
+
+static size_t s2MultiLineVertices(const MultiLineWithCRS& multiLine) {
+    size_t numVertices = 0;
+    for (size_t i = 0; i < multiLine.lines.vector().size(); ++i) {
+        numVertices += multiLine.lines.vector()[i]->num_vertices();
+    }
+    return numVertices;
+}
+
+static size_t s2MultiPolygonVertices(const MultiPolygonWithCRS& multiPolygon) {
+    size_t numVertices = 0;
+    for (size_t i = 0; i < multiPolygon.polygons.vector().size(); ++i) {
+        numVertices += s2PolygonVertices(*multiPolygon.polygons.vector()[i]);
+    }
+    return numVertices;
+}
+
+size_t GeometryContainer::getNumS2Vertices() const {
+    if (NULL != _line) {
+        return _line->line.num_vertices();
+    } else if (NULL != _polygon) {
+        return s2PolygonWithCRSVertices(*_polygon);
+    } else if (NULL != _multiPoint) {
+        return _multiPoint->points.size();
+    } else if (NULL != _multiLine) {
+        return s2MultiLineVertices(*_multiLine);
+    } else if (NULL != _multiPolygon) {
+        return s2MultiPolygonVertices(*_multiPolygon);
+    } else if (NULL != _geometryCollection) {
+        const GeometryCollection& collection = *_geometryCollection;
+        size_t numVertices = collection.points.size();
+        for (size_t i = 0; i < collection.lines.vector().size(); ++i) {
+            numVertices += collection.lines.vector()[i]->line.num_vertices();
+        }
+        for (size_t i = 0; i < collection.polygons.vector().size(); ++i) {
+            numVertices += s2PolygonWithCRSVertices(*collection.polygons.vector()[i]);
+        }
+        for (size_t i = 0; i < collection.multiPoints.vector().size(); ++i) {
+            numVertices += collection.multiPoints.vector()[i]->points.size();
+        }
+        for (size_t i = 0; i < collection.multiLines.vector().size(); ++i) {
+            numVertices += s2MultiLineVertices(*collection.multiLines.vector()[i]);
+        }
+        for (size_t i = 0; i < collection.multiPolygons.vector().size(); ++i) {
+            numVertices += s2MultiPolygonVertices(*collection.multiPolygons.vector()[i]);
+        }
+        return numVertices;
+    }
+
+    // A point, a box or a circle.
+    return 1;
+}
+
 bool GeometryContainer::hasR2Region() const {
     return _cap || _box || _point || (_polygon && _polygon->crs == FLAT) ||
         (_multiPoint && FLAT == _multiPoint->crs);
@@ -112,6 +112,10 @@ public:
     bool hasS2Region() const;
     const S2Region& getS2Region() const;
 
+    // Returns the number of vertices of the geometry in S2 space: points count as one vertex, and
+    // lines and polygons as the vertices of their edges.
+    size_t getNumS2Vertices() const;
+
     // Region which can be used to generate a covering of the query object in euclidean space.
     bool hasR2Region() const;
     const R2Region& getR2Region() const;
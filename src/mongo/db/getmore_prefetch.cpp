@@ -0,0 +1,190 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/getmore_prefetch.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "mongo/base/counter.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/cursor_manager.h"
+#include "mongo/db/client.h"
+#include "mongo/db/clientcursor.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+namespace {
+
+// Set until the helper thread for a cursor has unpinned it.
+struct Prefetch {
+    bool finished = false;
+    stdx::condition_variable finishedCondition;
+};
+
+stdx::mutex prefetchesMutex;
+std::unordered_map<CursorId, std::shared_ptr<Prefetch>> prefetches;
+
+// Batches loaded ahead of a getMore, the documents in them, and the getMores and killCursors
+// which arrived before the helper thread was done.
+Counter64 prefetchBatches;
+Counter64 prefetchDocuments;
+Counter64 prefetchWaits;
+ServerStatusMetricField<Counter64> displayPrefetchBatches("getMorePrefetch.batches",
+                                                          &prefetchBatches);
+ServerStatusMetricField<Counter64> displayPrefetchDocuments("getMorePrefetch.documents",
+                                                            &prefetchDocuments);
+ServerStatusMetricField<Counter64> displayPrefetchWaits("getMorePrefetch.waits", &prefetchWaits);
+
+/**
+ * Loads the next internalQueryGetMorePrefetchBytes of results from the executor of the pinned
+ * 'cursor' into the executor's own queue of results, which getNext() returns first.
+ */
+void prefetchBatch(OperationContext* txn, ClientCursor* cursor) {
+    const long long maxBytes = internalQueryGetMorePrefetchBytes;
+    PlanExecutor* exec = cursor->getExecutor();
+    exec->reattachToOperationContext(txn);
+
+    // Yielding would release locks that belong to this thread's OperationContext rather than the
+    // one the yield policy knows about.
+    exec->setYieldPolicy(PlanExecutor::WRITE_CONFLICT_RETRY_ONLY, false);
+
+    std::vector<BSONObj> batch;
+    long long batchBytes = 0;
+    std::string failure;
+    try {
+        if (exec->restoreState()) {
+            BSONObj obj;
+            PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
+            while (batchBytes < maxBytes &&
+                   PlanExecutor::ADVANCED == (state = exec->getNext(&obj, NULL))) {
+                batch.push_back(obj.getOwned());
+                batchBytes += obj.objsize();
+            }
+
+            if (PlanExecutor::FAILURE == state || PlanExecutor::DEAD == state) {
+                failure = WorkingSetCommon::toStatusString(obj);
+            }
+        }
+    } catch (const DBException& ex) {
+        failure = ex.toString();
+    }
+    exec->setYieldPolicy(PlanExecutor::YIELD_AUTO, false);
+
+    // The queue already held anything getNext() returned from it above, so putting the batch
+    // back keeps the results in order.
+    for (const BSONObj& obj : batch) {
+        exec->enqueue(obj);
+    }
+
+    // A killed executor reports why to the next getMore, which would otherwise not see the
+    // failure.
+    if (!failure.empty()) {
+        exec->kill(str::stream() << "getMore prefetch failed: " << failure);
+    }
+
+    exec->saveState();
+    exec->detachFromOperationContext();
+
+    prefetchBatches.increment();
+    prefetchDocuments.increment(batch.size());
+}
+
+void runPrefetch(const NamespaceString& nss, CursorId cursorId) {
+    Client::initThread("getMorePrefetch");
+    auto txn = cc().makeOperationContext();
+
+    // The locks are declared before the pin, so that the cursor is unpinned under them.
+    try {
+        ScopedTransaction transaction(txn.get(), MODE_IS);
+        AutoGetCollection autoColl(txn.get(), nss, MODE_IS);
+        if (Collection* collection = autoColl.getCollection()) {
+            ClientCursorPin ccPin(collection->getCursorManager(), cursorId);
+            if (ClientCursor* cursor = ccPin.c()) {
+                prefetchBatch(txn.get(), cursor);
+            }
+        }
+    } catch (const DBException& ex) {
+        // The cursor may be pinned by an operation which didn't wait for us.
+        LOG(1) << "Not prefetching for getMore on cursor " << cursorId << ": " << ex.toString();
+    }
+}
+
+}  // namespace
+
+void startGetMorePrefetch(const NamespaceString& nss, CursorId cursorId) {
+    auto prefetch = std::make_shared<Prefetch>();
+    {
+        // A getMore which pinned the cursor without waiting for an earlier helper thread may
+        // find that thread still running.
+        stdx::lock_guard<stdx::mutex> lk(prefetchesMutex);
+        if (!prefetches.emplace(cursorId, prefetch).second) {
+            return;
+        }
+    }
+
+    stdx::thread([nss, cursorId, prefetch] {
+        runPrefetch(nss, cursorId);
+
+        stdx::lock_guard<stdx::mutex> lk(prefetchesMutex);
+        prefetches.erase(cursorId);
+        prefetch->finished = true;
+        prefetch->finishedCondition.notify_all();
+    }).detach();
+}
+
+void waitForGetMorePrefetch(CursorId cursorId) {
+    stdx::unique_lock<stdx::mutex> lk(prefetchesMutex);
+    auto it = prefetches.find(cursorId);
+    if (it == prefetches.end()) {
+        return;
+    }
+
+    const std::shared_ptr<Prefetch> prefetch = it->second;
+    prefetchWaits.increment();
+    while (!prefetch->finished) {
+        prefetch->finishedCondition.wait(lk);
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,55 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/cursor_id.h"
+
+namespace mongo {
+
+class NamespaceString;
+
+/**
+ * Starts a helper thread which loads up to internalQueryGetMorePrefetchBytes of the next results
+ * of cursor 'cursorId' on 'nss' into its PlanExecutor, so they are ready when the next getMore
+ * arrives. Called by a getMore once it has unpinned the cursor, while it still holds its
+ * collection lock.
+ *
+ * The helper pins the cursor under its own intent locks, so it is subject to the usual rules on
+ * yielding and invalidation. If the cursor is gone or in use by then, it loads nothing.
+ */
+void startGetMorePrefetch(const NamespaceString& nss, CursorId cursorId);
+
+/**
+ * Waits for a helper thread started by startGetMorePrefetch() on 'cursorId', if there is one, to
+ * unpin the cursor. Must be called before pinning or killing the cursor, and without holding any
+ * locks, since the helper needs intent locks to finish.
+ */
+void waitForGetMorePrefetch(CursorId cursorId);
+
+}  // namespace mongo
@@ -42,4 +42,10 @@ Timestamp getLastSetTimestamp();
  * Generates a new and unique Timestamp.
  */
 Timestamp getNextGlobalTimestamp();
+
+/**
+ * Generates 'count' new and unique Timestamps at once and returns the first of them. They all have
+ * the same seconds, and increments that follow on from the returned one's.
+ */
+Timestamp getNextGlobalTimestamps(unsigned count);
 }
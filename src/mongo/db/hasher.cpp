@@ -37,29 +37,43 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/util/startup_test.h"
+#include "third_party/murmurhash3/MurmurHash3.h"
 
 namespace mongo {
 
-using std::unique_ptr;
-
-Hasher::Hasher(HashSeed seed) : _seed(seed) {
-    md5_init(&_md5State);
-    md5_append(&_md5State, reinterpret_cast<const md5_byte_t*>(&_seed), sizeof(_seed));
+Hasher::Hasher(HashSeed seed, int version) : _version(version), _seed(seed) {
+    verify(isValidVersion(_version));
+    if (_version == kMD5Version) {
+        md5_init(&_md5State);
+        md5_append(&_md5State, reinterpret_cast<const md5_byte_t*>(&_seed), sizeof(_seed));
+    }
 }
 
 void Hasher::addData(const void* keyData, size_t numBytes) {
-    md5_append(&_md5State, static_cast<const md5_byte_t*>(keyData), numBytes);
+    if (_version == kMD5Version) {
+        md5_append(&_md5State, static_cast<const md5_byte_t*>(keyData), numBytes);
+    } else {
+        _data.appendBuf(keyData, numBytes);
+    }
 }
 
 void Hasher::finish(HashDigest out) {
-    md5_finish(&_md5State, out);
+    if (_version == kMD5Version) {
+        md5_finish(&_md5State, out);
+    } else {
+        MurmurHash3_x64_128(_data.buf(), _data.len(), static_cast<uint32_t>(_seed), out);
+    }
 }
 
 long long int BSONElementHasher::hash64(const BSONElement& e, HashSeed seed) {
-    unique_ptr<Hasher> h(HasherFactory::createHasher(seed));
-    recursiveHash(h.get(), e, false);
+    return hash64(e, seed, Hasher::kMD5Version);
+}
+
+long long int BSONElementHasher::hash64(const BSONElement& e, HashSeed seed, int hashVersion) {
+    Hasher h(seed, hashVersion);
+    recursiveHash(&h, e, false);
     HashDigest d;
-    h->finish(d);
+    h.finish(d);
     // HashDigest is actually 16 bytes, but we just read 8 bytes
     ConstDataView digestView(reinterpret_cast<const char*>(d));
     return digestView.read<LittleEndian<long long int>>();
@@ -108,6 +122,8 @@ struct HasherUnitTest : public StartupTest {
         // Hard-coded check to ensure the hash function is consistent across platforms
         BSONObj o = BSON("check" << 42);
         verify(BSONElementHasher::hash64(o.firstElement(), 0) == -944302157085130861LL);
+        verify(BSONElementHasher::hash64(o.firstElement(), 0, Hasher::kMurmur3Version) ==
+               8715208212397937794LL);
     }
 } hasherUnitTest;
 }
@@ -37,6 +37,7 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/bson/bsonelement.h"
+#include "mongo/bson/util/builder.h"
 #include "mongo/util/md5.hpp"
 
 namespace mongo {
@@ -48,7 +49,19 @@ class Hasher {
     MONGO_DISALLOW_COPYING(Hasher);
 
 public:
-    explicit Hasher(HashSeed seed);
+    /* The hash function of each "hashVersion" a hashed index spec may give.
+     *
+     * WARNING: hashed shard keys are always computed with MD5, so it must stay the
+     * default, and only indexes using it can serve as hashed shard key indexes.
+     */
+    static const int kMD5Version = 0;
+    static const int kMurmur3Version = 1;
+
+    static bool isValidVersion(int version) {
+        return version == kMD5Version || version == kMurmur3Version;
+    }
+
+    explicit Hasher(HashSeed seed, int version = kMD5Version);
     ~Hasher(){};
 
     // pointer to next part of input key, length in bytes to read
@@ -59,7 +72,13 @@ public:
     void finish(HashDigest out);
 
 private:
+    const int _version;
     md5_state_t _md5State;
+
+    // MurmurHash3 has no incremental interface, so the data is gathered here and hashed at
+    // once by finish().
+    StackBufBuilder _data;
+
     HashSeed _seed;
 };
 
@@ -70,8 +89,8 @@ public:
     /* Eventually this may be a more sophisticated factory
      * for creating other hashers, but for now use MD5.
      */
-    static Hasher* createHasher(HashSeed seed) {
-        return new Hasher(seed);
+    static Hasher* createHasher(HashSeed seed, int version = Hasher::kMD5Version) {
+        return new Hasher(seed, version);
     }
 
 private:
@@ -105,6 +124,11 @@ public:
      */
     static long long int hash64(const BSONElement& e, HashSeed seed);
 
+    /* Same as above, with the hash function of the given hash version. The value
+     * changes with the version, but squashes elements the same way.
+     */
+    static long long int hash64(const BSONElement& e, HashSeed seed, int hashVersion);
+
     /* This incrementally computes the hash of BSONElement "e"
      * using hash function "h".  If "includeFieldName" is true,
      * then the name of the field is hashed in between the type of
@@ -356,5 +356,45 @@ TEST(BSONElementHasher, HashCodeWScope) {
     ASSERT_EQUALS(hashIt(o), 501342939894575968LL);
 }
 
+long long murmurHashIt(const BSONObj& object, int seed = 0) {
+    return BSONElementHasher::hash64(object.firstElement(), seed, Hasher::kMurmur3Version);
+}
+
+TEST(BSONElementHasher, Murmur3SquashesNumbersLikeMD5) {
+    ASSERT_EQUALS(murmurHashIt(BSON("a" << 3)), murmurHashIt(BSON("a" << 3LL)));
+    ASSERT_EQUALS(murmurHashIt(BSON("a" << 3)), murmurHashIt(BSON("a" << 3.1)));
+    ASSERT_NOT_EQUALS(murmurHashIt(BSON("a" << 3)), murmurHashIt(BSON("a" << 4)));
+    ASSERT_NOT_EQUALS(murmurHashIt(BSON("a" << 3)),
+                      murmurHashIt(BSON("a"
+                                        << "3")));
+    ASSERT_NOT_EQUALS(murmurHashIt(fromjson("{x : {a : {}, b : 1}}")),
+                      murmurHashIt(fromjson("{x : {a : {b : 1}}}")));
+}
+
+TEST(BSONElementHasher, Murmur3SeedMatters) {
+    ASSERT_NOT_EQUALS(murmurHashIt(BSON("a" << 4), 0), murmurHashIt(BSON("a" << 4), 1));
+}
+
+TEST(BSONElementHasher, Murmur3DiffersFromMD5) {
+    BSONObj o = BSON("check" << 42);
+    ASSERT_NOT_EQUALS(murmurHashIt(o), hashIt(o));
+    ASSERT_EQUALS(hashIt(o),
+                  BSONElementHasher::hash64(o.firstElement(), 0, Hasher::kMD5Version));
+}
+
+TEST(BSONElementHasher, Murmur3HashIsStable) {
+    // Hard-coded values, so an accidental change to the hash function is caught.
+    ASSERT_EQUALS(murmurHashIt(BSON("check" << 42)), 8715208212397937794LL);
+    ASSERT_EQUALS(murmurHashIt(BSON("check" << std::string(1000, 'x'))), 5747475395581655829LL);
+}
+
+TEST(BSONElementHasher, Murmur3HashesLongValues) {
+    // Longer than fits on the stack of the hasher.
+    const std::string a(1000, 'a');
+    std::string b = a;
+    b[999] = 'b';
+    ASSERT_NOT_EQUALS(murmurHashIt(BSON("check" << a)), murmurHashIt(BSON("check" << b)));
+}
+
 }  // namespace
 }  // namespace mongo
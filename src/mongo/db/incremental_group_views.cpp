@@ -0,0 +1,433 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/incremental_group_views.h"
+
+#include <algorithm>
+#include <deque>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbhelpers.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/ops/delete.h"
+#include "mongo/db/ops/insert.h"
+#include "mongo/db/pipeline/incremental_group.h"
+#include "mongo/db/query/internal_plans.h"
+#include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/service_context.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+using std::shared_ptr;
+using std::vector;
+
+namespace {
+
+const auto getIncrementalGroupViews = ServiceContext::declareDecoration<IncrementalGroupViews>();
+
+// How many source documents a rebuild groups at a time before merging them into the results.
+const size_t kRebuildBatchSize = 1000;
+
+BSONObj idQuery(const Document& partial) {
+    BSONObjBuilder builder;
+    partial["_id"].addToBsonObj(&builder, "_id");
+    return builder.obj();
+}
+
+}  // namespace
+
+struct IncrementalGroupViews::View {
+    View(const NamespaceString& source,
+         const NamespaceString& target,
+         std::unique_ptr<IncrementalGroup> group)
+        : source(source), target(target), group(std::move(group)) {}
+
+    const NamespaceString source;
+    const NamespaceString target;
+    const std::unique_ptr<IncrementalGroup> group;
+
+    // Nonzero when the stored partial results may not reflect the source, so that the next read
+    // has to rebuild them.
+    AtomicUInt32 stale;
+};
+
+// static
+IncrementalGroupViews& IncrementalGroupViews::get(ServiceContext* service) {
+    return getIncrementalGroupViews(service);
+}
+
+Status IncrementalGroupViews::create(OperationContext* txn,
+                                     const NamespaceString& source,
+                                     const NamespaceString& target,
+                                     std::unique_ptr<IncrementalGroup> group) {
+    if (!source.isNormal() || !target.isNormal()) {
+        return Status(ErrorCodes::InvalidNamespace,
+                      "incremental groups can only use normal collections");
+    }
+    if (source.db() != target.db()) {
+        return Status(ErrorCodes::BadValue,
+                      "an incremental group must be in the same database as its source");
+    }
+    if (source == target) {
+        return Status(ErrorCodes::BadValue, "an incremental group cannot replace its source");
+    }
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        for (auto&& view : _views) {
+            if (view->target == source || (view->source == target && view->target != target)) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << source.ns() << " and " << target.ns()
+                                            << " would chain incremental groups through "
+                                            << view->target.ns());
+            }
+        }
+    }
+
+    ScopedTransaction transaction(txn, MODE_IX);
+    AutoGetOrCreateDb autoDb(txn, target.db(), MODE_X);
+    if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(target)) {
+        return Status(ErrorCodes::NotMaster,
+                      str::stream() << "Not primary while creating incremental group "
+                                    << target.ns());
+    }
+
+    Database* db = autoDb.getDb();
+    if (!db->getCollection(target)) {
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+            WriteUnitOfWork wunit(txn);
+            invariant(db->createCollection(txn, target.ns()));
+            wunit.commit();
+        }
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "createIncrementalGroup", target.ns());
+    }
+
+    auto view = std::make_shared<View>(source, target, std::move(group));
+    Status status = _rebuild(txn, db, view.get());
+    if (!status.isOK()) {
+        return status;
+    }
+
+    // We still hold the database exclusively, so no write can come between the rebuild and the
+    // view being registered.
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = std::find_if(_views.begin(), _views.end(), [&](const shared_ptr<View>& existing) {
+        return existing->target == target;
+    });
+    if (it != _views.end()) {
+        *it = view;
+    } else {
+        _views.push_back(view);
+        _numViews.fetchAndAdd(1);
+    }
+    return Status::OK();
+}
+
+Status IncrementalGroupViews::drop(const NamespaceString& target) {
+    if (!_find(target)) {
+        return Status(ErrorCodes::NamespaceNotFound,
+                      str::stream() << "no incremental group maintains " << target.ns());
+    }
+    _remove([&](const View& view) { return view.target == target; });
+    return Status::OK();
+}
+
+StatusWith<vector<Document>> IncrementalGroupViews::read(OperationContext* txn,
+                                                         const NamespaceString& target) {
+    shared_ptr<View> view = _find(target);
+    if (!view) {
+        return Status(ErrorCodes::NamespaceNotFound,
+                      str::stream() << "no incremental group maintains " << target.ns());
+    }
+
+    if (view->stale.load()) {
+        ScopedTransaction transaction(txn, MODE_IX);
+        AutoGetDb autoDb(txn, target.db(), MODE_X);
+        if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(target)) {
+            return Status(ErrorCodes::NotMaster,
+                          str::stream() << "incremental group " << target.ns()
+                                        << " is stale and can only be rebuilt on the primary");
+        }
+
+        if (view->stale.load()) {
+            if (!autoDb.getDb()) {
+                return Status(ErrorCodes::NamespaceNotFound,
+                              str::stream() << "database " << target.db() << " not found");
+            }
+            Status status = _rebuild(txn, autoDb.getDb(), view.get());
+            if (!status.isOK()) {
+                return status;
+            }
+        }
+    }
+
+    AutoGetCollectionForRead ctx(txn, target);
+    Collection* collection = ctx.getCollection();
+    if (!collection) {
+        return Status(ErrorCodes::NamespaceNotFound,
+                      str::stream() << "collection " << target.ns() << " not found");
+    }
+
+    std::deque<Document> partials;
+    auto exec = InternalPlanner::collectionScan(
+        txn, target.ns(), collection, PlanExecutor::YIELD_AUTO);
+    BSONObj obj;
+    PlanExecutor::ExecState state;
+    while ((state = exec->getNext(&obj, NULL)) == PlanExecutor::ADVANCED) {
+        partials.push_back(Document(obj));
+    }
+    if (state != PlanExecutor::IS_EOF) {
+        return Status(ErrorCodes::OperationFailed,
+                      str::stream() << "failed reading incremental group " << target.ns());
+    }
+
+    return view->group->finalize(txn, std::move(partials));
+}
+
+void IncrementalGroupViews::onInsert(OperationContext* txn,
+                                     const NamespaceString& ns,
+                                     const BSONObj& doc) {
+    if (!_numViews.load()) {
+        return;
+    }
+
+    for (auto&& view : _viewsOn(ns)) {
+        if (view->stale.load()) {
+            continue;
+        }
+
+        // Writes applied from the oplog go to the target the same way, so only the primary may
+        // apply them to the view itself.
+        if (!txn->writesAreReplicated()) {
+            view->stale.store(1);
+            continue;
+        }
+
+        _apply(txn, view.get(), doc);
+    }
+}
+
+void IncrementalGroupViews::onUpdateOrDelete(const NamespaceString& ns) {
+    if (!_numViews.load()) {
+        return;
+    }
+
+    for (auto&& view : _viewsOn(ns)) {
+        view->stale.store(1);
+    }
+}
+
+void IncrementalGroupViews::onDropCollection(const NamespaceString& ns) {
+    if (!_numViews.load()) {
+        return;
+    }
+
+    _remove([&](const View& view) { return view.source == ns || view.target == ns; });
+}
+
+void IncrementalGroupViews::onDropDatabase(StringData dbName) {
+    if (!_numViews.load()) {
+        return;
+    }
+
+    _remove([&](const View& view) { return view.target.db() == dbName; });
+}
+
+shared_ptr<IncrementalGroupViews::View> IncrementalGroupViews::_find(
+    const NamespaceString& target) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    for (auto&& view : _views) {
+        if (view->target == target) {
+            return view;
+        }
+    }
+    return nullptr;
+}
+
+vector<shared_ptr<IncrementalGroupViews::View>> IncrementalGroupViews::_viewsOn(
+    const NamespaceString& source) const {
+    vector<shared_ptr<View>> views;
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    for (auto&& view : _views) {
+        if (view->source == source) {
+            views.push_back(view);
+        }
+    }
+    return views;
+}
+
+template <typename Pred>
+void IncrementalGroupViews::_remove(Pred pred) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto newEnd = std::remove_if(
+        _views.begin(), _views.end(), [&](const shared_ptr<View>& view) { return pred(*view); });
+    _numViews.fetchAndSubtract(static_cast<unsigned>(_views.end() - newEnd));
+    _views.erase(newEnd, _views.end());
+}
+
+// static
+Status IncrementalGroupViews::_rebuild(OperationContext* txn, Database* db, View* view) {
+    invariant(txn->lockState()->isDbLockedForMode(view->target.db(), MODE_X));
+
+    // Anything written from here on is part of the rebuild.
+    view->stale.store(0);
+
+    std::deque<Document> partials;
+    if (Collection* source = db->getCollection(view->source)) {
+        auto exec = InternalPlanner::collectionScan(
+            txn, view->source.ns(), source, PlanExecutor::YIELD_MANUAL);
+
+        std::deque<Document> batch;
+        BSONObj obj;
+        PlanExecutor::ExecState state;
+        while ((state = exec->getNext(&obj, NULL)) == PlanExecutor::ADVANCED) {
+            batch.push_back(Document(obj));
+            if (batch.size() == kRebuildBatchSize) {
+                for (auto&& partial : view->group->group(txn, std::move(batch))) {
+                    partials.push_back(std::move(partial));
+                }
+                vector<Document> merged = view->group->merge(txn, std::move(partials));
+                partials.assign(merged.begin(), merged.end());
+                batch.clear();
+            }
+        }
+        if (state != PlanExecutor::IS_EOF) {
+            view->stale.store(1);
+            return Status(ErrorCodes::OperationFailed,
+                          str::stream() << "failed reading " << view->source.ns()
+                                        << " to rebuild incremental group "
+                                        << view->target.ns());
+        }
+
+        for (auto&& partial : view->group->group(txn, std::move(batch))) {
+            partials.push_back(std::move(partial));
+        }
+    }
+    vector<Document> results = view->group->merge(txn, std::move(partials));
+
+    // Remove the old results the way a user's remove would, so that secondaries follow along.
+    deleteObjects(txn, db, view->target.ns(), BSONObj(), PlanExecutor::YIELD_MANUAL, false);
+
+    for (auto&& result : results) {
+        BSONObj obj = result.toBson();
+        StatusWith<BSONObj> fixed = fixDocumentForInsert(obj);
+        if (!fixed.isOK()) {
+            view->stale.store(1);
+            return fixed.getStatus();
+        }
+
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+            Collection* collection = db->getCollection(view->target);
+            if (!collection) {
+                view->stale.store(1);
+                return Status(ErrorCodes::NamespaceNotFound,
+                              str::stream() << "collection " << view->target.ns()
+                                            << " not found");
+            }
+
+            WriteUnitOfWork wunit(txn);
+            Status status = collection->insertDocument(txn, obj, false);
+            if (!status.isOK()) {
+                view->stale.store(1);
+                return status;
+            }
+            wunit.commit();
+        }
+        MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "incremental group rebuild", view->target.ns());
+    }
+    return Status::OK();
+}
+
+// static
+void IncrementalGroupViews::_apply(OperationContext* txn, View* view, const BSONObj& doc) {
+    vector<Document> partials = view->group->group(txn, {Document(doc)});
+    if (partials.empty()) {
+        return;
+    }
+
+    // The writer holds the database in at least intent mode already.
+    Lock::CollectionLock targetLock(txn->lockState(), view->target.ns(), MODE_IX);
+    Database* db = dbHolder().get(txn, view->target.db());
+    Collection* collection = db ? db->getCollection(view->target) : nullptr;
+    if (!collection) {
+        view->stale.store(1);
+        return;
+    }
+
+    for (auto&& partial : partials) {
+        const BSONObj query = idQuery(partial);
+        const RecordId loc = Helpers::findById(txn, collection, query);
+
+        std::deque<Document> toMerge{partial};
+        Snapshotted<BSONObj> oldDoc;
+        if (!loc.isNull()) {
+            oldDoc = collection->docFor(txn, loc);
+            toMerge.push_front(Document(oldDoc.value()));
+        }
+
+        vector<Document> merged = view->group->merge(txn, std::move(toMerge));
+        invariant(merged.size() == 1);
+        const BSONObj newDoc = merged.front().toBson();
+
+        // A failed write would fail the write to the source too, so leave the view to a rebuild
+        // to report the problem instead.
+        if (!fixDocumentForInsert(newDoc).isOK()) {
+            LOG(1) << "marking incremental group " << view->target.ns()
+                   << " stale, its results for " << query << " cannot be stored";
+            view->stale.store(1);
+            return;
+        }
+
+        if (loc.isNull()) {
+            uassertStatusOK(collection->insertDocument(txn, newDoc, false));
+        } else {
+            OpDebug debug;
+            oplogUpdateEntryArgs args;
+            args.update = newDoc;
+            args.criteria = query;
+            args.fromMigrate = false;
+            uassertStatusOK(
+                collection->updateDocument(txn, loc, oldDoc, newDoc, false, true, &debug, args)
+                    .getStatus());
+        }
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,129 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status_with.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+class Database;
+class IncrementalGroup;
+class OperationContext;
+class ServiceContext;
+
+/**
+ * The incremental groups on this server. Each one keeps the partial results of an
+ * IncrementalGroup over a source collection in a target collection of the same database, and
+ * merges the partial results for each document inserted into the source into the stored ones as
+ * part of the insert. Reading a view only has to finalize the stored partial results.
+ *
+ * Without the old contents of updated and deleted documents there is nothing to take back out of
+ * the stored partial results, so an update or delete on the source marks the view stale instead,
+ * and the next read rebuilds it from the source. So does any other change that could not be
+ * applied, such as a secondary applying the source's writes from the oplog.
+ *
+ * Views only live in memory, so they have to be created again after a restart or on a new
+ * primary. Until they are, their target collections are left as they are.
+ */
+class IncrementalGroupViews {
+    MONGO_DISALLOW_COPYING(IncrementalGroupViews);
+
+public:
+    static IncrementalGroupViews& get(ServiceContext* service);
+
+    IncrementalGroupViews() = default;
+
+    /**
+     * Builds 'target' from the current contents of 'source' and keeps it current from then on,
+     * replacing any view which already maintained 'target'.
+     */
+    Status create(OperationContext* txn,
+                  const NamespaceString& source,
+                  const NamespaceString& target,
+                  std::unique_ptr<IncrementalGroup> group);
+
+    /**
+     * Stops maintaining 'target'. Leaves the collection itself alone.
+     */
+    Status drop(const NamespaceString& target);
+
+    /**
+     * Returns the results of the view maintained in 'target', rebuilding it first if it is stale.
+     */
+    StatusWith<std::vector<Document>> read(OperationContext* txn, const NamespaceString& target);
+
+    //
+    // Called by the OpObserver, with 'ns' locked for writing.
+    //
+
+    void onInsert(OperationContext* txn, const NamespaceString& ns, const BSONObj& doc);
+    void onUpdateOrDelete(const NamespaceString& ns);
+    void onDropCollection(const NamespaceString& ns);
+    void onDropDatabase(StringData dbName);
+
+private:
+    struct View;
+
+    std::shared_ptr<View> _find(const NamespaceString& target) const;
+    std::vector<std::shared_ptr<View>> _viewsOn(const NamespaceString& source) const;
+
+    /**
+     * Removes the views for which 'pred' returns true.
+     */
+    template <typename Pred>
+    void _remove(Pred pred);
+
+    /**
+     * Replaces the contents of the view's target with its partial results over all of its
+     * source. The caller must hold the database exclusively.
+     */
+    static Status _rebuild(OperationContext* txn, Database* db, View* view);
+
+    /**
+     * Merges the partial results for 'doc' into those stored for the view.
+     */
+    static void _apply(OperationContext* txn, View* view, const BSONObj& doc);
+
+    // Lets writes skip '_mutex' while there are no views, which is almost always.
+    AtomicUInt32 _numViews;
+
+    mutable stdx::mutex _mutex;
+    std::vector<std::shared_ptr<View>> _views;
+};
+
+}  // namespace mongo
@@ -65,4 +65,10 @@ void BtreeAccessMethod::getKeys(const BSONObj& obj, BSONObjSet* keys) const {
     _keyGenerator->getKeys(obj, keys);
 }
 
+void BtreeAccessMethod::getKeysUsingOffsets(const BSONObj& obj,
+                                            const BSONFieldOffsets& offsets,
+                                            BSONObjSet* keys) const {
+    _keyGenerator->getKeys(obj, keys, &offsets);
+}
+
 }  // namespace mongo
@@ -50,6 +50,10 @@ public:
 private:
     virtual void getKeys(const BSONObj& obj, BSONObjSet* keys) const;
 
+    virtual void getKeysUsingOffsets(const BSONObj& obj,
+                                     const BSONFieldOffsets& offsets,
+                                     BSONObjSet* keys) const;
+
     // Our keys differ for V0 and V1.
     std::unique_ptr<BtreeKeyGenerator> _keyGenerator;
 };
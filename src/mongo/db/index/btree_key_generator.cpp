@@ -26,6 +26,9 @@
 *    it in the license file.
 */
 
+#include <algorithm>
+
+#include "mongo/bson/bson_field_offsets.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/index/btree_key_generator.h"
 #include "mongo/util/mongoutils/str.h"
@@ -58,10 +61,13 @@ BtreeKeyGenerator::BtreeKeyGenerator(std::vector<const char*> fieldNames,
     _isIdIndex = fieldNames.size() == 1 && std::string("_id") == fieldNames[0];
 }
 
-void BtreeKeyGenerator::getKeys(const BSONObj& obj, BSONObjSet* keys) const {
+void BtreeKeyGenerator::getKeys(const BSONObj& obj,
+                                BSONObjSet* keys,
+                                const BSONFieldOffsets* offsets) const {
+    dassert(!offsets || offsets->obj().objdata() == obj.objdata());
     if (_isIdIndex) {
         // we special case for speed
-        BSONElement e = obj["_id"];
+        BSONElement e = offsets ? offsets->getField("_id") : obj["_id"];
         if (e.eoo()) {
             keys->insert(_nullKey);
         } else {
@@ -76,7 +82,7 @@ void BtreeKeyGenerator::getKeys(const BSONObj& obj, BSONObjSet* keys) const {
 
     // '_fieldNames' and '_fixed' are passed by value so that they can be mutated as part of the
     // getKeys call.  :|
-    getKeysImpl(_fieldNames, _fixed, obj, keys);
+    getKeysImpl(_fieldNames, _fixed, obj, keys, offsets);
     if (keys->empty() && !_isSparse) {
         keys->insert(_nullKey);
     }
@@ -96,7 +102,8 @@ BtreeKeyGeneratorV0::BtreeKeyGeneratorV0(std::vector<const char*> fieldNames,
 void BtreeKeyGeneratorV0::getKeysImpl(std::vector<const char*> fieldNames,
                                       std::vector<BSONElement> fixed,
                                       const BSONObj& obj,
-                                      BSONObjSet* keys) const {
+                                      BSONObjSet* keys,
+                                      const BSONFieldOffsets* offsets) const {
     BSONElement arrElt;
     unsigned arrIdx = ~0;
     unsigned numNotFound = 0;
@@ -105,7 +112,8 @@ void BtreeKeyGeneratorV0::getKeysImpl(std::vector<const char*> fieldNames,
         if (*fieldNames[i] == '\0')
             continue;
 
-        BSONElement e = obj.getFieldDottedOrArray(fieldNames[i]);
+        BSONElement e = offsets ? offsets->getFieldDottedOrArray(fieldNames[i])
+                                : obj.getFieldDottedOrArray(fieldNames[i]);
 
         if (e.eoo()) {
             e = nullElt;  // no matching field
@@ -181,7 +189,7 @@ void BtreeKeyGeneratorV0::getKeysImpl(std::vector<const char*> fieldNames,
             while (i.more()) {
                 BSONElement e = i.next();
                 if (e.type() == Object) {
-                    getKeysImpl(fieldNames, fixed, e.embeddedObject(), keys);
+                    getKeysImpl(fieldNames, fixed, e.embeddedObject(), keys, NULL);
                 }
             }
         } else {
@@ -215,9 +223,12 @@ BtreeKeyGeneratorV1::BtreeKeyGeneratorV1(std::vector<const char*> fieldNames,
 BSONElement BtreeKeyGeneratorV1::extractNextElement(const BSONObj& obj,
                                                     const PositionalPathInfo& positionalInfo,
                                                     const char** field,
-                                                    bool* arrayNestedArray) const {
-    std::string firstField = mongoutils::str::before(*field, '.');
-    bool haveObjField = !obj.getField(firstField).eoo();
+                                                    bool* arrayNestedArray,
+                                                    const BSONFieldOffsets* offsets) const {
+    StringData firstField(*field);
+    firstField = firstField.substr(0, firstField.find('.'));
+    bool haveObjField =
+        !(offsets ? offsets->getField(firstField) : obj.getField(firstField)).eoo();
     BSONElement arrField = positionalInfo.positionallyIndexedElt;
 
     // An index component field name cannot exist in both a document
@@ -231,7 +242,7 @@ BSONElement BtreeKeyGeneratorV1::extractNextElement(const BSONObj& obj,
 
     *arrayNestedArray = false;
     if (haveObjField) {
-        return obj.getFieldDottedOrArray(*field);
+        return offsets ? offsets->getFieldDottedOrArray(*field) : obj.getFieldDottedOrArray(*field);
     } else if (positionalInfo.hasPositionallyIndexedElt()) {
         if (arrField.type() == Array) {
             *arrayNestedArray = true;
@@ -249,11 +260,11 @@ void BtreeKeyGeneratorV1::_getKeysArrEltFixed(
     BSONObjSet* keys,
     unsigned numNotFound,
     const BSONElement& arrObjElt,
-    const std::set<unsigned>& arrIdxs,
+    const std::vector<unsigned>& arrIdxs,
     bool mayExpandArrayUnembedded,
     const std::vector<PositionalPathInfo>& positionalInfo) const {
     // Set up any terminal array values.
-    for (std::set<unsigned>::const_iterator j = arrIdxs.begin(); j != arrIdxs.end(); ++j) {
+    for (std::vector<unsigned>::const_iterator j = arrIdxs.begin(); j != arrIdxs.end(); ++j) {
         unsigned idx = *j;
         if (*(*fieldNames)[idx] == '\0') {
             (*fixed)[idx] = mayExpandArrayUnembedded ? arrEntry : arrObjElt;
@@ -269,11 +280,21 @@ void BtreeKeyGeneratorV1::_getKeysArrEltFixed(
                          positionalInfo);
 }
 
+void BtreeKeyGeneratorV1::appendKey(const std::vector<BSONElement>& fixed,
+                                    BSONObjSet* keys) const {
+    BSONObjBuilder b(_sizeTracker);
+    for (std::vector<BSONElement>::const_iterator i = fixed.begin(); i != fixed.end(); ++i) {
+        b.appendAs(*i, "");
+    }
+    keys->insert(b.obj());
+}
+
 void BtreeKeyGeneratorV1::getKeysImpl(std::vector<const char*> fieldNames,
                                       std::vector<BSONElement> fixed,
                                       const BSONObj& obj,
-                                      BSONObjSet* keys) const {
-    getKeysImplWithArray(fieldNames, fixed, obj, keys, 0, _emptyPositionalInfo);
+                                      BSONObjSet* keys,
+                                      const BSONFieldOffsets* offsets) const {
+    getKeysImplWithArray(fieldNames, fixed, obj, keys, 0, _emptyPositionalInfo, offsets);
 }
 
 void BtreeKeyGeneratorV1::getKeysImplWithArray(
@@ -282,9 +303,10 @@ void BtreeKeyGeneratorV1::getKeysImplWithArray(
     const BSONObj& obj,
     BSONObjSet* keys,
     unsigned numNotFound,
-    const std::vector<PositionalPathInfo>& positionalInfo) const {
+    const std::vector<PositionalPathInfo>& positionalInfo,
+    const BSONFieldOffsets* offsets) const {
     BSONElement arrElt;
-    std::set<unsigned> arrIdxs;
+    std::vector<unsigned> arrIdxs;
     bool mayExpandArrayUnembedded = true;
     for (unsigned i = 0; i < fieldNames.size(); ++i) {
         if (*fieldNames[i] == '\0') {
@@ -294,7 +316,7 @@ void BtreeKeyGeneratorV1::getKeysImplWithArray(
         bool arrayNestedArray;
         // Extract element matching fieldName[ i ] from object xor array.
         BSONElement e =
-            extractNextElement(obj, positionalInfo[i], &fieldNames[i], &arrayNestedArray);
+            extractNextElement(obj, positionalInfo[i], &fieldNames[i], &arrayNestedArray, offsets);
 
         if (e.eoo()) {
             // if field not present, set to null
@@ -303,7 +325,7 @@ void BtreeKeyGeneratorV1::getKeysImplWithArray(
             fieldNames[i] = "";
             numNotFound++;
         } else if (e.type() == Array) {
-            arrIdxs.insert(i);
+            arrIdxs.push_back(i);
             if (arrElt.eoo()) {
                 // we only expand arrays on a single path -- track the path here
                 arrElt = e;
@@ -325,11 +347,7 @@ void BtreeKeyGeneratorV1::getKeysImplWithArray(
         if (_isSparse && numNotFound == fieldNames.size()) {
             return;
         }
-        BSONObjBuilder b(_sizeTracker);
-        for (std::vector<BSONElement>::iterator i = fixed.begin(); i != fixed.end(); ++i) {
-            b.appendAs(*i, "");
-        }
-        keys->insert(b.obj());
+        appendKey(fixed, keys);
     } else if (arrElt.embeddedObject().firstElement().eoo()) {
         // Empty array, so set matching fields to undefined.
         _getKeysArrEltFixed(&fieldNames,
@@ -341,6 +359,32 @@ void BtreeKeyGeneratorV1::getKeysImplWithArray(
                             arrIdxs,
                             true,
                             _emptyPositionalInfo);
+    } else if (std::all_of(fieldNames.begin(),
+                           fieldNames.end(),
+                           [](const char* fieldName) { return *fieldName == '\0'; })) {
+        // Every path ends at the indexed array, so there is nothing left to extract from its
+        // elements. Generate their keys here rather than recursing once per element.
+        if (_isSparse && numNotFound == fieldNames.size()) {
+            return;
+        }
+
+        if (!mayExpandArrayUnembedded) {
+            // The array itself is the key value, whatever its elements.
+            for (unsigned idx : arrIdxs) {
+                fixed[idx] = arrElt;
+            }
+            appendKey(fixed, keys);
+            return;
+        }
+
+        BSONObjIterator i(arrElt.embeddedObject());
+        while (i.more()) {
+            const BSONElement arrEntry = i.next();
+            for (unsigned idx : arrIdxs) {
+                fixed[idx] = arrEntry;
+            }
+            appendKey(fixed, keys);
+        }
     } else {
         BSONObj arrObj = arrElt.embeddedObject();
 
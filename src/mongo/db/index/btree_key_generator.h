@@ -34,6 +34,8 @@
 
 namespace mongo {
 
+class BSONFieldOffsets;
+
 /**
  * Internal class used by BtreeAccessMethod to generate keys for indexed documents.
  * This class is meant to be kept under the index access layer.
@@ -46,7 +48,13 @@ public:
 
     virtual ~BtreeKeyGenerator() {}
 
-    void getKeys(const BSONObj& obj, BSONObjSet* keys) const;
+    /**
+     * If 'offsets' is not NULL, it must be built over 'obj', and the top-level fields of 'obj'
+     * are looked up in it instead of by scanning 'obj'.
+     */
+    void getKeys(const BSONObj& obj,
+                 BSONObjSet* keys,
+                 const BSONFieldOffsets* offsets = NULL) const;
 
     static const int ParallelArraysCode;
 
@@ -63,7 +71,8 @@ private:
     virtual void getKeysImpl(std::vector<const char*> fieldNames,
                              std::vector<BSONElement> fixed,
                              const BSONObj& obj,
-                             BSONObjSet* keys) const = 0;
+                             BSONObjSet* keys,
+                             const BSONFieldOffsets* offsets) const = 0;
 
     std::vector<BSONElement> _fixed;
 };
@@ -80,7 +89,8 @@ private:
     virtual void getKeysImpl(std::vector<const char*> fieldNames,
                              std::vector<BSONElement> fixed,
                              const BSONObj& obj,
-                             BSONObjSet* keys) const;
+                             BSONObjSet* keys,
+                             const BSONFieldOffsets* offsets) const;
 };
 
 class BtreeKeyGeneratorV1 : public BtreeKeyGenerator {
@@ -154,11 +164,13 @@ private:
      * @param numNotFound - number of index fields that have already been identified as missing
      * @param array - array from which keys should be extracted, based on names in fieldNames
      *        If obj and array are both nonempty, obj will be one of the elements of array.
+     * @param offsets - if not NULL, the top-level fields of obj
      */
     virtual void getKeysImpl(std::vector<const char*> fieldNames,
                              std::vector<BSONElement> fixed,
                              const BSONObj& obj,
-                             BSONObjSet* keys) const;
+                             BSONObjSet* keys,
+                             const BSONFieldOffsets* offsets) const;
 
     /**
      * This recursive method does the heavy-lifting for getKeysImpl().
@@ -168,13 +180,15 @@ private:
                               const BSONObj& obj,
                               BSONObjSet* keys,
                               unsigned numNotFound,
-                              const std::vector<PositionalPathInfo>& positionalInfo) const;
+                              const std::vector<PositionalPathInfo>& positionalInfo,
+                              const BSONFieldOffsets* offsets = NULL) const;
     /**
      * A call to getKeysImplWithArray() begins by calling this for each field in the key
      * pattern. It uses getFieldDottedOrArray() to traverse the path '*field' in 'obj'.
      *
      * The 'positionalInfo' arg is used for handling a field path where 'obj' has an
      * array indexed by position. See the comments for PositionalPathInfo for more detail.
+     * If 'offsets' is not NULL, it holds the top-level fields of 'obj'.
      *
      * Returns the element extracted as a result of traversing the path, or an indexed array
      * if we encounter one during the path traversal.
@@ -204,7 +218,8 @@ private:
     BSONElement extractNextElement(const BSONObj& obj,
                                    const PositionalPathInfo& positionalInfo,
                                    const char** field,
-                                   bool* arrayNestedArray) const;
+                                   bool* arrayNestedArray,
+                                   const BSONFieldOffsets* offsets) const;
 
     /**
      * Sets extracted elements in 'fixed' for field paths that we have traversed to the end.
@@ -217,10 +232,15 @@ private:
                              BSONObjSet* keys,
                              unsigned numNotFound,
                              const BSONElement& arrObjElt,
-                             const std::set<unsigned>& arrIdxs,
+                             const std::vector<unsigned>& arrIdxs,
                              bool mayExpandArrayUnembedded,
                              const std::vector<PositionalPathInfo>& positionalInfo) const;
 
+    /**
+     * Inserts the key made of the values in 'fixed' into 'keys'.
+     */
+    void appendKey(const std::vector<BSONElement>& fixed, BSONObjSet* keys) const;
+
     const std::vector<PositionalPathInfo> _emptyPositionalInfo;
 };
 
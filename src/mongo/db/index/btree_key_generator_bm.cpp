@@ -0,0 +1,81 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/db/index/btree_key_generator.h"
+#include "mongo/db/json.h"
+#include "mongo/unittest/benchmark.h"
+
+namespace {
+
+using namespace mongo;
+using unittest::BenchmarkState;
+using unittest::doNotOptimizeAway;
+
+void runGetKeys(BenchmarkState& state, const char* keyPattern, const char* document) {
+    const BSONObj pattern = fromjson(keyPattern);
+    std::vector<const char*> fieldNames;
+    std::vector<BSONElement> fixed;
+    for (BSONObjIterator it(pattern); it.more();) {
+        fieldNames.push_back(it.next().fieldName());
+        fixed.push_back(BSONElement());
+    }
+    const BtreeKeyGeneratorV1 keyGen(fieldNames, fixed, false);
+    const BSONObj obj = fromjson(document);
+
+    while (state.keepRunning()) {
+        BSONObjSet keys;
+        keyGen.getKeys(obj, &keys);
+        doNotOptimizeAway(keys);
+    }
+}
+
+MONGO_BENCHMARK(BtreeKeyGeneratorSingleField) {
+    runGetKeys(state, "{a: 1}", "{_id: 1, a: 5, b: 'string', c: 2.5}");
+}
+
+MONGO_BENCHMARK(BtreeKeyGeneratorCompound) {
+    runGetKeys(state, "{a: 1, b: -1, c: 1}", "{_id: 1, a: 5, b: 'string', c: 2.5}");
+}
+
+MONGO_BENCHMARK(BtreeKeyGeneratorDotted) {
+    runGetKeys(state, "{'a.b.c': 1}", "{_id: 1, a: {b: {c: 5, d: 6}, e: 7}}");
+}
+
+MONGO_BENCHMARK(BtreeKeyGeneratorMultikey) {
+    runGetKeys(state, "{a: 1, b: 1}", "{_id: 1, a: [1, 2, 3, 4, 5, 6, 7, 8, 9, 10], b: 'x'}");
+}
+
+MONGO_BENCHMARK(BtreeKeyGeneratorMultikeyDotted) {
+    runGetKeys(state, "{'a.b': 1}", "{_id: 1, a: [{b: 1}, {b: 2}, {b: 3}, {b: [4, 5, 6]}]}");
+}
+
+}  // namespace
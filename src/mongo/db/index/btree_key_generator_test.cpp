@@ -30,6 +30,7 @@
 
 #include <iostream>
 
+#include "mongo/bson/bson_field_offsets.h"
 #include "mongo/db/json.h"
 #include "mongo/unittest/unittest.h"
 
@@ -103,6 +104,20 @@ bool testKeygen(const BSONObj& kp,
     if (!match) {
         cout << "Expected: " << dumpKeyset(expectedKeys) << ", "
              << "Actual: " << dumpKeyset(actualKeys) << endl;
+        return false;
+    }
+
+    //
+    // Step 4: check that looking up the top-level fields of 'obj' in a BSONFieldOffsets
+    // generates the same keys.
+    //
+    BSONFieldOffsets offsets(obj);
+    BSONObjSet keysWithOffsets;
+    keyGen->getKeys(obj, &keysWithOffsets, &offsets);
+    match = keysetsMatch(expectedKeys, keysWithOffsets);
+    if (!match) {
+        cout << "Expected: " << dumpKeyset(expectedKeys) << ", "
+             << "Actual with offsets: " << dumpKeyset(keysWithOffsets) << endl;
     }
 
     return match;
@@ -195,6 +210,33 @@ TEST(BtreeKeyGeneratorTest, GetKeysArraySubobjectCompoundIndex) {
     ASSERT(testKeygen(keyPattern, genKeysFrom, expectedKeys));
 }
 
+TEST(BtreeKeyGeneratorTest, GetKeysCompoundIndexLargeArrayWithDuplicates) {
+    BSONObj keyPattern = fromjson("{a: 1, b: 1, 'c.d': 1}");
+    BSONObjBuilder bob;
+    BSONArrayBuilder arr(bob.subarrayStart("a"));
+    for (int i = 0; i < 1000; i++) {
+        arr.append(i % 500);
+    }
+    arr.done();
+    bob.append("b", 7);
+    BSONObj genKeysFrom = bob.obj();
+
+    BSONObjSet expectedKeys;
+    for (int i = 0; i < 500; i++) {
+        expectedKeys.insert(BSON("" << i << "" << 7 << "" << BSONNULL));
+    }
+    ASSERT(testKeygen(keyPattern, genKeysFrom, expectedKeys));
+}
+
+TEST(BtreeKeyGeneratorTest, GetKeysCompoundIndexSameArrayTwice) {
+    BSONObj keyPattern = fromjson("{'a.b': 1, c: 1, 'a.b': -1}");
+    BSONObj genKeysFrom = fromjson("{a: {b: [1, 2, 1]}, c: 'x'}");
+    BSONObjSet expectedKeys;
+    expectedKeys.insert(fromjson("{'': 1, '': 'x', '': 1}"));
+    expectedKeys.insert(fromjson("{'': 2, '': 'x', '': 2}"));
+    ASSERT(testKeygen(keyPattern, genKeysFrom, expectedKeys));
+}
+
 TEST(BtreeKeyGeneratorTest, GetKeysArraySubobjectSingleMissing) {
     BSONObj keyPattern = fromjson("{'a.b': 1}");
     BSONObj genKeysFrom = fromjson("{a: [{foo: 41}, {b:1,c:4}, {b:2,c:4}, {b:3,c:4}]}");
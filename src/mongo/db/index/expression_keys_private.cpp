@@ -83,9 +83,6 @@ Status S2GetKeysForElement(const BSONElement& element,
     if (!status.isOK())
         return status;
 
-    S2RegionCoverer coverer;
-    params.configureCoverer(geoContainer, &coverer);
-
     // Don't index big polygon
     if (geoContainer.getNativeCRS() == STRICT_SPHERE) {
         return Status(ErrorCodes::BadValue, "can't index geometry with strict winding order");
@@ -108,7 +105,7 @@ Status S2GetKeysForElement(const BSONElement& element,
 
     invariant(geoContainer.hasS2Region());
 
-    coverer.GetCovering(geoContainer.getS2Region(), out);
+    params.getCovering(geoContainer, out);
     return Status::OK();
 }
 
@@ -339,8 +336,8 @@ void ExpressionKeysPrivate::getHashKeys(const BSONObj& obj,
 
 // static
 long long int ExpressionKeysPrivate::makeSingleHashKey(const BSONElement& e, HashSeed seed, int v) {
-    massert(16767, "Only HashVersion 0 has been defined", v == 0);
-    return BSONElementHasher::hash64(e, seed);
+    massert(16767, "Only HashVersion 0 and 1 have been defined", Hasher::isValidVersion(v));
+    return BSONElementHasher::hash64(e, seed, v);
 }
 
 // static
@@ -68,10 +68,9 @@ void ExpressionParams::parseTwoDParams(const BSONObj& infoObj, TwoDIndexingParam
     out->geoHashConverter.reset(new GeoHashConverter(hashParams));
 }
 
-void ExpressionParams::parseHashParams(const BSONObj& infoObj,
-                                       HashSeed* seedOut,
-                                       int* versionOut,
-                                       std::string* fieldOut) {
+void ExpressionParams::parseHashSeedAndVersion(const BSONObj& infoObj,
+                                               HashSeed* seedOut,
+                                               int* versionOut) {
     // Default _seed to DEFAULT_HASH_SEED if "seed" is not included in the index spec
     // or if the value of "seed" is not a number
 
@@ -84,11 +83,18 @@ void ExpressionParams::parseHashParams(const BSONObj& infoObj,
         *seedOut = infoObj["seed"].numberInt();
     }
 
-    // In case we have hashed indexes based on other hash functions in the future, we store
-    // a hashVersion number. If hashVersion changes, "makeSingleHashKey" will need to change
-    // accordingly.  Defaults to 0 if "hashVersion" is not included in the index spec or if
-    // the value of "hashversion" is not a number
+    // The hash function is chosen by the hashVersion number (see Hasher). If another one is
+    // added, "makeSingleHashKey" will need to change accordingly.  Defaults to 0 if
+    // "hashVersion" is not included in the index spec or if the value of "hashversion" is not
+    // a number
     *versionOut = infoObj["hashVersion"].numberInt();
+}
+
+void ExpressionParams::parseHashParams(const BSONObj& infoObj,
+                                       HashSeed* seedOut,
+                                       int* versionOut,
+                                       std::string* fieldOut) {
+    parseHashSeedAndVersion(infoObj, seedOut, versionOut);
 
     // Get the hashfield name
     BSONElement firstElt = infoObj.getObjectField("key").firstElement();
@@ -184,8 +190,9 @@ void ExpressionParams::parse2dsphereParams(const BSONObj& infoObj, S2IndexingPar
     massert(17395,
             stream() << "unsupported geo index version { " << kIndexVersionFieldName << " : "
                      << out->indexVersion << " }, only support versions: [" << S2_INDEX_VERSION_1
-                     << "," << S2_INDEX_VERSION_2 << "," << S2_INDEX_VERSION_3 << "]",
-            out->indexVersion == S2_INDEX_VERSION_3 || out->indexVersion == S2_INDEX_VERSION_2 ||
-                out->indexVersion == S2_INDEX_VERSION_1);
+                     << "," << S2_INDEX_VERSION_2 << "," << S2_INDEX_VERSION_3 << ","
+                     << S2_INDEX_VERSION_4 << "]",
+            out->indexVersion == S2_INDEX_VERSION_4 || out->indexVersion == S2_INDEX_VERSION_3 ||
+                out->indexVersion == S2_INDEX_VERSION_2 || out->indexVersion == S2_INDEX_VERSION_1);
 }
 }  // namespace mongo
@@ -43,6 +43,12 @@ namespace ExpressionParams {
 
 void parseTwoDParams(const BSONObj& infoObj, TwoDIndexingParams* out);
 
+/**
+ * Reads the hash seed and hash version of a hashed index from its spec, defaulting each when
+ * absent. Unlike parseHashParams(), does not require the spec to have a key pattern.
+ */
+void parseHashSeedAndVersion(const BSONObj& infoObj, HashSeed* seedOut, int* versionOut);
+
 void parseHashParams(const BSONObj& infoObj,
                      HashSeed* seedOut,
                      int* versionOut,
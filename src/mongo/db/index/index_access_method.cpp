@@ -32,6 +32,7 @@
 
 #include "mongo/db/index/btree_access_method.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "mongo/base/error_codes.h"
@@ -39,10 +40,12 @@
 #include "mongo/db/client.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/curop.h"
+#include "mongo/db/index/index_prefix_counts.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/keypattern.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/record_store.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/util/log.h"
 #include "mongo/util/progress_meter.h"
@@ -101,52 +104,152 @@ Status IndexAccessMethod::insert(OperationContext* txn,
                                  const BSONObj& obj,
                                  const RecordId& loc,
                                  const InsertDeleteOptions& options,
-                                 int64_t* numInserted) {
+                                 int64_t* numInserted,
+                                 const BSONFieldOffsets* offsets) {
     *numInserted = 0;
 
     BSONObjSet keys;
     // Delegate to the subclass.
-    getKeys(obj, &keys);
+    if (offsets) {
+        getKeysUsingOffsets(obj, *offsets, &keys);
+    } else {
+        getKeys(obj, &keys);
+    }
 
-    Status ret = Status::OK();
+    // All of the document's keys go to the index in one batch, within which the storage engine
+    // can reuse its cursor.
+    std::vector<IndexKeyEntry> entries;
+    entries.reserve(keys.size());
     for (BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i) {
-        Status status = _newInterface->insert(txn, *i, loc, options.dupsAllowed);
+        entries.push_back(IndexKeyEntry(*i, loc));
+    }
+    if (entries.size() > 1) {
+        std::sort(entries.begin(), entries.end(), IndexEntryComparison(_btreeState->ordering()));
+    }
+
+    if (_sideWrites) {
+        _recordSideWrites(txn, IndexBuildSideWrites::Op::kInsert, entries);
+        *numInserted = entries.size();
+    } else {
+        Status status = _insertEntries(txn, entries, options, numInserted);
+        if (!status.isOK())
+            return status;
+    }
+
+    if (*numInserted > 1) {
+        _btreeState->setMultikey(txn);
+    }
+
+    IndexPrefixCounts* prefixCounts = _btreeState->prefixCounts();
+    if (prefixCounts) {
+        prefixCounts->recordInsert(txn, keys);
+    }
+
+    return Status::OK();
+}
+
+Status IndexAccessMethod::insertBatch(OperationContext* txn,
+                                      const std::vector<Record>& records,
+                                      const InsertDeleteOptions& options,
+                                      int64_t* numInserted,
+                                      const std::vector<const BSONFieldOffsets*>* offsets) {
+    *numInserted = 0;
+    invariant(!offsets || offsets->size() == records.size());
+
+    IndexPrefixCounts* prefixCounts = _btreeState->prefixCounts();
+    std::vector<BSONObjSet> keysOfRecords;
+
+    bool isMultikey = false;
+    std::vector<IndexKeyEntry> entries;
+    for (size_t r = 0; r < records.size(); ++r) {
+        const Record& record = records[r];
+        BSONObjSet keys;
+        if (offsets) {
+            getKeysUsingOffsets(record.data.toBson(), *(*offsets)[r], &keys);
+        } else {
+            getKeys(record.data.toBson(), &keys);
+        }
+        isMultikey = isMultikey || keys.size() > 1;
+        for (BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i) {
+            entries.push_back(IndexKeyEntry(*i, record.id));
+        }
+        if (prefixCounts) {
+            keysOfRecords.push_back(std::move(keys));
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), IndexEntryComparison(_btreeState->ordering()));
+
+    if (_sideWrites) {
+        _recordSideWrites(txn, IndexBuildSideWrites::Op::kInsert, entries);
+        *numInserted = entries.size();
+    } else {
+        Status status = _insertEntries(txn, entries, options, numInserted);
+        if (!status.isOK())
+            return status;
+    }
+
+    if (isMultikey) {
+        _btreeState->setMultikey(txn);
+    }
+
+    for (size_t r = 0; r < keysOfRecords.size(); ++r) {
+        prefixCounts->recordInsert(txn, keysOfRecords[r]);
+    }
+
+    return Status::OK();
+}
+
+Status IndexAccessMethod::_insertEntries(OperationContext* txn,
+                                         const std::vector<IndexKeyEntry>& entries,
+                                         const InsertDeleteOptions& options,
+                                         int64_t* numInserted) {
+    *numInserted = 0;
+
+    // Entries whose error was tolerated, so must not be removed if a later entry fails.
+    vector<bool> skipped(entries.size(), false);
+
+    size_t pos = 0;
+    while (pos < entries.size()) {
+        size_t numDone;
+        Status status = _newInterface->insertBatch(
+            txn, &entries[pos], entries.size() - pos, options.dupsAllowed, &numDone);
+        *numInserted += numDone;
+        pos += numDone;
 
-        // Everything's OK, carry on.
         if (status.isOK()) {
-            ++*numInserted;
-            continue;
+            invariant(pos == entries.size());
+            break;
         }
 
-        // Error cases.
+        // Error cases. The failed entry is the one at 'pos'.
 
         if (status.code() == ErrorCodes::KeyTooLong && ignoreKeyTooLong(txn)) {
+            skipped[pos++] = true;
             continue;
         }
 
-        if (status.code() == ErrorCodes::DuplicateKeyValue) {
-            // A document might be indexed multiple times during a background index build
-            // if it moves ahead of the collection scan cursor (e.g. via an update).
-            if (!_btreeState->isReady(txn)) {
-                LOG(3) << "key " << *i << " already in index during background indexing (ok)";
-                continue;
-            }
+        // A document might be indexed multiple times during a background index build if it
+        // moves ahead of the collection scan cursor (e.g. via an update).
+        if (status.code() == ErrorCodes::DuplicateKeyValue && !_btreeState->isReady(txn)) {
+            LOG(3) << "key " << entries[pos].key
+                   << " already in index during background indexing (ok)";
+            skipped[pos++] = true;
+            continue;
         }
 
         // Clean up after ourselves.
-        for (BSONObjSet::const_iterator j = keys.begin(); j != i; ++j) {
-            removeOneKey(txn, *j, loc, options.dupsAllowed);
-            *numInserted = 0;
+        for (size_t j = 0; j < pos; j++) {
+            if (!skipped[j]) {
+                removeOneKey(txn, entries[j].key, entries[j].loc, options.dupsAllowed);
+            }
         }
+        *numInserted = 0;
 
         return status;
     }
 
-    if (*numInserted > 1) {
-        _btreeState->setMultikey(txn);
-    }
-
-    return ret;
+    return Status::OK();
 }
 
 void IndexAccessMethod::removeOneKey(OperationContext* txn,
@@ -178,6 +281,23 @@ Status IndexAccessMethod::remove(OperationContext* txn,
     getKeys(obj, &keys);
     *numDeleted = 0;
 
+    // Documents outside of a partial index are unindexed too, but aren't counted.
+    IndexPrefixCounts* prefixCounts = _btreeState->prefixCounts();
+    const MatchExpression* filter = _btreeState->getFilterExpression();
+    if (prefixCounts && (!filter || filter->matchesBSON(obj))) {
+        prefixCounts->recordRemove(txn, keys);
+    }
+
+    if (_sideWrites) {
+        std::vector<IndexKeyEntry> entries;
+        for (BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i) {
+            entries.push_back(IndexKeyEntry(*i, loc));
+        }
+        _recordSideWrites(txn, IndexBuildSideWrites::Op::kRemove, entries);
+        *numDeleted = entries.size();
+        return Status::OK();
+    }
+
     for (BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i) {
         removeOneKey(txn, *i, loc, options.dupsAllowed);
         ++*numDeleted;
@@ -263,6 +383,14 @@ long long IndexAccessMethod::getSpaceUsedBytes(OperationContext* txn) const {
     return _newInterface->getSpaceUsedBytes(txn);
 }
 
+boost::optional<long long> IndexAccessMethod::countRange(OperationContext* txn,
+                                                         const BSONObj& startKey,
+                                                         bool startInclusive,
+                                                         const BSONObj& endKey,
+                                                         bool endInclusive) const {
+    return _newInterface->countRange(txn, startKey, startInclusive, endKey, endInclusive);
+}
+
 Status IndexAccessMethod::validateUpdate(OperationContext* txn,
                                          const BSONObj& from,
                                          const BSONObj& to,
@@ -270,9 +398,11 @@ Status IndexAccessMethod::validateUpdate(OperationContext* txn,
                                          const InsertDeleteOptions& options,
                                          UpdateTicket* ticket,
                                          const MatchExpression* indexFilter) {
-    if (indexFilter == NULL || indexFilter->matchesBSON(from))
+    ticket->wasIndexed = indexFilter == NULL || indexFilter->matchesBSON(from);
+    if (ticket->wasIndexed)
         getKeys(from, &ticket->oldKeys);
-    if (indexFilter == NULL || indexFilter->matchesBSON(to))
+    ticket->isIndexed = indexFilter == NULL || indexFilter->matchesBSON(to);
+    if (ticket->isIndexed)
         getKeys(to, &ticket->newKeys);
     ticket->loc = record;
     ticket->dupsAllowed = options.dupsAllowed;
@@ -296,21 +426,54 @@ Status IndexAccessMethod::update(OperationContext* txn,
         _btreeState->setMultikey(txn);
     }
 
+    IndexPrefixCounts* prefixCounts = _btreeState->prefixCounts();
+    if (prefixCounts) {
+        prefixCounts->recordUpdate(
+            txn, ticket.oldKeys, ticket.wasIndexed, ticket.newKeys, ticket.isIndexed);
+    }
+
+    const IndexEntryComparison comparison(_btreeState->ordering());
+
+    std::vector<IndexKeyEntry> removed;
+    removed.reserve(ticket.removed.size());
     for (size_t i = 0; i < ticket.removed.size(); ++i) {
-        _newInterface->unindex(txn, *ticket.removed[i], ticket.loc, ticket.dupsAllowed);
+        removed.push_back(IndexKeyEntry(*ticket.removed[i], ticket.loc));
     }
 
+    std::vector<IndexKeyEntry> added;
+    added.reserve(ticket.added.size());
     for (size_t i = 0; i < ticket.added.size(); ++i) {
-        Status status =
-            _newInterface->insert(txn, *ticket.added[i], ticket.loc, ticket.dupsAllowed);
-        if (!status.isOK()) {
-            if (status.code() == ErrorCodes::KeyTooLong && ignoreKeyTooLong(txn)) {
-                // Ignore.
-                continue;
-            }
+        added.push_back(IndexKeyEntry(*ticket.added[i], ticket.loc));
+    }
 
-            return status;
+    if (_sideWrites) {
+        _recordSideWrites(txn, IndexBuildSideWrites::Op::kRemove, removed);
+        _recordSideWrites(txn, IndexBuildSideWrites::Op::kInsert, added);
+        *numUpdated = ticket.added.size();
+        return Status::OK();
+    }
+
+    std::sort(removed.begin(), removed.end(), comparison);
+    _newInterface->unindexBatch(txn, removed.data(), removed.size(), ticket.dupsAllowed);
+
+    std::sort(added.begin(), added.end(), comparison);
+
+    size_t pos = 0;
+    while (pos < added.size()) {
+        size_t numDone;
+        Status status = _newInterface->insertBatch(
+            txn, &added[pos], added.size() - pos, ticket.dupsAllowed, &numDone);
+        pos += numDone;
+        if (status.isOK())
+            break;
+
+        if (status.code() == ErrorCodes::KeyTooLong && ignoreKeyTooLong(txn)) {
+            // Ignore, and carry on after the failed entry.
+            pos++;
+            continue;
         }
+
+        return status;
     }
 
     *numUpdated = ticket.added.size();
@@ -318,33 +481,103 @@ Status IndexAccessMethod::update(OperationContext* txn,
     return Status::OK();
 }
 
-std::unique_ptr<IndexAccessMethod::BulkBuilder> IndexAccessMethod::initiateBulk() {
-    return std::unique_ptr<BulkBuilder>(new BulkBuilder(this, _descriptor));
+void IndexAccessMethod::_recordSideWrites(OperationContext* txn,
+                                          IndexBuildSideWrites::Op op,
+                                          const std::vector<IndexKeyEntry>& entries) {
+    for (size_t i = 0; i < entries.size(); ++i) {
+        _sideWrites->record(txn, op, entries[i].key, entries[i].loc);
+    }
+}
+
+Status IndexAccessMethod::drainSideWrites(OperationContext* txn,
+                                          IndexBuildSideWrites* sideWrites,
+                                          size_t maxEntries,
+                                          const InsertDeleteOptions& options,
+                                          size_t* numEntries) {
+    std::vector<IndexBuildSideWrites::Write> writes;
+    *numEntries = sideWrites->peekCommitted(maxEntries, &writes);
+
+    // Consecutive writes of the same kind can be applied in any order, since inserting a key
+    // that is already present or removing one that is absent changes nothing. Each run goes to
+    // the index sorted, in one batch.
+    const IndexEntryComparison comparison(_btreeState->ordering());
+    size_t runStart = 0;
+    while (runStart < writes.size()) {
+        const IndexBuildSideWrites::Op op = writes[runStart].op;
+        std::vector<IndexKeyEntry> entries;
+        size_t runEnd = runStart;
+        for (; runEnd < writes.size() && writes[runEnd].op == op; ++runEnd) {
+            entries.push_back(IndexKeyEntry(writes[runEnd].key, writes[runEnd].loc));
+        }
+        std::sort(entries.begin(), entries.end(), comparison);
+
+        if (op == IndexBuildSideWrites::Op::kInsert) {
+            int64_t numInserted;
+            Status status = _insertEntries(txn, entries, options, &numInserted);
+            if (!status.isOK())
+                return status;
+        } else {
+            _newInterface->unindexBatch(txn, entries.data(), entries.size(), options.dupsAllowed);
+        }
+        runStart = runEnd;
+    }
+
+    sideWrites->discardWhenCommitted(txn, *numEntries);
+    return Status::OK();
+}
+
+namespace {
+const size_t kBulkBuildMaxMemoryUsageBytes = 100 * 1024 * 1024;
+
+SortOptions bulkBuildSortOptions(size_t numPartitions) {
+    return SortOptions()
+        .TempDir(storageGlobalParams.dbpath + "/_tmp")
+        .ExtSortAllowed()
+        .MaxMemoryUsageBytes(kBulkBuildMaxMemoryUsageBytes / numPartitions);
+}
+}  // namespace
+
+std::unique_ptr<IndexAccessMethod::BulkBuilder> IndexAccessMethod::initiateBulk(
+    size_t numPartitions) {
+    return std::unique_ptr<BulkBuilder>(new BulkBuilder(this, _descriptor, numPartitions));
 }
 
 IndexAccessMethod::BulkBuilder::BulkBuilder(const IndexAccessMethod* index,
-                                            const IndexDescriptor* descriptor)
-    : _sorter(Sorter::make(
-          SortOptions()
-              .TempDir(storageGlobalParams.dbpath + "/_tmp")
-              .ExtSortAllowed()
-              .MaxMemoryUsageBytes(100 * 1024 * 1024),
-          BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version()))),
-      _real(index) {}
+                                            const IndexDescriptor* descriptor,
+                                            size_t numPartitions)
+    : _partitions(numPartitions), _real(index) {
+    invariant(numPartitions > 0);
+    for (size_t i = 0; i < numPartitions; i++) {
+        _partitions[i].sorter.reset(Sorter::make(
+            bulkBuildSortOptions(numPartitions),
+            BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version())));
+    }
+}
 
 Status IndexAccessMethod::BulkBuilder::insert(OperationContext* txn,
                                               const BSONObj& obj,
                                               const RecordId& loc,
                                               const InsertDeleteOptions& options,
                                               int64_t* numInserted) {
+    return insertIntoPartition(0, obj, loc, options, numInserted);
+}
+
+Status IndexAccessMethod::BulkBuilder::insertIntoPartition(size_t partitionIndex,
+                                                           const BSONObj& obj,
+                                                           const RecordId& loc,
+                                                           const InsertDeleteOptions& options,
+                                                           int64_t* numInserted) {
+    Partition& partition = _partitions[partitionIndex];
+
     BSONObjSet keys;
     _real->getKeys(obj, &keys);
 
-    _isMultiKey = _isMultiKey || (keys.size() > 1);
+    partition.isMultiKey = partition.isMultiKey || (keys.size() > 1);
 
     for (BSONObjSet::iterator it = keys.begin(); it != keys.end(); ++it) {
-        _sorter->add(*it, loc);
-        _keysInserted++;
+        partition.sorter->add(*it, loc);
+        partition.keysInserted++;
+        partition.keyBytesInserted += it->memUsageForSorter() + loc.memUsageForSorter();
     }
 
     if (NULL != numInserted) {
@@ -362,12 +595,31 @@ Status IndexAccessMethod::commitBulk(OperationContext* txn,
                                      set<RecordId>* dupsToDrop) {
     Timer timer;
 
-    std::unique_ptr<BulkBuilder::Sorter::Iterator> i(bulk->_sorter->done());
+    int64_t keysInserted = 0;
+    bool isMultiKey = false;
+    std::unique_ptr<BulkBuilder::Sorter::Iterator> i;
+    if (bulk->_partitions.size() == 1) {
+        keysInserted = bulk->_partitions[0].keysInserted;
+        isMultiKey = bulk->_partitions[0].isMultiKey;
+        i.reset(bulk->_partitions[0].sorter->done());
+    } else {
+        // Merge the sorted runs of each partition into a single stream of keys.
+        std::vector<std::shared_ptr<BulkBuilder::Sorter::Iterator>> iters;
+        for (size_t p = 0; p < bulk->_partitions.size(); p++) {
+            keysInserted += bulk->_partitions[p].keysInserted;
+            isMultiKey = isMultiKey || bulk->_partitions[p].isMultiKey;
+            iters.emplace_back(bulk->_partitions[p].sorter->done());
+        }
+        i.reset(BulkBuilder::Sorter::Iterator::merge(
+            iters,
+            bulkBuildSortOptions(1),
+            BtreeExternalSortComparison(_descriptor->keyPattern(), _descriptor->version())));
+    }
 
     stdx::unique_lock<Client> lk(*txn->getClient());
     ProgressMeterHolder pm(*txn->setMessage_inlock("Index Bulk Build: (2/3) btree bottom up",
                                                    "Index: (2/3) BTree Bottom Up Progress",
-                                                   bulk->_keysInserted,
+                                                   keysInserted,
                                                    10));
     lk.unlock();
 
@@ -376,7 +628,7 @@ Status IndexAccessMethod::commitBulk(OperationContext* txn,
     MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
         WriteUnitOfWork wunit(txn);
 
-        if (bulk->_isMultiKey) {
+        if (isMultiKey) {
             _btreeState->setMultikey(txn);
         }
 
@@ -31,6 +31,7 @@
 #include <memory>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/db/index/index_build_side_writes.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
@@ -40,10 +41,12 @@
 
 namespace mongo {
 
+class BSONFieldOffsets;
 class BSONObjBuilder;
 class MatchExpression;
 class UpdateTicket;
 struct InsertDeleteOptions;
+struct Record;
 
 /**
  * An IndexAccessMethod is the interface through which all the mutation, lookup, and
@@ -72,13 +75,30 @@ public:
      * 'numInserted' will be set to the number of keys added to the index for the document.  If
      * there is more than one key for 'obj', either all keys will be inserted or none will.
      *
-     * The behavior of the insertion can be specified through 'options'.
+     * The behavior of the insertion can be specified through 'options'. If not NULL, 'offsets'
+     * is a BSONFieldOffsets over 'obj' that key generation may look fields up in, which the
+     * caller shares between every index the document goes into.
      */
     Status insert(OperationContext* txn,
                   const BSONObj& obj,
                   const RecordId& loc,
                   const InsertDeleteOptions& options,
-                  int64_t* numInserted);
+                  int64_t* numInserted,
+                  const BSONFieldOffsets* offsets = NULL);
+
+    /**
+     * Analogous to insert(), but for every document in 'records' at once. The keys of all the
+     * documents are sorted and handed to the index in a single batch, which saves repeated
+     * descents when the documents' keys are close together. If any key fails to insert, none
+     * of the keys for any of the documents are left in the index.
+     *
+     * If not NULL, 'offsets' holds a BSONFieldOffsets for each entry of 'records', in order.
+     */
+    Status insertBatch(OperationContext* txn,
+                       const std::vector<Record>& records,
+                       const InsertDeleteOptions& options,
+                       int64_t* numInserted,
+                       const std::vector<const BSONFieldOffsets*>* offsets = NULL);
 
     /**
      * Analogous to above, but remove the records instead of inserting them.  If not NULL,
@@ -176,6 +196,18 @@ public:
      */
     long long getSpaceUsedBytes(OperationContext* txn) const;
 
+    /**
+     * Counts the keys between 'startKey' and 'endKey' without scanning them, if the storage
+     * engine keeps the statistics to do so. Returns boost::none otherwise.
+     *
+     * @see SortedDataInterface::countRange
+     */
+    boost::optional<long long> countRange(OperationContext* txn,
+                                          const BSONObj& startKey,
+                                          bool startInclusive,
+                                          const BSONObj& endKey,
+                                          bool endInclusive) const;
+
     RecordId findSingle(OperationContext* txn, const BSONObj& key) const;
 
     //
@@ -193,17 +225,55 @@ public:
                       const InsertDeleteOptions& options,
                       int64_t* numInserted);
 
+        /**
+         * Same as insert(), but adds the keys to the sorter of the given partition. Different
+         * partitions may be inserted into concurrently, each by a single thread at a time.
+         * insert() uses partition 0.
+         */
+        Status insertIntoPartition(size_t partition,
+                                   const BSONObj& obj,
+                                   const RecordId& loc,
+                                   const InsertDeleteOptions& options,
+                                   int64_t* numInserted);
+
+        size_t numPartitions() const {
+            return _partitions.size();
+        }
+
+        /**
+         * Returns the approximate number of bytes of keys added to the given partition so far,
+         * including those already spilled to disk.
+         */
+        int64_t keyBytesInserted(size_t partition) const {
+            return _partitions[partition].keyBytesInserted;
+        }
+
+        /**
+         * Changes how much memory the sorter of the given partition may hold before spilling.
+         * Must only be called by the thread inserting into that partition.
+         */
+        void setMaxMemoryUsageBytes(size_t partition, size_t maxMemoryUsageBytes) {
+            _partitions[partition].sorter->setMaxMemoryUsageBytes(maxMemoryUsageBytes);
+        }
+
     private:
         friend class IndexAccessMethod;
 
         using Sorter = mongo::Sorter<BSONObj, RecordId>;
 
-        BulkBuilder(const IndexAccessMethod* index, const IndexDescriptor* descriptor);
+        struct Partition {
+            std::unique_ptr<Sorter> sorter;
+            int64_t keysInserted = 0;
+            int64_t keyBytesInserted = 0;
+            bool isMultiKey = false;
+        };
+
+        BulkBuilder(const IndexAccessMethod* index,
+                    const IndexDescriptor* descriptor,
+                    size_t numPartitions);
 
-        std::unique_ptr<Sorter> _sorter;
+        std::vector<Partition> _partitions;
         const IndexAccessMethod* _real;
-        int64_t _keysInserted = 0;
-        bool _isMultiKey = false;
     };
 
     /**
@@ -211,9 +281,12 @@ public:
      * You work on the returned BulkBuilder and then call commitBulk.
      * This can return NULL, meaning bulk mode is not available.
      *
+     * The keys can be added from 'numPartitions' threads at once, each into its own sorter.
+     * commitBulk() merges them. The sorters share the memory budget of a single one.
+     *
      * It is only legal to initiate bulk when the index is new and empty.
      */
-    std::unique_ptr<BulkBuilder> initiateBulk();
+    std::unique_ptr<BulkBuilder> initiateBulk(size_t numPartitions = 1);
 
     /**
      * Call this when you are ready to finish your bulk work.
@@ -230,11 +303,45 @@ public:
                       bool dupsAllowed,
                       std::set<RecordId>* dups);
 
+    //
+    // Side writes support
+    //
+
+    /**
+     * While 'sideWrites' is not null, insertions, removals and updates record their keys in it
+     * instead of writing them to the index, so the index can be bulk built while writers
+     * proceed. Must be called under an exclusive collection lock.
+     */
+    void setSideWrites(std::shared_ptr<IndexBuildSideWrites> sideWrites) {
+        _sideWrites = std::move(sideWrites);
+    }
+
+    /**
+     * Applies to the index, in the unit of work of 'txn', the committed writes among the oldest
+     * 'maxEntries' of 'sideWrites', which are discarded when it commits. Sets '*numEntries' to
+     * the number of entries covered, which is 0 once there is nothing to apply.
+     */
+    Status drainSideWrites(OperationContext* txn,
+                           IndexBuildSideWrites* sideWrites,
+                           size_t maxEntries,
+                           const InsertDeleteOptions& options,
+                           size_t* numEntries);
+
     /**
      * Fills 'keys' with the keys that should be generated for 'obj' on this index.
      */
     virtual void getKeys(const BSONObj& obj, BSONObjSet* keys) const = 0;
 
+    /**
+     * Same as getKeys(), but may look the fields of 'obj' up in 'offsets', a BSONFieldOffsets
+     * over 'obj'. Index types that do not benefit from it keep this default, which ignores it.
+     */
+    virtual void getKeysUsingOffsets(const BSONObj& obj,
+                                     const BSONFieldOffsets& offsets,
+                                     BSONObjSet* keys) const {
+        getKeys(obj, keys);
+    }
+
 protected:
     // Determines whether it's OK to ignore ErrorCodes::KeyTooLong for this OperationContext
     bool ignoreKeyTooLong(OperationContext* txn);
@@ -248,7 +355,27 @@ private:
                       const RecordId& loc,
                       bool dupsAllowed);
 
+    /**
+     * Inserts 'entries', which must be sorted in the order of this index, in as few batches as
+     * their errors allow. Tolerated errors skip the failing entry. On any other error, removes
+     * the entries already inserted and sets '*numInserted' to 0.
+     */
+    Status _insertEntries(OperationContext* txn,
+                          const std::vector<IndexKeyEntry>& entries,
+                          const InsertDeleteOptions& options,
+                          int64_t* numInserted);
+
+    /**
+     * Records 'entries' in '_sideWrites' in place of inserting or removing them.
+     */
+    void _recordSideWrites(OperationContext* txn,
+                           IndexBuildSideWrites::Op op,
+                           const std::vector<IndexKeyEntry>& entries);
+
     const std::unique_ptr<SortedDataInterface> _newInterface;
+
+    // Set while the index is bulk built in the background. See setSideWrites().
+    std::shared_ptr<IndexBuildSideWrites> _sideWrites;
 };
 
 /**
@@ -271,6 +398,11 @@ private:
 
     RecordId loc;
     bool dupsAllowed;
+
+    // Whether the document was in the index before and after the update, which only differ for
+    // partial indexes.
+    bool wasIndexed;
+    bool isIndexed;
 };
 
 /**
@@ -0,0 +1,128 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/index/index_build_side_writes.h"
+
+#include "mongo/db/operation_context.h"
+#include "mongo/db/storage/recovery_unit.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+class IndexBuildSideWrites::RecordChange : public RecoveryUnit::Change {
+public:
+    RecordChange(IndexBuildSideWrites* sideWrites, uint64_t id)
+        : _sideWrites(sideWrites), _id(id) {}
+
+    void commit() override {
+        _sideWrites->_setState(_id, State::kCommitted);
+    }
+
+    void rollback() override {
+        _sideWrites->_setState(_id, State::kRolledBack);
+    }
+
+private:
+    IndexBuildSideWrites* const _sideWrites;
+    const uint64_t _id;
+};
+
+class IndexBuildSideWrites::DiscardChange : public RecoveryUnit::Change {
+public:
+    DiscardChange(IndexBuildSideWrites* sideWrites, size_t numEntries)
+        : _sideWrites(sideWrites), _numEntries(numEntries) {}
+
+    void commit() override {
+        _sideWrites->_discard(_numEntries);
+    }
+
+    void rollback() override {}
+
+private:
+    IndexBuildSideWrites* const _sideWrites;
+    const size_t _numEntries;
+};
+
+void IndexBuildSideWrites::record(OperationContext* txn,
+                                  Op op,
+                                  const BSONObj& key,
+                                  const RecordId& loc) {
+    uint64_t id;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        id = _firstId + _entries.size();
+        _entries.emplace_back(op, key.getOwned(), loc);
+    }
+    txn->recoveryUnit()->registerChange(new RecordChange(this, id));
+}
+
+size_t IndexBuildSideWrites::peekCommitted(size_t maxEntries, std::vector<Write>* out) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    size_t numEntries = 0;
+    while (numEntries < maxEntries && numEntries < _entries.size()) {
+        const Entry& entry = _entries[numEntries];
+        if (entry.state == State::kOpen)
+            break;
+        if (entry.state == State::kCommitted)
+            out->push_back(entry.write);
+        numEntries++;
+    }
+    return numEntries;
+}
+
+void IndexBuildSideWrites::discardWhenCommitted(OperationContext* txn, size_t numEntries) {
+    txn->recoveryUnit()->registerChange(new DiscardChange(this, numEntries));
+}
+
+size_t IndexBuildSideWrites::size() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _entries.size();
+}
+
+void IndexBuildSideWrites::_setState(uint64_t id, State state) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    // An entry is only discarded once its unit of work has finished.
+    invariant(id >= _firstId && id < _firstId + _entries.size());
+    Entry& entry = _entries[id - _firstId];
+    invariant(entry.state == State::kOpen);
+    entry.state = state;
+}
+
+void IndexBuildSideWrites::_discard(size_t numEntries) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    invariant(numEntries <= _entries.size());
+    for (size_t i = 0; i < numEntries; i++) {
+        invariant(_entries.front().state != State::kOpen);
+        _entries.pop_front();
+        _firstId++;
+    }
+}
+
+}  // namespace mongo
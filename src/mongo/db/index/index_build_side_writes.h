@@ -0,0 +1,115 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/record_id.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+class OperationContext;
+
+/**
+ * The side table of an index built in the background from an external sort. While the sorted
+ * keys are loaded into the index, writers record their key insertions and removals here
+ * instead of in the index, and the builder applies them afterwards in the order they were
+ * recorded.
+ *
+ * Writes become visible when the unit of work that recorded them commits, and are never
+ * applied if it rolls back. Recording is thread safe; only one thread may drain at a time.
+ */
+class IndexBuildSideWrites {
+    MONGO_DISALLOW_COPYING(IndexBuildSideWrites);
+
+public:
+    enum class Op { kInsert, kRemove };
+
+    struct Write {
+        Write(Op op, const BSONObj& key, const RecordId& loc) : op(op), key(key), loc(loc) {}
+
+        Op op;
+        BSONObj key;
+        RecordId loc;
+    };
+
+    IndexBuildSideWrites() = default;
+
+    /**
+     * Records that 'key' pointing to 'loc' was inserted into or removed from the index, in the
+     * unit of work of 'txn'.
+     */
+    void record(OperationContext* txn, Op op, const BSONObj& key, const RecordId& loc);
+
+    /**
+     * Appends to 'out' the committed writes among the oldest 'maxEntries' recorded, stopping
+     * before the first one whose unit of work is still open. Returns the number of entries
+     * covered, including those rolled back, to be passed to discardWhenCommitted().
+     */
+    size_t peekCommitted(size_t maxEntries, std::vector<Write>* out) const;
+
+    /**
+     * Discards the 'numEntries' oldest entries once the unit of work of 'txn' commits.
+     */
+    void discardWhenCommitted(OperationContext* txn, size_t numEntries);
+
+    /**
+     * Returns the number of entries not yet discarded, whether committed or not.
+     */
+    size_t size() const;
+
+private:
+    class RecordChange;
+    class DiscardChange;
+
+    enum class State { kOpen, kCommitted, kRolledBack };
+
+    struct Entry {
+        Entry(Op op, const BSONObj& key, const RecordId& loc)
+            : write(op, key, loc), state(State::kOpen) {}
+
+        Write write;
+        State state;
+    };
+
+    void _setState(uint64_t id, State state);
+    void _discard(size_t numEntries);
+
+    mutable stdx::mutex _mutex;
+    std::deque<Entry> _entries;
+
+    // The id of the entry at the front of '_entries'. Ids increase by one per recorded write.
+    uint64_t _firstId = 0;
+};
+
+}  // namespace mongo
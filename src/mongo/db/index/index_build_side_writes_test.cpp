@@ -0,0 +1,141 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/index/index_build_side_writes.h"
+
+#include "mongo/db/operation_context_noop.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using Op = IndexBuildSideWrites::Op;
+using Write = IndexBuildSideWrites::Write;
+
+TEST(IndexBuildSideWrites, CommittedWritesAreVisibleInOrder) {
+    OperationContextNoop txn;
+    IndexBuildSideWrites sideWrites;
+    {
+        WriteUnitOfWork wunit(&txn);
+        sideWrites.record(&txn, Op::kInsert, BSON("" << 1), RecordId(1));
+        sideWrites.record(&txn, Op::kRemove, BSON("" << 1), RecordId(1));
+
+        std::vector<Write> writes;
+        ASSERT_EQUALS(0U, sideWrites.peekCommitted(10, &writes));
+        ASSERT(writes.empty());
+        wunit.commit();
+    }
+
+    std::vector<Write> writes;
+    ASSERT_EQUALS(2U, sideWrites.peekCommitted(10, &writes));
+    ASSERT_EQUALS(2U, writes.size());
+    ASSERT(writes[0].op == Op::kInsert);
+    ASSERT(writes[1].op == Op::kRemove);
+    ASSERT_EQUALS(BSON("" << 1), writes[1].key);
+    ASSERT_EQUALS(RecordId(1), writes[1].loc);
+
+    writes.clear();
+    ASSERT_EQUALS(1U, sideWrites.peekCommitted(1, &writes));
+    ASSERT_EQUALS(1U, writes.size());
+}
+
+TEST(IndexBuildSideWrites, RolledBackWritesAreSkipped) {
+    OperationContextNoop txn;
+    IndexBuildSideWrites sideWrites;
+    {
+        WriteUnitOfWork wunit(&txn);
+        sideWrites.record(&txn, Op::kInsert, BSON("" << 1), RecordId(1));
+    }
+    {
+        WriteUnitOfWork wunit(&txn);
+        sideWrites.record(&txn, Op::kInsert, BSON("" << 2), RecordId(2));
+        wunit.commit();
+    }
+
+    std::vector<Write> writes;
+    ASSERT_EQUALS(2U, sideWrites.peekCommitted(10, &writes));
+    ASSERT_EQUALS(1U, writes.size());
+    ASSERT_EQUALS(BSON("" << 2), writes[0].key);
+}
+
+TEST(IndexBuildSideWrites, OpenWriteHoldsBackLaterOnes) {
+    OperationContextNoop first;
+    OperationContextNoop second;
+    IndexBuildSideWrites sideWrites;
+
+    WriteUnitOfWork firstUnit(&first);
+    sideWrites.record(&first, Op::kRemove, BSON("" << 1), RecordId(1));
+    {
+        WriteUnitOfWork secondUnit(&second);
+        sideWrites.record(&second, Op::kInsert, BSON("" << 1), RecordId(1));
+        secondUnit.commit();
+    }
+
+    std::vector<Write> writes;
+    ASSERT_EQUALS(0U, sideWrites.peekCommitted(10, &writes));
+
+    firstUnit.commit();
+    ASSERT_EQUALS(2U, sideWrites.peekCommitted(10, &writes));
+    ASSERT_EQUALS(2U, writes.size());
+    ASSERT(writes[0].op == Op::kRemove);
+    ASSERT(writes[1].op == Op::kInsert);
+}
+
+TEST(IndexBuildSideWrites, DiscardOnlyWhenCommitted) {
+    OperationContextNoop txn;
+    IndexBuildSideWrites sideWrites;
+    {
+        WriteUnitOfWork wunit(&txn);
+        sideWrites.record(&txn, Op::kInsert, BSON("" << 1), RecordId(1));
+        sideWrites.record(&txn, Op::kInsert, BSON("" << 2), RecordId(2));
+        wunit.commit();
+    }
+    ASSERT_EQUALS(2U, sideWrites.size());
+
+    {
+        WriteUnitOfWork wunit(&txn);
+        sideWrites.discardWhenCommitted(&txn, 1);
+    }
+    ASSERT_EQUALS(2U, sideWrites.size());
+
+    {
+        WriteUnitOfWork wunit(&txn);
+        sideWrites.discardWhenCommitted(&txn, 1);
+        wunit.commit();
+    }
+    ASSERT_EQUALS(1U, sideWrites.size());
+
+    std::vector<Write> writes;
+    ASSERT_EQUALS(1U, sideWrites.peekCommitted(10, &writes));
+    ASSERT_EQUALS(BSON("" << 2), writes[0].key);
+}
+
+}  // namespace
+}  // namespace mongo
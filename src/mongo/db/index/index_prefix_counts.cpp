@@ -0,0 +1,179 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/index/index_prefix_counts.h"
+
+#include "mongo/db/operation_context.h"
+#include "mongo/db/storage/recovery_unit.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+class IndexPrefixCounts::AdjustChange : public RecoveryUnit::Change {
+public:
+    AdjustChange(IndexPrefixCounts* counts, Deltas deltas, long long totalDelta)
+        : _counts(counts), _deltas(std::move(deltas)), _totalDelta(totalDelta) {}
+
+    void commit() override {
+        _counts->_apply(_deltas, _totalDelta);
+    }
+
+    void rollback() override {}
+
+private:
+    IndexPrefixCounts* const _counts;
+    const Deltas _deltas;
+    const long long _totalDelta;
+};
+
+void IndexPrefixCounts::reset() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _initialized = false;
+    _counts.clear();
+    _total = 0;
+}
+
+void IndexPrefixCounts::addDocument(const BSONObjSet& keys) {
+    const BSONObjSet prefixes = _prefixesOf(keys);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    invariant(!_initialized);
+    for (const BSONObj& prefix : prefixes) {
+        _counts[prefix]++;
+    }
+    _total++;
+}
+
+void IndexPrefixCounts::setInitialized() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _initialized = true;
+}
+
+bool IndexPrefixCounts::isInitialized() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _initialized;
+}
+
+void IndexPrefixCounts::recordInsert(OperationContext* txn, const BSONObjSet& keys) {
+    if (!isInitialized()) {
+        return;
+    }
+
+    Deltas deltas;
+    for (const BSONObj& prefix : _prefixesOf(keys)) {
+        deltas[prefix] = 1;
+    }
+    _record(txn, std::move(deltas), 1);
+}
+
+void IndexPrefixCounts::recordRemove(OperationContext* txn, const BSONObjSet& keys) {
+    if (!isInitialized()) {
+        return;
+    }
+
+    Deltas deltas;
+    for (const BSONObj& prefix : _prefixesOf(keys)) {
+        deltas[prefix] = -1;
+    }
+    _record(txn, std::move(deltas), -1);
+}
+
+void IndexPrefixCounts::recordUpdate(OperationContext* txn,
+                                     const BSONObjSet& oldKeys,
+                                     bool wasIndexed,
+                                     const BSONObjSet& newKeys,
+                                     bool isIndexed) {
+    if (!isInitialized()) {
+        return;
+    }
+
+    Deltas deltas;
+    for (const BSONObj& prefix : _prefixesOf(oldKeys)) {
+        deltas[prefix]--;
+    }
+    for (const BSONObj& prefix : _prefixesOf(newKeys)) {
+        if (++deltas[prefix] == 0) {
+            deltas.erase(prefix);
+        }
+    }
+
+    const long long totalDelta = (isIndexed ? 1 : 0) - (wasIndexed ? 1 : 0);
+    if (deltas.empty() && totalDelta == 0) {
+        return;
+    }
+    _record(txn, std::move(deltas), totalDelta);
+}
+
+long long IndexPrefixCounts::getCount(const BSONElement& value) const {
+    const BSONObj prefix = value.wrap("");
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    invariant(_initialized);
+    Deltas::const_iterator it = _counts.find(prefix);
+    return it == _counts.end() ? 0 : it->second;
+}
+
+long long IndexPrefixCounts::getTotal() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    invariant(_initialized);
+    return _total;
+}
+
+BSONObjSet IndexPrefixCounts::_prefixesOf(const BSONObjSet& keys) {
+    BSONObjSet prefixes;
+    for (const BSONObj& key : keys) {
+        prefixes.insert(key.firstElement().wrap(""));
+    }
+    return prefixes;
+}
+
+void IndexPrefixCounts::_record(OperationContext* txn, Deltas deltas, long long totalDelta) {
+    txn->recoveryUnit()->registerChange(new AdjustChange(this, std::move(deltas), totalDelta));
+}
+
+void IndexPrefixCounts::_apply(const Deltas& deltas, long long totalDelta) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (!_initialized) {
+        // Reset since the unit of work started, which only the thread rebuilding them can do.
+        return;
+    }
+
+    for (const auto& delta : deltas) {
+        long long& count = _counts[delta.first];
+        count += delta.second;
+        dassert(count >= 0);
+        if (count == 0) {
+            _counts.erase(delta.first);
+        }
+    }
+    _total += totalDelta;
+}
+
+}  // namespace mongo
@@ -0,0 +1,124 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+class OperationContext;
+
+/**
+ * The number of documents in a "counted" index for each value of the index's first field, and
+ * in total, kept up to date by every write to the index so that counts of documents with a
+ * given value need not scan it.
+ *
+ * A document is counted once for each distinct first field value among its keys, so the counts
+ * match an equality query on that field even when the index is multikey.
+ *
+ * The counts start out uninitialized, in which case writes leave them alone. Whoever holds the
+ * collection exclusively builds them with reset(), addDocument() and setInitialized(). After that,
+ * each write adjusts them when its unit of work commits, so they never include uncommitted
+ * writes. Reads and writes are thread safe.
+ */
+class IndexPrefixCounts {
+    MONGO_DISALLOW_COPYING(IndexPrefixCounts);
+
+public:
+    IndexPrefixCounts() = default;
+
+    /**
+     * Discards the counts and marks them uninitialized.
+     */
+    void reset();
+
+    /**
+     * Counts a document with the keys 'keys' right away. Only legal while uninitialized.
+     */
+    void addDocument(const BSONObjSet& keys);
+
+    /**
+     * Starts answering counts and following writes.
+     */
+    void setInitialized();
+
+    bool isInitialized() const;
+
+    /**
+     * Record that a document with the keys 'keys' was inserted into or removed from the index, in
+     * the unit of work of 'txn'.
+     */
+    void recordInsert(OperationContext* txn, const BSONObjSet& keys);
+    void recordRemove(OperationContext* txn, const BSONObjSet& keys);
+
+    /**
+     * Records that a document's keys changed from 'oldKeys' to 'newKeys' in the unit of work of
+     * 'txn'. 'wasIndexed' and 'isIndexed' tell whether the document was in the index before and
+     * after, which only differ for partial indexes.
+     */
+    void recordUpdate(OperationContext* txn,
+                      const BSONObjSet& oldKeys,
+                      bool wasIndexed,
+                      const BSONObjSet& newKeys,
+                      bool isIndexed);
+
+    /**
+     * Returns the number of documents whose keys have 'value' as their first field. Must be
+     * initialized.
+     */
+    long long getCount(const BSONElement& value) const;
+
+    /**
+     * Returns the number of documents in the index. Must be initialized.
+     */
+    long long getTotal() const;
+
+private:
+    class AdjustChange;
+
+    // Maps a first field value, as a BSONObj with a single field named "", to a change in its
+    // count.
+    using Deltas = std::map<BSONObj, long long, BSONObjCmp>;
+
+    static BSONObjSet _prefixesOf(const BSONObjSet& keys);
+
+    void _record(OperationContext* txn, Deltas deltas, long long totalDelta);
+    void _apply(const Deltas& deltas, long long totalDelta);
+
+    mutable stdx::mutex _mutex;
+    bool _initialized = false;
+    Deltas _counts;
+    long long _total = 0;
+};
+
+}  // namespace mongo
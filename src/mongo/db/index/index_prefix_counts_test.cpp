@@ -0,0 +1,144 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/index/index_prefix_counts.h"
+
+#include "mongo/db/operation_context_noop.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+BSONObjSet makeKeys(const std::vector<BSONObj>& keys) {
+    return BSONObjSet(keys.begin(), keys.end());
+}
+
+TEST(IndexPrefixCounts, CountsDocumentsOncePerPrefixValue) {
+    IndexPrefixCounts counts;
+    counts.addDocument(makeKeys({BSON("" << 1 << "" << "a"), BSON("" << 1 << "" << "b")}));
+    counts.addDocument(makeKeys({BSON("" << 1 << "" << "a"), BSON("" << 2 << "" << "a")}));
+    counts.addDocument(makeKeys({BSON("" << 3 << "" << "a")}));
+    counts.setInitialized();
+
+    ASSERT_EQUALS(2, counts.getCount(BSON("" << 1).firstElement()));
+    ASSERT_EQUALS(1, counts.getCount(BSON("" << 2).firstElement()));
+    ASSERT_EQUALS(0, counts.getCount(BSON("" << 4).firstElement()));
+    ASSERT_EQUALS(3, counts.getTotal());
+
+    // Numbers of different types compare equal.
+    ASSERT_EQUALS(2, counts.getCount(BSON("" << 1.0).firstElement()));
+    ASSERT_EQUALS(2, counts.getCount(BSON("" << 1LL).firstElement()));
+}
+
+TEST(IndexPrefixCounts, WritesApplyWhenTheyCommit) {
+    OperationContextNoop txn;
+    IndexPrefixCounts counts;
+    counts.setInitialized();
+    {
+        WriteUnitOfWork wunit(&txn);
+        counts.recordInsert(&txn, makeKeys({BSON("" << "x")}));
+        counts.recordInsert(&txn, makeKeys({BSON("" << "x")}));
+        ASSERT_EQUALS(0, counts.getCount(BSON("" << "x").firstElement()));
+        wunit.commit();
+    }
+    ASSERT_EQUALS(2, counts.getCount(BSON("" << "x").firstElement()));
+
+    {
+        WriteUnitOfWork wunit(&txn);
+        counts.recordRemove(&txn, makeKeys({BSON("" << "x")}));
+    }
+    ASSERT_EQUALS(2, counts.getCount(BSON("" << "x").firstElement()));
+    ASSERT_EQUALS(2, counts.getTotal());
+
+    {
+        WriteUnitOfWork wunit(&txn);
+        counts.recordRemove(&txn, makeKeys({BSON("" << "x")}));
+        wunit.commit();
+    }
+    ASSERT_EQUALS(1, counts.getCount(BSON("" << "x").firstElement()));
+    ASSERT_EQUALS(1, counts.getTotal());
+}
+
+TEST(IndexPrefixCounts, UpdatesMoveDocumentsBetweenValues) {
+    OperationContextNoop txn;
+    IndexPrefixCounts counts;
+    counts.addDocument(makeKeys({BSON("" << 1 << "" << 1)}));
+    counts.setInitialized();
+
+    {
+        WriteUnitOfWork wunit(&txn);
+        // Only the second field changes.
+        const BSONObjSet oldKeys = makeKeys({BSON("" << 1 << "" << 1)});
+        const BSONObjSet newKeys = makeKeys({BSON("" << 1 << "" << 2)});
+        counts.recordUpdate(&txn, oldKeys, true, newKeys, true);
+        wunit.commit();
+    }
+    ASSERT_EQUALS(1, counts.getCount(BSON("" << 1).firstElement()));
+
+    {
+        WriteUnitOfWork wunit(&txn);
+        const BSONObjSet oldKeys = makeKeys({BSON("" << 1 << "" << 2)});
+        const BSONObjSet newKeys = makeKeys({BSON("" << 2 << "" << 2)});
+        counts.recordUpdate(&txn, oldKeys, true, newKeys, true);
+        wunit.commit();
+    }
+    ASSERT_EQUALS(0, counts.getCount(BSON("" << 1).firstElement()));
+    ASSERT_EQUALS(1, counts.getCount(BSON("" << 2).firstElement()));
+    ASSERT_EQUALS(1, counts.getTotal());
+
+    // The document leaves a partial index.
+    {
+        WriteUnitOfWork wunit(&txn);
+        counts.recordUpdate(&txn, makeKeys({BSON("" << 2 << "" << 2)}), true, BSONObjSet(), false);
+        wunit.commit();
+    }
+    ASSERT_EQUALS(0, counts.getCount(BSON("" << 2).firstElement()));
+    ASSERT_EQUALS(0, counts.getTotal());
+}
+
+TEST(IndexPrefixCounts, UninitializedCountsIgnoreWrites) {
+    OperationContextNoop txn;
+    IndexPrefixCounts counts;
+    {
+        WriteUnitOfWork wunit(&txn);
+        counts.recordInsert(&txn, makeKeys({BSON("" << 1)}));
+        wunit.commit();
+    }
+    ASSERT_FALSE(counts.isInitialized());
+    counts.setInitialized();
+    ASSERT_EQUALS(0, counts.getCount(BSON("" << 1).firstElement()));
+    ASSERT_EQUALS(0, counts.getTotal());
+
+    counts.reset();
+    ASSERT_FALSE(counts.isInitialized());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -95,10 +95,11 @@ BSONObj S2AccessMethod::fixSpec(const BSONObj& specObj) {
     uassert(17394,
             str::stream() << "unsupported geo index version { " << kIndexVersionFieldName << " : "
                           << indexVersionElt << " }, only support versions: [" << S2_INDEX_VERSION_1
-                          << "," << S2_INDEX_VERSION_2 << "," << S2_INDEX_VERSION_3 << "]",
+                          << "," << S2_INDEX_VERSION_2 << "," << S2_INDEX_VERSION_3 << ","
+                          << S2_INDEX_VERSION_4 << "]",
             indexVersionElt.isNumber() &&
-                (indexVersion == S2_INDEX_VERSION_3 || indexVersion == S2_INDEX_VERSION_2 ||
-                 indexVersion == S2_INDEX_VERSION_1));
+                (indexVersion == S2_INDEX_VERSION_4 || indexVersion == S2_INDEX_VERSION_3 ||
+                 indexVersion == S2_INDEX_VERSION_2 || indexVersion == S2_INDEX_VERSION_1));
     return specObj;
 }
 
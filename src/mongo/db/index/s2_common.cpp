@@ -32,7 +32,9 @@
 
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/geo/geometry_container.h"
+#include "third_party/s2/s2cell.h"
 #include "third_party/s2/s2cellid.h"
+#include "third_party/s2/s2latlngrect.h"
 #include "third_party/s2/s2regioncoverer.h"
 
 namespace mongo {
@@ -66,6 +68,27 @@ void S2IndexingParams::configureCoverer(const GeometryContainer& geoContainer,
     coverer->set_max_cells(maxCellsInCovering);
 }
 
+void S2IndexingParams::getCovering(const GeometryContainer& geoContainer,
+                                   std::vector<S2CellId>* out) const {
+    S2RegionCoverer coverer;
+    configureCoverer(geoContainer, &coverer);
+
+    const S2Region& region = geoContainer.getS2Region();
+    if (indexVersion < S2_INDEX_VERSION_4 ||
+        geoContainer.getNumS2Vertices() <= kMaxVerticesForExactCovering) {
+        coverer.GetCovering(region, out);
+        return;
+    }
+
+    std::vector<S2CellId> boundCovering;
+    coverer.GetCovering(region.GetRectBound(), &boundCovering);
+    for (const S2CellId& cellId : boundCovering) {
+        if (region.MayIntersect(S2Cell(cellId))) {
+            out->push_back(cellId);
+        }
+    }
+}
+
 BSONObj S2CellIdToIndexKey(const S2CellId& cellId, S2IndexVersion indexVersion) {
     // The range of an unsigned long long is
     // |-----------------|------------------|
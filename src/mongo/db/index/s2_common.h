@@ -29,6 +29,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "mongo/db/jsobj.h"
 
@@ -52,9 +53,18 @@ enum S2IndexVersion {
 
     // The third version of the S2 index, introduced in MongoDB 3.2.0. Introduced
     // performance improvements and changed the key type from string to numeric
-    S2_INDEX_VERSION_3 = 3
+    S2_INDEX_VERSION_3 = 3,
+
+    // The fourth version of the S2 index. Keys are those of version 3, except that geometries with
+    // more than kMaxVerticesForExactCovering vertices are covered through their bounding
+    // rectangle, which is much cheaper than covering them exactly.
+    S2_INDEX_VERSION_4 = 4
 };
 
+// Geometries with more vertices than this are covered through their bounding rectangle in indexes
+// of version S2_INDEX_VERSION_4. See S2IndexingParams::getCovering().
+const size_t kMaxVerticesForExactCovering = 256;
+
 struct S2IndexingParams {
     // Since we take the cartesian product when we generate keys for an insert,
     // we need a cap.
@@ -75,6 +85,17 @@ struct S2IndexingParams {
     std::string toString() const;
 
     void configureCoverer(const GeometryContainer& geoContainer, S2RegionCoverer* coverer) const;
+
+    /**
+     * Appends the cells covering 'geoContainer', which must have been projected into spherical
+     * space, to 'out'.
+     *
+     * Each cell tested while covering a polygon or line costs about as much as checking its
+     * edges, so from version S2_INDEX_VERSION_4 on, a geometry with more than
+     * kMaxVerticesForExactCovering vertices is covered through its bounding rectangle instead,
+     * and just the cells of that covering which may intersect the geometry are kept.
+     */
+    void getCovering(const GeometryContainer& geoContainer, std::vector<S2CellId>* out) const;
 };
 
 BSONObj S2CellIdToIndexKey(const S2CellId& cellId, S2IndexVersion indexVersion);
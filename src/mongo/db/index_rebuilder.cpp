@@ -38,6 +38,7 @@
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/user_name.h"
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/collection_catalog_entry.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_catalog_entry.h"
 #include "mongo/db/catalog/index_create.h"
@@ -57,6 +58,28 @@ using std::string;
 using std::vector;
 
 namespace {
+/**
+ * Returns true if checkNS() has work to do on the collection: it has an index build which the
+ * last shutdown interrupted, or it is an oplog with indexes. Reading only the catalog of the
+ * storage engine leaves databases whose opening was deferred at startup closed.
+ */
+bool needsCheck(OperationContext* txn, StringData ns, const CollectionCatalogEntry* cce) {
+    vector<string> indexNames;
+    cce->getAllIndexes(txn, &indexNames);
+    if (indexNames.empty()) {
+        return false;
+    }
+    if (NamespaceString(ns).isOplog()) {
+        return true;
+    }
+    for (const auto& indexName : indexNames) {
+        if (!cce->isIndexReady(txn, indexName)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void checkNS(OperationContext* txn, const std::list<std::string>& nsToCheck) {
     bool firstTime = true;
     for (std::list<std::string>::const_iterator it = nsToCheck.begin(); it != nsToCheck.end();
@@ -158,10 +181,18 @@ void restartInProgressIndexesFromLastShutdown(OperationContext* txn) {
              dbName < dbNames.end();
              ++dbName) {
             ScopedTransaction scopedXact(txn, MODE_IS);
-            AutoGetDb autoDb(txn, *dbName, MODE_S);
-
-            Database* db = autoDb.getDb();
-            db->getDatabaseCatalogEntry()->getCollectionNamespaces(&collNames);
+            Lock::DBLock dbLock(txn->lockState(), *dbName, MODE_S);
+
+            const DatabaseCatalogEntry* dbEntry =
+                storageEngine->getDatabaseCatalogEntry(txn, *dbName);
+            std::list<std::string> dbCollNames;
+            dbEntry->getCollectionNamespaces(&dbCollNames);
+            for (const auto& ns : dbCollNames) {
+                const CollectionCatalogEntry* cce = dbEntry->getCollectionCatalogEntry(ns);
+                if (cce && needsCheck(txn, ns, cce)) {
+                    collNames.push_back(ns);
+                }
+            }
         }
         checkNS(txn, collNames);
     } catch (const DBException& e) {
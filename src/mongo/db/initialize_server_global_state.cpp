@@ -32,6 +32,7 @@
 
 #include "mongo/db/initialize_server_global_state.h"
 
+#include <algorithm>
 #include <boost/filesystem/operations.hpp>
 #include <iostream>
 #include <memory>
@@ -50,7 +51,9 @@
 #include "mongo/db/auth/authorization_manager_global.h"
 #include "mongo/db/auth/internal_user_auth.h"
 #include "mongo/db/auth/security_key.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/server_options.h"
+#include "mongo/logger/async_appender.h"
 #include "mongo/logger/logger.h"
 #include "mongo/logger/console_appender.h"
 #include "mongo/logger/message_event.h"
@@ -192,6 +195,30 @@ static bool forkServer() {
     return true;
 }
 
+// When true, the server log file or syslog is written by a background thread, so threads that log
+// don't wait for the I/O.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(asyncLogging, bool, false);
+
+// Size of the buffer of log messages waiting for the background thread. When it is full, new
+// messages are dropped, and the number dropped is logged later.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(asyncLoggingBufferSizeBytes, int, 16 * 1024 * 1024);
+
+namespace {
+
+/**
+ * Wraps "appender" in an AsyncAppender if asyncLogging is set.
+ */
+logger::MessageLogDomain::AppenderAutoPtr makeServerLogAppender(
+    logger::MessageLogDomain::AppenderAutoPtr appender) {
+    if (!asyncLogging) {
+        return appender;
+    }
+    return logger::MessageLogDomain::AppenderAutoPtr(new logger::AsyncAppender(
+        std::move(appender), static_cast<size_t>(std::max(asyncLoggingBufferSizeBytes, 0))));
+}
+
+}  // namespace
+
 void forkServerOrDie() {
     if (!forkServer())
         quickExit(EXIT_FAILURE);
@@ -220,8 +247,9 @@ MONGO_INITIALIZER_GENERAL(ServerLogRedirection,
         openlog(strdup(sb.str().c_str()), LOG_PID | LOG_CONS, serverGlobalParams.syslogFacility);
         LogManager* manager = logger::globalLogManager();
         manager->getGlobalDomain()->clearAppenders();
-        manager->getGlobalDomain()->attachAppender(MessageLogDomain::AppenderAutoPtr(
-            new SyslogAppender<MessageEventEphemeral>(new logger::MessageEventWithContextEncoder)));
+        manager->getGlobalDomain()->attachAppender(
+            makeServerLogAppender(MessageLogDomain::AppenderAutoPtr(new SyslogAppender<
+                MessageEventEphemeral>(new logger::MessageEventWithContextEncoder))));
         manager->getNamedDomain("javascriptOutput")
             ->attachAppender(
                 MessageLogDomain::AppenderAutoPtr(new SyslogAppender<MessageEventEphemeral>(
@@ -274,9 +302,9 @@ MONGO_INITIALIZER_GENERAL(ServerLogRedirection,
 
         LogManager* manager = logger::globalLogManager();
         manager->getGlobalDomain()->clearAppenders();
-        manager->getGlobalDomain()->attachAppender(
+        manager->getGlobalDomain()->attachAppender(makeServerLogAppender(
             MessageLogDomain::AppenderAutoPtr(new RotatableFileAppender<MessageEventEphemeral>(
-                new MessageEventDetailsEncoder, writer.getValue())));
+                new MessageEventDetailsEncoder, writer.getValue()))));
         manager->getNamedDomain("javascriptOutput")
             ->attachAppender(
                 MessageLogDomain::AppenderAutoPtr(new RotatableFileAppender<MessageEventEphemeral>(
@@ -82,8 +82,12 @@
 #include "mongo/db/s/sharded_connection_info.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/stats/counters.h"
+#include "mongo/db/stats/query_shape_stats.h"
+#include "mongo/db/stats/resource_usage_stats.h"
+#include "mongo/db/stats/sampling_profiler.h"
 #include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/logger/async_appender.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/rpc/command_reply_builder.h"
@@ -408,6 +412,7 @@ void assembleResponse(OperationContext* txn,
     // before we lock...
     int op = m.operation();
     bool isCommand = false;
+    const long long startCpuMicros = curThreadCpuTimeMicros();
 
     DbMessage dbmsg(m);
 
@@ -490,6 +495,9 @@ void assembleResponse(OperationContext* txn,
     OpDebug& debug = currentOp.debug();
     debug.op = op;
 
+    SamplingProfiler::ScopedOpTag profilerTag(isCommand ? "command" : opToString(op),
+                                              ns ? StringData(ns) : StringData());
+
     long long logThreshold = serverGlobalParams.slowMS;
     LogComponent responseComponent(LogComponent::kQuery);
     if (op == dbInsert || op == dbDelete || op == dbUpdate) {
@@ -581,6 +589,13 @@ void assembleResponse(OperationContext* txn,
     currentOp.ensureStarted();
     currentOp.done();
     debug.executionTime = currentOp.totalTimeMillis();
+    debug.cpuMicros = curThreadCpuTimeMicros() - startCpuMicros;
+
+    {
+        BSONObjBuilder storageStats;
+        txn->recoveryUnit()->appendOperationStats(&storageStats);
+        debug.storageStats = storageStats.obj();
+    }
 
     logThreshold += currentOp.getExpectedLatencyMs();
 
@@ -605,6 +620,11 @@ void assembleResponse(OperationContext* txn,
     }
 
     recordCurOpMetrics(txn);
+    QueryShapeStats::get(txn->getClient()->getServiceContext()).sample(txn);
+    if (!c.isInDirectClient()) {
+        // The usage of the operations run through a direct client is part of the enclosing one.
+        ResourceUsageStats::get(txn->getClient()->getServiceContext()).record(txn);
+    }
     debug.reset();
 }
 
@@ -859,7 +879,7 @@ bool receivedGetMore(OperationContext* txn, DbResponse& dbresponse, Message& m,
     }
 
     bool exhaust = false;
-    QueryResult::View msgdata = 0;
+    Message reply;
     bool isCursorAuthorized = false;
 
     try {
@@ -875,7 +895,7 @@ bool receivedGetMore(OperationContext* txn, DbResponse& dbresponse, Message& m,
             sleepmillis(0);
         }
 
-        msgdata = getMore(txn, ns, ntoreturn, cursorid, &exhaust, &isCursorAuthorized);
+        reply = getMore(txn, ns, ntoreturn, cursorid, &exhaust, &isCursorAuthorized);
     } catch (AssertionException& e) {
         if (isCursorAuthorized) {
             // If a cursor with id 'cursorid' was authorized, it may have been advanced
@@ -898,10 +918,10 @@ bool receivedGetMore(OperationContext* txn, DbResponse& dbresponse, Message& m,
         return false;
     }
 
-    Message* resp = new Message();
-    resp->setData(msgdata.view2ptr(), true);
+    Message* resp = new Message(std::move(reply));
+    QueryResult::View qr = resp->header().view2ptr();
     curop.debug().responseLength = resp->header().dataLen();
-    curop.debug().nreturned = msgdata.getNReturned();
+    curop.debug().nreturned = qr.getNReturned();
 
     dbresponse.response = resp;
     dbresponse.responseTo = m.header().getId();
@@ -1289,6 +1309,7 @@ NOINLINE_DECL void dbexit(ExitCode rc, const char* why) {
     }
 #endif
 
+    logger::AsyncAppender::flushAllAndWriteSynchronously();
     quickExit(rc);
 }
 
@@ -0,0 +1,95 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <memory>
+#include <utility>
+
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/matcher/matchable.h"
+#include "mongo/unittest/benchmark.h"
+
+namespace {
+
+using namespace mongo;
+using unittest::BenchmarkState;
+using unittest::doNotOptimizeAway;
+
+const char kDocument[] =
+    "{_id: 1, a: 5, b: 'string', c: {d: 10, e: [1, 2, 3]}, "
+    "f: [{g: 1, h: 'x'}, {g: 2, h: 'y'}, {g: 3, h: 'z'}]}";
+
+std::unique_ptr<MatchExpression> parse(const char* filter) {
+    StatusWithMatchExpression status = MatchExpressionParser::parse(fromjson(filter));
+    invariant(status.isOK());
+    return std::move(status.getValue());
+}
+
+void runMatches(BenchmarkState& state, const char* filter) {
+    const std::unique_ptr<MatchExpression> expr = parse(filter);
+    const BSONObj obj = fromjson(kDocument);
+    const BSONMatchableDocument doc(obj);
+    invariant(expr->matches(&doc));
+
+    while (state.keepRunning()) {
+        doNotOptimizeAway(expr->matches(&doc));
+    }
+}
+
+MONGO_BENCHMARK(MatchEquality) {
+    runMatches(state, "{a: 5}");
+}
+
+MONGO_BENCHMARK(MatchDottedPath) {
+    runMatches(state, "{'c.d': {$gte: 10}}");
+}
+
+MONGO_BENCHMARK(MatchAndOfComparisons) {
+    runMatches(state, "{a: {$gt: 1, $lt: 10}, b: {$in: ['other', 'string']}, 'c.e': 2}");
+}
+
+MONGO_BENCHMARK(MatchOr) {
+    runMatches(state, "{$or: [{a: 1}, {b: 'other'}, {'c.d': 10}]}");
+}
+
+MONGO_BENCHMARK(MatchElemMatch) {
+    runMatches(state, "{f: {$elemMatch: {g: {$gte: 3}, h: 'z'}}}");
+}
+
+MONGO_BENCHMARK(MatchExpressionParse) {
+    const BSONObj filter = fromjson("{a: {$gt: 1, $lt: 10}, b: {$in: ['other', 'string']}}");
+    while (state.keepRunning()) {
+        StatusWithMatchExpression status = MatchExpressionParser::parse(filter);
+        doNotOptimizeAway(status);
+    }
+}
+
+}  // namespace
@@ -30,8 +30,12 @@
 
 #include "mongo/db/matcher/expression_leaf.h"
 
+#include <cctype>
 #include <cmath>
+#include <cstring>
+#include <map>
 #include <unordered_map>
+#include <utility>
 #include <pcrecpp.h>
 
 #include "mongo/bson/bsonobj.h"
@@ -41,6 +45,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/path.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
 
 namespace mongo {
 
@@ -244,6 +249,165 @@ inline pcrecpp::RE_Options flags2options(const char* flags) {
     return options;
 }
 
+namespace {
+
+/**
+ * Returns the compiled form of the pattern 'regex' with 'flags'. A compiled pattern can be
+ * matched by many threads at once, so queries which use the same regex share one rather than
+ * each compiling it again.
+ */
+std::shared_ptr<const pcrecpp::RE> getCompiledRegex(const std::string& regex,
+                                                    const std::string& flags) {
+    typedef std::map<std::pair<std::string, std::string>, std::shared_ptr<const pcrecpp::RE>>
+        RegexCache;
+    static const size_t kMaxCachedRegexes = 1000;
+    static stdx::mutex mutex;
+    static RegexCache cache;
+
+    const RegexCache::key_type key(regex, flags);
+    stdx::lock_guard<stdx::mutex> lk(mutex);
+    RegexCache::const_iterator it = cache.find(key);
+    if (it != cache.end())
+        return it->second;
+
+    // Expressions hold on to the patterns they use, so it is safe to start over when full.
+    if (cache.size() >= kMaxCachedRegexes)
+        cache.clear();
+
+    std::shared_ptr<const pcrecpp::RE> re =
+        std::make_shared<pcrecpp::RE>(regex.c_str(), flags2options(flags.c_str()));
+    cache[key] = re;
+    return re;
+}
+
+/**
+ * Returns the longest run of characters which every string matched by the pattern 'regex' with
+ * 'flags' must contain, or the empty string if none can be found. Only a conservative subset
+ * of the pattern syntax is understood: anything else either ends a run or, where it could
+ * change the meaning of the rest of the pattern, gives up altogether.
+ */
+std::string findRequiredLiteral(StringData regex, StringData flags) {
+    // Case folding and extended mode both change which characters match literally.
+    if (flags.find('i') != std::string::npos || flags.find('x') != std::string::npos)
+        return std::string();
+
+    std::string best;
+    std::string run;
+    int depth = 0;
+
+    const auto endRun = [&]() {
+        if (run.size() > best.size())
+            best = run;
+        run.clear();
+    };
+
+    // Drops the last character of the run, which a quantifier has made optional. Patterns are
+    // UTF-8, so this may be several bytes.
+    const auto dropLastCharacter = [&]() {
+        while (!run.empty()) {
+            const bool continuation = (run.back() & 0xC0) == 0x80;
+            run.erase(run.size() - 1);
+            if (!continuation)
+                break;
+        }
+    };
+
+    const size_t size = regex.size();
+    for (size_t i = 0; i < size; ++i) {
+        const char c = regex[i];
+        switch (c) {
+            case '\\': {
+                if (++i == size)
+                    return std::string();
+                const char escaped = regex[i];
+                if (!isalnum(static_cast<unsigned char>(escaped))) {
+                    if (depth == 0)
+                        run.push_back(escaped);
+                    break;
+                }
+                // Escapes for a class of characters or an assertion just end the run. Others,
+                // like backreferences, character codes and \Q...\E quoting, are not worth
+                // understanding here.
+                if (!strchr("dDwWsSbBAzZGhHvVR", escaped))
+                    return std::string();
+                endRun();
+                break;
+            }
+            case '[': {
+                endRun();
+                if (++i < size && regex[i] == '^')
+                    ++i;
+                if (i < size && regex[i] == ']')
+                    ++i;
+                for (; i < size && regex[i] != ']'; ++i) {
+                    if (regex[i] == '\\') {
+                        ++i;
+                    } else if (regex[i] == '[' && i + 1 < size &&
+                               strchr(":.=", regex[i + 1])) {
+                        // A POSIX class like [:alpha:], which ends with its own ']'.
+                        const char delimiter = regex[i + 1];
+                        for (i += 2; i + 1 < size; ++i) {
+                            if (regex[i] == delimiter && regex[i + 1] == ']')
+                                break;
+                        }
+                        ++i;
+                    }
+                }
+                if (i >= size)
+                    return std::string();
+                break;
+            }
+            case '(':
+                // Groups with options, like (?i), can change the meaning of what follows them.
+                if (i + 1 < size && regex[i + 1] == '?' && (i + 2 == size || regex[i + 2] != ':'))
+                    return std::string();
+                endRun();
+                ++depth;
+                break;
+            case ')':
+                endRun();
+                if (--depth < 0)
+                    return std::string();
+                break;
+            case '|':
+                if (depth == 0)
+                    return std::string();
+                break;
+            case '{':
+                // Either a quantifier like {0,2}, or a literal brace, which we treat as one.
+                dropLastCharacter();
+                endRun();
+                while (i < size && regex[i] != '}')
+                    ++i;
+                if (i == size)
+                    return std::string();
+                break;
+            case '?':
+            case '*':
+                dropLastCharacter();
+                endRun();
+                break;
+            case '+':
+            case '.':
+            case '^':
+            case '$':
+                endRun();
+                break;
+            default:
+                if (depth == 0)
+                    run.push_back(c);
+                break;
+        }
+    }
+
+    if (depth != 0)
+        return std::string();
+    endRun();
+    return best;
+}
+
+}  // namespace
+
 RegexMatchExpression::RegexMatchExpression() : LeafMatchExpression(REGEX) {}
 
 RegexMatchExpression::~RegexMatchExpression() {}
@@ -272,7 +436,10 @@ Status RegexMatchExpression::init(StringData path, StringData regex, StringData
 
     _regex = regex.toString();
     _flags = options.toString();
-    _re.reset(new pcrecpp::RE(_regex.c_str(), flags2options(_flags.c_str())));
+    _re = getCompiledRegex(_regex, _flags);
+    _requiredLiteral.clear();
+    if (_re->error().empty())
+        _requiredLiteral = findRequiredLiteral(_regex, _flags);
 
     return initPath(path);
 }
@@ -283,11 +450,12 @@ bool RegexMatchExpression::matchesSingleElement(const BSONElement& e) const {
     switch (e.type()) {
         case String:
         case Symbol:
-            // TODO
-            // if (rm._prefix.empty())
+            if (!_requiredLiteral.empty() &&
+                StringData(e.valuestr(), e.valuestrsize() - 1).find(_requiredLiteral) ==
+                    std::string::npos) {
+                return false;
+            }
             return _re->PartialMatch(e.valuestr());
-        // else
-        // return !strncmp(e.valuestr(), rm._prefix.c_str(), rm._prefix.size());
         case RegEx:
             return _regex == e.regex() && _flags == e.regexFlags();
         default:
@@ -534,6 +702,7 @@ Status ArrayFilterEntries::addEquality(const BSONElement& e) {
         _hasEmptyArray = true;
 
     _equalities.insert(e);
+    _hashedEqualities.insert(e);
     return Status::OK();
 }
 
@@ -559,6 +728,7 @@ void ArrayFilterEntries::copyTo(ArrayFilterEntries& toFillIn) const {
     toFillIn._hasNull = _hasNull;
     toFillIn._hasEmptyArray = _hasEmptyArray;
     toFillIn._equalities = _equalities;
+    toFillIn._hashedEqualities = _hashedEqualities;
     for (unsigned i = 0; i < _regexes.size(); i++)
         toFillIn._regexes.push_back(
             static_cast<RegexMatchExpression*>(_regexes[i]->shallowClone().release()));
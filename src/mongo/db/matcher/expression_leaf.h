@@ -30,7 +30,9 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonmisc.h"
@@ -226,7 +228,13 @@ public:
 private:
     std::string _regex;
     std::string _flags;
-    std::unique_ptr<pcrecpp::RE> _re;
+
+    // Compiled patterns are shared by all the expressions with the same pattern and flags.
+    std::shared_ptr<const pcrecpp::RE> _re;
+
+    // A run of characters which every matching string must contain, if one could be found in
+    // the pattern. Strings without it are rejected without running the regex.
+    std::string _requiredLiteral;
 };
 
 class ModMatchExpression : public LeafMatchExpression {
@@ -308,7 +316,7 @@ public:
         return _equalities;
     }
     bool contains(const BSONElement& elem) const {
-        return _equalities.count(elem) > 0;
+        return _hashedEqualities.count(elem) > 0;
     }
 
     size_t numRegexes() const {
@@ -343,6 +351,12 @@ private:
     bool _hasNull;  // if _equalities has a jstNULL element in it
     bool _hasEmptyArray;
     BSONElementSet _equalities;
+
+    // The same elements as _equalities, for contains() to look up without a walk of comparisons.
+    // The ordered set is kept for equalities(), which callers such as index bounds building use.
+    std::unordered_set<BSONElement, BSONElement::HasherWithoutField, BSONElementEqualWithoutField>
+        _hashedEqualities;
+
     std::vector<RegexMatchExpression*> _regexes;
 };
 
@@ -1075,6 +1075,55 @@ TEST(RegexMatchExpression, MatchesElementUtf8) {
     ASSERT(regex.matchesSingleElement(multiByteCharacter.firstElement()));
 }
 
+TEST(RegexMatchExpression, MatchesElementRequiredLiteral) {
+    // Strings without a literal run that the pattern requires are rejected before running the
+    // regex, so these check that only runs which really are required are used.
+    struct {
+        const char* pattern;
+        const char* flags;
+        const char* value;
+        bool matches;
+    } cases[] = {
+        {"abc", "", "xxabxabcx", true},
+        {"abc", "", "xxabxacbx", false},
+        {"ab?c", "", "ac", true},
+        {"ab*c", "", "ac", true},
+        {"ab{0,2}c", "", "ac", true},
+        {"a{2}", "", "aa", true},
+        {"ab+c", "", "abbbc", true},
+        {"a(bc)?d", "", "ad", true},
+        {"a(?:b|c)d", "", "acd", true},
+        {"x|abc", "", "x", true},
+        {"a[bc]d", "", "acd", true},
+        {"a[[:alpha:]xyz]", "", "ab", true},
+        {"a[]b]c", "", "a]c", true},
+        {"a\\.b", "", "a.b", true},
+        {"a\\.b", "", "axb", false},
+        {"a\\.?b", "", "ab", true},
+        {"\\d+abc", "", "12abc", true},
+        {"\\x41bc", "", "Abc", true},
+        {"\\Qa.c\\E", "", "a.c", true},
+        {"\\Qa.c\\E", "", "abc", false},
+        {"(?i)abc", "", "ABC", true},
+        {"abc", "i", "ABC", true},
+        {"a b c", "x", "abc", true},
+        {"caf\xc3\xa9?s", "", "cafs", true},
+        {"^abc", "", "xabc", false},
+        {"^abc", "m", "x\nabc", true},
+        {"abc$", "", "xabc", true},
+    };
+
+    for (const auto& c : cases) {
+        RegexMatchExpression regex;
+        ASSERT_OK(regex.init("", c.pattern, c.flags));
+        BSONObj obj = BSON("x" << c.value);
+        if (regex.matchesSingleElement(obj.firstElement()) != c.matches) {
+            FAIL("wrong result") << " for /" << c.pattern << "/" << c.flags << " on '" << c.value
+                                 << "'";
+        }
+    }
+}
+
 TEST(RegexMatchExpression, MatchesScalar) {
     RegexMatchExpression regex;
     ASSERT(regex.init("a", "b", "").isOK());
@@ -1544,6 +1593,30 @@ TEST(InMatchExpression, MatchesElementMultiple) {
 }
 
 
+TEST(InMatchExpression, MatchesEqualValuesOfOtherTypes) {
+    BSONObj operand = BSON_ARRAY(1 << (1LL << 40) << 2.5 << -0.0
+                                   << std::numeric_limits<double>::quiet_NaN() << "r"
+                                   << BSON("x" << 1) << BSON_ARRAY(1 << 2));
+    InMatchExpression in;
+    BSONForEach(elem, operand) {
+        in.getArrayFilterEntries()->addEquality(elem);
+    }
+
+    BSONObj matches = BSON_ARRAY(1.0 << 1LL << static_cast<double>(1LL << 40) << 2.5 << 0
+                                     << std::numeric_limits<double>::signaling_NaN()
+                                     << BSONSymbol("r") << BSON("x" << 1.0)
+                                     << BSON_ARRAY(1LL << 2.0));
+    BSONForEach(elem, matches) {
+        ASSERT(in.matchesSingleElement(elem));
+    }
+
+    BSONObj notMatches = BSON_ARRAY(2 << 2.4 << "R" << BSON("y" << 1) << BSON_ARRAY(2 << 1)
+                                      << BSONCode("r") << true);
+    BSONForEach(elem, notMatches) {
+        ASSERT(!in.matchesSingleElement(elem));
+    }
+}
+
 TEST(InMatchExpression, MatchesScalar) {
     BSONObj operand = BSON_ARRAY(5);
     InMatchExpression in;
@@ -33,9 +33,17 @@
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonmisc.h"
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/matcher/matchable.h"
+#include "mongo/db/matcher/path.h"
 
 namespace mongo {
 
+namespace {
+// The fewest distinct top-level fields an $and's children must read from a BSON document before
+// it finds them all in one pass over the document instead of letting each child scan for its own.
+const size_t kMinTopLevelFieldsForSinglePass = 3;
+}  // namespace
+
 ListOfMatchExpression::~ListOfMatchExpression() {
     for (unsigned i = 0; i < _expressions.size(); i++)
         delete _expressions[i];
@@ -81,6 +89,27 @@ bool ListOfMatchExpression::equivalent(const MatchExpression* other) const {
 // -----
 
 bool AndMatchExpression::matches(const MatchableDocument* doc, MatchDetails* details) const {
+    BSONObj obj;
+    if (numChildren() >= kMinTopLevelFieldsForSinglePass && doc->iteratesOverBSON(&obj)) {
+        TopLevelFields fields;
+        for (size_t i = 0; i < numChildren(); i++) {
+            const StringData path = getChild(i)->path();
+            if (!path.empty())
+                fields.addPath(path);
+        }
+
+        if (fields.numFields() >= kMinTopLevelFieldsForSinglePass) {
+            fields.find(obj);
+            BSONMatchableDocument withFields(obj, &fields);
+            return matchesChildren(&withFields, details);
+        }
+    }
+
+    return matchesChildren(doc, details);
+}
+
+bool AndMatchExpression::matchesChildren(const MatchableDocument* doc,
+                                         MatchDetails* details) const {
     for (size_t i = 0; i < numChildren(); i++) {
         if (!getChild(i)->matches(doc, details)) {
             if (details)
@@ -102,6 +102,12 @@ public:
     virtual void debugString(StringBuilder& debug, int level = 0) const;
 
     virtual void toBSON(BSONObjBuilder* out) const;
+
+private:
+    /**
+     * Returns true if 'doc' matches every child, without finding their fields in advance.
+     */
+    bool matchesChildren(const MatchableDocument* doc, MatchDetails* details) const;
 };
 
 class OrMatchExpression : public ListOfMatchExpression {
@@ -187,6 +187,37 @@ TEST(AndOp, MatchesThreeClauses) {
     ASSERT(!andOp.matchesBSON(BSON("a" << 10 << "b" << 6), NULL));
 }
 
+TEST(AndOp, MatchesClausesOnManyFields) {
+    BSONObj operands = BSON("a" << 1 << "b" << 2 << "c" << 3 << "d" << BSONNULL);
+
+    AndMatchExpression andOp;
+    const char* paths[] = {"a", "b.x", "c", "d"};
+    for (const char* path : paths) {
+        unique_ptr<ComparisonMatchExpression> eq(new EqualityMatchExpression());
+        ASSERT(eq->init(path, operands[StringData(path, 1)]).isOK());
+        andOp.add(eq.release());
+    }
+
+    ASSERT(andOp.matchesBSON(BSON("c" << 3 << "b" << BSON("x" << 2) << "a" << 1), NULL));
+    ASSERT(andOp.matchesBSON(
+        BSON("a" << BSON_ARRAY(0 << 1) << "b" << BSON_ARRAY(BSON("x" << 2)) << "c" << 3 << "d"
+                 << BSONNULL << "e" << 5),
+        NULL));
+    ASSERT(!andOp.matchesBSON(BSON("a" << 1 << "b" << BSON("x" << 2) << "c" << 3 << "d" << 4),
+                              NULL));
+    ASSERT(!andOp.matchesBSON(BSON("a" << 1 << "b" << 2 << "c" << 3), NULL));
+    // Only the first of several fields with the same name is matched, as with a single clause.
+    ASSERT(!andOp.matchesBSON(BSON("a" << 0 << "b" << BSON("x" << 2) << "c" << 3 << "a" << 1),
+                              NULL));
+
+    MatchDetails details;
+    details.requestElemMatchKey();
+    ASSERT(andOp.matchesBSON(
+        BSON("a" << 1 << "b" << BSON("x" << 2) << "c" << BSON_ARRAY(4 << 3)), &details));
+    ASSERT(details.hasElemMatchKey());
+    ASSERT_EQUALS("1", details.elemMatchKey());
+}
+
 TEST(AndOp, ElemMatchKey) {
     BSONObj baseOperand1 = BSON("a" << 1);
     BSONObj baseOperand2 = BSON("b" << 2);
@@ -29,12 +29,19 @@
  */
 
 #include "mongo/platform/basic.h"
+#include "mongo/bson/bson_field_offsets.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/matchable.h"
 
 namespace mongo {
 
-BSONMatchableDocument::BSONMatchableDocument(const BSONObj& obj) : _obj(obj) {
+BSONMatchableDocument::BSONMatchableDocument(const BSONObj& obj, const TopLevelFields* fields)
+    : _obj(obj), _fields(fields), _offsets(NULL) {
+    _iteratorUsed = false;
+}
+
+BSONMatchableDocument::BSONMatchableDocument(const BSONFieldOffsets& offsets)
+    : _obj(offsets.obj()), _fields(NULL), _offsets(&offsets) {
     _iteratorUsed = false;
 }
 
@@ -44,6 +44,14 @@ public:
 
     virtual BSONObj toBSON() const = 0;
 
+    /**
+     * Returns true and sets 'obj' if this document is iterated as BSON, so that a
+     * BSONMatchableDocument over 'obj' matches the same as this one does.
+     */
+    virtual bool iteratesOverBSON(BSONObj* obj) const {
+        return false;
+    }
+
     /**
      * The neewly returned ElementIterator is allowed to keep a pointer to path.
      * So the caller of this function should make sure path is in scope until
@@ -76,18 +84,33 @@ public:
 
 class BSONMatchableDocument : public MatchableDocument {
 public:
-    BSONMatchableDocument(const BSONObj& obj);
+    /**
+     * If 'fields' is not NULL, iterators take the fields it holds from there. It must have been
+     * found in 'obj' and outlive this object.
+     */
+    BSONMatchableDocument(const BSONObj& obj, const TopLevelFields* fields = NULL);
+
+    /**
+     * Matches offsets.obj(), looking its top-level fields up in 'offsets', which must outlive
+     * this object.
+     */
+    explicit BSONMatchableDocument(const BSONFieldOffsets& offsets);
     virtual ~BSONMatchableDocument();
 
     virtual BSONObj toBSON() const {
         return _obj;
     }
 
+    virtual bool iteratesOverBSON(BSONObj* obj) const {
+        *obj = _obj;
+        return true;
+    }
+
     virtual ElementIterator* allocateIterator(const ElementPath* path) const {
         if (_iteratorUsed)
-            return new BSONElementIterator(path, _obj);
+            return new BSONElementIterator(path, _obj, _fields, _offsets);
         _iteratorUsed = true;
-        _iterator.reset(path, _obj);
+        _iterator.reset(path, _obj, _fields, _offsets);
         return &_iterator;
     }
 
@@ -101,6 +124,8 @@ public:
 
 private:
     BSONObj _obj;
+    const TopLevelFields* _fields;
+    const BSONFieldOffsets* _offsets;
     mutable BSONElementIterator _iterator;
     mutable bool _iteratorUsed;
 };
@@ -29,6 +29,10 @@
  */
 
 #include "mongo/platform/basic.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bson_field_offsets.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/path_internal.h"
 #include "mongo/db/matcher/path.h"
@@ -44,6 +48,67 @@ Status ElementPath::init(StringData path) {
 
 // -----
 
+void TopLevelFields::addPath(StringData path) {
+    invariant(!_sorted);
+    const StringData fieldName = path.substr(0, path.find('.'));
+    for (size_t i = 0; i < _fields.size(); ++i) {
+        if (_fields[i].first == fieldName)
+            return;
+    }
+    _fields.push_back(std::make_pair(fieldName, BSONElement()));
+}
+
+size_t TopLevelFields::numFields() const {
+    return _fields.size();
+}
+
+namespace {
+bool fieldNameLess(const std::pair<StringData, BSONElement>& field, StringData name) {
+    return field.first < name;
+}
+
+bool fieldLess(const std::pair<StringData, BSONElement>& lhs,
+               const std::pair<StringData, BSONElement>& rhs) {
+    return lhs.first < rhs.first;
+}
+}  // namespace
+
+void TopLevelFields::find(const BSONObj& doc) {
+    if (!_sorted) {
+        std::sort(_fields.begin(), _fields.end(), fieldLess);
+        _sorted = true;
+    }
+
+    for (size_t i = 0; i < _fields.size(); ++i) {
+        _fields[i].second = BSONElement();
+    }
+
+    // Like BSONObj::getField(), take the first of any fields with the same name, and stop once
+    // every requested field has been seen.
+    size_t numFound = 0;
+    BSONObjIterator it(doc);
+    while (numFound < _fields.size() && it.more()) {
+        BSONElement e = it.next();
+        auto field = std::lower_bound(
+            _fields.begin(), _fields.end(), e.fieldNameStringData(), fieldNameLess);
+        if (field != _fields.end() && field->first == e.fieldNameStringData() &&
+            field->second.eoo()) {
+            field->second = e;
+            ++numFound;
+        }
+    }
+}
+
+const BSONElement* TopLevelFields::get(StringData fieldName) const {
+    dassert(_sorted);
+    auto field = std::lower_bound(_fields.begin(), _fields.end(), fieldName, fieldNameLess);
+    if (field == _fields.end() || field->first != fieldName)
+        return NULL;
+    return &field->second;
+}
+
+// -----
+
 ElementIterator::~ElementIterator() {}
 
 void ElementIterator::Context::reset() {
@@ -85,19 +150,29 @@ ElementIterator::Context SimpleArrayElementIterator::next() {
 // ------
 BSONElementIterator::BSONElementIterator() {
     _path = NULL;
+    _fields = NULL;
+    _offsets = NULL;
 }
 
-BSONElementIterator::BSONElementIterator(const ElementPath* path, const BSONObj& context)
-    : _path(path), _context(context) {
+BSONElementIterator::BSONElementIterator(const ElementPath* path,
+                                         const BSONObj& context,
+                                         const TopLevelFields* fields,
+                                         const BSONFieldOffsets* offsets)
+    : _path(path), _context(context), _fields(fields), _offsets(offsets) {
     _state = BEGIN;
     // log() << "path: " << path.fieldRef().dottedField() << " context: " << context << endl;
 }
 
 BSONElementIterator::~BSONElementIterator() {}
 
-void BSONElementIterator::reset(const ElementPath* path, const BSONObj& context) {
+void BSONElementIterator::reset(const ElementPath* path,
+                                const BSONObj& context,
+                                const TopLevelFields* fields,
+                                const BSONFieldOffsets* offsets) {
     _path = path;
     _context = context;
+    _fields = fields;
+    _offsets = offsets;
     _state = BEGIN;
     _next.reset();
 
@@ -192,7 +267,20 @@ bool BSONElementIterator::more() {
 
     if (_state == BEGIN) {
         size_t idxPath = 0;
-        BSONElement e = getFieldDottedOrArray(_context, _path->fieldRef(), &idxPath);
+        const BSONElement* first = NULL;
+        BSONElement firstFromOffsets;
+        if (_path->fieldRef().numParts() > 0) {
+            if (_fields) {
+                first = _fields->get(_path->fieldRef().getPart(0));
+            }
+            if (!first && _offsets) {
+                firstFromOffsets = _offsets->getField(_path->fieldRef().getPart(0));
+                first = &firstFromOffsets;
+            }
+        }
+        BSONElement e = first
+            ? getFieldDottedOrArray(_context, _path->fieldRef(), &idxPath, *first)
+            : getFieldDottedOrArray(_context, _path->fieldRef(), &idxPath);
 
         if (e.type() != Array) {
             _next.reset(e, BSONElement(), false);
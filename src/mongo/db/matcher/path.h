@@ -31,6 +31,9 @@
 #pragma once
 
 
+#include <utility>
+#include <vector>
+
 #include "mongo/base/status.h"
 #include "mongo/base/string_data.h"
 #include "mongo/bson/bsonobj.h"
@@ -38,6 +41,8 @@
 
 namespace mongo {
 
+class BSONFieldOffsets;
+
 class ElementPath {
 public:
     Status init(StringData path);
@@ -65,6 +70,41 @@ private:
     bool _shouldTraverseLeafArray;
 };
 
+/**
+ * The top-level fields of a document that a set of paths start with, found in a single pass over
+ * the document. A BSONElementIterator given one of these takes the first element of its path from
+ * here instead of scanning the document for it, so that many paths into a large document do not
+ * each scan it from the start.
+ */
+class TopLevelFields {
+public:
+    /**
+     * Requests the top-level field that 'path' starts with. Must be called before find().
+     */
+    void addPath(StringData path);
+
+    /**
+     * Returns the number of distinct top-level fields requested.
+     */
+    size_t numFields() const;
+
+    /**
+     * Looks up every requested field in 'doc', which must outlive this object, in one pass.
+     */
+    void find(const BSONObj& doc);
+
+    /**
+     * Returns the element named 'fieldName' in the document given to find(), which is EOO if the
+     * document has no such field, or NULL if 'fieldName' was not requested.
+     */
+    const BSONElement* get(StringData fieldName) const;
+
+private:
+    // Distinct field names, sorted once find() has been called.
+    std::vector<std::pair<StringData, BSONElement>> _fields;
+    bool _sorted = false;
+};
+
 class ElementIterator {
 public:
     class Context {
@@ -137,11 +177,22 @@ private:
 class BSONElementIterator : public ElementIterator {
 public:
     BSONElementIterator();
-    BSONElementIterator(const ElementPath* path, const BSONObj& context);
+    /**
+     * If 'fields' is not NULL, it must have been found in 'context' and outlive this iterator.
+     * Likewise, if 'offsets' is not NULL, it must be built over 'context' and outlive this
+     * iterator; the first element of the path is looked up there when 'fields' lacks it.
+     */
+    BSONElementIterator(const ElementPath* path,
+                        const BSONObj& context,
+                        const TopLevelFields* fields = NULL,
+                        const BSONFieldOffsets* offsets = NULL);
 
     virtual ~BSONElementIterator();
 
-    void reset(const ElementPath* path, const BSONObj& context);
+    void reset(const ElementPath* path,
+               const BSONObj& context,
+               const TopLevelFields* fields = NULL,
+               const BSONFieldOffsets* offsets = NULL);
 
     bool more();
     Context next();
@@ -155,6 +206,8 @@ private:
 
     const ElementPath* _path;
     BSONObj _context;
+    const TopLevelFields* _fields;
+    const BSONFieldOffsets* _offsets;
 
     enum State { BEGIN, IN_ARRAY, DONE } _state;
     Context _next;
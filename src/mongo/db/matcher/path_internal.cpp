@@ -40,17 +40,18 @@ bool isAllDigits(StringData str) {
     return true;
 }
 
-BSONElement getFieldDottedOrArray(const BSONObj& doc, const FieldRef& path, size_t* idxPath) {
-    if (path.numParts() == 0)
-        return doc.getField("");
-
+namespace {
+BSONElement getFieldDottedOrArrayImpl(const BSONObj& doc,
+                                      const FieldRef& path,
+                                      size_t* idxPath,
+                                      const BSONElement* first) {
     BSONElement res;
 
     BSONObj curr = doc;
     bool stop = false;
     size_t partNum = 0;
     while (partNum < path.numParts() && !stop) {
-        res = curr.getField(path.getPart(partNum));
+        res = (partNum == 0 && first) ? *first : curr.getField(path.getPart(partNum));
 
         switch (res.type()) {
             case EOO:
@@ -77,6 +78,22 @@ BSONElement getFieldDottedOrArray(const BSONObj& doc, const FieldRef& path, size
     *idxPath = partNum;
     return res;
 }
+}  // namespace
+
+BSONElement getFieldDottedOrArray(const BSONObj& doc, const FieldRef& path, size_t* idxPath) {
+    if (path.numParts() == 0)
+        return doc.getField("");
+
+    return getFieldDottedOrArrayImpl(doc, path, idxPath, NULL);
+}
+
+BSONElement getFieldDottedOrArray(const BSONObj& doc,
+                                  const FieldRef& path,
+                                  size_t* idxPath,
+                                  BSONElement first) {
+    invariant(path.numParts() > 0);
+    return getFieldDottedOrArrayImpl(doc, path, idxPath, &first);
+}
 
 
 }  // namespace mongo
@@ -44,4 +44,11 @@ bool isAllDigits(StringData str);
 // Replaces getFieldDottedOrArray without recursion nor std::string manipulation
 BSONElement getFieldDottedOrArray(const BSONObj& doc, const FieldRef& path, size_t* idxPath);
 
+// Like the above, but starts from 'first', the element of 'doc' named by the first part of 'path'
+// (EOO if there is none), rather than looking it up. 'path' must have at least one part.
+BSONElement getFieldDottedOrArray(const BSONObj& doc,
+                                  const FieldRef& path,
+                                  size_t* idxPath,
+                                  BSONElement first);
+
 }  // namespace mongo
@@ -31,6 +31,7 @@
 
 #include "mongo/unittest/unittest.h"
 
+#include "mongo/bson/bson_field_offsets.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/path.h"
@@ -418,6 +419,64 @@ TEST(Path, ArrayOffsetWithImplicitAndExplicitTraversal) {
     ASSERT(!cursor.more());
 }
 
+TEST(Path, TopLevelFieldsGivesSameElements) {
+    BSONObj doc = fromjson("{x: 1, a: {b: [{c: 1}, {c: 2}]}, y: [3, 4], x: 5}");
+
+    TopLevelFields fields;
+    fields.addPath("a.b.c");
+    fields.addPath("y");
+    fields.addPath("x");
+    fields.addPath("missing.z");
+    fields.addPath("a");
+    ASSERT_EQUALS(4U, fields.numFields());
+    fields.find(doc);
+
+    ASSERT_EQUALS(1, fields.get("x")->numberInt());
+    ASSERT(fields.get("missing")->eoo());
+    ASSERT(fields.get("z") == NULL);
+
+    const char* paths[] = {"a.b.c", "a.b.1.c", "y", "y.0", "x", "missing.z", "z"};
+    for (const char* path : paths) {
+        ElementPath p;
+        ASSERT(p.init(path).isOK());
+
+        BSONElementIterator withoutFields(&p, doc);
+        BSONElementIterator withFields(&p, doc, &fields);
+        while (withoutFields.more()) {
+            ASSERT(withFields.more());
+            ElementIterator::Context expected = withoutFields.next();
+            ElementIterator::Context actual = withFields.next();
+            ASSERT_EQUALS(expected.element().rawdata(), actual.element().rawdata());
+            ASSERT_EQUALS(expected.arrayOffset().rawdata(), actual.arrayOffset().rawdata());
+            ASSERT_EQUALS(expected.outerArray(), actual.outerArray());
+        }
+        ASSERT(!withFields.more());
+    }
+}
+
+TEST(Path, BSONFieldOffsetsGivesSameElements) {
+    BSONObj doc = fromjson("{x: 1, a: {b: [{c: 1}, {c: 2}]}, y: [3, 4], x: 5}");
+    BSONFieldOffsets offsets(doc);
+
+    const char* paths[] = {"a.b.c", "a.b.1.c", "y", "y.0", "x", "missing.z", "z"};
+    for (const char* path : paths) {
+        ElementPath p;
+        ASSERT(p.init(path).isOK());
+
+        BSONElementIterator withoutOffsets(&p, doc);
+        BSONElementIterator withOffsets(&p, doc, NULL, &offsets);
+        while (withoutOffsets.more()) {
+            ASSERT(withOffsets.more());
+            ElementIterator::Context expected = withoutOffsets.next();
+            ElementIterator::Context actual = withOffsets.next();
+            ASSERT_EQUALS(expected.element().rawdata(), actual.element().rawdata());
+            ASSERT_EQUALS(expected.arrayOffset().rawdata(), actual.arrayOffset().rawdata());
+            ASSERT_EQUALS(expected.outerArray(), actual.outerArray());
+        }
+        ASSERT(!withOffsets.more());
+    }
+}
+
 TEST(SimpleArrayElementIterator, SimpleNoArrayLast1) {
     BSONObj obj = BSON("a" << BSON_ARRAY(5 << BSON("x" << 6) << BSON_ARRAY(7 << 9) << 11));
     SimpleArrayElementIterator i(obj["a"], false);
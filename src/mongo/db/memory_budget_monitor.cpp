@@ -0,0 +1,114 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/memory_budget_monitor.h"
+
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/background.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/memory_budget.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+using std::string;
+
+namespace {
+
+// The megabytes the caches registered with the MemoryBudget may hold together. Zero or less
+// means no limit, and nothing is shrunk to stay within it.
+MONGO_EXPORT_SERVER_PARAMETER(memoryBudgetMB, int, 0);
+
+class MemoryBudgetMonitor : public BackgroundJob {
+public:
+    virtual string name() const {
+        return "MemoryBudgetMonitor";
+    }
+
+    virtual void run() {
+        MemoryBudget* budget = MemoryBudget::get();
+        while (!inShutdown()) {
+            sleepsecs(1);
+
+            const int limitMB = memoryBudgetMB;
+            budget->setLimit(limitMB > 0 ? static_cast<int64_t>(limitMB) * 1024 * 1024 : 0);
+
+            const int64_t freed = budget->enforce();
+            if (freed > 0) {
+                LOG(1) << "freed " << freed << " bytes from caches to stay within memoryBudgetMB "
+                       << limitMB;
+            }
+        }
+    }
+};
+
+/**
+ * Sample format:
+ *
+ * memoryBudget: {
+ *   limitBytes: NumberLong(1073741824),
+ *   usedBytes: NumberLong(912814080),
+ *   consumers: {
+ *     planCache: NumberLong(1048576),
+ *     tcmallocFreeBytes: NumberLong(8388608),
+ *     wiredTigerCache: NumberLong(903376896)
+ *   },
+ *   shrinks: NumberLong(2),
+ *   bytesFreed: NumberLong(65536)
+ * }
+ */
+class MemoryBudgetServerStatusSection : public ServerStatusSection {
+public:
+    MemoryBudgetServerStatusSection() : ServerStatusSection("memoryBudget") {}
+
+    virtual bool includeByDefault() const {
+        return true;
+    }
+
+    virtual BSONObj generateSection(OperationContext* txn, const BSONElement& configElement) const {
+        BSONObjBuilder builder;
+        MemoryBudget::get()->appendStats(&builder);
+        return builder.obj();
+    }
+} memoryBudgetServerStatusSection;
+
+}  // namespace
+
+void startMemoryBudgetMonitor() {
+    MemoryBudgetMonitor* monitor = new MemoryBudgetMonitor();
+    monitor->go();
+}
+
+}  // namespace mongo
@@ -34,6 +34,7 @@
 #include "mongo/db/catalog/collection_options.h"
 #include "mongo/db/commands/dbhash.h"
 #include "mongo/db/dbdirectclient.h"
+#include "mongo/db/incremental_group_views.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/repl/oplog.h"
@@ -63,6 +64,25 @@ void OpObserver::onInsert(OperationContext* txn,
     getGlobalAuthorizationManager()->logOp(txn, "i", ns.ns().c_str(), doc, nullptr);
     logOpForSharding(txn, "i", ns.ns().c_str(), doc, nullptr, fromMigrate);
     logOpForDbHash(txn, ns.ns().c_str());
+    IncrementalGroupViews::get(getGlobalServiceContext()).onInsert(txn, ns, doc);
+    if (strstr(ns.ns().c_str(), ".system.js")) {
+        Scope::storedFuncMod(txn);
+    }
+}
+
+void OpObserver::onInserts(OperationContext* txn,
+                           const NamespaceString& ns,
+                           std::vector<BSONObj>::const_iterator begin,
+                           std::vector<BSONObj>::const_iterator end,
+                           bool fromMigrate) {
+    repl::_logOps(txn, "i", ns.ns().c_str(), begin, end, fromMigrate);
+
+    for (auto it = begin; it != end; it++) {
+        getGlobalAuthorizationManager()->logOp(txn, "i", ns.ns().c_str(), *it, nullptr);
+        logOpForSharding(txn, "i", ns.ns().c_str(), *it, nullptr, fromMigrate);
+        IncrementalGroupViews::get(getGlobalServiceContext()).onInsert(txn, ns, *it);
+    }
+    logOpForDbHash(txn, ns.ns().c_str());
     if (strstr(ns.ns().c_str(), ".system.js")) {
         Scope::storedFuncMod(txn);
     }
@@ -74,6 +94,8 @@ void OpObserver::onUpdate(OperationContext* txn, oplogUpdateEntryArgs args) {
     getGlobalAuthorizationManager()->logOp(txn, "u", args.ns.c_str(), args.update, &args.criteria);
     logOpForSharding(txn, "u", args.ns.c_str(), args.update, &args.criteria, args.fromMigrate);
     logOpForDbHash(txn, args.ns.c_str());
+    IncrementalGroupViews::get(getGlobalServiceContext())
+        .onUpdateOrDelete(NamespaceString(args.ns));
     if (strstr(args.ns.c_str(), ".system.js")) {
         Scope::storedFuncMod(txn);
     }
@@ -88,6 +110,7 @@ void OpObserver::onDelete(OperationContext* txn,
     getGlobalAuthorizationManager()->logOp(txn, "d", ns.c_str(), idDoc, nullptr);
     logOpForSharding(txn, "d", ns.c_str(), idDoc, nullptr, fromMigrate);
     logOpForDbHash(txn, ns.c_str());
+    IncrementalGroupViews::get(getGlobalServiceContext()).onUpdateOrDelete(NamespaceString(ns));
     if (strstr(ns.c_str(), ".system.js")) {
         Scope::storedFuncMod(txn);
     }
@@ -137,6 +160,8 @@ void OpObserver::onDropDatabase(OperationContext* txn, const std::string& dbName
 
     getGlobalAuthorizationManager()->logOp(txn, "c", dbName.c_str(), cmdObj, nullptr);
     logOpForDbHash(txn, dbName.c_str());
+    IncrementalGroupViews::get(getGlobalServiceContext())
+        .onDropDatabase(nsToDatabaseSubstring(dbName));
 }
 
 void OpObserver::onDropCollection(OperationContext* txn, const NamespaceString& collectionName) {
@@ -150,6 +175,7 @@ void OpObserver::onDropCollection(OperationContext* txn, const NamespaceString&
 
     getGlobalAuthorizationManager()->logOp(txn, "c", dbName.c_str(), cmdObj, nullptr);
     logOpForDbHash(txn, dbName.c_str());
+    IncrementalGroupViews::get(getGlobalServiceContext()).onDropCollection(collectionName);
 }
 
 void OpObserver::onDropIndex(OperationContext* txn,
@@ -175,6 +201,9 @@ void OpObserver::onRenameCollection(OperationContext* txn,
 
     getGlobalAuthorizationManager()->logOp(txn, "c", dbName.c_str(), cmdObj, nullptr);
     logOpForDbHash(txn, dbName.c_str());
+    IncrementalGroupViews& views = IncrementalGroupViews::get(getGlobalServiceContext());
+    views.onDropCollection(fromCollection);
+    views.onDropCollection(toCollection);
 }
 
 void OpObserver::onApplyOps(OperationContext* txn,
@@ -199,6 +228,7 @@ void OpObserver::onConvertToCapped(OperationContext* txn,
 
     getGlobalAuthorizationManager()->logOp(txn, "c", dbName.c_str(), cmdObj, nullptr);
     logOpForDbHash(txn, dbName.c_str());
+    IncrementalGroupViews::get(getGlobalServiceContext()).onUpdateOrDelete(collectionName);
 }
 
 void OpObserver::onEmptyCapped(OperationContext* txn, const NamespaceString& collectionName) {
@@ -212,6 +242,7 @@ void OpObserver::onEmptyCapped(OperationContext* txn, const NamespaceString& col
 
     getGlobalAuthorizationManager()->logOp(txn, "c", dbName.c_str(), cmdObj, nullptr);
     logOpForDbHash(txn, dbName.c_str());
+    IncrementalGroupViews::get(getGlobalServiceContext()).onUpdateOrDelete(collectionName);
 }
 
 }  // namespace mongo
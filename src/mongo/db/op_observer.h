@@ -29,6 +29,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/jsobj.h"
@@ -59,6 +60,15 @@ public:
                   const NamespaceString& ns,
                   BSONObj doc,
                   bool fromMigrate = false);
+    /**
+     * Same as calling onInsert() for each document in [begin, end), but writes all of their
+     * oplog entries at once.
+     */
+    void onInserts(OperationContext* txn,
+                   const NamespaceString& ns,
+                   std::vector<BSONObj>::const_iterator begin,
+                   std::vector<BSONObj>::const_iterator end,
+                   bool fromMigrate = false);
     void onUpdate(OperationContext* txn, oplogUpdateEntryArgs args);
     void onDelete(OperationContext* txn,
                   const std::string& ns,
@@ -34,6 +34,7 @@
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/write_concern_options.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/decorable.h"
 
 namespace mongo {
@@ -172,6 +173,17 @@ public:
         _writeConcern = writeConcern;
     }
 
+    /**
+     * Returns the priority with which this operation queues for storage engine tickets.
+     */
+    TicketHolder::Priority getTicketPriority() const {
+        return _ticketPriority;
+    }
+
+    void setTicketPriority(TicketHolder::Priority priority) {
+        _ticketPriority = priority;
+    }
+
     /**
      * Set whether or not operations should generate oplog entries.
      */
@@ -217,6 +229,7 @@ private:
 
     AtomicInt32 _killPending{0};
     WriteConcernOptions _writeConcern;
+    TicketHolder::Priority _ticketPriority = TicketHolder::Priority::kNormal;
 };
 
 class WriteUnitOfWork {
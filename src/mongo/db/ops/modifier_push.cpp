@@ -160,7 +160,11 @@ Status parseEachMode(ModifierPush::ModifierPushMode pushMode,
 
 struct ModifierPush::PreparedState {
     PreparedState(mutablebson::Document* targetDoc)
-        : doc(*targetDoc), idxFound(0), elemFound(doc.end()), arrayPreModSize(0) {}
+        : doc(*targetDoc),
+          idxFound(0),
+          elemFound(doc.end()),
+          arrayPreModSize(0),
+          numEachApplied(std::numeric_limits<std::size_t>::max()) {}
 
     // Document that is going to be changed.
     mutablebson::Document& doc;
@@ -172,6 +176,14 @@ struct ModifierPush::PreparedState {
     mutablebson::Element elemFound;
 
     size_t arrayPreModSize;
+
+    // The number of leading $each elements which were added to the array, if only the ones
+    // a positive $slice would keep were added. Otherwise, all of them were.
+    size_t numEachApplied;
+
+    bool slicedWhileAdding() const {
+        return numEachApplied != std::numeric_limits<std::size_t>::max();
+    }
 };
 
 ModifierPush::ModifierPush(ModifierPush::ModifierPushMode pushMode)
@@ -535,7 +547,18 @@ Status ModifierPush::apply() const {
     // 2. Add new elements to the array either by going over the $each array or by
     // appending the (old style $push) element.
     if (_eachMode || _pushMode == PUSH_ALL) {
+        // When appending to the end of an array which is shorter than a positive $slice,
+        // with no $sort in between, the $slice would keep all the existing elements and
+        // trim only new ones. So add just the new elements it keeps: neither the existing
+        // elements nor the log entry then need to be rebuilt.
+        if (_slicePresent && !_sortPresent && (_slice > 0) &&
+            (_startPosition >= _preparedState->arrayPreModSize) &&
+            (_preparedState->arrayPreModSize < static_cast<size_t>(_slice))) {
+            _preparedState->numEachApplied = _slice - _preparedState->arrayPreModSize;
+        }
+
         BSONObjIterator itEach(_eachElem.embeddedObject());
+        size_t numToApply = _preparedState->numEachApplied;
 
         // When adding more than one element we keep track of the previous one
         // so we can add right siblings to it.
@@ -544,7 +567,7 @@ Status ModifierPush::apply() const {
         // The first element is special below
         bool first = true;
 
-        while (itEach.more()) {
+        while (itEach.more() && (numToApply-- != 0)) {
             BSONElement eachItem = itEach.next();
             mutablebson::Element elem =
                 _preparedState->doc.makeElementWithNewFieldName(StringData(), eachItem);
@@ -581,8 +604,9 @@ Status ModifierPush::apply() const {
         sortChildren(_preparedState->elemFound, _sort);
     }
 
-    // 4. Trim the resulting array according to $slice, if present.
-    if (_slicePresent) {
+    // 4. Trim the resulting array according to $slice, if present and not already applied
+    // while adding the new elements.
+    if (_slicePresent && !_preparedState->slicedWhileAdding()) {
         // Slice 0 means to remove all
         if (_slice == 0) {
             while (_preparedState->elemFound.ok() && _preparedState->elemFound.rightChild().ok()) {
@@ -625,7 +649,10 @@ Status ModifierPush::log(LogBuilder* logBuilder) const {
     // that the first time the field gets filled with items that it is a full set of the array.
 
     // If we sorted, sliced, or added the first items to the array, make a full array copy.
-    const bool doFullCopy = _slicePresent || _sortPresent ||
+    // A $slice applied while appending only left out new elements, so the ones added can
+    // still be logged by position.
+    const bool trimmed = _slicePresent && !_preparedState->slicedWhileAdding();
+    const bool doFullCopy = trimmed || _sortPresent ||
         (position == 0)                                         // first element in new/empty array
         || (_startPosition < _preparedState->arrayPreModSize);  // add in middle
 
@@ -637,7 +664,8 @@ Status ModifierPush::log(LogBuilder* logBuilder) const {
         if (_eachMode || _pushMode == PUSH_ALL) {
             // For each input element log it as a posisional $set
             BSONObjIterator itEach(_eachElem.embeddedObject());
-            while (itEach.more()) {
+            size_t numToLog = _preparedState->numEachApplied;
+            while (itEach.more() && (numToLog-- != 0)) {
                 BSONElement eachItem = itEach.next();
                 // value for the logElement ("field.path.name.N": <value>)
                 const std::string positionalName = mongoutils::str::stream()
@@ -901,6 +901,56 @@ TEST(SlicePushEach, TopOne) {
     ASSERT_EQUALS(fromjson("{$set: {a: [3]}}"), logDoc);
 }
 
+TEST(SlicePushEach, TopPartOfEachIsAppended) {
+    Document doc(fromjson("{a: [1, 2]}"));
+    Mod pushMod(fromjson("{$push: {a: {$each: [3, 4, 5], $slice: 4}}}"));
+
+    ModifierInterface::ExecInfo execInfo;
+    ASSERT_OK(pushMod.prepare(doc.root(), "", &execInfo));
+    ASSERT_FALSE(execInfo.noOp);
+
+    ASSERT_OK(pushMod.apply());
+    ASSERT_EQUALS(fromjson("{a: [1, 2, 3, 4]}"), doc);
+
+    Document logDoc;
+    LogBuilder logBuilder(logDoc.root());
+    ASSERT_OK(pushMod.log(&logBuilder));
+    ASSERT_EQUALS(fromjson("{$set: {'a.2': 3, 'a.3': 4}}"), logDoc);
+}
+
+TEST(SlicePushEach, AllOfEachIsAppendedBelowSlice) {
+    Document doc(fromjson("{a: [1, 2]}"));
+    Mod pushMod(fromjson("{$push: {a: {$each: [3, 4], $slice: 10}}}"));
+
+    ModifierInterface::ExecInfo execInfo;
+    ASSERT_OK(pushMod.prepare(doc.root(), "", &execInfo));
+    ASSERT_FALSE(execInfo.noOp);
+
+    ASSERT_OK(pushMod.apply());
+    ASSERT_EQUALS(fromjson("{a: [1, 2, 3, 4]}"), doc);
+
+    Document logDoc;
+    LogBuilder logBuilder(logDoc.root());
+    ASSERT_OK(pushMod.log(&logBuilder));
+    ASSERT_EQUALS(fromjson("{$set: {'a.2': 3, 'a.3': 4}}"), logDoc);
+}
+
+TEST(SlicePushEach, ArrayLongerThanSliceIsCopied) {
+    Document doc(fromjson("{a: [1, 2, 3]}"));
+    Mod pushMod(fromjson("{$push: {a: {$each: [4], $slice: 2}}}"));
+
+    ModifierInterface::ExecInfo execInfo;
+    ASSERT_OK(pushMod.prepare(doc.root(), "", &execInfo));
+
+    ASSERT_OK(pushMod.apply());
+    ASSERT_EQUALS(fromjson("{a: [1, 2]}"), doc);
+
+    Document logDoc;
+    LogBuilder logBuilder(logDoc.root());
+    ASSERT_OK(pushMod.log(&logBuilder));
+    ASSERT_EQUALS(fromjson("{$set: {a: [1, 2]}}"), logDoc);
+}
+
 /**
  * Sort for scalar (whole) array elements
  */
@@ -43,6 +43,15 @@ using std::string;
 using std::vector;
 
 Position DocumentStorage::findField(StringData requested) const {
+    const Position pos = findLoadedField(requested);
+    if (pos.found() || MONGO_likely(_bsonNext == NULL))
+        return pos;
+
+    // Loading fields doesn't change the logical contents of the document. See loadAllFields().
+    return const_cast<DocumentStorage*>(this)->loadFieldsUntil(requested);
+}
+
+Position DocumentStorage::findLoadedField(StringData requested) const {
     int reqSize = requested.size();  // get size calculation out of the way if needed
 
     if (_numFields >= HASH_TAB_MIN) {  // hash lookup
@@ -59,7 +68,7 @@ Position DocumentStorage::findField(StringData requested) const {
             pos = elem.nextCollision;
         }
     } else {  // linear scan
-        for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance()) {
+        for (DocumentStorageIterator it = loadedIterator(); !it.atEnd(); it.advance()) {
             if (it->nameLen == reqSize && memcmp(requested.rawData(), it->_name, reqSize) == 0) {
                 return it.position();
             }
@@ -70,6 +79,48 @@ Position DocumentStorage::findField(StringData requested) const {
     return Position();
 }
 
+Position DocumentStorage::loadNextField() {
+    if (!_bsonNext)
+        return Position();
+
+    const BSONElement elem(_bsonNext);
+    _bsonNext += elem.size();
+    if (*_bsonNext == EOO)
+        _bsonNext = NULL;
+
+    const Position pos = getNextPosition();
+    appendField(elem.fieldNameStringData()) = Value(elem);
+    return pos;
+}
+
+Position DocumentStorage::loadFieldsUntil(StringData name) {
+    for (Position pos = loadNextField(); pos.found(); pos = loadNextField()) {
+        if (getField(pos).nameSD() == name)
+            return pos;
+    }
+    return Position();
+}
+
+void DocumentStorage::forgetBson() {
+    loadAllFields();
+    _bson = BSONObj();
+    _hasBson = false;
+}
+
+DocumentStorage::DocumentStorage(const BSONObj& bson)
+    : _buffer(NULL),
+      _bufferEnd(NULL),
+      _usedBytes(0),
+      _numFields(0),
+      _hashTabMask(0),
+      _metaFields(),
+      _textScore(0),
+      _bson(bson),
+      _bsonNext(bson.isEmpty() ? NULL : bson.firstElement().rawdata()),
+      _hasBson(true) {
+    dassert(bson.isOwned());
+}
+
 Value& DocumentStorage::appendField(StringData name) {
     Position pos = getNextPosition();
     const int nameSize = name.size();
@@ -182,12 +233,14 @@ void DocumentStorage::reserveFields(size_t expectedFields) {
 intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
     intrusive_ptr<DocumentStorage> out(new DocumentStorage());
 
-    // Make a copy of the buffer.
+    // Make a copy of the buffer, if any fields have been stored yet.
     // It is very important that the positions of each field are the same after cloning.
-    const size_t bufferBytes = (_bufferEnd + hashTabBytes()) - _buffer;
-    out->_buffer = new char[bufferBytes];
-    out->_bufferEnd = out->_buffer + (_bufferEnd - _buffer);
-    memcpy(out->_buffer, _buffer, bufferBytes);
+    if (_buffer) {
+        const size_t bufferBytes = (_bufferEnd + hashTabBytes()) - _buffer;
+        out->_buffer = new char[bufferBytes];
+        out->_bufferEnd = out->_buffer + (_bufferEnd - _buffer);
+        memcpy(out->_buffer, _buffer, bufferBytes);
+    }
 
     // Copy remaining fields
     out->_usedBytes = _usedBytes;
@@ -197,8 +250,14 @@ intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
     out->_textScore = _textScore;
     out->_randVal = _randVal;
 
+    // The clone converts the fields not loaded yet from the same BSON, in the same order, so they
+    // end up at the same positions.
+    out->_bson = _bson;
+    out->_bsonNext = _bsonNext;
+    out->_hasBson = _hasBson;
+
     // Tell values that they have been memcpyed (updates ref counts)
-    for (DocumentStorageIterator it = out->iteratorAll(); !it.atEnd(); it.advance()) {
+    for (DocumentStorageIterator it = out->loadedIterator(); !it.atEnd(); it.advance()) {
         it->val.memcpyed();
     }
 
@@ -208,12 +267,19 @@ intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
 DocumentStorage::~DocumentStorage() {
     std::unique_ptr<char[]> deleteBufferAtScopeEnd(_buffer);
 
-    for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance()) {
+    for (DocumentStorageIterator it = loadedIterator(); !it.atEnd(); it.advance()) {
         it->val.~Value();  // explicit destructor call
     }
 }
 
 Document::Document(const BSONObj& bson) {
+    if (bson.isOwned()) {
+        // Keep the BSON, which then holds the fields until they are used.
+        if (!bson.isEmpty())
+            _storage = new DocumentStorage(bson);
+        return;
+    }
+
     MutableDocument md(bson.nFields());
 
     BSONObjIterator it(bson);
@@ -233,12 +299,20 @@ BSONObjBuilder& operator<<(BSONObjBuilderValueStream& builder, const Document& d
 }
 
 void Document::toBson(BSONObjBuilder* pBuilder) const {
+    if (storage().hasBson()) {
+        pBuilder->appendElements(storage().bson());
+        return;
+    }
+
     for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
         *pBuilder << it->nameSD() << it->val;
     }
 }
 
 BSONObj Document::toBson() const {
+    if (storage().hasBson())
+        return storage().bson();
+
     BSONObjBuilder bb;
     toBson(&bb);
     return bb.obj();
@@ -257,7 +331,22 @@ BSONObj Document::toBsonWithMetaData() const {
     return bb.obj();
 }
 
+namespace {
+bool hasMetaField(const BSONObj& bson) {
+    BSONForEach(elem, bson) {
+        auto fieldName = elem.fieldNameStringData();
+        if (fieldName[0] == '$' &&
+            (fieldName == Document::metaFieldTextScore || fieldName == Document::metaFieldRandVal))
+            return true;
+    }
+    return false;
+}
+}  // namespace
+
 Document Document::fromBsonWithMetaData(const BSONObj& bson) {
+    if (bson.isOwned() && !hasMetaField(bson))
+        return Document(bson);
+
     MutableDocument md;
 
     BSONObjIterator it(bson);
@@ -353,7 +442,10 @@ size_t Document::getApproximateSize() const {
     size_t size = sizeof(DocumentStorage);
     size += storage().allocatedBytes();
 
-    for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
+    // Fields not converted yet are accounted for by allocatedBytes() as part of the BSON.
+    for (DocumentStorageIterator it = storage().loadedIterator(); !it.atEnd(); it.advance()) {
+        if (it->val.missing())
+            continue;
         size += it->val.getApproximateSize();
         size -= sizeof(Value);  // already accounted for above
     }
@@ -69,7 +69,12 @@ public:
     /// Empty Document (does no allocation)
     Document() {}
 
-    /// Create a new Document deep-converted from the given BSONObj.
+    /** Create a new Document from the given BSONObj.
+     *
+     *  If the BSONObj is owned, the Document keeps it and only converts each field once it is
+     *  used, so fields that no stage looks at are never converted, and toBson() returns the
+     *  original until the Document is modified. Otherwise it is deep-converted straight away.
+     */
     explicit Document(const BSONObj& bson);
 
     void swap(Document& rhs) {
@@ -108,7 +113,11 @@ public:
 
     /// True if this document has no fields.
     bool empty() const {
-        return !_storage || storage().iterator().atEnd();
+        if (!_storage)
+            return true;
+        if (storage().hasBson())
+            return storage().bson().isEmpty();
+        return storage().iterator().atEnd();
     }
 
     /// Create a new FieldIterator that can be used to examine the Document's fields in order.
@@ -485,7 +494,10 @@ private:
             return clonedStorage();
 
         // This function exists to ensure this is safe
-        return const_cast<DocumentStorage&>(*storagePtr());
+        DocumentStorage& ds = const_cast<DocumentStorage&>(*storagePtr());
+        if (MONGO_unlikely(ds.hasBson()))
+            ds.forgetBson();  // the fields are about to diverge from the BSON
+        return ds;
     }
     DocumentStorage& newStorage() {
         reset(new DocumentStorage);
@@ -493,7 +505,10 @@ private:
     }
     DocumentStorage& clonedStorage() {
         reset(storagePtr()->clone().get());
-        return const_cast<DocumentStorage&>(*storagePtr());
+        DocumentStorage& ds = const_cast<DocumentStorage&>(*storagePtr());
+        if (ds.hasBson())
+            ds.forgetBson();
+        return ds;
     }
 
     // recursive helpers for same-named public methods
@@ -0,0 +1,100 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/field_path.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/unittest/benchmark.h"
+
+namespace {
+
+using namespace mongo;
+using unittest::BenchmarkState;
+using unittest::doNotOptimizeAway;
+
+BSONObj makeObj() {
+    return fromjson(
+        "{_id: 1, name: 'benchmark', count: 42, ratio: 0.5, tags: ['a', 'b', 'c'], "
+        "nested: {x: 1, y: {z: 2}}}");
+}
+
+MONGO_BENCHMARK(DocumentFromBson) {
+    const BSONObj obj = makeObj();
+    while (state.keepRunning()) {
+        doNotOptimizeAway(Document(obj));
+    }
+}
+
+MONGO_BENCHMARK(DocumentToBson) {
+    const Document doc(makeObj());
+    while (state.keepRunning()) {
+        doNotOptimizeAway(doc.toBson());
+    }
+}
+
+MONGO_BENCHMARK(DocumentGetField) {
+    const Document doc(makeObj());
+    while (state.keepRunning()) {
+        doNotOptimizeAway(doc["ratio"]);
+    }
+}
+
+MONGO_BENCHMARK(DocumentGetNestedField) {
+    const Document doc(makeObj());
+    const FieldPath path("nested.y.z");
+    while (state.keepRunning()) {
+        doNotOptimizeAway(doc.getNestedField(path));
+    }
+}
+
+MONGO_BENCHMARK(MutableDocumentAddFields) {
+    while (state.keepRunning()) {
+        MutableDocument doc;
+        doc.addField("a", Value(1));
+        doc.addField("b", Value(StringData("string")));
+        doc.addField("c", Value(2.5));
+        doc.addField("d", Value(BSON_ARRAY(1 << 2 << 3)));
+        doNotOptimizeAway(doc.freeze());
+    }
+}
+
+MONGO_BENCHMARK(MutableDocumentSetNestedField) {
+    const Document original(makeObj());
+    const FieldPath path("nested.y.w");
+    while (state.keepRunning()) {
+        MutableDocument doc(original);
+        doc.setNestedField(path, Value(3));
+        doNotOptimizeAway(doc.freeze());
+    }
+}
+
+}  // namespace
@@ -33,6 +33,7 @@
 #include <boost/intrusive_ptr.hpp>
 #include <bitset>
 
+#include "mongo/bson/bsonobj.h"
 #include "mongo/util/intrusive_counter.h"
 #include "mongo/db/pipeline/value.h"
 
@@ -190,7 +191,17 @@ public:
           _numFields(0),
           _hashTabMask(0),
           _metaFields(),
-          _textScore(0) {}
+          _textScore(0),
+          _bsonNext(NULL),
+          _hasBson(false) {}
+
+    /**
+     * Creates storage for the fields of 'bson', which must be owned, without converting any of
+     * them. A field is only converted to a Value and added to the buffer once it is looked up, or
+     * once something iterates over the fields.
+     */
+    explicit DocumentStorage(const BSONObj& bson);
+
     ~DocumentStorage();
 
     enum MetaType : char {
@@ -206,6 +217,9 @@ public:
     }
 
     size_t size() const {
+        if (_hasBson)
+            return _bson.nFields();
+
         // can't use _numFields because it includes removed Fields
         size_t count = 0;
         for (DocumentStorageIterator it = iterator(); !it.atEnd(); it.advance())
@@ -255,19 +269,45 @@ public:
 
     /// This skips missing values
     DocumentStorageIterator iterator() const {
+        loadAllFields();
         return DocumentStorageIterator(_firstElement, end(), false);
     }
 
     /// This includes missing values
     DocumentStorageIterator iteratorAll() const {
+        loadAllFields();
+        return DocumentStorageIterator(_firstElement, end(), true);
+    }
+
+    /// Like iteratorAll(), but only over the fields converted so far. Converts no more fields.
+    DocumentStorageIterator loadedIterator() const {
         return DocumentStorageIterator(_firstElement, end(), true);
     }
 
+    /**
+     * True if the fields are still exactly those of the BSON this was created from, which bson()
+     * then returns.
+     */
+    bool hasBson() const {
+        return _hasBson;
+    }
+    const BSONObj& bson() const {
+        dassert(_hasBson);
+        return _bson;
+    }
+
+    /**
+     * Converts all remaining fields and releases the BSON. MutableDocument calls this before
+     * modifying the fields, after which hasBson() is false.
+     */
+    void forgetBson();
+
     /// Shallow copy of this. Caller owns memory.
     boost::intrusive_ptr<DocumentStorage> clone() const;
 
     size_t allocatedBytes() const {
-        return !_buffer ? 0 : (_bufferEnd - _buffer + hashTabBytes());
+        return (!_buffer ? 0 : (_bufferEnd - _buffer + hashTabBytes())) +
+            (_hasBson ? _bson.objsize() : 0);
     }
 
     /**
@@ -349,10 +389,35 @@ private:
     /// Adds all fields to the hash table
     void rehash() {
         hashTabInit();
-        for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance())
+        for (DocumentStorageIterator it = loadedIterator(); !it.atEnd(); it.advance())
             addFieldToHashTable(it.position());
     }
 
+    /// Looks up a field among those converted so far.
+    Position findLoadedField(StringData name) const;
+
+    /**
+     * Converts the next field of _bson and appends it to the buffer. Returns its Position, or
+     * Position() if all fields have been converted.
+     */
+    Position loadNextField();
+
+    /// Converts fields until one named 'name' is found. Returns its Position or Position().
+    Position loadFieldsUntil(StringData name);
+
+    /**
+     * Converts all remaining fields. This is const since it leaves the logical contents of the
+     * document unchanged, but it can move the buffer, so only call it from places that hold no
+     * references into the buffer.
+     */
+    void loadAllFields() const {
+        if (MONGO_unlikely(_bsonNext != NULL)) {
+            DocumentStorage* self = const_cast<DocumentStorage*>(this);
+            while (self->loadNextField().found()) {
+            }
+        }
+    }
+
     enum {
         HASH_TAB_INIT_SIZE = 8,  // must be power of 2
         HASH_TAB_MIN = 4,        // don't hash fields for docs smaller than this
@@ -386,6 +451,13 @@ private:
     std::bitset<MetaType::NUM_FIELDS> _metaFields;
     double _textScore;
     double _randVal;
+
+    // The BSON this was created from, if any, which is kept until the document is modified. Its
+    // fields are converted in order, so the buffer holds a prefix of them, and _bsonNext points to
+    // the next element to convert, or is NULL once none are left.
+    BSONObj _bson;
+    const char* _bsonNext;
+    bool _hasBson;
     // When adding a field, make sure to update clone() method
 };
 }
@@ -313,7 +313,9 @@ protected:
  * Constructs and returns Documents from the BSONObj objects produced by a supplied
  * PlanExecutor.
  *
- * An object of this type may only be used by one thread, see SERVER-6123.
+ * An object of this type may only be used by one thread, see SERVER-6123. The exception is that
+ * with internalDocumentSourceCursorPrefetch set, it loads each next batch on a helper thread of
+ * its own while the current batch is being consumed.
  */
 class DocumentSourceCursor final : public DocumentSource {
 public:
@@ -381,13 +383,53 @@ public:
     /// returns -1 for no limit
     long long getLimit() const;
 
+    /**
+     * Waits for the helper thread loading the next batch, if there is one, and takes back the
+     * PlanExecutor. Whatever holds the PlanExecutor must call this before saving, detaching or
+     * otherwise using it.
+     */
+    void finishPrefetch();
+
 private:
+    struct Prefetch;
+
     DocumentSourceCursor(const std::string& ns,
                          const std::shared_ptr<PlanExecutor>& exec,
                          const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
 
     void loadBatch();
 
+    /**
+     * Appends documents from the restored '_exec' to 'batch' until the batch is full, the limit
+     * is reached or '_exec' has no more. Returns ADVANCED, with '_exec' saved, if a later batch
+     * may find more. Otherwise returns the final state of '_exec', with the object explaining a
+     * DEAD or FAILURE state in 'errorObj'.
+     */
+    PlanExecutor::ExecState fillBatch(std::deque<Document>* batch, BSONObj* errorObj);
+
+    /**
+     * Destroys '_exec' unless 'state' from fillBatch() says there may be more, and throws if
+     * '_exec' failed.
+     */
+    void endBatch(PlanExecutor::ExecState state, const BSONObj& errorObj);
+
+    /**
+     * Starts a helper thread loading the next batch into '_prefetch', with '_exec' detached from
+     * our OperationContext.
+     */
+    void startPrefetch();
+
+    /**
+     * Runs on the helper thread started by startPrefetch().
+     */
+    void prefetchBatch();
+
+    /**
+     * Moves the batch loaded by the helper thread into '_currentBatch', or loads one here if the
+     * helper gave up before it could.
+     */
+    void takePrefetchedBatch();
+
     std::deque<Document> _currentBatch;
 
     // BSONObj members must outlive _projection and cursor.
@@ -400,6 +442,9 @@ private:
 
     const std::string _ns;
     std::shared_ptr<PlanExecutor> _exec;  // PipelineProxyStage holds a weak_ptr to this.
+
+    // Set while a helper thread may be using '_exec' to load the next batch.
+    std::unique_ptr<Prefetch> _prefetch;
 };
 
 
@@ -412,6 +457,7 @@ public:
     GetDepsReturn getDependencies(DepsTracker* deps) const final;
     void dispose() final;
     Value serialize(bool explain = false) const final;
+    void serializeToArray(std::vector<Value>& array, bool explain = false) const final;
 
     static boost::intrusive_ptr<DocumentSourceGroup> create(
         const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
@@ -437,6 +483,32 @@ public:
         _doingMerge = doingMerge;
     }
 
+    /**
+     * Returns true if input sorted by 'sortPattern' brings all documents with the same group key
+     * together, which is the case when the _id is made of plain field paths naming exactly the
+     * fields of some prefix of 'sortPattern'.
+     */
+    bool groupsAreContiguousInSortOrder(const BSONObj& sortPattern) const;
+
+    /**
+     * Tell this source that its input is sorted such that groups are contiguous, so it can emit
+     * each group as soon as the group key changes rather than after consuming all of its input.
+     * Defaults to false.
+     */
+    void setStreaming(bool streaming) {
+        _streaming = streaming;
+    }
+
+    /**
+     * Makes this source do the work of a $unwind on 'unwindPath' directly before it: each input
+     * document is accumulated once per element of the array at 'unwindPath', with the element in
+     * place of the array. The unwound documents are never materialized as separate Documents.
+     *
+     * Returns false, leaving this source unchanged, if it already absorbed a $unwind or is
+     * streaming.
+     */
+    bool absorbUnwind(const FieldPath& unwindPath);
+
     /**
       Create a grouping DocumentSource from BSON.
 
@@ -473,6 +545,45 @@ private:
     void populate();
     bool populated;
 
+    /**
+     * Implements populate() when the grouping is spread across 'numThreads' threads. This thread
+     * reads the input and deals it out in batches. Each worker groups its batches with a copy of
+     * this stage producing mergeable output, and the partial groups are then combined by the
+     * stage that would merge them from shards, which becomes _parallelMerger.
+     */
+    void populateInParallel(size_t numThreads);
+
+    /**
+     * Adds 'input' to the group for its key in the groups map, or each document unwound from it
+     * if this source absorbed a $unwind.
+     */
+    void accumulateDocument(const Document& input);
+
+    /**
+     * Adds 'input' to the group for its key in the groups map, ignoring any absorbed $unwind.
+     */
+    void accumulateUnwoundDocument(const Document& input);
+
+    /**
+     * Adds the current ROOT document to the group for 'id' in the groups map, spilling the map to
+     * disk when it grows past the memory limit.
+     */
+    void accumulateIntoGroups(const Value& id);
+
+    /**
+     * Called once all input has been consumed to prepare the groups map, or the files it was
+     * spilled to, for output. Sets populated.
+     */
+    void readyGroupsForOutput();
+
+    /**
+     * Implements getNext() while _streaming and not yet populated: accumulates the current group
+     * until a document with a different key arrives. Groups whose keys contain arrays are routed
+     * to the groups map instead, since they may not arrive in key order, and are returned once
+     * the input is exhausted.
+     */
+    boost::optional<Document> getNextStreaming();
+
     /**
      * Parses the raw id expression into _idExpressions and possibly _idFieldNames.
      */
@@ -514,19 +625,28 @@ private:
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
     bool _doingMerge;
+    bool _streaming;
     bool _spilled;
     const bool _extSortAllowed;
-    const int _maxMemoryUsageBytes;
+    int _maxMemoryUsageBytes;
+    int _memoryUsageBytes;
+    std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> _sortedFiles;  // from spill()
     std::unique_ptr<Variables> _variables;
     std::vector<std::string> _idFieldNames;  // used when id is a document
     std::vector<boost::intrusive_ptr<Expression>> _idExpressions;
+    std::unique_ptr<FieldPath> _unwindPath;  // set by absorbUnwind()
 
     // only used when !_spilled
     GroupsMap::iterator groupsIterator;
 
+    // set by populateInParallel(), which leaves the results to this stage
+    boost::intrusive_ptr<DocumentSourceGroup> _parallelMerger;
+
     // only used when _spilled
     std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
     std::pair<Value, Value> _firstPartOfNextGroup;
+
+    // used when _spilled, and while _streaming for the group being accumulated (missing if none)
     Value _currentId;
     Accumulators _currentAccumulators;
 };
@@ -642,6 +762,9 @@ private:
         CursorAndConnection(ConnectionString host, NamespaceString ns, CursorId id);
         ScopedDbConnection connection;
         DBClientCursor cursor;
+
+        // Whether the request for the first batch was sent but its reply not yet read.
+        bool awaitingFirstBatch = false;
     };
 
     // using list to enable removing arbitrary elements
@@ -650,9 +773,13 @@ private:
     DocumentSourceMergeCursors(const CursorIds& cursorIds,
                                const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
 
-    // Converts _cursorIds into active _cursors.
+    // Converts _cursorIds into active _cursors, requesting their first batches without waiting
+    // for the replies.
     void start();
 
+    // Waits for the reply to the first batch request of 'cursorAndConn', if it is outstanding.
+    static void awaitFirstBatch(CursorAndConnection* cursorAndConn);
+
     // This is the description of cursors to merge.
     const CursorIds _cursorIds;
 
@@ -742,10 +869,16 @@ private:
 
     void spill(const std::vector<BSONObj>& toInsert);
 
+    // Builds the indexes prepTempCollection() found on _outputNs on the filled _tempNs.
+    void buildIndexes();
+
     bool _done;
 
     NamespaceString _tempNs;          // output goes here as it is being processed.
     const NamespaceString _outputNs;  // output will go here after all data is processed.
+
+    // Specs of the indexes on _outputNs other than _id, for _tempNs.
+    std::vector<BSONObj> _indexesToBuild;
 };
 
 
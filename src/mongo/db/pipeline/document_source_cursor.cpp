@@ -32,14 +32,21 @@
 
 
 #include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/locker.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/find_common.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/service_context.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/d_state.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
 
 namespace mongo {
 
@@ -47,6 +54,79 @@ using boost::intrusive_ptr;
 using std::shared_ptr;
 using std::string;
 
+namespace {
+
+// How long the prefetch thread waits for each of its locks before checking whether it has been
+// cancelled.
+const unsigned kPrefetchLockTimeoutMs = 100;
+
+/**
+ * Takes the intent locks AutoGetCollectionForRead would, but gives up on any lock it cannot get
+ * within 'timeoutMs'. The owning thread may hold its own intent locks while it waits for the
+ * prefetch thread, so waiting on a lock without a timeout could queue us behind a conflicting
+ * request that in turn waits on the owner.
+ */
+class TimedCollectionReadLock {
+    MONGO_DISALLOW_COPYING(TimedCollectionReadLock);
+
+public:
+    TimedCollectionReadLock(Locker* locker, const NamespaceString& nss, unsigned timeoutMs)
+        : _locker(locker) {
+        if (_locker->lock(resourceIdParallelBatchWriterMode, MODE_IS, timeoutMs) != LOCK_OK) {
+            return;
+        }
+        _pbwmLocked = true;
+
+        if (_locker->lockGlobal(MODE_IS, timeoutMs) != LOCK_OK) {
+            return;
+        }
+        _globalLocked = true;
+
+        _locked = _locker->lock(ResourceId(RESOURCE_DATABASE, nss.db()), MODE_IS, timeoutMs) ==
+                LOCK_OK &&
+            _locker->lock(ResourceId(RESOURCE_COLLECTION, nss.ns()), MODE_IS, timeoutMs) ==
+                LOCK_OK;
+    }
+
+    ~TimedCollectionReadLock() {
+        if (_globalLocked) {
+            _locker->unlockAll();
+        } else if (_pbwmLocked) {
+            _locker->unlock(resourceIdParallelBatchWriterMode);
+        }
+    }
+
+    bool isLocked() const {
+        return _locked;
+    }
+
+private:
+    Locker* const _locker;
+    bool _pbwmLocked = false;
+    bool _globalLocked = false;
+    bool _locked = false;
+};
+
+}  // namespace
+
+struct DocumentSourceCursor::Prefetch {
+    stdx::thread thread;
+
+    // Set by the owner to make the prefetch thread give up if it is still waiting for locks.
+    AtomicUInt32 cancelled;
+
+    // Set once the owner has joined 'thread' and reattached '_exec' to its OperationContext.
+    bool finished = false;
+
+    // Whether the prefetch thread used '_exec' at all. If not, '_exec' is untouched and the
+    // fields below are meaningless.
+    bool loaded = false;
+    std::deque<Document> batch;
+    PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
+    BSONObj errorObj;
+    Status status = Status::OK();
+};
+
 DocumentSourceCursor::~DocumentSourceCursor() {
     dispose();
 }
@@ -59,10 +139,18 @@ boost::optional<Document> DocumentSourceCursor::getNext() {
     pExpCtx->checkForInterrupt();
 
     if (_currentBatch.empty()) {
-        loadBatch();
+        if (_prefetch) {
+            takePrefetchedBatch();
+        } else {
+            loadBatch();
+        }
 
         if (_currentBatch.empty())  // exhausted the cursor
             return boost::none;
+
+        if (_exec && internalDocumentSourceCursorPrefetch && supportsDocLocking()) {
+            startPrefetch();
+        }
     }
 
     Document out = _currentBatch.front();
@@ -72,7 +160,15 @@ boost::optional<Document> DocumentSourceCursor::getNext() {
 
 void DocumentSourceCursor::dispose() {
     // Can't call in to PlanExecutor or ClientCursor registries from this function since it
-    // will be called when an agg cursor is killed which would cause a deadlock.
+    // will be called when an agg cursor is killed which would cause a deadlock. The prefetch
+    // thread only ever waits for locks with a timeout, so joining it here cannot deadlock.
+    if (_prefetch) {
+        _prefetch->cancelled.store(1);
+        if (_prefetch->thread.joinable()) {
+            _prefetch->thread.join();
+        }
+        _prefetch.reset();
+    }
     _exec.reset();
     _currentBatch.clear();
 }
@@ -90,49 +186,134 @@ void DocumentSourceCursor::loadBatch() {
 
     _exec->restoreState();
 
+    BSONObj errorObj;
+    const PlanExecutor::ExecState state = fillBatch(&_currentBatch, &errorObj);
+    endBatch(state, errorObj);
+}
+
+PlanExecutor::ExecState DocumentSourceCursor::fillBatch(std::deque<Document>* batch,
+                                                        BSONObj* errorObj) {
     int memUsageBytes = 0;
     BSONObj obj;
     PlanExecutor::ExecState state;
     while ((state = _exec->getNext(&obj, NULL)) == PlanExecutor::ADVANCED) {
         if (_dependencies) {
-            _currentBatch.push_back(_dependencies->extractFields(obj));
+            batch->push_back(_dependencies->extractFields(obj));
         } else {
-            _currentBatch.push_back(Document::fromBsonWithMetaData(obj));
+            // An owned copy lets the Document wrap the BSON and convert fields only as needed.
+            batch->push_back(Document::fromBsonWithMetaData(obj.getOwned()));
         }
 
         if (_limit) {
             if (++_docsAddedToBatches == _limit->getLimit()) {
-                break;
+                return PlanExecutor::IS_EOF;
             }
             verify(_docsAddedToBatches < _limit->getLimit());
         }
 
-        memUsageBytes += _currentBatch.back().getApproximateSize();
+        memUsageBytes += batch->back().getApproximateSize();
 
         if (memUsageBytes > FindCommon::kMaxBytesToReturnToClientAtOnce) {
             // End this batch and prepare PlanExecutor for yielding.
             _exec->saveState();
-            return;
+            return PlanExecutor::ADVANCED;
         }
     }
 
-    // If we got here, there won't be any more documents, so destroy the executor. Can't use
-    // dispose since we want to keep the _currentBatch.
+    *errorObj = obj.getOwned();
+    return state;
+}
+
+void DocumentSourceCursor::endBatch(PlanExecutor::ExecState state, const BSONObj& errorObj) {
+    if (state == PlanExecutor::ADVANCED) {
+        return;
+    }
+
+    // There won't be any more documents, so destroy the executor. Can't use dispose since we
+    // want to keep the _currentBatch.
     _exec.reset();
 
     uassert(16028,
             str::stream() << "collection or index disappeared when cursor yielded: "
-                          << WorkingSetCommon::toStatusString(obj),
+                          << WorkingSetCommon::toStatusString(errorObj),
             state != PlanExecutor::DEAD);
 
-    uassert(
-        17285,
-        str::stream() << "cursor encountered an error: " << WorkingSetCommon::toStatusString(obj),
-        state != PlanExecutor::FAILURE);
+    uassert(17285,
+            str::stream() << "cursor encountered an error: "
+                          << WorkingSetCommon::toStatusString(errorObj),
+            state != PlanExecutor::FAILURE);
 
     massert(17286,
             str::stream() << "Unexpected return from PlanExecutor::getNext: " << state,
-            state == PlanExecutor::IS_EOF || state == PlanExecutor::ADVANCED);
+            state == PlanExecutor::IS_EOF);
+}
+
+void DocumentSourceCursor::startPrefetch() {
+    invariant(!_prefetch);
+    _exec->detachFromOperationContext();
+    _prefetch = stdx::make_unique<Prefetch>();
+    _prefetch->thread = stdx::thread([this] { prefetchBatch(); });
+}
+
+void DocumentSourceCursor::prefetchBatch() {
+    Client::initThread("aggCursorPrefetch");
+    auto txn = cc().makeOperationContext();
+    const NamespaceString nss(_ns);
+
+    while (!_prefetch->cancelled.load()) {
+        TimedCollectionReadLock lock(txn->lockState(), nss, kPrefetchLockTimeoutMs);
+        if (!lock.isLocked()) {
+            continue;
+        }
+
+        _prefetch->loaded = true;
+        _exec->reattachToOperationContext(txn.get());
+
+        // Yielding would release locks that belong to this thread's OperationContext rather than
+        // the one the yield policy knows about.
+        _exec->setYieldPolicy(PlanExecutor::WRITE_CONFLICT_RETRY_ONLY, false);
+        try {
+            _exec->restoreState();
+            _prefetch->state = fillBatch(&_prefetch->batch, &_prefetch->errorObj);
+        } catch (const DBException& ex) {
+            _prefetch->status = ex.toStatus();
+        }
+        _exec->setYieldPolicy(PlanExecutor::YIELD_AUTO, false);
+
+        // Leave the executor saved whether or not there is more, so the owner can always
+        // reattach it.
+        _exec->saveState();
+        _exec->detachFromOperationContext();
+        return;
+    }
+}
+
+void DocumentSourceCursor::finishPrefetch() {
+    if (!_prefetch || _prefetch->finished) {
+        return;
+    }
+
+    _prefetch->cancelled.store(1);
+    _prefetch->thread.join();
+    _exec->reattachToOperationContext(pExpCtx->opCtx);
+    _prefetch->finished = true;
+}
+
+void DocumentSourceCursor::takePrefetchedBatch() {
+    finishPrefetch();
+    const std::unique_ptr<Prefetch> prefetch = std::move(_prefetch);
+
+    if (!prefetch->loaded) {
+        loadBatch();
+        return;
+    }
+
+    _currentBatch = std::move(prefetch->batch);
+    if (!prefetch->status.isOK()) {
+        _exec.reset();
+        uassertStatusOK(prefetch->status);
+    }
+    endBatch(prefetch->state, prefetch->errorObj);
 }
 
 void DocumentSourceCursor::setSource(DocumentSource* pSource) {
@@ -167,6 +348,9 @@ Value DocumentSourceCursor::serialize(bool explain) const {
     // Get planner-level explain info from the underlying PlanExecutor.
     BSONObjBuilder explainBuilder;
     {
+        // Explain runs before the pipeline has loaded anything.
+        invariant(!_prefetch);
+
         const NamespaceString nss(_ns);
         AutoGetCollectionForRead autoColl(pExpCtx->opCtx, nss);
 
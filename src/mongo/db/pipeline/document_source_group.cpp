@@ -28,6 +28,9 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+#include <deque>
+#include <set>
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/accumulator.h"
@@ -36,6 +39,11 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -53,8 +61,16 @@ const char* DocumentSourceGroup::getSourceName() const {
 boost::optional<Document> DocumentSourceGroup::getNext() {
     pExpCtx->checkForInterrupt();
 
-    if (!populated)
-        populate();
+    if (!populated) {
+        if (!_streaming) {
+            populate();
+        } else if (boost::optional<Document> out = getNextStreaming()) {
+            return out;
+        }
+    }
+
+    if (_parallelMerger)
+        return _parallelMerger->getNext();
 
     if (_spilled) {
         if (!_sorterIterator)
@@ -119,11 +135,15 @@ void DocumentSourceGroup::dispose() {
     GroupsMap().swap(groups);
     _sorterIterator.reset();
 
+    _parallelMerger.reset();
+
     // make us look done
     groupsIterator = groups.end();
 
     // free our source's resources
-    pSource->dispose();
+    if (pSource) {
+        pSource->dispose();
+    }
 }
 
 intrusive_ptr<DocumentSource> DocumentSourceGroup::optimize() {
@@ -173,9 +193,26 @@ Value DocumentSourceGroup::serialize(bool explain) const {
         insides["$doingMerge"] = Value(true);
     }
 
+    if (explain && _streaming) {
+        insides["$streaming"] = Value(true);
+    }
+
+    if (explain && _unwindPath) {
+        insides["$unwind"] = Value(_unwindPath->getPath(true));
+    }
+
     return Value(DOC(getSourceName() << insides.freeze()));
 }
 
+void DocumentSourceGroup::serializeToArray(vector<Value>& array, bool explain) const {
+    // Outside of explain an absorbed $unwind is written back out as its own stage, so that what
+    // we serialize, such as the pipeline sent to the shards, parses to the same results.
+    if (_unwindPath && !explain) {
+        array.push_back(Value(DOC("$unwind" << _unwindPath->getPath(true))));
+    }
+    DocumentSource::serializeToArray(array, explain);
+}
+
 DocumentSource::GetDepsReturn DocumentSourceGroup::getDependencies(DepsTracker* deps) const {
     // add the _id
     for (size_t i = 0; i < _idExpressions.size(); i++) {
@@ -188,6 +225,10 @@ DocumentSource::GetDepsReturn DocumentSourceGroup::getDependencies(DepsTracker*
         vpExpression[i]->addDependencies(deps);
     }
 
+    if (_unwindPath) {
+        deps->fields.insert(_unwindPath->getPath(false));
+    }
+
     return EXHAUSTIVE_ALL;
 }
 
@@ -201,9 +242,52 @@ DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>&
     : DocumentSource(pExpCtx),
       populated(false),
       _doingMerge(false),
+      _streaming(false),
       _spilled(false),
       _extSortAllowed(pExpCtx->extSortAllowed && !pExpCtx->inRouter),
-      _maxMemoryUsageBytes(100 * 1024 * 1024) {}
+      _maxMemoryUsageBytes(100 * 1024 * 1024),
+      _memoryUsageBytes(0) {}
+
+bool DocumentSourceGroup::absorbUnwind(const FieldPath& unwindPath) {
+    if (_unwindPath || _streaming)
+        return false;
+
+    _unwindPath.reset(new FieldPath(unwindPath));
+    return true;
+}
+
+bool DocumentSourceGroup::groupsAreContiguousInSortOrder(const BSONObj& sortPattern) const {
+    std::set<std::string> idFields;
+    for (size_t i = 0; i < _idExpressions.size(); i++) {
+        const ExpressionFieldPath* fieldPathExpr =
+            dynamic_cast<ExpressionFieldPath*>(_idExpressions[i].get());
+        if (!fieldPathExpr)
+            return false;
+
+        // Only paths into the input document, such as "$a" or "$$ROOT.a", can match a sort field.
+        const FieldPath& withVariable = fieldPathExpr->getFieldPath();
+        if (withVariable.getPathLength() < 2 ||
+            (withVariable.getFieldName(0) != "CURRENT" && withVariable.getFieldName(0) != "ROOT"))
+            return false;
+
+        idFields.insert(withVariable.tail().getPath(false));
+    }
+
+    // Documents agreeing on every field of a sort prefix are adjacent, so the _id fields must be
+    // exactly the fields of some prefix. Fewer would split a group, and more would interleave
+    // groups that differ only on a field the sort does not order by.
+    std::set<std::string> prefixFields;
+    BSONForEach(elem, sortPattern) {
+        if (!elem.isNumber() || !idFields.count(elem.fieldName()))
+            return false;
+
+        prefixFields.insert(elem.fieldName());
+        if (prefixFields.size() == idFields.size())
+            return true;
+    }
+
+    return false;
+}
 
 void DocumentSourceGroup::addAccumulator(const std::string& fieldName,
                                          Accumulator::Factory accumulatorFactory,
@@ -306,98 +390,274 @@ public:
 }
 
 void DocumentSourceGroup::populate() {
-    const size_t numAccumulators = vpAccumulatorFactory.size();
-    dassert(numAccumulators == vpExpression.size());
-
-    // pushed to on spill()
-    vector<shared_ptr<Sorter<Value, Value>::Iterator>> sortedFiles;
-    int memoryUsageBytes = 0;
+    const size_t numThreads = std::max(1, internalDocumentSourceGroupThreads);
+    if (numThreads > 1 && !pExpCtx->inRouter) {
+        populateInParallel(numThreads);
+        return;
+    }
 
     // This loop consumes all input from pSource and buckets it based on pIdExpression.
     while (boost::optional<Document> input = pSource->getNext()) {
-        if (memoryUsageBytes > _maxMemoryUsageBytes) {
-            uassert(16945,
-                    "Exceeded memory limit for $group, but didn't allow external sort."
-                    " Pass allowDiskUse:true to opt in.",
-                    _extSortAllowed);
-            sortedFiles.push_back(spill());
-            memoryUsageBytes = 0;
+        accumulateDocument(*input);
+    }
+
+    readyGroupsForOutput();
+}
+
+namespace {
+// How many documents the reading thread hands a worker at a time in populateInParallel().
+const size_t kParallelBatchSize = 1024;
+}  // namespace
+
+void DocumentSourceGroup::populateInParallel(size_t numThreads) {
+    // Each worker gets its own copy of this stage, parsed from our spec under an
+    // ExpressionContext of its own so that nothing is shared between threads but the (immutable)
+    // input documents. A copy behaves like the shard half of a split $group: it emits partial
+    // results, which the merging half combines.
+    const BSONObj spec = serialize().getDocument().toBson();
+    std::vector<intrusive_ptr<DocumentSourceGroup>> partials;
+    for (size_t i = 0; i < numThreads; i++) {
+        intrusive_ptr<ExpressionContext> partialCtx =
+            new ExpressionContext(pExpCtx->opCtx, pExpCtx->ns);
+        partialCtx->inShard = true;
+        partialCtx->extSortAllowed = pExpCtx->extSortAllowed;
+        partialCtx->tempDir = pExpCtx->tempDir;
+
+        intrusive_ptr<DocumentSourceGroup> partial = static_cast<DocumentSourceGroup*>(
+            createFromBson(spec.firstElement(), partialCtx).get());
+        partial->_maxMemoryUsageBytes = _maxMemoryUsageBytes / numThreads;
+        if (_unwindPath) {
+            // Our spec does not include the $unwind, and the workers unwind their batches.
+            partial->absorbUnwind(*_unwindPath);
         }
+        partial->optimize();  // So that its expressions are compiled, like ours.
+        partials.push_back(partial);
+    }
 
-        _variables->setRoot(*input);
+    stdx::mutex mutex;
+    stdx::condition_variable batchesChanged;
+    std::deque<std::vector<Document>> batches;  // guarded by 'mutex'
+    bool inputDone = false;                     // guarded by 'mutex'
+    bool stopped = false;                       // guarded by 'mutex'
+    std::vector<Status> statuses(numThreads, Status::OK());
+
+    std::vector<stdx::thread> threads;
+    for (size_t i = 0; i < numThreads; i++) {
+        threads.emplace_back([&, i] {
+            try {
+                while (true) {
+                    std::vector<Document> batch;
+                    {
+                        stdx::unique_lock<stdx::mutex> lk(mutex);
+                        batchesChanged.wait(
+                            lk, [&] { return stopped || inputDone || !batches.empty(); });
+                        if (stopped || batches.empty())
+                            return;
+                        batch = std::move(batches.front());
+                        batches.pop_front();
+                    }
+                    batchesChanged.notify_all();
 
-        /* get the _id value */
-        Value id = computeId(_variables.get());
+                    for (size_t j = 0; j < batch.size(); j++) {
+                        partials[i]->accumulateDocument(batch[j]);
+                    }
+                }
+            } catch (const DBException& ex) {
+                statuses[i] = ex.toStatus();
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                stopped = true;
+                batchesChanged.notify_all();
+            }
+        });
+    }
 
-        /* treat missing values the same as NULL SERVER-4674 */
-        if (id.missing())
-            id = Value(BSONNULL);
+    // Whether the input runs out, a worker fails or reading the input throws, the workers must
+    // be finished with 'partials' before this function returns.
+    auto stopWorkers = [&](bool stop) {
+        {
+            stdx::lock_guard<stdx::mutex> lk(mutex);
+            inputDone = true;
+            stopped = stopped || stop;
+        }
+        batchesChanged.notify_all();
+        for (size_t i = 0; i < threads.size(); i++) {
+            threads[i].join();
+        }
+        threads.clear();
+    };
+    ScopeGuard workerGuard = MakeGuard(stopWorkers, true);
+
+    // Keep a couple of batches queued per worker, which bounds the input held in memory.
+    const size_t maxQueuedBatches = 2 * numThreads;
+    std::vector<Document> batch;
+    batch.reserve(kParallelBatchSize);
+    boost::optional<Document> input;
+    do {
+        input = pSource->getNext();
+        if (input)
+            batch.push_back(std::move(*input));
+
+        if (batch.size() == kParallelBatchSize || (!input && !batch.empty())) {
+            stdx::unique_lock<stdx::mutex> lk(mutex);
+            batchesChanged.wait(lk, [&] { return stopped || batches.size() < maxQueuedBatches; });
+            if (stopped)
+                break;
+            batches.push_back(std::move(batch));
+            lk.unlock();
+            batchesChanged.notify_all();
 
-        /*
-          Look for the _id value in the map; if it's not there, add a
-          new entry with a blank accumulator.
-        */
-        const size_t oldSize = groups.size();
-        vector<intrusive_ptr<Accumulator>>& group = groups[id];
-        const bool inserted = groups.size() != oldSize;
+            batch.clear();
+            batch.reserve(kParallelBatchSize);
+        }
+    } while (input);
 
-        if (inserted) {
-            memoryUsageBytes += id.getApproximateSize();
+    workerGuard.Dismiss();
+    stopWorkers(false);
 
-            // Add the accumulators
-            group.reserve(numAccumulators);
-            for (size_t i = 0; i < numAccumulators; i++) {
-                group.push_back(vpAccumulatorFactory[i]());
-            }
-        } else {
-            for (size_t i = 0; i < numAccumulators; i++) {
-                // subtract old mem usage. New usage added back after processing.
-                memoryUsageBytes -= group[i]->memUsageForSorter();
-            }
+    for (size_t i = 0; i < numThreads; i++) {
+        uassertStatusOK(statuses[i]);
+    }
+
+    intrusive_ptr<DocumentSourceGroup> merger =
+        static_cast<DocumentSourceGroup*>(getMergeSource().get());
+    for (size_t i = 0; i < numThreads; i++) {
+        partials[i]->readyGroupsForOutput();
+        while (boost::optional<Document> partialGroup = partials[i]->getNext()) {
+            merger->accumulateDocument(*partialGroup);
         }
+    }
+    merger->readyGroupsForOutput();
+
+    _parallelMerger = merger;
+    populated = true;
+}
+
+void DocumentSourceGroup::accumulateDocument(const Document& input) {
+    if (!_unwindPath) {
+        accumulateUnwoundDocument(input);
+        return;
+    }
+
+    // Produce what $unwind would: nothing for a missing, null or empty array, the document itself
+    // for a value that is not an array, and otherwise one document per element.
+    vector<Position> unwindPathPositions;
+    const Value array = input.getNestedField(*_unwindPath, &unwindPathPositions);
+    if (array.nullish())
+        return;
+
+    if (array.getType() != Array) {
+        accumulateUnwoundDocument(input);
+        return;
+    }
 
-        /* tickle all the accumulators for the group we found */
-        dassert(numAccumulators == group.size());
+    // The unwound documents differ only in the element at the unwind path, so a single copy of
+    // the input is updated in place for each one. The copy is cloned along the path by the first
+    // setNestedField(), after which it is only cloned again if an accumulator holds on to ROOT.
+    const size_t length = array.getArrayLength();
+    MutableDocument unwound(input);
+    for (size_t i = 0; i < length; i++) {
+        unwound.setNestedField(unwindPathPositions, array[i]);
+        accumulateUnwoundDocument(unwound.peek());
+    }
+}
+
+void DocumentSourceGroup::accumulateUnwoundDocument(const Document& input) {
+    _variables->setRoot(input);
+
+    /* get the _id value */
+    Value id = computeId(_variables.get());
+
+    /* treat missing values the same as NULL SERVER-4674 */
+    if (id.missing())
+        id = Value(BSONNULL);
+
+    accumulateIntoGroups(id);
+
+    // We are done with the ROOT document so release it.
+    _variables->clearRoot();
+}
+
+void DocumentSourceGroup::accumulateIntoGroups(const Value& id) {
+    const size_t numAccumulators = vpAccumulatorFactory.size();
+    dassert(numAccumulators == vpExpression.size());
+
+    if (_memoryUsageBytes > _maxMemoryUsageBytes) {
+        uassert(16945,
+                "Exceeded memory limit for $group, but didn't allow external sort."
+                " Pass allowDiskUse:true to opt in.",
+                _extSortAllowed);
+        _sortedFiles.push_back(spill());
+        _memoryUsageBytes = 0;
+    }
+
+    /*
+      Look for the _id value in the map; if it's not there, add a
+      new entry with a blank accumulator.
+    */
+    const size_t oldSize = groups.size();
+    vector<intrusive_ptr<Accumulator>>& group = groups[id];
+    const bool inserted = groups.size() != oldSize;
+
+    if (inserted) {
+        _memoryUsageBytes += id.getApproximateSize();
+
+        // Add the accumulators
+        group.reserve(numAccumulators);
         for (size_t i = 0; i < numAccumulators; i++) {
-            group[i]->process(vpExpression[i]->evaluate(_variables.get()), _doingMerge);
-            memoryUsageBytes += group[i]->memUsageForSorter();
+            group.push_back(vpAccumulatorFactory[i]());
         }
+    } else {
+        for (size_t i = 0; i < numAccumulators; i++) {
+            // subtract old mem usage. New usage added back after processing.
+            _memoryUsageBytes -= group[i]->memUsageForSorter();
+        }
+    }
 
-        // We are done with the ROOT document so release it.
-        _variables->clearRoot();
+    /* tickle all the accumulators for the group we found */
+    dassert(numAccumulators == group.size());
+    for (size_t i = 0; i < numAccumulators; i++) {
+        group[i]->process(vpExpression[i]->evaluate(_variables.get()), _doingMerge);
+        _memoryUsageBytes += group[i]->memUsageForSorter();
+    }
 
-        DEV {
-            // In debug mode, spill every time we have a duplicate id to stress merge logic.
-            if (!inserted  // is a dup
-                &&
-                !pExpCtx->inRouter  // can't spill to disk in router
-                &&
-                !_extSortAllowed  // don't change behavior when testing external sort
-                &&
-                sortedFiles.size() < 20  // don't open too many FDs
-                ) {
-                sortedFiles.push_back(spill());
-            }
+    DEV {
+        // In debug mode, spill every time we have a duplicate id to stress merge logic.
+        if (!inserted  // is a dup
+            &&
+            !pExpCtx->inRouter  // can't spill to disk in router
+            &&
+            !_extSortAllowed  // don't change behavior when testing external sort
+            &&
+            _sortedFiles.size() < 20  // don't open too many FDs
+            ) {
+            _sortedFiles.push_back(spill());
         }
     }
+}
+
+void DocumentSourceGroup::readyGroupsForOutput() {
+    const size_t numAccumulators = vpAccumulatorFactory.size();
 
     // These blocks do any final steps necessary to prepare to output results.
-    if (!sortedFiles.empty()) {
+    if (!_sortedFiles.empty()) {
         _spilled = true;
         if (!groups.empty()) {
-            sortedFiles.push_back(spill());
+            _sortedFiles.push_back(spill());
         }
 
         // We won't be using groups again so free its memory.
         GroupsMap().swap(groups);
 
         _sorterIterator.reset(
-            Sorter<Value, Value>::Iterator::merge(sortedFiles, SortOptions(), SorterComparator()));
+            Sorter<Value, Value>::Iterator::merge(_sortedFiles, SortOptions(), SorterComparator()));
+        _sortedFiles.clear();
 
         // prepare current to accumulate data
-        _currentAccumulators.reserve(numAccumulators);
-        for (size_t i = 0; i < numAccumulators; i++) {
-            _currentAccumulators.push_back(vpAccumulatorFactory[i]());
+        if (_currentAccumulators.empty()) {
+            _currentAccumulators.reserve(numAccumulators);
+            for (size_t i = 0; i < numAccumulators; i++) {
+                _currentAccumulators.push_back(vpAccumulatorFactory[i]());
+            }
         }
 
         verify(_sorterIterator->more());  // we put data in, we should get something out.
@@ -410,6 +670,83 @@ void DocumentSourceGroup::populate() {
     populated = true;
 }
 
+namespace {
+/**
+ * Returns true if the group key 'id' is, or for a compound _id has a component that is, an array.
+ */
+bool idContainsArray(const Value& id, bool compoundId) {
+    if (!compoundId)
+        return id.getType() == Array;
+
+    const vector<Value>& components = id.getArray();
+    for (size_t i = 0; i < components.size(); i++) {
+        if (components[i].getType() == Array)
+            return true;
+    }
+    return false;
+}
+}  // namespace
+
+boost::optional<Document> DocumentSourceGroup::getNextStreaming() {
+    const size_t numAccumulators = vpAccumulatorFactory.size();
+    boost::optional<Document> out;
+
+    while (!out) {
+        boost::optional<Document> input = pSource->getNext();
+        if (!input)
+            break;
+
+        _variables->setRoot(*input);
+
+        Value id = computeId(_variables.get());
+        if (id.missing())
+            id = Value(BSONNULL);
+
+        if (idContainsArray(id, _idExpressions.size() > 1)) {
+            // The input order only places a document among the others with equal keys if its key
+            // is not an array: a multikey index, for example, returns it at its first key. Group
+            // such documents in the map and output them once the input is exhausted.
+            accumulateIntoGroups(id);
+        } else {
+            if (!_currentId.missing() && Value::compare(id, _currentId) != 0) {
+                // The key changed, so the current group is complete.
+                out = makeDocument(_currentId, _currentAccumulators, pExpCtx->inShard);
+                for (size_t i = 0; i < numAccumulators; i++) {
+                    _currentAccumulators[i]->reset();
+                }
+            }
+
+            if (_currentAccumulators.empty()) {
+                _currentAccumulators.reserve(numAccumulators);
+                for (size_t i = 0; i < numAccumulators; i++) {
+                    _currentAccumulators.push_back(vpAccumulatorFactory[i]());
+                }
+            }
+
+            _currentId = id;
+            for (size_t i = 0; i < numAccumulators; i++) {
+                _currentAccumulators[i]->process(vpExpression[i]->evaluate(_variables.get()),
+                                                 _doingMerge);
+            }
+        }
+
+        _variables->clearRoot();
+    }
+
+    if (out)
+        return out;
+
+    // The input is exhausted. Output the last streamed group, and leave any groups with array keys
+    // to be returned by the non-streaming code path.
+    if (!_currentId.missing()) {
+        out = makeDocument(_currentId, _currentAccumulators, pExpCtx->inShard);
+        _currentId = Value();
+    }
+
+    readyGroupsForOutput();
+    return out;
+}
+
 class DocumentSourceGroup::SpillSTLComparator {
 public:
     bool operator()(const GroupsMap::value_type* lhs, const GroupsMap::value_type* rhs) const {
@@ -97,6 +97,7 @@ vector<DBClientCursor*> DocumentSourceMergeCursors::getCursors() {
     start();
     vector<DBClientCursor*> out;
     for (Cursors::const_iterator it = _cursors.begin(); it != _cursors.end(); ++it) {
+        awaitFirstBatch(it->get());
         out.push_back(&((*it)->cursor));
     }
 
@@ -112,20 +113,26 @@ void DocumentSourceMergeCursors::start() {
             std::make_shared<CursorAndConnection>(it->first, pExpCtx->ns, it->second));
         verify(_cursors.back()->connection->lazySupported());
         _cursors.back()->cursor.initLazy();  // shouldn't block
+        _cursors.back()->awaitingFirstBatch = true;
     }
 
-    // wait for all cursors to return a batch
+    // The first batches are read as the cursors are visited, so documents from the shards which
+    // answer first are not held back by the slowest shard.
     // TODO need a way to keep cursors alive if some take longer than 10 minutes.
-    for (Cursors::const_iterator it = _cursors.begin(); it != _cursors.end(); ++it) {
-        bool retry = false;
-        bool ok = (*it)->cursor.initLazyFinish(retry);  // blocks here for first batch
+    _currentCursor = _cursors.begin();
+}
 
-        uassert(
-            17028, "error reading response from " + _cursors.back()->connection->toString(), ok);
-        verify(!retry);
+void DocumentSourceMergeCursors::awaitFirstBatch(CursorAndConnection* cursorAndConn) {
+    if (!cursorAndConn->awaitingFirstBatch) {
+        return;
     }
 
-    _currentCursor = _cursors.begin();
+    cursorAndConn->awaitingFirstBatch = false;
+    bool retry = false;
+    bool ok = cursorAndConn->cursor.initLazyFinish(retry);  // blocks here for first batch
+
+    uassert(17028, "error reading response from " + cursorAndConn->connection->toString(), ok);
+    verify(!retry);
 }
 
 Document DocumentSourceMergeCursors::nextSafeFrom(DBClientCursor* cursor) {
@@ -143,8 +150,26 @@ boost::optional<Document> DocumentSourceMergeCursors::getNext() {
     if (_unstarted)
         start();
 
+    // Prefer a cursor which already has documents buffered, starting from the current one, so
+    // that we only block on the network once every received batch has been consumed.
+    auto it = _currentCursor;
+    for (size_t i = 0; i < _cursors.size(); ++i) {
+        if (!(*it)->awaitingFirstBatch && (*it)->cursor.moreInCurrentBatch()) {
+            _currentCursor = it;
+            break;
+        }
+
+        if (++it == _cursors.end())
+            it = _cursors.begin();
+    }
+
     // purge eof cursors and release their connections
-    while (!_cursors.empty() && !(*_currentCursor)->cursor.more()) {
+    while (!_cursors.empty()) {
+        awaitFirstBatch(_currentCursor->get());
+        if ((*_currentCursor)->cursor.more()) {
+            break;
+        }
+
         (*_currentCursor)->connection.done();
         _cursors.erase(_currentCursor);
         _currentCursor = _cursors.begin();
@@ -164,9 +189,19 @@ boost::optional<Document> DocumentSourceMergeCursors::getNext() {
 
 void DocumentSourceMergeCursors::dispose() {
     // Note it is an error to call done() on a connection before consuming the response from a
-    // request. Therefore it is an error to call dispose() if there are any outstanding connections
-    // which have not received a reply.
+    // request. Therefore the replies to first batch requests which were never visited are read
+    // here, and it is an error to call dispose() while a getMore is outstanding.
     for (auto&& cursorAndConn : _cursors) {
+        if (cursorAndConn->awaitingFirstBatch) {
+            // Read the outstanding reply first. If that fails the connection is not returned to
+            // the pool, and the shard times the cursor out.
+            try {
+                awaitFirstBatch(cursorAndConn.get());
+            } catch (const DBException&) {
+                continue;
+            }
+        }
+
         cursorAndConn->cursor.kill();
         cursorAndConn->connection.done();
     }
@@ -26,10 +26,15 @@
  * it in the license file.
  */
 
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/pipeline/document_source.h"
 
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
+
 namespace mongo {
 
 using boost::intrusive_ptr;
@@ -90,21 +95,39 @@ void DocumentSourceOut::prepTempCollection() {
                 ok);
     }
 
-    // copy indexes on _outputNs to _tempNs
+    // Remember the indexes on _outputNs so that buildIndexes() can copy them to _tempNs once it
+    // holds all of the output. The create command already built the _id index.
     const std::list<BSONObj> indexes = conn->getIndexSpecs(_outputNs.ns());
     for (std::list<BSONObj>::const_iterator it = indexes.begin(); it != indexes.end(); ++it) {
+        if (it->getStringField("name") == StringData("_id_")) {
+            continue;
+        }
+
         MutableDocument index((Document(*it)));
         index.remove("_id");  // indexes shouldn't have _ids but some existing ones do
         index["ns"] = Value(_tempNs.ns());
+        _indexesToBuild.push_back(index.freeze().toBson());
+    }
+}
 
-        BSONObj indexBson = index.freeze().toBson();
-        conn->insert(_tempNs.getSystemIndexesCollection(), indexBson);
-        BSONObj err = conn->getLastErrorDetailed();
-        uassert(16995,
-                str::stream() << "copying index for $out failed."
-                              << " index: " << indexBson << " error: " << err,
-                DBClientWithCommands::getLastErrorString(err).empty());
+void DocumentSourceOut::buildIndexes() {
+    if (_indexesToBuild.empty()) {
+        return;
     }
+
+    // Building every index in one command over the full collection lets them all be built from
+    // one scan with bulk loading, rather than updating each index document by document.
+    BSONObjBuilder cmd;
+    cmd << "createIndexes" << _tempNs.coll();
+    cmd.append("indexes", _indexesToBuild);
+
+    BSONObj info;
+    bool ok = _mongod->directClient()->runCommand(_tempNs.db().toString(), cmd.done(), info);
+    uassert(16995,
+            str::stream() << "copying indexes for $out failed."
+                          << " indexes: " << BSON("indexes" << _indexesToBuild)
+                          << " error: " << info,
+            ok);
 }
 
 void DocumentSourceOut::spill(const vector<BSONObj>& toInsert) {
@@ -128,10 +151,16 @@ boost::optional<Document> DocumentSourceOut::getNext() {
     prepTempCollection();
     verify(_tempNs.size() != 0);
 
+    Timer insertTimer;
+    long long docsWritten = 0;
+    long long bytesWritten = 0;
+
     vector<BSONObj> bufferedObjects;
     int bufferedBytes = 0;
     while (boost::optional<Document> next = pSource->getNext()) {
         BSONObj toInsert = next->toBson();
+        ++docsWritten;
+        bytesWritten += toInsert.objsize();
         bufferedBytes += toInsert.objsize();
         if (!bufferedObjects.empty() && bufferedBytes > BSONObjMaxUserSize) {
             spill(bufferedObjects);
@@ -144,6 +173,13 @@ boost::optional<Document> DocumentSourceOut::getNext() {
     if (!bufferedObjects.empty())
         spill(bufferedObjects);
 
+    const long long insertMillis = insertTimer.millis();
+    Timer indexTimer;
+    buildIndexes();
+    LOG(1) << "$out to " << _outputNs << " inserted " << docsWritten << " documents ("
+           << bytesWritten << " bytes) in " << insertMillis << "ms and built "
+           << _indexesToBuild.size() << " indexes in " << indexTimer.millis() << "ms";
+
     // Checking again to make sure we didn't become sharded while running.
     uassert(17018,
             str::stream() << "namespace '" << _outputNs.ns()
@@ -32,6 +32,7 @@
 #include "mongo/db/pipeline/dependencies.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_noop.h"
 #include "mongo/db/storage_options.h"
@@ -877,6 +878,182 @@ public:
     }
 };
 
+/** A streaming $group returns each group as soon as a document with the next key arrives. */
+class StreamingReturnsGroupsBeforeInputIsExhausted : public Base {
+public:
+    void run() {
+        createGroup(fromjson("{_id:'$a',b:{$sum:'$b'}}"));
+        static_cast<DocumentSourceGroup*>(group())->setStreaming(true);
+        auto source =
+            DocumentSourceMock::create({"{a:1,b:1}", "{a:1,b:2}", "{a:2,b:3}", "{a:3,b:4}"});
+        group()->setSource(source.get());
+
+        boost::optional<Document> next = group()->getNext();
+        ASSERT(bool(next));
+        ASSERT_EQUALS(fromjson("{_id:1,b:3}"), next->toBson());
+        // Only the documents up to the first one of the next group have been read.
+        ASSERT_EQUALS(1U, source->queue.size());
+
+        next = group()->getNext();
+        ASSERT(bool(next));
+        ASSERT_EQUALS(fromjson("{_id:2,b:3}"), next->toBson());
+        next = group()->getNext();
+        ASSERT(bool(next));
+        ASSERT_EQUALS(fromjson("{_id:3,b:4}"), next->toBson());
+        assertExhausted(group());
+    }
+};
+
+/**
+ * A streaming $group does not rely on the input order for array keys, which a multikey index
+ * returns at their first key, but groups them with the non-streaming logic after the input ends.
+ */
+class StreamingGroupsArrayKeysAtEnd : public CheckResultsBase {
+public:
+    void run() {
+        createGroup(groupSpec());
+        static_cast<DocumentSourceGroup*>(group())->setStreaming(true);
+        auto source = DocumentSourceMock::create(inputData());
+        group()->setSource(source.get());
+        checkResultSet(group());
+    }
+
+private:
+    std::deque<Document> inputData() {
+        return {DOC("a" << BSON_ARRAY(1 << 3)),
+                DOC("a" << 1),
+                DOC("a" << BSON_ARRAY(1 << 3)),
+                DOC("a" << 2)};
+    }
+    BSONObj groupSpec() {
+        return fromjson("{_id:'$a',n:{$sum:1}}");
+    }
+    string expectedResultSetString() {
+        return "[{_id:1,n:1},{_id:2,n:1},{_id:[1,3],n:2}]";
+    }
+};
+
+/** A $group spread across several threads combines their partial groups into the same results. */
+class GroupInParallel : public CheckResultsBase {
+public:
+    void run() {
+        const int oldThreads = internalDocumentSourceGroupThreads;
+        internalDocumentSourceGroupThreads = 3;
+        CheckResultsBase::run();
+        internalDocumentSourceGroupThreads = oldThreads;
+    }
+
+private:
+    static const int kNumDocs = 10000;
+    static const int kNumGroups = 7;
+
+    std::deque<Document> inputData() {
+        std::deque<Document> docs;
+        for (int i = 0; i < kNumDocs; i++) {
+            docs.push_back(DOC("a" << i % kNumGroups << "b" << i));
+        }
+        return docs;
+    }
+    BSONObj groupSpec() {
+        return fromjson(
+            "{_id:{a:'$a'},count:{$sum:1},total:{$sum:'$b'},avg:{$avg:'$b'},max:{$max:'$b'}}");
+    }
+    BSONObj expectedResultSet() {
+        BSONArrayBuilder expected;
+        for (int group = 0; group < kNumGroups; group++) {
+            int count = 0;
+            int total = 0;
+            int max = 0;
+            for (int i = group; i < kNumDocs; i += kNumGroups) {
+                count++;
+                total += i;
+                max = i;
+            }
+            expected << BSON("_id" << BSON("a" << group) << "count" << count << "total" << total
+                                   << "avg" << static_cast<double>(total) / count << "max"
+                                   << max);
+        }
+        return expected.arr();
+    }
+};
+
+/**
+ * A $group that absorbed a $unwind accumulates what the $unwind would have returned, even when an
+ * accumulator keeps the unwound documents, whether or not it runs across several threads.
+ */
+class AbsorbedUnwind : public CheckResultsBase {
+public:
+    void run() {
+        checkAbsorbedUnwind();
+
+        const int oldThreads = internalDocumentSourceGroupThreads;
+        internalDocumentSourceGroupThreads = 3;
+        checkAbsorbedUnwind();
+        internalDocumentSourceGroupThreads = oldThreads;
+    }
+
+private:
+    void checkAbsorbedUnwind() {
+        createGroup(groupSpec());
+        DocumentSourceGroup* absorbing = static_cast<DocumentSourceGroup*>(group());
+        ASSERT(absorbing->absorbUnwind(FieldPath("a.b")));
+        ASSERT_FALSE(absorbing->absorbUnwind(FieldPath("c")));
+        auto source = DocumentSourceMock::create(inputData());
+        group()->setSource(source.get());
+        checkResultSet(group());
+    }
+
+    std::deque<Document> inputData() {
+        return {DOC("a" << DOC("b" << BSON_ARRAY(1 << 2 << 1)) << "c" << 1),
+                DOC("a" << DOC("b" << BSONArray()) << "c" << 2),
+                DOC("a" << DOC("b" << BSONNULL) << "c" << 3),
+                DOC("c" << 4),
+                DOC("a" << DOC("b" << 2) << "c" << 5)};
+    }
+    BSONObj groupSpec() {
+        return fromjson("{_id:'$a.b',cs:{$push:'$c'},docs:{$push:'$$ROOT'}}");
+    }
+    string expectedResultSetString() {
+        return "[{_id:1,cs:[1,1],docs:[{a:{b:1},c:1},{a:{b:1},c:1}]},"
+               "{_id:2,cs:[1,5],docs:[{a:{b:2},c:1},{a:{b:2},c:5}]}]";
+    }
+};
+
+/** Groups are contiguous when the _id fields are exactly the fields of a sort prefix. */
+class GroupsAreContiguousInSortOrder : public Base {
+public:
+    void run() {
+        createGroup(fromjson("{_id:'$a'}"));
+        ASSERT(contiguousIn("{a:1}"));
+        ASSERT(contiguousIn("{a:-1,b:1}"));
+        ASSERT_FALSE(contiguousIn("{b:1,a:1}"));
+        ASSERT_FALSE(contiguousIn("{a:{$meta:'textScore'}}"));
+        ASSERT_FALSE(contiguousIn("{}"));
+
+        createGroup(fromjson("{_id:'$$ROOT.a.b'}"));
+        ASSERT(contiguousIn("{'a.b':1}"));
+        ASSERT_FALSE(contiguousIn("{a:1}"));
+
+        createGroup(fromjson("{_id:{x:'$a',y:'$b'}}"));
+        ASSERT(contiguousIn("{b:1,a:-1}"));
+        ASSERT(contiguousIn("{a:1,b:1,c:1}"));
+        ASSERT_FALSE(contiguousIn("{a:1}"));
+        ASSERT_FALSE(contiguousIn("{a:1,c:1,b:1}"));
+
+        createGroup(fromjson("{_id:{$add:['$a',1]}}"));
+        ASSERT_FALSE(contiguousIn("{a:1}"));
+
+        createGroup(fromjson("{_id:null}"));
+        ASSERT_FALSE(contiguousIn("{a:1}"));
+    }
+
+private:
+    bool contiguousIn(const char* sortPattern) {
+        return static_cast<DocumentSourceGroup*>(group())
+            ->groupsAreContiguousInSortOrder(fromjson(sortPattern));
+    }
+};
+
 }  // namespace DocumentSourceGroup
 
 namespace DocumentSourceProject {
@@ -2263,6 +2440,11 @@ public:
         add<DocumentSourceGroup::Dependencies>();
         add<DocumentSourceGroup::StringConstantIdAndAccumulatorExpressions>();
         add<DocumentSourceGroup::ArrayConstantAccumulatorExpression>();
+        add<DocumentSourceGroup::StreamingReturnsGroupsBeforeInputIsExhausted>();
+        add<DocumentSourceGroup::StreamingGroupsArrayKeysAtEnd>();
+        add<DocumentSourceGroup::GroupInParallel>();
+        add<DocumentSourceGroup::AbsorbedUnwind>();
+        add<DocumentSourceGroup::GroupsAreContiguousInSortOrder>();
 
         add<DocumentSourceProject::Inclusion>();
         add<DocumentSourceProject::Optimize>();
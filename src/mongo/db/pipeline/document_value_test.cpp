@@ -537,6 +537,99 @@ TEST(MetaFields, BadSerialization) {
 }
 }  // namespace MetaFields
 
+namespace LazyBson {
+using mongo::Document;
+
+TEST(LazyBson, UnmodifiedDocumentReturnsItsBson) {
+    BSONObj bson = fromjson("{a: 1, b: {c: 2}, d: 'x'}");
+    Document doc(bson);
+    ASSERT_EQ(2, doc["b"]["c"].getInt());
+    ASSERT_EQ(3U, doc.size());
+    ASSERT_FALSE(doc.empty());
+    ASSERT_EQ(bson.objdata(), doc.toBson().objdata());
+
+    BSONObjBuilder bob;
+    bob.append("before", 0);
+    doc.toBson(&bob);
+    ASSERT_EQ(fromjson("{before: 0, a: 1, b: {c: 2}, d: 'x'}"), bob.obj());
+}
+
+TEST(LazyBson, LookupsInAnyOrderKeepFieldOrder) {
+    Document doc(fromjson("{a: 1, b: 2, c: 3, d: 4, e: 5, f: 6}"));
+    ASSERT_EQ(5, doc["e"].getInt());
+    ASSERT(doc["z"].missing());
+    ASSERT_EQ(1, doc["a"].getInt());
+    ASSERT_EQ(6, doc["f"].getInt());
+
+    FieldIterator it(doc);
+    for (char name = 'a'; name <= 'f'; name++) {
+        ASSERT(it.more());
+        Document::FieldPair field = it.next();
+        ASSERT_EQ(std::string(1, name), field.first.toString());
+        ASSERT_EQ(name - 'a' + 1, field.second.getInt());
+    }
+    ASSERT_FALSE(it.more());
+}
+
+TEST(LazyBson, FirstOfDuplicateFieldsIsFound) {
+    Document doc(fromjson("{a: 1, b: 2, a: 3}"));
+    ASSERT_EQ(1, doc["a"].getInt());
+    ASSERT_EQ(3U, doc.size());
+}
+
+TEST(LazyBson, ModifyingForgetsBson) {
+    BSONObj bson = fromjson("{a: 1, b: 2, c: 3}");
+    Document doc(bson);
+    const Position pos = doc.positionOf("b");
+
+    MutableDocument md(doc);
+    md.setField(pos, mongo::Value(20));
+    md.addField("d", mongo::Value(4));
+    Document modified = md.freeze();
+    ASSERT_EQ(fromjson("{a: 1, b: 20, c: 3, d: 4}"), modified.toBson());
+
+    // The original is unaffected.
+    ASSERT_EQ(bson.objdata(), doc.toBson().objdata());
+    ASSERT_EQ(2, doc["b"].getInt());
+}
+
+TEST(LazyBson, CloneConvertsRemainingFieldsIndependently) {
+    Document doc(fromjson("{a: 1, b: 2, c: 3, d: 4, e: 5}"));
+    ASSERT_EQ(2, doc["b"].getInt());
+    Document clone = doc.clone();
+    ASSERT_EQ(5, clone["e"].getInt());
+    ASSERT_EQ(3, doc["c"].getInt());
+    ASSERT_EQ(doc, clone);
+}
+
+TEST(LazyBson, UnownedBsonIsConvertedUpFront) {
+    BSONObj owner = fromjson("{sub: {a: 1, b: 'x'}}");
+    Document doc(owner["sub"].embeddedObject());
+    ASSERT_NOT_EQUALS(owner["sub"].embeddedObject().objdata(), doc.toBson().objdata());
+    ASSERT_EQ(fromjson("{a: 1, b: 'x'}"), doc.toBson());
+}
+
+TEST(LazyBson, ApproximateSizeIncludesUnconvertedFields) {
+    BSONObj bson = BSON("a" << std::string(1000, 'x') << "b" << 1);
+    Document doc(bson);
+    ASSERT_GTE(doc.getApproximateSize(), static_cast<size_t>(bson.objsize()));
+    ASSERT_EQ(1, doc["b"].getInt());
+    ASSERT_GTE(doc.getApproximateSize(), static_cast<size_t>(bson.objsize()));
+}
+
+TEST(LazyBson, MetaFieldsAreStillParsed) {
+    Document doc = Document::fromBsonWithMetaData(fromjson("{a: 1, $textScore: 2.5}"));
+    ASSERT_TRUE(doc.hasTextScore());
+    ASSERT_EQ(2.5, doc.getTextScore());
+    ASSERT_EQ(fromjson("{a: 1}"), doc.toBson());
+
+    BSONObj plain = fromjson("{a: 1, $other: 2}");
+    Document plainDoc = Document::fromBsonWithMetaData(plain);
+    ASSERT_FALSE(plainDoc.hasTextScore());
+    ASSERT_EQ(plain.objdata(), plainDoc.toBson().objdata());
+}
+}  // namespace LazyBson
+
 namespace Value {
 
 using mongo::Value;
@@ -50,6 +50,7 @@ using namespace mongoutils;
 using boost::intrusive_ptr;
 using std::set;
 using std::string;
+using std::unique_ptr;
 using std::vector;
 
 /// Helper function to easily wrap constants with $const.
@@ -357,6 +358,154 @@ intrusive_ptr<Expression> Expression::parseOperand(BSONElement exprElement,
 }
 
 
+/* ----------------------- CompiledArithmetic ---------------------------- */
+
+unique_ptr<CompiledArithmetic> CompiledArithmetic::compile(const Expression* expr) {
+    unique_ptr<CompiledArithmetic> program(new CompiledArithmetic());
+    if (!program->compileInto(expr, 0))
+        return {};
+    return program;
+}
+
+bool CompiledArithmetic::compileInto(const Expression* expr, size_t depth) {
+    Instruction::Op op;
+    if (dynamic_cast<const ExpressionAdd*>(expr)) {
+        op = Instruction::kAdd;
+    } else if (dynamic_cast<const ExpressionMultiply*>(expr)) {
+        op = Instruction::kMultiply;
+    } else if (dynamic_cast<const ExpressionSubtract*>(expr)) {
+        op = Instruction::kSubtract;
+    } else if (dynamic_cast<const ExpressionDivide*>(expr)) {
+        op = Instruction::kDivide;
+    } else {
+        return false;
+    }
+
+    // Each operand's value goes on the stack above the values of the operands before it.
+    const auto& operands = static_cast<const ExpressionNary*>(expr)->getOperands();
+    for (size_t i = 0; i < operands.size(); ++i) {
+        const size_t operandDepth = depth + i;
+        if (operandDepth >= kMaxStackDepth)
+            return false;
+
+        const Expression* operand = operands[i].get();
+        if (dynamic_cast<const ExpressionFieldPath*>(operand)) {
+            _code.push_back({Instruction::kPushField, _fields.size()});
+            _fields.push_back(operands[i]);
+        } else if (auto constant = dynamic_cast<const ExpressionConstant*>(operand)) {
+            const Value val = constant->getValue();
+            if (!val.numeric())
+                return false;
+            _code.push_back({Instruction::kPushConstant, _constants.size()});
+            _constants.push_back(toNumber(val));
+        } else if (!compileInto(operand, operandDepth)) {
+            return false;
+        }
+    }
+
+    _code.push_back({op, operands.size()});
+    return true;
+}
+
+CompiledArithmetic::Number CompiledArithmetic::toNumber(const Value& val) {
+    switch (val.getType()) {
+        case NumberInt:
+            return fromLong(NumberInt, val.getInt());
+        case NumberLong:
+            return fromLong(NumberLong, val.getLong());
+        default:
+            invariant(val.getType() == NumberDouble);
+            return fromDouble(val.getDouble());
+    }
+}
+
+CompiledArithmetic::Number CompiledArithmetic::fromLong(BSONType type, long long longValue) {
+    // Like Value::createIntOrLong(), an int result that doesn't fit in an int becomes a long.
+    if (type == NumberInt && static_cast<int>(longValue) != longValue)
+        type = NumberLong;
+    return {type, longValue, static_cast<double>(longValue)};
+}
+
+CompiledArithmetic::Number CompiledArithmetic::fromDouble(double doubleValue) {
+    // The interpreter only uses the integral total of an $add or $multiply when none of the
+    // operands are doubles, so a double has no need for a long representation.
+    return {NumberDouble, 0, doubleValue};
+}
+
+bool CompiledArithmetic::run(Variables* vars, Value* result) const {
+    Number stack[kMaxStackDepth];
+    size_t depth = 0;
+
+    for (const Instruction& instruction : _code) {
+        switch (instruction.op) {
+            case Instruction::kPushField: {
+                const Value val = static_cast<const ExpressionFieldPath*>(
+                                      _fields[instruction.arg].get())->evaluateInternal(vars);
+                if (!val.numeric())
+                    return false;
+                stack[depth++] = toNumber(val);
+                break;
+            }
+            case Instruction::kPushConstant:
+                stack[depth++] = _constants[instruction.arg];
+                break;
+            case Instruction::kAdd:
+            case Instruction::kMultiply: {
+                // As in ExpressionAdd and ExpressionMultiply, the double and integral results are
+                // computed in parallel, tracking the narrowest type that holds the result.
+                const bool isAdd = instruction.op == Instruction::kAdd;
+                BSONType type = NumberInt;
+                long long longResult = isAdd ? 0 : 1;
+                double doubleResult = isAdd ? 0 : 1;
+
+                depth -= instruction.arg;
+                for (size_t i = depth; i < depth + instruction.arg; ++i) {
+                    type = Value::getWidestNumeric(type, stack[i].type);
+                    if (isAdd) {
+                        longResult += stack[i].longValue;
+                        doubleResult += stack[i].doubleValue;
+                    } else {
+                        longResult *= stack[i].longValue;
+                        doubleResult *= stack[i].doubleValue;
+                    }
+                }
+
+                stack[depth++] =
+                    type == NumberDouble ? fromDouble(doubleResult) : fromLong(type, longResult);
+                break;
+            }
+            case Instruction::kSubtract: {
+                const Number rhs = stack[--depth];
+                const Number lhs = stack[--depth];
+                const BSONType type = Value::getWidestNumeric(lhs.type, rhs.type);
+                stack[depth++] = type == NumberDouble
+                    ? fromDouble(lhs.doubleValue - rhs.doubleValue)
+                    : fromLong(type, lhs.longValue - rhs.longValue);
+                break;
+            }
+            case Instruction::kDivide: {
+                const Number rhs = stack[--depth];
+                const Number lhs = stack[--depth];
+                if (rhs.doubleValue == 0)
+                    return false;  // Let the interpreter report the division by zero.
+                stack[depth++] = fromDouble(lhs.doubleValue / rhs.doubleValue);
+                break;
+            }
+        }
+    }
+
+    invariant(depth == 1);
+    const Number& number = stack[0];
+    if (number.type == NumberInt) {
+        *result = Value(static_cast<int>(number.longValue));
+    } else if (number.type == NumberLong) {
+        *result = Value(number.longValue);
+    } else {
+        *result = Value(number.doubleValue);
+    }
+    return true;
+}
+
 /* ----------------------- ExpressionAbs ---------------------------- */
 
 Value ExpressionAbs::evaluateNumericArg(const Value& numericArg) const {
@@ -380,7 +529,21 @@ const char* ExpressionAbs::getOpName() const {
 
 /* ------------------------- ExpressionAdd ----------------------------- */
 
+intrusive_ptr<Expression> ExpressionAdd::optimize() {
+    // Drop any earlier program first: ExpressionNary::optimize() evaluates this expression when
+    // folding constants, and may change the operands.
+    _program.reset();
+    intrusive_ptr<Expression> optimized = ExpressionNary::optimize();
+    if (optimized.get() == this)
+        _program = CompiledArithmetic::compile(this);
+    return optimized;
+}
+
 Value ExpressionAdd::evaluateInternal(Variables* vars) const {
+    Value result;
+    if (_program && _program->run(vars, &result))
+        return result;
+
     /*
       We'll try to return the narrowest possible result value.  To do that
       without creating intermediate Values, do the arithmetic for double
@@ -1133,7 +1296,21 @@ const char* ExpressionDayOfYear::getOpName() const {
 
 /* ----------------------- ExpressionDivide ---------------------------- */
 
+intrusive_ptr<Expression> ExpressionDivide::optimize() {
+    // Drop any earlier program first: ExpressionNary::optimize() evaluates this expression when
+    // folding constants, and may change the operands.
+    _program.reset();
+    intrusive_ptr<Expression> optimized = ExpressionNary::optimize();
+    if (optimized.get() == this)
+        _program = CompiledArithmetic::compile(this);
+    return optimized;
+}
+
 Value ExpressionDivide::evaluateInternal(Variables* vars) const {
+    Value result;
+    if (_program && _program->run(vars, &result))
+        return result;
+
     Value lhs = vpOperand[0]->evaluateInternal(vars);
     Value rhs = vpOperand[1]->evaluateInternal(vars);
 
@@ -2008,7 +2185,21 @@ const char* ExpressionMonth::getOpName() const {
 
 /* ------------------------- ExpressionMultiply ----------------------------- */
 
+intrusive_ptr<Expression> ExpressionMultiply::optimize() {
+    // Drop any earlier program first: ExpressionNary::optimize() evaluates this expression when
+    // folding constants, and may change the operands.
+    _program.reset();
+    intrusive_ptr<Expression> optimized = ExpressionNary::optimize();
+    if (optimized.get() == this)
+        _program = CompiledArithmetic::compile(this);
+    return optimized;
+}
+
 Value ExpressionMultiply::evaluateInternal(Variables* vars) const {
+    Value result;
+    if (_program && _program->run(vars, &result))
+        return result;
+
     /*
       We'll try to return the narrowest possible result value.  To do that
       without creating intermediate Values, do the arithmetic for double
@@ -2924,7 +3115,21 @@ const char* ExpressionSubstr::getOpName() const {
 
 /* ----------------------- ExpressionSubtract ---------------------------- */
 
+intrusive_ptr<Expression> ExpressionSubtract::optimize() {
+    // Drop any earlier program first: ExpressionNary::optimize() evaluates this expression when
+    // folding constants, and may change the operands.
+    _program.reset();
+    intrusive_ptr<Expression> optimized = ExpressionNary::optimize();
+    if (optimized.get() == this)
+        _program = CompiledArithmetic::compile(this);
+    return optimized;
+}
+
 Value ExpressionSubtract::evaluateInternal(Variables* vars) const {
+    Value result;
+    if (_program && _program->run(vars, &result))
+        return result;
+
     Value lhs = vpOperand[0]->evaluateInternal(vars);
     Value rhs = vpOperand[1]->evaluateInternal(vars);
 
@@ -32,6 +32,7 @@
 
 #include <boost/intrusive_ptr.hpp>
 #include <map>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -358,6 +359,10 @@ public:
 
     static ExpressionVector parseArguments(BSONElement bsonExpr, const VariablesParseState& vps);
 
+    const ExpressionVector& getOperands() const {
+        return vpOperand;
+    }
+
 protected:
     ExpressionNary() {}
 
@@ -480,6 +485,67 @@ public:
 };
 
 
+/**
+ * A tree of $add, $subtract, $multiply and $divide expressions over field paths and numeric
+ * constants, flattened into a postfix program that runs without virtual calls or intermediate
+ * Values. The program only handles int, long and double operands and nonzero divisors; for any
+ * other input (dates, nulls, missing fields, other types) run() gives up and the caller evaluates
+ * the expression tree as usual, which is also what reports any errors.
+ */
+class CompiledArithmetic {
+public:
+    /**
+     * Returns a program computing 'expr', or an empty pointer if 'expr' is not an arithmetic
+     * expression or has operands that aren't arithmetic expressions, field paths or numeric
+     * constants.
+     */
+    static std::unique_ptr<CompiledArithmetic> compile(const Expression* expr);
+
+    /**
+     * Computes the expression into '*result' and returns true, or returns false without touching
+     * '*result' if these inputs have to be handled by the interpreter.
+     */
+    bool run(Variables* vars, Value* result) const;
+
+private:
+    // Deeper programs are rejected so that run() can keep its stack in a local array.
+    static const size_t kMaxStackDepth = 32;
+
+    // An int, long or double. Both representations are kept so that mixed-type arithmetic can
+    // follow the interpreter's rules without converting on every use.
+    struct Number {
+        BSONType type;
+        long long longValue;
+        double doubleValue;
+    };
+
+    struct Instruction {
+        enum Op { kPushField, kPushConstant, kAdd, kMultiply, kSubtract, kDivide };
+
+        Op op;
+        // The index into '_fields' or '_constants' for a push; the number of operands for an
+        // $add or $multiply.
+        size_t arg;
+    };
+
+    CompiledArithmetic() = default;
+
+    /**
+     * Appends the instructions computing 'expr' to '_code', where 'depth' values are already on
+     * the stack. Returns false if 'expr' can't be compiled.
+     */
+    bool compileInto(const Expression* expr, size_t depth);
+
+    static Number toNumber(const Value& val);
+    static Number fromLong(BSONType type, long long longValue);
+    static Number fromDouble(double doubleValue);
+
+    std::vector<Instruction> _code;
+    std::vector<boost::intrusive_ptr<Expression>> _fields;  // All ExpressionFieldPaths.
+    std::vector<Number> _constants;
+};
+
+
 class ExpressionAbs final : public ExpressionSingleNumericArg<ExpressionAbs> {
     Value evaluateNumericArg(const Value& numericArg) const final;
     const char* getOpName() const final;
@@ -488,11 +554,16 @@ class ExpressionAbs final : public ExpressionSingleNumericArg<ExpressionAbs> {
 
 class ExpressionAdd final : public ExpressionVariadic<ExpressionAdd> {
 public:
+    boost::intrusive_ptr<Expression> optimize() final;
     Value evaluateInternal(Variables* vars) const final;
     const char* getOpName() const final;
     bool isAssociativeAndCommutative() const final {
         return true;
     }
+
+private:
+    // Set by optimize() if this expression can be run as a CompiledArithmetic program.
+    std::unique_ptr<CompiledArithmetic> _program;
 };
 
 
@@ -708,8 +779,13 @@ public:
 
 class ExpressionDivide final : public ExpressionFixedArity<ExpressionDivide, 2> {
 public:
+    boost::intrusive_ptr<Expression> optimize() final;
     Value evaluateInternal(Variables* vars) const final;
     const char* getOpName() const final;
+
+private:
+    // Set by optimize() if this expression can be run as a CompiledArithmetic program.
+    std::unique_ptr<CompiledArithmetic> _program;
 };
 
 
@@ -938,11 +1014,16 @@ public:
 
 class ExpressionMultiply final : public ExpressionVariadic<ExpressionMultiply> {
 public:
+    boost::intrusive_ptr<Expression> optimize() final;
     Value evaluateInternal(Variables* vars) const final;
     const char* getOpName() const final;
     bool isAssociativeAndCommutative() const final {
         return true;
     }
+
+private:
+    // Set by optimize() if this expression can be run as a CompiledArithmetic program.
+    std::unique_ptr<CompiledArithmetic> _program;
 };
 
 
@@ -1191,8 +1272,13 @@ public:
 
 class ExpressionSubtract final : public ExpressionFixedArity<ExpressionSubtract, 2> {
 public:
+    boost::intrusive_ptr<Expression> optimize() final;
     Value evaluateInternal(Variables* vars) const final;
     const char* getOpName() const final;
+
+private:
+    // Set by optimize() if this expression can be run as a CompiledArithmetic program.
+    std::unique_ptr<CompiledArithmetic> _program;
 };
 
 
@@ -1479,6 +1479,101 @@ TEST(ExpressionFromAccumulators, StdDevSamp) {
                            {{}, Value(BSONNULL)}});
 }
 
+namespace {
+intrusive_ptr<Expression> parseExpression(const BSONObj& spec) {
+    VariablesIdGenerator idGenerator;
+    VariablesParseState vps(&idGenerator);
+    return Expression::parseOperand(BSON("" << spec).firstElement(), vps);
+}
+}  // namespace
+
+TEST(CompiledArithmeticTest, CompilesArithmeticOverFieldPathsAndNumbers) {
+    ASSERT(CompiledArithmetic::compile(parseExpression(BSON("$add" << BSON_ARRAY("$a" << 1)))
+                                           .get()));
+    ASSERT(CompiledArithmetic::compile(
+        parseExpression(BSON("$subtract" << BSON_ARRAY(BSON("$multiply" << BSON_ARRAY("$a" << 2.5))
+                                                       << BSON("$divide" << BSON_ARRAY("$b"
+                                                                                       << "$c")))))
+            .get()));
+
+    // Anything else in the tree means the interpreter has to evaluate it.
+    ASSERT_FALSE(CompiledArithmetic::compile(
+        parseExpression(BSON("$add" << BSON_ARRAY("$a" << BSON("$abs"
+                                                               << "$b")))).get()));
+    ASSERT_FALSE(CompiledArithmetic::compile(
+        parseExpression(BSON("$add" << BSON_ARRAY("$a" << BSON("$literal"
+                                                               << "1")))).get()));
+    ASSERT_FALSE(CompiledArithmetic::compile(parseExpression(BSON("$concat" << BSON_ARRAY("$a")))
+                                                 .get()));
+}
+
+TEST(CompiledArithmeticTest, MatchesInterpreterOnNumericInputs) {
+    const vector<BSONObj> specs = {
+        BSON("$add" << BSON_ARRAY("$a"
+                                  << "$b")),
+        BSON("$add" << BSON_ARRAY("$a" << BSON("$multiply" << BSON_ARRAY("$b"
+                                                                         << "$c")) << 1)),
+        BSON("$multiply" << BSON_ARRAY("$a"
+                                       << "$b"
+                                       << "$c")),
+        BSON("$subtract" << BSON_ARRAY("$a" << BSON("$add" << BSON_ARRAY("$b" << 2147483647)))),
+        BSON("$subtract" << BSON_ARRAY(BSON("$multiply" << BSON_ARRAY("$a" << 2))
+                                       << BSON("$divide" << BSON_ARRAY("$b"
+                                                                       << "$c")))),
+    };
+    const vector<BSONObj> inputs = {
+        BSON("a" << 1 << "b" << 2 << "c" << 3),
+        BSON("a" << 2147483647 << "b" << 1 << "c" << 2147483647),
+        BSON("a" << 5LL << "b" << -7 << "c" << 9LL),
+        BSON("a" << 1.5 << "b" << 2 << "c" << 4LL),
+        BSON("a" << -2147483647LL << "b" << 0.25 << "c" << -3),
+    };
+
+    for (auto&& spec : specs) {
+        intrusive_ptr<Expression> expression = parseExpression(spec);
+        std::unique_ptr<CompiledArithmetic> program = CompiledArithmetic::compile(expression.get());
+        ASSERT(program);
+        for (auto&& input : inputs) {
+            const Value expected = expression->evaluate(Document(input));
+
+            Variables vars(0, Document(input));
+            Value result;
+            ASSERT(program->run(&vars, &result));
+            ASSERT_EQUALS(expected.getType(), result.getType());
+            ASSERT_EQUALS(expected, result);
+        }
+    }
+}
+
+TEST(CompiledArithmeticTest, LeavesOtherInputsToInterpreter) {
+    intrusive_ptr<Expression> expression = parseExpression(
+        BSON("$add" << BSON_ARRAY(1 << BSON("$divide" << BSON_ARRAY("$a"
+                                                                    << "$b")))));
+    std::unique_ptr<CompiledArithmetic> program = CompiledArithmetic::compile(expression.get());
+    ASSERT(program);
+
+    const vector<BSONObj> inputs = {
+        BSON("b" << 1),
+        BSON("a" << BSONNULL << "b" << 1),
+        BSON("a" << Date_t::fromMillisSinceEpoch(1000) << "b" << 1),
+        BSON("a" << BSON_ARRAY(1 << 2) << "b" << 1),
+        BSON("a" << 1 << "b" << 0),
+    };
+    for (auto&& input : inputs) {
+        Variables vars(0, Document(input));
+        Value result;
+        ASSERT_FALSE(program->run(&vars, &result));
+    }
+
+    // The optimized expression still gets the interpreter's results and errors for these.
+    intrusive_ptr<Expression> optimized = expression->optimize();
+    ASSERT_EQUALS(Value(BSONNULL),
+                  optimized->evaluate(Document(BSON("a" << BSONNULL << "b" << 1))));
+    ASSERT_THROWS_CODE(
+        optimized->evaluate(Document(BSON("a" << 1 << "b" << 0))), UserException, 16608);
+    ASSERT_EQUALS(Value(3.0), optimized->evaluate(Document(BSON("a" << 4 << "b" << 2))));
+}
+
 namespace FieldPath {
 
 /** The provided field path does not pass validation. */
@@ -0,0 +1,146 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/incremental_group.h"
+
+#include <boost/intrusive_ptr.hpp>
+
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+using boost::intrusive_ptr;
+using std::unique_ptr;
+using std::vector;
+
+namespace {
+
+const char kGroupName[] = "$group";
+const char kMatchName[] = "$match";
+
+}  // namespace
+
+IncrementalGroup::IncrementalGroup(const NamespaceString& ns, vector<BSONObj> stages)
+    : _ns(ns), _stages(std::move(stages)) {}
+
+StatusWith<unique_ptr<IncrementalGroup>> IncrementalGroup::parse(const NamespaceString& ns,
+                                                                const vector<BSONObj>& stages) {
+    if (stages.empty() || stages.back().firstElementFieldName() != StringData(kGroupName)) {
+        return Status(ErrorCodes::BadValue,
+                      "an incremental group pipeline must end with its only $group stage");
+    }
+
+    vector<BSONObj> ownedStages;
+    for (size_t i = 0; i < stages.size(); ++i) {
+        const BSONObj& stage = stages[i];
+        if (stage.nFields() != 1) {
+            return Status(ErrorCodes::BadValue,
+                          "a pipeline stage specification object must contain exactly one field");
+        }
+
+        const bool isGroup = i + 1 == stages.size();
+        if (!isGroup && stage.firstElementFieldName() != StringData(kMatchName)) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "an incremental group pipeline may only have $match "
+                                           "stages before its $group, found "
+                                        << stage.firstElementFieldName());
+        }
+
+        if (!isGroup && stage.firstElement().type() == Object &&
+            DocumentSourceMatch::isTextQuery(stage.firstElement().Obj())) {
+            return Status(ErrorCodes::BadValue,
+                          "an incremental group pipeline may not use a $text query");
+        }
+
+        try {
+            intrusive_ptr<ExpressionContext> expCtx(new ExpressionContext(nullptr, ns));
+            DocumentSource::parse(expCtx, stage);
+        } catch (const DBException& ex) {
+            return ex.toStatus();
+        }
+
+        ownedStages.push_back(stage.getOwned());
+    }
+
+    return unique_ptr<IncrementalGroup>(new IncrementalGroup(ns, std::move(ownedStages)));
+}
+
+vector<Document> IncrementalGroup::group(OperationContext* txn, std::deque<Document> inputs) const {
+    return run(txn, std::move(inputs), false, true);
+}
+
+vector<Document> IncrementalGroup::merge(OperationContext* txn,
+                                         std::deque<Document> partials) const {
+    return run(txn, std::move(partials), true, true);
+}
+
+vector<Document> IncrementalGroup::finalize(OperationContext* txn,
+                                            std::deque<Document> partials) const {
+    return run(txn, std::move(partials), true, false);
+}
+
+vector<Document> IncrementalGroup::run(OperationContext* txn,
+                                       std::deque<Document> inputs,
+                                       bool merging,
+                                       bool partial) const {
+    intrusive_ptr<ExpressionContext> expCtx(new ExpressionContext(txn, _ns));
+
+    // A $group on a shard outputs the partial state of its accumulators rather than their values.
+    expCtx->inShard = partial;
+
+    vector<intrusive_ptr<DocumentSource>> sources;
+    sources.push_back(DocumentSourceMock::create(std::move(inputs)));
+    if (!merging) {
+        for (size_t i = 0; i + 1 < _stages.size(); ++i) {
+            sources.push_back(DocumentSource::parse(expCtx, _stages[i]));
+        }
+    }
+
+    intrusive_ptr<DocumentSource> group = DocumentSource::parse(expCtx, _stages.back());
+    if (merging) {
+        group = static_cast<DocumentSourceGroup*>(group.get())->getMergeSource();
+    }
+    sources.push_back(group);
+
+    for (size_t i = 1; i < sources.size(); ++i) {
+        sources[i]->setSource(sources[i - 1].get());
+    }
+
+    vector<Document> results;
+    while (boost::optional<Document> next = sources.back()->getNext()) {
+        results.push_back(std::move(*next));
+    }
+    return results;
+}
+
+}  // namespace mongo
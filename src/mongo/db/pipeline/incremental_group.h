@@ -0,0 +1,102 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status_with.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/pipeline/document.h"
+
+namespace mongo {
+
+class OperationContext;
+
+/**
+ * A $group, optionally preceded by $match stages, whose results are kept as the partial
+ * accumulator state a shard would send to a merger. Partial results for new input documents can
+ * then be merged into the stored ones, so the results stay current without rerunning the whole
+ * pipeline.
+ *
+ * Every method builds its own stages, so an IncrementalGroup may be used by several threads at
+ * once.
+ */
+class IncrementalGroup {
+    MONGO_DISALLOW_COPYING(IncrementalGroup);
+
+public:
+    /**
+     * Parses 'stages', which must be any number of $match stages followed by exactly one $group,
+     * for a pipeline on 'ns'.
+     */
+    static StatusWith<std::unique_ptr<IncrementalGroup>> parse(const NamespaceString& ns,
+                                                               const std::vector<BSONObj>& stages);
+
+    /**
+     * Returns the partial results of the pipeline over 'inputs', one document per group with at
+     * least one matching input.
+     */
+    std::vector<Document> group(OperationContext* txn, std::deque<Document> inputs) const;
+
+    /**
+     * Combines partial results, such as stored ones and those group() returned for new inputs,
+     * into one partial result per group.
+     */
+    std::vector<Document> merge(OperationContext* txn, std::deque<Document> partials) const;
+
+    /**
+     * Returns the results the pipeline would give for the inputs which produced 'partials'.
+     */
+    std::vector<Document> finalize(OperationContext* txn, std::deque<Document> partials) const;
+
+    const std::vector<BSONObj>& getStages() const {
+        return _stages;
+    }
+
+private:
+    IncrementalGroup(const NamespaceString& ns, std::vector<BSONObj> stages);
+
+    /**
+     * Runs the $match stages and the $group, or only the $group's merger if 'merging' is true,
+     * over 'inputs'. Outputs partial results if 'partial' is true.
+     */
+    std::vector<Document> run(OperationContext* txn,
+                              std::deque<Document> inputs,
+                              bool merging,
+                              bool partial) const;
+
+    const NamespaceString _ns;
+    const std::vector<BSONObj> _stages;
+};
+
+}  // namespace mongo
@@ -0,0 +1,145 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/incremental_group.h"
+
+#include <algorithm>
+
+#include "mongo/db/pipeline/value.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+bool isMongos() {
+    return false;
+}
+
+namespace {
+
+using std::deque;
+using std::vector;
+
+const NamespaceString kNss("unittests.incremental_group");
+
+std::unique_ptr<IncrementalGroup> parseGroup(vector<BSONObj> stages) {
+    auto parsed = IncrementalGroup::parse(kNss, stages);
+    ASSERT_OK(parsed.getStatus());
+    return std::move(parsed.getValue());
+}
+
+deque<Document> toDeque(const vector<Document>& docs) {
+    return deque<Document>(docs.begin(), docs.end());
+}
+
+/**
+ * Returns 'docs' sorted by _id as an array Value, so that results can be compared regardless of
+ * the order the $group returned them in.
+ */
+Value sortedById(vector<Document> docs) {
+    std::sort(docs.begin(), docs.end(), [](const Document& lhs, const Document& rhs) {
+        return Value::compare(lhs["_id"], rhs["_id"]) < 0;
+    });
+    return Value(vector<Value>(docs.begin(), docs.end()));
+}
+
+TEST(IncrementalGroupTest, ParseRequiresATrailingGroup) {
+    ASSERT_NOT_OK(IncrementalGroup::parse(kNss, {}).getStatus());
+    ASSERT_NOT_OK(IncrementalGroup::parse(kNss, {BSON("$match" << BSON("a" << 1))}).getStatus());
+    ASSERT_NOT_OK(IncrementalGroup::parse(kNss,
+                                          {BSON("$group" << BSON("_id"
+                                                                 << "$a")),
+                                           BSON("$match" << BSON("_id" << 1))})
+                      .getStatus());
+}
+
+TEST(IncrementalGroupTest, ParseRejectsStagesOtherThanMatchBeforeTheGroup) {
+    ASSERT_NOT_OK(IncrementalGroup::parse(kNss,
+                                          {BSON("$project" << BSON("a" << 1)),
+                                           BSON("$group" << BSON("_id"
+                                                                 << "$a"))})
+                      .getStatus());
+    ASSERT_NOT_OK(IncrementalGroup::parse(kNss,
+                                          {BSON("$match" << BSON("$text" << BSON("$search"
+                                                                                 << "x"))),
+                                           BSON("$group" << BSON("_id"
+                                                                 << "$a"))})
+                      .getStatus());
+}
+
+TEST(IncrementalGroupTest, ParseRejectsAnInvalidGroup) {
+    ASSERT_NOT_OK(
+        IncrementalGroup::parse(kNss, {BSON("$group" << BSON("total" << BSON("$sum" << 1)))})
+            .getStatus());
+}
+
+TEST(IncrementalGroupTest, MergedBatchesGiveTheSameResultsAsOneBatch) {
+    auto group = parseGroup({BSON("$match" << BSON("b" << BSON("$gte" << 0))),
+                             BSON("$group" << BSON("_id"
+                                                   << "$a"
+                                                   << "total" << BSON("$sum"
+                                                                      << "$b")
+                                                   << "mean" << BSON("$avg"
+                                                                     << "$b")
+                                                   << "top" << BSON("$max"
+                                                                    << "$b")))});
+
+    vector<Document> inputs;
+    for (int i = 0; i < 20; ++i) {
+        inputs.push_back(DOC("a" << i % 3 << "b" << (i % 2 ? i : -i)));
+    }
+    const deque<Document> firstBatch(inputs.begin(), inputs.begin() + 7);
+    const deque<Document> secondBatch(inputs.begin() + 7, inputs.end());
+
+    const vector<Document> expected =
+        group->finalize(nullptr, toDeque(group->group(nullptr, toDeque(inputs))));
+
+    // Merge the second batch's partial results into the first's, as an update would.
+    deque<Document> partials = toDeque(group->group(nullptr, firstBatch));
+    for (auto&& partial : group->group(nullptr, secondBatch)) {
+        partials.push_back(partial);
+    }
+    const vector<Document> merged = group->merge(nullptr, std::move(partials));
+    ASSERT_EQUALS(3U, merged.size());
+
+    ASSERT_EQUALS(sortedById(expected), sortedById(group->finalize(nullptr, toDeque(merged))));
+}
+
+TEST(IncrementalGroupTest, GroupOmitsGroupsWithoutMatchingInputs) {
+    auto group = parseGroup({BSON("$match" << BSON("b" << 1)),
+                             BSON("$group" << BSON("_id"
+                                                   << "$a"
+                                                   << "n" << BSON("$sum" << 1)))});
+    const vector<Document> partials =
+        group->group(nullptr, {DOC("a" << 1 << "b" << 1), DOC("a" << 2 << "b" << 2)});
+    ASSERT_EQUALS(1U, partials.size());
+    ASSERT_EQUALS(Value(1), partials[0]["_id"]);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -89,6 +89,11 @@ intrusive_ptr<Pipeline> Pipeline::parseCommand(string& errmsg,
             continue;
         }
 
+        // shardVersion is also for the command processor.
+        if (str::equals(pFieldName, "shardVersion")) {
+            continue;
+        }
+
         // ignore cursor options since they are handled externally.
         if (str::equals(pFieldName, "cursor")) {
             continue;
@@ -171,6 +176,8 @@ intrusive_ptr<Pipeline> Pipeline::parseCommand(string& errmsg,
     Optimizations::Local::coalesceAdjacent(pPipeline.get());
     Optimizations::Local::optimizeEachDocumentSource(pPipeline.get());
     Optimizations::Local::duplicateMatchBeforeInitalRedact(pPipeline.get());
+    Optimizations::Local::streamGroupAfterSort(pPipeline.get());
+    Optimizations::Local::absorbUnwindIntoGroup(pPipeline.get());
 
     return pPipeline;
 }
@@ -239,8 +246,12 @@ void Pipeline::Optimizations::Local::moveLimitBeforeSkip(Pipeline* pipeline) {
         DocumentSourceLimit* limit = dynamic_cast<DocumentSourceLimit*>(sources[i].get());
         DocumentSourceSkip* skip = dynamic_cast<DocumentSourceSkip*>(sources[i - 1].get());
         if (limit && skip) {
-            // Increase limit by skip since the skipped docs now pass through the $limit
-            limit->setLimit(limit->getLimit() + skip->getSkip());
+            // Increase limit by skip since the skipped docs now pass through the $limit. Saturate
+            // rather than overflow, as either may be as large as a long long can be.
+            const long long maxLimit = std::numeric_limits<long long>::max();
+            limit->setLimit(limit->getLimit() > maxLimit - skip->getSkip()
+                                ? maxLimit
+                                : limit->getLimit() + skip->getSkip());
             swap(sources[i], sources[i - 1]);
 
             // Start at back again. This is needed to handle cases with more than 1 $limit
@@ -310,6 +321,30 @@ void Pipeline::Optimizations::Local::duplicateMatchBeforeInitalRedact(Pipeline*
     }
 }
 
+void Pipeline::Optimizations::Local::streamGroupAfterSort(Pipeline* pipeline) {
+    SourceContainer& sources = pipeline->sources;
+    for (size_t srcn = sources.size(), srci = 1; srci < srcn; ++srci) {
+        DocumentSourceGroup* group = dynamic_cast<DocumentSourceGroup*>(sources[srci].get());
+        DocumentSourceSort* sort = dynamic_cast<DocumentSourceSort*>(sources[srci - 1].get());
+        if (group && sort &&
+            group->groupsAreContiguousInSortOrder(sort->serializeSortKey(false).toBson())) {
+            group->setStreaming(true);
+        }
+    }
+}
+
+void Pipeline::Optimizations::Local::absorbUnwindIntoGroup(Pipeline* pipeline) {
+    SourceContainer& sources = pipeline->sources;
+    for (size_t srci = 1; srci < sources.size(); ++srci) {
+        DocumentSourceGroup* group = dynamic_cast<DocumentSourceGroup*>(sources[srci].get());
+        DocumentSourceUnwind* unwind = dynamic_cast<DocumentSourceUnwind*>(sources[srci - 1].get());
+        if (group && unwind && group->absorbUnwind(FieldPath(unwind->getUnwindPath()))) {
+            sources.erase(sources.begin() + (srci - 1));
+            --srci;
+        }
+    }
+}
+
 Status Pipeline::checkAuthForCommand(ClientBasic* client,
                                      const std::string& db,
                                      const BSONObj& cmdObj) {
@@ -138,6 +138,12 @@ public:
         return sources.back().get();
     }
 
+    /// The source the pipeline reads from. Returns a non-owning pointer.
+    DocumentSource* input() {
+        invariant(!sources.empty());
+        return sources.front().get();
+    }
+
     /**
      * Write the pipeline's operators to a std::vector<Value>, with the
      * explain flag true (for DocumentSource::serializeToArray()).
@@ -162,11 +162,18 @@ StatusWith<std::unique_ptr<PlanExecutor>> attemptToGetExecutor(
     BSONObj queryObj,
     BSONObj projectionObj,
     BSONObj sortObj,
-    const size_t plannerOpts) {
+    const size_t plannerOpts,
+    long long limit = 0) {
     const WhereCallbackReal whereCallback(pExpCtx->opCtx, pExpCtx->ns.db());
 
-    auto cq =
-        CanonicalQuery::canonicalize(pExpCtx->ns, queryObj, sortObj, projectionObj, whereCallback);
+    // A negative ntoreturn is a hard limit, which lets the plan stop once it has produced 'limit'
+    // documents and lets plan selection end its trial period early. A limit too large for an int
+    // is left to the pipeline.
+    const int ntoreturn =
+        (limit > 0 && limit <= std::numeric_limits<int>::max()) ? -static_cast<int>(limit) : 0;
+
+    auto cq = CanonicalQuery::canonicalize(
+        pExpCtx->ns, queryObj, sortObj, projectionObj, 0, ntoreturn, whereCallback);
 
     if (!cq.isOK()) {
         // Return an error instead of uasserting, since there are cases where the combination of
@@ -311,14 +318,23 @@ std::shared_ptr<PlanExecutor> PipelineD::prepareExecutor(
 
     BSONObj emptyProjection;
     if (sortStage) {
+        // If the query system provides the sort, it can also enforce a $limit coalesced into it.
+        const long long sortLimit = sortStage->getLimit() > 0 ? sortStage->getLimit() : 0;
+
         // See if the query system can provide a non-blocking sort.
         auto swExecutorSort = attemptToGetExecutor(
-            txn, collection, expCtx, queryObj, emptyProjection, *sortObj, plannerOpts);
+            txn, collection, expCtx, queryObj, emptyProjection, *sortObj, plannerOpts, sortLimit);
 
         if (swExecutorSort.isOK()) {
             // Success! Now see if the query system can also cover the projection.
-            auto swExecutorSortAndProj = attemptToGetExecutor(
-                txn, collection, expCtx, queryObj, *projectionObj, *sortObj, plannerOpts);
+            auto swExecutorSortAndProj = attemptToGetExecutor(txn,
+                                                              collection,
+                                                              expCtx,
+                                                              queryObj,
+                                                              *projectionObj,
+                                                              *sortObj,
+                                                              plannerOpts,
+                                                              sortLimit);
 
             if (swExecutorSortAndProj.isOK()) {
                 // Success! We have a non-blocking sort and a covered projection.
@@ -95,6 +95,25 @@ public:
      * BSONObjs converted to Documents.
      */
     static void duplicateMatchBeforeInitalRedact(Pipeline* pipeline);
+
+    /**
+     * Tells a $group that directly follows a $sort on its _id fields to stream its results.
+     *
+     * The group then only holds one group at a time and can return it as soon as the key
+     * changes, which lets a following $limit stop the pipeline early. This still applies when
+     * the $sort is later absorbed by the query system, since the cursor returns documents in the
+     * same order.
+     */
+    static void streamGroupAfterSort(Pipeline* pipeline);
+
+    /**
+     * Removes a $unwind directly before a $group, which then does the unwinding itself.
+     *
+     * The $group accumulates each array element straight from the input document instead of
+     * reading a separate Document per element from the $unwind. This must run after
+     * streamGroupAfterSort(), which does not account for an absorbed $unwind.
+     */
+    static void absorbUnwindIntoGroup(Pipeline* pipeline);
 };
 
 /**
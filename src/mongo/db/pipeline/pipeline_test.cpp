@@ -128,6 +128,70 @@ class SortMatchProjSkipLimBecomesMatchTopKSortSkipProj : public Base {
     }
 };
 
+class SortWithChainedSkipsAndLimitsBecomesTopKSortSkip : public Base {
+    string inputPipeJson() override {
+        return "[{$sort: {a: 1}}"
+               ",{$limit: 10}"
+               ",{$skip: 3}"
+               ",{$limit: 5}"
+               ",{$skip: 2}"
+               ",{$limit: 1}"
+               "]";
+    }
+
+    string outputPipeJson() override {
+        return "[{$sort: {sortKey: {a: 1}, limit: 6}}, {$skip: 5}]";
+    }
+};
+
+class SkipPlusLimitSaturatesWhenMovingLimitBeforeSkip : public Base {
+    string inputPipeJson() override {
+        return "[{$skip: NumberLong(9223372036854775000)}"
+               ",{$limit: NumberLong(9223372036854775000)}"
+               "]";
+    }
+
+    string outputPipeJson() override {
+        return "[{$limit: NumberLong(9223372036854775807)}"
+               ",{$skip: NumberLong(9223372036854775000)}"
+               "]";
+    }
+};
+
+class GroupAfterSortOnIdFieldsStreams : public Base {
+    string inputPipeJson() override {
+        return "[{$sort: {a: 1, b: -1}}, {$group: {_id: {x: '$b', y: '$a'}}}]";
+    }
+
+    string outputPipeJson() override {
+        return "[{$sort: {sortKey: {a: 1, b: -1}}}"
+               ",{$group: {_id: {x: '$b', y: '$a'}, $streaming: true}}"
+               "]";
+    }
+};
+
+class GroupAfterSortOnOtherFieldsDoesNotStream : public Base {
+    string inputPipeJson() override {
+        return "[{$sort: {a: 1}}, {$group: {_id: {x: '$a', y: '$b'}}}]";
+    }
+
+    string outputPipeJson() override {
+        return "[{$sort: {sortKey: {a: 1}}}, {$group: {_id: {x: '$a', y: '$b'}}}]";
+    }
+};
+
+class UnwindBeforeGroupIsAbsorbed : public Base {
+    string inputPipeJson() override {
+        return "[{$unwind: '$a'}, {$unwind: '$b'}, {$group: {_id: '$b', n: {$sum: 1}}}]";
+    }
+
+    string outputPipeJson() override {
+        return "[{$unwind: '$a'}"
+               ",{$group: {_id: '$b', n: {$sum: {$const: 1}}, $unwind: '$b'}}"
+               "]";
+    }
+};
+
 class RemoveSkipZero : public Base {
     string inputPipeJson() override {
         return "[{$skip: 0}]";
@@ -461,9 +525,14 @@ public:
         add<Optimizations::Local::MoveMulitipleSkipsAndLimitsBeforeProject>();
         add<Optimizations::Local::SortMatchProjSkipLimBecomesMatchTopKSortSkipProj>();
         add<Optimizations::Local::DoNotRemoveSkipOne>();
+        add<Optimizations::Local::SortWithChainedSkipsAndLimitsBecomesTopKSortSkip>();
+        add<Optimizations::Local::SkipPlusLimitSaturatesWhenMovingLimitBeforeSkip>();
         add<Optimizations::Local::RemoveEmptyMatch>();
         add<Optimizations::Local::RemoveMultipleEmptyMatches>();
         add<Optimizations::Local::DoNotRemoveNonEmptyMatch>();
+        add<Optimizations::Local::GroupAfterSortOnIdFieldsStreams>();
+        add<Optimizations::Local::GroupAfterSortOnOtherFieldsDoesNotStream>();
+        add<Optimizations::Local::UnwindBeforeGroupIsAbsorbed>();
         add<Optimizations::Sharded::Empty>();
         add<Optimizations::Sharded::moveFinalUnwindFromShardsToMerger::OneUnwind>();
         add<Optimizations::Sharded::moveFinalUnwindFromShardsToMerger::TwoUnwind>();
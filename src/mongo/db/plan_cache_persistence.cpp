@@ -0,0 +1,399 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/plan_cache_persistence.h"
+
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_catalog_entry.h"
+#include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands/fsync.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/query/query_planner.h"
+#include "mongo/db/query/query_planner_params.h"
+#include "mongo/db/query/query_settings.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/query/stage_types.h"
+#include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/util/background.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+
+using std::list;
+using std::set;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace {
+
+// The local database is never replicated, so each node keeps its own copy of its plan caches.
+const char kPlanCacheNamespace[] = "local.plancache";
+
+// Reported by the plan cache commands in place of the trial period stats of a warmed entry.
+const char kPersistedPlanStageType[] = "PERSISTED_PLAN";
+
+// Distinguishes the documents describing automatically pinned index filters from the ones
+// describing plan cache entries.
+const char kAutoPinnedIndexesField[] = "autoPinnedIndexes";
+
+/**
+ * Appends a document describing the winning plan of each plan cache entry, and one describing
+ * each automatically pinned index filter, of the collections in 'dbName' to 'docs'.
+ */
+void getPlanCacheDocsForDB(OperationContext* txn, const string& dbName, vector<BSONObj>* docs) {
+    ScopedTransaction transaction(txn, MODE_IS);
+    Lock::DBLock dbLock(txn->lockState(), dbName, MODE_IS);
+
+    Database* db = dbHolder().get(txn, dbName);
+    if (!db) {
+        return;  // skip since database no longer exists
+    }
+
+    list<string> namespaces;
+    db->getDatabaseCatalogEntry()->getCollectionNamespaces(&namespaces);
+
+    for (list<string>::const_iterator it = namespaces.begin(); it != namespaces.end(); ++it) {
+        const string& ns = *it;
+        Lock::CollectionLock collLock(txn->lockState(), ns, MODE_IS);
+        Collection* collection = db->getCollection(ns);
+        if (!collection) {
+            continue;  // skip since collection was dropped
+        }
+
+        OwnedPointerVector<PlanCacheEntry> entries;
+        entries.mutableVector() = collection->infoCache()->getPlanCache()->getAllEntries();
+
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const PlanCacheEntry* entry = entries[i];
+            if (entry->plannerData.empty() || entry->decision->stats.empty()) {
+                continue;
+            }
+
+            BSONObjBuilder bob;
+            bob.append("ns", ns);
+            bob.append("query", entry->query);
+            bob.append("sort", entry->sort);
+            bob.append("projection", entry->projection);
+            bob.append("works", static_cast<long long>(entry->decision->stats[0]->common.works));
+            bob.append("solution", entry->plannerData[0]->toString());
+            docs->push_back(bob.obj());
+        }
+
+        QuerySettings* querySettings = collection->infoCache()->getQuerySettings();
+        OwnedPointerVector<AllowedIndexEntry> filters;
+        filters.mutableVector() = querySettings->getAllAllowedIndices();
+
+        for (size_t i = 0; i < filters.size(); ++i) {
+            const AllowedIndexEntry* filter = filters[i];
+            if (!filter->autoPinned) {
+                continue;
+            }
+
+            BSONObjBuilder bob;
+            bob.append("ns", ns);
+            bob.append("query", filter->query);
+            bob.append("sort", filter->sort);
+            bob.append("projection", filter->projection);
+            bob.append(kAutoPinnedIndexesField, filter->indexKeyPatterns);
+            docs->push_back(bob.obj());
+        }
+    }
+}
+
+/**
+ * Restores the automatically pinned index filter described by 'doc'. Returns true if the pin
+ * was restored.
+ */
+bool restoreAutoPin(OperationContext* txn, const BSONObj& doc) {
+    const NamespaceString nss(doc["ns"].str());
+    if (!nss.isValid() || doc["query"].type() != Object || doc["sort"].type() != Object ||
+        doc["projection"].type() != Object || doc[kAutoPinnedIndexesField].type() != Array) {
+        LOG(1) << "skipping malformed plan cache document " << doc;
+        return false;
+    }
+
+    AutoGetCollectionForRead ctx(txn, nss);
+    Collection* collection = ctx.getCollection();
+    if (!collection) {
+        return false;
+    }
+
+    // A pin naming an index which no longer exists would leave the shape without its index.
+    vector<BSONObj> indexes;
+    for (const BSONElement& elt : doc[kAutoPinnedIndexesField].Array()) {
+        if (elt.type() != Object ||
+            !collection->getIndexCatalog()->findIndexByKeyPattern(txn, elt.Obj())) {
+            return false;
+        }
+        indexes.push_back(elt.Obj().getOwned());
+    }
+    if (indexes.empty()) {
+        return false;
+    }
+
+    const WhereCallbackReal whereCallback(txn, nss.db());
+    auto statusWithCQ = CanonicalQuery::canonicalize(
+        nss, doc["query"].Obj(), doc["sort"].Obj(), doc["projection"].Obj(), whereCallback);
+    if (!statusWithCQ.isOK()) {
+        return false;
+    }
+    const unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+
+    CollectionInfoCache* infoCache = collection->infoCache();
+    if (!infoCache->getQuerySettings()->setAutoPinnedIndices(
+            *cq, infoCache->getPlanCache()->computeKey(*cq), indexes)) {
+        return false;
+    }
+    infoCache->getPlanCache()->remove(*cq);
+    return true;
+}
+
+/**
+ * Replans the shape described by 'doc' and adds the solution it names to its collection's plan
+ * cache. Returns true if an entry was added.
+ */
+bool warmPlanCacheEntry(OperationContext* txn, const BSONObj& doc) {
+    const NamespaceString nss(doc["ns"].str());
+    if (!nss.isValid() || doc["query"].type() != Object || doc["sort"].type() != Object ||
+        doc["projection"].type() != Object || !doc["works"].isNumber() ||
+        doc["solution"].type() != String) {
+        LOG(1) << "skipping malformed plan cache document " << doc;
+        return false;
+    }
+
+    AutoGetCollectionForRead ctx(txn, nss);
+    Collection* collection = ctx.getCollection();
+    if (!collection) {
+        return false;
+    }
+
+    const WhereCallbackReal whereCallback(txn, nss.db());
+    auto statusWithCQ = CanonicalQuery::canonicalize(
+        nss, doc["query"].Obj(), doc["sort"].Obj(), doc["projection"].Obj(), whereCallback);
+    if (!statusWithCQ.isOK()) {
+        LOG(1) << "skipping plan cache document " << doc
+               << " that no longer parses: " << statusWithCQ.getStatus();
+        return false;
+    }
+    const unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+
+    PlanCache* planCache = collection->infoCache()->getPlanCache();
+    if (!PlanCache::shouldCacheQuery(*cq) || planCache->contains(*cq)) {
+        return false;
+    }
+
+    QueryPlannerParams plannerParams;
+    fillOutPlannerParams(txn, collection, cq.get(), &plannerParams);
+
+    OwnedPointerVector<QuerySolution> solutions;
+    if (!QueryPlanner::plan(*cq, plannerParams, &solutions.mutableVector()).isOK()) {
+        return false;
+    }
+
+    // Index positions in the stored solution refer to the order of the collection's indexes,
+    // so a solution only matches while the same indexes exist.
+    const string storedSolution = doc["solution"].str();
+    for (size_t i = 0; i < solutions.size(); ++i) {
+        QuerySolution* soln = solutions[i];
+        if (!soln->cacheData || soln->cacheData->toString() != storedSolution) {
+            continue;
+        }
+
+        // The trial period is not rerun, so the decision only carries the work count it took
+        // to pick this plan originally. CachedPlanStage uses it to decide when to replan.
+        unique_ptr<PlanRankingDecision> decision(new PlanRankingDecision());
+        CommonStats common(kPersistedPlanStageType);
+        common.works = static_cast<size_t>(doc["works"].numberLong());
+        decision->stats.mutableVector().push_back(new PlanStageStats(common, STAGE_UNKNOWN));
+        decision->scores.push_back(1);
+        decision->candidateOrder.push_back(0);
+
+        return planCache->add(*cq, {soln}, decision.release()).isOK();
+    }
+
+    return false;
+}
+
+class PlanCachePersistenceMonitor : public BackgroundJob {
+public:
+    virtual string name() const {
+        return "PlanCachePersistenceMonitor";
+    }
+
+    virtual void run() {
+        Client::initThread(name().c_str());
+        AuthorizationSession::get(cc())->grantInternalAuthorization();
+
+        try {
+            OperationContextImpl txn;
+            const size_t numWarmed = warmPlanCaches(&txn);
+            log() << "warmed " << numWarmed << " plan cache entries from " << kPlanCacheNamespace;
+        } catch (const DBException& e) {
+            warning() << "failed to warm plan caches from " << kPlanCacheNamespace << ": "
+                      << e.toString();
+        }
+
+        while (!inShutdown()) {
+            sleepsecs(std::max(1, internalQueryCachePersistIntervalSecs));
+
+            if (internalQueryCachePersistIntervalSecs <= 0) {
+                continue;
+            }
+
+            if (lockedForWriting()) {
+                LOG(3) << " locked for writing";
+                continue;
+            }
+
+            try {
+                OperationContextImpl txn;
+                persistPlanCaches(&txn);
+            } catch (const WriteConflictException& e) {
+                LOG(1) << "Got WriteConflictException in plan cache persistence thread";
+            } catch (const DBException& e) {
+                warning() << "failed to persist plan caches to " << kPlanCacheNamespace << ": "
+                          << e.toString();
+            }
+        }
+    }
+};
+
+}  // namespace
+
+void persistPlanCaches(OperationContext* txn) {
+    // If part of a replica set but not in a readable state (e.g. during initial sync), the plan
+    // caches are about to be invalidated anyway.
+    if (repl::getGlobalReplicationCoordinator()->getReplicationMode() ==
+            repl::ReplicationCoordinator::modeReplSet &&
+        !repl::getGlobalReplicationCoordinator()->getMemberState().readable()) {
+        return;
+    }
+
+    set<string> dbs;
+    dbHolder().getAllShortNames(dbs);
+
+    vector<BSONObj> docs;
+    for (set<string>::const_iterator it = dbs.begin(); it != dbs.end(); ++it) {
+        if (*it != "local") {
+            getPlanCacheDocsForDB(txn, *it, &docs);
+        }
+    }
+
+    ScopedTransaction transaction(txn, MODE_IX);
+    AutoGetOrCreateDb autoDb(txn, "local", MODE_X);
+    Database* db = autoDb.getDb();
+    Collection* collection = db->getCollection(kPlanCacheNamespace);
+
+    WriteUnitOfWork wunit(txn);
+    if (!collection) {
+        bool shouldReplicateWrites = txn->writesAreReplicated();
+        txn->setReplicatedWrites(false);
+        ON_BLOCK_EXIT(&OperationContext::setReplicatedWrites, txn, shouldReplicateWrites);
+        uassertStatusOK(userCreateNS(txn, db, kPlanCacheNamespace, BSONObj()));
+        collection = db->getCollection(kPlanCacheNamespace);
+    }
+    invariant(collection);
+
+    uassertStatusOK(collection->truncate(txn));
+    for (vector<BSONObj>::const_iterator it = docs.begin(); it != docs.end(); ++it) {
+        uassertStatusOK(collection->insertDocument(txn, *it, false));
+    }
+    wunit.commit();
+
+    LOG(1) << "persisted " << docs.size() << " plan cache entries to " << kPlanCacheNamespace;
+}
+
+size_t warmPlanCaches(OperationContext* txn) {
+    vector<BSONObj> docs;
+    {
+        DBDirectClient client(txn);
+        unique_ptr<DBClientCursor> cursor = client.query(kPlanCacheNamespace, Query());
+        while (cursor && cursor->more()) {
+            docs.push_back(cursor->nextSafe().getOwned());
+        }
+    }
+
+    // Pins are restored first so that the plans warmed next are planned under them.
+    size_t numPins = 0;
+    for (vector<BSONObj>::const_iterator it = docs.begin(); it != docs.end(); ++it) {
+        if (it->hasField(kAutoPinnedIndexesField) && restoreAutoPin(txn, *it)) {
+            ++numPins;
+        }
+    }
+    if (numPins > 0) {
+        LOG(1) << "restored " << numPins << " automatic index filter pins from "
+               << kPlanCacheNamespace;
+    }
+
+    size_t numWarmed = 0;
+    for (vector<BSONObj>::const_iterator it = docs.begin(); it != docs.end(); ++it) {
+        if (!it->hasField(kAutoPinnedIndexesField) && warmPlanCacheEntry(txn, *it)) {
+            ++numWarmed;
+        }
+    }
+    return numWarmed;
+}
+
+void startPlanCachePersistenceBackgroundJob() {
+    if (internalQueryCachePersistIntervalSecs <= 0) {
+        return;
+    }
+
+    PlanCachePersistenceMonitor* monitor = new PlanCachePersistenceMonitor();
+    monitor->go();
+}
+
+}  // namespace mongo
@@ -0,0 +1,60 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace mongo {
+
+class OperationContext;
+
+/**
+ * Writes the winning plan of every plan cache entry on this node, and every index filter the
+ * server pinned automatically, to the local.plancache collection, replacing whatever an earlier
+ * pass stored there.
+ */
+void persistPlanCaches(OperationContext* txn);
+
+/**
+ * Replans each query shape stored in local.plancache and seeds the collection's plan cache with
+ * the solution that was cached when the shape was persisted. Shapes whose collection or indexes
+ * no longer produce that solution are skipped. Returns the number of entries added.
+ *
+ * Automatically pinned index filters are restored first, unless one of their indexes is gone.
+ */
+size_t warmPlanCaches(OperationContext* txn);
+
+/**
+ * Warms the plan caches from local.plancache and then persists them every
+ * internalQueryCachePersistIntervalSecs seconds. Does nothing if persistence is disabled at
+ * startup.
+ */
+void startPlanCachePersistenceBackgroundJob();
+
+}  // namespace mongo
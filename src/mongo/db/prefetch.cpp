@@ -42,7 +42,9 @@
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
 #include "mongo/db/stats/timer_stats.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/storage/mmap_v1/mmap.h"
 #include "mongo/util/log.h"
 
@@ -115,8 +117,13 @@ void prefetchIndexPages(OperationContext* txn,
     }
 }
 
-// page in the data pages for a record associated with an object
-void prefetchRecordPages(OperationContext* txn, Database* db, const char* ns, const BSONObj& obj) {
+// page in the data pages for a record associated with an object, returning the record's current
+// document if it was found
+BSONObj prefetchRecordPages(OperationContext* txn,
+                            Database* db,
+                            const char* ns,
+                            const BSONObj& obj,
+                            bool isMMAPV1) {
     BSONElement _id;
     if (obj.getObjectID(_id)) {
         TimerHolder timer(&prefetchDocStats);
@@ -125,6 +132,11 @@ void prefetchRecordPages(OperationContext* txn, Database* db, const char* ns, co
         BSONObj result;
         try {
             if (Helpers::findById(txn, db, ns, builder.done(), result)) {
+                if (!isMMAPV1) {
+                    // Finding the document has already read it into the storage engine's cache.
+                    return result.getOwned();
+                }
+
                 // do we want to use Record::touch() here?  it's pretty similar.
                 volatile char _dummy_char = '\0';
 
@@ -134,11 +146,13 @@ void prefetchRecordPages(OperationContext* txn, Database* db, const char* ns, co
                 }
                 // hit the last page, in case we missed it above
                 _dummy_char += *(result.objdata() + result.objsize() - 1);
+                return result;
             }
         } catch (const DBException& e) {
             LOG(2) << "ignoring exception in prefetchRecordPages(): " << e.what() << endl;
         }
     }
+    return BSONObj();
 }
 }  // namespace
 
@@ -165,10 +179,10 @@ void prefetchPagesForReplicatedOp(OperationContext* txn, Database* db, const BSO
     BSONObj obj = op.getObjectField(opField);
     const char* ns = op.getStringField("ns");
 
-    // This will have to change for engines other than MMAP V1, because they might not have
-    // means for directly prefetching pages from the collection. For this purpose, acquire S
-    // lock on the database, instead of optimizing with IS.
-    Lock::CollectionLock collLock(txn->lockState(), ns, MODE_S);
+    // MMAP V1 prefetches pages by reading directly from the collection's files, so it needs an S
+    // lock on the collection. Other engines only use cursors, which are safe under IS.
+    const bool isMMAPV1 = getGlobalServiceContext()->getGlobalStorageEngine()->isMmapV1();
+    Lock::CollectionLock collLock(txn->lockState(), ns, isMMAPV1 ? MODE_S : MODE_IS);
 
     Collection* collection = db->getCollection(ns);
     if (!collection) {
@@ -200,11 +214,23 @@ void prefetchPagesForReplicatedOp(OperationContext* txn, Database* db, const BSO
     // when we delete.  note if done we only want to touch the first page.
     //
     // update: do record prefetch.
-    if ((*opType == 'u') &&
-        // do not prefetch the data for capped collections because
-        // they typically do not have an _id index for findById() to use.
-        !collection->isCapped()) {
-        prefetchRecordPages(txn, db, ns, obj);
+    //
+    // do not prefetch the data for capped collections because they typically do not have an _id
+    // index for findById() to use.
+    if (isMMAPV1) {
+        if (*opType == 'u' && !collection->isCapped()) {
+            prefetchRecordPages(txn, db, ns, obj, isMMAPV1);
+        }
+        return;
+    }
+
+    // Other engines only keep recently used pages in their cache, so warm everything the write
+    // will read: the current document of an update or delete, and the index keys it will remove.
+    if ((*opType == 'u' || *opType == 'd') && !collection->isCapped()) {
+        const BSONObj current = prefetchRecordPages(txn, db, ns, obj, isMMAPV1);
+        if (!current.isEmpty() && prefetchConfig == BackgroundSync::PREFETCH_ALL) {
+            prefetchIndexPages(txn, collection, prefetchConfig, current);
+        }
     }
 }
 
@@ -209,6 +209,9 @@ public:
     static size_t countNodes(const MatchExpression* root, MatchExpression::MatchType type);
 
 private:
+    // Remembers the plan cache key of this query, see PlanCache::computeKey().
+    friend class PlanCache;
+
     // You must go through canonicalize to create a CanonicalQuery.
     CanonicalQuery() {}
 
@@ -225,6 +228,11 @@ private:
     std::unique_ptr<MatchExpression> _root;
 
     std::unique_ptr<ParsedProjection> _proj;
+
+    // The plan cache key last computed for this query, along with the key version of the plan
+    // cache which computed it. A version of 0 means that no key has been computed yet.
+    mutable std::string _planCacheKey;
+    mutable unsigned long long _planCacheKeyVersion = 0;
 };
 
 }  // namespace mongo
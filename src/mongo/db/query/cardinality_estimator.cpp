@@ -0,0 +1,119 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/cardinality_estimator.h"
+
+#include <algorithm>
+
+#include "mongo/db/query/index_histogram.h"
+#include "mongo/db/query/query_knobs.h"
+
+namespace mongo {
+
+namespace {
+
+const IndexHistogram* findHistogram(const BSONObj& keyPattern,
+                                    const std::vector<IndexEntry>& indices) {
+    for (const IndexEntry& index : indices) {
+        if (index.histogram && index.keyPattern.woCompare(keyPattern) == 0) {
+            return index.histogram.get();
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+// static
+double CardinalityEstimator::estimateKeysExamined(const QuerySolutionNode* node,
+                                                  const std::vector<IndexEntry>& indices) {
+    if (STAGE_IXSCAN == node->getType()) {
+        const IndexScanNode* ixn = static_cast<const IndexScanNode*>(node);
+        // Skip-scans seek past most of the keys within their bounds over the first field.
+        if (ixn->skipScan || ixn->bounds.isSimpleRange || ixn->bounds.fields.empty()) {
+            return -1;
+        }
+
+        const IndexHistogram* histogram = findHistogram(ixn->indexKeyPattern, indices);
+        if (!histogram) {
+            return -1;
+        }
+        return histogram->estimateKeys(ixn->bounds.fields[0]);
+    }
+
+    if (node->children.empty()) {
+        return -1;
+    }
+
+    double estimate = 0;
+    for (const QuerySolutionNode* child : node->children) {
+        const double childEstimate = estimateKeysExamined(child, indices);
+        if (childEstimate < 0) {
+            return -1;
+        }
+        estimate += childEstimate;
+    }
+    return estimate;
+}
+
+// static
+void CardinalityEstimator::pruneSolutions(const std::vector<IndexEntry>& indices,
+                                          std::vector<QuerySolution*>* solutions) {
+    const double ratio = internalQueryPlannerHistogramPruningRatio;
+    if (ratio <= 0 || solutions->size() < 2) {
+        return;
+    }
+
+    std::vector<double> estimates;
+    double cheapest = -1;
+    for (const QuerySolution* soln : *solutions) {
+        estimates.push_back(estimateKeysExamined(soln->root.get(), indices));
+        if (estimates.back() >= 0 && (cheapest < 0 || estimates.back() < cheapest)) {
+            cheapest = estimates.back();
+        }
+    }
+    if (cheapest < 0) {
+        return;
+    }
+
+    // Estimates of a handful of keys are too rough to tell plans apart.
+    const double limit = ratio * std::max(cheapest, 1.0);
+    std::vector<QuerySolution*> kept;
+    for (size_t i = 0; i < solutions->size(); ++i) {
+        if (estimates[i] > limit) {
+            delete (*solutions)[i];
+        } else {
+            kept.push_back((*solutions)[i]);
+        }
+    }
+    solutions->swap(kept);
+}
+
+}  // namespace mongo
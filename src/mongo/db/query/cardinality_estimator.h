@@ -0,0 +1,61 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/query/index_entry.h"
+#include "mongo/db/query/query_solution.h"
+
+namespace mongo {
+
+/**
+ * Estimates the cost of candidate solutions from the histograms the analyze command collects,
+ * so that hopeless candidates need not be run in the multi-plan trial period.
+ */
+class CardinalityEstimator {
+public:
+    /**
+     * Estimates how many index keys the tree rooted at 'node' examines, summed over its index
+     * scans. Returns a negative number if the tree scans a collection, or an index of 'indices'
+     * without a histogram, so that no estimate can be made.
+     */
+    static double estimateKeysExamined(const QuerySolutionNode* node,
+                                       const std::vector<IndexEntry>& indices);
+
+    /**
+     * Deletes from 'solutions' the solutions estimated to examine more than
+     * internalQueryPlannerHistogramPruningRatio times the keys of the cheapest estimated
+     * solution. Solutions without an estimate are kept, as is at least one solution.
+     */
+    static void pruneSolutions(const std::vector<IndexEntry>& indices,
+                               std::vector<QuerySolution*>* solutions);
+};
+
+}  // namespace mongo
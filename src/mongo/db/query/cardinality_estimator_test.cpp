@@ -0,0 +1,126 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/cardinality_estimator.h"
+
+#include <memory>
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/index_histogram.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+
+/**
+ * An index on 'keyPattern' whose first field holds 'numKeys' keys spread evenly over the values
+ * 0 to 99.
+ */
+IndexEntry makeIndex(const BSONObj& keyPattern, long long numKeys) {
+    std::vector<BSONObj> sample;
+    for (int i = 0; i < 100; ++i) {
+        sample.push_back(BSON("" << i));
+    }
+    IndexEntry index(keyPattern);
+    index.histogram = std::make_shared<IndexHistogram>(sample, 100, numKeys);
+    return index;
+}
+
+/**
+ * A solution scanning the index on 'keyPattern' over the values in [start, end] of its first
+ * field.
+ */
+QuerySolution* makeIndexScanSolution(const BSONObj& keyPattern, int start, int end) {
+    IndexScanNode* ixn = new IndexScanNode();
+    ixn->indexKeyPattern = keyPattern;
+    OrderedIntervalList oil(keyPattern.firstElement().fieldName());
+    oil.intervals.push_back(Interval(BSON("" << start << "" << end), true, true));
+    ixn->bounds.fields.push_back(oil);
+
+    QuerySolution* soln = new QuerySolution();
+    soln->root.reset(new FetchNode());
+    soln->root->children.push_back(ixn);
+    return soln;
+}
+
+TEST(CardinalityEstimatorTest, EstimateIndexScan) {
+    std::vector<IndexEntry> indices{makeIndex(BSON("a" << 1), 1000)};
+    std::unique_ptr<QuerySolution> soln(makeIndexScanSolution(BSON("a" << 1), 0, 9));
+    ASSERT_EQUALS(100, CardinalityEstimator::estimateKeysExamined(soln->root.get(), indices));
+}
+
+TEST(CardinalityEstimatorTest, NoEstimateWithoutHistogram) {
+    std::vector<IndexEntry> indices{IndexEntry(BSON("a" << 1))};
+    std::unique_ptr<QuerySolution> soln(makeIndexScanSolution(BSON("a" << 1), 0, 9));
+    ASSERT_LESS_THAN(CardinalityEstimator::estimateKeysExamined(soln->root.get(), indices), 0);
+
+    CollectionScanNode collscan;
+    ASSERT_LESS_THAN(CardinalityEstimator::estimateKeysExamined(&collscan, indices), 0);
+}
+
+TEST(CardinalityEstimatorTest, PruneCostlySolutions) {
+    std::vector<IndexEntry> indices{makeIndex(BSON("a" << 1), 1000),
+                                    makeIndex(BSON("b" << 1), 1000),
+                                    IndexEntry(BSON("c" << 1))};
+
+    // Examines 10 keys, 1000 keys and an unknown number of keys.
+    std::vector<QuerySolution*> solutions{makeIndexScanSolution(BSON("a" << 1), 0, 0),
+                                          makeIndexScanSolution(BSON("b" << 1), 0, 99),
+                                          makeIndexScanSolution(BSON("c" << 1), 0, 99)};
+    CardinalityEstimator::pruneSolutions(indices, &solutions);
+
+    ASSERT_EQUALS(2U, solutions.size());
+    ASSERT_EQUALS(BSON("a" << 1),
+                  static_cast<IndexScanNode*>(solutions[0]->root->children[0])->indexKeyPattern);
+    ASSERT_EQUALS(BSON("c" << 1),
+                  static_cast<IndexScanNode*>(solutions[1]->root->children[0])->indexKeyPattern);
+    for (QuerySolution* soln : solutions) {
+        delete soln;
+    }
+}
+
+TEST(CardinalityEstimatorTest, KeepSolutionsWithinRatio) {
+    std::vector<IndexEntry> indices{makeIndex(BSON("a" << 1), 1000),
+                                    makeIndex(BSON("b" << 1), 1000)};
+
+    // Examines 100 and 500 keys, within the default ratio.
+    std::vector<QuerySolution*> solutions{makeIndexScanSolution(BSON("a" << 1), 0, 9),
+                                          makeIndexScanSolution(BSON("b" << 1), 0, 49)};
+    CardinalityEstimator::pruneSolutions(indices, &solutions);
+
+    ASSERT_EQUALS(2U, solutions.size());
+    for (QuerySolution* soln : solutions) {
+        delete soln;
+    }
+}
+
+}  // namespace
@@ -46,6 +46,7 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/server_options.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/util/allocation_counter.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/version.h"
 
@@ -56,6 +57,9 @@ using std::string;
 using std::unique_ptr;
 using std::vector;
 
+// Whether the execution stats of an explain include the execution trace of the winning plan.
+MONGO_EXPORT_SERVER_PARAMETER(explainExecutionTrace, bool, false);
+
 /**
  * Traverse the tree rooted at 'root', and add all tree nodes into the list 'flattened'.
  */
@@ -77,6 +81,37 @@ void flattenExecTree(const PlanStage* root, vector<const PlanStage*>* flattened)
     }
 }
 
+/**
+ * Adds to 'events' a complete event of the Chrome trace event format for the stage of 'stats',
+ * starting at 'startMicros', and the events of its children nested in it. The stages only add up
+ * the time of their work, so each child starts when the previous one ends.
+ */
+void appendTraceEvents(const PlanStageStats& stats, double startMicros, BSONArrayBuilder* events) {
+    BSONObjBuilder event(events->subobjStart());
+    event.append("name", stats.common.stageTypeStr);
+    event.append("cat", "stage");
+    event.append("ph", "X");
+    event.append("ts", startMicros);
+    event.append("dur", stats.common.executionTimeNanos / 1000.0);
+    event.append("pid", 0);
+    event.append("tid", 0);
+
+    BSONObjBuilder args(event.subobjStart("args"));
+    args.appendNumber("works", stats.common.works);
+    args.appendNumber("advanced", stats.common.advanced);
+    if (AllocationCounter::isEnabled()) {
+        args.appendNumber("bytesAllocated", stats.common.bytesAllocated);
+    }
+    args.doneFast();
+    event.doneFast();
+
+    double childStartMicros = startMicros;
+    for (const PlanStageStats* child : stats.children) {
+        appendTraceEvents(*child, childStartMicros, events);
+        childStartMicros += child->common.executionTimeNanos / 1000.0;
+    }
+}
+
 /**
  * Get a pointer to the MultiPlanStage inside the stage tree rooted at 'root'.
  * Returns NULL if there is no MPS.
@@ -224,6 +259,12 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         bob->appendNumber("restoreState", stats.common.unyields);
         bob->appendNumber("isEOF", stats.common.isEOF);
         bob->appendNumber("invalidates", stats.common.invalidates);
+        if (stats.common.traced) {
+            bob->appendNumber("executionTimeNanos", stats.common.executionTimeNanos);
+            if (AllocationCounter::isEnabled()) {
+                bob->appendNumber("bytesAllocated", stats.common.bytesAllocated);
+            }
+        }
     }
 
     // Stage-specific stats
@@ -233,6 +274,7 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         if (verbosity >= ExplainCommon::EXEC_STATS) {
             bob->appendNumber("memUsage", spec->memUsage);
             bob->appendNumber("memLimit", spec->memLimit);
+            bob->appendBool("usedRecordIdBitmaps", spec->usedRecordIdBitmaps);
 
             bob->appendNumber("flaggedButPassed", spec->flaggedButPassed);
             bob->appendNumber("flaggedInProgress", spec->flaggedInProgress);
@@ -255,10 +297,18 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         bob->append("direction", spec->direction > 0 ? "forward" : "backward");
         if (verbosity >= ExplainCommon::EXEC_STATS) {
             bob->appendNumber("docsExamined", spec->docsTested);
+            bob->appendNumber("docBytesExamined", spec->docBytesTested);
+            if (spec->workers > 0) {
+                bob->appendNumber("workers", spec->workers);
+            }
         }
     } else if (STAGE_COUNT == stats.stageType) {
         CountStats* spec = static_cast<CountStats*>(stats.specific.get());
 
+        if (!spec->countedIndex.empty()) {
+            bob->append("countedIndex", spec->countedIndex);
+        }
+
         if (verbosity >= ExplainCommon::EXEC_STATS) {
             bob->appendNumber("nCounted", spec->nCounted);
             bob->appendNumber("nSkipped", spec->nSkipped);
@@ -268,6 +318,9 @@ void Explain::statsToBSON(const PlanStageStats& stats,
 
         if (verbosity >= ExplainCommon::EXEC_STATS) {
             bob->appendNumber("keysExamined", spec->keysExamined);
+            if (spec->usedRangeCount) {
+                bob->appendBool("usedRangeCount", true);
+            }
         }
 
         bob->append("keyPattern", spec->keyPattern);
@@ -309,7 +362,11 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         FetchStats* spec = static_cast<FetchStats*>(stats.specific.get());
         if (verbosity >= ExplainCommon::EXEC_STATS) {
             bob->appendNumber("docsExamined", spec->docsExamined);
+            bob->appendNumber("docBytesExamined", spec->docBytesExamined);
             bob->appendNumber("alreadyHasObj", spec->alreadyHasObj);
+            if (spec->fetchBatches > 0) {
+                bob->appendNumber("fetchBatches", spec->fetchBatches);
+            }
         }
     } else if (STAGE_GEO_NEAR_2D == stats.stageType || STAGE_GEO_NEAR_2DSPHERE == stats.stageType) {
         NearStats* spec = static_cast<NearStats*>(stats.specific.get());
@@ -353,6 +410,12 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         bob->appendBool("isPartial", spec->isPartial);
         bob->append("indexVersion", spec->indexVersion);
         bob->append("direction", spec->direction > 0 ? "forward" : "backward");
+        if (spec->isSkipScan) {
+            bob->appendBool("isSkipScan", true);
+        }
+        if (spec->mergedPointScans > 0) {
+            bob->appendNumber("mergedPointScans", spec->mergedPointScans);
+        }
 
         if ((topLevelBob->len() + spec->indexBounds.objsize()) > kMaxStatsBSONSize) {
             bob->append("warning", "index bounds omitted due to BSON size limit");
@@ -365,6 +428,7 @@ void Explain::statsToBSON(const PlanStageStats& stats,
             bob->appendNumber("dupsTested", spec->dupsTested);
             bob->appendNumber("dupsDropped", spec->dupsDropped);
             bob->appendNumber("seenInvalidated", spec->seenInvalidated);
+            bob->appendNumber("seeks", spec->seeks);
         }
     } else if (STAGE_OR == stats.stageType) {
         OrStats* spec = static_cast<OrStats*>(stats.specific.get());
@@ -385,6 +449,7 @@ void Explain::statsToBSON(const PlanStageStats& stats,
 
         if (verbosity >= ExplainCommon::EXEC_STATS) {
             bob->appendNumber("chunkSkips", spec->chunkSkips);
+            bob->appendBool("allKeysOwned", spec->allKeysOwned);
         }
     } else if (STAGE_SKIP == stats.stageType) {
         SkipStats* spec = static_cast<SkipStats*>(stats.specific.get());
@@ -396,6 +461,11 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         if (verbosity >= ExplainCommon::EXEC_STATS) {
             bob->appendNumber("memUsage", spec->memUsage);
             bob->appendNumber("memLimit", spec->memLimit);
+
+            if (spec->allowDiskUse) {
+                bob->appendNumber("spills", spec->spills);
+                bob->appendNumber("bytesSpilled", spec->bytesSpilled);
+            }
         }
 
         if (spec->limit > 0) {
@@ -424,8 +494,15 @@ void Explain::statsToBSON(const PlanStageStats& stats,
     } else if (STAGE_TEXT_OR == stats.stageType) {
         TextOrStats* spec = static_cast<TextOrStats*>(stats.specific.get());
 
+        if (spec->limit) {
+            bob->appendNumber("limitAmount", spec->limit);
+        }
+
         if (verbosity >= ExplainCommon::EXEC_STATS) {
             bob->appendNumber("docsExamined", spec->fetches);
+            if (spec->limit) {
+                bob->appendBool("stoppedEarly", spec->stoppedEarly);
+            }
         }
     } else if (STAGE_UPDATE == stats.stageType) {
         UpdateStats* spec = static_cast<UpdateStats*>(stats.specific.get());
@@ -437,6 +514,7 @@ void Explain::statsToBSON(const PlanStageStats& stats,
             bob->appendBool("wouldInsert", spec->inserted);
             bob->appendBool("fastmod", spec->fastmod);
             bob->appendBool("fastmodinsert", spec->fastmodinsert);
+            bob->appendNumber("nElementsMaterialized", spec->nElementsMaterialized);
         }
     }
 
@@ -604,6 +682,7 @@ void Explain::explainStages(PlanExecutor* exec,
     // If we need execution stats, then run the plan in order to gather the stats.
     Status executePlanStatus = Status::OK();
     if (verbosity >= ExplainCommon::EXEC_STATS) {
+        exec->getRootStage()->enableTracing();
         executePlanStatus = exec->executePlan();
     }
 
@@ -644,6 +723,16 @@ void Explain::explainStages(PlanExecutor* exec,
         long long totalTimeMillis = CurOp::get(opCtx)->elapsedMillis();
         generateExecStats(winningStats.get(), verbosity, &execBob, totalTimeMillis);
 
+        // How many heap allocations the working set made for owned copies of documents and
+        // index keys, to compare with nReturned.
+        const WorkingSetArena* arena = exec->getWorkingSet()->arena();
+        execBob.appendNumber("ownedObjAllocations",
+                             static_cast<long long>(arena->numAllocations()));
+
+        if (explainExecutionTrace) {
+            execBob.append("executionTrace", statsToChromeTrace(*winningStats));
+        }
+
         // Also generate exec stats for all plans, if the verbosity level is high enough.
         // These stats reflect what happened during the trial period that ranked the plans.
         if (verbosity >= ExplainCommon::EXEC_ALL_PLANS) {
@@ -671,6 +760,16 @@ void Explain::explainStages(PlanExecutor* exec,
     generateServerInfo(out);
 }
 
+// static
+BSONObj Explain::statsToChromeTrace(const PlanStageStats& stats) {
+    BSONObjBuilder bob;
+    BSONArrayBuilder events(bob.subarrayStart("traceEvents"));
+    appendTraceEvents(stats, 0, &events);
+    events.doneFast();
+    bob.append("displayTimeUnit", "ns");
+    return bob.obj();
+}
+
 // static
 std::string Explain::getPlanSummary(const PlanExecutor* exec) {
     return getPlanSummary(exec->getRootStage());
@@ -766,4 +865,46 @@ void Explain::getSummaryStats(const PlanExecutor& exec, PlanSummaryStats* statsO
     }
 }
 
+// static
+void Explain::getSummaryStats(const PlanStageStats& stats, PlanSummaryStats* statsOut) {
+    invariant(NULL != statsOut);
+
+    statsOut->nReturned = stats.common.advanced;
+    statsOut->executionTimeMillis = stats.common.executionTimeMillis;
+
+    vector<const PlanStageStats*> statsNodes;
+    flattenStatsTree(&stats, &statsNodes);
+
+    for (size_t i = 0; i < statsNodes.size(); ++i) {
+        statsOut->totalKeysExamined +=
+            getKeysExamined(statsNodes[i]->stageType, statsNodes[i]->specific.get());
+        statsOut->totalDocsExamined +=
+            getDocsExamined(statsNodes[i]->stageType, statsNodes[i]->specific.get());
+
+        const StageType stageType = statsNodes[i]->stageType;
+        const SpecificStats* specific = statsNodes[i]->specific.get();
+        if (STAGE_IDHACK == stageType) {
+            statsOut->isIdhack = true;
+        }
+        if (STAGE_SORT == stageType) {
+            statsOut->hasSortStage = true;
+        }
+
+        if (STAGE_IXSCAN == stageType) {
+            statsOut->indexesUsed.insert(static_cast<const IndexScanStats*>(specific)->indexName);
+        } else if (STAGE_COUNT_SCAN == stageType) {
+            statsOut->indexesUsed.insert(static_cast<const CountScanStats*>(specific)->indexName);
+        } else if (STAGE_IDHACK == stageType) {
+            statsOut->indexesUsed.insert(static_cast<const IDHackStats*>(specific)->indexName);
+        } else if (STAGE_DISTINCT_SCAN == stageType) {
+            statsOut->indexesUsed.insert(
+                static_cast<const DistinctScanStats*>(specific)->indexName);
+        } else if (STAGE_TEXT == stageType) {
+            statsOut->indexesUsed.insert(static_cast<const TextStats*>(specific)->indexName);
+        } else if (STAGE_GEO_NEAR_2D == stageType || STAGE_GEO_NEAR_2DSPHERE == stageType) {
+            statsOut->indexesUsed.insert(static_cast<const NearStats*>(specific)->indexName);
+        }
+    }
+}
+
 }  // namespace mongo
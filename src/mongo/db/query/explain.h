@@ -121,6 +121,13 @@ public:
                             BSONObjBuilder* bob,
                             ExplainCommon::Verbosity verbosity = ExplainCommon::EXEC_STATS);
 
+    /**
+     * Converts the stats tree 'stats' of a traced plan into a trace of the Chrome trace event
+     * format, with an event for each stage lasting the time of its work, which includes the
+     * events of its children.
+     */
+    static BSONObj statsToChromeTrace(const PlanStageStats& stats);
+
     /**
      * Returns a short plan summary std::string describing the leaves of the query plan.
      */
@@ -142,6 +149,14 @@ public:
      */
     static void getSummaryStats(const PlanExecutor& exec, PlanSummaryStats* statsOut);
 
+    /**
+     * Fills out 'statsOut' with summary stats using an already extracted stats tree.
+     *
+     * Used to summarize stats trees which outlive their execution tree, such as the ones kept in
+     * the plan cache.
+     */
+    static void getSummaryStats(const PlanStageStats& stats, PlanSummaryStats* statsOut);
+
 private:
     /**
      * Private helper that does the heavy-lifting for the public statsToBSON(...) functions
@@ -48,7 +48,10 @@ namespace mongo {
  */
 class ExpressionMapping {
 public:
-    static BSONObj hash(const BSONElement& value);
+    /**
+     * Returns the key a hashed index with the spec 'indexInfoObj' has for 'value'.
+     */
+    static BSONObj hash(const BSONElement& value, const BSONObj& indexInfoObj);
 
     static std::vector<GeoHash> get2dCovering(const R2Region& region,
                                               const BSONObj& indexInfoObj,
@@ -41,4 +41,7 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryS2GeoFinestLevel, int, 23);
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryS2GeoCoarsestLevel, int, 0);
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryS2GeoMaxCells, int, 20);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryS2GeoNearTargetIntervalResults, int, 400);
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryS2GeoNearCoveringCacheSize, int, 1024);
+
 }  // namespace mongo
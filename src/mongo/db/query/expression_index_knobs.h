@@ -57,4 +57,12 @@ extern int internalQueryS2GeoCoarsestLevel;
 // What is the maximum cell count that we want? (advisory, not a hard threshold)
 extern int internalQueryS2GeoMaxCells;
 
+// How many documents should each geoNear annulus after the first hold? The annuli over a
+// 2dsphere index grow or shrink to this count, given the density of the annuli already scanned.
+extern int internalQueryS2GeoNearTargetIntervalResults;
+
+// How many geoNear annulus coverings do we keep for repeated queries around the same point?
+// 0 disables the cache.
+extern int internalQueryS2GeoNearCoveringCacheSize;
+
 }  // namespace mongo
@@ -54,6 +54,7 @@
 #include "mongo/db/server_options.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/rpc/vectored_reply_builder.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/stale_exception.h"
 #include "mongo/stdx/memory.h"
@@ -191,7 +192,7 @@ void endQueryOp(OperationContext* txn,
 namespace {
 
 /**
- * Uses 'cursor' to fill out 'bb' with the batch of result documents to
+ * Uses 'cursor' to fill out 'reply' with the batch of result documents to
  * be returned by this getMore.
  *
  * Returns the number of documents in the batch in 'numResults', which must be initialized to
@@ -204,7 +205,7 @@ namespace {
  */
 void generateBatch(int ntoreturn,
                    ClientCursor* cursor,
-                   BufBuilder* bb,
+                   rpc::VectoredReplyBuilder* reply,
                    int* numResults,
                    Timestamp* slaveReadTill,
                    PlanExecutor::ExecState* state) {
@@ -213,7 +214,7 @@ void generateBatch(int ntoreturn,
     BSONObj obj;
     while (PlanExecutor::ADVANCED == (*state = exec->getNext(&obj, NULL))) {
         // Add result to output buffer.
-        bb->appendBuf((void*)obj.objdata(), obj.objsize());
+        reply->addDocument(obj);
 
         // Count the result.
         (*numResults)++;
@@ -226,7 +227,7 @@ void generateBatch(int ntoreturn,
             }
         }
 
-        if (FindCommon::enoughForGetMore(ntoreturn, *numResults, bb->len())) {
+        if (FindCommon::enoughForGetMore(ntoreturn, *numResults, reply->len())) {
             break;
         }
     }
@@ -244,12 +245,12 @@ void generateBatch(int ntoreturn,
 /**
  * Called by db/instance.cpp.  This is the getMore entry point.
  */
-QueryResult::View getMore(OperationContext* txn,
-                          const char* ns,
-                          int ntoreturn,
-                          long long cursorid,
-                          bool* exhaust,
-                          bool* isCursorAuthorized) {
+Message getMore(OperationContext* txn,
+                const char* ns,
+                int ntoreturn,
+                long long cursorid,
+                bool* exhaust,
+                bool* isCursorAuthorized) {
     CurOp& curop = *CurOp::get(txn);
 
     // For testing, we may want to fail if we receive a getmore.
@@ -316,11 +317,7 @@ QueryResult::View getMore(OperationContext* txn,
     int numResults = 0;
     int startingResult = 0;
 
-    const int InitialBufSize =
-        512 + sizeof(QueryResult::Value) + FindCommon::kMaxBytesToReturnToClientAtOnce;
-
-    BufBuilder bb(InitialBufSize);
-    bb.skip(sizeof(QueryResult::Value));
+    rpc::VectoredReplyBuilder reply;
 
     if (NULL == cc) {
         cursorid = 0;
@@ -370,9 +367,17 @@ QueryResult::View getMore(OperationContext* txn,
         exec->reattachToOperationContext(txn);
         exec->restoreState();
 
+        // If we're tailing a capped collection, retrieve a monotonically increasing insert
+        // counter before reading, so that an insert committed after we reach EOF wakes us up.
+        uint64_t lastInsertCount = 0;
+        if (isCursorAwaitData(cc)) {
+            invariant(ctx->getCollection()->isCapped());
+            lastInsertCount = ctx->getCollection()->getCappedInsertNotifier()->getCount();
+        }
+
         PlanExecutor::ExecState state;
 
-        generateBatch(ntoreturn, cc, &bb, &numResults, &slaveReadTill, &state);
+        generateBatch(ntoreturn, cc, &reply, &numResults, &slaveReadTill, &state);
 
         // If this is an await data cursor, and we hit EOF without generating any results, then
         // we block waiting for new data to arrive.
@@ -389,7 +394,6 @@ QueryResult::View getMore(OperationContext* txn,
 
             // Block waiting for data for up to 1 second.
             Seconds timeout(1);
-            uint64_t lastInsertCount = notifier->getCount();
             notifier->waitForInsert(lastInsertCount, timeout);
             notifier.reset();
 
@@ -403,7 +407,7 @@ QueryResult::View getMore(OperationContext* txn,
 
             // We woke up because either the timed_wait expired, or there was more data. Either
             // way, attempt to generate another batch of results.
-            generateBatch(ntoreturn, cc, &bb, &numResults, &slaveReadTill, &state);
+            generateBatch(ntoreturn, cc, &reply, &numResults, &slaveReadTill, &state);
         }
 
         // We have to do this before re-acquiring locks in the agg case because
@@ -458,16 +462,10 @@ QueryResult::View getMore(OperationContext* txn,
         }
     }
 
-    QueryResult::View qr = bb.buf();
-    qr.msgdata().setLen(bb.len());
-    qr.msgdata().setOperation(opReply);
-    qr.setResultFlags(resultFlags);
-    qr.setCursorId(cursorid);
-    qr.setStartingFrom(startingResult);
-    qr.setNReturned(numResults);
-    bb.decouple();
+    Message result;
+    reply.done(resultFlags, cursorid, startingResult, numResults, &result);
     LOG(5) << "getMore returned " << numResults << " results\n";
-    return qr;
+    return result;
 }
 
 std::string runQuery(OperationContext* txn,
@@ -554,11 +552,8 @@ std::string runQuery(OperationContext* txn,
     uassertStatusOK(serveReadsStatus);
 
     // Run the query.
-    // bb is used to hold query results
-    // this buffer should contain either requested documents per query or
-    // explain information, but not both
-    BufBuilder bb(32768);
-    bb.skip(sizeof(QueryResult::Value));
+    // reply is used to hold query results
+    rpc::VectoredReplyBuilder reply;
 
     // How many results have we obtained from the executor?
     int numResults = 0;
@@ -575,7 +570,7 @@ std::string runQuery(OperationContext* txn,
 
     while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, NULL))) {
         // Add result to output buffer.
-        bb.appendBuf((void*)obj.objdata(), obj.objsize());
+        reply.addDocument(obj);
 
         // Count the result.
         ++numResults;
@@ -588,7 +583,7 @@ std::string runQuery(OperationContext* txn,
             }
         }
 
-        if (FindCommon::enoughForFirstBatch(pq, numResults, bb.len())) {
+        if (FindCommon::enoughForFirstBatch(pq, numResults, reply.len())) {
             LOG(5) << "Enough for first batch, wantMore=" << pq.wantMore()
                    << " ntoreturn=" << pq.getNToReturn().value_or(0) << " numResults=" << numResults
                    << endl;
@@ -672,17 +667,8 @@ std::string runQuery(OperationContext* txn,
         endQueryOp(txn, collection, *exec, dbProfilingLevel, numResults, ccId);
     }
 
-    // Add the results from the query into the output buffer.
-    result.appendData(bb.buf(), bb.len());
-    bb.decouple();
-
-    // Fill out the output buffer's header.
-    QueryResult::View qr = result.header().view2ptr();
-    qr.setCursorId(ccId);
-    qr.setResultFlagsToOk();
-    qr.msgdata().setOperation(opReply);
-    qr.setStartingFrom(0);
-    qr.setNReturned(numResults);
+    // Add the results from the query into the output message and fill out its header.
+    reply.done(ResultFlag_AwaitCapable, ccId, 0, numResults, &result);
 
     // curop.debug().exhaust is set above.
     return curop.debug().exhaust ? nss.ns() : "";
@@ -38,6 +38,7 @@
 #include "mongo/base/error_codes.h"
 #include "mongo/base/parse_number.h"
 #include "mongo/client/dbclientinterface.h"
+#include "mongo/db/catalog/index_catalog_entry.h"
 #include "mongo/db/exec/cached_plan.h"
 #include "mongo/db/exec/count.h"
 #include "mongo/db/exec/delete.h"
@@ -50,10 +51,17 @@
 #include "mongo/db/exec/shard_filter.h"
 #include "mongo/db/exec/subplan.h"
 #include "mongo/db/exec/update.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/curop.h"
 #include "mongo/db/index_names.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index/index_prefix_counts.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/operation_arena.h"
 #include "mongo/db/ops/update_lifecycle.h"
 #include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/cardinality_estimator.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/internal_plans.h"
@@ -61,6 +69,7 @@
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/query/planner_access.h"
 #include "mongo/db/query/planner_analysis.h"
+#include "mongo/db/query/planner_ixselect.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
@@ -74,6 +83,7 @@
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/storage/oplog_hack.h"
+#include "mongo/db/storage/record_zone_map.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
@@ -118,6 +128,45 @@ void filterAllowedIndexEntries(const AllowedIndices& allowedIndices,
 namespace {
 // The body is below in the "count hack" section but getExecutor calls it.
 bool turnIxscanIntoCount(QuerySolution* soln);
+
+/**
+ * Could the planner skip-scan 'desc' for a query over 'fields'? That needs a compound btree
+ * index whose first field the query doesn't constrain but whose second field it does.
+ */
+bool mayBeSkipScanned(const IndexDescriptor* desc, const unordered_set<string>& fields) {
+    if (desc->getAccessMethodName() != IndexNames::BTREE || desc->isSparse()) {
+        return false;
+    }
+
+    BSONObjIterator it(desc->keyPattern());
+    if (!it.more() || fields.count(it.next().fieldName())) {
+        return false;
+    }
+    return it.more() && fields.count(it.next().fieldName());
+}
+
+/**
+ * Counts the distinct values of the first field in the index by seeking past each one in turn.
+ * Stops once there are more than 'limit' of them, returning limit + 1.
+ */
+long long countDistinctPrefixValues(OperationContext* txn,
+                                    const IndexAccessMethod* iam,
+                                    long long limit) {
+    std::unique_ptr<SortedDataInterface::Cursor> cursor = iam->newCursor(txn);
+
+    IndexSeekPoint seekPoint;
+    seekPoint.prefixLen = 1;
+    seekPoint.prefixExclusive = true;
+
+    long long count = 0;
+    const auto kWantKey = SortedDataInterface::Cursor::kWantKey;
+    for (auto entry = cursor->seek(BSONObj(), true, kWantKey); entry && count <= limit;
+         entry = cursor->seek(seekPoint, kWantKey)) {
+        ++count;
+        seekPoint.keyPrefix = entry->key.getOwned();
+    }
+    return count;
+}
 }  // namespace
 
 
@@ -125,7 +174,10 @@ void fillOutPlannerParams(OperationContext* txn,
                           Collection* collection,
                           CanonicalQuery* canonicalQuery,
                           QueryPlannerParams* plannerParams) {
+    plannerParams->arena = OperationArena::get(txn);
+
     // If it's not NULL, we may have indices.  Access the catalog and fill out IndexEntry(s)
+    unordered_set<string> queryFields;
     IndexCatalog::IndexIterator ii = collection->getIndexCatalog()->getIndexIterator(txn, false);
     while (ii.more()) {
         const IndexDescriptor* desc = ii.next();
@@ -138,6 +190,25 @@ void fillOutPlannerParams(OperationContext* txn,
                                                     desc->indexName(),
                                                     ice->getFilterExpression(),
                                                     desc->infoObj()));
+        plannerParams->indices.back().histogram =
+            collection->infoCache()->getIndexHistogram(desc->indexName());
+
+        // Skip-scans are only planned for indexes with few distinct leading values. Finding
+        // out how many costs a seek per value, up to the limit.
+        const long long maxPrefixValues = internalQueryPlannerMaxSkipScanPrefixValues;
+        if (maxPrefixValues > 0) {
+            if (queryFields.empty()) {
+                QueryPlannerIXSelect::getFields(canonicalQuery->root(), "", &queryFields);
+            }
+            if (mayBeSkipScanned(desc, queryFields)) {
+                try {
+                    plannerParams->indices.back().distinctPrefixValues =
+                        countDistinctPrefixValues(txn, ice->accessMethod(), maxPrefixValues);
+                } catch (const WriteConflictException&) {
+                    // Leave it unknown, which means the index isn't skip-scanned.
+                }
+            }
+        }
     }
 
     // If query supports index filters, filter params.indices by indices in query settings.
@@ -146,6 +217,12 @@ void fillOutPlannerParams(OperationContext* txn,
     PlanCacheKey planCacheKey =
         collection->infoCache()->getPlanCache()->computeKey(*canonicalQuery);
 
+    // Remember the shape of the query in case the operation is sampled by QueryShapeStats.
+    std::string& queryShape = CurOp::get(txn)->debug().queryShape;
+    if (queryShape.empty()) {
+        queryShape = planCacheKey;
+    }
+
     // Filter index catalog if index filters are specified for query.
     // Also, signal to planner that application hint should be ignored.
     if (querySettings->getAllowedIndices(planCacheKey, &allowedIndicesRaw)) {
@@ -270,7 +347,8 @@ Status prepareExecution(OperationContext* opCtx,
 
             // Stuff the right data into the params depending on what proj impl we use.
             if (canonicalQuery->getProj()->requiresDocument() ||
-                canonicalQuery->getProj()->wantIndexKey()) {
+                canonicalQuery->getProj()->wantIndexKey() ||
+                canonicalQuery->getProj()->hasDottedField()) {
                 params.fullExpression = canonicalQuery->root();
                 params.projImpl = ProjectionStageParams::NO_FAST_PATH;
             } else {
@@ -311,12 +389,18 @@ Status prepareExecution(OperationContext* opCtx,
 
             // Add a CachedPlanStage on top of the previous root.
             //
-            // 'decisionWorks' is used to determine whether the existing cache entry should
-            // be evicted, and the query replanned.
+            // 'decisionWorks' and 'decisionCostPerResult' are used to determine whether the
+            // existing cache entry should be evicted, and the query replanned.
             //
             // Takes ownership of '*rootOut'.
-            *rootOut = new CachedPlanStage(
-                opCtx, collection, ws, canonicalQuery, plannerParams, cs->decisionWorks, *rootOut);
+            *rootOut = new CachedPlanStage(opCtx,
+                                           collection,
+                                           ws,
+                                           canonicalQuery,
+                                           plannerParams,
+                                           cs->decisionWorks,
+                                           cs->decisionCostPerResult,
+                                           *rootOut);
             *querySolutionOut = qs;
             return Status::OK();
         }
@@ -369,6 +453,10 @@ Status prepareExecution(OperationContext* opCtx,
         }
     }
 
+    // Histograms collected by the analyze command let candidates that are clearly costlier than
+    // the others be dropped without competing in the trial period.
+    CardinalityEstimator::pruneSolutions(plannerParams.indices, &solutions);
+
     if (1 == solutions.size()) {
         // Only one possible plan.  Run it.  Build the stages from the solution.
         verify(StageBuilder::build(opCtx, collection, *solutions[0], ws, rootOut));
@@ -507,6 +595,35 @@ mongo::BSONElement extractOplogTsOptime(const mongo::MatchExpression* me) {
     return static_cast<const mongo::ComparisonMatchExpression*>(me)->getData();
 }
 
+/**
+ * Returns a predicate holding the top-level equality on the "ns" field of 'root', if it has one,
+ * so that the storage engine can skip ranges of the oplog without operations on that namespace.
+ */
+std::shared_ptr<const ZoneMapPredicate> makeOplogNsPredicate(const MatchExpression* root) {
+    std::vector<const MatchExpression*> candidates;
+    if (MatchExpression::AND == root->matchType()) {
+        for (size_t i = 0; i < root->numChildren(); ++i) {
+            candidates.push_back(root->getChild(i));
+        }
+    } else {
+        candidates.push_back(root);
+    }
+
+    for (const MatchExpression* me : candidates) {
+        if (MatchExpression::EQ != me->matchType() || me->path() != "ns") {
+            continue;
+        }
+        const BSONElement ns = static_cast<const ComparisonMatchExpression*>(me)->getData();
+        if (ns.type() != String) {
+            continue;
+        }
+        auto predicate = std::make_shared<ZoneMapPredicate>();
+        predicate->addComparison("ns", ZoneMapPredicate::Op::kEQ, ns);
+        return std::move(predicate);
+    }
+    return {};
+}
+
 StatusWith<unique_ptr<PlanExecutor>> getOplogStartHack(OperationContext* txn,
                                                        Collection* collection,
                                                        unique_ptr<CanonicalQuery> cq) {
@@ -585,6 +702,7 @@ StatusWith<unique_ptr<PlanExecutor>> getOplogStartHack(OperationContext* txn,
     params.start = *startLoc;
     params.direction = CollectionScanParams::FORWARD;
     params.tailable = cq->getParsed().isTailable();
+    params.zoneMapPredicate = makeOplogNsPredicate(cq->root());
 
     unique_ptr<WorkingSet> ws = make_unique<WorkingSet>();
     unique_ptr<CollectionScan> cs = make_unique<CollectionScan>(txn, params, ws.get(), cq->root());
@@ -1163,6 +1281,67 @@ BSONObj getDistinctProjection(const std::string& field) {
     return bob.obj();
 }
 
+/**
+ * Returns a counted index that can answer a count of the documents matching 'root' by itself,
+ * or NULL if there is none. Sets '*value' to the first field value to look up in it, or to an
+ * empty object if the count is that of all the documents in the index.
+ *
+ * A counted index answers an equality to a value on its first field, as long as all documents
+ * with that value are in the index, and a query equivalent to its filter if it is partial.
+ */
+const IndexDescriptor* getCountedIndex(OperationContext* txn,
+                                       Collection* collection,
+                                       const MatchExpression* root,
+                                       BSONObj* value) {
+    // Documents whose field is missing or null may be missing from sparse indexes, and the keys
+    // of arrays are their elements, so the counts can't answer equalities to those.
+    BSONElement equalityValue;
+    if (MatchExpression::EQ == root->matchType()) {
+        equalityValue = static_cast<const EqualityMatchExpression*>(root)->getData();
+        switch (equalityValue.type()) {
+            case Array:
+            case jstNULL:
+            case Undefined:
+            case RegEx:
+            case MinKey:
+            case MaxKey:
+                equalityValue = BSONElement();
+                break;
+            default:
+                break;
+        }
+    }
+
+    std::unique_ptr<MatchExpression> normalizedFilter;
+    const IndexCatalog* catalog = collection->getIndexCatalog();
+    IndexCatalog::IndexIterator ii = catalog->getIndexIterator(txn, false);
+    while (ii.more()) {
+        const IndexDescriptor* desc = ii.next();
+        const IndexCatalogEntry* entry = catalog->getEntry(desc);
+        const IndexPrefixCounts* prefixCounts = entry->prefixCounts();
+        if (!prefixCounts || !prefixCounts->isInitialized()) {
+            continue;
+        }
+
+        const MatchExpression* filter = entry->getFilterExpression();
+        if (filter) {
+            // The query is normalized, so the filter has to be too.
+            normalizedFilter.reset(CanonicalQuery::normalizeTree(filter->shallowClone().release()));
+            CanonicalQuery::sortTree(normalizedFilter.get());
+            if (root->equivalent(normalizedFilter.get())) {
+                *value = BSONObj();
+                return desc;
+            }
+        } else if (!equalityValue.eoo() &&
+                   root->path() == desc->keyPattern().firstElementFieldName()) {
+            *value = equalityValue.wrap("");
+            return desc;
+        }
+    }
+
+    return NULL;
+}
+
 }  // namespace
 
 StatusWith<unique_ptr<PlanExecutor>> getExecutorCount(OperationContext* txn,
@@ -1222,6 +1401,19 @@ StatusWith<unique_ptr<PlanExecutor>> getExecutorCount(OperationContext* txn,
 
     invariant(cq.get());
 
+    // Counted indexes keep the answer to some counts, as long as no hint asks for a plan.
+    if (request.getHint().isEmpty()) {
+        BSONObj countedValue;
+        const IndexDescriptor* countedIndex =
+            getCountedIndex(txn, collection, cq->root(), &countedValue);
+        if (countedIndex) {
+            unique_ptr<PlanStage> root = make_unique<CountStage>(
+                txn, collection, request, ws.get(), countedIndex, countedValue);
+            return PlanExecutor::make(
+                txn, std::move(ws), std::move(root), request.getNs().ns(), yieldPolicy);
+        }
+    }
+
     const size_t plannerOptions = QueryPlannerParams::PRIVATE_IS_COUNT;
     PlanStage* child;
     QuerySolution* rawQuerySolution;
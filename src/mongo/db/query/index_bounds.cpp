@@ -492,13 +492,19 @@ IndexBoundsChecker::KeyState IndexBoundsChecker::checkKey(const BSONObj& key, In
     // Field number 'firstNonContainedField' of the index key is after interval we think it's
     // in.  Fields 0 through 'firstNonContained-1' are within their current intervals and we can
     // ignore them.
+    const size_t firstAheadField = firstNonContainedField;
     while (firstNonContainedField < _curInterval.size()) {
-        // Find the interval that contains our field.
+        // Find the interval that contains our field.  The first field we look at is ahead of
+        // its current interval, so its new interval can't be an earlier one.  Fields to the
+        // right of it may have to go back to any of their intervals.
         size_t newIntervalForField;
+        const size_t startIndex =
+            firstNonContainedField == firstAheadField ? _curInterval[firstNonContainedField] : 0;
 
         Location where = findIntervalForField(keyValues[firstNonContainedField],
                                               _bounds->fields[firstNonContainedField],
                                               _expectedDirection[firstNonContainedField],
+                                              startIndex,
                                               &newIntervalForField);
 
         if (WITHIN == where) {
@@ -580,6 +586,32 @@ IndexBoundsChecker::Location IndexBoundsChecker::findIntervalForField(
     const OrderedIntervalList& oil,
     const int expectedDirection,
     size_t* newIntervalIndex) {
+    return findIntervalForField(elt, oil, expectedDirection, 0, newIntervalIndex);
+}
+
+// static
+IndexBoundsChecker::Location IndexBoundsChecker::findIntervalForField(
+    const BSONElement& elt,
+    const OrderedIntervalList& oil,
+    const int expectedDirection,
+    size_t startIndex,
+    size_t* newIntervalIndex) {
+    const std::pair<BSONElement, int> keyAndDirection = std::make_pair(elt, expectedDirection);
+    const size_t numIntervals = oil.intervals.size();
+
+    // Gallop over the intervals the key is ahead of, doubling the stride each time, until we
+    // reach one it isn't ahead of or run out of intervals.  The interval we want is in
+    // [searchBegin, searchEnd).
+    size_t searchBegin = std::min(startIndex, numIntervals);
+    size_t probe = searchBegin;
+    size_t stride = 1;
+    while (probe < numIntervals && isKeyAheadOfInterval(oil.intervals[probe], keyAndDirection)) {
+        searchBegin = probe + 1;
+        probe += stride;
+        stride *= 2;
+    }
+    const size_t searchEnd = std::min(probe + 1, numIntervals);
+
     // Binary search for interval.
     // Intervals are ordered in the same direction as our keys.
     // Key behind all intervals: [BEHIND, ..., BEHIND]
@@ -588,9 +620,9 @@ IndexBoundsChecker::Location IndexBoundsChecker::findIntervalForField(
     // Key not in any inteval: [AHEAD, ..., AHEAD, BEHIND, ...]
 
     // Find left-most BEHIND/WITHIN interval.
-    vector<Interval>::const_iterator i = std::lower_bound(oil.intervals.begin(),
-                                                          oil.intervals.end(),
-                                                          std::make_pair(elt, expectedDirection),
+    vector<Interval>::const_iterator i = std::lower_bound(oil.intervals.begin() + searchBegin,
+                                                          oil.intervals.begin() + searchEnd,
+                                                          keyAndDirection,
                                                           isKeyAheadOfInterval);
 
     // Key ahead of all intervals.
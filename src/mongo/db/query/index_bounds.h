@@ -202,12 +202,23 @@ public:
      * If 'elt' cannot be advanced to any interval, return AHEAD.
      *
      * Exposed for testing only.
+     */
+    static Location findIntervalForField(const BSONElement& elt,
+                                         const OrderedIntervalList& oil,
+                                         const int expectedDirection,
+                                         size_t* newIntervalIndex);
+
+    /**
+     * As above, but 'elt' is known to be ahead of every interval before 'startIndex'.  Gallops
+     * forward from 'startIndex' before binary searching, so that finding an interval near the
+     * one the scan is already in costs a few comparisons even when 'oil' has many intervals.
      *
-     * TODO(efficiency): Start search from a given index.
+     * Exposed for testing only.
      */
     static Location findIntervalForField(const BSONElement& elt,
                                          const OrderedIntervalList& oil,
                                          const int expectedDirection,
+                                         size_t startIndex,
                                          size_t* newIntervalIndex);
 
 private:
@@ -336,7 +336,7 @@ void IndexBoundsBuilder::translate(const MatchExpression* expr,
         }
     } else if (MatchExpression::EQ == expr->matchType()) {
         const EqualityMatchExpression* node = static_cast<const EqualityMatchExpression*>(expr);
-        translateEquality(node->getData(), isHashed, oilOut, tightnessOut);
+        translateEquality(node->getData(), isHashed, index, oilOut, tightnessOut);
     } else if (MatchExpression::LTE == expr->matchType()) {
         const LTEMatchExpression* node = static_cast<const LTEMatchExpression*>(expr);
         BSONElement dataElt = node->getData();
@@ -524,7 +524,7 @@ void IndexBoundsBuilder::translate(const MatchExpression* expr,
         IndexBoundsBuilder::BoundsTightness tightness;
         for (BSONElementSet::iterator it = afr.equalities().begin(); it != afr.equalities().end();
              ++it) {
-            translateEquality(*it, isHashed, oilOut, &tightness);
+            translateEquality(*it, isHashed, index, oilOut, &tightness);
             if (tightness != IndexBoundsBuilder::EXACT) {
                 *tightnessOut = tightness;
             }
@@ -780,6 +780,7 @@ void IndexBoundsBuilder::translateRegex(const RegexMatchExpression* rme,
 // static
 void IndexBoundsBuilder::translateEquality(const BSONElement& data,
                                            bool isHashed,
+                                           const IndexEntry& index,
                                            OrderedIntervalList* oil,
                                            BoundsTightness* tightnessOut) {
     // We have to copy the data out of the parse tree and stuff it into the index
@@ -787,7 +788,7 @@ void IndexBoundsBuilder::translateEquality(const BSONElement& data,
     if (Array != data.type()) {
         BSONObj dataObj;
         if (isHashed) {
-            dataObj = ExpressionMapping::hash(data);
+            dataObj = ExpressionMapping::hash(data, index.infoObj);
         } else {
             dataObj = objFromElement(data);
         }
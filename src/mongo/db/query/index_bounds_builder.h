@@ -157,8 +157,13 @@ public:
                                OrderedIntervalList* oil,
                                BoundsTightness* tightnessOut);
 
+    /**
+     * If 'isHashed', the bounds are on the hashes of 'data' computed with the seed and hash
+     * version of 'index'.
+     */
     static void translateEquality(const BSONElement& data,
                                   bool isHashed,
+                                  const IndexEntry& index,
                                   OrderedIntervalList* oil,
                                   BoundsTightness* tightnessOut);
 
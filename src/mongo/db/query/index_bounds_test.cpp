@@ -968,4 +968,62 @@ TEST(IndexBoundsCheckerTest, FindIntervalForField) {
     testFindIntervalForField(0, pointsObj, -1, IndexBoundsChecker::AHEAD, 0U);
 }
 
+TEST(IndexBoundsCheckerTest, FindIntervalForFieldFromStartIndex) {
+    // Points 0, 2, 4, ..., 98.
+    OrderedIntervalList oil("foo");
+    for (int i = 0; i < 100; i += 2) {
+        oil.intervals.push_back(Interval(BSON("" << i << "" << i), true, true));
+    }
+
+    // Every start index at or before the answer finds the same interval as a full search.
+    for (int key = 0; key <= 98; ++key) {
+        BSONObj keyObj = BSON("" << key);
+        const size_t expectedIndex = (key + 1) / 2;
+        const IndexBoundsChecker::Location expectedLocation =
+            key % 2 == 0 ? IndexBoundsChecker::WITHIN : IndexBoundsChecker::BEHIND;
+        for (size_t startIndex = 0; startIndex <= expectedIndex; ++startIndex) {
+            size_t intervalIndex = 0;
+            ASSERT_EQUALS(expectedLocation,
+                          IndexBoundsChecker::findIntervalForField(
+                              keyObj.firstElement(), oil, 1, startIndex, &intervalIndex));
+            ASSERT_EQUALS(expectedIndex, intervalIndex);
+        }
+    }
+
+    // Keys past the last point are ahead of every interval, wherever the search starts.
+    BSONObj keyObj = BSON("" << 99);
+    size_t intervalIndex = 0;
+    ASSERT_EQUALS(IndexBoundsChecker::AHEAD,
+                  IndexBoundsChecker::findIntervalForField(
+                      keyObj.firstElement(), oil, 1, 0, &intervalIndex));
+    ASSERT_EQUALS(IndexBoundsChecker::AHEAD,
+                  IndexBoundsChecker::findIntervalForField(
+                      keyObj.firstElement(), oil, 1, 49, &intervalIndex));
+    ASSERT_EQUALS(IndexBoundsChecker::AHEAD,
+                  IndexBoundsChecker::findIntervalForField(
+                      keyObj.firstElement(), oil, 1, 50, &intervalIndex));
+}
+
+TEST(IndexBoundsCheckerTest, CheckKeyManyPointsSkipsToLaterPoint) {
+    OrderedIntervalList oil("foo");
+    for (int i = 0; i < 1000; i += 10) {
+        oil.intervals.push_back(Interval(BSON("" << i << "" << i), true, true));
+    }
+    IndexBounds bounds;
+    bounds.fields.push_back(oil);
+    BSONObj idx = BSON("foo" << 1);
+    IndexBoundsChecker it(&bounds, idx, 1);
+
+    IndexSeekPoint seekPoint;
+    ASSERT_EQUALS(IndexBoundsChecker::VALID, it.checkKey(BSON("" << 0), &seekPoint));
+    ASSERT_EQUALS(IndexBoundsChecker::VALID, it.checkKey(BSON("" << 10), &seekPoint));
+
+    // A key between two points must advance to the next one.
+    ASSERT_EQUALS(IndexBoundsChecker::MUST_ADVANCE, it.checkKey(BSON("" << 555), &seekPoint));
+    ASSERT_EQUALS(seekPoint.keySuffix[0]->numberInt(), 560);
+    ASSERT_EQUALS(IndexBoundsChecker::VALID, it.checkKey(BSON("" << 560), &seekPoint));
+    ASSERT_EQUALS(IndexBoundsChecker::VALID, it.checkKey(BSON("" << 990), &seekPoint));
+    ASSERT_EQUALS(IndexBoundsChecker::DONE, it.checkKey(BSON("" << 991), &seekPoint));
+}
+
 }  // namespace
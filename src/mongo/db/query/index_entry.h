@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "mongo/db/index_names.h"
@@ -36,6 +37,7 @@
 
 namespace mongo {
 
+class IndexHistogram;
 class MatchExpression;
 
 /**
@@ -116,6 +118,14 @@ struct IndexEntry {
     // by the keyPattern?)
     IndexType type;
 
+    // How many distinct values the first field of the index holds, if it was worth finding out
+    // in order to consider skip-scanning the index. -1 if unknown.
+    long long distinctPrefixValues = -1;
+
+    // Distribution of the first field of the index's keys, if the analyze command has sampled
+    // it. Used to estimate how many keys a scan of the index examines.
+    std::shared_ptr<const IndexHistogram> histogram;
+
     std::string toString() const;
 };
 
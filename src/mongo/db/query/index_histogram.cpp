@@ -0,0 +1,132 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/index_histogram.h"
+
+#include <algorithm>
+
+namespace mongo {
+
+namespace {
+
+int compareValues(const BSONElement& lhs, const BSONElement& rhs) {
+    return lhs.woCompare(rhs, false);
+}
+
+}  // namespace
+
+IndexHistogram::IndexHistogram(const std::vector<BSONObj>& sample,
+                               size_t numBuckets,
+                               long long numKeys)
+    : _numKeys(numKeys) {
+    if (sample.empty() || numBuckets == 0) {
+        return;
+    }
+
+    // Each sampled value stands for this many keys of the index.
+    const double keysPerValue = static_cast<double>(numKeys) / sample.size();
+    const size_t bucketSize = (sample.size() + numBuckets - 1) / numBuckets;
+
+    for (size_t begin = 0; begin < sample.size(); begin += bucketSize) {
+        const size_t end = std::min(sample.size(), begin + bucketSize);
+
+        Bucket bucket;
+        bucket.low = sample[begin].getOwned();
+        bucket.high = sample[end - 1].getOwned();
+        bucket.numKeys = keysPerValue * (end - begin);
+        bucket.numDistinct = 1;
+        for (size_t i = begin + 1; i < end; ++i) {
+            if (compareValues(sample[i].firstElement(), sample[i - 1].firstElement()) != 0) {
+                ++bucket.numDistinct;
+            }
+        }
+        _buckets.push_back(bucket);
+    }
+}
+
+double IndexHistogram::estimateKeys(const OrderedIntervalList& oil) const {
+    double estimate = 0;
+    for (const Interval& interval : oil.intervals) {
+        estimate += estimateKeys(interval);
+    }
+    return std::min(estimate, static_cast<double>(_numKeys));
+}
+
+double IndexHistogram::estimateKeys(const Interval& interval) const {
+    // Intervals over descending fields run from high to low.
+    Interval ascending = interval;
+    if (ascending.start.woCompare(ascending.end, false) > 0) {
+        ascending.reverse();
+    }
+    const bool isPoint = ascending.isPoint();
+
+    double estimate = 0;
+    for (const Bucket& bucket : _buckets) {
+        const BSONElement low = bucket.low.firstElement();
+        const BSONElement high = bucket.high.firstElement();
+
+        // Skip buckets entirely outside the interval.
+        const int endVsLow = compareValues(ascending.end, low);
+        if (endVsLow < 0 || (endVsLow == 0 && !ascending.endInclusive)) {
+            continue;
+        }
+        const int startVsHigh = compareValues(ascending.start, high);
+        if (startVsHigh > 0 || (startVsHigh == 0 && !ascending.startInclusive)) {
+            continue;
+        }
+
+        const int startVsLow = compareValues(ascending.start, low);
+        const int endVsHigh = compareValues(ascending.end, high);
+        const bool coversLow = startVsLow < 0 || (startVsLow == 0 && ascending.startInclusive);
+        const bool coversHigh = endVsHigh > 0 || (endVsHigh == 0 && ascending.endInclusive);
+        if (coversLow && coversHigh) {
+            estimate += bucket.numKeys;
+        } else if (isPoint) {
+            // Assume the values within a bucket are equally frequent.
+            estimate += bucket.numKeys / bucket.numDistinct;
+        } else {
+            estimate += bucket.numKeys / 2;
+        }
+    }
+    return estimate;
+}
+
+void IndexHistogram::appendBuckets(StringData fieldName, BSONObjBuilder* bob) const {
+    BSONArrayBuilder bucketsBob(bob->subarrayStart(fieldName));
+    for (const Bucket& bucket : _buckets) {
+        BSONObjBuilder bucketBob(bucketsBob.subobjStart());
+        bucketBob.appendAs(bucket.low.firstElement(), "low");
+        bucketBob.appendAs(bucket.high.firstElement(), "high");
+        bucketBob.append("keys", bucket.numKeys);
+        bucketBob.append("distinct", static_cast<long long>(bucket.numDistinct));
+    }
+}
+
+}  // namespace mongo
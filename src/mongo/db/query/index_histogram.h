@@ -0,0 +1,90 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/index_bounds.h"
+
+namespace mongo {
+
+/**
+ * An equi-depth histogram over the first field of an index's keys, built by the analyze command
+ * from a sample of the keys. The planner uses it to estimate how many keys an index scan over
+ * some bounds examines.
+ */
+class IndexHistogram {
+public:
+    /**
+     * Builds a histogram of at most 'numBuckets' buckets from 'sample', the values of the first
+     * key field of keys sampled from an index holding 'numKeys' keys. Each value is an object
+     * with one field; the field name is ignored. 'sample' must be sorted in ascending order.
+     */
+    IndexHistogram(const std::vector<BSONObj>& sample, size_t numBuckets, long long numKeys);
+
+    /**
+     * Estimates how many keys of the index have a first field within 'oil'. The intervals may be
+     * in either direction.
+     */
+    double estimateKeys(const OrderedIntervalList& oil) const;
+
+    long long numKeys() const {
+        return _numKeys;
+    }
+
+    size_t numBuckets() const {
+        return _buckets.size();
+    }
+
+    /**
+     * Appends the buckets as an array named 'fieldName', for the analyze command's output.
+     */
+    void appendBuckets(StringData fieldName, BSONObjBuilder* bob) const;
+
+private:
+    struct Bucket {
+        // Single-field objects holding the smallest and largest sampled value in the bucket.
+        BSONObj low;
+        BSONObj high;
+
+        // Estimated number of index keys within [low, high].
+        double numKeys;
+
+        // Number of distinct sampled values within [low, high].
+        size_t numDistinct;
+    };
+
+    double estimateKeys(const Interval& interval) const;
+
+    std::vector<Bucket> _buckets;
+    long long _numKeys;
+};
+
+}  // namespace mongo
@@ -0,0 +1,107 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/index_histogram.h"
+
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+
+std::vector<BSONObj> makeSample(const std::vector<int>& values) {
+    std::vector<BSONObj> sample;
+    for (int value : values) {
+        sample.push_back(BSON("" << value));
+    }
+    return sample;
+}
+
+OrderedIntervalList makeOil(const BSONObj& bounds, bool startInclusive, bool endInclusive) {
+    OrderedIntervalList oil("a");
+    oil.intervals.push_back(Interval(bounds, startInclusive, endInclusive));
+    return oil;
+}
+
+TEST(IndexHistogramTest, EmptySampleEstimatesNothing) {
+    IndexHistogram histogram(std::vector<BSONObj>(), 10, 0);
+    ASSERT_EQUALS(0U, histogram.numBuckets());
+    ASSERT_EQUALS(0, histogram.estimateKeys(makeOil(BSON("" << 0 << "" << 10), true, true)));
+}
+
+TEST(IndexHistogramTest, FullRangeEstimatesAllKeys) {
+    // Ten sampled values standing for a thousand keys.
+    IndexHistogram histogram(makeSample({1, 2, 3, 4, 5, 6, 7, 8, 9, 10}), 5, 1000);
+    ASSERT_EQUALS(5U, histogram.numBuckets());
+    ASSERT_EQUALS(1000,
+                  histogram.estimateKeys(makeOil(BSON("" << MINKEY << "" << MAXKEY), true, true)));
+}
+
+TEST(IndexHistogramTest, RangeCoveringSomeBuckets) {
+    // Buckets [1, 2], [3, 4], [5, 6], [7, 8], [9, 10] of 200 keys each.
+    IndexHistogram histogram(makeSample({1, 2, 3, 4, 5, 6, 7, 8, 9, 10}), 5, 1000);
+    ASSERT_EQUALS(400, histogram.estimateKeys(makeOil(BSON("" << 3 << "" << 6), true, true)));
+
+    // Only partially covers the buckets starting at 3 and ending at 6.
+    ASSERT_EQUALS(200, histogram.estimateKeys(makeOil(BSON("" << 3 << "" << 6), false, false)));
+
+    // Outside of every bucket.
+    ASSERT_EQUALS(0, histogram.estimateKeys(makeOil(BSON("" << 11 << "" << 20), true, true)));
+}
+
+TEST(IndexHistogramTest, DescendingInterval) {
+    IndexHistogram histogram(makeSample({1, 2, 3, 4, 5, 6, 7, 8, 9, 10}), 5, 1000);
+    ASSERT_EQUALS(400, histogram.estimateKeys(makeOil(BSON("" << 6 << "" << 3), true, true)));
+}
+
+TEST(IndexHistogramTest, PointEstimatesUseDistinctValues) {
+    // Buckets [1, 1], [1, 1], [2, 3] of 100 keys each.
+    IndexHistogram histogram(makeSample({1, 1, 1, 1, 2, 3}), 3, 300);
+    ASSERT_EQUALS(200, histogram.estimateKeys(makeOil(BSON("" << 1 << "" << 1), true, true)));
+    ASSERT_EQUALS(50, histogram.estimateKeys(makeOil(BSON("" << 2 << "" << 2), true, true)));
+}
+
+TEST(IndexHistogramTest, SumsIntervalsUpToNumKeys) {
+    IndexHistogram histogram(makeSample({1, 2, 3, 4}), 4, 4);
+    OrderedIntervalList oil("a");
+    oil.intervals.push_back(Interval(BSON("" << 1 << "" << 1), true, true));
+    oil.intervals.push_back(Interval(BSON("" << 3 << "" << 3), true, true));
+    ASSERT_EQUALS(2, histogram.estimateKeys(oil));
+
+    OrderedIntervalList overlapping("a");
+    overlapping.intervals.push_back(Interval(BSON("" << 1 << "" << 4), true, true));
+    overlapping.intervals.push_back(Interval(BSON("" << 1 << "" << 4), true, true));
+    ASSERT_EQUALS(4, histogram.estimateKeys(overlapping));
+}
+
+}  // namespace
@@ -84,6 +84,8 @@ const char kNToReturnField[] = "ntoreturn";
 const char kSingleBatchField[] = "singleBatch";
 const char kCommentField[] = "comment";
 const char kMaxScanField[] = "maxScan";
+const char kReadaheadField[] = "readahead";
+const char kParallelismField[] = "parallelism";
 const char kMaxField[] = "max";
 const char kMinField[] = "min";
 const char kReturnKeyField[] = "returnKey";
@@ -94,6 +96,7 @@ const char kOplogReplayField[] = "oplogReplay";
 const char kNoCursorTimeoutField[] = "noCursorTimeout";
 const char kAwaitDataField[] = "awaitData";
 const char kPartialResultsField[] = "allowPartialResults";
+const char kAllowDiskUseField[] = "allowDiskUse";
 const char kTermField[] = "term";
 const char kOptionsField[] = "options";
 const char kShardVersionField[] = "shardVersion";
@@ -251,6 +254,34 @@ StatusWith<unique_ptr<LiteParsedQuery>> LiteParsedQuery::makeFromFindCommand(Nam
             }
 
             pq->_maxScan = maxScan;
+        } else if (str::equals(fieldName, kReadaheadField)) {
+            if (!el.isNumber()) {
+                str::stream ss;
+                ss << "Failed to parse: " << cmdObj.toString() << ". "
+                   << "'readahead' field must be numeric.";
+                return Status(ErrorCodes::FailedToParse, ss);
+            }
+
+            int readahead = el.numberInt();
+            if (readahead < 0) {
+                return Status(ErrorCodes::BadValue, "readahead value must be non-negative");
+            }
+
+            pq->_readahead = readahead;
+        } else if (str::equals(fieldName, kParallelismField)) {
+            if (!el.isNumber()) {
+                str::stream ss;
+                ss << "Failed to parse: " << cmdObj.toString() << ". "
+                   << "'parallelism' field must be numeric.";
+                return Status(ErrorCodes::FailedToParse, ss);
+            }
+
+            int parallelism = el.numberInt();
+            if (parallelism < 0) {
+                return Status(ErrorCodes::BadValue, "parallelism value must be non-negative");
+            }
+
+            pq->_parallelism = parallelism;
         } else if (str::equals(fieldName, cmdOptionMaxTimeMS.c_str())) {
             StatusWith<int> maxTimeMS = parseMaxTimeMS(el);
             if (!maxTimeMS.isOK()) {
@@ -328,6 +359,13 @@ StatusWith<unique_ptr<LiteParsedQuery>> LiteParsedQuery::makeFromFindCommand(Nam
             }
 
             pq->_allowPartialResults = el.boolean();
+        } else if (str::equals(fieldName, kAllowDiskUseField)) {
+            Status status = checkFieldType(el, Bool);
+            if (!status.isOK()) {
+                return status;
+            }
+
+            pq->_allowDiskUse = el.boolean();
         } else if (str::equals(fieldName, kOptionsField)) {
             // 3.0.x versions of the shell may generate an explain of a find command with an
             // 'options' field. We accept this only if the 'options' field is empty so that
@@ -528,6 +566,14 @@ void LiteParsedQuery::asFindCommand(BSONObjBuilder* cmdBuilder) const {
         cmdBuilder->append(kMaxScanField, _maxScan);
     }
 
+    if (_readahead) {
+        cmdBuilder->append(kReadaheadField, *_readahead);
+    }
+
+    if (_parallelism > 0) {
+        cmdBuilder->append(kParallelismField, _parallelism);
+    }
+
     if (_maxTimeMS > 0) {
         cmdBuilder->append(cmdOptionMaxTimeMS, _maxTimeMS);
     }
@@ -572,6 +618,10 @@ void LiteParsedQuery::asFindCommand(BSONObjBuilder* cmdBuilder) const {
         cmdBuilder->append(kPartialResultsField, true);
     }
 
+    if (_allowDiskUse) {
+        cmdBuilder->append(kAllowDiskUseField, true);
+    }
+
     if (_replicationTerm) {
         cmdBuilder->append(kTermField, *_replicationTerm);
     }
@@ -909,6 +959,17 @@ Status LiteParsedQuery::initFullQuery(const BSONObj& top) {
             } else if (str::equals("maxScan", name)) {
                 // Won't throw.
                 _maxScan = e.numberInt();
+            } else if (str::equals("readahead", name)) {
+                if (!e.isNumber() || e.numberInt() < 0) {
+                    return Status(ErrorCodes::BadValue, "$readahead must be a non-negative number");
+                }
+                _readahead = e.numberInt();
+            } else if (str::equals("parallelism", name)) {
+                if (!e.isNumber() || e.numberInt() < 0) {
+                    return Status(ErrorCodes::BadValue,
+                                  "$parallelism must be a non-negative number");
+                }
+                _parallelism = e.numberInt();
             } else if (str::equals("showDiskLoc", name)) {
                 // Won't throw.
                 if (e.trueValue()) {
@@ -227,6 +227,12 @@ public:
     int getMaxScan() const {
         return _maxScan;
     }
+    boost::optional<int> getReadahead() const {
+        return _readahead;
+    }
+    int getParallelism() const {
+        return _parallelism;
+    }
     int getMaxTimeMS() const {
         return _maxTimeMS;
     }
@@ -273,6 +279,14 @@ public:
         return _allowPartialResults;
     }
 
+    /**
+     * Whether a blocking sort which exceeds its memory limit may spill to temporary files
+     * under the dbpath rather than fail.
+     */
+    bool allowDiskUse() const {
+        return _allowDiskUse;
+    }
+
     boost::optional<long long> getReplicationTerm() const {
         return _replicationTerm;
     }
@@ -376,6 +390,14 @@ private:
     int _maxScan = 0;
     int _maxTimeMS = 0;
 
+    // How far ahead of a collection scan the storage engine should read, in engine-specific units
+    // (extents on MMAPv1). Unset leaves the engine's default in place; 0 disables readahead.
+    boost::optional<int> _readahead;
+
+    // How many threads a collection scan may be split across, subject to
+    // internalQueryExecMaxCollectionScanParallelism. 0 or 1 scans on the calling thread.
+    int _parallelism = 0;
+
     BSONObj _min;
     BSONObj _max;
 
@@ -393,6 +415,8 @@ private:
     bool _exhaust = false;
     bool _allowPartialResults = false;
 
+    bool _allowDiskUse = false;
+
     boost::optional<long long> _replicationTerm;
 };
 
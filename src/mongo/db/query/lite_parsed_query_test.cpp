@@ -777,6 +777,105 @@ TEST(LiteParsedQueryTest, ParseFromCommandMaxScanWrongType) {
     ASSERT_NOT_OK(result.getStatus());
 }
 
+TEST(LiteParsedQueryTest, ParseFromCommandReadahead) {
+    BSONObj cmdObj = fromjson(
+        "{find: 'testns',"
+        "filter:  {a: 1},"
+        "readahead: 4}");
+    const NamespaceString nss("test.testns");
+    bool isExplain = false;
+    unique_ptr<LiteParsedQuery> lpq(
+        assertGet(LiteParsedQuery::makeFromFindCommand(nss, cmdObj, isExplain)));
+
+    ASSERT(lpq->getReadahead());
+    ASSERT_EQUALS(4, *lpq->getReadahead());
+    ASSERT_EQUALS(4, lpq->asFindCommand()["readahead"].numberInt());
+}
+
+TEST(LiteParsedQueryTest, ParseFromCommandReadaheadUnsetByDefault) {
+    BSONObj cmdObj = fromjson("{find: 'testns', filter: {a: 1}}");
+    const NamespaceString nss("test.testns");
+    bool isExplain = false;
+    unique_ptr<LiteParsedQuery> lpq(
+        assertGet(LiteParsedQuery::makeFromFindCommand(nss, cmdObj, isExplain)));
+
+    ASSERT_FALSE(lpq->getReadahead());
+    ASSERT_FALSE(lpq->asFindCommand().hasField("readahead"));
+}
+
+TEST(LiteParsedQueryTest, ParseFromCommandReadaheadWrongType) {
+    BSONObj cmdObj = fromjson(
+        "{find: 'testns',"
+        "filter:  {a: 1},"
+        "readahead: true}");
+    const NamespaceString nss("test.testns");
+    bool isExplain = false;
+    auto result = LiteParsedQuery::makeFromFindCommand(nss, cmdObj, isExplain);
+    ASSERT_NOT_OK(result.getStatus());
+}
+
+TEST(LiteParsedQueryTest, ParseFromCommandNegativeReadahead) {
+    BSONObj cmdObj = fromjson(
+        "{find: 'testns',"
+        "filter:  {a: 1},"
+        "readahead: -1}");
+    const NamespaceString nss("test.testns");
+    bool isExplain = false;
+    auto result = LiteParsedQuery::makeFromFindCommand(nss, cmdObj, isExplain);
+    ASSERT_NOT_OK(result.getStatus());
+}
+
+TEST(LiteParsedQueryTest, ParseFromCommandParallelism) {
+    BSONObj cmdObj = fromjson(
+        "{find: 'testns',"
+        "filter:  {a: 1},"
+        "parallelism: 4}");
+    const NamespaceString nss("test.testns");
+    bool isExplain = false;
+    unique_ptr<LiteParsedQuery> lpq(
+        assertGet(LiteParsedQuery::makeFromFindCommand(nss, cmdObj, isExplain)));
+
+    ASSERT_EQUALS(4, lpq->getParallelism());
+    ASSERT_EQUALS(4, lpq->asFindCommand()["parallelism"].numberInt());
+}
+
+TEST(LiteParsedQueryTest, ParseFromCommandNegativeParallelism) {
+    BSONObj cmdObj = fromjson(
+        "{find: 'testns',"
+        "filter:  {a: 1},"
+        "parallelism: -1}");
+    const NamespaceString nss("test.testns");
+    bool isExplain = false;
+    auto result = LiteParsedQuery::makeFromFindCommand(nss, cmdObj, isExplain);
+    ASSERT_NOT_OK(result.getStatus());
+}
+
+TEST(LiteParsedQueryTest, ParseFromCommandAllowDiskUse) {
+    BSONObj cmdObj = fromjson(
+        "{find: 'testns',"
+        "filter:  {a: 1},"
+        "sort: {b: 1},"
+        "allowDiskUse: true}");
+    const NamespaceString nss("test.testns");
+    bool isExplain = false;
+    unique_ptr<LiteParsedQuery> lpq(
+        assertGet(LiteParsedQuery::makeFromFindCommand(nss, cmdObj, isExplain)));
+
+    ASSERT(lpq->allowDiskUse());
+    ASSERT(lpq->asFindCommand()["allowDiskUse"].trueValue());
+}
+
+TEST(LiteParsedQueryTest, ParseFromCommandAllowDiskUseWrongType) {
+    BSONObj cmdObj = fromjson(
+        "{find: 'testns',"
+        "filter:  {a: 1},"
+        "allowDiskUse: 1}");
+    const NamespaceString nss("test.testns");
+    bool isExplain = false;
+    auto result = LiteParsedQuery::makeFromFindCommand(nss, cmdObj, isExplain);
+    ASSERT_NOT_OK(result.getStatus());
+}
+
 TEST(LiteParsedQueryTest, ParseFromCommandMaxTimeMSWrongType) {
     BSONObj cmdObj = fromjson(
         "{find: 'testns',"
@@ -170,6 +170,42 @@ public:
         return Status::OK();
     }
 
+    /**
+     * Removes and deletes every kv-store entry for which 'pred(key, value)' returns true.
+     * Returns the number of entries removed.
+     */
+    template <typename Predicate>
+    size_t removeIf(Predicate pred) {
+        size_t numRemoved = 0;
+        for (KVListIt i = _kvList.begin(); i != _kvList.end();) {
+            if (!pred(i->first, *i->second)) {
+                ++i;
+                continue;
+            }
+            delete i->second;
+            _kvMap.erase(i->first);
+            i = _kvList.erase(i);
+            _currentSize--;
+            numRemoved++;
+        }
+        return numRemoved;
+    }
+
+    /**
+     * Removes the least recently used entry and passes its ownership to the caller, or returns
+     * an empty unique_ptr if the kv-store is empty.
+     */
+    std::unique_ptr<V> removeLeastRecentlyUsed() {
+        if (_kvList.empty()) {
+            return std::unique_ptr<V>();
+        }
+        V* evictedEntry = _kvList.back().second;
+        _kvMap.erase(_kvList.back().first);
+        _kvList.pop_back();
+        _currentSize--;
+        return std::unique_ptr<V>(evictedEntry);
+    }
+
     /**
      * Deletes all entries in the kv-store.
      */
@@ -194,4 +194,52 @@ TEST(LRUKeyValueTest, IterationTest) {
     ASSERT(i == cache.end());
 }
 
+/**
+ * Test removing only the entries that match a predicate.
+ */
+TEST(LRUKeyValueTest, RemoveIfTest) {
+    LRUKeyValue<int, int> cache(10);
+    for (int i = 0; i < 6; i++) {
+        cache.add(i, new int(i * 10));
+    }
+
+    size_t numRemoved =
+        cache.removeIf([](const int& key, const int& value) { return value % 20 == 0; });
+    ASSERT_EQUALS(numRemoved, 3U);
+    ASSERT_EQUALS(cache.size(), 3U);
+    assertNotInKVStore(cache, 0);
+    assertNotInKVStore(cache, 2);
+    assertNotInKVStore(cache, 4);
+    assertInKVStore(cache, 1, 10);
+    assertInKVStore(cache, 3, 30);
+    assertInKVStore(cache, 5, 50);
+
+    // Nothing matches, so nothing is removed.
+    ASSERT_EQUALS(cache.removeIf([](const int& key, const int& value) { return key > 100; }), 0U);
+    ASSERT_EQUALS(cache.size(), 3U);
+}
+
+/**
+ * Test removing the least recently used entry.
+ */
+TEST(LRUKeyValueTest, RemoveLeastRecentlyUsedTest) {
+    LRUKeyValue<int, int> cache(10);
+    ASSERT(!cache.removeLeastRecentlyUsed());
+    for (int i = 0; i < 3; i++) {
+        cache.add(i, new int(i * 10));
+    }
+
+    // Reading the oldest entry makes the next one the least recently used.
+    int* value;
+    ASSERT_OK(cache.get(0, &value));
+
+    std::unique_ptr<int> evicted = cache.removeLeastRecentlyUsed();
+    ASSERT(evicted);
+    ASSERT_EQUALS(*evicted, 10);
+    ASSERT_EQUALS(cache.size(), 2U);
+    assertNotInKVStore(cache, 1);
+    assertInKVStore(cache, 0, 0);
+    assertInKVStore(cache, 2, 20);
+}
+
 }  // namespace
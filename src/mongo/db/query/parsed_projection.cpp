@@ -241,10 +241,11 @@ Status ParsedProjection::make(const BSONObj& spec,
     pp->_source = spec;
     pp->_returnKey = hasIndexKeyProjection;
 
-    // Dotted fields aren't covered, non-simple require match details, and as for include, "if
-    // we default to including then we can't use an index because we don't know what we're
-    // missing."
-    pp->_requiresDocument = include || hasNonSimple || hasDottedField;
+    // Non-simple projections require match details, as does the positional operator, and as for
+    // include, "if we default to including then we can't use an index because we don't know
+    // what we're missing."
+    pp->_requiresDocument = include || hasNonSimple || ARRAY_OP_POSITIONAL == arrayOpType;
+    pp->_hasDottedField = hasDottedField;
 
     // Add meta-projections.
     pp->_wantGeoNearPoint = wantGeoNearPoint;
@@ -258,7 +259,7 @@ Status ParsedProjection::make(const BSONObj& spec,
             pp->_requiredFields.push_back("_id");
         }
 
-        // The only way we could be here is if spec is only simple non-dotted-field projections.
+        // The only way we could be here is if spec is only simple field projections.
         // Therefore we can iterate over spec to get the fields required.
         BSONObjIterator srcIt(spec);
         while (srcIt.more()) {
@@ -267,10 +268,31 @@ Status ParsedProjection::make(const BSONObj& spec,
             if (includeID && mongoutils::str::equals(elt.fieldName(), "_id")) {
                 continue;
             }
+            // No document has a field whose name starts with '$', so there's nothing to get for
+            // one.  The aggregation framework asks for {$noFieldsNeeded: 1} when it needs no
+            // fields at all.
+            if (elt.fieldName()[0] == '$') {
+                continue;
+            }
             if (elt.trueValue()) {
                 pp->_requiredFields.push_back(elt.fieldName());
             }
         }
+
+        // A covered projection builds its output from the values of the fields it includes, so
+        // it can't include both a field and a path within that field.
+        if (hasDottedField) {
+            const std::vector<string>& fields = pp->_requiredFields;
+            for (size_t i = 0; i < fields.size() && !pp->_requiresDocument; ++i) {
+                for (size_t j = 0; j < fields.size(); ++j) {
+                    if (i != j && mongoutils::str::startsWith(fields[j], fields[i] + '.')) {
+                        pp->_requiresDocument = true;
+                        pp->_requiredFields.clear();
+                        break;
+                    }
+                }
+            }
+        }
     }
 
     // returnKey clobbers everything except for sortKey meta-projection.
@@ -74,6 +74,14 @@ public:
         return _requiredFields;
     }
 
+    /**
+     * Does the projection include a dotted field?  If so, the simple projection
+     * implementations can't compute it from a fetched document.
+     */
+    bool hasDottedField() const {
+        return _hasDottedField;
+    }
+
     /**
      * Get the raw BSONObj proj spec obj
      */
@@ -130,6 +138,8 @@ private:
 
     bool _requiresDocument = true;
 
+    bool _hasDottedField = false;
+
     BSONObj _source;
 
     bool _wantGeoNearDistance = false;
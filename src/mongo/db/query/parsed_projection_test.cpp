@@ -137,6 +137,40 @@ TEST(ParsedProjectionTest, MakeSingleFieldCoveredIdBoolean) {
     ASSERT_EQUALS(fields[0], "a");
 }
 
+TEST(ParsedProjectionTest, MakeDottedFieldsCovered) {
+    unique_ptr<ParsedProjection> parsedProj(
+        createParsedProjection("{}", "{_id: 0, 'a.b': 1, 'a.c': 1, d: 1}"));
+    ASSERT(!parsedProj->requiresDocument());
+    ASSERT(parsedProj->hasDottedField());
+    const vector<string>& fields = parsedProj->getRequiredFields();
+    ASSERT_EQUALS(fields.size(), 3U);
+    ASSERT_EQUALS(fields[0], "a.b");
+    ASSERT_EQUALS(fields[1], "a.c");
+    ASSERT_EQUALS(fields[2], "d");
+}
+
+TEST(ParsedProjectionTest, FieldAndPathWithinItRequireDocument) {
+    unique_ptr<ParsedProjection> parsedProj(
+        createParsedProjection("{}", "{_id: 0, a: 1, 'a.b': 1}"));
+    ASSERT(parsedProj->requiresDocument());
+
+    parsedProj = createParsedProjection("{}", "{'_id.a': 1}");
+    ASSERT(parsedProj->requiresDocument());
+}
+
+TEST(ParsedProjectionTest, PositionalProjectionRequiresDocument) {
+    unique_ptr<ParsedProjection> parsedProj(createParsedProjection("{a: 1}", "{'a.$': 1}"));
+    ASSERT(parsedProj->requiresDocument());
+}
+
+// The aggregation framework's way of asking for no fields.
+TEST(ParsedProjectionTest, MakeNoFieldsNeededCovered) {
+    unique_ptr<ParsedProjection> parsedProj(
+        createParsedProjection("{}", "{_id: 0, $noFieldsNeeded: 1}"));
+    ASSERT(!parsedProj->requiresDocument());
+    ASSERT(parsedProj->getRequiredFields().empty());
+}
+
 //
 // Positional operator validation
 //
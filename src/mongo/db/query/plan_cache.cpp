@@ -33,15 +33,20 @@
 #include "mongo/db/query/plan_cache.h"
 
 #include <algorithm>
+#include <functional>
+#include <iterator>
 #include <math.h>
 #include <memory>
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/client/dbclientinterface.h"  // For QueryOption_foobar
 #include "mongo/db/matcher/expression_array.h"
 #include "mongo/db/matcher/expression_geo.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/query/planner_ixselect.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/query/query_knobs.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
@@ -58,6 +63,36 @@ const char kEncodeChildrenSeparator = ',';
 const char kEncodeSortSection = '~';
 const char kEncodeProjectionSection = '|';
 
+// Hands out the key versions of plan caches.
+AtomicUInt64 nextKeyVersion(1);
+
+// The name the plan caches of all collections are reported under by the MemoryBudget.
+const char kMemoryConsumerName[] = "planCache";
+
+// A rough allowance for the stage specific stats of each node of a stats tree, which hold index
+// bounds and key patterns of varying size.
+const size_t kEstimatedSpecificStatsBytes = 256;
+
+size_t estimateStatsTreeBytes(const PlanStageStats* stats) {
+    size_t bytes = sizeof(PlanStageStats) + kEstimatedSpecificStatsBytes;
+    for (const PlanStageStats* child : stats->children) {
+        bytes += estimateStatsTreeBytes(child);
+    }
+    return bytes;
+}
+
+size_t estimateIndexTreeBytes(const PlanCacheIndexTree* tree) {
+    size_t bytes = sizeof(PlanCacheIndexTree);
+    if (tree->entry) {
+        bytes += sizeof(IndexEntry) + tree->entry->keyPattern.objsize() +
+            tree->entry->infoObj.objsize();
+    }
+    for (const PlanCacheIndexTree* child : tree->children) {
+        bytes += estimateIndexTreeBytes(child);
+    }
+    return bytes;
+}
+
 /**
  * Encode user-provided string. Cache key delimiters seen in the
  * user string are escaped with a backslash.
@@ -246,6 +281,24 @@ void encodeGeoNearMatchExpression(const GeoNearMatchExpression* tree, StringBuil
     }
 }
 
+/**
+ * Returns true if 'tree' or any of its descendants is tagged with the index named 'indexName'.
+ */
+bool indexTreeUsesIndex(const PlanCacheIndexTree* tree, StringData indexName) {
+    if (!tree) {
+        return false;
+    }
+    if (tree->entry && tree->entry->name == indexName) {
+        return true;
+    }
+    for (const PlanCacheIndexTree* child : tree->children) {
+        if (indexTreeUsesIndex(child, indexName)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 }  // namespace
 
 //
@@ -312,7 +365,8 @@ CachedSolution::CachedSolution(const PlanCacheKey& key, const PlanCacheEntry& en
       query(entry.query.getOwned()),
       sort(entry.sort.getOwned()),
       projection(entry.projection.getOwned()),
-      decisionWorks(entry.decision->stats[0]->common.works) {
+      decisionWorks(entry.decision->stats[0]->common.works),
+      decisionCostPerResult(entry.decision->winnerCostPerResult) {
     // CachedSolution should not having any references into
     // cache entry. All relevant data should be cloned/copied.
     for (size_t i = 0; i < entry.plannerData.size(); ++i) {
@@ -372,12 +426,17 @@ PlanCacheEntry* PlanCacheEntry::clone() const {
     entry->query = query.getOwned();
     entry->sort = sort.getOwned();
     entry->projection = projection.getOwned();
+    entry->indexableFields = indexableFields;
 
     // Copy performance stats.
     for (size_t i = 0; i < feedback.size(); ++i) {
         PlanCacheEntryFeedback* fb = new PlanCacheEntryFeedback();
         fb->stats.reset(feedback[i]->stats->clone());
         fb->score = feedback[i]->score;
+        fb->nReturned = feedback[i]->nReturned;
+        fb->keysExamined = feedback[i]->keysExamined;
+        fb->docsExamined = feedback[i]->docsExamined;
+        fb->executionTimeMillis = feedback[i]->executionTimeMillis;
         entry->feedback.push_back(fb);
     }
     return entry;
@@ -389,6 +448,34 @@ std::string PlanCacheEntry::toString() const {
                          << ";solutions: " << plannerData.size() << ")";
 }
 
+size_t PlanCacheEntry::estimateObjectSizeInBytes() const {
+    size_t bytes = sizeof(*this) + query.objsize() + sort.objsize() + projection.objsize();
+    for (const std::string& field : indexableFields) {
+        bytes += sizeof(field) + field.capacity();
+    }
+    for (const SolutionCacheData* data : plannerData) {
+        bytes += sizeof(SolutionCacheData);
+        if (data->tree) {
+            bytes += estimateIndexTreeBytes(data->tree.get());
+        }
+    }
+    if (decision) {
+        bytes += sizeof(PlanRankingDecision);
+        for (const PlanStageStats* stats : decision->stats.vector()) {
+            bytes += estimateStatsTreeBytes(stats);
+        }
+        bytes += decision->scores.size() * sizeof(double) +
+            decision->candidateOrder.size() * sizeof(size_t);
+    }
+    for (const PlanCacheEntryFeedback* fb : feedback) {
+        bytes += sizeof(PlanCacheEntryFeedback);
+        if (fb->stats) {
+            bytes += estimateStatsTreeBytes(fb->stats.get());
+        }
+    }
+    return bytes;
+}
+
 std::string CachedSolution::toString() const {
     return str::stream() << "key: " << key << '\n';
 }
@@ -476,11 +563,67 @@ std::string SolutionCacheData::toString() const {
 // PlanCache
 //
 
-PlanCache::PlanCache() : _cache(internalQueryCacheSize) {}
+PlanCache::PlanCache() : PlanCache("") {}
 
-PlanCache::PlanCache(const std::string& ns) : _cache(internalQueryCacheSize), _ns(ns) {}
+PlanCache::PlanCache(const std::string& ns)
+    : _ns(ns), _keyVersion(nextKeyVersion.fetchAndAdd(1)) {
+    // Each shard holds an even part of the entries, so eviction is only approximately LRU
+    // across the whole cache.
+    const size_t shardSize =
+        std::max(size_t(1), (size_t(internalQueryCacheSize) + kNumShards - 1) / kNumShards);
+    for (size_t i = 0; i < kNumShards; ++i) {
+        _shards.emplace_back(stdx::make_unique<Shard>(shardSize));
+    }
 
-PlanCache::~PlanCache() {}
+    // Only the caches of collections are accounted for, not the ones made by tests and tools.
+    if (!_ns.empty()) {
+        MemoryBudget::get()->registerConsumer(kMemoryConsumerName, this);
+    }
+}
+
+PlanCache::~PlanCache() {
+    if (!_ns.empty()) {
+        MemoryBudget::get()->unregisterConsumer(this);
+    }
+}
+
+int64_t PlanCache::bytesUsed() const {
+    int64_t bytes = 0;
+    for (const auto& shard : _shards) {
+        stdx::lock_guard<stdx::mutex> cacheLock(shard->mutex);
+        for (auto i = shard->cache.begin(); i != shard->cache.end(); ++i) {
+            bytes += i->first.capacity() + i->second->estimateObjectSizeInBytes();
+        }
+    }
+    return bytes;
+}
+
+int64_t PlanCache::shrink(int64_t bytes) {
+    int64_t freed = 0;
+    size_t numEvicted = 0;
+    bool evictedAny = true;
+    while (freed < bytes && evictedAny) {
+        evictedAny = false;
+        for (const auto& shard : _shards) {
+            if (freed >= bytes) {
+                break;
+            }
+            stdx::lock_guard<stdx::mutex> cacheLock(shard->mutex);
+            if (shard->cache.size() == 0) {
+                continue;
+            }
+            const size_t keyBytes = std::prev(shard->cache.end())->first.capacity();
+            std::unique_ptr<PlanCacheEntry> evictedEntry = shard->cache.removeLeastRecentlyUsed();
+            if (evictedEntry) {
+                freed += keyBytes + evictedEntry->estimateObjectSizeInBytes();
+                numEvicted++;
+                evictedAny = true;
+            }
+        }
+    }
+    LOG(1) << _ns << ": evicted " << numEvicted << " plan cache entries to free memory";
+    return freed;
+}
 
 /**
  * Traverses expression tree pre-order.
@@ -652,8 +795,15 @@ Status PlanCache::add(const CanonicalQuery& query,
     }
     entry->projection = projBuilder.obj();
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    std::unique_ptr<PlanCacheEntry> evictedEntry = _cache.add(computeKey(query), entry);
+    QueryPlannerIXSelect::getFields(query.root(), "", &entry->indexableFields);
+    for (auto elem : entry->sort) {
+        entry->indexableFields.insert(elem.fieldName());
+    }
+
+    PlanCacheKey key = computeKey(query);
+    Shard& shard = shardFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(shard.mutex);
+    std::unique_ptr<PlanCacheEntry> evictedEntry = shard.cache.add(key, entry);
 
     if (NULL != evictedEntry.get()) {
         LOG(1) << _ns << ": plan cache maximum size exceeded - "
@@ -667,9 +817,10 @@ Status PlanCache::get(const CanonicalQuery& query, CachedSolution** crOut) const
     PlanCacheKey key = computeKey(query);
     verify(crOut);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    Shard& shard = shardFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(shard.mutex);
     PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(key, &entry);
+    Status cacheStatus = shard.cache.get(key, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
@@ -687,9 +838,10 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
     std::unique_ptr<PlanCacheEntryFeedback> autoFeedback(feedback);
     PlanCacheKey ck = computeKey(cq);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    Shard& shard = shardFor(ck);
+    stdx::lock_guard<stdx::mutex> cacheLock(shard.mutex);
     PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(ck, &entry);
+    Status cacheStatus = shard.cache.get(ck, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
@@ -704,31 +856,92 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
 }
 
 Status PlanCache::remove(const CanonicalQuery& canonicalQuery) {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.remove(computeKey(canonicalQuery));
+    PlanCacheKey key = computeKey(canonicalQuery);
+    Shard& shard = shardFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(shard.mutex);
+    return shard.cache.remove(key);
 }
 
 void PlanCache::clear() {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    _cache.clear();
+    for (const auto& shard : _shards) {
+        stdx::lock_guard<stdx::mutex> cacheLock(shard->mutex);
+        shard->cache.clear();
+    }
     _writeOperations.store(0);
 }
 
+size_t PlanCache::removeEntriesIf(stdx::function<bool(const PlanCacheEntry&)> pred) {
+    size_t numRemoved = 0;
+    for (const auto& shard : _shards) {
+        stdx::lock_guard<stdx::mutex> cacheLock(shard->mutex);
+        numRemoved += shard->cache.removeIf(
+            [&pred](const PlanCacheKey& key, const PlanCacheEntry& entry) { return pred(entry); });
+    }
+    return numRemoved;
+}
+
+size_t PlanCache::removeEntriesUsingIndex(StringData indexName) {
+    size_t numRemoved = removeEntriesIf([indexName](const PlanCacheEntry& entry) {
+        for (const SolutionCacheData* solnData : entry.plannerData) {
+            if (indexTreeUsesIndex(solnData->tree.get(), indexName)) {
+                return true;
+            }
+        }
+        return false;
+    });
+    LOG(1) << _ns << ": removed " << numRemoved << " plan cache entries using index "
+           << indexName;
+    return numRemoved;
+}
+
+size_t PlanCache::removeEntriesIndexableBy(const BSONObj& keyPattern) {
+    // Whether a geo or text index applies depends on more than the fields of the query, so
+    // these don't get the benefit of the doubt.
+    const std::string accessMethod = IndexNames::findPluginName(keyPattern);
+    if (accessMethod != IndexNames::BTREE && accessMethod != IndexNames::HASHED) {
+        size_t numRemoved = size();
+        clear();
+        LOG(1) << _ns << ": clearing plan cache - new " << accessMethod << " index "
+               << keyPattern;
+        return numRemoved;
+    }
+
+    // The planner only considers an index relevant to a query when the query predicates or
+    // sort mention its leading field.
+    const std::string leadingField = keyPattern.firstElementFieldName();
+    size_t numRemoved = removeEntriesIf([&leadingField](const PlanCacheEntry& entry) {
+        return entry.indexableFields.count(leadingField) > 0;
+    });
+    LOG(1) << _ns << ": removed " << numRemoved << " plan cache entries indexable by "
+           << keyPattern;
+    return numRemoved;
+}
+
 PlanCacheKey PlanCache::computeKey(const CanonicalQuery& cq) const {
+    // A single query asks for its key several times on its way through planning, caching and
+    // feedback, so the encoding is only built once.
+    if (cq._planCacheKeyVersion == _keyVersion) {
+        return cq._planCacheKey;
+    }
+
     StringBuilder keyBuilder;
     encodeKeyForMatch(cq.root(), &keyBuilder);
     encodeKeyForSort(cq.getParsed().getSort(), &keyBuilder);
     encodeKeyForProj(cq.getParsed().getProj(), &keyBuilder);
-    return keyBuilder.str();
+
+    cq._planCacheKey = keyBuilder.str();
+    cq._planCacheKeyVersion = _keyVersion;
+    return cq._planCacheKey;
 }
 
 Status PlanCache::getEntry(const CanonicalQuery& query, PlanCacheEntry** entryOut) const {
     PlanCacheKey key = computeKey(query);
     verify(entryOut);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    Shard& shard = shardFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(shard.mutex);
     PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(key, &entry);
+    Status cacheStatus = shard.cache.get(key, &entry);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
@@ -740,29 +953,77 @@ Status PlanCache::getEntry(const CanonicalQuery& query, PlanCacheEntry** entryOu
 }
 
 std::vector<PlanCacheEntry*> PlanCache::getAllEntries() const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
     std::vector<PlanCacheEntry*> entries;
     typedef std::list<std::pair<PlanCacheKey, PlanCacheEntry*>>::const_iterator ConstIterator;
-    for (ConstIterator i = _cache.begin(); i != _cache.end(); i++) {
-        PlanCacheEntry* entry = i->second;
-        entries.push_back(entry->clone());
+    for (const auto& shard : _shards) {
+        stdx::lock_guard<stdx::mutex> cacheLock(shard->mutex);
+        for (ConstIterator i = shard->cache.begin(); i != shard->cache.end(); i++) {
+            PlanCacheEntry* entry = i->second;
+            entries.push_back(entry->clone());
+        }
     }
 
     return entries;
 }
 
 bool PlanCache::contains(const CanonicalQuery& cq) const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.hasKey(computeKey(cq));
+    PlanCacheKey key = computeKey(cq);
+    Shard& shard = shardFor(key);
+    stdx::lock_guard<stdx::mutex> cacheLock(shard.mutex);
+    return shard.cache.hasKey(key);
 }
 
 size_t PlanCache::size() const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.size();
+    size_t size = 0;
+    for (const auto& shard : _shards) {
+        stdx::lock_guard<stdx::mutex> cacheLock(shard->mutex);
+        size += shard->cache.size();
+    }
+    return size;
+}
+
+PlanCache::Shard& PlanCache::shardFor(const PlanCacheKey& key) const {
+    return *_shards[std::hash<PlanCacheKey>()(key) % kNumShards];
 }
 
 void PlanCache::notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries) {
+    const std::map<std::string, size_t> oldCounts = _indexabilityState.getDiscriminatorCounts();
     _indexabilityState.updateDiscriminators(indexEntries);
+    const std::map<std::string, size_t> newCounts = _indexabilityState.getDiscriminatorCounts();
+
+    // Keys remembered by queries may no longer have the right discriminators.
+    _keyVersion = nextKeyVersion.fetchAndAdd(1);
+
+    // Queries over a path whose discriminators changed now encode to different keys, so the
+    // entries cached under the old keys would only take up space until evicted.
+    std::set<std::string> changedPaths;
+    for (const auto& pathAndCount : oldCounts) {
+        auto it = newCounts.find(pathAndCount.first);
+        if (it == newCounts.end() || it->second != pathAndCount.second) {
+            changedPaths.insert(pathAndCount.first);
+        }
+    }
+    for (const auto& pathAndCount : newCounts) {
+        if (oldCounts.find(pathAndCount.first) == oldCounts.end()) {
+            changedPaths.insert(pathAndCount.first);
+        }
+    }
+    if (changedPaths.empty()) {
+        return;
+    }
+
+    // Discriminators are looked up by the path of a match expression, which below an
+    // $elemMatch is only the trailing part of the full field name.
+    removeEntriesIf([&changedPaths](const PlanCacheEntry& entry) {
+        for (const std::string& field : entry.indexableFields) {
+            for (const std::string& path : changedPaths) {
+                if (field == path || str::endsWith(field, "." + path)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    });
 }
 
 }  // namespace mongo
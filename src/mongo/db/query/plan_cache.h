@@ -38,7 +38,10 @@
 #include "mongo/db/query/plan_cache_indexability.h"
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/platform/unordered_set.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/memory_budget.h"
 
 namespace mongo {
 
@@ -60,6 +63,13 @@ struct PlanCacheEntryFeedback {
     // The "goodness" score produced by the plan ranker
     // corresponding to 'stats'.
     double score;
+
+    // What the cached plan actually did during its run: the results it produced, the index keys
+    // and documents it examined to produce them, and the time it took.
+    size_t nReturned = 0;
+    size_t keysExamined = 0;
+    size_t docsExamined = 0;
+    long long executionTimeMillis = 0;
 };
 
 // TODO: Replace with opaque type.
@@ -200,6 +210,10 @@ public:
     // The number of work cycles taken to decide on a winning plan when the plan was first
     // cached.
     size_t decisionWorks;
+
+    // The keys plus documents examined per result by the winning plan when it was first cached.
+    // Zero if the entry was not created by ranking plans.
+    double decisionCostPerResult;
 };
 
 /**
@@ -228,6 +242,11 @@ public:
     // For debugging.
     std::string toString() const;
 
+    /**
+     * An approximation of the bytes held by this entry, for accounting in the MemoryBudget.
+     */
+    size_t estimateObjectSizeInBytes() const;
+
     //
     // Planner data
     //
@@ -246,6 +265,10 @@ public:
     BSONObj sort;
     BSONObj projection;
 
+    // The fields of the query predicate and sort an index could be used for.  When an index is
+    // created, only entries with its leading field here are invalidated.
+    unordered_set<std::string> indexableFields;
+
     //
     // Performance stats
     //
@@ -264,8 +287,10 @@ public:
  * mapping, the cache contains information on why that mapping was made and statistics on the
  * cache entry's actual performance on subsequent runs.
  *
+ * The plan cache of a collection accounts for its entries in the MemoryBudget, which may have it
+ * evict its least recently used entries before the cache is full.
  */
-class PlanCache {
+class PlanCache : public MemoryConsumer {
 private:
     MONGO_DISALLOW_COPYING(PlanCache);
 
@@ -286,6 +311,17 @@ public:
 
     ~PlanCache();
 
+    /**
+     * The estimated bytes held by the cache entries and their keys.
+     */
+    int64_t bytesUsed() const override;
+
+    /**
+     * Evicts the least recently used entries of each shard in turn, until about 'bytes' bytes
+     * are freed or the cache is empty. Returns the estimated bytes freed.
+     */
+    int64_t shrink(int64_t bytes) override;
+
     /**
      * Record solutions for query. Best plan is first element in list.
      * Each query in the cache will have more than 1 plan because we only
@@ -338,6 +374,20 @@ public:
      */
     void clear();
 
+    /**
+     * Remove the cached plans with a candidate solution which uses the index named 'indexName'.
+     * Returns the number of entries removed.  Used when the index is dropped.
+     */
+    size_t removeEntriesUsingIndex(StringData indexName);
+
+    /**
+     * Remove the cached plans for which the planner could now also consider a newly created
+     * index with key pattern 'keyPattern', that is those with the leading field of the index
+     * among their indexable fields.  Special (geo, text) index types remove *all* cached plans.
+     * Returns the number of entries removed.
+     */
+    size_t removeEntriesIndexableBy(const BSONObj& keyPattern);
+
     /**
      * Get the cache key corresponding to the given canonical query.  The query need not already
      * be cached.
@@ -345,6 +395,9 @@ public:
      * This is provided in the public API simply as a convenience for consumers who need some
      * description of query shape (e.g. index filters).
      *
+     * The key is remembered by the query, so only the first call for a given query builds it.
+     * Later calls return it until the indexes of the collection change.
+     *
      * Callers must hold the collection lock when calling this method.
      */
     PlanCacheKey computeKey(const CanonicalQuery&) const;
@@ -384,6 +437,9 @@ public:
      * Updates internal state kept about the collection's indexes.  Must be called when the set
      * of indexes on the associated collection have changed.
      *
+     * Removes the cached plans whose keys change because a sparse or partial index now
+     * discriminates differently on one of their fields, as they can no longer be looked up.
+     *
      * Callers must hold the collection lock in exclusive mode when calling this method.
      */
     void notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries);
@@ -393,10 +449,31 @@ private:
     void encodeKeyForSort(const BSONObj& sortObj, StringBuilder* keyBuilder) const;
     void encodeKeyForProj(const BSONObj& projObj, StringBuilder* keyBuilder) const;
 
-    LRUKeyValue<PlanCacheKey, PlanCacheEntry> _cache;
+    // The entries are split by key hash over this many shards, each with its own lock, so that
+    // lookups of different query shapes in a busy collection don't all wait on one mutex.
+    static const size_t kNumShards = 16;
 
-    // Protects _cache.
-    mutable stdx::mutex _cacheMutex;
+    struct Shard {
+        explicit Shard(size_t maxSize) : cache(maxSize) {}
+
+        LRUKeyValue<PlanCacheKey, PlanCacheEntry> cache;
+
+        // Protects 'cache'.
+        stdx::mutex mutex;
+    };
+
+    /**
+     * Returns the shard which holds the entry for 'key', if there is one.
+     */
+    Shard& shardFor(const PlanCacheKey& key) const;
+
+    /**
+     * Removes the entries of every shard for which 'pred' returns true.  Returns the number of
+     * entries removed.
+     */
+    size_t removeEntriesIf(stdx::function<bool(const PlanCacheEntry&)> pred);
+
+    std::vector<std::unique_ptr<Shard>> _shards;
 
     // Counter for write notifications since initialization or last clear() invocation.  Starts
     // at 0.
@@ -411,6 +488,13 @@ private:
     // Concurrent access is synchronized by the collection lock.  Multiple concurrent readers
     // are allowed.
     PlanCacheIndexabilityState _indexabilityState;
+
+    // Identifies both this plan cache and the current state of '_indexabilityState', so that a
+    // key remembered by a query is only reused by the cache and index set which computed it.
+    // Taken from a process-wide counter, and so never 0.
+    //
+    // Synchronized like '_indexabilityState'.
+    unsigned long long _keyVersion;
 };
 
 }  // namespace mongo
@@ -85,6 +85,14 @@ const IndexabilityDiscriminators& PlanCacheIndexabilityState::getDiscriminators(
     return it->second;
 }
 
+std::map<std::string, size_t> PlanCacheIndexabilityState::getDiscriminatorCounts() const {
+    std::map<std::string, size_t> counts;
+    for (const auto& pathAndDiscriminators : _pathDiscriminatorsMap) {
+        counts[pathAndDiscriminators.first] = pathAndDiscriminators.second.size();
+    }
+    return counts;
+}
+
 void PlanCacheIndexabilityState::updateDiscriminators(const std::vector<IndexEntry>& indexEntries) {
     _pathDiscriminatorsMap = PathDiscriminatorsMap();
 
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <map>
+#include <string>
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
@@ -63,6 +65,12 @@ public:
      */
     const IndexabilityDiscriminators& getDiscriminators(StringData path) const;
 
+    /**
+     * Returns the number of discriminators registered for each path which has any.  Two states
+     * with the same counts generate the same plan cache keys.
+     */
+    std::map<std::string, size_t> getDiscriminatorCounts() const;
+
     /**
      * Clears discriminators for all paths, and regenerate them from 'indexEntries'.
      */
@@ -206,6 +206,34 @@ TEST(PlanCacheIndexabilityTest, IndexNeitherSparseNorPartial) {
                                            nullptr,
                                            BSONObj())});
     ASSERT(state.getDiscriminators("a").empty());
+    ASSERT(state.getDiscriminatorCounts().empty());
+}
+
+// Test that discriminator counts are reported for every discriminated path.
+TEST(PlanCacheIndexabilityTest, DiscriminatorCounts) {
+    BSONObj filterObj = BSON("a" << BSON("$gt" << 0));
+    std::unique_ptr<MatchExpression> filterExpr(parseMatchExpression(filterObj));
+
+    PlanCacheIndexabilityState state;
+    state.updateDiscriminators({IndexEntry(BSON("a" << 1 << "b" << 1),
+                                           false,  // multikey
+                                           true,   // sparse
+                                           false,  // unique
+                                           "",     // name
+                                           nullptr,
+                                           BSONObj()),
+                                IndexEntry(BSON("c" << 1),
+                                           false,  // multikey
+                                           false,  // sparse
+                                           false,  // unique
+                                           "",     // name
+                                           filterExpr.get(),
+                                           BSONObj())});
+
+    std::map<std::string, size_t> counts = state.getDiscriminatorCounts();
+    ASSERT_EQ(2U, counts.size());
+    ASSERT_EQ(2U, counts["a"]);
+    ASSERT_EQ(1U, counts["b"]);
 }
 
 }  // namespace
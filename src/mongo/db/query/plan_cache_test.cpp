@@ -45,6 +45,7 @@
 #include "mongo/db/query/query_solution.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/memory_budget.h"
 
 using namespace mongo;
 
@@ -388,6 +389,169 @@ TEST(PlanCacheTest, AddValidSolution) {
     ASSERT_EQUALS(planCache.size(), 1U);
 }
 
+// Entries for many shapes end up in different shards of the cache, which must still behave as
+// one cache.
+TEST(PlanCacheTest, AddManyShapes) {
+    PlanCache planCache;
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+
+    const size_t nShapes = 100;
+    std::vector<std::unique_ptr<CanonicalQuery>> queries;
+    for (size_t i = 0; i < nShapes; ++i) {
+        const std::string field = str::stream() << "a" << i;
+        queries.push_back(canonicalize(BSON(field << 1)));
+        ASSERT_OK(planCache.add(*queries.back(), solns, createDecision(1U)));
+    }
+
+    ASSERT_EQUALS(planCache.size(), nShapes);
+    for (const auto& cq : queries) {
+        ASSERT_TRUE(planCache.contains(*cq));
+    }
+
+    std::vector<PlanCacheEntry*> entries = planCache.getAllEntries();
+    ASSERT_EQUALS(entries.size(), nShapes);
+    for (PlanCacheEntry* entry : entries) {
+        delete entry;
+    }
+
+    ASSERT_OK(planCache.remove(*queries[0]));
+    ASSERT_FALSE(planCache.contains(*queries[0]));
+    ASSERT_EQUALS(planCache.size(), nShapes - 1);
+
+    planCache.clear();
+    ASSERT_EQUALS(planCache.size(), 0U);
+    ASSERT_FALSE(planCache.contains(*queries[1]));
+}
+
+// Only the entries with a solution tagged with a dropped index are removed.
+TEST(PlanCacheTest, RemoveEntriesUsingIndex) {
+    PlanCache planCache;
+    IndexEntry indexA(BSON("a" << 1), false, false, false, "a_1", nullptr, BSONObj());
+    IndexEntry indexB(BSON("b" << 1), false, false, false, "b_1", nullptr, BSONObj());
+
+    QuerySolution qsA;
+    qsA.cacheData.reset(new SolutionCacheData());
+    qsA.cacheData->tree.reset(new PlanCacheIndexTree());
+    qsA.cacheData->tree->setIndexEntry(indexA);
+
+    // The index is tagged below the root of this solution's tree.
+    QuerySolution qsB;
+    qsB.cacheData.reset(new SolutionCacheData());
+    qsB.cacheData->tree.reset(new PlanCacheIndexTree());
+    qsB.cacheData->tree->children.push_back(new PlanCacheIndexTree());
+    qsB.cacheData->tree->children.back()->setIndexEntry(indexB);
+
+    unique_ptr<CanonicalQuery> cqA(canonicalize("{a: 1}"));
+    unique_ptr<CanonicalQuery> cqB(canonicalize("{b: 1, c: 1}"));
+    ASSERT_OK(planCache.add(*cqA, {&qsA}, createDecision(1U)));
+    ASSERT_OK(planCache.add(*cqB, {&qsB}, createDecision(1U)));
+
+    ASSERT_EQUALS(planCache.removeEntriesUsingIndex("c_1"), 0U);
+    ASSERT_EQUALS(planCache.size(), 2U);
+
+    ASSERT_EQUALS(planCache.removeEntriesUsingIndex("b_1"), 1U);
+    ASSERT_TRUE(planCache.contains(*cqA));
+    ASSERT_FALSE(planCache.contains(*cqB));
+}
+
+// Only the entries with the leading field of a new index among their predicate or sort fields are
+// removed, unless the index is of a special type.
+TEST(PlanCacheTest, RemoveEntriesIndexableBy) {
+    PlanCache planCache;
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+
+    unique_ptr<CanonicalQuery> cqA(canonicalize("{a: 1}"));
+    unique_ptr<CanonicalQuery> cqB(canonicalize("{b: 1, c: 1}"));
+    unique_ptr<CanonicalQuery> cqSort(canonicalize("{d: 1}", "{c: 1}", "{}"));
+    unique_ptr<CanonicalQuery> cqElemMatch(canonicalize("{e: {$elemMatch: {c: 1}}}"));
+    for (CanonicalQuery* cq : {cqA.get(), cqB.get(), cqSort.get(), cqElemMatch.get()}) {
+        ASSERT_OK(planCache.add(*cq, {&qs}, createDecision(1U)));
+    }
+
+    // Trailing fields of the key pattern don't make an index relevant to a query.
+    ASSERT_EQUALS(planCache.removeEntriesIndexableBy(BSON("x" << 1 << "c" << 1)), 0U);
+    ASSERT_EQUALS(planCache.size(), 4U);
+
+    ASSERT_EQUALS(planCache.removeEntriesIndexableBy(BSON("c" << 1 << "x" << 1)), 2U);
+    ASSERT_TRUE(planCache.contains(*cqA));
+    ASSERT_FALSE(planCache.contains(*cqB));
+    ASSERT_FALSE(planCache.contains(*cqSort));
+    ASSERT_TRUE(planCache.contains(*cqElemMatch));
+
+    ASSERT_EQUALS(planCache.removeEntriesIndexableBy(BSON("e.c" << "hashed")), 1U);
+    ASSERT_TRUE(planCache.contains(*cqA));
+    ASSERT_FALSE(planCache.contains(*cqElemMatch));
+
+    ASSERT_EQUALS(planCache.removeEntriesIndexableBy(BSON("loc" << "2dsphere")), 1U);
+    ASSERT_EQUALS(planCache.size(), 0U);
+}
+
+// Entries whose keys change with the discriminators of a new partial index are removed.
+TEST(PlanCacheTest, NotifyOfIndexEntriesRemovesEntriesWithChangedDiscriminators) {
+    BSONObj filterObj = BSON("f" << BSON("$gt" << 0));
+    unique_ptr<MatchExpression> filterExpr(parseMatchExpression(filterObj));
+
+    PlanCache planCache;
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+
+    unique_ptr<CanonicalQuery> cqF(canonicalize("{f: {$gt: 5}}"));
+    unique_ptr<CanonicalQuery> cqElemMatch(canonicalize("{e: {$elemMatch: {f: 1}}}"));
+    unique_ptr<CanonicalQuery> cqG(canonicalize("{g: 1}"));
+    for (CanonicalQuery* cq : {cqF.get(), cqElemMatch.get(), cqG.get()}) {
+        ASSERT_OK(planCache.add(*cq, {&qs}, createDecision(1U)));
+    }
+
+    planCache.notifyOfIndexEntries({IndexEntry(BSON("a" << 1),
+                                               false,  // multikey
+                                               false,  // sparse
+                                               false,  // unique
+                                               "",     // name
+                                               filterExpr.get(),
+                                               BSONObj())});
+    ASSERT_EQUALS(planCache.size(), 1U);
+    ASSERT_TRUE(planCache.contains(*cqG));
+}
+
+// The plan cache of a collection accounts for its entries in the memory budget, and evicts
+// entries when asked to shrink.
+TEST(PlanCacheTest, ShrinkEvictsEntries) {
+    PlanCache planCache("test.shrink");
+    const int64_t budgetBytesBefore = MemoryBudget::get()->totalBytesUsed();
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+
+    const size_t nShapes = 64;
+    std::vector<std::unique_ptr<CanonicalQuery>> queries;
+    for (size_t i = 0; i < nShapes; ++i) {
+        const std::string field = str::stream() << "a" << i;
+        queries.push_back(canonicalize(BSON(field << 1)));
+        ASSERT_OK(planCache.add(*queries.back(), {&qs}, createDecision(1U)));
+    }
+
+    const int64_t bytesUsed = planCache.bytesUsed();
+    ASSERT_GREATER_THAN(bytesUsed, 0);
+    ASSERT_EQUALS(MemoryBudget::get()->totalBytesUsed() - budgetBytesBefore, bytesUsed);
+
+    const int64_t freed = planCache.shrink(bytesUsed / 2);
+    ASSERT_GREATER_THAN_OR_EQUALS(freed, bytesUsed / 2);
+    ASSERT_LESS_THAN(planCache.size(), nShapes);
+    ASSERT_GREATER_THAN(planCache.size(), 0U);
+    ASSERT_EQUALS(planCache.bytesUsed(), bytesUsed - freed);
+
+    ASSERT_GREATER_THAN_OR_EQUALS(planCache.shrink(bytesUsed), bytesUsed - freed);
+    ASSERT_EQUALS(planCache.size(), 0U);
+    ASSERT_EQUALS(planCache.bytesUsed(), 0);
+}
+
 /**
  * Each test in the CachePlanSelectionTest suite goes through
  * the following flow:
@@ -1201,4 +1365,31 @@ TEST(PlanCacheTest, ComputeKeyPartialIndex) {
     ASSERT_NOT_EQUALS(planCache.computeKey(*cqGtNegativeFive), planCache.computeKey(*cqGtZero));
 }
 
+// A key remembered by a query must not be reused once the indexes have changed, or by another
+// plan cache.
+TEST(PlanCacheTest, ComputeKeyAfterIndexChange) {
+    BSONObj filterObj = BSON("f" << BSON("$gt" << 0));
+    unique_ptr<MatchExpression> filterExpr(parseMatchExpression(filterObj));
+
+    PlanCache planCache;
+    PlanCache otherPlanCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{f: {$gt: 5}}"));
+    const PlanCacheKey keyWithoutIndex = planCache.computeKey(*cq);
+    ASSERT_EQ(keyWithoutIndex, planCache.computeKey(*cq));
+
+    planCache.notifyOfIndexEntries({IndexEntry(BSON("a" << 1),
+                                               false,  // multikey
+                                               false,  // sparse
+                                               false,  // unique
+                                               "",     // name
+                                               filterExpr.get(),
+                                               BSONObj())});
+    const PlanCacheKey keyWithIndex = planCache.computeKey(*cq);
+    ASSERT_NOT_EQUALS(keyWithoutIndex, keyWithIndex);
+    ASSERT_EQ(keyWithIndex, planCache.computeKey(*cq));
+
+    ASSERT_EQ(keyWithoutIndex, otherPlanCache.computeKey(*cq));
+    ASSERT_EQ(keyWithIndex, planCache.computeKey(*cq));
+}
+
 }  // namespace
@@ -68,14 +68,19 @@ bool expressionRequiresIndex(const MatchExpression* node) {
 namespace mongo {
 
 PlanEnumerator::PlanEnumerator(const PlanEnumeratorParams& params)
-    : _root(params.root),
+    : _nodeToId(0,
+                std::hash<MatchExpression*>(),
+                std::equal_to<MatchExpression*>(),
+                NodeToIdMap::allocator_type(params.arena)),
+      _memo(0, std::hash<MemoID>(), std::equal_to<MemoID>(), MemoMap::allocator_type(params.arena)),
+      _root(params.root),
       _indices(params.indices),
+      _arena(params.arena),
       _ixisect(params.intersect),
       _orLimit(params.maxSolutionsPerOr),
       _intersectLimit(params.maxIntersectPerAnd) {}
 
 PlanEnumerator::~PlanEnumerator() {
-    typedef unordered_map<MemoID, NodeAssignment*> MemoMap;
     for (MemoMap::iterator it = _memo.begin(); it != _memo.end(); ++it) {
         delete it->second;
     }
@@ -156,8 +161,15 @@ string PlanEnumerator::NodeAssignment::toString() const {
     }
 }
 
+PlanEnumerator::IndexToPredMap PlanEnumerator::makeIndexToPredMap() const {
+    return IndexToPredMap(0,
+                          std::hash<IndexID>(),
+                          std::equal_to<IndexID>(),
+                          IndexToPredMap::allocator_type(_arena));
+}
+
 PlanEnumerator::MemoID PlanEnumerator::memoIDForNode(MatchExpression* node) {
-    unordered_map<MatchExpression*, MemoID>::iterator it = _nodeToId.find(node);
+    NodeToIdMap::iterator it = _nodeToId.find(node);
 
     if (_nodeToId.end() == it) {
         error() << "Trying to look up memo entry for node, none found.";
@@ -305,8 +317,8 @@ bool PlanEnumerator::prepMemo(MatchExpression* node, PrepMemoContext context) {
         // maps in a known order. Currently when iterating over these maps we have to impose an
         // ordering on each individual pair of indices in order to make sure that the
         // enumeration results are order-independent. See SERVER-12196.
-        IndexToPredMap idxToFirst;
-        IndexToPredMap idxToNotFirst;
+        IndexToPredMap idxToFirst = makeIndexToPredMap();
+        IndexToPredMap idxToNotFirst = makeIndexToPredMap();
 
         // Children that aren't predicates, and which do not necessarily need
         // to use an index.
@@ -36,6 +36,7 @@
 #include "mongo/db/query/index_entry.h"
 #include "mongo/db/query/index_tag.h"
 #include "mongo/db/query/query_knobs.h"
+#include "mongo/util/arena.h"
 
 namespace mongo {
 
@@ -43,7 +44,8 @@ struct PlanEnumeratorParams {
     PlanEnumeratorParams()
         : intersect(false),
           maxSolutionsPerOr(internalQueryEnumerationMaxOrSolutions),
-          maxIntersectPerAnd(internalQueryEnumerationMaxIntersectPerAnd) {}
+          maxIntersectPerAnd(internalQueryEnumerationMaxIntersectPerAnd),
+          arena(nullptr) {}
 
     // Do we provide solutions that use more indices than the minimum required to provide
     // an indexed solution?
@@ -64,6 +66,9 @@ struct PlanEnumeratorParams {
     // all-pairs approach, we could wind up creating a lot of enumeration possibilities for
     // certain inputs.
     size_t maxIntersectPerAnd;
+
+    // Not owned here.  The memo is allocated from this arena if it is not null.
+    Arena* arena;
 };
 
 /**
@@ -362,7 +367,17 @@ private:
     /**
      * Output index intersection assignments inside of an AND node.
      */
-    typedef unordered_map<IndexID, std::vector<MatchExpression*>> IndexToPredMap;
+    typedef unordered_map<IndexID,
+                          std::vector<MatchExpression*>,
+                          std::hash<IndexID>,
+                          std::equal_to<IndexID>,
+                          ArenaAllocator<std::pair<const IndexID, std::vector<MatchExpression*>>>>
+        IndexToPredMap;
+
+    /**
+     * Returns an empty IndexToPredMap allocating from the enumerator's arena.
+     */
+    IndexToPredMap makeIndexToPredMap() const;
 
     /**
      * Generate index intersection assignments given the predicate/index structure in idxToFirst
@@ -415,10 +430,20 @@ private:
     std::string dumpMemo();
 
     // Map from expression to its MemoID.
-    unordered_map<MatchExpression*, MemoID> _nodeToId;
+    typedef unordered_map<MatchExpression*,
+                          MemoID,
+                          std::hash<MatchExpression*>,
+                          std::equal_to<MatchExpression*>,
+                          ArenaAllocator<std::pair<MatchExpression* const, MemoID>>> NodeToIdMap;
+    NodeToIdMap _nodeToId;
 
     // Map from MemoID to its precomputed solution info.
-    unordered_map<MemoID, NodeAssignment*> _memo;
+    typedef unordered_map<MemoID,
+                          NodeAssignment*,
+                          std::hash<MemoID>,
+                          std::equal_to<MemoID>,
+                          ArenaAllocator<std::pair<const MemoID, NodeAssignment*>>> MemoMap;
+    MemoMap _memo;
 
     // If true, there are no further enumeration states, and getNext should return false.
     // We could be _done immediately after init if we're unable to output an indexed plan.
@@ -434,6 +459,9 @@ private:
     // Indices we're allowed to enumerate with.  Not owned here.
     const std::vector<IndexEntry>* _indices;
 
+    // The arena the memo is allocated from, or null for the global allocator.  Not owned here.
+    Arena* _arena;
+
     // Do we output >1 index per AND (index intersection)?
     bool _ixisect;
 
@@ -42,6 +42,7 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/query/plan_yield_policy.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 
@@ -265,6 +266,11 @@ void PlanExecutor::saveState() {
     if (!killed()) {
         _root->saveState();
     }
+
+    // Let the block the working set was copying into be freed with the results already in it,
+    // instead of holding it across the yield or until the next getMore.
+    _workingSet->arena()->releaseBlock();
+
     _currentState = kSaved;
 }
 
@@ -314,6 +320,7 @@ void PlanExecutor::reattachToOperationContext(OperationContext* txn) {
 void PlanExecutor::invalidate(OperationContext* txn, const RecordId& dl, InvalidationType type) {
     if (!killed()) {
         _root->invalidate(txn, dl, type);
+        _rootBatch.invalidate(txn, _workingSet.get(), _collection, dl);
     }
 }
 
@@ -369,7 +376,9 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
         //   2) some stage requested a yield due to a document fetch, or
         //   3) we need to yield and retry due to a WriteConflictException.
         // In all cases, the actual yielding happens here.
-        if (_yieldPolicy->shouldYield()) {
+        //
+        // We don't yield while results of a batch remain.
+        if (_rootBatch.empty() && _yieldPolicy->shouldYield()) {
             if (!_yieldPolicy->yield(fetcher.get())) {
                 // A return of false from a yield should only happen if we've been killed during the
                 // yield.
@@ -390,7 +399,7 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
         fetcher.reset();
 
         WorkingSetID id = WorkingSet::INVALID_ID;
-        PlanStage::StageState code = _root->work(&id);
+        PlanStage::StageState code = workRoot(&id);
 
         if (code != PlanStage::NEED_YIELD)
             writeConflictsInARow = 0;
@@ -476,9 +485,20 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
     }
 }
 
+PlanStage::StageState PlanExecutor::workRoot(WorkingSetID* out) {
+    if (_rootBatch.empty()) {
+        const size_t batchSize = internalQueryExecWorkBatchSize;
+        if (batchSize <= 1 || !_root->supportsWorkBatch()) {
+            return _root->work(out);
+        }
+        _rootBatch.fill(_root.get(), batchSize);
+    }
+    return _rootBatch.next(out);
+}
+
 bool PlanExecutor::isEOF() {
     invariant(_currentState == kUsable);
-    return killed() || (_stash.empty() && _root->isEOF());
+    return killed() || (_stash.empty() && _rootBatch.empty() && _root->isEOF());
 }
 
 void PlanExecutor::registerExec() {
@@ -32,6 +32,7 @@
 #include <queue>
 
 #include "mongo/base/status.h"
+#include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/invalidation_type.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/storage/snapshot.h"
@@ -41,11 +42,9 @@ namespace mongo {
 class BSONObj;
 class Collection;
 class RecordId;
-class PlanStage;
 class PlanExecutor;
 struct PlanStageStats;
 class PlanYieldPolicy;
-class WorkingSet;
 
 /**
  * A PlanExecutor is the abstraction that knows how to crank a tree of stages into execution.
@@ -372,6 +371,12 @@ public:
 private:
     ExecState getNextImpl(Snapshotted<BSONObj>* objOut, RecordId* dlOut);
 
+    /**
+     * Produces the next result of the plan, as _root->work() would. Pulls results from the plan
+     * a batch at a time if the plan supports it and internalQueryExecWorkBatchSize allows.
+     */
+    PlanStage::StageState workRoot(WorkingSetID* out);
+
     /**
      * RAII approach to ensuring that plan executors are deregistered.
      *
@@ -463,6 +468,10 @@ private:
     // stages.
     std::queue<BSONObj> _stash;
 
+    // Results of the last call to _root->workBatch() which have not been handed out yet. Only
+    // used when the whole plan supports batched execution.
+    PlanStage::WorkBatch _rootBatch;
+
     enum { kUsable, kSaved, kDetached } _currentState = kUsable;
 
     bool _everDetachedFromOperationContext = false;
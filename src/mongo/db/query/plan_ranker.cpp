@@ -157,6 +157,7 @@ size_t PlanRanker::pickBestPlan(const vector<CandidatePlan>& candidates, PlanRan
     }
 
     size_t bestChild = scoresAndCandidateindices[0].second;
+    why->winnerCostPerResult = costPerResult(statTrees[bestChild]);
     return bestChild;
 }
 
@@ -260,4 +261,13 @@ double PlanRanker::scoreTree(const PlanStageStats* stats) {
     return score;
 }
 
+// static
+double PlanRanker::costPerResult(const PlanStageStats* stats) {
+    PlanSummaryStats summary;
+    Explain::getSummaryStats(*stats, &summary);
+
+    const double examined = summary.totalKeysExamined + summary.totalDocsExamined;
+    return examined / std::max(size_t(1), summary.nReturned);
+}
+
 }  // namespace mongo
@@ -62,6 +62,12 @@ public:
      * the plan. The exact value isn't meaningful except for imposing a ranking.
      */
     static double scoreTree(const PlanStageStats* stats);
+
+    /**
+     * Returns the number of index keys plus documents examined by the plan for each result it
+     * produced. A plan which produced no results is charged as if it had produced one.
+     */
+    static double costPerResult(const PlanStageStats* stats);
 };
 
 /**
@@ -70,7 +76,7 @@ public:
  */
 struct CandidatePlan {
     CandidatePlan(QuerySolution* s, PlanStage* r, WorkingSet* w)
-        : solution(s), root(r), ws(w), failed(false) {}
+        : solution(s), root(r), ws(w), failed(false), eliminated(false) {}
 
 #if defined(_MSC_VER) && _MSC_VER < 1900  // MVSC++ <= 2013 can't generate default move operations
     CandidatePlan(CandidatePlan&& other)
@@ -78,7 +84,8 @@ struct CandidatePlan {
           root(std::move(other.root)),
           ws(std::move(other.ws)),
           results(std::move(other.results)),
-          failed(std::move(other.failed)) {}
+          failed(std::move(other.failed)),
+          eliminated(std::move(other.eliminated)) {}
 
     CandidatePlan& operator=(CandidatePlan&& other) {
         solution = std::move(other.solution);
@@ -86,6 +93,7 @@ struct CandidatePlan {
         ws = std::move(other.ws);
         results = std::move(other.results);
         failed = std::move(other.failed);
+        eliminated = std::move(other.eliminated);
         return *this;
     }
 #endif
@@ -98,6 +106,10 @@ struct CandidatePlan {
     std::list<WorkingSetID> results;
 
     bool failed;
+
+    // Set if the plan was clearly losing and stopped being worked before the end of the trial
+    // period. It is still ranked with the others.
+    bool eliminated;
 };
 
 /**
@@ -119,6 +131,7 @@ struct PlanRankingDecision {
         }
         decision->scores = scores;
         decision->candidateOrder = candidateOrder;
+        decision->winnerCostPerResult = winnerCostPerResult;
         return decision;
     }
 
@@ -143,6 +156,11 @@ struct PlanRankingDecision {
     // Reading this flag is the only reliable way for callers to determine if there was a tie,
     // because the scores kept inside the PlanRankingDecision do not incorporate the EOF bonus.
     bool tieForBest = false;
+
+    // The cost per result, as computed by PlanRanker::costPerResult(), of the winning plan
+    // during the trial period. The CachedPlanStage compares the cost observed when running the
+    // cached plan against this baseline before deciding to replan. Zero if unknown.
+    double winnerCostPerResult = 0;
 };
 
 }  // namespace mongo
@@ -0,0 +1,108 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_regression_tracker.h"
+
+#include <algorithm>
+
+namespace mongo {
+
+PlanRegressionTracker::PlanRegressionTracker(size_t maxShapes, Milliseconds window)
+    : _maxShapes(maxShapes), _window(window) {}
+
+void PlanRegressionTracker::recordPlan(const PlanCacheKey& key,
+                                       const std::vector<BSONObj>& indexKeyPatterns,
+                                       double costPerResult,
+                                       Date_t now) {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+
+    auto it = _bestPlans.find(key);
+    if (it != _bestPlans.end()) {
+        ObservedPlan& best = it->second;
+        const bool samePlan = best.indexKeyPatterns.size() == indexKeyPatterns.size() &&
+            std::equal(best.indexKeyPatterns.begin(),
+                       best.indexKeyPatterns.end(),
+                       indexKeyPatterns.begin());
+        if (!samePlan && !_isExpired(best, now) && best.costPerResult <= costPerResult) {
+            return;
+        }
+    } else if (_bestPlans.size() >= _maxShapes) {
+        // Make room by dropping the shape least recently observed at its best.
+        if (_maxShapes == 0) {
+            return;
+        }
+        auto oldest = _bestPlans.begin();
+        for (auto candidate = _bestPlans.begin(); candidate != _bestPlans.end(); ++candidate) {
+            if (candidate->second.observedAt < oldest->second.observedAt) {
+                oldest = candidate;
+            }
+        }
+        _bestPlans.erase(oldest);
+    }
+
+    ObservedPlan& plan = _bestPlans[key];
+    plan.indexKeyPatterns.clear();
+    for (const BSONObj& keyPattern : indexKeyPatterns) {
+        plan.indexKeyPatterns.push_back(keyPattern.getOwned());
+    }
+    plan.costPerResult = costPerResult;
+    plan.observedAt = now;
+}
+
+bool PlanRegressionTracker::getBestPlan(const PlanCacheKey& key,
+                                        Date_t now,
+                                        ObservedPlan* planOut) const {
+    invariant(planOut);
+
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    auto it = _bestPlans.find(key);
+    if (it == _bestPlans.end() || _isExpired(it->second, now)) {
+        return false;
+    }
+
+    *planOut = it->second;
+    return true;
+}
+
+void PlanRegressionTracker::clear() {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    _bestPlans.clear();
+}
+
+size_t PlanRegressionTracker::size() const {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    return _bestPlans.size();
+}
+
+bool PlanRegressionTracker::_isExpired(const ObservedPlan& plan, Date_t now) const {
+    return now - plan.observedAt > _window;
+}
+
+}  // namespace mongo
@@ -0,0 +1,106 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/platform/unordered_map.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+/**
+ * Remembers, for each query shape of a collection, the cheapest plan observed within a sliding
+ * window, so that a replan which picks a measurably worse plan can be undone by pinning the
+ * indexes of the earlier one.
+ *
+ * Plans are identified by the key patterns of the indexes they use, and their cost is measured
+ * in keys plus documents examined per result (see PlanRanker::costPerResult()).
+ *
+ * The tracker is thread-safe.
+ */
+class PlanRegressionTracker {
+    MONGO_DISALLOW_COPYING(PlanRegressionTracker);
+
+public:
+    struct ObservedPlan {
+        // The key patterns of the indexes used by the plan, in index name order.
+        std::vector<BSONObj> indexKeyPatterns;
+
+        double costPerResult = 0;
+
+        // When the cost was observed.
+        Date_t observedAt;
+    };
+
+    /**
+     * Tracks at most 'maxShapes' query shapes, observations older than 'window' being replaced by
+     * any newer one.
+     */
+    PlanRegressionTracker(size_t maxShapes, Milliseconds window);
+
+    /**
+     * Records that a plan using the indexes 'indexKeyPatterns' was observed to cost
+     * 'costPerResult' for the query shape 'key' at time 'now'. Kept if it is the cheapest
+     * observation for the shape within the window, or if it is a newer observation of the plan
+     * currently kept, whose cost it replaces.
+     */
+    void recordPlan(const PlanCacheKey& key,
+                    const std::vector<BSONObj>& indexKeyPatterns,
+                    double costPerResult,
+                    Date_t now);
+
+    /**
+     * Fills out 'planOut' and returns true if a plan was observed for 'key' within the window
+     * ending at 'now'.
+     */
+    bool getBestPlan(const PlanCacheKey& key, Date_t now, ObservedPlan* planOut) const;
+
+    /**
+     * Forgets all observations, e.g. because the collection's indexes changed.
+     */
+    void clear();
+
+    size_t size() const;
+
+private:
+    bool _isExpired(const ObservedPlan& plan, Date_t now) const;
+
+    const size_t _maxShapes;
+    const Milliseconds _window;
+
+    // Protects '_bestPlans'.
+    mutable stdx::mutex _mutex;
+    unordered_map<PlanCacheKey, ObservedPlan> _bestPlans;
+};
+
+}  // namespace mongo
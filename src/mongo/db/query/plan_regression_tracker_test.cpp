@@ -0,0 +1,120 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_regression_tracker.h"
+
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+
+const PlanCacheKey kKey("a");
+
+const Date_t kStart = Date_t::fromMillisSinceEpoch(1000 * 1000);
+
+TEST(PlanRegressionTrackerTest, NothingObserved) {
+    PlanRegressionTracker tracker(10, Seconds(60));
+    PlanRegressionTracker::ObservedPlan best;
+    ASSERT_FALSE(tracker.getBestPlan(kKey, kStart, &best));
+    ASSERT_EQUALS(0U, tracker.size());
+}
+
+TEST(PlanRegressionTrackerTest, KeepsCheapestPlan) {
+    PlanRegressionTracker tracker(10, Seconds(60));
+    tracker.recordPlan(kKey, {BSON("a" << 1)}, 5, kStart);
+    tracker.recordPlan(kKey, {BSON("b" << 1)}, 50, kStart + Seconds(1));
+
+    PlanRegressionTracker::ObservedPlan best;
+    ASSERT_TRUE(tracker.getBestPlan(kKey, kStart + Seconds(2), &best));
+    ASSERT_EQUALS(1U, best.indexKeyPatterns.size());
+    ASSERT_EQUALS(BSON("a" << 1), best.indexKeyPatterns[0]);
+    ASSERT_EQUALS(5, best.costPerResult);
+    ASSERT_EQUALS(kStart, best.observedAt);
+
+    // A cheaper plan replaces it.
+    tracker.recordPlan(kKey, {BSON("b" << 1)}, 2, kStart + Seconds(3));
+    ASSERT_TRUE(tracker.getBestPlan(kKey, kStart + Seconds(4), &best));
+    ASSERT_EQUALS(BSON("b" << 1), best.indexKeyPatterns[0]);
+    ASSERT_EQUALS(2, best.costPerResult);
+}
+
+TEST(PlanRegressionTrackerTest, NewerObservationOfSamePlanReplacesCost) {
+    PlanRegressionTracker tracker(10, Seconds(60));
+    tracker.recordPlan(kKey, {BSON("a" << 1)}, 5, kStart);
+    tracker.recordPlan(kKey, {BSON("a" << 1)}, 40, kStart + Seconds(1));
+
+    PlanRegressionTracker::ObservedPlan best;
+    ASSERT_TRUE(tracker.getBestPlan(kKey, kStart + Seconds(2), &best));
+    ASSERT_EQUALS(40, best.costPerResult);
+    ASSERT_EQUALS(kStart + Seconds(1), best.observedAt);
+}
+
+TEST(PlanRegressionTrackerTest, ObservationsExpire) {
+    PlanRegressionTracker tracker(10, Seconds(60));
+    tracker.recordPlan(kKey, {BSON("a" << 1)}, 5, kStart);
+
+    PlanRegressionTracker::ObservedPlan best;
+    ASSERT_TRUE(tracker.getBestPlan(kKey, kStart + Seconds(60), &best));
+    ASSERT_FALSE(tracker.getBestPlan(kKey, kStart + Seconds(61), &best));
+
+    // Once expired, a more expensive plan takes over.
+    tracker.recordPlan(kKey, {BSON("b" << 1)}, 50, kStart + Seconds(61));
+    ASSERT_TRUE(tracker.getBestPlan(kKey, kStart + Seconds(62), &best));
+    ASSERT_EQUALS(BSON("b" << 1), best.indexKeyPatterns[0]);
+}
+
+TEST(PlanRegressionTrackerTest, EvictsOldestShapeWhenFull) {
+    PlanRegressionTracker tracker(2, Seconds(60));
+    tracker.recordPlan("a", {BSON("a" << 1)}, 1, kStart + Seconds(1));
+    tracker.recordPlan("b", {BSON("a" << 1)}, 1, kStart);
+    tracker.recordPlan("c", {BSON("a" << 1)}, 1, kStart + Seconds(2));
+    ASSERT_EQUALS(2U, tracker.size());
+
+    PlanRegressionTracker::ObservedPlan best;
+    ASSERT_TRUE(tracker.getBestPlan("a", kStart + Seconds(3), &best));
+    ASSERT_FALSE(tracker.getBestPlan("b", kStart + Seconds(3), &best));
+    ASSERT_TRUE(tracker.getBestPlan("c", kStart + Seconds(3), &best));
+}
+
+TEST(PlanRegressionTrackerTest, Clear) {
+    PlanRegressionTracker tracker(10, Seconds(60));
+    tracker.recordPlan(kKey, {BSON("a" << 1)}, 5, kStart);
+    tracker.clear();
+
+    PlanRegressionTracker::ObservedPlan best;
+    ASSERT_FALSE(tracker.getBestPlan(kKey, kStart, &best));
+    ASSERT_EQUALS(0U, tracker.size());
+}
+
+}  // namespace
@@ -42,9 +42,11 @@
 #include "mongo/db/query/indexability.h"
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/index_tag.h"
+#include "mongo/db/query/planner_ixselect.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
+#include "mongo/db/storage/record_zone_map.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
 
@@ -104,6 +106,46 @@ bool scansAreEquivalent(const QuerySolutionNode* lhs, const QuerySolutionNode* r
     return *leftIxscan == *rightIxscan;
 }
 
+/**
+ * Adds to 'predicate' the comparisons against top-level fields that every document matching
+ * 'expr' must satisfy, so that a collection scan can skip blocks of records using the
+ * collection's zone map.
+ */
+void addZoneMapComparisons(const MatchExpression* expr, ZoneMapPredicate* predicate) {
+    ZoneMapPredicate::Op op;
+    switch (expr->matchType()) {
+        case MatchExpression::AND:
+            for (size_t i = 0; i < expr->numChildren(); ++i) {
+                addZoneMapComparisons(expr->getChild(i), predicate);
+            }
+            return;
+        case MatchExpression::EQ:
+            op = ZoneMapPredicate::Op::kEQ;
+            break;
+        case MatchExpression::LT:
+            op = ZoneMapPredicate::Op::kLT;
+            break;
+        case MatchExpression::LTE:
+            op = ZoneMapPredicate::Op::kLTE;
+            break;
+        case MatchExpression::GT:
+            op = ZoneMapPredicate::Op::kGT;
+            break;
+        case MatchExpression::GTE:
+            op = ZoneMapPredicate::Op::kGTE;
+            break;
+        default:
+            return;
+    }
+
+    const ComparisonMatchExpression* cmp = static_cast<const ComparisonMatchExpression*>(expr);
+    if (cmp->path().find('.') != std::string::npos ||
+        !ZoneMapPredicate::canUseValue(cmp->getData())) {
+        return;
+    }
+    predicate->addComparison(cmp->path(), op, cmp->getData());
+}
+
 }  // namespace
 
 namespace mongo {
@@ -122,6 +164,15 @@ QuerySolutionNode* QueryPlannerAccess::makeCollectionScan(const CanonicalQuery&
     csn->filter = query.root()->shallowClone();
     csn->tailable = tailable;
     csn->maxScan = query.getParsed().getMaxScan();
+    csn->readahead = query.getParsed().getReadahead();
+
+    if (!tailable) {
+        auto zoneMapPredicate = std::make_shared<ZoneMapPredicate>();
+        addZoneMapComparisons(query.root(), zoneMapPredicate.get());
+        if (!zoneMapPredicate->isEmpty()) {
+            csn->zoneMapPredicate = std::move(zoneMapPredicate);
+        }
+    }
 
     // If the hint is {$natural: +-1} this changes the direction of the collection scan.
     if (!query.getParsed().getHint().isEmpty()) {
@@ -141,6 +192,17 @@ QuerySolutionNode* QueryPlannerAccess::makeCollectionScan(const CanonicalQuery&
         }
     }
 
+    // A parallel scan returns records out of order, so it is only used if the query does not ask
+    // for natural order. $where is evaluated in a JS scope which cannot be shared across threads.
+    const int parallelism =
+        std::min(query.getParsed().getParallelism(), internalQueryExecMaxCollectionScanParallelism);
+    if (parallelism > 1 && !tailable && 0 == csn->maxScan &&
+        query.getParsed().getHint().getFieldDotted("$natural").eoo() &&
+        sortObj.getFieldDotted("$natural").eoo() &&
+        !QueryPlannerCommon::hasNode(query.root(), MatchExpression::WHERE)) {
+        csn->parallelism = parallelism;
+    }
+
     return csn;
 }
 
@@ -1266,6 +1328,71 @@ QuerySolutionNode* QueryPlannerAccess::scanWholeIndex(const IndexEntry& index,
     return solnRoot;
 }
 
+// static
+QuerySolutionNode* QueryPlannerAccess::makeSkipScan(const IndexEntry& index,
+                                                    const CanonicalQuery& query,
+                                                    const QueryPlannerParams& params) {
+    MatchExpression* root = query.root();
+    std::vector<MatchExpression*> preds;
+    if (MatchExpression::AND == root->matchType()) {
+        for (size_t i = 0; i < root->numChildren(); ++i) {
+            preds.push_back(root->getChild(i));
+        }
+    } else {
+        preds.push_back(root);
+    }
+
+    unique_ptr<IndexScanNode> isn = make_unique<IndexScanNode>();
+    isn->indexKeyPattern = index.keyPattern;
+    isn->indexIsMultiKey = index.multikey;
+    isn->maxScan = query.getParsed().getMaxScan();
+    isn->addKeyMetadata = query.getParsed().returnKey();
+    isn->skipScan = true;
+
+    BSONObjIterator kpIt(index.keyPattern);
+    invariant(kpIt.more());
+    isn->bounds.fields.resize(1);
+    IndexBoundsBuilder::allValuesForField(kpIt.next(), &isn->bounds.fields[0]);
+
+    while (kpIt.more()) {
+        const BSONElement elt = kpIt.next();
+        OrderedIntervalList oil;
+        bool bounded = false;
+        for (MatchExpression* pred : preds) {
+            if (!Indexability::nodeCanUseIndexOnOwnField(pred) || pred->path() != elt.fieldName() ||
+                !QueryPlannerIXSelect::compatible(elt, index, pred)) {
+                continue;
+            }
+
+            // The bounds only have to contain the matching keys since the FETCH applies the whole
+            // query. Bounds from several predicates over a multikey field can't be intersected.
+            IndexBoundsBuilder::BoundsTightness tightness;
+            if (!bounded) {
+                IndexBoundsBuilder::translate(pred, elt, index, &oil, &tightness);
+                bounded = true;
+            } else if (!index.multikey) {
+                IndexBoundsBuilder::translateAndIntersect(pred, elt, index, &oil, &tightness);
+            }
+        }
+
+        if (!bounded) {
+            // Nothing to skip by if the second field is unbounded.
+            if (isn->bounds.fields.size() == 1) {
+                return NULL;
+            }
+            IndexBoundsBuilder::allValuesForField(elt, &oil);
+        }
+        isn->bounds.fields.push_back(oil);
+    }
+
+    IndexBoundsBuilder::alignBounds(&isn->bounds, index.keyPattern);
+
+    unique_ptr<FetchNode> fetch = make_unique<FetchNode>();
+    fetch->filter = root->shallowClone();
+    fetch->children.push_back(isn.release());
+    return fetch.release();
+}
+
 // static
 void QueryPlannerAccess::addFilterToSolutionNode(QuerySolutionNode* node,
                                                  MatchExpression* match,
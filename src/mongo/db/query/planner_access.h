@@ -197,6 +197,19 @@ public:
                                              const QueryPlannerParams& params,
                                              int direction = 1);
 
+    /**
+     * Return a plan that skip-scans the provided compound index: its first field is left
+     * unbounded and the remaining fields are bounded by the top-level predicates of the query
+     * over them. The IXSCAN's bounds checker then seeks from one value of the first field to the
+     * next, only reading the keys within the other fields' bounds. The whole query is applied
+     * as a filter after fetching.
+     *
+     * Returns NULL if the query has no predicate that can bound the index's second field.
+     */
+    static QuerySolutionNode* makeSkipScan(const IndexEntry& index,
+                                           const CanonicalQuery& query,
+                                           const QueryPlannerParams& params);
+
     /**
      * Return a plan that scans the provided index from [startKey to endKey).
      */
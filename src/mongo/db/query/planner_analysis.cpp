@@ -34,6 +34,7 @@
 #include <vector>
 
 #include "mongo/db/jsobj.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/index/expression_params.h"
 #include "mongo/db/index/s2_common.h"
 #include "mongo/db/matcher/expression_geo.h"
@@ -67,6 +68,47 @@ void getLeafNodes(QuerySolutionNode* root, vector<QuerySolutionNode*>* leafNodes
     }
 }
 
+/**
+ * Returns true if a blocking sort with a limit can run over the unfetched 'solnRoot', taking its
+ * sort keys from the index keys, so that only the documents which make it into the top results
+ * have to be fetched.
+ */
+bool canSortBeforeFetch(const CanonicalQuery& query,
+                        const QueryPlannerParams& params,
+                        QuerySolutionNode* solnRoot) {
+    const LiteParsedQuery& lpq = query.getParsed();
+    if (solnRoot->fetched() || lpq.allowDiskUse()) {
+        return false;
+    }
+
+    if (!lpq.getLimit() && !lpq.getNToReturn()) {
+        return false;
+    }
+
+    // Flagged results are merged in below the sort stage, and must have their documents.
+    if (params.options & QueryPlannerParams::KEEP_MUTATIONS) {
+        return false;
+    }
+
+    vector<QuerySolutionNode*> leafNodes;
+    getLeafNodes(solnRoot, &leafNodes);
+    if (1 != leafNodes.size() || STAGE_IXSCAN != leafNodes[0]->getType()) {
+        return false;
+    }
+
+    // The index scan only covers fields of a btree index that isn't multikey, so each document
+    // has a single key to sort by.
+    BSONObjIterator it(lpq.getSort());
+    while (it.more()) {
+        BSONElement elt = it.next();
+        if (!elt.isNumber() || !leafNodes[0]->hasField(elt.fieldName())) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 /**
  * Returns true if every interval in 'oil' is a point, false otherwise.
  */
@@ -281,6 +323,113 @@ void geoSkipValidationOn(const std::set<StringData>& twoDSphereFields,
     }
 }
 
+/**
+ * Returns true if some key can be within both 'lhs' and 'rhs'.
+ */
+bool intervalsIntersect(const Interval& lhs, const Interval& rhs) {
+    // Intervals over descending fields run from high to low.
+    Interval lhsAscending = lhs;
+    if (lhsAscending.start.woCompare(lhsAscending.end, false) > 0) {
+        lhsAscending.reverse();
+    }
+    Interval rhsAscending = rhs;
+    if (rhsAscending.start.woCompare(rhsAscending.end, false) > 0) {
+        rhsAscending.reverse();
+    }
+    return lhsAscending.intersects(rhsAscending);
+}
+
+/**
+ * Returns true if no key can be within both 'lhs' and 'rhs', which are bounds over the same
+ * index. That is the case when the bounds don't overlap over at least one field.
+ */
+bool boundsDisjoint(const IndexBounds& lhs, const IndexBounds& rhs) {
+    if (lhs.isSimpleRange || rhs.isSimpleRange || lhs.fields.size() != rhs.fields.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < lhs.fields.size(); ++i) {
+        bool overlap = false;
+        for (const Interval& lhsInterval : lhs.fields[i].intervals) {
+            for (const Interval& rhsInterval : rhs.fields[i].intervals) {
+                if (intervalsIntersect(lhsInterval, rhsInterval)) {
+                    overlap = true;
+                    break;
+                }
+            }
+            if (overlap) {
+                break;
+            }
+        }
+
+        if (!overlap) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Returns true if no two children of the OR or MERGE_SORT 'node' can output the same RecordId.
+ * This holds when each child is a scan, possibly fetched and filtered, of the same btree index
+ * that isn't multikey, over bounds which are disjoint from those of every other child. Each
+ * document then has one key in the index, which only one of the scans can reach.
+ */
+bool childrenDisjoint(const QuerySolutionNode* node) {
+    vector<const IndexScanNode*> scans;
+    for (const QuerySolutionNode* child : node->children) {
+        if (STAGE_FETCH == child->getType()) {
+            child = child->children[0];
+        }
+        if (STAGE_IXSCAN != child->getType()) {
+            return false;
+        }
+
+        const IndexScanNode* isn = static_cast<const IndexScanNode*>(child);
+        if (isn->indexIsMultiKey ||
+            IndexNames::BTREE != IndexNames::findPluginName(isn->indexKeyPattern)) {
+            return false;
+        }
+        if (!scans.empty() && scans[0]->indexKeyPattern != isn->indexKeyPattern) {
+            return false;
+        }
+        scans.push_back(isn);
+    }
+
+    for (size_t i = 0; i < scans.size(); ++i) {
+        for (size_t j = i + 1; j < scans.size(); ++j) {
+            if (!boundsDisjoint(scans[i]->bounds, scans[j]->bounds)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Turns off deduplication for each OR and MERGE_SORT in the tree 'root' whose children can't
+ * output the same RecordId, so that those stages don't have to remember what they've returned.
+ */
+void skipDedupOfDisjointChildren(QuerySolutionNode* root) {
+    for (QuerySolutionNode* child : root->children) {
+        skipDedupOfDisjointChildren(child);
+    }
+
+    if (STAGE_OR == root->getType()) {
+        OrNode* orn = static_cast<OrNode*>(root);
+        if (orn->dedup && childrenDisjoint(orn)) {
+            orn->dedup = false;
+        }
+    } else if (STAGE_SORT_MERGE == root->getType()) {
+        MergeSortNode* msn = static_cast<MergeSortNode*>(root);
+        if (msn->dedup && childrenDisjoint(msn)) {
+            msn->dedup = false;
+        }
+    }
+}
+
 }  // namespace
 
 // static
@@ -421,6 +570,18 @@ bool QueryPlannerAnalysis::explodeForSort(const CanonicalQuery& query,
 
     // Too many ixscans spoil the performance.
     if (totalNumScans > (size_t)internalQueryMaxScansToExplode) {
+        // A lone index scan can still provide the sort without a merge sort stage or a blocking
+        // sort, by merging the scans of its point prefixes itself.
+        if (STAGE_IXSCAN == toReplace->getType() &&
+            totalNumScans <= (size_t)internalQueryMaxPointScansToMerge) {
+            IndexScanNode* isn = static_cast<IndexScanNode*>(toReplace);
+            isn->mergedPrefixFields = fieldsToExplode[0];
+            (*solnRoot)->computeProperties();
+            LOG(5) << "Merging " << totalNumScans << " point scans within ixscan to pull out sort"
+                   << " order. Result: " << (*solnRoot)->toString();
+            return true;
+        }
+
         LOG(5) << "Could expand ixscans to pull out sort order but resulting scan count"
                << "(" << totalNumScans << ") is too high.";
         return false;
@@ -501,14 +662,16 @@ QuerySolutionNode* QueryPlannerAnalysis::analyzeSort(const CanonicalQuery& query
         return NULL;
     }
 
-    // Add a fetch stage so we have the full object when we hit the sort stage.  TODO: Can we
-    // pull the values that we sort by out of the key and if so in what cases?  Perhaps we can
-    // avoid a fetch.
-    if (!solnRoot->fetched()) {
+    // Add a fetch stage so we have the full object when we hit the sort stage, unless the sort
+    // keys can come out of the index keys. A top-K sort then discards the documents which don't
+    // make the cut before they are fetched.
+    const bool fetchAfterSort = canSortBeforeFetch(query, params, solnRoot);
+    if (!fetchAfterSort && !solnRoot->fetched()) {
         FetchNode* fetch = new FetchNode();
         fetch->children.push_back(solnRoot);
         solnRoot = fetch;
     }
+    QuerySolutionNode* sortChild = solnRoot;
 
     // And build the full sort stage. The sort stage has to have a sort key generating stage
     // as its child, supplying it with the appropriate sort keys.
@@ -520,6 +683,7 @@ QuerySolutionNode* QueryPlannerAnalysis::analyzeSort(const CanonicalQuery& query
 
     SortNode* sort = new SortNode();
     sort->pattern = sortObj;
+    sort->allowDiskUse = lpq.allowDiskUse();
     sort->children.push_back(solnRoot);
     solnRoot = sort;
     // When setting the limit on the sort, we need to consider both
@@ -579,6 +743,19 @@ QuerySolutionNode* QueryPlannerAnalysis::analyzeSort(const CanonicalQuery& query
         sort->limit = 0;
     }
 
+    // A text search sorted only by the text score keeps just the top results of the TEXT stage,
+    // which can then stop reading the text index once no other document can make the cut.
+    if (sort->limit && STAGE_TEXT == sortChild->getType() && 1 == sortObj.nFields() &&
+        LiteParsedQuery::isTextScoreMeta(sortObj.firstElement())) {
+        static_cast<TextNode*>(sortChild)->limit = sort->limit;
+    }
+
+    if (fetchAfterSort) {
+        FetchNode* fetch = new FetchNode();
+        fetch->children.push_back(solnRoot);
+        solnRoot = fetch;
+    }
+
     *blockingSortOut = true;
 
     return solnRoot;
@@ -636,6 +813,9 @@ QuerySolution* QueryPlannerAnalysis::analyzeDataAccess(const CanonicalQuery& que
         return NULL;
     }
 
+    // Done after analyzeSort, which may explode an index scan into a merge of disjoint scans.
+    skipDedupOfDisjointChildren(solnRoot);
+
     // A solution can be blocking if it has a blocking sort stage or
     // a hashed AND stage.
     bool hasAndHashStage = hasNode(solnRoot, STAGE_AND_HASH);
@@ -705,10 +885,15 @@ QuerySolution* QueryPlannerAnalysis::analyzeDataAccess(const CanonicalQuery& que
             }
         } else if (!query.getProj()->wantIndexKey()) {
             // The only way we're here is if it's a simple projection.  That is, we can pick out
-            // the fields we want to include and they're not dotted.  So we want to execute the
-            // projection in the fast-path simple fashion.  Just don't know which fast path yet.
+            // the fields we want to include.  So we want to execute the projection in the
+            // fast-path simple fashion.  Just don't know which fast path yet.  The SIMPLE_DOC fast
+            // path only looks at top-level fields, so if there are dotted fields we fall back to
+            // the default implementation whenever we have the full document.
             LOG(5) << "PROJECTION: requires fields\n";
             const vector<string>& fields = query.getProj()->getRequiredFields();
+            const ProjectionNode::ProjectionType fetchedProjType =
+                query.getProj()->hasDottedField() ? ProjectionNode::DEFAULT
+                                                  : ProjectionNode::SIMPLE_DOC;
             bool covered = true;
             for (size_t i = 0; i < fields.size(); ++i) {
                 if (!solnRoot->hasField(fields[i])) {
@@ -729,12 +914,12 @@ QuerySolution* QueryPlannerAnalysis::analyzeDataAccess(const CanonicalQuery& que
 
                 // It's simple but we'll have the full document and we should just iterate
                 // over that.
-                projType = ProjectionNode::SIMPLE_DOC;
+                projType = fetchedProjType;
                 LOG(5) << "PROJECTION: not covered, fetching.";
             } else {
                 if (solnRoot->fetched()) {
                     // Fetched implies hasObj() so let's run with that.
-                    projType = ProjectionNode::SIMPLE_DOC;
+                    projType = fetchedProjType;
                     LOG(5) << "PROJECTION: covered via FETCH, using SIMPLE_DOC fast path";
                 } else {
                     // If we're here we're not fetched so we're covered.  Let's see if we can
@@ -758,6 +943,16 @@ QuerySolution* QueryPlannerAnalysis::analyzeDataAccess(const CanonicalQuery& que
                             LOG(5) << "PROJECTION: covered via DISTINCT, using COVERED fast path";
                         }
                     }
+
+                    // Only the COVERED fast path knows how to nest the values of dotted fields
+                    // in its output, so otherwise we need the documents after all.
+                    if (ProjectionNode::COVERED_ONE_INDEX != projType &&
+                        query.getProj()->hasDottedField()) {
+                        FetchNode* fetch = new FetchNode();
+                        fetch->children.push_back(solnRoot);
+                        solnRoot = fetch;
+                        LOG(5) << "PROJECTION: dotted fields not covered by one index, fetching.";
+                    }
                 }
             }
         }
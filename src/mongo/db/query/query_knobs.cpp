@@ -38,12 +38,26 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationCollFraction, double, 0
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationMaxResults, int, 101);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationMaxMillis, int, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationMaxTotalWorks, int, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationEliminationRatio, double, 0.0);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheSize, int, 5000);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheFeedbacksStored, int, 20);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheEvictionRatio, double, 10.0);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheCostRegressionRatio, double, 2.0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryAutoPinRegressionRatio, double, 0.0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryAutoPinWindowSecs, int, 3600);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryCachePersistIntervalSecs, int, 0);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerMaxIndexedSolutions, int, 64);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryEnumerationMaxOrSolutions, int, 10);
@@ -56,14 +70,38 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerEnableIndexIntersection, bool,
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerEnableHashIntersection, bool, false);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerMaxSkipScanPrefixValues, int, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerHistogramPruningRatio, double, 10.0);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanOrChildrenIndependently, bool, true);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQuerySubplanPlanningThreads, int, 1);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryMaxScansToExplode, int, 200);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryMaxPointScansToMerge, int, 20000);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecMaxBlockingSortBytes, int, 32 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecAndHashUseRecordIdBitmaps, bool, false);
+
 // Yield every 128 cycles or 10ms.
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldIterations, int, 128);
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldPeriodMS, int, 10);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecWorkBatchSize, int, 64);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecMaxCollectionScanParallelism, int, 4);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecFetchBatchSize, int, 1);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecWriteBatchSize, int, 1);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryGetMorePrefetchBytes, int, 0);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupThreads, int, 1);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceCursorPrefetch, bool, false);
+
 }  // namespace mongo
@@ -45,6 +45,17 @@ extern double internalQueryPlanEvaluationCollFraction;
 // Stop working plans once a plan returns this many results.
 extern int internalQueryPlanEvaluationMaxResults;
 
+// Stop working plans once the trial period has taken this many milliseconds. 0 means no limit.
+extern int internalQueryPlanEvaluationMaxMillis;
+
+// Stop working plans once this many work() calls have been made over all of the candidates.
+// 0 means no limit.
+extern int internalQueryPlanEvaluationMaxTotalWorks;
+
+// Stop working a plan during the trial period if it produces results at less than 1 / this ratio
+// of the rate of the most productive plan. 0 disables early elimination.
+extern double internalQueryPlanEvaluationEliminationRatio;
+
 // Do we give a big ranking bonus to intersection plans?
 extern bool internalQueryForceIntersectionPlans;
 
@@ -54,6 +65,15 @@ extern bool internalQueryPlannerEnableIndexIntersection;
 // Do we use hash-based intersection for rooted $and queries?
 extern bool internalQueryPlannerEnableHashIntersection;
 
+// A compound index whose first field the query doesn't constrain is skip-scanned if its first
+// field has at most this many distinct values. 0 disables skip-scans.
+extern int internalQueryPlannerMaxSkipScanPrefixValues;
+
+// Candidate plans whose index histograms estimate that they examine more than this many times
+// the keys of the cheapest estimated candidate are dropped before the trial period. 0 disables
+// pruning.
+extern double internalQueryPlannerHistogramPruningRatio;
+
 //
 // plan cache
 //
@@ -69,6 +89,24 @@ extern int internalQueryCacheFeedbacksStored;
 // and replanning?
 extern double internalQueryCacheEvictionRatio;
 
+// Once a cached plan has used up its works budget, how many times more keys and documents per
+// result than it examined when it was cached must it be examining before we replan? Zero
+// replans based on the works budget alone.
+extern double internalQueryCacheCostRegressionRatio;
+
+// When a cached plan is replanned, how many times more keys and documents per result than the
+// best plan observed for the query shape must the new winner examine before we pin the indexes
+// of the best plan for the shape? Zero disables automatic pinning.
+extern double internalQueryAutoPinRegressionRatio;
+
+// For how many seconds does an observed plan remain a query shape's best plan for the purposes of
+// automatic pinning?
+extern int internalQueryAutoPinWindowSecs;
+
+// How often, in seconds, are plan cache entries persisted to local.plancache so that a restarted
+// node can warm its plan caches? Zero disables persistence.
+extern int internalQueryCachePersistIntervalSecs;
+
 //
 // Planning and enumeration.
 //
@@ -85,20 +123,66 @@ extern int internalQueryEnumerationMaxIntersectPerAnd;
 // Do we want to plan each child of the OR independently?
 extern bool internalQueryPlanOrChildrenIndependently;
 
+// How many threads may enumerate the plans for the children of a rooted $or at once? A value of 1
+// or less enumerates them one after another in the thread running the query.
+extern int internalQuerySubplanPlanningThreads;
+
 // How many index scans are we willing to produce in order to obtain a sort order
 // during explodeForSort?
 extern int internalQueryMaxScansToExplode;
 
+// When exploding a lone index scan would take more scans than internalQueryMaxScansToExplode, how
+// many combinations of points are we willing to have the scan merge itself, using its one index
+// cursor, in order to obtain the sort order anyway? A value of 0 disables the merging.
+extern int internalQueryMaxPointScansToMerge;
+
 //
 // Query execution.
 //
 
 extern int internalQueryExecMaxBlockingSortBytes;
 
+// Should AND_HASH intersect RecordId bitmaps of its children from the start, rather than only
+// once its hash table outgrows the memory limit?
+extern bool internalQueryExecAndHashUseRecordIdBitmaps;
+
 // Yield after this many "should yield?" checks.
 extern int internalQueryExecYieldIterations;
 
 // Yield if it's been at least this many milliseconds since we last yielded.
 extern int internalQueryExecYieldPeriodMS;
 
+// How many units of work to pull from a plan at a time when all of its stages support batched
+// execution. A value of 1 or less disables batching.
+extern int internalQueryExecWorkBatchSize;
+
+// The most threads a single collection scan may be split across when a find asks for
+// 'parallelism'. A value of 1 or less disables parallel collection scans.
+extern int internalQueryExecMaxCollectionScanParallelism;
+
+// How many of its child's results FETCH looks up together, in RecordId order. A value of 1 or
+// less looks each one up as soon as the child returns it.
+extern int internalQueryExecFetchBatchSize;
+
+// How many documents a multi-update or multi-delete modifies in one WriteUnitOfWork, on storage
+// engines with document-level locking. A value of 1 or less modifies each in its own.
+extern int internalQueryExecWriteBatchSize;
+
+// How many bytes of results does a helper thread load from a cursor once a getMore has returned,
+// ready for the next getMore? Only used on storage engines with document-level locking. 0 disables
+// prefetching.
+extern int internalQueryGetMorePrefetchBytes;
+
+//
+// Aggregation.
+//
+
+// How many threads may a $group spread the grouping of its input across? A value of 1 or less
+// groups the input in the thread running the pipeline.
+extern int internalDocumentSourceGroupThreads;
+
+// Should a $cursor stage load its next batch on a helper thread while the rest of the pipeline
+// works through the current one? Only used on storage engines with document-level locking.
+extern bool internalDocumentSourceCursorPrefetch;
+
 }  // namespace mongo
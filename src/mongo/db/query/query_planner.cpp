@@ -44,6 +44,7 @@
 #include "mongo/db/query/planner_analysis.h"
 #include "mongo/db/query/planner_ixselect.h"
 #include "mongo/db/query/plan_enumerator.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/util/log.h"
@@ -731,11 +732,14 @@ Status QueryPlanner::plan(const CanonicalQuery& query,
 
     // If we have any relevant indices, we try to create indexed plans.
     if (0 < relevantIndices.size()) {
-        // The enumerator spits out trees tagged with IndexTag(s).
+        // The enumerator spits out trees tagged with IndexTag(s).  Its memo goes back to the
+        // arena once it is done, so that replanning in the same operation reuses the memory.
+        ArenaScope arenaScope(params.arena);
         PlanEnumeratorParams enumParams;
         enumParams.intersect = params.options & QueryPlannerParams::INDEX_INTERSECTION;
         enumParams.root = query.root();
         enumParams.indices = &relevantIndices;
+        enumParams.arena = params.arena;
 
         PlanEnumerator isp(enumParams);
         isp.init();
@@ -812,6 +816,40 @@ Status QueryPlanner::plan(const CanonicalQuery& query,
         return Status::OK();
     }
 
+    // A compound index whose first field the query doesn't constrain can still be used for the
+    // predicates over its other fields by skip-scanning it, as long as there are few enough
+    // distinct values of the first field to seek past.
+    if (!QueryPlannerCommon::hasNode(query.root(), MatchExpression::GEO_NEAR) &&
+        !QueryPlannerCommon::hasNode(query.root(), MatchExpression::TEXT)) {
+        for (size_t i = 0; i < params.indices.size(); ++i) {
+            const IndexEntry& index = params.indices[i];
+            if (index.distinctPrefixValues < 0 ||
+                index.distinctPrefixValues > internalQueryPlannerMaxSkipScanPrefixValues) {
+                continue;
+            }
+            if (index.type != INDEX_BTREE || index.sparse || index.keyPattern.nFields() < 2) {
+                continue;
+            }
+            if (fields.count(index.keyPattern.firstElementFieldName())) {
+                // Planned above as an ordinary index scan.
+                continue;
+            }
+            if (index.filterExpr && !expression::isSubsetOf(query.root(), index.filterExpr)) {
+                continue;
+            }
+
+            QuerySolutionNode* solnRoot = QueryPlannerAccess::makeSkipScan(index, query, params);
+            if (NULL == solnRoot) {
+                continue;
+            }
+            QuerySolution* soln = QueryPlannerAnalysis::analyzeDataAccess(query, params, solnRoot);
+            if (NULL != soln) {
+                LOG(5) << "Planner: outputting soln that skip-scans index " << index.name << endl;
+                out->push_back(soln);
+            }
+        }
+    }
+
     // If a sort order is requested, there may be an index that provides it, even if that
     // index is not over any predicates in the query.
     //
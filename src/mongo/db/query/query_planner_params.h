@@ -33,6 +33,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/index_entry.h"
 #include "mongo/db/query/query_knobs.h"
+#include "mongo/util/arena.h"
 
 namespace mongo {
 
@@ -40,7 +41,8 @@ struct QueryPlannerParams {
     QueryPlannerParams()
         : options(DEFAULT),
           indexFiltersApplied(false),
-          maxIndexedSolutions(internalQueryPlannerMaxIndexedSolutions) {}
+          maxIndexedSolutions(internalQueryPlannerMaxIndexedSolutions),
+          arena(nullptr) {}
 
     enum Options {
         // You probably want to set this.
@@ -116,6 +118,11 @@ struct QueryPlannerParams {
     // plans via the MultiPlanStage, and the set of possible plans is very large for certain
     // index+query combinations.
     size_t maxIndexedSolutions;
+
+    // Not owned here.  The arena of the operation to allocate the planner's scratch structures
+    // from, or null to use the global allocator.  Stages which replan from saved params refresh
+    // it, as it is only valid for the operation which filled the params out.
+    Arena* arena;
 };
 
 }  // namespace mongo
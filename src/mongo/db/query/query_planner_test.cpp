@@ -34,6 +34,7 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/json.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_test_fixture.h"
 
@@ -1289,7 +1290,27 @@ TEST_F(QueryPlannerTest, DottedFieldCovering) {
         "{proj: {spec: {_id: 0, 'a.b': 1}, node: "
         "{cscan: {dir: 1, filter: {'a.b': 5}}}}}");
     // SERVER-2104
-    // assertSolutionExists("{proj: {spec: {_id: 0, 'a.b': 1}, node: {'a.b': 1}}}");
+    assertSolutionExists(
+        "{proj: {spec: {_id: 0, 'a.b': 1}, type: 'coveredIndex', node: "
+        "{ixscan: {filter: null, pattern: {'a.b': 1}}}}}");
+}
+
+TEST_F(QueryPlannerTest, DottedFieldsCoveredByOneIndexOnly) {
+    addIndex(BSON("a.b" << 1 << "c" << 1));
+    addIndex(BSON("d" << 1 << "a.b" << 1));
+    runQuerySortProj(fromjson("{$or: [{'a.b': 5}, {d: 6}]}"),
+                     BSONObj(),
+                     fromjson("{_id: 0, 'a.b': 1}"));
+
+    // The covered projection of an OR of index scans can't nest 'a.b', so it fetches.
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{proj: {spec: {_id: 0, 'a.b': 1}, node: "
+        "{cscan: {dir: 1}}}}");
+    assertSolutionExists(
+        "{proj: {spec: {_id: 0, 'a.b': 1}, type: 'default', node: {fetch: {node: "
+        "{or: {nodes: [{ixscan: {pattern: {'a.b': 1, c: 1}}},"
+        "{ixscan: {pattern: {d: 1, 'a.b': 1}}}]}}}}}}");
 }
 
 TEST_F(QueryPlannerTest, IdCovering) {
@@ -1708,6 +1729,9 @@ TEST_F(QueryPlannerTest, ManyInWithSort) {
 
 // SERVER-1205
 TEST_F(QueryPlannerTest, TooManyToExplode) {
+    const int oldMaxPointScansToMerge = internalQueryMaxPointScansToMerge;
+    internalQueryMaxPointScansToMerge = 0;
+
     addIndex(BSON("a" << 1 << "b" << 1 << "c" << 1 << "d" << 1));
     runQuerySortProjSkipLimit(fromjson(
                                   "{a: {$in: [1,2,3,4,5,6]},"
@@ -1717,15 +1741,115 @@ TEST_F(QueryPlannerTest, TooManyToExplode) {
                               BSONObj(),
                               0,
                               1);
+    internalQueryMaxPointScansToMerge = oldMaxPointScansToMerge;
 
-    // We cap the # of ixscans we're willing to create.
+    // We cap the # of ixscans we're willing to create. The sort key is in the index, so the
+    // top-K sort goes below the fetch.
     assertNumSolutions(2);
     assertSolutionExists(
         "{sort: {pattern: {d: 1}, limit: 1, node: {sortKeyGen: "
         "{node: {cscan: {dir: 1}}}}}}");
     assertSolutionExists(
-        "{sort: {pattern: {d: 1}, limit: 1, node: {sortKeyGen: {node: "
-        "{fetch: {node: {ixscan: {pattern: {a: 1, b: 1, c:1, d:1}}}}}}}}}");
+        "{fetch: {filter: null, node: {sort: {pattern: {d: 1}, limit: 1, node: {sortKeyGen: "
+        "{node: {ixscan: {pattern: {a: 1, b: 1, c:1, d:1}}}}}}}}}");
+}
+
+TEST_F(QueryPlannerTest, TooManyToExplodeMergesPointScans) {
+    addIndex(BSON("a" << 1 << "b" << 1 << "c" << 1 << "d" << 1));
+    runQuerySortProjSkipLimit(fromjson(
+                                  "{a: {$in: [1,2,3,4,5,6]},"
+                                  "b:{$in:[1,2,3,4,5,6,7,8]},"
+                                  "c:{$in:[1,2,3,4,5,6,7,8]}}"),
+                              BSON("d" << -1),
+                              BSONObj(),
+                              0,
+                              1);
+
+    // Rather than explode into more ixscans than we allow, the ixscan merges its 384 point
+    // scans itself, walking them backwards to provide the sort.
+    assertNumSolutions(2);
+    assertSolutionExists(
+        "{sort: {pattern: {d: -1}, limit: 1, node: {sortKeyGen: "
+        "{node: {cscan: {dir: 1}}}}}}");
+    assertSolutionExists(
+        "{fetch: {filter: null, node: "
+        "{ixscan: {pattern: {a: 1, b: 1, c:1, d:1}, dir: -1, mergedPrefixFields: 3}}}}");
+}
+
+TEST_F(QueryPlannerTest, TooManyToMergePointScans) {
+    const int oldMaxPointScansToMerge = internalQueryMaxPointScansToMerge;
+    internalQueryMaxPointScansToMerge = 300;
+
+    addIndex(BSON("a" << 1 << "b" << 1 << "c" << 1 << "d" << 1));
+    runQuerySortProj(fromjson(
+                         "{a: {$in: [1,2,3,4,5,6]},"
+                         "b:{$in:[1,2,3,4,5,6,7,8]},"
+                         "c:{$in:[1,2,3,4,5,6,7,8]}}"),
+                     BSON("d" << 1),
+                     BSONObj());
+    internalQueryMaxPointScansToMerge = oldMaxPointScansToMerge;
+
+    assertNumSolutions(2);
+    assertSolutionExists(
+        "{sort: {pattern: {d: 1}, limit: 0, node: {sortKeyGen: "
+        "{node: {cscan: {dir: 1}}}}}}");
+    assertSolutionExists(
+        "{sort: {pattern: {d: 1}, limit: 0, node: {sortKeyGen: {node: {fetch: {filter: null, "
+        "node: {ixscan: {pattern: {a: 1, b: 1, c:1, d:1}, mergedPrefixFields: 0}}}}}}}}");
+}
+
+TEST_F(QueryPlannerTest, SortLimitBeforeFetchWhenSortKeyIsInIndex) {
+    addIndex(BSON("a" << 1 << "b" << 1));
+    runQuerySortProjSkipLimit(fromjson("{a: {$gt: 1}}"), BSON("b" << -1), BSONObj(), 0, -20);
+
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{sort: {pattern: {b: -1}, limit: 20, node: {sortKeyGen: "
+        "{node: {cscan: {dir: 1}}}}}}");
+    assertSolutionExists(
+        "{fetch: {filter: null, node: {sort: {pattern: {b: -1}, limit: 20, node: {sortKeyGen: "
+        "{node: {ixscan: {pattern: {a: 1, b: 1}}}}}}}}}");
+}
+
+TEST_F(QueryPlannerTest, NoSortBeforeFetchWithoutLimit) {
+    addIndex(BSON("a" << 1 << "b" << 1));
+    runQuerySortProj(fromjson("{a: {$gt: 1}}"), BSON("b" << -1), BSONObj());
+
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{sort: {pattern: {b: -1}, limit: 0, node: {sortKeyGen: {node: "
+        "{fetch: {filter: null, node: {ixscan: {pattern: {a: 1, b: 1}}}}}}}}}");
+}
+
+TEST_F(QueryPlannerTest, NoSortBeforeFetchWhenSortKeyIsNotInIndex) {
+    addIndex(BSON("a" << 1));
+    runQuerySortProjSkipLimit(fromjson("{a: {$gt: 1}}"), BSON("b" << -1), BSONObj(), 0, -20);
+
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{sort: {pattern: {b: -1}, limit: 20, node: {sortKeyGen: {node: "
+        "{fetch: {filter: null, node: {ixscan: {pattern: {a: 1}}}}}}}}}");
+}
+
+TEST_F(QueryPlannerTest, NoSortBeforeFetchWithMultikeyIndex) {
+    // true means multikey
+    addIndex(BSON("a" << 1 << "b" << 1), true);
+    runQuerySortProjSkipLimit(fromjson("{a: {$gt: 1}}"), BSON("b" << -1), BSONObj(), 0, -20);
+
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{sort: {pattern: {b: -1}, limit: 20, node: {sortKeyGen: {node: "
+        "{fetch: {filter: null, node: {ixscan: {pattern: {a: 1, b: 1}}}}}}}}}");
+}
+
+TEST_F(QueryPlannerTest, NoSortBeforeFetchWithResidualFilter) {
+    addIndex(BSON("a" << 1 << "b" << 1));
+    runQuerySortProjSkipLimit(fromjson("{a: {$gt: 1}, c: 1}"), BSON("b" << -1), BSONObj(), 0, -20);
+
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{sort: {pattern: {b: -1}, limit: 20, node: {sortKeyGen: {node: "
+        "{fetch: {filter: {c: 1}, node: {ixscan: {pattern: {a: 1, b: 1}}}}}}}}}");
 }
 
 TEST_F(QueryPlannerTest, CantExplodeMetaSort) {
@@ -1899,6 +2023,56 @@ TEST_F(QueryPlannerTest, CantExplodeOrForSort2) {
         "{a: [[6,10,false,false]]}}}]}}}}}}}}");
 }
 
+TEST_F(QueryPlannerTest, NoDedupForOrOfDisjointScans) {
+    addIndex(BSON("a" << 1));
+    runQuery(fromjson("{$or: [{a: {$gt: 1, $lt: 3}}, {a: {$gt: 6, $lt: 10}}]}"));
+
+    assertSolutionExists(
+        "{fetch: {filter: null, node: {or: {dedup: false, nodes: ["
+        "{ixscan: {pattern: {a: 1}, bounds: {a: [[1,3,false,false]]}}},"
+        "{ixscan: {pattern: {a: 1}, bounds: {a: [[6,10,false,false]]}}}]}}}}");
+}
+
+TEST_F(QueryPlannerTest, DedupForOrOfOverlappingScans) {
+    addIndex(BSON("a" << 1));
+    runQuery(fromjson("{$or: [{a: {$gt: 1, $lt: 7}}, {a: {$gt: 6, $lt: 10}}]}"));
+
+    assertSolutionExists(
+        "{fetch: {filter: null, node: {or: {dedup: true, nodes: ["
+        "{ixscan: {pattern: {a: 1}, bounds: {a: [[1,7,false,false]]}}},"
+        "{ixscan: {pattern: {a: 1}, bounds: {a: [[6,10,false,false]]}}}]}}}}");
+}
+
+TEST_F(QueryPlannerTest, DedupForOrOfDisjointScansOverMultikeyIndex) {
+    // true means multikey
+    addIndex(BSON("a" << 1), true);
+    runQuery(fromjson("{$or: [{a: {$gt: 1, $lt: 3}}, {a: {$gt: 6, $lt: 10}}]}"));
+
+    assertSolutionExists(
+        "{fetch: {filter: null, node: {or: {dedup: true, nodes: ["
+        "{ixscan: {pattern: {a: 1}, bounds: {a: [[1,3,false,false]]}}},"
+        "{ixscan: {pattern: {a: 1}, bounds: {a: [[6,10,false,false]]}}}]}}}}");
+}
+
+TEST_F(QueryPlannerTest, DedupForOrOfScansOverDifferentIndexes) {
+    addIndex(BSON("a" << 1));
+    addIndex(BSON("b" << 1));
+    runQuery(fromjson("{$or: [{a: 1}, {b: 1}]}"));
+
+    assertSolutionExists(
+        "{fetch: {filter: null, node: {or: {dedup: true, nodes: ["
+        "{ixscan: {pattern: {a: 1}}}, {ixscan: {pattern: {b: 1}}}]}}}}");
+}
+
+TEST_F(QueryPlannerTest, NoDedupForExplodedMergeSort) {
+    addIndex(BSON("a" << 1 << "b" << 1));
+    runQuerySortProj(fromjson("{a: {$in: [1, 2]}}"), BSON("b" << 1), BSONObj());
+
+    assertSolutionExists(
+        "{fetch: {node: {mergeSort: {dedup: false, nodes: "
+        "[{ixscan: {pattern: {a: 1, b: 1}}}, {ixscan: {pattern: {a: 1, b: 1}}}]}}}}");
+}
+
 // SERVER-13754: too many scans in an $or explosion.
 TEST_F(QueryPlannerTest, TooManyToExplodeOr) {
     addIndex(BSON("a" << 1 << "e" << 1));
@@ -3631,9 +3805,7 @@ TEST_F(QueryPlannerTest, ShardFilterCompoundProjCovered) {
         "{ixscan: {pattern: {a: 1, b: 1}}}}}}}");
 }
 
-TEST_F(QueryPlannerTest, ShardFilterNestedProjNotCovered) {
-    // Nested projections can't be covered currently, though the shard key filter shouldn't need
-    // to fetch.
+TEST_F(QueryPlannerTest, ShardFilterNestedProjCovered) {
     params.options = QueryPlannerParams::INCLUDE_SHARD_FILTER;
     params.shardKey = BSON("a" << 1 << "b.c" << 1);
     addIndex(BSON("a" << 1 << "b.c" << 1));
@@ -3642,10 +3814,9 @@ TEST_F(QueryPlannerTest, ShardFilterNestedProjNotCovered) {
 
     assertNumSolutions(1U);
     assertSolutionExists(
-        "{proj: {spec: {_id: 0, a: 1, 'b.c': 1 }, type: 'default', node: "
-        "{fetch: {node: "
+        "{proj: {spec: {_id: 0, a: 1, 'b.c': 1 }, type: 'coveredIndex', node: "
         "{sharding_filter: {node: "
-        "{ixscan: {pattern: {a: 1, 'b.c': 1}}}}}}}}}");
+        "{ixscan: {pattern: {a: 1, 'b.c': 1}}}}}}}");
 }
 
 TEST_F(QueryPlannerTest, ShardFilterHashProjNotCovered) {
@@ -4032,4 +4203,90 @@ TEST_F(QueryPlannerTest, NToReturnHackWithSingleBatch) {
         "{cscan: {dir:1, filter: {}}}}}}}");
 }
 
+//
+// Skip-scans
+//
+
+class QueryPlannerSkipScanTest : public QueryPlannerTest {
+protected:
+    void setUp() final {
+        QueryPlannerTest::setUp();
+        _oldMaxPrefixValues = internalQueryPlannerMaxSkipScanPrefixValues;
+        internalQueryPlannerMaxSkipScanPrefixValues = 10;
+    }
+
+    void tearDown() final {
+        internalQueryPlannerMaxSkipScanPrefixValues = _oldMaxPrefixValues;
+    }
+
+    void addIndexWithPrefixValues(BSONObj keyPattern, long long distinctPrefixValues) {
+        addIndex(keyPattern);
+        params.indices.back().distinctPrefixValues = distinctPrefixValues;
+    }
+
+private:
+    int _oldMaxPrefixValues;
+};
+
+TEST_F(QueryPlannerSkipScanTest, SkipScansUnconstrainedPrefix) {
+    addIndexWithPrefixValues(BSON("a" << 1 << "b" << 1), 5);
+
+    runQuery(fromjson("{b: {$gte: 3, $lt: 7}}"));
+
+    assertNumSolutions(1U);
+    assertSolutionExists(
+        "{fetch: {filter: {b: {$gte: 3, $lt: 7}}, node: {ixscan: {pattern: {a: 1, b: 1}, "
+        "bounds: {a: [['MinKey','MaxKey',true,true]], b: [[3,7,true,false]]}}}}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, SkipScanBoundsLaterFields) {
+    addIndexWithPrefixValues(BSON("a" << 1 << "b" << -1 << "c" << 1), 5);
+
+    runQuery(fromjson("{b: 4, c: {$gt: 2}, d: 1}"));
+
+    assertNumSolutions(1U);
+    assertSolutionExists(
+        "{fetch: {filter: {b: 4, c: {$gt: 2}, d: 1}, node: {ixscan: {pattern: {a: 1, b: -1, c: 1}, "
+        "bounds: {a: [['MinKey','MaxKey',true,true]], b: [[4,4,true,true]], "
+        "c: [[2,Infinity,false,true]]}}}}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, NoSkipScanWithTooManyPrefixValues) {
+    addIndexWithPrefixValues(BSON("a" << 1 << "b" << 1), 11);
+
+    runQuery(fromjson("{b: 5}"));
+
+    assertNumSolutions(1U);
+    assertSolutionExists("{cscan: {dir: 1, filter: {b: 5}}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, NoSkipScanWhenPrefixValuesUnknown) {
+    addIndex(BSON("a" << 1 << "b" << 1));
+
+    runQuery(fromjson("{b: 5}"));
+
+    assertNumSolutions(1U);
+    assertSolutionExists("{cscan: {dir: 1, filter: {b: 5}}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, NoSkipScanWithoutPredicateOnSecondField) {
+    addIndexWithPrefixValues(BSON("a" << 1 << "b" << 1 << "c" << 1), 5);
+
+    runQuery(fromjson("{c: 5}"));
+
+    assertNumSolutions(1U);
+    assertSolutionExists("{cscan: {dir: 1, filter: {c: 5}}}");
+}
+
+TEST_F(QueryPlannerSkipScanTest, NoSkipScanWhenPrefixIsConstrained) {
+    addIndexWithPrefixValues(BSON("a" << 1 << "b" << 1), 5);
+
+    runQuery(fromjson("{a: 1, b: 5}"));
+
+    assertNumSolutions(1U);
+    assertSolutionExists(
+        "{fetch: {filter: null, node: {ixscan: {pattern: {a: 1, b: 1}, "
+        "bounds: {a: [[1,1,true,true]], b: [[5,5,true,true]]}}}}}");
+}
+
 }  // namespace
@@ -48,6 +48,7 @@ const NamespaceString QueryPlannerTest::nss("test.collection");
 void QueryPlannerTest::setUp() {
     internalQueryPlannerEnableHashIntersection = true;
     params.options = QueryPlannerParams::INCLUDE_COLLSCAN;
+    params.arena = &arena;
     addIndex(BSON("_id" << 1));
 }
 
@@ -193,6 +193,9 @@ protected:
 
     BSONObj queryObj;
     std::unique_ptr<CanonicalQuery> cq;
+
+    // The planner allocates from it as it would from the arena of an operation.
+    Arena arena;
     QueryPlannerParams params;
     OwnedPointerVector<QuerySolution> solns;
 };
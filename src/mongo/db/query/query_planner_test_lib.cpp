@@ -261,6 +261,14 @@ bool QueryPlannerTestLib::solutionMatches(const BSONObj& testSoln,
             }
         }
 
+        BSONElement mergedPrefixFields = ixscanObj["mergedPrefixFields"];
+        if (!mergedPrefixFields.eoo()) {
+            if (!mergedPrefixFields.isNumber() ||
+                static_cast<size_t>(mergedPrefixFields.numberLong()) != ixn->mergedPrefixFields) {
+                return false;
+            }
+        }
+
         BSONElement filter = ixscanObj["filter"];
         if (filter.eoo()) {
             return true;
@@ -334,6 +342,14 @@ bool QueryPlannerTestLib::solutionMatches(const BSONObj& testSoln,
             }
         }
 
+        BSONElement limitElt = textObj["limit"];
+        if (!limitElt.eoo()) {
+            if (!limitElt.isNumber() ||
+                limitElt.numberLong() != static_cast<long long>(node->limit)) {
+                return false;
+            }
+        }
+
         BSONElement filter = textObj["filter"];
         if (!filter.eoo()) {
             if (filter.isNull()) {
@@ -387,6 +403,12 @@ bool QueryPlannerTestLib::solutionMatches(const BSONObj& testSoln,
             return false;
         }
         BSONObj orObj = el.Obj();
+
+        BSONElement dedup = orObj["dedup"];
+        if (!dedup.eoo() && (!dedup.isBoolean() || dedup.Bool() != orn->dedup)) {
+            return false;
+        }
+
         return childrenMatch(orObj, orn);
     } else if (STAGE_AND_HASH == trueSoln->getType()) {
         const AndHashNode* ahn = static_cast<const AndHashNode*>(trueSoln);
@@ -507,6 +529,12 @@ bool QueryPlannerTestLib::solutionMatches(const BSONObj& testSoln,
             return false;
         }
         BSONObj mergeSortObj = el.Obj();
+
+        BSONElement dedup = mergeSortObj["dedup"];
+        if (!dedup.eoo() && (!dedup.isBoolean() || dedup.Bool() != msn->dedup)) {
+            return false;
+        }
+
         return childrenMatch(mergeSortObj, msn);
     } else if (STAGE_SKIP == trueSoln->getType()) {
         const SkipNode* sn = static_cast<const SkipNode*>(trueSoln);
@@ -428,4 +428,40 @@ TEST_F(QueryPlannerTest, SortKeyMetaProjectionWithTextScoreMetaSort) {
         "{sortKeyGen: {node: {text: {search: 'foo'}}}}}}}}");
 }
 
+TEST_F(QueryPlannerTest, TextScoreSortWithLimitPushesLimitToText) {
+    addIndex(BSON("_fts"
+                  << "text"
+                  << "_ftsx" << 1));
+
+    runQuerySortProjSkipLimit(fromjson("{$text: {$search: 'foo'}}"),
+                              fromjson("{a: {$meta: 'textScore'}}"),
+                              fromjson("{a: {$meta: 'textScore'}}"),
+                              3,
+                              10);
+
+    assertNumSolutions(1U);
+    assertSolutionExists(
+        "{skip: {n: 3, node: {proj: {spec: {a: {$meta: 'textScore'}}, node: "
+        "{sort: {limit: 13, pattern: {a: {$meta: 'textScore'}}, node: "
+        "{sortKeyGen: {node: {text: {search: 'foo', limit: 13}}}}}}}}}}");
+}
+
+TEST_F(QueryPlannerTest, CompoundSortWithLimitDoesNotPushLimitToText) {
+    addIndex(BSON("_fts"
+                  << "text"
+                  << "_ftsx" << 1));
+
+    runQuerySortProjSkipLimit(fromjson("{$text: {$search: 'foo'}}"),
+                              fromjson("{a: {$meta: 'textScore'}, b: 1}"),
+                              fromjson("{a: {$meta: 'textScore'}}"),
+                              0,
+                              10);
+
+    assertNumSolutions(1U);
+    assertSolutionExists(
+        "{proj: {spec: {a: {$meta: 'textScore'}}, node: "
+        "{sort: {limit: 10, pattern: {a: {$meta: 'textScore'}, b: 1}, node: "
+        "{sortKeyGen: {node: {text: {search: 'foo', limit: 0}}}}}}}}");
+}
+
 }  // namespace
@@ -70,6 +70,7 @@ AllowedIndexEntry::~AllowedIndexEntry() {}
 
 AllowedIndexEntry* AllowedIndexEntry::clone() const {
     AllowedIndexEntry* entry = new AllowedIndexEntry(query, sort, projection, indexKeyPatterns);
+    entry->autoPinned = autoPinned;
     return entry;
 }
 
@@ -135,6 +136,27 @@ void QuerySettings::setAllowedIndices(const CanonicalQuery& canonicalQuery,
     _allowedIndexEntryMap[key] = entry;
 }
 
+bool QuerySettings::setAutoPinnedIndices(const CanonicalQuery& canonicalQuery,
+                                         const PlanCacheKey& key,
+                                         const std::vector<BSONObj>& indexes) {
+    const LiteParsedQuery& lpq = canonicalQuery.getParsed();
+    std::unique_ptr<AllowedIndexEntry> entry(
+        new AllowedIndexEntry(lpq.getFilter(), lpq.getSort(), lpq.getProj(), indexes));
+    entry->autoPinned = true;
+
+    stdx::lock_guard<stdx::mutex> cacheLock(_mutex);
+    AllowedIndexEntryMap::iterator i = _allowedIndexEntryMap.find(key);
+    if (i != _allowedIndexEntryMap.end()) {
+        // Index filters set by the user take precedence over automatic pins.
+        if (!i->second->autoPinned) {
+            return false;
+        }
+        delete i->second;
+    }
+    _allowedIndexEntryMap[key] = entry.release();
+    return true;
+}
+
 void QuerySettings::removeAllowedIndices(const PlanCacheKey& key) {
     stdx::lock_guard<stdx::mutex> cacheLock(_mutex);
     AllowedIndexEntryMap::iterator i = _allowedIndexEntryMap.find(key);
@@ -150,11 +172,39 @@ void QuerySettings::removeAllowedIndices(const PlanCacheKey& key) {
     delete entry;
 }
 
+bool QuerySettings::removeAutoPinnedIndices(const PlanCacheKey& key) {
+    stdx::lock_guard<stdx::mutex> cacheLock(_mutex);
+    AllowedIndexEntryMap::iterator i = _allowedIndexEntryMap.find(key);
+    if (i == _allowedIndexEntryMap.end() || !i->second->autoPinned) {
+        return false;
+    }
+
+    AllowedIndexEntry* entry = i->second;
+    _allowedIndexEntryMap.erase(i);
+    delete entry;
+    return true;
+}
+
 void QuerySettings::clearAllowedIndices() {
     stdx::lock_guard<stdx::mutex> cacheLock(_mutex);
     _clear();
 }
 
+std::vector<AllowedIndexEntry*> QuerySettings::clearAutoPinnedIndices() {
+    stdx::lock_guard<stdx::mutex> cacheLock(_mutex);
+    vector<AllowedIndexEntry*> removed;
+    for (AllowedIndexEntryMap::iterator i = _allowedIndexEntryMap.begin();
+         i != _allowedIndexEntryMap.end();) {
+        if (!i->second->autoPinned) {
+            ++i;
+            continue;
+        }
+        removed.push_back(i->second);
+        i = _allowedIndexEntryMap.erase(i);
+    }
+    return removed;
+}
+
 void QuerySettings::_clear() {
     for (AllowedIndexEntryMap::const_iterator i = _allowedIndexEntryMap.begin();
          i != _allowedIndexEntryMap.end();
@@ -86,6 +86,10 @@ public:
     // we will use to override the indexes retrieved from
     // the index catalog.
     std::vector<BSONObj> indexKeyPatterns;
+
+    // True if the server pinned these indexes itself after the query shape was replanned to a
+    // worse plan, rather than an index filter command setting them.
+    bool autoPinned = false;
 };
 
 /**
@@ -123,16 +127,37 @@ public:
                            const PlanCacheKey& key,
                            const std::vector<BSONObj>& indexes);
 
+    /**
+     * Adds an automatically pinned entry to query settings, replacing an earlier automatic pin
+     * for the same key. Never replaces an index filter set by a command.
+     * Returns true if the entry was added.
+     */
+    bool setAutoPinnedIndices(const CanonicalQuery& canonicalQuery,
+                              const PlanCacheKey& key,
+                              const std::vector<BSONObj>& indexes);
+
     /**
      * Removes single entry from query settings. No effect if query shape is not found.
      */
     void removeAllowedIndices(const PlanCacheKey& canonicalQuery);
 
+    /**
+     * Removes the entry for the key if it was automatically pinned.
+     * Returns true if an entry was removed.
+     */
+    bool removeAutoPinnedIndices(const PlanCacheKey& key);
+
     /**
      * Clears all allowed indices from query settings.
      */
     void clearAllowedIndices();
 
+    /**
+     * Clears the automatically pinned entries from query settings, keeping the ones set by
+     * commands. Returns the removed entries. Caller owns them.
+     */
+    std::vector<AllowedIndexEntry*> clearAutoPinnedIndices();
+
 private:
     /**
      * Clears entries without acquiring mutex.
@@ -82,6 +82,10 @@ void TextNode::appendToString(mongoutils::str::stream* ss, int indent) const {
     *ss << "diacriticSensitive= " << diacriticSensitive << '\n';
     addIndent(ss, indent + 1);
     *ss << "indexPrefix = " << indexPrefix.toString() << '\n';
+    if (limit) {
+        addIndent(ss, indent + 1);
+        *ss << "limit = " << limit << '\n';
+    }
     if (NULL != filter) {
         addIndent(ss, indent + 1);
         *ss << " filter = " << filter->toString();
@@ -100,6 +104,7 @@ QuerySolutionNode* TextNode::clone() const {
     copy->caseSensitive = this->caseSensitive;
     copy->diacriticSensitive = this->diacriticSensitive;
     copy->indexPrefix = this->indexPrefix;
+    copy->limit = this->limit;
 
     return copy;
 }
@@ -108,7 +113,8 @@ QuerySolutionNode* TextNode::clone() const {
 // CollectionScanNode
 //
 
-CollectionScanNode::CollectionScanNode() : tailable(false), direction(1), maxScan(0) {}
+CollectionScanNode::CollectionScanNode()
+    : tailable(false), direction(1), maxScan(0), parallelism(1) {}
 
 void CollectionScanNode::appendToString(mongoutils::str::stream* ss, int indent) const {
     addIndent(ss, indent);
@@ -119,6 +125,18 @@ void CollectionScanNode::appendToString(mongoutils::str::stream* ss, int indent)
         addIndent(ss, indent + 1);
         *ss << "filter = " << filter->toString();
     }
+    if (zoneMapPredicate) {
+        addIndent(ss, indent + 1);
+        *ss << "zoneMapPredicate = " << zoneMapPredicate->toString() << '\n';
+    }
+    if (readahead) {
+        addIndent(ss, indent + 1);
+        *ss << "readahead = " << *readahead << '\n';
+    }
+    if (parallelism > 1) {
+        addIndent(ss, indent + 1);
+        *ss << "parallelism = " << parallelism << '\n';
+    }
     addCommon(ss, indent);
 }
 
@@ -131,6 +149,9 @@ QuerySolutionNode* CollectionScanNode::clone() const {
     copy->tailable = this->tailable;
     copy->direction = this->direction;
     copy->maxScan = this->maxScan;
+    copy->parallelism = this->parallelism;
+    copy->readahead = this->readahead;
+    copy->zoneMapPredicate = this->zoneMapPredicate;
 
     return copy;
 }
@@ -254,6 +275,10 @@ void OrNode::appendToString(mongoutils::str::stream* ss, int indent) const {
         addIndent(ss, indent + 1);
         *ss << " filter = " << filter->toString() << '\n';
     }
+    if (!dedup) {
+        addIndent(ss, indent + 1);
+        *ss << "dedup = false\n";
+    }
     addCommon(ss, indent);
     for (size_t i = 0; i < children.size(); ++i) {
         addIndent(ss, indent + 1);
@@ -314,6 +339,10 @@ void MergeSortNode::appendToString(mongoutils::str::stream* ss, int indent) cons
         addIndent(ss, indent + 1);
         *ss << " filter = " << filter->toString() << '\n';
     }
+    if (!dedup) {
+        addIndent(ss, indent + 1);
+        *ss << "dedup = false\n";
+    }
     addCommon(ss, indent);
     for (size_t i = 0; i < children.size(); ++i) {
         addIndent(ss, indent + 1);
@@ -396,7 +425,12 @@ QuerySolutionNode* FetchNode::clone() const {
 //
 
 IndexScanNode::IndexScanNode()
-    : indexIsMultiKey(false), direction(1), maxScan(0), addKeyMetadata(false) {}
+    : indexIsMultiKey(false),
+      direction(1),
+      maxScan(0),
+      addKeyMetadata(false),
+      skipScan(false),
+      mergedPrefixFields(0) {}
 
 void IndexScanNode::appendToString(mongoutils::str::stream* ss, int indent) const {
     addIndent(ss, indent);
@@ -409,6 +443,14 @@ void IndexScanNode::appendToString(mongoutils::str::stream* ss, int indent) cons
     }
     addIndent(ss, indent + 1);
     *ss << "direction = " << direction << '\n';
+    if (skipScan) {
+        addIndent(ss, indent + 1);
+        *ss << "skipScan = true\n";
+    }
+    if (mergedPrefixFields > 0) {
+        addIndent(ss, indent + 1);
+        *ss << "mergedPrefixFields = " << mergedPrefixFields << '\n';
+    }
     addIndent(ss, indent + 1);
     *ss << "bounds = " << bounds.toString() << '\n';
     addCommon(ss, indent);
@@ -441,6 +483,11 @@ bool IndexScanNode::sortedByDiskLoc() const {
     // Therefore, if we're only examining one index key, the output is sorted
     // by RecordId.
 
+    // Merging the scans of several keys loses that order.
+    if (mergedPrefixFields > 0) {
+        return false;
+    }
+
     // If it's a simple range query, it's easy to determine if the range is a point.
     if (bounds.isSimpleRange) {
         return 0 == bounds.startKey.woCompare(bounds.endKey, indexKeyPattern);
@@ -469,6 +516,30 @@ void IndexScanNode::computeProperties() {
         sortPattern = QueryPlannerCommon::reverseSortObj(sortPattern);
     }
 
+    if (mergedPrefixFields > 0) {
+        // The scan merges its scans of each combination of points of the prefix fields, so it's
+        // sorted only by the rest of the key pattern and its prefixes.
+        BSONObjIterator suffixIt(sortPattern);
+        for (size_t i = 0; i < mergedPrefixFields && suffixIt.more(); ++i) {
+            suffixIt.next();
+        }
+        BSONObjBuilder suffixBob;
+        while (suffixIt.more()) {
+            suffixBob.append(suffixIt.next());
+        }
+        BSONObj suffixPattern = suffixBob.obj();
+        for (int i = 0; i < suffixPattern.nFields(); ++i) {
+            // Make obj out of fields [0,i]
+            BSONObjIterator it(suffixPattern);
+            BSONObjBuilder prefixBob;
+            for (int j = 0; j <= i; ++j) {
+                prefixBob.append(it.next());
+            }
+            _sorts.insert(prefixBob.obj());
+        }
+        return;
+    }
+
     _sorts.insert(sortPattern);
 
     const int nFields = sortPattern.nFields();
@@ -576,6 +647,8 @@ QuerySolutionNode* IndexScanNode::clone() const {
     copy->direction = this->direction;
     copy->maxScan = this->maxScan;
     copy->addKeyMetadata = this->addKeyMetadata;
+    copy->skipScan = this->skipScan;
+    copy->mergedPrefixFields = this->mergedPrefixFields;
     copy->bounds = this->bounds;
 
     return copy;
@@ -599,7 +672,8 @@ bool IndexScanNode::operator==(const IndexScanNode& other) const {
     return filtersAreEquivalent(filter.get(), other.filter.get()) &&
         indexKeyPattern == other.indexKeyPattern && indexIsMultiKey == other.indexIsMultiKey &&
         direction == other.direction && maxScan == other.maxScan &&
-        addKeyMetadata == other.addKeyMetadata && bounds == other.bounds;
+        addKeyMetadata == other.addKeyMetadata && skipScan == other.skipScan &&
+        mergedPrefixFields == other.mergedPrefixFields && bounds == other.bounds;
 }
 
 //
@@ -676,6 +750,10 @@ void SortNode::appendToString(mongoutils::str::stream* ss, int indent) const {
     *ss << "pattern = " << pattern.toString() << '\n';
     addIndent(ss, indent + 1);
     *ss << "limit = " << limit << '\n';
+    if (allowDiskUse) {
+        addIndent(ss, indent + 1);
+        *ss << "allowDiskUse = true\n";
+    }
     addCommon(ss, indent);
     addIndent(ss, indent + 1);
     *ss << "Child:" << '\n';
@@ -689,6 +767,7 @@ QuerySolutionNode* SortNode::clone() const {
     copy->_sorts = this->_sorts;
     copy->pattern = this->pattern;
     copy->limit = this->limit;
+    copy->allowDiskUse = this->allowDiskUse;
 
     return copy;
 }
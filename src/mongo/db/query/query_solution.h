@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <memory>
 
 #include "mongo/db/jsobj.h"
@@ -36,6 +37,7 @@
 #include "mongo/db/query/index_bounds.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/stage_types.h"
+#include "mongo/db/storage/record_zone_map.h"
 
 namespace mongo {
 
@@ -256,6 +258,10 @@ struct TextNode : public QuerySolutionNode {
     // text node while creating the text leaf node and convert them into a BSONObj index prefix
     // when we finish the text leaf node.
     BSONObj indexPrefix;
+
+    // If nonzero, the text node is below a sort on the text score that keeps this many results,
+    // so it only has to produce the 'limit' highest scoring documents.
+    size_t limit = 0;
 };
 
 struct CollectionScanNode : public QuerySolutionNode {
@@ -295,6 +301,16 @@ struct CollectionScanNode : public QuerySolutionNode {
 
     // maxScan option to .find() limits how many docs we look at.
     int maxScan;
+
+    // readahead option to .find(); see CollectionScanParams::readahead.
+    boost::optional<int> readahead;
+
+    // How many threads the scan may be split across; see CollectionScanParams::parallelism.
+    size_t parallelism;
+
+    // Comparisons implied by 'filter' that the collection's zone map can use to skip blocks of
+    // records. Null if there are none.
+    std::shared_ptr<const ZoneMapPredicate> zoneMapPredicate;
 };
 
 struct AndHashNode : public QuerySolutionNode {
@@ -475,6 +491,16 @@ struct IndexScanNode : public QuerySolutionNode {
     // If there's a 'returnKey' projection we add key metadata.
     bool addKeyMetadata;
 
+    // True if the bounds leave the first field of the index unconstrained so as to skip-scan it
+    // using the bounds on its other fields. Only affects explain: the bounds checker does the
+    // skipping on its own.
+    bool skipScan;
+
+    // If nonzero, the first 'mergedPrefixFields' fields of the bounds are unions of points and
+    // the scan merges its scans of each combination of those points, so that its output is
+    // sorted by the remaining fields of the key pattern rather than by the whole of it.
+    size_t mergedPrefixFields;
+
     // BIG NOTE:
     // If you use simple bounds, we'll use whatever index access method the keypattern implies.
     // If you use the complex bounds, we force Btree access.
@@ -597,7 +623,7 @@ struct SortKeyGeneratorNode : public QuerySolutionNode {
 };
 
 struct SortNode : public QuerySolutionNode {
-    SortNode() : limit(0) {}
+    SortNode() : limit(0), allowDiskUse(false) {}
     virtual ~SortNode() {}
 
     virtual StageType getType() const {
@@ -636,6 +662,9 @@ struct SortNode : public QuerySolutionNode {
 
     // Sum of both limit and skip count in the parsed query.
     size_t limit;
+
+    // Whether the sort may spill to disk once it exceeds its memory limit.
+    bool allowDiskUse;
 };
 
 struct LimitNode : public QuerySolutionNode {
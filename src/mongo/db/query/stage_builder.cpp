@@ -54,6 +54,7 @@
 #include "mongo/db/index/fts_access_method.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
+#include "mongo/db/s/collection_metadata.h"
 #include "mongo/db/s/sharding_state.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
@@ -63,6 +64,80 @@ namespace mongo {
 using std::unique_ptr;
 using stdx::make_unique;
 
+namespace {
+
+/**
+ * If 'node' only returns documents found by an index scan on an index which starts with the
+ * fields of 'shardKeyPattern', fills 'min' and 'max' with the lowest and highest shard keys the
+ * bounds of the scan let through and returns true.
+ */
+bool getShardKeyBounds(const QuerySolutionNode* node,
+                       const BSONObj& shardKeyPattern,
+                       BSONObj* min,
+                       BSONObj* max) {
+    if (STAGE_FETCH == node->getType()) {
+        node = node->children[0];
+    }
+
+    if (STAGE_IXSCAN != node->getType()) {
+        return false;
+    }
+
+    const IndexScanNode* ixn = static_cast<const IndexScanNode*>(node);
+    if (ixn->bounds.isSimpleRange ||
+        ixn->bounds.fields.size() < static_cast<size_t>(shardKeyPattern.nFields())) {
+        return false;
+    }
+
+    BSONObjBuilder minBuilder;
+    BSONObjBuilder maxBuilder;
+    BSONObjIterator shardKeyIt(shardKeyPattern);
+    BSONObjIterator indexIt(ixn->indexKeyPattern);
+    for (size_t i = 0; shardKeyIt.more(); i++) {
+        const BSONElement shardKeyElt = shardKeyIt.next();
+        const BSONElement indexElt = indexIt.next();
+
+        // The index must hold the values of the shard key, hashed ones for a hashed shard key
+        if (shardKeyElt.fieldNameStringData() != indexElt.fieldNameStringData()) {
+            return false;
+        }
+        if (shardKeyElt.type() == String
+                ? indexElt.type() != String ||
+                    shardKeyElt.valueStringData() != indexElt.valueStringData()
+                : !indexElt.isNumber()) {
+            return false;
+        }
+
+        // Intervals are in the order of the scan, so look at all of them for the extremes
+        const std::vector<Interval>& intervals = ixn->bounds.fields[i].intervals;
+        if (intervals.empty()) {
+            return false;
+        }
+
+        BSONElement low = intervals.front().start;
+        BSONElement high = intervals.front().start;
+        for (const Interval& interval : intervals) {
+            for (const BSONElement& bound : {interval.start, interval.end}) {
+                if (bound.woCompare(low, false) < 0) {
+                    low = bound;
+                }
+                if (bound.woCompare(high, false) > 0) {
+                    high = bound;
+                }
+            }
+        }
+
+        minBuilder.appendAs(low, shardKeyElt.fieldName());
+        maxBuilder.appendAs(high, shardKeyElt.fieldName());
+    }
+
+    *min = minBuilder.obj();
+    *max = maxBuilder.obj();
+    return true;
+}
+
+}  // namespace
+
 PlanStage* buildStages(OperationContext* txn,
                        Collection* collection,
                        const QuerySolution& qsol,
@@ -76,6 +151,9 @@ PlanStage* buildStages(OperationContext* txn,
         params.direction =
             (csn->direction == 1) ? CollectionScanParams::FORWARD : CollectionScanParams::BACKWARD;
         params.maxScan = csn->maxScan;
+        params.readahead = csn->readahead;
+        params.parallelism = csn->parallelism;
+        params.zoneMapPredicate = csn->zoneMapPredicate;
         return new CollectionScan(txn, params, ws, csn->filter.get());
     } else if (STAGE_IXSCAN == root->getType()) {
         const IndexScanNode* ixn = static_cast<const IndexScanNode*>(root);
@@ -99,6 +177,8 @@ PlanStage* buildStages(OperationContext* txn,
         params.direction = ixn->direction;
         params.maxScan = ixn->maxScan;
         params.addKeyMetadata = ixn->addKeyMetadata;
+        params.skipScan = ixn->skipScan;
+        params.mergedPrefixFields = ixn->mergedPrefixFields;
         return new IndexScan(txn, params, ws, ixn->filter.get());
     } else if (STAGE_FETCH == root->getType()) {
         const FetchNode* fn = static_cast<const FetchNode*>(root);
@@ -117,6 +197,7 @@ PlanStage* buildStages(OperationContext* txn,
         params.collection = collection;
         params.pattern = sn->pattern;
         params.limit = sn->limit;
+        params.allowDiskUse = sn->allowDiskUse;
         return new SortStage(txn, params, ws, childStage);
     } else if (STAGE_SORT_KEY_GENERATOR == root->getType()) {
         const SortKeyGeneratorNode* keyGenNode = static_cast<const SortKeyGeneratorNode*>(root);
@@ -275,6 +356,7 @@ PlanStage* buildStages(OperationContext* txn,
         params.index = index;
         params.spec = fam->getSpec();
         params.indexPrefix = node->indexPrefix;
+        params.limit = node->limit;
 
         const std::string& language =
             ("" == node->language ? fam->getSpec().defaultLanguage().str() : node->language);
@@ -296,11 +378,20 @@ PlanStage* buildStages(OperationContext* txn,
         if (NULL == childStage) {
             return NULL;
         }
-        return new ShardFilterStage(txn,
-                                    ShardingState::get(getGlobalServiceContext())
-                                        ->getCollectionMetadata(collection->ns().ns()),
-                                    ws,
-                                    childStage);
+
+        std::shared_ptr<CollectionMetadata> metadata =
+            ShardingState::get(getGlobalServiceContext())
+                ->getCollectionMetadata(collection->ns().ns());
+
+        // No need to check each document when the scan below stays within chunks we own
+        BSONObj minShardKey;
+        BSONObj maxShardKey;
+        const bool allKeysOwned = metadata &&
+            getShardKeyBounds(
+                fn->children[0], metadata->getKeyPattern(), &minShardKey, &maxShardKey) &&
+            metadata->rangeBelongsToMe(minShardKey, maxShardKey);
+
+        return new ShardFilterStage(txn, metadata, ws, childStage, allKeysOwned);
     } else if (STAGE_KEEP_MUTATIONS == root->getType()) {
         const KeepMutationsNode* km = static_cast<const KeepMutationsNode*>(root);
         PlanStage* childStage = buildStages(txn, collection, qsol, km->children[0], ws);
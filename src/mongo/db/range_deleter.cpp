@@ -576,7 +576,11 @@ void RangeDeleter::recordDelStats(DeleteJobStats* newStat) {
 }
 
 RangeDeleteEntry::RangeDeleteEntry(const RangeDeleterOptions& options)
-    : options(options), notifyDone(NULL) {}
+    : options(options), notifyDone(NULL) {
+    stats.ns = options.range.ns;
+    stats.minKey = options.range.minKey;
+    stats.maxKey = options.range.maxKey;
+}
 
 BSONObj RangeDeleteEntry::toBSON() const {
     BSONObjBuilder builder;
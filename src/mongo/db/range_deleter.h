@@ -248,6 +248,10 @@ private:
  * Simple class for storing statistics for the RangeDeleter.
  */
 struct DeleteJobStats {
+    std::string ns;
+    BSONObj minKey;
+    BSONObj maxKey;
+
     Date_t queueStartTS;
     Date_t queueEndTS;
     Date_t deleteStartTS;
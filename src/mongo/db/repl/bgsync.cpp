@@ -51,6 +51,7 @@
 #include "mongo/db/repl/rollback_source_impl.h"
 #include "mongo/db/repl/rs_rollback.h"
 #include "mongo/db/repl/rs_sync.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/executor/network_interface_factory.h"
 #include "mongo/rpc/metadata/repl_set_metadata.h"
@@ -74,6 +75,11 @@ const char hashFieldName[] = "h";
 int SleepToAllowBatchingMillis = 2;
 const int BatchIsSmallish = 40000;  // bytes
 
+// Number of documents the sync source is asked to return in each batch of the oplog query. The
+// find command otherwise returns at most 101 documents in its first batch. 0 leaves the batch size
+// to the sync source.
+MONGO_EXPORT_SERVER_PARAMETER(replOplogFetcherBatchSize, int, 0);
+
 /**
  * Returns new thread pool for thead pool task executor.
  */
@@ -130,6 +136,11 @@ static ServerStatusMetricField<Counter64> displayOpsRead("repl.network.ops", &op
 static Counter64 networkByteStats;
 static ServerStatusMetricField<Counter64> displayBytesRead("repl.network.bytes", &networkByteStats);
 
+// The number of times we started fetching from a different sync source than before
+static Counter64 syncSourceChanges;
+static ServerStatusMetricField<Counter64> displaySyncSourceChanges("repl.syncSource.changes",
+                                                                   &syncSourceChanges);
+
 // The count of items in the buffer
 static Counter64 bufferCountGauge;
 static ServerStatusMetricField<Counter64> displayBufferCount("repl.buffer.count",
@@ -308,6 +319,12 @@ void BackgroundSync::_produce(OperationContext* txn) {
         lastOpTimeFetched = _lastOpTimeFetched;
         lastHashFetched = _lastFetchedHash;
         _syncSourceHost = syncSourceReader.getHost();
+        if (_syncSourceHost != _lastSyncSourceHost) {
+            if (!_lastSyncSourceHost.empty()) {
+                syncSourceChanges.increment();
+            }
+            _lastSyncSourceHost = _syncSourceHost;
+        }
         _replCoord->signalUpstreamUpdater();
     }
 
@@ -348,6 +365,9 @@ void BackgroundSync::_produce(OperationContext* txn) {
     cmdBob.append("oplogReplay", true);
     cmdBob.append("awaitData", true);
     cmdBob.append("maxTimeMS", durationCount<Milliseconds>(fetcherMaxTimeMS));
+    if (replOplogFetcherBatchSize > 0) {
+        cmdBob.append("batchSize", replOplogFetcherBatchSize);
+    }
 
     BSONObjBuilder metadataBob;
     if (isV1ElectionProtocol) {
@@ -471,7 +491,7 @@ void BackgroundSync::_fetcherCallback(const StatusWith<Fetcher::QueryResponse>&
 
     // process documents
     int currentBatchMessageSize = 0;
-    for (auto documentIter = documentBegin; documentIter != documentEnd; ++documentIter) {
+    if (documentBegin != documentEnd) {
         if (inShutdown()) {
             return;
         }
@@ -483,11 +503,16 @@ void BackgroundSync::_fetcherCallback(const StatusWith<Fetcher::QueryResponse>&
             return;
         }
 
-        // At this point, we are guaranteed to have at least one thing to read out
-        // of the fetcher.
-        const BSONObj& o = *documentIter;
-        currentBatchMessageSize += o.objsize();
-        opsReadStats.increment();
+        // Parse the optimes up front, before any of the batch is visible to the applier.
+        std::vector<OpTime> opTimes;
+        opTimes.reserve(std::distance(documentBegin, documentEnd));
+        size_t batchBufferSize = 0;
+        for (auto documentIter = documentBegin; documentIter != documentEnd; ++documentIter) {
+            currentBatchMessageSize += documentIter->objsize();
+            batchBufferSize += getSize(*documentIter);
+            opTimes.push_back(fassertStatusOK(28770, OpTime::parseFromBSON(*documentIter)));
+        }
+        opsReadStats.increment(opTimes.size());
 
         if (MONGO_FAIL_POINT(stepDownWhileDrainingFailPoint)) {
             sleepsecs(20);
@@ -502,16 +527,27 @@ void BackgroundSync::_fetcherCallback(const StatusWith<Fetcher::QueryResponse>&
             LOG(2) << "bgsync buffer has " << _buffer.size() << " bytes";
         }
 
-        bufferCountGauge.increment();
-        bufferSizeGauge.increment(getSize(o));
-        _buffer.push(o);
+        // Push the whole batch at once. If the buffer is cleared while we wait for room in it,
+        // the rest of the batch is dropped, and we only record the ops that were pushed as
+        // fetched.
+        bufferCountGauge.increment(opTimes.size());
+        bufferSizeGauge.increment(batchBufferSize);
+        const size_t pushed = _buffer.pushAll(documentBegin, documentEnd);
+        for (auto documentIter = documentBegin + pushed; documentIter != documentEnd;
+             ++documentIter) {
+            bufferCountGauge.decrement(1);
+            bufferSizeGauge.decrement(getSize(*documentIter));
+        }
 
-        {
+        if (pushed) {
             stdx::unique_lock<stdx::mutex> lock(_mutex);
-            _lastFetchedHash = o["h"].numberLong();
-            _lastOpTimeFetched = fassertStatusOK(28770, OpTime::parseFromBSON(o));
+            _lastFetchedHash = documentBegin[pushed - 1]["h"].numberLong();
+            _lastOpTimeFetched = opTimes[pushed - 1];
             LOG(3) << "lastOpTimeFetched: " << _lastOpTimeFetched;
         }
+        if (pushed < opTimes.size()) {
+            return;
+        }
     }
 
     // record time for each batch
@@ -555,6 +591,9 @@ void BackgroundSync::_fetcherCallback(const StatusWith<Fetcher::QueryResponse>&
     bob->append("getMore", queryResponse.cursorId);
     bob->append("collection", queryResponse.nss.coll());
     bob->append("maxTimeMS", durationCount<Milliseconds>(fetcherMaxTimeMS));
+    if (replOplogFetcherBatchSize > 0) {
+        bob->append("batchSize", replOplogFetcherBatchSize);
+    }
     if (receivedMetadata) {
         bob->append("term", _replCoord->getTerm());
     }
@@ -164,6 +164,10 @@ private:
 
     HostAndPort _syncSourceHost;
 
+    // The last sync source we fetched from. Unlike _syncSourceHost, this is not cleared between
+    // sync source selections, so that we can tell when the sync source changes.
+    HostAndPort _lastSyncSourceHost;
+
     BackgroundSync();
     BackgroundSync(const BackgroundSync& s);
     BackgroundSync operator=(const BackgroundSync& s);
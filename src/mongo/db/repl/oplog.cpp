@@ -38,6 +38,7 @@
 #include <set>
 #include <vector>
 
+#include "mongo/bson/bson_fixed_writer.h"
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/db/auth/action_set.h"
 #include "mongo/db/auth/action_type.h"
@@ -127,21 +128,21 @@ void checkOplogInsert(Status result) {
 }
 
 /**
- * Allocates an optime for a new entry in the oplog, and updates the replication coordinator to
- * reflect that new optime.  Returns the new optime and the correct value of the "h" field for
- * the new oplog entry.
+ * Allocates optimes for 'count' new entries in the oplog, and updates the replication coordinator
+ * to reflect those new optimes.  Returns each new optime, in increasing order, with the correct
+ * value of the "h" field for its oplog entry.
  *
- * NOTE: From the time this function returns to the time that the new oplog entry is written
+ * NOTE: From the time this function returns to the time that the new oplog entries are written
  * to the storage system, all errors must be considered fatal.  This is because the this
- * function registers the new optime with the storage system and the replication coordinator,
+ * function registers the new optimes with the storage system and the replication coordinator,
  * and provides no facility to revert those registrations on rollback.
  */
-std::pair<OpTime, long long> getNextOpTime(OperationContext* txn,
-                                           Collection* oplog,
-                                           const char* ns,
-                                           ReplicationCoordinator* replCoord,
-                                           const char* opstr,
-                                           ReplicationCoordinator::Mode replicationMode) {
+std::vector<std::pair<OpTime, long long>> getNextOpTimes(
+    OperationContext* txn,
+    Collection* oplog,
+    ReplicationCoordinator* replCoord,
+    ReplicationCoordinator::Mode replicationMode,
+    size_t count) {
     synchronizeOnCappedInFlightResource(txn->lockState(), oplog->ns());
 
     long long hashNew = 0;
@@ -154,58 +155,113 @@ std::pair<OpTime, long long> getNextOpTime(OperationContext* txn,
         term = replCoord->getTerm();
     }
 
+    std::vector<std::pair<OpTime, long long>> slots;
+    slots.reserve(count);
+
     stdx::lock_guard<stdx::mutex> lk(newOpMutex);
-    Timestamp ts = getNextGlobalTimestamp();
+    const Timestamp first = getNextGlobalTimestamps(count);
     newTimestampNotifier.notify_all();
 
-    fassert(28560, oplog->getRecordStore()->oplogDiskLocRegister(txn, ts));
+    // Registering the first optime keeps the whole block invisible until it commits.
+    fassert(28560, oplog->getRecordStore()->oplogDiskLocRegister(txn, first));
 
-    // Set hash if we're in replset mode, otherwise it remains 0 in master/slave.
-    if (replicationMode == ReplicationCoordinator::modeReplSet) {
-        hashNew = hashGenerator.nextInt64();
-    }
+    for (size_t i = 0; i < count; i++) {
+        // Set hash if we're in replset mode, otherwise it remains 0 in master/slave.
+        if (replicationMode == ReplicationCoordinator::modeReplSet) {
+            hashNew = hashGenerator.nextInt64();
+        }
 
-    OpTime opTime(ts, term);
-    return std::pair<OpTime, long long>(opTime, hashNew);
+        const Timestamp ts(first.getSecs(), first.getInc() + i);
+        slots.push_back(std::make_pair(OpTime(ts, term), hashNew));
+    }
+    return slots;
 }
 
 /**
  * This allows us to stream the oplog entry directly into data region
  * main goal is to avoid copying the o portion
  * which can be very large
- * TODO: can have this build the entire doc
+ *
+ * Every entry has the same fields, so the whole document is written in place by a
+ * BSONFixedWriter whose size is computed once, rather than by building the other fields
+ * into a separate BSONObj first.
  */
 class OplogDocWriter : public DocWriter {
 public:
-    OplogDocWriter(const BSONObj& frame, const BSONObj& oField) : _frame(frame), _oField(oField) {}
+    OplogDocWriter(const OpTime& opTime,
+                   long long hash,
+                   StringData opstr,
+                   StringData ns,
+                   bool fromMigrate,
+                   const BSONObj* o2,
+                   const BSONObj& oField)
+        : _opTime(opTime),
+          _hash(hash),
+          _opstr(opstr),
+          _ns(ns),
+          _fromMigrate(fromMigrate),
+          _o2(o2),
+          _oField(oField),
+          _size(computeSize()) {}
 
     ~OplogDocWriter() {}
 
+    // The field names match the ones OpTime::append() and parseFromBSON() use.
     void writeDocument(char* start) const {
-        char* buf = start;
-
-        memcpy(buf, _frame.objdata(), _frame.objsize() - 1);  // don't copy final EOO
-
-        reinterpret_cast<int*>(buf)[0] = documentSize();
-
-        buf += (_frame.objsize() - 1);
-        buf[0] = (char)Object;
-        buf[1] = 'o';
-        buf[2] = 0;
-        memcpy(buf + 3, _oField.objdata(), _oField.objsize());
-        buf += 3 + _oField.objsize();
-        buf[0] = EOO;
-
-        verify(static_cast<size_t>((buf + 1) - start) == documentSize());  // DEV?
+        BSONFixedWriter writer(start, _size);
+        writer.appendTimestamp("ts", _opTime.getTimestamp());
+        if (hasTerm()) {
+            writer.appendNumberLong("t", _opTime.getTerm());
+        }
+        writer.appendNumberLong("h", _hash);
+        writer.appendNumberInt("v", OPLOG_VERSION);
+        writer.appendString("op", _opstr);
+        writer.appendString("ns", _ns);
+        if (_fromMigrate) {
+            writer.appendBool("fromMigrate", true);
+        }
+        if (_o2) {
+            writer.appendObject("o2", *_o2);
+        }
+        writer.appendObject("o", _oField);
+        writer.done();
     }
 
     size_t documentSize() const {
-        return _frame.objsize() + _oField.objsize() + 1 /* type */ + 2 /* "o" */;
+        return _size;
     }
 
 private:
-    BSONObj _frame;
-    BSONObj _oField;
+    bool hasTerm() const {
+        // Don't add term in protocol version 0.
+        return _opTime.getTerm() != OpTime::kUninitializedTerm;
+    }
+
+    size_t computeSize() const {
+        size_t size = BSONFixedWriter::kDocumentOverhead + BSONFixedWriter::timestampSize("ts") +
+            BSONFixedWriter::numberLongSize("h") + BSONFixedWriter::numberIntSize("v") +
+            BSONFixedWriter::stringSize("op", _opstr) + BSONFixedWriter::stringSize("ns", _ns) +
+            BSONFixedWriter::objectSize("o", _oField);
+        if (hasTerm()) {
+            size += BSONFixedWriter::numberLongSize("t");
+        }
+        if (_fromMigrate) {
+            size += BSONFixedWriter::boolSize("fromMigrate");
+        }
+        if (_o2) {
+            size += BSONFixedWriter::objectSize("o2", *_o2);
+        }
+        return size;
+    }
+
+    const OpTime _opTime;
+    const long long _hash;
+    const StringData _opstr;
+    const StringData _ns;
+    const bool _fromMigrate;
+    const BSONObj* const _o2;
+    const BSONObj _oField;
+    const size_t _size;
 };
 
 class UpdateReplOpTimeChange : public RecoveryUnit::Change {
@@ -254,15 +310,21 @@ void setOplogCollectionName() {
 
 */
 
-void _logOp(OperationContext* txn,
-            const char* opstr,
-            const char* ns,
-            const BSONObj& obj,
-            BSONObj* o2,
-            bool fromMigrate,
-            const std::string& oplogCollectionName,
-            ReplicationCoordinator::Mode replicationMode,
-            bool updateReplOpTime) {
+namespace {
+/**
+ * Writes an oplog entry for each of the objects in [begin, end), all with the same 'opstr',
+ * 'ns' and 'o2', using one allocation of optimes and one write to the oplog collection.
+ */
+void _logOpsInternal(OperationContext* txn,
+                     const char* opstr,
+                     const char* ns,
+                     const BSONObj* begin,
+                     const BSONObj* end,
+                     BSONObj* o2,
+                     bool fromMigrate,
+                     const std::string& oplogCollectionName,
+                     ReplicationCoordinator::Mode replicationMode,
+                     bool updateReplOpTime) {
     NamespaceString nss(ns);
     if (nss.db() == "local") {
         return;
@@ -305,39 +367,60 @@ void _logOp(OperationContext* txn,
                 _localOplogCollection);
     }
 
-    std::pair<OpTime, long long> slot =
-        getNextOpTime(txn, _localOplogCollection, ns, replCoord, opstr, replicationMode);
+    const size_t count = end - begin;
+    const std::vector<std::pair<OpTime, long long>> slots =
+        getNextOpTimes(txn, _localOplogCollection, replCoord, replicationMode, count);
 
     /* we jump through a bunch of hoops here to avoid copying the obj buffer twice --
        instead we do a single copy to the destination position in the memory mapped file.
     */
-
-    BSONObjBuilder b(256);
-
-    slot.first.append(&b);
-    b.append("h", slot.second);
-    b.append("v", OPLOG_VERSION);
-    b.append("op", opstr);
-    b.append("ns", ns);
-    if (fromMigrate) {
-        b.appendBool("fromMigrate", true);
-    }
-
-    if (o2) {
-        b.append("o2", *o2);
+    // This transaction might roll back.
+    if (count == 1) {
+        OplogDocWriter writer(slots[0].first, slots[0].second, opstr, ns, fromMigrate, o2, *begin);
+        checkOplogInsert(_localOplogCollection->insertDocument(txn, &writer, false));
+    } else {
+        std::vector<OplogDocWriter> writers;
+        writers.reserve(count);
+        std::vector<const DocWriter*> docs;
+        docs.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            writers.emplace_back(
+                slots[i].first, slots[i].second, opstr, ns, fromMigrate, o2, begin[i]);
+            docs.push_back(&writers.back());
+        }
+        checkOplogInsert(_localOplogCollection->insertDocuments(txn, docs, false));
     }
-    BSONObj partial = b.done();
 
-    OplogDocWriter writer(partial, obj);
-    // This transaction might roll back.
-    checkOplogInsert(_localOplogCollection->insertDocument(txn, &writer, false));
+    const OpTime& lastOpTime = slots.back().first;
 
     // Set replCoord last optime only after we're sure the WUOW didn't abort and roll back.
     if (updateReplOpTime) {
-        txn->recoveryUnit()->registerChange(new UpdateReplOpTimeChange(slot.first, replCoord));
+        txn->recoveryUnit()->registerChange(new UpdateReplOpTimeChange(lastOpTime, replCoord));
     }
 
-    ReplClientInfo::forClient(txn->getClient()).setLastOp(slot.first);
+    ReplClientInfo::forClient(txn->getClient()).setLastOp(lastOpTime);
+}
+}  // namespace
+
+void _logOp(OperationContext* txn,
+            const char* opstr,
+            const char* ns,
+            const BSONObj& obj,
+            BSONObj* o2,
+            bool fromMigrate,
+            const std::string& oplogCollectionName,
+            ReplicationCoordinator::Mode replicationMode,
+            bool updateReplOpTime) {
+    _logOpsInternal(txn,
+                    opstr,
+                    ns,
+                    &obj,
+                    &obj + 1,
+                    o2,
+                    fromMigrate,
+                    oplogCollectionName,
+                    replicationMode,
+                    updateReplOpTime);
 }
 
 void _logOp(OperationContext* txn,
@@ -357,7 +440,30 @@ void _logOp(OperationContext* txn,
            true);
 }
 
-OpTime writeOpsToOplog(OperationContext* txn, const std::deque<BSONObj>& ops) {
+void _logOps(OperationContext* txn,
+             const char* opstr,
+             const char* ns,
+             std::vector<BSONObj>::const_iterator begin,
+             std::vector<BSONObj>::const_iterator end,
+             bool fromMigrate) {
+    if (begin == end) {
+        return;
+    }
+    _logOpsInternal(txn,
+                    opstr,
+                    ns,
+                    &*begin,
+                    &*begin + (end - begin),
+                    nullptr,
+                    fromMigrate,
+                    _oplogCollectionName,
+                    ReplicationCoordinator::get(txn)->getReplicationMode(),
+                    true);
+}
+
+OpTime writeOpsToOplog(OperationContext* txn,
+                       const std::deque<BSONObj>& ops,
+                       const stdx::function<bool()>& beforeCommit) {
     ReplicationCoordinator* replCoord = getGlobalReplicationCoordinator();
 
     OpTime lastOptime;
@@ -396,6 +502,9 @@ OpTime writeOpsToOplog(OperationContext* txn, const std::deque<BSONObj>& ops) {
             }
             lastOptime = optime;
         }
+        if (beforeCommit && !beforeCommit()) {
+            return OpTime();
+        }
         wunit.commit();
     }
     MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "writeOps", _localOplogCollection->ns().ns());
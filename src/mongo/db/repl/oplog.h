@@ -31,11 +31,13 @@
 #include <cstddef>
 #include <deque>
 #include <string>
+#include <vector>
 
 #include "mongo/base/status.h"
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/time_support.h"
 
@@ -70,7 +72,13 @@ void createOplog(OperationContext* txn);
 // used internally by replication secondaries after they have applied ops.  Updates the global
 // optime.
 // Returns the optime for the last op inserted.
-OpTime writeOpsToOplog(OperationContext* txn, const std::deque<BSONObj>& ops);
+//
+// If 'beforeCommit' is set, it is called after the ops are inserted and before they are committed,
+// possibly more than once if the write has to be retried. If it returns false, the inserts are
+// rolled back and a null optime is returned.
+OpTime writeOpsToOplog(OperationContext* txn,
+                       const std::deque<BSONObj>& ops,
+                       const stdx::function<bool()>& beforeCommit = stdx::function<bool()>());
 
 extern std::string rsOplogName;
 extern std::string masterSlaveOplogName;
@@ -109,6 +117,18 @@ void _logOp(OperationContext* txn,
             BSONObj* o2,
             bool fromMigrate);
 
+/**
+ * Logs one operation of type 'opstr' for each object in [begin, end), in order, as if by calling
+ * _logOp() on each in turn. The entries get consecutive optimes and are written to the oplog
+ * together, which is cheaper than writing them one at a time.
+ */
+void _logOps(OperationContext* txn,
+             const char* opstr,
+             const char* ns,
+             std::vector<BSONObj>::const_iterator begin,
+             std::vector<BSONObj>::const_iterator end,
+             bool fromMigrate);
+
 // Flush out the cached pointers to the local database and oplog.
 // Used by the closeDatabase command to ensure we don't cache closed things.
 void oplogCheckCloseDatabase(OperationContext* txn, Database* db);
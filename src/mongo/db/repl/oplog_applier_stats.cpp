@@ -0,0 +1,107 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/oplog_applier_stats.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace repl {
+
+namespace {
+
+OplogApplierStats globalOplogApplierStats;
+
+}  // namespace
+
+OplogApplierStats* OplogApplierStats::get() {
+    return &globalOplogApplierStats;
+}
+
+StringData OplogApplierStats::phaseName(Phase phase) {
+    switch (phase) {
+        case kFetch:
+            return "fetch";
+        case kPrefetch:
+            return "prefetch";
+        case kPartition:
+            return "partition";
+        case kApply:
+            return "apply";
+        case kOplogWrite:
+            return "oplogWrite";
+        case kWaitUntilDurable:
+            return "waitUntilDurable";
+        case kNumPhases:
+            break;
+    }
+    MONGO_UNREACHABLE;
+}
+
+void OplogApplierStats::recordPhase(Phase phase, long long micros) {
+    invariant(phase < kNumPhases);
+    _phases[phase].increment(micros);
+}
+
+void OplogApplierStats::recordWriter(long long micros) {
+    _writers.increment(micros);
+}
+
+void OplogApplierStats::recordOp(long long micros) {
+    _ops.increment(micros);
+}
+
+void OplogApplierStats::recordSlowOp() {
+    _slowOps.fetchAndAdd(1);
+}
+
+void OplogApplierStats::append(BSONObjBuilder* builder, bool includeBuckets) const {
+    BSONObjBuilder phasesBuilder(builder->subobjStart("phases"));
+    for (int phase = 0; phase < kNumPhases; ++phase) {
+        BSONObjBuilder phaseBuilder(phasesBuilder.subobjStart(phaseName(Phase(phase))));
+        _phases[phase].append(&phaseBuilder, includeBuckets);
+        phaseBuilder.doneFast();
+    }
+    phasesBuilder.doneFast();
+
+    BSONObjBuilder writersBuilder(builder->subobjStart("writers"));
+    _writers.append(&writersBuilder, includeBuckets);
+    writersBuilder.doneFast();
+
+    BSONObjBuilder opsBuilder(builder->subobjStart("ops"));
+    _ops.append(&opsBuilder, includeBuckets);
+    opsBuilder.doneFast();
+
+    builder->appendNumber("slowOps", static_cast<long long>(_slowOps.load()));
+}
+
+}  // namespace repl
+}  // namespace mongo
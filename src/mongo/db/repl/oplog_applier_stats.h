@@ -0,0 +1,108 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/db/stats/latency_histogram.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+namespace repl {
+
+/**
+ * Latencies of the oplog applier of a secondary: of each phase of the batches it applies, of the
+ * share of a batch each writer thread applies, and of each op the writers apply. They show where
+ * the applier spends its time when replication lags.
+ */
+class OplogApplierStats {
+    MONGO_DISALLOW_COPYING(OplogApplierStats);
+
+public:
+    enum Phase {
+        // Waiting for the ops of the batch to arrive from the sync source.
+        kFetch,
+        // Warming the caches of the storage engine with the documents and index keys of the ops.
+        kPrefetch,
+        // Assigning the ops to the writer threads.
+        kPartition,
+        // Waiting for the writer threads to apply the batch.
+        kApply,
+        // Writing the batch to the oplog, which overlaps kApply when the oplog writes are
+        // pipelined.
+        kOplogWrite,
+        // Waiting for the batch to be durable.
+        kWaitUntilDurable,
+        kNumPhases
+    };
+
+    OplogApplierStats() = default;
+
+    /**
+     * The stats of the oplog applier of this server.
+     */
+    static OplogApplierStats* get();
+
+    static StringData phaseName(Phase phase);
+
+    void recordPhase(Phase phase, long long micros);
+
+    /**
+     * Records the time a writer thread took to apply its share of a batch.
+     */
+    void recordWriter(long long micros);
+
+    /**
+     * Records the time it took to apply an op, or a group of inserts applied together.
+     */
+    void recordOp(long long micros);
+
+    /**
+     * Counts an op which took longer than the slow operation threshold to apply.
+     */
+    void recordSlowOp();
+
+    /**
+     * Appends a "phases" subobject with the histogram of each phase, "writers" and "ops"
+     * histograms and the number of "slowOps". See LatencyHistogram::append for 'includeBuckets'.
+     */
+    void append(BSONObjBuilder* builder, bool includeBuckets) const;
+
+private:
+    LatencyHistogram _phases[kNumPhases];
+    LatencyHistogram _writers;
+    LatencyHistogram _ops;
+    AtomicUInt64 _slowOps;
+};
+
+}  // namespace repl
+}  // namespace mongo
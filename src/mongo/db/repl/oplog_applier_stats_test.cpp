@@ -0,0 +1,84 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/oplog_applier_stats.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+using namespace mongo::repl;
+
+TEST(OplogApplierStatsTest, AppendsEveryPhase) {
+    OplogApplierStats stats;
+    BSONObjBuilder builder;
+    stats.append(&builder, false);
+    BSONObj obj = builder.obj();
+
+    BSONObj phases = obj["phases"].Obj();
+    ASSERT_EQUALS(OplogApplierStats::kNumPhases, phases.nFields());
+    for (int phase = 0; phase < OplogApplierStats::kNumPhases; ++phase) {
+        StringData name = OplogApplierStats::phaseName(OplogApplierStats::Phase(phase));
+        ASSERT_EQUALS(0, phases[name]["ops"].numberLong());
+    }
+    ASSERT_EQUALS(0, obj["writers"]["ops"].numberLong());
+    ASSERT_EQUALS(0, obj["ops"]["ops"].numberLong());
+    ASSERT_EQUALS(0, obj["slowOps"].numberLong());
+}
+
+TEST(OplogApplierStatsTest, RecordsIntoTheirOwnHistograms) {
+    OplogApplierStats stats;
+    stats.recordPhase(OplogApplierStats::kPartition, 10);
+    stats.recordPhase(OplogApplierStats::kPartition, 30);
+    stats.recordPhase(OplogApplierStats::kWaitUntilDurable, 1000);
+    stats.recordWriter(500);
+    stats.recordOp(20);
+    stats.recordOp(40);
+    stats.recordOp(60);
+    stats.recordSlowOp();
+
+    BSONObjBuilder builder;
+    stats.append(&builder, true);
+    BSONObj obj = builder.obj();
+
+    BSONObj phases = obj["phases"].Obj();
+    ASSERT_EQUALS(2, phases["partition"]["ops"].numberLong());
+    ASSERT_EQUALS(40, phases["partition"]["latency"].numberLong());
+    ASSERT_EQUALS(2U, phases["partition"]["histogram"].Array().size());
+    ASSERT_EQUALS(1, phases["waitUntilDurable"]["ops"].numberLong());
+    ASSERT_EQUALS(0, phases["apply"]["ops"].numberLong());
+    ASSERT_EQUALS(1, obj["writers"]["ops"].numberLong());
+    ASSERT_EQUALS(3, obj["ops"]["ops"].numberLong());
+    ASSERT_EQUALS(120, obj["ops"]["latency"].numberLong());
+    ASSERT_EQUALS(1, obj["slowOps"].numberLong());
+}
+
+}  // namespace
@@ -54,6 +54,7 @@ const string ReadConcernArgs::kOpTimeFieldName("afterOpTime");
 const string ReadConcernArgs::kOpTimestampFieldName("ts");
 const string ReadConcernArgs::kOpTermFieldName("term");
 const string ReadConcernArgs::kLevelFieldName("level");
+const string ReadConcernArgs::kMaxStalenessFieldName("maxStalenessMS");
 
 ReadConcernArgs::ReadConcernArgs() = default;
 
@@ -69,6 +70,10 @@ OpTime ReadConcernArgs::getOpTime() const {
     return _opTime.value_or(OpTime());
 }
 
+boost::optional<Milliseconds> ReadConcernArgs::getMaxStaleness() const {
+    return _maxStaleness;
+}
+
 Status ReadConcernArgs::initialize(const BSONObj& cmdObj) {
     auto readConcernElem = cmdObj[ReadConcernArgs::kReadConcernFieldName];
 
@@ -109,6 +114,32 @@ Status ReadConcernArgs::initialize(const BSONObj& cmdObj) {
         return readCommittedStatus;
     }
 
+    if (readConcernObj.hasField(kMaxStalenessFieldName)) {
+        long long maxStalenessMS;
+        auto maxStalenessStatus =
+            bsonExtractIntegerField(readConcernObj, kMaxStalenessFieldName, &maxStalenessMS);
+        if (!maxStalenessStatus.isOK()) {
+            return maxStalenessStatus;
+        }
+
+        if (maxStalenessMS <= 0) {
+            return Status(ErrorCodes::FailedToParse,
+                          str::stream() << kReadConcernFieldName << '.' << kMaxStalenessFieldName
+                                        << " must be positive");
+        }
+
+        // A stale view can both predate the requested optime and be newer than the majority
+        // committed point, so it can satisfy neither guarantee.
+        if (getLevel() != ReadConcernLevel::kLocalReadConcern || _opTime) {
+            return Status(ErrorCodes::FailedToParse,
+                          str::stream() << kReadConcernFieldName << '.' << kMaxStalenessFieldName
+                                        << " is only supported with level \"local\" and no "
+                                        << kOpTimeFieldName);
+        }
+
+        _maxStaleness = Milliseconds(maxStalenessMS);
+    }
+
     return Status::OK();
 }
 
@@ -144,6 +175,10 @@ void ReadConcernArgs::appendInfo(BSONObjBuilder* builder) {
         afterBuilder.done();
     }
 
+    if (_maxStaleness) {
+        rcBuilder.append(kMaxStalenessFieldName, durationCount<Milliseconds>(*_maxStaleness));
+    }
+
     rcBuilder.done();
 }
 
@@ -50,6 +50,7 @@ public:
     static const std::string kOpTimeFieldName;
     static const std::string kOpTimestampFieldName;
     static const std::string kLevelFieldName;
+    static const std::string kMaxStalenessFieldName;
 
     ReadConcernArgs();
     ReadConcernArgs(boost::optional<OpTime> opTime, boost::optional<ReadConcernLevel> level);
@@ -62,6 +63,7 @@ public:
      *    readConcern: { // optional
      *      level: "[majority|local|linearizable]",
      *      afterOpTime: { ts: <timestamp>, term: <NumberLong> },
+     *      maxStalenessMS: <NumberLong>, // only valid with level local and no afterOpTime
      *    }
      * }
      */
@@ -75,9 +77,16 @@ public:
     ReadConcernLevel getLevel() const;
     OpTime getOpTime() const;
 
+    /**
+     * Returns how stale the data read may be, or boost::none if the read must see the latest
+     * data.
+     */
+    boost::optional<Milliseconds> getMaxStaleness() const;
+
 private:
     boost::optional<OpTime> _opTime;
     boost::optional<ReadConcernLevel> _level;
+    boost::optional<Milliseconds> _maxStaleness;
 };
 
 }  // namespace repl
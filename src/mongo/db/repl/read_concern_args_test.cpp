@@ -162,6 +162,61 @@ TEST(ReadAfterParse, BadLevelValue) {
                                                       << "seven is not a real level"))));
 }
 
+TEST(ReadAfterParse, MaxStalenessWithLocalLevel) {
+    ReadConcernArgs readAfterOpTime;
+    ASSERT_OK(readAfterOpTime.initialize(
+        BSON("find"
+             << "test" << ReadConcernArgs::kReadConcernFieldName
+             << BSON(ReadConcernArgs::kLevelFieldName
+                     << "local" << ReadConcernArgs::kMaxStalenessFieldName << 500))));
+
+    ASSERT(ReadConcernLevel::kLocalReadConcern == readAfterOpTime.getLevel());
+    ASSERT(readAfterOpTime.getMaxStaleness());
+    ASSERT_EQ(Milliseconds(500), *readAfterOpTime.getMaxStaleness());
+}
+
+TEST(ReadAfterParse, NoMaxStalenessByDefault) {
+    ReadConcernArgs readAfterOpTime;
+    ASSERT_OK(
+        readAfterOpTime.initialize(BSON("find"
+                                        << "test" << ReadConcernArgs::kReadConcernFieldName
+                                        << BSON(ReadConcernArgs::kLevelFieldName << "local"))));
+
+    ASSERT_FALSE(readAfterOpTime.getMaxStaleness());
+}
+
+TEST(ReadAfterParse, BadMaxStalenessValue) {
+    ReadConcernArgs readAfterOpTime;
+    ASSERT_NOT_OK(readAfterOpTime.initialize(
+        BSON("find"
+             << "test" << ReadConcernArgs::kReadConcernFieldName
+             << BSON(ReadConcernArgs::kMaxStalenessFieldName << 0))));
+    ASSERT_NOT_OK(readAfterOpTime.initialize(
+        BSON("find"
+             << "test" << ReadConcernArgs::kReadConcernFieldName
+             << BSON(ReadConcernArgs::kMaxStalenessFieldName << "x"))));
+}
+
+TEST(ReadAfterParse, MaxStalenessWithMajorityLevel) {
+    ReadConcernArgs readAfterOpTime;
+    ASSERT_NOT_OK(readAfterOpTime.initialize(
+        BSON("find"
+             << "test" << ReadConcernArgs::kReadConcernFieldName
+             << BSON(ReadConcernArgs::kLevelFieldName
+                     << "majority" << ReadConcernArgs::kMaxStalenessFieldName << 500))));
+}
+
+TEST(ReadAfterParse, MaxStalenessWithOpTime) {
+    ReadConcernArgs readAfterOpTime;
+    ASSERT_NOT_OK(readAfterOpTime.initialize(
+        BSON("find"
+             << "test" << ReadConcernArgs::kReadConcernFieldName
+             << BSON(ReadConcernArgs::kOpTimeFieldName
+                     << BSON(ReadConcernArgs::kOpTimestampFieldName
+                             << Timestamp(20, 30) << ReadConcernArgs::kOpTermFieldName << 2)
+                     << ReadConcernArgs::kMaxStalenessFieldName << 500))));
+}
+
 TEST(ReadAfterSerialize, Empty) {
     BSONObjBuilder builder;
     ReadConcernArgs readAfterOpTime;
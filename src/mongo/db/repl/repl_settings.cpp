@@ -42,5 +42,17 @@ MONGO_INITIALIZER(maxSyncSourceLagSecsCheck)(InitializerContext*) {
     }
     return Status::OK();
 }
+
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(syncSourceLagPenaltyMillisPerSec, int, 0);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(syncSourceChangeHysteresisMillis, int, 0);
+MONGO_INITIALIZER(syncSourceRankingCheck)(InitializerContext*) {
+    if (syncSourceLagPenaltyMillisPerSec < 0) {
+        return Status(ErrorCodes::BadValue, "syncSourceLagPenaltyMillisPerSec must be >= 0");
+    }
+    if (syncSourceChangeHysteresisMillis < 0) {
+        return Status(ErrorCodes::BadValue, "syncSourceChangeHysteresisMillis must be >= 0");
+    }
+    return Status::OK();
+}
 }
 }
@@ -39,6 +39,8 @@ namespace mongo {
 namespace repl {
 
 extern int maxSyncSourceLagSecs;
+extern int syncSourceLagPenaltyMillisPerSec;
+extern int syncSourceChangeHysteresisMillis;
 
 bool anyReplEnabled();
 
@@ -654,7 +654,12 @@ void ReplicationCoordinatorImpl::_updateSlaveInfoOptime_inlock(SlaveInfo* slaveI
     slaveInfo->lastUpdate = _replExecutor.now();
     slaveInfo->down = false;
 
-    _updateLastCommittedOpTime_inlock();
+    // Only voting members count toward the commit point, so progress reported by the non-voting
+    // members of a large set does not need to recompute it.
+    const MemberConfig* memberConfig = _rsConfig.findMemberByID(slaveInfo->memberId);
+    if (!memberConfig || memberConfig->isVoter()) {
+        _updateLastCommittedOpTime_inlock();
+    }
     // Wake up any threads waiting for replication that now have their replication
     // check satisfied
     _wakeReadyWaiters_inlock();
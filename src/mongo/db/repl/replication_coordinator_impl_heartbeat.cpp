@@ -32,7 +32,9 @@
 
 #include <algorithm>
 
+#include "mongo/base/counter.h"
 #include "mongo/base/status.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/elect_cmd_runner.h"
 #include "mongo/db/repl/freshness_checker.h"
@@ -51,7 +53,9 @@
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace repl {
@@ -60,6 +64,14 @@ namespace {
 
 typedef ReplicationExecutor::CallbackHandle CBHandle;
 
+// The number of heartbeat responses processed, and the time spent processing them.
+Counter64 heartbeatResponseStats;
+ServerStatusMetricField<Counter64> displayHeartbeatResponses("repl.heartbeats.responses",
+                                                             &heartbeatResponseStats);
+Counter64 heartbeatProcessingMicrosStats;
+ServerStatusMetricField<Counter64> displayHeartbeatProcessingMicros(
+    "repl.heartbeats.processingMicros", &heartbeatProcessingMicrosStats);
+
 }  // namespace
 
 using executor::RemoteCommandRequest;
@@ -123,6 +135,12 @@ void ReplicationCoordinatorImpl::_handleHeartbeatResponse(
         return;
     }
 
+    Timer processingTimer;
+    heartbeatResponseStats.increment();
+    ON_BLOCK_EXIT([&processingTimer] {
+        heartbeatProcessingMicrosStats.increment(processingTimer.micros());
+    });
+
     const HostAndPort& target = cbData.request.target;
     ReplSetHeartbeatResponse hbResponse;
     BSONObj resp;
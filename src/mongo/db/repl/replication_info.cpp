@@ -42,11 +42,13 @@
 #include "mongo/db/repl/is_master_response.h"
 #include "mongo/db/repl/master_slave.h"
 #include "mongo/db/repl/oplog.h"
+#include "mongo/db/repl/oplog_applier_stats.h"
 #include "mongo/db/repl/oplogreader.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/s/write_ops/batched_command_request.h"
+#include "mongo/util/net/message_compressor.h"
 
 namespace mongo {
 
@@ -158,6 +160,13 @@ public:
         appendReplicationInfo(txn, result, level);
         getGlobalReplicationCoordinator()->processReplSetGetRBID(&result);
 
+        // The latencies of the oplog applier, with their buckets for {repl: {histograms: true}}.
+        const bool includeHistograms =
+            configElement.type() == Object && configElement.Obj()["histograms"].trueValue();
+        BSONObjBuilder applyBuilder(result.subobjStart("apply"));
+        OplogApplierStats::get()->append(&applyBuilder, includeHistograms);
+        applyBuilder.doneFast();
+
         return result.obj();
     }
 
@@ -239,6 +248,8 @@ public:
         result.appendDate("localTime", jsTime());
         result.append("maxWireVersion", maxWireVersion);
         result.append("minWireVersion", minWireVersion);
+
+        negotiateMessageCompressor(cmdObj, txn->getClient()->port(), &result);
         return true;
     }
 } cmdismaster;
@@ -30,6 +30,7 @@
 
 #include "mongo/db/repl/rollback_source_impl.h"
 
+#include "mongo/client/dbclientcursor.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/cloner.h"
 #include "mongo/db/jsobj.h"
@@ -68,6 +69,38 @@ BSONObj RollbackSourceImpl::findOne(const NamespaceString& nss, const BSONObj& f
     return _getConnection()->findOne(nss.toString(), filter, NULL, QueryOption_SlaveOk).getOwned();
 }
 
+std::vector<BSONObj> RollbackSourceImpl::findByIds(const NamespaceString& nss,
+                                                   const std::vector<BSONElement>& ids) const {
+    std::vector<BSONObj> docs;
+    BSONObjBuilder queryBuilder;
+    {
+        BSONObjBuilder idBuilder(queryBuilder.subobjStart("_id"));
+        BSONArrayBuilder inBuilder(idBuilder.subarrayStart("$in"));
+        for (const auto& id : ids) {
+            // A regular expression inside $in matches by pattern rather than by equality.
+            if (id.type() == RegEx) {
+                BSONObj doc = findOne(nss, id.wrap());
+                if (!doc.isEmpty()) {
+                    docs.push_back(doc);
+                }
+                continue;
+            }
+            inBuilder.append(id);
+        }
+        if (inBuilder.arrSize() == 0) {
+            return docs;
+        }
+    }
+
+    auto cursor = _getConnection()->query(
+        nss.ns(), Query(queryBuilder.obj()), 0, 0, nullptr, QueryOption_SlaveOk);
+    uassert(28812, str::stream() << "rollback unable to query " << nss.ns(), cursor);
+    while (cursor->more()) {
+        docs.push_back(cursor->nextSafe().getOwned());
+    }
+    return docs;
+}
+
 void RollbackSourceImpl::copyCollectionFromRemote(OperationContext* txn,
                                                   const NamespaceString& nss) const {
     std::string errmsg;
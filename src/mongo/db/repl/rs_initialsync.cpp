@@ -54,6 +54,9 @@
 #include "mongo/db/repl/oplogreader.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -69,6 +72,11 @@ using std::string;
 // Failpoint which fails initial sync and leaves on oplog entry in the buffer.
 MONGO_FP_DECLARE(failInitSyncWithBufferedEntriesLeft);
 
+// Number of databases that initial sync clones, and builds the indexes of, at the same time. Each
+// database is cloned on its own thread and connection to the sync source, holding only its own
+// database lock.
+MONGO_EXPORT_SERVER_PARAMETER(initialSyncDatabaseCloners, int, 1);
+
 /**
  * Truncates the oplog (removes any documents) and resets internal variables that were
  * originally initialized or affected by using values from the oplog at startup time.  These
@@ -164,48 +172,126 @@ void checkAdminDatabasePostClone(OperationContext* txn, Database* adminDb) {
     }
 }
 
+bool _initialSyncCloneDb(OperationContext* txn,
+                         Cloner& cloner,
+                         const std::string& host,
+                         const string& db,
+                         bool dataPass) {
+    if (dataPass)
+        log() << "initial sync cloning db: " << db;
+    else
+        log() << "initial sync cloning indexes for : " << db;
+
+    CloneOptions options;
+    options.fromDB = db;
+    options.slaveOk = true;
+    options.useReplAuth = true;
+    options.snapshot = false;
+    options.mayYield = true;
+    options.mayBeInterrupted = true;
+    options.syncData = dataPass;
+    options.syncIndexes = !dataPass;
+
+    // Make database stable
+    ScopedTransaction transaction(txn, MODE_IX);
+    Lock::DBLock dbWrite(txn->lockState(), db, MODE_X);
+
+    Status status = cloner.copyDb(txn, db, host, options, NULL);
+    if (!status.isOK()) {
+        log() << "initial sync: error while " << (dataPass ? "cloning " : "indexing ") << db
+              << ".  " << status.toString();
+        return false;
+    }
+
+    if (db == "admin") {
+        checkAdminDatabasePostClone(txn, dbHolder().get(txn, db));
+    }
+    return true;
+}
+
+/**
+ * Clones the databases in 'dbs' on 'numCloners' threads, each of which takes the next database
+ * that has not been cloned yet. Returns false as soon as one database fails to clone.
+ */
+bool _initialSyncCloneDbsInParallel(const std::string& host,
+                                    const std::vector<string>& dbs,
+                                    size_t numCloners,
+                                    bool dataPass) {
+    stdx::mutex mutex;
+    size_t nextDb = 0;
+    bool failed = false;
+
+    auto cloneDbs = [&](size_t clonerId) {
+        const std::string threadName = str::stream() << "initial sync cloner " << clonerId;
+        Client::initThread(threadName.c_str());
+        OperationContextImpl txn;
+        txn.setReplicatedWrites(false);
+        DisableDocumentValidation validationDisabler(&txn);
+        Cloner cloner;
+
+        while (true) {
+            string db;
+            {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                if (failed || nextDb == dbs.size() || inShutdown()) {
+                    return;
+                }
+                db = dbs[nextDb++];
+            }
+
+            bool cloned = false;
+            try {
+                cloned = _initialSyncCloneDb(&txn, cloner, host, db, dataPass);
+            } catch (const DBException& e) {
+                log() << "initial sync: error while " << (dataPass ? "cloning " : "indexing ")
+                      << db << ".  " << e.toStatus();
+            }
+            if (!cloned) {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                failed = true;
+                return;
+            }
+        }
+    };
+
+    std::vector<stdx::thread> cloners;
+    for (size_t i = 0; i < numCloners; i++) {
+        cloners.emplace_back(cloneDbs, i);
+    }
+    for (auto&& cloner : cloners) {
+        cloner.join();
+    }
+    return !failed && !inShutdown();
+}
+
 bool _initialSyncClone(OperationContext* txn,
                        Cloner& cloner,
                        const std::string& host,
                        const list<string>& dbs,
                        bool dataPass) {
+    std::vector<string> toClone;
     for (list<string>::const_iterator i = dbs.begin(); i != dbs.end(); i++) {
         const string db = *i;
         if (db == "local")
             continue;
 
-        if (dataPass)
-            log() << "initial sync cloning db: " << db;
-        else
-            log() << "initial sync cloning indexes for : " << db;
-
-        CloneOptions options;
-        options.fromDB = db;
-        options.slaveOk = true;
-        options.useReplAuth = true;
-        options.snapshot = false;
-        options.mayYield = true;
-        options.mayBeInterrupted = true;
-        options.syncData = dataPass;
-        options.syncIndexes = !dataPass;
-
-        // Make database stable
-        ScopedTransaction transaction(txn, MODE_IX);
-        Lock::DBLock dbWrite(txn->lockState(), db, MODE_X);
-
-        Status status = cloner.copyDb(txn, db, host, options, NULL);
-        if (!status.isOK()) {
-            log() << "initial sync: error while " << (dataPass ? "cloning " : "indexing ") << db
-                  << ".  " << status.toString();
-            return false;
-        }
-
-        if (db == "admin") {
-            checkAdminDatabasePostClone(txn, dbHolder().get(txn, db));
+        // The admin database is cloned before any other databases are, on its own, to catch
+        // schema errors early.
+        if (initialSyncDatabaseCloners <= 1 || db == "admin") {
+            if (!_initialSyncCloneDb(txn, cloner, host, db, dataPass)) {
+                return false;
+            }
+            continue;
         }
+        toClone.push_back(db);
     }
 
-    return true;
+    if (toClone.empty()) {
+        return true;
+    }
+    const size_t numCloners =
+        std::min(static_cast<size_t>(initialSyncDatabaseCloners), toClone.size());
+    return _initialSyncCloneDbsInParallel(host, toClone, numCloners, dataPass);
 }
 
 /**
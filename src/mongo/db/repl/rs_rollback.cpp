@@ -110,10 +110,14 @@ using std::map;
 using std::set;
 using std::string;
 using std::pair;
+using std::vector;
 
 namespace repl {
 namespace {
 
+// Maximum number of documents refetched from the sync source in one query during rollback.
+const size_t kRefetchBatchSize = 1000;
+
 class RSFatalException : public std::exception {
 public:
     RSFatalException(std::string m = "replica set fatal exception") : msg(m) {}
@@ -277,21 +281,35 @@ void syncFixUp(OperationContext* txn,
     DocID doc;
     unsigned long long numFetched = 0;
     try {
-        for (set<DocID>::iterator it = fixUpInfo.toRefetch.begin(); it != fixUpInfo.toRefetch.end();
-             it++) {
+        // toRefetch is ordered by namespace, so each batch of ids comes from a single collection.
+        set<DocID>::iterator it = fixUpInfo.toRefetch.begin();
+        while (it != fixUpInfo.toRefetch.end()) {
             doc = *it;
+            vector<DocID> batch;
+            vector<BSONElement> ids;
+            for (; it != fixUpInfo.toRefetch.end() && strcmp(it->ns, doc.ns) == 0 &&
+                     batch.size() < kRefetchBatchSize;
+                 ++it) {
+                verify(!it->_id.eoo());
+                batch.push_back(*it);
+                ids.push_back(it->_id);
+            }
 
-            verify(!doc._id.eoo());
+            map<BSONElement, BSONObj> fetched;
+            for (const auto& good : rollbackSource.findByIds(NamespaceString(doc.ns), ids)) {
+                fetched[good["_id"]] = good;
+            }
 
-            {
-                // TODO : slow.  lots of round trips.
+            for (const auto& docId : batch) {
+                doc = docId;
                 numFetched++;
-                BSONObj good = rollbackSource.findOne(NamespaceString(doc.ns), doc._id.wrap());
+                auto fetchedIt = fetched.find(docId._id);
+                // note good might be empty, indicating we should delete it
+                BSONObj good = fetchedIt == fetched.end() ? BSONObj() : fetchedIt->second;
                 totalSize += good.objsize();
                 uassert(13410, "replSet too much data to roll back", totalSize < 300 * 1024 * 1024);
 
-                // note good might be eoo, indicating we should delete it
-                goodVersions.push_back(pair<DocID, BSONObj>(doc, good));
+                goodVersions.push_back(pair<DocID, BSONObj>(docId, good));
             }
         }
         newMinValid = rollbackSource.getLastOperation();
@@ -84,6 +84,8 @@ public:
     const OplogInterface& getOplog() const override;
     BSONObj getLastOperation() const override;
     BSONObj findOne(const NamespaceString& nss, const BSONObj& filter) const override;
+    std::vector<BSONObj> findByIds(const NamespaceString& nss,
+                                   const std::vector<BSONElement>& ids) const override;
     void copyCollectionFromRemote(OperationContext* txn, const NamespaceString& nss) const override;
     StatusWith<BSONObj> getCollectionInfo(const NamespaceString& nss) const override;
 
@@ -113,6 +115,18 @@ BSONObj RollbackSourceMock::findOne(const NamespaceString& nss, const BSONObj& f
     return BSONObj();
 }
 
+std::vector<BSONObj> RollbackSourceMock::findByIds(const NamespaceString& nss,
+                                                   const std::vector<BSONElement>& ids) const {
+    std::vector<BSONObj> docs;
+    for (const auto& id : ids) {
+        BSONObj doc = findOne(nss, id.wrap());
+        if (!doc.isEmpty()) {
+            docs.push_back(doc);
+        }
+    }
+    return docs;
+}
+
 void RollbackSourceMock::copyCollectionFromRemote(OperationContext* txn,
                                                   const NamespaceString& nss) const {}
 
@@ -379,6 +393,61 @@ TEST_F(RSRollbackTest, RollBackDeleteRestoreDocument) {
     ASSERT_EQUALS(1, _testRollBackDelete(_txn.get(), _coordinator, doc));
 }
 
+TEST_F(RSRollbackTest, RollBackDeletesRefetchesDocumentsInOneBatch) {
+    createOplog(_txn.get());
+    _createCollection(_txn.get(), "test.t", CollectionOptions());
+    auto commonOperation =
+        std::make_pair(BSON("ts" << Timestamp(Seconds(1), 0) << "h" << 1LL), RecordId(1));
+    auto makeDeleteOperation = [](int id) {
+        return std::make_pair(BSON("ts" << Timestamp(Seconds(id + 2), 0) << "h" << 1LL << "op"
+                                        << "d"
+                                        << "ns"
+                                        << "test.t"
+                                        << "o" << BSON("_id" << id)),
+                              RecordId(id + 2));
+    };
+    class RollbackSourceLocal : public RollbackSourceMock {
+    public:
+        RollbackSourceLocal(std::unique_ptr<OplogInterface> oplog)
+            : RollbackSourceMock(std::move(oplog)) {}
+        std::vector<BSONObj> findByIds(const NamespaceString& nss,
+                                       const std::vector<BSONElement>& ids) const override {
+            ++calls;
+            std::vector<BSONObj> docs;
+            // Document 1 no longer exists at the source.
+            for (const auto& id : ids) {
+                if (id.numberInt() != 1) {
+                    docs.push_back(BSON("_id" << id.numberInt() << "a" << 1));
+                }
+            }
+            return docs;
+        }
+        mutable int calls = 0;
+    };
+    RollbackSourceLocal rollbackSource(std::unique_ptr<OplogInterface>(new OplogInterfaceMock({
+        commonOperation,
+    })));
+    auto lastOperation = makeDeleteOperation(2);
+    OpTime opTime(lastOperation.first["ts"].timestamp(), lastOperation.first["h"].Long());
+    ASSERT_OK(syncRollback(
+        _txn.get(),
+        opTime,
+        OplogInterfaceMock(
+            {lastOperation, makeDeleteOperation(1), makeDeleteOperation(0), commonOperation}),
+        rollbackSource,
+        _coordinator,
+        noSleep));
+    ASSERT_EQUALS(1, rollbackSource.calls);
+
+    Lock::DBLock dbLock(_txn->lockState(), "test", MODE_S);
+    Lock::CollectionLock collLock(_txn->lockState(), "test.t", MODE_S);
+    auto db = dbHolder().get(_txn.get(), "test");
+    ASSERT_TRUE(db);
+    auto collection = db->getCollection("test.t");
+    ASSERT_TRUE(collection);
+    ASSERT_EQUALS(2, collection->getRecordStore()->numRecords(_txn.get()));
+}
+
 TEST_F(RSRollbackTest, RollbackUnknownCommand) {
     createOplog(_txn.get());
     auto commonOperation =
@@ -46,6 +46,7 @@
 #include "mongo/db/repl/replica_set_config.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/hostandport.h"
@@ -57,6 +58,14 @@ using std::string;
 
 namespace repl {
 
+namespace {
+
+// Minimum time between two replSetUpdatePosition commands sent for position changes. Changes that
+// arrive in the meantime are coalesced into the next command. Keepalives are not affected.
+MONGO_EXPORT_SERVER_PARAMETER(replUpdatePositionMinIntervalMillis, int, 0);
+
+}  // namespace
+
 void SyncSourceFeedback::_resetConnection() {
     LOG(1) << "resetting connection in sync source feedback";
     _connection.reset();
@@ -171,11 +180,20 @@ void SyncSourceFeedback::run() {
                 }
             }
 
+            if (_positionChanged) {
+                const Date_t nextUpdateDate =
+                    _lastUpdateDate + Milliseconds(replUpdatePositionMinIntervalMillis);
+                while (!_shutdownSignaled && Date_t::now() < nextUpdateDate) {
+                    _cond.wait_until(lock, nextUpdateDate.toSystemTimePoint());
+                }
+            }
+
             if (_shutdownSignaled) {
                 break;
             }
 
             _positionChanged = false;
+            _lastUpdateDate = Date_t::now();
         }
 
         MemberState state = ReplicationCoordinator::get(txn.get())->getMemberState();
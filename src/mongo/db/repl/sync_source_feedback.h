@@ -34,6 +34,7 @@
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 class OperationContext;
@@ -82,7 +83,7 @@ private:
     HostAndPort _syncTarget;
     // our connection to our sync target
     std::unique_ptr<DBClientConnection> _connection;
-    // protects cond, _shutdownSignaled, _keepAliveInterval, and _positionChanged.
+    // protects cond, _shutdownSignaled, _keepAliveInterval, _positionChanged and _lastUpdateDate.
     stdx::mutex _mtx;
     // used to alert our thread of changes which need to be passed up the chain
     stdx::condition_variable _cond;
@@ -90,6 +91,8 @@ private:
     Milliseconds _keepAliveInterval = Milliseconds(100);
     // used to indicate a position change which has not yet been pushed along
     bool _positionChanged = false;
+    // when the last update was sent upstream, used to coalesce frequent position changes
+    Date_t _lastUpdateDate;
     // Once this is set to true the _run method will terminate
     bool _shutdownSignaled = false;
 };
@@ -54,16 +54,22 @@
 #include "mongo/db/repl/bgsync.h"
 #include "mongo/db/repl/minvalid.h"
 #include "mongo/db/repl/oplog.h"
+#include "mongo/db/repl/oplog_applier_stats.h"
 #include "mongo/db/repl/oplogreader.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replica_set_config.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_options.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/counters.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/string_map.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -100,8 +106,29 @@ public:
 } exportedWriterThreadCountParam;
 
 
+// Prefetching is always done for MMAP V1. Other engines only do it if this is set: it warms their
+// cache before the writers take their locks, at the cost of an extra lookup for each operation.
+MONGO_EXPORT_SERVER_PARAMETER(replPrefetchAllStorageEngines, bool, false);
+
+// When set, engines with document-level locking insert a batch into the oplog while the writer
+// threads apply it, and commit the inserts once the batch has been applied.
+MONGO_EXPORT_SERVER_PARAMETER(replPipelineOplogWrites, bool, false);
+
+// When set, each writer thread inserts a run of consecutive inserts into the same collection with
+// one call to Collection::insertDocuments() instead of applying them one at a time. A run that
+// cannot be inserted this way is applied one op at a time, so this is on by default.
+MONGO_EXPORT_SERVER_PARAMETER(replGroupInserts, bool, true);
+
 static Counter64 opsAppliedStats;
 
+// Number of runs of inserts applied with one batched insert, and the number of ops in those runs
+static Counter64 insertGroupsApplied;
+static ServerStatusMetricField<Counter64> displayInsertGroupsApplied("repl.apply.insertGroups",
+                                                                     &insertGroupsApplied);
+static Counter64 groupedInsertsApplied;
+static ServerStatusMetricField<Counter64> displayGroupedInsertsApplied(
+    "repl.apply.groupedInserts", &groupedInsertsApplied);
+
 // The oplog entries applied
 static ServerStatusMetricField<Counter64> displayOpsApplied("repl.apply.ops", &opsAppliedStats);
 
@@ -299,12 +326,11 @@ void prefetchOps(const std::deque<BSONObj>& ops, OldThreadPool* prefetcherPool)
     prefetcherPool->join();
 }
 
-// Doles out all the work to the writer pool threads and waits for them to complete
-void applyOps(const std::vector<std::vector<BSONObj>>& writerVectors,
-              OldThreadPool* writerPool,
-              SyncTail::MultiSyncApplyFunc func,
-              SyncTail* sync) {
-    TimerHolder timer(&applyBatchStats);
+// Doles out all the work to the writer pool threads without waiting for them to complete
+void scheduleApplyOps(const std::vector<std::vector<BSONObj>>& writerVectors,
+                      OldThreadPool* writerPool,
+                      SyncTail::MultiSyncApplyFunc func,
+                      SyncTail* sync) {
     for (std::vector<std::vector<BSONObj>>::const_iterator it = writerVectors.begin();
          it != writerVectors.end();
          ++it) {
@@ -312,11 +338,68 @@ void applyOps(const std::vector<std::vector<BSONObj>>& writerVectors,
             writerPool->schedule(func, stdx::cref(*it), sync);
         }
     }
+}
+
+// Doles out all the work to the writer pool threads and waits for them to complete
+void applyOps(const std::vector<std::vector<BSONObj>>& writerVectors,
+              OldThreadPool* writerPool,
+              SyncTail::MultiSyncApplyFunc func,
+              SyncTail* sync) {
+    TimerHolder timer(&applyBatchStats);
+    scheduleApplyOps(writerVectors, writerPool, func, sync);
     writerPool->join();
 }
 
-void fillWriterVectors(const std::deque<BSONObj>& ops,
+// The oplog can only be written while a batch is applied if no op of the batch needs stronger
+// locks than the writer threads take, since the oplog inserts hold an exclusive lock on the local
+// database until the batch has been applied.
+bool canPipelineOplogWrite(const std::deque<BSONObj>& ops) {
+    if (!replPipelineOplogWrites ||
+        !getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking()) {
+        return false;
+    }
+    for (std::deque<BSONObj>::const_iterator it = ops.begin(); it != ops.end(); ++it) {
+        const char* opType = it->getField("op").valuestrsafe();
+        if (!isCrudOpType(opType) && !(opType[0] == 'n' && opType[1] == 0)) {
+            return false;
+        }
+        if (nsToDatabaseSubstring(it->getStringField("ns")) == "local") {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns whether 'ns' is a capped collection, caching the answer in 'cappedCache' for the rest of
+ * the batch. A collection that does not exist yet is not capped: if the batch creates it, the
+ * create command is applied on its own before any of the CRUD ops that follow it.
+ */
+bool isCappedCollection(OperationContext* txn, StringData ns, StringMap<bool>* cappedCache) {
+    StringMap<bool>::const_iterator cached = cappedCache->find(ns);
+    if (cached != cappedCache->end()) {
+        return cached->second;
+    }
+
+    bool isCapped = false;
+    {
+        Lock::DBLock dbLock(txn->lockState(), nsToDatabaseSubstring(ns), MODE_IS);
+        Lock::CollectionLock collLock(txn->lockState(), ns, MODE_IS);
+        Database* db = dbHolder().get(txn, nsToDatabaseSubstring(ns));
+        Collection* collection = db ? db->getCollection(ns) : nullptr;
+        isCapped = collection && collection->isCapped();
+    }
+    (*cappedCache)[ns] = isCapped;
+    return isCapped;
+}
+
+void fillWriterVectors(OperationContext* txn,
+                       const std::deque<BSONObj>& ops,
                        std::vector<std::vector<BSONObj>>* writerVectors) {
+    const bool supportsDocLocking =
+        getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking();
+    StringMap<bool> cappedCache;
+
     for (std::deque<BSONObj>::const_iterator it = ops.begin(); it != ops.end(); ++it) {
         const BSONElement e = it->getField("ns");
         verify(e.type() == String);
@@ -327,8 +410,10 @@ void fillWriterVectors(const std::deque<BSONObj>& ops,
 
         const char* opType = it->getField("op").valuestrsafe();
 
-        if (getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking() &&
-            isCrudOpType(opType)) {
+        // Ops on a capped collection stay on one writer so that its documents keep the order
+        // they were inserted in on the primary.
+        if (supportsDocLocking && isCrudOpType(opType) &&
+            !isCappedCollection(txn, StringData(ns, len - 1), &cappedCache)) {
             BSONElement id;
             switch (opType[0]) {
                 case 'u':
@@ -364,14 +449,21 @@ OpTime SyncTail::multiApply(OperationContext* txn,
     invariant(func);
     invariant(sync);
 
-    if (getGlobalServiceContext()->getGlobalStorageEngine()->isMmapV1()) {
+    OplogApplierStats* stats = OplogApplierStats::get();
+
+    if (getGlobalServiceContext()->getGlobalStorageEngine()->isMmapV1() ||
+        replPrefetchAllStorageEngines) {
         // Use a ThreadPool to prefetch all the operations in a batch.
+        Timer prefetchTimer;
         prefetchOps(ops.getDeque(), prefetcherPool);
+        stats->recordPhase(OplogApplierStats::kPrefetch, prefetchTimer.micros());
     }
 
     std::vector<std::vector<BSONObj>> writerVectors(replWriterThreadCount);
 
-    fillWriterVectors(ops.getDeque(), &writerVectors);
+    Timer partitionTimer;
+    fillWriterVectors(txn, ops.getDeque(), &writerVectors);
+    stats->recordPhase(OplogApplierStats::kPartition, partitionTimer.micros());
     LOG(2) << "replication batch size is " << ops.getDeque().size() << endl;
     // We must grab this because we're going to grab write locks later.
     // We hold this mutex the entire time we're writing; it doesn't matter
@@ -387,22 +479,56 @@ OpTime SyncTail::multiApply(OperationContext* txn,
         fassertFailed(28527);
     }
 
-    applyOps(writerVectors, writerPool, func, sync);
-
-    if (inShutdown()) {
-        return OpTime();
-    }
-
     const bool mustWaitUntilDurable =
         replCoord->isV1ElectionProtocol() && supportsWaitingUntilDurable;
-    if (mustWaitUntilDurable) {
-        txn->recoveryUnit()->goingToWaitUntilDurable();
-    }
 
-    OpTime lastOpTime = writeOpsToOplog(txn, ops.getDeque());
+    OpTime lastOpTime;
+    if (canPipelineOplogWrite(ops.getDeque())) {
+        // Insert the batch into the oplog while the writers apply it. The inserts are only
+        // committed once every op has been applied, so the oplog never gets ahead of the data.
+        TimerHolder timer(&applyBatchStats);
+        Timer applyTimer;
+        scheduleApplyOps(writerVectors, writerPool, func, sync);
+        // The writers refer to 'writerVectors', so they must be done before it goes away.
+        ON_BLOCK_EXIT([writerPool] { writerPool->join(); });
+        if (mustWaitUntilDurable) {
+            txn->recoveryUnit()->goingToWaitUntilDurable();
+        }
+        lastOpTime = writeOpsToOplog(txn,
+                                     ops.getDeque(),
+                                     [writerPool, stats, &applyTimer] {
+                                         writerPool->join();
+                                         stats->recordPhase(OplogApplierStats::kApply,
+                                                            applyTimer.micros());
+                                         return !inShutdown();
+                                     });
+        stats->recordPhase(OplogApplierStats::kOplogWrite, applyTimer.micros());
+        if (lastOpTime.isNull()) {
+            // The writers may have stopped before applying every op.
+            return OpTime();
+        }
+    } else {
+        Timer applyTimer;
+        applyOps(writerVectors, writerPool, func, sync);
+        stats->recordPhase(OplogApplierStats::kApply, applyTimer.micros());
+
+        if (inShutdown()) {
+            return OpTime();
+        }
+
+        if (mustWaitUntilDurable) {
+            txn->recoveryUnit()->goingToWaitUntilDurable();
+        }
+
+        Timer oplogWriteTimer;
+        lastOpTime = writeOpsToOplog(txn, ops.getDeque());
+        stats->recordPhase(OplogApplierStats::kOplogWrite, oplogWriteTimer.micros());
+    }
 
     if (mustWaitUntilDurable) {
+        Timer durableTimer;
         txn->recoveryUnit()->waitUntilDurable();
+        stats->recordPhase(OplogApplierStats::kWaitUntilDurable, durableTimer.micros());
     }
     ReplClientInfo::forClient(txn->getClient()).setLastOp(lastOpTime);
     replCoord->setMyLastOptime(lastOpTime);
@@ -423,6 +549,7 @@ void SyncTail::_applyOplogUntil(OperationContext* txn, const OpTime& endOpTime)
     unsigned long long entriesApplied = 0;
     while (true) {
         OpQueue ops;
+        Timer fetchTimer;
 
         while (!tryPopAndWaitForMore(txn, &ops, getGlobalReplicationCoordinator())) {
             // nothing came back last time, so go again
@@ -453,6 +580,7 @@ void SyncTail::_applyOplogUntil(OperationContext* txn, const OpTime& endOpTime)
             severe() << "got no ops for batch...";
             fassertFailedNoTrace(18692);
         }
+        OplogApplierStats::get()->recordPhase(OplogApplierStats::kFetch, fetchTimer.micros());
 
         const BSONObj lastOp = ops.back().getOwned();
 
@@ -584,6 +712,7 @@ void SyncTail::oplogApplication() {
         if (ops.empty()) {
             continue;
         }
+        OplogApplierStats::get()->recordPhase(OplogApplierStats::kFetch, batchTimer.micros());
 
         const BSONObj lastOp = ops.back();
         handleSlaveDelay(lastOp);
@@ -830,6 +959,142 @@ static void initializeWriterThread() {
     }
 }
 
+namespace {
+
+// Limits on the size of a run of inserts applied with one call to Collection::insertDocuments().
+const size_t kMaxGroupedInserts = 64;
+const int kMaxGroupedInsertBytes = 256 * 1024;
+
+bool isGroupableInsert(const BSONObj& op) {
+    const char* opType = op.getField("op").valuestrsafe();
+    if (opType[0] != 'i' || opType[1] != 0) {
+        return false;
+    }
+    const StringData ns = op.getStringField("ns");
+    if (ns.empty() || nsToCollectionSubstring(ns) == "system.indexes") {
+        return false;
+    }
+    const BSONElement o = op.getField("o");
+    return o.type() == Object && o.Obj().hasField("_id");
+}
+
+/**
+ * Inserts the documents of the insert ops in [begin, end), which all target 'ns', in one
+ * WriteUnitOfWork. Returns false, having applied none of them, if the collection does not exist
+ * or is capped, or if the insert fails for any reason. The caller then applies each op on its own,
+ * which turns inserts of existing documents into updates.
+ */
+bool applyGroupedInserts(OperationContext* txn,
+                         StringData ns,
+                         std::vector<BSONObj>::const_iterator begin,
+                         std::vector<BSONObj>::const_iterator end) {
+    if (inShutdown()) {
+        return false;
+    }
+
+    std::vector<BSONObj> docs;
+    docs.reserve(std::distance(begin, end));
+    for (std::vector<BSONObj>::const_iterator it = begin; it != end; ++it) {
+        docs.push_back(it->getField("o").Obj());
+    }
+
+    try {
+        CurOp curOp(txn);
+        Lock::DBLock dbLock(txn->lockState(), nsToDatabaseSubstring(ns), MODE_IX);
+        Lock::CollectionLock collLock(txn->lockState(), ns, MODE_IX);
+        Database* db = dbHolder().get(txn, nsToDatabaseSubstring(ns));
+        Collection* collection = db ? db->getCollection(ns) : nullptr;
+        if (!collection || collection->isCapped()) {
+            return false;
+        }
+
+        WriteUnitOfWork wuow(txn);
+        if (!collection->insertDocuments(txn, docs.begin(), docs.end(), true).isOK()) {
+            return false;
+        }
+        wuow.commit();
+    } catch (const DBException& e) {
+        LOG(2) << "applying " << docs.size() << " grouped inserts into " << ns
+               << " one at a time after: " << causedBy(e);
+        return false;
+    }
+
+    for (size_t i = 0; i < docs.size(); ++i) {
+        replOpCounters.gotInsert();
+    }
+    opsAppliedStats.increment(docs.size());
+    insertGroupsApplied.increment();
+    groupedInsertsApplied.increment(docs.size());
+    return true;
+}
+
+/**
+ * If '*it' starts a run of inserts into one collection, tries to apply the whole run with
+ * applyGroupedInserts(). On success, advances '*it' to the last op of the run and returns true.
+ * Otherwise leaves '*it' alone and returns false, and the caller applies '**it' on its own.
+ */
+bool applyInsertGroupStartingAt(OperationContext* txn,
+                                const std::vector<BSONObj>& ops,
+                                std::vector<BSONObj>::const_iterator* it) {
+    if (!replGroupInserts || !isGroupableInsert(**it)) {
+        return false;
+    }
+
+    const StringData ns = (*it)->getStringField("ns");
+    std::vector<BSONObj>::const_iterator end = *it + 1;
+    int groupBytes = (*it)->objsize();
+    while (end != ops.end() && static_cast<size_t>(end - *it) < kMaxGroupedInserts &&
+           groupBytes + end->objsize() <= kMaxGroupedInsertBytes && isGroupableInsert(*end) &&
+           ns == end->getStringField("ns")) {
+        groupBytes += end->objsize();
+        ++end;
+    }
+
+    if (end - *it < 2 || !applyGroupedInserts(txn, ns, *it, end)) {
+        return false;
+    }
+    *it = end - 1;
+    return true;
+}
+
+/**
+ * Records the time it took to apply the ops in [first, last], a single op or a group of inserts,
+ * and logs them like the slow query log if it took longer than the slow operation threshold.
+ */
+void recordAppliedOps(std::vector<BSONObj>::const_iterator first,
+                      std::vector<BSONObj>::const_iterator last,
+                      long long micros) {
+    OplogApplierStats* stats = OplogApplierStats::get();
+    stats->recordOp(micros);
+    if (micros / 1000 <= serverGlobalParams.slowMS) {
+        return;
+    }
+    stats->recordSlowOp();
+
+    const BSONObj& op = *first;
+    mongoutils::str::stream ss;
+    ss << "applied";
+    if (first != last) {
+        ss << " " << (last - first + 1) << " grouped";
+    }
+    ss << " op: " << op.getStringField("op") << " ns: " << op.getStringField("ns");
+    switch (op.getStringField("op")[0]) {
+        case 'u':
+            ss << " " << op["o2"];
+            break;
+        case 'i':
+        case 'd':
+            ss << " " << op["o"]["_id"];
+            break;
+        case 'c':
+            ss << " " << op["o"];
+            break;
+    }
+    log() << std::string(ss) << " " << micros / 1000 << "ms";
+}
+
+}  // namespace
+
 // This free function is used by the writer threads to apply each op
 void multiSyncApply(const std::vector<BSONObj>& ops, SyncTail* st) {
     initializeWriterThread();
@@ -843,13 +1108,22 @@ void multiSyncApply(const std::vector<BSONObj>& ops, SyncTail* st) {
 
     bool convertUpdatesToUpserts = true;
 
+    Timer writerTimer;
     for (std::vector<BSONObj>::const_iterator it = ops.begin(); it != ops.end(); ++it) {
+        Timer opTimer;
+        const std::vector<BSONObj>::const_iterator first = it;
+        if (applyInsertGroupStartingAt(&txn, ops, &it)) {
+            recordAppliedOps(first, it, opTimer.micros());
+            continue;
+        }
+
         try {
             const Status s = SyncTail::syncApply(&txn, *it, convertUpdatesToUpserts);
             if (!s.isOK()) {
                 severe() << "Error applying operation (" << it->toString() << "): " << s;
                 fassertFailedNoTrace(16359);
             }
+            recordAppliedOps(it, it, opTimer.micros());
         } catch (const DBException& e) {
             severe() << "writer worker caught exception: " << causedBy(e)
                      << " on: " << it->toString();
@@ -861,6 +1135,7 @@ void multiSyncApply(const std::vector<BSONObj>& ops, SyncTail* st) {
             fassertFailedNoTrace(16360);
         }
     }
+    OplogApplierStats::get()->recordWriter(writerTimer.micros());
 }
 
 // This free function is used by the initial sync writer threads to apply each op
@@ -876,7 +1151,15 @@ void multiInitialSyncApply(const std::vector<BSONObj>& ops, SyncTail* st) {
 
     bool convertUpdatesToUpserts = false;
 
+    Timer writerTimer;
     for (std::vector<BSONObj>::const_iterator it = ops.begin(); it != ops.end(); ++it) {
+        Timer opTimer;
+        const std::vector<BSONObj>::const_iterator first = it;
+        if (applyInsertGroupStartingAt(&txn, ops, &it)) {
+            recordAppliedOps(first, it, opTimer.micros());
+            continue;
+        }
+
         try {
             const Status s = SyncTail::syncApply(&txn, *it, convertUpdatesToUpserts);
             if (!s.isOK()) {
@@ -892,6 +1175,7 @@ void multiInitialSyncApply(const std::vector<BSONObj>& ops, SyncTail* st) {
                 // This can happen if the document that was moved and missed by Cloner
                 // subsequently got deleted and no longer exists on the Sync Target at all
             }
+            recordAppliedOps(it, it, opTimer.micros());
         } catch (const DBException& e) {
             severe() << "writer worker caught exception: " << causedBy(e)
                      << " on: " << it->toString();
@@ -903,6 +1187,7 @@ void multiInitialSyncApply(const std::vector<BSONObj>& ops, SyncTail* st) {
             fassertFailedNoTrace(16361);
         }
     }
+    OplogApplierStats::get()->recordWriter(writerTimer.micros());
 }
 
 }  // namespace repl
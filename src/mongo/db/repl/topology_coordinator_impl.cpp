@@ -193,7 +193,8 @@ HostAndPort TopologyCoordinatorImpl::chooseNewSyncSource(Date_t now,
         }
     }
 
-    // find the member with the lowest ping time that is ahead of me
+    // find the member with the best rank (lowest ping time, plus the lag penalty) that is ahead
+    // of me
 
     // choose a time that will exclude no candidates by default, in case we don't see a primary
     OpTime oldestSyncOpTime;
@@ -213,13 +214,19 @@ HostAndPort TopologyCoordinatorImpl::chooseNewSyncSource(Date_t now,
         }
     }
 
+    const OpTime freshestOpTime = _getFreshestKnownOpTime();
+    const int previousIndex =
+        _syncSource.empty() ? -1 : _rsConfig.findMemberIndexByHostAndPort(_syncSource);
     int closestIndex = -1;
+    Milliseconds closestRank{0};
 
     // Make two attempts.  The first attempt, we ignore those nodes with
     // slave delay higher than our own, hidden nodes, and nodes that are excessively lagged.
     // The second attempt includes such nodes, in case those are the only ones we can reach.
     // This loop attempts to set 'closestIndex'.
     for (int attempts = 0; attempts < 2; ++attempts) {
+        bool previousIsCandidate = false;
+        Milliseconds previousRank{0};
         for (std::vector<MemberHeartbeatData>::const_iterator it = _hbdata.begin();
              it != _hbdata.end();
              ++it) {
@@ -261,13 +268,6 @@ HostAndPort TopologyCoordinatorImpl::chooseNewSyncSource(Date_t now,
                 continue;
             }
 
-            // omit nodes that are more latent than anything we've already considered
-            if ((closestIndex != -1) &&
-                (_getPing(itMemberConfig.getHostAndPort()) >
-                 _getPing(_rsConfig.getMemberAt(closestIndex).getHostAndPort()))) {
-                continue;
-            }
-
             if (attempts == 0) {
                 if (_selfConfig().getSlaveDelay() < itMemberConfig.getSlaveDelay() ||
                     itMemberConfig.isHidden()) {
@@ -279,8 +279,26 @@ HostAndPort TopologyCoordinatorImpl::chooseNewSyncSource(Date_t now,
                 continue;
             }
 
+            const Milliseconds rank = _getSyncSourceRank(itIndex, freshestOpTime);
+            if (itIndex == previousIndex) {
+                previousIsCandidate = true;
+                previousRank = rank;
+            }
+
+            // omit nodes that rank worse than anything we've already considered
+            if (closestIndex != -1 && rank > closestRank) {
+                continue;
+            }
+
             // This candidate has passed all tests; set 'closestIndex'
             closestIndex = itIndex;
+            closestRank = rank;
+        }
+
+        // Stay with the sync source we had unless the best candidate is clearly better.
+        if (_options.syncSourceChangeHysteresis > Milliseconds(0) && previousIsCandidate &&
+            previousRank <= closestRank + _options.syncSourceChangeHysteresis) {
+            closestIndex = previousIndex;
         }
         if (closestIndex != -1)
             break;  // no need for second attempt
@@ -2090,6 +2108,32 @@ Milliseconds TopologyCoordinatorImpl::_getPing(const HostAndPort& host) {
     return _pings[host].getMillis();
 }
 
+OpTime TopologyCoordinatorImpl::_getFreshestKnownOpTime() const {
+    if (_currentPrimaryIndex != -1) {
+        return _hbdata[_currentPrimaryIndex].getOpTime();
+    }
+    OpTime freshest;
+    for (std::vector<MemberHeartbeatData>::const_iterator it = _hbdata.begin(); it != _hbdata.end();
+         ++it) {
+        if (it->up() && it->getOpTime() > freshest) {
+            freshest = it->getOpTime();
+        }
+    }
+    return freshest;
+}
+
+Milliseconds TopologyCoordinatorImpl::_getSyncSourceRank(int memberIndex,
+                                                         const OpTime& freshestOpTime) const {
+    PingMap::const_iterator ping = _pings.find(_rsConfig.getMemberAt(memberIndex).getHostAndPort());
+    Milliseconds rank = ping == _pings.end() ? UninitializedPing : ping->second.getMillis();
+
+    const unsigned int memberSecs = _hbdata[memberIndex].getOpTime().getSecs();
+    if (freshestOpTime.getSecs() > memberSecs) {
+        rank += _options.syncSourceLagPenaltyPerSec * (freshestOpTime.getSecs() - memberSecs);
+    }
+    return rank;
+}
+
 void TopologyCoordinatorImpl::_setElectionTime(const Timestamp& newElectionTime) {
     _electionTime = newElectionTime;
 }
@@ -2354,6 +2398,39 @@ bool TopologyCoordinatorImpl::shouldChangeSyncSource(const HostAndPort& currentS
             return true;
         }
     }
+
+    // Also change if another member ranks better than currentSource by more than the hysteresis,
+    // so that a slow or lagging sync source is replaced without flapping between members that
+    // rank about the same. Without chaining we always sync from the primary, so there is nothing
+    // to switch to.
+    if (_options.syncSourceChangeHysteresis <= Milliseconds(0) || !_rsConfig.isChainingAllowed()) {
+        return false;
+    }
+    const OpTime freshestOpTime = _getFreshestKnownOpTime();
+    const Milliseconds currentRank = _getSyncSourceRank(currentMemberIndex, freshestOpTime);
+    for (std::vector<MemberHeartbeatData>::const_iterator it = _hbdata.begin(); it != _hbdata.end();
+         ++it) {
+        const int itIndex = indexOfIterator(_hbdata, it);
+        if (itIndex == _selfIndex || itIndex == currentMemberIndex) {
+            continue;
+        }
+        const MemberConfig& candidateConfig = _rsConfig.getMemberAt(itIndex);
+        if (it->up() && (candidateConfig.isVoter() || !_selfConfig().isVoter()) &&
+            (candidateConfig.shouldBuildIndexes() || !_selfConfig().shouldBuildIndexes()) &&
+            it->getState().readable() && !_memberIsBlacklisted(candidateConfig, now) &&
+            !candidateConfig.isHidden() &&
+            candidateConfig.getSlaveDelay() <= _selfConfig().getSlaveDelay() &&
+            it->getOpTime() >= currentOpTime) {
+            const Milliseconds candidateRank = _getSyncSourceRank(itIndex, freshestOpTime);
+            if (candidateRank + _options.syncSourceChangeHysteresis < currentRank) {
+                log() << "changing sync target because member "
+                      << candidateConfig.getHostAndPort().toString() << " ranks "
+                      << candidateRank << " against " << currentRank << " for the current one, "
+                      << currentSource.toString();
+                return true;
+            }
+        }
+    }
     return false;
 }
 
@@ -126,6 +126,15 @@ public:
         // A sync source is re-evaluated after it lags behind further than this amount.
         Seconds maxSyncSourceLagSecs{0};
 
+        // Sync source candidates are ranked by their heartbeat round trip time plus this much for
+        // each second that their last optime is behind the freshest optime we know of.
+        Milliseconds syncSourceLagPenaltyPerSec{0};
+
+        // When non-zero, we switch to a candidate whose rank is better than the current sync
+        // source's by more than this, and keep the current sync source when choosing a new one if
+        // its rank is within this of the best candidate's.
+        Milliseconds syncSourceChangeHysteresis{0};
+
         // Whether or not this node is running as a config server, and if so whether it was started
         // with --configsvrMode=SCCC.
         CatalogManager::ConfigServerMode configServerMode{CatalogManager::ConfigServerMode::NONE};
@@ -285,6 +294,14 @@ private:
     // Returns the current "ping" value for the given member by their address
     Milliseconds _getPing(const HostAndPort& host);
 
+    // Returns the optime of the primary if it is known, and otherwise the latest optime of any
+    // member that is up.
+    OpTime _getFreshestKnownOpTime() const;
+
+    // Returns the rank of the member at "memberIndex" as a sync source, given the freshest optime
+    // we know of. Lower is better. See Options::syncSourceLagPenaltyPerSec.
+    Milliseconds _getSyncSourceRank(int memberIndex, const OpTime& freshestOpTime) const;
+
     // Determines if we will veto the member specified by "args.id", given that the last op
     // we have applied locally is "lastOpApplied".
     // If we veto, the errmsg will be filled in with a reason
@@ -299,6 +299,102 @@ TEST_F(TopoCoordTest, ChooseSyncSourceBasic) {
     ASSERT_EQUALS(HostAndPort("h3"), getTopoCoord().getSyncSourceAddress());
 }
 
+TEST_F(TopoCoordTest, ChooseSyncSourcePenalizesLaggingMembers) {
+    TopologyCoordinatorImpl::Options options;
+    options.maxSyncSourceLagSecs = Seconds{100};
+    options.syncSourceLagPenaltyPerSec = Milliseconds{10};
+    setOptions(options);
+
+    updateConfig(BSON("_id"
+                      << "rs0"
+                      << "version" << 1 << "members"
+                      << BSON_ARRAY(BSON("_id" << 10 << "host"
+                                               << "hself")
+                                    << BSON("_id" << 20 << "host"
+                                                  << "h2") << BSON("_id" << 30 << "host"
+                                                                         << "h3"))),
+                 0);
+    setSelfMemberState(MemberState::RS_SECONDARY);
+
+    // h2 is closer, but 50 seconds behind h3, which costs it 500ms.
+    for (int i = 0; i < 2; ++i) {
+        heartbeatFromMember(HostAndPort("h2"),
+                            "rs0",
+                            MemberState::RS_SECONDARY,
+                            OpTime(Timestamp(50, 0), 0),
+                            Milliseconds(10));
+        heartbeatFromMember(HostAndPort("h3"),
+                            "rs0",
+                            MemberState::RS_SECONDARY,
+                            OpTime(Timestamp(100, 0), 0),
+                            Milliseconds(100));
+    }
+    getTopoCoord().chooseNewSyncSource(now()++, Timestamp());
+    ASSERT_EQUALS(HostAndPort("h3"), getTopoCoord().getSyncSourceAddress());
+
+    // Once h2 catches up, its lower round trip time wins.
+    heartbeatFromMember(HostAndPort("h2"),
+                        "rs0",
+                        MemberState::RS_SECONDARY,
+                        OpTime(Timestamp(100, 0), 0),
+                        Milliseconds(10));
+    getTopoCoord().chooseNewSyncSource(now()++, Timestamp());
+    ASSERT_EQUALS(HostAndPort("h2"), getTopoCoord().getSyncSourceAddress());
+}
+
+TEST_F(TopoCoordTest, SyncSourceChangesOnlyWhenAnotherMemberRanksBetterByTheHysteresis) {
+    TopologyCoordinatorImpl::Options options;
+    options.maxSyncSourceLagSecs = Seconds{100};
+    options.syncSourceLagPenaltyPerSec = Milliseconds{1};
+    options.syncSourceChangeHysteresis = Milliseconds{20};
+    setOptions(options);
+
+    updateConfig(BSON("_id"
+                      << "rs0"
+                      << "version" << 1 << "members"
+                      << BSON_ARRAY(BSON("_id" << 10 << "host"
+                                               << "hself")
+                                    << BSON("_id" << 20 << "host"
+                                                  << "h2") << BSON("_id" << 30 << "host"
+                                                                         << "h3"))),
+                 0);
+    setSelfMemberState(MemberState::RS_SECONDARY);
+
+    auto heartbeats = [this](unsigned int h2Secs, unsigned int h3Secs) {
+        heartbeatFromMember(HostAndPort("h2"),
+                            "rs0",
+                            MemberState::RS_SECONDARY,
+                            OpTime(Timestamp(h2Secs, 0), 0),
+                            Milliseconds(10));
+        heartbeatFromMember(HostAndPort("h3"),
+                            "rs0",
+                            MemberState::RS_SECONDARY,
+                            OpTime(Timestamp(h3Secs, 0), 0),
+                            Milliseconds(10));
+    };
+
+    // The members rank the same, and the last one considered is chosen.
+    heartbeats(100, 100);
+    heartbeats(100, 100);
+    getTopoCoord().chooseNewSyncSource(now()++, Timestamp());
+    ASSERT_EQUALS(HostAndPort("h3"), getTopoCoord().getSyncSourceAddress());
+
+    // h3 falls 10 seconds behind h2, which is within the hysteresis, so we keep syncing from it.
+    heartbeats(110, 100);
+    ASSERT_FALSE(getTopoCoord().shouldChangeSyncSource(HostAndPort("h3"), now()));
+    getTopoCoord().chooseNewSyncSource(now()++, Timestamp());
+    ASSERT_EQUALS(HostAndPort("h3"), getTopoCoord().getSyncSourceAddress());
+
+    // h3 falls 50 seconds behind h2, which is more than the hysteresis.
+    heartbeats(150, 100);
+    startCapturingLogMessages();
+    ASSERT_TRUE(getTopoCoord().shouldChangeSyncSource(HostAndPort("h3"), now()));
+    stopCapturingLogMessages();
+    ASSERT_EQUALS(1, countLogLinesContaining("changing sync target because member h2:27017"));
+    getTopoCoord().chooseNewSyncSource(now()++, Timestamp());
+    ASSERT_EQUALS(HostAndPort("h2"), getTopoCoord().getSyncSourceAddress());
+}
+
 TEST_F(TopoCoordTest, ChooseSyncSourceCandidates) {
     updateConfig(BSON("_id"
                       << "rs0"
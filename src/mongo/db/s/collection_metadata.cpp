@@ -32,7 +32,10 @@
 
 #include "mongo/db/s/collection_metadata.h"
 
+#include <algorithm>
+
 #include "mongo/bson/util/builder.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
@@ -45,6 +48,37 @@ using std::string;
 using std::vector;
 using str::stream;
 
+namespace {
+
+// Shard keys compare in ascending order on all of their fields
+const Ordering kRangeBoundsOrdering = Ordering::make(BSONObj());
+
+/**
+ * Encodes the shard key 'key' into 'out'. KeyStrings are built from index keys, which have no
+ * field names.
+ */
+void encodeKey(const BSONObj& key, KeyString* out) {
+    BSONObjBuilder indexKey;
+    BSONObjIterator it(key);
+    while (it.more()) {
+        indexKey.appendAs(it.next(), "");
+    }
+    out->resetToKey(indexKey.done(), kRangeBoundsOrdering);
+}
+
+/**
+ * Returns the first of the encoded range bounds which is greater than 'key'.
+ */
+vector<string>::const_iterator upperBound(const vector<string>& rangeBounds,
+                                          const KeyString& key) {
+    return std::upper_bound(rangeBounds.begin(),
+                            rangeBounds.end(),
+                            StringData(key.getBuffer(), key.getSize()),
+                            [](StringData lhs, const string& rhs) { return lhs < rhs; });
+}
+
+}  // namespace
+
 CollectionMetadata::CollectionMetadata() = default;
 
 CollectionMetadata::~CollectionMetadata() = default;
@@ -195,6 +229,7 @@ CollectionMetadata* CollectionMetadata::cloneMinusPending(const ChunkType& pendi
     metadata->_pendingMap.erase(pending.getMin());
     metadata->_chunksMap = this->_chunksMap;
     metadata->_rangesMap = this->_rangesMap;
+    metadata->_rangeBounds = this->_rangeBounds;
     metadata->_shardVersion = _shardVersion;
     metadata->_collVersion = _collVersion;
 
@@ -229,6 +264,7 @@ CollectionMetadata* CollectionMetadata::clonePlusPending(const ChunkType& pendin
     metadata->_pendingMap = this->_pendingMap;
     metadata->_chunksMap = this->_chunksMap;
     metadata->_rangesMap = this->_rangesMap;
+    metadata->_rangeBounds = this->_rangeBounds;
     metadata->_shardVersion = _shardVersion;
     metadata->_collVersion = _collVersion;
 
@@ -400,6 +436,7 @@ CollectionMetadata* CollectionMetadata::cloneMerge(const BSONObj& minKey,
     metadata->_pendingMap = this->_pendingMap;
     metadata->_chunksMap = this->_chunksMap;
     metadata->_rangesMap = this->_rangesMap;
+    metadata->_rangeBounds = this->_rangeBounds;
     metadata->_shardVersion = newShardVersion;
     metadata->_collVersion = newShardVersion > _collVersion ? newShardVersion : this->_collVersion;
 
@@ -446,6 +483,32 @@ bool CollectionMetadata::keyBelongsToMe(const BSONObj& key) const {
     return good;
 }
 
+bool CollectionMetadata::keyStringBelongsToMe(const BSONObj& key, KeyString* scratch) const {
+    if (_keyPattern.isEmpty()) {
+        return true;
+    }
+
+    encodeKey(key, scratch);
+    return (upperBound(_rangeBounds, *scratch) - _rangeBounds.begin()) % 2 == 1;
+}
+
+bool CollectionMetadata::rangeBelongsToMe(const BSONObj& min, const BSONObj& max) const {
+    if (_keyPattern.isEmpty()) {
+        return true;
+    }
+
+    KeyString scratch;
+    encodeKey(min, &scratch);
+    const auto rangeEnd = upperBound(_rangeBounds, scratch);
+    if ((rangeEnd - _rangeBounds.begin()) % 2 == 0) {
+        return false;
+    }
+
+    // 'min' is in the range which ends at 'rangeEnd', so 'max' must be below it
+    encodeKey(max, &scratch);
+    return StringData(scratch.getBuffer(), scratch.getSize()) < *rangeEnd;
+}
+
 bool CollectionMetadata::keyIsPending(const BSONObj& key) const {
     // If we aren't sharded, then the key is never pending (though it belongs-to-me)
     if (_keyPattern.isEmpty()) {
@@ -709,6 +772,22 @@ void CollectionMetadata::fillRanges() {
     dassert(!min.isEmpty());
 
     _rangesMap.insert(make_pair(min, max));
+
+    _rangeBounds.clear();
+    KeyString encoded;
+    for (const auto& range : _rangesMap) {
+        encodeKey(range.first, &encoded);
+        string encodedMin(encoded.getBuffer(), encoded.getSize());
+        if (!_rangeBounds.empty() && _rangeBounds.back() == encodedMin) {
+            // Bounds such as 10 and 10.0 differ as BSON but compare equal
+            _rangeBounds.pop_back();
+        } else {
+            _rangeBounds.push_back(std::move(encodedMin));
+        }
+
+        encodeKey(range.second, &encoded);
+        _rangeBounds.emplace_back(encoded.getBuffer(), encoded.getSize());
+    }
 }
 
 void CollectionMetadata::fillKeyPatternFields() {
@@ -39,6 +39,7 @@
 namespace mongo {
 
 class ChunkType;
+class KeyString;
 class MetadataLoader;
 class CollectionMetadata;
 
@@ -146,6 +147,20 @@ public:
      */
     bool keyBelongsToMe(const BSONObj& key) const;
 
+    /**
+     * Same as keyBelongsToMe, but binary searches the KeyString encoded bounds of the ranges of
+     * contiguous chunks instead of comparing BSON keys. 'scratch' receives the encoded key, so
+     * a caller checking many keys can keep reusing its buffer.
+     */
+    bool keyStringBelongsToMe(const BSONObj& key, KeyString* scratch) const;
+
+    /**
+     * Returns true if every key from 'min' to 'max', both included, belongs to this chunkset,
+     * that is if they fall in the same range of contiguous chunks. Keys must be full shard keys
+     * and 'min' must not be greater than 'max'.
+     */
+    bool rangeBelongsToMe(const BSONObj& min, const BSONObj& max) const;
+
     /**
      * Returns true if the document key 'key' is or has been migrated to this shard, and may
      * belong to us after a subsequent config reload.  Key must be the full shard key.
@@ -299,13 +314,20 @@ private:
     // installations.
     RangeMap _rangesMap;
 
+    // The bounds of the ranges in _rangesMap encoded as KeyStrings, in order: the min and
+    // max of the first range, then of the second one, and so on. Ranges which only touch
+    // once encoded are coalesced, so the array is strictly increasing and a key belongs to
+    // the chunkset when an odd number of bounds are not greater than it.
+    std::vector<std::string> _rangeBounds;
+
     /**
      * Returns true if this metadata was loaded with all necessary information.
      */
     bool isValid() const;
 
     /**
-     * Try to find chunks that are adjacent and record these intervals in the _rangesMap
+     * Try to find chunks that are adjacent and record these intervals in the _rangesMap and
+     * _rangeBounds
      */
     void fillRanges();
 
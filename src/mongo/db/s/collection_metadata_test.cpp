@@ -35,6 +35,7 @@
 #include "mongo/db/operation_context_noop.h"
 #include "mongo/db/s/collection_metadata.h"
 #include "mongo/db/s/metadata_loader.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/dbtests/mock/mock_conn_registry.h"
 #include "mongo/dbtests/mock/mock_remote_db_server.h"
 #include "mongo/s/catalog/legacy/catalog_manager_legacy.h"
@@ -511,6 +512,27 @@ TEST_F(SingleChunkFixture, DoesntBelongsToMe) {
     ASSERT_FALSE(getCollMetadata().keyBelongsToMe(BSON("a" << MAXKEY)));
 }
 
+TEST_F(SingleChunkFixture, KeyStringBelongsToMe) {
+    KeyString scratch;
+    ASSERT(getCollMetadata().keyStringBelongsToMe(BSON("a" << 10), &scratch));
+    ASSERT(getCollMetadata().keyStringBelongsToMe(BSON("a" << 10.0), &scratch));
+    ASSERT(getCollMetadata().keyStringBelongsToMe(BSON("a" << 15), &scratch));
+    ASSERT(getCollMetadata().keyStringBelongsToMe(BSON("a" << 19.5), &scratch));
+    ASSERT_FALSE(getCollMetadata().keyStringBelongsToMe(BSON("a" << 9), &scratch));
+    ASSERT_FALSE(getCollMetadata().keyStringBelongsToMe(BSON("a" << 20), &scratch));
+    ASSERT_FALSE(getCollMetadata().keyStringBelongsToMe(BSON("a" << 20LL), &scratch));
+    ASSERT_FALSE(getCollMetadata().keyStringBelongsToMe(BSON("a" << MINKEY), &scratch));
+    ASSERT_FALSE(getCollMetadata().keyStringBelongsToMe(BSON("a" << MAXKEY), &scratch));
+}
+
+TEST_F(SingleChunkFixture, RangeBelongsToMe) {
+    ASSERT(getCollMetadata().rangeBelongsToMe(BSON("a" << 10), BSON("a" << 19)));
+    ASSERT(getCollMetadata().rangeBelongsToMe(BSON("a" << 12), BSON("a" << 12)));
+    ASSERT_FALSE(getCollMetadata().rangeBelongsToMe(BSON("a" << 10), BSON("a" << 20)));
+    ASSERT_FALSE(getCollMetadata().rangeBelongsToMe(BSON("a" << 5), BSON("a" << 15)));
+    ASSERT_FALSE(getCollMetadata().rangeBelongsToMe(BSON("a" << MINKEY), BSON("a" << MAXKEY)));
+}
+
 TEST_F(SingleChunkFixture, CompoudKeyBelongsToMe) {
     ASSERT(getCollMetadata().keyBelongsToMe(BSON("a" << 15 << "a" << 14)));
 }
@@ -650,6 +672,9 @@ TEST_F(SingleChunkFixture, SingleSplit) {
     ASSERT(chunk.getMax().woCompare(BSON("a" << 20)) == 0);
 
     ASSERT_FALSE(cloned->getNextChunk(BSON("a" << 20), &chunk));
+
+    // The two chunks still make up a single range
+    ASSERT(cloned->rangeBelongsToMe(BSON("a" << 10), BSON("a" << 19)));
 }
 
 TEST_F(SingleChunkFixture, MultiSplit) {
@@ -886,6 +911,17 @@ private:
     CollectionMetadata _metadata;
 };
 
+TEST_F(TwoChunksWithGapCompoundKeyFixture, RangeBelongsToMe) {
+    ASSERT(getCollMetadata().rangeBelongsToMe(BSON("a" << 10 << "b" << 0),
+                                              BSON("a" << 19 << "b" << MAXKEY)));
+    ASSERT(getCollMetadata().rangeBelongsToMe(BSON("a" << 30 << "b" << 0),
+                                              BSON("a" << 39 << "b" << 0)));
+    ASSERT_FALSE(getCollMetadata().rangeBelongsToMe(BSON("a" << 10 << "b" << MINKEY),
+                                                    BSON("a" << 15 << "b" << 0)));
+    ASSERT_FALSE(getCollMetadata().rangeBelongsToMe(BSON("a" << 15 << "b" << 0),
+                                                    BSON("a" << 35 << "b" << 0)));
+}
+
 TEST_F(TwoChunksWithGapCompoundKeyFixture, ClonePlusBasic) {
     ChunkType chunk;
     chunk.setMin(BSON("a" << 40 << "b" << 0));
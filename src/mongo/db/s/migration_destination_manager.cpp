@@ -35,6 +35,7 @@
 #include <list>
 #include <vector>
 
+#include "mongo/base/counter.h"
 #include "mongo/client/connpool.h"
 #include "mongo/db/auth/authorization_manager_global.h"
 #include "mongo/db/auth/authorization_session.h"
@@ -43,6 +44,7 @@
 #include "mongo/db/catalog/document_validation.h"
 #include "mongo/db/catalog/index_create.h"
 #include "mongo/db/client.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
@@ -53,6 +55,7 @@
 #include "mongo/db/range_deleter_service.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/mmap_v1/dur.h"
 #include "mongo/db/s/sharded_connection_info.h"
@@ -62,9 +65,12 @@
 #include "mongo/s/grid.h"
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/stdx/chrono.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -75,6 +81,32 @@ namespace {
 
 Tee* migrateLog = RamLog::get("migrate");
 
+// The number of documents and bytes this shard has cloned as the recipient of chunk migrations,
+// and the time it spent cloning them.
+Counter64 migrationClonedDocs;
+ServerStatusMetricField<Counter64> displayMigrationClonedDocs("migration.clonedDocs",
+                                                              &migrationClonedDocs);
+Counter64 migrationClonedBytes;
+ServerStatusMetricField<Counter64> displayMigrationClonedBytes("migration.clonedBytes",
+                                                               &migrationClonedBytes);
+Counter64 migrationCloneMillis;
+ServerStatusMetricField<Counter64> displayMigrationCloneMillis("migration.cloneMillis",
+                                                               &migrationCloneMillis);
+
+/**
+ * Asks the donor shard on 'conn' for the next batch of documents to clone. Returns false if the
+ * command or the connection failed, with the error in 'res'.
+ */
+bool fetchCloneBatch(DBClientBase* conn, BSONObj* res) {
+    try {
+        // Gets an array of objects to copy, in disk order
+        return conn->runCommand("admin", BSON("_migrateClone" << 1), *res);
+    } catch (const DBException& ex) {
+        *res = BSON("errmsg" << ex.toString());
+        return false;
+    }
+}
+
 /**
  * Returns a human-readabale name of the migration manager's state.
  */
@@ -171,6 +203,14 @@ MONGO_FP_DECLARE(migrateThreadHangAtStep3);
 MONGO_FP_DECLARE(migrateThreadHangAtStep4);
 MONGO_FP_DECLARE(migrateThreadHangAtStep5);
 
+// The number of cloned documents the recipient of a migration inserts under one lock acquisition,
+// and between waits for replication when secondaryThrottle is on.
+MONGO_EXPORT_SERVER_PARAMETER(migrateCloneInsertBatchSize, int, 100);
+
+// Whether the recipient of a migration requests the next batch of documents from the donor on a
+// second connection while it inserts the current batch.
+MONGO_EXPORT_SERVER_PARAMETER(migrateCloneFetchAhead, bool, false);
+
 
 MigrationDestinationManager::MigrationDestinationManager()
     : _active(false),
@@ -561,11 +601,21 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* txn,
         // 3. Initial bulk clone
         setState(CLONE);
 
+        Timer cloneTimer;
+        ON_BLOCK_EXIT([&] { migrationCloneMillis.increment(cloneTimer.millis()); });
+
+        const int insertBatchSize = std::max(1, static_cast<int>(migrateCloneInsertBatchSize));
+
+        // The connection on which the next batch is fetched while the current one is inserted.
+        std::unique_ptr<ScopedDbConnection> fetchAheadConn;
+        if (migrateCloneFetchAhead) {
+            fetchAheadConn = stdx::make_unique<ScopedDbConnection>(fromShard);
+        }
+
+        BSONObj res;
+        bool fetched = fetchCloneBatch(conn.get(), &res);
         while (true) {
-            BSONObj res;
-            if (!conn->runCommand("admin",
-                                  BSON("_migrateClone" << 1),
-                                  res)) {  // gets array of objects to copy, in disk order
+            if (!fetched) {
                 setState(FAIL);
                 errmsg = "_migrateClone failed: ";
                 errmsg += res.toString();
@@ -575,7 +625,21 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* txn,
             }
 
             BSONObj arr = res["objects"].Obj();
-            int thisTime = 0;
+            if (arr.isEmpty())
+                break;
+
+            BSONObj nextRes;
+            bool nextFetched = false;
+            stdx::thread fetcher;
+            if (fetchAheadConn) {
+                fetcher = stdx::thread(
+                    [&] { nextFetched = fetchCloneBatch(fetchAheadConn->get(), &nextRes); });
+            }
+            ScopeGuard fetcherJoiner = MakeGuard([&] {
+                if (fetcher.joinable()) {
+                    fetcher.join();
+                }
+            });
 
             BSONObjIterator i(arr);
             while (i.more()) {
@@ -588,32 +652,47 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* txn,
                     return;
                 }
 
-                BSONObj docToClone = i.next().Obj();
+                int batchDocs = 0;
+                long long batchBytes = 0;
                 {
                     OldClientWriteContext cx(txn, ns);
 
-                    BSONObj localDoc;
-                    if (willOverrideLocalId(
-                            txn, ns, min, max, shardKeyPattern, cx.db(), docToClone, &localDoc)) {
-                        string errMsg = str::stream() << "cannot migrate chunk, local document "
-                                                      << localDoc << " has same _id as cloned "
-                                                      << "remote document " << docToClone;
-
-                        warning() << errMsg;
-
-                        // Exception will abort migration cleanly
-                        uasserted(16976, errMsg);
+                    while (i.more() && batchDocs < insertBatchSize) {
+                        BSONObj docToClone = i.next().Obj();
+
+                        BSONObj localDoc;
+                        if (willOverrideLocalId(txn,
+                                                ns,
+                                                min,
+                                                max,
+                                                shardKeyPattern,
+                                                cx.db(),
+                                                docToClone,
+                                                &localDoc)) {
+                            string errMsg = str::stream()
+                                << "cannot migrate chunk, local document " << localDoc
+                                << " has same _id as cloned "
+                                << "remote document " << docToClone;
+
+                            warning() << errMsg;
+
+                            // Exception will abort migration cleanly
+                            uasserted(16976, errMsg);
+                        }
+
+                        Helpers::upsert(txn, ns, docToClone, true);
+                        ++batchDocs;
+                        batchBytes += docToClone.objsize();
                     }
-
-                    Helpers::upsert(txn, ns, docToClone, true);
                 }
-                thisTime++;
 
                 {
                     stdx::lock_guard<stdx::mutex> statsLock(_mutex);
-                    _numCloned++;
-                    _clonedBytes += docToClone.objsize();
+                    _numCloned += batchDocs;
+                    _clonedBytes += batchBytes;
                 }
+                migrationClonedDocs.increment(batchDocs);
+                migrationClonedBytes.increment(batchBytes);
 
                 if (writeConcern.shouldWaitForOtherNodes()) {
                     repl::ReplicationCoordinator::StatusAndDuration replStatus =
@@ -630,8 +709,17 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* txn,
                 }
             }
 
-            if (thisTime == 0)
-                break;
+            if (fetchAheadConn) {
+                fetcher.join();
+                res = nextRes;
+                fetched = nextFetched;
+            } else {
+                fetched = fetchCloneBatch(conn.get(), &res);
+            }
+        }
+
+        if (fetchAheadConn) {
+            fetchAheadConn->done();
         }
 
         timing.done(3);
@@ -98,6 +98,14 @@ struct ServerGlobalParams {
 
     int maxConns;  // Maximum number of simultaneous open connections.
 
+    enum class ServiceExecutor {
+        kThreadPerConnection,  // Each connection is serviced by a dedicated thread.
+        kAsync,                // Connections are multiplexed over a fixed-size thread pool.
+    };
+    ServiceExecutor serviceExecutor = ServiceExecutor::kThreadPerConnection;  // --serviceExecutor
+    int serviceExecutorThreads = 0;  // --serviceExecutorThreads, 0 means one per core
+    bool writeCoalescing = false;    // --writeCoalescing
+
     int unixSocketPermissions;  // permissions for the UNIX domain socket
 
     std::string keyFile;  // Path to keyfile, or empty if none.
@@ -53,6 +53,7 @@
 #include "mongo/util/map_util.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/net/listen.h"  // For DEFAULT_MAX_CONN
+#include "mongo/util/net/message_compressor.h"
 #include "mongo/util/net/ssl_options.h"
 #include "mongo/util/options_parser/startup_options.h"
 
@@ -207,6 +208,32 @@ Status addGeneralServerOptions(moe::OptionSection* options) {
     options->addOptionChaining(
         "net.maxIncomingConnections", "maxConns", moe::Int, maxConnInfoBuilder.str().c_str());
 
+    options->addOptionChaining("net.serviceExecutor",
+                               "serviceExecutor",
+                               moe::String,
+                               "how incoming connections are serviced (threadPerConnection/async)")
+        .format("(:?threadPerConnection)|(:?async)", "(threadPerConnection/async)");
+
+    options->addOptionChaining("net.serviceExecutorThreads",
+                               "serviceExecutorThreads",
+                               moe::Int,
+                               "number of worker threads for the async service executor "
+                               "(defaults to the number of cores)")
+        .requires("net.serviceExecutor");
+
+    options->addOptionChaining("net.writeCoalescing",
+                               "writeCoalescing",
+                               moe::Switch,
+                               "gather small replies to pipelined requests into fewer socket "
+                               "writes (threadPerConnection service executor only)");
+
+    options->addOptionChaining("net.compression.compressors",
+                               "networkMessageCompressors",
+                               moe::String,
+                               "comma separated list of compressors to offer and accept for "
+                               "network messages, in order of preference (snappy, zlib) or "
+                               "\"disabled\" (the default)");
+
     options->addOptionChaining(
                  "logpath",
                  "logpath",
@@ -804,6 +831,38 @@ Status storeServerOptions(const moe::Environment& params, const std::vector<std:
         }
     }
 
+    if (params.count("net.serviceExecutor")) {
+        const std::string executor = params["net.serviceExecutor"].as<std::string>();
+        if (executor == "async") {
+            serverGlobalParams.serviceExecutor = ServerGlobalParams::ServiceExecutor::kAsync;
+        } else {
+            serverGlobalParams.serviceExecutor =
+                ServerGlobalParams::ServiceExecutor::kThreadPerConnection;
+        }
+    }
+
+    if (params.count("net.serviceExecutorThreads")) {
+        serverGlobalParams.serviceExecutorThreads =
+            params["net.serviceExecutorThreads"].as<int>();
+
+        if (serverGlobalParams.serviceExecutorThreads < 1) {
+            return Status(ErrorCodes::BadValue, "serviceExecutorThreads has to be at least 1");
+        }
+    }
+
+    if (params.count("net.writeCoalescing")) {
+        serverGlobalParams.writeCoalescing = params["net.writeCoalescing"].as<bool>();
+    }
+
+    if (params.count("net.compression.compressors")) {
+        auto swCompressors = parseMessageCompressorList(
+            params["net.compression.compressors"].as<std::string>());
+        if (!swCompressors.isOK()) {
+            return swCompressors.getStatus();
+        }
+        setEnabledMessageCompressors(std::move(swCompressors.getValue()));
+    }
+
     if (params.count("net.wireObjectCheck")) {
         serverGlobalParams.objcheck = params["net.wireObjectCheck"].as<bool>();
     }
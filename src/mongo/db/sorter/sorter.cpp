@@ -49,6 +49,7 @@
 
 #include <boost/filesystem/operations.hpp>
 #include <snappy.h>
+#include <third_party/murmurhash3/MurmurHash3.h>
 
 #include "mongo/base/string_data.h"
 #include "mongo/config.h"
@@ -56,6 +57,7 @@
 #include "mongo/db/storage_options.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/s/mongos_options.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
 #include "mongo/util/mongoutils/str.h"
@@ -68,6 +70,21 @@ namespace sorter {
 using std::shared_ptr;
 using namespace mongoutils;
 
+// The most runs a single merge reads from at once. A sort that spilled more runs than this merges
+// them in stages, writing the output of each group of runs to a new one.
+const size_t kMaxMergeFanIn = 64;
+
+// The most groups of runs merged concurrently by one stage.
+const size_t kMaxParallelMerges = 4;
+
+// Each block of a sorted file is stored as its signed size (negative if compressed), the checksum
+// of the stored bytes, then the bytes themselves.
+inline uint32_t blockChecksum(const char* data, size_t size) {
+    uint32_t checksum;
+    MurmurHash3_x86_32(data, size, 0, &checksum);
+    return checksum;
+}
+
 // We need to use the "real" errno everywhere, not GetLastError() on Windows
 inline std::string myErrnoWithDescription() {
     int errnoCopy = errno;
@@ -158,7 +175,10 @@ private:
     std::deque<Data> _data;
 };
 
-/** Returns results in order from a single file */
+/**
+ * Returns results in order from a single file. The file is only opened on first use and is closed
+ * once exhausted, so spilled runs that are waiting to be merged don't hold file descriptors.
+ */
 template <typename Key, typename Value>
 class FileIterator : public SortIteratorInterface<Key, Value> {
 public:
@@ -169,20 +189,7 @@ public:
     FileIterator(const std::string& fileName,
                  const Settings& settings,
                  std::shared_ptr<FileDeleter> fileDeleter)
-        : _settings(settings),
-          _done(false),
-          _fileName(fileName),
-          _fileDeleter(fileDeleter),
-          _file(_fileName.c_str(), std::ios::in | std::ios::binary) {
-        massert(16814,
-                str::stream() << "error opening file \"" << _fileName
-                              << "\": " << myErrnoWithDescription(),
-                _file.good());
-
-        massert(16815,
-                str::stream() << "unexpected empty file: " << _fileName,
-                boost::filesystem::file_size(_fileName) != 0);
-    }
+        : _settings(settings), _done(false), _fileName(fileName), _fileDeleter(fileDeleter) {}
 
     bool more() {
         if (!_done)
@@ -209,20 +216,45 @@ private:
             fill();
     }
 
+    void open() {
+        _file.open(_fileName.c_str(), std::ios::in | std::ios::binary);
+        massert(16814,
+                str::stream() << "error opening file \"" << _fileName
+                              << "\": " << myErrnoWithDescription(),
+                _file.good());
+
+        massert(16815,
+                str::stream() << "unexpected empty file: " << _fileName,
+                boost::filesystem::file_size(_fileName) != 0);
+    }
+
     void fill() {
+        if (!_file.is_open())
+            open();
+
         int32_t rawSize;
         read(&rawSize, sizeof(rawSize));
-        if (_done)
+        if (_done) {
+            _file.close();
             return;
+        }
 
         // negative size means compressed
         const bool compressed = rawSize < 0;
         const int32_t blockSize = std::abs(rawSize);
 
+        uint32_t checksum;
+        read(&checksum, sizeof(checksum));
+        massert(16816, "file too short?", !_done);
+
         _buffer.reset(new char[blockSize]);
         read(_buffer.get(), blockSize);
         massert(16816, "file too short?", !_done);
 
+        massert(28808,
+                str::stream() << "checksum mismatch in sorted file \"" << _fileName << '"',
+                blockChecksum(_buffer.get(), blockSize) == checksum);
+
         if (!compressed) {
             _reader.reset(new BufReader(_buffer.get(), blockSize));
             return;
@@ -394,6 +426,71 @@ private:
     STLComparator _greater;                      // named so calls make sense
 };
 
+/**
+ * Merges the runs a sorter spilled. At most kMaxMergeFanIn of them are read at once: while there
+ * are more, consecutive groups of runs are merged into new ones, several groups at a time.
+ * Keeping the groups in order keeps the merge stable.
+ */
+template <typename Key, typename Value, typename Comparator>
+SortIteratorInterface<Key, Value>* mergeRuns(
+    std::vector<std::shared_ptr<SortIteratorInterface<Key, Value>>> runs,
+    const SortOptions& opts,
+    const Comparator& comp,
+    const typename Sorter<Key, Value>::Settings& settings) {
+    typedef SortIteratorInterface<Key, Value> Iterator;
+
+    while (runs.size() > kMaxMergeFanIn) {
+        const size_t numGroups = (runs.size() + kMaxMergeFanIn - 1) / kMaxMergeFanIn;
+        std::vector<std::shared_ptr<Iterator>> merged(numGroups);
+        std::vector<std::exception_ptr> errors(numGroups);
+
+        auto mergeGroup = [&](size_t group) {
+            try {
+                const size_t begin = group * kMaxMergeFanIn;
+                const size_t end = std::min(begin + kMaxMergeFanIn, runs.size());
+                std::vector<std::shared_ptr<Iterator>> inputs;
+                for (size_t i = begin; i < end; i++) {
+                    // Only the merge holds the run from here, so its file goes away with it.
+                    inputs.push_back(std::move(runs[i]));
+                }
+
+                std::unique_ptr<Iterator> input(Iterator::merge(inputs, opts, comp));
+                inputs.clear();
+
+                SortedFileWriter<Key, Value> writer(opts, settings);
+                while (input->more()) {
+                    std::pair<Key, Value> next = input->next();
+                    writer.addAlreadySorted(next.first, next.second);
+                }
+                merged[group].reset(writer.done());
+            } catch (...) {
+                errors[group] = std::current_exception();
+            }
+        };
+
+        for (size_t first = 0; first < numGroups; first += kMaxParallelMerges) {
+            const size_t last = std::min(first + kMaxParallelMerges, numGroups);
+            std::vector<stdx::thread> threads;
+            for (size_t group = first + 1; group < last; group++) {
+                threads.emplace_back(mergeGroup, group);
+            }
+            mergeGroup(first);
+            for (auto&& thread : threads) {
+                thread.join();
+            }
+
+            for (size_t group = first; group < last; group++) {
+                if (errors[group])
+                    std::rethrow_exception(errors[group]);
+            }
+        }
+
+        runs.swap(merged);
+    }
+
+    return Iterator::merge(runs, opts, comp);
+}
+
 template <typename Key, typename Value, typename Comparator>
 class NoLimitSorter : public Sorter<Key, Value> {
 public:
@@ -426,7 +523,11 @@ public:
         }
 
         spill();
-        return Iterator::merge(_iters, _opts, _comp);
+        return mergeRuns(std::move(_iters), _opts, _comp, _settings);
+    }
+
+    void setMaxMemoryUsageBytes(size_t maxMemoryUsageBytes) {
+        _opts.maxMemoryUsageBytes = maxMemoryUsageBytes;
     }
 
     // TEMP these are here for compatibility. Will be replaced with a general stats API
@@ -530,6 +631,8 @@ public:
         }
     }
 
+    void setMaxMemoryUsageBytes(size_t maxMemoryUsageBytes) {}
+
     // TEMP these are here for compatibility. Will be replaced with a general stats API
     int numFiles() const {
         return 0;
@@ -623,7 +726,11 @@ public:
         }
 
         spill();
-        return Iterator::merge(_iters, _opts, _comp);
+        return mergeRuns(std::move(_iters), _opts, _comp, _settings);
+    }
+
+    void setMaxMemoryUsageBytes(size_t maxMemoryUsageBytes) {
+        _opts.maxMemoryUsageBytes = maxMemoryUsageBytes;
     }
 
     // TEMP these are here for compatibility. Will be replaced with a general stats API
@@ -851,11 +958,15 @@ void SortedFileWriter<Key, Value>::spill() {
     try {
         if (compressed.size() < size_t(_buffer.len() / 10 * 9)) {
             const int32_t size = -int32_t(compressed.size());  // negative means compressed
+            const uint32_t checksum = sorter::blockChecksum(compressed.data(), compressed.size());
             _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            _file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
             _file.write(compressed.data(), compressed.size());
         } else {
             const int32_t size = _buffer.len();
+            const uint32_t checksum = sorter::blockChecksum(_buffer.buf(), _buffer.len());
             _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            _file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
             _file.write(_buffer.buf(), _buffer.len());
         }
     } catch (const std::exception&) {
@@ -168,6 +168,10 @@ public:
     virtual void add(const Key&, const Value&) = 0;
     virtual Iterator* done() = 0;  /// Can't add more data after calling done()
 
+    /// Changes the memory limit from that in the SortOptions. If the data already held is over
+    /// the new limit, it is spilled by the next call to add().
+    virtual void setMaxMemoryUsageBytes(size_t maxMemoryUsageBytes) = 0;
+
     virtual ~Sorter() {}
 
     // TEMP these are here for compatibility. Will be replaced with a general stats API
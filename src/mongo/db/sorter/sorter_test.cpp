@@ -262,6 +262,24 @@ public:
             ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter.done()),
                                         make_shared<IntIterator>(0, 10 * 1000 * 1000));
         }
+        {  // corrupt
+            SortedFileWriter<IntWrapper, IntWrapper> sorter(opts);
+            for (int i = 0; i < 1000; i++)
+                sorter.addAlreadySorted(i, -i);
+            std::shared_ptr<IWIterator> iter(sorter.done());
+
+            // Flip the last byte of the only block in the file.
+            const std::string fileName =
+                boost::filesystem::directory_iterator(tempDir.path())->path().string();
+            std::fstream file(fileName.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+            file.seekg(-1, std::ios::end);
+            const char last = file.get();
+            file.seekp(-1, std::ios::end);
+            file.put(~last);
+            file.close();
+
+            ASSERT_THROWS(iter->more(), MsgAssertionException);
+        }
 
         ASSERT(boost::filesystem::is_empty(tempDir.path()));
     }
@@ -538,6 +556,69 @@ class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
     }
     enum { MEM_LIMIT = 32 * 1024 };
 };
+
+class ManyRuns {
+public:
+    void run() {
+        unittest::TempDir tempDir("sorterManyRunsTests");
+
+        // Spilling on every add makes a run per item, enough for several stages of merges with
+        // more groups than are merged at once.
+        const int numItems = 20 * kMaxMergeFanIn * kMaxParallelMerges;
+        const SortOptions opts =
+            SortOptions().TempDir(tempDir.path()).ExtSortAllowed().MaxMemoryUsageBytes(1);
+        {
+            std::shared_ptr<IWSorter> sorter(IWSorter::make(opts, IWComparator(ASC)));
+            for (int i = numItems - 1; i >= 0; i--)
+                sorter->add(i, -i);
+            ASSERT_EQUALS(sorter->numFiles(), numItems);
+
+            ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter->done()),
+                                        make_shared<IntIterator>(0, numItems));
+        }
+        {  // with a limit
+            std::shared_ptr<IWSorter> sorter(
+                IWSorter::make(SortOptions(opts).Limit(10), IWComparator(DESC)));
+            for (int i = 0; i < numItems; i++)
+                sorter->add(i, -i);
+
+            ASSERT_ITERATORS_EQUIVALENT(
+                std::shared_ptr<IWIterator>(sorter->done()),
+                make_shared<LimitIterator>(10, make_shared<IntIterator>(numItems - 1, -1, -1)));
+        }
+        ASSERT(boost::filesystem::is_empty(tempDir.path()));
+    }
+};
+
+class SetMaxMemoryUsage {
+public:
+    void run() {
+        unittest::TempDir tempDir("sorterSetMaxMemoryUsageTests");
+        const SortOptions opts =
+            SortOptions().TempDir(tempDir.path()).ExtSortAllowed().MaxMemoryUsageBytes(1 << 20);
+        {
+            std::shared_ptr<IWSorter> sorter(IWSorter::make(opts, IWComparator(ASC)));
+            for (int i = 999; i >= 0; i--)
+                sorter->add(i, -i);
+            ASSERT_EQUALS(sorter->numFiles(), 0);
+
+            // Lowering the limit spills what is held on the next add.
+            sorter->setMaxMemoryUsageBytes(1);
+            sorter->add(1000, -1000);
+            ASSERT_EQUALS(sorter->numFiles(), 1);
+            ASSERT_EQUALS(sorter->memUsed(), 0U);
+
+            // Raising it stops spilling again.
+            sorter->setMaxMemoryUsageBytes(1 << 20);
+            sorter->add(1001, -1001);
+            ASSERT_EQUALS(sorter->numFiles(), 1);
+
+            ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter->done()),
+                                        make_shared<IntIterator>(0, 1002));
+        }
+        ASSERT(boost::filesystem::is_empty(tempDir.path()));
+    }
+};
 }
 
 class SorterSuite : public mongo::unittest::Suite {
@@ -559,6 +640,8 @@ public:
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/true>>();    // fits in mem
         add<SorterTests::LotsOfDataWithLimit<5000, /*random=*/false>>();  // spills
         add<SorterTests::LotsOfDataWithLimit<5000, /*random=*/true>>();   // spills
+        add<SorterTests::ManyRuns>();
+        add<SorterTests::SetMaxMemoryUsage>();
     }
 };
 
@@ -0,0 +1,197 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/latency_histogram.h"
+
+#include <cmath>
+
+#include "mongo/platform/bits.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/threadlocal.h"
+
+namespace mongo {
+
+namespace {
+
+AtomicUInt32 nextStripe;
+
+// One more than the stripe of this thread, so that 0 means none was assigned yet.
+MONGO_TRIVIALLY_CONSTRUCTIBLE_THREAD_LOCAL int threadStripe;
+
+int getThreadStripe() {
+    if (!threadStripe) {
+        threadStripe = 1 + nextStripe.fetchAndAdd(1) % StripedLatencyHistogram::kNumStripes;
+    }
+    return threadStripe - 1;
+}
+
+// Returns 'newer' - 'older', or 'newer' if the counter went backwards because it was reset.
+unsigned long long diff(const AtomicUInt64& older, const AtomicUInt64& newer) {
+    const unsigned long long olderValue = older.load();
+    const unsigned long long newerValue = newer.load();
+    return newerValue >= olderValue ? newerValue - olderValue : newerValue;
+}
+
+}  // namespace
+
+LatencyHistogram::LatencyHistogram(const LatencyHistogram& other) {
+    *this = other;
+}
+
+LatencyHistogram& LatencyHistogram::operator=(const LatencyHistogram& other) {
+    for (int i = 0; i < kNumBuckets; i++) {
+        _buckets[i].store(other._buckets[i].load());
+    }
+    _count.store(other._count.load());
+    _totalMicros.store(other._totalMicros.load());
+    return *this;
+}
+
+LatencyHistogram::LatencyHistogram(const LatencyHistogram& older, const LatencyHistogram& newer) {
+    for (int i = 0; i < kNumBuckets; i++) {
+        _buckets[i].store(diff(older._buckets[i], newer._buckets[i]));
+    }
+    _count.store(diff(older._count, newer._count));
+    _totalMicros.store(diff(older._totalMicros, newer._totalMicros));
+}
+
+int LatencyHistogram::bucketFor(long long micros) {
+    if (micros < kSubBuckets) {
+        return micros < 0 ? 0 : static_cast<int>(micros);
+    }
+
+    const int exponent = 63 - countLeadingZeros64(static_cast<unsigned long long>(micros));
+    if (exponent >= kMaxExponent) {
+        return kNumBuckets - 1;
+    }
+
+    const int subBucket = (micros >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+    return (exponent - kSubBucketBits + 1) * kSubBuckets + subBucket;
+}
+
+long long LatencyHistogram::bucketLowerBound(int bucket) {
+    invariant(bucket >= 0 && bucket < kNumBuckets);
+    if (bucket < kSubBuckets) {
+        return bucket;
+    }
+
+    const int exponent = bucket / kSubBuckets + kSubBucketBits - 1;
+    const long long subBucket = bucket % kSubBuckets;
+    return (kSubBuckets + subBucket) << (exponent - kSubBucketBits);
+}
+
+void LatencyHistogram::increment(long long micros) {
+    _buckets[bucketFor(micros)].fetchAndAdd(1);
+    _count.fetchAndAdd(1);
+    _totalMicros.fetchAndAdd(micros < 0 ? 0 : micros);
+}
+
+void LatencyHistogram::add(const LatencyHistogram& other) {
+    for (int i = 0; i < kNumBuckets; i++) {
+        _buckets[i].fetchAndAdd(other._buckets[i].load());
+    }
+    _count.fetchAndAdd(other._count.load());
+    _totalMicros.fetchAndAdd(other._totalMicros.load());
+}
+
+long long LatencyHistogram::getPercentile(double fraction) const {
+    invariant(fraction > 0 && fraction <= 1);
+
+    // Sum the buckets rather than reading _count, which may already include operations whose
+    // buckets were not incremented yet.
+    unsigned long long counts[kNumBuckets];
+    unsigned long long total = 0;
+    for (int i = 0; i < kNumBuckets; i++) {
+        counts[i] = _buckets[i].load();
+        total += counts[i];
+    }
+
+    if (total == 0) {
+        return 0;
+    }
+
+    const unsigned long long rank = std::ceil(fraction * total);
+    unsigned long long seen = 0;
+    for (int i = 0; i < kNumBuckets - 1; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return bucketLowerBound(i + 1) - 1;
+        }
+    }
+
+    return bucketLowerBound(kNumBuckets - 1);
+}
+
+void LatencyHistogram::append(BSONObjBuilder* builder, bool includeBuckets) const {
+    builder->appendNumber("ops", getCount());
+    builder->appendNumber("latency", getTotalMicros());
+    builder->appendNumber("p50", getPercentile(0.5));
+    builder->appendNumber("p95", getPercentile(0.95));
+    builder->appendNumber("p99", getPercentile(0.99));
+
+    if (includeBuckets) {
+        BSONArrayBuilder bucketsBuilder(builder->subarrayStart("histogram"));
+        for (int i = 0; i < kNumBuckets; i++) {
+            const long long count = _buckets[i].load();
+            if (count) {
+                bucketsBuilder.append(BSON("micros" << bucketLowerBound(i) << "count" << count));
+            }
+        }
+        bucketsBuilder.done();
+    }
+}
+
+void LatencyHistogram::appendDenseBuckets(BSONObjBuilder* builder) const {
+    BSONArrayBuilder bucketsBuilder(builder->subarrayStart("buckets"));
+    for (int i = 0; i < kNumBuckets; i++) {
+        bucketsBuilder.append(static_cast<long long>(_buckets[i].load()));
+    }
+    bucketsBuilder.done();
+}
+
+BSONObj LatencyHistogram::getReport() const {
+    BSONObjBuilder b;
+    append(&b, false);
+    return b.obj();
+}
+
+void StripedLatencyHistogram::increment(long long micros) {
+    _stripes[getThreadStripe()].increment(micros);
+}
+
+LatencyHistogram StripedLatencyHistogram::get() const {
+    LatencyHistogram sum;
+    for (const auto& stripe : _stripes) {
+        sum.add(stripe);
+    }
+    return sum;
+}
+
+}  // namespace mongo
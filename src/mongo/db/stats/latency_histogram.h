@@ -0,0 +1,136 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+/**
+ * Counts latencies in log-linear buckets: each power of two of microseconds is split into
+ * kSubBuckets buckets of equal width, so any percentile is known to within 25% of its value.
+ * Recording takes a few atomic increments and no lock.
+ *
+ * Copies and diffs read the counters one at a time, so they are only consistent to within the
+ * operations recorded concurrently.
+ */
+class LatencyHistogram {
+public:
+    static const int kSubBucketBits = 2;
+    static const int kSubBuckets = 1 << kSubBucketBits;
+
+    // Latencies of 2^kMaxExponent microseconds (about 19 hours) and above share the last bucket.
+    static const int kMaxExponent = 36;
+    static const int kNumBuckets = (kMaxExponent - kSubBucketBits + 1) * kSubBuckets;
+
+    LatencyHistogram() = default;
+    LatencyHistogram(const LatencyHistogram& other);
+    LatencyHistogram& operator=(const LatencyHistogram& other);
+
+    /**
+     * constructs a diff
+     */
+    LatencyHistogram(const LatencyHistogram& older, const LatencyHistogram& newer);
+
+    void increment(long long micros);
+
+    /**
+     * Adds the counts of 'other' to this histogram.
+     */
+    void add(const LatencyHistogram& other);
+
+    long long getCount() const {
+        return static_cast<long long>(_count.load());
+    }
+
+    long long getTotalMicros() const {
+        return static_cast<long long>(_totalMicros.load());
+    }
+
+    /**
+     * Returns an upper bound of the latency under which a 'fraction' of the recorded operations
+     * completed, or 0 if none were recorded. 'fraction' must be in (0, 1].
+     */
+    long long getPercentile(double fraction) const;
+
+    /**
+     * Appends the number of operations, their total latency and the 50th, 95th and 99th
+     * percentiles. If 'includeBuckets' is true, also appends the non-empty buckets as an array of
+     * {micros: <lower bound>, count: <operations>}.
+     */
+    void append(BSONObjBuilder* builder, bool includeBuckets) const;
+
+    /**
+     * Appends the count of every bucket, empty or not, as a 'buckets' array indexed like
+     * bucketLowerBound. The fixed length suits consumers which store the deltas between samples,
+     * like FTDC.
+     */
+    void appendDenseBuckets(BSONObjBuilder* builder) const;
+
+    BSONObj getReport() const;
+    operator BSONObj() const {
+        return getReport();
+    }
+
+    static int bucketFor(long long micros);
+    static long long bucketLowerBound(int bucket);
+
+private:
+    AtomicUInt64 _buckets[kNumBuckets];
+    AtomicUInt64 _count;
+    AtomicUInt64 _totalMicros;
+};
+
+/**
+ * A LatencyHistogram split into stripes, each thread recording into its own one, for latencies
+ * recorded by every operation of the server, where the atomic increments of a single histogram
+ * would contend.
+ */
+class StripedLatencyHistogram {
+    MONGO_DISALLOW_COPYING(StripedLatencyHistogram);
+
+public:
+    static const int kNumStripes = 16;
+
+    StripedLatencyHistogram() = default;
+
+    void increment(long long micros);
+
+    /**
+     * Returns the sum of the stripes.
+     */
+    LatencyHistogram get() const;
+
+private:
+    LatencyHistogram _stripes[kNumStripes];
+};
+
+}  // namespace mongo
@@ -0,0 +1,152 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "mongo/db/stats/latency_histogram.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+
+TEST(LatencyHistogramTest, BucketsCoverEveryLatencyInOrder) {
+    ASSERT_EQUALS(0, LatencyHistogram::bucketFor(-5));
+    ASSERT_EQUALS(0, LatencyHistogram::bucketFor(0));
+    for (int i = 0; i < LatencyHistogram::kNumBuckets; i++) {
+        const long long lowerBound = LatencyHistogram::bucketLowerBound(i);
+        ASSERT_EQUALS(i, LatencyHistogram::bucketFor(lowerBound));
+        if (i + 1 < LatencyHistogram::kNumBuckets) {
+            const long long nextLowerBound = LatencyHistogram::bucketLowerBound(i + 1);
+            ASSERT_LESS_THAN(lowerBound, nextLowerBound);
+            ASSERT_EQUALS(i, LatencyHistogram::bucketFor(nextLowerBound - 1));
+
+            // Every bucket is at most a quarter as wide as its lower bound.
+            ASSERT_LESS_THAN_OR_EQUALS((nextLowerBound - lowerBound) * 4,
+                                       std::max(lowerBound, 4LL));
+        }
+    }
+    ASSERT_EQUALS(LatencyHistogram::kNumBuckets - 1,
+                  LatencyHistogram::bucketFor(std::numeric_limits<long long>::max()));
+}
+
+TEST(LatencyHistogramTest, Percentiles) {
+    LatencyHistogram histogram;
+    ASSERT_EQUALS(0, histogram.getPercentile(0.99));
+
+    for (int i = 1; i <= 1000; i++) {
+        histogram.increment(i);
+    }
+    ASSERT_EQUALS(1000, histogram.getCount());
+    ASSERT_EQUALS(500500, histogram.getTotalMicros());
+
+    const long long p50 = histogram.getPercentile(0.5);
+    ASSERT_GREATER_THAN_OR_EQUALS(p50, 500);
+    ASSERT_LESS_THAN_OR_EQUALS(p50, 500 * 5 / 4);
+
+    const long long p99 = histogram.getPercentile(0.99);
+    ASSERT_GREATER_THAN_OR_EQUALS(p99, 990);
+    ASSERT_LESS_THAN_OR_EQUALS(p99, 990 * 5 / 4);
+
+    ASSERT_GREATER_THAN_OR_EQUALS(histogram.getPercentile(1), 1000);
+    ASSERT_EQUALS(1, histogram.getPercentile(0.001));
+}
+
+TEST(LatencyHistogramTest, DiffAndAdd) {
+    LatencyHistogram older;
+    older.increment(10);
+    older.increment(10000);
+
+    LatencyHistogram newer(older);
+    newer.increment(10000);
+    newer.increment(10000);
+
+    LatencyHistogram diff(older, newer);
+    ASSERT_EQUALS(2, diff.getCount());
+    ASSERT_EQUALS(20000, diff.getTotalMicros());
+    ASSERT_GREATER_THAN_OR_EQUALS(diff.getPercentile(0.5), 10000);
+
+    diff.add(older);
+    ASSERT_EQUALS(4, diff.getCount());
+    ASSERT_EQUALS(30010, diff.getTotalMicros());
+    ASSERT_EQUALS(11, diff.getPercentile(0.25));
+}
+
+TEST(LatencyHistogramTest, Append) {
+    LatencyHistogram histogram;
+    histogram.increment(3);
+    histogram.increment(3);
+    histogram.increment(100);
+
+    BSONObjBuilder builder;
+    histogram.append(&builder, true);
+    const BSONObj report = builder.obj();
+    ASSERT_EQUALS(3, report["ops"].numberLong());
+    ASSERT_EQUALS(106, report["latency"].numberLong());
+    ASSERT_EQUALS(3, report["p50"].numberLong());
+
+    const std::vector<BSONElement> buckets = report["histogram"].Array();
+    ASSERT_EQUALS(2U, buckets.size());
+    ASSERT_EQUALS(BSON("micros" << 3LL << "count" << 2LL), buckets[0].Obj());
+    ASSERT_EQUALS(96, buckets[1].Obj()["micros"].numberLong());
+    ASSERT_FALSE(histogram.getReport().hasField("histogram"));
+}
+
+TEST(LatencyHistogramTest, AppendDenseBuckets) {
+    LatencyHistogram histogram;
+    histogram.increment(3);
+    histogram.increment(100);
+
+    BSONObjBuilder builder;
+    histogram.appendDenseBuckets(&builder);
+    const std::vector<BSONElement> buckets = builder.obj()["buckets"].Array();
+    ASSERT_EQUALS(static_cast<size_t>(LatencyHistogram::kNumBuckets), buckets.size());
+
+    long long total = 0;
+    for (const auto& bucket : buckets) {
+        total += bucket.numberLong();
+    }
+    ASSERT_EQUALS(2, total);
+    ASSERT_EQUALS(1, buckets[LatencyHistogram::bucketFor(3)].numberLong());
+    ASSERT_EQUALS(1, buckets[LatencyHistogram::bucketFor(100)].numberLong());
+}
+
+TEST(LatencyHistogramTest, StripesAreSummed) {
+    StripedLatencyHistogram striped;
+    for (int i = 0; i < 10; i++) {
+        striped.increment(50);
+    }
+    const LatencyHistogram sum = striped.get();
+    ASSERT_EQUALS(10, sum.getCount());
+    ASSERT_EQUALS(500, sum.getTotalMicros());
+}
+
+}  // namespace
@@ -0,0 +1,208 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/query_shape_stats.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "mongo/db/client.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+namespace {
+
+const auto getQueryShapeStats = ServiceContext::declareDecoration<QueryShapeStats>();
+
+// Fraction of the operations with a query shape which are sampled, chosen at random.
+double queryShapeSampleRate = 0;
+
+class QueryShapeSampleRateParameter : public ExportedServerParameter<double> {
+public:
+    QueryShapeSampleRateParameter()
+        : ExportedServerParameter<double>(ServerParameterSet::getGlobal(),
+                                          "queryShapeSampleRate",
+                                          &queryShapeSampleRate,
+                                          true,   // allowedToChangeAtStartup
+                                          true)   // allowedToChangeAtRuntime
+    {}
+
+    Status validate(const double& potentialNewValue) final {
+        if (potentialNewValue < 0 || potentialNewValue > 1) {
+            return Status(ErrorCodes::BadValue, "queryShapeSampleRate must be between 0 and 1");
+        }
+        return Status::OK();
+    }
+} queryShapeSampleRateParameter;
+
+// When positive, every Nth operation with a query shape is sampled, in addition to the random
+// sample.
+MONGO_EXPORT_SERVER_PARAMETER(queryShapeSampleEvery, int, 0);
+
+// The number of distinct namespaces and shapes whose statistics are kept.
+MONGO_EXPORT_SERVER_PARAMETER(queryShapeMaxShapes, int, 1000);
+
+AtomicUInt64 operationsWithShape;
+
+}  // namespace
+
+// static
+QueryShapeStats& QueryShapeStats::get(ServiceContext* service) {
+    return getQueryShapeStats(service);
+}
+
+void QueryShapeStats::sample(OperationContext* txn) {
+    CurOp* curOp = CurOp::get(txn);
+    const OpDebug& debug = curOp->debug();
+    if (debug.queryShape.empty()) {
+        return;
+    }
+
+    const int every = queryShapeSampleEvery;
+    const double rate = queryShapeSampleRate;
+    if (every <= 0 && rate <= 0) {
+        return;
+    }
+
+    bool sampled = every > 0 && operationsWithShape.fetchAndAdd(1) % every == 0;
+    if (!sampled && rate > 0) {
+        sampled = rate >= 1 || txn->getClient()->getPrng().nextCanonicalDouble() < rate;
+    }
+
+    if (!sampled) {
+        return;
+    }
+
+    record(curOp->getNS(),
+           debug.queryShape,
+           debug.query,
+           debug.planSummary.toString(),
+           std::max(debug.keysExamined, 0LL),
+           std::max(debug.docsExamined, 0LL),
+           std::max(debug.nreturned, 0LL),
+           debug.hasSortStage,
+           curOp->totalTimeMicros(),
+           queryShapeMaxShapes);
+}
+
+void QueryShapeStats::record(StringData ns,
+                             StringData shape,
+                             const BSONObj& query,
+                             StringData planSummary,
+                             long long keysExamined,
+                             long long docsExamined,
+                             long long nreturned,
+                             bool hasSortStage,
+                             long long micros,
+                             int maxShapes) {
+    auto key = std::make_pair(ns.toString(), shape.toString());
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    auto it = _shapes.find(key);
+    if (it == _shapes.end()) {
+        if (static_cast<long long>(_shapes.size()) >= maxShapes) {
+            _droppedShapes++;
+            return;
+        }
+
+        it = _shapes.emplace(std::move(key), ShapeData()).first;
+        if (query.objsize() <= kMaxExampleQuerySize) {
+            it->second.exampleQuery = query.getOwned();
+        }
+    }
+
+    ShapeData& data = it->second;
+    data.planSummary = planSummary.toString();
+    data.keysExamined += keysExamined;
+    data.docsExamined += docsExamined;
+    data.nreturned += nreturned;
+    if (hasSortStage) {
+        data.inMemorySorts++;
+    }
+    data.latencies.increment(micros);
+}
+
+void QueryShapeStats::append(StringData ns, BSONObjBuilder* builder) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    std::vector<ShapeMap::const_iterator> shapes;
+    for (auto it = _shapes.begin(); it != _shapes.end(); ++it) {
+        if (ns.empty() || it->first.first == ns) {
+            shapes.push_back(it);
+        }
+    }
+
+    std::sort(shapes.begin(),
+              shapes.end(),
+              [](ShapeMap::const_iterator lhs, ShapeMap::const_iterator rhs) {
+                  return lhs->second.latencies.getTotalMicros() >
+                      rhs->second.latencies.getTotalMicros();
+              });
+
+    BSONArrayBuilder shapesBuilder(builder->subarrayStart("shapes"));
+    for (const auto& it : shapes) {
+        const ShapeData& data = it->second;
+
+        BSONObjBuilder shapeBuilder(shapesBuilder.subobjStart());
+        shapeBuilder.append("ns", it->first.first);
+        shapeBuilder.append("shape", it->first.second);
+        if (!data.exampleQuery.isEmpty()) {
+            shapeBuilder.append("exampleQuery", data.exampleQuery);
+        }
+        shapeBuilder.append("planSummary", data.planSummary);
+        shapeBuilder.appendNumber("keysExamined", data.keysExamined);
+        shapeBuilder.appendNumber("docsExamined", data.docsExamined);
+        shapeBuilder.appendNumber("nreturned", data.nreturned);
+        shapeBuilder.appendNumber("inMemorySorts", data.inMemorySorts);
+
+        BSONObjBuilder latencyBuilder(shapeBuilder.subobjStart("latencyStats"));
+        data.latencies.append(&latencyBuilder, true);
+        latencyBuilder.done();
+
+        shapeBuilder.done();
+    }
+    shapesBuilder.done();
+
+    builder->appendNumber("droppedShapes", _droppedShapes);
+}
+
+void QueryShapeStats::reset() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _shapes.clear();
+    _droppedShapes = 0;
+}
+
+}  // namespace mongo
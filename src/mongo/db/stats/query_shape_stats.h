@@ -0,0 +1,116 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/stats/latency_histogram.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+class OperationContext;
+class ServiceContext;
+
+/**
+ * Aggregates the statistics of a sample of the operations by namespace and query shape, the plan
+ * cache key of their query, so that the costliest query patterns can be found without writing a
+ * system.profile document for each operation.
+ *
+ * The sample is configured with the queryShapeSampleRate and queryShapeSampleEvery server
+ * parameters. Only operations which planned a query through getExecutor have a shape.
+ */
+class QueryShapeStats {
+    MONGO_DISALLOW_COPYING(QueryShapeStats);
+
+public:
+    static QueryShapeStats& get(ServiceContext* service);
+
+    QueryShapeStats() = default;
+
+    struct ShapeData {
+        // The query of the first sampled operation of this shape
+        BSONObj exampleQuery;
+
+        // The plan chosen for the last sampled operation of this shape
+        std::string planSummary;
+
+        long long keysExamined = 0;
+        long long docsExamined = 0;
+        long long nreturned = 0;
+        long long inMemorySorts = 0;
+        LatencyHistogram latencies;
+    };
+
+    /**
+     * Adds the finished current operation of 'txn' to the statistics of its shape if it has one
+     * and is picked by the sample.
+     */
+    void sample(OperationContext* txn);
+
+    /**
+     * Adds an operation to the statistics of its shape. New shapes are only counted as dropped
+     * once 'maxShapes' shapes are tracked.
+     */
+    void record(StringData ns,
+                StringData shape,
+                const BSONObj& query,
+                StringData planSummary,
+                long long keysExamined,
+                long long docsExamined,
+                long long nreturned,
+                bool hasSortStage,
+                long long micros,
+                int maxShapes);
+
+    /**
+     * Appends the statistics of the shapes of 'ns', or of every namespace if it is empty, the
+     * shapes with the highest total latency first.
+     */
+    void append(StringData ns, BSONObjBuilder* builder) const;
+
+    void reset();
+
+private:
+    // Keyed by namespace and shape
+    typedef std::map<std::pair<std::string, std::string>, ShapeData> ShapeMap;
+
+    // Keeps the example queries of the tracked shapes from using too much memory.
+    static const int kMaxExampleQuerySize = 1024;
+
+    mutable stdx::mutex _mutex;
+    ShapeMap _shapes;
+    long long _droppedShapes = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,92 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/stats/query_shape_stats.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+
+BSONObj report(const QueryShapeStats& stats, StringData ns = StringData()) {
+    BSONObjBuilder builder;
+    stats.append(ns, &builder);
+    return builder.obj();
+}
+
+TEST(QueryShapeStatsTest, AggregatesByNamespaceAndShape) {
+    QueryShapeStats stats;
+    stats.record("test.a", "eqa", BSON("a" << 1), "IXSCAN { a: 1 }", 1, 1, 1, false, 100, 10);
+    stats.record("test.a", "eqa", BSON("a" << 2), "IXSCAN { a: 1 }", 2, 2, 0, true, 300, 10);
+    stats.record("test.a", "eqb", BSON("b" << 1), "COLLSCAN", 0, 50, 1, false, 5000, 10);
+    stats.record("test.b", "eqa", BSON("a" << 1), "COLLSCAN", 0, 10, 1, false, 10, 10);
+
+    const std::vector<BSONElement> shapes = report(stats)["shapes"].Array();
+    ASSERT_EQUALS(3U, shapes.size());
+
+    // The costliest shape comes first.
+    ASSERT_EQUALS("eqb", shapes[0]["shape"].String());
+    ASSERT_EQUALS("COLLSCAN", shapes[0]["planSummary"].String());
+
+    const BSONObj eqa = shapes[1].Obj();
+    ASSERT_EQUALS("test.a", eqa["ns"].String());
+    ASSERT_EQUALS("eqa", eqa["shape"].String());
+    ASSERT_EQUALS(BSON("a" << 1), eqa["exampleQuery"].Obj());
+    ASSERT_EQUALS(3, eqa["keysExamined"].numberLong());
+    ASSERT_EQUALS(3, eqa["docsExamined"].numberLong());
+    ASSERT_EQUALS(1, eqa["nreturned"].numberLong());
+    ASSERT_EQUALS(1, eqa["inMemorySorts"].numberLong());
+    ASSERT_EQUALS(2, eqa["latencyStats"]["ops"].numberLong());
+    ASSERT_EQUALS(400, eqa["latencyStats"]["latency"].numberLong());
+
+    const std::vector<BSONElement> bShapes = report(stats, "test.b")["shapes"].Array();
+    ASSERT_EQUALS(1U, bShapes.size());
+    ASSERT_EQUALS("test.b", bShapes[0]["ns"].String());
+}
+
+TEST(QueryShapeStatsTest, BoundedNumberOfShapes) {
+    QueryShapeStats stats;
+    stats.record("test.a", "s1", BSONObj(), "", 0, 0, 0, false, 1, 2);
+    stats.record("test.a", "s2", BSONObj(), "", 0, 0, 0, false, 1, 2);
+    stats.record("test.a", "s3", BSONObj(), "", 0, 0, 0, false, 1, 2);
+    stats.record("test.a", "s1", BSONObj(), "", 0, 0, 0, false, 1, 2);
+
+    BSONObj res = report(stats);
+    ASSERT_EQUALS(2U, res["shapes"].Array().size());
+    ASSERT_EQUALS(1, res["droppedShapes"].numberLong());
+
+    stats.reset();
+    res = report(stats);
+    ASSERT_EQUALS(0U, res["shapes"].Array().size());
+    ASSERT_EQUALS(0, res["droppedShapes"].numberLong());
+}
+
+}  // namespace
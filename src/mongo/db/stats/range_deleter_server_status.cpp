@@ -40,6 +40,9 @@ namespace mongo {
  * rangeDeleter: {
  *   lastDeleteStats: [
  *     {
+ *       ns: "test.user",
+ *       min: { x: 0 },
+ *       max: { x: 10 },
  *       deleteDocs: NumberLong(5);
  *       queueStart: ISODate("2014-06-11T22:45:30.221Z"),
  *       queueEnd: ISODate("2014-06-11T22:45:30.221Z"),
@@ -73,6 +76,9 @@ public:
              it != statsList.end();
              ++it) {
             BSONObjBuilder entryBuilder;
+            entryBuilder.append("ns", (*it)->ns);
+            entryBuilder.append("min", (*it)->minKey);
+            entryBuilder.append("max", (*it)->maxKey);
             entryBuilder.append("deletedDocs", (*it)->deletedDocCount);
 
             if ((*it)->queueEndTS > Date_t()) {
@@ -0,0 +1,177 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/resource_usage_stats.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/client.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+
+namespace mongo {
+
+namespace {
+
+const auto getResourceUsageStats = ServiceContext::declareDecoration<ResourceUsageStats>();
+
+MONGO_EXPORT_SERVER_PARAMETER(resourceUsageTrackingEnabled, bool, true);
+
+// The number of distinct users and databases whose usage is kept.
+MONGO_EXPORT_SERVER_PARAMETER(resourceUsageMaxEntries, int, 10000);
+
+long long nonNegative(long long value) {
+    return std::max(value, 0LL);
+}
+
+}  // namespace
+
+void ResourceUsageStats::Usage::add(const Usage& other) {
+    ops += other.ops;
+    latencyMicros += other.latencyMicros;
+    cpuMicros += other.cpuMicros;
+    keysExamined += other.keysExamined;
+    docsExamined += other.docsExamined;
+    bytesRead += other.bytesRead;
+    bytesWritten += other.bytesWritten;
+    cacheWaitMicros += other.cacheWaitMicros;
+    bytesSent += other.bytesSent;
+}
+
+void ResourceUsageStats::Usage::append(BSONObjBuilder* builder) const {
+    builder->appendNumber("ops", ops);
+    builder->appendNumber("latencyMicros", latencyMicros);
+    builder->appendNumber("cpuMicros", cpuMicros);
+    builder->appendNumber("keysExamined", keysExamined);
+    builder->appendNumber("docsExamined", docsExamined);
+    builder->appendNumber("bytesRead", bytesRead);
+    builder->appendNumber("bytesWritten", bytesWritten);
+    builder->appendNumber("cacheWaitMicros", cacheWaitMicros);
+    builder->appendNumber("bytesSent", bytesSent);
+}
+
+// static
+ResourceUsageStats& ResourceUsageStats::get(ServiceContext* service) {
+    return getResourceUsageStats(service);
+}
+
+void ResourceUsageStats::record(OperationContext* txn) {
+    if (!resourceUsageTrackingEnabled) {
+        return;
+    }
+
+    CurOp* curOp = CurOp::get(txn);
+    const OpDebug& debug = curOp->debug();
+
+    Usage usage;
+    usage.ops = 1;
+    usage.latencyMicros = curOp->totalTimeMicros();
+    usage.cpuMicros = nonNegative(debug.cpuMicros);
+    usage.keysExamined = nonNegative(debug.keysExamined);
+    usage.docsExamined = nonNegative(debug.docsExamined);
+    usage.bytesRead = debug.storageStats["bytesRead"].safeNumberLong();
+    usage.bytesWritten = debug.storageStats["bytesWritten"].safeNumberLong();
+    usage.cacheWaitMicros = debug.storageStats["cacheWaitMicros"].safeNumberLong();
+    usage.bytesSent = nonNegative(debug.responseLength);
+
+    std::string user;
+    UserNameIterator names =
+        AuthorizationSession::get(txn->getClient())->getAuthenticatedUserNames();
+    while (names.more()) {
+        if (!user.empty()) {
+            user += ',';
+        }
+        user += names.next().getFullName();
+    }
+
+    record(user, nsToDatabaseSubstring(curOp->getNS()), usage, resourceUsageMaxEntries);
+}
+
+void ResourceUsageStats::record(StringData user,
+                                StringData db,
+                                const Usage& usage,
+                                int maxEntries) {
+    auto key = std::make_pair(user.toString(), db.toString());
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    auto it = _usage.find(key);
+    if (it == _usage.end()) {
+        if (static_cast<long long>(_usage.size()) >= maxEntries) {
+            _droppedEntries++;
+            return;
+        }
+        it = _usage.emplace(std::move(key), Usage()).first;
+    }
+    it->second.add(usage);
+}
+
+void ResourceUsageStats::append(StringData user, StringData db, BSONObjBuilder* builder) const {
+    std::vector<const UsageMap::value_type*> entries;
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    for (const auto& entry : _usage) {
+        if ((user.empty() || entry.first.first == user) &&
+            (db.empty() || entry.first.second == db)) {
+            entries.push_back(&entry);
+        }
+    }
+
+    std::sort(entries.begin(),
+              entries.end(),
+              [](const UsageMap::value_type* lhs, const UsageMap::value_type* rhs) {
+                  return lhs->second.cpuMicros > rhs->second.cpuMicros;
+              });
+
+    BSONArrayBuilder usageBuilder(builder->subarrayStart("usage"));
+    for (const auto* entry : entries) {
+        BSONObjBuilder entryBuilder(usageBuilder.subobjStart());
+        entryBuilder.append("user", entry->first.first);
+        entryBuilder.append("db", entry->first.second);
+        entry->second.append(&entryBuilder);
+        entryBuilder.done();
+    }
+    usageBuilder.done();
+
+    builder->appendNumber("droppedEntries", _droppedEntries);
+}
+
+void ResourceUsageStats::reset() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _usage.clear();
+    _droppedEntries = 0;
+}
+
+}  // namespace mongo
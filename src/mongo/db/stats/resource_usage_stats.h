@@ -0,0 +1,102 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+class OperationContext;
+class ServiceContext;
+
+/**
+ * Aggregates the resources consumed by the operations by authenticated user and database, for
+ * chargeback and to find the costliest tenants of a shared deployment.
+ *
+ * The storage bytes and cache wait come from the storage statistics of the operation, so they are
+ * only counted by the storage engines which report them.
+ */
+class ResourceUsageStats {
+    MONGO_DISALLOW_COPYING(ResourceUsageStats);
+
+public:
+    static ResourceUsageStats& get(ServiceContext* service);
+
+    ResourceUsageStats() = default;
+
+    struct Usage {
+        long long ops = 0;
+        long long latencyMicros = 0;
+        long long cpuMicros = 0;
+        long long keysExamined = 0;
+        long long docsExamined = 0;
+        long long bytesRead = 0;
+        long long bytesWritten = 0;
+        long long cacheWaitMicros = 0;
+        long long bytesSent = 0;
+
+        void add(const Usage& other);
+        void append(BSONObjBuilder* builder) const;
+    };
+
+    /**
+     * Adds the usage of the finished current operation of 'txn' to its user and database.
+     */
+    void record(OperationContext* txn);
+
+    /**
+     * Adds the usage of an operation. New users and databases are only counted as dropped once
+     * 'maxEntries' of them are tracked.
+     */
+    void record(StringData user, StringData db, const Usage& usage, int maxEntries);
+
+    /**
+     * Appends the usage of 'user' on 'db', where an empty string matches all of them, the entries
+     * which used the most CPU time first.
+     */
+    void append(StringData user, StringData db, BSONObjBuilder* builder) const;
+
+    void reset();
+
+private:
+    // Keyed by user and database
+    typedef std::map<std::pair<std::string, std::string>, Usage> UsageMap;
+
+    mutable stdx::mutex _mutex;
+    UsageMap _usage;
+    long long _droppedEntries = 0;
+};
+
+}  // namespace mongo
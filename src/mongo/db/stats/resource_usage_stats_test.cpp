@@ -0,0 +1,116 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/stats/resource_usage_stats.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+
+BSONObj report(const ResourceUsageStats& stats,
+               StringData user = StringData(),
+               StringData db = StringData()) {
+    BSONObjBuilder builder;
+    stats.append(user, db, &builder);
+    return builder.obj();
+}
+
+ResourceUsageStats::Usage makeUsage(long long cpuMicros, long long bytesRead) {
+    ResourceUsageStats::Usage usage;
+    usage.ops = 1;
+    usage.cpuMicros = cpuMicros;
+    usage.bytesRead = bytesRead;
+    return usage;
+}
+
+TEST(ResourceUsageStatsTest, AggregatesByUserAndDatabase) {
+    ResourceUsageStats stats;
+    stats.record("alice@admin", "a", makeUsage(10, 100), 10);
+    stats.record("alice@admin", "a", makeUsage(20, 200), 10);
+    stats.record("alice@admin", "b", makeUsage(5, 0), 10);
+    stats.record("bob@admin", "a", makeUsage(100, 1), 10);
+
+    const BSONObj res = report(stats);
+    const std::vector<BSONElement> usage = res["usage"].Array();
+    ASSERT_EQUALS(3U, usage.size());
+    ASSERT_EQUALS(0, res["droppedEntries"].numberLong());
+
+    // The entry which used the most CPU time comes first.
+    ASSERT_EQUALS("bob@admin", usage[0]["user"].String());
+
+    const BSONObj aliceA = usage[1].Obj();
+    ASSERT_EQUALS("alice@admin", aliceA["user"].String());
+    ASSERT_EQUALS("a", aliceA["db"].String());
+    ASSERT_EQUALS(2, aliceA["ops"].numberLong());
+    ASSERT_EQUALS(30, aliceA["cpuMicros"].numberLong());
+    ASSERT_EQUALS(300, aliceA["bytesRead"].numberLong());
+    ASSERT_EQUALS(0, aliceA["bytesSent"].numberLong());
+
+    ASSERT_EQUALS("b", usage[2]["db"].String());
+}
+
+TEST(ResourceUsageStatsTest, FiltersByUserAndDatabase) {
+    ResourceUsageStats stats;
+    stats.record("alice@admin", "a", makeUsage(10, 0), 10);
+    stats.record("alice@admin", "b", makeUsage(10, 0), 10);
+    stats.record("bob@admin", "a", makeUsage(10, 0), 10);
+    stats.record("", "a", makeUsage(10, 0), 10);
+
+    ASSERT_EQUALS(2U, report(stats, "alice@admin")["usage"].Array().size());
+    ASSERT_EQUALS(3U, report(stats, StringData(), "a")["usage"].Array().size());
+    ASSERT_EQUALS(1U, report(stats, "bob@admin", "a")["usage"].Array().size());
+    ASSERT_EQUALS(0U, report(stats, "bob@admin", "b")["usage"].Array().size());
+}
+
+TEST(ResourceUsageStatsTest, DropsNewEntriesWhenFull) {
+    ResourceUsageStats stats;
+    stats.record("alice@admin", "a", makeUsage(10, 0), 2);
+    stats.record("alice@admin", "b", makeUsage(10, 0), 2);
+    stats.record("alice@admin", "c", makeUsage(10, 0), 2);
+
+    // An existing entry is still updated.
+    stats.record("alice@admin", "a", makeUsage(10, 0), 2);
+
+    BSONObj res = report(stats);
+    ASSERT_EQUALS(2U, res["usage"].Array().size());
+    ASSERT_EQUALS(1, res["droppedEntries"].numberLong());
+    ASSERT_EQUALS(20, res["usage"].Array()[0]["cpuMicros"].numberLong());
+
+    stats.reset();
+    res = report(stats);
+    ASSERT_EQUALS(0U, res["usage"].Array().size());
+    ASSERT_EQUALS(0, res["droppedEntries"].numberLong());
+}
+
+}  // namespace
@@ -0,0 +1,393 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kControl
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/sampling_profiler.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "mongo/config.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/background.h"
+#include "mongo/util/concurrency/threadlocal.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/hex.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/time_support.h"
+
+#if defined(MONGO_CONFIG_HAVE_EXECINFO_BACKTRACE)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <sys/time.h>
+#endif
+
+namespace mongo {
+
+namespace {
+
+// Size of the ring of samples recorded by the signal handler. At the maximum frequency, it holds
+// the samples of a tenth of a second of CPU time of 10 cores.
+const unsigned kNumSlots = 1024;
+
+// The handler and the signal trampoline are on top of the stack of every sample.
+const int kSkippedFrames = 2;
+
+// Interval at which the background thread drains the ring.
+const int kDrainIntervalMillis = 100;
+
+enum SlotState { kEmpty, kWriting, kFull };
+
+struct Slot {
+    AtomicInt32 state;
+    SamplingProfiler::Sample sample;
+};
+
+Slot slots[kNumSlots];
+AtomicUInt32 nextSlot;
+AtomicInt64 droppedSamples;
+
+/**
+ * Operation of the current thread, read by the signal handler. The thread sets 'op' to null while
+ * it changes the tag, so the handler never sees a torn namespace.
+ */
+struct OpTag {
+    const char* volatile op;
+    char ns[SamplingProfiler::kMaxNamespaceLength];
+};
+
+MONGO_TRIVIALLY_CONSTRUCTIBLE_THREAD_LOCAL OpTag threadOpTag;
+
+SamplingProfiler samplingProfiler;
+
+void drainSamples() {
+    for (auto& slot : slots) {
+        if (slot.state.load() != kFull) {
+            continue;
+        }
+        const SamplingProfiler::Sample sample = slot.sample;
+        slot.state.store(kEmpty);
+        samplingProfiler.addSample(sample);
+    }
+}
+
+class SamplingProfilerThread : public BackgroundJob {
+public:
+    std::string name() const {
+        return "SamplingProfiler";
+    }
+
+    void run() {
+        while (!inShutdown()) {
+            sleepmillis(kDrainIntervalMillis);
+            drainSamples();
+        }
+    }
+} samplingProfilerThread;
+
+#if defined(MONGO_CONFIG_HAVE_EXECINFO_BACKTRACE)
+
+/**
+ * Records the stack of the interrupted thread. Only uses atomics and backtrace(), which is safe in
+ * a signal handler once it was called outside of one.
+ */
+void onProfilingSignal(int, siginfo_t*, void*) {
+    const int savedErrno = errno;
+
+    Slot& slot = slots[nextSlot.fetchAndAdd(1) % kNumSlots];
+    if (slot.state.compareAndSwap(kEmpty, kWriting) != kEmpty) {
+        droppedSamples.fetchAndAdd(1);
+        errno = savedErrno;
+        return;
+    }
+
+    void* frames[SamplingProfiler::kMaxFrames + kSkippedFrames];
+    const int numFrames = backtrace(frames, SamplingProfiler::kMaxFrames + kSkippedFrames);
+
+    SamplingProfiler::Sample& sample = slot.sample;
+    sample.numFrames = std::max(numFrames - kSkippedFrames, 0);
+    std::copy(frames + kSkippedFrames, frames + kSkippedFrames + sample.numFrames, sample.frames);
+
+    sample.op = threadOpTag.op;
+    if (sample.op) {
+        std::memcpy(sample.ns, threadOpTag.ns, sizeof(sample.ns));
+    }
+
+    slot.state.store(kFull);
+    errno = savedErrno;
+}
+
+Status installSignalHandler() {
+    // The first call to backtrace() may allocate while loading the unwinder.
+    void* frames[1];
+    backtrace(frames, 1);
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_sigaction = onProfilingSignal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, NULL) != 0) {
+        return Status(ErrorCodes::InternalError,
+                      str::stream() << "failed to install the SIGPROF handler: "
+                                    << errnoWithDescription());
+    }
+    return Status::OK();
+}
+
+Status setTimer(int hz) {
+    struct itimerval timer;
+    std::memset(&timer, 0, sizeof(timer));
+    if (hz > 0) {
+        timer.it_interval.tv_usec = 1000 * 1000 / hz;
+        timer.it_value = timer.it_interval;
+    }
+    if (setitimer(ITIMER_PROF, &timer, NULL) != 0) {
+        return Status(ErrorCodes::InternalError,
+                      str::stream() << "failed to set the profiling timer: "
+                                    << errnoWithDescription());
+    }
+    return Status::OK();
+}
+
+std::string symbolize(void* address) {
+    Dl_info info;
+    if (dladdr(address, &info) == 0) {
+        return str::stream() << address;
+    }
+
+    if (info.dli_sname) {
+        int status;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, NULL, NULL, &status);
+        std::string name = (status == 0 && demangled) ? demangled : info.dli_sname;
+        free(demangled);
+        return str::stream() << name << "+0x"
+                             << integerToHex(static_cast<char*>(address) -
+                                             static_cast<char*>(info.dli_saddr));
+    }
+
+    StringData module = info.dli_fname ? info.dli_fname : "?";
+    module = module.substr(module.rfind('/') + 1);
+    return str::stream() << module << "+0x"
+                         << integerToHex(static_cast<char*>(address) -
+                                         static_cast<char*>(info.dli_fbase));
+}
+
+#else
+
+Status installSignalHandler() {
+    return Status(ErrorCodes::IllegalOperation,
+                  "the sampling profiler is not supported on this platform");
+}
+
+Status setTimer(int hz) {
+    return installSignalHandler();
+}
+
+std::string symbolize(void* address) {
+    return str::stream() << address;
+}
+
+#endif
+
+int samplingProfilerHz = 0;
+
+class SamplingProfilerHzParameter : public ExportedServerParameter<int> {
+public:
+    SamplingProfilerHzParameter()
+        : ExportedServerParameter<int>(ServerParameterSet::getGlobal(),
+                                       "samplingProfilerHz",
+                                       &samplingProfilerHz,
+                                       false,  // allowedToChangeAtStartup
+                                       true)   // allowedToChangeAtRuntime
+    {}
+
+    Status validate(const int& potentialNewValue) final {
+        if (potentialNewValue < 0 || potentialNewValue > SamplingProfiler::kMaxFrequency) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "samplingProfilerHz must be between 0 and "
+                                        << SamplingProfiler::kMaxFrequency);
+        }
+        return SamplingProfiler::get().setFrequency(potentialNewValue);
+    }
+} samplingProfilerHzParameter;
+
+}  // namespace
+
+const int SamplingProfiler::kMaxFrames;
+const size_t SamplingProfiler::kMaxNamespaceLength;
+const size_t SamplingProfiler::kMaxStacks;
+const int SamplingProfiler::kMaxFrequency;
+
+SamplingProfiler::ScopedOpTag::ScopedOpTag(const char* op, StringData ns)
+    : _previousOp(threadOpTag.op) {
+    std::memcpy(_previousNs, threadOpTag.ns, sizeof(_previousNs));
+
+    threadOpTag.op = NULL;
+    const size_t length = std::min(ns.size(), kMaxNamespaceLength - 1);
+    std::memcpy(threadOpTag.ns, ns.rawData(), length);
+    threadOpTag.ns[length] = '\0';
+    threadOpTag.op = op;
+}
+
+SamplingProfiler::ScopedOpTag::~ScopedOpTag() {
+    threadOpTag.op = NULL;
+    std::memcpy(threadOpTag.ns, _previousNs, sizeof(_previousNs));
+    threadOpTag.op = _previousOp;
+}
+
+SamplingProfiler& SamplingProfiler::get() {
+    return samplingProfiler;
+}
+
+bool SamplingProfiler::isSupported() {
+#if defined(MONGO_CONFIG_HAVE_EXECINFO_BACKTRACE)
+    return true;
+#else
+    return false;
+#endif
+}
+
+Status SamplingProfiler::setFrequency(int hz) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    if (hz > 0 && !_threadStarted) {
+        Status status = installSignalHandler();
+        if (!status.isOK()) {
+            return status;
+        }
+        samplingProfilerThread.go();
+        _threadStarted = true;
+    }
+
+    if (_threadStarted) {
+        Status status = setTimer(hz);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
+    _hz.store(hz);
+    log() << "sampling profiler frequency set to " << hz << "Hz";
+    return Status::OK();
+}
+
+void SamplingProfiler::addSample(const Sample& sample) {
+    std::vector<void*> stack(sample.frames, sample.frames + sample.numFrames);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    ++_samples;
+
+    auto it = _stacks.find(stack);
+    if (it != _stacks.end()) {
+        ++it->second;
+    } else if (_stacks.size() < kMaxStacks) {
+        _stacks.emplace(std::move(stack), 1);
+    } else {
+        ++_otherStacks;
+    }
+
+    if (sample.op) {
+        auto key = std::make_pair(std::string(sample.op), std::string(sample.ns));
+        auto opIt = _ops.find(key);
+        if (opIt != _ops.end()) {
+            ++opIt->second;
+        } else if (_ops.size() < kMaxStacks) {
+            _ops.emplace(std::move(key), 1);
+        }
+    }
+}
+
+void SamplingProfiler::report(size_t maxStacks, BSONObjBuilder* builder) const {
+    typedef std::pair<long long, const std::vector<void*>*> StackCount;
+    typedef std::pair<long long, const std::pair<std::string, std::string>*> OpCount;
+    std::vector<StackCount> topStacks;
+    std::vector<OpCount> opCounts;
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    builder->append("hz", _hz.load());
+    builder->appendNumber("samples", _samples);
+    builder->appendNumber("droppedSamples", static_cast<long long>(droppedSamples.load()));
+    builder->appendNumber("otherStacks", _otherStacks);
+
+    for (const auto& stack : _stacks) {
+        topStacks.push_back(StackCount(stack.second, &stack.first));
+    }
+    const size_t numStacks = std::min(maxStacks, topStacks.size());
+    std::partial_sort(topStacks.begin(),
+                      topStacks.begin() + numStacks,
+                      topStacks.end(),
+                      [](const StackCount& lhs, const StackCount& rhs) {
+                          return lhs.first > rhs.first;
+                      });
+
+    BSONArrayBuilder stacksBuilder(builder->subarrayStart("stacks"));
+    for (size_t i = 0; i < numStacks; i++) {
+        BSONObjBuilder stackBuilder(stacksBuilder.subobjStart());
+        stackBuilder.appendNumber("count", topStacks[i].first);
+        BSONArrayBuilder framesBuilder(stackBuilder.subarrayStart("frames"));
+        for (void* frame : *topStacks[i].second) {
+            framesBuilder.append(symbolize(frame));
+        }
+        framesBuilder.done();
+        stackBuilder.done();
+    }
+    stacksBuilder.done();
+
+    for (const auto& op : _ops) {
+        opCounts.push_back(OpCount(op.second, &op.first));
+    }
+    std::sort(opCounts.begin(), opCounts.end(), [](const OpCount& lhs, const OpCount& rhs) {
+        return lhs.first > rhs.first;
+    });
+
+    BSONArrayBuilder opsBuilder(builder->subarrayStart("ops"));
+    for (const auto& op : opCounts) {
+        opsBuilder.append(BSON("op" << op.second->first << "ns" << op.second->second << "count"
+                                    << op.first));
+    }
+    opsBuilder.done();
+}
+
+void SamplingProfiler::reset() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _samples = 0;
+    _otherStacks = 0;
+    _stacks.clear();
+    _ops.clear();
+    droppedSamples.store(0);
+}
+
+}  // namespace mongo
@@ -0,0 +1,147 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/base/string_data.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+/**
+ * A low rate sampling profiler of the CPU time of the whole process.
+ *
+ * While enabled, the process gets a SIGPROF for every 1/hz seconds of CPU time it consumes. The
+ * signal handler records the stack of the interrupted thread, along with the operation the thread
+ * is running if it set a ScopedOpTag, into a fixed ring of samples. A background thread drains the
+ * ring and counts the samples by stack and by operation, so the report shows the hot paths under
+ * the real load without attaching an external profiler.
+ *
+ * Must not be enabled at the same time as the gperftools profiler of _cpuProfilerStart, which
+ * also relies on SIGPROF.
+ */
+class SamplingProfiler {
+    MONGO_DISALLOW_COPYING(SamplingProfiler);
+
+public:
+    static const int kMaxFrames = 32;
+    static const size_t kMaxNamespaceLength = 64;
+
+    // Samples of new stacks are counted as 'otherStacks' beyond this number of distinct stacks.
+    static const size_t kMaxStacks = 4096;
+
+    static const int kMaxFrequency = 1000;
+
+    /**
+     * Raw sample recorded by the signal handler. 'op' points to a string with static storage
+     * duration, or is null if the thread was not running an operation.
+     */
+    struct Sample {
+        int numFrames;
+        void* frames[kMaxFrames];
+        const char* op;
+        char ns[kMaxNamespaceLength];
+    };
+
+    /**
+     * Tags the samples of the current thread with an operation and its namespace while in scope,
+     * and restores the tag of the enclosing operation, if any, on destruction. 'op' must have
+     * static storage duration. The namespace is truncated to kMaxNamespaceLength - 1 bytes.
+     */
+    class ScopedOpTag {
+        MONGO_DISALLOW_COPYING(ScopedOpTag);
+
+    public:
+        ScopedOpTag(const char* op, StringData ns);
+        ~ScopedOpTag();
+
+    private:
+        const char* _previousOp;
+        char _previousNs[kMaxNamespaceLength];
+    };
+
+    SamplingProfiler() = default;
+
+    static SamplingProfiler& get();
+
+    /**
+     * Returns false on the platforms where stacks cannot be sampled.
+     */
+    static bool isSupported();
+
+    /**
+     * Sets the number of samples per second of CPU time, or disables sampling with 0. The samples
+     * already counted are kept.
+     */
+    Status setFrequency(int hz);
+
+    int getFrequency() const {
+        return _hz.load();
+    }
+
+    /**
+     * Counts a sample. Called by the background thread with the samples drained from the ring.
+     */
+    void addSample(const Sample& sample);
+
+    /**
+     * Appends the number of samples, the 'maxStacks' most frequent stacks with their symbolized
+     * frames, innermost first, and the count of samples per operation and namespace.
+     */
+    void report(size_t maxStacks, BSONObjBuilder* builder) const;
+
+    /**
+     * Clears the counts.
+     */
+    void reset();
+
+private:
+    // Sampling frequency, 0 if disabled
+    AtomicInt32 _hz{0};
+
+    // Protects the counts, and the start of the background thread
+    mutable stdx::mutex _mutex;
+
+    bool _threadStarted{false};
+
+    long long _samples{0};
+    long long _otherStacks{0};
+    std::map<std::vector<void*>, long long> _stacks;
+    std::map<std::pair<std::string, std::string>, long long> _ops;
+};
+
+}  // namespace mongo
@@ -0,0 +1,134 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/stats/sampling_profiler.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
+
+namespace {
+
+using namespace mongo;
+
+SamplingProfiler::Sample makeSample(std::vector<void*> frames, const char* op, StringData ns) {
+    SamplingProfiler::Sample sample;
+    sample.numFrames = frames.size();
+    std::copy(frames.begin(), frames.end(), sample.frames);
+    sample.op = op;
+    ns.copyTo(sample.ns, true);
+    return sample;
+}
+
+BSONObj report(const SamplingProfiler& profiler, size_t maxStacks) {
+    BSONObjBuilder builder;
+    profiler.report(maxStacks, &builder);
+    return builder.obj();
+}
+
+void* frame(uintptr_t address) {
+    return reinterpret_cast<void*>(address);
+}
+
+TEST(SamplingProfilerTest, AggregatesByStackAndOperation) {
+    SamplingProfiler profiler;
+    profiler.addSample(makeSample({frame(1), frame(2)}, "query", "test.a"));
+    profiler.addSample(makeSample({frame(3), frame(2)}, "insert", "test.b"));
+    profiler.addSample(makeSample({frame(3), frame(2)}, "insert", "test.b"));
+    profiler.addSample(makeSample({frame(3), frame(2)}, NULL, ""));
+
+    BSONObj res = report(profiler, 1);
+    ASSERT_EQUALS(4, res["samples"].numberLong());
+
+    // Only the most frequent stack is reported.
+    const std::vector<BSONElement> stacks = res["stacks"].Array();
+    ASSERT_EQUALS(1U, stacks.size());
+    ASSERT_EQUALS(3, stacks[0]["count"].numberLong());
+    ASSERT_EQUALS(2U, stacks[0]["frames"].Array().size());
+
+    // The samples which were not tagged with an operation only count for their stack.
+    const std::vector<BSONElement> ops = res["ops"].Array();
+    ASSERT_EQUALS(2U, ops.size());
+    ASSERT_EQUALS(BSON("op"
+                       << "insert"
+                       << "ns"
+                       << "test.b"
+                       << "count" << 2LL),
+                  ops[0].Obj());
+    ASSERT_EQUALS("query", ops[1]["op"].String());
+
+    profiler.reset();
+    res = report(profiler, 10);
+    ASSERT_EQUALS(0, res["samples"].numberLong());
+    ASSERT_EQUALS(0U, res["stacks"].Array().size());
+    ASSERT_EQUALS(0U, res["ops"].Array().size());
+}
+
+TEST(SamplingProfilerTest, BoundedNumberOfStacks) {
+    SamplingProfiler profiler;
+    for (size_t i = 0; i < SamplingProfiler::kMaxStacks + 10; i++) {
+        profiler.addSample(makeSample({frame(i + 1)}, NULL, ""));
+    }
+    profiler.addSample(makeSample({frame(1)}, NULL, ""));
+
+    const BSONObj res = report(profiler, SamplingProfiler::kMaxStacks * 2);
+    ASSERT_EQUALS(10, res["otherStacks"].numberLong());
+    ASSERT_EQUALS(SamplingProfiler::kMaxStacks, res["stacks"].Array().size());
+    ASSERT_EQUALS(2, res["stacks"].Array()[0]["count"].numberLong());
+}
+
+TEST(SamplingProfilerTest, SamplesTheCurrentOperation) {
+    if (!SamplingProfiler::isSupported()) {
+        return;
+    }
+
+    SamplingProfiler& profiler = SamplingProfiler::get();
+    ASSERT_OK(profiler.setFrequency(SamplingProfiler::kMaxFrequency));
+
+    // Burn CPU time until the background thread counted some of its samples.
+    bool sampled = false;
+    {
+        SamplingProfiler::ScopedOpTag tag("query", "test.sampled");
+        Timer timer;
+        volatile long long sink = 0;
+        while (!sampled && timer.seconds() < 30) {
+            for (int i = 0; i < 1000 * 1000; i++) {
+                sink = sink + i;
+            }
+            const std::vector<BSONElement> ops = report(profiler, 0)["ops"].Array();
+            sampled = !ops.empty() && ops[0]["ns"].String() == "test.sampled";
+        }
+    }
+
+    ASSERT_OK(profiler.setFrequency(0));
+    ASSERT_TRUE(sampled);
+}
+
+}  // namespace
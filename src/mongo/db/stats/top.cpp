@@ -66,7 +66,10 @@ Top::CollectionData::CollectionData(const CollectionData& older, const Collectio
       insert(older.insert, newer.insert),
       update(older.update, newer.update),
       remove(older.remove, newer.remove),
-      commands(older.commands, newer.commands) {}
+      commands(older.commands, newer.commands),
+      readLatencies(older.readLatencies, newer.readLatencies),
+      writeLatencies(older.writeLatencies, newer.writeLatencies),
+      commandLatencies(older.commandLatencies, newer.commandLatencies) {}
 
 // static
 Top& Top::get(ServiceContext* service) {
@@ -103,21 +106,28 @@ void Top::_record(CollectionData& c, int op, int lockType, long long micros, boo
             break;
         case dbUpdate:
             c.update.inc(micros);
+            c.writeLatencies.increment(micros);
             break;
         case dbInsert:
             c.insert.inc(micros);
+            c.writeLatencies.increment(micros);
             break;
         case dbQuery:
-            if (command)
+            if (command) {
                 c.commands.inc(micros);
-            else
+                c.commandLatencies.increment(micros);
+            } else {
                 c.queries.inc(micros);
+                c.readLatencies.increment(micros);
+            }
             break;
         case dbGetMore:
             c.getmore.inc(micros);
+            c.readLatencies.increment(micros);
             break;
         case dbDelete:
             c.remove.inc(micros);
+            c.writeLatencies.increment(micros);
             break;
         case dbKillCursors:
             break;
@@ -128,6 +138,7 @@ void Top::_record(CollectionData& c, int op, int lockType, long long micros, boo
             break;
         case dbCommand:
             c.commands.inc(micros);
+            c.commandLatencies.increment(micros);
             break;
         default:
             log() << "unknown op in Top::record: " << op << endl;
@@ -177,10 +188,24 @@ void Top::_appendToUsageMap(BSONObjBuilder& b, const UsageMap& map) const {
         _appendStatsEntry(b, "remove", coll.remove);
         _appendStatsEntry(b, "commands", coll.commands);
 
+        BSONObjBuilder latencyBuilder(bb.subobjStart("latencyStats"));
+        _appendLatencyStats(latencyBuilder, "reads", coll.readLatencies);
+        _appendLatencyStats(latencyBuilder, "writes", coll.writeLatencies);
+        _appendLatencyStats(latencyBuilder, "commands", coll.commandLatencies);
+        latencyBuilder.done();
+
         bb.done();
     }
 }
 
+void Top::_appendLatencyStats(BSONObjBuilder& b,
+                              const char* statsName,
+                              const LatencyHistogram& histogram) const {
+    BSONObjBuilder bb(b.subobjStart(statsName));
+    histogram.append(&bb, false);
+    bb.done();
+}
+
 void Top::_appendStatsEntry(BSONObjBuilder& b, const char* statsName, const UsageData& map) const {
     BSONObjBuilder bb(b.subobjStart(statsName));
     bb.appendNumber("time", map.time);
@@ -31,6 +31,7 @@
 
 #include <boost/date_time/posix_time/posix_time.hpp>
 
+#include "mongo/db/stats/latency_histogram.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/string_map.h"
 
@@ -77,6 +78,10 @@ public:
         UsageData update;
         UsageData remove;
         UsageData commands;
+
+        LatencyHistogram readLatencies;
+        LatencyHistogram writeLatencies;
+        LatencyHistogram commandLatencies;
     };
 
     typedef StringMap<CollectionData> UsageMap;
@@ -90,6 +95,9 @@ public:
 private:
     void _appendToUsageMap(BSONObjBuilder& b, const UsageMap& map) const;
     void _appendStatsEntry(BSONObjBuilder& b, const char* statsName, const UsageData& map) const;
+    void _appendLatencyStats(BSONObjBuilder& b,
+                             const char* statsName,
+                             const LatencyHistogram& histogram) const;
     void _record(CollectionData& c, int op, int lockType, long long micros, bool command);
 
     mutable SimpleMutex _lock;
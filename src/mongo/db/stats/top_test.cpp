@@ -28,8 +28,10 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/db/jsobj.h"
 #include "mongo/db/stats/top.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/net/message.h"
 
 namespace {
 
@@ -39,4 +41,26 @@ TEST(TopTest, CollectionDropped) {
     Top().collectionDropped("coll");
 }
 
+TEST(TopTest, LatencyStats) {
+    Top top;
+    top.record("test.coll", dbQuery, -1, 100, false);
+    top.record("test.coll", dbGetMore, -1, 200, false);
+    top.record("test.coll", dbInsert, 1, 300, false);
+    top.record("test.coll", dbQuery, -1, 400, true);
+
+    BSONObjBuilder builder;
+    top.append(builder);
+    const BSONObj latencyStats = builder.obj()["test.coll"]["latencyStats"].Obj();
+    ASSERT_EQUALS(2, latencyStats["reads"]["ops"].numberLong());
+    ASSERT_EQUALS(300, latencyStats["reads"]["latency"].numberLong());
+    ASSERT_EQUALS(1, latencyStats["writes"]["ops"].numberLong());
+    ASSERT_EQUALS(1, latencyStats["commands"]["ops"].numberLong());
+    ASSERT_GREATER_THAN_OR_EQUALS(latencyStats["commands"]["p99"].numberLong(), 400);
+
+    Top::UsageMap usage;
+    top.cloneMap(usage);
+    Top::CollectionData diff(Top::CollectionData(), usage["test.coll"]);
+    ASSERT_EQUALS(2, diff.readLatencies.getCount());
+}
+
 }  // namespace
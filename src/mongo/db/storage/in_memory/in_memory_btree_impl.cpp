@@ -32,13 +32,18 @@
 
 #include "mongo/db/storage/in_memory/in_memory_btree_impl.h"
 
+#include <algorithm>
 #include <set>
 
 #include "mongo/db/catalog/index_catalog_entry.h"
 #include "mongo/db/storage/index_entry_comparison.h"
+#include "mongo/db/storage/in_memory/in_memory_memory_budget.h"
 #include "mongo/db/storage/in_memory/in_memory_recovery_unit.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/bufreader.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/order_statistic_tree.h"
 
 namespace mongo {
 
@@ -69,7 +74,136 @@ BSONObj stripFieldNames(const BSONObj& query) {
     return bb.obj();
 }
 
-typedef std::set<IndexKeyEntry, IndexEntryComparison> IndexSet;
+/**
+ * An index entry as kept in the IndexSet. The key is stored in KeyString form so that ordering
+ * entries is a memcmp rather than a BSON comparison under the index Ordering. The TypeBits
+ * needed to turn the key back into BSON follow it in the same buffer, and are omitted when they
+ * are all zeros.
+ */
+class KeyStringEntry {
+public:
+    KeyStringEntry(const KeyString& ks, RecordId loc)
+        : _buf(ks.getBuffer(), ks.getSize()), _keySize(ks.getSize()), _loc(loc) {
+        const KeyString::TypeBits& typeBits = ks.getTypeBits();
+        if (!typeBits.isAllZeros()) {
+            _buf.append(reinterpret_cast<const char*>(typeBits.getBuffer()), typeBits.getSize());
+        }
+    }
+
+    StringData key() const {
+        return StringData(_buf.data(), _keySize);
+    }
+
+    const RecordId& loc() const {
+        return _loc;
+    }
+
+    /**
+     * Bytes used by the key and its TypeBits.
+     */
+    size_t size() const {
+        return _buf.size();
+    }
+
+    BSONObj toBson(Ordering ordering) const {
+        BufReader reader(_buf.data() + _keySize, _buf.size() - _keySize);
+        return KeyString::toBson(
+            _buf.data(), _keySize, ordering, KeyString::TypeBits::fromBuffer(&reader));
+    }
+
+    int compare(const KeyStringEntry& other) const {
+        const int cmp = key().compare(other.key());
+        return cmp ? cmp : _loc.compare(other._loc);
+    }
+
+private:
+    std::string _buf;
+    size_t _keySize;
+    RecordId _loc;
+};
+
+struct KeyStringEntryLess {
+    bool operator()(const KeyStringEntry& lhs, const KeyStringEntry& rhs) const {
+        return lhs.compare(rhs) < 0;
+    }
+};
+
+typedef std::set<KeyStringEntry, KeyStringEntryLess> IndexSet;
+typedef OrderStatisticTree<KeyStringEntry, KeyStringEntryLess> IndexCounts;
+
+/**
+ * The "persistent" data of an index: its entries and the memory they use, which is charged to
+ * the engine's budget when there is one.
+ *
+ * Indexes created with the 'rangeCounts' option also keep a copy of their entries in 'counts'
+ * so that the number of entries in a range can be found without walking them.
+ */
+struct IndexData {
+    // Estimated bytes per entry beyond its key: the entry and its set node.
+    static const int64_t kEntryOverheadBytes = sizeof(KeyStringEntry) + 4 * sizeof(void*);
+
+    // Estimated bytes per entry for its copy in 'counts': the copied key and the tree node.
+    static const int64_t kCountsOverheadBytes = sizeof(KeyStringEntry) + 5 * sizeof(void*);
+
+    ~IndexData() {
+        if (budget)
+            budget->adjust(-memoryBytes());
+    }
+
+    int64_t memoryBytes() const {
+        const int64_t numEntries = static_cast<int64_t>(entries.size());
+        int64_t bytes = keyBytes + numEntries * kEntryOverheadBytes;
+        if (counts)
+            bytes += keyBytes + numEntries * kCountsOverheadBytes;
+        return bytes;
+    }
+
+    // Bytes charged for holding 'entry'.
+    int64_t bytesFor(const KeyStringEntry& entry) const {
+        const int64_t size = entry.size();
+        return size + kEntryOverheadBytes + (counts ? size + kCountsOverheadBytes : 0);
+    }
+
+    Status checkRoomFor(const KeyStringEntry& entry) const {
+        if (!budget)
+            return Status::OK();
+        return budget->checkRoomFor(bytesFor(entry));
+    }
+
+    // Account for an entry just added to or removed from 'entries'.
+    void added(const KeyStringEntry& entry) {
+        keyBytes += entry.size();
+        if (counts)
+            counts->insert(entry);
+        if (budget)
+            budget->adjust(bytesFor(entry));
+    }
+    void removed(const KeyStringEntry& entry) {
+        keyBytes -= entry.size();
+        if (counts)
+            counts->erase(entry);
+        if (budget)
+            budget->adjust(-bytesFor(entry));
+    }
+
+    // Starts keeping order statistics for the entries, building them from those present.
+    void enableCounts() {
+        if (counts)
+            return;
+        const int64_t before = memoryBytes();
+        counts = stdx::make_unique<IndexCounts>();
+        for (const KeyStringEntry& entry : entries) {
+            counts->insert(entry);
+        }
+        if (budget)
+            budget->adjust(memoryBytes() - before);
+    }
+
+    IndexSet entries;
+    std::unique_ptr<IndexCounts> counts;
+    int64_t keyBytes = 0;
+    InMemoryMemoryBudget* budget = nullptr;  // not owned
+};
 
 // taken from btree_logic.cpp
 Status dupKeyError(const BSONObj& key) {
@@ -80,23 +214,24 @@ Status dupKeyError(const BSONObj& key) {
     return Status(ErrorCodes::DuplicateKey, sb.str());
 }
 
-bool isDup(const IndexSet& data, const BSONObj& key, RecordId loc) {
-    const IndexSet::const_iterator it = data.find(IndexKeyEntry(key, RecordId()));
-    if (it == data.end())
-        return false;
-
-    // Not a dup if the entry is for the same loc.
-    return it->loc != loc;
+bool isDup(const IndexSet& data, const KeyString& key, RecordId loc) {
+    // Entries for the same key are ordered by RecordId, so this finds the first of them.
+    const KeyStringEntry first(key, RecordId::min());
+    for (IndexSet::const_iterator it = data.lower_bound(first);
+         it != data.end() && it->key() == first.key();
+         ++it) {
+        // Not a dup if the entry is for the same loc.
+        if (it->loc() != loc)
+            return true;
+    }
+    return false;
 }
 
 class InMemoryBtreeBuilderImpl : public SortedDataBuilderInterface {
 public:
-    InMemoryBtreeBuilderImpl(IndexSet* data, long long* currentKeySize, bool dupsAllowed)
-        : _data(data),
-          _currentKeySize(currentKeySize),
-          _dupsAllowed(dupsAllowed),
-          _comparator(_data->key_comp()) {
-        invariant(_data->empty());
+    InMemoryBtreeBuilderImpl(IndexData* data, Ordering ordering, bool dupsAllowed)
+        : _data(data), _ordering(ordering), _dupsAllowed(dupsAllowed) {
+        invariant(_data->entries.empty());
     }
 
     Status addKey(const BSONObj& key, const RecordId& loc) {
@@ -109,41 +244,42 @@ public:
         invariant(loc.isNormal());
         invariant(!hasFieldNames(key));
 
-        if (!_data->empty()) {
+        KeyStringEntry entry(KeyString(key, _ordering), loc);
+        if (!_data->entries.empty()) {
             // Compare specified key with last inserted key, ignoring its RecordId
-            int cmp = _comparator.compare(IndexKeyEntry(key, RecordId()), *_last);
-            if (cmp < 0 || (_dupsAllowed && cmp == 0 && loc < _last->loc)) {
+            int cmp = entry.key().compare(_last->key());
+            if (cmp < 0 || (_dupsAllowed && cmp == 0 && loc < _last->loc())) {
                 return Status(ErrorCodes::InternalError,
                               "expected ascending (key, RecordId) order in bulk builder");
-            } else if (!_dupsAllowed && cmp == 0 && loc != _last->loc) {
+            } else if (!_dupsAllowed && cmp == 0 && loc != _last->loc()) {
                 return dupKeyError(key);
             }
         }
 
-        BSONObj owned = key.getOwned();
-        _last = _data->insert(_data->end(), IndexKeyEntry(owned, loc));
-        *_currentKeySize += key.objsize();
+        Status roomStatus = _data->checkRoomFor(entry);
+        if (!roomStatus.isOK())
+            return roomStatus;
+
+        _data->added(entry);
+        _last = _data->entries.insert(_data->entries.end(), std::move(entry));
 
         return Status::OK();
     }
 
 private:
-    IndexSet* const _data;
-    long long* _currentKeySize;
+    IndexData* const _data;
+    const Ordering _ordering;
     const bool _dupsAllowed;
 
-    IndexEntryComparison _comparator;  // used by the bulk builder to detect duplicate keys
-    IndexSet::const_iterator _last;    // or (key, RecordId) ordering violations
+    IndexSet::const_iterator _last;  // used to detect duplicate keys or ordering violations
 };
 
 class InMemoryBtreeImpl : public SortedDataInterface {
 public:
-    InMemoryBtreeImpl(IndexSet* data) : _data(data) {
-        _currentKeySize = 0;
-    }
+    InMemoryBtreeImpl(IndexData* data, Ordering ordering) : _data(data), _ordering(ordering) {}
 
     virtual SortedDataBuilderInterface* getBulkBuilder(OperationContext* txn, bool dupsAllowed) {
-        return new InMemoryBtreeBuilderImpl(_data, &_currentKeySize, dupsAllowed);
+        return new InMemoryBtreeBuilderImpl(_data, _ordering, dupsAllowed);
     }
 
     virtual Status insert(OperationContext* txn,
@@ -160,14 +296,20 @@ public:
             return Status(ErrorCodes::KeyTooLong, msg);
         }
 
+        const KeyString keyString(key, _ordering);
+
         // TODO optimization: save the iterator from the dup-check to speed up insert
-        if (!dupsAllowed && isDup(*_data, key, loc))
+        if (!dupsAllowed && isDup(_data->entries, keyString, loc))
             return dupKeyError(key);
 
-        IndexKeyEntry entry(key.getOwned(), loc);
-        if (_data->insert(entry).second) {
-            _currentKeySize += key.objsize();
-            txn->recoveryUnit()->registerChange(new IndexChange(_data, entry, true));
+        KeyStringEntry entry(keyString, loc);
+        Status roomStatus = _data->checkRoomFor(entry);
+        if (!roomStatus.isOK())
+            return roomStatus;
+
+        if (_data->entries.insert(entry).second) {
+            _data->added(entry);
+            txn->recoveryUnit()->registerChange(new IndexChange(_data, std::move(entry), true));
         }
         return Status::OK();
     }
@@ -179,12 +321,14 @@ public:
         invariant(loc.isNormal());
         invariant(!hasFieldNames(key));
 
-        IndexKeyEntry entry(key.getOwned(), loc);
-        const size_t numDeleted = _data->erase(entry);
-        invariant(numDeleted <= 1);
-        if (numDeleted == 1) {
-            _currentKeySize -= key.objsize();
-            txn->recoveryUnit()->registerChange(new IndexChange(_data, entry, false));
+        const KeyStringEntry query(KeyString(key, _ordering), loc);
+        const IndexSet::iterator it = _data->entries.find(query);
+        if (it != _data->entries.end()) {
+            // Keep the stored entry for rollback since its TypeBits may differ from 'key'.
+            KeyStringEntry entry = *it;
+            _data->entries.erase(it);
+            _data->removed(entry);
+            txn->recoveryUnit()->registerChange(new IndexChange(_data, std::move(entry), false));
         }
     }
 
@@ -193,28 +337,29 @@ public:
                               long long* numKeysOut,
                               BSONObjBuilder* output) const {
         // TODO check invariants?
-        *numKeysOut = _data->size();
+        *numKeysOut = _data->entries.size();
     }
 
     virtual bool appendCustomStats(OperationContext* txn,
                                    BSONObjBuilder* output,
                                    double scale) const {
-        return false;
+        output->appendIntOrLL("memoryBytes", _data->memoryBytes() / scale);
+        return true;
     }
 
     virtual long long getSpaceUsedBytes(OperationContext* txn) const {
-        return _currentKeySize + (sizeof(IndexKeyEntry) * _data->size());
+        return _data->memoryBytes();
     }
 
     virtual Status dupKeyCheck(OperationContext* txn, const BSONObj& key, const RecordId& loc) {
         invariant(!hasFieldNames(key));
-        if (isDup(*_data, key, loc))
+        if (isDup(_data->entries, KeyString(key, _ordering), loc))
             return dupKeyError(key);
         return Status::OK();
     }
 
     virtual bool isEmpty(OperationContext* txn) {
-        return _data->empty();
+        return _data->entries.empty();
     }
 
     virtual Status touch(OperationContext* txn) const {
@@ -222,10 +367,38 @@ public:
         return Status::OK();
     }
 
+    virtual boost::optional<long long> countRange(OperationContext* txn,
+                                                  const BSONObj& startKey,
+                                                  bool startInclusive,
+                                                  const BSONObj& endKey,
+                                                  bool endInclusive) const {
+        if (!_data->counts)
+            return boost::none;
+
+        // The discriminators place each query between index keys, using the same rules as a
+        // forward cursor's seek() and setEndPosition().
+        const KeyStringEntry start(
+            KeyString(stripFieldNames(startKey),
+                      _ordering,
+                      startInclusive ? KeyString::kExclusiveBefore : KeyString::kExclusiveAfter),
+            {});
+        long long endRank = _data->counts->size();
+        if (!endKey.isEmpty()) {
+            const KeyStringEntry end(
+                KeyString(stripFieldNames(endKey),
+                          _ordering,
+                          endInclusive ? KeyString::kExclusiveAfter : KeyString::kExclusiveBefore),
+                {});
+            endRank = _data->counts->countLess(end);
+        }
+        const long long startRank = _data->counts->countLess(start);
+        return std::max(0LL, endRank - startRank);
+    }
+
     class Cursor final : public SortedDataInterface::Cursor {
     public:
-        Cursor(OperationContext* txn, const IndexSet& data, bool isForward)
-            : _txn(txn), _data(data), _forward(isForward), _it(data.end()) {}
+        Cursor(OperationContext* txn, const IndexSet& data, Ordering ordering, bool isForward)
+            : _txn(txn), _data(data), _ordering(ordering), _forward(isForward), _it(data.end()) {}
 
         boost::optional<IndexKeyEntry> next(RequestedInfo parts) override {
             if (_lastMoveWasRestore) {
@@ -237,9 +410,7 @@ public:
                     _isEOF = true;
             }
 
-            if (_isEOF)
-                return {};
-            return *_it;
+            return curr(parts);
         }
 
         void setEndPosition(const BSONObj& key, bool inclusive) override {
@@ -249,36 +420,43 @@ public:
                 return;
             }
 
-            // NOTE: this uses the opposite min/max rules as a normal seek because a forward
-            // scan should land after the key if inclusive and before if exclusive.
-            _endState = EndState(stripFieldNames(key),
-                                 _forward == inclusive ? RecordId::max() : RecordId::min());
+            // NOTE: this uses the opposite rules as a normal seek because a forward scan should
+            // end after the key if inclusive and before if exclusive.
+            const auto discriminator =
+                _forward == inclusive ? KeyString::kExclusiveAfter : KeyString::kExclusiveBefore;
+            _endState = EndState(
+                KeyStringEntry(KeyString(stripFieldNames(key), _ordering, discriminator), {}));
             seekEndCursor();
         }
 
         boost::optional<IndexKeyEntry> seek(const BSONObj& key,
                                             bool inclusive,
                                             RequestedInfo parts) override {
-            const BSONObj query = stripFieldNames(key);
-            locate(query, _forward == inclusive ? RecordId::min() : RecordId::max());
+            const auto discriminator =
+                _forward == inclusive ? KeyString::kExclusiveBefore : KeyString::kExclusiveAfter;
+            const KeyStringEntry query(KeyString(stripFieldNames(key), _ordering, discriminator),
+                                       {});
+            locate(query);
             _lastMoveWasRestore = false;
             if (_isEOF)
                 return {};
-            dassert(inclusive ? compareKeys(_it->key, query) >= 0
-                              : compareKeys(_it->key, query) > 0);
-            return *_it;
+            dassert(compareKeys(_it->key(), query.key()) > 0);
+            return curr(parts);
         }
 
         boost::optional<IndexKeyEntry> seek(const IndexSeekPoint& seekPoint,
                                             RequestedInfo parts) override {
-            // Query encodes exclusive case so it can be treated as an inclusive query.
-            const BSONObj query = IndexEntryComparison::makeQueryObject(seekPoint, _forward);
-            locate(query, _forward ? RecordId::min() : RecordId::max());
+            // makeQueryObject handles the discriminator in the real exclusive cases.
+            const BSONObj key = IndexEntryComparison::makeQueryObject(seekPoint, _forward);
+            const auto discriminator =
+                _forward ? KeyString::kExclusiveBefore : KeyString::kExclusiveAfter;
+            const KeyStringEntry query(KeyString(key, _ordering, discriminator), {});
+            locate(query);
             _lastMoveWasRestore = false;
             if (_isEOF)
                 return {};
-            dassert(compareKeys(_it->key, query) >= 0);
-            return *_it;
+            dassert(compareKeys(_it->key(), query.key()) > 0);
+            return curr(parts);
         }
 
         void save() override {
@@ -292,14 +470,12 @@ public:
                 return;
             }
 
-            _savedAtEnd = false;
-            _savedKey = _it->key.getOwned();
-            _savedLoc = _it->loc;
+            _savedPosition = *_it;
             // Doing nothing with end cursor since it will do full reseek on restore.
         }
 
         void saveUnpositioned() override {
-            _savedAtEnd = true;
+            _savedPosition = boost::none;
             // Doing nothing with end cursor since it will do full reseek on restore.
         }
 
@@ -309,16 +485,16 @@ public:
             // over them.
             seekEndCursor();
 
-            if (_savedAtEnd) {
+            if (!_savedPosition) {
                 _isEOF = true;
                 return;
             }
 
             // Need to find our position from the root.
-            locate(_savedKey, _savedLoc);
+            locate(*_savedPosition);
 
             _lastMoveWasRestore = _isEOF  // We weren't EOF but now are.
-                || _data.value_comp().compare(*_it, {_savedKey, _savedLoc}) != 0;
+                || _it->compare(*_savedPosition) != 0;
         }
 
         void detachFromOperationContext() final {
@@ -330,6 +506,18 @@ public:
         }
 
     private:
+        boost::optional<IndexKeyEntry> curr(RequestedInfo parts) const {
+            if (_isEOF)
+                return {};
+
+            // Decoding the KeyString is most of the cost of returning an entry, so it is only
+            // done when the caller wants the key.
+            BSONObj key;
+            if (parts & kWantKey)
+                key = _it->toBson(_ordering);
+            return {{std::move(key), _it->loc()}};
+        }
+
         bool atEndPoint() const {
             return _endState && _it == _endState->it;
         }
@@ -361,11 +549,10 @@ public:
             if (!_endState)
                 return false;
 
-            const int cmp = _data.value_comp().compare(*_it, _endState->query);
+            const int cmp = _it->compare(_endState->query);
 
-            // We set up _endState->query to be in between the last in-range value and the first
-            // out-of-range value. In particular, it is constructed to never equal any legal
-            // index key.
+            // The discriminator in _endState->query puts it in between the last in-range value
+            // and the first out-of-range value, so it never equals any legal index key.
             dassert(cmp != 0);
 
             if (_forward) {
@@ -377,16 +564,15 @@ public:
             }
         }
 
-        void locate(const BSONObj& key, const RecordId& loc) {
+        void locate(const KeyStringEntry& query) {
             _isEOF = false;
-            const auto query = IndexKeyEntry(key, loc);
             _it = _data.lower_bound(query);
             if (_forward) {
                 if (_it == _data.end())
                     _isEOF = true;
             } else {
                 // lower_bound lands us on or after query. Reverse cursors must be on or before.
-                if (_it == _data.end() || _data.value_comp().compare(*_it, query) > 0)
+                if (_it == _data.end() || _it->compare(query) > 0)
                     advance();  // sets _isEOF if there is nothing more to return.
             }
 
@@ -396,8 +582,8 @@ public:
 
         // Returns comparison relative to direction of scan. If rhs would be seen later, returns
         // a positive value.
-        int compareKeys(const BSONObj& lhs, const BSONObj& rhs) const {
-            int cmp = _data.value_comp().compare({lhs, RecordId()}, {rhs, RecordId()});
+        int compareKeys(StringData lhs, StringData rhs) const {
+            int cmp = lhs.compare(rhs);
             return _forward ? cmp : -cmp;
         }
 
@@ -408,7 +594,7 @@ public:
             auto it = _data.lower_bound(_endState->query);
             if (!_forward) {
                 // lower_bound lands us on or after query. Reverse cursors must be on or before.
-                if (it == _data.end() || _data.value_comp().compare(*it, _endState->query) > 0) {
+                if (it == _data.end() || it->compare(_endState->query) > 0) {
                     if (it == _data.begin()) {
                         it = _data.end();  // all existing data in range.
                     } else {
@@ -418,20 +604,21 @@ public:
             }
 
             if (it != _data.end())
-                dassert(compareKeys(it->key, _endState->query.key) >= 0);
+                dassert(compareKeys(it->key(), _endState->query.key()) >= 0);
             _endState->it = it;
         }
 
         OperationContext* _txn;  // not owned
         const IndexSet& _data;
+        const Ordering _ordering;
         const bool _forward;
         bool _isEOF = true;
         IndexSet::const_iterator _it;
 
         struct EndState {
-            EndState(BSONObj key, RecordId loc) : query(std::move(key), loc) {}
+            EndState(KeyStringEntry query) : query(std::move(query)) {}
 
-            IndexKeyEntry query;
+            KeyStringEntry query;
             IndexSet::const_iterator it;
         };
         boost::optional<EndState> _endState;
@@ -441,15 +628,14 @@ public:
         // pairs.
         bool _lastMoveWasRestore = false;
 
-        // For save/restore since _it may be invalidated during a yield.
-        bool _savedAtEnd = false;
-        BSONObj _savedKey;
-        RecordId _savedLoc;
+        // For save/restore since _it may be invalidated during a yield. Unset if saved at the
+        // end.
+        boost::optional<KeyStringEntry> _savedPosition;
     };
 
     virtual std::unique_ptr<SortedDataInterface::Cursor> newCursor(OperationContext* txn,
                                                                    bool isForward) const {
-        return stdx::make_unique<Cursor>(txn, *_data, isForward);
+        return stdx::make_unique<Cursor>(txn, _data->entries, _ordering, isForward);
     }
 
     virtual Status initAsEmpty(OperationContext* txn) {
@@ -460,37 +646,50 @@ public:
 private:
     class IndexChange : public RecoveryUnit::Change {
     public:
-        IndexChange(IndexSet* data, const IndexKeyEntry& entry, bool insert)
-            : _data(data), _entry(entry), _insert(insert) {}
+        IndexChange(IndexData* data, KeyStringEntry entry, bool insert)
+            : _data(data), _entry(std::move(entry)), _insert(insert) {}
 
         virtual void commit() {}
         virtual void rollback() {
-            if (_insert)
-                _data->erase(_entry);
-            else
-                _data->insert(_entry);
+            if (_insert) {
+                if (_data->entries.erase(_entry))
+                    _data->removed(_entry);
+            } else {
+                if (_data->entries.insert(_entry).second)
+                    _data->added(_entry);
+            }
         }
 
     private:
-        IndexSet* _data;
-        const IndexKeyEntry _entry;
+        IndexData* _data;
+        const KeyStringEntry _entry;
         const bool _insert;
     };
 
-    IndexSet* _data;
-    long long _currentKeySize;
+    IndexData* _data;
+    const Ordering _ordering;
 };
 }  // namespace
 
 // IndexCatalogEntry argument taken by non-const pointer for consistency with other Btree
 // factories. We don't actually modify it.
 SortedDataInterface* getInMemoryBtreeImpl(const Ordering& ordering,
-                                          std::shared_ptr<void>* dataInOut) {
+                                          std::shared_ptr<void>* dataInOut,
+                                          InMemoryMemoryBudget* budget,
+                                          bool rangeCounts) {
     invariant(dataInOut);
     if (!*dataInOut) {
-        *dataInOut = std::make_shared<IndexSet>(IndexEntryComparison(ordering));
+        *dataInOut = std::make_shared<IndexData>();
+    }
+    IndexData* data = static_cast<IndexData*>(dataInOut->get());
+    if (budget && !data->budget) {
+        data->budget = budget;
+        budget->adjust(data->memoryBytes());
     }
-    return new InMemoryBtreeImpl(static_cast<IndexSet*>(dataInOut->get()));
+    invariant(!budget || data->budget == budget);
+    if (rangeCounts)
+        data->enableCounts();
+    return new InMemoryBtreeImpl(data, ordering);
 }
 
 }  // namespace mongo
@@ -36,12 +36,19 @@
 namespace mongo {
 
 class IndexCatalogEntry;
+class InMemoryMemoryBudget;
 
 /**
  * Caller takes ownership.
  * All permanent data will be stored and fetch from dataInOut.
+ * If 'budget' is given, the index's memory is charged to it and inserts fail with
+ * ExceededMemoryLimit once it is full.
+ * If 'rangeCounts' is true, the index keeps order statistics so countRange() can answer without
+ * a scan. This costs about twice the memory per entry.
  */
 SortedDataInterface* getInMemoryBtreeImpl(const Ordering& ordering,
-                                          std::shared_ptr<void>* dataInOut);
+                                          std::shared_ptr<void>* dataInOut,
+                                          InMemoryMemoryBudget* budget = nullptr,
+                                          bool rangeCounts = false);
 
 }  // namespace mongo
@@ -31,6 +31,7 @@
 #include "mongo/db/storage/in_memory/in_memory_btree_impl.h"
 
 
+#include "mongo/db/operation_context_noop.h"
 #include "mongo/db/storage/in_memory/in_memory_recovery_unit.h"
 #include "mongo/db/storage/sorted_data_interface_test_harness.h"
 #include "mongo/stdx/memory.h"
@@ -58,4 +59,81 @@ private:
 std::unique_ptr<HarnessHelper> newHarnessHelper() {
     return stdx::make_unique<InMemoryHarnessHelper>();
 }
+
+namespace {
+
+void insertKeys(OperationContext* txn, SortedDataInterface* sorted, int numKeys, bool commit) {
+    WriteUnitOfWork uow(txn);
+    for (int i = 0; i < numKeys; i++) {
+        // Two entries per key.
+        ASSERT_OK(sorted->insert(txn, BSON("" << i), RecordId(2 * i + 1), true));
+        ASSERT_OK(sorted->insert(txn, BSON("" << i), RecordId(2 * i + 2), true));
+    }
+    if (commit)
+        uow.commit();
+}
+
+TEST(InMemoryBtreeImpl, CountRangeNeedsOption) {
+    OperationContextNoop txn(new InMemoryRecoveryUnit());
+    std::shared_ptr<void> data;
+    std::unique_ptr<SortedDataInterface> sorted(
+        getInMemoryBtreeImpl(Ordering::make(BSONObj()), &data));
+    insertKeys(&txn, sorted.get(), 10, true);
+
+    ASSERT_FALSE(sorted->countRange(&txn, BSON("" << 0), true, BSON("" << 9), true));
+}
+
+TEST(InMemoryBtreeImpl, CountRangeHonorsBounds) {
+    OperationContextNoop txn(new InMemoryRecoveryUnit());
+    std::shared_ptr<void> data;
+    std::unique_ptr<SortedDataInterface> sorted(
+        getInMemoryBtreeImpl(Ordering::make(BSONObj()), &data, nullptr, true));
+    insertKeys(&txn, sorted.get(), 100, true);
+
+    ASSERT_EQUALS(200, *sorted->countRange(&txn, BSON("" << 0), true, BSONObj(), true));
+    ASSERT_EQUALS(20, *sorted->countRange(&txn, BSON("" << 10), true, BSON("" << 19), true));
+    ASSERT_EQUALS(18, *sorted->countRange(&txn, BSON("" << 10), false, BSON("" << 19), true));
+    ASSERT_EQUALS(16, *sorted->countRange(&txn, BSON("" << 10), false, BSON("" << 19), false));
+    ASSERT_EQUALS(2, *sorted->countRange(&txn, BSON("" << 5), true, BSON("" << 5), true));
+    ASSERT_EQUALS(0, *sorted->countRange(&txn, BSON("" << 5), false, BSON("" << 5), true));
+    ASSERT_EQUALS(0, *sorted->countRange(&txn, BSON("" << 200), true, BSON("" << 300), true));
+
+    // Field names in the bounds are ignored, as they are by cursors.
+    ASSERT_EQUALS(4, *sorted->countRange(&txn, BSON("a" << 1.5), true, BSON("a" << 3.5), true));
+}
+
+TEST(InMemoryBtreeImpl, CountRangeTracksRemovesAndRollback) {
+    OperationContextNoop txn(new InMemoryRecoveryUnit());
+    std::shared_ptr<void> data;
+    std::unique_ptr<SortedDataInterface> sorted(
+        getInMemoryBtreeImpl(Ordering::make(BSONObj()), &data, nullptr, true));
+    insertKeys(&txn, sorted.get(), 10, true);
+
+    {
+        WriteUnitOfWork uow(&txn);
+        sorted->unindex(&txn, BSON("" << 3), RecordId(7), true);
+        uow.commit();
+    }
+    ASSERT_EQUALS(19, *sorted->countRange(&txn, BSON("" << 0), true, BSON("" << 9), true));
+
+    // Inserting with rollback leaves the counts unchanged.
+    std::shared_ptr<void> otherData;
+    std::unique_ptr<SortedDataInterface> other(
+        getInMemoryBtreeImpl(Ordering::make(BSONObj()), &otherData, nullptr, true));
+    insertKeys(&txn, other.get(), 10, false);
+    ASSERT_EQUALS(0, *other->countRange(&txn, BSON("" << 0), true, BSON("" << 9), true));
+}
+
+TEST(InMemoryBtreeImpl, CountRangeBuiltForExistingEntries) {
+    OperationContextNoop txn(new InMemoryRecoveryUnit());
+    std::shared_ptr<void> data;
+    std::unique_ptr<SortedDataInterface> sorted(
+        getInMemoryBtreeImpl(Ordering::make(BSONObj()), &data));
+    insertKeys(&txn, sorted.get(), 10, true);
+
+    sorted.reset(getInMemoryBtreeImpl(Ordering::make(BSONObj()), &data, nullptr, true));
+    ASSERT_EQUALS(6, *sorted->countRange(&txn, BSON("" << 2), true, BSON("" << 4), true));
+}
+
+}  // namespace
 }
@@ -37,6 +37,8 @@
 
 namespace mongo {
 
+const char InMemoryEngine::kStorageEngineName[] = "inMemoryExperiment";
+
 RecoveryUnit* InMemoryEngine::newRecoveryUnit() {
     return new InMemoryRecoveryUnit();
 }
@@ -53,16 +55,23 @@ RecordStore* InMemoryEngine::getRecordStore(OperationContext* opCtx,
                                             StringData ns,
                                             StringData ident,
                                             const CollectionOptions& options) {
+    const bool evictWhenFull = uassertStatusOK(InMemoryRecordStore::parseOptionsField(
+        options.storageEngine.getObjectField(kStorageEngineName)));
+
     stdx::lock_guard<stdx::mutex> lk(_mutex);
+    InMemoryRecordStore* rs;
     if (options.capped) {
-        return new InMemoryRecordStore(ns,
-                                       &_dataMap[ident],
-                                       true,
-                                       options.cappedSize ? options.cappedSize : 4096,
-                                       options.cappedMaxDocs ? options.cappedMaxDocs : -1);
+        rs = new InMemoryRecordStore(ns,
+                                     &_dataMap[ident],
+                                     true,
+                                     options.cappedSize ? options.cappedSize : 4096,
+                                     options.cappedMaxDocs ? options.cappedMaxDocs : -1);
     } else {
-        return new InMemoryRecordStore(ns, &_dataMap[ident]);
+        rs = new InMemoryRecordStore(ns, &_dataMap[ident]);
     }
+    // Capped collections already bound their own size, so they never evict for the budget.
+    rs->setMemoryBudget(&_memoryBudget, evictWhenFull && !options.capped);
+    return rs;
 }
 
 Status InMemoryEngine::createSortedDataInterface(OperationContext* opCtx,
@@ -76,7 +85,10 @@ SortedDataInterface* InMemoryEngine::getSortedDataInterface(OperationContext* op
                                                             StringData ident,
                                                             const IndexDescriptor* desc) {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
-    return getInMemoryBtreeImpl(Ordering::make(desc->keyPattern()), &_dataMap[ident]);
+    return getInMemoryBtreeImpl(Ordering::make(desc->keyPattern()),
+                                &_dataMap[ident],
+                                &_memoryBudget,
+                                desc->getInfoElement("rangeCounts").trueValue());
 }
 
 Status InMemoryEngine::dropIdent(OperationContext* opCtx, StringData ident) {
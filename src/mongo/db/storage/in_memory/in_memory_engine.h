@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include "mongo/db/storage/in_memory/in_memory_memory_budget.h"
 #include "mongo/db/storage/kv/kv_engine.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/string_map.h"
@@ -38,6 +39,18 @@ namespace mongo {
 
 class InMemoryEngine : public KVEngine {
 public:
+    /**
+     * Name under which collection options for this engine are found in
+     * CollectionOptions::storageEngine.
+     */
+    static const char kStorageEngineName[];
+
+    /**
+     * Limits the memory used by all records and index entries to 'maxMemoryBytes', or tracks it
+     * without a limit if 0.
+     */
+    explicit InMemoryEngine(int64_t maxMemoryBytes = 0) : _memoryBudget(maxMemoryBytes) {}
+
     virtual RecoveryUnit* newRecoveryUnit();
 
     virtual Status createRecordStore(OperationContext* opCtx,
@@ -90,9 +103,16 @@ public:
 
     std::vector<std::string> getAllIdents(OperationContext* opCtx) const;
 
+    const InMemoryMemoryBudget& getMemoryBudget() const {
+        return _memoryBudget;
+    }
+
 private:
     typedef StringMap<std::shared_ptr<void>> DataMap;
 
+    // Declared before _dataMap since the data releases its memory here when destroyed.
+    InMemoryMemoryBudget _memoryBudget;
+
     mutable stdx::mutex _mutex;
     DataMap _dataMap;  // All actual data is owned in here
 };
@@ -30,8 +30,10 @@
  */
 
 #include "mongo/base/init.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/in_memory/in_memory_engine.h"
+#include "mongo/db/storage/in_memory/in_memory_record_store.h"
 #include "mongo/db/storage/kv/kv_storage_engine.h"
 #include "mongo/db/storage_options.h"
 
@@ -39,6 +41,9 @@ namespace mongo {
 
 namespace {
 
+// Upper bound on the memory used by all records and index entries, or 0 for no limit.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(inMemoryExperimentMaxBytes, long long, 0);
+
 class InMemoryFactory : public StorageEngine::Factory {
 public:
     virtual ~InMemoryFactory() {}
@@ -47,11 +52,15 @@ public:
         KVStorageEngineOptions options;
         options.directoryPerDB = params.directoryperdb;
         options.forRepair = params.repair;
-        return new KVStorageEngine(new InMemoryEngine(), options);
+        return new KVStorageEngine(new InMemoryEngine(inMemoryExperimentMaxBytes), options);
     }
 
     virtual StringData getCanonicalName() const {
-        return "inMemoryExperiment";
+        return InMemoryEngine::kStorageEngineName;
+    }
+
+    virtual Status validateCollectionStorageOptions(const BSONObj& options) const {
+        return InMemoryRecordStore::parseOptionsField(options).getStatus();
     }
 
     virtual Status validateMetadata(const StorageEngineMetadata& metadata,
@@ -68,7 +77,8 @@ public:
 
 MONGO_INITIALIZER_WITH_PREREQUISITES(InMemoryEngineInit, ("SetGlobalEnvironment"))
 (InitializerContext* context) {
-    getGlobalServiceContext()->registerStorageEngine("inMemoryExperiment", new InMemoryFactory());
+    getGlobalServiceContext()->registerStorageEngine(InMemoryEngine::kStorageEngineName,
+                                                     new InMemoryFactory());
     return Status::OK();
 }
 
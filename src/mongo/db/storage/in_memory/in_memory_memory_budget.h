@@ -0,0 +1,92 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+/**
+ * Tracks the memory used by the records and index entries of an InMemoryEngine against an
+ * optional limit. One instance is shared by all of an engine's record stores and indexes, which
+ * adjust it as their contents change and check it before growing.
+ */
+class InMemoryMemoryBudget {
+    MONGO_DISALLOW_COPYING(InMemoryMemoryBudget);
+
+public:
+    /**
+     * A 'maxBytes' of 0 means there is no limit and only usage is tracked.
+     */
+    explicit InMemoryMemoryBudget(int64_t maxBytes) : _maxBytes(maxBytes) {}
+
+    bool isLimited() const {
+        return _maxBytes > 0;
+    }
+
+    int64_t maxBytes() const {
+        return _maxBytes;
+    }
+
+    int64_t bytesUsed() const {
+        return _bytesUsed.load();
+    }
+
+    /**
+     * Usage that collections which evict when full free memory down to, so that eviction runs in
+     * batches and leaves room for the index entries of the record that triggered it.
+     */
+    int64_t evictionTargetBytes() const {
+        return _maxBytes - _maxBytes / 10;
+    }
+
+    /**
+     * Returns ExceededMemoryLimit if using 'bytes' more would take usage over the limit.
+     * Does not reserve anything; callers adjust() once they have actually grown.
+     */
+    Status checkRoomFor(int64_t bytes) const;
+
+    void adjust(int64_t deltaBytes) {
+        _bytesUsed.fetchAndAdd(deltaBytes);
+    }
+
+    void appendStats(BSONObjBuilder* builder, double scale) const;
+
+private:
+    const int64_t _maxBytes;
+    AtomicInt64 _bytesUsed;
+};
+
+}  // namespace mongo
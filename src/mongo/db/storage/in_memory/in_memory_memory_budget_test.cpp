@@ -0,0 +1,180 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/in_memory/in_memory_memory_budget.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/operation_context_noop.h"
+#include "mongo/db/storage/in_memory/in_memory_btree_impl.h"
+#include "mongo/db/storage/in_memory/in_memory_record_store.h"
+#include "mongo/db/storage/in_memory/in_memory_recovery_unit.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const int kRecordSize = 1000;
+
+StatusWith<RecordId> insert(OperationContext* txn, RecordStore* rs, bool commit = true) {
+    const std::string data(kRecordSize, 'x');
+    WriteUnitOfWork uow(txn);
+    StatusWith<RecordId> result = rs->insertRecord(txn, data.c_str(), data.size(), false);
+    if (result.isOK() && commit)
+        uow.commit();
+    return result;
+}
+
+TEST(InMemoryMemoryBudget, ChecksRoomAgainstLimit) {
+    InMemoryMemoryBudget budget(100);
+    ASSERT_OK(budget.checkRoomFor(100));
+    budget.adjust(60);
+    ASSERT_OK(budget.checkRoomFor(40));
+    ASSERT_EQUALS(ErrorCodes::ExceededMemoryLimit, budget.checkRoomFor(41).code());
+    budget.adjust(-60);
+    ASSERT_EQUALS(0, budget.bytesUsed());
+
+    InMemoryMemoryBudget unlimited(0);
+    unlimited.adjust(1000);
+    ASSERT_OK(unlimited.checkRoomFor(1 << 30));
+}
+
+TEST(InMemoryMemoryBudget, RecordStoreChargesAndReleases) {
+    InMemoryMemoryBudget budget(0);
+    OperationContextNoop txn(new InMemoryRecoveryUnit());
+    std::shared_ptr<void> data;
+    {
+        InMemoryRecordStore rs("a.b", &data);
+        rs.setMemoryBudget(&budget, false);
+        ASSERT_OK(insert(&txn, &rs).getStatus());
+        ASSERT_EQUALS(rs.memoryBytes(), budget.bytesUsed());
+        ASSERT_GREATER_THAN(budget.bytesUsed(), kRecordSize);
+
+        // A rolled back insert gives its memory back.
+        const long long before = budget.bytesUsed();
+        ASSERT_OK(insert(&txn, &rs, false).getStatus());
+        ASSERT_EQUALS(before, budget.bytesUsed());
+    }
+
+    // Dropping the data releases everything it used.
+    data.reset();
+    ASSERT_EQUALS(0, budget.bytesUsed());
+}
+
+TEST(InMemoryMemoryBudget, RejectsInsertsWhenFull) {
+    InMemoryMemoryBudget budget(3 * kRecordSize);
+    OperationContextNoop txn(new InMemoryRecoveryUnit());
+    std::shared_ptr<void> data;
+    InMemoryRecordStore rs("a.b", &data);
+    rs.setMemoryBudget(&budget, false);
+
+    ASSERT_OK(insert(&txn, &rs).getStatus());
+    ASSERT_OK(insert(&txn, &rs).getStatus());
+    ASSERT_EQUALS(ErrorCodes::ExceededMemoryLimit, insert(&txn, &rs).getStatus().code());
+    ASSERT_EQUALS(2, rs.numRecords(&txn));
+}
+
+TEST(InMemoryMemoryBudget, EvictsOldestRecordsWhenFull) {
+    InMemoryMemoryBudget budget(5 * kRecordSize);
+    OperationContextNoop txn(new InMemoryRecoveryUnit());
+    std::shared_ptr<void> data;
+    InMemoryRecordStore rs("a.b", &data);
+    rs.setMemoryBudget(&budget, true);
+
+    std::vector<RecordId> ids;
+    for (int i = 0; i < 20; i++) {
+        StatusWith<RecordId> result = insert(&txn, &rs);
+        ASSERT_OK(result.getStatus());
+        ids.push_back(result.getValue());
+        ASSERT_LESS_THAN_OR_EQUALS(budget.bytesUsed(), budget.maxBytes());
+    }
+
+    // The newest records are kept and the oldest ones evicted.
+    ASSERT_LESS_THAN(rs.numRecords(&txn), 20);
+    RecordData rd;
+    ASSERT_TRUE(rs.findRecord(&txn, ids.back(), &rd));
+    ASSERT_FALSE(rs.findRecord(&txn, ids.front(), &rd));
+}
+
+TEST(InMemoryMemoryBudget, IndexChargesAndRejects) {
+    InMemoryMemoryBudget budget(1000);
+    OperationContextNoop txn(new InMemoryRecoveryUnit());
+    std::shared_ptr<void> data;
+    std::unique_ptr<SortedDataInterface> sorted(
+        getInMemoryBtreeImpl(Ordering::make(BSONObj()), &data, &budget));
+
+    Status status = Status::OK();
+    int inserted = 0;
+    for (; inserted < 1000 && status.isOK(); inserted++) {
+        WriteUnitOfWork uow(&txn);
+        status = sorted->insert(&txn, BSON("" << inserted), RecordId(inserted + 1), true);
+        if (status.isOK())
+            uow.commit();
+    }
+    ASSERT_EQUALS(ErrorCodes::ExceededMemoryLimit, status.code());
+    ASSERT_GREATER_THAN(inserted, 1);
+    ASSERT_EQUALS(sorted->getSpaceUsedBytes(&txn), budget.bytesUsed());
+
+    sorted.reset();
+    data.reset();
+    ASSERT_EQUALS(0, budget.bytesUsed());
+}
+
+TEST(InMemoryMemoryBudget, IndexChargesForRangeCounts) {
+    InMemoryMemoryBudget budget(1000 * 1000);
+    OperationContextNoop txn(new InMemoryRecoveryUnit());
+    std::shared_ptr<void> data;
+    std::unique_ptr<SortedDataInterface> sorted(
+        getInMemoryBtreeImpl(Ordering::make(BSONObj()), &data, &budget));
+    for (int i = 0; i < 100; i++) {
+        WriteUnitOfWork uow(&txn);
+        ASSERT_OK(sorted->insert(&txn, BSON("" << i), RecordId(i + 1), true));
+        uow.commit();
+    }
+    const int64_t withoutCounts = budget.bytesUsed();
+
+    // Turning on range counts charges for the copy of the existing entries.
+    sorted.reset(getInMemoryBtreeImpl(Ordering::make(BSONObj()), &data, &budget, true));
+    ASSERT_GREATER_THAN(budget.bytesUsed(), withoutCounts);
+    ASSERT_EQUALS(sorted->getSpaceUsedBytes(&txn), budget.bytesUsed());
+
+    {
+        WriteUnitOfWork uow(&txn);
+        sorted->unindex(&txn, BSON("" << 0), RecordId(1), true);
+        uow.commit();
+    }
+    ASSERT_EQUALS(sorted->getSpaceUsedBytes(&txn), budget.bytesUsed());
+
+    sorted.reset();
+    data.reset();
+    ASSERT_EQUALS(0, budget.bytesUsed());
+}
+
+}  // namespace
+}  // namespace mongo
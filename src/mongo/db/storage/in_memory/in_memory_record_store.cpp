@@ -57,6 +57,7 @@ public:
         if (it != _data->records.end()) {
             _data->dataSize -= it->second.size;
             _data->records.erase(it);
+            _data->updateMemoryUsage();
         }
     }
 
@@ -80,6 +81,7 @@ public:
 
         _data->dataSize += _rec.size;
         _data->records[_loc] = _rec;
+        _data->updateMemoryUsage();
     }
 
 private:
@@ -94,6 +96,7 @@ public:
         using std::swap;
         swap(_dataSize, _data->dataSize);
         swap(_records, _data->records);
+        _data->updateMemoryUsage();
     }
 
     virtual void commit() {}
@@ -101,6 +104,7 @@ public:
         using std::swap;
         swap(_dataSize, _data->dataSize);
         swap(_records, _data->records);
+        _data->updateMemoryUsage();
     }
 
 private:
@@ -321,6 +325,7 @@ void InMemoryRecordStore::deleteRecord(OperationContext* txn, const RecordId& lo
     txn->recoveryUnit()->registerChange(new RemoveChange(_data, loc, *rec));
     _data->dataSize -= rec->size;
     invariant(_data->records.erase(loc) == 1);
+    _data->updateMemoryUsage();
 }
 
 bool InMemoryRecordStore::cappedAndNeedDelete(OperationContext* txn) const {
@@ -339,16 +344,66 @@ bool InMemoryRecordStore::cappedAndNeedDelete(OperationContext* txn) const {
 void InMemoryRecordStore::cappedDeleteAsNeeded(OperationContext* txn) {
     while (cappedAndNeedDelete(txn)) {
         invariant(!_data->records.empty());
+        deleteOldestRecord(txn);
+    }
+}
+
+void InMemoryRecordStore::deleteOldestRecord(OperationContext* txn) {
+    Records::iterator oldest = _data->records.begin();
+    RecordId id = oldest->first;
+    RecordData data = oldest->second.toRecordData();
 
-        Records::iterator oldest = _data->records.begin();
-        RecordId id = oldest->first;
-        RecordData data = oldest->second.toRecordData();
+    if (_cappedDeleteCallback)
+        uassertStatusOK(_cappedDeleteCallback->aboutToDeleteCapped(txn, id, data));
+
+    deleteRecord(txn, id);
+}
 
-        if (_cappedDeleteCallback)
-            uassertStatusOK(_cappedDeleteCallback->aboutToDeleteCapped(txn, id, data));
+Status InMemoryRecordStore::makeRoomFor(OperationContext* txn, int64_t bytes) {
+    InMemoryMemoryBudget* const budget = _data->budget;
+    if (!budget)
+        return Status::OK();
 
-        deleteRecord(txn, id);
+    Status status = budget->checkRoomFor(bytes);
+    if (status.isOK() || !_evictWhenFull)
+        return status;
+
+    // Like a capped collection, evict oldest first. Go down to the eviction target rather than
+    // just enough for this record so the next inserts do not each have to evict.
+    while (!_data->records.empty() &&
+           budget->bytesUsed() + bytes > budget->evictionTargetBytes()) {
+        deleteOldestRecord(txn);
     }
+
+    return budget->checkRoomFor(bytes);
+}
+
+void InMemoryRecordStore::setMemoryBudget(InMemoryMemoryBudget* budget, bool evictWhenFull) {
+    invariant(!_data->budget || _data->budget == budget);
+    _evictWhenFull = evictWhenFull;
+    if (!_data->budget) {
+        _data->budget = budget;
+        _data->chargedBytes = 0;
+        _data->updateMemoryUsage();
+    }
+}
+
+StatusWith<bool> InMemoryRecordStore::parseOptionsField(const BSONObj& options) {
+    bool evictWhenFull = false;
+    BSONForEach(elem, options) {
+        if (elem.fieldNameStringData() == "evictWhenFull") {
+            if (!elem.isBoolean()) {
+                return StatusWith<bool>(ErrorCodes::TypeMismatch,
+                                        "evictWhenFull must be a boolean");
+            }
+            evictWhenFull = elem.boolean();
+        } else {
+            return StatusWith<bool>(ErrorCodes::InvalidOptions,
+                                    str::stream() << "inMemoryExperiment storage engine option "
+                                                  << elem.fieldName() << " not supported");
+        }
+    }
+    return StatusWith<bool>(evictWhenFull);
 }
 
 StatusWith<RecordId> InMemoryRecordStore::extractAndCheckLocForOplog(const char* data,
@@ -373,6 +428,10 @@ StatusWith<RecordId> InMemoryRecordStore::insertRecord(OperationContext* txn,
         return StatusWith<RecordId>(ErrorCodes::BadValue, "object to insert exceeds cappedMaxSize");
     }
 
+    Status roomStatus = makeRoomFor(txn, len + Data::kRecordOverheadBytes);
+    if (!roomStatus.isOK())
+        return StatusWith<RecordId>(roomStatus);
+
     InMemoryRecord rec(len);
     memcpy(rec.data.get(), data, len);
 
@@ -389,12 +448,56 @@ StatusWith<RecordId> InMemoryRecordStore::insertRecord(OperationContext* txn,
     txn->recoveryUnit()->registerChange(new InsertChange(_data, loc));
     _data->dataSize += len;
     _data->records[loc] = rec;
+    _data->updateMemoryUsage();
 
     cappedDeleteAsNeeded(txn);
 
     return StatusWith<RecordId>(loc);
 }
 
+Status InMemoryRecordStore::insertRecords(OperationContext* txn,
+                                          std::vector<Record>* records,
+                                          bool enforceQuota) {
+    int64_t totalLength = 0;
+    for (const Record& record : *records) {
+        if (_isCapped && record.data.size() > _cappedMaxSize) {
+            // We use dataSize for capped rollover and we don't want to delete everything if we
+            // know this won't fit.
+            return Status(ErrorCodes::BadValue, "object to insert exceeds cappedMaxSize");
+        }
+        totalLength += record.data.size();
+    }
+
+    const int64_t numRecords = records->size();
+    Status roomStatus = makeRoomFor(txn, totalLength + numRecords * Data::kRecordOverheadBytes);
+    if (!roomStatus.isOK())
+        return roomStatus;
+
+    for (Record& record : *records) {
+        const int len = record.data.size();
+        InMemoryRecord rec(len);
+        memcpy(rec.data.get(), record.data.data(), len);
+
+        if (_data->isOplog) {
+            StatusWith<RecordId> status = extractAndCheckLocForOplog(record.data.data(), len);
+            if (!status.isOK())
+                return status.getStatus();
+            record.id = status.getValue();
+        } else {
+            record.id = allocateLoc();
+        }
+
+        txn->recoveryUnit()->registerChange(new InsertChange(_data, record.id));
+        _data->dataSize += len;
+        _data->records[record.id] = rec;
+    }
+    _data->updateMemoryUsage();
+
+    cappedDeleteAsNeeded(txn);
+
+    return Status::OK();
+}
+
 StatusWith<RecordId> InMemoryRecordStore::insertRecord(OperationContext* txn,
                                                        const DocWriter* doc,
                                                        bool enforceQuota) {
@@ -405,6 +508,10 @@ StatusWith<RecordId> InMemoryRecordStore::insertRecord(OperationContext* txn,
         return StatusWith<RecordId>(ErrorCodes::BadValue, "object to insert exceeds cappedMaxSize");
     }
 
+    Status roomStatus = makeRoomFor(txn, len + Data::kRecordOverheadBytes);
+    if (!roomStatus.isOK())
+        return StatusWith<RecordId>(roomStatus);
+
     InMemoryRecord rec(len);
     doc->writeDocument(rec.data.get());
 
@@ -421,6 +528,7 @@ StatusWith<RecordId> InMemoryRecordStore::insertRecord(OperationContext* txn,
     txn->recoveryUnit()->registerChange(new InsertChange(_data, loc));
     _data->dataSize += len;
     _data->records[loc] = rec;
+    _data->updateMemoryUsage();
 
     cappedDeleteAsNeeded(txn);
 
@@ -441,6 +549,13 @@ StatusWith<RecordId> InMemoryRecordStore::updateRecord(OperationContext* txn,
                 "failing update: objects in a capped ns cannot grow"};
     }
 
+    if (len > oldLen && _data->budget) {
+        // Growing updates do not evict since the oldest record may be the one being updated.
+        Status roomStatus = _data->budget->checkRoomFor(len - oldLen);
+        if (!roomStatus.isOK())
+            return StatusWith<RecordId>(roomStatus);
+    }
+
     if (notifier) {
         // The in-memory KV engine uses the invalidation framework (does not support
         // doc-locking), and therefore must notify that it is updating a document.
@@ -456,6 +571,7 @@ StatusWith<RecordId> InMemoryRecordStore::updateRecord(OperationContext* txn,
     txn->recoveryUnit()->registerChange(new RemoveChange(_data, loc, *oldRecord));
     _data->dataSize += len - oldLen;
     *oldRecord = newRecord;
+    _data->updateMemoryUsage();
 
     cappedDeleteAsNeeded(txn);
 
@@ -521,6 +637,7 @@ void InMemoryRecordStore::temp_cappedTruncateAfter(OperationContext* txn,
         _data->dataSize -= it->second.size;
         _data->records.erase(it++);
     }
+    _data->updateMemoryUsage();
 }
 
 Status InMemoryRecordStore::validate(OperationContext* txn,
@@ -557,6 +674,12 @@ void InMemoryRecordStore::appendCustomStats(OperationContext* txn,
         result->appendIntOrLL("max", _cappedMaxDocs);
         result->appendIntOrLL("maxSize", _cappedMaxSize / scale);
     }
+    result->appendIntOrLL("memoryBytes", _data->memoryBytes() / scale);
+    if (_data->budget) {
+        result->appendBool("evictWhenFull", _evictWhenFull);
+        BSONObjBuilder budgetBuilder(result->subobjStart("memoryBudget"));
+        _data->budget->appendStats(&budgetBuilder, scale);
+    }
 }
 
 Status InMemoryRecordStore::touch(OperationContext* txn, BSONObjBuilder* output) const {
@@ -576,8 +699,7 @@ int64_t InMemoryRecordStore::storageSize(OperationContext* txn,
                                          BSONObjBuilder* extraInfo,
                                          int infoLevel) const {
     // Note: not making use of extraInfo or infoLevel since we don't have extents
-    const int64_t recordOverhead = numRecords(txn) * sizeof(InMemoryRecord);
-    return _data->dataSize + recordOverhead;
+    return _data->memoryBytes();
 }
 
 RecordId InMemoryRecordStore::allocateLoc() {
@@ -30,11 +30,12 @@
 
 #pragma once
 
-#include <boost/shared_array.hpp>
 #include <map>
 
 #include "mongo/db/storage/capped_callback.h"
+#include "mongo/db/storage/in_memory/in_memory_memory_budget.h"
 #include "mongo/db/storage/record_store.h"
+#include "mongo/util/shared_buffer.h"
 
 namespace mongo {
 
@@ -69,6 +70,10 @@ public:
                                               const DocWriter* doc,
                                               bool enforceQuota);
 
+    virtual Status insertRecords(OperationContext* txn,
+                                 std::vector<Record>* records,
+                                 bool enforceQuota);
+
     virtual StatusWith<RecordId> updateRecord(OperationContext* txn,
                                               const RecordId& oldLocation,
                                               const char* data,
@@ -126,19 +131,21 @@ public:
                                         long long dataSize) {
         invariant(_data->records.size() == size_t(numRecords));
         _data->dataSize = dataSize;
+        _data->updateMemoryUsage();
     }
 
 protected:
     struct InMemoryRecord {
         InMemoryRecord() : size(0) {}
-        InMemoryRecord(int size) : size(size), data(new char[size]) {}
+        // The data shares one allocation with its reference count.
+        InMemoryRecord(int size) : size(size), data(SharedBuffer::allocate(size)) {}
 
         RecordData toRecordData() const {
             return RecordData(data.get(), size);
         }
 
         int size;
-        boost::shared_array<char> data;
+        SharedBuffer data;
     };
 
     virtual const InMemoryRecord* recordFor(const RecordId& loc) const;
@@ -157,6 +164,9 @@ public:
     void setCappedDeleteCallback(CappedDocumentDeleteCallback* cb) {
         _cappedDeleteCallback = cb;
     }
+    bool needsCappedDeleteCallback() const {
+        return _isCapped || _evictWhenFull;
+    }
     bool cappedMaxDocs() const {
         invariant(_isCapped);
         return _cappedMaxDocs;
@@ -166,6 +176,27 @@ public:
         return _cappedMaxSize;
     }
 
+    /**
+     * Charges this record store's data to 'budget' and checks the budget before inserts and
+     * growing updates. When the budget is full, inserts fail with ExceededMemoryLimit unless
+     * 'evictWhenFull' is set, in which case the oldest records of this collection are deleted
+     * to make room, through the CappedDocumentDeleteCallback as for capped collections.
+     */
+    void setMemoryBudget(InMemoryMemoryBudget* budget, bool evictWhenFull);
+
+    /**
+     * Bytes of memory used by the records, including per-record overhead.
+     */
+    int64_t memoryBytes() const {
+        return _data->memoryBytes();
+    }
+
+    /**
+     * Parses the collection options for this engine: {evictWhenFull: <bool>}. Returns whether
+     * the collection evicts when full.
+     */
+    static StatusWith<bool> parseOptionsField(const BSONObj& options);
+
 private:
     class InsertChange;
     class RemoveChange;
@@ -179,21 +210,53 @@ private:
     RecordId allocateLoc();
     bool cappedAndNeedDelete(OperationContext* txn) const;
     void cappedDeleteAsNeeded(OperationContext* txn);
+    void deleteOldestRecord(OperationContext* txn);
+
+    // Makes sure the budget has room for 'bytes' more, evicting if this collection may.
+    Status makeRoomFor(OperationContext* txn, int64_t bytes);
 
     // TODO figure out a proper solution to metadata
     const bool _isCapped;
     const int64_t _cappedMaxSize;
     const int64_t _cappedMaxDocs;
     CappedDocumentDeleteCallback* _cappedDeleteCallback;
+    bool _evictWhenFull = false;
 
     // This is the "persistent" data.
     struct Data {
+        // Estimated bytes per record beyond its data: the map node and the buffer header.
+        static const int64_t kRecordOverheadBytes =
+            sizeof(Records::value_type) + 4 * sizeof(void*) + sizeof(SharedBuffer::Holder);
+
         Data(bool isOplog) : dataSize(0), nextId(1), isOplog(isOplog) {}
 
+        ~Data() {
+            if (budget)
+                budget->adjust(-chargedBytes);
+        }
+
+        int64_t memoryBytes() const {
+            return dataSize + static_cast<int64_t>(records.size()) * kRecordOverheadBytes;
+        }
+
+        /**
+         * Brings the budget up to date with the current contents. Must be called after anything,
+         * including a rollback, changes the records or dataSize.
+         */
+        void updateMemoryUsage() {
+            const int64_t bytes = memoryBytes();
+            if (budget)
+                budget->adjust(bytes - chargedBytes);
+            chargedBytes = bytes;
+        }
+
         int64_t dataSize;
         Records records;
         int64_t nextId;
         const bool isOplog;
+
+        InMemoryMemoryBudget* budget = nullptr;  // not owned
+        int64_t chargedBytes = 0;                // what this data has added to the budget
     };
 
     Data* const _data;
@@ -34,6 +34,7 @@
 
 #include "mongo/db/storage/key_string.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "mongo/base/data_view.h"
@@ -41,6 +42,7 @@
 #include "mongo/platform/strnlen.h"
 #include "mongo/util/hex.h"
 #include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
@@ -183,10 +185,23 @@ const uint8_t kGreater = 254;
 
 // some utility functions
 namespace {
+/**
+ * Copies 'bytes' bytes from 'src' to 'dst', flipping every bit. Works a word at a time, which the
+ * compiler can vectorize. 'dst' may equal 'src' to flip the bits in place.
+ */
 void memcpy_flipBits(void* dst, const void* src, size_t bytes) {
     const char* input = static_cast<const char*>(src);
     char* output = static_cast<char*>(dst);
     const char* const end = input + bytes;
+
+    for (; end - input >= static_cast<ptrdiff_t>(sizeof(uint64_t));
+         input += sizeof(uint64_t), output += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, input, sizeof(word));
+        word = ~word;
+        memcpy(output, &word, sizeof(word));
+    }
+
     while (input != end) {
         *output++ = ~(*input++);
     }
@@ -238,23 +253,24 @@ string readInvertedCString(BufReader* reader) {
     const char* end = static_cast<const char*>(memchr(start, 0xFF, reader->remaining()));
     invariant(end);
     size_t actualBytes = end - start;
-    string s(start, actualBytes);
-    for (size_t i = 0; i < s.size(); i++) {
-        s[i] = ~s[i];
-    }
+    string s(actualBytes, '\0');
+    memcpy_flipBits(&s[0], start, actualBytes);
     reader->skip(1 + actualBytes);
     return s;
 }
 
 string readInvertedCStringWithNuls(BufReader* reader) {
     std::string out;
+    bool firstPass = true;
     do {
-        if (!out.empty()) {
+        if (!firstPass) {
             // If this isn't our first pass through the loop it means we hit an NUL byte
-            // encoded as "\xFF\00" in our inverted string.
+            // encoded as "\xFF\00" in our inverted string. This can't test for an empty 'out',
+            // which is what a string starting with a NUL byte has after the first pass.
             reader->skip(1);
             out += '\xFF';  // will be flipped to '\0' with rest of out before returning.
         }
+        firstPass = false;
 
         const char* start = static_cast<const char*>(reader->pos());
         const char* end = static_cast<const char*>(memchr(start, 0xFF, reader->remaining()));
@@ -265,23 +281,91 @@ string readInvertedCStringWithNuls(BufReader* reader) {
         reader->skip(1 + actualBytes);
     } while (reader->peek<unsigned char>() == 0x00);
 
-    for (size_t i = 0; i < out.size(); i++) {
-        out[i] = ~out[i];
-    }
-
+    memcpy_flipBits(&out[0], out.data(), out.size());
     return out;
 }
 }  // namespace
 
-void KeyString::resetToKey(const BSONObj& obj, Ordering ord, RecordId recordId) {
+const size_t KeyString::Dictionary::kMaxStringsPerField;
+
+StatusWith<KeyString::Dictionary> KeyString::Dictionary::parse(const BSONObj& keyPattern,
+                                                               const BSONObj& spec) {
+    Dictionary dictionary;
+    BSONForEach(fieldSpec, spec) {
+        const StringData fieldName = fieldSpec.fieldNameStringData();
+        size_t fieldIdx = 0;
+        bool inKeyPattern = false;
+        BSONForEach(keyElem, keyPattern) {
+            if (keyElem.fieldNameStringData() == fieldName) {
+                inKeyPattern = true;
+                break;
+            }
+            fieldIdx++;
+        }
+        if (!inKeyPattern) {
+            return StatusWith<Dictionary>(ErrorCodes::InvalidOptions,
+                                          str::stream() << "dictionary field '" << fieldName
+                                                        << "' is not in the key pattern "
+                                                        << keyPattern);
+        }
+        if (fieldSpec.type() != Array) {
+            return StatusWith<Dictionary>(ErrorCodes::TypeMismatch,
+                                          str::stream() << "dictionary for field '" << fieldName
+                                                        << "' must be an array of strings");
+        }
+
+        if (fieldIdx >= dictionary._stringsByField.size()) {
+            dictionary._stringsByField.resize(fieldIdx + 1);
+        }
+        std::vector<std::string>& strings = dictionary._stringsByField[fieldIdx];
+        if (!strings.empty()) {
+            return StatusWith<Dictionary>(ErrorCodes::InvalidOptions,
+                                          str::stream() << "dictionary field '" << fieldName
+                                                        << "' is listed more than once");
+        }
+
+        BSONForEach(stringElem, fieldSpec.Obj()) {
+            if (stringElem.type() != String) {
+                return StatusWith<Dictionary>(ErrorCodes::TypeMismatch,
+                                              str::stream() << "dictionary for field '"
+                                                            << fieldName
+                                                            << "' must only contain strings");
+            }
+            strings.push_back(stringElem.str());
+        }
+        std::sort(strings.begin(),
+                  strings.end(),
+                  [](const std::string& lhs, const std::string& rhs) {
+                      return StringData(lhs) < StringData(rhs);
+                  });
+        strings.erase(std::unique(strings.begin(), strings.end()), strings.end());
+
+        if (strings.empty() || strings.size() > kMaxStringsPerField) {
+            return StatusWith<Dictionary>(ErrorCodes::InvalidOptions,
+                                          str::stream() << "dictionary for field '" << fieldName
+                                                        << "' must have between 1 and "
+                                                        << kMaxStringsPerField
+                                                        << " distinct strings");
+        }
+    }
+    return StatusWith<Dictionary>(std::move(dictionary));
+}
+
+void KeyString::resetToKey(const BSONObj& obj,
+                           Ordering ord,
+                           RecordId recordId,
+                           const Dictionary* dictionary) {
     resetToEmpty();
-    _appendAllElementsForIndexing(obj, ord, kInclusive);
+    _appendAllElementsForIndexing(obj, ord, kInclusive, dictionary);
     appendRecordId(recordId);
 }
 
-void KeyString::resetToKey(const BSONObj& obj, Ordering ord, Discriminator discriminator) {
+void KeyString::resetToKey(const BSONObj& obj,
+                           Ordering ord,
+                           Discriminator discriminator,
+                           const Dictionary* dictionary) {
     resetToEmpty();
-    _appendAllElementsForIndexing(obj, ord, discriminator);
+    _appendAllElementsForIndexing(obj, ord, discriminator, dictionary);
 }
 
 // ----------------------------------------------------------------------
@@ -290,14 +374,21 @@ void KeyString::resetToKey(const BSONObj& obj, Ordering ord, Discriminator discr
 
 void KeyString::_appendAllElementsForIndexing(const BSONObj& obj,
                                               Ordering ord,
-                                              Discriminator discriminator) {
+                                              Discriminator discriminator,
+                                              const Dictionary* dictionary) {
     int elemCount = 0;
     BSONObjIterator it(obj);
     while (auto elem = it.next()) {
         const int elemIdx = elemCount++;
         const bool invert = (ord.get(elemIdx) == -1);
 
-        _appendBsonValue(elem, invert, NULL);
+        const std::vector<std::string>* strings =
+            dictionary ? dictionary->getStrings(elemIdx) : NULL;
+        if (strings && (elem.type() == String || elem.type() == Symbol)) {
+            _appendDictionaryStringLike(elem, *strings, invert);
+        } else {
+            _appendBsonValue(elem, invert, NULL);
+        }
 
         dassert(elem.fieldNameSize() < 3);  // fieldNameSize includes the NUL
 
@@ -423,6 +514,33 @@ void KeyString::_appendSymbol(StringData val, bool invert) {
     _appendStringLike(val, invert);
 }
 
+void KeyString::_appendDictionaryStringLike(const BSONElement& elem,
+                                            const std::vector<std::string>& strings,
+                                            bool invert) {
+    const StringData val = elem.valueStringData();
+    if (elem.type() == String) {
+        _typeBits.appendString();
+    } else {
+        dassert(elem.type() == Symbol);
+        _typeBits.appendSymbol();
+    }
+    _append(CType::kStringLike, invert);
+
+    const auto lowerBound = std::lower_bound(
+        strings.begin(), strings.end(), val, [](const std::string& listed, StringData val) {
+            return StringData(listed) < val;
+        });
+    const uint8_t numLess = lowerBound - strings.begin();
+    if (lowerBound != strings.end() && StringData(*lowerBound) == val) {
+        _append(static_cast<uint8_t>(2 * numLess + 2), invert);
+        return;
+    }
+
+    // Not in the dictionary, so the code only orders it relative to the listed strings.
+    _append(static_cast<uint8_t>(2 * numLess + 1), invert);
+    _appendStringLike(val, invert);
+}
+
 void KeyString::_appendCode(StringData val, bool invert) {
     _append(CType::kCode, invert);
     _appendStringLike(val, invert);
@@ -632,14 +750,24 @@ void KeyString::_appendBsonValue(const BSONElement& elem, bool invert, const Str
 
 void KeyString::_appendStringLike(StringData str, bool invert) {
     while (true) {
-        size_t firstNul = strnlen(str.rawData(), str.size());
-        // No NULs in string.
-        _appendBytes(str.rawData(), firstNul, invert);
-        if (firstNul == str.size() || firstNul == std::string::npos) {
-            _append(int8_t(0), invert);
+        const char* nul =
+            str.empty() ? NULL : static_cast<const char*>(memchr(str.rawData(), 0, str.size()));
+        if (!nul) {
+            // No NULs left, so the rest of the string and its terminator go in one append.
+            char* const base = _buffer.skip(str.size() + 1);
+            if (invert) {
+                memcpy_flipBits(base, str.rawData(), str.size());
+                base[str.size()] = char(0xFF);
+            } else {
+                memcpy(base, str.rawData(), str.size());
+                base[str.size()] = 0;
+            }
             break;
         }
 
+        const size_t firstNul = nul - str.rawData();
+        _appendBytes(str.rawData(), firstNul, invert);
+
         // replace "\x00" with "\x00\xFF"
         _appendBytes("\x00\xFF", 2, invert);
         str = str.substr(firstNul + 1);  // skip over the NUL byte
@@ -1071,7 +1199,11 @@ void toBsonValue(uint8_t ctype,
 }
 }  // namespace
 
-BSONObj KeyString::toBson(const char* buffer, size_t len, Ordering ord, const TypeBits& typeBits) {
+BSONObj KeyString::toBson(const char* buffer,
+                          size_t len,
+                          Ordering ord,
+                          const TypeBits& typeBits,
+                          const Dictionary* dictionary) {
     BSONObjBuilder builder;
     BufReader reader(buffer, len);
     TypeBits::Reader typeBitsReader(typeBits);
@@ -1088,13 +1220,32 @@ BSONObj KeyString::toBson(const char* buffer, size_t len, Ordering ord, const Ty
 
         if (ctype == kEnd)
             break;
+
+        const std::vector<std::string>* strings = dictionary ? dictionary->getStrings(i) : NULL;
+        if (strings && ctype == CType::kStringLike) {
+            const uint8_t code = readType<uint8_t>(&reader, invert);
+            if (code % 2 == 0) {
+                invariant(code >= 2 && code / 2 <= strings->size());
+                const std::string& str = (*strings)[code / 2 - 1];
+                if (typeBitsReader.readStringLike() == TypeBits::kString) {
+                    builder.append("", str);
+                } else {
+                    builder.appendSymbol("", str);
+                }
+                continue;
+            }
+            // Odd codes are followed by the usual string encoding.
+        }
         toBsonValue(ctype, &reader, &typeBitsReader, invert, &(builder << ""));
     }
     return builder.obj();
 }
 
-BSONObj KeyString::toBson(StringData data, Ordering ord, const TypeBits& typeBits) {
-    return toBson(data.rawData(), data.size(), ord, typeBits);
+BSONObj KeyString::toBson(StringData data,
+                          Ordering ord,
+                          const TypeBits& typeBits,
+                          const Dictionary* dictionary) {
+    return toBson(data.rawData(), data.size(), ord, typeBits, dictionary);
 }
 
 RecordId KeyString::decodeRecordIdAtEnd(const void* bufferRaw, size_t bufSize) {
@@ -30,6 +30,10 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
+#include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/bson/bsonmisc.h"
@@ -205,6 +209,44 @@ public:
         uint8_t _buf[1 /*size*/ + kMaxBytesNeeded];
     };
 
+    /**
+     * Replaces the common string values of some top-level key fields with one byte codes.
+     *
+     * Each such field has a sorted list of strings. A string in the list at position i is
+     * encoded as the code byte 2 * i + 2 after its type byte. Any other string is encoded as the
+     * code byte 2 * g + 1, where g is the number of listed strings less than it, followed by its
+     * usual encoding. This keeps KeyStrings in the same order as without a dictionary, so a
+     * dictionary only has to be used consistently for every key of an index. It must never
+     * change once an index has keys encoded with it.
+     */
+    class Dictionary {
+    public:
+        // Largest code byte is 2 * kMaxStringsPerField + 1.
+        static const size_t kMaxStringsPerField = 126;
+
+        /**
+         * Parses a spec of the form {<key field>: [<string>, ...], ...}, where every field must
+         * be a top-level field of 'keyPattern'. Strings may be listed in any order.
+         */
+        static StatusWith<Dictionary> parse(const BSONObj& keyPattern, const BSONObj& spec);
+
+        bool isEmpty() const {
+            return _stringsByField.empty();
+        }
+
+        /**
+         * Returns the sorted strings for the key field at 'fieldIdx', or NULL if it has none.
+         */
+        const std::vector<std::string>* getStrings(size_t fieldIdx) const {
+            if (fieldIdx >= _stringsByField.size() || _stringsByField[fieldIdx].empty())
+                return NULL;
+            return &_stringsByField[fieldIdx];
+        }
+
+    private:
+        std::vector<std::vector<std::string>> _stringsByField;
+    };
+
     enum Discriminator {
         kInclusive,  // Anything to be stored in an index must use this.
         kExclusiveBefore,
@@ -213,20 +255,36 @@ public:
 
     KeyString() {}
 
-    KeyString(const BSONObj& obj, Ordering ord, RecordId recordId) {
-        resetToKey(obj, ord, recordId);
+    KeyString(const BSONObj& obj,
+              Ordering ord,
+              RecordId recordId,
+              const Dictionary* dictionary = NULL) {
+        resetToKey(obj, ord, recordId, dictionary);
     }
 
-    KeyString(const BSONObj& obj, Ordering ord, Discriminator discriminator = kInclusive) {
-        resetToKey(obj, ord, discriminator);
+    KeyString(const BSONObj& obj,
+              Ordering ord,
+              Discriminator discriminator = kInclusive,
+              const Dictionary* dictionary = NULL) {
+        resetToKey(obj, ord, discriminator, dictionary);
     }
 
     explicit KeyString(RecordId rid) {
         appendRecordId(rid);
     }
 
-    static BSONObj toBson(StringData data, Ordering ord, const TypeBits& types);
-    static BSONObj toBson(const char* buffer, size_t len, Ordering ord, const TypeBits& types);
+    /**
+     * 'dictionary' must be the one the KeyString was encoded with, if any.
+     */
+    static BSONObj toBson(StringData data,
+                          Ordering ord,
+                          const TypeBits& types,
+                          const Dictionary* dictionary = NULL);
+    static BSONObj toBson(const char* buffer,
+                          size_t len,
+                          Ordering ord,
+                          const TypeBits& types,
+                          const Dictionary* dictionary = NULL);
 
     /**
      * Decodes a RecordId from the end of a buffer.
@@ -250,8 +308,14 @@ public:
         _typeBits.reset();
     }
 
-    void resetToKey(const BSONObj& obj, Ordering ord, RecordId recordId);
-    void resetToKey(const BSONObj& obj, Ordering ord, Discriminator discriminator = kInclusive);
+    void resetToKey(const BSONObj& obj,
+                    Ordering ord,
+                    RecordId recordId,
+                    const Dictionary* dictionary = NULL);
+    void resetToKey(const BSONObj& obj,
+                    Ordering ord,
+                    Discriminator discriminator = kInclusive,
+                    const Dictionary* dictionary = NULL);
     void resetFromBuffer(const void* buffer, size_t size) {
         _buffer.reset();
         memcpy(_buffer.skip(size), buffer, size);
@@ -281,7 +345,8 @@ public:
 private:
     void _appendAllElementsForIndexing(const BSONObj& obj,
                                        Ordering ord,
-                                       Discriminator discriminator);
+                                       Discriminator discriminator,
+                                       const Dictionary* dictionary);
 
     void _appendBool(bool val, bool invert);
     void _appendDate(Date_t val, bool invert);
@@ -290,6 +355,9 @@ private:
     void _appendString(StringData val, bool invert);
     void _appendSymbol(StringData val, bool invert);
     void _appendCode(StringData val, bool invert);
+    void _appendDictionaryStringLike(const BSONElement& elem,
+                                     const std::vector<std::string>& strings,
+                                     bool invert);
     void _appendCodeWString(const BSONCodeWScope& val, bool invert);
     void _appendBinData(const BSONBinData& val, bool invert);
     void _appendRegex(const BSONRegEx& val, bool invert);
@@ -155,6 +155,26 @@ TEST(KeyStringTest, AllTypesSimple) {
     ROUNDTRIP(BSON("" << 1235123123123LL));
 }
 
+TEST(KeyStringTest, StringsAcrossWordBoundaries) {
+    // Lengths around multiples of 8 exercise both the word-at-a-time and the trailing bytes of
+    // the bit flipping that descending keys use.
+    for (size_t len = 0; len <= 40; len++) {
+        std::string str;
+        for (size_t i = 0; i < len; i++) {
+            str += char('a' + i % 26);
+        }
+        ROUNDTRIP(BSON("" << str));
+        ROUNDTRIP(BSON("" << BSONSymbol(str)));
+
+        // NUL bytes at the start, middle and end.
+        std::string withNuls = std::string(1, '\0') + str + std::string(1, '\0') + str + '\0';
+        ROUNDTRIP(BSON("" << withNuls));
+
+        COMPARES_SAME(BSON("" << str), BSON("" << withNuls));
+        COMPARES_SAME(BSON("" << str + "a"), BSON("" << str + "b"));
+    }
+}
+
 TEST(KeyStringTest, Array1) {
     BSONObj emptyArray = BSON("" << BSONArray());
 
@@ -843,3 +863,82 @@ TEST(KeyStringTest, RecordIds) {
         }
     }
 }
+
+TEST(KeyStringTest, DictionaryPreservesOrderAndRoundtrips) {
+    const BSONObj keyPattern = BSON("a" << 1 << "b" << 1);
+    auto swDictionary = KeyString::Dictionary::parse(
+        keyPattern, BSON("b" << BSON_ARRAY("pending" << "active" << "deleted" << "active")));
+    ASSERT_OK(swDictionary.getStatus());
+    const KeyString::Dictionary& dictionary = swDictionary.getValue();
+    ASSERT(!dictionary.getStrings(0));
+    ASSERT_EQ(3U, dictionary.getStrings(1)->size());
+
+    std::vector<BSONObj> values;
+    values.push_back(BSON("" << 1 << "" << MINKEY));
+    values.push_back(BSON("" << 1 << "" << 5));
+    values.push_back(BSON("" << 1 << "" << ""));
+    values.push_back(BSON("" << 1 << "" << "aardvark"));
+    values.push_back(BSON("" << 1 << "" << "active"));
+    values.push_back(BSON("" << 1 << "" << BSONSymbol("active")));
+    values.push_back(BSON("" << 1 << "" << "activeX"));
+    values.push_back(BSON("" << 1 << "" << StringData("active\0", 7)));
+    values.push_back(BSON("" << 1 << "" << "deleted"));
+    values.push_back(BSON("" << 1 << "" << "pending"));
+    values.push_back(BSON("" << 1 << "" << "zebra"));
+    values.push_back(BSON("" << 1 << "" << BSON("x" << "active")));
+    values.push_back(BSON("" << "active" << "" << "active"));
+
+    std::vector<BSONObj> orderings;
+    orderings.push_back(keyPattern);
+    orderings.push_back(BSON("a" << 1 << "b" << -1));
+    for (size_t k = 0; k < orderings.size(); k++) {
+        const Ordering ord = Ordering::make(orderings[k]);
+        for (size_t i = 0; i < values.size(); i++) {
+            const KeyString encoded(values[i], ord, RecordId(7), &dictionary);
+            const BSONObj decoded = KeyString::toBson(
+                encoded.getBuffer(), encoded.getSize(), ord, encoded.getTypeBits(), &dictionary);
+            ASSERT(decoded.binaryEqual(values[i])) << decoded << " vs " << values[i];
+
+            for (size_t j = 0; j < values.size(); j++) {
+                // Comparisons must be the same as without the dictionary.
+                const int plain = KeyString(values[i], ord, RecordId(7))
+                                      .compare(KeyString(values[j], ord, RecordId(7)));
+                const int coded =
+                    encoded.compare(KeyString(values[j], ord, RecordId(7), &dictionary));
+                ASSERT_EQ(plain < 0, coded < 0) << values[i] << " vs " << values[j];
+                ASSERT_EQ(plain == 0, coded == 0) << values[i] << " vs " << values[j];
+            }
+        }
+    }
+
+    // A listed string is stored as just its type byte and code byte.
+    const Ordering ord = Ordering::make(keyPattern);
+    const BSONObj key = BSON("" << 1 << "" << "deleted");
+    ASSERT_EQ(KeyString(key, ord, KeyString::kInclusive, &dictionary).getSize() + strlen("deleted"),
+              KeyString(key, ord).getSize());
+}
+
+TEST(KeyStringTest, DictionaryParseErrors) {
+    const BSONObj keyPattern = BSON("a" << 1 << "b.c" << 1);
+    ASSERT_OK(KeyString::Dictionary::parse(keyPattern, BSONObj()).getStatus());
+    ASSERT_OK(KeyString::Dictionary::parse(keyPattern, BSON("b.c" << BSON_ARRAY("x"))).getStatus());
+    ASSERT_EQ(ErrorCodes::InvalidOptions,
+              KeyString::Dictionary::parse(keyPattern, BSON("b" << BSON_ARRAY("x"))).getStatus());
+    ASSERT_EQ(ErrorCodes::TypeMismatch,
+              KeyString::Dictionary::parse(keyPattern, BSON("a" << "x")).getStatus());
+    ASSERT_EQ(ErrorCodes::TypeMismatch,
+              KeyString::Dictionary::parse(keyPattern, BSON("a" << BSON_ARRAY("x" << 1)))
+                  .getStatus());
+    ASSERT_EQ(ErrorCodes::InvalidOptions,
+              KeyString::Dictionary::parse(keyPattern, BSON("a" << BSONArray())).getStatus());
+    ASSERT_EQ(ErrorCodes::InvalidOptions,
+              KeyString::Dictionary::parse(
+                  keyPattern, BSON("a" << BSON_ARRAY("x") << "a" << BSON_ARRAY("y"))).getStatus());
+
+    BSONArrayBuilder tooMany;
+    for (size_t i = 0; i <= KeyString::Dictionary::kMaxStringsPerField; i++) {
+        tooMany.append(std::string(1 + i / 26, 'a' + i % 26) + "x");
+    }
+    ASSERT_EQ(ErrorCodes::InvalidOptions,
+              KeyString::Dictionary::parse(keyPattern, BSON("a" << tooMany.arr())).getStatus());
+}
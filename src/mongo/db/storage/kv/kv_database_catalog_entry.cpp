@@ -227,24 +227,30 @@ Status KVDatabaseCatalogEntry::createCollection(OperationContext* txn,
 void KVDatabaseCatalogEntry::initCollection(OperationContext* opCtx,
                                             const std::string& ns,
                                             bool forRepair) {
-    invariant(!_collections.count(ns));
+    // Using a NULL rs for repair since we don't want to open this record store before it has
+    // been repaired. This also ensures that if we try to use it, it will blow up.
+    initCollection(ns, forRepair ? std::unique_ptr<RecordStore>() : openRecordStore(opCtx, ns));
+}
 
+std::unique_ptr<RecordStore> KVDatabaseCatalogEntry::openRecordStore(
+    OperationContext* opCtx, const std::string& ns) const {
     const std::string ident = _engine->getCatalog()->getCollectionIdent(ns);
+    BSONCollectionCatalogEntry::MetaData md = _engine->getCatalog()->getMetaData(opCtx, ns);
+    std::unique_ptr<RecordStore> rs(
+        _engine->getEngine()->getRecordStore(opCtx, ns, ident, md.options));
+    invariant(rs);
+    return rs;
+}
 
-    RecordStore* rs;
-    if (forRepair) {
-        // Using a NULL rs since we don't want to open this record store before it has been
-        // repaired. This also ensures that if we try to use it, it will blow up.
-        rs = NULL;
-    } else {
-        BSONCollectionCatalogEntry::MetaData md = _engine->getCatalog()->getMetaData(opCtx, ns);
-        rs = _engine->getEngine()->getRecordStore(opCtx, ns, ident, md.options);
-        invariant(rs);
-    }
+void KVDatabaseCatalogEntry::initCollection(const std::string& ns,
+                                            std::unique_ptr<RecordStore> rs) {
+    invariant(!_collections.count(ns));
+
+    const std::string ident = _engine->getCatalog()->getCollectionIdent(ns);
 
     // No change registration since this is only for committed collections
-    _collections[ns] =
-        new KVCollectionCatalogEntry(_engine->getEngine(), _engine->getCatalog(), ns, ident, rs);
+    _collections[ns] = new KVCollectionCatalogEntry(
+        _engine->getEngine(), _engine->getCatalog(), ns, ident, rs.release());
 }
 
 void KVDatabaseCatalogEntry::reinitCollectionAfterRepair(OperationContext* opCtx,
@@ -31,6 +31,7 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
 
 #include "mongo/db/catalog/database_catalog_entry.h"
@@ -38,6 +39,7 @@
 namespace mongo {
 
 class KVCollectionCatalogEntry;
+class RecordStore;
 class KVStorageEngine;
 
 class KVDatabaseCatalogEntry : public DatabaseCatalogEntry {
@@ -86,6 +88,20 @@ public:
 
     void initCollection(OperationContext* opCtx, const std::string& ns, bool forRepair);
 
+    /**
+     * Opens the RecordStore of the committed collection 'ns'. Does not touch this entry, so it
+     * may be called for different collections from several threads when the KVEngine
+     * supportsConcurrentRecordStoreOpen().
+     */
+    std::unique_ptr<RecordStore> openRecordStore(OperationContext* opCtx,
+                                                 const std::string& ns) const;
+
+    /**
+     * Like initCollection() but takes a RecordStore already returned by openRecordStore(). A
+     * NULL 'rs' leaves the collection unopened, as for repair.
+     */
+    void initCollection(const std::string& ns, std::unique_ptr<RecordStore> rs);
+
     void initCollectionBeforeRepair(OperationContext* opCtx, const std::string& ns);
     void reinitCollectionAfterRepair(OperationContext* opCtx, const std::string& ns);
 
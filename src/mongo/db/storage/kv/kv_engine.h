@@ -34,6 +34,7 @@
 #include <vector>
 
 #include "mongo/base/status.h"
+#include "mongo/base/status_with.h"
 #include "mongo/base/string_data.h"
 #include "mongo/db/catalog/collection_options.h"
 
@@ -108,6 +109,15 @@ public:
      */
     virtual bool supportsDirectoryPerDB() const = 0;
 
+    /**
+     * Returns true if getRecordStore() may be called for different idents from several threads
+     * at once, each with its own OperationContext. Startup uses this to open existing
+     * collections in parallel.
+     */
+    virtual bool supportsConcurrentRecordStoreOpen() const {
+        return false;
+    }
+
     virtual Status okToRename(OperationContext* opCtx,
                               StringData fromNS,
                               StringData toNS,
@@ -138,6 +148,16 @@ public:
         return nullptr;
     }
 
+    /**
+     * See StorageEngine::beginBackup() and StorageEngine::endBackup().
+     */
+    virtual StatusWith<std::vector<std::string>> beginBackup(OperationContext* opCtx) {
+        return Status(ErrorCodes::CommandNotSupported,
+                      "This storage engine does not support backing up its data files");
+    }
+
+    virtual void endBackup(OperationContext* opCtx) {}
+
     /**
      * The destructor will never be called from mongod, but may be called from tests.
      * Engines may assume that this will only be called in the case of clean shutdown, even if
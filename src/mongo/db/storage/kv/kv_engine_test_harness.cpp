@@ -133,6 +133,35 @@ TEST(KVEngineTestHarness, Restart1) {
 }
 
 
+TEST(KVEngineTestHarness, Backup1) {
+    unique_ptr<KVHarnessHelper> helper(KVHarnessHelper::create());
+    KVEngine* engine = helper->getEngine();
+    ASSERT(engine);
+
+    string ns = "a.b";
+    {
+        MyOperationContext opCtx(engine);
+        ASSERT_OK(engine->createRecordStore(&opCtx, ns, ns, CollectionOptions()));
+    }
+
+    MyOperationContext opCtx(engine);
+    StatusWith<std::vector<std::string>> files = engine->beginBackup(&opCtx);
+    if (files.getStatus() == ErrorCodes::CommandNotSupported) {
+        return;
+    }
+    ASSERT_OK(files.getStatus());
+    ASSERT_FALSE(files.getValue().empty());
+
+    // Only one backup may be in progress at a time.
+    ASSERT_EQUALS(ErrorCodes::ConflictingOperationInProgress,
+                  engine->beginBackup(&opCtx).getStatus());
+
+    engine->endBackup(&opCtx);
+    files = engine->beginBackup(&opCtx);
+    ASSERT_OK(files.getStatus());
+    engine->endBackup(&opCtx);
+}
+
 TEST(KVEngineTestHarness, SimpleSorted1) {
     unique_ptr<KVHarnessHelper> helper(KVHarnessHelper::create());
     KVEngine* engine = helper->getEngine();
@@ -32,9 +32,15 @@
 
 #include "mongo/db/storage/kv/kv_storage_engine.h"
 
+#include <algorithm>
+#include <exception>
+
 #include "mongo/db/operation_context_noop.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/kv/kv_database_catalog_entry.h"
 #include "mongo/db/storage/kv/kv_engine.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
@@ -46,6 +52,10 @@ using std::vector;
 
 namespace {
 const std::string catalogInfo = "_mdb_catalog";
+
+// Number of threads used to open the record stores of existing collections at startup, for
+// engines that support it. 1 opens them serially on the startup thread.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(storageEngineOpenThreads, int, 8);
 }
 
 class KVStorageEngine::RemoveDBChange : public RecoveryUnit::Change {
@@ -104,9 +114,9 @@ KVStorageEngine::KVStorageEngine(KVEngine* engine, const KVStorageEngineOptions&
         std::vector<std::string> collections;
         _catalog->getAllCollections(&collections);
 
+        std::vector<KVDatabaseCatalogEntry*> collectionDbs;
         for (size_t i = 0; i < collections.size(); i++) {
-            std::string coll = collections[i];
-            NamespaceString nss(coll);
+            NamespaceString nss(collections[i]);
             string dbName = nss.db().toString();
 
             // No rollback since this is only for committed dbs.
@@ -114,8 +124,17 @@ KVStorageEngine::KVStorageEngine(KVEngine* engine, const KVStorageEngineOptions&
             if (!db) {
                 db = new KVDatabaseCatalogEntry(dbName, this);
             }
+            collectionDbs.push_back(db);
+        }
 
-            db->initCollection(&opCtx, coll, options.forRepair);
+        // Record stores are not opened before repair.
+        std::vector<std::unique_ptr<RecordStore>> recordStores(collections.size());
+        if (!options.forRepair) {
+            _openRecordStores(&opCtx, collections, collectionDbs, &recordStores);
+        }
+
+        for (size_t i = 0; i < collections.size(); i++) {
+            collectionDbs[i]->initCollection(collections[i], std::move(recordStores[i]));
         }
 
         uow.commit();
@@ -155,6 +174,58 @@ KVStorageEngine::KVStorageEngine(KVEngine* engine, const KVStorageEngineOptions&
     }
 }
 
+void KVStorageEngine::_openRecordStores(OperationContext* opCtx,
+                                        const std::vector<std::string>& collections,
+                                        const std::vector<KVDatabaseCatalogEntry*>& dbs,
+                                        std::vector<std::unique_ptr<RecordStore>>* out) {
+    size_t numThreads = 1;
+    if (_engine->supportsConcurrentRecordStoreOpen() && storageEngineOpenThreads > 1) {
+        numThreads = std::min(static_cast<size_t>(storageEngineOpenThreads), collections.size());
+    }
+
+    if (numThreads <= 1) {
+        for (size_t i = 0; i < collections.size(); i++) {
+            (*out)[i] = dbs[i]->openRecordStore(opCtx, collections[i]);
+        }
+        return;
+    }
+
+    // Each worker opens whichever collection is next, using its own recovery unit. Only the
+    // slots of 'out' are written concurrently; the catalog entries are populated by the caller.
+    AtomicUInt64 next;
+    std::vector<std::exception_ptr> errors(numThreads);
+    std::vector<stdx::thread> workers;
+    for (size_t t = 0; t < numThreads; t++) {
+        workers.emplace_back([&, t] {
+            try {
+                OperationContextNoop workerOpCtx(_engine->newRecoveryUnit());
+                for (size_t i = next.fetchAndAdd(1); i < collections.size();
+                     i = next.fetchAndAdd(1)) {
+                    (*out)[i] = dbs[i]->openRecordStore(&workerOpCtx, collections[i]);
+                    workerOpCtx.recoveryUnit()->abandonSnapshot();
+                }
+            } catch (...) {
+                errors[t] = std::current_exception();
+                // Stop the other workers early; startup fails anyway.
+                next.store(collections.size());
+            }
+        });
+    }
+
+    for (auto&& worker : workers) {
+        worker.join();
+    }
+
+    for (auto&& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    log() << "opened " << collections.size() << " collections using " << numThreads
+          << " threads";
+}
+
 void KVStorageEngine::cleanShutdown() {
     for (DBMap::const_iterator it = _dbs.begin(); it != _dbs.end(); ++it) {
         delete it->second;
@@ -255,6 +326,14 @@ SnapshotManager* KVStorageEngine::getSnapshotManager() const {
     return _engine->getSnapshotManager();
 }
 
+StatusWith<std::vector<std::string>> KVStorageEngine::beginBackup(OperationContext* txn) {
+    return _engine->beginBackup(txn);
+}
+
+void KVStorageEngine::endBackup(OperationContext* txn) {
+    _engine->endBackup(txn);
+}
+
 Status KVStorageEngine::repairRecordStore(OperationContext* txn, const std::string& ns) {
     Status status = _engine->repairIdent(txn, _catalog->getCollectionIdent(ns));
     if (!status.isOK())
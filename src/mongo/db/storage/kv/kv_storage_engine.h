@@ -31,7 +31,9 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "mongo/db/storage/kv/kv_catalog.h"
 #include "mongo/db/storage/record_store.h"
@@ -88,6 +90,10 @@ public:
 
     SnapshotManager* getSnapshotManager() const final;
 
+    StatusWith<std::vector<std::string>> beginBackup(OperationContext* txn) final;
+
+    void endBackup(OperationContext* txn) final;
+
     // ------ kv ------
 
     KVEngine* getEngine() {
@@ -107,6 +113,16 @@ public:
 private:
     class RemoveDBChange;
 
+    /**
+     * Opens the record store of each of 'collections', whose database entries are the matching
+     * elements of 'dbs', into the matching slot of 'out'. Uses several threads when the engine
+     * supports it.
+     */
+    void _openRecordStores(OperationContext* opCtx,
+                           const std::vector<std::string>& collections,
+                           const std::vector<KVDatabaseCatalogEntry*>& dbs,
+                           std::vector<std::unique_ptr<RecordStore>>* out);
+
     KVStorageEngineOptions _options;
 
     // This must be the first member so it is destroyed last.
@@ -54,6 +54,12 @@ public:
         return _builder->addKey(key, DiskLoc::fromRecordId(loc));
     }
 
+    void commit(bool mayInterrupt) {
+        WriteUnitOfWork wunit(_trans);
+        _builder->commit();
+        wunit.commit();
+    }
+
 private:
     std::unique_ptr<typename BtreeLogic<OnDiskFormat>::Builder> _builder;
 
@@ -87,6 +93,14 @@ public:
         return _btree->insert(txn, key, DiskLoc::fromRecordId(loc), dupsAllowed);
     }
 
+    virtual Status insertBatch(OperationContext* txn,
+                               const IndexKeyEntry* entries,
+                               size_t nEntries,
+                               bool dupsAllowed,
+                               size_t* numInsertedOut) {
+        return _btree->insertBatch(txn, entries, nEntries, dupsAllowed, numInsertedOut);
+    }
+
     virtual void unindex(OperationContext* txn,
                          const BSONObj& key,
                          const RecordId& loc,
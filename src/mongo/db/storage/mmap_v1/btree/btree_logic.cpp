@@ -65,6 +65,23 @@ using std::vector;
 //   we get to the root and it is full, a new root is created above the current root. When
 //   creating a new right sibling, it is set as its parent's nextChild as all keys in the right
 //   sibling will be higher than all keys currently in the parent.
+//
+//   Only the buckets on the right-most edge of the tree (the spine) can still change, so they are
+//   built up in memory. A bucket is written to disk with a single write once it leaves the spine,
+//   and commit() writes out whatever remains on the spine after the last key.
+
+class DummyDocWriter : public DocWriter {
+public:
+    DummyDocWriter(size_t sz) : _sz(sz) {}
+    virtual void writeDocument(char* buf) const { /* no-op */
+    }
+    virtual size_t documentSize() const {
+        return _sz;
+    }
+
+private:
+    size_t _sz;
+};
 
 //
 // Public Builder logic
@@ -84,30 +101,21 @@ BtreeLogic<BtreeLayout>::Builder::Builder(BtreeLogic* logic,
     // The normal bulk building path calls initAsEmpty, so we already have an empty root bucket.
     // This isn't the case in some unit tests that use the Builder directly rather than going
     // through an IndexAccessMethod.
-    _rightLeafLoc = DiskLoc::fromRecordId(_logic->_headManager->getHead(txn));
-    if (_rightLeafLoc.isNull()) {
-        _rightLeafLoc = _logic->_addBucket(txn);
-        _logic->_headManager->setHead(_txn, _rightLeafLoc.toRecordId());
+    const DiskLoc rootLoc = DiskLoc::fromRecordId(_logic->_headManager->getHead(txn));
+    if (rootLoc.isNull()) {
+        _logic->_headManager->setHead(_txn, _addSpineBucket(0).toRecordId());
+    } else {
+        SpineBucket root;
+        root.loc = rootLoc;
+        root.image.reset(new char[BtreeLayout::BucketSize]);
+        memcpy(root.image.get(), _logic->getBucket(txn, rootLoc), BtreeLayout::BucketSize);
+        _spine.push_back(std::move(root));
     }
 
     // must be empty when starting
-    invariant(_getBucket(_rightLeafLoc)->n == 0);
+    invariant(_spine.front().bucket()->n == 0);
 }
 
-template <class BtreeLayout>
-class BtreeLogic<BtreeLayout>::Builder::SetRightLeafLocChange : public RecoveryUnit::Change {
-public:
-    SetRightLeafLocChange(Builder* builder, DiskLoc oldLoc) : _builder(builder), _oldLoc(oldLoc) {}
-
-    virtual void commit() {}
-    virtual void rollback() {
-        _builder->_rightLeafLoc = _oldLoc;
-    }
-
-    Builder* _builder;
-    const DiskLoc _oldLoc;
-};
-
 template <class BtreeLayout>
 Status BtreeLogic<BtreeLayout>::Builder::addKey(const BSONObj& keyObj, const DiskLoc& loc) {
     unique_ptr<KeyDataOwnedType> key(new KeyDataOwnedType(keyObj));
@@ -135,12 +143,11 @@ Status BtreeLogic<BtreeLayout>::Builder::addKey(const BSONObj& keyObj, const Dis
         }
     }
 
-    BucketType* rightLeaf = _getModifiableBucket(_rightLeafLoc);
+    BucketType* rightLeaf = _spine.front().bucket();
     if (!_logic->pushBack(rightLeaf, loc, *key, DiskLoc())) {
         // bucket was full, so split and try with the new node.
-        _txn->recoveryUnit()->registerChange(new SetRightLeafLocChange(this, _rightLeafLoc));
-        _rightLeafLoc = newBucket(rightLeaf, _rightLeafLoc);
-        rightLeaf = _getModifiableBucket(_rightLeafLoc);
+        const DiskLoc rightLeafLoc = newBucket(rightLeaf, _spine.front().loc);
+        rightLeaf = _getModifiableBucket(rightLeafLoc);
         invariant(_logic->pushBack(rightLeaf, loc, *key, DiskLoc()));
     }
 
@@ -148,6 +155,14 @@ Status BtreeLogic<BtreeLayout>::Builder::addKey(const BSONObj& keyObj, const Dis
     return Status::OK();
 }
 
+template <class BtreeLayout>
+void BtreeLogic<BtreeLayout>::Builder::commit() {
+    for (size_t level = 0; level < _spine.size(); ++level) {
+        _writeSpineBucket(level);
+    }
+    _spine.clear();
+}
+
 //
 // Private Builder logic
 //
@@ -156,16 +171,17 @@ template <class BtreeLayout>
 DiskLoc BtreeLogic<BtreeLayout>::Builder::newBucket(BucketType* leftSib, DiskLoc leftSibLoc) {
     invariant(leftSib->n >= 2);  // Guaranteed by sufficiently small KeyMax.
 
+    const size_t level = _getSpineLevel(leftSibLoc);
     if (leftSib->parent.isNull()) {
         // Making a new root
         invariant(leftSibLoc.toRecordId() == _logic->_headManager->getHead(_txn));
-        const DiskLoc newRootLoc = _logic->_addBucket(_txn);
+        invariant(level + 1 == _spine.size());
+        const DiskLoc newRootLoc = _addSpineBucket(level + 1);
         leftSib->parent = newRootLoc;
         _logic->_headManager->setHead(_txn, newRootLoc.toRecordId());
 
         // Set the newRoot's nextChild to point to leftSib for the invariant below.
-        BucketType* newRoot = _getBucket(newRootLoc);
-        *_txn->recoveryUnit()->writing(&newRoot->nextChild) = leftSibLoc;
+        _spine[level + 1].bucket()->nextChild = leftSibLoc;
     }
 
     DiskLoc parentLoc = leftSib->parent;
@@ -188,25 +204,61 @@ DiskLoc BtreeLogic<BtreeLayout>::Builder::newBucket(BucketType* leftSib, DiskLoc
         leftSib->parent = parentLoc;
     }
 
-    // Create a new bucket to the right of leftSib and set its parent pointer and the downward
-    // nextChild pointer from the parent.
-    DiskLoc newBucketLoc = _logic->_addBucket(_txn);
-    BucketType* newBucket = _getBucket(newBucketLoc);
-    *_txn->recoveryUnit()->writing(&newBucket->parent) = parentLoc;
-    *_txn->recoveryUnit()->writing(&parent->nextChild) = newBucketLoc;
+    // leftSib is now complete, so write it out and replace it on the spine with a new bucket to
+    // its right. Set the new bucket's parent pointer and the downward nextChild pointer from
+    // the parent.
+    _writeSpineBucket(level);
+    const DiskLoc newBucketLoc = _addSpineBucket(level);
+    _spine[level].bucket()->parent = parentLoc;
+    parent->nextChild = newBucketLoc;
     return newBucketLoc;
 }
 
 template <class BtreeLayout>
-typename BtreeLogic<BtreeLayout>::BucketType*
-BtreeLogic<BtreeLayout>::Builder::_getModifiableBucket(DiskLoc loc) {
-    return _logic->btreemod(_txn, _logic->getBucket(_txn, loc));
+DiskLoc BtreeLogic<BtreeLayout>::Builder::_addSpineBucket(size_t level) {
+    invariant(level <= _spine.size());
+
+    DummyDocWriter docWriter(BtreeLayout::BucketSize);
+    StatusWith<RecordId> loc = _logic->_recordStore->insertRecord(_txn, &docWriter, false);
+    uassertStatusOK(loc.getStatus());
+
+    SpineBucket spineBucket;
+    spineBucket.loc = DiskLoc::fromRecordId(loc.getValue());
+    spineBucket.image.reset(new char[BtreeLayout::BucketSize]);
+    memset(spineBucket.image.get(), 0, BtreeLayout::BucketSize);
+    _logic->init(spineBucket.bucket());
+
+    if (level == _spine.size()) {
+        _spine.push_back(std::move(spineBucket));
+    } else {
+        _spine[level] = std::move(spineBucket);
+    }
+    return _spine[level].loc;
 }
 
 template <class BtreeLayout>
-typename BtreeLogic<BtreeLayout>::BucketType* BtreeLogic<BtreeLayout>::Builder::_getBucket(
-    DiskLoc loc) {
-    return _logic->getBucket(_txn, loc);
+void BtreeLogic<BtreeLayout>::Builder::_writeSpineBucket(size_t level) {
+    const SpineBucket& spineBucket = _spine[level];
+    void* dest = _txn->recoveryUnit()->writingPtr(_logic->getBucket(_txn, spineBucket.loc),
+                                                  BtreeLayout::BucketSize);
+    memcpy(dest, spineBucket.image.get(), BtreeLayout::BucketSize);
+}
+
+template <class BtreeLayout>
+size_t BtreeLogic<BtreeLayout>::Builder::_getSpineLevel(DiskLoc loc) const {
+    for (size_t level = 0; level < _spine.size(); ++level) {
+        if (_spine[level].loc == loc) {
+            return level;
+        }
+    }
+    invariant(false);
+    return 0;
+}
+
+template <class BtreeLayout>
+typename BtreeLogic<BtreeLayout>::BucketType*
+BtreeLogic<BtreeLayout>::Builder::_getModifiableBucket(DiskLoc loc) {
+    return _spine[_getSpineLevel(loc)].bucket();
 }
 
 //
@@ -1802,7 +1854,8 @@ void BtreeLogic<BtreeLayout>::split(OperationContext* txn,
                 splitkey.recordLoc,
                 true,  // dupsallowed
                 bucketLoc,
-                rLoc);
+                rLoc,
+                NULL);
     }
 
     int newpos = keypos;
@@ -1819,19 +1872,6 @@ void BtreeLogic<BtreeLayout>::split(OperationContext* txn,
     }
 }
 
-class DummyDocWriter : public DocWriter {
-public:
-    DummyDocWriter(size_t sz) : _sz(sz) {}
-    virtual void writeDocument(char* buf) const { /* no-op */
-    }
-    virtual size_t documentSize() const {
-        return _sz;
-    }
-
-private:
-    size_t _sz;
-};
-
 template <class BtreeLayout>
 Status BtreeLogic<BtreeLayout>::initAsEmpty(OperationContext* txn) {
     if (!_headManager->getHead(txn).isNull()) {
@@ -2059,13 +2099,90 @@ Status BtreeLogic<BtreeLayout>::insert(OperationContext* txn,
         return Status(ErrorCodes::KeyTooLong, msg);
     }
 
-    Status status =
-        _insert(txn, getRoot(txn), getRootLoc(txn), key, value, dupsAllowed, DiskLoc(), DiskLoc());
+    Status status = _insert(
+        txn, getRoot(txn), getRootLoc(txn), key, value, dupsAllowed, DiskLoc(), DiskLoc(), NULL);
 
     assertValid(_indexName, getRoot(txn), _ordering);
     return status;
 }
 
+template <class BtreeLayout>
+Status BtreeLogic<BtreeLayout>::insertBatch(OperationContext* txn,
+                                            const IndexKeyEntry* entries,
+                                            size_t nEntries,
+                                            bool dupsAllowed,
+                                            size_t* numInsertedOut) {
+    Status status = Status::OK();
+
+    // The bucket which received the previous key of the batch.
+    DiskLoc lastBucketLoc;
+
+    size_t i = 0;
+    for (; i < nEntries; i++) {
+        KeyDataOwnedType key(entries[i].key);
+        const DiskLoc value = DiskLoc::fromRecordId(entries[i].loc);
+
+        if (key.dataSize() > BtreeLayout::KeyMax) {
+            string msg = str::stream() << "Btree::insert: key too large to index, failing "
+                                       << _indexName << ' ' << key.dataSize() << ' '
+                                       << key.toString();
+            status = Status(ErrorCodes::KeyTooLong, msg);
+            break;
+        }
+
+        if (lastBucketLoc.isNull() ||
+            !_insertIntoBucket(txn, lastBucketLoc, key, value, dupsAllowed, &status)) {
+            status = _insert(txn,
+                             getRoot(txn),
+                             getRootLoc(txn),
+                             key,
+                             value,
+                             dupsAllowed,
+                             DiskLoc(),
+                             DiskLoc(),
+                             &lastBucketLoc);
+        }
+
+        if (!status.isOK())
+            break;
+    }
+
+    *numInsertedOut = i;
+    assertValid(_indexName, getRoot(txn), _ordering);
+    return status;
+}
+
+template <class BtreeLayout>
+bool BtreeLogic<BtreeLayout>::_insertIntoBucket(OperationContext* txn,
+                                                const DiskLoc bucketLoc,
+                                                const KeyDataType& key,
+                                                const DiskLoc recordLoc,
+                                                bool dupsAllowed,
+                                                Status* statusOut) {
+    BucketType* bucket = getBucket(txn, bucketLoc);
+
+    int pos;
+    bool found;
+    Status findStatus = _find(txn, bucket, key, recordLoc, !dupsAllowed, &pos, &found);
+    if (!findStatus.isOK()) {
+        // _find() compared the key against both of its neighbors in this bucket, so a
+        // duplicate it reports is a duplicate no matter where the key belongs in the tree.
+        *statusOut = findStatus;
+        return true;
+    }
+
+    // The key belongs here only if it falls strictly between two keys of this bucket with no
+    // child bucket between them. Anything else, including reuse of an unused key, is left to
+    // a descent from the root.
+    if (found || pos == 0 || pos >= bucket->n || !childLocForPos(bucket, pos).isNull()) {
+        return false;
+    }
+
+    insertHere(txn, bucketLoc, pos, key, recordLoc, DiskLoc(), DiskLoc());
+    *statusOut = Status::OK();
+    return true;
+}
+
 template <class BtreeLayout>
 Status BtreeLogic<BtreeLayout>::_insert(OperationContext* txn,
                                         BucketType* bucket,
@@ -2074,7 +2191,8 @@ Status BtreeLogic<BtreeLayout>::_insert(OperationContext* txn,
                                         const DiskLoc recordLoc,
                                         bool dupsAllowed,
                                         const DiskLoc leftChild,
-                                        const DiskLoc rightChild) {
+                                        const DiskLoc rightChild,
+                                        DiskLoc* bucketLocOut) {
     invariant(key.dataSize() > 0);
 
     int pos;
@@ -2106,6 +2224,9 @@ Status BtreeLogic<BtreeLayout>::_insert(OperationContext* txn,
     // currently.
     if (childLoc.isNull() || !rightChild.isNull()) {
         insertHere(txn, bucketLoc, pos, key, recordLoc, leftChild, rightChild);
+        if (bucketLocOut) {
+            *bucketLocOut = bucketLoc;
+        }
         return Status::OK();
     } else {
         return _insert(txn,
@@ -2115,7 +2236,8 @@ Status BtreeLogic<BtreeLayout>::_insert(OperationContext* txn,
                        recordLoc,
                        dupsAllowed,
                        DiskLoc(),
-                       DiskLoc());
+                       DiskLoc(),
+                       bucketLocOut);
     }
 }
 
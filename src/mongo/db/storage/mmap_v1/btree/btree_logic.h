@@ -100,30 +100,64 @@ public:
 
         Status addKey(const BSONObj& key, const DiskLoc& loc);
 
+        /**
+         * Writes out the buckets along the right-most edge of the tree, which are held in memory
+         * while keys are being added. Must be called once after the last addKey, before the tree
+         * is read.
+         */
+        void commit();
+
     private:
         friend class BtreeLogic;
 
-        class SetRightLeafLocChange;
+        /**
+         * An in-memory image of a bucket on the right-most edge of the tree. These are the only
+         * buckets that addKey can still modify, so they are filled in memory and written to disk
+         * once, as a whole, when they are complete.
+         */
+        struct SpineBucket {
+            DiskLoc loc;
+            std::unique_ptr<char[]> image;
+
+            BucketType* bucket() const {
+                return reinterpret_cast<BucketType*>(image.get());
+            }
+        };
 
         Builder(BtreeLogic* logic, OperationContext* txn, bool dupsAllowed);
 
         /**
          * Creates and returns a new empty bucket to the right of leftSib, maintaining the
          * internal consistency of the tree. leftSib must be the right-most child of its parent
-         * or it must be the root.
+         * or it must be the root. leftSib is complete afterwards and is written to disk.
          */
         DiskLoc newBucket(BucketType* leftSib, DiskLoc leftSibLoc);
 
+        /**
+         * Allocates space for a new bucket and makes a freshly initialized in-memory image of it
+         * the spine bucket at 'level', replacing any image already there. Nothing is written to
+         * the allocated record until the bucket is complete.
+         */
+        DiskLoc _addSpineBucket(size_t level);
+
+        /**
+         * Writes the image of the spine bucket at 'level' to disk as a single journaled write.
+         */
+        void _writeSpineBucket(size_t level);
+
+        size_t _getSpineLevel(DiskLoc loc) const;
+
         BucketType* _getModifiableBucket(DiskLoc loc);
-        BucketType* _getBucket(DiskLoc loc);
 
         // Not owned.
         BtreeLogic* _logic;
 
-        DiskLoc _rightLeafLoc;  // DiskLoc of right-most (highest) leaf bucket.
         bool _dupsAllowed;
         std::unique_ptr<KeyDataOwnedType> _keyLast;
 
+        // Images of the right-most bucket at each level of the tree, ordered from the leaf up.
+        std::vector<SpineBucket> _spine;
+
         // Not owned.
         OperationContext* _txn;
     };
@@ -141,6 +175,17 @@ public:
                   const DiskLoc& value,
                   bool dupsAllowed);
 
+    /**
+     * Inserts entries sorted in index order, stopping at the first failure. A key that falls
+     * between two adjacent keys of the bucket which received the previous key is inserted there
+     * directly instead of descending from the root again.
+     */
+    Status insertBatch(OperationContext* txn,
+                       const IndexKeyEntry* entries,
+                       size_t nEntries,
+                       bool dupsAllowed,
+                       size_t* numInsertedOut);
+
     /**
      * Navigates down the tree and locates the bucket and position containing a record with
      * the specified <key, recordLoc> combination.
@@ -429,7 +474,19 @@ private:
                    const DiskLoc recordLoc,
                    bool dupsAllowed,
                    const DiskLoc leftChild,
-                   const DiskLoc rightChild);
+                   const DiskLoc rightChild,
+                   DiskLoc* bucketLocOut);
+
+    /**
+     * Inserts 'key' into 'bucketLoc' if it can be placed there without looking at any other
+     * bucket. Returns false, having changed nothing, if the caller must descend from the root.
+     */
+    bool _insertIntoBucket(OperationContext* txn,
+                           const DiskLoc bucketLoc,
+                           const KeyDataType& key,
+                           const DiskLoc recordLoc,
+                           bool dupsAllowed,
+                           Status* statusOut);
 
     // TODO take a BucketType*?
     void insertHere(OperationContext* txn,
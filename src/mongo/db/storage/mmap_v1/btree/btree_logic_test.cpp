@@ -2259,6 +2259,59 @@ public:
     }
 };
 
+/**
+ * Bulk builds a tree deep enough that buckets are split at every level, then checks that every
+ * key is reachable once the builder has committed.
+ */
+template <class OnDiskFormat>
+class BulkBuildMultiLevel : public BtreeLogicTestBase<OnDiskFormat> {
+public:
+    void run() {
+        OperationContextNoop txn;
+        this->_helper.btree.initAsEmpty(&txn);
+
+        const int nKeys = 2000;
+        {
+            std::unique_ptr<typename BtreeLogic<OnDiskFormat>::Builder> builder(
+                this->_helper.btree.newBuilder(&txn, false));
+
+            for (int i = 0; i < nKeys; ++i) {
+                ASSERT_OK(builder->addKey(bulkKey(i), this->_helper.dummyDiskLoc));
+            }
+
+            // Keys must arrive in order, and without duplicates when those are not allowed.
+            ASSERT_EQUALS(ErrorCodes::DuplicateKey,
+                          builder->addKey(bulkKey(nKeys - 1), this->_helper.dummyDiskLoc));
+            ASSERT_EQUALS(ErrorCodes::InternalError,
+                          builder->addKey(bulkKey(0), this->_helper.dummyDiskLoc));
+
+            builder->commit();
+        }
+
+        this->checkValidNumKeys(nKeys);
+
+        // With keys this large the tree needs at least three levels.
+        const typename BtreeLogicTestBase<OnDiskFormat>::BucketType* bucket = this->head();
+        ASSERT_FALSE(bucket->nextChild.isNull());
+        bucket = this->child(bucket, bucket->n);
+        ASSERT_FALSE(bucket->nextChild.isNull());
+
+        for (int i = 0; i < nKeys; i += 97) {
+            int pos;
+            DiskLoc loc;
+            ASSERT_TRUE(this->_helper.btree.locate(
+                &txn, bulkKey(i), this->_helper.dummyDiskLoc, 1, &pos, &loc));
+        }
+    }
+
+private:
+    static BSONObj bulkKey(int i) {
+        char num[16];
+        sprintf(num, "%08d", i);
+        return BSON("" << (std::string(num) + std::string(700, 'x')));
+    }
+};
+
 
 /* This test requires the entire server to be linked-in and it is better implemented using
    the JS framework. Disabling here and will put in jsCore.
@@ -2489,6 +2542,8 @@ public:
         add<LocateEmptyReverse<OnDiskFormat>>();
 
         add<DuplicateKeys<OnDiskFormat>>();
+
+        add<BulkBuildMultiLevel<OnDiskFormat>>();
     }
 };
 
@@ -43,6 +43,7 @@
 #include "mongo/db/storage/mmap_v1/mmap_v1_options.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/storage/mmap_v1/file_allocator.h"
+#include "mongo/db/storage/mmap_v1/page_residency_refresher.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -120,6 +121,7 @@ Status DataFile::openExisting(const char* filename) {
     // The mapped view of the file should never be NULL if the open call above succeeded.
     _mb = mmf.getView();
     invariant(_mb);
+    _trackResidency();
 
     const uint64_t sz = mmf.length();
     invariant(sz <= 0x7fffffff);
@@ -181,9 +183,20 @@ void DataFile::open(OperationContext* txn,
     }
 
     data_file_check(_mb);
+    _trackResidency();
     header()->init(txn, _fileNo, size, filename);
 }
 
+DataFile::~DataFile() {
+    // Must happen before 'mmf' unmaps the view.
+    pageResidencyRefresher.untrack(&_residency);
+}
+
+void DataFile::_trackResidency() {
+    _residency.reset(_mb, mmf.length());
+    pageResidencyRefresher.track(mmf.asMongoFile(), &_residency);
+}
+
 void DataFile::flush(bool sync) {
     mmf.flush(sync);
 }
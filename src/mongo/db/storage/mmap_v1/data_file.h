@@ -32,6 +32,7 @@
 
 #include "mongo/db/storage/mmap_v1/diskloc.h"
 #include "mongo/db/storage/mmap_v1/durable_mapped_file.h"
+#include "mongo/db/storage/mmap_v1/page_residency_map.h"
 
 namespace mongo {
 
@@ -157,6 +158,7 @@ public:
 class DataFile {
 public:
     DataFile(int fn) : _fileNo(fn), _mb(NULL) {}
+    ~DataFile();
 
     /** @return true if found and opened. if uninitialized (prealloc only) does not open. */
     Status openExisting(const char* filename);
@@ -189,6 +191,11 @@ public:
     /** fsync */
     void flush(bool sync);
 
+    /** Which pages of the mapped view are resident; see PageResidencyMap. */
+    const PageResidencyMap& residency() const {
+        return _residency;
+    }
+
 private:
     friend class MmapV1ExtentManager;
 
@@ -198,6 +205,9 @@ private:
 
     void grow(DiskLoc dl, int size);
 
+    /** Starts tracking page residency of the mapped view. Called once the file is mapped. */
+    void _trackResidency();
+
     char* p() const {
         return (char*)_mb;
     }
@@ -213,5 +223,7 @@ private:
 
     DurableMappedFile mmf;
     void* _mb;  // the memory mapped view
+
+    PageResidencyMap _residency;
 };
 }
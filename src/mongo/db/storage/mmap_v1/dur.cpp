@@ -84,6 +84,7 @@
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/storage/mmap_v1/aligned_builder.h"
 #include "mongo/db/storage/mmap_v1/dur_commitjob.h"
+#include "mongo/db/storage/mmap_v1/dur_group_commit.h"
 #include "mongo/db/storage/mmap_v1/dur_journal.h"
 #include "mongo/db/storage/mmap_v1/dur_journal_writer.h"
 #include "mongo/db/storage/mmap_v1/dur_recover.h"
@@ -455,6 +456,15 @@ void Stats::S::reset() {
     _startTimeMicros = curTimeMicros64();
 }
 
+void Stats::S::noteCommitBatch(unsigned waiters) {
+    int bucket = 0;
+    while (waiters && bucket < kNumCommitBatchBuckets - 1) {
+        waiters >>= 1;
+        bucket++;
+    }
+    _commitBatchSizes[bucket]++;
+}
+
 std::string Stats::S::_CSVHeader() const {
     return "cmts\t jrnMB\t wrDFMB\t cIWLk\t early\t prpLgB\t wrToJ\t wrToDF\t rmpPrVw";
 }
@@ -488,6 +498,26 @@ void Stats::S::_asObj(BSONObjBuilder* builder) const {
     if (mmapv1GlobalOptions.journalCommitInterval != 0) {
         b << "journalCommitIntervalMs" << mmapv1GlobalOptions.journalCommitInterval;
     }
+
+    {
+        BSONObjBuilder groupCommit(b.subobjStart("groupCommit"));
+        groupCommit << "intervalMs" << _groupCommitIntervalMillis << "avgBatchSize"
+                    << _avgCommitBatchSize;
+
+        // Histogram of the number of threads waiting on each commit, keyed by bucket range.
+        BSONObjBuilder batchSizes(groupCommit.subobjStart("batchSizes"));
+        for (int i = 0; i < kNumCommitBatchBuckets; i++) {
+            const unsigned low = i == 0 ? 0 : 1U << (i - 1);
+            const unsigned high = i == 0 ? 0 : (1U << i) - 1;
+            std::string range = std::to_string(low);
+            if (i == kNumCommitBatchBuckets - 1) {
+                range += "+";
+            } else if (high != low) {
+                range += "-" + std::to_string(high);
+            }
+            batchSizes << range << _commitBatchSizes[i];
+        }
+    }
 }
 
 
@@ -521,6 +551,10 @@ bool DurableImpl::commitNow(OperationContext* txn) {
 }
 
 bool DurableImpl::waitUntilDurable() {
+    // Wake the durability thread rather than waiting out the commit interval. It gathers
+    // concurrent waiters into a single group commit.
+    flushRequested.notify_one();
+
     commitNotify.awaitBeyondNow();
     return true;
 }
@@ -666,6 +700,8 @@ static void durThread() {
     JournalWriter journalWriter(&commitNotify, &applyToDataFilesNotify, NumAsyncJournalWrites);
     journalWriter.start();
 
+    GroupCommitPolicy groupCommit;
+
     // Used as an estimate of how much / how fast to remap
     uint64_t commitCounter(0);
     uint64_t estimatedPrivateMapSize(0);
@@ -677,6 +713,9 @@ static void durThread() {
             ms = samePartition ? 100 : 30;
         }
 
+        // The interval shortens while writers are waiting for commits
+        ms = groupCommit.intervalMillis(ms);
+
         // +1 so it never goes down to zero
         const unsigned oneThird = (ms / 3) + 1;
 
@@ -689,6 +728,11 @@ static void durThread() {
             stdx::unique_lock<stdx::mutex> lock(flushMutex);
 
             for (unsigned i = 0; i <= 2; i++) {
+                if (commitNotify.nWaiting()) {
+                    // Waiters arrived while the previous commit was running
+                    break;
+                }
+
                 if (stdx::cv_status::no_timeout ==
                     flushRequested.wait_for(lock, Milliseconds(oneThird))) {
                     // Someone forced a flush
@@ -706,6 +750,19 @@ static void durThread() {
                 }
             }
 
+            // Group commit: if recent commits were shared by several waiters, hold this one
+            // briefly so that concurrent writers join it instead of each waiting for the next.
+            const uint64_t gatherMicros =
+                groupCommit.gatherMicros(commitNotify.nWaiting(), oneThird * 1000ULL);
+            if (gatherMicros) {
+                const uint64_t gatherEnd = curTimeMicros64() + gatherMicros;
+                uint64_t nowMicros;
+                while (commitNotify.nWaiting() < groupCommit.expectedBatchSize() &&
+                       (nowMicros = curTimeMicros64()) < gatherEnd) {
+                    flushRequested.wait_for(lock, Microseconds(gatherEnd - nowMicros));
+                }
+            }
+
             // The commit logic itself
             LOG(4) << "groupCommit begin";
 
@@ -714,6 +771,9 @@ static void durThread() {
             OperationContextImpl txn;
             AutoAcquireFlushLockForMMAPV1Commit autoFlushLock(txn.lockState());
 
+            // Everyone waiting now is satisfied by this commit
+            const unsigned batchSize = commitNotify.nWaiting();
+
             // We need to snapshot the commitNumber after the flush lock has been obtained,
             // because at this point we know that we have a stable snapshot of the data.
             const NotifyAll::When commitNumber(commitNotify.now());
@@ -827,6 +887,11 @@ static void durThread() {
             stats.curr()->_commits++;
             stats.curr()->_commitsMicros += t.micros();
 
+            groupCommit.noteCommit(batchSize, t.micros());
+            stats.curr()->noteCommitBatch(batchSize);
+            stats.curr()->_groupCommitIntervalMillis = ms;
+            stats.curr()->_avgCommitBatchSize = groupCommit.averageBatchSize();
+
             LOG(4) << "groupCommit end";
         } catch (DBException& e) {
             severe() << "dbexception in durThread causing immediate shutdown: " << e.toString();
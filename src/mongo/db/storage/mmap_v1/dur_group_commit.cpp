@@ -0,0 +1,71 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/mmap_v1/dur_group_commit.h"
+
+#include <algorithm>
+
+namespace mongo {
+namespace dur {
+
+namespace {
+
+// Weight of the newest commit in the moving averages.
+const double kSmoothing = 1.0 / 8;
+
+// Gather only when recent commits have averaged at least this many waiters.
+const double kMinConcurrentWaiters = 1.5;
+
+}  // namespace
+
+const unsigned GroupCommitPolicy::kMinIntervalMillis;
+
+unsigned GroupCommitPolicy::intervalMillis(unsigned configuredMillis) const {
+    const unsigned shortened = static_cast<unsigned>(configuredMillis / (1 + _avgWaiters));
+    return std::max(shortened, std::min(configuredMillis, kMinIntervalMillis));
+}
+
+uint64_t GroupCommitPolicy::gatherMicros(unsigned waiting, uint64_t maxMicros) const {
+    if (waiting == 0 || waiting >= expectedBatchSize() || _avgWaiters < kMinConcurrentWaiters)
+        return 0;
+    return std::min(static_cast<uint64_t>(_avgCommitMicros), maxMicros);
+}
+
+unsigned GroupCommitPolicy::expectedBatchSize() const {
+    return std::max(1u, static_cast<unsigned>(_avgWaiters + 0.5));
+}
+
+void GroupCommitPolicy::noteCommit(unsigned waiters, uint64_t commitMicros) {
+    _avgWaiters += (waiters - _avgWaiters) * kSmoothing;
+    _avgCommitMicros += (commitMicros - _avgCommitMicros) * kSmoothing;
+}
+
+}  // namespace dur
+}  // namespace mongo
@@ -0,0 +1,85 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace mongo {
+namespace dur {
+
+/**
+ * Decides how the durability thread batches commits, based on how many threads waited for each
+ * recent group commit (j:true writers and commitNow callers) and how long the commits took.
+ *
+ * While writers are waiting it shortens the interval between commits. Once a writer is waiting,
+ * if recent commits have been shared by several waiters, it holds the commit for about one
+ * commit's duration so that more of them join. That at most doubles one writer's latency, but
+ * lets a single journal write satisfy the whole batch. A lone writer is committed right away.
+ *
+ * Only the durability thread uses this, so it is not synchronized.
+ */
+class GroupCommitPolicy {
+public:
+    // Waiter load never shortens the commit interval below this.
+    static const unsigned kMinIntervalMillis = 2;
+
+    /**
+     * Returns the interval to wait between commits given the configured one.
+     */
+    unsigned intervalMillis(unsigned configuredMillis) const;
+
+    /**
+     * Returns how long to hold a commit that 'waiting' threads are waiting for so that more can
+     * join, at most 'maxMicros'. Returns 0 if the commit should go ahead now.
+     */
+    uint64_t gatherMicros(unsigned waiting, uint64_t maxMicros) const;
+
+    /**
+     * Number of waiters recent commits have had, at least 1. A commit being gathered can go
+     * ahead once this many are waiting.
+     */
+    unsigned expectedBatchSize() const;
+
+    /**
+     * Records that a commit with 'waiters' waiters took 'commitMicros'.
+     */
+    void noteCommit(unsigned waiters, uint64_t commitMicros);
+
+    double averageBatchSize() const {
+        return _avgWaiters;
+    }
+
+private:
+    // Exponentially weighted moving averages over recent commits.
+    double _avgWaiters = 0;
+    double _avgCommitMicros = 0;
+};
+
+}  // namespace dur
+}  // namespace mongo
@@ -0,0 +1,92 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/mmap_v1/dur_group_commit.h"
+
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace dur {
+namespace {
+
+TEST(GroupCommitPolicy, KeepsConfiguredIntervalWithoutWaiters) {
+    GroupCommitPolicy policy;
+    ASSERT_EQUALS(100U, policy.intervalMillis(100));
+
+    for (int i = 0; i < 100; i++) {
+        policy.noteCommit(0, 1000);
+    }
+    ASSERT_EQUALS(100U, policy.intervalMillis(100));
+    ASSERT_EQUALS(1U, policy.expectedBatchSize());
+}
+
+TEST(GroupCommitPolicy, ShortensIntervalUnderWaiterLoad) {
+    GroupCommitPolicy policy;
+    for (int i = 0; i < 100; i++) {
+        policy.noteCommit(9, 1000);
+    }
+    ASSERT_APPROX_EQUAL(9.0, policy.averageBatchSize(), 0.1);
+    ASSERT_EQUALS(10U, policy.intervalMillis(100));
+
+    // Never below the minimum, nor above what was configured.
+    for (int i = 0; i < 100; i++) {
+        policy.noteCommit(1000, 1000);
+    }
+    ASSERT_EQUALS(GroupCommitPolicy::kMinIntervalMillis, policy.intervalMillis(100));
+    ASSERT_EQUALS(1U, policy.intervalMillis(1));
+}
+
+TEST(GroupCommitPolicy, CommitsLoneWriterImmediately) {
+    GroupCommitPolicy policy;
+    for (int i = 0; i < 100; i++) {
+        policy.noteCommit(1, 5000);
+    }
+    ASSERT_EQUALS(0U, policy.gatherMicros(1, 100000));
+}
+
+TEST(GroupCommitPolicy, GathersConcurrentWriters) {
+    GroupCommitPolicy policy;
+    for (int i = 0; i < 100; i++) {
+        policy.noteCommit(8, 5000);
+    }
+    ASSERT_EQUALS(8U, policy.expectedBatchSize());
+
+    // Holds for about one commit's duration, capped by the caller.
+    ASSERT_APPROX_EQUAL(5000.0, static_cast<double>(policy.gatherMicros(2, 100000)), 10.0);
+    ASSERT_EQUALS(1000U, policy.gatherMicros(2, 1000));
+
+    // Nothing to gather for, or the batch is already as large as usual.
+    ASSERT_EQUALS(0U, policy.gatherMicros(0, 100000));
+    ASSERT_EQUALS(0U, policy.gatherMicros(8, 100000));
+}
+
+}  // namespace
+}  // namespace dur
+}  // namespace mongo
@@ -40,6 +40,7 @@
 #include <sys/stat.h>
 
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/compress.h"
 #include "mongo/db/storage/mmap_v1/dur_commitjob.h"
 #include "mongo/db/storage/mmap_v1/dur_journal.h"
@@ -51,10 +52,13 @@
 #include "mongo/platform/strnlen.h"
 #include "mongo/util/bufreader.h"
 #include "mongo/util/checksum.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/hex.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/startup_test.h"
 
 namespace mongo {
@@ -103,6 +107,43 @@ struct ParsedJournalEntry {/*copyable*/
     std::shared_ptr<DurOp> op;
 };
 
+namespace {
+
+// Number of threads used to apply journaled writes to the data files during recovery. 0 picks
+// one per core, up to kMaxDefaultApplyThreads; 1 applies everything on the recovery thread.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(journalRecoveryApplyThreads, int, 0);
+
+const int kMaxDefaultApplyThreads = 8;
+const long long kProgressLogIntervalMillis = 10 * 1000;
+
+int getApplyThreadCount() {
+    if (journalRecoveryApplyThreads > 0) {
+        return journalRecoveryApplyThreads;
+    }
+    return std::max(1, std::min<int>(kMaxDefaultApplyThreads, ProcessInfo().getNumCores()));
+}
+
+/**
+ * The basic writes of one section that land in the same region of one data file, in journal
+ * order.
+ */
+struct RegionWrites {
+    DurableMappedFile* mmf;
+    std::vector<const JEntry*> writes;
+};
+
+unsigned long long applyRegionWrites(const RegionWrites& region) {
+    char* const base = static_cast<char*>(region.mmf->view_write());
+    unsigned long long bytes = 0;
+    for (const JEntry* e : region.writes) {
+        memcpy(base + e->ofs, e->srcData(), e->len);
+        bytes += e->len;
+    }
+    return bytes;
+}
+
+}  // namespace
+
 
 /**
  * Get journal filenames, in order. Throws if unexpected content found.
@@ -253,7 +294,11 @@ static string fileName(const char* dbName, int fileNo) {
 
 
 RecoveryJob::RecoveryJob()
-    : _recovering(false), _lastDataSyncedFromLastRun(0), _lastSeqMentionedInConsoleLog(1) {}
+    : _recovering(false),
+      _lastDataSyncedFromLastRun(0),
+      _lastSeqMentionedInConsoleLog(1),
+      _sectionsApplied(0),
+      _bytesApplied(0) {}
 
 RecoveryJob::~RecoveryJob() {
     DESTRUCTOR_GUARD(if (!_mmfs.empty()) {} close();)
@@ -321,6 +366,7 @@ void RecoveryJob::write(Last& last, const ParsedJournalEntry& entry) {
         void* dest = (char*)mmf->view_write() + entry.e->ofs;
         memcpy(dest, entry.e->srcData(), entry.e->len);
         stats.curr()->_writeToDataFilesBytes += entry.e->len;
+        _bytesApplied += entry.e->len;
     } else {
         massert(13622, "Trying to write past end of file in WRITETODATAFILES", _recovering);
     }
@@ -366,8 +412,13 @@ void RecoveryJob::applyEntries(const vector<ParsedJournalEntry>& entries) {
     }
 
     Last last;
-    for (vector<ParsedJournalEntry>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
-        applyEntry(last, *i, apply, dump);
+    if (_applyPool && apply && !dump) {
+        applyEntriesInParallel(last, entries);
+    } else {
+        for (vector<ParsedJournalEntry>::const_iterator i = entries.begin(); i != entries.end();
+             ++i) {
+            applyEntry(last, *i, apply, dump);
+        }
     }
 
     if (dump) {
@@ -375,6 +426,87 @@ void RecoveryJob::applyEntries(const vector<ParsedJournalEntry>& entries) {
     }
 }
 
+void RecoveryJob::applyEntriesInParallel(Last& last, const vector<ParsedJournalEntry>& entries) {
+    invariant(_recovering);
+
+    vector<RegionWrites> regions;
+    map<pair<DurableMappedFile*, unsigned long long>, size_t> regionIndex;
+
+    // Applies every region gathered so far and waits for all of them to land.
+    const auto flush = [&]() {
+        if (regions.empty()) {
+            return;
+        }
+
+        vector<unsigned long long> bytes(regions.size(), 0);
+        if (regions.size() == 1) {
+            bytes[0] = applyRegionWrites(regions[0]);
+        } else {
+            for (size_t r = 0; r < regions.size(); ++r) {
+                const RegionWrites* region = &regions[r];
+                unsigned long long* out = &bytes[r];
+                invariantOK(
+                    _applyPool->schedule([region, out]() { *out = applyRegionWrites(*region); }));
+            }
+            _applyPool->waitForIdle();
+        }
+
+        for (unsigned long long b : bytes) {
+            stats.curr()->_writeToDataFilesBytes += b;
+            _bytesApplied += b;
+        }
+        regions.clear();
+        regionIndex.clear();
+    };
+
+    for (const ParsedJournalEntry& entry : entries) {
+        if (!entry.e) {
+            // DurOps may create, extend or close files, so they must see every earlier write
+            // and precede every later one.
+            flush();
+            applyEntry(last, entry, true, false);
+            continue;
+        }
+
+        verify(entry.dbName);
+        DurableMappedFile* mmf = last.newEntry(entry, *this);
+        if (entry.e->len == 0 || (entry.e->ofs + entry.e->len) > mmf->length()) {
+            // write() likewise skips writes past the end of the file while recovering.
+            continue;
+        }
+        verify(mmf->view_write());
+        verify(entry.e->srcData());
+
+        const unsigned long long region = entry.e->ofs / kApplyRegionBytes;
+        if ((entry.e->ofs + entry.e->len - 1) / kApplyRegionBytes != region) {
+            flush();
+            write(last, entry);
+            continue;
+        }
+
+        const auto inserted =
+            regionIndex.insert(std::make_pair(std::make_pair(mmf, region), regions.size()));
+        if (inserted.second) {
+            regions.push_back(RegionWrites{mmf, {}});
+        }
+        regions[inserted.first->second].writes.push_back(entry.e);
+    }
+
+    flush();
+}
+
+void RecoveryJob::logProgress(const JSectHeader& h) {
+    ++_sectionsApplied;
+    if (_progressTimer.millis() < kProgressLogIntervalMillis) {
+        return;
+    }
+
+    log() << "recover progress: applied " << _sectionsApplied << " sections ("
+          << _bytesApplied / (1024 * 1024) << "MB) through section seq:" << h.seqNumber << " of "
+          << _currentJournalFile;
+    _progressTimer.reset();
+}
+
 void RecoveryJob::processSection(const JSectHeader* h,
                                  const void* p,
                                  unsigned len,
@@ -435,6 +567,10 @@ void RecoveryJob::processSection(const JSectHeader* h,
 
     // got all the entries for one group commit.  apply them:
     applyEntries(entries);
+
+    if (_recovering) {
+        logProgress(*h);
+    }
 }
 
 /** apply a specific journal file, that is already mmap'd
@@ -512,6 +648,7 @@ bool RecoveryJob::processFileBuffer(const void* p, unsigned len) {
 /** apply a specific journal file */
 bool RecoveryJob::processFile(boost::filesystem::path journalfile) {
     log() << "recover " << journalfile.string() << endl;
+    _currentJournalFile = journalfile.string();
 
     try {
         if (boost::filesystem::file_size(journalfile.string()) == 0) {
@@ -541,6 +678,23 @@ void RecoveryJob::go(vector<boost::filesystem::path>& files) {
     _lastDataSyncedFromLastRun = journalReadLSN();
     log() << "recover lsn: " << _lastDataSyncedFromLastRun << endl;
 
+    const bool apply = (mmapv1GlobalOptions.journalOptions & MMAPV1Options::JournalScanOnly) == 0;
+    const int applyThreads = getApplyThreadCount();
+    if (apply && applyThreads > 1) {
+        ThreadPool::Options options;
+        options.poolName = "journalRecovery";
+        options.minThreads = applyThreads;
+        options.maxThreads = applyThreads;
+        _applyPool.reset(new ThreadPool(options));
+        _applyPool->startup();
+    }
+    ON_BLOCK_EXIT([this]() { _applyPool.reset(); });
+
+    _sectionsApplied = 0;
+    _bytesApplied = 0;
+    _progressTimer.reset();
+    Timer recoveryTimer;
+
     for (unsigned i = 0; i != files.size(); ++i) {
         bool abruptEnd = processFile(files[i]);
         if (abruptEnd && i + 1 < files.size()) {
@@ -553,6 +707,10 @@ void RecoveryJob::go(vector<boost::filesystem::path>& files) {
 
     close();
 
+    log() << "recover applied " << _sectionsApplied << " sections (" << _bytesApplied
+          << " bytes) in " << recoveryTimer.millis()
+          << "ms using " << (_applyPool ? applyThreads : 1) << " thread(s)";
+
     if (mmapv1GlobalOptions.journalOptions & MMAPV1Options::JournalScanOnly) {
         uasserted(13545,
                   str::stream() << "--durOptions " << (int)MMAPV1Options::JournalScanOnly
@@ -32,13 +32,16 @@
 
 #include <boost/filesystem/operations.hpp>
 #include <list>
+#include <memory>
 
 #include "mongo/db/storage/mmap_v1/dur_journalformat.h"
 #include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
 class DurableMappedFile;
+class ThreadPool;
 
 namespace dur {
 
@@ -81,6 +84,16 @@ private:
     void write(Last& last, const ParsedJournalEntry& entry);  // actually writes to the file
     void applyEntry(Last& last, const ParsedJournalEntry& entry, bool apply, bool dump);
     void applyEntries(const std::vector<ParsedJournalEntry>& entries);
+
+    /**
+     * Applies the entries of one section using _applyPool. Basic writes are partitioned by data
+     * file and kApplyRegionBytes-sized offset range, with each region's writes applied in journal
+     * order by a single worker. DurOps and writes that straddle two regions act as barriers and
+     * are applied on the calling thread once all earlier writes have landed.
+     */
+    void applyEntriesInParallel(Last& last, const std::vector<ParsedJournalEntry>& entries);
+
+    void logProgress(const JSectHeader& h);
     bool processFileBuffer(const void*, unsigned len);
     bool processFile(boost::filesystem::path journalfile);
     void _close();  // doesn't lock
@@ -96,6 +109,18 @@ private:
     unsigned long long _lastDataSyncedFromLastRun;
     unsigned long long _lastSeqMentionedInConsoleLog;
 
+    // Workers used to apply writes during recovery; null when applying serially.
+    std::unique_ptr<ThreadPool> _applyPool;
+
+    // Progress reporting for recovery.
+    std::string _currentJournalFile;
+    unsigned long long _sectionsApplied;
+    unsigned long long _bytesApplied;
+    Timer _progressTimer;
+
+    // Size of the data file region owned by one apply task in applyEntriesInParallel.
+    static const unsigned long long kApplyRegionBytes = 64 * 1024 * 1024;
+
 
     static RecoveryJob& _instance;
 };
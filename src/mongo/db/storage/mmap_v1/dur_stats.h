@@ -51,6 +51,12 @@ struct Stats {
             return ((curTimeMicros64() - _startTimeMicros) / 1000);
         }
 
+        // Commits are counted by number of waiters in power-of-two buckets: 0, 1, 2-3, ...,
+        // with the last bucket holding everything larger.
+        static const int kNumCommitBatchBuckets = 8;
+
+        void noteCommitBatch(unsigned waiters);
+
 
         // Not reported. Internal use only.
         uint64_t _startTimeMicros;
@@ -71,6 +77,10 @@ struct Stats {
         uint64_t _remapPrivateViewMicros;
         uint64_t _commitsMicros;
         uint64_t _commitsInWriteLockMicros;
+
+        unsigned _commitBatchSizes[kNumCommitBatchBuckets];
+        unsigned _groupCommitIntervalMillis;
+        double _avgCommitBatchSize;
     };
 
 
@@ -106,6 +106,11 @@ public:
         return MemoryMappedFile::getFd();
     }
 
+    /** @return this file as registered in MongoFile::getAllFiles() while it is open. */
+    MongoFile* asMongoFile() {
+        return this;
+    }
+
     /** true if we have written.
         set in PREPLOGBUFFER, it is NOT set immediately on write intent declaration.
         reset to false in REMAPPRIVATEVIEW
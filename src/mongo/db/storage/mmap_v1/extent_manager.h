@@ -176,5 +176,11 @@ public:
      * Caller takes owernship of CacheHint
      */
     virtual CacheHint* cacheHint(const DiskLoc& extentLoc, const HintType& hint) = 0;
+
+    /**
+     * Asks the system to start paging in the extent at 'extentLoc' in the background because it
+     * is about to be scanned. Never blocks on I/O.
+     */
+    virtual void readaheadExtent(const DiskLoc& extentLoc) const {}
 };
 }
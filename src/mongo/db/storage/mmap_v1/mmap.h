@@ -54,6 +54,12 @@ public:
     enum Advice { Sequential = 1, Random = 2 };
     MAdvise(void* p, unsigned len, Advice a);
     ~MAdvise();  // destructor resets the range to MADV_NORMAL
+
+    /**
+     * Asks the OS to start reading [p, p+len) into memory in the background (MADV_WILLNEED).
+     * Does not wait for the reads and leaves no advice behind to be reset.
+     */
+    static void willNeed(void* p, unsigned len);
 private:
     void* _p;
     unsigned _len;
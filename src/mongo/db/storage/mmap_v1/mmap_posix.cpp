@@ -125,6 +125,7 @@ public:
 #if defined(__sun)
 MAdvise::MAdvise(void*, unsigned, Advice) {}
 MAdvise::~MAdvise() {}
+void MAdvise::willNeed(void*, unsigned) {}
 #else
 MAdvise::MAdvise(void* p, unsigned len, Advice a) {
     _p = _pageAlign(p);
@@ -148,6 +149,14 @@ MAdvise::MAdvise(void* p, unsigned len, Advice a) {
 MAdvise::~MAdvise() {
     madvise(_p, _len, MADV_NORMAL);
 }
+void MAdvise::willNeed(void* p, unsigned len) {
+    void* start = _pageAlign(p);
+    len += static_cast<unsigned>(reinterpret_cast<size_t>(p) - reinterpret_cast<size_t>(start));
+
+    if (madvise(start, len, MADV_WILLNEED)) {
+        error() << "madvise failed: " << errnoWithDescription();
+    }
+}
 #endif
 
 void* MemoryMappedFile::map(const char* filename, unsigned long long& length, int options) {
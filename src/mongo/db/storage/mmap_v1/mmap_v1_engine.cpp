@@ -45,6 +45,7 @@
 #include "mongo/db/storage/mmap_v1/dur_recovery_unit.h"
 #include "mongo/db/storage/mmap_v1/mmap_v1_database_catalog_entry.h"
 #include "mongo/db/storage/mmap_v1/mmap_v1_options.h"
+#include "mongo/db/storage/mmap_v1/page_residency_refresher.h"
 #include "mongo/db/storage/storage_engine_lock_file.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/storage/mmap_v1/file_allocator.h"
@@ -231,6 +232,7 @@ MMAPV1Engine::MMAPV1Engine(const StorageEngineLockFile& lockFile) {
 
 void MMAPV1Engine::finishInit() {
     dataFileSync.go();
+    pageResidencyRefresher.go();
 
     // Replays the journal (if needed) and starts the background thread. This requires the
     // ability to create OperationContexts.
@@ -327,10 +329,6 @@ bool MMAPV1Engine::isDurable() const {
     return getDur().isDurable();
 }
 
-RecordAccessTracker& MMAPV1Engine::getRecordAccessTracker() {
-    return _recordAccessTracker;
-}
-
 void MMAPV1Engine::cleanShutdown() {
     // wait until file preallocation finishes
     // we would only hang here if the file_allocator code generates a
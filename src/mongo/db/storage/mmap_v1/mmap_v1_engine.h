@@ -32,7 +32,6 @@
 
 #include <map>
 
-#include "mongo/db/storage/mmap_v1/record_access_tracker.h"
 #include "mongo/db/storage/storage_engine.h"
 #include "mongo/stdx/mutex.h"
 
@@ -79,28 +78,12 @@ public:
                           bool preserveClonedFilesOnFailure,
                           bool backupOriginalFiles);
 
-    /**
-     * Gets a reference to the abstraction used by MMAP v1 to track recently used memory
-     * addresses.
-     *
-     * MMAPv1 specific (non-virtual). This is non-const because callers are allowed to use
-     * the returned reference to modify the RecordAccessTracker.
-     *
-     * The RecordAccessTracker is thread-safe (it uses its own mutex internally).
-     */
-    RecordAccessTracker& getRecordAccessTracker();
-
 private:
     static void _listDatabases(const std::string& directory, std::vector<std::string>* out);
 
     stdx::mutex _entryMapMutex;
     typedef std::map<std::string, MMAPV1DatabaseCatalogEntry*> EntryMap;
     EntryMap _entryMap;
-
-    // A record access tracker is essentially a large table which tracks recently used
-    // addresses. It is used when higher layers (e.g. the query system) need to ask
-    // the storage engine whether data is likely in physical memory.
-    RecordAccessTracker _recordAccessTracker;
 };
 
 void _deleteDataFiles(const std::string& database);
@@ -37,14 +37,12 @@
 #include "mongo/base/counter.h"
 #include "mongo/db/audit.h"
 #include "mongo/db/client.h"
-#include "mongo/db/service_context.h"
 #include "mongo/db/storage/mmap_v1/dur.h"
 #include "mongo/db/storage/mmap_v1/data_file.h"
 #include "mongo/db/storage/mmap_v1/record.h"
 #include "mongo/db/storage/mmap_v1/extent.h"
 #include "mongo/db/storage/mmap_v1/extent_manager.h"
 #include "mongo/db/storage/mmap_v1/mmap.h"
-#include "mongo/db/storage/mmap_v1/mmap_v1_engine.h"
 #include "mongo/db/storage/mmap_v1/mmap_v1_options.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/db/operation_context.h"
@@ -68,6 +66,9 @@ static const int kNeedsFetchFailFreq = 2;
 static Counter64 needsFetchFailCounter;
 MONGO_FP_DECLARE(recordNeedsFetchFail);
 
+// Largest prefix of an extent that readaheadExtent() asks the OS to page in.
+static const unsigned kMaxReadaheadBytesPerExtent = 64 * 1024 * 1024;
+
 // Used to make sure the compiler doesn't get too smart on us when we're
 // trying to touch records.
 volatile int __record_touch_dummy = 1;
@@ -112,12 +113,7 @@ MmapV1ExtentManager::MmapV1ExtentManager(StringData dbname, StringData path, boo
     : _dbname(dbname.toString()),
       _path(path.toString()),
       _directoryPerDB(directoryPerDB),
-      _rid(RESOURCE_METADATA, dbname) {
-    StorageEngine* engine = getGlobalServiceContext()->getGlobalStorageEngine();
-    invariant(engine->isMmapV1());
-    MMAPV1Engine* mmapEngine = static_cast<MMAPV1Engine*>(engine);
-    _recordAccessTracker = &mmapEngine->getRecordAccessTracker();
-}
+      _rid(RESOURCE_METADATA, dbname) {}
 
 boost::filesystem::path MmapV1ExtentManager::_fileName(int n) const {
     stringstream ss;
@@ -286,7 +282,7 @@ MmapV1RecordHeader* MmapV1ExtentManager::_recordForV1(const DiskLoc& loc) const
 
 MmapV1RecordHeader* MmapV1ExtentManager::recordForV1(const DiskLoc& loc) const {
     MmapV1RecordHeader* record = _recordForV1(loc);
-    _recordAccessTracker->markAccessed(record);
+    _getOpenFile(loc.a())->residency().markResident(record);
     return record;
 }
 
@@ -296,7 +292,7 @@ std::unique_ptr<RecordFetcher> MmapV1ExtentManager::recordNeedsFetch(const DiskL
     MmapV1RecordHeader* record = _recordForV1(loc);
 
     // For testing: if failpoint is enabled we randomly request fetches without
-    // going to the RecordAccessTracker.
+    // consulting the residency map.
     if (MONGO_FAIL_POINT(recordNeedsFetchFail)) {
         needsFetchFailCounter.increment();
         if ((needsFetchFailCounter.get() % kNeedsFetchFailFreq) == 0) {
@@ -304,7 +300,7 @@ std::unique_ptr<RecordFetcher> MmapV1ExtentManager::recordNeedsFetch(const DiskL
         }
     }
 
-    if (!_recordAccessTracker->checkAccessedAndMark(record)) {
+    if (!_getOpenFile(loc.a())->residency().isResident(record)) {
         return stdx::make_unique<MmapV1RecordFetcher>(record);
     }
 
@@ -323,11 +319,12 @@ Extent* MmapV1ExtentManager::extentForV1(const DiskLoc& loc) const {
 
 Extent* MmapV1ExtentManager::getExtent(const DiskLoc& loc, bool doSanityCheck) const {
     loc.assertOk();
-    Extent* e = reinterpret_cast<Extent*>(_getOpenFile(loc.a())->p() + loc.getOfs());
+    const DataFile* df = _getOpenFile(loc.a());
+    Extent* e = reinterpret_cast<Extent*>(df->p() + loc.getOfs());
     if (doSanityCheck)
         e->assertOk();
 
-    _recordAccessTracker->markAccessed(e);
+    df->residency().markResident(e);
 
     return e;
 }
@@ -632,6 +629,15 @@ ExtentManager::CacheHint* MmapV1ExtentManager::cacheHint(const DiskLoc& extentLo
     return new CacheHintMadvise(reinterpret_cast<void*>(e), e->length, MAdvise::Sequential);
 }
 
+void MmapV1ExtentManager::readaheadExtent(const DiskLoc& extentLoc) const {
+    Extent* e = getExtent(extentLoc, false);
+
+    // Bound the I/O that a single scan can queue up at once; the rest of a very large extent is
+    // faulted in by the scan itself.
+    const unsigned len = std::min<unsigned>(e->length, kMaxReadaheadBytesPerExtent);
+    MAdvise::willNeed(e, len);
+}
+
 MmapV1ExtentManager::FilesArray::~FilesArray() {
     for (int i = 0; i < size(); i++) {
         delete _files[i];
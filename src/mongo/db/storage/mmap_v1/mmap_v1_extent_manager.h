@@ -39,7 +39,6 @@
 #include "mongo/db/concurrency/lock_manager_defs.h"
 #include "mongo/db/storage/mmap_v1/diskloc.h"
 #include "mongo/db/storage/mmap_v1/extent_manager.h"
-#include "mongo/db/storage/mmap_v1/record_access_tracker.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/mutex.h"
 
@@ -152,6 +151,8 @@ public:
 
     virtual CacheHint* cacheHint(const DiskLoc& extentLoc, const HintType& hint);
 
+    void readaheadExtent(const DiskLoc& extentLoc) const final;
+
 private:
     /**
      * will return NULL if nothing suitable in free list
@@ -191,10 +192,6 @@ private:
     const bool _directoryPerDB;
     const ResourceId _rid;
 
-    // This reference points into the MMAPv1 engine and is only valid as long as the
-    // engine is valid. Not owned here.
-    RecordAccessTracker* _recordAccessTracker;
-
     /**
      * Simple wrapper around an array object to allow append-only modification of the array,
      * as well as concurrent read-accesses. This class has a minimal interface to keep
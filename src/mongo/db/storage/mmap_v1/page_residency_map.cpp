@@ -0,0 +1,143 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/mmap_v1/page_residency_map.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "mongo/util/assert_util.h"
+#include "mongo/util/processinfo.h"
+
+namespace mongo {
+
+namespace {
+
+const unsigned kBitsPerWord = 64;
+
+static_assert(PageResidencyMap::PagesPerRefreshChunk % kBitsPerWord == 0,
+              "refresh chunks must cover whole bitmap words");
+
+}  // namespace
+
+PageResidencyMap::PageResidencyMap() : _base(NULL), _length(0), _numPages(0), _pageShift(0) {}
+
+void PageResidencyMap::reset(const void* base, size_t length) {
+    const size_t pageSize = ProcessInfo::getPageSize();
+    invariant(pageSize > 0 && (pageSize & (pageSize - 1)) == 0);
+
+    _pageShift = 0;
+    while ((size_t(1) << _pageShift) < pageSize) {
+        _pageShift++;
+    }
+
+    // Cover whole pages, starting from the page that contains 'base'.
+    const size_t start = reinterpret_cast<size_t>(base);
+    const size_t alignedStart = start & ~(pageSize - 1);
+    _base = reinterpret_cast<const char*>(alignedStart);
+    _length = length + (start - alignedStart);
+    _numPages = (_length + pageSize - 1) >> _pageShift;
+    _words.reset(new AtomicUInt64[(_numPages + kBitsPerWord - 1) / kBitsPerWord]);
+}
+
+bool PageResidencyMap::_pageOf(const void* ptr, size_t* page) const {
+    const char* p = static_cast<const char*>(ptr);
+    if (p < _base || p >= _base + _length) {
+        return false;
+    }
+
+    *page = static_cast<size_t>(p - _base) >> _pageShift;
+    return true;
+}
+
+bool PageResidencyMap::isResident(const void* ptr) const {
+    size_t page;
+    if (!_pageOf(ptr, &page)) {
+        return false;
+    }
+
+    const unsigned long long bit = 1ULL << (page % kBitsPerWord);
+    return _words[page / kBitsPerWord].loadRelaxed() & bit;
+}
+
+void PageResidencyMap::markResident(const void* ptr) const {
+    size_t page;
+    if (!_pageOf(ptr, &page)) {
+        return;
+    }
+
+    AtomicUInt64& word = _words[page / kBitsPerWord];
+    const unsigned long long bit = 1ULL << (page % kBitsPerWord);
+
+    // The common case is an already-resident page, which must not dirty the cache line.
+    unsigned long long old = word.loadRelaxed();
+    while (!(old & bit)) {
+        const unsigned long long seen = word.compareAndSwap(old, old | bit);
+        if (seen == old) {
+            break;
+        }
+        old = seen;
+    }
+}
+
+bool PageResidencyMap::refresh() {
+    const size_t numWords = (_numPages + kBitsPerWord - 1) / kBitsPerWord;
+
+    if (!ProcessInfo::blockCheckSupported()) {
+        for (size_t i = 0; i < numWords; i++) {
+            _words[i].store(0);
+        }
+        return true;
+    }
+
+    std::vector<char> resident;
+    for (size_t firstPage = 0; firstPage < _numPages; firstPage += PagesPerRefreshChunk) {
+        const size_t numPages = std::min<size_t>(PagesPerRefreshChunk, _numPages - firstPage);
+        if (!ProcessInfo::pagesInMemory(_base + (firstPage << _pageShift), numPages, &resident)) {
+            return false;
+        }
+
+        // Every chunk starts on a word boundary (see the static_assert above).
+        for (size_t i = 0; i < numPages; i += kBitsPerWord) {
+            const size_t bits = std::min<size_t>(kBitsPerWord, numPages - i);
+            unsigned long long word = 0;
+            for (size_t b = 0; b < bits; b++) {
+                if (resident[i + b]) {
+                    word |= 1ULL << b;
+                }
+            }
+            _words[(firstPage + i) / kBitsPerWord].store(word);
+        }
+    }
+
+    return true;
+}
+
+}  // namespace mongo
@@ -0,0 +1,115 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+/**
+ * A bitmap recording which pages of one memory mapped region are resident in physical memory.
+ * It is used to implement recordNeedsFetch() for the MMAP v1 storage engine: since MMAP v1 holds
+ * collection-level locks, it should yield them rather than take a page fault, and this map tells
+ * it which records can be read without faulting.
+ *
+ * The bits are refreshed from the operating system (mincore or its equivalent) by the
+ * PageResidencyRefresher, and set in between refreshes whenever a page is known to have been
+ * touched. Lookups and marks are lock-free and may run concurrently with a refresh; a bit that
+ * is stale for up to one refresh interval only costs an extra yield or a page fault, never
+ * correctness.
+ */
+class PageResidencyMap {
+    MONGO_DISALLOW_COPYING(PageResidencyMap);
+
+public:
+    enum Constants {
+        // Number of pages passed to the operating system in one residency query.
+        PagesPerRefreshChunk = 4096,
+    };
+
+    /**
+     * Constructs a map that covers no memory. Every lookup reports the page as not resident.
+     */
+    PageResidencyMap();
+
+    /**
+     * Covers the 'length' bytes starting at 'base' and forgets any earlier residency information.
+     * All pages are considered not resident until the first refresh() or markResident().
+     *
+     * Not thread-safe: must be called before the map is visible to readers or the refresher.
+     */
+    void reset(const void* base, size_t length);
+
+    /**
+     * @return whether the page containing 'ptr' was resident as of the last refresh, or has been
+     * marked resident since. Pointers outside the covered range are never resident.
+     */
+    bool isResident(const void* ptr) const;
+
+    /**
+     * Records that the page containing 'ptr' has just been touched and is therefore resident.
+     * Pointers outside the covered range are ignored. Safe to call concurrently with any other
+     * method except reset().
+     */
+    void markResident(const void* ptr) const;
+
+    /**
+     * Re-reads the residency of every covered page from the operating system. On platforms
+     * without a residency query this instead clears every bit, so that only pages touched
+     * since the last refresh are considered resident.
+     *
+     * @return false if the operating system query failed, in which case the bits are unchanged.
+     */
+    bool refresh();
+
+    size_t numPages() const {
+        return _numPages;
+    }
+
+private:
+    /**
+     * Sets '*page' to the index of the page containing 'ptr'.
+     * @return false if 'ptr' is outside the covered range.
+     */
+    bool _pageOf(const void* ptr, size_t* page) const;
+
+    const char* _base;
+    size_t _length;
+    size_t _numPages;
+    unsigned _pageShift;
+
+    // One bit per page, 64 pages per word.
+    std::unique_ptr<AtomicUInt64[]> _words;
+};
+
+}  // namespace mongo
@@ -0,0 +1,145 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/mmap_v1/page_residency_map.h"
+
+#include <vector>
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/processinfo.h"
+
+namespace mongo {
+namespace {
+
+const size_t kNumPages = 2 * PageResidencyMap::PagesPerRefreshChunk + 100;
+
+class PageResidencyMapTest : public unittest::Test {
+protected:
+    void setUp() override {
+        _pageSize = ProcessInfo::getPageSize();
+        _buffer.resize((kNumPages + 1) * _pageSize);
+
+        // Start on a page boundary so that page(i) is exactly the i'th page of the map.
+        const size_t start = reinterpret_cast<size_t>(&_buffer[0]);
+        _aligned = &_buffer[0] + ((_pageSize - start % _pageSize) % _pageSize);
+    }
+
+    const char* page(size_t n) const {
+        return _aligned + n * _pageSize;
+    }
+
+    size_t _pageSize;
+    std::vector<char> _buffer;
+    char* _aligned;
+};
+
+TEST_F(PageResidencyMapTest, EmptyMapHasNoResidentPages) {
+    PageResidencyMap map;
+    ASSERT_EQUALS(0U, map.numPages());
+    ASSERT_FALSE(map.isResident(page(0)));
+
+    map.markResident(page(0));
+    ASSERT_FALSE(map.isResident(page(0)));
+    ASSERT_TRUE(map.refresh());
+}
+
+TEST_F(PageResidencyMapTest, NothingResidentBeforeRefresh) {
+    PageResidencyMap map;
+    map.reset(page(0), kNumPages * _pageSize);
+    ASSERT_EQUALS(kNumPages, map.numPages());
+
+    for (size_t i = 0; i < kNumPages; i++) {
+        ASSERT_FALSE(map.isResident(page(i)));
+    }
+}
+
+TEST_F(PageResidencyMapTest, MarkResidentCoversOnlyThatPage) {
+    PageResidencyMap map;
+    map.reset(page(0), kNumPages * _pageSize);
+
+    map.markResident(page(65) + 17);
+
+    ASSERT_TRUE(map.isResident(page(65)));
+    ASSERT_TRUE(map.isResident(page(65) + _pageSize - 1));
+    ASSERT_FALSE(map.isResident(page(64)));
+    ASSERT_FALSE(map.isResident(page(66)));
+
+    // Marking twice is harmless.
+    map.markResident(page(65));
+    ASSERT_TRUE(map.isResident(page(65)));
+}
+
+TEST_F(PageResidencyMapTest, PointersOutsideRangeAreNeverResident) {
+    PageResidencyMap map;
+    map.reset(page(1), 10 * _pageSize);
+    ASSERT_EQUALS(10U, map.numPages());
+
+    map.markResident(page(0));
+    map.markResident(page(11));
+    ASSERT_FALSE(map.isResident(page(0)));
+    ASSERT_FALSE(map.isResident(page(11)));
+
+    map.markResident(page(10));
+    ASSERT_TRUE(map.isResident(page(10)));
+}
+
+TEST_F(PageResidencyMapTest, UnalignedBaseCoversWholePages) {
+    PageResidencyMap map;
+    map.reset(page(1) + 10, _pageSize);
+    ASSERT_EQUALS(2U, map.numPages());
+
+    map.markResident(page(1));
+    ASSERT_TRUE(map.isResident(page(1) + 10));
+    ASSERT_FALSE(map.isResident(page(1) - 1));
+}
+
+TEST_F(PageResidencyMapTest, RefreshFindsTouchedPages) {
+    // Touch every page, including those in the final partial chunk and word.
+    for (size_t i = 0; i < kNumPages; i++) {
+        _aligned[i * _pageSize] = 1;
+    }
+
+    PageResidencyMap map;
+    map.reset(page(0), kNumPages * _pageSize);
+    ASSERT_TRUE(map.refresh());
+
+    if (!ProcessInfo::blockCheckSupported()) {
+        // Without a residency query a refresh forgets everything.
+        ASSERT_FALSE(map.isResident(page(0)));
+        return;
+    }
+
+    for (size_t i = 0; i < kNumPages; i++) {
+        ASSERT_TRUE(map.isResident(page(i)));
+    }
+}
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,117 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/mmap_v1/page_residency_refresher.h"
+
+#include <algorithm>
+
+#include "mongo/db/client.h"
+#include "mongo/db/storage/mmap_v1/mmap.h"
+#include "mongo/db/storage/mmap_v1/page_residency_map.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+namespace {
+
+// Lower bound on the time between the starts of two refresh passes.
+const long long kMinRefreshIntervalMillis = 1000;
+
+// A pass that takes N ms is followed by a pause of (kRefreshIdleFactor * N) ms.
+const long long kRefreshIdleFactor = 4;
+
+}  // namespace
+
+PageResidencyRefresher pageResidencyRefresher;
+
+void PageResidencyRefresher::track(MongoFile* file, PageResidencyMap* map) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _maps[map] = file;
+}
+
+void PageResidencyRefresher::untrack(PageResidencyMap* map) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _maps.erase(map);
+}
+
+size_t PageResidencyRefresher::refreshAll() {
+    size_t pagesQueried = 0;
+
+    // Maps are visited one at a time in address order, so that files can be opened and closed
+    // between two maps and a map that is untracked mid-pass is simply skipped.
+    PageResidencyMap* last = NULL;
+    while (!inShutdown()) {
+        // Files are only unmapped under the exclusive lock, so holding it shared keeps the range
+        // covered by the current map valid while it is queried. It must be taken before _mutex,
+        // since untrack() may be called by a thread that holds it exclusively.
+        LockMongoFilesShared filesLock;
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+        const auto it = _maps.upper_bound(last);
+        if (it == _maps.end()) {
+            break;
+        }
+        last = it->first;
+
+        if (MongoFile::getAllFiles().count(it->second) == 0) {
+            // Closed, but the owning DataFile has not been destroyed yet.
+            continue;
+        }
+
+        if (it->first->refresh()) {
+            pagesQueried += it->first->numPages();
+        }
+    }
+
+    return pagesQueried;
+}
+
+void PageResidencyRefresher::run() {
+    Client::initThread(name().c_str());
+
+    while (!inShutdown()) {
+        Timer t;
+        const size_t pagesQueried = refreshAll();
+        const long long elapsedMillis = t.millis();
+
+        LOG(2) << "refreshed residency of " << pagesQueried << " pages in " << elapsedMillis
+               << "ms";
+
+        sleepmillis(std::max(kMinRefreshIntervalMillis - elapsedMillis,
+                             kRefreshIdleFactor * elapsedMillis));
+    }
+}
+
+}  // namespace mongo
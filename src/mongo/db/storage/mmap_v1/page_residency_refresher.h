@@ -0,0 +1,80 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/background.h"
+
+namespace mongo {
+
+class MongoFile;
+class PageResidencyMap;
+
+/**
+ * Background job that periodically refreshes the PageResidencyMap of every open data file from
+ * the operating system. A pass over all maps is spread out so that the refresher spends at most
+ * a fifth of its time querying residency, which keeps the cost bounded on very large data sets.
+ */
+class PageResidencyRefresher : public BackgroundJob {
+public:
+    std::string name() const override {
+        return "PageResidencyRefresher";
+    }
+
+    void run() override;
+
+    /**
+     * Starts refreshing 'map', which covers memory mapped by 'file'. The map is only refreshed
+     * while 'file' remains open.
+     */
+    void track(MongoFile* file, PageResidencyMap* map);
+
+    /**
+     * Stops refreshing 'map'. Once this returns, the refresher no longer accesses 'map'.
+     */
+    void untrack(PageResidencyMap* map);
+
+    /**
+     * Refreshes every tracked map whose file is still open.
+     *
+     * @return the number of pages whose residency was queried.
+     */
+    size_t refreshAll();
+
+private:
+    stdx::mutex _mutex;
+    std::map<PageResidencyMap*, MongoFile*> _maps;
+};
+
+extern PageResidencyRefresher pageResidencyRefresher;
+
+}  // namespace mongo
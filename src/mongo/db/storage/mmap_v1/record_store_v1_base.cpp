@@ -341,17 +341,65 @@ StatusWith<RecordId> RecordStoreV1Base::insertRecord(OperationContext* txn,
     return _insertRecord(txn, data, len, enforceQuota);
 }
 
+Status RecordStoreV1Base::insertRecords(OperationContext* txn,
+                                        std::vector<Record>* records,
+                                        bool enforceQuota) {
+    if (isCapped()) {
+        // Capped allocation decides what to delete from the stats, so they must be updated after
+        // every insert.
+        return RecordStore::insertRecords(txn, records, enforceQuota);
+    }
+
+    for (const Record& record : *records) {
+        if (record.data.size() < 4) {
+            return Status(ErrorCodes::InvalidLength, "record has to be >= 4 bytes");
+        }
+
+        if (record.data.size() + MmapV1RecordHeader::HeaderSize > MaxAllowedAllocation) {
+            return Status(ErrorCodes::InvalidLength, "record has to be <= 16.5MB");
+        }
+    }
+
+    long long netLength = 0;
+    for (Record& record : *records) {
+        StatusWith<DiskLoc> loc =
+            _allocAndWriteRecord(txn, record.data.data(), record.data.size(), enforceQuota);
+        if (!loc.isOK())
+            return loc.getStatus();
+
+        netLength += recordFor(loc.getValue())->netLength();
+        record.id = loc.getValue().toRecordId();
+    }
+
+    _details->incrementStats(txn, netLength, records->size());
+
+    return Status::OK();
+}
+
 StatusWith<RecordId> RecordStoreV1Base::_insertRecord(OperationContext* txn,
                                                       const char* data,
                                                       int len,
                                                       bool enforceQuota) {
+    StatusWith<DiskLoc> loc = _allocAndWriteRecord(txn, data, len, enforceQuota);
+    if (!loc.isOK())
+        return StatusWith<RecordId>(loc.getStatus());
+
+    _details->incrementStats(txn, recordFor(loc.getValue())->netLength(), 1);
+
+    return StatusWith<RecordId>(loc.getValue().toRecordId());
+}
+
+StatusWith<DiskLoc> RecordStoreV1Base::_allocAndWriteRecord(OperationContext* txn,
+                                                            const char* data,
+                                                            int len,
+                                                            bool enforceQuota) {
     const int lenWHdr = len + MmapV1RecordHeader::HeaderSize;
     const int lenToAlloc = shouldPadInserts() ? quantizeAllocationSpace(lenWHdr) : lenWHdr;
     fassert(17208, lenToAlloc >= lenWHdr);
 
     StatusWith<DiskLoc> loc = allocRecord(txn, lenToAlloc, enforceQuota);
     if (!loc.isOK())
-        return StatusWith<RecordId>(loc.getStatus());
+        return loc;
 
     MmapV1RecordHeader* r = recordFor(loc.getValue());
     fassert(17210, r->lengthWithHeaders() >= lenWHdr);
@@ -362,9 +410,7 @@ StatusWith<RecordId> RecordStoreV1Base::_insertRecord(OperationContext* txn,
 
     _addRecordToRecListInExtent(txn, r, loc.getValue());
 
-    _details->incrementStats(txn, r->netLength(), 1);
-
-    return StatusWith<RecordId>(loc.getValue().toRecordId());
+    return loc;
 }
 
 StatusWith<RecordId> RecordStoreV1Base::updateRecord(OperationContext* txn,
@@ -199,6 +199,8 @@ public:
                                       const DocWriter* doc,
                                       bool enforceQuota);
 
+    Status insertRecords(OperationContext* txn, std::vector<Record>* records, bool enforceQuota);
+
     virtual StatusWith<RecordId> updateRecord(OperationContext* txn,
                                               const RecordId& oldLocation,
                                               const char* data,
@@ -312,6 +314,14 @@ protected:
                                        int len,
                                        bool enforceQuota);
 
+    /**
+     * Allocates a record for 'data' and copies it in, without updating the stats.
+     */
+    StatusWith<DiskLoc> _allocAndWriteRecord(OperationContext* txn,
+                                             const char* data,
+                                             int len,
+                                             bool enforceQuota);
+
     std::unique_ptr<RecordStoreV1MetaData> _details;
     ExtentManager* _extentManager;
     bool _isSystemIndexes;
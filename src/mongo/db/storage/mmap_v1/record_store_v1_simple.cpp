@@ -34,6 +34,8 @@
 
 #include "mongo/db/storage/mmap_v1/record_store_v1_simple.h"
 
+#include <algorithm>
+
 #include "mongo/base/counter.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/client.h"
@@ -193,6 +195,9 @@ StatusWith<DiskLoc> SimpleRecordStoreV1::allocRecord(OperationContext* txn,
 }
 
 Status SimpleRecordStoreV1::truncate(OperationContext* txn) {
+    // Any extent being drained is about to be freed or reset, and its deleted records orphaned.
+    _onlineCompact.reset();
+
     const DiskLoc firstExtLoc = _details->firstExtent(txn);
     if (firstExtLoc.isNull() || !firstExtLoc.isValid()) {
         // Already empty
@@ -230,6 +235,11 @@ Status SimpleRecordStoreV1::truncate(OperationContext* txn) {
 void SimpleRecordStoreV1::addDeletedRec(OperationContext* txn, const DiskLoc& dloc) {
     DeletedRecord* d = drec(dloc);
 
+    if (_inExtentBeingDrained(dloc, d)) {
+        // compactOnline() frees the whole extent once it is empty, so its space is not reused.
+        return;
+    }
+
     int b = bucket(d->lengthWithHeaders());
     *txn->recoveryUnit()->writing(&d->nextDeleted()) = _details->deletedListEntry(b);
     _details->setDeletedListEntry(txn, b, dloc);
@@ -342,26 +352,8 @@ void SimpleRecordStoreV1::_compactExtent(OperationContext* txn,
 
                 // Allocation sizes include the headers and possibly some padding.
                 const unsigned minAllocationSize = rawDataSize + MmapV1RecordHeader::HeaderSize;
-                unsigned allocationSize = minAllocationSize;
-                switch (compactOptions->paddingMode) {
-                    case CompactOptions::NONE:  // default padding
-                        if (shouldPadInserts()) {
-                            allocationSize = quantizeAllocationSpace(minAllocationSize);
-                        }
-                        break;
-
-                    case CompactOptions::PRESERVE:  // keep original padding
-                        allocationSize = recOld->lengthWithHeaders();
-                        break;
-
-                    case CompactOptions::MANUAL:  // user specified how much padding to use
-                        allocationSize = compactOptions->computeRecordSize(minAllocationSize);
-                        if (allocationSize < minAllocationSize ||
-                            allocationSize > BSONObjMaxUserSize / 2) {
-                            allocationSize = minAllocationSize;
-                        }
-                        break;
-                }
+                const unsigned allocationSize =
+                    _compactAllocationSize(recOld, rawDataSize, compactOptions);
                 invariant(allocationSize >= minAllocationSize);
 
                 // Copy the data to a new record. Because we orphaned the record freelist at the
@@ -427,10 +419,40 @@ void SimpleRecordStoreV1::_compactExtent(OperationContext* txn,
     }
 }
 
+unsigned SimpleRecordStoreV1::_compactAllocationSize(const MmapV1RecordHeader* rec,
+                                                     unsigned rawDataSize,
+                                                     const CompactOptions* compactOptions) const {
+    const unsigned minAllocationSize = rawDataSize + MmapV1RecordHeader::HeaderSize;
+    unsigned allocationSize = minAllocationSize;
+    switch (compactOptions->paddingMode) {
+        case CompactOptions::NONE:  // default padding
+            if (shouldPadInserts()) {
+                allocationSize = quantizeAllocationSpace(minAllocationSize);
+            }
+            break;
+
+        case CompactOptions::PRESERVE:  // keep original padding
+            allocationSize = rec->lengthWithHeaders();
+            break;
+
+        case CompactOptions::MANUAL:  // user specified how much padding to use
+            allocationSize = compactOptions->computeRecordSize(minAllocationSize);
+            if (allocationSize < minAllocationSize || allocationSize > BSONObjMaxUserSize / 2) {
+                allocationSize = minAllocationSize;
+            }
+            break;
+    }
+    return allocationSize;
+}
+
 Status SimpleRecordStoreV1::compact(OperationContext* txn,
                                     RecordStoreCompactAdaptor* adaptor,
                                     const CompactOptions* options,
                                     CompactStats* stats) {
+    // The deleted lists are orphaned below, so there is nothing left to preserve for an
+    // interrupted online compaction.
+    _onlineCompact.reset();
+
     std::vector<DiskLoc> extents;
     for (DiskLoc extLocation = _details->firstExtent(txn); !extLocation.isNull();
          extLocation = _extentManager->getExtent(extLocation)->xnext) {
@@ -480,4 +502,179 @@ Status SimpleRecordStoreV1::compact(OperationContext* txn,
 
     return Status::OK();
 }
+namespace {
+// Extents whose records fill less than this fraction of their space are worth emptying.
+const double kOnlineCompactMaxUtilization = 0.5;
+}  // namespace
+
+bool SimpleRecordStoreV1::_inExtentBeingDrained(const DiskLoc& loc, const DeletedRecord* d) const {
+    return _onlineCompact && !_onlineCompact->drainingExtent.isNull() &&
+        DiskLoc(loc.a(), d->extentOfs()) == _onlineCompact->drainingExtent;
+}
+
+long long SimpleRecordStoreV1::_extentBytesInUse(OperationContext* txn,
+                                                 const DiskLoc& extentLoc) const {
+    long long bytesInUse = 0;
+    const Extent* const extent = _getExtent(txn, extentLoc);
+    for (DiskLoc loc = extent->firstRecord; !loc.isNull();
+         loc = getNextRecordInExtent(txn, loc)) {
+        bytesInUse += recordFor(loc)->lengthWithHeaders();
+    }
+    return bytesInUse;
+}
+
+void SimpleRecordStoreV1::_unlinkDeletedRecordsInExtent(OperationContext* txn,
+                                                        const DiskLoc& extentLoc) {
+    const auto inExtent = [this, &extentLoc](const DiskLoc& loc) {
+        return DiskLoc(loc.a(), drec(loc)->extentOfs()) == extentLoc;
+    };
+
+    for (int b = 0; b < Buckets; b++) {
+        DiskLoc prev;
+        DiskLoc loc = _details->deletedListEntry(b);
+        while (!loc.isNull()) {
+            const DiskLoc next = drec(loc)->nextDeleted();
+            if (!inExtent(loc)) {
+                prev = loc;
+            } else if (prev.isNull()) {
+                _details->setDeletedListEntry(txn, b, next);
+            } else {
+                *txn->recoveryUnit()->writing(&drec(prev)->nextDeleted()) = next;
+            }
+            loc = next;
+        }
+    }
+
+    // The grab bag from older versions is drained into the deleted lists by allocations, so it
+    // must not be left pointing into the extent either.
+    DiskLoc prev;
+    DiskLoc loc = _details->deletedListLegacyGrabBag();
+    while (!loc.isNull()) {
+        const DiskLoc next = drec(loc)->nextDeleted();
+        if (!inExtent(loc)) {
+            prev = loc;
+        } else if (prev.isNull()) {
+            _details->setDeletedListLegacyGrabBag(txn, next);
+        } else {
+            *txn->recoveryUnit()->writing(&drec(prev)->nextDeleted()) = next;
+        }
+        loc = next;
+    }
+}
+
+void SimpleRecordStoreV1::_freeEmptyExtent(OperationContext* txn, const DiskLoc& extentLoc) {
+    Extent* const extent = _extentManager->getExtent(extentLoc);
+    invariant(extent->firstRecord.isNull());
+    invariant(extent->lastRecord.isNull());
+
+    // The last extent is never drained, so there is always a next extent.
+    invariant(_details->lastExtent(txn) != extentLoc);
+    const DiskLoc prev = extent->xprev;
+    const DiskLoc next = extent->xnext;
+
+    *txn->recoveryUnit()->writing(&_extentManager->getExtent(next)->xprev) = prev;
+    if (prev.isNull()) {
+        _details->setFirstExtent(txn, next);
+    } else {
+        *txn->recoveryUnit()->writing(&_extentManager->getExtent(prev)->xnext) = next;
+    }
+    _extentManager->freeExtent(txn, extentLoc);
+}
+
+Status SimpleRecordStoreV1::compactOnline(OperationContext* txn,
+                                          RecordStoreCompactAdaptor* adaptor,
+                                          const CompactOptions* options,
+                                          long long maxBytes,
+                                          CompactStats* stats,
+                                          bool* done) {
+    if (!_onlineCompact) {
+        _onlineCompact.reset(new OnlineCompactState());
+        _onlineCompact->nextExtentToMeasure = _details->firstExtent(txn);
+        log() << "compact online begin for namespace " << _ns;
+    }
+    OnlineCompactState* const state = _onlineCompact.get();
+
+    long long bytesLeft = maxBytes;
+
+    // Phase 1: find the extents worth emptying. The last extent is where new records go, so it
+    // is never a candidate.
+    while (bytesLeft > 0 && !state->nextExtentToMeasure.isNull()) {
+        const DiskLoc extentLoc = state->nextExtentToMeasure;
+        const Extent* const extent = _getExtent(txn, extentLoc);
+        state->nextExtentToMeasure = extent->xnext;
+        if (extentLoc != _details->lastExtent(txn)) {
+            const long long bytesInUse = _extentBytesInUse(txn, extentLoc);
+            const double utilization = double(bytesInUse) / extent->length;
+            if (utilization < kOnlineCompactMaxUtilization) {
+                state->candidates.push_back(std::make_pair(utilization, extentLoc));
+            }
+            bytesLeft -= bytesInUse;
+        }
+
+        if (state->nextExtentToMeasure.isNull()) {
+            std::sort(state->candidates.rbegin(), state->candidates.rend());
+            log() << "compact online found " << state->candidates.size()
+                  << " extents to empty for namespace " << _ns;
+        }
+    }
+
+    // Phase 2: empty the candidates, least utilized first.
+    while (bytesLeft > 0 && state->nextExtentToMeasure.isNull()) {
+        if (state->drainingExtent.isNull()) {
+            if (state->candidates.empty()) {
+                break;
+            }
+            const DiskLoc extentLoc = state->candidates.back().second;
+            state->candidates.pop_back();
+
+            WriteUnitOfWork wunit(txn);
+            _unlinkDeletedRecordsInExtent(txn, extentLoc);
+            wunit.commit();
+            state->drainingExtent = extentLoc;
+        }
+
+        const DiskLoc extentLoc = state->drainingExtent;
+        Extent* const extent = _extentManager->getExtent(extentLoc);
+        while (bytesLeft > 0 && !extent->firstRecord.isNull()) {
+            const DiskLoc oldLoc = extent->firstRecord;
+
+            WriteUnitOfWork wunit(txn);
+            const MmapV1RecordHeader* recOld = recordFor(oldLoc);
+            const int oldLengthWithHeaders = recOld->lengthWithHeaders();
+            const unsigned rawDataSize = adaptor->dataSize(recOld->toRecordData());
+
+            // Nothing in the deleted lists is inside the extent, so the copy goes elsewhere.
+            CompactDocWriter writer(
+                recOld, rawDataSize, _compactAllocationSize(recOld, rawDataSize, options));
+            StatusWith<RecordId> status = insertRecord(txn, &writer, false);
+            if (!status.isOK()) {
+                return status.getStatus();
+            }
+            const MmapV1RecordHeader* newRec = recordFor(DiskLoc::fromRecordId(status.getValue()));
+
+            adaptor->moved(newRec->toRecordData(), oldLoc.toRecordId(), status.getValue());
+            deleteRecord(txn, oldLoc.toRecordId());
+            wunit.commit();
+
+            stats->bytesMoved += oldLengthWithHeaders;
+            bytesLeft -= oldLengthWithHeaders;
+        }
+
+        if (extent->firstRecord.isNull()) {
+            WriteUnitOfWork wunit(txn);
+            _freeEmptyExtent(txn, extentLoc);
+            wunit.commit();
+            state->drainingExtent = DiskLoc();
+            stats->extentsFreed++;
+        }
+    }
+
+    *done = state->nextExtentToMeasure.isNull() && state->drainingExtent.isNull() &&
+        state->candidates.empty();
+    if (*done) {
+        log() << "compact online end for namespace " << _ns;
+        _onlineCompact.reset();
+    }
+    return Status::OK();
+}
 }
@@ -75,6 +75,22 @@ public:
                            const CompactOptions* options,
                            CompactStats* stats);
 
+    virtual bool compactOnlineSupported() const {
+        return true;
+    }
+
+    /**
+     * Measures the utilization of every extent but the last, then empties the least utilized
+     * extents one at a time by moving their records elsewhere, and returns each emptied extent
+     * to the ExtentManager. While an extent is being emptied none of its free space is reused.
+     */
+    virtual Status compactOnline(OperationContext* txn,
+                                 RecordStoreCompactAdaptor* adaptor,
+                                 const CompactOptions* options,
+                                 long long maxBytes,
+                                 CompactStats* stats,
+                                 bool* done);
+
 protected:
     virtual bool isCapped() const {
         return false;
@@ -99,8 +115,48 @@ private:
                         const CompactOptions* compactOptions,
                         CompactStats* stats);
 
+    /**
+     * Returns the size, including headers, to give the copy of 'rec' made by compaction.
+     */
+    unsigned _compactAllocationSize(const MmapV1RecordHeader* rec,
+                                    unsigned rawDataSize,
+                                    const CompactOptions* compactOptions) const;
+
+    /**
+     * Returns the number of bytes used by records in the extent at 'extentLoc'.
+     */
+    long long _extentBytesInUse(OperationContext* txn, const DiskLoc& extentLoc) const;
+
+    /**
+     * Unlinks every deleted record inside the extent at 'extentLoc' from the deleted lists.
+     */
+    void _unlinkDeletedRecordsInExtent(OperationContext* txn, const DiskLoc& extentLoc);
+
+    /**
+     * Removes the empty extent at 'extentLoc' from the extent list and frees it.
+     */
+    void _freeEmptyExtent(OperationContext* txn, const DiskLoc& extentLoc);
+
+    bool _inExtentBeingDrained(const DiskLoc& loc, const DeletedRecord* d) const;
+
+    /**
+     * Work carried over between calls to compactOnline().
+     */
+    struct OnlineCompactState {
+        // Next extent whose utilization should be measured. Null once all have been measured.
+        DiskLoc nextExtentToMeasure;
+
+        // Extents worth emptying, as (utilization, extent) pairs with the least utilized last.
+        std::vector<std::pair<double, DiskLoc>> candidates;
+
+        // Extent whose records are currently being moved out, or Null.
+        DiskLoc drainingExtent;
+    };
+
     bool _normalCollection;
 
+    std::unique_ptr<OnlineCompactState> _onlineCompact;
+
     friend class SimpleRecordStoreV1Iterator;
 };
 }
@@ -28,13 +28,24 @@
 
 #include "mongo/db/storage/mmap_v1/record_store_v1_simple_iterator.h"
 
+#include <vector>
+
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/extent.h"
 #include "mongo/db/storage/mmap_v1/extent_manager.h"
 #include "mongo/db/storage/mmap_v1/record_store_v1_simple.h"
 
 namespace mongo {
 
+namespace {
+
+// Number of extents a collection scan pages in ahead of the extent it is reading, unless the
+// query sets its own 'readahead'.
+MONGO_EXPORT_SERVER_PARAMETER(mmapv1CollectionScanReadaheadExtents, int, 2);
+
+}  // namespace
+
 //
 // Regular / non-capped collection traversal
 //
@@ -42,7 +53,10 @@ namespace mongo {
 SimpleRecordStoreV1Iterator::SimpleRecordStoreV1Iterator(OperationContext* txn,
                                                          const SimpleRecordStoreV1* collection,
                                                          bool forward)
-    : _txn(txn), _recordStore(collection), _forward(forward) {
+    : _txn(txn),
+      _recordStore(collection),
+      _forward(forward),
+      _readahead(mmapv1CollectionScanReadaheadExtents) {
     // Eagerly seek to first Record on creation since it is cheap.
     const ExtentManager* em = _recordStore->_extentManager;
     if (_recordStore->details()->firstExtent(txn).isNull()) {
@@ -74,6 +88,8 @@ SimpleRecordStoreV1Iterator::SimpleRecordStoreV1Iterator(OperationContext* txn,
         // valid e->xprev
         _curr = e->lastRecord;
     }
+
+    _readaheadIfNewExtent();
 }
 
 boost::optional<Record> SimpleRecordStoreV1Iterator::next() {
@@ -98,7 +114,56 @@ void SimpleRecordStoreV1Iterator::advance() {
         } else {
             _curr = _recordStore->getPrevRecord(_txn, _curr);
         }
+        _readaheadIfNewExtent();
+    }
+}
+
+void SimpleRecordStoreV1Iterator::setReadahead(int extents) {
+    _readahead = extents;
+
+    // Forget what was requested under the old setting so the new window is requested in full.
+    _currExtent = DiskLoc();
+    _readaheadThrough = DiskLoc();
+    _readaheadIfNewExtent();
+}
+
+void SimpleRecordStoreV1Iterator::_readaheadIfNewExtent() {
+    if (_readahead <= 0 || isEOF()) {
+        return;
+    }
+
+    const ExtentManager* em = _recordStore->_extentManager;
+    const DiskLoc extentLoc = em->extentLocForV1(_curr);
+    if (extentLoc == _currExtent) {
+        return;
+    }
+    _currExtent = extentLoc;
+
+    // The window is the current extent and the _readahead extents after it.
+    std::vector<DiskLoc> window(1, extentLoc);
+    while (window.size() <= static_cast<size_t>(_readahead)) {
+        const Extent* e = em->getExtent(window.back(), false);
+        const DiskLoc next = _forward ? e->xnext : e->xprev;
+        if (next.isNull()) {
+            break;
+        }
+        window.push_back(next);
+    }
+
+    // Extents up to _readaheadThrough were requested when an earlier extent was entered. If the
+    // cursor jumped somewhere else entirely, request the whole window.
+    size_t firstNew = 0;
+    for (size_t i = 0; i < window.size(); i++) {
+        if (window[i] == _readaheadThrough) {
+            firstNew = i + 1;
+            break;
+        }
+    }
+
+    for (size_t i = firstNew; i < window.size(); i++) {
+        em->readaheadExtent(window[i]);
     }
+    _readaheadThrough = window.back();
 }
 
 void SimpleRecordStoreV1Iterator::invalidate(const RecordId& dl) {
@@ -60,6 +60,7 @@ public:
     void invalidate(const RecordId& dl) final;
     std::unique_ptr<RecordFetcher> fetcherForNext() const final;
     std::unique_ptr<RecordFetcher> fetcherForId(const RecordId& id) const final;
+    void setReadahead(int extents) final;
 
 private:
     void advance();
@@ -67,6 +68,13 @@ private:
         return _curr.isNull();
     }
 
+    /**
+     * Called whenever _curr moves. When it has entered a new extent, asks the extent manager to
+     * page in that extent and the _readahead extents after it in scan order, skipping those that
+     * were already requested.
+     */
+    void _readaheadIfNewExtent();
+
     // for getNext, not owned
     OperationContext* _txn;
 
@@ -74,6 +82,15 @@ private:
     DiskLoc _curr;
     const SimpleRecordStoreV1* const _recordStore;
     const bool _forward;
+
+    // How many extents ahead of the one holding _curr to keep paging in. 0 disables readahead.
+    int _readahead;
+
+    // The extent that holds _curr, as of the last call to _readaheadIfNewExtent().
+    DiskLoc _currExtent;
+
+    // The furthest extent, in scan order, that has been passed to readaheadExtent().
+    DiskLoc _readaheadThrough;
 };
 
 }  // namespace mongo
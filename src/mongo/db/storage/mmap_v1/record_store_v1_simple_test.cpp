@@ -30,6 +30,7 @@
 
 #include "mongo/db/storage/mmap_v1/record_store_v1_simple.h"
 
+#include "mongo/db/catalog/collection.h"
 #include "mongo/db/operation_context_noop.h"
 #include "mongo/db/storage/mmap_v1/extent.h"
 #include "mongo/db/storage/mmap_v1/record.h"
@@ -449,4 +450,163 @@ TEST(SimpleRecordStoreV1, Truncate) {
         assertStateV1RS(&txn, recs, drecs, NULL, &em, md);
     }
 }
+
+// -----------------
+
+TEST(SimpleRecordStoreV1, ScanReadsAheadExtents) {
+    OperationContextNoop txn;
+    DummyExtentManager em;
+    DummyRecordStoreV1MetaData* md = new DummyRecordStoreV1MetaData(false, 0);
+    SimpleRecordStoreV1 rs(&txn, "test.foo", md, &em, false);
+
+    {
+        LocAndSize recs[] = {{DiskLoc(0, 1000), 100},
+                             {DiskLoc(1, 1000), 100},
+                             {DiskLoc(2, 1000), 100},
+                             {DiskLoc(3, 1000), 100},
+                             {}};
+        initializeV1RS(&txn, recs, NULL, NULL, &em, md);
+    }
+
+    auto cursor = rs.getCursor(&txn, true);
+    em.readaheadRequests.clear();
+
+    // The extent being read and the one after it are requested up front.
+    cursor->setReadahead(1);
+    ASSERT_EQUALS(2U, em.readaheadRequests.size());
+    ASSERT_EQUALS(DiskLoc(0, 0), em.readaheadRequests[0]);
+    ASSERT_EQUALS(DiskLoc(1, 0), em.readaheadRequests[1]);
+
+    // Each step into a new extent requests only the one extent that entered the window.
+    int numRecords = 0;
+    while (cursor->next()) {
+        numRecords++;
+    }
+    ASSERT_EQUALS(4, numRecords);
+    ASSERT_EQUALS(4U, em.readaheadRequests.size());
+    ASSERT_EQUALS(DiskLoc(2, 0), em.readaheadRequests[2]);
+    ASSERT_EQUALS(DiskLoc(3, 0), em.readaheadRequests[3]);
+}
+
+TEST(SimpleRecordStoreV1, ScanReadaheadDisabled) {
+    OperationContextNoop txn;
+    DummyExtentManager em;
+    DummyRecordStoreV1MetaData* md = new DummyRecordStoreV1MetaData(false, 0);
+    SimpleRecordStoreV1 rs(&txn, "test.foo", md, &em, false);
+
+    {
+        LocAndSize recs[] = {{DiskLoc(0, 1000), 100}, {DiskLoc(1, 1000), 100}, {}};
+        initializeV1RS(&txn, recs, NULL, NULL, &em, md);
+    }
+
+    auto cursor = rs.getCursor(&txn, false);
+    cursor->setReadahead(0);
+    em.readaheadRequests.clear();
+
+    while (cursor->next()) {
+    }
+    ASSERT_EQUALS(0U, em.readaheadRequests.size());
+}
+// -----------------
+
+/**
+ * Records the moves made by online compaction.
+ */
+class RecordingCompactAdaptor : public RecordStoreCompactAdaptor {
+public:
+    virtual bool isDataValid(const RecordData& recData) {
+        return true;
+    }
+    virtual size_t dataSize(const RecordData& recData) {
+        return recData.size();
+    }
+    virtual void inserted(const RecordData& recData, const RecordId& newLocation) {
+        invariant(false);
+    }
+    virtual void moved(const RecordData& recData,
+                       const RecordId& oldLocation,
+                       const RecordId& newLocation) {
+        moves.push_back(std::make_pair(oldLocation, newLocation));
+    }
+
+    std::vector<std::pair<RecordId, RecordId>> moves;
+};
+
+/**
+ * Creates three extents: a sparse one, a dense one, and a sparse last extent.
+ */
+void initializeForOnlineCompact(OperationContext* txn,
+                                DummyExtentManager* em,
+                                DummyRecordStoreV1MetaData* md) {
+    LocAndSize recs[] = {{DiskLoc(0, 1000), 100},
+                         {DiskLoc(1, 1000), 1000},
+                         {DiskLoc(1, 2000), 1000},
+                         {DiskLoc(1, 3000), 1000},
+                         {DiskLoc(2, 1000), 100},
+                         {}};
+    LocAndSize drecs[] = {{DiskLoc(0, 1100), 2000}, {DiskLoc(2, 1100), 2900}, {}};
+    initializeV1RS(txn, recs, drecs, NULL, em, md);
+}
+
+TEST(SimpleRecordStoreV1, CompactOnlineEmptiesSparseExtents) {
+    OperationContextNoop txn;
+    DummyExtentManager em;
+    DummyRecordStoreV1MetaData* md = new DummyRecordStoreV1MetaData(false, 0);
+    SimpleRecordStoreV1 rs(&txn, "test.foo", md, &em, false);
+    initializeForOnlineCompact(&txn, &em, md);
+
+    RecordingCompactAdaptor adaptor;
+    CompactOptions options;
+    CompactStats stats;
+    bool done = false;
+    ASSERT_OK(rs.compactOnline(&txn, &adaptor, &options, 1024 * 1024, &stats, &done));
+    ASSERT_TRUE(done);
+
+    // Only the sparse first extent is emptied; the last extent is never a candidate.
+    ASSERT_EQUALS(1, stats.extentsFreed);
+    ASSERT_EQUALS(100, stats.bytesMoved);
+    ASSERT_EQUALS(1U, adaptor.moves.size());
+    ASSERT_EQUALS(DiskLoc(0, 1000).toRecordId(), adaptor.moves[0].first);
+    ASSERT_EQUALS(2, DiskLoc::fromRecordId(adaptor.moves[0].second).a());
+
+    ASSERT_EQUALS(DiskLoc(1, 0), md->firstExtent(&txn));
+    ASSERT_TRUE(em.getExtent(DiskLoc(1, 0))->xprev.isNull());
+
+    // The moved record was carved out of the last extent's free space, and the free space in
+    // the emptied extent is gone from the deleted lists.
+    {
+        LocAndSize recs[] = {{DiskLoc(1, 1000), 1000},
+                             {DiskLoc(1, 2000), 1000},
+                             {DiskLoc(1, 3000), 1000},
+                             {DiskLoc(2, 1000), 100},
+                             {DiskLoc(2, 1100), 128},
+                             {}};
+        LocAndSize drecs[] = {{DiskLoc(2, 1228), 2772}, {}};
+        assertStateV1RS(&txn, recs, drecs, NULL, &em, md);
+    }
+}
+
+TEST(SimpleRecordStoreV1, CompactOnlineHonorsBudget) {
+    OperationContextNoop txn;
+    DummyExtentManager em;
+    DummyRecordStoreV1MetaData* md = new DummyRecordStoreV1MetaData(false, 0);
+    SimpleRecordStoreV1 rs(&txn, "test.foo", md, &em, false);
+    initializeForOnlineCompact(&txn, &em, md);
+
+    RecordingCompactAdaptor adaptor;
+    CompactOptions options;
+    CompactStats stats;
+    bool done = false;
+
+    // Each call measures at most one extent or moves at most one record with this budget.
+    int calls = 0;
+    while (!done) {
+        ASSERT_OK(rs.compactOnline(&txn, &adaptor, &options, 1, &stats, &done));
+        ASSERT_LESS_THAN(++calls, 10);
+    }
+    ASSERT_GREATER_THAN(calls, 2);
+    ASSERT_EQUALS(1, stats.extentsFreed);
+    ASSERT_EQUALS(1U, adaptor.moves.size());
+    ASSERT_EQUALS(DiskLoc(1, 0), md->firstExtent(&txn));
+}
 }
@@ -295,6 +295,10 @@ DummyExtentManager::CacheHint* DummyExtentManager::cacheHint(const DiskLoc& exte
     return new CacheHint();
 }
 
+void DummyExtentManager::readaheadExtent(const DiskLoc& extentLoc) const {
+    readaheadRequests.push_back(extentLoc);
+}
+
 namespace {
 void accumulateExtentSizeRequirements(const LocAndSize* las, std::map<int, size_t>* sizes) {
     if (!las)
@@ -141,6 +141,11 @@ public:
 
     virtual CacheHint* cacheHint(const DiskLoc& extentLoc, const HintType& hint);
 
+    void readaheadExtent(const DiskLoc& extentLoc) const override;
+
+    // Every extent passed to readaheadExtent(), in order.
+    mutable std::vector<DiskLoc> readaheadRequests;
+
 protected:
     struct ExtentInfo {
         char* data;
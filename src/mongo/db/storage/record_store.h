@@ -31,6 +31,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <memory>
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/bson/mutable/damage_vector.h"
@@ -56,6 +57,7 @@ class RecordStore;
 
 struct ValidateResults;
 class ValidateAdaptor;
+class ZoneMapPredicate;
 
 /**
  * Allows inserting a Record "in-place" without creating a copy ahead of time.
@@ -258,6 +260,22 @@ public:
     virtual std::unique_ptr<RecordFetcher> fetcherForId(const RecordId& id) const {
         return {};
     }
+
+    /**
+     * Lets next() skip blocks of records that the RecordStore's zone map, if it keeps one,
+     * proves cannot satisfy 'predicate'. A RecordStore may also use other summaries of its
+     * records, such as the namespaces of the oplog entries in each oplog stone on WiredTiger.
+     * This is only an optimization: callers must still apply their full filter to every record
+     * returned.
+     */
+    virtual void setZoneMapPredicate(std::shared_ptr<const ZoneMapPredicate> predicate) {}
+
+    /**
+     * Asks the cursor to read up to 'amount' units of storage (extents on MMAPv1) ahead of its
+     * position in the background, replacing the storage engine's default. 0 disables readahead.
+     * Engines that do not benefit from readahead ignore this.
+     */
+    virtual void setReadahead(int amount) {}
 };
 
 /**
@@ -304,6 +322,15 @@ public:
         invariant(false);
     }
 
+    /**
+     * Returns true if this RecordStore deletes records on its own and so must be given a
+     * CappedDocumentDeleteCallback. True for capped collections, but a RecordStore that evicts
+     * may need one without being capped.
+     */
+    virtual bool needsCappedDeleteCallback() const {
+        return isCapped();
+    }
+
     /**
      * @param extraInfo - optional more debug info
      * @param level - optional, level of debug info to put in (higher is more)
@@ -366,6 +393,28 @@ public:
                                               const DocWriter* doc,
                                               bool enforceQuota) = 0;
 
+    /**
+     * Inserts the data of every Record in 'records', in order, and sets each Record's id to the
+     * RecordId it was given. Behaves like calling insertRecord() on each in turn, which is what
+     * this default implementation does; RecordStores can override it to share per-insert work
+     * such as cursor setup and metadata updates across the whole batch.
+     *
+     * On error, some of the records may have been inserted; the caller is expected to roll back
+     * its WriteUnitOfWork.
+     */
+    virtual Status insertRecords(OperationContext* txn,
+                                 std::vector<Record>* records,
+                                 bool enforceQuota) {
+        for (auto& record : *records) {
+            StatusWith<RecordId> res =
+                insertRecord(txn, record.data.data(), record.data.size(), enforceQuota);
+            if (!res.isOK())
+                return res.getStatus();
+            record.id = res.getValue();
+        }
+        return Status::OK();
+    }
+
     /**
      * @param notifier - Only used by record stores which do not support doc-locking.
      *                   In the case of a document move, this is called after the document
@@ -498,6 +547,32 @@ public:
         invariant(false);
     }
 
+    /**
+     * Does this RecordStore support the compactOnline operation?
+     */
+    virtual bool compactOnlineSupported() const {
+        return false;
+    }
+
+    /**
+     * Reduces the storage space used by this RecordStore a bounded amount of work at a time,
+     * so that callers can release their locks between calls. Each call does roughly 'maxBytes'
+     * of I/O and sets '*done' once there is nothing left worth compacting. Any progress made is
+     * kept by the RecordStore between calls.
+     *
+     * Every record that moves is reported through adaptor->moved() in the same unit of work.
+     *
+     * Only called if compactOnlineSupported() returns true.
+     */
+    virtual Status compactOnline(OperationContext* txn,
+                                 RecordStoreCompactAdaptor* adaptor,
+                                 const CompactOptions* options,
+                                 long long maxBytes,
+                                 CompactStats* stats,
+                                 bool* done) {
+        invariant(false);
+    }
+
     /**
      * @param full - does more checks
      * @param scanData - scans each document
@@ -575,6 +650,14 @@ public:
     virtual bool isDataValid(const RecordData& recData) = 0;
     virtual size_t dataSize(const RecordData& recData) = 0;
     virtual void inserted(const RecordData& recData, const RecordId& newLocation) = 0;
+
+    /**
+     * Called by compactOnline() after a record has been copied to 'newLocation' and before the
+     * original at 'oldLocation' is deleted.
+     */
+    virtual void moved(const RecordData& recData,
+                       const RecordId& oldLocation,
+                       const RecordId& newLocation) {}
 };
 
 struct ValidateResults {
@@ -0,0 +1,224 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * Benchmarks of the operations of the record store of a storage engine, at several levels of
+ * concurrency. Each benchmark binary links this library with the newHarnessHelper() of its
+ * engine, so that the same benchmarks measure every engine.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/db/operation_context.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/db/storage/record_store_test_harness.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/barrier.h"
+#include "mongo/unittest/benchmark.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace {
+
+using unittest::BenchmarkRegistration;
+using unittest::BenchmarkState;
+
+const std::vector<int> kThreadLevels = {1, 2, 4, 8};
+const int kRecordSize = 100;
+const long long kNumRecords = 10000;
+
+/**
+ * A record store of the engine of the benchmark binary. Its operations run on several threads,
+ * each with its own client and operation context, and are serialized like the collection lock
+ * would on the engines without document level locking.
+ */
+class RecordStoreBenchmark {
+public:
+    typedef stdx::function<void(OperationContext* txn, long long iteration, int thread)> Operation;
+
+    RecordStoreBenchmark()
+        : _harness(newHarnessHelper()),
+          _rs(_harness->newNonCappedRecordStore()),
+          _record(kRecordSize, 'x'),
+          _serialize(!_harness->supportsDocLocking()) {}
+
+    RecordStore* rs() {
+        return _rs.get();
+    }
+
+    const char* record() const {
+        return _record.c_str();
+    }
+
+    RecordId insertRecord(OperationContext* txn) {
+        WriteUnitOfWork wuow(txn);
+        StatusWith<RecordId> result = _rs->insertRecord(txn, record(), kRecordSize, false);
+        invariantOK(result.getStatus());
+        wuow.commit();
+        return result.getValue();
+    }
+
+    /**
+     * Inserts 'count' records before the timed operations, returning their ids.
+     */
+    std::vector<RecordId> insertRecords(long long count) {
+        auto txn = _harness->newOperationContext();
+        std::vector<RecordId> ids;
+        ids.reserve(count);
+        for (long long i = 0; i < count; i++) {
+            ids.push_back(insertRecord(txn.get()));
+        }
+        return ids;
+    }
+
+    /**
+     * Times state.iterations() calls of 'op', shared between state.threads() threads. Each thread
+     * then calls 'threadDone', if set, while its operation context still exists.
+     */
+    void run(BenchmarkState& state,
+             const Operation& op,
+             const stdx::function<void(int thread)>& threadDone = nullptr) {
+        const int threads = state.threads();
+        unittest::Barrier started(threads + 1);
+        unittest::Barrier finished(threads + 1);
+        AtomicInt64 nextIteration(0);
+
+        std::vector<stdx::thread> workers;
+        for (int thread = 0; thread < threads; thread++) {
+            workers.emplace_back([&, thread] {
+                auto client = _harness->serviceContext()->makeClient(str::stream() << "bm"
+                                                                                   << thread);
+                auto txn = _harness->newOperationContext(client.get());
+                started.countDownAndWait();
+                for (long long i; (i = nextIteration.fetchAndAdd(1)) < state.iterations();) {
+                    if (_serialize) {
+                        stdx::lock_guard<stdx::mutex> lk(_mutex);
+                        op(txn.get(), i, thread);
+                    } else {
+                        op(txn.get(), i, thread);
+                    }
+                }
+                finished.countDownAndWait();
+                if (threadDone) {
+                    threadDone(thread);
+                }
+            });
+        }
+
+        started.countDownAndWait();
+        state.resumeTiming();
+        finished.countDownAndWait();
+        state.pauseTiming();
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+private:
+    std::unique_ptr<HarnessHelper> _harness;
+    std::unique_ptr<RecordStore> _rs;
+    const std::string _record;
+    const bool _serialize;
+    stdx::mutex _mutex;
+};
+
+void insertBenchmark(BenchmarkState& state) {
+    RecordStoreBenchmark bm;
+    bm.run(state, [&](OperationContext* txn, long long, int) { bm.insertRecord(txn); });
+}
+
+/**
+ * Each thread updates its own records, so that the threads don't conflict.
+ */
+void updateBenchmark(BenchmarkState& state) {
+    RecordStoreBenchmark bm;
+    std::vector<RecordId> ids = bm.insertRecords(kNumRecords);
+    const long long perThread = kNumRecords / state.threads();
+    bm.run(state, [&](OperationContext* txn, long long iteration, int thread) {
+        const RecordId& id = ids[thread + state.threads() * (iteration % perThread)];
+        WriteUnitOfWork wuow(txn);
+        invariantOK(bm.rs()->updateRecord(txn, id, bm.record(), kRecordSize, false, nullptr)
+                        .getStatus());
+        wuow.commit();
+    });
+}
+
+void deleteBenchmark(BenchmarkState& state) {
+    RecordStoreBenchmark bm;
+    std::vector<RecordId> ids = bm.insertRecords(state.iterations());
+    bm.run(state, [&](OperationContext* txn, long long iteration, int) {
+        WriteUnitOfWork wuow(txn);
+        bm.rs()->deleteRecord(txn, ids[iteration]);
+        wuow.commit();
+    });
+}
+
+void findRecordBenchmark(BenchmarkState& state) {
+    RecordStoreBenchmark bm;
+    std::vector<RecordId> ids = bm.insertRecords(kNumRecords);
+    bm.run(state, [&](OperationContext* txn, long long iteration, int) {
+        RecordData data;
+        invariant(bm.rs()->findRecord(txn, ids[iteration % kNumRecords], &data));
+    });
+}
+
+/**
+ * Each thread scans the records with its own cursor, starting over at the end of the store, and
+ * destroys it before its operation context.
+ */
+void scanBenchmark(BenchmarkState& state) {
+    RecordStoreBenchmark bm;
+    bm.insertRecords(kNumRecords);
+    std::vector<std::unique_ptr<SeekableRecordCursor>> cursors(state.threads());
+    bm.run(state, [&](OperationContext* txn, long long, int thread) {
+        auto& cursor = cursors[thread];
+        if (!cursor || !cursor->next()) {
+            cursor = bm.rs()->getCursor(txn);
+            invariant(cursor->next());
+        }
+    }, [&](int thread) { cursors[thread].reset(); });
+}
+
+const BenchmarkRegistration insertRegistration("RecordStoreInsert", insertBenchmark, kThreadLevels);
+const BenchmarkRegistration updateRegistration("RecordStoreUpdate", updateBenchmark, kThreadLevels);
+const BenchmarkRegistration deleteRegistration("RecordStoreDelete", deleteBenchmark, kThreadLevels);
+const BenchmarkRegistration findRecordRegistration("RecordStoreFindRecord",
+                                                   findRecordBenchmark,
+                                                   kThreadLevels);
+const BenchmarkRegistration scanRegistration("RecordStoreScan", scanBenchmark, kThreadLevels);
+
+}  // namespace
+}  // namespace mongo
@@ -30,6 +30,8 @@
 
 #include "mongo/db/storage/record_store_test_harness.h"
 
+#include <set>
+#include <vector>
 
 #include "mongo/db/record_id.h"
 #include "mongo/db/storage/record_data.h"
@@ -109,6 +111,46 @@ TEST(RecordStoreTestHarness, InsertMultipleRecords) {
     }
 }
 
+// Insert a batch of records with insertRecords() and verify that each was given its own
+// RecordId and can be read back.
+TEST(RecordStoreTestHarness, InsertRecordsBatch) {
+    unique_ptr<HarnessHelper> harnessHelper(newHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    const int nToInsert = 10;
+    std::vector<string> datas;
+    for (int i = 0; i < nToInsert; i++) {
+        stringstream ss;
+        ss << "record " << i;
+        datas.push_back(ss.str());
+    }
+
+    std::vector<Record> records;
+    for (int i = 0; i < nToInsert; i++) {
+        records.push_back(Record{RecordId(), RecordData(datas[i].c_str(), datas[i].size() + 1)});
+    }
+
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        {
+            WriteUnitOfWork uow(opCtx.get());
+            ASSERT_OK(rs->insertRecords(opCtx.get(), &records, false));
+            uow.commit();
+        }
+    }
+
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        ASSERT_EQUALS(nToInsert, rs->numRecords(opCtx.get()));
+
+        std::set<RecordId> ids;
+        for (int i = 0; i < nToInsert; i++) {
+            ASSERT_TRUE(ids.insert(records[i].id).second);
+            ASSERT_EQUALS(datas[i], rs->dataFor(opCtx.get(), records[i].id).data());
+        }
+    }
+}
+
 // Insert a record using a DocWriter and verify the number of entries
 // in the collection is 1.
 TEST(RecordStoreTestHarness, InsertRecordUsingDocWriter) {
@@ -111,4 +111,42 @@ TEST(RecordStoreTestHarness, GetManyIteratorsNonEmpty) {
     }
 }
 
+// Iterating all of the cursors over a larger record store, which engines may split into
+// several ranges, returns every record exactly once.
+TEST(RecordStoreTestHarness, GetManyIteratorsCoverEveryRecordOnce) {
+    unique_ptr<HarnessHelper> harnessHelper(newHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    const int nToInsert = 5000;
+    set<RecordId> remain;
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        WriteUnitOfWork uow(opCtx.get());
+        for (int i = 0; i < nToInsert; i++) {
+            stringstream ss;
+            ss << "record " << i;
+            string data = ss.str();
+
+            StatusWith<RecordId> res =
+                rs->insertRecord(opCtx.get(), data.c_str(), data.size() + 1, false);
+            ASSERT_OK(res.getStatus());
+            remain.insert(res.getValue());
+        }
+        uow.commit();
+    }
+    ASSERT_EQUALS(size_t(nToInsert), remain.size());
+
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        for (auto&& cursor : rs->getManyCursors(opCtx.get())) {
+            while (auto record = cursor->next()) {
+                ASSERT_EQ(remain.erase(record->id), size_t(1));
+            }
+
+            ASSERT(!cursor->next());
+        }
+        ASSERT(remain.empty());
+    }
+}
+
 }  // namespace mongo
@@ -0,0 +1,302 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/record_zone_map.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+namespace {
+
+const int64_t kMinRecordsPerBlock = 16;
+const int64_t kMaxRecordsPerBlock = 1 << 20;
+const size_t kMaxFields = 32;
+
+const char* opName(ZoneMapPredicate::Op op) {
+    switch (op) {
+        case ZoneMapPredicate::Op::kEQ:
+            return "$eq";
+        case ZoneMapPredicate::Op::kLT:
+            return "$lt";
+        case ZoneMapPredicate::Op::kLTE:
+            return "$lte";
+        case ZoneMapPredicate::Op::kGT:
+            return "$gt";
+        case ZoneMapPredicate::Op::kGTE:
+            return "$gte";
+    }
+    MONGO_UNREACHABLE;
+}
+}  // namespace
+
+bool ZoneMapPredicate::canUseValue(const BSONElement& value) {
+    switch (value.type()) {
+        case NumberDouble:
+            // NaN only compares equal to NaN, which does not fit a min/max range.
+            return !std::isnan(value.Double());
+        case NumberInt:
+        case NumberLong:
+        case String:
+        case jstOID:
+        case Bool:
+        case Date:
+        case bsonTimestamp:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void ZoneMapPredicate::addComparison(StringData field, Op op, const BSONElement& value) {
+    invariant(canUseValue(value));
+    invariant(field.find('.') == std::string::npos);
+
+    Comparison comparison;
+    comparison.field = field.toString();
+    comparison.op = op;
+    comparison.holder = value.wrap("");
+    comparison.value = comparison.holder.firstElement();
+    _comparisons.push_back(std::move(comparison));
+}
+
+std::string ZoneMapPredicate::toString() const {
+    str::stream ss;
+    for (size_t i = 0; i < _comparisons.size(); i++) {
+        if (i > 0)
+            ss << ", ";
+        ss << _comparisons[i].field << ' ' << opName(_comparisons[i].op) << ' '
+           << _comparisons[i].value.toString(false);
+    }
+    return ss;
+}
+
+RecordZoneMap::RecordZoneMap(std::vector<std::string> fields, int64_t recordsPerBlock)
+    : _fields(std::move(fields)), _recordsPerBlock(recordsPerBlock) {
+    invariant(!_fields.empty());
+    invariant(_recordsPerBlock >= kMinRecordsPerBlock);
+}
+
+StatusWith<std::unique_ptr<RecordZoneMap>> RecordZoneMap::parse(const BSONElement& spec) {
+    if (spec.type() != Object) {
+        return {ErrorCodes::TypeMismatch, "'zoneMap' must be an object"};
+    }
+
+    std::vector<std::string> fields;
+    int64_t recordsPerBlock = kDefaultRecordsPerBlock;
+    BSONForEach(elem, spec.Obj()) {
+        const StringData name = elem.fieldNameStringData();
+        if (name == "fields") {
+            if (elem.type() != Array) {
+                return {ErrorCodes::TypeMismatch, "'zoneMap.fields' must be an array"};
+            }
+            BSONForEach(fieldElem, elem.Obj()) {
+                if (fieldElem.type() != String) {
+                    return {ErrorCodes::TypeMismatch,
+                            "'zoneMap.fields' must only contain strings"};
+                }
+                const std::string field = fieldElem.String();
+                if (field.empty() || field[0] == '$' || field.find('.') != std::string::npos) {
+                    return {ErrorCodes::BadValue,
+                            str::stream() << "'" << field << "' in 'zoneMap.fields' must be a "
+                                          << "top-level field name"};
+                }
+                if (std::find(fields.begin(), fields.end(), field) != fields.end()) {
+                    return {ErrorCodes::BadValue,
+                            str::stream() << "'" << field << "' appears twice in 'zoneMap.fields'"};
+                }
+                fields.push_back(field);
+            }
+        } else if (name == "recordsPerBlock") {
+            if (!elem.isNumber()) {
+                return {ErrorCodes::TypeMismatch, "'zoneMap.recordsPerBlock' must be a number"};
+            }
+            recordsPerBlock = elem.safeNumberLong();
+            if (recordsPerBlock < kMinRecordsPerBlock || recordsPerBlock > kMaxRecordsPerBlock) {
+                return {ErrorCodes::BadValue,
+                        str::stream() << "'zoneMap.recordsPerBlock' must be between "
+                                      << kMinRecordsPerBlock << " and " << kMaxRecordsPerBlock};
+            }
+        } else {
+            return {ErrorCodes::InvalidOptions,
+                    str::stream() << "'zoneMap." << name << "' is not a supported option."};
+        }
+    }
+
+    if (fields.empty()) {
+        return {ErrorCodes::BadValue, "'zoneMap.fields' must list at least one field"};
+    }
+    if (fields.size() > kMaxFields) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "'zoneMap.fields' may list at most " << kMaxFields
+                              << " fields"};
+    }
+
+    return {stdx::make_unique<RecordZoneMap>(std::move(fields), recordsPerBlock)};
+}
+
+void RecordZoneMap::noteRecord(const RecordId& id, const BSONObj& doc) {
+    const int64_t blockNum = _blockFor(id);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    Block& block = _blocks[blockNum];
+    if (block.empty())
+        block.resize(_fields.size());
+
+    for (size_t i = 0; i < _fields.size(); i++) {
+        const BSONElement elem = doc[_fields[i]];
+        if (elem.eoo())
+            continue;
+
+        if (elem.type() == Array) {
+            // A comparison matches an array if it matches any of its elements.
+            BSONForEach(arrayElem, elem.Obj()) {
+                _widen(&block[i], arrayElem);
+            }
+        } else {
+            _widen(&block[i], elem);
+        }
+    }
+}
+
+bool RecordZoneMap::blockMayMatch(const RecordId& id, const ZoneMapPredicate& predicate) const {
+    const int64_t blockNum = _blockFor(id);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _blocks.find(blockNum);
+    if (it == _blocks.end()) {
+        // Records are noted before they are written, so this one was written before the zone
+        // map was built. That cannot happen, but be conservative.
+        return true;
+    }
+    return _blockMayMatch_inlock(it->second, predicate);
+}
+
+RecordId RecordZoneMap::nextCandidate(const RecordId& id,
+                                      const ZoneMapPredicate& predicate,
+                                      bool forward) const {
+    const int64_t blockNum = _blockFor(id);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (forward) {
+        for (auto it = _blocks.upper_bound(blockNum); it != _blocks.end(); ++it) {
+            if (_blockMayMatch_inlock(it->second, predicate))
+                return RecordId(it->first * _recordsPerBlock);
+        }
+    } else {
+        auto it = _blocks.lower_bound(blockNum);
+        while (it != _blocks.begin()) {
+            --it;
+            if (_blockMayMatch_inlock(it->second, predicate))
+                return RecordId(it->first * _recordsPerBlock + _recordsPerBlock - 1);
+        }
+    }
+    return RecordId();
+}
+
+void RecordZoneMap::appendStats(BSONObjBuilder* builder) const {
+    size_t numBlocks;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        numBlocks = _blocks.size();
+    }
+    builder->append("fields", _fields);
+    builder->appendNumber("recordsPerBlock", static_cast<long long>(_recordsPerBlock));
+    builder->appendNumber("blocks", static_cast<long long>(numBlocks));
+    builder->appendNumber("blocksSkipped", static_cast<long long>(_blocksSkipped.load()));
+}
+
+void RecordZoneMap::_widen(Bounds* bounds, const BSONElement& elem) {
+    if (bounds->min.isEmpty()) {
+        bounds->min = elem.wrap("");
+        bounds->max = bounds->min;
+        return;
+    }
+    if (elem.woCompare(bounds->min.firstElement(), false) < 0)
+        bounds->min = elem.wrap("");
+    if (elem.woCompare(bounds->max.firstElement(), false) > 0)
+        bounds->max = elem.wrap("");
+}
+
+int64_t RecordZoneMap::_blockFor(const RecordId& id) const {
+    const int64_t repr = id.repr();
+    // Round toward negative infinity so that each block covers a contiguous range of ids.
+    return repr >= 0 ? repr / _recordsPerBlock : (repr + 1) / _recordsPerBlock - 1;
+}
+
+bool RecordZoneMap::_blockMayMatch_inlock(const Block& block,
+                                          const ZoneMapPredicate& predicate) const {
+    for (const auto& comparison : predicate.getComparisons()) {
+        auto field = std::find(_fields.begin(), _fields.end(), comparison.field);
+        if (field == _fields.end())
+            continue;
+
+        const Bounds& bounds = block[field - _fields.begin()];
+        if (bounds.min.isEmpty()) {
+            // No record in this block has the field, and missing fields never match the types
+            // of value that ZoneMapPredicate accepts.
+            return false;
+        }
+
+        // Comparisons only match values of the same canonical type as 'value', and within a
+        // type BSON order agrees with the comparison, so the type-spanning min/max rule out
+        // values conservatively.
+        const int minCmp = bounds.min.firstElement().woCompare(comparison.value, false);
+        const int maxCmp = bounds.max.firstElement().woCompare(comparison.value, false);
+        bool mayMatch = true;
+        switch (comparison.op) {
+            case ZoneMapPredicate::Op::kEQ:
+                mayMatch = minCmp <= 0 && maxCmp >= 0;
+                break;
+            case ZoneMapPredicate::Op::kLT:
+                mayMatch = minCmp < 0;
+                break;
+            case ZoneMapPredicate::Op::kLTE:
+                mayMatch = minCmp <= 0;
+                break;
+            case ZoneMapPredicate::Op::kGT:
+                mayMatch = maxCmp > 0;
+                break;
+            case ZoneMapPredicate::Op::kGTE:
+                mayMatch = maxCmp >= 0;
+                break;
+        }
+        if (!mayMatch)
+            return false;
+    }
+    return true;
+}
+
+}  // namespace mongo
@@ -0,0 +1,168 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status_with.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/record_id.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+/**
+ * A conjunction of comparisons against top-level fields, extracted by the query planner from a
+ * collection scan's filter. A RecordZoneMap uses it to rule out whole blocks of records. It is
+ * only ever a necessary condition: records in blocks that are not ruled out must still be
+ * matched against the full filter.
+ */
+class ZoneMapPredicate {
+public:
+    enum class Op { kEQ, kLT, kLTE, kGT, kGTE };
+
+    struct Comparison {
+        std::string field;
+        Op op;
+        BSONObj holder;  // Owns 'value'.
+        BSONElement value;
+    };
+
+    /**
+     * Returns true if a comparison against 'value' can be evaluated with min/max bounds. Only
+     * scalar types whose matching values all share one canonical type qualify.
+     */
+    static bool canUseValue(const BSONElement& value);
+
+    /**
+     * Adds a comparison that every matching document must satisfy. 'field' must not be a dotted
+     * path and 'value' must pass canUseValue().
+     */
+    void addComparison(StringData field, Op op, const BSONElement& value);
+
+    bool isEmpty() const {
+        return _comparisons.empty();
+    }
+
+    const std::vector<Comparison>& getComparisons() const {
+        return _comparisons;
+    }
+
+    std::string toString() const;
+
+private:
+    std::vector<Comparison> _comparisons;
+};
+
+/**
+ * Keeps, for each block of 'recordsPerBlock' consecutive RecordIds, the minimum and maximum
+ * value of a fixed set of top-level fields. Values in arrays count individually.
+ *
+ * Blocks only ever widen: deletes and the old versions of updated documents are never removed,
+ * so the bounds stay correct, if loose, without any bookkeeping on rollback. A block with no
+ * entry holds no records, as every record is noted before it is written.
+ *
+ * All methods are thread-safe.
+ */
+class RecordZoneMap {
+    MONGO_DISALLOW_COPYING(RecordZoneMap);
+
+public:
+    static const int64_t kDefaultRecordsPerBlock = 1024;
+
+    RecordZoneMap(std::vector<std::string> fields, int64_t recordsPerBlock);
+
+    /**
+     * Parses the 'zoneMap' collection storage option, which has the form
+     * {fields: [<field>, ...], recordsPerBlock: <int>}.
+     */
+    static StatusWith<std::unique_ptr<RecordZoneMap>> parse(const BSONElement& spec);
+
+    /**
+     * Widens the bounds of the block holding 'id' to cover 'doc'.
+     */
+    void noteRecord(const RecordId& id, const BSONObj& doc);
+
+    /**
+     * Returns true if some record in the block holding 'id' might satisfy 'predicate'.
+     */
+    bool blockMayMatch(const RecordId& id, const ZoneMapPredicate& predicate) const;
+
+    /**
+     * Returns the position to resume a scan from after ruling out the block holding 'id': the
+     * first RecordId of the next block after it (before it, when scanning backward, in which
+     * case the last RecordId of that block) that might satisfy 'predicate'. Returns a null
+     * RecordId if there is no such block.
+     */
+    RecordId nextCandidate(const RecordId& id,
+                           const ZoneMapPredicate& predicate,
+                           bool forward) const;
+
+    /**
+     * Records that a scan skipped 'numBlocks' blocks of records.
+     */
+    void noteBlocksSkipped(int64_t numBlocks) {
+        _blocksSkipped.fetchAndAdd(numBlocks);
+    }
+
+    void appendStats(BSONObjBuilder* builder) const;
+
+private:
+    struct Bounds {
+        BSONObj min;  // Empty if the field has not been seen in this block.
+        BSONObj max;
+    };
+
+    using Block = std::vector<Bounds>;  // One entry per field.
+    using BlockMap = std::map<int64_t, Block>;
+
+    static void _widen(Bounds* bounds, const BSONElement& elem);
+
+    int64_t _blockFor(const RecordId& id) const;
+
+    bool _blockMayMatch_inlock(const Block& block, const ZoneMapPredicate& predicate) const;
+
+    const std::vector<std::string> _fields;
+    const int64_t _recordsPerBlock;
+
+    mutable stdx::mutex _mutex;
+    BlockMap _blocks;
+
+    AtomicInt64 _blocksSkipped;
+};
+
+}  // namespace mongo
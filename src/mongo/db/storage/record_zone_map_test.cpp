@@ -0,0 +1,153 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/record_zone_map.h"
+
+#include <limits>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+// Two blocks of 16 records: ids 16 to 31 have 'x' from 0 to 15 and ids 32 to 47 have 'x' from
+// 100 to 115.
+std::unique_ptr<RecordZoneMap> makeZoneMap() {
+    auto zoneMap = RecordZoneMap::parse(fromjson("{zoneMap: {fields: ['x'], recordsPerBlock: 16}}")
+                                            .firstElement());
+    ASSERT_OK(zoneMap.getStatus());
+    for (int i = 0; i < 16; i++) {
+        zoneMap.getValue()->noteRecord(RecordId(16 + i), BSON("x" << i));
+        zoneMap.getValue()->noteRecord(RecordId(32 + i), BSON("x" << 100 + i));
+    }
+    return std::move(zoneMap.getValue());
+}
+
+ZoneMapPredicate makePredicate(ZoneMapPredicate::Op op, const BSONObj& value) {
+    ZoneMapPredicate predicate;
+    predicate.addComparison("x", op, value.firstElement());
+    return predicate;
+}
+
+TEST(RecordZoneMapTest, ParseRejectsBadSpecs) {
+    ASSERT_EQ(ErrorCodes::TypeMismatch,
+              RecordZoneMap::parse(fromjson("{zoneMap: 1}").firstElement()).getStatus());
+    ASSERT_EQ(ErrorCodes::BadValue,
+              RecordZoneMap::parse(fromjson("{zoneMap: {fields: []}}").firstElement()).getStatus());
+    ASSERT_EQ(ErrorCodes::BadValue,
+              RecordZoneMap::parse(fromjson("{zoneMap: {fields: ['a.b']}}").firstElement())
+                  .getStatus());
+    ASSERT_EQ(ErrorCodes::BadValue,
+              RecordZoneMap::parse(fromjson("{zoneMap: {fields: ['a', 'a']}}").firstElement())
+                  .getStatus());
+    ASSERT_EQ(ErrorCodes::BadValue,
+              RecordZoneMap::parse(
+                  fromjson("{zoneMap: {fields: ['a'], recordsPerBlock: 1}}").firstElement())
+                  .getStatus());
+    ASSERT_EQ(ErrorCodes::InvalidOptions,
+              RecordZoneMap::parse(fromjson("{zoneMap: {fields: ['a'], x: 1}}").firstElement())
+                  .getStatus());
+}
+
+TEST(RecordZoneMapTest, RangeComparisons) {
+    auto zoneMap = makeZoneMap();
+    const RecordId low(20);
+    const RecordId high(40);
+
+    auto gt = makePredicate(ZoneMapPredicate::Op::kGT, BSON("" << 15));
+    ASSERT_FALSE(zoneMap->blockMayMatch(low, gt));
+    ASSERT_TRUE(zoneMap->blockMayMatch(high, gt));
+
+    auto gte = makePredicate(ZoneMapPredicate::Op::kGTE, BSON("" << 15));
+    ASSERT_TRUE(zoneMap->blockMayMatch(low, gte));
+
+    auto lt = makePredicate(ZoneMapPredicate::Op::kLT, BSON("" << 100.0));
+    ASSERT_TRUE(zoneMap->blockMayMatch(low, lt));
+    ASSERT_FALSE(zoneMap->blockMayMatch(high, lt));
+
+    auto lte = makePredicate(ZoneMapPredicate::Op::kLTE, BSON("" << 100LL));
+    ASSERT_TRUE(zoneMap->blockMayMatch(high, lte));
+
+    auto eq = makePredicate(ZoneMapPredicate::Op::kEQ, BSON("" << 50));
+    ASSERT_FALSE(zoneMap->blockMayMatch(low, eq));
+    ASSERT_FALSE(zoneMap->blockMayMatch(high, eq));
+}
+
+TEST(RecordZoneMapTest, ArrayElementsAndMissingFields) {
+    auto zoneMap = RecordZoneMap::parse(fromjson("{zoneMap: {fields: ['x', 'y']}}").firstElement());
+    ASSERT_OK(zoneMap.getStatus());
+    zoneMap.getValue()->noteRecord(RecordId(1), fromjson("{x: [1, 500]}"));
+
+    auto eq = makePredicate(ZoneMapPredicate::Op::kEQ, BSON("" << 500));
+    ASSERT_TRUE(zoneMap.getValue()->blockMayMatch(RecordId(1), eq));
+
+    // No record in the block has 'y'.
+    ZoneMapPredicate onY;
+    onY.addComparison("y", ZoneMapPredicate::Op::kGT, BSON("" << 0).firstElement());
+    ASSERT_FALSE(zoneMap.getValue()->blockMayMatch(RecordId(1), onY));
+
+    // Fields the zone map does not track never rule anything out.
+    ZoneMapPredicate onZ;
+    onZ.addComparison("z", ZoneMapPredicate::Op::kGT, BSON("" << 0).firstElement());
+    ASSERT_TRUE(zoneMap.getValue()->blockMayMatch(RecordId(1), onZ));
+}
+
+TEST(RecordZoneMapTest, OtherTypesNeverMatchNumberRange) {
+    auto zoneMap = makeZoneMap();
+    auto onString = makePredicate(ZoneMapPredicate::Op::kGTE, BSON("" << "a"));
+    ASSERT_FALSE(zoneMap->blockMayMatch(RecordId(20), onString));
+}
+
+TEST(RecordZoneMapTest, NextCandidate) {
+    auto zoneMap = makeZoneMap();
+
+    auto high = makePredicate(ZoneMapPredicate::Op::kGTE, BSON("" << 100));
+    ASSERT_EQ(RecordId(32), zoneMap->nextCandidate(RecordId(16), high, true));
+    ASSERT_EQ(RecordId(), zoneMap->nextCandidate(RecordId(40), high, true));
+
+    auto low = makePredicate(ZoneMapPredicate::Op::kLT, BSON("" << 10));
+    ASSERT_EQ(RecordId(31), zoneMap->nextCandidate(RecordId(40), low, false));
+    ASSERT_EQ(RecordId(), zoneMap->nextCandidate(RecordId(16), low, false));
+}
+
+TEST(RecordZoneMapTest, CanUseValue) {
+    ASSERT_TRUE(ZoneMapPredicate::canUseValue(BSON("" << 1).firstElement()));
+    ASSERT_TRUE(ZoneMapPredicate::canUseValue(BSON("" << Date_t()).firstElement()));
+    ASSERT_FALSE(ZoneMapPredicate::canUseValue(BSON("" << BSONNULL).firstElement()));
+    ASSERT_FALSE(ZoneMapPredicate::canUseValue(BSON("" << BSON_ARRAY(1)).firstElement()));
+    ASSERT_FALSE(
+        ZoneMapPredicate::canUseValue(BSON("" << std::numeric_limits<double>::quiet_NaN())
+                                          .firstElement()));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -36,6 +36,7 @@
 #include "mongo/base/status.h"
 #include "mongo/db/storage/snapshot.h"
 #include "mongo/db/storage/snapshot_name.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -54,6 +55,13 @@ public:
 
     virtual void reportState(BSONObjBuilder* b) const {}
 
+    /**
+     * Appends statistics about where the storage engine spent time on behalf of the operation
+     * that owns this recovery unit, for the slow query log and the profiler. Appends nothing by
+     * default.
+     */
+    virtual void appendOperationStats(BSONObjBuilder* b) const {}
+
     /**
      * These should be called through WriteUnitOfWork rather than directly.
      *
@@ -114,6 +122,47 @@ public:
         return false;
     }
 
+    /**
+     * Tells the recovery unit that reads may be served from a view of the data that is at most
+     * 'maxStaleness' old, which lets storage engines share one snapshot among many readers.
+     * Must only be used by operations that do not write.
+     *
+     * StorageEngines that cannot share snapshots should use the default implementation.
+     */
+    virtual Status setReadFromStaleSnapshot(Milliseconds maxStaleness) {
+        return {ErrorCodes::CommandNotSupported,
+                "Current storage engine does not support reading from stale snapshots"};
+    }
+
+    /**
+     * Tells the recovery unit to read from the most recently created named snapshot rather than
+     * from the latest data. On a secondary, named snapshots are only created between oplog
+     * batches, so such reads never observe a partially applied batch. Must only be used by
+     * operations that do not write.
+     *
+     * Fails, leaving the recovery unit unchanged, if there is no named snapshot or the newest one
+     * is older than 'minSnapshot'.
+     *
+     * StorageEngines that don't support a SnapshotManager should use the default
+     * implementation.
+     */
+    virtual Status setReadFromLastAppliedSnapshot(
+        const boost::optional<SnapshotName>& minSnapshot) {
+        return {ErrorCodes::CommandNotSupported,
+                "Current storage engine does not support reading from the last applied snapshot"};
+    }
+
+    /**
+     * Returns the SnapshotName being used by this recovery unit or boost::none if
+     * setReadFromLastAppliedSnapshot() has not been called.
+     *
+     * As with getMajorityCommittedSnapshot(), reads may occur from later snapshots, but not from
+     * earlier ones.
+     */
+    virtual boost::optional<SnapshotName> getLastAppliedSnapshot() const {
+        return {};
+    }
+
     /**
      * Returns the SnapshotName being used by this recovery unit or boost::none if not reading from
      * a majority committed snapshot.
@@ -99,6 +99,31 @@ public:
                           const RecordId& loc,
                           bool dupsAllowed) = 0;
 
+    /**
+     * Insert the 'nEntries' entries starting at 'entries', which must be sorted in the order of
+     * 'this' index. This is equivalent to calling insert() on each entry in turn, but lets an
+     * implementation reuse its position in the index from one entry to the next.
+     *
+     * Stops at the first entry that fails to insert. '*numInsertedOut' is set to the number of
+     * leading entries that were inserted, so on error entries[*numInsertedOut] is the entry
+     * whose insert() failed and the caller may resume after it.
+     */
+    virtual Status insertBatch(OperationContext* txn,
+                               const IndexKeyEntry* entries,
+                               size_t nEntries,
+                               bool dupsAllowed,
+                               size_t* numInsertedOut) {
+        for (size_t i = 0; i < nEntries; i++) {
+            Status status = insert(txn, entries[i].key, entries[i].loc, dupsAllowed);
+            if (!status.isOK()) {
+                *numInsertedOut = i;
+                return status;
+            }
+        }
+        *numInsertedOut = nEntries;
+        return Status::OK();
+    }
+
     /**
      * Remove the entry from the index with the specified key and RecordId.
      *
@@ -111,6 +136,19 @@ public:
                          const RecordId& loc,
                          bool dupsAllowed) = 0;
 
+    /**
+     * Remove the 'nEntries' entries starting at 'entries', which must be sorted in the order of
+     * 'this' index. This is equivalent to calling unindex() on each entry in turn.
+     */
+    virtual void unindexBatch(OperationContext* txn,
+                              const IndexKeyEntry* entries,
+                              size_t nEntries,
+                              bool dupsAllowed) {
+        for (size_t i = 0; i < nEntries; i++) {
+            unindex(txn, entries[i].key, entries[i].loc, dupsAllowed);
+        }
+    }
+
     /**
      * Return ErrorCodes::DuplicateKey if 'key' already exists in 'this'
      * index at a RecordId other than 'loc', and Status::OK() otherwise.
@@ -180,6 +218,22 @@ public:
         return x;
     }
 
+    /**
+     * Return the number of entries whose keys lie between 'startKey' and 'endKey', with the
+     * bounds interpreted as by a forward cursor's seek() and setEndPosition(). An empty
+     * 'endKey' means the end of the index.
+     *
+     * Implementations that keep order statistics can answer this without visiting the entries.
+     * The default returns boost::none, meaning the caller must count by scanning.
+     */
+    virtual boost::optional<long long> countRange(OperationContext* txn,
+                                                  const BSONObj& startKey,
+                                                  bool startInclusive,
+                                                  const BSONObj& endKey,
+                                                  bool endInclusive) const {
+        return boost::none;
+    }
+
     /**
      * Navigates over the sorted data.
      *
@@ -31,6 +31,7 @@
 #include "mongo/db/storage/sorted_data_interface_test_harness.h"
 
 #include <memory>
+#include <vector>
 
 #include "mongo/db/storage/sorted_data_interface.h"
 #include "mongo/unittest/unittest.h"
@@ -360,4 +361,83 @@ TEST(SortedDataInterface, InsertMultipleCompoundKeys) {
     }
 }
 
+// Insert a sorted batch of keys that interleave with keys already in the index, and verify
+// that a cursor returns all of them in order.
+TEST(SortedDataInterface, InsertBatch) {
+    const std::unique_ptr<HarnessHelper> harnessHelper(newHarnessHelper());
+    const std::unique_ptr<SortedDataInterface> sorted(harnessHelper->newSortedDataInterface(false));
+
+    int nToInsert = 2000;
+    {
+        const std::unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        WriteUnitOfWork uow(opCtx.get());
+        for (int i = 0; i < nToInsert; i += 2) {
+            ASSERT_OK(sorted->insert(opCtx.get(), BSON("" << i), RecordId(42, i * 2), true));
+        }
+        uow.commit();
+    }
+
+    {
+        std::vector<IndexKeyEntry> entries;
+        for (int i = 1; i < nToInsert; i += 2) {
+            entries.push_back(IndexKeyEntry(BSON("" << i), RecordId(42, i * 2)));
+        }
+
+        const std::unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        WriteUnitOfWork uow(opCtx.get());
+        size_t numInserted;
+        ASSERT_OK(
+            sorted->insertBatch(opCtx.get(), &entries[0], entries.size(), true, &numInserted));
+        ASSERT_EQUALS(entries.size(), numInserted);
+        uow.commit();
+    }
+
+    {
+        const std::unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        ASSERT_EQUALS(nToInsert, sorted->numEntries(opCtx.get()));
+
+        const std::unique_ptr<SortedDataInterface::Cursor> cursor(sorted->newCursor(opCtx.get()));
+        for (int i = 0; i < nToInsert; i++) {
+            auto entry = i == 0 ? cursor->seek(minKey, true) : cursor->next();
+            ASSERT_EQ(entry, IndexKeyEntry(BSON("" << i), RecordId(42, i * 2)));
+        }
+        ASSERT(!cursor->next());
+    }
+}
+
+// Insert a batch into a unique index where one key already exists at a different RecordId,
+// and verify that the batch stops at that key and reports how many entries were inserted.
+TEST(SortedDataInterface, InsertBatchStopsAtDuplicateKey) {
+    const std::unique_ptr<HarnessHelper> harnessHelper(newHarnessHelper());
+    const std::unique_ptr<SortedDataInterface> sorted(harnessHelper->newSortedDataInterface(true));
+
+    {
+        const std::unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        WriteUnitOfWork uow(opCtx.get());
+        ASSERT_OK(sorted->insert(opCtx.get(), key2, loc1, false));
+        uow.commit();
+    }
+
+    {
+        std::vector<IndexKeyEntry> entries;
+        entries.push_back(IndexKeyEntry(key1, loc2));
+        entries.push_back(IndexKeyEntry(key2, loc2));
+        entries.push_back(IndexKeyEntry(key3, loc2));
+
+        const std::unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        WriteUnitOfWork uow(opCtx.get());
+        size_t numInserted;
+        ASSERT_EQUALS(
+            ErrorCodes::DuplicateKey,
+            sorted->insertBatch(opCtx.get(), &entries[0], entries.size(), false, &numInserted));
+        ASSERT_EQUALS(1U, numInserted);
+        uow.commit();
+    }
+
+    {
+        const std::unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        ASSERT_EQUALS(2, sorted->numEntries(opCtx.get()));
+    }
+}
+
 }  // namespace mongo
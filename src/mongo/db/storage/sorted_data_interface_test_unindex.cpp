@@ -31,6 +31,7 @@
 #include "mongo/db/storage/sorted_data_interface_test_harness.h"
 
 #include <memory>
+#include <vector>
 
 #include "mongo/db/storage/sorted_data_interface.h"
 #include "mongo/unittest/unittest.h"
@@ -282,4 +283,45 @@ TEST(SortedDataInterface, UnindexEmpty) {
     }
 }
 
+// Unindex a sorted batch of every other key, including one that is not in the index, and verify
+// that a cursor returns only the remaining keys.
+TEST(SortedDataInterface, UnindexBatch) {
+    const std::unique_ptr<HarnessHelper> harnessHelper(newHarnessHelper());
+    const std::unique_ptr<SortedDataInterface> sorted(harnessHelper->newSortedDataInterface(false));
+
+    int nToInsert = 2000;
+    {
+        const std::unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        WriteUnitOfWork uow(opCtx.get());
+        for (int i = 0; i < nToInsert; i++) {
+            ASSERT_OK(sorted->insert(opCtx.get(), BSON("" << i), RecordId(42, i * 2), true));
+        }
+        uow.commit();
+    }
+
+    {
+        std::vector<IndexKeyEntry> entries;
+        for (int i = 1; i <= nToInsert + 1; i += 2) {
+            entries.push_back(IndexKeyEntry(BSON("" << i), RecordId(42, i * 2)));
+        }
+
+        const std::unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        WriteUnitOfWork uow(opCtx.get());
+        sorted->unindexBatch(opCtx.get(), &entries[0], entries.size(), true);
+        uow.commit();
+    }
+
+    {
+        const std::unique_ptr<OperationContext> opCtx(harnessHelper->newOperationContext());
+        ASSERT_EQUALS(nToInsert / 2, sorted->numEntries(opCtx.get()));
+
+        const std::unique_ptr<SortedDataInterface::Cursor> cursor(sorted->newCursor(opCtx.get()));
+        for (int i = 0; i < nToInsert; i += 2) {
+            auto entry = i == 0 ? cursor->seek(minKey, true) : cursor->next();
+            ASSERT_EQ(entry, IndexKeyEntry(BSON("" << i), RecordId(42, i * 2)));
+        }
+        ASSERT(!cursor->next());
+    }
+}
+
 }  // namespace mongo
@@ -34,6 +34,7 @@
 #include <vector>
 
 #include "mongo/base/status.h"
+#include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/util/mongoutils/str.h"
 
@@ -221,6 +222,22 @@ public:
         return nullptr;
     }
 
+    /**
+     * Begins a backup of the data files. On success, returns the paths, relative to the dbpath,
+     * of the files that hold a consistent copy of all data. The engine does not modify or remove
+     * those files, beyond appending to its journal, until endBackup() is called, so they can be
+     * copied while the server keeps running. Only one backup may be in progress at a time.
+     */
+    virtual StatusWith<std::vector<std::string>> beginBackup(OperationContext* txn) {
+        return Status(ErrorCodes::CommandNotSupported,
+                      "This storage engine does not support backing up its data files");
+    }
+
+    /**
+     * Ends the backup started by a successful beginBackup().
+     */
+    virtual void endBackup(OperationContext* txn) {}
+
 protected:
     /**
      * The destructor will never be called. See cleanShutdown instead.
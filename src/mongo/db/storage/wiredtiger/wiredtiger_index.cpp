@@ -79,13 +79,23 @@ static const int TempKeyMaxSize = 1024;  // this goes away with SERVER-3372
 
 static const WiredTigerItem emptyItem(NULL, 0);
 
+// Used for indexes created with {prefixCompression: true}. Compound KeyStrings that share leading
+// fields share whole encoded bytes, so prefixes shorter than WT's default minimum of 4 bytes are
+// still worth compressing.
+static const char kKeyStringPrefixCompressionConfig[] =
+    "prefix_compression=true,prefix_compression_min=2,";
+
 static const int kMinimumIndexVersion = 6;
 static const int kCurrentIndexVersion = 6;  // New indexes use this by default.
-static const int kMaximumIndexVersion = 6;
+// Indexes created with a keyDictionary, which older versions can't decode.
+static const int kKeyDictionaryIndexVersion = 7;
+static const int kMaximumIndexVersion = 7;
 static_assert(kCurrentIndexVersion >= kMinimumIndexVersion,
               "kCurrentIndexVersion >= kMinimumIndexVersion");
 static_assert(kCurrentIndexVersion <= kMaximumIndexVersion,
               "kCurrentIndexVersion <= kMaximumIndexVersion");
+static_assert(kKeyDictionaryIndexVersion <= kMaximumIndexVersion,
+              "kKeyDictionaryIndexVersion <= kMaximumIndexVersion");
 
 bool hasFieldNames(const BSONObj& obj) {
     BSONForEach(e, obj) {
@@ -106,6 +116,20 @@ BSONObj stripFieldNames(const BSONObj& query) {
     return bb.obj();
 }
 
+/**
+ * Returns the {keyDictionary: {<field>: [<string>, ...]}} option of an index, or an empty object.
+ * The dictionary is part of the on-disk key format, so it is read from the index spec every time
+ * the index is opened and can never be changed.
+ */
+BSONObj getKeyDictionarySpec(const IndexDescriptor& desc) {
+    BSONElement storageEngineElement = desc.getInfoElement("storageEngine");
+    if (!storageEngineElement.isABSONObj()) {
+        return BSONObj();
+    }
+    return storageEngineElement.Obj().getObjectField(kWiredTigerEngineName).getObjectField(
+        "keyDictionary");
+}
+
 Status checkKeySize(const BSONObj& key) {
     if (key.objsize() >= TempKeyMaxSize) {
         string msg = mongoutils::str::stream()
@@ -137,6 +161,20 @@ StatusWith<std::string> WiredTigerIndex::parseIndexOptions(const BSONObj& option
                 return status;
             }
             ss << elem.valueStringData() << ',';
+        } else if (elem.fieldNameStringData() == "prefixCompression") {
+            if (!elem.isBoolean()) {
+                return StatusWith<std::string>(ErrorCodes::TypeMismatch,
+                                               "'prefixCompression' must be a boolean");
+            }
+            ss << (elem.boolean() ? kKeyStringPrefixCompressionConfig
+                                  : "prefix_compression=false,");
+        } else if (elem.fieldNameStringData() == "keyDictionary") {
+            // Checked against the key pattern by generateCreateString(). It changes the key
+            // format rather than the WiredTiger configuration.
+            if (elem.type() != Object) {
+                return StatusWith<std::string>(ErrorCodes::TypeMismatch,
+                                               "'keyDictionary' must be an object");
+            }
         } else {
             // Return error on first unrecognized field.
             return StatusWith<std::string>(ErrorCodes::InvalidOptions,
@@ -185,6 +223,15 @@ StatusWith<std::string> WiredTigerIndex::generateCreateString(const std::string&
         }
     }
 
+    const BSONObj keyDictionarySpec = getKeyDictionarySpec(desc);
+    if (!keyDictionarySpec.isEmpty()) {
+        Status status =
+            KeyString::Dictionary::parse(desc.keyPattern(), keyDictionarySpec).getStatus();
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
     // WARNING: No user-specified config can appear below this line. These options are required
     // for correct behavior of the server.
 
@@ -193,7 +240,8 @@ StatusWith<std::string> WiredTigerIndex::generateCreateString(const std::string&
 
     // Index metadata
     ss << ",app_metadata=("
-       << "formatVersion=" << kCurrentIndexVersion << ','
+       << "formatVersion="
+       << (keyDictionarySpec.isEmpty() ? kCurrentIndexVersion : kKeyDictionaryIndexVersion) << ','
        << "infoObj=" << desc.infoObj().jsonString() << "),";
 
     LOG(3) << "index create string: " << ss.ss.str();
@@ -223,6 +271,12 @@ WiredTigerIndex::WiredTigerIndex(OperationContext* ctx,
     if (!versionStatus.isOK()) {
         fassertFailedWithStatusNoTrace(28579, versionStatus);
     }
+
+    const BSONObj keyDictionarySpec = getKeyDictionarySpec(*desc);
+    if (!keyDictionarySpec.isEmpty()) {
+        _dictionary = fassertStatusOK(
+            28810, KeyString::Dictionary::parse(desc->keyPattern(), keyDictionarySpec));
+    }
 }
 
 Status WiredTigerIndex::insert(OperationContext* txn,
@@ -243,6 +297,39 @@ Status WiredTigerIndex::insert(OperationContext* txn,
     return _insert(c, key, loc, dupsAllowed);
 }
 
+Status WiredTigerIndex::insertBatch(OperationContext* txn,
+                                    const IndexKeyEntry* entries,
+                                    size_t nEntries,
+                                    bool dupsAllowed,
+                                    size_t* numInsertedOut) {
+    *numInsertedOut = 0;
+    if (nEntries == 0)
+        return Status::OK();
+
+    // A single cursor serves the whole batch. Since the entries arrive in index order, each
+    // insert lands at or just after the page the previous one touched.
+    WiredTigerCursor curwrap(_uri, _tableId, false, txn);
+    curwrap.assertInActiveTxn();
+    WT_CURSOR* c = curwrap.get();
+
+    for (size_t i = 0; i < nEntries; i++) {
+        const IndexKeyEntry& entry = entries[i];
+        invariant(entry.loc.isNormal());
+        dassert(!hasFieldNames(entry.key));
+
+        Status s = checkKeySize(entry.key);
+        if (s.isOK())
+            s = _insert(c, entry.key, entry.loc, dupsAllowed);
+        if (!s.isOK()) {
+            *numInsertedOut = i;
+            return s;
+        }
+    }
+
+    *numInsertedOut = nEntries;
+    return Status::OK();
+}
+
 void WiredTigerIndex::unindex(OperationContext* txn,
                               const BSONObj& key,
                               const RecordId& loc,
@@ -258,6 +345,25 @@ void WiredTigerIndex::unindex(OperationContext* txn,
     _unindex(c, key, loc, dupsAllowed);
 }
 
+void WiredTigerIndex::unindexBatch(OperationContext* txn,
+                                   const IndexKeyEntry* entries,
+                                   size_t nEntries,
+                                   bool dupsAllowed) {
+    if (nEntries == 0)
+        return;
+
+    WiredTigerCursor curwrap(_uri, _tableId, false, txn);
+    curwrap.assertInActiveTxn();
+    WT_CURSOR* c = curwrap.get();
+    invariant(c);
+
+    for (size_t i = 0; i < nEntries; i++) {
+        invariant(entries[i].loc.isNormal());
+        dassert(!hasFieldNames(entries[i].key));
+        _unindex(c, entries[i].key, entries[i].loc, dupsAllowed);
+    }
+}
+
 void WiredTigerIndex::fullValidate(OperationContext* txn,
                                    bool full,
                                    long long* numKeysOut,
@@ -312,6 +418,77 @@ void WiredTigerIndex::fullValidate(OperationContext* txn,
     }
 
     invariant(output);
+    _validateKeyFormat(txn, output);
+}
+
+void WiredTigerIndex::_validateKeyFormat(OperationContext* txn, BSONObjBuilder* output) const {
+    std::string type, sourceURI;
+    WiredTigerUtil::fetchTypeAndSourceURI(txn, _uri, &type, &sourceURI);
+    StatusWith<std::string> metadata = WiredTigerUtil::getMetadata(txn, sourceURI);
+
+    long long numKeys = 0;
+    long long keyBytes = 0;
+    long long sharedPrefixBytes = 0;
+    long long keysWithTypeBits = 0;
+    std::vector<std::string> errors;
+
+    WiredTigerCursor curwrap(_uri, _tableId, false, txn);
+    WT_CURSOR* c = curwrap.get();
+    std::string lastKey;
+    int ret;
+    while ((ret = c->next(c)) == 0) {
+        WT_ITEM key;
+        WT_ITEM value;
+        invariantWTOK(c->get_key(c, &key));
+        invariantWTOK(c->get_value(c, &value));
+
+        // WT compresses each key against the one before it on the same leaf page.
+        const char* keyData = static_cast<const char*>(key.data);
+        const size_t prefixLimit = std::min(key.size, lastKey.size());
+        size_t shared = 0;
+        while (shared < prefixLimit && keyData[shared] == lastKey[shared]) {
+            shared++;
+        }
+        numKeys++;
+        keyBytes += key.size;
+        sharedPrefixBytes += shared;
+        lastKey.assign(keyData, key.size);
+
+        bool hasTypeBits = false;
+        Status status = Status::OK();
+        try {
+            status = _checkValueFormat(value, &hasTypeBits);
+        } catch (const DBException& ex) {
+            status = ex.toStatus();
+        }
+        if (!status.isOK()) {
+            if (errors.size() < 20) {
+                errors.push_back(str::stream() << "index entry " << numKeys
+                                               << " has a malformed value: " << status.reason());
+            }
+            continue;
+        }
+        if (hasTypeBits)
+            keysWithTypeBits++;
+    }
+    invariant(ret == WT_NOTFOUND);
+
+    BSONObjBuilder keyFormat(output->subobjStart("keyFormat"));
+    if (metadata.isOK()) {
+        keyFormat.append("prefixCompression",
+                         metadata.getValue().find("prefix_compression=true") != std::string::npos);
+    }
+    keyFormat.appendNumber("keys", numKeys);
+    keyFormat.appendNumber("keysWithTypeBits", keysWithTypeBits);
+    keyFormat.append("averageKeyBytes", numKeys ? double(keyBytes) / numKeys : 0.0);
+    keyFormat.append("averageSharedPrefixBytes",
+                     numKeys ? double(sharedPrefixBytes) / numKeys : 0.0);
+    keyFormat.done();
+
+    if (!errors.empty()) {
+        *output << "errors" << errors;
+        *output << "valid" << false;
+    }
 }
 
 bool WiredTigerIndex::appendCustomStats(OperationContext* txn,
@@ -387,7 +564,7 @@ long long WiredTigerIndex::getSpaceUsedBytes(OperationContext* txn) const {
 bool WiredTigerIndex::isDup(WT_CURSOR* c, const BSONObj& key, const RecordId& loc) {
     invariant(unique());
     // First check whether the key exists.
-    KeyString data(key, _ordering);
+    KeyString data(key, _ordering, KeyString::kInclusive, dictionary());
     WiredTigerItem item(data.getBuffer(), data.getSize());
     c->set_key(c, item.Get());
     int ret = WT_OP_CHECK(c->search(c));
@@ -429,6 +606,11 @@ public:
           _cursor(openBulkCursor(idx)) {}
 
     ~BulkBuilder() {
+        if (_keysInTxn > 0) {
+            // Not committed, so the index build failed and the index will be dropped.
+            WT_SESSION* session = _session->getSession();
+            invariantWTOK(session->rollback_transaction(session, NULL));
+        }
         _cursor->close(_cursor);
         WiredTigerRecoveryUnit::get(_txn)->getSessionCache()->releaseSession(_session);
     }
@@ -445,8 +627,16 @@ protected:
         // We use our own session to ensure we aren't in a transaction.
         WT_SESSION* session = _session->getSession();
         int err = session->open_cursor(session, idx->uri().c_str(), NULL, "bulk", &cursor);
-        if (!err)
+        if (err == EBUSY) {
+            // Idle sessions in the cache may still have cursors open on a table that was only
+            // just created, so close them the same way a drop does and try again.
+            WiredTigerRecoveryUnit::get(_txn)->getSessionCache()->closeAll();
+            err = session->open_cursor(session, idx->uri().c_str(), NULL, "bulk", &cursor);
+        }
+        if (!err) {
+            _isBulk = true;
             return cursor;
+        }
 
         warning() << "failed to create WiredTiger bulk cursor: " << wiredtiger_strerror(err);
         warning() << "falling back to non-bulk cursor for index " << idx->uri();
@@ -455,10 +645,43 @@ protected:
         return cursor;
     }
 
+    /**
+     * Inserts the key and value set on the cursor. A bulk cursor appends them directly. A regular
+     * cursor groups inserts into transactions of kKeysPerTxn keys rather than running each one
+     * as a transaction of its own.
+     */
+    void insertCurrent() {
+        WT_SESSION* session = _session->getSession();
+        if (!_isBulk && _keysInTxn == 0) {
+            invariantWTOK(session->begin_transaction(session, NULL));
+        }
+
+        invariantWTOK(_cursor->insert(_cursor));
+
+        if (!_isBulk && ++_keysInTxn == kKeysPerTxn) {
+            commitKeys();
+        }
+    }
+
+    /**
+     * Commits any keys inserted through a regular cursor that are not yet committed.
+     */
+    void commitKeys() {
+        if (_keysInTxn == 0)
+            return;
+        WT_SESSION* session = _session->getSession();
+        invariantWTOK(session->commit_transaction(session, NULL));
+        _keysInTxn = 0;
+    }
+
+    static const int kKeysPerTxn = 1000;
+
     const Ordering _ordering;
     OperationContext* const _txn;
     WiredTigerSession* const _session;
+    bool _isBulk = false;  // Set by openBulkCursor(), so must be declared before _cursor.
     WT_CURSOR* const _cursor;
+    int _keysInTxn = 0;
 };
 
 /**
@@ -476,7 +699,7 @@ public:
                 return s;
         }
 
-        KeyString data(key, _idx->_ordering, loc);
+        KeyString data(key, _idx->_ordering, loc, _idx->dictionary());
 
         // Can't use WiredTigerCursor since we aren't using the cache.
         WiredTigerItem item(data.getBuffer(), data.getSize());
@@ -488,12 +711,14 @@ public:
 
         _cursor->set_value(_cursor, valueItem.Get());
 
-        invariantWTOK(_cursor->insert(_cursor));
+        insertCurrent();
 
         return Status::OK();
     }
 
     void commit(bool mayInterrupt) {
+        commitKeys();
+
         // TODO do we still need this?
         // this is bizarre, but required as part of the contract
         WriteUnitOfWork uow(_txn);
@@ -544,7 +769,7 @@ public:
         }
 
         _key = newKey.getOwned();
-        _keyString.resetToKey(_key, _idx->ordering());
+        _keyString.resetToKey(_key, _idx->ordering(), KeyString::kInclusive, _idx->dictionary());
         _records.push_back(std::make_pair(loc, _keyString.getTypeBits()));
 
         return Status::OK();
@@ -556,6 +781,7 @@ public:
             // This handles inserting the last unique key.
             doInsert();
         }
+        commitKeys();
         uow.commit();
     }
 
@@ -579,7 +805,7 @@ private:
         _cursor->set_key(_cursor, keyItem.Get());
         _cursor->set_value(_cursor, valueItem.Get());
 
-        invariantWTOK(_cursor->insert(_cursor));
+        insertCurrent();
 
         _records.clear();
     }
@@ -626,7 +852,8 @@ public:
         const auto discriminator =
             _forward == inclusive ? KeyString::kExclusiveAfter : KeyString::kExclusiveBefore;
         _endPosition = stdx::make_unique<KeyString>();
-        _endPosition->resetToKey(stripFieldNames(key), _idx.ordering(), discriminator);
+        _endPosition->resetToKey(
+            stripFieldNames(key), _idx.ordering(), discriminator, _idx.dictionary());
     }
 
     boost::optional<IndexKeyEntry> seek(const BSONObj& key,
@@ -638,7 +865,7 @@ public:
 
         // By using a discriminator other than kInclusive, there is no need to distinguish
         // unique vs non-unique key formats since both start with the key.
-        _query.resetToKey(finalKey, _idx.ordering(), discriminator);
+        _query.resetToKey(finalKey, _idx.ordering(), discriminator, _idx.dictionary());
         seekWTCursor(_query);
         updatePosition();
         return curr(parts);
@@ -652,7 +879,7 @@ public:
         // makeQueryObject handles the discriminator in the real exclusive cases.
         const auto discriminator =
             _forward ? KeyString::kExclusiveBefore : KeyString::kExclusiveAfter;
-        _query.resetToKey(key, _idx.ordering(), discriminator);
+        _query.resetToKey(key, _idx.ordering(), discriminator, _idx.dictionary());
         seekWTCursor(_query);
         updatePosition();
         return curr(parts);
@@ -713,7 +940,8 @@ protected:
 
         BSONObj bson;
         if (TRACING_ENABLED || (parts & kWantKey)) {
-            bson = KeyString::toBson(_key.getBuffer(), _key.getSize(), _idx.ordering(), _typeBits);
+            bson = KeyString::toBson(
+                _key.getBuffer(), _key.getSize(), _idx.ordering(), _typeBits, _idx.dictionary());
 
             TRACE_CURSOR << " returning " << bson << ' ' << _loc;
         }
@@ -912,7 +1140,8 @@ public:
     }
 
     boost::optional<IndexKeyEntry> seekExact(const BSONObj& key, RequestedInfo parts) override {
-        _query.resetToKey(stripFieldNames(key), _idx.ordering());
+        _query.resetToKey(
+            stripFieldNames(key), _idx.ordering(), KeyString::kInclusive, _idx.dictionary());
         const WiredTigerItem keyItem(_query.getBuffer(), _query.getSize());
 
         WT_CURSOR* c = _cursor->get();
@@ -946,11 +1175,27 @@ SortedDataBuilderInterface* WiredTigerIndexUnique::getBulkBuilder(OperationConte
     return new UniqueBulkBuilder(this, txn, dupsAllowed);
 }
 
+Status WiredTigerIndexUnique::_checkValueFormat(const WT_ITEM& value, bool* hasTypeBits) const {
+    // One or more RecordIds, each followed by its TypeBits. The TypeBits may be omitted when
+    // there is a single RecordId and they are all zeros.
+    BufReader br(value.data, value.size);
+    if (!br.remaining())
+        return Status(ErrorCodes::BadValue, "no RecordId");
+
+    while (br.remaining()) {
+        if (!KeyString::decodeRecordId(&br).isNormal())
+            return Status(ErrorCodes::BadValue, "invalid RecordId");
+        if (!KeyString::TypeBits::fromBuffer(&br).isAllZeros())
+            *hasTypeBits = true;
+    }
+    return Status::OK();
+}
+
 Status WiredTigerIndexUnique::_insert(WT_CURSOR* c,
                                       const BSONObj& key,
                                       const RecordId& loc,
                                       bool dupsAllowed) {
-    const KeyString data(key, _ordering);
+    const KeyString data(key, _ordering, KeyString::kInclusive, dictionary());
     WiredTigerItem keyItem(data.getBuffer(), data.getSize());
 
     KeyString value(loc);
@@ -1014,7 +1259,7 @@ void WiredTigerIndexUnique::_unindex(WT_CURSOR* c,
                                      const BSONObj& key,
                                      const RecordId& loc,
                                      bool dupsAllowed) {
-    KeyString data(key, _ordering);
+    KeyString data(key, _ordering, KeyString::kInclusive, dictionary());
     WiredTigerItem keyItem(data.getBuffer(), data.getSize());
     c->set_key(c, keyItem.Get());
 
@@ -1102,6 +1347,22 @@ SortedDataBuilderInterface* WiredTigerIndexStandard::getBulkBuilder(OperationCon
     return new StandardBulkBuilder(this, txn);
 }
 
+Status WiredTigerIndexStandard::_checkValueFormat(const WT_ITEM& value, bool* hasTypeBits) const {
+    // The RecordId is part of the key, so the value only holds TypeBits, and only when they are
+    // not all zeros.
+    if (value.size == 0)
+        return Status::OK();
+
+    BufReader br(value.data, value.size);
+    if (KeyString::TypeBits::fromBuffer(&br).isAllZeros())
+        return Status(ErrorCodes::BadValue, "all-zero TypeBits stored out of line");
+    if (br.remaining())
+        return Status(ErrorCodes::BadValue, "unexpected bytes after TypeBits");
+
+    *hasTypeBits = true;
+    return Status::OK();
+}
+
 Status WiredTigerIndexStandard::_insert(WT_CURSOR* c,
                                         const BSONObj& keyBson,
                                         const RecordId& loc,
@@ -1110,7 +1371,7 @@ Status WiredTigerIndexStandard::_insert(WT_CURSOR* c,
 
     TRACE_INDEX << " key: " << keyBson << " loc: " << loc;
 
-    KeyString key(keyBson, _ordering, loc);
+    KeyString key(keyBson, _ordering, loc, dictionary());
     WiredTigerItem keyItem(key.getBuffer(), key.getSize());
 
     WiredTigerItem valueItem = key.getTypeBits().isAllZeros()
@@ -1134,7 +1395,7 @@ void WiredTigerIndexStandard::_unindex(WT_CURSOR* c,
                                        const RecordId& loc,
                                        bool dupsAllowed) {
     invariant(dupsAllowed);
-    KeyString data(key, _ordering, loc);
+    KeyString data(key, _ordering, loc, dictionary());
     WiredTigerItem item(data.getBuffer(), data.getSize());
     c->set_key(c, item.Get());
     int ret = WT_OP_CHECK(c->remove(c));
@@ -32,6 +32,7 @@
 
 #include "mongo/base/status_with.h"
 #include "mongo/db/storage/index_entry_comparison.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage/sorted_data_interface.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 
@@ -83,11 +84,22 @@ public:
                           const RecordId& loc,
                           bool dupsAllowed);
 
+    virtual Status insertBatch(OperationContext* txn,
+                               const IndexKeyEntry* entries,
+                               size_t nEntries,
+                               bool dupsAllowed,
+                               size_t* numInsertedOut);
+
     virtual void unindex(OperationContext* txn,
                          const BSONObj& key,
                          const RecordId& loc,
                          bool dupsAllowed);
 
+    virtual void unindexBatch(OperationContext* txn,
+                              const IndexKeyEntry* entries,
+                              size_t nEntries,
+                              bool dupsAllowed);
+
     virtual void fullValidate(OperationContext* txn,
                               bool full,
                               long long* numKeysOut,
@@ -116,6 +128,13 @@ public:
         return _ordering;
     }
 
+    /**
+     * Returns the dictionary every key of this index is encoded with, or NULL if it has none.
+     */
+    const KeyString::Dictionary* dictionary() const {
+        return _dictionary.isEmpty() ? NULL : &_dictionary;
+    }
+
     virtual bool unique() const = 0;
 
     Status dupKeyError(const BSONObj& key);
@@ -131,11 +150,21 @@ protected:
                           const RecordId& loc,
                           bool dupsAllowed) = 0;
 
+    /**
+     * Checks that 'value' matches the layout this kind of index writes, and sets 'hasTypeBits'
+     * if it includes TypeBits that are not all zeros. Used by full validation.
+     */
+    virtual Status _checkValueFormat(const WT_ITEM& value, bool* hasTypeBits) const = 0;
+
+    // Checks the format of every entry and reports key and prefix sizes under "keyFormat".
+    void _validateKeyFormat(OperationContext* txn, BSONObjBuilder* output) const;
+
     class BulkBuilder;
     class StandardBulkBuilder;
     class UniqueBulkBuilder;
 
     const Ordering _ordering;
+    KeyString::Dictionary _dictionary;
     std::string _uri;
     uint64_t _tableId;
     std::string _collectionNamespace;
@@ -164,6 +193,8 @@ public:
                    bool dupsAllowed) override;
 
     void _unindex(WT_CURSOR* c, const BSONObj& key, const RecordId& loc, bool dupsAllowed) override;
+
+    Status _checkValueFormat(const WT_ITEM& value, bool* hasTypeBits) const override;
 };
 
 class WiredTigerIndexStandard : public WiredTigerIndex {
@@ -187,6 +218,8 @@ public:
                    bool dupsAllowed) override;
 
     void _unindex(WT_CURSOR* c, const BSONObj& key, const RecordId& loc, bool dupsAllowed) override;
+
+    Status _checkValueFormat(const WT_ITEM& value, bool* hasTypeBits) const override;
 };
 
 }  // namespace
@@ -139,4 +139,51 @@ TEST(WiredTigerIndexTest, GenerateCreateStringValidConfigStringOption) {
     ASSERT_EQ(WiredTigerIndex::parseIndexOptions(spec), std::string("prefix_compression=true,"));
 }
 
+TEST(WiredTigerIndexTest, GenerateCreateStringPrefixCompressionEnabled) {
+    BSONObj spec = fromjson("{prefixCompression: true}");
+    ASSERT_EQ(WiredTigerIndex::parseIndexOptions(spec),
+              std::string("prefix_compression=true,prefix_compression_min=2,"));
+}
+
+TEST(WiredTigerIndexTest, GenerateCreateStringPrefixCompressionDisabled) {
+    BSONObj spec = fromjson("{prefixCompression: false}");
+    ASSERT_EQ(WiredTigerIndex::parseIndexOptions(spec), std::string("prefix_compression=false,"));
+}
+
+TEST(WiredTigerIndexTest, GenerateCreateStringNonBooleanPrefixCompression) {
+    BSONObj spec = fromjson("{prefixCompression: 'yes'}");
+    ASSERT_EQ(WiredTigerIndex::parseIndexOptions(spec), ErrorCodes::TypeMismatch);
+}
+
+TEST(WiredTigerIndexTest, GenerateCreateStringKeyDictionary) {
+    BSONObj spec = fromjson("{keyDictionary: {a: ['x', 'y']}}");
+    ASSERT_EQ(WiredTigerIndex::parseIndexOptions(spec), std::string());
+
+    IndexDescriptor desc(NULL,
+                         "",
+                         BSON("key" << BSON("a" << 1) << "name"
+                                    << "a_1"
+                                    << "ns"
+                                    << "test.wt"
+                                    << "storageEngine" << BSON("wiredTiger" << spec)));
+    StatusWith<std::string> result = WiredTigerIndex::generateCreateString("", "", desc);
+    ASSERT_OK(result.getStatus());
+    ASSERT_NOT_EQUALS(std::string::npos, result.getValue().find("formatVersion=7,"));
+}
+
+TEST(WiredTigerIndexTest, GenerateCreateStringInvalidKeyDictionary) {
+    ASSERT_EQ(WiredTigerIndex::parseIndexOptions(fromjson("{keyDictionary: ['x']}")),
+              ErrorCodes::TypeMismatch);
+
+    IndexDescriptor desc(NULL,
+                         "",
+                         BSON("key" << BSON("a" << 1) << "name"
+                                    << "a_1"
+                                    << "ns"
+                                    << "test.wt"
+                                    << "storageEngine"
+                                    << fromjson("{wiredTiger: {keyDictionary: {b: ['x']}}}")));
+    ASSERT_EQ(WiredTigerIndex::generateCreateString("", "", desc), ErrorCodes::InvalidOptions);
+}
+
 }  // namespace mongo
@@ -64,6 +64,8 @@ public:
             params.dbpath, wiredTigerGlobalOptions.engineConfig, params.dur, params.repair);
         kv->setRecordStoreExtraOptions(wiredTigerGlobalOptions.collectionConfig);
         kv->setSortedDataInterfaceExtraOptions(wiredTigerGlobalOptions.indexConfig);
+        kv->startTicketController();
+        kv->startSizeStorerFlusher();
         // Intentionally leaked.
         new WiredTigerServerStatusSection(kv);
         new WiredTigerEngineRuntimeConfigParameter(kv);
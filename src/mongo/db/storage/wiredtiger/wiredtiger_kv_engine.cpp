@@ -40,6 +40,7 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/storage/record_zone_map.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_index.h"
@@ -47,8 +48,11 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_size_storer.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_controller.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
+#include "mongo/util/memory_budget.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/scopeguard.h"
 #include "mongo/util/time_support.h"
@@ -62,6 +66,36 @@ namespace mongo {
 using std::set;
 using std::string;
 
+namespace {
+
+/**
+ * Reports the bytes in the WiredTiger cache. The cache is sized by --wiredTigerCacheSizeGB and
+ * evicts on its own, so it can't be asked to shrink, but counting it lets the budget leave the
+ * rest of its limit to the caches which can.
+ */
+class WiredTigerCacheMemoryConsumer : public MemoryConsumer {
+public:
+    explicit WiredTigerCacheMemoryConsumer(WT_CONNECTION* conn) : _conn(conn) {}
+
+    int64_t bytesUsed() const override {
+        WiredTigerSession session(_conn);
+        const std::string uri = "statistics:";
+        const std::string config = "statistics=(fast)";
+        auto bytesInUse = WiredTigerUtil::getStatisticsValueAs<int64_t>(
+            session.getSession(), uri, config, WT_STAT_CONN_CACHE_BYTES_INUSE);
+        return bytesInUse.isOK() ? bytesInUse.getValue() : 0;
+    }
+
+    int64_t shrink(int64_t bytes) override {
+        return 0;
+    }
+
+private:
+    WT_CONNECTION* const _conn;
+};
+
+}  // namespace
+
 
 WiredTigerKVEngine::WiredTigerKVEngine(const std::string& path,
                                        const std::string& extraOpenOptions,
@@ -163,6 +197,9 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& path,
         _sizeStorer.reset(new WiredTigerSizeStorer(_conn, _sizeStorerUri));
         _sizeStorer->fillCache();
     }
+
+    _cacheMemoryConsumer = stdx::make_unique<WiredTigerCacheMemoryConsumer>(_conn);
+    MemoryBudget::get()->registerConsumer("wiredTigerCache", _cacheMemoryConsumer.get());
 }
 
 
@@ -176,8 +213,28 @@ WiredTigerKVEngine::~WiredTigerKVEngine() {
 
 void WiredTigerKVEngine::cleanShutdown() {
     log() << "WiredTigerKVEngine shutting down";
+    if (_sizeStorerFlusher) {
+        _sizeStorerFlusher->shutdown();
+        _sizeStorerFlusher.reset();
+    }
     syncSizeInfo(true);
     if (_conn) {
+        if (_cacheMemoryConsumer) {
+            MemoryBudget::get()->unregisterConsumer(_cacheMemoryConsumer.get());
+            _cacheMemoryConsumer.reset();
+        }
+
+        if (_ticketController) {
+            _ticketController->shutdown();
+            _ticketController.reset();
+        }
+
+        {
+            // Closing the connection closes the backup session; forget it first.
+            stdx::lock_guard<stdx::mutex> lk(_backupMutex);
+            _backupSession = nullptr;
+        }
+
         // these must be the last things we do before _conn->close();
         _sizeStorer.reset(NULL);
         _sessionCache->shuttingDown();
@@ -192,6 +249,25 @@ void WiredTigerKVEngine::cleanShutdown() {
     }
 }
 
+void WiredTigerKVEngine::startTicketController() {
+    invariant(!_ticketController);
+    _ticketController = stdx::make_unique<WiredTigerTicketController>(_conn);
+    _ticketController->go();
+}
+
+void WiredTigerKVEngine::startSizeStorerFlusher() {
+    invariant(!_sizeStorerFlusher);
+    if (!_sizeStorer)
+        return;
+    _sizeStorerFlusher = stdx::make_unique<WiredTigerSizeStorerFlusher>(_sizeStorer.get());
+    _sizeStorerFlusher->go();
+}
+
+void WiredTigerKVEngine::appendSizeStorerStats(BSONObjBuilder* b) const {
+    if (_sizeStorer)
+        _sizeStorer->appendStats(b);
+}
+
 Status WiredTigerKVEngine::okToRename(OperationContext* opCtx,
                                       StringData fromNS,
                                       StringData toNS,
@@ -306,10 +382,20 @@ RecordStore* WiredTigerKVEngine::getRecordStore(OperationContext* opCtx,
                                          options.cappedMaxDocs ? options.cappedMaxDocs : -1,
                                          NULL,
                                          _sizeStorer.get());
-    } else {
-        return new WiredTigerRecordStore(
-            opCtx, ns, _uri(ident), false, -1, -1, NULL, _sizeStorer.get());
     }
+
+    auto rs = stdx::make_unique<WiredTigerRecordStore>(
+        opCtx, ns, _uri(ident), false, -1, -1, nullptr, _sizeStorer.get());
+
+    // Zone maps are kept in memory only, so they are rebuilt each time the collection is opened.
+    // The option was validated when the collection was created. Capped collections ignore it,
+    // since their records are deleted in insertion order anyway.
+    BSONElement zoneMapSpec =
+        options.storageEngine.getObjectField(kWiredTigerEngineName).getField("zoneMap");
+    if (!zoneMapSpec.eoo()) {
+        rs->setZoneMap(opCtx, uassertStatusOK(RecordZoneMap::parse(zoneMapSpec)));
+    }
+    return rs.release();
 }
 
 string WiredTigerKVEngine::_uri(StringData ident) const {
@@ -394,7 +480,7 @@ bool WiredTigerKVEngine::haveDropsQueued() const {
     Date_t now = Date_t::now();
     Milliseconds delta = now - _previousCheckedDropsQueued;
 
-    if (_sizeStorerSyncTracker.intervalHasElapsed()) {
+    if (!_sizeStorerFlusher && _sizeStorerSyncTracker.intervalHasElapsed()) {
         _sizeStorerSyncTracker.resetLastTime();
         syncSizeInfo(false);
     }
@@ -501,6 +587,49 @@ std::vector<std::string> WiredTigerKVEngine::getAllIdents(OperationContext* opCt
     return all;
 }
 
+StatusWith<std::vector<std::string>> WiredTigerKVEngine::beginBackup(OperationContext* opCtx) {
+    stdx::lock_guard<stdx::mutex> lk(_backupMutex);
+    if (_backupSession) {
+        return Status(ErrorCodes::ConflictingOperationInProgress,
+                      "A backup of the data files is already in progress");
+    }
+
+    // The backup cursor must stay open until endBackup(), so it gets a session of its own
+    // rather than one from the session cache.
+    WT_SESSION* session;
+    int ret = _conn->open_session(_conn, NULL, NULL, &session);
+    if (ret != 0) {
+        return wtRCToStatus(ret);
+    }
+
+    std::vector<std::string> files;
+    WT_CURSOR* c;
+    ret = session->open_cursor(session, "backup:", NULL, NULL, &c);
+    if (ret == 0) {
+        while ((ret = c->next(c)) == 0) {
+            const char* filename;
+            invariantWTOK(c->get_key(c, &filename));
+            files.push_back(filename);
+        }
+    }
+    if (ret != WT_NOTFOUND) {
+        invariantWTOK(session->close(session, NULL));
+        return wtRCToStatus(ret);
+    }
+
+    _backupSession = session;
+    return files;
+}
+
+void WiredTigerKVEngine::endBackup(OperationContext* opCtx) {
+    stdx::lock_guard<stdx::mutex> lk(_backupMutex);
+    if (!_backupSession) {
+        return;
+    }
+    invariantWTOK(_backupSession->close(_backupSession, NULL));
+    _backupSession = nullptr;
+}
+
 int WiredTigerKVEngine::reconfigure(const char* str) {
     return _conn->reconfigure(_conn, str);
 }
@@ -44,8 +44,11 @@
 
 namespace mongo {
 
+class MemoryConsumer;
 class WiredTigerSessionCache;
 class WiredTigerSizeStorer;
+class WiredTigerSizeStorerFlusher;
+class WiredTigerTicketController;
 
 class WiredTigerKVEngine final : public KVEngine {
 public:
@@ -62,6 +65,10 @@ public:
 
     virtual bool supportsDirectoryPerDB() const;
 
+    virtual bool supportsConcurrentRecordStoreOpen() const {
+        return true;
+    }
+
     virtual bool isDurable() const {
         return _durable;
     }
@@ -110,6 +117,14 @@ public:
         return &_sessionCache->snapshotManager();
     }
 
+    /**
+     * Opens a WiredTiger backup cursor, which keeps the files it lists from being changed by
+     * checkpoints or removed until endBackup() closes it.
+     */
+    StatusWith<std::vector<std::string>> beginBackup(OperationContext* opCtx) final;
+
+    void endBackup(OperationContext* opCtx) final;
+
     // wiredtiger specific
     // Calls WT_CONNECTION::reconfigure on the underlying WT_CONNECTION
     // held by this class
@@ -131,6 +146,23 @@ public:
      */
     static bool initRsOplogBackgroundThread(StringData ns);
 
+    /**
+     * Starts the background job that resizes the concurrent transaction ticket pools when
+     * adaptive sizing is enabled. It is stopped by cleanShutdown().
+     */
+    void startTicketController();
+
+    /**
+     * Starts the background job that writes size storer changes a little at a time. Until it is
+     * started, changes are written all at once, periodically, from haveDropsQueued().
+     */
+    void startSizeStorerFlusher();
+
+    /**
+     * Appends size storer flushing statistics for serverStatus.
+     */
+    void appendSizeStorerStats(BSONObjBuilder* b) const;
+
 private:
     Status _salvageIfNeeded(const char* uri);
     void _checkIdentPath(StringData ident);
@@ -155,7 +187,17 @@ private:
     std::unique_ptr<WiredTigerSizeStorer> _sizeStorer;
     std::string _sizeStorerUri;
     mutable ElapsedTracker _sizeStorerSyncTracker;
+    std::unique_ptr<WiredTigerSizeStorerFlusher> _sizeStorerFlusher;
+
+    std::unique_ptr<WiredTigerTicketController> _ticketController;
+
+    // Reports the bytes in the WiredTiger cache to the MemoryBudget while the connection is open.
+    std::unique_ptr<MemoryConsumer> _cacheMemoryConsumer;
 
     mutable Date_t _previousCheckedDropsQueued;
+
+    // The session holding the open backup cursor, if a backup is in progress.
+    stdx::mutex _backupMutex;
+    WT_SESSION* _backupSession = nullptr;
 };
 }
@@ -43,8 +43,10 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/oplog_hack.h"
+#include "mongo/db/storage/record_zone_map.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
@@ -60,6 +62,7 @@
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
 #include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 //#define RS_ITERATOR_TRACE(x) log() << "WTRS::Iterator " << x
 #define RS_ITERATOR_TRACE(x)
@@ -92,6 +95,42 @@ bool shouldUseOplogHack(OperationContext* opCtx, const std::string& uri) {
 
 MONGO_FP_DECLARE(WTWriteConflictException);
 
+// Percentage of the oplog's maximum size that stones awaiting truncation may add up to before
+// oplog inserts wait for the background reclaim thread to catch up. 0 disables the backpressure.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerOplogTruncationBackpressurePercent, int, 0);
+
+// Whether each oplog stone remembers the namespaces of its operations, so that oplog scans that
+// filter on a single namespace can skip the stones without any.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerOplogStonesTrackNamespaces, bool, false);
+
+namespace {
+
+// The longest a single oplog insert waits for truncation before going ahead regardless, so that
+// an insert holding locks cannot stall indefinitely behind the reclaim thread.
+const Milliseconds kMaxOplogBackpressureWait(100);
+
+// getManyCursors() splits a collection into at most this many RecordId ranges, and only gives a
+// range its own cursor if the collection has at least kMinRecordsPerRangeCursor records per range.
+const int kMaxRangeCursors = 16;
+const long long kMinRecordsPerRangeCursor = 1000;
+
+struct OplogTruncationStats {
+    AtomicInt64 truncations;
+    AtomicInt64 bytesTruncated;
+    AtomicInt64 truncateMicros;
+    AtomicInt64 backpressureWaits;
+    AtomicInt64 backpressureWaitMicros;
+    AtomicInt64 stonesSkippedByNamespace;
+};
+
+OplogTruncationStats oplogTruncationStats;
+
+// The oplog stones of the oplog record store, if one exists, for reporting truncation lag.
+stdx::mutex activeOplogStonesMutex;
+std::weak_ptr<WiredTigerRecordStore::OplogStones> activeOplogStones;
+
+}  // namespace
+
 const std::string kWiredTigerEngineName = "wiredTiger";
 
 class WiredTigerRecordStore::OplogStones::InsertChange final : public RecoveryUnit::Change {
@@ -128,6 +167,9 @@ public:
 
         stdx::lock_guard<stdx::mutex> lk(_oplogStones->_mutex);
         _oplogStones->_stones.clear();
+        _oplogStones->_excessSince = Date_t();
+        _oplogStones->_currentNamespaces.clear();
+        _oplogStones->_namespacesUnknownThrough = RecordId();
     }
 
     void rollback() final {}
@@ -137,7 +179,7 @@ private:
 };
 
 WiredTigerRecordStore::OplogStones::OplogStones(OperationContext* txn, WiredTigerRecordStore* rs)
-    : _rs(rs) {
+    : _rs(rs), _trackNamespaces(wiredTigerOplogStonesTrackNamespaces) {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
 
     invariant(rs->isCapped());
@@ -167,6 +209,7 @@ void WiredTigerRecordStore::OplogStones::kill() {
         _isDead = true;
     }
     _oplogReclaimCv.notify_one();
+    _oplogTruncatedCv.notify_all();
 }
 
 void WiredTigerRecordStore::OplogStones::awaitHasExcessStonesOrDead() {
@@ -177,6 +220,36 @@ void WiredTigerRecordStore::OplogStones::awaitHasExcessStonesOrDead() {
     }
 }
 
+void WiredTigerRecordStore::OplogStones::awaitTruncation(Milliseconds timeout) {
+    const auto deadline = stdx::chrono::system_clock::now() + timeout;
+    stdx::unique_lock<stdx::mutex> lock(_oplogReclaimMutex);
+    const uint64_t truncatedBefore = _numTruncatedStones;
+    while (!_isDead && _numTruncatedStones == truncatedBefore) {
+        if (_oplogTruncatedCv.wait_until(lock, deadline) == stdx::cv_status::timeout) {
+            return;
+        }
+    }
+}
+
+size_t WiredTigerRecordStore::OplogStones::numExcessStones() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return hasExcessStones() ? _stones.size() - _numStonesToKeep : 0;
+}
+
+int64_t WiredTigerRecordStore::OplogStones::excessBytes() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    int64_t bytes = 0;
+    for (size_t i = 0; i + _numStonesToKeep < _stones.size(); ++i) {
+        bytes += _stones[i].bytes;
+    }
+    return bytes;
+}
+
+Date_t WiredTigerRecordStore::OplogStones::excessSince() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _excessSince;
+}
+
 boost::optional<WiredTigerRecordStore::OplogStones::Stone>
 WiredTigerRecordStore::OplogStones::peekOldestStoneIfNeeded() const {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
@@ -189,8 +262,19 @@ WiredTigerRecordStore::OplogStones::peekOldestStoneIfNeeded() const {
 }
 
 void WiredTigerRecordStore::OplogStones::popOldestStone() {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-    _stones.pop_front();
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _stones.pop_front();
+        if (!hasExcessStones()) {
+            _excessSince = Date_t();
+        }
+    }
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(_oplogReclaimMutex);
+        ++_numTruncatedStones;
+    }
+    _oplogTruncatedCv.notify_all();
 }
 
 void WiredTigerRecordStore::OplogStones::createNewStoneIfNeeded(RecordId lastRecord) {
@@ -206,8 +290,14 @@ void WiredTigerRecordStore::OplogStones::createNewStoneIfNeeded(RecordId lastRec
         return;
     }
 
-    OplogStones::Stone stone = {_currentRecords.swap(0), _currentBytes.swap(0), lastRecord};
+    OplogStones::Stone stone = {_currentRecords.swap(0),
+                                _currentBytes.swap(0),
+                                lastRecord,
+                                _takeCurrentNamespaces_inlock(lastRecord)};
     _stones.push_back(stone);
+    if (hasExcessStones() && _excessSince == Date_t()) {
+        _excessSince = Date_t::now();
+    }
 
     _pokeReclaimThreadIfNeeded();
 }
@@ -221,6 +311,47 @@ void WiredTigerRecordStore::OplogStones::clearStonesOnCommit(OperationContext* t
     txn->recoveryUnit()->registerChange(new TruncateChange(this));
 }
 
+void WiredTigerRecordStore::OplogStones::noteRecord(const RecordId& id, const BSONObj& doc) {
+    if (!_trackNamespaces) {
+        return;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _noteRecord_inlock(id, doc);
+}
+
+RecordId WiredTigerRecordStore::OplogStones::lastRecordOfStonesWithout(
+    const RecordId& id,
+    const std::string& ns,
+    int64_t* stonesSkipped,
+    RecordId* mayMatchThrough) const {
+    invariant(_trackNamespaces);
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    auto stone = std::lower_bound(_stones.begin(),
+                                  _stones.end(),
+                                  id,
+                                  [](const OplogStones::Stone& stone, const RecordId& id) {
+                                      return stone.lastRecord < id;
+                                  });
+
+    RecordId skipThrough;
+    for (; stone != _stones.end(); ++stone) {
+        if (!stone->namespaces || stone->namespaces->count(ns)) {
+            break;
+        }
+        skipThrough = stone->lastRecord;
+        ++*stonesSkipped;
+    }
+
+    if (skipThrough.isNull()) {
+        // The records of the stone being filled may match until it is placed.
+        *mayMatchThrough = stone == _stones.end() ? RecordId::max() : stone->lastRecord;
+    }
+    return skipThrough;
+}
+
 void WiredTigerRecordStore::OplogStones::updateStonesAfterCappedTruncateAfter(
     int64_t recordsRemoved, int64_t bytesRemoved, RecordId firstRemovedId) {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
@@ -240,8 +371,21 @@ void WiredTigerRecordStore::OplogStones::updateStonesAfterCappedTruncateAfter(
         bytesInStonesToRemove += it->bytes;
     }
 
-    // Remove the stones corresponding to the records that were deleted.
+    // Remove the stones corresponding to the records that were deleted. Their namespaces move to
+    // the stone being filled, which now holds their remaining records.
     int64_t offset = _stones.size() - numStonesToRemove;
+    if (_trackNamespaces) {
+        for (auto it = _stones.begin() + offset; it != _stones.end(); ++it) {
+            if (!it->namespaces) {
+                _namespacesUnknownThrough = std::max(_namespacesUnknownThrough, it->lastRecord);
+                continue;
+            }
+            for (const auto& ns : *it->namespaces) {
+                RecordId& highest = _currentNamespaces[ns];
+                highest = std::max(highest, it->lastRecord);
+            }
+        }
+    }
     _stones.erase(_stones.begin() + offset, _stones.end());
 
     // Account for any remaining records from a partially truncated stone in the stone currently
@@ -270,6 +414,14 @@ void WiredTigerRecordStore::OplogStones::setNumStonesToKeep(size_t numStones) {
     _numStonesToKeep = numStones;
 }
 
+void WiredTigerRecordStore::OplogStones::setTrackNamespaces(bool trackNamespaces) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    // Only allow changing whether namespaces are tracked if no data has been inserted.
+    invariant(_stones.size() == 0 && _currentRecords.load() == 0);
+    _trackNamespaces = trackNamespaces;
+}
+
 void WiredTigerRecordStore::OplogStones::_calculateStones(OperationContext* txn) {
     long long numRecords = _rs->numRecords(txn);
     long long dataSize = _rs->dataSize(txn);
@@ -304,13 +456,20 @@ void WiredTigerRecordStore::OplogStones::_calculateStonesByScanning(OperationCon
 
     auto cursor = _rs->getCursor(txn, true);
     while (auto record = cursor->next()) {
+        if (_trackNamespaces) {
+            _noteRecord_inlock(record->id, record->data.toBson());
+        }
+
         _currentRecords.addAndFetch(1);
         int64_t newCurrentBytes = _currentBytes.addAndFetch(record->data.size());
         if (newCurrentBytes >= _minBytesPerStone) {
             LOG(1) << "Placing a marker at optime "
                    << Timestamp(record->id.repr()).toStringPretty();
 
-            OplogStones::Stone stone = {_currentRecords.swap(0), _currentBytes.swap(0), record->id};
+            OplogStones::Stone stone = {_currentRecords.swap(0),
+                                        _currentBytes.swap(0),
+                                        record->id,
+                                        _takeCurrentNamespaces_inlock(record->id)};
             _stones.push_back(stone);
         }
 
@@ -352,6 +511,14 @@ void WiredTigerRecordStore::OplogStones::_calculateStonesBySampling(OperationCon
     }
     std::sort(oplogEstimates.begin(), oplogEstimates.end());
 
+    if (_trackNamespaces) {
+        // Sampling doesn't see the namespaces of the records already in the oplog.
+        auto reverseCursor = _rs->getCursor(txn, false);
+        if (auto record = reverseCursor->next()) {
+            _namespacesUnknownThrough = record->id;
+        }
+    }
+
     for (int i = 1; i <= wholeStones; ++i) {
         // Use every (kRandomSamplesPerStone)th sample, starting with the
         // (kRandomSamplesPerStone - 1)th, as the last record for each stone.
@@ -374,6 +541,69 @@ void WiredTigerRecordStore::OplogStones::_pokeReclaimThreadIfNeeded() {
     }
 }
 
+void WiredTigerRecordStore::OplogStones::_noteRecord_inlock(const RecordId& id,
+                                                            const BSONObj& doc) {
+    BSONElement nsElem = doc["ns"];
+    if (nsElem.type() != String) {
+        // No equality on a string namespace can match this record.
+        return;
+    }
+    StringData ns = nsElem.valueStringData();
+
+    if (_stones.empty() || _stones.back().lastRecord < id) {
+        RecordId& highest = _currentNamespaces[ns.toString()];
+        highest = std::max(highest, id);
+        return;
+    }
+
+    // A stone was already placed past this record, which was inserted out of order. Readers may
+    // hold copies of the stone's namespaces, so replace them rather than adding to them.
+    auto stone = std::lower_bound(_stones.begin(),
+                                  _stones.end(),
+                                  id,
+                                  [](const OplogStones::Stone& stone, const RecordId& id) {
+                                      return stone.lastRecord < id;
+                                  });
+    if (!stone->namespaces || stone->namespaces->count(ns.toString())) {
+        return;
+    }
+    if (stone->namespaces->size() >= kMaxNamespacesPerStone) {
+        stone->namespaces.reset();
+        return;
+    }
+    auto namespaces = std::make_shared<std::set<std::string>>(*stone->namespaces);
+    namespaces->insert(ns.toString());
+    stone->namespaces = std::move(namespaces);
+}
+
+std::shared_ptr<const std::set<std::string>>
+WiredTigerRecordStore::OplogStones::_takeCurrentNamespaces_inlock(const RecordId& lastRecord) {
+    if (!_trackNamespaces) {
+        return {};
+    }
+
+    const RecordId previousLastRecord = _stones.empty() ? RecordId() : _stones.back().lastRecord;
+    std::shared_ptr<std::set<std::string>> namespaces;
+    if (_namespacesUnknownThrough <= previousLastRecord &&
+        _currentNamespaces.size() <= kMaxNamespacesPerStone) {
+        namespaces = std::make_shared<std::set<std::string>>();
+    }
+
+    // Only the highest RecordId of each namespace is kept, so a namespace also seen after
+    // 'lastRecord' has to be kept for the next stone as well.
+    for (auto it = _currentNamespaces.begin(); it != _currentNamespaces.end();) {
+        if (namespaces) {
+            namespaces->insert(it->first);
+        }
+        if (it->second <= lastRecord) {
+            it = _currentNamespaces.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return namespaces;
+}
+
 class WiredTigerRecordStore::Cursor final : public SeekableRecordCursor {
 public:
     Cursor(OperationContext* txn, const WiredTigerRecordStore& rs, bool forward = true)
@@ -384,6 +614,17 @@ public:
         _cursor.emplace(rs.getURI(), rs.tableId(), true, txn);
     }
 
+    /**
+     * Restricts a forward cursor to the records with ids in [start, end). A null bound leaves that
+     * side of the range open. Must be called before the first call to next().
+     */
+    void setRange(const RecordId& start, const RecordId& end) {
+        invariant(_forward);
+        invariant(_lastReturnedId.isNull());
+        _rangeStart = start;
+        _rangeEnd = end;
+    }
+
     boost::optional<Record> next() final {
         if (_eof)
             return {};
@@ -412,6 +653,17 @@ public:
                     ? (cmp >= 0)
                     : (cmp > 0);  // No longer hidden.
             }
+        } else if (_lastReturnedId.isNull() && !_rangeStart.isNull()) {
+            // Start at the first record of our range rather than the first in the table.
+            c->set_key(c, _makeKey(_rangeStart));
+            int cmp;
+            int seekRet = WT_OP_CHECK(c->search_near(c, &cmp));
+            if (seekRet == WT_NOTFOUND) {
+                _eof = true;
+                return {};
+            }
+            invariantWTOK(seekRet);
+            mustAdvance = cmp < 0;
         }
 
         if (mustAdvance) {
@@ -428,7 +680,22 @@ public:
 
         int64_t key;
         invariantWTOK(c->get_key(c, &key));
-        const RecordId id = _fromKey(key);
+        RecordId id = _fromKey(key);
+
+        if (_zoneMapPredicate && !_skipRuledOutBlocks(&id)) {
+            _eof = true;
+            return {};
+        }
+
+        if (!_oplogNamespace.empty() && !_skipStonesWithoutNamespace(&id)) {
+            _eof = true;
+            return {};
+        }
+
+        if (!_rangeEnd.isNull() && id >= _rangeEnd) {
+            _eof = true;
+            return {};
+        }
 
         if (!isVisible(id)) {
             _eof = true;
@@ -437,6 +704,7 @@ public:
 
         WT_ITEM value;
         invariantWTOK(c->get_value(c, &value));
+        WiredTigerRecoveryUnit::get(_txn)->noteBytesRead(value.size);
 
         _lastReturnedId = id;
         return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
@@ -455,6 +723,7 @@ public:
 
         WT_ITEM value;
         invariantWTOK(c->get_value(c, &value));
+        WiredTigerRecoveryUnit::get(_txn)->noteBytesRead(value.size);
 
         _lastReturnedId = id;
         _eof = false;
@@ -474,6 +743,7 @@ public:
     void saveUnpositioned() final {
         save();
         _lastReturnedId = RecordId();
+        _namespaceMayMatchThrough = RecordId();
     }
 
     bool restore() final {
@@ -483,6 +753,9 @@ public:
         // This will ensure an active session exists, so any restored cursors will bind to it
         invariant(WiredTigerRecoveryUnit::get(_txn)->getSession(_txn) == _cursor->getSession());
 
+        // The stone being filled may have been placed since, and its namespaces become known.
+        _namespaceMayMatchThrough = RecordId();
+
         // If we've hit EOF, then this iterator is done and need not be restored.
         if (_eof)
             return true;
@@ -537,7 +810,106 @@ public:
         // _cursor recreated in restore() to avoid risk of WT_ROLLBACK issues.
     }
 
+    void setZoneMapPredicate(std::shared_ptr<const ZoneMapPredicate> predicate) final {
+        if (_rs._zoneMap) {
+            _zoneMapPredicate = std::move(predicate);
+            return;
+        }
+
+        // Without a zone map, forward scans of the oplog can still skip the oplog stones that have
+        // no operations on the namespace they are looking for.
+        if (!_forward || !_rs._oplogStones || !_rs._oplogStones->tracksNamespaces())
+            return;
+        for (const auto& comparison : predicate->getComparisons()) {
+            if (comparison.field == "ns" && comparison.op == ZoneMapPredicate::Op::kEQ &&
+                comparison.value.type() == String) {
+                _oplogNamespace = comparison.value.str();
+            }
+        }
+    }
+
 private:
+    /**
+     * If the zone map rules out the block holding 'id', moves the cursor to the first record of
+     * the next block it does not rule out and updates 'id'. Returns false if there is no such
+     * record.
+     *
+     * This may throw a WriteConflictException. That is safe because _lastReturnedId has not
+     * moved yet, so restore() puts the cursor back where next() started.
+     */
+    bool _skipRuledOutBlocks(RecordId* id) {
+        RecordZoneMap* zoneMap = _rs._zoneMap.get();
+        WT_CURSOR* c = _cursor->get();
+
+        int64_t blocksSkipped = 0;
+        ON_BLOCK_EXIT([&] {
+            if (blocksSkipped)
+                zoneMap->noteBlocksSkipped(blocksSkipped);
+        });
+
+        while (!zoneMap->blockMayMatch(*id, *_zoneMapPredicate)) {
+            blocksSkipped++;
+            const RecordId target = zoneMap->nextCandidate(*id, *_zoneMapPredicate, _forward);
+            if (target.isNull())
+                return false;
+
+            c->set_key(c, _makeKey(target));
+            int cmp;
+            int ret = WT_OP_CHECK(c->search_near(c, &cmp));
+            if (ret == 0 && (_forward ? cmp < 0 : cmp > 0)) {
+                // Landed just before the block in the direction of the scan.
+                ret = WT_OP_CHECK(_forward ? c->next(c) : c->prev(c));
+            }
+            if (ret == WT_NOTFOUND)
+                return false;
+            invariantWTOK(ret);
+
+            int64_t key;
+            invariantWTOK(c->get_key(c, &key));
+            *id = _fromKey(key);
+        }
+        return true;
+    }
+
+    /**
+     * If the oplog stones show that the stones starting with the one holding 'id' have no
+     * operations on '_oplogNamespace', moves the cursor to the first record after them and
+     * updates 'id'. Returns false if there is no such record.
+     *
+     * Like _skipRuledOutBlocks(), this may throw a WriteConflictException.
+     */
+    bool _skipStonesWithoutNamespace(RecordId* id) {
+        WT_CURSOR* c = _cursor->get();
+
+        int64_t stonesSkipped = 0;
+        ON_BLOCK_EXIT([&] {
+            if (stonesSkipped)
+                oplogTruncationStats.stonesSkippedByNamespace.fetchAndAdd(stonesSkipped);
+        });
+
+        while (*id > _namespaceMayMatchThrough) {
+            const RecordId skipThrough = _rs._oplogStones->lastRecordOfStonesWithout(
+                *id, _oplogNamespace, &stonesSkipped, &_namespaceMayMatchThrough);
+            if (skipThrough.isNull())
+                return true;
+
+            c->set_key(c, _makeKey(skipThrough));
+            int cmp;
+            int ret = WT_OP_CHECK(c->search_near(c, &cmp));
+            if (ret == 0 && cmp <= 0) {
+                ret = WT_OP_CHECK(c->next(c));
+            }
+            if (ret == WT_NOTFOUND)
+                return false;
+            invariantWTOK(ret);
+
+            int64_t key;
+            invariantWTOK(c->get_key(c, &key));
+            *id = _fromKey(key);
+        }
+        return true;
+    }
+
     bool isVisible(const RecordId& id) {
         if (!_rs._isCapped)
             return true;
@@ -563,6 +935,11 @@ private:
     bool _eof = false;
     RecordId _lastReturnedId;  // If null, need to seek to first/last record.
     const RecordId _readUntilForOplog;
+    RecordId _rangeStart;  // If non-null, the first id this cursor may return.
+    RecordId _rangeEnd;    // If non-null, the id this cursor stops before.
+    std::shared_ptr<const ZoneMapPredicate> _zoneMapPredicate;
+    std::string _oplogNamespace;         // If non-empty, the only namespace this scan can match.
+    RecordId _namespaceMayMatchThrough;  // Records up to here need not be checked for skipping.
 };
 
 StatusWith<std::string> WiredTigerRecordStore::parseOptionsField(const BSONObj options) {
@@ -574,6 +951,13 @@ StatusWith<std::string> WiredTigerRecordStore::parseOptionsField(const BSONObj o
                 return status;
             }
             ss << elem.valueStringData() << ',';
+        } else if (elem.fieldNameStringData() == "zoneMap") {
+            // Only validated here. The zone map lives in memory, see
+            // WiredTigerKVEngine::getRecordStore().
+            auto zoneMap = RecordZoneMap::parse(elem);
+            if (!zoneMap.isOK()) {
+                return zoneMap.getStatus();
+            }
         } else {
             // Return error on first unrecognized field.
             return StatusWith<std::string>(ErrorCodes::InvalidOptions,
@@ -608,6 +992,7 @@ public:
 
         WT_ITEM value;
         invariantWTOK(_cursor->get_value(_cursor, &value));
+        WiredTigerRecoveryUnit::get(_txn)->noteBytesRead(value.size);
 
         return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
     }
@@ -728,7 +1113,6 @@ WiredTigerRecordStore::WiredTigerRecordStore(OperationContext* ctx,
       _cappedDeleteCheckCount(0),
       _useOplogHack(shouldUseOplogHack(ctx, _uri)),
       _sizeStorer(sizeStorer),
-      _sizeStorerCounter(0),
       _shuttingDown(false) {
     Status versionStatus = WiredTigerUtil::checkApplicationMetadataFormatVersion(
         ctx, uri, kMinimumRecordStoreVersion, kMaximumRecordStoreVersion);
@@ -780,6 +1164,9 @@ WiredTigerRecordStore::WiredTigerRecordStore(OperationContext* ctx,
 
     if (WiredTigerKVEngine::initRsOplogBackgroundThread(ns)) {
         _oplogStones = std::make_shared<OplogStones>(ctx, this);
+
+        stdx::lock_guard<stdx::mutex> lk(activeOplogStonesMutex);
+        activeOplogStones = _oplogStones;
     }
 }
 
@@ -870,7 +1257,9 @@ RecordData WiredTigerRecordStore::dataFor(OperationContext* txn, const RecordId&
     int ret = WT_OP_CHECK(c->search(c));
     massert(28556, "Didn't find RecordId in WiredTigerRecordStore", ret != WT_NOTFOUND);
     invariantWTOK(ret);
-    return _getData(curwrap);
+    RecordData data = _getData(curwrap);
+    WiredTigerRecoveryUnit::get(txn)->noteBytesRead(data.size());
+    return data;
 }
 
 bool WiredTigerRecordStore::findRecord(OperationContext* txn,
@@ -886,6 +1275,7 @@ bool WiredTigerRecordStore::findRecord(OperationContext* txn,
     }
     invariantWTOK(ret);
     *out = _getData(curwrap);
+    WiredTigerRecoveryUnit::get(txn)->noteBytesRead(out->size());
     return true;
 }
 
@@ -1120,12 +1510,17 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* txn) {
             WT_CURSOR* end = endwrap.get();
             end->set_key(end, _makeKey(stone->lastRecord));
 
+            Timer timer;
             invariantWTOK(session->truncate(session, nullptr, start, end, nullptr));
             _changeNumRecords(txn, -stone->records);
             _increaseDataSize(txn, -stone->bytes);
 
             wuow.commit();
 
+            oplogTruncationStats.truncations.fetchAndAdd(1);
+            oplogTruncationStats.bytesTruncated.fetchAndAdd(stone->bytes);
+            oplogTruncationStats.truncateMicros.fetchAndAdd(timer.micros());
+
             // Remove the stone after a successful truncation.
             _oplogStones->popOldestStone();
 
@@ -1140,6 +1535,60 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* txn) {
            << " records totaling to " << _dataSize.load() << " bytes";
 }
 
+void WiredTigerRecordStore::_awaitOplogReclaimIfOverrun() {
+    const int marginPercent = wiredTigerOplogTruncationBackpressurePercent;
+    if (marginPercent <= 0) {
+        return;
+    }
+
+    const int64_t margin = _cappedMaxSize / 100 * marginPercent;
+    if (_oplogStones->excessBytes() <= margin) {
+        return;
+    }
+
+    Timer timer;
+    while (_oplogStones->excessBytes() > margin && !_oplogStones->isDead()) {
+        const Milliseconds elapsed(timer.millis());
+        if (elapsed >= kMaxOplogBackpressureWait) {
+            break;
+        }
+        _oplogStones->awaitTruncation(kMaxOplogBackpressureWait - elapsed);
+    }
+
+    oplogTruncationStats.backpressureWaits.fetchAndAdd(1);
+    oplogTruncationStats.backpressureWaitMicros.fetchAndAdd(timer.micros());
+}
+
+void WiredTigerRecordStore::appendOplogTruncationStats(BSONObjBuilder* b) {
+    const auto& stats = oplogTruncationStats;
+    b->appendNumber("truncations", static_cast<long long>(stats.truncations.load()));
+    b->appendNumber("bytesTruncated", static_cast<long long>(stats.bytesTruncated.load()));
+    b->appendNumber("truncateMicros", static_cast<long long>(stats.truncateMicros.load()));
+    b->appendNumber("backpressureWaits", static_cast<long long>(stats.backpressureWaits.load()));
+    b->appendNumber("backpressureWaitMicros",
+                    static_cast<long long>(stats.backpressureWaitMicros.load()));
+    b->appendNumber("stonesSkippedByNamespace",
+                    static_cast<long long>(stats.stonesSkippedByNamespace.load()));
+
+    std::shared_ptr<OplogStones> oplogStones;
+    {
+        stdx::lock_guard<stdx::mutex> lk(activeOplogStonesMutex);
+        oplogStones = activeOplogStones.lock();
+    }
+    if (!oplogStones || oplogStones->isDead()) {
+        return;
+    }
+
+    BSONObjBuilder lag(b->subobjStart("lag"));
+    lag.appendNumber("stones", static_cast<long long>(oplogStones->numExcessStones()));
+    lag.appendNumber("bytes", static_cast<long long>(oplogStones->excessBytes()));
+    const Date_t excessSince = oplogStones->excessSince();
+    lag.appendNumber("millis",
+                     excessSince == Date_t()
+                         ? 0LL
+                         : durationCount<Milliseconds>(Date_t::now() - excessSince));
+}
+
 StatusWith<RecordId> WiredTigerRecordStore::extractAndCheckLocForOplog(const char* data, int len) {
     return oploghack::extractKey(data, len);
 }
@@ -1148,28 +1597,56 @@ StatusWith<RecordId> WiredTigerRecordStore::insertRecord(OperationContext* txn,
                                                          const char* data,
                                                          int len,
                                                          bool enforceQuota) {
-    if (_isCapped && len > _cappedMaxSize) {
-        return StatusWith<RecordId>(ErrorCodes::BadValue, "object to insert exceeds cappedMaxSize");
+    std::vector<Record> records(1);
+    records[0].data = RecordData(data, len);
+    Status status = insertRecords(txn, &records, enforceQuota);
+    if (!status.isOK())
+        return StatusWith<RecordId>(status);
+    return StatusWith<RecordId>(records[0].id);
+}
+
+Status WiredTigerRecordStore::insertRecords(OperationContext* txn,
+                                            std::vector<Record>* records,
+                                            bool enforceQuota) {
+    if (_isCapped) {
+        for (const Record& record : *records) {
+            if (record.data.size() > _cappedMaxSize) {
+                return Status(ErrorCodes::BadValue, "object to insert exceeds cappedMaxSize");
+            }
+        }
+    }
+
+    if (_oplogStones) {
+        _awaitOplogReclaimIfOverrun();
     }
 
-    RecordId loc;
+    // Assign every RecordId up front so that the capped bookkeeping is done under one lock.
     if (_useOplogHack) {
-        StatusWith<RecordId> status = extractAndCheckLocForOplog(data, len);
-        if (!status.isOK())
-            return status;
-        loc = status.getValue();
-        if (loc > _oplog_highestSeen) {
+        RecordId highestInserted;
+        for (Record& record : *records) {
+            StatusWith<RecordId> status =
+                extractAndCheckLocForOplog(record.data.data(), record.data.size());
+            if (!status.isOK())
+                return status.getStatus();
+            record.id = status.getValue();
+            highestInserted = std::max(highestInserted, record.id);
+        }
+        if (highestInserted > _oplog_highestSeen) {
             stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
-            if (loc > _oplog_highestSeen) {
-                _oplog_highestSeen = loc;
+            if (highestInserted > _oplog_highestSeen) {
+                _oplog_highestSeen = highestInserted;
             }
         }
     } else if (_isCapped) {
         stdx::lock_guard<stdx::mutex> lk(_uncommittedDiskLocsMutex);
-        loc = _nextId();
-        _addUncommitedDiskLoc_inlock(txn, loc);
+        for (Record& record : *records) {
+            record.id = _nextId();
+            _addUncommitedDiskLoc_inlock(txn, record.id);
+        }
     } else {
-        loc = _nextId();
+        for (Record& record : *records) {
+            record.id = _nextId();
+        }
     }
 
     WiredTigerCursor curwrap(_uri, _tableId, true, txn);
@@ -1177,24 +1654,40 @@ StatusWith<RecordId> WiredTigerRecordStore::insertRecord(OperationContext* txn,
     WT_CURSOR* c = curwrap.get();
     invariant(c);
 
-    c->set_key(c, _makeKey(loc));
-    WiredTigerItem value(data, len);
-    c->set_value(c, value.Get());
-    int ret = WT_OP_CHECK(c->insert(c));
-    if (ret) {
-        return StatusWith<RecordId>(wtRCToStatus(ret, "WiredTigerRecordStore::insertRecord"));
+    int64_t totalLength = 0;
+    for (const Record& record : *records) {
+        if (_zoneMap) {
+            // The zone map must cover a record before anyone can see it.
+            _zoneMap->noteRecord(record.id, record.data.toBson());
+        }
+        if (_oplogStones) {
+            _oplogStones->noteRecord(record.id, record.data.toBson());
+        }
+
+        c->set_key(c, _makeKey(record.id));
+        WiredTigerItem value(record.data.data(), record.data.size());
+        c->set_value(c, value.Get());
+        int ret = WT_OP_CHECK(c->insert(c));
+        if (ret) {
+            return wtRCToStatus(ret, "WiredTigerRecordStore::insertRecord");
+        }
+
+        totalLength += record.data.size();
+        if (_oplogStones) {
+            _oplogStones->updateCurrentStoneAfterInsertOnCommit(
+                txn, record.data.size(), record.id);
+        }
     }
 
-    _changeNumRecords(txn, 1);
-    _increaseDataSize(txn, len);
+    _changeNumRecords(txn, records->size());
+    _increaseDataSize(txn, totalLength);
+    WiredTigerRecoveryUnit::get(txn)->noteBytesWritten(totalLength);
 
-    if (_oplogStones) {
-        _oplogStones->updateCurrentStoneAfterInsertOnCommit(txn, len, loc);
-    } else {
-        cappedDeleteAsNeeded(txn, loc);
+    if (!_oplogStones && !records->empty()) {
+        cappedDeleteAsNeeded(txn, records->back().id);
     }
 
-    return StatusWith<RecordId>(loc);
+    return Status::OK();
 }
 
 void WiredTigerRecordStore::dealtWithCappedLoc(const RecordId& loc) {
@@ -1253,11 +1746,19 @@ StatusWith<RecordId> WiredTigerRecordStore::updateRecord(OperationContext* txn,
         return {ErrorCodes::IllegalOperation, "Cannot change the size of a document in the oplog"};
     }
 
+    if (_zoneMap) {
+        _zoneMap->noteRecord(loc, BSONObj(data));
+    }
+    if (_oplogStones) {
+        _oplogStones->noteRecord(loc, BSONObj(data));
+    }
+
     c->set_key(c, _makeKey(loc));
     WiredTigerItem value(data, len);
     c->set_value(c, value.Get());
     ret = WT_OP_CHECK(c->insert(c));
     invariantWTOK(ret);
+    WiredTigerRecoveryUnit::get(txn)->noteBytesWritten(len);
 
     _increaseDataSize(txn, len - old_length);
     if (!_oplogStones) {
@@ -1268,7 +1769,7 @@ StatusWith<RecordId> WiredTigerRecordStore::updateRecord(OperationContext* txn,
 }
 
 bool WiredTigerRecordStore::updateWithDamagesSupported() const {
-    return false;
+    return true;
 }
 
 StatusWith<RecordData> WiredTigerRecordStore::updateWithDamages(
@@ -1277,7 +1778,42 @@ StatusWith<RecordData> WiredTigerRecordStore::updateWithDamages(
     const RecordData& oldRec,
     const char* damageSource,
     const mutablebson::DamageVector& damages) {
-    MONGO_UNREACHABLE;
+    // WiredTiger stores each record as a single value, so the damages are applied to a copy of
+    // the old record, which is then written back whole. That still spares the update path from
+    // rebuilding the document out of mutable BSON, and since the size of the record does not
+    // change, the old value does not have to be searched for first.
+    const int len = oldRec.size();
+    SharedBuffer data = SharedBuffer::allocate(len);
+    char* root = data.get();
+    memcpy(root, oldRec.data(), len);
+
+    mutablebson::DamageVector::const_iterator where = damages.begin();
+    const mutablebson::DamageVector::const_iterator end = damages.end();
+    for (; where != end; ++where) {
+        const char* sourcePtr = damageSource + where->sourceOffset;
+        char* targetPtr = root + where->targetOffset;
+        std::memcpy(targetPtr, sourcePtr, where->size);
+    }
+
+    if (_zoneMap) {
+        _zoneMap->noteRecord(loc, BSONObj(root));
+    }
+    if (_oplogStones) {
+        _oplogStones->noteRecord(loc, BSONObj(root));
+    }
+
+    WiredTigerCursor curwrap(_uri, _tableId, true, txn);
+    curwrap.assertInActiveTxn();
+    WT_CURSOR* c = curwrap.get();
+    invariant(c);
+    c->set_key(c, _makeKey(loc));
+    WiredTigerItem value(root, len);
+    c->set_value(c, value.Get());
+    int ret = WT_OP_CHECK(c->insert(c));
+    invariantWTOK(ret);
+    WiredTigerRecoveryUnit::get(txn)->noteBytesWritten(len);
+
+    return RecordData(data, len);
 }
 
 void WiredTigerRecordStore::_oplogSetStartHack(WiredTigerRecoveryUnit* wru) const {
@@ -1302,14 +1838,63 @@ std::unique_ptr<SeekableRecordCursor> WiredTigerRecordStore::getCursor(Operation
     return stdx::make_unique<Cursor>(txn, *this, forward);
 }
 
+void WiredTigerRecordStore::setZoneMap(OperationContext* txn,
+                                       std::unique_ptr<RecordZoneMap> zoneMap) {
+    invariant(!_isCapped);
+
+    Cursor cursor(txn, *this);
+    while (auto record = cursor.next()) {
+        zoneMap->noteRecord(record->id, record->data.toBson());
+    }
+    _zoneMap = std::move(zoneMap);
+}
+
 std::unique_ptr<RecordCursor> WiredTigerRecordStore::getRandomCursor(OperationContext* txn) const {
     return stdx::make_unique<RandomCursor>(txn, *this);
 }
 
 std::vector<std::unique_ptr<RecordCursor>> WiredTigerRecordStore::getManyCursors(
     OperationContext* txn) const {
-    std::vector<std::unique_ptr<RecordCursor>> cursors(1);
-    cursors[0] = stdx::make_unique<Cursor>(txn, *this, /*forward=*/true);
+    std::vector<std::unique_ptr<RecordCursor>> cursors;
+
+    // Capped collections rely on a single cursor for their visibility rules.
+    const long long numRanges = _isCapped
+        ? 1
+        : std::min<long long>(kMaxRangeCursors, numRecords(txn) / kMinRecordsPerRangeCursor);
+    if (numRanges <= 1) {
+        cursors.push_back(stdx::make_unique<Cursor>(txn, *this, /*forward=*/true));
+        return cursors;
+    }
+
+    // Split the ids between the first and last record evenly. Non-capped collections assign ids
+    // in increasing order, so this gives ranges of roughly the same number of records. The ranges
+    // on either end are left open so that records inserted outside of the current bounds are
+    // still covered.
+    WiredTigerCursor curwrap(_uri, _tableId, true, txn);
+    WT_CURSOR* c = curwrap.get();
+    int ret = WT_OP_CHECK(c->next(c));
+    if (ret == WT_NOTFOUND) {
+        cursors.push_back(stdx::make_unique<Cursor>(txn, *this, /*forward=*/true));
+        return cursors;
+    }
+    invariantWTOK(ret);
+    int64_t first;
+    invariantWTOK(c->get_key(c, &first));
+
+    invariantWTOK(c->reset(c));
+    invariantWTOK(WT_OP_CHECK(c->prev(c)));
+    int64_t last;
+    invariantWTOK(c->get_key(c, &last));
+
+    const int64_t step = (last - first) / numRanges + 1;
+    RecordId start;
+    for (long long i = 1; i <= numRanges; i++) {
+        const RecordId end = i == numRanges ? RecordId() : _fromKey(first + step * i);
+        auto cursor = stdx::make_unique<Cursor>(txn, *this, /*forward=*/true);
+        cursor->setRange(start, end);
+        cursors.push_back(std::move(cursor));
+        start = end;
+    }
     return cursors;
 }
 
@@ -1430,6 +2015,10 @@ void WiredTigerRecordStore::appendCustomStats(OperationContext* txn,
         result->appendIntOrLL("sleepCount", _cappedSleep.load());
         result->appendIntOrLL("sleepMS", _cappedSleepMS.load());
     }
+    if (_zoneMap) {
+        BSONObjBuilder zoneMap(result->subobjStart("zoneMap"));
+        _zoneMap->appendStats(&zoneMap);
+    }
     WiredTigerSession* session = WiredTigerRecoveryUnit::get(txn)->getSession(txn);
     WT_SESSION* s = session->getSession();
     BSONObjBuilder bob(result->subobjStart(kWiredTigerEngineName));
@@ -1559,6 +2148,7 @@ public:
     virtual void commit() {}
     virtual void rollback() {
         _rs->_numRecords.fetchAndAdd(-_diff);
+        _rs->_sizeInfoChanged();
     }
 
 private:
@@ -1570,6 +2160,7 @@ void WiredTigerRecordStore::_changeNumRecords(OperationContext* txn, int64_t dif
     txn->recoveryUnit()->registerChange(new NumRecordsChange(this, diff));
     if (_numRecords.fetchAndAdd(diff) < 0)
         _numRecords.store(std::max(diff, int64_t(0)));
+    _sizeInfoChanged();
 }
 
 class WiredTigerRecordStore::DataSizeChange : public RecoveryUnit::Change {
@@ -1591,9 +2182,14 @@ void WiredTigerRecordStore::_increaseDataSize(OperationContext* txn, int64_t amo
 
     if (_dataSize.fetchAndAdd(amount) < 0)
         _dataSize.store(std::max(amount, int64_t(0)));
+    _sizeInfoChanged();
+}
 
-    if (_sizeStorer && _sizeStorerCounter++ % 1000 == 0) {
-        _sizeStorer->storeToCache(_uri, _numRecords.load(), _dataSize.load());
+void WiredTigerRecordStore::_sizeInfoChanged() {
+    // Check before swapping so that writers to a collection that is already dirty do not all
+    // write to the same cache line.
+    if (_sizeStorer && _sizeInfoDirty.load() == 0 && _sizeInfoDirty.swap(1) == 0) {
+        _sizeStorer->onSizeInfoChanged(this);
     }
 }
 
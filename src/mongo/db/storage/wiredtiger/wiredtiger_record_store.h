@@ -51,6 +51,7 @@
 
 namespace mongo {
 
+class RecordZoneMap;
 class RecoveryUnit;
 class WiredTigerCursor;
 class WiredTigerRecoveryUnit;
@@ -123,6 +124,10 @@ public:
                                               const DocWriter* doc,
                                               bool enforceQuota);
 
+    virtual Status insertRecords(OperationContext* txn,
+                                 std::vector<Record>* records,
+                                 bool enforceQuota);
+
     virtual StatusWith<RecordId> updateRecord(OperationContext* txn,
                                               const RecordId& oldLocation,
                                               const char* data,
@@ -204,6 +209,20 @@ public:
         _sizeStorer = ss;
     }
 
+    /**
+     * Called by the size storer before it reads numRecords() and dataSize() to flush them, so
+     * that the next change reports this record store to it again.
+     */
+    void clearSizeInfoDirty() {
+        _sizeInfoDirty.store(0);
+    }
+
+    /**
+     * Starts maintaining 'zoneMap' for this record store, after noting every existing record in
+     * it. Must be called before the record store is used.
+     */
+    void setZoneMap(OperationContext* txn, std::unique_ptr<RecordZoneMap> zoneMap);
+
     void dealtWithCappedLoc(const RecordId& loc);
     bool isCappedHidden(const RecordId& loc) const;
     RecordId lowestCappedHiddenRecord() const;
@@ -223,6 +242,12 @@ public:
     // Returns false if the oplog was dropped while waiting for a deletion request.
     bool yieldAndAwaitOplogDeletionRequest(OperationContext* txn);
 
+    /**
+     * Appends statistics about the background truncation of the oplog, including how far it is
+     * lagging behind, for serverStatus.
+     */
+    static void appendOplogTruncationStats(BSONObjBuilder* b);
+
     class OplogStones;
 
     // Exposed only for testing.
@@ -240,6 +265,12 @@ private:
 
     static WiredTigerRecoveryUnit* _getRecoveryUnit(OperationContext* txn);
 
+    /**
+     * Holds up an oplog insert while the stones awaiting truncation by the background reclaim
+     * thread exceed the margin set by 'wiredTigerOplogTruncationBackpressurePercent'.
+     */
+    void _awaitOplogReclaimIfOverrun();
+
     static int64_t _makeKey(const RecordId& loc);
     static RecordId _fromKey(int64_t k);
 
@@ -250,6 +281,8 @@ private:
     bool cappedAndNeedDelete() const;
     void _changeNumRecords(OperationContext* txn, int64_t diff);
     void _increaseDataSize(OperationContext* txn, int64_t amount);
+    // Tells the size storer, once per flush, that numRecords or dataSize changed.
+    void _sizeInfoChanged();
     RecordData _getData(const WiredTigerCursor& cursor) const;
     StatusWith<RecordId> extractAndCheckLocForOplog(const char* data, int len);
     void _oplogSetStartHack(WiredTigerRecoveryUnit* wru) const;
@@ -285,12 +318,15 @@ private:
     AtomicInt64 _numRecords;
 
     WiredTigerSizeStorer* _sizeStorer;  // not owned, can be NULL
-    int _sizeStorerCounter;
+    AtomicInt32 _sizeInfoDirty;          // 1 if the size storer has been told of a change
 
     bool _shuttingDown;
 
     // Non-null if this record store is underlying the active oplog.
     std::shared_ptr<OplogStones> _oplogStones;
+
+    // Non-null if the collection was created with the 'zoneMap' storage option.
+    std::unique_ptr<RecordZoneMap> _zoneMap;
 };
 
 // WT failpoint to throw write conflict exceptions randomly
@@ -30,14 +30,20 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
+class BSONObj;
 class OperationContext;
 class RecordId;
 
@@ -49,6 +55,10 @@ public:
         int64_t records;      // Approximate number of records in a chunk of the oplog.
         int64_t bytes;        // Approximate size of records in a chunk of the oplog.
         RecordId lastRecord;  // RecordId of the last record in a chunk of the oplog.
+
+        // Namespaces of the operations in a chunk of the oplog, or null if they are not known.
+        // Only kept when wiredTigerOplogStonesTrackNamespaces is set.
+        std::shared_ptr<const std::set<std::string>> namespaces;
     };
 
     OplogStones(OperationContext* txn, WiredTigerRecordStore* rs);
@@ -63,6 +73,17 @@ public:
 
     void awaitHasExcessStonesOrDead();
 
+    // Waits until the oldest stone has been truncated, kill() is called, or 'timeout' elapses.
+    void awaitTruncation(Milliseconds timeout);
+
+    // Number of stones, and the bytes they hold, that are waiting to be truncated.
+    size_t numExcessStones() const;
+    int64_t excessBytes() const;
+
+    // The time at which the stones were first found to be in excess without having since been
+    // truncated back down to the number to keep, or Date_t() if there are no excess stones.
+    Date_t excessSince() const;
+
     boost::optional<OplogStones::Stone> peekOldestStoneIfNeeded() const;
 
     void popOldestStone();
@@ -75,6 +96,23 @@ public:
 
     void clearStonesOnCommit(OperationContext* txn);
 
+    bool tracksNamespaces() const {
+        return _trackNamespaces;
+    }
+
+    // Notes the namespace of the oplog entry 'doc' stored at 'id'. Must be called before the
+    // record can be seen by readers. Does nothing unless namespaces are tracked.
+    void noteRecord(const RecordId& id, const BSONObj& doc);
+
+    // Returns the last record of the run of consecutive stones, starting with the one holding
+    // 'id', known to contain no operations on 'ns', and adds the length of that run to
+    // '*stonesSkipped'. If the stone holding 'id' may contain such operations, returns a null
+    // RecordId instead and sets '*mayMatchThrough' to the last record of that stone.
+    RecordId lastRecordOfStonesWithout(const RecordId& id,
+                                       const std::string& ns,
+                                       int64_t* stonesSkipped,
+                                       RecordId* mayMatchThrough) const;
+
     // Updates the metadata about the oplog stones after a rollback occurs.
     void updateStonesAfterCappedTruncateAfter(int64_t recordsRemoved,
                                               int64_t bytesRemoved,
@@ -105,6 +143,8 @@ public:
 
     void setNumStonesToKeep(size_t numStones);
 
+    void setTrackNamespaces(bool trackNamespaces);
+
 private:
     class InsertChange;
     class TruncateChange;
@@ -117,12 +157,28 @@ private:
 
     void _pokeReclaimThreadIfNeeded();
 
+    void _noteRecord_inlock(const RecordId& id, const BSONObj& doc);
+
+    // Returns the namespaces for a new stone ending at 'lastRecord', and forgets those only seen
+    // in it.
+    std::shared_ptr<const std::set<std::string>> _takeCurrentNamespaces_inlock(
+        const RecordId& lastRecord);
+
     static const uint64_t kRandomSamplesPerStone = 10;
 
+    // Stones with operations on more namespaces than this don't keep them.
+    static const size_t kMaxNamespacesPerStone = 1000;
+
     WiredTigerRecordStore* _rs;
 
+    // Whether stones keep the namespaces of their operations. This value should not be changed
+    // after initialization.
+    bool _trackNamespaces;
+
     stdx::mutex _oplogReclaimMutex;
     stdx::condition_variable _oplogReclaimCv;
+    stdx::condition_variable _oplogTruncatedCv;  // Signaled after the oldest stone is popped.
+    uint64_t _numTruncatedStones = 0;            // Protected by '_oplogReclaimMutex'.
 
     // True if '_rs' has been destroyed, e.g. due to repairDatabase being called on the "local"
     // database, and false otherwise.
@@ -141,6 +197,15 @@ private:
 
     mutable stdx::mutex _mutex;  // Protects against concurrent access to the deque of oplog stones.
     std::deque<OplogStones::Stone> _stones;  // front = oldest, back = newest.
+    Date_t _excessSince;                     // Protected by '_mutex'.
+
+    // The highest RecordId seen for each namespace with operations in the stone being filled.
+    // Protected by '_mutex'.
+    std::map<std::string, RecordId> _currentNamespaces;
+
+    // The namespaces of records up to and including this one are unknown, e.g. because the stones
+    // were placed by sampling. Protected by '_mutex'.
+    RecordId _namespacesUnknownThrough;
 };
 
 }  // namespace mongo
@@ -39,14 +39,15 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/json.h"
 #include "mongo/db/operation_context_noop.h"
+#include "mongo/db/storage/record_zone_map.h"
 #include "mongo/db/storage/record_store_test_harness.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store_oplog_stones.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_record_store_test_harness.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_size_storer.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
-#include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -55,114 +56,6 @@ using std::unique_ptr;
 using std::string;
 using std::stringstream;
 
-class WiredTigerHarnessHelper final : public HarnessHelper {
-public:
-    static WT_CONNECTION* createConnection(StringData dbpath, StringData extraStrings) {
-        WT_CONNECTION* conn = NULL;
-
-        std::stringstream ss;
-        ss << "create,";
-        ss << "statistics=(all),";
-        ss << extraStrings;
-        string config = ss.str();
-        int ret = wiredtiger_open(dbpath.toString().c_str(), NULL, config.c_str(), &conn);
-        ASSERT_OK(wtRCToStatus(ret));
-        ASSERT(conn);
-
-        return conn;
-    }
-
-    WiredTigerHarnessHelper()
-        : _dbpath("wt_test"),
-          _conn(createConnection(_dbpath.path(), "")),
-          _sessionCache(new WiredTigerSessionCache(_conn)) {}
-
-    WiredTigerHarnessHelper(StringData extraStrings)
-        : _dbpath("wt_test"),
-          _conn(createConnection(_dbpath.path(), extraStrings)),
-          _sessionCache(new WiredTigerSessionCache(_conn)) {}
-
-    ~WiredTigerHarnessHelper() {
-        delete _sessionCache;
-        _conn->close(_conn, NULL);
-    }
-
-    virtual std::unique_ptr<RecordStore> newNonCappedRecordStore() {
-        return newNonCappedRecordStore("a.b");
-    }
-    std::unique_ptr<RecordStore> newNonCappedRecordStore(const std::string& ns) {
-        WiredTigerRecoveryUnit* ru = new WiredTigerRecoveryUnit(_sessionCache);
-        OperationContextNoop txn(ru);
-        string uri = "table:" + ns;
-
-        StatusWith<std::string> result =
-            WiredTigerRecordStore::generateCreateString(ns, CollectionOptions(), "");
-        ASSERT_TRUE(result.isOK());
-        std::string config = result.getValue();
-
-        {
-            WriteUnitOfWork uow(&txn);
-            WT_SESSION* s = ru->getSession(&txn)->getSession();
-            invariantWTOK(s->create(s, uri.c_str(), config.c_str()));
-            uow.commit();
-        }
-
-        return stdx::make_unique<WiredTigerRecordStore>(&txn, ns, uri);
-    }
-
-    std::unique_ptr<RecordStore> newCappedRecordStore(int64_t cappedSizeBytes,
-                                                      int64_t cappedMaxDocs) final {
-        return newCappedRecordStore("a.b", cappedSizeBytes, cappedMaxDocs);
-    }
-
-    std::unique_ptr<RecordStore> newCappedRecordStore(const std::string& ns,
-                                                      int64_t cappedMaxSize,
-                                                      int64_t cappedMaxDocs) {
-        WiredTigerRecoveryUnit* ru = new WiredTigerRecoveryUnit(_sessionCache);
-        OperationContextNoop txn(ru);
-        string uri = "table:a.b";
-
-        CollectionOptions options;
-        options.capped = true;
-
-        StatusWith<std::string> result =
-            WiredTigerRecordStore::generateCreateString(ns, options, "");
-        ASSERT_TRUE(result.isOK());
-        std::string config = result.getValue();
-
-        {
-            WriteUnitOfWork uow(&txn);
-            WT_SESSION* s = ru->getSession(&txn)->getSession();
-            invariantWTOK(s->create(s, uri.c_str(), config.c_str()));
-            uow.commit();
-        }
-
-        return stdx::make_unique<WiredTigerRecordStore>(
-            &txn, ns, uri, true, cappedMaxSize, cappedMaxDocs);
-    }
-
-    RecoveryUnit* newRecoveryUnit() final {
-        return new WiredTigerRecoveryUnit(_sessionCache);
-    }
-
-    bool supportsDocLocking() final {
-        return true;
-    }
-
-    WT_CONNECTION* conn() const {
-        return _conn;
-    }
-
-private:
-    unittest::TempDir _dbpath;
-    WT_CONNECTION* _conn;
-    WiredTigerSessionCache* _sessionCache;
-};
-
-std::unique_ptr<HarnessHelper> newHarnessHelper() {
-    return stdx::make_unique<WiredTigerHarnessHelper>();
-}
-
 TEST(WiredTigerRecordStoreTest, GenerateCreateStringEmptyDocument) {
     BSONObj spec = fromjson("{}");
     StatusWith<std::string> result = WiredTigerRecordStore::parseOptionsField(spec);
@@ -380,6 +273,41 @@ TEST(WiredTigerRecordStoreTest, SizeStorer1) {
     rs.reset(NULL);  // this has to be deleted before ss
 }
 
+TEST(WiredTigerRecordStoreTest, SizeStorerSyncsOnlyDirtyEntries) {
+    unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+    const string sizeStorerUri = "table:sizeStorer";
+    const size_t batch = WiredTigerSizeStorer::kEntriesPerTransaction;
+    const size_t numEntries = batch * 2 + 10;
+
+    WiredTigerSizeStorer ss(harnessHelper->conn(), sizeStorerUri);
+    for (size_t i = 0; i < numEntries; i++) {
+        ss.storeToCache("table:coll" + std::to_string(i), i, i * 10);
+    }
+    ASSERT_EQUALS(numEntries, ss.numDirty());
+
+    // Changing an entry that is already queued does not queue it twice.
+    ss.storeToCache("table:coll0", 1, 10);
+    ASSERT_EQUALS(numEntries, ss.numDirty());
+
+    ASSERT_EQUALS(batch + 5, ss.syncSome(batch + 5));
+    ASSERT_EQUALS(numEntries - batch - 5, ss.numDirty());
+
+    ss.syncCache(false);
+    ASSERT_EQUALS(0U, ss.numDirty());
+    ASSERT_EQUALS(0U, ss.syncSome(batch));
+
+    WiredTigerSizeStorer ss2(harnessHelper->conn(), sizeStorerUri);
+    ss2.fillCache();
+    long long numRecords;
+    long long dataSize;
+    ss2.loadFromCache("table:coll0", &numRecords, &dataSize);
+    ASSERT_EQUALS(1, numRecords);
+    ASSERT_EQUALS(10, dataSize);
+    ss2.loadFromCache("table:coll" + std::to_string(numEntries - 1), &numRecords, &dataSize);
+    ASSERT_EQUALS(static_cast<long long>(numEntries - 1), numRecords);
+    ASSERT_EQUALS(0U, ss2.numDirty());
+}
+
 namespace {
 
 class GoodValidateAdaptor : public ValidateAdaptor {
@@ -1278,6 +1206,60 @@ TEST(WiredTigerRecordStoreTest, OplogStones_ReclaimStones) {
     }
 }
 
+// Verify that the stones awaiting truncation are reported until the oplog is reclaimed.
+TEST(WiredTigerRecordStoreTest, OplogStones_ExcessStones) {
+    WiredTigerHarnessHelper harnessHelper;
+
+    const int64_t cappedMaxSize = 10 * 1024;  // 10KB
+    unique_ptr<RecordStore> rs(
+        harnessHelper.newCappedRecordStore("local.oplog.stones", cappedMaxSize, -1));
+
+    WiredTigerRecordStore* wtrs = static_cast<WiredTigerRecordStore*>(rs.get());
+    WiredTigerRecordStore::OplogStones* oplogStones = wtrs->oplogStones();
+
+    oplogStones->setMinBytesPerStone(100);
+    oplogStones->setNumStonesToKeep(2U);
+
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 1), 100), RecordId(1, 1));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 2), 110), RecordId(1, 2));
+
+        ASSERT_EQ(0U, oplogStones->numExcessStones());
+        ASSERT_EQ(0, oplogStones->excessBytes());
+        ASSERT_EQ(Date_t(), oplogStones->excessSince());
+    }
+
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 3), 120), RecordId(1, 3));
+        ASSERT_EQ(insertBSONWithSize(opCtx.get(), rs.get(), Timestamp(1, 4), 130), RecordId(1, 4));
+
+        ASSERT_EQ(2U, oplogStones->numExcessStones());
+        ASSERT_EQ(210, oplogStones->excessBytes());
+        ASSERT_NOT_EQUALS(Date_t(), oplogStones->excessSince());
+
+        BSONObjBuilder builder;
+        WiredTigerRecordStore::appendOplogTruncationStats(&builder);
+        BSONObj stats = builder.obj();
+        ASSERT_EQ(2, stats["lag"]["stones"].numberLong());
+        ASSERT_EQ(210, stats["lag"]["bytes"].numberLong());
+    }
+
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+
+        wtrs->reclaimOplog(opCtx.get());
+
+        ASSERT_EQ(2U, oplogStones->numStones());
+        ASSERT_EQ(0U, oplogStones->numExcessStones());
+        ASSERT_EQ(0, oplogStones->excessBytes());
+        ASSERT_EQ(Date_t(), oplogStones->excessSince());
+    }
+}
+
 // Verify that oplog stones are not reclaimed even if the size of the record store exeeds
 // 'cappedMaxSize'.
 TEST(WiredTigerRecordStoreTest, OplogStones_ExceedCappedMaxSize) {
@@ -1322,4 +1304,124 @@ TEST(WiredTigerRecordStoreTest, OplogStones_ExceedCappedMaxSize) {
     }
 }
 
+StatusWith<RecordId> insertOplogEntryWithSize(OperationContext* opCtx,
+                                              RecordStore* rs,
+                                              const Timestamp& opTime,
+                                              StringData ns,
+                                              int size) {
+    BSONObj objTemplate = BSON("ts" << opTime << "ns" << ns << "str"
+                                    << "");
+    ASSERT_LTE(objTemplate.objsize(), size);
+    BSONObj obj = BSON("ts" << opTime << "ns" << ns << "str"
+                            << std::string(size - objTemplate.objsize(), 'x'));
+
+    WriteUnitOfWork wuow(opCtx);
+    WiredTigerRecordStore* wtrs = checked_cast<WiredTigerRecordStore*>(rs);
+    Status status = wtrs->oplogDiskLocRegister(opCtx, opTime);
+    if (!status.isOK()) {
+        return StatusWith<RecordId>(status);
+    }
+    StatusWith<RecordId> res = rs->insertRecord(opCtx, obj.objdata(), obj.objsize(), false);
+    if (res.isOK()) {
+        wuow.commit();
+    }
+    return res;
+}
+
+std::shared_ptr<const ZoneMapPredicate> makeNsPredicate(StringData ns) {
+    auto predicate = std::make_shared<ZoneMapPredicate>();
+    BSONObj holder = BSON("" << ns);
+    predicate->addComparison("ns", ZoneMapPredicate::Op::kEQ, holder.firstElement());
+    return std::move(predicate);
+}
+
+// Verify that stones keep the namespaces of their operations when asked to, and that forward scans
+// looking for a single namespace skip the stones without it.
+TEST(WiredTigerRecordStoreTest, OplogStones_SkipStonesWithoutNamespace) {
+    WiredTigerHarnessHelper harnessHelper;
+
+    const int64_t cappedMaxSize = 10 * 1024;  // 10KB
+    unique_ptr<RecordStore> rs(
+        harnessHelper.newCappedRecordStore("local.oplog.stones", cappedMaxSize, -1));
+
+    WiredTigerRecordStore* wtrs = static_cast<WiredTigerRecordStore*>(rs.get());
+    WiredTigerRecordStore::OplogStones* oplogStones = wtrs->oplogStones();
+
+    oplogStones->setMinBytesPerStone(100);
+    oplogStones->setTrackNamespaces(true);
+
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+
+        const char* namespaces[] = {"test.a", "test.a", "test.b", "test.b", "test.a", "test.b"};
+        for (int i = 0; i < 6; ++i) {
+            ASSERT_EQ(insertOplogEntryWithSize(
+                          opCtx.get(), rs.get(), Timestamp(1, i + 1), namespaces[i], 50),
+                      RecordId(1, i + 1));
+        }
+        ASSERT_EQ(insertOplogEntryWithSize(opCtx.get(), rs.get(), Timestamp(1, 7), "test.c", 50),
+                  RecordId(1, 7));
+
+        // Stones end at (1, 2), (1, 4) and (1, 6).
+        ASSERT_EQ(3U, oplogStones->numStones());
+        ASSERT_EQ(1, oplogStones->currentRecords());
+    }
+
+    {
+        int64_t stonesSkipped = 0;
+        RecordId mayMatchThrough;
+        ASSERT_EQ(RecordId(1, 4),
+                  oplogStones->lastRecordOfStonesWithout(
+                      RecordId(1, 3), "test.a", &stonesSkipped, &mayMatchThrough));
+        ASSERT_EQ(1, stonesSkipped);
+
+        ASSERT_EQ(RecordId(),
+                  oplogStones->lastRecordOfStonesWithout(
+                      RecordId(1, 1), "test.a", &stonesSkipped, &mayMatchThrough));
+        ASSERT_EQ(RecordId(1, 2), mayMatchThrough);
+
+        ASSERT_EQ(RecordId(1, 6),
+                  oplogStones->lastRecordOfStonesWithout(
+                      RecordId(1, 1), "test.c", &stonesSkipped, &mayMatchThrough));
+        ASSERT_EQ(4, stonesSkipped);
+
+        // The records of the stone being filled are never skipped.
+        ASSERT_EQ(RecordId(),
+                  oplogStones->lastRecordOfStonesWithout(
+                      RecordId(1, 7), "test.d", &stonesSkipped, &mayMatchThrough));
+        ASSERT_EQ(RecordId::max(), mayMatchThrough);
+    }
+
+    {
+        unique_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+
+        auto scan = [&](StringData ns) {
+            std::vector<RecordId> ids;
+            auto cursor = rs->getCursor(opCtx.get());
+            cursor->setZoneMapPredicate(makeNsPredicate(ns));
+            while (auto record = cursor->next()) {
+                ids.push_back(record->id);
+            }
+            return ids;
+        };
+
+        BSONObjBuilder before;
+        WiredTigerRecordStore::appendOplogTruncationStats(&before);
+        const long long skippedBefore = before.obj()["stonesSkippedByNamespace"].numberLong();
+
+        const std::vector<RecordId> expectedA = {
+            RecordId(1, 1), RecordId(1, 2), RecordId(1, 5), RecordId(1, 6), RecordId(1, 7)};
+        ASSERT(expectedA == scan("test.a"));
+        const std::vector<RecordId> expectedB = {
+            RecordId(1, 3), RecordId(1, 4), RecordId(1, 5), RecordId(1, 6), RecordId(1, 7)};
+        ASSERT(expectedB == scan("test.b"));
+        const std::vector<RecordId> expectedC = {RecordId(1, 7)};
+        ASSERT(expectedC == scan("test.c"));
+
+        BSONObjBuilder after;
+        WiredTigerRecordStore::appendOplogTruncationStats(&after);
+        ASSERT_EQ(skippedBefore + 5, after.obj()["stonesSkippedByNamespace"].numberLong());
+    }
+}
+
 }  // namespace mongo
@@ -0,0 +1,141 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_record_store_test_harness.h"
+
+#include <sstream>
+
+#include "mongo/db/operation_context_noop.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+
+using std::string;
+
+WT_CONNECTION* WiredTigerHarnessHelper::createConnection(StringData dbpath,
+                                                         StringData extraStrings) {
+    WT_CONNECTION* conn = NULL;
+
+    std::stringstream ss;
+    ss << "create,";
+    ss << "statistics=(all),";
+    ss << extraStrings;
+    string config = ss.str();
+    int ret = wiredtiger_open(dbpath.toString().c_str(), NULL, config.c_str(), &conn);
+    ASSERT_OK(wtRCToStatus(ret));
+    ASSERT(conn);
+
+    return conn;
+}
+
+WiredTigerHarnessHelper::WiredTigerHarnessHelper()
+    : _dbpath("wt_test"),
+      _conn(createConnection(_dbpath.path(), "")),
+      _sessionCache(new WiredTigerSessionCache(_conn)) {}
+
+WiredTigerHarnessHelper::WiredTigerHarnessHelper(StringData extraStrings)
+    : _dbpath("wt_test"),
+      _conn(createConnection(_dbpath.path(), extraStrings)),
+      _sessionCache(new WiredTigerSessionCache(_conn)) {}
+
+WiredTigerHarnessHelper::~WiredTigerHarnessHelper() {
+    delete _sessionCache;
+    _conn->close(_conn, NULL);
+}
+
+std::unique_ptr<RecordStore> WiredTigerHarnessHelper::newNonCappedRecordStore() {
+    return newNonCappedRecordStore("a.b");
+}
+
+std::unique_ptr<RecordStore> WiredTigerHarnessHelper::newNonCappedRecordStore(
+    const std::string& ns) {
+    WiredTigerRecoveryUnit* ru = new WiredTigerRecoveryUnit(_sessionCache);
+    OperationContextNoop txn(ru);
+    string uri = "table:" + ns;
+
+    StatusWith<std::string> result =
+        WiredTigerRecordStore::generateCreateString(ns, CollectionOptions(), "");
+    ASSERT_TRUE(result.isOK());
+    std::string config = result.getValue();
+
+    {
+        WriteUnitOfWork uow(&txn);
+        WT_SESSION* s = ru->getSession(&txn)->getSession();
+        invariantWTOK(s->create(s, uri.c_str(), config.c_str()));
+        uow.commit();
+    }
+
+    return stdx::make_unique<WiredTigerRecordStore>(&txn, ns, uri);
+}
+
+std::unique_ptr<RecordStore> WiredTigerHarnessHelper::newCappedRecordStore(
+    int64_t cappedSizeBytes, int64_t cappedMaxDocs) {
+    return newCappedRecordStore("a.b", cappedSizeBytes, cappedMaxDocs);
+}
+
+std::unique_ptr<RecordStore> WiredTigerHarnessHelper::newCappedRecordStore(const std::string& ns,
+                                                                           int64_t cappedMaxSize,
+                                                                           int64_t cappedMaxDocs) {
+    WiredTigerRecoveryUnit* ru = new WiredTigerRecoveryUnit(_sessionCache);
+    OperationContextNoop txn(ru);
+    string uri = "table:a.b";
+
+    CollectionOptions options;
+    options.capped = true;
+
+    StatusWith<std::string> result = WiredTigerRecordStore::generateCreateString(ns, options, "");
+    ASSERT_TRUE(result.isOK());
+    std::string config = result.getValue();
+
+    {
+        WriteUnitOfWork uow(&txn);
+        WT_SESSION* s = ru->getSession(&txn)->getSession();
+        invariantWTOK(s->create(s, uri.c_str(), config.c_str()));
+        uow.commit();
+    }
+
+    return stdx::make_unique<WiredTigerRecordStore>(
+        &txn, ns, uri, true, cappedMaxSize, cappedMaxDocs);
+}
+
+RecoveryUnit* WiredTigerHarnessHelper::newRecoveryUnit() {
+    return new WiredTigerRecoveryUnit(_sessionCache);
+}
+
+std::unique_ptr<HarnessHelper> newHarnessHelper() {
+    return stdx::make_unique<WiredTigerHarnessHelper>();
+}
+
+}  // namespace mongo
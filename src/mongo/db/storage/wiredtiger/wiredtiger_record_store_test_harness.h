@@ -0,0 +1,80 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <wiredtiger.h>
+
+#include "mongo/base/string_data.h"
+#include "mongo/db/storage/record_store_test_harness.h"
+#include "mongo/unittest/temp_dir.h"
+
+namespace mongo {
+
+class WiredTigerSessionCache;
+
+/**
+ * The HarnessHelper of the record store tests and benchmarks of WiredTiger, with a connection to a
+ * temporary directory.
+ */
+class WiredTigerHarnessHelper final : public HarnessHelper {
+public:
+    static WT_CONNECTION* createConnection(StringData dbpath, StringData extraStrings);
+
+    WiredTigerHarnessHelper();
+    WiredTigerHarnessHelper(StringData extraStrings);
+    ~WiredTigerHarnessHelper();
+
+    std::unique_ptr<RecordStore> newNonCappedRecordStore() final;
+    std::unique_ptr<RecordStore> newNonCappedRecordStore(const std::string& ns);
+
+    std::unique_ptr<RecordStore> newCappedRecordStore(int64_t cappedSizeBytes,
+                                                      int64_t cappedMaxDocs) final;
+    std::unique_ptr<RecordStore> newCappedRecordStore(const std::string& ns,
+                                                      int64_t cappedMaxSize,
+                                                      int64_t cappedMaxDocs);
+
+    RecoveryUnit* newRecoveryUnit() final;
+
+    bool supportsDocLocking() final {
+        return true;
+    }
+
+    WT_CONNECTION* conn() const {
+        return _conn;
+    }
+
+private:
+    unittest::TempDir _dbpath;
+    WT_CONNECTION* _conn;
+    WiredTigerSessionCache* _sessionCache;
+};
+
+}  // namespace mongo
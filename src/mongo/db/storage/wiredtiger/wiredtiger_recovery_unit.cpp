@@ -34,9 +34,11 @@
 #include "mongo/base/init.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_controller.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
@@ -105,10 +107,24 @@ void WiredTigerRecoveryUnit::reportState(BSONObjBuilder* b) const {
         b->append("wt_millisSinceCommit", _timer.millis());
 }
 
+void WiredTigerRecoveryUnit::appendOperationStats(BSONObjBuilder* b) const {
+    if (_opStats.transactions == 0 && _opStats.durableWaitMicros == 0)
+        return;
+
+    b->appendNumber("transactions", _opStats.transactions);
+    b->appendNumber("ticketWaitMicros", _opStats.ticketWaitMicros);
+    b->appendNumber("cacheWaitMicros", _opStats.cacheWaitMicros);
+    b->appendNumber("commitMicros", _opStats.commitMicros);
+    b->appendNumber("durableWaitMicros", _opStats.durableWaitMicros);
+    b->appendNumber("bytesRead", _opStats.bytesRead);
+    b->appendNumber("bytesWritten", _opStats.bytesWritten);
+}
+
 void WiredTigerRecoveryUnit::prepareForCreateSnapshot(OperationContext* opCtx) {
     invariant(!_active);  // Can't already be in a WT transaction.
     invariant(!_inUnitOfWork);
     invariant(!_readFromMajorityCommittedSnapshot);
+    invariant(_maxStaleness == Milliseconds(0));
 
     // Starts the WT transaction that will be the basis for creating a named snapshot.
     getSession(opCtx);
@@ -157,8 +173,13 @@ void WiredTigerRecoveryUnit::beginUnitOfWork(OperationContext* opCtx) {
     invariant(!_areWriteUnitOfWorksBanned);
     invariant(!_inUnitOfWork);
     invariant(!_currentlySquirreled);
-    _inUnitOfWork = true;
     _everStartedWrite = true;
+    if (_onSharedSnapshot) {
+        // Writes must be based on the latest data. Retrying after abandoning the snapshot opens a
+        // regular transaction, since the operation has now started writing.
+        throw WriteConflictException();
+    }
+    _inUnitOfWork = true;
     _getTicket(opCtx);
 }
 
@@ -188,7 +209,9 @@ bool WiredTigerRecoveryUnit::waitUntilDurable() {
         // we did a sync, so we're good
         return true;
     }
+    Timer waitTimer;
     waitUntilDurableData.waitUntilDurable();
+    _opStats.durableWaitMicros += waitTimer.micros();
     return true;
 }
 
@@ -277,6 +300,37 @@ TicketServerParameter openWriteTransactionParam(&openWriteTransaction,
 TicketHolder openReadTransaction(128);
 TicketServerParameter openReadTransactionParam(&openReadTransaction,
                                                "wiredTigerConcurrentReadTransactions");
+
+WiredTigerTicketPoolStats writeTransactionStats;
+WiredTigerTicketPoolStats readTransactionStats;
+
+// Operations which first acquired a ticket longer ago than this queue for tickets with low
+// priority, behind the short ones. 0 disables this.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerLowPriorityTicketsAfterMillis, int, 0);
+
+void appendQueueDepth(const TicketHolder& holder, BSONObjBuilder* builder) {
+    BSONObjBuilder queueDepth(builder->subobjStart("queueDepth"));
+    for (int i = 0; i < TicketHolder::kNumPriorities; i++) {
+        const TicketHolder::Priority priority = static_cast<TicketHolder::Priority>(i);
+        queueDepth.append(TicketHolder::priorityName(priority), holder.waiting(priority));
+    }
+}
+}
+
+TicketHolder* WiredTigerRecoveryUnit::getReadTicketHolder() {
+    return &openReadTransaction;
+}
+
+TicketHolder* WiredTigerRecoveryUnit::getWriteTicketHolder() {
+    return &openWriteTransaction;
+}
+
+WiredTigerTicketPoolStats* WiredTigerRecoveryUnit::getReadTicketStats() {
+    return &readTransactionStats;
+}
+
+WiredTigerTicketPoolStats* WiredTigerRecoveryUnit::getWriteTicketStats() {
+    return &writeTransactionStats;
 }
 
 void WiredTigerRecoveryUnit::appendGlobalStats(BSONObjBuilder& b) {
@@ -286,6 +340,8 @@ void WiredTigerRecoveryUnit::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("out", openWriteTransaction.used());
         bbb.append("available", openWriteTransaction.available());
         bbb.append("totalTickets", openWriteTransaction.outof());
+        bbb.appendNumber("queued", static_cast<long long>(writeTransactionStats.queued.load()));
+        appendQueueDepth(openWriteTransaction, &bbb);
         bbb.done();
     }
     {
@@ -293,8 +349,11 @@ void WiredTigerRecoveryUnit::appendGlobalStats(BSONObjBuilder& b) {
         bbb.append("out", openReadTransaction.used());
         bbb.append("available", openReadTransaction.available());
         bbb.append("totalTickets", openReadTransaction.outof());
+        bbb.appendNumber("queued", static_cast<long long>(readTransactionStats.queued.load()));
+        appendQueueDepth(openReadTransaction, &bbb);
         bbb.done();
     }
+    WiredTigerTicketController::appendStats(&bb);
     bb.done();
 }
 
@@ -302,7 +361,9 @@ void WiredTigerRecoveryUnit::_txnClose(bool commit) {
     invariant(_active);
     WT_SESSION* s = _session->getSession();
     if (commit) {
+        Timer commitTimer;
         invariantWTOK(s->commit_transaction(s, NULL));
+        _opStats.commitMicros += commitTimer.micros();
         LOG(2) << "WT commit_transaction";
         if (_syncing)
             waitUntilDurableData.syncHappend();
@@ -311,7 +372,12 @@ void WiredTigerRecoveryUnit::_txnClose(bool commit) {
         LOG(2) << "WT rollback_transaction";
     }
     _active = false;
+    _onSharedSnapshot = false;
     _myTransactionCount++;
+    if (_ticket.hasTicket()) {
+        _ticketStats->completed.fetchAndAdd(1);
+        _ticketStats->latencyMicros.fetchAndAdd(_timer.micros());
+    }
     _ticket.reset(NULL);
 }
 
@@ -338,6 +404,52 @@ boost::optional<SnapshotName> WiredTigerRecoveryUnit::getMajorityCommittedSnapsh
     return _majorityCommittedSnapshot;
 }
 
+Status WiredTigerRecoveryUnit::setReadFromStaleSnapshot(Milliseconds maxStaleness) {
+    invariant(maxStaleness > Milliseconds(0));
+    if (_readFromMajorityCommittedSnapshot) {
+        return {ErrorCodes::BadValue,
+                "Cannot read from a stale snapshot while reading from the committed snapshot"};
+    }
+
+    _maxStaleness = maxStaleness;
+    return Status::OK();
+}
+
+Status WiredTigerRecoveryUnit::setReadFromLastAppliedSnapshot(
+    const boost::optional<SnapshotName>& minSnapshot) {
+    if (_readFromMajorityCommittedSnapshot) {
+        return {ErrorCodes::BadValue,
+                "Cannot read from the last applied snapshot while reading from the committed "
+                "snapshot"};
+    }
+
+    if (_active) {
+        // The open transaction may already have read data that is newer than the snapshot.
+        return {ErrorCodes::BadValue,
+                "Cannot start reading from the last applied snapshot in an open transaction"};
+    }
+
+    auto snapshotName = _sessionCache->snapshotManager().getNewestSnapshot();
+    if (!snapshotName) {
+        return {ErrorCodes::ReadConcernMajorityNotAvailableYet,
+                "There is no snapshot of the last applied batch"};
+    }
+    if (minSnapshot && *snapshotName < *minSnapshot) {
+        return {ErrorCodes::ReadConcernMajorityNotAvailableYet,
+                "The snapshot of the last applied batch predates the catalog"};
+    }
+
+    _lastAppliedSnapshot = *snapshotName;
+    _readFromLastAppliedSnapshot = true;
+    return Status::OK();
+}
+
+boost::optional<SnapshotName> WiredTigerRecoveryUnit::getLastAppliedSnapshot() const {
+    if (!_readFromLastAppliedSnapshot)
+        return {};
+    return _lastAppliedSnapshot;
+}
+
 void WiredTigerRecoveryUnit::markNoTicketRequired() {
     invariant(!_ticket.hasTicket());
     _noTicketNeeded = true;
@@ -363,9 +475,28 @@ void WiredTigerRecoveryUnit::_getTicket(OperationContext* opCtx) {
     }
 
     TicketHolder* holder = writeLocked ? &openWriteTransaction : &openReadTransaction;
+    WiredTigerTicketPoolStats* stats = writeLocked ? &writeTransactionStats : &readTransactionStats;
+    const int lowPriorityAfterMillis = wiredTigerLowPriorityTicketsAfterMillis;
+
+    if (!holder->tryAcquire()) {
+        TicketHolder::Priority priority =
+            opCtx ? opCtx->getTicketPriority() : TicketHolder::Priority::kNormal;
+        if (lowPriorityAfterMillis > 0 && _firstTicketMillis != 0 &&
+            curTimeMillis64() - _firstTicketMillis >
+                static_cast<unsigned long long>(lowPriorityAfterMillis)) {
+            priority = TicketHolder::Priority::kLow;
+        }
 
-    holder->waitForTicket();
+        stats->queued.fetchAndAdd(1);
+        Timer waitTimer;
+        holder->waitForTicket(priority);
+        _opStats.ticketWaitMicros += waitTimer.micros();
+    }
+    if (lowPriorityAfterMillis > 0 && _firstTicketMillis == 0) {
+        _firstTicketMillis = curTimeMillis64();
+    }
     _ticket.reset(holder);
+    _ticketStats = stats;
 }
 
 void WiredTigerRecoveryUnit::_txnOpen(OperationContext* opCtx) {
@@ -375,12 +506,23 @@ void WiredTigerRecoveryUnit::_txnOpen(OperationContext* opCtx) {
     WT_SESSION* s = _session->getSession();
     _syncing = _syncing || waitUntilDurableData.numWaitingForSync.load() > 0;
 
+    Timer beginTimer;
     if (_readFromMajorityCommittedSnapshot) {
         _majorityCommittedSnapshot =
             _sessionCache->snapshotManager().beginTransactionOnCommittedSnapshot(s, _syncing);
+    } else if (_readFromLastAppliedSnapshot && !_everStartedWrite) {
+        _lastAppliedSnapshot =
+            _sessionCache->snapshotManager().beginTransactionOnNewestSnapshot(s, _syncing);
+        _onSharedSnapshot = true;
+    } else if (_maxStaleness > Milliseconds(0) && !_everStartedWrite) {
+        _sessionCache->snapshotManager().beginTransactionOnStaleSnapshot(
+            s, _maxStaleness, _syncing);
+        _onSharedSnapshot = true;
     } else {
         invariantWTOK(s->begin_transaction(s, _syncing ? "sync=true" : NULL));
     }
+    _opStats.cacheWaitMicros += beginTimer.micros();
+    _opStats.transactions++;
 
     LOG(2) << "WT begin_transaction";
     _timer.reset();
@@ -48,6 +48,7 @@ namespace mongo {
 class BSONObjBuilder;
 class WiredTigerSession;
 class WiredTigerSessionCache;
+struct WiredTigerTicketPoolStats;
 
 class WiredTigerRecoveryUnit final : public RecoveryUnit {
 public:
@@ -57,6 +58,8 @@ public:
 
     virtual void reportState(BSONObjBuilder* b) const;
 
+    void appendOperationStats(BSONObjBuilder* b) const override;
+
     void beginUnitOfWork(OperationContext* opCtx) final;
     void commitUnitOfWork() final;
     void abortUnitOfWork() final;
@@ -84,6 +87,13 @@ public:
 
     boost::optional<SnapshotName> getMajorityCommittedSnapshot() const final;
 
+    Status setReadFromStaleSnapshot(Milliseconds maxStaleness) final;
+
+    Status setReadFromLastAppliedSnapshot(
+        const boost::optional<SnapshotName>& minSnapshot) final;
+
+    boost::optional<SnapshotName> getLastAppliedSnapshot() const final;
+
     // ---- WT STUFF
 
     WiredTigerSession* getSession(OperationContext* opCtx);
@@ -106,10 +116,30 @@ public:
 
     void markNoTicketRequired();
 
+    /**
+     * Account the bytes of the records read and written through this recovery unit, reported by
+     * appendOperationStats().
+     */
+    void noteBytesRead(long long bytes) {
+        _opStats.bytesRead += bytes;
+    }
+    void noteBytesWritten(long long bytes) {
+        _opStats.bytesWritten += bytes;
+    }
+
     static WiredTigerRecoveryUnit* get(OperationContext* txn);
 
     static void appendGlobalStats(BSONObjBuilder& b);
 
+    /**
+     * The ticket pools that bound the number of concurrent read and write transactions, and the
+     * counters kept for them. Used by WiredTigerTicketController to size the pools at runtime.
+     */
+    static TicketHolder* getReadTicketHolder();
+    static TicketHolder* getWriteTicketHolder();
+    static WiredTigerTicketPoolStats* getReadTicketStats();
+    static WiredTigerTicketPoolStats* getWriteTicketStats();
+
     /**
      * Prepares this RU to be the basis for a named snapshot.
      *
@@ -139,6 +169,12 @@ private:
     RecordId _oplogReadTill;
     bool _readFromMajorityCommittedSnapshot = false;
     SnapshotName _majorityCommittedSnapshot = SnapshotName::min();
+    bool _readFromLastAppliedSnapshot = false;
+    SnapshotName _lastAppliedSnapshot = SnapshotName::min();
+    Milliseconds _maxStaleness{0};  // 0 unless reads may use a shared, possibly stale snapshot.
+    // The active transaction is on a snapshot shared with other readers: the stale snapshot or
+    // the newest named snapshot.
+    bool _onSharedSnapshot = false;
 
     typedef OwnedPointerVector<Change> Changes;
     Changes _changes;
@@ -146,6 +182,26 @@ private:
     bool _noTicketNeeded;
     void _getTicket(OperationContext* opCtx);
     TicketHolderReleaser _ticket;
+    WiredTigerTicketPoolStats* _ticketStats = nullptr;  // Stats of the pool _ticket came from.
+    // When this recovery unit first acquired a ticket, only tracked while tickets of long running
+    // operations are deprioritized, or 0.
+    unsigned long long _firstTicketMillis = 0;
+
+    // Time spent by this recovery unit in the places where WT can stall an operation, reported
+    // through appendOperationStats(). WT does not keep per-session statistics, so these are
+    // measured around the calls that can block.
+    struct OperationStats {
+        long long transactions = 0;
+        long long ticketWaitMicros = 0;
+        // begin_transaction is where an application thread does eviction work when the cache
+        // is full, so this is mostly time stalled on cache pressure.
+        long long cacheWaitMicros = 0;
+        long long commitMicros = 0;  // Log writes, and syncs for transactions that need them.
+        long long durableWaitMicros = 0;
+        long long bytesRead = 0;
+        long long bytesWritten = 0;
+    };
+    OperationStats _opStats;
 };
 
 /**
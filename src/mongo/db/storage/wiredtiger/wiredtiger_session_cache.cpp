@@ -33,11 +33,16 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
@@ -112,6 +117,18 @@ void WiredTigerSession::closeAllCursors() {
 
 namespace {
 AtomicUInt64 nextTableId(1);
+
+// Threads are assigned to session cache shards round-robin, the first time they use one.
+AtomicUInt32 nextShardAssignment;
+MONGO_TRIVIALLY_CONSTRUCTIBLE_THREAD_LOCAL unsigned shardAssignment;
+MONGO_TRIVIALLY_CONSTRUCTIBLE_THREAD_LOCAL bool hasShardAssignment;
+
+const size_t kMaxShards = 64;
+
+size_t numShards() {
+    ProcessInfo p;
+    return std::max<size_t>(1, std::min<size_t>(kMaxShards, p.getNumCores()));
+}
 }
 // static
 uint64_t WiredTigerSession::genTableId() {
@@ -121,10 +138,17 @@ uint64_t WiredTigerSession::genTableId() {
 // -----------------------
 
 WiredTigerSessionCache::WiredTigerSessionCache(WiredTigerKVEngine* engine)
-    : _engine(engine), _conn(engine->getConnection()), _snapshotManager(_conn), _shuttingDown(0) {}
+    : WiredTigerSessionCache(engine->getConnection()) {
+    _engine = engine;
+}
 
 WiredTigerSessionCache::WiredTigerSessionCache(WT_CONNECTION* conn)
-    : _engine(NULL), _conn(conn), _snapshotManager(_conn), _shuttingDown(0) {}
+    : _engine(NULL), _conn(conn), _snapshotManager(_conn), _shuttingDown(0) {
+    const size_t shards = numShards();
+    for (size_t i = 0; i < shards; i++) {
+        _shards.push_back(stdx::make_unique<Shard>());
+    }
+}
 
 WiredTigerSessionCache::~WiredTigerSessionCache() {
     shuttingDown();
@@ -152,18 +176,43 @@ void WiredTigerSessionCache::shuttingDown() {
 }
 
 void WiredTigerSessionCache::closeAll() {
-    // Increment the epoch as we are now closing all sessions with this epoch
-    SessionCache swap;
+    // Increment the epoch as we are now closing all sessions with this epoch. Sessions released
+    // into a shard after it has been emptied below see the new epoch and are not cached.
+    _epoch.fetchAndAdd(1);
+
+    for (auto&& shard : _shards) {
+        SessionCache swap;
+        {
+            stdx::lock_guard<stdx::mutex> lock(shard->lock);
+            shard->sessions.swap(swap);
+            shard->numSessions.store(0);
+        }
 
-    {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-        _epoch.fetchAndAdd(1);
-        _sessions.swap(swap);
+        for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
+            delete (*i);
+        }
     }
+}
 
-    for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
-        delete (*i);
+WiredTigerSessionCache::Shard& WiredTigerSessionCache::_myShard() {
+    if (!hasShardAssignment) {
+        shardAssignment = nextShardAssignment.fetchAndAdd(1);
+        hasShardAssignment = true;
     }
+    return *_shards[shardAssignment % _shards.size()];
+}
+
+WiredTigerSession* WiredTigerSessionCache::_popSession(Shard& shard) {
+    stdx::lock_guard<stdx::mutex> lock(shard.lock);
+    if (shard.sessions.empty())
+        return nullptr;
+
+    // Get the most recently used session so that if we discard sessions, we're
+    // discarding older ones
+    WiredTigerSession* cachedSession = shard.sessions.back();
+    shard.sessions.pop_back();
+    shard.numSessions.store(shard.sessions.size());
+    return cachedSession;
 }
 
 WiredTigerSession* WiredTigerSessionCache::getSession() {
@@ -171,18 +220,24 @@ WiredTigerSession* WiredTigerSessionCache::getSession() {
     // operations should be allowed to start.
     invariant(!(_shuttingDown.loadRelaxed() & kShuttingDownMask));
 
-    {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-        if (!_sessions.empty()) {
-            // Get the most recently used session so that if we discard sessions, we're
-            // discarding older ones
-            WiredTigerSession* cachedSession = _sessions.back();
-            _sessions.pop_back();
-            return cachedSession;
+    Shard& myShard = _myShard();
+    if (WiredTigerSession* session = _popSession(myShard)) {
+        myShard.hits.fetchAndAdd(1);
+        return session;
+    }
+
+    // Steal from the other shards, skipping the ones that look empty without taking their locks.
+    for (auto&& shard : _shards) {
+        if (shard.get() == &myShard || shard->numSessions.load() == 0)
+            continue;
+        if (WiredTigerSession* session = _popSession(*shard)) {
+            shard->steals.fetchAndAdd(1);
+            return session;
         }
     }
 
-    // Outside of the cache partition lock, but on release will be put back on the cache
+    // Outside of the shard locks, but on release will be put back on the cache
+    myShard.misses.fetchAndAdd(1);
     return new WiredTigerSession(_conn, _epoch.load());
 }
 
@@ -214,10 +269,12 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
     uint64_t currentEpoch = _epoch.load();
 
     if (session->_getEpoch() == currentEpoch) {  // check outside of lock to reduce contention
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
+        Shard& shard = _myShard();
+        stdx::lock_guard<stdx::mutex> lock(shard.lock);
         if (session->_getEpoch() == _epoch.load()) {  // recheck inside the lock for correctness
             returnedToCache = true;
-            _sessions.push_back(session);
+            shard.sessions.push_back(session);
+            shard.numSessions.store(shard.sessions.size());
         }
     } else
         invariant(session->_getEpoch() < currentEpoch);
@@ -225,7 +282,28 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
     if (!returnedToCache)
         delete session;
 
+    _snapshotManager.dropExpiredStaleSnapshot();
+
     if (_engine && _engine->haveDropsQueued())
         _engine->dropAllQueued();
 }
+
+void WiredTigerSessionCache::appendStats(BSONObjBuilder* b) const {
+    long long cached = 0;
+    long long hits = 0;
+    long long steals = 0;
+    long long misses = 0;
+    for (auto&& shard : _shards) {
+        cached += shard->numSessions.load();
+        hits += shard->hits.load();
+        steals += shard->steals.load();
+        misses += shard->misses.load();
+    }
+
+    b->appendNumber("shards", static_cast<long long>(_shards.size()));
+    b->appendNumber("cached", cached);
+    b->appendNumber("hits", hits);
+    b->appendNumber("steals", steals);
+    b->appendNumber("misses", misses);
+}
 }
@@ -32,7 +32,9 @@
 #pragma once
 
 #include <list>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include <boost/thread/shared_mutex.hpp>
 #include <wiredtiger.h>
@@ -44,6 +46,7 @@
 
 namespace mongo {
 
+class BSONObjBuilder;
 class WiredTigerKVEngine;
 
 class WiredTigerCachedCursor {
@@ -119,6 +122,10 @@ private:
 /**
  *  This cache implements a shared pool of WiredTiger sessions with the goal to amortize the
  *  cost of session creation and destruction over multiple uses.
+ *
+ *  The pool is split into one shard per core, each with its own lock. A thread always returns
+ *  sessions to, and first looks for them in, the shard it is assigned to, and only steals from the
+ *  other shards when its own is empty.
  */
 class WiredTigerSessionCache {
 public:
@@ -163,7 +170,31 @@ public:
         return _snapshotManager;
     }
 
+    /**
+     * Appends the number of shards and how often getSession() was served from the calling
+     * thread's shard, by stealing from another shard, or by opening a new session.
+     */
+    void appendStats(BSONObjBuilder* b) const;
+
 private:
+    typedef std::vector<WiredTigerSession*> SessionCache;
+
+    struct Shard {
+        stdx::mutex lock;
+        SessionCache sessions;  // Guarded by lock.
+
+        AtomicUInt32 numSessions;  // Size of sessions, readable without the lock.
+        AtomicUInt64 hits;         // Sessions handed out to threads assigned to this shard.
+        AtomicUInt64 steals;       // Sessions handed out to threads assigned to other shards.
+        AtomicUInt64 misses;       // Sessions opened because no shard had one.
+    };
+
+    // Returns the shard the calling thread takes sessions from and returns them to.
+    Shard& _myShard();
+
+    // Takes the most recently released session from 'shard', or returns nullptr if it is empty.
+    static WiredTigerSession* _popSession(Shard& shard);
+
     WiredTigerKVEngine* _engine;  // not owned, might be NULL
     WT_CONNECTION* _conn;         // not owned
     WiredTigerSnapshotManager _snapshotManager;
@@ -174,11 +205,10 @@ private:
     AtomicUInt32 _shuttingDown;
     static const uint32_t kShuttingDownMask = 1 << 31;
 
-    stdx::mutex _cacheLock;
-    typedef std::vector<WiredTigerSession*> SessionCache;
-    SessionCache _sessions;
+    // Allocated separately so that the locks of different shards do not share cache lines.
+    std::vector<std::unique_ptr<Shard>> _shards;
 
     // Bumped when all open sessions need to be closed
-    AtomicUInt64 _epoch;  // atomic so we can check it outside of the lock
+    AtomicUInt64 _epoch;  // atomic so we can check it outside of the shard locks
 };
 }
@@ -0,0 +1,125 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+class WiredTigerSessionCacheTest : public unittest::Test {
+public:
+    void setUp() override {
+        int ret = wiredtiger_open(_dbpath.path().c_str(), NULL, "create,", &_conn);
+        ASSERT_OK(wtRCToStatus(ret));
+        _cache.reset(new WiredTigerSessionCache(_conn));
+    }
+
+    void tearDown() override {
+        _cache.reset();
+        _conn->close(_conn, NULL);
+    }
+
+protected:
+    BSONObj stats() const {
+        BSONObjBuilder b;
+        _cache->appendStats(&b);
+        return b.obj();
+    }
+
+    unittest::TempDir _dbpath{"wt_session_cache_test"};
+    WT_CONNECTION* _conn = nullptr;
+    std::unique_ptr<WiredTigerSessionCache> _cache;
+};
+
+TEST_F(WiredTigerSessionCacheTest, ReusesReleasedSession) {
+    WiredTigerSession* session = _cache->getSession();
+    _cache->releaseSession(session);
+    ASSERT_EQUALS(session, _cache->getSession());
+    _cache->releaseSession(session);
+
+    BSONObj s = stats();
+    ASSERT_EQUALS(1, s["misses"].numberLong());
+    ASSERT_EQUALS(1, s["hits"].numberLong());
+    ASSERT_EQUALS(0, s["steals"].numberLong());
+    ASSERT_EQUALS(1, s["cached"].numberLong());
+}
+
+TEST_F(WiredTigerSessionCacheTest, StealsFromAnotherThreadsShard) {
+    if (stats()["shards"].numberLong() < 2) {
+        return;  // Every thread shares the one shard.
+    }
+
+    // Threads are assigned shards round-robin, so a new thread never shares this thread's shard
+    // while there are at least two shards.
+    WiredTigerSession* session = _cache->getSession();
+    WiredTigerSession* otherSession = nullptr;
+    WiredTigerSession* reusedSession = nullptr;
+    stdx::thread([&] {
+        otherSession = _cache->getSession();
+        _cache->releaseSession(otherSession);
+        reusedSession = _cache->getSession();
+        _cache->releaseSession(reusedSession);
+    }).join();
+    ASSERT_EQUALS(otherSession, reusedSession);
+    _cache->releaseSession(session);
+
+    // This thread's own shard is used first, then the other thread's.
+    ASSERT_EQUALS(session, _cache->getSession());
+    ASSERT_EQUALS(otherSession, _cache->getSession());
+    _cache->releaseSession(session);
+    _cache->releaseSession(otherSession);
+
+    BSONObj s = stats();
+    ASSERT_EQUALS(2, s["misses"].numberLong());
+    ASSERT_EQUALS(2, s["hits"].numberLong());
+    ASSERT_EQUALS(1, s["steals"].numberLong());
+}
+
+TEST_F(WiredTigerSessionCacheTest, CloseAllDiscardsOutstandingSessions) {
+    WiredTigerSession* cached = _cache->getSession();
+    WiredTigerSession* outstanding = _cache->getSession();
+    _cache->releaseSession(cached);
+    ASSERT_EQUALS(1, stats()["cached"].numberLong());
+
+    _cache->closeAll();
+    ASSERT_EQUALS(0, stats()["cached"].numberLong());
+
+    // Sessions from before closeAll() are closed on release rather than cached.
+    _cache->releaseSession(outstanding);
+    ASSERT_EQUALS(0, stats()["cached"].numberLong());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -31,10 +31,17 @@
 
 #define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
 
+#include "mongo/platform/basic.h"
+
 #include <wiredtiger.h>
 
+#include <algorithm>
+
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
@@ -44,13 +51,20 @@
 #include "mongo/stdx/thread.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
 using std::string;
 
+// The background flusher writes the entries that changed during each interval over the course of
+// the next one.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerSizeStorerSyncIntervalSecs, int, 60);
+
 namespace {
 int MAGIC = 123123;
+
+const Milliseconds kFlushTick(1000);
 }
 
 WiredTigerSizeStorer::WiredTigerSizeStorer(WT_CONNECTION* conn, const std::string& storageUri)
@@ -89,11 +103,20 @@ void WiredTigerSizeStorer::onCreate(WiredTigerRecordStore* rs,
                                     long long dataSize) {
     _checkMagic();
     stdx::lock_guard<stdx::mutex> lk(_entriesMutex);
-    Entry& entry = _entries[rs->getURI()];
+    auto it = _entries.find(rs->getURI());
+    if (it == _entries.end()) {
+        it = _entries.insert(std::make_pair(rs->getURI(), Entry())).first;
+    } else if (it->second.numRecords == numRecords && it->second.dataSize == dataSize) {
+        // Reopening a record store with the sizes it was flushed with. Skipping the write here
+        // keeps startup from queueing every collection for the next flush.
+        it->second.rs = rs;
+        return;
+    }
+    Entry& entry = it->second;
     entry.rs = rs;
     entry.numRecords = numRecords;
     entry.dataSize = dataSize;
-    entry.dirty = true;
+    _markDirty_inlock(it->first, &entry);
 }
 
 void WiredTigerSizeStorer::onDestroy(WiredTigerRecordStore* rs) {
@@ -102,18 +125,34 @@ void WiredTigerSizeStorer::onDestroy(WiredTigerRecordStore* rs) {
     Entry& entry = _entries[rs->getURI()];
     entry.numRecords = rs->numRecords(NULL);
     entry.dataSize = rs->dataSize(NULL);
-    entry.dirty = true;
     entry.rs = NULL;
+    _markDirty_inlock(rs->getURI(), &entry);
+}
+
+void WiredTigerSizeStorer::onSizeInfoChanged(WiredTigerRecordStore* rs) {
+    _checkMagic();
+    stdx::lock_guard<stdx::mutex> lk(_entriesMutex);
+    Entry& entry = _entries[rs->getURI()];
+    entry.rs = rs;
+    _markDirty_inlock(rs->getURI(), &entry);
+}
+
+void WiredTigerSizeStorer::_markDirty_inlock(const std::string& uri, Entry* entry) {
+    if (entry->dirty)
+        return;
+    entry->dirty = true;
+    _dirtyQueue.push_back(uri);
 }
 
 
 void WiredTigerSizeStorer::storeToCache(StringData uri, long long numRecords, long long dataSize) {
     _checkMagic();
     stdx::lock_guard<stdx::mutex> lk(_entriesMutex);
-    Entry& entry = _entries[uri.toString()];
+    const std::string uriKey = uri.toString();
+    Entry& entry = _entries[uriKey];
     entry.numRecords = numRecords;
     entry.dataSize = dataSize;
-    entry.dirty = true;
+    _markDirty_inlock(uriKey, &entry);
 }
 
 void WiredTigerSizeStorer::loadFromCache(StringData uri,
@@ -166,43 +205,98 @@ void WiredTigerSizeStorer::fillCache() {
 
     stdx::lock_guard<stdx::mutex> lk(_entriesMutex);
     _entries.swap(m);
+    _dirtyQueue.clear();
 }
 
 void WiredTigerSizeStorer::syncCache(bool syncToDisk) {
     stdx::lock_guard<stdx::mutex> cursorLock(_cursorMutex);
     _checkMagic();
 
-    Map myMap;
+    // Only the last transaction needs to sync, as that also makes the log records of the earlier
+    // ones durable.
+    size_t remaining = numDirty();
+    while (remaining > 0) {
+        const bool last = remaining <= kEntriesPerTransaction;
+        const size_t written = _syncBatch(kEntriesPerTransaction, syncToDisk && last);
+        if (written == 0)
+            break;
+        remaining -= std::min(remaining, written);
+    }
+}
+
+size_t WiredTigerSizeStorer::syncSome(size_t maxEntries) {
+    size_t total = 0;
+    while (total < maxEntries) {
+        // Release the cursor between transactions so that a full sync is never stuck behind a
+        // long run of them.
+        stdx::lock_guard<stdx::mutex> cursorLock(_cursorMutex);
+        _checkMagic();
+        const size_t written = _syncBatch(maxEntries - total, false);
+        if (written == 0)
+            break;
+        total += written;
+    }
+    return total;
+}
+
+size_t WiredTigerSizeStorer::numDirty() const {
+    stdx::lock_guard<stdx::mutex> lk(_entriesMutex);
+    return _dirtyQueue.size();
+}
+
+void WiredTigerSizeStorer::appendStats(BSONObjBuilder* b) const {
+    b->appendNumber("dirtyEntries", static_cast<long long>(numDirty()));
+    b->appendNumber("transactions", static_cast<long long>(_transactions.load()));
+    b->appendNumber("entriesWritten", static_cast<long long>(_entriesWritten.load()));
+    b->appendNumber("totalTransactionMicros",
+                    static_cast<long long>(_totalTransactionMicros.load()));
+    b->appendNumber("maxTransactionMicros", static_cast<long long>(_maxTransactionMicros.load()));
+}
+
+size_t WiredTigerSizeStorer::_syncBatch(size_t maxEntries, bool syncToDisk) {
+    Map batch;
     {
         stdx::lock_guard<stdx::mutex> lk(_entriesMutex);
-        for (Map::iterator it = _entries.begin(); it != _entries.end(); ++it) {
-            std::string uriKey = it->first;
+        const size_t limit = std::min(maxEntries, kEntriesPerTransaction);
+        while (!_dirtyQueue.empty() && batch.size() < limit) {
+            const std::string uriKey = _dirtyQueue.front();
+            _dirtyQueue.pop_front();
+
+            Map::iterator it = _entries.find(uriKey);
+            if (it == _entries.end())
+                continue;
             Entry& entry = it->second;
+            entry.dirty = false;
             if (entry.rs) {
-                if (entry.dataSize != entry.rs->dataSize(NULL)) {
-                    entry.dataSize = entry.rs->dataSize(NULL);
-                    entry.dirty = true;
-                }
-                if (entry.numRecords != entry.rs->numRecords(NULL)) {
-                    entry.numRecords = entry.rs->numRecords(NULL);
-                    entry.dirty = true;
-                }
+                // Clear the record store's flag before reading its sizes, so that any change
+                // made after the read queues the entry again.
+                entry.rs->clearSizeInfoDirty();
+                entry.dataSize = entry.rs->dataSize(NULL);
+                entry.numRecords = entry.rs->numRecords(NULL);
             }
-
-            if (!entry.dirty)
-                continue;
-            myMap[uriKey] = entry;
+            batch[uriKey] = entry;
         }
     }
 
-    if (myMap.empty())
-        return;  // Nothing to do.
+    if (batch.empty())
+        return 0;
 
+    // If the transaction does not commit, queue the entries again for the next attempt.
+    ScopeGuard requeuer = MakeGuard([&] {
+        stdx::lock_guard<stdx::mutex> lk(_entriesMutex);
+        for (Map::iterator it = batch.begin(); it != batch.end(); ++it) {
+            Map::iterator entry = _entries.find(it->first);
+            if (entry != _entries.end())
+                _markDirty_inlock(it->first, &entry->second);
+        }
+    });
+
+    Timer timer;
     WT_SESSION* session = _session.getSession();
     invariantWTOK(session->begin_transaction(session, syncToDisk ? "sync=true" : ""));
     ScopeGuard rollbacker = MakeGuard(session->rollback_transaction, session, "");
 
-    for (Map::iterator it = myMap.begin(); it != myMap.end(); ++it) {
+    for (Map::iterator it = batch.begin(); it != batch.end(); ++it) {
         string uriKey = it->first;
         Entry& entry = it->second;
 
@@ -227,11 +321,67 @@ void WiredTigerSizeStorer::syncCache(bool syncToDisk) {
 
     rollbacker.Dismiss();
     invariantWTOK(session->commit_transaction(session, NULL));
+    requeuer.Dismiss();
+
+    const long long micros = timer.micros();
+    _transactions.fetchAndAdd(1);
+    _entriesWritten.fetchAndAdd(batch.size());
+    _totalTransactionMicros.fetchAndAdd(micros);
+    long long max = _maxTransactionMicros.load();
+    while (micros > max) {
+        const long long old = _maxTransactionMicros.compareAndSwap(max, micros);
+        if (old == max)
+            break;
+        max = old;
+    }
+    return batch.size();
+}
+
+WiredTigerSizeStorerFlusher::WiredTigerSizeStorerFlusher(WiredTigerSizeStorer* sizeStorer)
+    : BackgroundJob(false /* selfDelete */), _sizeStorer(sizeStorer) {}
+
+std::string WiredTigerSizeStorerFlusher::name() const {
+    return "WTSizeStorerFlusher";
+}
 
+void WiredTigerSizeStorerFlusher::shutdown() {
     {
-        stdx::lock_guard<stdx::mutex> lk(_entriesMutex);
-        for (Map::iterator it = _entries.begin(); it != _entries.end(); ++it) {
-            it->second.dirty = false;
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _shuttingDown = true;
+    }
+    _shutdownCV.notify_one();
+    wait();
+}
+
+void WiredTigerSizeStorerFlusher::run() {
+    Client::initThread(name().c_str());
+
+    // Entries that change during an interval are written during the next one, a slice each
+    // tick, so each tick only writes a small share of them.
+    int ticksLeft = 0;
+    size_t intervalRemaining = 0;
+    while (true) {
+        {
+            stdx::unique_lock<stdx::mutex> lk(_mutex);
+            if (_shutdownCV.wait_for(lk, kFlushTick, [this] { return _shuttingDown; })) {
+                return;
+            }
+        }
+
+        if (ticksLeft <= 0) {
+            ticksLeft = std::max(1, static_cast<int>(wiredTigerSizeStorerSyncIntervalSecs));
+            intervalRemaining = _sizeStorer->numDirty();
+        }
+
+        const size_t slice = (intervalRemaining + ticksLeft - 1) / ticksLeft;
+        --ticksLeft;
+        if (slice == 0)
+            continue;
+
+        try {
+            intervalRemaining -= std::min(intervalRemaining, _sizeStorer->syncSome(slice));
+        } catch (const WriteConflictException&) {
+            // The entries were queued again, try next tick.
         }
     }
 }
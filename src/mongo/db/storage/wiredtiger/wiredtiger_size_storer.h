@@ -31,27 +31,42 @@
 
 #pragma once
 
+#include <deque>
 #include <map>
 #include <string>
 #include <wiredtiger.h>
 
+#include "mongo/base/disallow_copying.h"
 #include "mongo/base/string_data.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/background.h"
 
 namespace mongo {
 
+class BSONObjBuilder;
 class WiredTigerRecordStore;
 class WiredTigerSession;
 
 class WiredTigerSizeStorer {
 public:
+    // Most entries written in a single WT transaction.
+    static const size_t kEntriesPerTransaction = 100;
+
     WiredTigerSizeStorer(WT_CONNECTION* conn, const std::string& storageUri);
     ~WiredTigerSizeStorer();
 
     void onCreate(WiredTigerRecordStore* rs, long long nr, long long ds);
     void onDestroy(WiredTigerRecordStore* rs);
 
+    /**
+     * Called by 'rs' when its numRecords or dataSize changes after it was last flushed, so that
+     * its entry is written by the next flush. See WiredTigerRecordStore::clearSizeInfoDirty().
+     */
+    void onSizeInfoChanged(WiredTigerRecordStore* rs);
+
     void storeToCache(StringData uri, long long numRecords, long long dataSize);
 
     void loadFromCache(StringData uri, long long* numRecords, long long* dataSize) const;
@@ -66,17 +81,40 @@ public:
      */
     void syncCache(bool syncToDisk);
 
+    /**
+     * Writes at most 'maxEntries' of the changed entries, oldest change first, in transactions
+     * of at most kEntriesPerTransaction entries. Returns the number of entries written.
+     */
+    size_t syncSome(size_t maxEntries);
+
+    /**
+     * Returns the number of entries with changes that have not been written yet.
+     */
+    size_t numDirty() const;
+
+    /**
+     * Appends flush counts and durations for serverStatus.
+     */
+    void appendStats(BSONObjBuilder* b) const;
+
 private:
     void _checkMagic() const;
 
+    // Writes up to 'maxEntries', and no more than kEntriesPerTransaction, changed entries in one
+    // transaction. Requires _cursorMutex. Returns the number of entries written.
+    size_t _syncBatch(size_t maxEntries, bool syncToDisk);
+
     struct Entry {
         Entry() : numRecords(0), dataSize(0), dirty(false), rs(NULL) {}
         long long numRecords;
         long long dataSize;
-        bool dirty;
+        bool dirty;                 // true if the entry's uri is in _dirtyQueue
         WiredTigerRecordStore* rs;  // not owned
     };
 
+    // Queues the entry for the next flush. Requires _entriesMutex.
+    void _markDirty_inlock(const std::string& uri, Entry* entry);
+
     int _magic;
 
     // Guards _cursor. Acquire *before* _entriesMutex.
@@ -86,6 +124,41 @@ private:
 
     typedef std::map<std::string, Entry> Map;
     Map _entries;
+    std::deque<std::string> _dirtyQueue;  // uris of the dirty entries, in the order they changed
     mutable stdx::mutex _entriesMutex;
+
+    AtomicInt64 _transactions;
+    AtomicInt64 _entriesWritten;
+    AtomicInt64 _totalTransactionMicros;
+    AtomicInt64 _maxTransactionMicros;
+};
+
+/**
+ * Flushes the size storer in the background, spreading the entries that changed over each
+ * interval across that interval instead of writing them all at once.
+ */
+class WiredTigerSizeStorerFlusher : public BackgroundJob {
+    MONGO_DISALLOW_COPYING(WiredTigerSizeStorerFlusher);
+
+public:
+    explicit WiredTigerSizeStorerFlusher(WiredTigerSizeStorer* sizeStorer);
+
+    /**
+     * Stops the thread and waits for it to exit. Must be called before the size storer is
+     * destroyed.
+     */
+    void shutdown();
+
+protected:
+    std::string name() const override;
+
+    void run() override;
+
+private:
+    WiredTigerSizeStorer* const _sizeStorer;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _shutdownCV;
+    bool _shuttingDown = false;
 };
 }
@@ -41,15 +41,38 @@
 
 namespace mongo {
 
+namespace {
+const char kStaleSnapshotName[] = "staleRead";
+}  // namespace
+
 Status WiredTigerSnapshotManager::prepareForCreateSnapshot(OperationContext* txn) {
+    {
+        // Counted before the view is established, so any stale snapshot taken from now on is
+        // treated as possibly newer than it.
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        _numPreparedSnapshots++;
+    }
     WiredTigerRecoveryUnit::get(txn)->prepareForCreateSnapshot(txn);
     return Status::OK();
 }
 
 Status WiredTigerSnapshotManager::createSnapshot(OperationContext* txn, const SnapshotName& name) {
+    {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        if (_staleSnapshotTaken && _staleSnapshotPreparedCount == _numPreparedSnapshots) {
+            _resetStaleSnapshot_inlock(true);
+        }
+    }
+
     auto session = WiredTigerRecoveryUnit::get(txn)->getSession(txn)->getSession();
     const std::string config = str::stream() << "name=" << name.asU64();
-    return wtRCToStatus(session->snapshot(session, config.c_str()));
+    Status status = wtRCToStatus(session->snapshot(session, config.c_str()));
+    if (status.isOK()) {
+        stdx::lock_guard<stdx::mutex> lock(_mutex);
+        invariant(!_newestSnapshot || *_newestSnapshot < name);
+        _newestSnapshot = name;
+    }
+    return status;
 }
 
 void WiredTigerSnapshotManager::setCommittedSnapshot(const SnapshotName& name) {
@@ -67,12 +90,17 @@ void WiredTigerSnapshotManager::cleanupUnneededSnapshots() {
 
     const std::string config = str::stream() << "drop=(before=" << _committedSnapshot->asU64()
                                              << ')';
+    // Dropped first because it would otherwise go with the rest if it is older than the
+    // committed snapshot, and readers can cheaply take a new one.
+    _resetStaleSnapshot_inlock(true);
     invariantWTOK(_session->snapshot(_session, config.c_str()));
 }
 
 void WiredTigerSnapshotManager::dropAllSnapshots() {
     stdx::lock_guard<stdx::mutex> lock(_mutex);
     _committedSnapshot = boost::none;
+    _newestSnapshot = boost::none;
+    _resetStaleSnapshot_inlock(false);
     invariantWTOK(_session->snapshot(_session, "drop=(all)"));
 }
 
@@ -80,6 +108,7 @@ void WiredTigerSnapshotManager::shutdown() {
     stdx::lock_guard<stdx::mutex> lock(_mutex);
     if (!_session)
         return;
+    _resetStaleSnapshot_inlock(false);
     invariantWTOK(_session->close(_session, NULL));
     _session = nullptr;
 }
@@ -107,4 +136,83 @@ SnapshotName WiredTigerSnapshotManager::beginTransactionOnCommittedSnapshot(WT_S
     return *_committedSnapshot;
 }
 
+boost::optional<SnapshotName> WiredTigerSnapshotManager::getNewestSnapshot() const {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    return _newestSnapshot;
+}
+
+SnapshotName WiredTigerSnapshotManager::beginTransactionOnNewestSnapshot(WT_SESSION* session,
+                                                                         bool sync) const {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+
+    uassert(ErrorCodes::NotMasterOrSecondaryCode,
+            "Snapshot of the last applied batch disappeared while running operation",
+            _newestSnapshot);
+
+    StringBuilder config;
+    config << "snapshot=" << _newestSnapshot->asU64();
+    if (sync)
+        config << ",sync=true";
+    invariantWTOK(session->begin_transaction(session, config.str().c_str()));
+
+    return *_newestSnapshot;
+}
+
+void WiredTigerSnapshotManager::beginTransactionOnStaleSnapshot(WT_SESSION* session,
+                                                                Milliseconds maxStaleness,
+                                                                bool sync) {
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+
+    if (!_session) {
+        // Shutting down, so there is nothing to share. A private snapshot is always fresh enough.
+        invariantWTOK(session->begin_transaction(session, sync ? "sync=true" : NULL));
+        return;
+    }
+
+    const Date_t now = Date_t::now();
+    if (!_staleSnapshotTaken || now - *_staleSnapshotTaken > maxStaleness) {
+        // Replaces any existing snapshot with the same name.
+        const std::string config = str::stream() << "name=" << kStaleSnapshotName;
+        invariantWTOK(_session->snapshot(_session, config.c_str()));
+        _staleSnapshotTaken = now;
+        _staleSnapshotPreparedCount = _numPreparedSnapshots;
+        _staleSnapshotMaxStaleness = maxStaleness;
+    } else if (maxStaleness > _staleSnapshotMaxStaleness) {
+        _staleSnapshotMaxStaleness = maxStaleness;
+    }
+    _staleSnapshotExpiry.store(
+        (*_staleSnapshotTaken + _staleSnapshotMaxStaleness).toMillisSinceEpoch());
+
+    StringBuilder config;
+    config << "snapshot=" << kStaleSnapshotName;
+    if (sync)
+        config << ",sync=true";
+    invariantWTOK(session->begin_transaction(session, config.str().c_str()));
+}
+
+void WiredTigerSnapshotManager::dropExpiredStaleSnapshot() {
+    const long long expiry = _staleSnapshotExpiry.load();
+    if (expiry == 0 || Date_t::now().toMillisSinceEpoch() <= expiry)
+        return;
+
+    stdx::lock_guard<stdx::mutex> lock(_mutex);
+    if (!_session || !_staleSnapshotTaken ||
+        Date_t::now() - *_staleSnapshotTaken <= _staleSnapshotMaxStaleness)
+        return;
+    _resetStaleSnapshot_inlock(true);
+}
+
+void WiredTigerSnapshotManager::_resetStaleSnapshot_inlock(bool drop) {
+    if (!_staleSnapshotTaken)
+        return;
+
+    if (drop) {
+        const std::string config = str::stream() << "drop=(names=[" << kStaleSnapshotName << "])";
+        invariantWTOK(_session->snapshot(_session, config.c_str()));
+    }
+    _staleSnapshotTaken = boost::none;
+    _staleSnapshotMaxStaleness = Milliseconds(0);
+    _staleSnapshotExpiry.store(0);
+}
+
 }  // namespace mongo
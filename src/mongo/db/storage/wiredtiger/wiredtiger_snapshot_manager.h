@@ -35,7 +35,9 @@
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/storage/snapshot_manager.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -83,9 +85,56 @@ public:
      */
     boost::optional<SnapshotName> getMinSnapshotForNextCommittedRead() const;
 
+    /**
+     * Returns the name of the most recently created named snapshot, or boost::none if there is
+     * none. Like getMinSnapshotForNextCommittedRead(), the result must not be used to start a
+     * transaction.
+     */
+    boost::optional<SnapshotName> getNewestSnapshot() const;
+
+    /**
+     * Starts a transaction on the most recently created named snapshot and returns its name.
+     *
+     * Throws if there is currently no named snapshot.
+     */
+    SnapshotName beginTransactionOnNewestSnapshot(WT_SESSION* session, bool sync) const;
+
+    /**
+     * Starts a read-only transaction on a named snapshot shared by all readers that tolerate
+     * stale data. The shared snapshot is refreshed first if it is older than 'maxStaleness'.
+     */
+    void beginTransactionOnStaleSnapshot(WT_SESSION* session, Milliseconds maxStaleness, bool sync);
+
+    /**
+     * Drops the shared stale snapshot once it is too old for any reader that used it, so an idle
+     * snapshot does not keep old versions of data pinned in the cache. Cheap enough to call
+     * whenever a session is released.
+     */
+    void dropExpiredStaleSnapshot();
+
 private:
+    // Forgets the shared stale snapshot, dropping it if 'drop' is true. Must hold _mutex.
+    void _resetStaleSnapshot_inlock(bool drop);
+
     mutable stdx::mutex _mutex;  // Guards all members.
     boost::optional<SnapshotName> _committedSnapshot;
-    WT_SESSION* _session;  // only used for dropping snapshots.
+    // Never older than _committedSnapshot, so it survives cleanupUnneededSnapshots().
+    boost::optional<SnapshotName> _newestSnapshot;
+    WT_SESSION* _session;  // used for dropping snapshots and taking the stale snapshot.
+
+    // Number of calls to prepareForCreateSnapshot(). A stale snapshot taken after the latest
+    // preparation may be newer than the named snapshot that follows it and is dropped before that
+    // one is created, because WT needs named snapshots created in the order of their views.
+    uint64_t _numPreparedSnapshots = 0;
+
+    // The shared stale snapshot, if any: when it was taken, the value of _numPreparedSnapshots at
+    // that time, and the greatest staleness allowed by a reader that used it.
+    boost::optional<Date_t> _staleSnapshotTaken;
+    uint64_t _staleSnapshotPreparedCount = 0;
+    Milliseconds _staleSnapshotMaxStaleness{0};
+
+    // When the stale snapshot can be dropped, in millis since the epoch, or 0 if there is none.
+    // Read without the mutex by dropExpiredStaleSnapshot().
+    AtomicInt64 _staleSnapshotExpiry;
 };
 }
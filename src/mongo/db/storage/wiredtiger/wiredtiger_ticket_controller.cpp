@@ -0,0 +1,234 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_controller.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/client.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+// When true, the read and write ticket pools are resized at runtime instead of keeping the sizes
+// set through wiredTigerConcurrentReadTransactions and wiredTigerConcurrentWriteTransactions.
+MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveConcurrentTransactions, bool, false);
+
+namespace {
+
+const Milliseconds kAdjustInterval(1000);
+
+// A cache fuller than this fraction of its configured size counts as eviction pressure.
+const double kCacheFullRatio = 0.95;
+
+// Growing the pool counts as harmful if throughput drops below this fraction of what it was.
+const double kThroughputLossRatio = 0.95;
+
+// Growing the pool counts as harmful if average latency rises by more than this factor.
+const double kLatencyGrowthRatio = 2.0;
+
+AtomicInt64 adjustments;
+
+}  // namespace
+
+TicketPoolSizer::TicketPoolSizer(int minSize, int maxSize) : _minSize(minSize), _maxSize(maxSize) {
+    invariant(minSize > 0 && minSize <= maxSize);
+}
+
+int TicketPoolSizer::nextSize(int currentSize, const Sample& sample) {
+    const double averageLatency =
+        sample.completed ? static_cast<double>(sample.latencyMicros) / sample.completed : 0;
+    const int step = std::max(8, currentSize / 8);
+
+    const Action lastAction = _lastAction;
+    const int64_t lastCompleted = _lastCompleted;
+    const double lastAverageLatency = _lastAverageLatency;
+    _lastCompleted = sample.completed;
+    _lastAverageLatency = averageLatency;
+    _lastAction = Action::kNone;
+
+    int size = currentSize;
+    if (sample.evictionPressure) {
+        // Fewer concurrent transactions pin less of the cache, letting eviction catch up.
+        size = currentSize - std::max(1, currentSize / 4);
+        _lastAction = Action::kShrink;
+    } else if (lastAction == Action::kGrow &&
+               (sample.completed < lastCompleted * kThroughputLossRatio ||
+                averageLatency > lastAverageLatency * kLatencyGrowthRatio)) {
+        // The last increase did not pay off, so undo it and hold for a while.
+        size = currentSize - step;
+        _lastAction = Action::kShrink;
+        _holdIntervals = kHoldIntervals;
+    } else if (_holdIntervals > 0) {
+        --_holdIntervals;
+    } else if (sample.queued > 0) {
+        size = currentSize + step;
+        _lastAction = Action::kGrow;
+    }
+
+    size = std::max(_minSize, std::min(_maxSize, size));
+    if (size == currentSize) {
+        _lastAction = Action::kNone;
+    }
+    return size;
+}
+
+WiredTigerTicketController::Pool::Pool(const char* name,
+                                       TicketHolder* holder,
+                                       WiredTigerTicketPoolStats* stats)
+    : name(name), holder(holder), stats(stats), sizer(kMinTickets, kMaxTickets) {}
+
+WiredTigerTicketController::WiredTigerTicketController(WT_CONNECTION* conn)
+    : _conn(conn),
+      _read("read",
+            WiredTigerRecoveryUnit::getReadTicketHolder(),
+            WiredTigerRecoveryUnit::getReadTicketStats()),
+      _write("write",
+             WiredTigerRecoveryUnit::getWriteTicketHolder(),
+             WiredTigerRecoveryUnit::getWriteTicketStats()) {}
+
+std::string WiredTigerTicketController::name() const {
+    return "WTTicketController";
+}
+
+void WiredTigerTicketController::shutdown() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _shuttingDown = true;
+    }
+    _shutdownCV.notify_one();
+    wait();
+}
+
+void WiredTigerTicketController::appendStats(BSONObjBuilder* b) {
+    b->append("sizing", wiredTigerAdaptiveConcurrentTransactions ? "adaptive" : "static");
+    b->appendNumber("adjustments", static_cast<long long>(adjustments.load()));
+}
+
+void WiredTigerTicketController::run() {
+    Client::initThread(name().c_str());
+
+    bool wasAdaptive = false;
+    while (true) {
+        {
+            stdx::unique_lock<stdx::mutex> lk(_mutex);
+            if (_shutdownCV.wait_for(lk, kAdjustInterval, [this] { return _shuttingDown; })) {
+                return;
+            }
+        }
+
+        const bool adaptive = wiredTigerAdaptiveConcurrentTransactions;
+        if (adaptive != wasAdaptive) {
+            log() << "Adaptive sizing of WiredTiger concurrent transactions "
+                  << (adaptive ? "enabled" : "disabled");
+        }
+
+        // The first adaptive interval only establishes a baseline, so that sizing decisions are
+        // not based on activity from before adaptive sizing was switched on.
+        const bool resize = adaptive && wasAdaptive;
+        const bool evictionPressure = adaptive && _underEvictionPressure();
+        _adjust(&_read, evictionPressure, resize);
+        _adjust(&_write, evictionPressure, resize);
+
+        wasAdaptive = adaptive;
+    }
+}
+
+void WiredTigerTicketController::_adjust(Pool* pool, bool evictionPressure, bool resize) {
+    TicketPoolSizer::Sample current;
+    current.completed = pool->stats->completed.load();
+    current.latencyMicros = pool->stats->latencyMicros.load();
+    current.queued = pool->stats->queued.load();
+
+    TicketPoolSizer::Sample interval;
+    interval.completed = current.completed - pool->last.completed;
+    interval.latencyMicros = current.latencyMicros - pool->last.latencyMicros;
+    interval.queued = current.queued - pool->last.queued;
+    interval.evictionPressure = evictionPressure;
+    pool->last = current;
+
+    if (!resize) {
+        return;
+    }
+
+    const int currentSize = pool->holder->outof();
+    const int newSize = pool->sizer.nextSize(currentSize, interval);
+    if (newSize == currentSize) {
+        return;
+    }
+
+    Status status = pool->holder->resize(newSize);
+    if (!status.isOK()) {
+        warning() << "Failed to resize the " << pool->name << " ticket pool from " << currentSize
+                  << " to " << newSize << ": " << status;
+        return;
+    }
+
+    adjustments.fetchAndAdd(1);
+    LOG(1) << "Resized the " << pool->name << " ticket pool from " << currentSize << " to "
+           << newSize << " (completed: " << interval.completed
+           << ", queued: " << interval.queued << ", eviction pressure: " << evictionPressure
+           << ")";
+}
+
+bool WiredTigerTicketController::_underEvictionPressure() {
+    WiredTigerSession session(_conn);
+    WT_SESSION* s = session.getSession();
+
+    const std::string uri = "statistics:";
+    const std::string config = "statistics=(fast)";
+    auto appEvictions = WiredTigerUtil::getStatisticsValueAs<uint64_t>(
+        s, uri, config, WT_STAT_CONN_CACHE_EVICTION_APP);
+    auto bytesInUse = WiredTigerUtil::getStatisticsValueAs<uint64_t>(
+        s, uri, config, WT_STAT_CONN_CACHE_BYTES_INUSE);
+    auto bytesMax = WiredTigerUtil::getStatisticsValueAs<uint64_t>(
+        s, uri, config, WT_STAT_CONN_CACHE_BYTES_MAX);
+    if (!appEvictions.isOK() || !bytesInUse.isOK() || !bytesMax.isOK()) {
+        return false;
+    }
+
+    const bool appThreadsEvicted =
+        _lastAppEvictions != 0 && appEvictions.getValue() > _lastAppEvictions;
+    _lastAppEvictions = appEvictions.getValue();
+
+    const bool cacheFull =
+        bytesMax.getValue() > 0 && bytesInUse.getValue() > bytesMax.getValue() * kCacheFullRatio;
+    return appThreadsEvicted || cacheFull;
+}
+
+}  // namespace mongo
@@ -0,0 +1,153 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <wiredtiger.h>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/background.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+class TicketHolder;
+
+/**
+ * Counters kept for a pool of WiredTiger transaction tickets.
+ */
+struct WiredTigerTicketPoolStats {
+    AtomicInt64 completed;      // Transactions that have released their ticket.
+    AtomicInt64 latencyMicros;  // Total time those transactions held their ticket.
+    AtomicInt64 queued;         // Ticket requests that had to wait for a ticket.
+};
+
+/**
+ * Decides how large a ticket pool should be from what it observed over the last interval. The
+ * pool grows while requests are queueing for tickets and throughput keeps up with the extra
+ * concurrency, backs off when growing lowered throughput or sharply raised latency, and shrinks
+ * quickly under cache eviction pressure.
+ */
+class TicketPoolSizer {
+public:
+    struct Sample {
+        int64_t completed = 0;
+        int64_t latencyMicros = 0;
+        int64_t queued = 0;
+        bool evictionPressure = false;
+    };
+
+    // Number of intervals to leave the size alone after backing off from a harmful increase.
+    static const int kHoldIntervals = 10;
+
+    TicketPoolSizer(int minSize, int maxSize);
+
+    /**
+     * Returns the size the pool should have for the next interval.
+     */
+    int nextSize(int currentSize, const Sample& sample);
+
+private:
+    enum class Action { kNone, kGrow, kShrink };
+
+    const int _minSize;
+    const int _maxSize;
+
+    Action _lastAction = Action::kNone;
+    int64_t _lastCompleted = 0;
+    double _lastAverageLatency = 0;
+    int _holdIntervals = 0;
+};
+
+/**
+ * Background thread which, while 'wiredTigerAdaptiveConcurrentTransactions' is enabled, resizes
+ * the read and write ticket pools once per interval based on their observed throughput and
+ * latency and on WiredTiger cache eviction pressure. Static sizing, set through
+ * 'wiredTigerConcurrentReadTransactions' and 'wiredTigerConcurrentWriteTransactions', is left
+ * untouched while the switch is off.
+ */
+class WiredTigerTicketController : public BackgroundJob {
+    MONGO_DISALLOW_COPYING(WiredTigerTicketController);
+
+public:
+    static const int kMinTickets = 16;
+    static const int kMaxTickets = 1024;
+
+    explicit WiredTigerTicketController(WT_CONNECTION* conn);
+
+    /**
+     * Stops the thread and waits for it to exit. Must be called before the connection closes.
+     */
+    void shutdown();
+
+    /**
+     * Appends the sizing mode and the number of adjustments made for serverStatus.
+     */
+    static void appendStats(BSONObjBuilder* b);
+
+protected:
+    std::string name() const override;
+
+    void run() override;
+
+private:
+    struct Pool {
+        Pool(const char* name, TicketHolder* holder, WiredTigerTicketPoolStats* stats);
+
+        const char* const name;
+        TicketHolder* const holder;
+        WiredTigerTicketPoolStats* const stats;
+        TicketPoolSizer sizer;
+        TicketPoolSizer::Sample last;
+    };
+
+    // Returns true if WiredTiger reports that application threads are being drafted into
+    // eviction or that the cache is nearly full.
+    bool _underEvictionPressure();
+
+    // Samples the pool's counters and, if 'resize' is true, resizes it for the next interval.
+    void _adjust(Pool* pool, bool evictionPressure, bool resize);
+
+    WT_CONNECTION* const _conn;
+
+    Pool _read;
+    Pool _write;
+    uint64_t _lastAppEvictions = 0;  // Pages evicted by application threads, as of last check.
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _shutdownCV;
+    bool _shuttingDown = false;
+};
+
+}  // namespace mongo
@@ -0,0 +1,97 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_ticket_controller.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const int kMin = 16;
+const int kMax = 1024;
+
+TicketPoolSizer::Sample makeSample(int64_t completed,
+                                   int64_t latencyMicros,
+                                   int64_t queued,
+                                   bool evictionPressure = false) {
+    TicketPoolSizer::Sample sample;
+    sample.completed = completed;
+    sample.latencyMicros = latencyMicros;
+    sample.queued = queued;
+    sample.evictionPressure = evictionPressure;
+    return sample;
+}
+
+TEST(TicketPoolSizer, GrowsWhileRequestsQueue) {
+    TicketPoolSizer sizer(kMin, kMax);
+    ASSERT_EQUALS(144, sizer.nextSize(128, makeSample(1000, 1000 * 100, 50)));
+    ASSERT_EQUALS(162, sizer.nextSize(144, makeSample(1100, 1100 * 100, 50)));
+}
+
+TEST(TicketPoolSizer, KeepsSizeWhenNothingQueues) {
+    TicketPoolSizer sizer(kMin, kMax);
+    ASSERT_EQUALS(128, sizer.nextSize(128, makeSample(1000, 1000 * 100, 0)));
+    ASSERT_EQUALS(128, sizer.nextSize(128, makeSample(0, 0, 0)));
+}
+
+TEST(TicketPoolSizer, UndoesGrowthThatLowersThroughput) {
+    TicketPoolSizer sizer(kMin, kMax);
+    ASSERT_EQUALS(144, sizer.nextSize(128, makeSample(1000, 1000 * 100, 50)));
+    ASSERT_EQUALS(126, sizer.nextSize(144, makeSample(800, 800 * 100, 50)));
+
+    // Holds at the reduced size even though requests are still queueing.
+    for (int i = 0; i < TicketPoolSizer::kHoldIntervals; ++i) {
+        ASSERT_EQUALS(126, sizer.nextSize(126, makeSample(1000, 1000 * 100, 50)));
+    }
+    ASSERT_EQUALS(141, sizer.nextSize(126, makeSample(1000, 1000 * 100, 50)));
+}
+
+TEST(TicketPoolSizer, UndoesGrowthThatRaisesLatency) {
+    TicketPoolSizer sizer(kMin, kMax);
+    ASSERT_EQUALS(144, sizer.nextSize(128, makeSample(1000, 1000 * 100, 50)));
+    ASSERT_EQUALS(126, sizer.nextSize(144, makeSample(1000, 1000 * 300, 50)));
+}
+
+TEST(TicketPoolSizer, ShrinksUnderEvictionPressure) {
+    TicketPoolSizer sizer(kMin, kMax);
+    ASSERT_EQUALS(96, sizer.nextSize(128, makeSample(1000, 1000 * 100, 50, true)));
+    ASSERT_EQUALS(72, sizer.nextSize(96, makeSample(1000, 1000 * 100, 50, true)));
+}
+
+TEST(TicketPoolSizer, StaysWithinBounds) {
+    TicketPoolSizer sizer(kMin, kMax);
+    ASSERT_EQUALS(kMax, sizer.nextSize(kMax - 1, makeSample(1000, 1000 * 100, 50)));
+    ASSERT_EQUALS(kMax, sizer.nextSize(kMax, makeSample(1100, 1100 * 100, 50)));
+    ASSERT_EQUALS(kMin, sizer.nextSize(kMin + 1, makeSample(1000, 1000 * 100, 50, true)));
+    ASSERT_EQUALS(kMin, sizer.nextSize(kMin, makeSample(1000, 1000 * 100, 50, true)));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -54,9 +54,14 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/util/background.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -69,14 +74,28 @@ using std::unique_ptr;
 
 Counter64 ttlPasses;
 Counter64 ttlDeletedDocuments;
+Counter64 ttlBatches;
+Counter64 ttlIndexesWithBacklog;  // as of the last pass
 
 ServerStatusMetricField<Counter64> ttlPassesDisplay("ttl.passes", &ttlPasses);
 ServerStatusMetricField<Counter64> ttlDeletedDocumentsDisplay("ttl.deletedDocuments",
                                                               &ttlDeletedDocuments);
+ServerStatusMetricField<Counter64> ttlBatchesDisplay("ttl.batches", &ttlBatches);
+ServerStatusMetricField<Counter64> ttlIndexesWithBacklogDisplay("ttl.indexesWithBacklog",
+                                                                &ttlIndexesWithBacklog);
 
 MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorEnabled, bool, true);
 MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorSleepSecs, int, 60);  // used for testing
 
+// The most documents a TTL index deletes while holding its collection lock. Locks are released
+// between batches. Zero or less deletes all expired documents in one batch.
+MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorBatchSize, int, 0);
+
+// The most documents per second a TTL index deletes. A pass spreads its batches over the time
+// until the next pass, and leaves what it can't delete by then to later passes. Zero or less
+// means no limit.
+MONGO_EXPORT_SERVER_PARAMETER(ttlMonitorMaxDeletesPerSecondPerIndex, int, 0);
+
 class TTLMonitor : public BackgroundJob {
 public:
     TTLMonitor() {}
@@ -130,8 +149,14 @@ private:
 
         set<string> dbs;
         dbHolder().getAllShortNames(dbs);
+        dbHolder().getDeferredNames(dbs);
 
         ttlPasses.increment();
+        long long indexesWithBacklog = 0;
+        ON_BLOCK_EXIT([&indexesWithBacklog] {
+            ttlIndexesWithBacklog.decrement(ttlIndexesWithBacklog.get());
+            ttlIndexesWithBacklog.increment(indexesWithBacklog);
+        });
 
         for (set<string>::const_iterator i = dbs.begin(); i != dbs.end(); ++i) {
             string db = *i;
@@ -142,7 +167,12 @@ private:
             for (vector<BSONObj>::const_iterator it = indexes.begin(); it != indexes.end(); ++it) {
                 BSONObj idx = *it;
                 try {
-                    if (!doTTLForIndex(&txn, db, idx)) {
+                    bool hasBacklog = false;
+                    const bool keepGoing = doTTLForIndex(&txn, db, idx, &hasBacklog);
+                    if (hasBacklog) {
+                        indexesWithBacklog++;
+                    }
+                    if (!keepGoing) {
                         break;  // stop processing TTL indexes on this database
                     }
                 } catch (const DBException& dbex) {
@@ -167,13 +197,20 @@ private:
         ScopedTransaction transaction(txn, MODE_IS);
         Lock::DBLock dbLock(txn->lockState(), dbName, MODE_IS);
 
-        Database* db = dbHolder().get(txn, dbName);
-        if (!db) {
-            return;  // skip since database no longer exists
+        const DatabaseCatalogEntry* dbEntry;
+        if (dbHolder().isDeferred(txn, dbName)) {
+            // Only open the database if it has TTL indexes to delete documents with.
+            dbEntry =
+                getGlobalServiceContext()->getGlobalStorageEngine()->getDatabaseCatalogEntry(
+                    txn, dbName);
+        } else {
+            Database* db = dbHolder().get(txn, dbName);
+            if (!db) {
+                return;  // skip since database no longer exists
+            }
+            dbEntry = db->getDatabaseCatalogEntry();
         }
 
-        const DatabaseCatalogEntry* dbEntry = db->getDatabaseCatalogEntry();
-
         list<string> namespaces;
         dbEntry->getCollectionNamespaces(&namespaces);
 
@@ -204,10 +241,76 @@ private:
      * after a sufficient amount of time has passed according to its expiry
      * specification.
      *
+     * The documents are deleted in batches of at most ttlMonitorBatchSize, each under its own
+     * collection lock, at no more than ttlMonitorMaxDeletesPerSecondPerIndex. Sets '*hasBacklog'
+     * if the rate limit stopped the deletes before every expired document was gone.
+     *
      * @return true if caller should continue processing TTL indexes of collections
      *         on the specified database, and false otherwise
      */
-    bool doTTLForIndex(OperationContext* txn, const string& dbName, BSONObj idx) {
+    bool doTTLForIndex(OperationContext* txn,
+                       const string& dbName,
+                       const BSONObj& idx,
+                       bool* hasBacklog) {
+        const long long batchSize = std::max(0, ttlMonitorBatchSize);
+        const long long maxPerSecond = std::max(0, ttlMonitorMaxDeletesPerSecondPerIndex);
+        const long long maxPerPass = maxPerSecond * std::max(1, ttlMonitorSleepSecs);
+
+        // Every batch deletes the documents which had expired when the pass started.
+        const Date_t now = Date_t::now();
+        const Timer timer;
+        long long numDeleted = 0;
+
+        while (true) {
+            long long limit = batchSize;
+            if (maxPerPass > 0) {
+                const long long remaining = maxPerPass - numDeleted;
+                limit = limit > 0 ? std::min(limit, remaining) : remaining;
+            }
+
+            long long batchDeleted = 0;
+            if (!deleteExpiredBatch(txn, dbName, idx, now, limit, &batchDeleted)) {
+                return false;
+            }
+            ttlBatches.increment();
+            numDeleted += batchDeleted;
+
+            if (limit == 0 || batchDeleted < limit) {
+                break;  // no expired documents left
+            }
+            if (maxPerPass > 0 && numDeleted >= maxPerPass) {
+                *hasBacklog = true;
+                break;
+            }
+            if (inShutdown() || !ttlMonitorEnabled) {
+                break;
+            }
+
+            if (maxPerSecond > 0) {
+                const long long dueMillis = numDeleted * 1000 / maxPerSecond;
+                if (dueMillis > timer.millis()) {
+                    sleepmillis(dueMillis - timer.millis());
+                }
+            }
+        }
+
+        LOG(1) << "\tTTL deleted: " << numDeleted << endl;
+        return true;
+    }
+
+    /**
+     * Removes up to 'limit' documents, or all of them if 'limit' is 0, which had expired at
+     * 'now' according to the TTL index 'idx'. Adds the number removed to '*numDeleted'.
+     *
+     * @return true if caller should continue processing TTL indexes of collections
+     *         on the specified database, and false otherwise
+     */
+    bool deleteExpiredBatch(OperationContext* txn,
+                            const string& dbName,
+                            BSONObj idx,
+                            Date_t now,
+                            long long limit,
+                            long long* numDeleted) {
         const string ns = idx["ns"].String();
         NamespaceString nss(ns);
         if (!userAllowedWriteNS(nss).isOK()) {
@@ -271,7 +374,7 @@ private:
 
         const Date_t kDawnOfTime =
             Date_t::fromMillisSinceEpoch(std::numeric_limits<long long>::min());
-        const Date_t expirationTime = Date_t::now() - Seconds(secondsExpireElt.numberLong());
+        const Date_t expirationTime = now - Seconds(secondsExpireElt.numberLong());
         const BSONObj startKey = BSON("" << kDawnOfTime);
         const BSONObj endKey = BSON("" << expirationTime);
         const bool endKeyInclusive = true;
@@ -293,6 +396,7 @@ private:
         DeleteStageParams params;
         params.isMulti = true;
         params.canonicalQuery = canonicalQuery.getValue().get();
+        params.limit = limit;
 
         unique_ptr<PlanExecutor> exec =
             InternalPlanner::deleteWithIndexScan(txn,
@@ -311,9 +415,9 @@ private:
             return true;
         }
 
-        const long long numDeleted = DeleteStage::getNumDeleted(*exec);
-        ttlDeletedDocuments.increment(numDeleted);
-        LOG(1) << "\tTTL deleted: " << numDeleted << endl;
+        const long long batchDeleted = DeleteStage::getNumDeleted(*exec);
+        ttlDeletedDocuments.increment(batchDeleted);
+        *numDeleted += batchDeleted;
 
         return true;
     }
@@ -30,6 +30,7 @@
 
 #include "mongo/bson/util/builder.h"
 #include "mongo/db/field_ref.h"
+#include "mongo/db/field_ref_set.h"
 #include "mongo/db/update_index_data.h"
 
 namespace mongo {
@@ -55,6 +56,12 @@ void UpdateIndexData::allPathsIndexed() {
     _allPathsIndexed = true;
 }
 
+void UpdateIndexData::merge(const UpdateIndexData& other) {
+    _canonicalPaths.insert(other._canonicalPaths.begin(), other._canonicalPaths.end());
+    _pathComponents.insert(other._pathComponents.begin(), other._pathComponents.end());
+    _allPathsIndexed = _allPathsIndexed || other._allPathsIndexed;
+}
+
 void UpdateIndexData::clear() {
     _canonicalPaths.clear();
     _pathComponents.clear();
@@ -96,6 +103,15 @@ bool UpdateIndexData::mightBeIndexed(StringData path) const {
     return false;
 }
 
+bool UpdateIndexData::mightBeIndexed(const FieldRefSet& paths) const {
+    for (FieldRefSet::const_iterator it = paths.begin(); it != paths.end(); ++it) {
+        if (mightBeIndexed((*it)->dottedField())) {
+            return true;
+        }
+    }
+    return false;
+}
+
 bool UpdateIndexData::_startsWith(StringData a, StringData b) const {
     if (!a.startsWith(b))
         return false;
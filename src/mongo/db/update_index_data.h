@@ -47,6 +47,8 @@ bool getCanonicalIndexField(StringData fullName, std::string* out);
  * Holds pre-processed index spec information to allow update to quickly determine if an update
  * can be applied as a delta to a document, or if the document must be re-indexed.
  */
+class FieldRefSet;
+
 class UpdateIndexData {
 public:
     UpdateIndexData();
@@ -69,10 +71,20 @@ public:
      */
     void allPathsIndexed();
 
+    /**
+     * Register every path, path component and wildcard registered with 'other'.
+     */
+    void merge(const UpdateIndexData& other);
+
     void clear();
 
     bool mightBeIndexed(StringData path) const;
 
+    /**
+     * Returns true if an update targeting any of 'paths' might change the index keys.
+     */
+    bool mightBeIndexed(const FieldRefSet& paths) const;
+
 private:
     bool _startsWith(StringData a, StringData b) const;
 
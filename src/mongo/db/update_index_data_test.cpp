@@ -29,6 +29,8 @@
 
 #include "mongo/unittest/unittest.h"
 
+#include "mongo/db/field_ref.h"
+#include "mongo/db/field_ref_set.h"
 #include "mongo/db/update_index_data.h"
 
 namespace mongo {
@@ -92,6 +94,33 @@ TEST(UpdateIndexDataTest, AllPathsIndexed2) {
     ASSERT_FALSE(a.mightBeIndexed("a"));
 }
 
+TEST(UpdateIndexDataTest, Merge) {
+    UpdateIndexData a;
+    a.addPath("a.b");
+    UpdateIndexData b;
+    b.addPathComponent("c");
+    a.merge(b);
+    ASSERT_TRUE(a.mightBeIndexed("a"));
+    ASSERT_TRUE(a.mightBeIndexed("x.c"));
+    ASSERT_FALSE(a.mightBeIndexed("x"));
+    b.allPathsIndexed();
+    a.merge(b);
+    ASSERT_TRUE(a.mightBeIndexed("x"));
+}
+
+TEST(UpdateIndexDataTest, FieldRefSet) {
+    UpdateIndexData a;
+    a.addPath("a.b");
+    FieldRef x("x");
+    FieldRef ab("a.b.c");
+    FieldRefSet paths;
+    ASSERT_FALSE(a.mightBeIndexed(paths));
+    paths.insert(&x);
+    ASSERT_FALSE(a.mightBeIndexed(paths));
+    paths.insert(&ab);
+    ASSERT_TRUE(a.mightBeIndexed(paths));
+}
+
 TEST(UpdateIndexDataTest, getCanonicalIndexField1) {
     string x;
 
@@ -41,6 +41,8 @@
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/write_concern_options.h"
+#include "mongo/util/net/message_server_async.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -54,6 +56,15 @@ static Counter64 gleWtimeouts;
 static ServerStatusMetricField<Counter64> gleWtimeoutsDisplay("getLastError.wtimeouts",
                                                               &gleWtimeouts);
 
+// The number of operations currently waiting for their writes to be journaled or replicated.
+static Counter64 waitingForJournal;
+static ServerStatusMetricField<Counter64> waitingForJournalDisplay("writeConcern.waiting.journal",
+                                                                   &waitingForJournal);
+
+static Counter64 waitingForReplication;
+static ServerStatusMetricField<Counter64> waitingForReplicationDisplay(
+    "writeConcern.waiting.replication", &waitingForReplication);
+
 void setupSynchronousCommit(OperationContext* txn) {
     const WriteConcernOptions& writeConcern = txn->getWriteConcern();
 
@@ -213,6 +224,9 @@ Status waitForWriteConcern(OperationContext* txn,
 
     Timer syncTimer;
 
+    // Neither kind of wait needs the CPU, so let an async server use another worker meanwhile.
+    AsyncWorkerBlockingSection blockingSection;
+
     switch (writeConcern.syncMode) {
         case WriteConcernOptions::NONE:
             break;
@@ -222,13 +236,18 @@ Status waitForWriteConcern(OperationContext* txn,
                 result->fsyncFiles = storageEngine->flushAllFiles(true);
             } else {
                 // We only need to commit the journal if we're durable
+                waitingForJournal.increment();
+                ON_BLOCK_EXIT([] { waitingForJournal.decrement(); });
                 txn->recoveryUnit()->waitUntilDurable();
             }
             break;
         }
-        case WriteConcernOptions::JOURNAL:
+        case WriteConcernOptions::JOURNAL: {
+            waitingForJournal.increment();
+            ON_BLOCK_EXIT([] { waitingForJournal.decrement(); });
             txn->recoveryUnit()->waitUntilDurable();
             break;
+        }
     }
 
     result->syncMillis = syncTimer.millis();
@@ -248,8 +267,12 @@ Status waitForWriteConcern(OperationContext* txn,
 
     // Now we wait for replication
     // Note that replica set stepdowns and gle mode changes are thrown as errors
-    repl::ReplicationCoordinator::StatusAndDuration replStatus =
-        repl::getGlobalReplicationCoordinator()->awaitReplication(txn, replOpTime, writeConcern);
+    repl::ReplicationCoordinator::StatusAndDuration replStatus = [&] {
+        waitingForReplication.increment();
+        ON_BLOCK_EXIT([] { waitingForReplication.decrement(); });
+        return repl::getGlobalReplicationCoordinator()->awaitReplication(
+            txn, replOpTime, writeConcern);
+    }();
     if (replStatus.status == ErrorCodes::WriteConcernFailed) {
         gleWtimeouts.increment();
         result->err = "timeout";
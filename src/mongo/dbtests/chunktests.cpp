@@ -60,6 +60,7 @@ public:
         }
 
         _chunkRanges.reloadAll(_chunkMap);
+        _chunkKeyIndex.reloadAll(_chunkMap);
     }
 };
 
@@ -330,6 +331,40 @@ class InMultiShard : public CompoundKeyBase {
     }
 };
 
+/**
+ * Checks that findIntersectingChunk, which searches the KeyString encoded chunk keys, finds the
+ * same chunk as a lookup in the chunk map, including across types.
+ */
+class FindIntersectingChunk {
+public:
+    void run() {
+        ShardKeyPattern shardKeyPattern(BSON("a" << 1));
+        TestableChunkManager chunkManager("", shardKeyPattern, false);
+        chunkManager.setSingleChunkForShards({BSON("a" << 5),
+                                              BSON("a" << 5.5),
+                                              BSON("a"
+                                                   << "x"),
+                                              BSON("a"
+                                                   << "xy"),
+                                              BSON("a" << BSON("b" << 1))});
+
+        BSONArray keys = BSON_ARRAY(MINKEY << -1 << 5 << 5LL << 5.2 << 6 << ""
+                                           << "x"
+                                           << "xa"
+                                           << "xy"
+                                           << "z" << BSON("b" << 0) << BSON("b" << 1) << true);
+        BSONObjIterator it(keys);
+        while (it.more()) {
+            BSONObj shardKey = it.next().wrap("a");
+            const ChunkMap& chunkMap = chunkManager.getChunkMap();
+            ChunkMap::const_iterator expected = chunkMap.upper_bound(shardKey);
+            ASSERT(expected != chunkMap.end());
+            ASSERT_EQUALS(expected->second,
+                          chunkManager.findIntersectingChunk(nullptr, shardKey));
+        }
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("chunk") {}
@@ -354,6 +389,7 @@ public:
         add<InequalityThenUnsatisfiable>();
         add<OrEqualityUnsatisfiableInequality>();
         add<InMultiShard>();
+        add<FindIntersectingChunk>();
     }
 };
 
@@ -211,6 +211,32 @@ public:
     }
 };
 
+// Test that dropping the collection kills every registered runner, whichever partition of the
+// cursor manager it was registered in.
+class ExecutorRegistryDropCollectionManyExecutors : public ExecutorRegistryBase {
+public:
+    void run() {
+        std::vector<std::unique_ptr<PlanExecutor>> runs;
+        for (int i = 0; i < 32; ++i) {
+            runs.emplace_back(getCollscan());
+            BSONObj obj;
+            ASSERT_EQUALS(PlanExecutor::ADVANCED, runs.back()->getNext(&obj, NULL));
+            runs.back()->saveState();
+            registerExecutor(runs.back().get());
+        }
+
+        // Drop our collection.
+        _client.dropCollection(nss.ns());
+
+        for (size_t i = 0; i < runs.size(); ++i) {
+            BSONObj obj;
+            deregisterExecutor(runs[i].get());
+            runs[i]->restoreState();
+            ASSERT_EQUALS(PlanExecutor::DEAD, runs[i]->getNext(&obj, NULL));
+        }
+    }
+};
+
 // Test that registered runners are killed when all indices are dropped on the collection.
 class ExecutorRegistryDropAllIndices : public ExecutorRegistryBase {
 public:
@@ -331,6 +357,7 @@ public:
     void setupTests() {
         add<ExecutorRegistryDiskLocInvalid>();
         add<ExecutorRegistryDropCollection>();
+        add<ExecutorRegistryDropCollectionManyExecutors>();
         add<ExecutorRegistryDropAllIndices>();
         add<ExecutorRegistryDropOneIndex>();
         add<ExecutorRegistryDropDatabase>();
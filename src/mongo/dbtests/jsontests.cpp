@@ -99,6 +99,15 @@ public:
     }
 };
 
+class EscapesAmongUnescapedRuns {
+public:
+    void run() {
+        BSONObjBuilder b;
+        b.append("a", StringData("ab\0cd/\"ef\n", 10));
+        ASSERT_EQUALS("{ \"a\" : \"ab\\u0000cd/\\\"ef\\n\" }", b.done().jsonString(Strict));
+    }
+};
+
 class EscapeFieldName {
 public:
     void run() {
@@ -2707,6 +2716,7 @@ public:
         add<JsonStringTests::EscapedCharacters>();
         add<JsonStringTests::AdditionalControlCharacters>();
         add<JsonStringTests::ExtendedAscii>();
+        add<JsonStringTests::EscapesAmongUnescapedRuns>();
         add<JsonStringTests::EscapeFieldName>();
         add<JsonStringTests::SingleIntMember>();
         add<JsonStringTests::SingleNumberMember>();
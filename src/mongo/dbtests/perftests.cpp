@@ -52,6 +52,7 @@
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage/mmap_v1/dur_stats.h"
 #include "mongo/db/storage/mmap_v1/mmap.h"
 #include "mongo/db/storage_options.h"
@@ -444,6 +445,140 @@ public:
     }
 };
 
+/**
+ * Measures the throughput of encoding a key into a KeyString, which every WiredTiger index
+ * operation does. Subclasses provide the key.
+ */
+class KeyStringEncodeBase : public B {
+public:
+    virtual int howLongMillis() {
+        return 500;
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+    virtual unsigned batchSize() {
+        return 1000;
+    }
+    void prep() {
+        _key = makeKey();
+    }
+    void timed() {
+        _ks.resetToKey(_key, ordering(), RecordId(1, 2));
+    }
+
+protected:
+    virtual BSONObj makeKey() = 0;
+
+    // Subclasses may index in descending order, which flips the bits of every encoded byte.
+    virtual Ordering ordering() {
+        return Ordering::make(BSONObj());
+    }
+
+private:
+    BSONObj _key;
+    KeyString _ks;
+};
+
+class KeyStringEncodeInt : public KeyStringEncodeBase {
+public:
+    string name() {
+        return "KeyString::encode int";
+    }
+    BSONObj makeKey() {
+        return BSON("" << 123456789);
+    }
+};
+
+class KeyStringEncodeDouble : public KeyStringEncodeBase {
+public:
+    string name() {
+        return "KeyString::encode double";
+    }
+    BSONObj makeKey() {
+        return BSON("" << 12345.6789);
+    }
+};
+
+class KeyStringEncodeString : public KeyStringEncodeBase {
+public:
+    string name() {
+        return "KeyString::encode 100 byte string";
+    }
+    BSONObj makeKey() {
+        return BSON("" << string(100, 'x'));
+    }
+};
+
+class KeyStringEncodeStringDescending : public KeyStringEncodeString {
+public:
+    string name() {
+        return "KeyString::encode 100 byte string desc";
+    }
+    Ordering ordering() {
+        return Ordering::make(BSON("a" << -1));
+    }
+};
+
+class KeyStringEncodeStringWithNuls : public KeyStringEncodeBase {
+public:
+    string name() {
+        return "KeyString::encode string with NULs";
+    }
+    BSONObj makeKey() {
+        string str;
+        for (int i = 0; i < 10; i++) {
+            str += string(9, 'x') + '\0';
+        }
+        return BSON("" << str);
+    }
+};
+
+class KeyStringEncodeCompound : public KeyStringEncodeBase {
+public:
+    string name() {
+        return "KeyString::encode compound";
+    }
+    BSONObj makeKey() {
+        return BSON("" << 42 << "" << "abcdefghijklmnop"
+                       << "" << 3.5 << "" << OID("abcdefabcdefabcdefabcdef"));
+    }
+};
+
+class KeyStringDecodeStringDescending : public KeyStringEncodeStringDescending {
+public:
+    string name() {
+        return "KeyString::toBson 100 byte string desc";
+    }
+    void prep() {
+        _encoded.resetToKey(makeKey(), ordering());
+    }
+    void timed() {
+        KeyString::toBson(
+            _encoded.getBuffer(), _encoded.getSize(), ordering(), _encoded.getTypeBits());
+    }
+
+private:
+    KeyString _encoded;
+};
+
+class KeyStringCompare : public KeyStringEncodeString {
+public:
+    string name() {
+        return "KeyString::compare 100 byte strings";
+    }
+    void prep() {
+        _a.resetToKey(makeKey(), ordering(), RecordId(1, 2));
+        _b.resetToKey(makeKey(), ordering(), RecordId(1, 3));
+    }
+    void timed() {
+        invariant(_a.compare(_b) < 0);
+    }
+
+private:
+    KeyString _a;
+    KeyString _b;
+};
 
 class All : public Suite {
 public:
@@ -457,6 +592,15 @@ public:
         add<boosttimed_mutexspeed>();
         add<stdmutexspeed>();
         add<stdtimed_mutexspeed>();
+
+        add<KeyStringEncodeInt>();
+        add<KeyStringEncodeDouble>();
+        add<KeyStringEncodeString>();
+        add<KeyStringEncodeStringDescending>();
+        add<KeyStringEncodeStringWithNuls>();
+        add<KeyStringEncodeCompound>();
+        add<KeyStringDecodeStringDescending>();
+        add<KeyStringCompare>();
     }
 } myall;
 }
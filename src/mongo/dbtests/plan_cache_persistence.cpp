@@ -0,0 +1,309 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/plan_cache_persistence.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/query/query_planner.h"
+#include "mongo/db/query/query_planner_params.h"
+#include "mongo/db/query/query_settings.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/dbtests/dbtests.h"
+
+namespace PlanCachePersistence {
+
+static const NamespaceString nss("unittests.PlanCachePersistence");
+static const NamespaceString persistedNss("local.plancache");
+
+class PlanCachePersistenceBase {
+public:
+    PlanCachePersistenceBase() {
+        dropCollection(nss);
+        dropCollection(persistedNss);
+
+        // Add indices.
+        addIndex(BSON("a" << 1));
+        addIndex(BSON("b" << 1));
+
+        OldClientWriteContext ctx(&_txn, nss.ns());
+        Collection* collection = ctx.getCollection();
+        ASSERT(collection);
+
+        // Add data.
+        for (int i = 0; i < 10; i++) {
+            insertDocument(collection, BSON("_id" << i << "a" << i << "b" << 1));
+        }
+    }
+
+    virtual ~PlanCachePersistenceBase() {
+        dropCollection(persistedNss);
+    }
+
+    void addIndex(const BSONObj& obj) {
+        ASSERT_OK(dbtests::createIndex(&_txn, nss.ns(), obj));
+    }
+
+    void dropCollection(const NamespaceString& toDrop) {
+        ScopedTransaction transaction(&_txn, MODE_X);
+        Lock::DBLock dbLock(_txn.lockState(), toDrop.db(), MODE_X);
+        Database* database = dbHolder().get(&_txn, toDrop.db());
+        if (!database) {
+            return;
+        }
+
+        WriteUnitOfWork wuow(&_txn);
+        database->dropCollection(&_txn, toDrop.ns());
+        wuow.commit();
+    }
+
+    void insertDocument(Collection* collection, BSONObj obj) {
+        WriteUnitOfWork wuow(&_txn);
+
+        const bool enforceQuota = false;
+        ASSERT_OK(collection->insertDocument(&_txn, obj, enforceQuota));
+        wuow.commit();
+    }
+
+    std::unique_ptr<CanonicalQuery> canonicalize() {
+        // Query can be answered by either index on "a" or index on "b".
+        auto statusWithCQ = CanonicalQuery::canonicalize(nss, fromjson("{a: {$gte: 8}, b: 1}"));
+        ASSERT_OK(statusWithCQ.getStatus());
+        return std::move(statusWithCQ.getValue());
+    }
+
+    /**
+     * Caches the solution using the index on "b" for the test query, as if it had won a trial
+     * period taking 'works' work cycles. Returns the cached solution's description.
+     */
+    std::string cacheIndexBSolution(size_t works) {
+        AutoGetCollectionForRead ctx(&_txn, nss.ns());
+        Collection* collection = ctx.getCollection();
+        ASSERT(collection);
+
+        const std::unique_ptr<CanonicalQuery> cq = canonicalize();
+        QueryPlannerParams plannerParams;
+        fillOutPlannerParams(&_txn, collection, cq.get(), &plannerParams);
+
+        OwnedPointerVector<QuerySolution> solutions;
+        ASSERT_OK(QueryPlanner::plan(*cq, plannerParams, &solutions.mutableVector()));
+
+        for (size_t i = 0; i < solutions.size(); ++i) {
+            QuerySolution* soln = solutions[i];
+            if (!soln->cacheData) {
+                continue;
+            }
+            const std::string solnString = soln->cacheData->toString();
+            if (solnString.find("{ b: 1 }") == std::string::npos) {
+                continue;
+            }
+
+            PlanRankingDecision* decision = new PlanRankingDecision();
+            CommonStats common("IXSCAN");
+            common.works = works;
+            decision->stats.mutableVector().push_back(new PlanStageStats(common, STAGE_IXSCAN));
+            decision->scores.push_back(1);
+            decision->candidateOrder.push_back(0);
+
+            PlanCache* cache = collection->infoCache()->getPlanCache();
+            ASSERT_OK(cache->add(*cq, {soln}, decision));
+            return solnString;
+        }
+
+        FAIL("no solution uses the index on b");
+        return "";
+    }
+
+    void clearPlanCache() {
+        AutoGetCollectionForRead ctx(&_txn, nss.ns());
+        ctx.getCollection()->infoCache()->getPlanCache()->clear();
+    }
+
+    /**
+     * Pins the index on "b" for the test query, as if replanning had picked a worse plan.
+     */
+    void autoPinIndexB() {
+        AutoGetCollectionForRead ctx(&_txn, nss.ns());
+        CollectionInfoCache* infoCache = ctx.getCollection()->infoCache();
+        const std::unique_ptr<CanonicalQuery> cq = canonicalize();
+        ASSERT(infoCache->getQuerySettings()->setAutoPinnedIndices(
+            *cq, infoCache->getPlanCache()->computeKey(*cq), {BSON("b" << 1)}));
+    }
+
+    /**
+     * Returns the collection's automatically pinned index filters. Also clears them if 'clear'
+     * is true.
+     */
+    std::vector<BSONObj> getAutoPins(bool clear) {
+        AutoGetCollectionForRead ctx(&_txn, nss.ns());
+        QuerySettings* querySettings = ctx.getCollection()->infoCache()->getQuerySettings();
+
+        OwnedPointerVector<AllowedIndexEntry> entries;
+        entries.mutableVector() = clear ? querySettings->clearAutoPinnedIndices()
+                                        : querySettings->getAllAllowedIndices();
+
+        std::vector<BSONObj> pinnedIndexes;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i]->autoPinned) {
+                ASSERT_EQUALS(1U, entries[i]->indexKeyPatterns.size());
+                pinnedIndexes.push_back(entries[i]->indexKeyPatterns[0]);
+            }
+        }
+        return pinnedIndexes;
+    }
+
+protected:
+    OperationContextImpl _txn;
+};
+
+/**
+ * A cached plan survives being persisted, cleared and warmed again, keeping its original works.
+ */
+class PlanCachePersistenceRoundTrip : public PlanCachePersistenceBase {
+public:
+    void run() {
+        const size_t works = 7;
+        const std::string solnString = cacheIndexBSolution(works);
+
+        persistPlanCaches(&_txn);
+        {
+            DBDirectClient client(&_txn);
+            ASSERT_EQUALS(1U, client.count(persistedNss.ns(), BSON("ns" << nss.ns())));
+        }
+
+        clearPlanCache();
+        ASSERT_EQUALS(1U, warmPlanCaches(&_txn));
+
+        AutoGetCollectionForRead ctx(&_txn, nss.ns());
+        PlanCache* cache = ctx.getCollection()->infoCache()->getPlanCache();
+        const std::unique_ptr<CanonicalQuery> cq = canonicalize();
+        CachedSolution* rawCachedSolution;
+        ASSERT_OK(cache->get(*cq, &rawCachedSolution));
+        const std::unique_ptr<CachedSolution> cachedSolution(rawCachedSolution);
+        ASSERT_EQUALS(works, cachedSolution->decisionWorks);
+        ASSERT_EQUALS(1U, cachedSolution->plannerData.size());
+        ASSERT_EQUALS(solnString, cachedSolution->plannerData[0]->toString());
+    }
+};
+
+/**
+ * Warming skips shapes that are already cached.
+ */
+class PlanCachePersistenceSkipsCachedShapes : public PlanCachePersistenceBase {
+public:
+    void run() {
+        cacheIndexBSolution(7);
+        persistPlanCaches(&_txn);
+        ASSERT_EQUALS(0U, warmPlanCaches(&_txn));
+    }
+};
+
+/**
+ * A persisted solution whose index has been dropped is not warmed.
+ */
+class PlanCachePersistenceSkipsDroppedIndex : public PlanCachePersistenceBase {
+public:
+    void run() {
+        cacheIndexBSolution(7);
+        persistPlanCaches(&_txn);
+
+        {
+            DBDirectClient client(&_txn);
+            client.dropIndex(nss.ns(), BSON("b" << 1));
+        }
+
+        clearPlanCache();
+        ASSERT_EQUALS(0U, warmPlanCaches(&_txn));
+    }
+};
+
+/**
+ * An automatic index filter pin survives being persisted, cleared and restored, unless its index
+ * has been dropped in the meantime.
+ */
+class PlanCachePersistenceAutoPinRoundTrip : public PlanCachePersistenceBase {
+public:
+    void run() {
+        autoPinIndexB();
+        persistPlanCaches(&_txn);
+        {
+            DBDirectClient client(&_txn);
+            ASSERT_EQUALS(1U,
+                          client.count(persistedNss.ns(),
+                                       BSON("ns" << nss.ns() << "autoPinnedIndexes"
+                                                 << BSON("$exists" << true))));
+        }
+
+        ASSERT_EQUALS(1U, getAutoPins(true).size());
+        ASSERT_EQUALS(0U, warmPlanCaches(&_txn));
+        std::vector<BSONObj> pins = getAutoPins(false);
+        ASSERT_EQUALS(1U, pins.size());
+        ASSERT_EQUALS(BSON("b" << 1), pins[0]);
+
+        // Dropping the index removes the pin, and warming does not bring it back.
+        {
+            DBDirectClient client(&_txn);
+            client.dropIndex(nss.ns(), BSON("b" << 1));
+        }
+        ASSERT_TRUE(getAutoPins(false).empty());
+        warmPlanCaches(&_txn);
+        ASSERT_TRUE(getAutoPins(false).empty());
+    }
+};
+
+class All : public Suite {
+public:
+    All() : Suite("plan_cache_persistence") {}
+
+    void setupTests() {
+        add<PlanCachePersistenceRoundTrip>();
+        add<PlanCachePersistenceSkipsCachedShapes>();
+        add<PlanCachePersistenceSkipsDroppedIndex>();
+        add<PlanCachePersistenceAutoPinRoundTrip>();
+    }
+};
+
+SuiteInstance<All> all;
+
+}  // namespace PlanCachePersistence
@@ -46,9 +46,11 @@
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 namespace QueryStageAnd {
 
@@ -401,10 +403,72 @@ public:
     }
 };
 
+// An AND with two children which intersects RecordId bitmaps from the start, and so fetches the
+// documents it returns.
+class QueryStageAndHashTwoLeafRecordIdBitmaps : public QueryStageAndBase {
+public:
+    void run() {
+        OldClientWriteContext ctx(&_txn, ns());
+        Database* db = ctx.db();
+        Collection* coll = ctx.getCollection();
+        if (!coll) {
+            WriteUnitOfWork wuow(&_txn);
+            coll = db->createCollection(&_txn, ns());
+            wuow.commit();
+        }
+
+        for (int i = 0; i < 50; ++i) {
+            insert(BSON("foo" << i << "bar" << i));
+        }
+
+        addIndex(BSON("foo" << 1));
+        addIndex(BSON("bar" << 1));
+
+        const bool oldUseBitmaps = internalQueryExecAndHashUseRecordIdBitmaps;
+        internalQueryExecAndHashUseRecordIdBitmaps = true;
+        ON_BLOCK_EXIT([oldUseBitmaps] {
+            internalQueryExecAndHashUseRecordIdBitmaps = oldUseBitmaps;
+        });
+
+        WorkingSet ws;
+        auto ah = make_unique<AndHashStage>(&_txn, &ws, coll);
+
+        // Foo <= 20
+        IndexScanParams params;
+        params.descriptor = getIndex(BSON("foo" << 1), coll);
+        params.bounds.isSimpleRange = true;
+        params.bounds.startKey = BSON("" << 20);
+        params.bounds.endKey = BSONObj();
+        params.bounds.endKeyInclusive = true;
+        params.direction = -1;
+        ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
+
+        // Bar >= 10
+        params.descriptor = getIndex(BSON("bar" << 1), coll);
+        params.bounds.startKey = BSON("" << 10);
+        params.bounds.endKey = BSONObj();
+        params.bounds.endKeyInclusive = true;
+        params.direction = 1;
+        ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
+
+        // Results come back fetched, in the order of the last child.
+        for (int i = 10; i <= 20; ++i) {
+            BSONObj obj = getNext(ah.get(), &ws);
+            ASSERT_EQUALS(i, obj["foo"].numberInt());
+            ASSERT_EQUALS(i, obj["bar"].numberInt());
+        }
+        ASSERT_EQUALS(0, countResults(ah.get()));
+
+        const AndHashStats* stats = static_cast<const AndHashStats*>(ah->getSpecificStats());
+        ASSERT_TRUE(stats->usedRecordIdBitmaps);
+    }
+};
+
 // An AND with two children.
 // Add large keys (512 bytes) to index of first child to cause
 // internal buffer within hashed AND to exceed threshold (32MB)
-// before gathering all requested results.
+// before gathering all requested results. The stage carries on
+// with RecordId bitmaps.
 class QueryStageAndHashTwoLeafFirstChildLargeKeys : public QueryStageAndBase {
 public:
     void run() {
@@ -426,7 +490,7 @@ public:
         addIndex(BSON("foo" << 1 << "big" << 1));
         addIndex(BSON("bar" << 1));
 
-        // Lower buffer limit to 20 * sizeof(big) to force memory error
+        // Lower buffer limit to 20 * sizeof(big) to exceed it
         // before hashed AND is done reading the first child (stage has to
         // hold 21 keys in buffer for Foo <= 20).
         WorkingSet ws;
@@ -450,8 +514,11 @@ public:
         params.direction = 1;
         ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
 
-        // Stage execution should fail.
-        ASSERT_EQUALS(-1, countResults(ah.get()));
+        // foo == bar, and foo<=20, bar>=10, so our values are:
+        // foo == 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20.
+        ASSERT_EQUALS(11, countResults(ah.get()));
+        const AndHashStats* stats = static_cast<const AndHashStats*>(ah->getSpecificStats());
+        ASSERT_TRUE(stats->usedRecordIdBitmaps);
     }
 };
 
@@ -571,7 +638,7 @@ public:
 // before gathering all requested results.
 // We need 3 children because the hashed AND stage buffered data for
 // N-1 of its children. If the second child is the last child, it will not
-// be buffered.
+// be buffered. The stage carries on with RecordId bitmaps.
 class QueryStageAndHashThreeLeafMiddleChildLargeKeys : public QueryStageAndBase {
 public:
     void run() {
@@ -594,7 +661,7 @@ public:
         addIndex(BSON("bar" << 1 << "big" << 1));
         addIndex(BSON("baz" << 1));
 
-        // Lower buffer limit to 10 * sizeof(big) to force memory error
+        // Lower buffer limit to 10 * sizeof(big) to exceed it
         // before hashed AND is done reading the second child (stage has to
         // hold 11 keys in buffer for Foo <= 20 and Bar >= 10).
         WorkingSet ws;
@@ -626,8 +693,11 @@ public:
         params.direction = 1;
         ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
 
-        // Stage execution should fail.
-        ASSERT_EQUALS(-1, countResults(ah.get()));
+        // foo == bar == baz, and foo<=20, bar>=10, 5<=baz<=15, so our values are:
+        // foo == 10, 11, 12, 13, 14, 15.
+        ASSERT_EQUALS(6, countResults(ah.get()));
+        const AndHashStats* stats = static_cast<const AndHashStats*>(ah->getSpecificStats());
+        ASSERT_TRUE(stats->usedRecordIdBitmaps);
     }
 };
 
@@ -1449,6 +1519,7 @@ public:
     void setupTests() {
         add<QueryStageAndHashInvalidation>();
         add<QueryStageAndHashTwoLeaf>();
+        add<QueryStageAndHashTwoLeafRecordIdBitmaps>();
         add<QueryStageAndHashTwoLeafFirstChildLargeKeys>();
         add<QueryStageAndHashTwoLeafLastChildLargeKeys>();
         add<QueryStageAndHashThreeLeaf>();
@@ -26,6 +26,7 @@
  *    then also delete it in the license file.
  */
 
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
@@ -39,9 +40,11 @@
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_regression_tracker.h"
 #include "mongo/db/query/plan_yield_policy.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner_params.h"
+#include "mongo/db/query/query_settings.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
 
@@ -131,8 +134,15 @@ public:
 
         // High enough so that we shouldn't trigger a replan based on works.
         const size_t decisionWorks = 50;
-        CachedPlanStage cachedPlanStage(
-            &_txn, collection, &_ws, cq.get(), plannerParams, decisionWorks, mockChild.release());
+        const double decisionCostPerResult = 0;
+        CachedPlanStage cachedPlanStage(&_txn,
+                                        collection,
+                                        &_ws,
+                                        cq.get(),
+                                        plannerParams,
+                                        decisionWorks,
+                                        decisionCostPerResult,
+                                        mockChild.release());
 
         // This should succeed after triggering a replan.
         PlanYieldPolicy yieldPolicy(nullptr, PlanExecutor::YIELD_MANUAL);
@@ -199,8 +209,15 @@ public:
             mockChild->pushBack(PlanStage::NEED_TIME);
         }
 
-        CachedPlanStage cachedPlanStage(
-            &_txn, collection, &_ws, cq.get(), plannerParams, decisionWorks, mockChild.release());
+        const double decisionCostPerResult = 0;
+        CachedPlanStage cachedPlanStage(&_txn,
+                                        collection,
+                                        &_ws,
+                                        cq.get(),
+                                        plannerParams,
+                                        decisionWorks,
+                                        decisionCostPerResult,
+                                        mockChild.release());
 
         // This should succeed after triggering a replan.
         PlanYieldPolicy yieldPolicy(nullptr, PlanExecutor::YIELD_MANUAL);
@@ -232,6 +249,159 @@ public:
     }
 };
 
+/**
+ * Test that hitting the cached plan stage trial period's threshold for work cycles does not cause
+ * a replan if the cached plan examines no more keys and documents per result than it did when it
+ * was cached.
+ */
+class QueryStageCachedPlanHitMaxWorksWithinBaselineCost : public QueryStageCachedPlanBase {
+public:
+    void run() {
+        AutoGetCollectionForRead ctx(&_txn, nss.ns());
+        Collection* collection = ctx.getCollection();
+        ASSERT(collection);
+
+        // Query can be answered by either index on "a" or index on "b".
+        auto statusWithCQ = CanonicalQuery::canonicalize(nss, fromjson("{a: {$gte: 8}, b: 1}"));
+        ASSERT_OK(statusWithCQ.getStatus());
+        const std::unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+
+        // We shouldn't have anything in the plan cache for this shape yet.
+        PlanCache* cache = collection->infoCache()->getPlanCache();
+        ASSERT(cache);
+        CachedSolution* rawCachedSolution;
+        ASSERT_NOT_OK(cache->get(*cq, &rawCachedSolution));
+
+        // Get planner params.
+        QueryPlannerParams plannerParams;
+        fillOutPlannerParams(&_txn, collection, cq.get(), &plannerParams);
+
+        // Set up queued data stage to produce one result and then take long enough before
+        // returning EOF to exhaust the works budget. It examines no keys or documents, so its
+        // cost per result stays below the baseline.
+        const size_t decisionWorks = 10;
+        const size_t mockWorks =
+            1U + static_cast<size_t>(internalQueryCacheEvictionRatio * decisionWorks);
+        auto mockChild = stdx::make_unique<QueuedDataStage>(&_txn, &_ws);
+        {
+            WorkingSetID id = _ws.allocate();
+            WorkingSetMember* wsm = _ws.get(id);
+            wsm->obj = Snapshotted<BSONObj>(SnapshotId(), BSON("_id" << 8 << "a" << 8 << "b" << 1));
+            _ws.transitionToOwnedObj(id);
+            mockChild->pushBack(id);
+        }
+        for (size_t i = 0; i < mockWorks; i++) {
+            mockChild->pushBack(PlanStage::NEED_TIME);
+        }
+
+        const double decisionCostPerResult = 1;
+        CachedPlanStage cachedPlanStage(&_txn,
+                                        collection,
+                                        &_ws,
+                                        cq.get(),
+                                        plannerParams,
+                                        decisionWorks,
+                                        decisionCostPerResult,
+                                        mockChild.release());
+
+        PlanYieldPolicy yieldPolicy(nullptr, PlanExecutor::YIELD_MANUAL);
+        ASSERT_OK(cachedPlanStage.pickBestPlan(&yieldPolicy));
+
+        // We should still be running the mock plan, so its one result is all we get back.
+        size_t numResults = 0;
+        PlanStage::StageState state = PlanStage::NEED_TIME;
+        while (state != PlanStage::IS_EOF) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            state = cachedPlanStage.work(&id);
+
+            ASSERT_NE(state, PlanStage::FAILURE);
+            ASSERT_NE(state, PlanStage::DEAD);
+
+            if (state == PlanStage::ADVANCED) {
+                numResults++;
+            }
+        }
+
+        ASSERT_EQ(numResults, 1U);
+
+        // No replan happened, so nothing was written to the plan cache.
+        ASSERT_NOT_OK(cache->get(*cq, &rawCachedSolution));
+    }
+};
+
+/**
+ * Test that when hitting the works threshold makes the cached plan stage replan to a plan which
+ * examines many more keys and documents per result than the best plan observed for the query
+ * shape, the indexes of that plan are pinned automatically.
+ */
+class QueryStageCachedPlanAutoPinsBestPlan : public QueryStageCachedPlanBase {
+public:
+    QueryStageCachedPlanAutoPinsBestPlan() : _oldRatio(internalQueryAutoPinRegressionRatio) {
+        internalQueryAutoPinRegressionRatio = 2.0;
+    }
+
+    ~QueryStageCachedPlanAutoPinsBestPlan() {
+        internalQueryAutoPinRegressionRatio = _oldRatio;
+    }
+
+    void run() {
+        AutoGetCollectionForRead ctx(&_txn, nss.ns());
+        Collection* collection = ctx.getCollection();
+        ASSERT(collection);
+
+        // Replanning picks the index on "a", which only scans the keys of two documents.
+        auto statusWithCQ = CanonicalQuery::canonicalize(nss, fromjson("{a: {$gte: 8}, b: 1}"));
+        ASSERT_OK(statusWithCQ.getStatus());
+        const std::unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+
+        PlanCache* cache = collection->infoCache()->getPlanCache();
+        QuerySettings* querySettings = collection->infoCache()->getQuerySettings();
+
+        // Pretend that a plan using the index on "b" was observed to be far cheaper still.
+        collection->infoCache()->getPlanRegressionTracker()->recordPlan(
+            cache->computeKey(*cq), {BSON("b" << 1)}, 0.01, Date_t::now());
+
+        QueryPlannerParams plannerParams;
+        fillOutPlannerParams(&_txn, collection, cq.get(), &plannerParams);
+
+        // Set up queued data stage to take long enough before returning EOF to trigger a replan.
+        const size_t decisionWorks = 10;
+        const size_t mockWorks =
+            1U + static_cast<size_t>(internalQueryCacheEvictionRatio * decisionWorks);
+        auto mockChild = stdx::make_unique<QueuedDataStage>(&_txn, &_ws);
+        for (size_t i = 0; i < mockWorks; i++) {
+            mockChild->pushBack(PlanStage::NEED_TIME);
+        }
+
+        const double decisionCostPerResult = 0;
+        CachedPlanStage cachedPlanStage(&_txn,
+                                        collection,
+                                        &_ws,
+                                        cq.get(),
+                                        plannerParams,
+                                        decisionWorks,
+                                        decisionCostPerResult,
+                                        mockChild.release());
+
+        PlanYieldPolicy yieldPolicy(nullptr, PlanExecutor::YIELD_MANUAL);
+        ASSERT_OK(cachedPlanStage.pickBestPlan(&yieldPolicy));
+
+        // The index on "b" is pinned, and the plan picked by replanning is not cached.
+        OwnedPointerVector<AllowedIndexEntry> entries;
+        entries.mutableVector() = querySettings->getAllAllowedIndices();
+        ASSERT_EQUALS(1U, entries.size());
+        ASSERT(entries[0]->autoPinned);
+        ASSERT_EQUALS(1U, entries[0]->indexKeyPatterns.size());
+        ASSERT_EQUALS(BSON("b" << 1), entries[0]->indexKeyPatterns[0]);
+
+        CachedSolution* rawCachedSolution;
+        ASSERT_NOT_OK(cache->get(*cq, &rawCachedSolution));
+    }
+
+private:
+    double _oldRatio;
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_cached_plan") {}
@@ -239,6 +409,8 @@ public:
     void setupTests() {
         add<QueryStageCachedPlanFailure>();
         add<QueryStageCachedPlanHitMaxWorks>();
+        add<QueryStageCachedPlanHitMaxWorksWithinBaselineCost>();
+        add<QueryStageCachedPlanAutoPinsBestPlan>();
     }
 };
 
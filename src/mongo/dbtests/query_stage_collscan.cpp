@@ -31,6 +31,8 @@
  */
 
 
+#include <set>
+
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
@@ -74,6 +76,10 @@ public:
         _client.dropCollection(ns());
     }
 
+    void insert(const BSONObj& obj) {
+        _client.insert(ns(), obj);
+    }
+
     void remove(const BSONObj& obj) {
         _client.remove(ns(), obj);
     }
@@ -383,6 +389,61 @@ public:
     }
 };
 
+//
+// Split a scan across threads and check that every matching object comes back exactly once, even
+// when the scan is saved and restored along the way.
+//
+
+class QueryStageCollscanParallel : public QueryStageCollectionScanBase {
+public:
+    void run() {
+        OldClientWriteContext ctx(&_txn, ns());
+
+        // Enough objects for the storage engine to hand out several cursors.
+        const int numParallelObj = 5000;
+        for (int i = numObj(); i < numParallelObj; ++i) {
+            insert(BSON("foo" << i));
+        }
+
+        CollectionScanParams params;
+        params.collection = ctx.getCollection();
+        params.direction = CollectionScanParams::FORWARD;
+        params.tailable = false;
+        params.parallelism = 4;
+
+        BSONObj filterObj = BSON("foo" << BSON("$gte" << 100));
+        StatusWithMatchExpression statusWithMatcher = MatchExpressionParser::parse(filterObj);
+        ASSERT_OK(statusWithMatcher.getStatus());
+        unique_ptr<MatchExpression> filterExpr = std::move(statusWithMatcher.getValue());
+
+        WorkingSet ws;
+        unique_ptr<CollectionScan> scan(new CollectionScan(&_txn, params, &ws, filterExpr.get()));
+
+        std::set<int> seen;
+        int works = 0;
+        while (!scan->isEOF()) {
+            if (++works % 100 == 0) {
+                scan->saveState();
+                scan->restoreState();
+            }
+
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState state = scan->work(&id);
+            ASSERT_NOT_EQUALS(PlanStage::FAILURE, state);
+            if (PlanStage::ADVANCED == state) {
+                WorkingSetMember* member = ws.get(id);
+                ASSERT(member->hasLoc());
+                int foo = member->obj.value()["foo"].numberInt();
+                ASSERT_GREATER_THAN_OR_EQUALS(foo, 100);
+                ASSERT(seen.insert(foo).second);
+                ws.free(id);
+            }
+        }
+
+        ASSERT_EQUALS(static_cast<size_t>(numParallelObj - 100), seen.size());
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("QueryStageCollectionScan") {}
@@ -397,6 +458,7 @@ public:
         add<QueryStageCollscanObjectsInOrderBackward>();
         add<QueryStageCollscanInvalidateUpcomingObject>();
         add<QueryStageCollscanInvalidateUpcomingObjectBackward>();
+        add<QueryStageCollscanParallel>();
     }
 };
 
@@ -40,9 +40,11 @@
 #include "mongo/db/exec/queued_data_stage.h"
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/service_context.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/scopeguard.h"
 
 namespace QueryStageDelete {
 
@@ -294,6 +296,55 @@ public:
     }
 };
 
+/**
+ * Test that a multi delete with a limit stops once it has deleted that many documents, whether or
+ * not it deletes them in batches.
+ */
+class QueryStageDeleteLimit : public QueryStageDeleteBase {
+public:
+    void run() {
+        OldClientWriteContext ctx(&_txn, nss.ns());
+        Collection* coll = ctx.getCollection();
+
+        const int oldBatchSize = internalQueryExecWriteBatchSize;
+        ON_BLOCK_EXIT([oldBatchSize] { internalQueryExecWriteBatchSize = oldBatchSize; });
+
+        size_t expectedDeleted = 0;
+        for (int batchSize : {1, 4}) {
+            internalQueryExecWriteBatchSize = batchSize;
+
+            CollectionScanParams collScanParams;
+            collScanParams.collection = coll;
+            collScanParams.direction = CollectionScanParams::FORWARD;
+            collScanParams.tailable = false;
+
+            DeleteStageParams deleteParams;
+            deleteParams.isMulti = true;
+            deleteParams.limit = 10;
+
+            WorkingSet ws;
+            DeleteStage deleteStage(&_txn,
+                                    deleteParams,
+                                    &ws,
+                                    coll,
+                                    new CollectionScan(&_txn, collScanParams, &ws, NULL));
+            const DeleteStats* stats =
+                static_cast<const DeleteStats*>(deleteStage.getSpecificStats());
+
+            while (!deleteStage.isEOF()) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                PlanStage::StageState state = deleteStage.work(&id);
+                ASSERT(PlanStage::NEED_TIME == state || PlanStage::IS_EOF == state);
+            }
+
+            ASSERT_EQUALS(10U, stats->docsDeleted);
+            expectedDeleted += stats->docsDeleted;
+            ASSERT_EQUALS(static_cast<long long>(numObj() - expectedDeleted),
+                          coll->numRecords(&_txn));
+        }
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_delete") {}
@@ -303,6 +354,7 @@ public:
         add<QueryStageDeleteInvalidateUpcomingObject>();
         add<QueryStageDeleteReturnOldDoc>();
         add<QueryStageDeleteSkipOwnedObjects>();
+        add<QueryStageDeleteLimit>();
     }
 };
 
@@ -42,8 +42,10 @@
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/scopeguard.h"
 
 namespace QueryStageFetch {
 
@@ -214,6 +216,70 @@ public:
     }
 };
 
+//
+// Test that batched lookups return documents in the child's order, and skip documents which were
+// deleted before they could be fetched.
+//
+class FetchStageBatched : public QueryStageFetchBase {
+public:
+    void run() {
+        OldClientWriteContext ctx(&_txn, ns());
+        Database* db = ctx.db();
+        Collection* coll = db->getCollection(ns());
+        if (!coll) {
+            WriteUnitOfWork wuow(&_txn);
+            coll = db->createCollection(&_txn, ns());
+            wuow.commit();
+        }
+
+        const int oldBatchSize = internalQueryExecFetchBatchSize;
+        internalQueryExecFetchBatchSize = 4;
+        ON_BLOCK_EXIT([oldBatchSize] { internalQueryExecFetchBatchSize = oldBatchSize; });
+
+        WorkingSet ws;
+
+        for (int i = 0; i < 10; ++i) {
+            insert(BSON("foo" << i));
+        }
+        set<RecordId> locs;
+        getLocs(&locs, coll);
+        ASSERT_EQUALS(size_t(10), locs.size());
+
+        // Queue the records up in reverse RecordId order so that the lookups are reordered.
+        auto mockStage = make_unique<QueuedDataStage>(&_txn, &ws);
+        std::vector<int> expected;
+        for (auto it = locs.rbegin(); it != locs.rend(); ++it) {
+            WorkingSetID id = ws.allocate();
+            WorkingSetMember* mockMember = ws.get(id);
+            mockMember->loc = *it;
+            ws.transitionToLocAndIdx(id);
+            mockStage->pushBack(id);
+            expected.push_back(coll->docFor(&_txn, *it).value()["foo"].numberInt());
+        }
+
+        // Delete one of the documents before it is fetched.
+        remove(BSON("foo" << expected[5]));
+        expected.erase(expected.begin() + 5);
+
+        unique_ptr<FetchStage> fetchStage(
+            new FetchStage(&_txn, &ws, mockStage.release(), NULL, coll));
+
+        std::vector<int> results;
+        while (!fetchStage->isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState state = fetchStage->work(&id);
+            ASSERT_NOT_EQUALS(PlanStage::FAILURE, state);
+            if (PlanStage::ADVANCED == state) {
+                results.push_back(ws.get(id)->obj.value()["foo"].numberInt());
+            }
+        }
+
+        ASSERT(expected == results);
+        const FetchStats* stats = static_cast<const FetchStats*>(fetchStage->getSpecificStats());
+        ASSERT_EQUALS(size_t(3), stats->fetchBatches);
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_fetch") {}
@@ -221,6 +287,7 @@ public:
     void setupTests() {
         add<FetchStageAlreadyFetched>();
         add<FetchStageFilter>();
+        add<FetchStageBatched>();
     }
 };
 
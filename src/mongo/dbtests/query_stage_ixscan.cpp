@@ -308,6 +308,86 @@ public:
     }
 };
 
+// An ixscan which merges its scans of each point of its first field returns keys in the order of
+// its second field, and carries on in that order after a yield.
+class QueryStageIxscanMergedPointScans : public IndexScanTest {
+public:
+    void run() {
+        setup();
+
+        const BSONObj keyPattern = BSON("a" << 1 << "x" << 1);
+        {
+            WriteUnitOfWork wunit(&_txn);
+            ASSERT_OK(_coll->getIndexCatalog()->createIndexOnEmptyCollection(
+                &_txn,
+                BSON("ns" << ns() << "key" << keyPattern << "name"
+                          << DBClientBase::genIndexName(keyPattern))));
+            wunit.commit();
+        }
+
+        insert(fromjson("{_id: 1, a: 1, x: 4}"));
+        insert(fromjson("{_id: 2, a: 2, x: 1}"));
+        insert(fromjson("{_id: 3, a: 3, x: 3}"));
+        insert(fromjson("{_id: 4, a: 2, x: 5}"));
+        insert(fromjson("{_id: 5, a: 4, x: 2}"));
+        insert(fromjson("{_id: 6, a: 1, x: 2}"));
+
+        IndexDescriptor* descriptor =
+            _coll->getIndexCatalog()->findIndexByKeyPattern(&_txn, keyPattern);
+        invariant(descriptor);
+
+        IndexScanParams params;
+        params.descriptor = descriptor;
+        params.direction = 1;
+        params.mergedPrefixFields = 1;
+
+        OrderedIntervalList aOil("a");
+        for (int a = 1; a <= 3; ++a) {
+            aOil.intervals.push_back(Interval(BSON("" << a << "" << a), true, true));
+        }
+        params.bounds.fields.push_back(aOil);
+
+        OrderedIntervalList xOil("x");
+        BSONObjBuilder bob;
+        bob.appendMinKey("");
+        bob.appendMaxKey("");
+        xOil.intervals.push_back(Interval(bob.obj(), true, true));
+        params.bounds.fields.push_back(xOil);
+
+        std::unique_ptr<IndexScan> ixscan(new IndexScan(&_txn, params, &_ws, NULL));
+
+        WorkingSetMember* member = getNext(ixscan.get());
+        ASSERT_EQ(member->keyData[0].keyData, BSON("" << 2 << "" << 1));
+        member = getNext(ixscan.get());
+        ASSERT_EQ(member->keyData[0].keyData, BSON("" << 1 << "" << 2));
+
+        // Save state and insert a doc for each of a scan we've taken keys from and one we
+        // haven't.
+        ixscan->saveState();
+        insert(fromjson("{_id: 7, a: 3, x: 6}"));
+        insert(fromjson("{_id: 8, a: 1, x: 0}"));
+        ixscan->restoreState();
+
+        // Ensure that we don't return {'': 1, '': 0}, which is behind the scan.
+        member = getNext(ixscan.get());
+        ASSERT_EQ(member->keyData[0].keyData, BSON("" << 3 << "" << 3));
+        member = getNext(ixscan.get());
+        ASSERT_EQ(member->keyData[0].keyData, BSON("" << 1 << "" << 4));
+        member = getNext(ixscan.get());
+        ASSERT_EQ(member->keyData[0].keyData, BSON("" << 2 << "" << 5));
+        member = getNext(ixscan.get());
+        ASSERT_EQ(member->keyData[0].keyData, BSON("" << 3 << "" << 6));
+
+        WorkingSetID id;
+        ASSERT_EQ(PlanStage::IS_EOF, ixscan->work(&id));
+        ASSERT(ixscan->isEOF());
+
+        const IndexScanStats* stats =
+            static_cast<const IndexScanStats*>(ixscan->getSpecificStats());
+        ASSERT_EQUALS(3U, stats->mergedPointScans);
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_ixscan") {}
@@ -318,6 +398,7 @@ public:
         add<QueryStageIxscanInsertDuringSaveExclusive>();
         add<QueryStageIxscanInsertDuringSaveExclusive2>();
         add<QueryStageIxscanInsertDuringSaveReverse>();
+        add<QueryStageIxscanMergedPointScans>();
     }
 } QueryStageIxscanAll;
 
@@ -85,6 +85,17 @@ int countResults(PlanStage* stage) {
     return count;
 }
 
+int countResultsInBatches(PlanStage* stage, size_t batchSize) {
+    int count = 0;
+    while (!stage->isEOF()) {
+        std::vector<WorkingSetID> results;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        stage->workBatch(batchSize, &results, &id);
+        count += results.size();
+    }
+    return count;
+}
+
 //
 // Insert 50 objects.  Filter/skip 0, 1, 2, ..., 100 objects and expect the right # of results.
 //
@@ -103,12 +114,33 @@ public:
     }
 };
 
+//
+// Same as above, but with the stages worked a batch at a time.
+//
+class QueryStageLimitSkipBatchTest {
+public:
+    void run() {
+        for (int i = 0; i < 2 * N; ++i) {
+            WorkingSet ws;
+
+            unique_ptr<PlanStage> skip = make_unique<SkipStage>(nullptr, i, &ws, getMS(&ws));
+            ASSERT_TRUE(skip->supportsWorkBatch());
+            ASSERT_EQUALS(max(0, N - i), countResultsInBatches(skip.get(), 7));
+
+            unique_ptr<PlanStage> limit = make_unique<LimitStage>(nullptr, i, &ws, getMS(&ws));
+            ASSERT_TRUE(limit->supportsWorkBatch());
+            ASSERT_EQUALS(min(N, i), countResultsInBatches(limit.get(), 7));
+        }
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_limit_skip") {}
 
     void setupTests() {
         add<QueryStageLimitSkipBasicTest>();
+        add<QueryStageLimitSkipBatchTest>();
     }
 };
 
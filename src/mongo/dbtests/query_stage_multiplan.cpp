@@ -26,6 +26,7 @@
  *    then also delete it in the license file.
  */
 
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/db_raii.h"
@@ -99,9 +100,39 @@ public:
         _client.remove(nss.ns(), obj);
     }
 
+    /**
+     * Adds two plans for the query {foo: 7} to 'mps': an index scan over the index {foo: 1}
+     * followed by a collection scan.
+     */
+    void addFooPlans(const Collection* coll, WorkingSet* ws, MultiPlanStage* mps) {
+        IndexScanParams ixparams;
+        ixparams.descriptor =
+            coll->getIndexCatalog()->findIndexByKeyPattern(&_txn, BSON("foo" << 1));
+        ixparams.bounds.isSimpleRange = true;
+        ixparams.bounds.startKey = BSON("" << 7);
+        ixparams.bounds.endKey = BSON("" << 7);
+        ixparams.bounds.endKeyInclusive = true;
+        ixparams.direction = 1;
+        IndexScan* ix = new IndexScan(&_txn, ixparams, ws, NULL);
+        mps->addPlan(createQuerySolution(), new FetchStage(&_txn, ws, ix, NULL, coll), ws);
+
+        CollectionScanParams csparams;
+        csparams.collection = coll;
+        csparams.direction = CollectionScanParams::FORWARD;
+        StatusWithMatchExpression statusWithMatcher =
+            MatchExpressionParser::parse(BSON("foo" << 7));
+        verify(statusWithMatcher.isOK());
+        _filter = std::move(statusWithMatcher.getValue());
+        mps->addPlan(
+            createQuerySolution(), new CollectionScan(&_txn, csparams, ws, _filter.get()), ws);
+    }
+
 protected:
     OperationContextImpl _txn;
     DBDirectClient _client;
+
+    // Filter of the collection scan made by addFooPlans().
+    unique_ptr<MatchExpression> _filter;
 };
 
 
@@ -287,6 +318,84 @@ public:
     }
 };
 
+// A plan producing results at a fraction of the rate of the best one stops being worked early.
+class MPSEliminateLosingPlan : public QueryStageMultiPlanBase {
+public:
+    void run() {
+        for (int i = 0; i < 5000; ++i) {
+            insert(BSON("foo" << (i % 10)));
+        }
+        addIndex(BSON("foo" << 1));
+
+        AutoGetCollectionForRead ctx(&_txn, nss.ns());
+        const Collection* coll = ctx.getCollection();
+
+        auto statusWithCQ = CanonicalQuery::canonicalize(nss, BSON("foo" << 7));
+        verify(statusWithCQ.isOK());
+        unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+
+        WorkingSet ws;
+        MultiPlanStage mps(&_txn, coll, cq.get());
+        addFooPlans(coll, &ws, &mps);
+
+        // The collection scan matches one document in ten while every work() of the index scan
+        // produces one.
+        const double oldEliminationRatio = internalQueryPlanEvaluationEliminationRatio;
+        internalQueryPlanEvaluationEliminationRatio = 5;
+        PlanYieldPolicy yieldPolicy(NULL, PlanExecutor::YIELD_MANUAL);
+        mps.pickBestPlan(&yieldPolicy);
+        internalQueryPlanEvaluationEliminationRatio = oldEliminationRatio;
+
+        ASSERT(mps.bestPlanChosen());
+        ASSERT_EQUALS(0, mps.bestPlanIdx());
+
+        // The trial period ran until the index scan produced a batch of results, but the
+        // collection scan was eliminated well before that.
+        OwnedPointerVector<PlanStageStats> candidateStats;
+        candidateStats.mutableVector() = mps.generateCandidateStats();
+        ASSERT_EQUALS(1U, candidateStats.size());
+        const size_t numResults = MultiPlanStage::getTrialPeriodNumToReturn(*cq);
+        ASSERT_LESS_THAN(candidateStats[0]->common.works, numResults);
+    }
+};
+
+// The trial period stops once the plans have been worked a total number of times.
+class MPSTotalWorksBudget : public QueryStageMultiPlanBase {
+public:
+    void run() {
+        for (int i = 0; i < 5000; ++i) {
+            insert(BSON("foo" << (i % 10)));
+        }
+        addIndex(BSON("foo" << 1));
+
+        AutoGetCollectionForRead ctx(&_txn, nss.ns());
+        const Collection* coll = ctx.getCollection();
+
+        auto statusWithCQ = CanonicalQuery::canonicalize(nss, BSON("foo" << 7));
+        verify(statusWithCQ.isOK());
+        unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+
+        WorkingSet ws;
+        MultiPlanStage mps(&_txn, coll, cq.get());
+        addFooPlans(coll, &ws, &mps);
+
+        const int oldMaxTotalWorks = internalQueryPlanEvaluationMaxTotalWorks;
+        internalQueryPlanEvaluationMaxTotalWorks = 20;
+        PlanYieldPolicy yieldPolicy(NULL, PlanExecutor::YIELD_MANUAL);
+        mps.pickBestPlan(&yieldPolicy);
+        internalQueryPlanEvaluationMaxTotalWorks = oldMaxTotalWorks;
+
+        ASSERT(mps.bestPlanChosen());
+        ASSERT_EQUALS(0, mps.bestPlanIdx());
+
+        // Each of the two plans was worked 10 times.
+        OwnedPointerVector<PlanStageStats> candidateStats;
+        candidateStats.mutableVector() = mps.generateCandidateStats();
+        ASSERT_EQUALS(1U, candidateStats.size());
+        ASSERT_EQUALS(10U, candidateStats[0]->common.works);
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_multiplan") {}
@@ -294,6 +403,8 @@ public:
     void setupTests() {
         add<MPSCollectionScanVsHighlySelectiveIXScan>();
         add<MPSBackupPlan>();
+        add<MPSEliminateLosingPlan>();
+        add<MPSTotalWorksBudget>();
     }
 };
 
@@ -40,6 +40,7 @@
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/dbtests/dbtests.h"
 
 namespace QueryStageSubplan {
@@ -594,6 +595,145 @@ public:
     }
 };
 
+/**
+ * Works 'subplan' until EOF and returns the number of results it produced.
+ */
+size_t countResults(SubplanStage* subplan) {
+    size_t numResults = 0;
+    PlanStage::StageState stageState = PlanStage::NEED_TIME;
+    while (stageState != PlanStage::IS_EOF) {
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        stageState = subplan->work(&id);
+        ASSERT_NE(stageState, PlanStage::DEAD);
+        ASSERT_NE(stageState, PlanStage::FAILURE);
+        if (stageState == PlanStage::ADVANCED) {
+            ++numResults;
+        }
+    }
+    return numResults;
+}
+
+/**
+ * Test that $or branches with the same shape are only planned once, and that the branch whose
+ * plan is reused is not looked up in the plan cache either.
+ */
+class QueryStageSubplanPlanSameShapeOnce : public QueryStageSubplanBase {
+public:
+    void run() {
+        OldClientWriteContext ctx(&_txn, nss.ns());
+
+        addIndex(BSON("a" << 1));
+        addIndex(BSON("a" << 1 << "b" << 1));
+        addIndex(BSON("c" << 1));
+
+        for (int i = 0; i < 10; i++) {
+            insert(BSON("a" << 1 << "b" << i << "c" << i));
+        }
+
+        // The first and last branches have the same shape.
+        BSONObj query = fromjson("{$or: [{a: 1, b: 3}, {c: 1}, {a: 1, b: 5}]}");
+        auto cq = unittest::assertGet(CanonicalQuery::canonicalize(nss, query));
+
+        Collection* collection = ctx.getCollection();
+
+        QueryPlannerParams plannerParams;
+        fillOutPlannerParams(&_txn, collection, cq.get(), &plannerParams);
+
+        WorkingSet ws;
+        std::unique_ptr<SubplanStage> subplan(
+            new SubplanStage(&_txn, collection, &ws, plannerParams, cq.get()));
+
+        PlanYieldPolicy yieldPolicy(nullptr, PlanExecutor::YIELD_MANUAL);
+        ASSERT_OK(subplan->pickBestPlan(&yieldPolicy));
+
+        size_t numFromEarlierBranch = 0;
+        for (size_t i = 0; i < 3; i++) {
+            ASSERT_FALSE(subplan->branchPlannedFromCache(i));
+            if (subplan->branchPlannedFromEarlierBranch(i)) {
+                ++numFromEarlierBranch;
+            }
+        }
+        ASSERT_EQ(numFromEarlierBranch, 1U);
+        ASSERT_EQ(countResults(subplan.get()), 3U);
+
+        // The second time around the first branch of the shape comes from the cache, and the
+        // other one still borrows its plan.
+        ws.clear();
+        subplan.reset(new SubplanStage(&_txn, collection, &ws, plannerParams, cq.get()));
+        ASSERT_OK(subplan->pickBestPlan(&yieldPolicy));
+
+        size_t numFromCache = 0;
+        numFromEarlierBranch = 0;
+        for (size_t i = 0; i < 3; i++) {
+            if (subplan->branchPlannedFromCache(i)) {
+                ++numFromCache;
+            }
+            if (subplan->branchPlannedFromEarlierBranch(i)) {
+                ASSERT_FALSE(subplan->branchPlannedFromCache(i));
+                ++numFromEarlierBranch;
+            }
+        }
+        ASSERT_EQ(numFromCache, 1U);
+        ASSERT_EQ(numFromEarlierBranch, 1U);
+        ASSERT_EQ(countResults(subplan.get()), 3U);
+    }
+};
+
+/**
+ * Test that enumerating the plans of $or branches on several threads gives the same results as
+ * doing it on one.
+ */
+class QueryStageSubplanPlanBranchesConcurrently : public QueryStageSubplanBase {
+public:
+    QueryStageSubplanPlanBranchesConcurrently()
+        : _oldPlanningThreads(internalQuerySubplanPlanningThreads) {}
+
+    ~QueryStageSubplanPlanBranchesConcurrently() {
+        internalQuerySubplanPlanningThreads = _oldPlanningThreads;
+    }
+
+    void run() {
+        OldClientWriteContext ctx(&_txn, nss.ns());
+
+        addIndex(BSON("a" << 1));
+        addIndex(BSON("a" << 1 << "b" << 1));
+        addIndex(BSON("c" << 1));
+        addIndex(BSON("d" << 1));
+        addIndex(BSON("e" << 1));
+
+        for (int i = 0; i < 10; i++) {
+            insert(BSON("a" << 1 << "b" << i << "c" << i << "d" << i << "e" << i));
+        }
+
+        BSONObj query = fromjson("{$or: [{a: 1, b: 3}, {c: 4}, {d: 5}, {e: 6}, {e: {$gt: 8}}]}");
+        auto cq = unittest::assertGet(CanonicalQuery::canonicalize(nss, query));
+
+        Collection* collection = ctx.getCollection();
+
+        QueryPlannerParams plannerParams;
+        fillOutPlannerParams(&_txn, collection, cq.get(), &plannerParams);
+
+        for (int numThreads : {1, 3}) {
+            internalQuerySubplanPlanningThreads = numThreads;
+            collection->infoCache()->getPlanCache()->clear();
+
+            WorkingSet ws;
+            SubplanStage subplan(&_txn, collection, &ws, plannerParams, cq.get());
+
+            PlanYieldPolicy yieldPolicy(nullptr, PlanExecutor::YIELD_MANUAL);
+            ASSERT_OK(subplan.pickBestPlan(&yieldPolicy));
+            for (size_t i = 0; i < 5; i++) {
+                ASSERT_FALSE(subplan.branchPlannedFromCache(i));
+                ASSERT_FALSE(subplan.branchPlannedFromEarlierBranch(i));
+            }
+            ASSERT_EQ(countResults(&subplan), 5U);
+        }
+    }
+
+private:
+    int _oldPlanningThreads;
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_subplan") {}
@@ -607,6 +747,8 @@ public:
         add<QueryStageSubplanRewriteToRootedOr>();
         add<QueryStageSubplanPlanContainedOr>();
         add<QueryStageSubplanPlanRootedOrNE>();
+        add<QueryStageSubplanPlanSameShapeOnce>();
+        add<QueryStageSubplanPlanBranchesConcurrently>();
     }
 };
 
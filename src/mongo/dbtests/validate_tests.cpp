@@ -0,0 +1,181 @@
+/**
+ *    Copyright (C) 2014 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+/**
+ * This file tests Collection::validateInBackground.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/dbtests/dbtests.h"
+
+namespace ValidateTests {
+
+static const NamespaceString nss("unittests.validate_tests");
+
+class ValidateBase {
+public:
+    ValidateBase() : _client(&_txn) {
+        _client.dropCollection(nss.ns());
+        for (int i = 0; i < 50; ++i) {
+            BSONObjBuilder bob;
+            bob.append("_id", i);
+            bob.append("a", i);
+            bob.append("b", BSON_ARRAY(i << i + 1 << "x"));
+            if (i % 2 == 0) {
+                bob.append("c", i * 1.5);
+            }
+            _client.insert(nss.ns(), bob.obj());
+        }
+        ASSERT_OK(dbtests::createIndex(&_txn, nss.ns(), BSON("a" << 1)));
+        ASSERT_OK(dbtests::createIndex(&_txn, nss.ns(), BSON("b" << 1 << "a" << -1)));
+        ASSERT_OK(dbtests::createIndexFromSpec(
+            &_txn,
+            nss.ns(),
+            BSON("ns" << nss.ns() << "key" << BSON("c" << 1) << "name"
+                      << "c_1"
+                      << "sparse" << true)));
+        ASSERT_OK(dbtests::createIndexFromSpec(
+            &_txn,
+            nss.ns(),
+            BSON("ns" << nss.ns() << "key" << BSON("a" << 1 << "c" << 1) << "name"
+                      << "a_1_c_1_partial"
+                      << "partialFilterExpression" << BSON("a" << BSON("$gt" << 10)))));
+    }
+
+    virtual ~ValidateBase() {
+        _client.dropCollection(nss.ns());
+    }
+
+protected:
+    bool validateInBackground(BSONObj* output) {
+        ScopedTransaction transaction(&_txn, MODE_IS);
+        AutoGetDb autoDb(&_txn, nss.db(), MODE_IS);
+        Lock::CollectionLock collLock(_txn.lockState(), nss.ns(), MODE_IS);
+        Collection* collection = autoDb.getDb()->getCollection(nss);
+        ASSERT(collection);
+
+        ValidateResults results;
+        BSONObjBuilder bob;
+        ASSERT_OK(collection->validateInBackground(&_txn, 0, &results, &bob));
+        bob.append("errors", results.errors);
+        *output = bob.obj();
+        return results.valid;
+    }
+
+    /**
+     * Removes the entries of index "indexName" for the first document, and, if "replacement" is
+     * not empty, inserts the keys of "replacement" for it instead.
+     */
+    void corruptIndex(StringData indexName, const BSONObj& replacement) {
+        OldClientWriteContext ctx(&_txn, nss.ns());
+        Collection* collection = ctx.getCollection();
+        IndexCatalog* catalog = collection->getIndexCatalog();
+        IndexAccessMethod* iam = catalog->getIndex(catalog->findIndexByName(&_txn, indexName));
+
+        auto record = collection->getCursor(&_txn)->next();
+        ASSERT(record);
+        const BSONObj obj = record->data.releaseToBson().getOwned();
+
+        WriteUnitOfWork wuow(&_txn);
+        InsertDeleteOptions options;
+        options.dupsAllowed = true;
+        int64_t numDeleted;
+        ASSERT_OK(iam->remove(&_txn, obj, record->id, options, &numDeleted));
+        ASSERT_GREATER_THAN(numDeleted, 0);
+        if (!replacement.isEmpty()) {
+            int64_t numInserted;
+            ASSERT_OK(iam->insert(&_txn, replacement, record->id, options, &numInserted));
+        }
+        wuow.commit();
+    }
+
+    OperationContextImpl _txn;
+    DBDirectClient _client;
+};
+
+class ValidateBackgroundValid : public ValidateBase {
+public:
+    void run() {
+        BSONObj output;
+        ASSERT(validateInBackground(&output));
+        ASSERT_EQUALS(50, output["nrecords"].numberLong());
+        ASSERT_EQUALS(5, output["nIndexes"].numberInt());
+        const BSONObj keysPerIndex = output["keysPerIndex"].Obj();
+        ASSERT_EQUALS(50, keysPerIndex[nss.ns() + ".$_id_"].numberLong());
+        ASSERT_EQUALS(50, keysPerIndex[nss.ns() + ".$a_1"].numberLong());
+        ASSERT_EQUALS(150, keysPerIndex[nss.ns() + ".$b_1_a_-1"].numberLong());
+        ASSERT_EQUALS(25, keysPerIndex[nss.ns() + ".$c_1"].numberLong());
+        ASSERT_EQUALS(39, keysPerIndex[nss.ns() + ".$a_1_c_1_partial"].numberLong());
+    }
+};
+
+class ValidateBackgroundMissingIndexEntry : public ValidateBase {
+public:
+    void run() {
+        corruptIndex("b_1_a_-1", BSONObj());
+        BSONObj output;
+        ASSERT_FALSE(validateInBackground(&output));
+        ASSERT_EQUALS(147, output["keysPerIndex"].Obj()[nss.ns() + ".$b_1_a_-1"].numberLong());
+        ASSERT_EQUALS(1, output["errors"].Obj().nFields());
+    }
+};
+
+class ValidateBackgroundWrongIndexEntry : public ValidateBase {
+public:
+    void run() {
+        // Same number of keys, for a document that doesn't exist.
+        corruptIndex("a_1", BSON("a" << 12345));
+        BSONObj output;
+        ASSERT_FALSE(validateInBackground(&output));
+        ASSERT_EQUALS(50, output["keysPerIndex"].Obj()[nss.ns() + ".$a_1"].numberLong());
+        ASSERT_EQUALS(1, output["errors"].Obj().nFields());
+    }
+};
+
+class All : public Suite {
+public:
+    All() : Suite("validate_tests") {}
+
+    void setupTests() {
+        add<ValidateBackgroundValid>();
+        add<ValidateBackgroundMissingIndexEntry>();
+        add<ValidateBackgroundWrongIndexEntry>();
+    }
+};
+
+SuiteInstance<All> all;
+
+}  // namespace ValidateTests
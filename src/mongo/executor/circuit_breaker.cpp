@@ -0,0 +1,201 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/executor/circuit_breaker.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/executor/remote_command_request.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace executor {
+
+CircuitBreaker::CircuitBreaker(Options options) : _options(std::move(options)) {}
+
+bool CircuitBreaker::enabled() const {
+    return _options.failureRatio > 0 || _options.maxOutstanding > 0 ||
+        _options.timeoutMultiplier > 0;
+}
+
+Status CircuitBreaker::onStart(const HostAndPort& host, Date_t now) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto& hostState = _hosts[host];
+
+    if (!_accepts_inlock(hostState, now)) {
+        hostState.rejected++;
+        return {ErrorCodes::HostUnreachable,
+                str::stream() << "not sending command to " << host.toString() << " as "
+                              << (hostState.state == State::kClosed
+                                      ? "too many commands to it are outstanding"
+                                      : "too many recent commands to it failed")};
+    }
+
+    if (hostState.state == State::kOpen) {
+        // The open period is over, so this command is the probe.
+        hostState.state = State::kHalfOpen;
+        hostState.probing = true;
+    }
+
+    hostState.outstanding++;
+    return Status::OK();
+}
+
+void CircuitBreaker::onFinish(const HostAndPort& host,
+                              Date_t now,
+                              Milliseconds elapsed,
+                              bool failed) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto& hostState = _hosts[host];
+
+    if (hostState.outstanding > 0) {
+        hostState.outstanding--;
+    }
+
+    hostState.outcomes.push_back(failed);
+    hostState.failures += failed;
+    if (hostState.outcomes.size() > _options.windowSize) {
+        hostState.failures -= hostState.outcomes.front();
+        hostState.outcomes.pop_front();
+    }
+
+    if (!failed) {
+        hostState.latencies.push_back(elapsed);
+        if (hostState.latencies.size() > _options.windowSize) {
+            hostState.latencies.pop_front();
+        }
+    }
+
+    if (hostState.state == State::kHalfOpen) {
+        hostState.probing = false;
+        if (failed) {
+            _open_inlock(host, &hostState, now);
+        } else {
+            log() << "Closing the circuit breaker for " << host << " after a successful probe";
+            hostState.state = State::kClosed;
+            hostState.outcomes.clear();
+            hostState.failures = 0;
+        }
+        return;
+    }
+
+    if (hostState.state == State::kClosed && _options.failureRatio > 0 &&
+        hostState.outcomes.size() >= _options.minRequests &&
+        hostState.failures >= _options.failureRatio * hostState.outcomes.size()) {
+        _open_inlock(host, &hostState, now);
+    }
+}
+
+bool CircuitBreaker::accepts(const HostAndPort& host, Date_t now) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _hosts.find(host);
+    return it == _hosts.end() || _accepts_inlock(it->second, now);
+}
+
+Milliseconds CircuitBreaker::timeoutFor(const HostAndPort& host, Milliseconds requested) const {
+    if (_options.timeoutMultiplier <= 0 || requested != RemoteCommandRequest::kNoTimeout) {
+        return requested;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = _hosts.find(host);
+    if (it == _hosts.end() || it->second.latencies.size() < _options.minRequests) {
+        return requested;
+    }
+
+    const Milliseconds adaptive(static_cast<long long>(
+        _tailLatency(it->second).count() * _options.timeoutMultiplier));
+    return std::max(adaptive, _options.minTimeout);
+}
+
+void CircuitBreaker::appendStats(BSONObjBuilder* b, Date_t now) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    for (const auto& entry : _hosts) {
+        const auto& hostState = entry.second;
+        // An open breaker whose open period is over lets the next command through as a probe.
+        StringData state = "closed";
+        if (hostState.state == State::kOpen && now < hostState.openUntil) {
+            state = "open";
+        } else if (hostState.state != State::kClosed) {
+            state = "halfOpen";
+        }
+
+        BSONObjBuilder hostBuilder(b->subobjStart(entry.first.toString()));
+        hostBuilder.append("state", state);
+        hostBuilder.appendNumber("outstanding", static_cast<long long>(hostState.outstanding));
+        hostBuilder.appendNumber("recentCommands",
+                                 static_cast<long long>(hostState.outcomes.size()));
+        hostBuilder.appendNumber("recentFailures", static_cast<long long>(hostState.failures));
+        if (!hostState.latencies.empty()) {
+            hostBuilder.appendNumber("tailLatencyMillis",
+                                     static_cast<long long>(_tailLatency(hostState).count()));
+        }
+        hostBuilder.appendNumber("timesOpened", hostState.timesOpened);
+        hostBuilder.appendNumber("rejected", hostState.rejected);
+    }
+}
+
+bool CircuitBreaker::_accepts_inlock(const HostState& hostState, Date_t now) const {
+    switch (hostState.state) {
+        case State::kOpen:
+            return now >= hostState.openUntil;
+        case State::kHalfOpen:
+            return !hostState.probing;
+        case State::kClosed:
+            return _options.maxOutstanding == 0 ||
+                hostState.outstanding < _options.maxOutstanding;
+    }
+    MONGO_UNREACHABLE;
+}
+
+void CircuitBreaker::_open_inlock(const HostAndPort& host, HostState* hostState, Date_t now) {
+    warning() << "Opening the circuit breaker for " << host << " for "
+              << _options.openDuration << " after " << hostState->failures << " of the last "
+              << hostState->outcomes.size() << " commands to it failed";
+
+    hostState->state = State::kOpen;
+    hostState->openUntil = now + _options.openDuration;
+    hostState->timesOpened++;
+}
+
+Milliseconds CircuitBreaker::_tailLatency(const HostState& hostState) {
+    std::vector<Milliseconds> latencies(hostState.latencies.begin(), hostState.latencies.end());
+    const auto rank = latencies.begin() + (latencies.size() * 99) / 100;
+    std::nth_element(latencies.begin(), rank, latencies.end());
+    return *rank;
+}
+
+}  // namespace executor
+}  // namespace mongo
@@ -0,0 +1,169 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <unordered_map>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+namespace executor {
+
+/**
+ * Tracks the outcome and round trip time of the commands a network interface sends to each host,
+ * and from them decides whether a new command to a host may be sent and how long it may take.
+ *
+ * For each host the breaker is closed (commands are sent), open (commands fail immediately) or
+ * half open (a single probe command is sent to find out whether the host has recovered). It
+ * opens when enough of the recent commands to the host failed without a response, and closes
+ * again once a probe succeeds. Independently of that, commands fail immediately while too many
+ * others to the same host are outstanding.
+ *
+ * This class is thread safe.
+ */
+class CircuitBreaker {
+    MONGO_DISALLOW_COPYING(CircuitBreaker);
+
+public:
+    struct Options {
+        Options() {}
+
+        /**
+         * Ratio of failed commands among the recent commands to a host at which its breaker
+         * opens. Zero disables opening.
+         */
+        double failureRatio = 0;
+
+        /**
+         * Number of recent commands to a host the failure ratio and the latency percentile are
+         * computed over, and how many of them are needed before either is used.
+         */
+        size_t windowSize = 50;
+        size_t minRequests = 20;
+
+        /**
+         * How long an open breaker fails commands before letting a probe through.
+         */
+        Milliseconds openDuration{5000};
+
+        /**
+         * Number of outstanding commands to a host at which new ones fail immediately. Zero means
+         * there is no limit.
+         */
+        size_t maxOutstanding = 0;
+
+        /**
+         * If not zero, commands to a host which are sent without a timeout time out after this
+         * multiple of the host's recent 99th percentile round trip time, and never sooner than
+         * minTimeout.
+         */
+        double timeoutMultiplier = 0;
+        Milliseconds minTimeout{1000};
+    };
+
+    explicit CircuitBreaker(Options options = Options());
+
+    /**
+     * Returns false if the options turn off every feature, in which case callers may skip the
+     * breaker altogether.
+     */
+    bool enabled() const;
+
+    /**
+     * Called before a command is sent to "host". Returns HostUnreachable if it must fail right
+     * away instead; otherwise the caller must report its completion with onFinish().
+     */
+    Status onStart(const HostAndPort& host, Date_t now);
+
+    /**
+     * Reports the completion of a command admitted by onStart(). "failed" is true if no response
+     * was received from the host.
+     */
+    void onFinish(const HostAndPort& host, Date_t now, Milliseconds elapsed, bool failed);
+
+    /**
+     * Returns whether a command to "host" started at "now" would be sent.
+     */
+    bool accepts(const HostAndPort& host, Date_t now) const;
+
+    /**
+     * Returns the timeout for a command to "host" which was asked to time out after "requested".
+     */
+    Milliseconds timeoutFor(const HostAndPort& host, Milliseconds requested) const;
+
+    /**
+     * Appends the state of the breaker of every host.
+     */
+    void appendStats(BSONObjBuilder* b, Date_t now) const;
+
+private:
+    enum class State { kClosed, kOpen, kHalfOpen };
+
+    struct HostState {
+        State state = State::kClosed;
+
+        // When an open breaker lets the next probe through and whether a probe is outstanding.
+        Date_t openUntil;
+        bool probing = false;
+
+        // Outcome of the recent commands, true for failures, and the round trip times of those
+        // which succeeded, oldest first.
+        std::deque<bool> outcomes;
+        size_t failures = 0;
+        std::deque<Milliseconds> latencies;
+
+        size_t outstanding = 0;
+
+        long long timesOpened = 0;
+        long long rejected = 0;
+    };
+
+    bool _accepts_inlock(const HostState& hostState, Date_t now) const;
+
+    void _open_inlock(const HostAndPort& host, HostState* hostState, Date_t now);
+
+    static Milliseconds _tailLatency(const HostState& hostState);
+
+    const Options _options;
+
+    mutable stdx::mutex _mutex;
+    std::unordered_map<HostAndPort, HostState> _hosts;
+};
+
+}  // namespace executor
+}  // namespace mongo
@@ -0,0 +1,176 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/executor/circuit_breaker.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/executor/remote_command_request.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace executor {
+namespace {
+
+const HostAndPort kHost("host1", 27017);
+const HostAndPort kOtherHost("host2", 27017);
+
+CircuitBreaker::Options failureOptions() {
+    CircuitBreaker::Options options;
+    options.failureRatio = 0.5;
+    options.windowSize = 10;
+    options.minRequests = 4;
+    options.openDuration = Milliseconds(1000);
+    return options;
+}
+
+void runCommand(CircuitBreaker* breaker, Date_t now, Milliseconds elapsed, bool failed) {
+    ASSERT_OK(breaker->onStart(kHost, now));
+    breaker->onFinish(kHost, now, elapsed, failed);
+}
+
+TEST(CircuitBreakerTest, DisabledByDefault) {
+    CircuitBreaker breaker;
+    ASSERT_FALSE(breaker.enabled());
+    ASSERT_EQUALS(RemoteCommandRequest::kNoTimeout,
+                  breaker.timeoutFor(kHost, RemoteCommandRequest::kNoTimeout));
+}
+
+TEST(CircuitBreakerTest, OpensWhenEnoughRecentCommandsFailed) {
+    CircuitBreaker breaker(failureOptions());
+    ASSERT_TRUE(breaker.enabled());
+
+    const Date_t now = Date_t::fromMillisSinceEpoch(100000);
+    runCommand(&breaker, now, Milliseconds(1), false);
+    runCommand(&breaker, now, Milliseconds(1), true);
+    runCommand(&breaker, now, Milliseconds(1), false);
+    ASSERT_TRUE(breaker.accepts(kHost, now));
+
+    runCommand(&breaker, now, Milliseconds(1), true);
+    ASSERT_FALSE(breaker.accepts(kHost, now));
+    ASSERT_EQUALS(ErrorCodes::HostUnreachable, breaker.onStart(kHost, now));
+
+    // Other hosts are not affected
+    ASSERT_TRUE(breaker.accepts(kOtherHost, now));
+    ASSERT_OK(breaker.onStart(kOtherHost, now));
+}
+
+TEST(CircuitBreakerTest, ClosesAfterSuccessfulProbe) {
+    CircuitBreaker breaker(failureOptions());
+
+    const Date_t now = Date_t::fromMillisSinceEpoch(100000);
+    for (int i = 0; i < 4; i++) {
+        runCommand(&breaker, now, Milliseconds(1), true);
+    }
+    ASSERT_FALSE(breaker.accepts(kHost, now + Milliseconds(999)));
+
+    // Only one probe is let through once the breaker was open long enough
+    const Date_t later = now + Milliseconds(1000);
+    ASSERT_OK(breaker.onStart(kHost, later));
+    ASSERT_EQUALS(ErrorCodes::HostUnreachable, breaker.onStart(kHost, later));
+
+    breaker.onFinish(kHost, later, Milliseconds(1), false);
+    ASSERT_TRUE(breaker.accepts(kHost, later));
+
+    // The failures from before the probe are forgotten
+    runCommand(&breaker, later, Milliseconds(1), true);
+    ASSERT_TRUE(breaker.accepts(kHost, later));
+}
+
+TEST(CircuitBreakerTest, ReopensAfterFailedProbe) {
+    CircuitBreaker breaker(failureOptions());
+
+    const Date_t now = Date_t::fromMillisSinceEpoch(100000);
+    for (int i = 0; i < 4; i++) {
+        runCommand(&breaker, now, Milliseconds(1), true);
+    }
+
+    const Date_t later = now + Milliseconds(1000);
+    ASSERT_OK(breaker.onStart(kHost, later));
+    breaker.onFinish(kHost, later, Milliseconds(1), true);
+
+    ASSERT_FALSE(breaker.accepts(kHost, later + Milliseconds(999)));
+    ASSERT_TRUE(breaker.accepts(kHost, later + Milliseconds(1000)));
+}
+
+TEST(CircuitBreakerTest, RejectsAboveMaxOutstanding) {
+    CircuitBreaker::Options options;
+    options.maxOutstanding = 2;
+    CircuitBreaker breaker(options);
+
+    const Date_t now = Date_t::fromMillisSinceEpoch(100000);
+    ASSERT_OK(breaker.onStart(kHost, now));
+    ASSERT_OK(breaker.onStart(kHost, now));
+    ASSERT_EQUALS(ErrorCodes::HostUnreachable, breaker.onStart(kHost, now));
+
+    breaker.onFinish(kHost, now, Milliseconds(1), false);
+    ASSERT_OK(breaker.onStart(kHost, now));
+
+    BSONObjBuilder builder;
+    breaker.appendStats(&builder, now);
+    const BSONObj hostStats = builder.obj()[kHost.toString()].Obj();
+    ASSERT_EQUALS("closed", hostStats["state"].String());
+    ASSERT_EQUALS(2, hostStats["outstanding"].numberLong());
+    ASSERT_EQUALS(1, hostStats["rejected"].numberLong());
+}
+
+TEST(CircuitBreakerTest, AdaptiveTimeoutFollowsTailLatency) {
+    CircuitBreaker::Options options;
+    options.windowSize = 100;
+    options.minRequests = 10;
+    options.timeoutMultiplier = 2;
+    options.minTimeout = Milliseconds(50);
+    CircuitBreaker breaker(options);
+
+    const Date_t now = Date_t::fromMillisSinceEpoch(100000);
+    for (int i = 1; i < 10; i++) {
+        runCommand(&breaker, now, Milliseconds(i), false);
+    }
+
+    // Not enough samples yet
+    ASSERT_EQUALS(RemoteCommandRequest::kNoTimeout,
+                  breaker.timeoutFor(kHost, RemoteCommandRequest::kNoTimeout));
+
+    runCommand(&breaker, now, Milliseconds(10), false);
+    ASSERT_EQUALS(Milliseconds(50), breaker.timeoutFor(kHost, RemoteCommandRequest::kNoTimeout));
+
+    for (int i = 0; i < 90; i++) {
+        runCommand(&breaker, now, Milliseconds(100), false);
+    }
+    ASSERT_EQUALS(Milliseconds(200), breaker.timeoutFor(kHost, RemoteCommandRequest::kNoTimeout));
+
+    // Failed commands do not count towards the latency and explicit timeouts are kept
+    runCommand(&breaker, now, Milliseconds(10000), true);
+    ASSERT_EQUALS(Milliseconds(200), breaker.timeoutFor(kHost, RemoteCommandRequest::kNoTimeout));
+    ASSERT_EQUALS(Milliseconds(5), breaker.timeoutFor(kHost, Milliseconds(5)));
+}
+
+}  // namespace
+}  // namespace executor
+}  // namespace mongo
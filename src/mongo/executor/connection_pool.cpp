@@ -29,8 +29,13 @@
 
 #include "mongo/executor/connection_pool.h"
 
+#include <algorithm>
+#include <array>
+
+#include "mongo/db/jsobj.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
 
 
@@ -78,22 +83,39 @@ public:
      */
     void returnConnection(ConnectionInterface* connection, stdx::unique_lock<stdx::mutex> lk);
 
+    /**
+     * Appends the stats for this pool. Must be called with the parent's _mutex held.
+     */
+    void appendConnectionStats(BSONObjBuilder* b) const;
+
 private:
     using OwnedConnection = std::unique_ptr<ConnectionInterface>;
     using OwnershipPool = std::unordered_map<ConnectionInterface*, OwnedConnection>;
-    using Request = std::pair<Date_t, GetConnectionCallback>;
+    struct Request {
+        Date_t expiration;
+        Date_t requested;
+        GetConnectionCallback cb;
+    };
     struct RequestComparator {
         bool operator()(const Request& a, const Request& b) {
-            return a.first > b.first;
+            return a.expiration > b.expiration;
         }
     };
 
+    // Upper bounds of the buckets of the acquire time histogram. The last bucket holds
+    // everything above the last bound.
+    static const std::array<Milliseconds, 12> kAcquireTimeBuckets;
+
     void addToReady(stdx::unique_lock<stdx::mutex>& lk, OwnedConnection conn);
 
     void fulfillRequests(stdx::unique_lock<stdx::mutex>& lk);
 
     void spawnConnections(stdx::unique_lock<stdx::mutex>& lk, const HostAndPort& hostAndPort);
 
+    void scheduleRefill();
+
+    void recordAcquireTime(Milliseconds acquireTime);
+
     void shutdown();
 
     OwnedConnection takeFromPool(OwnershipPool& pool, ConnectionInterface* connection);
@@ -118,6 +140,13 @@ private:
     size_t _generation;
     bool _inFulfillRequests;
 
+    // Re-establishes minConnections after a failure
+    std::unique_ptr<TimerInterface> _refillTimer;
+    bool _refillScheduled;
+
+    size_t _totalCreated;
+    std::array<uint64_t, kAcquireTimeBuckets.size() + 1> _acquireTimes;
+
     /**
      * The current state of the pool
      *
@@ -149,6 +178,21 @@ private:
 Milliseconds const ConnectionPool::kDefaultRefreshTimeout = Minutes(5);
 Milliseconds const ConnectionPool::kDefaultRefreshRequirement = Minutes(5);
 Milliseconds const ConnectionPool::kDefaultHostTimeout = Minutes(5);
+Milliseconds const ConnectionPool::kDefaultRefillDelay = Seconds(1);
+
+const std::array<Milliseconds, 12> ConnectionPool::SpecificPool::kAcquireTimeBuckets = {
+    {Milliseconds(1),
+     Milliseconds(2),
+     Milliseconds(5),
+     Milliseconds(10),
+     Milliseconds(20),
+     Milliseconds(50),
+     Milliseconds(100),
+     Milliseconds(200),
+     Milliseconds(500),
+     Milliseconds(1000),
+     Milliseconds(2000),
+     Milliseconds(5000)}};
 
 ConnectionPool::ConnectionPool(std::unique_ptr<DependentTypeFactoryInterface> impl, Options options)
     : _options(std::move(options)), _factory(std::move(impl)) {}
@@ -189,6 +233,15 @@ void ConnectionPool::get(const HostAndPort& hostAndPort,
     pool->getConnection(hostAndPort, timeout, std::move(lk), std::move(cb));
 }
 
+void ConnectionPool::appendConnectionStats(BSONObjBuilder* b) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    for (const auto& pool : _pools) {
+        BSONObjBuilder hostBuilder(b->subobjStart(pool.first.toString()));
+        pool.second->appendConnectionStats(&hostBuilder);
+    }
+}
+
 void ConnectionPool::returnConnection(ConnectionInterface* conn) {
     stdx::unique_lock<stdx::mutex> lk(_mutex);
 
@@ -205,19 +258,40 @@ ConnectionPool::SpecificPool::SpecificPool(ConnectionPool* parent, const HostAnd
       _requestTimer(parent->_factory->makeTimer()),
       _generation(0),
       _inFulfillRequests(false),
+      _refillTimer(parent->_factory->makeTimer()),
+      _refillScheduled(false),
+      _totalCreated(0),
+      _acquireTimes(),
       _state(State::kRunning) {}
 
 ConnectionPool::SpecificPool::~SpecificPool() {
     DESTRUCTOR_GUARD(_requestTimer->cancelTimeout();)
+    DESTRUCTOR_GUARD(_refillTimer->cancelTimeout();)
+}
+
+void ConnectionPool::SpecificPool::appendConnectionStats(BSONObjBuilder* b) const {
+    b->appendNumber("available", static_cast<long long>(_readyPool.size()));
+    b->appendNumber("inUse", static_cast<long long>(_checkedOutPool.size()));
+    b->appendNumber("inSetupOrRefresh", static_cast<long long>(_processingPool.size()));
+    b->appendNumber("waiting", static_cast<long long>(_requests.size()));
+    b->appendNumber("created", static_cast<long long>(_totalCreated));
+
+    BSONObjBuilder histogram(b->subobjStart("acquireTimeMillis"));
+    for (size_t i = 0; i < kAcquireTimeBuckets.size(); ++i) {
+        const std::string bucket = str::stream() << "<" << kAcquireTimeBuckets[i].count();
+        histogram.appendNumber(bucket, static_cast<long long>(_acquireTimes[i]));
+    }
+    const std::string lastBucket = str::stream() << ">=" << kAcquireTimeBuckets.back().count();
+    histogram.appendNumber(lastBucket, static_cast<long long>(_acquireTimes.back()));
 }
 
 void ConnectionPool::SpecificPool::getConnection(const HostAndPort& hostAndPort,
                                                  Milliseconds timeout,
                                                  stdx::unique_lock<stdx::mutex> lk,
                                                  GetConnectionCallback cb) {
-    auto expiration = _parent->_factory->now() + timeout;
+    auto now = _parent->_factory->now();
 
-    _requests.push(make_pair(expiration, std::move(cb)));
+    _requests.push(Request{now + timeout, now, std::move(cb)});
 
     updateStateInLock();
 
@@ -351,12 +425,15 @@ void ConnectionPool::SpecificPool::processFailure(const Status& status,
     // Update state to reflect the lack of requests
     updateStateInLock();
 
+    // Give the host some time to recover before re-establishing minConnections
+    scheduleRefill();
+
     // Drop the lock and process all of the requests
     // with the same failed status
     lk.unlock();
 
     while (requestsToFail.size()) {
-        requestsToFail.top().second(status);
+        requestsToFail.top().cb(status);
         requestsToFail.pop();
     }
 }
@@ -383,7 +460,8 @@ void ConnectionPool::SpecificPool::fulfillRequests(stdx::unique_lock<stdx::mutex
         conn->cancelTimeout();
 
         // Grab the request and callback
-        auto cb = std::move(_requests.top().second);
+        auto cb = std::move(_requests.top().cb);
+        recordAcquireTime(_parent->_factory->now() - _requests.top().requested);
         _requests.pop();
 
         updateStateInLock();
@@ -417,6 +495,7 @@ void ConnectionPool::SpecificPool::spawnConnections(stdx::unique_lock<stdx::mute
         auto handle = _parent->_factory->makeConnection(hostAndPort, _generation);
         auto connPtr = handle.get();
         _processingPool[connPtr] = std::move(handle);
+        ++_totalCreated;
 
         // Run the setup callback
         lk.unlock();
@@ -445,6 +524,33 @@ void ConnectionPool::SpecificPool::spawnConnections(stdx::unique_lock<stdx::mute
     }
 }
 
+// Arms the refill timer, unless it is already armed
+void ConnectionPool::SpecificPool::scheduleRefill() {
+    if (_refillScheduled || _state == State::kInShutdown)
+        return;
+
+    _refillScheduled = true;
+
+    _refillTimer->setTimeout(_parent->_options.refillDelay,
+                             [this]() {
+                                 stdx::unique_lock<stdx::mutex> lk(_parent->_mutex);
+
+                                 _refillScheduled = false;
+
+                                 // If we're in shutdown, we don't need new connections
+                                 if (_state == State::kInShutdown)
+                                     return;
+
+                                 spawnConnections(lk, _hostAndPort);
+                             });
+}
+
+void ConnectionPool::SpecificPool::recordAcquireTime(Milliseconds acquireTime) {
+    auto bucket = std::upper_bound(
+        kAcquireTimeBuckets.begin(), kAcquireTimeBuckets.end(), acquireTime);
+    _acquireTimes[bucket - kAcquireTimeBuckets.begin()]++;
+}
+
 // Called every second after hostTimeout until all processing connections reap
 void ConnectionPool::SpecificPool::shutdown() {
     stdx::unique_lock<stdx::mutex> lk(_parent->_mutex);
@@ -491,16 +597,16 @@ void ConnectionPool::SpecificPool::updateStateInLock() {
 
         // If we were already running and the timer is the same as it was
         // before, nothing to do
-        if (_state == State::kRunning && _requestTimerExpiration == _requests.top().first)
+        if (_state == State::kRunning && _requestTimerExpiration == _requests.top().expiration)
             return;
 
         _state = State::kRunning;
 
         _requestTimer->cancelTimeout();
 
-        _requestTimerExpiration = _requests.top().first;
+        _requestTimerExpiration = _requests.top().expiration;
 
-        auto timeout = _requests.top().first - _parent->_factory->now();
+        auto timeout = _requests.top().expiration - _parent->_factory->now();
 
         // We set a timer for the most recent request, then invoke each timed
         // out request we couldn't service
@@ -514,8 +620,8 @@ void ConnectionPool::SpecificPool::updateStateInLock() {
                 while (_requests.size()) {
                     auto& x = _requests.top();
 
-                    if (x.first <= now) {
-                        auto cb = std::move(x.second);
+                    if (x.expiration <= now) {
+                        auto cb = std::move(x.cb);
                         _requests.pop();
 
                         lk.unlock();
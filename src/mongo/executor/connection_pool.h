@@ -38,6 +38,9 @@
 #include "mongo/util/net/hostandport.h"
 
 namespace mongo {
+
+class BSONObjBuilder;
+
 namespace executor {
 
 /**
@@ -65,13 +68,15 @@ public:
     static const Milliseconds kDefaultRefreshTimeout;
     static const Milliseconds kDefaultRefreshRequirement;
     static const Milliseconds kDefaultHostTimeout;
+    static const Milliseconds kDefaultRefillDelay;
 
     struct Options {
         Options() {}
 
         /**
          * The minimum number of connections to keep alive while the pool is in
-         * operation
+         * operation. These are established as soon as a host is first used, and
+         * re-established refillDelay after they are dropped because of a failure.
          */
         size_t minConnections = 1;
 
@@ -99,6 +104,12 @@ public:
          * out connections or new requests
          */
         Milliseconds hostTimeout = kDefaultHostTimeout;
+
+        /**
+         * Amount of time to wait after a failure dropped a host's connections
+         * before establishing minConnections to it again
+         */
+        Milliseconds refillDelay = kDefaultRefillDelay;
     };
 
     explicit ConnectionPool(std::unique_ptr<DependentTypeFactoryInterface> impl,
@@ -111,8 +122,10 @@ public:
     void get(const HostAndPort& hostAndPort, Milliseconds timeout, GetConnectionCallback cb);
 
     /**
-     * TODO add a function returning connection pool stats
+     * Appends, for each host, the number of connections in each state and a
+     * histogram of the time it took requests to acquire a connection.
      */
+    void appendConnectionStats(BSONObjBuilder* b);
 
 private:
     void returnConnection(ConnectionInterface* connection);
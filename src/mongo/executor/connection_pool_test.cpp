@@ -29,6 +29,7 @@
 
 #include "mongo/executor/connection_pool_test_fixture.h"
 
+#include "mongo/db/jsobj.h"
 #include "mongo/executor/connection_pool.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/stdx/memory.h"
@@ -785,6 +786,113 @@ TEST_F(ConnectionPoolTest, dropConnections) {
     ASSERT(reachedB);
 }
 
+/**
+ * Verify that minConnections are re-established once the refillDelay has
+ * passed after a failure
+ */
+TEST_F(ConnectionPoolTest, refillAfterFailure) {
+    ConnectionPool::Options options;
+    options.minConnections = 2;
+    options.refillDelay = Milliseconds(1000);
+    ConnectionPool pool(stdx::make_unique<PoolImpl>(), options);
+
+    auto now = Date_t::now();
+    PoolImpl::setNow(now);
+
+    bool reachedA = false;
+
+    // Both connections are spawned by the first request
+    pool.get(HostAndPort(),
+             Milliseconds(5000),
+             [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                 ASSERT(!swConn.isOK());
+                 reachedA = true;
+             });
+    ASSERT(!reachedA);
+
+    // Failing the first one fails the request and drops the second
+    ConnectionImpl::pushSetup(Status(ErrorCodes::HostUnreachable, "host unreachable"));
+    ASSERT(reachedA);
+    ConnectionImpl::pushSetup(Status::OK());
+
+    // Nothing is spawned before the refillDelay
+    PoolImpl::setNow(now + Milliseconds(999));
+
+    {
+        BSONObjBuilder b;
+        pool.appendConnectionStats(&b);
+        auto stats = b.obj()[HostAndPort().toString()].Obj();
+        ASSERT_EQ(0, stats["available"].numberLong());
+        ASSERT_EQ(2, stats["created"].numberLong());
+    }
+
+    // Both connections come back once it has passed
+    PoolImpl::setNow(now + Milliseconds(1000));
+    ConnectionImpl::pushSetup(Status::OK());
+    ConnectionImpl::pushSetup(Status::OK());
+
+    {
+        BSONObjBuilder b;
+        pool.appendConnectionStats(&b);
+        auto stats = b.obj()[HostAndPort().toString()].Obj();
+        ASSERT_EQ(2, stats["available"].numberLong());
+        ASSERT_EQ(4, stats["created"].numberLong());
+    }
+
+    // And serve requests without any more setup
+    bool reachedB = false;
+    pool.get(HostAndPort(),
+             Milliseconds(5000),
+             [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                 ASSERT(swConn.isOK());
+                 reachedB = true;
+             });
+    ASSERT(reachedB);
+}
+
+/**
+ * Verify that the time requests wait for a connection is recorded in the
+ * acquire time histogram
+ */
+TEST_F(ConnectionPoolTest, acquireTimeHistogram) {
+    ConnectionPool pool(stdx::make_unique<PoolImpl>());
+
+    auto now = Date_t::now();
+    PoolImpl::setNow(now);
+
+    bool reachedA = false;
+
+    // Queue up a request that waits for its connection
+    pool.get(HostAndPort(),
+             Milliseconds(5000),
+             [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                 ASSERT(swConn.isOK());
+                 reachedA = true;
+             });
+    ASSERT(!reachedA);
+
+    PoolImpl::setNow(now + Milliseconds(30));
+    ConnectionImpl::pushSetup(Status::OK());
+    ASSERT(reachedA);
+
+    // And get one that is immediately available
+    bool reachedB = false;
+    pool.get(HostAndPort(),
+             Milliseconds(5000),
+             [&](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+                 ASSERT(swConn.isOK());
+                 reachedB = true;
+             });
+    ASSERT(reachedB);
+
+    BSONObjBuilder b;
+    pool.appendConnectionStats(&b);
+    auto histogram = b.obj()[HostAndPort().toString()]["acquireTimeMillis"].Obj();
+    ASSERT_EQ(1, histogram["<1"].numberLong());
+    ASSERT_EQ(1, histogram["<50"].numberLong());
+    ASSERT_EQ(0, histogram[">=5000"].numberLong());
+}
+
 }  // namespace connection_pool_test_details
 }  // namespace executor
 }  // namespace mongo
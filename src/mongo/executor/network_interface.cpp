@@ -43,6 +43,14 @@ const unsigned int NetworkInterface::kMessagingPortKeepOpen;
 NetworkInterface::NetworkInterface() {}
 NetworkInterface::~NetworkInterface() {}
 
+void NetworkInterface::appendConnectionStats(BSONObjBuilder* b) {}
+
+bool NetworkInterface::isHostAccepting(const HostAndPort& host) {
+    return true;
+}
+
+void NetworkInterface::appendCircuitBreakerStats(BSONObjBuilder* b) {}
+
 
 }  // namespace executor
 }  // namespace mongo
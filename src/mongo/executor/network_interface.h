@@ -36,6 +36,9 @@
 #include "mongo/stdx/functional.h"
 
 namespace mongo {
+
+class BSONObjBuilder;
+
 namespace executor {
 
 /**
@@ -130,6 +133,25 @@ public:
      */
     virtual void setAlarm(Date_t when, const stdx::function<void()>& action) = 0;
 
+    /**
+     * Appends information about the connections this interface keeps to remote hosts. By
+     * default, nothing is appended.
+     */
+    virtual void appendConnectionStats(BSONObjBuilder* b);
+
+    /**
+     * Returns whether a command to "host" started now would be sent to it, rather than fail right
+     * away because recent commands to the host failed or too many are outstanding. By default,
+     * every host is accepting.
+     */
+    virtual bool isHostAccepting(const HostAndPort& host);
+
+    /**
+     * Appends the state of the circuit breakers this interface keeps for remote hosts. By
+     * default, nothing is appended.
+     */
+    virtual void appendCircuitBreakerStats(BSONObjBuilder* b);
+
 protected:
     NetworkInterface();
 };
@@ -63,6 +63,7 @@ NetworkInterfaceASIO::NetworkInterfaceASIO(
       _streamFactory(std::move(streamFactory)),
       _connectionPool(stdx::make_unique<connection_pool_asio::ASIOImpl>(this),
                       _options.connectionPoolOptions),
+      _circuitBreaker(_options.circuitBreakerOptions),
       _isExecutorRunnable(false) {}
 
 std::string NetworkInterfaceASIO::getDiagnosticString() {
@@ -131,14 +132,72 @@ Date_t NetworkInterfaceASIO::now() {
 void NetworkInterfaceASIO::startCommand(const TaskExecutor::CallbackHandle& cbHandle,
                                         const RemoteCommandRequest& request,
                                         const RemoteCommandCompletionFn& onFinish) {
+    auto startTime = now();
+
+    if (!_circuitBreaker.enabled()) {
+        return _dispatchCommand(cbHandle, request, onFinish, startTime);
+    }
+
+    auto admitted = _circuitBreaker.onStart(request.target, startTime);
+    if (!admitted.isOK()) {
+        // Completed on the ASIO thread, as our caller may hold locks which onFinish takes.
+        asio::post(_io_service,
+                   [this, admitted, onFinish] {
+                       onFinish(admitted);
+                       signalWorkAvailable();
+                   });
+        return;
+    }
+
+    auto timedRequest = request;
+    timedRequest.timeout = _circuitBreaker.timeoutFor(request.target, request.timeout);
+
+    const auto target = request.target;
+    auto reportingOnFinish = [this, target, startTime, onFinish](const ResponseStatus& response) {
+        // Only commands which got no response at all count against the host.
+        const bool failed =
+            !response.isOK() && response.getStatus() != ErrorCodes::CallbackCanceled;
+        const auto finishTime = now();
+        _circuitBreaker.onFinish(target, finishTime, finishTime - startTime, failed);
+        onFinish(response);
+    };
+
+    _dispatchCommand(cbHandle, timedRequest, reportingOnFinish, startTime);
+}
+
+void NetworkInterfaceASIO::_dispatchCommand(const TaskExecutor::CallbackHandle& cbHandle,
+                                            const RemoteCommandRequest& request,
+                                            const RemoteCommandCompletionFn& onFinish,
+                                            Date_t startTime) {
+    const bool hasTimeout = request.timeout != RemoteCommandRequest::kNoTimeout;
+
+    if (_options.multiplexCommands) {
+        asio::post(_io_service,
+                   [this, startTime, cbHandle, request, onFinish, hasTimeout] {
+                       auto& multiplexed = _multiplexed[request.target];
+                       if (!multiplexed) {
+                           multiplexed =
+                               std::make_shared<MultiplexedConnection>(this, request.target);
+                       }
+
+                       // Hold a reference, as the command may complete, and the connection
+                       // retire, before startCommand() returns.
+                       auto conn = multiplexed;
+                       conn->startCommand(cbHandle, request, onFinish, startTime);
+
+                       if (hasTimeout) {
+                           _setTimeout(cbHandle, startTime + request.timeout);
+                       }
+                   });
+        return;
+    }
+
     {
         stdx::lock_guard<stdx::mutex> lk(_inProgressMutex);
         _inGetConnection.push_back(cbHandle);
     }
 
-    auto startTime = now();
-
-    auto nextStep = [this, startTime, cbHandle, request, onFinish](
+    auto nextStep = [this, startTime, cbHandle, request, onFinish, hasTimeout](
         StatusWith<ConnectionPool::ConnectionHandle> swConn) {
 
         if (!swConn.isOK()) {
@@ -180,17 +239,70 @@ void NetworkInterfaceASIO::startCommand(const TaskExecutor::CallbackHandle& cbHa
         op->_connectionPoolHandle = std::move(swConn.getValue());
         op->_start = startTime;
 
+        if (hasTimeout) {
+            _setTimeout(cbHandle, startTime + request.timeout);
+        }
+
         _beginCommunication(op);
     };
 
-    // TODO: thread some higher level timeout through, rather than 5 minutes,
-    // once we make timeouts pervasive in this api.
-    asio::post(
-        _io_service,
-        [this, request, nextStep] { _connectionPool.get(request.target, Minutes(5), nextStep); });
+    // TODO: thread some higher level timeout through for commands without one, rather than 5
+    // minutes, once we make timeouts pervasive in this api.
+    const Milliseconds getConnectionTimeout = hasTimeout ? request.timeout : Minutes(5);
+    asio::post(_io_service,
+               [this, request, nextStep, getConnectionTimeout] {
+                   _connectionPool.get(request.target, getConnectionTimeout, nextStep);
+               });
+}
+
+void NetworkInterfaceASIO::_setTimeout(const TaskExecutor::CallbackHandle& cbHandle,
+                                       Date_t deadline) {
+    // "alarm" must stay alive until it expires, hence the shared_ptr.
+    auto alarm = std::make_shared<asio::steady_timer>(_io_service, deadline - now());
+    alarm->async_wait([alarm, this, cbHandle](std::error_code ec) {
+        if (ec) {
+            return;
+        }
+
+        if (_options.multiplexCommands) {
+            const Status timedOut(ErrorCodes::ExceededTimeLimit,
+                                  "Timed out waiting for a response to a multiplexed command");
+            for (auto&& conn : _multiplexedConnections()) {
+                if (conn->cancelCommand(cbHandle, timedOut)) {
+                    break;
+                }
+            }
+            return;
+        }
+
+        // The command usually completed long before, in which case it is not found.
+        stdx::lock_guard<stdx::mutex> lk(_inProgressMutex);
+        for (auto&& entry : _inProgress) {
+            auto op = entry.first;
+            if (op->cbHandle() == cbHandle) {
+                // Aborts the pending read or write, which then completes the operation.
+                op->timeOut();
+                op->connection().stream().cancel();
+                break;
+            }
+        }
+    });
 }
 
 void NetworkInterfaceASIO::cancelCommand(const TaskExecutor::CallbackHandle& cbHandle) {
+    if (_options.multiplexCommands) {
+        asio::post(_io_service,
+                   [this, cbHandle] {
+                       const Status canceled(ErrorCodes::CallbackCanceled, "Callback canceled");
+                       for (auto&& conn : _multiplexedConnections()) {
+                           if (conn->cancelCommand(cbHandle, canceled)) {
+                               break;
+                           }
+                       }
+                   });
+        return;
+    }
+
     stdx::lock_guard<stdx::mutex> lk(_inProgressMutex);
     for (auto iter = _inProgress.begin(); iter != _inProgress.end(); ++iter) {
         if (iter->first->cbHandle() == cbHandle) {
@@ -201,6 +313,16 @@ void NetworkInterfaceASIO::cancelCommand(const TaskExecutor::CallbackHandle& cbH
 }
 
 void NetworkInterfaceASIO::cancelAllCommands() {
+    if (_options.multiplexCommands) {
+        asio::post(_io_service,
+                   [this] {
+                       for (auto&& conn : _multiplexedConnections()) {
+                           conn->cancelAllCommands();
+                       }
+                   });
+        return;
+    }
+
     stdx::lock_guard<stdx::mutex> lk(_inProgressMutex);
     for (auto iter = _inProgress.begin(); iter != _inProgress.end(); ++iter) {
         iter->first->cancel();
@@ -221,6 +343,28 @@ void NetworkInterfaceASIO::setAlarm(Date_t when, const stdx::function<void()>& a
     });
 };
 
+void NetworkInterfaceASIO::appendConnectionStats(BSONObjBuilder* b) {
+    _connectionPool.appendConnectionStats(b);
+}
+
+bool NetworkInterfaceASIO::isHostAccepting(const HostAndPort& host) {
+    return !_circuitBreaker.enabled() || _circuitBreaker.accepts(host, now());
+}
+
+void NetworkInterfaceASIO::appendCircuitBreakerStats(BSONObjBuilder* b) {
+    _circuitBreaker.appendStats(b, now());
+}
+
+std::vector<std::shared_ptr<NetworkInterfaceASIO::MultiplexedConnection>>
+NetworkInterfaceASIO::_multiplexedConnections() {
+    // Copied, as canceling commands may retire connections and remove them from _multiplexed
+    std::vector<std::shared_ptr<MultiplexedConnection>> conns;
+    for (auto&& x : _multiplexed) {
+        conns.push_back(x.second);
+    }
+    return conns;
+}
+
 bool NetworkInterfaceASIO::inShutdown() const {
     return (_state.load() == State::kShutdown);
 }
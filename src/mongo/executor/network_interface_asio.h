@@ -31,14 +31,17 @@
 #include <asio.hpp>
 
 #include <boost/optional.hpp>
+#include <deque>
 #include <memory>
 #include <string>
 #include <system_error>
 #include <unordered_map>
 #include <vector>
 
+#include "mongo/base/disallow_copying.h"
 #include "mongo/base/status.h"
 #include "mongo/base/system_error.h"
+#include "mongo/executor/circuit_breaker.h"
 #include "mongo/executor/connection_pool.h"
 #include "mongo/executor/network_connection_hook.h"
 #include "mongo/executor/network_interface.h"
@@ -51,6 +54,7 @@
 #include "mongo/stdx/mutex.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor.h"
 
 namespace mongo {
 namespace executor {
@@ -75,7 +79,22 @@ class NetworkInterfaceASIO final : public NetworkInterface {
 
 public:
     struct Options {
+        Options() {}
+
         ConnectionPool::Options connectionPoolOptions;
+
+        /**
+         * If set, all commands to a host share a single connection, on which they are tagged
+         * with their requestID and matched to their replies by responseTo, instead of each
+         * holding a connection of its own for the duration of the command.
+         */
+        bool multiplexCommands = false;
+
+        /**
+         * Decides from the recent commands to each host whether new ones are sent to it, and
+         * which timeout those sent without one get.
+         */
+        CircuitBreaker::Options circuitBreakerOptions;
     };
 
     NetworkInterfaceASIO(std::unique_ptr<AsyncStreamFactoryInterface> streamFactory,
@@ -97,6 +116,9 @@ public:
     void cancelCommand(const TaskExecutor::CallbackHandle& cbHandle) override;
     void cancelAllCommands() override;
     void setAlarm(Date_t when, const stdx::function<void()>& action) override;
+    void appendConnectionStats(BSONObjBuilder* b) override;
+    bool isHostAccepting(const HostAndPort& host) override;
+    void appendCircuitBreakerStats(BSONObjBuilder* b) override;
 
     bool inShutdown() const;
 
@@ -108,6 +130,7 @@ private:
     enum class State { kReady, kRunning, kShutdown };
 
     friend class AsyncOp;
+    class MultiplexedConnection;
 
     /**
      * AsyncConnection encapsulates the per-connection state we maintain.
@@ -122,6 +145,9 @@ private:
         rpc::ProtocolSet clientProtocols() const;
         void setServerProtocols(rpc::ProtocolSet protocols);
 
+        MessageCompressorId messageCompressor() const;
+        void setMessageCompressor(MessageCompressorId compressor);
+
 // Explicit move construction and assignment to support MSVC
 #if defined(_MSC_VER) && _MSC_VER < 1900
         AsyncConnection(AsyncConnection&&);
@@ -136,6 +162,9 @@ private:
 
         rpc::ProtocolSet _serverProtocols;
         rpc::ProtocolSet _clientProtocols{rpc::supports::kAll};
+
+        // Compressor negotiated in the isMaster handshake, used for the commands we send.
+        MessageCompressorId _messageCompressor{MessageCompressorId::kNoop};
     };
 
     /**
@@ -165,9 +194,20 @@ private:
 
         AsyncCommand(AsyncConnection* conn, CommandType type, Message&& command, Date_t now);
 
+        /**
+         * Builds the command for "request" to be sent over "conn" into "command",
+         * downconverting find and getMore commands if the server does not support OP_COMMAND.
+         */
+        static Status make(AsyncConnection* conn,
+                           rpc::Protocol protocol,
+                           const RemoteCommandRequest& request,
+                           Date_t now,
+                           boost::optional<AsyncCommand>* command);
+
         NetworkInterfaceASIO::AsyncConnection& conn();
 
         Message& toSend();
+        Message& toSendCompressed();
         Message& toRecv();
         MSGHEADER::Value& header();
 
@@ -181,6 +221,9 @@ private:
         Message _toSend;
         Message _toRecv;
 
+        // The compressed form of _toSend, if the connection uses compression.
+        Message _toSendCompressed;
+
         // TODO: Investigate efficiency of storing header separately.
         MSGHEADER::Value _header;
 
@@ -192,6 +235,7 @@ private:
      */
     class AsyncOp {
         friend class NetworkInterfaceASIO;
+        friend class MultiplexedConnection;
 
     public:
         AsyncOp(NetworkInterfaceASIO* net,
@@ -203,6 +247,17 @@ private:
         void cancel();
         bool canceled() const;
 
+        /**
+         * Cancels the operation because its request timed out, unless it was already canceled.
+         */
+        void timeOut();
+
+        /**
+         * The status a canceled operation completes with: ExceededTimeLimit if it timed out and
+         * CallbackCanceled otherwise.
+         */
+        Status cancelStatus() const;
+
         const TaskExecutor::CallbackHandle& cbHandle() const;
 
         AsyncConnection& connection();
@@ -254,6 +309,7 @@ private:
 
         Date_t _start;
 
+        // 0 while the operation runs, 1 once canceled and 2 once timed out
         AtomicUInt64 _canceled;
 
         /**
@@ -265,8 +321,92 @@ private:
         bool _inSetup;
     };
 
+    /**
+     * MultiplexedConnection runs the commands to one host over a single pooled connection when
+     * Options::multiplexCommands is set. Commands are written as soon as they are started and
+     * replies are matched to them by responseTo, so any number of them may be in flight at
+     * once. The connection goes back to the pool as soon as nothing is in flight on it.
+     *
+     * Only used on the ASIO thread. Pending network operations hold a reference to the object,
+     * so it outlives its removal from _multiplexed.
+     */
+    class MultiplexedConnection : public std::enable_shared_from_this<MultiplexedConnection> {
+        MONGO_DISALLOW_COPYING(MultiplexedConnection);
+
+    public:
+        MultiplexedConnection(NetworkInterfaceASIO* net, const HostAndPort& target);
+
+        void startCommand(const TaskExecutor::CallbackHandle& cbHandle,
+                          const RemoteCommandRequest& request,
+                          const RemoteCommandCompletionFn& onFinish,
+                          Date_t start);
+
+        /**
+         * Completes the command for "cbHandle" with "status". Its reply, if already requested,
+         * is discarded when it arrives. Returns false if the command is not here.
+         */
+        bool cancelCommand(const TaskExecutor::CallbackHandle& cbHandle, const Status& status);
+        void cancelAllCommands();
+
+    private:
+        struct PendingCommand {
+            TaskExecutor::CallbackHandle cbHandle;
+            RemoteCommandRequest request;
+            RemoteCommandCompletionFn onFinish;
+            Date_t start;
+            boost::optional<AsyncCommand> command;
+
+            // Set once onFinish has been called.
+            bool finished = false;
+        };
+
+        void _acquireConnection();
+        void _sendNext();
+        void _receiveNext();
+        void _dispatchReply();
+        void _fail(const Status& status);
+        void _complete(PendingCommand* pending, const ResponseStatus& status);
+        void _retireIfIdle();
+
+        NetworkInterfaceASIO* const _net;
+        const HostAndPort _target;
+
+        // The connection and the operation which set it up, while checked out of the pool.
+        std::unique_ptr<AsyncOp> _op;
+
+        // Commands waiting to be written, in order.
+        std::deque<std::unique_ptr<PendingCommand>> _toSend;
+
+        // Written commands by requestID. Commands which were canceled or failed stay here until
+        // their reply is read, or until the connection is given up.
+        std::unordered_map<int32_t, std::unique_ptr<PendingCommand>> _inFlight;
+
+        bool _acquiring = false;
+        bool _sending = false;
+        bool _receiving = false;
+
+        // Set on the first error on the connection, after which it is not used again.
+        Status _failure = Status::OK();
+
+        MSGHEADER::Value _header;
+        Message _toRecv;
+    };
+
     void _startCommand(AsyncOp* op);
 
+    void _dispatchCommand(const TaskExecutor::CallbackHandle& cbHandle,
+                          const RemoteCommandRequest& request,
+                          const RemoteCommandCompletionFn& onFinish,
+                          Date_t startTime);
+
+    /**
+     * Completes the command for "cbHandle" with ExceededTimeLimit at "deadline", if it is still
+     * running by then.
+     */
+    void _setTimeout(const TaskExecutor::CallbackHandle& cbHandle, Date_t deadline);
+
+    std::vector<std::shared_ptr<MultiplexedConnection>> _multiplexedConnections();
+
     /**
      * Wraps a completion handler in pre-condition checks.
      * When we resume after an asynchronous call, we may find the following:
@@ -278,8 +418,7 @@ private:
     template <typename Handler>
     void _validateAndRun(AsyncOp* op, std::error_code ec, Handler&& handler) {
         if (op->canceled())
-            return _completeOperation(op,
-                                      Status(ErrorCodes::CallbackCanceled, "Callback canceled"));
+            return _completeOperation(op, op->cancelStatus());
         if (ec)
             return _networkErrorCallback(op, ec);
 
@@ -306,6 +445,9 @@ private:
 
     void _asyncRunCommand(AsyncCommand* cmd, NetworkOpHandler handler);
 
+    // Returns the message to write for "cmd", compressed if its connection uses compression.
+    Message* _messageToSend(AsyncCommand* cmd);
+
     Options _options;
 
     asio::io_service _io_service;
@@ -321,6 +463,12 @@ private:
 
     ConnectionPool _connectionPool;
 
+    CircuitBreaker _circuitBreaker;
+
+    // Only used on the ASIO thread. Declared after _connectionPool, so that the connections
+    // they hold are returned before it is destroyed.
+    std::unordered_map<HostAndPort, std::shared_ptr<MultiplexedConnection>> _multiplexed;
+
     stdx::mutex _inProgressMutex;
     std::unordered_map<AsyncOp*, std::unique_ptr<AsyncOp>> _inProgress;
     std::vector<TaskExecutor::CallbackHandle> _inGetConnection;
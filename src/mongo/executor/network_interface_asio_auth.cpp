@@ -41,6 +41,7 @@
 #include "mongo/rpc/legacy_request_builder.h"
 #include "mongo/rpc/reply_interface.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/net/message_compressor.h"
 #include "mongo/util/net/ssl_manager.h"
 
 namespace mongo {
@@ -55,7 +56,11 @@ void NetworkInterfaceASIO::_runIsMaster(AsyncOp* op) {
     requestBuilder.setDatabase("admin");
     requestBuilder.setCommandName("isMaster");
     requestBuilder.setMetadata(rpc::makeEmptyMetadata());
-    requestBuilder.setCommandArgs(BSON("isMaster" << 1));
+
+    BSONObjBuilder isMasterCmd;
+    isMasterCmd.append("isMaster", 1);
+    appendMessageCompressionRequest(&isMasterCmd);
+    requestBuilder.setCommandArgs(isMasterCmd.done());
 
     // Set current command to ismaster request and run
     auto beginStatus = op->beginCommand(std::move(*(requestBuilder.done())));
@@ -87,6 +92,7 @@ void NetworkInterfaceASIO::_runIsMaster(AsyncOp* op) {
             return _completeOperation(op, protocolSet.getStatus());
 
         op->connection().setServerProtocols(protocolSet.getValue());
+        op->connection().setMessageCompressor(getNegotiatedMessageCompressor(commandReply.data));
 
         // Set the operation protocol
         auto negotiatedProtocol =
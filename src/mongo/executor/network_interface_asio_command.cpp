@@ -49,6 +49,7 @@
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/message_compressor.h"
 
 namespace mongo {
 namespace executor {
@@ -150,6 +151,32 @@ ResponseStatus decodeRPC(Message* received, rpc::Protocol protocol, Milliseconds
     }
 }
 
+// Replaces a compressed reply in "m" with its decompressed form.
+Status decompressReply(Message* m) {
+    if (m->operation() != dbCompressed) {
+        return Status::OK();
+    }
+
+    Message decompressed;
+    Status status = decompressMessage(*m, &decompressed);
+    m->reset();
+    if (!status.isOK()) {
+        LOG(3) << "failed to decompress response: " << status;
+        return status;
+    }
+    *m = std::move(decompressed);
+    return Status::OK();
+}
+
+Status statusFromNetworkError(const std::error_code& ec) {
+    if (ec.category() == mongoErrorCategory()) {
+        // If we get a Mongo error code, we can preserve it.
+        return Status(ErrorCodes::fromInt(ec.value()), ec.message());
+    }
+    // If we get an asio or system error, we just convert it to a network error.
+    return Status(ErrorCodes::HostUnreachable, ec.message());
+}
+
 }  // namespace
 
 NetworkInterfaceASIO::AsyncCommand::AsyncCommand(AsyncConnection* conn,
@@ -168,6 +195,10 @@ Message& NetworkInterfaceASIO::AsyncCommand::toSend() {
     return _toSend;
 }
 
+Message& NetworkInterfaceASIO::AsyncCommand::toSendCompressed() {
+    return _toSendCompressed;
+}
+
 Message& NetworkInterfaceASIO::AsyncCommand::toRecv() {
     return _toRecv;
 }
@@ -238,13 +269,7 @@ void NetworkInterfaceASIO::_completedOpCallback(AsyncOp* op) {
 
 void NetworkInterfaceASIO::_networkErrorCallback(AsyncOp* op, const std::error_code& ec) {
     LOG(3) << "networking error occurred";
-    if (ec.category() == mongoErrorCategory()) {
-        // If we get a Mongo error code, we can preserve it.
-        _completeOperation(op, Status(ErrorCodes::fromInt(ec.value()), ec.message()));
-    } else {
-        // If we get an asio or system error, we just convert it to a network error.
-        _completeOperation(op, Status(ErrorCodes::HostUnreachable, ec.message()));
-    }
+    _completeOperation(op, statusFromNetworkError(ec));
 }
 
 // NOTE: This method may only be called by ASIO threads
@@ -291,8 +316,15 @@ void NetworkInterfaceASIO::_asyncRunCommand(AsyncCommand* cmd, NetworkOpHandler
     // 4 - advance the state machine by calling handler()
 
     // Step 4
-    auto recvMessageCallback =
-        [this, cmd, handler](std::error_code ec, size_t bytes) { handler(ec, bytes); };
+    auto recvMessageCallback = [this, cmd, handler](std::error_code ec, size_t bytes) {
+        if (!ec) {
+            Status status = decompressReply(&cmd->toRecv());
+            if (!status.isOK()) {
+                return handler(make_error_code(status.code()), bytes);
+            }
+        }
+        handler(ec, bytes);
+    };
 
     // Step 3
     auto recvHeaderCallback = [this, cmd, handler, recvMessageCallback](std::error_code ec,
@@ -324,7 +356,22 @@ void NetworkInterfaceASIO::_asyncRunCommand(AsyncCommand* cmd, NetworkOpHandler
     };
 
     // Step 1
-    asyncSendMessage(cmd->conn().stream(), &cmd->toSend(), std::move(sendMessageCallback));
+    asyncSendMessage(cmd->conn().stream(), _messageToSend(cmd), std::move(sendMessageCallback));
+}
+
+Message* NetworkInterfaceASIO::_messageToSend(AsyncCommand* cmd) {
+    const MessageCompressorId compressor = cmd->conn().messageCompressor();
+    if (compressor == MessageCompressorId::kNoop) {
+        return &cmd->toSend();
+    }
+
+    cmd->toSendCompressed().reset();
+    Status status = compressMessage(compressor, cmd->toSend(), &cmd->toSendCompressed());
+    if (!status.isOK()) {
+        LOG(3) << "sending command uncompressed: " << status;
+        return &cmd->toSend();
+    }
+    return &cmd->toSendCompressed();
 }
 
 void NetworkInterfaceASIO::_runConnectionHook(AsyncOp* op) {
@@ -375,6 +422,293 @@ void NetworkInterfaceASIO::_runConnectionHook(AsyncOp* op) {
                             });
 }
 
+NetworkInterfaceASIO::MultiplexedConnection::MultiplexedConnection(NetworkInterfaceASIO* net,
+                                                                   const HostAndPort& target)
+    : _net(net), _target(target) {}
+
+void NetworkInterfaceASIO::MultiplexedConnection::startCommand(
+    const TaskExecutor::CallbackHandle& cbHandle,
+    const RemoteCommandRequest& request,
+    const RemoteCommandCompletionFn& onFinish,
+    Date_t start) {
+    LOG(3) << "running command " << request.cmdObj << " against database " << request.dbname
+           << " across multiplexed connection to " << _target.toString();
+
+    auto pending = stdx::make_unique<PendingCommand>();
+    pending->cbHandle = cbHandle;
+    pending->request = request;
+    pending->onFinish = onFinish;
+    pending->start = start;
+    _toSend.push_back(std::move(pending));
+
+    if (!_op) {
+        return _acquireConnection();
+    }
+    _sendNext();
+}
+
+bool NetworkInterfaceASIO::MultiplexedConnection::cancelCommand(
+    const TaskExecutor::CallbackHandle& cbHandle, const Status& status) {
+
+    for (auto iter = _toSend.begin(); iter != _toSend.end(); ++iter) {
+        if ((*iter)->cbHandle == cbHandle) {
+            auto pending = std::move(*iter);
+            _toSend.erase(iter);
+            _complete(pending.get(), status);
+            _retireIfIdle();
+            return true;
+        }
+    }
+
+    for (auto&& x : _inFlight) {
+        if (!x.second->finished && x.second->cbHandle == cbHandle) {
+            // The reply is still read off the connection, and then dropped.
+            _complete(x.second.get(), status);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void NetworkInterfaceASIO::MultiplexedConnection::cancelAllCommands() {
+    const Status canceled(ErrorCodes::CallbackCanceled, "Callback canceled");
+
+    auto toCancel = std::move(_toSend);
+    _toSend.clear();
+    for (auto&& pending : toCancel) {
+        _complete(pending.get(), canceled);
+    }
+
+    for (auto&& x : _inFlight) {
+        if (!x.second->finished) {
+            _complete(x.second.get(), canceled);
+        }
+    }
+
+    _retireIfIdle();
+}
+
+void NetworkInterfaceASIO::MultiplexedConnection::_acquireConnection() {
+    if (_acquiring || !_failure.isOK()) {
+        return;
+    }
+
+    _acquiring = true;
+
+    auto self = shared_from_this();
+
+    // TODO: thread some higher level timeout through, rather than 5 minutes,
+    // once we make timeouts pervasive in this api.
+    _net->_connectionPool.get(
+        _target,
+        Minutes(5),
+        [self](StatusWith<ConnectionPool::ConnectionHandle> swConn) {
+            self->_acquiring = false;
+
+            if (!swConn.isOK()) {
+                return self->_fail(swConn.getStatus());
+            }
+
+            auto conn =
+                static_cast<connection_pool_asio::ASIOConnection*>(swConn.getValue().get());
+
+            self->_op = conn->releaseAsyncOp();
+            self->_op->_connectionPoolHandle = std::move(swConn.getValue());
+
+            self->_sendNext();
+        });
+}
+
+// Writes the commands one at a time, since writes to the stream may not interleave
+void NetworkInterfaceASIO::MultiplexedConnection::_sendNext() {
+    if (_sending || !_failure.isOK()) {
+        return;
+    }
+
+    while (!_toSend.empty()) {
+        auto pending = std::move(_toSend.front());
+        _toSend.pop_front();
+
+        Status status = AsyncCommand::make(&_op->connection(),
+                                           _op->operationProtocol(),
+                                           pending->request,
+                                           _net->now(),
+                                           &pending->command);
+        if (!status.isOK()) {
+            _complete(pending.get(), status);
+            continue;
+        }
+
+        auto cmd = pending->command.get_ptr();
+
+        // Downconverted commands are built without a requestID, but replies can only be told
+        // apart by theirs.
+        cmd->toSend().header().setId(nextMessageId());
+        const int32_t requestId = cmd->toSend().header().getId();
+
+        Message* toSend = _net->_messageToSend(cmd);
+        _inFlight.emplace(requestId, std::move(pending));
+
+        _sending = true;
+
+        auto self = shared_from_this();
+        asyncSendMessage(_op->connection().stream(),
+                         toSend,
+                         [self](std::error_code ec, size_t bytes) {
+                             self->_sending = false;
+
+                             if (ec) {
+                                 return self->_fail(statusFromNetworkError(ec));
+                             }
+
+                             self->_sendNext();
+                         });
+
+        return _receiveNext();
+    }
+
+    _retireIfIdle();
+}
+
+// Keeps one read outstanding for as long as replies are expected
+void NetworkInterfaceASIO::MultiplexedConnection::_receiveNext() {
+    if (_receiving || !_failure.isOK() || _inFlight.empty()) {
+        return;
+    }
+
+    _receiving = true;
+
+    auto self = shared_from_this();
+    asyncRecvMessageHeader(
+        _op->connection().stream(),
+        &_header,
+        [self](std::error_code ec, size_t bytes) {
+            if (ec) {
+                self->_receiving = false;
+                return self->_fail(statusFromNetworkError(ec));
+            }
+
+            asyncRecvMessageBody(self->_op->connection().stream(),
+                                 &self->_header,
+                                 &self->_toRecv,
+                                 [self](std::error_code ec, size_t bytes) {
+                                     self->_receiving = false;
+
+                                     if (ec) {
+                                         return self->_fail(statusFromNetworkError(ec));
+                                     }
+
+                                     self->_dispatchReply();
+                                 });
+        });
+}
+
+void NetworkInterfaceASIO::MultiplexedConnection::_dispatchReply() {
+    const int32_t responseTo = _header.constView().getResponseTo();
+
+    auto iter = _inFlight.find(responseTo);
+    if (iter == _inFlight.end()) {
+        _toRecv.reset();
+        return _fail(Status(ErrorCodes::ProtocolError,
+                            str::stream() << "got response to unknown request id " << responseTo
+                                          << " from " << _target.toString()));
+    }
+
+    auto pending = std::move(iter->second);
+    _inFlight.erase(iter);
+
+    auto cmd = pending->command.get_ptr();
+    cmd->toRecv() = std::move(_toRecv);
+    _toRecv.reset();
+
+    if (!pending->finished) {
+        Status status = decompressReply(&cmd->toRecv());
+        if (!status.isOK()) {
+            _complete(pending.get(), status);
+        } else {
+            _complete(pending.get(), cmd->response(_op->operationProtocol(), _net->now()));
+        }
+    }
+
+    _receiveNext();
+    _retireIfIdle();
+}
+
+// Fails every command which has not completed yet and gives up the connection
+void NetworkInterfaceASIO::MultiplexedConnection::_fail(const Status& status) {
+    if (_failure.isOK()) {
+        LOG(3) << "multiplexed connection to " << _target.toString() << " failed: " << status;
+
+        _failure = status;
+
+        if (_op && (_sending || _receiving)) {
+            _op->connection().stream().cancel();
+        }
+
+        auto toFail = std::move(_toSend);
+        _toSend.clear();
+        for (auto&& pending : toFail) {
+            _complete(pending.get(), status);
+        }
+
+        for (auto&& x : _inFlight) {
+            if (!x.second->finished) {
+                _complete(x.second.get(), status);
+            }
+        }
+    }
+
+    _retireIfIdle();
+}
+
+void NetworkInterfaceASIO::MultiplexedConnection::_complete(PendingCommand* pending,
+                                                            const ResponseStatus& status) {
+    invariant(!pending->finished);
+    pending->finished = true;
+
+    auto onFinish = std::move(pending->onFinish);
+    onFinish(status);
+
+    _net->signalWorkAvailable();
+}
+
+// Returns the connection to the pool once no network operation is outstanding on it, and no
+// further commands or replies are due
+void NetworkInterfaceASIO::MultiplexedConnection::_retireIfIdle() {
+    if (_acquiring || _sending || _receiving) {
+        return;
+    }
+
+    if (_failure.isOK() && (!_toSend.empty() || !_inFlight.empty())) {
+        return;
+    }
+
+    // Removing ourselves from _multiplexed may release the last reference
+    auto self = shared_from_this();
+
+    auto iter = _net->_multiplexed.find(_target);
+    if (iter != _net->_multiplexed.end() && iter->second == self) {
+        _net->_multiplexed.erase(iter);
+    }
+
+    _inFlight.clear();
+
+    if (!_op) {
+        return;
+    }
+
+    auto conn = std::move(_op->_connectionPoolHandle);
+    auto asioConn = static_cast<connection_pool_asio::ASIOConnection*>(conn.get());
+
+    asioConn->bindAsyncOp(std::move(_op));
+    if (!_failure.isOK()) {
+        asioConn->indicateFailed(_failure);
+    } else {
+        asioConn->indicateUsed();
+    }
+}
+
 
 }  // namespace executor
 }  // namespace mongo
@@ -55,13 +55,15 @@ NetworkInterfaceASIO::AsyncConnection::AsyncConnection(std::unique_ptr<AsyncStre
 NetworkInterfaceASIO::AsyncConnection::AsyncConnection(AsyncConnection&& other)
     : _stream(std::move(other._stream)),
       _serverProtocols(other._serverProtocols),
-      _clientProtocols(other._clientProtocols) {}
+      _clientProtocols(other._clientProtocols),
+      _messageCompressor(other._messageCompressor) {}
 
 NetworkInterfaceASIO::AsyncConnection& NetworkInterfaceASIO::AsyncConnection::operator=(
     AsyncConnection&& other) {
     _stream = std::move(other._stream);
     _serverProtocols = other._serverProtocols;
     _clientProtocols = other._clientProtocols;
+    _messageCompressor = other._messageCompressor;
     return *this;
 }
 #endif
@@ -82,6 +84,14 @@ void NetworkInterfaceASIO::AsyncConnection::setServerProtocols(rpc::ProtocolSet
     _serverProtocols = protocols;
 }
 
+MessageCompressorId NetworkInterfaceASIO::AsyncConnection::messageCompressor() const {
+    return _messageCompressor;
+}
+
+void NetworkInterfaceASIO::AsyncConnection::setMessageCompressor(MessageCompressorId compressor) {
+    _messageCompressor = compressor;
+}
+
 void NetworkInterfaceASIO::_connect(AsyncOp* op) {
     tcp::resolver::query query(op->request().target.host(),
                                std::to_string(op->request().target.port()));
@@ -68,6 +68,45 @@ std::unique_ptr<Message> messageFromRequest(const RemoteCommandRequest& request,
 
 }  // namespace
 
+Status NetworkInterfaceASIO::AsyncCommand::make(AsyncConnection* conn,
+                                               rpc::Protocol protocol,
+                                               const RemoteCommandRequest& request,
+                                               Date_t now,
+                                               boost::optional<AsyncCommand>* command) {
+    // Check if we need to downconvert find or getMore commands.
+    StringData commandName = request.cmdObj.firstElement().fieldNameStringData();
+    const auto isFindCmd = commandName == LiteParsedQuery::kFindCommandName;
+    const auto isGetMoreCmd = commandName == GetMoreRequest::kGetMoreCommandName;
+    const auto isFindOrGetMoreCmd = isFindCmd || isGetMoreCmd;
+
+    // If we aren't sending a find or getMore, or the server supports OP_COMMAND we don't have
+    // to worry about downconversion.
+    if (!isFindOrGetMoreCmd || conn->serverProtocols() == rpc::supports::kAll) {
+        auto newCommand = messageFromRequest(request, protocol);
+        command->emplace(conn, CommandType::kRPC, std::move(*newCommand), now);
+        return Status::OK();
+    } else if (isFindCmd) {
+        auto downconvertedFind = downconvertFindCommandRequest(request);
+        if (!downconvertedFind.isOK()) {
+            return downconvertedFind.getStatus();
+        }
+        command->emplace(
+            conn, CommandType::kDownConvertedFind, std::move(downconvertedFind.getValue()), now);
+        return Status::OK();
+    } else {
+        invariant(isGetMoreCmd);
+        auto downconvertedGetMore = downconvertGetMoreCommandRequest(request);
+        if (!downconvertedGetMore.isOK()) {
+            return downconvertedGetMore.getStatus();
+        }
+        command->emplace(conn,
+                         CommandType::kDownConvertedGetMore,
+                         std::move(downconvertedGetMore.getValue()),
+                         now);
+        return Status::OK();
+    }
+}
+
 NetworkInterfaceASIO::AsyncOp::AsyncOp(NetworkInterfaceASIO* const owner,
                                        const TaskExecutor::CallbackHandle& cbHandle,
                                        const RemoteCommandRequest& request,
@@ -88,7 +127,20 @@ void NetworkInterfaceASIO::AsyncOp::cancel() {
 }
 
 bool NetworkInterfaceASIO::AsyncOp::canceled() const {
-    return (_canceled.load() == 1);
+    return (_canceled.load() != 0);
+}
+
+void NetworkInterfaceASIO::AsyncOp::timeOut() {
+    _canceled.compareAndSwap(0, 2);
+}
+
+Status NetworkInterfaceASIO::AsyncOp::cancelStatus() const {
+    if (_canceled.load() == 2) {
+        return {ErrorCodes::ExceededTimeLimit,
+                str::stream() << "Timed out after " << _request.timeout
+                              << " waiting for a response from " << _request.target.toString()};
+    }
+    return {ErrorCodes::CallbackCanceled, "Callback canceled"};
 }
 
 const TaskExecutor::CallbackHandle& NetworkInterfaceASIO::AsyncOp::cbHandle() const {
@@ -117,33 +169,13 @@ Status NetworkInterfaceASIO::AsyncOp::beginCommand(Message&& newCommand,
 }
 
 Status NetworkInterfaceASIO::AsyncOp::beginCommand(const RemoteCommandRequest& request) {
-    // Check if we need to downconvert find or getMore commands.
-    StringData commandName = request.cmdObj.firstElement().fieldNameStringData();
-    const auto isFindCmd = commandName == LiteParsedQuery::kFindCommandName;
-    const auto isGetMoreCmd = commandName == GetMoreRequest::kGetMoreCommandName;
-    const auto isFindOrGetMoreCmd = isFindCmd || isGetMoreCmd;
+    // NOTE: We operate based on the assumption that AsyncOp's
+    // AsyncConnection does not change over its lifetime.
+    invariant(_connection.is_initialized());
 
-    // If we aren't sending a find or getMore, or the server supports OP_COMMAND we don't have
-    // to worry about downconversion.
-    if (!isFindOrGetMoreCmd || connection().serverProtocols() == rpc::supports::kAll) {
-        auto newCommand = messageFromRequest(request, operationProtocol());
-        return beginCommand(std::move(*newCommand), AsyncCommand::CommandType::kRPC);
-    } else if (isFindCmd) {
-        auto downconvertedFind = downconvertFindCommandRequest(request);
-        if (!downconvertedFind.isOK()) {
-            return downconvertedFind.getStatus();
-        }
-        return beginCommand(std::move(downconvertedFind.getValue()),
-                            AsyncCommand::CommandType::kDownConvertedFind);
-    } else {
-        invariant(isGetMoreCmd);
-        auto downconvertedGetMore = downconvertGetMoreCommandRequest(request);
-        if (!downconvertedGetMore.isOK()) {
-            return downconvertedGetMore.getStatus();
-        }
-        return beginCommand(std::move(downconvertedGetMore.getValue()),
-                            AsyncCommand::CommandType::kDownConvertedGetMore);
-    }
+    // Construct a new AsyncCommand object for each command.
+    return AsyncCommand::make(
+        _connection.get_ptr(), operationProtocol(), request, _owner->now(), &_command);
 }
 
 NetworkInterfaceASIO::AsyncCommand* NetworkInterfaceASIO::AsyncOp::command() {
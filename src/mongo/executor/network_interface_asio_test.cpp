@@ -38,7 +38,10 @@
 #include "mongo/executor/async_mock_stream_factory.h"
 #include "mongo/executor/network_interface_asio.h"
 #include "mongo/executor/test_network_connection_hook.h"
+#include "mongo/rpc/factory.h"
 #include "mongo/rpc/legacy_reply_builder.h"
+#include "mongo/rpc/reply_builder_interface.h"
+#include "mongo/rpc/request_interface.h"
 #include "mongo/stdx/future.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
@@ -458,6 +461,190 @@ TEST_F(NetworkInterfaceASIOTest, setAlarm) {
     ASSERT(status == stdx::future_status::timeout);
 }
 
+class NetworkInterfaceASIOCircuitBreakerTest : public NetworkInterfaceASIOTest {
+public:
+    void setUp() override {
+        auto factory = stdx::make_unique<AsyncMockStreamFactory>();
+        // keep unowned pointer, but pass ownership to NIA
+        _streamFactory = factory.get();
+        NetworkInterfaceASIO::Options options;
+        options.circuitBreakerOptions.maxOutstanding = 1;
+        _net = stdx::make_unique<NetworkInterfaceASIO>(std::move(factory), std::move(options));
+        _net->startup();
+    }
+};
+
+TEST_F(NetworkInterfaceASIOCircuitBreakerTest, RejectsCommandsAboveMaxOutstanding) {
+    stdx::promise<RemoteCommandResponse> first;
+    net().startCommand({},
+                       RemoteCommandRequest(testHost, "testDB", BSON("foo" << 1), BSONObj()),
+                       [&first](StatusWith<RemoteCommandResponse> resp) {
+                           try {
+                               first.set_value(uassertStatusOK(resp));
+                           } catch (...) {
+                               first.set_exception(std::current_exception());
+                           }
+                       });
+    ASSERT_FALSE(net().isHostAccepting(testHost));
+
+    // The second command fails without waiting for the first one
+    stdx::promise<Status> second;
+    net().startCommand({},
+                       RemoteCommandRequest(testHost, "testDB", BSON("foo" << 2), BSONObj()),
+                       [&second](StatusWith<RemoteCommandResponse> resp) {
+                           second.set_value(resp.getStatus());
+                       });
+    ASSERT_EQ(ErrorCodes::HostUnreachable, second.get_future().get());
+
+    auto stream = streamFactory().blockUntilStreamExists(testHost);
+    ConnectEvent{stream}.skip();
+    stream->simulateServer(rpc::Protocol::kOpQuery,
+                           [](RemoteCommandRequest request) -> RemoteCommandResponse {
+                               RemoteCommandResponse response;
+                               response.data = BSON("minWireVersion" << mongo::minWireVersion
+                                                                     << "maxWireVersion"
+                                                                     << mongo::maxWireVersion);
+                               return response;
+                           });
+    stream->simulateServer(rpc::Protocol::kOpCommandV1,
+                           [](RemoteCommandRequest request) -> RemoteCommandResponse {
+                               RemoteCommandResponse response;
+                               response.data = BSON("ok" << 1);
+                               response.metadata = BSONObj();
+                               return response;
+                           });
+    ASSERT_EQ(BSON("ok" << 1), first.get_future().get().data);
+    ASSERT_TRUE(net().isHostAccepting(testHost));
+
+    BSONObjBuilder builder;
+    net().appendCircuitBreakerStats(&builder);
+    auto hostStats = builder.obj()[testHost.toString()].Obj();
+    ASSERT_EQ(1, hostStats["rejected"].numberLong());
+    ASSERT_EQ(0, hostStats["outstanding"].numberLong());
+}
+
+class NetworkInterfaceASIOMultiplexTest : public NetworkInterfaceASIOTest {
+public:
+    void setUp() override {
+        auto factory = stdx::make_unique<AsyncMockStreamFactory>();
+        // keep unowned pointer, but pass ownership to NIA
+        _streamFactory = factory.get();
+        NetworkInterfaceASIO::Options options;
+        options.multiplexCommands = true;
+        _net = stdx::make_unique<NetworkInterfaceASIO>(std::move(factory), std::move(options));
+        _net->startup();
+    }
+
+    void startCommand(int i, stdx::promise<RemoteCommandResponse>* prom) {
+        net().startCommand({},
+                           RemoteCommandRequest(testHost, "testDB", BSON("ping" << i), BSONObj()),
+                           [prom](StatusWith<RemoteCommandResponse> resp) {
+                               try {
+                                   prom->set_value(uassertStatusOK(resp));
+                               } catch (...) {
+                                   prom->set_exception(std::current_exception());
+                               }
+                           });
+    }
+
+    // Connects the stream and replies to its isMaster.
+    static void connect(AsyncMockStreamFactory::MockStream* stream) {
+        ConnectEvent{stream}.skip();
+
+        stream->simulateServer(rpc::Protocol::kOpQuery,
+                               [](RemoteCommandRequest request) -> RemoteCommandResponse {
+                                   RemoteCommandResponse response;
+                                   response.data =
+                                       BSON("minWireVersion" << mongo::minWireVersion
+                                                             << "maxWireVersion"
+                                                             << mongo::maxWireVersion);
+                                   return response;
+                               });
+    }
+
+    // Takes the command written to the stream, and returns the reply to send to it.
+    static std::unique_ptr<Message> popCommand(AsyncMockStreamFactory::MockStream* stream,
+                                               int expected) {
+        WriteEvent write{stream};
+
+        auto data = stream->popWrite();
+        Message msg(data.data(), false);
+
+        auto request = rpc::makeRequest(&msg);
+        ASSERT_EQ(expected, request->getCommandArgs()["ping"].numberInt());
+
+        auto replyBuilder = rpc::makeReplyBuilder(rpc::Protocol::kOpCommandV1);
+        replyBuilder->setMetadata(BSONObj());
+        replyBuilder->setCommandReply(BSON("ok" << 1 << "pong" << expected));
+
+        auto reply = replyBuilder->done();
+        reply->header().setResponseTo(msg.header().getId());
+        return reply;
+    }
+
+    static void pushReplyHeader(AsyncMockStreamFactory::MockStream* stream, const Message& reply) {
+        ReadEvent read{stream};
+        auto hdrBytes = reinterpret_cast<const uint8_t*>(reply.header().view2ptr());
+        stream->pushRead({hdrBytes, hdrBytes + sizeof(MSGHEADER::Value)});
+    }
+
+    static void pushReplyBody(AsyncMockStreamFactory::MockStream* stream, const Message& reply) {
+        ReadEvent read{stream};
+        auto dataBytes = reinterpret_cast<const uint8_t*>(reply.buf());
+        stream->pushRead({dataBytes + sizeof(MSGHEADER::Value),
+                          dataBytes + static_cast<std::size_t>(reply.size())});
+    }
+};
+
+TEST_F(NetworkInterfaceASIOMultiplexTest, CommandsArePipelined) {
+    stdx::promise<RemoteCommandResponse> promA;
+    stdx::promise<RemoteCommandResponse> promB;
+
+    // Both commands are queued while the connection is set up
+    startCommand(1, &promA);
+    startCommand(2, &promB);
+
+    auto stream = streamFactory().blockUntilStreamExists(testHost);
+    connect(stream);
+
+    // The second command is written before the reply to the first has been read
+    auto replyA = popCommand(stream, 1);
+    pushReplyHeader(stream, *replyA);
+    auto replyB = popCommand(stream, 2);
+    pushReplyBody(stream, *replyA);
+
+    ASSERT_EQ(1, promA.get_future().get().data["pong"].numberInt());
+
+    pushReplyHeader(stream, *replyB);
+    pushReplyBody(stream, *replyB);
+
+    ASSERT_EQ(2, promB.get_future().get().data["pong"].numberInt());
+}
+
+TEST_F(NetworkInterfaceASIOMultiplexTest, ConnectionIsReused) {
+    stdx::promise<RemoteCommandResponse> promA;
+    startCommand(1, &promA);
+
+    auto stream = streamFactory().blockUntilStreamExists(testHost);
+    connect(stream);
+
+    auto replyA = popCommand(stream, 1);
+    pushReplyHeader(stream, *replyA);
+    pushReplyBody(stream, *replyA);
+
+    ASSERT_EQ(1, promA.get_future().get().data["pong"].numberInt());
+
+    // The connection went back to the pool, and is used again without another isMaster
+    stdx::promise<RemoteCommandResponse> promB;
+    startCommand(2, &promB);
+
+    auto replyB = popCommand(stream, 2);
+    pushReplyHeader(stream, *replyB);
+    pushReplyBody(stream, *replyB);
+
+    ASSERT_EQ(2, promB.get_future().get().data["pong"].numberInt());
+}
+
 }  // namespace
 }  // namespace executor
 }  // namespace mongo
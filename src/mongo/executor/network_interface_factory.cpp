@@ -28,6 +28,8 @@
 
 #include "mongo/executor/network_interface_factory.h"
 
+#include <algorithm>
+
 #include "mongo/base/init.h"
 #include "mongo/base/status.h"
 #include "mongo/config.h"
@@ -60,6 +62,44 @@ MONGO_INITIALIZER(outboundNetworkImpl)(InitializerContext*) {
     return Status::OK();
 }
 
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(connectionPoolMinConnectionsPerHost, int, 1);
+MONGO_INITIALIZER(connectionPoolMinConnectionsPerHost)(InitializerContext*) {
+    if (connectionPoolMinConnectionsPerHost < 0) {
+        return Status(ErrorCodes::BadValue,
+                      "connectionPoolMinConnectionsPerHost must be greater than or equal to 0");
+    }
+    return Status::OK();
+}
+
+// Only used by the ASIO implementation
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(outboundNetworkMultiplexCommands, bool, false);
+
+// Circuit breaker settings, only used by the ASIO implementation. The breaker of a host stays
+// closed unless outboundCircuitBreakerFailureRatio is set, new commands are only rejected because
+// of the ones outstanding if outboundMaxOutstandingCommandsPerHost is set, and commands keep their
+// timeout unless outboundAdaptiveTimeoutMultiplier is set.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(outboundCircuitBreakerFailureRatio, double, 0);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(outboundCircuitBreakerMinCommands, int, 20);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(outboundCircuitBreakerOpenMillis, int, 5000);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(outboundMaxOutstandingCommandsPerHost, int, 0);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(outboundAdaptiveTimeoutMultiplier, double, 0);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(outboundAdaptiveTimeoutMinMillis, int, 1000);
+
+MONGO_INITIALIZER(outboundCircuitBreaker)(InitializerContext*) {
+    if (outboundCircuitBreakerFailureRatio < 0 || outboundCircuitBreakerFailureRatio > 1) {
+        return Status(ErrorCodes::BadValue,
+                      "outboundCircuitBreakerFailureRatio must be between 0 and 1");
+    }
+    if (outboundCircuitBreakerMinCommands < 1 || outboundCircuitBreakerOpenMillis < 0 ||
+        outboundMaxOutstandingCommandsPerHost < 0 || outboundAdaptiveTimeoutMultiplier < 0 ||
+        outboundAdaptiveTimeoutMinMillis < 0) {
+        return Status(ErrorCodes::BadValue,
+                      "outboundCircuitBreakerMinCommands must be positive, and the other circuit "
+                      "breaker and adaptive timeout settings may not be negative");
+    }
+    return Status::OK();
+}
+
 std::unique_ptr<NetworkInterface> makeNetworkInterface() {
     return makeNetworkInterface(nullptr);
 }
@@ -67,14 +107,28 @@ std::unique_ptr<NetworkInterface> makeNetworkInterface() {
 std::unique_ptr<NetworkInterface> makeNetworkInterface(
     std::unique_ptr<NetworkConnectionHook> hook) {
     if (outboundNetworkImpl == kNetworkImplASIO) {
+        NetworkInterfaceASIO::Options options;
+        options.connectionPoolOptions.minConnections =
+            static_cast<size_t>(connectionPoolMinConnectionsPerHost);
+        options.multiplexCommands = outboundNetworkMultiplexCommands;
+        auto& breakerOptions = options.circuitBreakerOptions;
+        breakerOptions.failureRatio = outboundCircuitBreakerFailureRatio;
+        breakerOptions.minRequests = static_cast<size_t>(outboundCircuitBreakerMinCommands);
+        breakerOptions.windowSize = std::max(breakerOptions.windowSize, breakerOptions.minRequests);
+        breakerOptions.openDuration = Milliseconds(outboundCircuitBreakerOpenMillis);
+        breakerOptions.maxOutstanding = static_cast<size_t>(outboundMaxOutstandingCommandsPerHost);
+        breakerOptions.timeoutMultiplier = outboundAdaptiveTimeoutMultiplier;
+        breakerOptions.minTimeout = Milliseconds(outboundAdaptiveTimeoutMinMillis);
 #ifdef MONGO_CONFIG_SSL
         if (SSLManagerInterface* manager = getSSLManager()) {
             auto factory = stdx::make_unique<AsyncSecureStreamFactory>(manager);
-            return stdx::make_unique<NetworkInterfaceASIO>(std::move(factory), std::move(hook));
+            return stdx::make_unique<NetworkInterfaceASIO>(
+                std::move(factory), std::move(hook), std::move(options));
         }
 #endif
         auto factory = stdx::make_unique<AsyncStreamFactory>();
-        return stdx::make_unique<NetworkInterfaceASIO>(std::move(factory), std::move(hook));
+        return stdx::make_unique<NetworkInterfaceASIO>(
+            std::move(factory), std::move(hook), std::move(options));
 
     } else {
         return stdx::make_unique<NetworkInterfaceImpl>(std::move(hook));
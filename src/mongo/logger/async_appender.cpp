@@ -0,0 +1,180 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/logger/async_appender.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "mongo/stdx/functional.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace logger {
+
+namespace {
+
+// How long a fatal error path waits for each writer thread to write what it has buffered.
+const Milliseconds kFatalFlushTimeout(5000);
+
+// Live AsyncAppenders, for flushAllAndWriteSynchronously().
+stdx::mutex registryMutex;
+std::vector<AsyncAppender*> registry;
+
+}  // namespace
+
+AsyncAppender::BufferedEvent::BufferedEvent(const MessageEventEphemeral& event)
+    : date(event.getDate()),
+      severity(event.getSeverity()),
+      component(event.getComponent()),
+      contextName(event.getContextName().toString()),
+      message(event.getMessage().toString()) {}
+
+AsyncAppender::AsyncAppender(std::unique_ptr<EventAppender> target, size_t maxBufferedBytes)
+    : _target(std::move(target)), _maxBufferedBytes(maxBufferedBytes) {
+    _writerThread = stdx::thread(stdx::bind(&AsyncAppender::_writerThreadBody, this));
+    stdx::lock_guard<stdx::mutex> lk(registryMutex);
+    registry.push_back(this);
+}
+
+AsyncAppender::~AsyncAppender() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(registryMutex);
+        registry.erase(std::remove(registry.begin(), registry.end(), this), registry.end());
+    }
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _shutdown = true;
+        _eventsAvailable.notify_one();
+    }
+    _writerThread.join();
+}
+
+Status AsyncAppender::append(const MessageEventEphemeral& event) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    if (_synchronous) {
+        // Holding _mutex keeps the events of concurrent callers from interleaving with anything
+        // the writer thread has left to write.
+        _waitUntilDrained_inlock(&lk, Date_t::now() + kFatalFlushTimeout);
+        return _target->append(event);
+    }
+
+    const size_t size = event.getContextName().size() + event.getMessage().size();
+    if (_bufferedBytes + size > _maxBufferedBytes) {
+        ++_numDropped;
+        ++_numDroppedUnreported;
+        return Status::OK();
+    }
+    _buffer.emplace_back(event);
+    _bufferedBytes += size;
+    if (_buffer.size() == 1) {
+        // The writer thread only waits when the buffer is empty.
+        _eventsAvailable.notify_one();
+    }
+    return Status::OK();
+}
+
+void AsyncAppender::flush(Milliseconds timeout) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _waitUntilDrained_inlock(&lk, Date_t::now() + timeout);
+}
+
+unsigned long long AsyncAppender::getNumDropped() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _numDropped;
+}
+
+void AsyncAppender::flushAllAndWriteSynchronously() {
+    stdx::lock_guard<stdx::mutex> registryLock(registryMutex);
+    for (auto appender : registry) {
+        stdx::unique_lock<stdx::mutex> lk(appender->_mutex);
+        appender->_synchronous = true;
+        appender->_waitUntilDrained_inlock(&lk, Date_t::now() + kFatalFlushTimeout);
+    }
+}
+
+void AsyncAppender::_waitUntilDrained_inlock(stdx::unique_lock<stdx::mutex>* lk,
+                                             Date_t deadline) {
+    if (stdx::this_thread::get_id() == _writerThread.get_id()) {
+        // The writer thread would wait for itself.
+        return;
+    }
+    while (!_buffer.empty() || _numDroppedUnreported > 0 || _writing) {
+        if (Date_t::now() >= deadline) {
+            return;
+        }
+        _drained.wait_until(*lk, deadline.toSystemTimePoint());
+    }
+}
+
+void AsyncAppender::_writerThreadBody() {
+    setThreadName("asyncLogWriter");
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    while (true) {
+        while (_buffer.empty() && _numDroppedUnreported == 0 && !_shutdown) {
+            _eventsAvailable.wait(lk);
+        }
+        if (_buffer.empty() && _numDroppedUnreported == 0) {
+            return;
+        }
+
+        std::deque<BufferedEvent> batch;
+        batch.swap(_buffer);
+        _bufferedBytes = 0;
+        const unsigned long long numDropped = _numDroppedUnreported;
+        _numDroppedUnreported = 0;
+        _writing = true;
+        lk.unlock();
+
+        // The target reports its own I/O errors, if it can; there is no caller to return them to.
+        for (const auto& event : batch) {
+            _target->append(event.toEvent());
+        }
+        if (numDropped > 0) {
+            _reportDropped(numDropped);
+        }
+        batch.clear();
+
+        lk.lock();
+        _writing = false;
+        _drained.notify_all();
+    }
+}
+
+void AsyncAppender::_reportDropped(unsigned long long numDropped) {
+    const std::string message = str::stream() << "Dropped " << numDropped
+                                              << " log message(s) because the buffer of "
+                                              << _maxBufferedBytes << " bytes was full";
+    _target->append(MessageEventEphemeral(
+        Date_t::now(), LogSeverity::Warning(), getThreadName(), message));
+}
+
+}  // namespace logger
+}  // namespace mongo
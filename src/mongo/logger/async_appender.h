@@ -0,0 +1,159 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/logger/appender.h"
+#include "mongo/logger/message_event.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace logger {
+
+/**
+ * Appender that hands events to a background thread, which appends them to another appender.
+ *
+ * append() copies the event into a bounded in-memory buffer and returns without waiting for the
+ * target appender, so threads that log don't stall on file or syslog I/O. Events that don't fit
+ * in the buffer are dropped and counted, and the writer thread logs how many it dropped once it
+ * catches up. The order of the events is preserved.
+ *
+ * Fatal error paths call flushAllAndWriteSynchronously(), after which every AsyncAppender writes
+ * the events still buffered and then appends new events directly on the calling thread, so the
+ * last messages of a dying process are never lost.
+ */
+class AsyncAppender : public Appender<MessageEventEphemeral> {
+    MONGO_DISALLOW_COPYING(AsyncAppender);
+
+public:
+    typedef Appender<MessageEventEphemeral> EventAppender;
+
+    /**
+     * Constructs an appender that owns "target", and buffers up to "maxBufferedBytes" bytes of
+     * log messages for it. Starts the writer thread.
+     */
+    AsyncAppender(std::unique_ptr<EventAppender> target, size_t maxBufferedBytes);
+
+    /**
+     * Writes the buffered events and stops the writer thread.
+     */
+    ~AsyncAppender() override;
+
+    Status append(const MessageEventEphemeral& event) override;
+
+    /**
+     * Blocks until every event appended before the call has been written to the target, or
+     * until "timeout" expires.
+     */
+    void flush(Milliseconds timeout);
+
+    /**
+     * Returns the number of events dropped because the buffer was full.
+     */
+    unsigned long long getNumDropped();
+
+    /**
+     * Flushes every live AsyncAppender, and makes them append later events synchronously.
+     *
+     * Intended for fatal error handlers and process exit; waits a bounded amount of time for each
+     * writer thread, and does not wait for the writer thread that calls it.
+     */
+    static void flushAllAndWriteSynchronously();
+
+private:
+    /**
+     * Copy of a MessageEventEphemeral that owns its strings.
+     */
+    struct BufferedEvent {
+        explicit BufferedEvent(const MessageEventEphemeral& event);
+
+        MessageEventEphemeral toEvent() const {
+            return MessageEventEphemeral(date, severity, component, contextName, message);
+        }
+
+        Date_t date;
+        LogSeverity severity;
+        LogComponent component;
+        std::string contextName;
+        std::string message;
+    };
+
+    void _writerThreadBody();
+
+    /**
+     * Waits until the buffer is empty and the writer thread is not writing, or "deadline" passes.
+     * "lk" must own _mutex.
+     */
+    void _waitUntilDrained_inlock(stdx::unique_lock<stdx::mutex>* lk, Date_t deadline);
+
+    /**
+     * Appends an event reporting "numDropped" dropped events to the target.
+     */
+    void _reportDropped(unsigned long long numDropped);
+
+    const std::unique_ptr<EventAppender> _target;
+    const size_t _maxBufferedBytes;
+
+    // Guards all members below.
+    stdx::mutex _mutex;
+
+    // Signaled when events are buffered, when writing synchronously starts, and at shutdown.
+    stdx::condition_variable _eventsAvailable;
+
+    // Signaled when the writer thread has written everything it took from _buffer.
+    stdx::condition_variable _drained;
+
+    std::deque<BufferedEvent> _buffer;
+    size_t _bufferedBytes = 0;
+
+    // True while the writer thread appends events it took from _buffer, without _mutex.
+    bool _writing = false;
+
+    // Once set, append() writes to the target on the calling thread.
+    bool _synchronous = false;
+
+    bool _shutdown = false;
+
+    unsigned long long _numDropped = 0;
+
+    // Events dropped since the writer thread last reported them.
+    unsigned long long _numDroppedUnreported = 0;
+
+    stdx::thread _writerThread;
+};
+
+}  // namespace logger
+}  // namespace mongo
@@ -0,0 +1,158 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/logger/async_appender.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+using namespace mongo;
+using namespace mongo::logger;
+
+/**
+ * Appender that records the messages of the events it receives, and can be made to block until
+ * released.
+ */
+class RecordingAppender : public Appender<MessageEventEphemeral> {
+public:
+    struct State {
+        stdx::mutex mutex;
+        stdx::condition_variable cv;
+        std::vector<std::string> messages;
+        bool blocked = false;
+        bool waiting = false;
+    };
+
+    explicit RecordingAppender(State* state) : _state(state) {}
+
+    Status append(const MessageEventEphemeral& event) override {
+        stdx::unique_lock<stdx::mutex> lk(_state->mutex);
+        while (_state->blocked) {
+            _state->waiting = true;
+            _state->cv.notify_all();
+            _state->cv.wait(lk);
+        }
+        _state->waiting = false;
+        _state->messages.push_back(event.getMessage().toString());
+        return Status::OK();
+    }
+
+private:
+    State* const _state;
+};
+
+MessageEventEphemeral makeEvent(StringData message) {
+    return MessageEventEphemeral(Date_t::now(), LogSeverity::Log(), "test", message);
+}
+
+std::vector<std::string> getMessages(RecordingAppender::State* state) {
+    stdx::lock_guard<stdx::mutex> lk(state->mutex);
+    return state->messages;
+}
+
+TEST(AsyncAppenderTest, WritesEventsInOrder) {
+    RecordingAppender::State state;
+    AsyncAppender appender(stdx::make_unique<RecordingAppender>(&state), 1024 * 1024);
+    std::vector<std::string> expected;
+    for (int i = 0; i < 1000; ++i) {
+        expected.push_back(std::to_string(i));
+        ASSERT_OK(appender.append(makeEvent(expected.back())));
+    }
+    appender.flush(Milliseconds(10000));
+    ASSERT(expected == getMessages(&state));
+    ASSERT_EQ(0U, appender.getNumDropped());
+}
+
+TEST(AsyncAppenderTest, DestructorWritesBufferedEvents) {
+    RecordingAppender::State state;
+    {
+        AsyncAppender appender(stdx::make_unique<RecordingAppender>(&state), 1024 * 1024);
+        for (int i = 0; i < 100; ++i) {
+            ASSERT_OK(appender.append(makeEvent("message")));
+        }
+    }
+    ASSERT_EQ(100U, getMessages(&state).size());
+}
+
+TEST(AsyncAppenderTest, DropsEventsWhenBufferIsFullAndReportsThem) {
+    RecordingAppender::State state;
+    state.blocked = true;
+    // Room for 2 events with the context "test" and a 6 byte message.
+    AsyncAppender appender(stdx::make_unique<RecordingAppender>(&state), 20);
+
+    // The writer thread takes the first event and blocks in the target.
+    ASSERT_OK(appender.append(makeEvent("first.")));
+    {
+        stdx::unique_lock<stdx::mutex> lk(state.mutex);
+        while (!state.waiting) {
+            state.cv.wait(lk);
+        }
+    }
+    ASSERT_OK(appender.append(makeEvent("second")));
+    ASSERT_OK(appender.append(makeEvent("third.")));
+    ASSERT_OK(appender.append(makeEvent("fourth")));
+    ASSERT_EQ(1U, appender.getNumDropped());
+
+    {
+        stdx::lock_guard<stdx::mutex> lk(state.mutex);
+        state.blocked = false;
+        state.cv.notify_all();
+    }
+    appender.flush(Milliseconds(10000));
+    const auto messages = getMessages(&state);
+    ASSERT_EQ(4U, messages.size());
+    ASSERT_EQ("first.", messages[0]);
+    ASSERT_EQ("second", messages[1]);
+    ASSERT_EQ("third.", messages[2]);
+    ASSERT_NOT_EQUALS(std::string::npos, messages[3].find("Dropped 1 log message(s)"));
+    ASSERT_EQ(1U, appender.getNumDropped());
+}
+
+TEST(AsyncAppenderTest, WritesSynchronouslyAfterFatalFlush) {
+    RecordingAppender::State state;
+    AsyncAppender appender(stdx::make_unique<RecordingAppender>(&state), 1024 * 1024);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_OK(appender.append(makeEvent("buffered")));
+    }
+    AsyncAppender::flushAllAndWriteSynchronously();
+    ASSERT_EQ(100U, getMessages(&state).size());
+
+    // From now on, append() returns only after the target has the event.
+    ASSERT_OK(appender.append(makeEvent("last words")));
+    const auto messages = getMessages(&state);
+    ASSERT_EQ(101U, messages.size());
+    ASSERT_EQ("last words", messages.back());
+}
+
+}  // namespace
@@ -75,6 +75,21 @@ StatusWith<CommandAndMetadata> upconvertRequestMetadata(BSONObj legacyCmdObj, in
     // support.
     BSONObjBuilder metadataBob;
 
+#if !defined(MONGO_ENTERPRISE_VERSION)
+    // AuditMetadata does not rewrite commands here, so if ServerSelectionMetadata leaves the
+    // command untouched as well, return it as is rather than copying it out of the request
+    // message twice. Only the metadata derived from the query flags needs to be built.
+    if (ServerSelectionMetadata::upconvertPreservesCommand(legacyCmdObj)) {
+        BSONObjBuilder unusedCommandBob;
+        auto upconvertStatus = ServerSelectionMetadata::upconvert(
+            BSONObj(), queryFlags, &unusedCommandBob, &metadataBob);
+        if (!upconvertStatus.isOK()) {
+            return upconvertStatus;
+        }
+        return std::make_tuple(std::move(legacyCmdObj), metadataBob.obj());
+    }
+#endif
+
     // Ordering is important here - ServerSelectionMetadata must be upconverted
     // first, then AuditMetadata.
     BSONObjBuilder ssmCommandBob;
@@ -256,6 +256,13 @@ Status ServerSelectionMetadata::upconvert(const BSONObj& legacyCommand,
     return extractUnwrappedReadPreference(maybeUnwrapped, commandBob, metadataBob);
 }
 
+bool ServerSelectionMetadata::upconvertPreservesCommand(const BSONObj& legacyCommand) {
+    const auto firstElFieldName = legacyCommand.firstElementFieldName();
+    return (firstElFieldName != StringData(kDollarQueryWrapper)) &&
+        (firstElFieldName != StringData(kQueryWrapper)) &&
+        !legacyCommand.hasField(kQueryOptionsFieldName);
+}
+
 bool ServerSelectionMetadata::isSecondaryOk() const {
     return _secondaryOk;
 }
@@ -95,6 +95,13 @@ public:
                             const int legacyQueryFlags,
                             BSONObjBuilder* commandBob,
                             BSONObjBuilder* metadataBob);
+
+    /**
+     * Returns true if upconvert() would write 'legacyCommand' to its command builder unchanged,
+     * that is if the command is neither wrapped nor carries $queryOptions.
+     */
+    static bool upconvertPreservesCommand(const BSONObj& legacyCommand);
+
     /**
      * Returns true if this operation has been explicitly overridden to run on a secondary.
      * This replaces previous usage of QueryOption_SlaveOk.
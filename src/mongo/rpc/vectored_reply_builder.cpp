@@ -0,0 +1,101 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/rpc/vectored_reply_builder.h"
+
+#include "mongo/db/dbmessage.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace rpc {
+
+namespace {
+// Initial size of the buffers holding copied documents.
+const int kCopiedBufferInitialSize = 32 * 1024;
+}  // namespace
+
+VectoredReplyBuilder::VectoredReplyBuilder()
+    : _copied(stdx::make_unique<BufBuilder>(kCopiedBufferInitialSize)) {
+    _copied->skip(sizeof(QueryResult::Value));
+    _len = _copied->len();
+}
+
+void VectoredReplyBuilder::addDocument(const BSONObj& obj) {
+    invariant(_copied);
+
+    const int objSize = obj.objsize();
+    _len += objSize;
+
+    if (!obj.isOwned() || objSize < kMinReferencedObjSize) {
+        _copied->appendBuf(obj.objdata(), objSize);
+        return;
+    }
+
+    _flushCopied();
+    _message.appendReferencedData(obj.objdata(), objSize, obj.sharedBuffer());
+}
+
+int VectoredReplyBuilder::len() const {
+    return _len;
+}
+
+void VectoredReplyBuilder::done(
+    int resultFlags, long long cursorId, int startingFrom, int nReturned, Message* result) {
+    invariant(_copied);
+
+    _flushCopied();
+    _copied.reset();
+
+    invariant(_message.size() == _len);
+
+    QueryResult::View qr = _message.header().view2ptr();
+    qr.msgdata().setOperation(opReply);
+    qr.setResultFlags(resultFlags);
+    qr.setCursorId(cursorId);
+    qr.setStartingFrom(startingFrom);
+    qr.setNReturned(nReturned);
+
+    *result = std::move(_message);
+}
+
+void VectoredReplyBuilder::_flushCopied() {
+    if (_copied->len() == 0) {
+        return;
+    }
+
+    _message.appendData(_copied->buf(), _copied->len());
+    _copied->decouple();
+    _copied = stdx::make_unique<BufBuilder>(kCopiedBufferInitialSize);
+}
+
+}  // namespace rpc
+}  // namespace mongo
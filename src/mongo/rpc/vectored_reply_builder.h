@@ -0,0 +1,94 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/util/builder.h"
+#include "mongo/util/net/message.h"
+
+namespace mongo {
+
+class BSONObj;
+
+namespace rpc {
+
+/**
+ * Builds an OP_REPLY carrying a batch of documents for a legacy find or getMore, without
+ * copying large documents into the reply.
+ *
+ * Owned documents of at least kMinReferencedObjSize bytes are referenced by the reply message
+ * rather than copied into it, and are written to the socket directly from the buffers that
+ * already hold them using scatter/gather I/O. The reply keeps those buffers alive until it has
+ * been sent. Smaller or unowned documents are copied, and consecutive copied documents share a
+ * buffer, which keeps the number of I/O vectors per reply low.
+ */
+class VectoredReplyBuilder {
+    MONGO_DISALLOW_COPYING(VectoredReplyBuilder);
+
+public:
+    static const int kMinReferencedObjSize = 4096;
+
+    VectoredReplyBuilder();
+
+    /**
+     * Adds 'obj' to the batch.
+     */
+    void addDocument(const BSONObj& obj);
+
+    /**
+     * Returns the size of the reply built so far in bytes, including the reply header.
+     */
+    int len() const;
+
+    /**
+     * Fills in the reply header and moves the reply into 'result', which must be empty. No
+     * other methods may be called afterwards.
+     */
+    void done(int resultFlags, long long cursorId, int startingFrom, int nReturned, Message* result);
+
+private:
+    /**
+     * Moves the documents copied since the last flush into the reply.
+     */
+    void _flushCopied();
+
+    Message _message;
+
+    // Holds copied documents until they are flushed into _message. The first buffer also holds
+    // the reply header.
+    std::unique_ptr<BufBuilder> _copied;
+
+    // Size of the reply so far, including the documents not flushed yet.
+    int _len = 0;
+};
+
+}  // namespace rpc
+}  // namespace mongo
@@ -0,0 +1,149 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+
+#include "mongo/db/dbmessage.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/rpc/vectored_reply_builder.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+
+BSONObj makeDocument(int i, size_t padding) {
+    return BSON("_id" << i << "padding" << std::string(padding, 'x'));
+}
+
+/**
+ * Checks that 'reply' is a valid OP_REPLY holding exactly 'expected', in order.
+ */
+void assertReplyContains(Message& reply, const std::vector<BSONObj>& expected) {
+    reply.concat();
+    QueryResult::View qr = reply.singleData().view2ptr();
+    ASSERT_EQUALS(opReply, qr.msgdata().getOperation());
+    ASSERT_EQUALS(static_cast<int>(expected.size()), qr.getNReturned());
+
+    const char* data = qr.data();
+    const char* end = qr.view2ptr() + qr.msgdata().getLen();
+    for (const auto& obj : expected) {
+        ASSERT_LESS_THAN(data, end);
+        BSONObj actual(data);
+        ASSERT_EQUALS(obj, actual);
+        data += actual.objsize();
+    }
+    ASSERT_EQUALS(end, data);
+}
+
+TEST(VectoredReplyBuilder, EmptyBatch) {
+    rpc::VectoredReplyBuilder builder;
+    ASSERT_EQUALS(static_cast<int>(sizeof(QueryResult::Value)), builder.len());
+
+    Message reply;
+    builder.done(ResultFlag_AwaitCapable, 0, 0, 0, &reply);
+
+    QueryResult::View qr = reply.singleData().view2ptr();
+    ASSERT_EQUALS(static_cast<int>(sizeof(QueryResult::Value)), qr.msgdata().getLen());
+    ASSERT_EQUALS(ResultFlag_AwaitCapable, qr.getResultFlags());
+    assertReplyContains(reply, {});
+}
+
+TEST(VectoredReplyBuilder, SmallDocumentsAreCopiedIntoOneBuffer) {
+    std::vector<BSONObj> docs;
+    rpc::VectoredReplyBuilder builder;
+    for (int i = 0; i < 10; ++i) {
+        docs.push_back(makeDocument(i, 10));
+        builder.addDocument(docs.back());
+    }
+
+    Message reply;
+    builder.done(0, 42, 7, docs.size(), &reply);
+
+    // Everything fits in the buffer holding the header.
+    ASSERT(reply.buf());
+    QueryResult::View qr = reply.singleData().view2ptr();
+    ASSERT_EQUALS(42LL, qr.getCursorId());
+    ASSERT_EQUALS(7, qr.getStartingFrom());
+    assertReplyContains(reply, docs);
+}
+
+TEST(VectoredReplyBuilder, LargeOwnedDocumentsAreReferenced) {
+    std::vector<BSONObj> docs;
+    docs.push_back(makeDocument(0, 10));
+    docs.push_back(makeDocument(1, rpc::VectoredReplyBuilder::kMinReferencedObjSize));
+    docs.push_back(makeDocument(2, 10));
+
+    rpc::VectoredReplyBuilder builder;
+    int expectedLen = builder.len();
+    for (const auto& doc : docs) {
+        builder.addDocument(doc);
+        expectedLen += doc.objsize();
+    }
+    ASSERT_EQUALS(expectedLen, builder.len());
+
+    Message reply;
+    builder.done(0, 0, 0, docs.size(), &reply);
+
+    // The large document is sent from its own buffer.
+    ASSERT_FALSE(reply.buf());
+    ASSERT_EQUALS(expectedLen, reply.size());
+    ASSERT_EQUALS(expectedLen, reply.header().getLen());
+    assertReplyContains(reply, docs);
+}
+
+TEST(VectoredReplyBuilder, ReferencedDocumentOutlivesOriginal) {
+    BSONObj expected = makeDocument(0, rpc::VectoredReplyBuilder::kMinReferencedObjSize);
+    Message reply;
+    {
+        rpc::VectoredReplyBuilder builder;
+        BSONObj doc = expected.copy();
+        builder.addDocument(doc);
+        builder.done(0, 0, 0, 1, &reply);
+    }
+    assertReplyContains(reply, {expected});
+}
+
+TEST(VectoredReplyBuilder, LargeUnownedDocumentsAreCopied) {
+    BSONObj owned = makeDocument(0, rpc::VectoredReplyBuilder::kMinReferencedObjSize);
+    BSONObj unowned(owned.objdata());
+    ASSERT_FALSE(unowned.isOwned());
+
+    rpc::VectoredReplyBuilder builder;
+    builder.addDocument(unowned);
+
+    Message reply;
+    builder.done(0, 0, 0, 1, &reply);
+
+    ASSERT(reply.buf());
+    assertReplyContains(reply, {owned});
+}
+
+}  // namespace
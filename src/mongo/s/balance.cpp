@@ -40,6 +40,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/db/write_concern_options.h"
 #include "mongo/s/balancer_policy.h"
@@ -56,6 +57,7 @@
 #include "mongo/s/grid.h"
 #include "mongo/s/client/shard.h"
 #include "mongo/s/client/shard_registry.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -73,19 +75,123 @@ using std::vector;
 
 MONGO_FP_DECLARE(skipBalanceRound);
 
+// Number of migrations the balancer runs at the same time. A shard never takes part in more than
+// one of them.
+MONGO_EXPORT_SERVER_PARAMETER(balancerMaxConcurrentMigrations, int, 1);
+
 Balancer balancer;
 
 Balancer::Balancer() : _balancedLastTime(0), _policy(new BalancerPolicy()) {}
 
 Balancer::~Balancer() = default;
 
+void Balancer::planBalanceRound(OperationContext* txn,
+                                vector<shared_ptr<MigrateInfo>>* candidateChunks) {
+    _doBalanceRound(txn, nullptr, candidateChunks);
+}
+
+bool Balancer::_moveChunk(OperationContext* txn,
+                          const MigrateInfo& migrateInfo,
+                          const WriteConcernOptions* writeConcern,
+                          bool waitForDelete) {
+    // Changes to metadata, borked metadata, and connectivity problems between shards
+    // should cause us to abort this chunk move, but shouldn't cause us to abort the entire
+    // round of chunks.
+    //
+    // TODO(spencer): We probably *should* abort the whole round on issues communicating
+    // with the config servers, but its impossible to distinguish those types of failures
+    // at the moment.
+    //
+    // TODO: Handle all these things more cleanly, since they're expected problems
+
+    const NamespaceString nss(migrateInfo.ns);
+
+    try {
+        auto status = grid.catalogCache()->getDatabase(txn, nss.db().toString());
+        fassert(28628, status.getStatus());
+
+        shared_ptr<DBConfig> cfg = status.getValue();
+
+        // NOTE: We purposely do not reload metadata here, since _doBalanceRound already
+        // tried to do so once.
+        shared_ptr<ChunkManager> cm = cfg->getChunkManager(txn, migrateInfo.ns);
+        invariant(cm);
+
+        ChunkPtr c = cm->findIntersectingChunk(txn, migrateInfo.chunk.min);
+
+        if (c->getMin().woCompare(migrateInfo.chunk.min) ||
+            c->getMax().woCompare(migrateInfo.chunk.max)) {
+            // Likely a split happened somewhere, so force reload the chunk manager
+            cm = cfg->getChunkManager(txn, migrateInfo.ns, true);
+            invariant(cm);
+
+            c = cm->findIntersectingChunk(txn, migrateInfo.chunk.min);
+
+            if (c->getMin().woCompare(migrateInfo.chunk.min) ||
+                c->getMax().woCompare(migrateInfo.chunk.max)) {
+                log() << "chunk mismatch after reload, ignoring will retry issue "
+                      << migrateInfo.chunk.toString();
+
+                return false;
+            }
+        }
+
+        BSONObj res;
+        if (c->moveAndCommit(txn,
+                             migrateInfo.to,
+                             Chunk::MaxChunkSize,
+                             writeConcern,
+                             waitForDelete,
+                             0, /* maxTimeMS */
+                             res)) {
+            return true;
+        }
+
+        // The move requires acquiring the collection metadata's lock, which can fail.
+        log() << "balancer move failed: " << res << " from: " << migrateInfo.from
+              << " to: " << migrateInfo.to << " chunk: " << migrateInfo.chunk;
+
+        if (res["chunkTooBig"].trueValue()) {
+            // Reload just to be safe
+            cm = cfg->getChunkManager(txn, migrateInfo.ns);
+            invariant(cm);
+
+            c = cm->findIntersectingChunk(txn, migrateInfo.chunk.min);
+
+            log() << "performing a split because migrate failed for size reasons";
+
+            Status status = c->split(txn, Chunk::normal, NULL, NULL);
+            log() << "split results: " << status;
+
+            if (!status.isOK()) {
+                log() << "marking chunk as jumbo: " << c->toString();
+
+                c->markAsJumbo(txn);
+
+                // We count it as moved so we do another round right away
+                return true;
+            }
+        }
+    } catch (const DBException& ex) {
+        warning() << "could not move chunk " << migrateInfo.chunk.toString()
+                  << ", continuing balancing round" << causedBy(ex);
+    }
+
+    return false;
+}
+
 int Balancer::_moveChunks(OperationContext* txn,
                           const vector<shared_ptr<MigrateInfo>>& candidateChunks,
                           const WriteConcernOptions* writeConcern,
-                          bool waitForDelete) {
+                          bool waitForDelete,
+                          int* numWaves) {
+    const size_t maxConcurrentMigrations = std::max(1, balancerMaxConcurrentMigrations);
+
     int movedCount = 0;
+    *numWaves = 0;
 
-    for (const auto& migrateInfo : candidateChunks) {
+    vector<shared_ptr<MigrateInfo>> pending(candidateChunks);
+    while (!pending.empty()) {
         // If the balancer was disabled since we started this round, don't start new chunks
         // moves.
         const auto balSettingsResult =
@@ -108,89 +214,51 @@ int Balancer::_moveChunks(OperationContext* txn,
             return movedCount;
         }
 
-        // Changes to metadata, borked metadata, and connectivity problems between shards
-        // should cause us to abort this chunk move, but shouldn't cause us to abort the entire
-        // round of chunks.
-        //
-        // TODO(spencer): We probably *should* abort the whole round on issues communicating
-        // with the config servers, but its impossible to distinguish those types of failures
-        // at the moment.
-        //
-        // TODO: Handle all these things more cleanly, since they're expected problems
-
-        const NamespaceString nss(migrateInfo->ns);
-
-        try {
-            auto status = grid.catalogCache()->getDatabase(txn, nss.db().toString());
-            fassert(28628, status.getStatus());
-
-            shared_ptr<DBConfig> cfg = status.getValue();
-
-            // NOTE: We purposely do not reload metadata here, since _doBalanceRound already
-            // tried to do so once.
-            shared_ptr<ChunkManager> cm = cfg->getChunkManager(txn, migrateInfo->ns);
-            invariant(cm);
-
-            ChunkPtr c = cm->findIntersectingChunk(txn, migrateInfo->chunk.min);
-
-            if (c->getMin().woCompare(migrateInfo->chunk.min) ||
-                c->getMax().woCompare(migrateInfo->chunk.max)) {
-                // Likely a split happened somewhere, so force reload the chunk manager
-                cm = cfg->getChunkManager(txn, migrateInfo->ns, true);
-                invariant(cm);
-
-                c = cm->findIntersectingChunk(txn, migrateInfo->chunk.min);
-
-                if (c->getMin().woCompare(migrateInfo->chunk.min) ||
-                    c->getMax().woCompare(migrateInfo->chunk.max)) {
-                    log() << "chunk mismatch after reload, ignoring will retry issue "
-                          << migrateInfo->chunk.toString();
-
-                    continue;
-                }
+        // A shard takes part in one migration at a time, so only migrations between distinct
+        // shards run together. The others wait for a later wave.
+        vector<shared_ptr<MigrateInfo>> wave;
+        vector<shared_ptr<MigrateInfo>> deferred;
+        set<ShardId> busyShards;
+        for (const auto& migrateInfo : pending) {
+            if (wave.size() < maxConcurrentMigrations && !busyShards.count(migrateInfo->from) &&
+                !busyShards.count(migrateInfo->to)) {
+                busyShards.insert(migrateInfo->from);
+                busyShards.insert(migrateInfo->to);
+                wave.push_back(migrateInfo);
+            } else {
+                deferred.push_back(migrateInfo);
             }
+        }
+        pending.swap(deferred);
+        ++*numWaves;
 
-            BSONObj res;
-            if (c->moveAndCommit(txn,
-                                 migrateInfo->to,
-                                 Chunk::MaxChunkSize,
-                                 writeConcern,
-                                 waitForDelete,
-                                 0, /* maxTimeMS */
-                                 res)) {
+        if (wave.size() == 1) {
+            if (_moveChunk(txn, *wave.front(), writeConcern, waitForDelete)) {
                 movedCount++;
-                continue;
             }
+            continue;
+        }
 
-            // The move requires acquiring the collection metadata's lock, which can fail.
-            log() << "balancer move failed: " << res << " from: " << migrateInfo->from
-                  << " to: " << migrateInfo->to << " chunk: " << migrateInfo->chunk;
-
-            if (res["chunkTooBig"].trueValue()) {
-                // Reload just to be safe
-                cm = cfg->getChunkManager(txn, migrateInfo->ns);
-                invariant(cm);
-
-                c = cm->findIntersectingChunk(txn, migrateInfo->chunk.min);
-
-                log() << "performing a split because migrate failed for size reasons";
-
-                Status status = c->split(txn, Chunk::normal, NULL, NULL);
-                log() << "split results: " << status;
-
-                if (!status.isOK()) {
-                    log() << "marking chunk as jumbo: " << c->toString();
-
-                    c->markAsJumbo(txn);
-
-                    // We increment moveCount so we do another round right away
-                    movedCount++;
+        vector<int> moved(wave.size(), 0);
+        vector<stdx::thread> movers;
+        for (size_t i = 0; i < wave.size(); i++) {
+            movers.emplace_back([this, &wave, &moved, i, writeConcern, waitForDelete] {
+                Client::initThread("BalancerMigration");
+                try {
+                    auto moverTxn = cc().makeOperationContext();
+                    moved[i] = _moveChunk(moverTxn.get(), *wave[i], writeConcern, waitForDelete);
+                } catch (const std::exception& ex) {
+                    warning() << "could not move chunk " << wave[i]->chunk.toString()
+                              << ", continuing balancing round" << causedBy(ex);
                 }
-            }
-        } catch (const DBException& ex) {
-            warning() << "could not move chunk " << migrateInfo->chunk.toString()
-                      << ", continuing balancing round" << causedBy(ex);
+            });
+        }
+
+        for (auto& mover : movers) {
+            mover.join();
         }
+
+        movedCount += std::count(moved.begin(), moved.end(), 1);
     }
 
     return movedCount;
@@ -322,9 +390,15 @@ void Balancer::_doBalanceRound(OperationContext* txn,
 
     OCCASIONALLY warnOnMultiVersion(shardInfo);
 
+    // A planned round runs outside of the balancer thread, so it cannot tell how many chunks the
+    // last round moved and plans as if it moved none.
+    const int balancedLastTime = distLock ? _balancedLastTime : 0;
+
     // For each collection, check if the balancing policy recommends moving anything around.
     for (const auto& coll : collections) {
-        uassertStatusOK(distLock->checkForPendingCatalogSwap());
+        if (distLock) {
+            uassertStatusOK(distLock->checkForPendingCatalogSwap());
+        }
 
         // Skip collections for which balancing is disabled
         const NamespaceString& nss = coll.getNs();
@@ -416,6 +490,12 @@ void Balancer::_doBalanceRound(OperationContext* txn,
 
             didAnySplits = true;
 
+            if (!distLock) {
+                LOG(1) << "nss: " << nss.ns() << " would need to split on " << min
+                       << " because there is a range there";
+                break;
+            }
+
             log() << "nss: " << nss.ns() << " need to split on " << min
                   << " because there is a range there";
 
@@ -440,8 +520,37 @@ void Balancer::_doBalanceRound(OperationContext* txn,
         }
 
         shared_ptr<MigrateInfo> migrateInfo(
-            _policy->balance(nss.ns(), distStatus, _balancedLastTime));
-        if (migrateInfo) {
+            _policy->balance(nss.ns(), distStatus, balancedLastTime));
+        if (!migrateInfo) {
+            continue;
+        }
+
+        candidateChunks->push_back(migrateInfo);
+
+        // When migrations may run concurrently, plan more moves for this collection among the
+        // shards which are not part of one of its moves yet.
+        ShardInfoMap freeShardInfo(shardInfo);
+        ShardToChunksMap freeShardToChunksMap(shardToChunksMap);
+        for (int i = 1; i < balancerMaxConcurrentMigrations; i++) {
+            freeShardInfo.erase(migrateInfo->from);
+            freeShardInfo.erase(migrateInfo->to);
+            freeShardToChunksMap.erase(migrateInfo->from);
+            freeShardToChunksMap.erase(migrateInfo->to);
+            if (freeShardInfo.size() < 2) {
+                break;
+            }
+
+            DistributionStatus freeDistStatus(freeShardInfo, freeShardToChunksMap);
+            for (const TagRange& range : ranges) {
+                // Already validated against the full distribution above
+                freeDistStatus.addTagRange(range);
+            }
+
+            migrateInfo.reset(_policy->balance(nss.ns(), freeDistStatus, balancedLastTime));
+            if (!migrateInfo) {
+                break;
+            }
+
             candidateChunks->push_back(migrateInfo);
         }
     }
@@ -570,20 +679,29 @@ void Balancer::run() {
                        << (writeConcern.get() ? writeConcern->toBSON().toString() : "default");
 
                 vector<shared_ptr<MigrateInfo>> candidateChunks;
+                int migrationWaves = 0;
+                int migrationMillis = 0;
                 _doBalanceRound(txn.get(), &scopedDistLock.getValue(), &candidateChunks);
 
                 if (candidateChunks.size() == 0) {
                     LOG(1) << "no need to move any chunk";
                     _balancedLastTime = 0;
                 } else {
-                    _balancedLastTime =
-                        _moveChunks(txn.get(), candidateChunks, writeConcern.get(), waitForDelete);
+                    Timer migrationTimer;
+                    _balancedLastTime = _moveChunks(txn.get(),
+                                                    candidateChunks,
+                                                    writeConcern.get(),
+                                                    waitForDelete,
+                                                    &migrationWaves);
+                    migrationMillis = migrationTimer.millis();
                 }
 
                 actionLog.setDetails(boost::none,
                                      balanceRoundTimer.millis(),
                                      static_cast<int>(candidateChunks.size()),
-                                     _balancedLastTime);
+                                     _balancedLastTime,
+                                     migrationMillis,
+                                     migrationWaves);
                 actionLog.setTime(jsTime());
 
                 grid.catalogManager(txn.get())->logAction(txn.get(), actionLog);
@@ -602,7 +720,7 @@ void Balancer::run() {
             LOG(1) << "*** End of balancing round";
 
             // This round failed, tell the world!
-            actionLog.setDetails(string(e.what()), balanceRoundTimer.millis(), 0, 0);
+            actionLog.setDetails(string(e.what()), balanceRoundTimer.millis(), 0, 0, 0, 0);
             actionLog.setTime(jsTime());
 
             grid.catalogManager(txn.get())->logAction(txn.get(), actionLog);
@@ -63,6 +63,15 @@ public:
         return "Balancer";
     }
 
+    /**
+     * Fills 'candidateChunks' with the chunks the balancing policy would move if a balancing
+     * round started now, at most balancerMaxConcurrentMigrations per collection. Does not take
+     * the balancer lock and does not split or move anything. Collections which first need a
+     * split at a tag boundary are left out, like in a real round.
+     */
+    void planBalanceRound(OperationContext* txn,
+                          std::vector<std::shared_ptr<MigrateInfo>>* candidateChunks);
+
 private:
     // hostname:port of my mongos
     std::string _myid;
@@ -89,25 +98,41 @@ private:
      * Gathers all the necessary information about shards and chunks, and decides whether there are
      * candidate chunks to be moved.
      *
-     * @param conn is the connection with the config server(s)
-     * @param candidateChunks (IN/OUT) filled with candidate chunks, one per collection, that could
-     *                          possibly be moved
+     * @param distLock is the balancer lock, or NULL to only plan the round without splitting
+     *                 chunks at tag boundaries
+     * @param candidateChunks (IN/OUT) filled with candidate chunks, up to
+     *                          balancerMaxConcurrentMigrations per collection with no shard in
+     *                          two of them, that could possibly be moved
      */
     void _doBalanceRound(OperationContext* txn,
                          ForwardingCatalogManager::ScopedDistLock* distLock,
                          std::vector<std::shared_ptr<MigrateInfo>>* candidateChunks);
 
     /**
-     * Issues chunk migration request, one at a time.
+     * Issues chunk migration requests in waves of up to balancerMaxConcurrentMigrations
+     * migrations, which run in parallel. A shard takes part in at most one migration of a wave.
      *
      * @param candidateChunks possible chunks to move
      * @param writeConcern detailed write concern. NULL means the default write concern.
      * @param waitForDelete wait for deletes to complete after each chunk move
+     * @param numWaves receives the number of waves issued
      * @return number of chunks effectively moved
      */
     int _moveChunks(OperationContext* txn,
                     const std::vector<std::shared_ptr<MigrateInfo>>& candidateChunks,
                     const WriteConcernOptions* writeConcern,
+                    bool waitForDelete,
+                    int* numWaves);
+
+    /**
+     * Issues one chunk migration request.
+     *
+     * @return true if the chunk was moved, or was marked as jumbo and another round should
+     *         follow right away
+     */
+    bool _moveChunk(OperationContext* txn,
+                    const MigrateInfo& migrateInfo,
+                    const WriteConcernOptions* writeConcern,
                     bool waitForDelete);
 
     /**
@@ -37,6 +37,7 @@
 
 #include "mongo/client/read_preference.h"
 #include "mongo/client/remote_command_targeter.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/catalog/catalog_manager.h"
 #include "mongo/s/catalog/type_shard.h"
 #include "mongo/s/catalog/type_tags.h"
@@ -45,8 +46,10 @@
 #include "mongo/s/client/shard_registry.h"
 #include "mongo/s/grid.h"
 #include "mongo/s/shard_util.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/log.h"
 #include "mongo/util/stringutils.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -56,19 +59,26 @@ using std::set;
 using std::string;
 using std::vector;
 
+MONGO_EXPORT_SERVER_PARAMETER(balancerLoadAware, bool, false);
+
 namespace {
 
+// Difference in load, in percent, between the most and the least loaded shard above which the
+// load aware policy moves a chunk.
+MONGO_EXPORT_SERVER_PARAMETER(balancerLoadImbalancePercent, int, 10);
+
 /**
  * Executes the serverStatus command against the specified shard and obtains the version of the
- * running MongoD service.
+ * running MongoD service and the total of its read and write operation counters.
  *
- * The MongoD version or throws an exception. Known exception codes are:
+ * Throws an exception on failure. Known exception codes are:
  *  ShardNotFound if shard by that id is not available on the registry
  *  NoSuchKey if the version could not be retrieved
  */
 std::string retrieveShardMongoDVersion(OperationContext* txn,
                                        ShardId shardId,
-                                       ShardRegistry* shardRegistry) {
+                                       ShardRegistry* shardRegistry,
+                                       long long* totalOps) {
     auto shard = shardRegistry->getShard(txn, shardId);
     if (!shard) {
         uassertStatusOK({ErrorCodes::ShardNotFound, "Shard not found"});
@@ -84,9 +94,111 @@ std::string retrieveShardMongoDVersion(OperationContext* txn,
         uassertStatusOK({ErrorCodes::NoSuchKey, "version field not found in serverStatus"});
     }
 
+    // Commands are left out, they are mostly the cluster's own traffic.
+    *totalOps = 0;
+    for (const auto& counter : serverStatus.getObjectField("opcounters")) {
+        if (counter.isNumber() && counter.fieldNameStringData() != "command") {
+            *totalOps += counter.safeNumberLong();
+        }
+    }
+
     return versionElement.str();
 }
 
+struct OpCountSample {
+    long long totalOps;
+    Date_t time;
+    long long opsPerSec;
+};
+
+stdx::mutex opCountSamplesMutex;
+map<ShardId, OpCountSample> opCountSamples;
+
+/**
+ * Records that the shard had processed 'totalOps' operations by now and returns its operation
+ * rate since the previous sample, or the previous rate if that sample is too recent to measure
+ * one.
+ */
+long long sampleOpsPerSec(const ShardId& shardId, long long totalOps) {
+    const Date_t now = Date_t::now();
+
+    stdx::lock_guard<stdx::mutex> lk(opCountSamplesMutex);
+
+    auto it = opCountSamples.find(shardId);
+    if (it == opCountSamples.end() || totalOps < it->second.totalOps) {
+        // First sample, or the shard restarted and its counters started over.
+        opCountSamples[shardId] = {totalOps, now, 0};
+        return 0;
+    }
+
+    OpCountSample& sample = it->second;
+    const long long elapsedMillis = durationCount<Milliseconds>(now - sample.time);
+    if (elapsedMillis >= 1000) {
+        sample.opsPerSec = (totalOps - sample.totalOps) * 1000 / elapsedMillis;
+        sample.totalOps = totalOps;
+        sample.time = now;
+    }
+
+    return sample.opsPerSec;
+}
+
+/**
+ * Suggests moving a chunk with the given tag from the most to the least loaded shard, if their
+ * loads differ by more than balancerLoadImbalancePercent. Returns NULL otherwise.
+ */
+MigrateInfo* balanceTagByLoad(const string& ns,
+                              const DistributionStatus& distribution,
+                              const string& tag) {
+    const ShardId from = distribution.getMostLoadedShard(tag);
+    if (from.size() == 0)
+        return NULL;
+
+    // Moving away the only chunk would just move the imbalance to the receiver.
+    if (distribution.numberOfChunksInShardWithTag(from, tag) < 2)
+        return NULL;
+
+    const ShardId to = distribution.getLeastLoadedReceiverShard(tag);
+    if (to.size() == 0) {
+        log() << "no available shards to take chunks for tag [" << tag << "]";
+        return NULL;
+    }
+
+    if (to == from)
+        return NULL;
+
+    const double fromLoad = distribution.shardLoad(from);
+    const double toLoad = distribution.shardLoad(to);
+
+    LOG(1) << "collection : " << ns;
+    LOG(1) << "donor      : " << from << " load " << fromLoad;
+    LOG(1) << "receiver   : " << to << " load " << toLoad;
+    LOG(1) << "threshold  : " << balancerLoadImbalancePercent << "%";
+
+    if ((fromLoad - toLoad) * 100 <= balancerLoadImbalancePercent)
+        return NULL;
+
+    const vector<ChunkType>& chunks = distribution.getChunks(from);
+    unsigned numJumboChunks = 0;
+    for (const ChunkType& chunk : chunks) {
+        if (distribution.getTagForChunk(chunk) != tag)
+            continue;
+
+        if (chunk.getJumbo()) {
+            numJumboChunks++;
+            continue;
+        }
+
+        log() << " ns: " << ns << " going to move " << chunk << " from: " << from
+              << " (load " << fromLoad << ") to: " << to << " (load " << toLoad << ") tag ["
+              << tag << "]";
+        return new MigrateInfo(ns, to, from, chunk.toBSON());
+    }
+
+    error() << "shard: " << from << " ns: " << ns << " is overloaded, but its chunks are all jumbo "
+            << " numJumboChunks: " << numJumboChunks;
+    return NULL;
+}
+
 }  // namespace
 
 string TagRange::toString() const {
@@ -195,6 +307,67 @@ string DistributionStatus::getMostOverloadedShard(const string& tag) const {
     return worst;
 }
 
+double DistributionStatus::shardLoad(const ShardId& shardId) const {
+    long long totalSizeMB = 0;
+    long long totalOpsPerSec = 0;
+    for (ShardInfoMap::const_iterator i = _shardInfo.begin(); i != _shardInfo.end(); ++i) {
+        totalSizeMB += i->second.getCurrSizeMB();
+        totalOpsPerSec += i->second.getOpsPerSec();
+    }
+
+    const ShardInfo& info = shardInfo(shardId);
+
+    double load = 0;
+    if (totalSizeMB > 0) {
+        load += static_cast<double>(info.getCurrSizeMB()) / totalSizeMB;
+    }
+    if (totalOpsPerSec > 0) {
+        load += static_cast<double>(info.getOpsPerSec()) / totalOpsPerSec;
+    }
+
+    return load;
+}
+
+string DistributionStatus::getLeastLoadedReceiverShard(const string& tag) const {
+    string best;
+    double minLoad = numeric_limits<double>::max();
+
+    for (ShardInfoMap::const_iterator i = _shardInfo.begin(); i != _shardInfo.end(); ++i) {
+        if (i->second.isSizeMaxed() || i->second.isDraining() || !i->second.hasTag(tag)) {
+            continue;
+        }
+
+        const double myLoad = shardLoad(i->first);
+        if (myLoad >= minLoad) {
+            continue;
+        }
+
+        best = i->first;
+        minLoad = myLoad;
+    }
+
+    return best;
+}
+
+string DistributionStatus::getMostLoadedShard(const string& tag) const {
+    string worst;
+    double maxLoad = -1;
+
+    for (ShardInfoMap::const_iterator i = _shardInfo.begin(); i != _shardInfo.end(); ++i) {
+        if (numberOfChunksInShardWithTag(i->first, tag) == 0)
+            continue;
+
+        const double myLoad = shardLoad(i->first);
+        if (myLoad <= maxLoad)
+            continue;
+
+        worst = i->first;
+        maxLoad = myLoad;
+    }
+
+    return worst;
+}
+
 const vector<ChunkType>& DistributionStatus::getChunks(const ShardId& shardId) const {
     ShardToChunksMap::const_iterator i = _shardChunks.find(shardId);
     invariant(i != _shardChunks.end());
@@ -289,8 +462,9 @@ Status DistributionStatus::populateShardInfoMap(OperationContext* txn, ShardInfo
             const long long shardSizeBytes = uassertStatusOK(
                 shardutil::retrieveTotalShardSize(txn, shardData.getName(), grid.shardRegistry()));
 
-            const std::string shardMongodVersion =
-                retrieveShardMongoDVersion(txn, shardData.getName(), grid.shardRegistry());
+            long long totalOps;
+            const std::string shardMongodVersion = retrieveShardMongoDVersion(
+                txn, shardData.getName(), grid.shardRegistry(), &totalOps);
 
             ShardInfo newShardEntry(shardData.getMaxSizeMB(),
                                     shardSizeBytes / 1024 / 1024,
@@ -302,6 +476,8 @@ Status DistributionStatus::populateShardInfoMap(OperationContext* txn, ShardInfo
                 newShardEntry.addTag(shardTag);
             }
 
+            newShardEntry.setOpsPerSec(sampleOpsPerSec(shardData.getName(), totalOps));
+
             shardInfo->insert(make_pair(shardData.getName(), newShardEntry));
         }
     } catch (const DBException& ex) {
@@ -446,6 +622,13 @@ MigrateInfo* BalancerPolicy::balance(const string& ns,
     for (unsigned i = 0; i < tags.size(); i++) {
         string tag = tags[i];
 
+        if (balancerLoadAware) {
+            MigrateInfo* migrateInfo = balanceTagByLoad(ns, distribution, tag);
+            if (migrateInfo)
+                return migrateInfo;
+            continue;
+        }
+
         const ShardId from = distribution.getMostOverloadedShard(tag);
         if (from.size() == 0)
             continue;
@@ -513,9 +696,10 @@ ShardInfo::ShardInfo(long long maxSizeMB,
       _currSizeMB(currSizeMB),
       _draining(draining),
       _tags(tags),
-      _mongoVersion(mongoVersion) {}
+      _mongoVersion(mongoVersion),
+      _opsPerSec(0) {}
 
-ShardInfo::ShardInfo() : _maxSizeMB(0), _currSizeMB(0), _draining(false) {}
+ShardInfo::ShardInfo() : _maxSizeMB(0), _currSizeMB(0), _draining(false), _opsPerSec(0) {}
 
 void ShardInfo::addTag(const string& tag) {
     _tags.insert(tag);
@@ -546,6 +730,7 @@ string ShardInfo::toString() const {
             ss << *i << ",";
     }
     ss << " version: " << _mongoVersion;
+    ss << " opsPerSec: " << _opsPerSec;
     return ss.str();
 }
 
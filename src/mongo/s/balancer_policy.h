@@ -40,6 +40,10 @@ namespace mongo {
 class ChunkManager;
 class OperationContext;
 
+// Whether the balancer evens out the data size and operation rate of the shards (see
+// DistributionStatus::shardLoad) rather than their chunk counts. Exposed for testing.
+extern bool balancerLoadAware;
+
 struct ChunkInfo {
     const BSONObj min;
     const BSONObj max;
@@ -107,6 +111,18 @@ public:
         return _mongoVersion;
     }
 
+    /**
+     * Reads, inserts, updates and deletes per second on the shard, measured between the two
+     * latest times its serverStatus was sampled. Zero until the shard was sampled twice.
+     */
+    long long getOpsPerSec() const {
+        return _opsPerSec;
+    }
+
+    void setOpsPerSec(long long opsPerSec) {
+        _opsPerSec = opsPerSec;
+    }
+
     std::string toString() const;
 
 private:
@@ -115,6 +131,7 @@ private:
     bool _draining;
     std::set<std::string> _tags;
     std::string _mongoVersion;
+    long long _opsPerSec;
 };
 
 
@@ -162,6 +179,23 @@ public:
      */
     std::string getMostOverloadedShard(const std::string& forTag) const;
 
+    /**
+     * @return the share of the cluster's data size plus the share of the cluster's operation
+     *         rate which the shard holds, between 0 and 2
+     */
+    double shardLoad(const ShardId& shardId) const;
+
+    /**
+     * @param forTag "" if you don't care, or a tag
+     * @return the least loaded shard which can receive a chunk with the given tag
+     */
+    std::string getLeastLoadedReceiverShard(const std::string& forTag) const;
+
+    /**
+     * @return the most loaded shard among those with chunks with the given tag
+     */
+    std::string getMostLoadedShard(const std::string& forTag) const;
+
 
     // ---- basic accessors, counters, etc...
 
@@ -198,7 +232,7 @@ public:
 
     /**
      * Retrieves shard metadata information from the config server as well as some stats
-     * from the shards.
+     * from the shards, including their operation rates since they were last sampled.
      */
     static Status populateShardInfoMap(OperationContext* txn, ShardInfoMap* shardInfo);
 
@@ -225,6 +259,9 @@ public:
      * space usage and number of chunks for that collection. If the policy doesn't recommend
      * moving, it returns NULL.
      *
+     * Once draining shards and tag violations are dealt with, the chunks of each tag are
+     * balanced by count, or by shard load when balancerLoadAware is set.
+     *
      * @param ns is the collections namepace.
      * @param DistributionStatus holds all the info about the current state of the cluster/namespace
      * @param balancedLastTime is the number of chunks effectively moved in the last round.
@@ -620,4 +620,120 @@ TEST(BalancerPolicyTests, Simulation) {
     }
 }
 
+/**
+ * Returns 'numChunks' consecutive chunks, starting at x = 'start'.
+ */
+vector<ChunkType> makeChunks(int start, int numChunks) {
+    vector<ChunkType> chunks;
+    for (int i = start; i < start + numChunks; i++) {
+        ChunkType chunk;
+        chunk.setMin(BSON("x" << i));
+        chunk.setMax(BSON("x" << i + 1));
+        chunks.push_back(chunk);
+    }
+    return chunks;
+}
+
+/**
+ * Turns on the load aware policy for the lifetime of the object.
+ */
+class LoadAwareScope {
+public:
+    LoadAwareScope() {
+        balancerLoadAware = true;
+    }
+
+    ~LoadAwareScope() {
+        balancerLoadAware = false;
+    }
+};
+
+TEST(BalancerPolicyTests, LoadAwareMovesFromLargerShard) {
+    ShardToChunksMap chunkMap;
+    chunkMap["shard0"] = makeChunks(0, 10);
+    chunkMap["shard1"] = makeChunks(10, 10);
+
+    // Same chunk counts, but shard0 holds four times the data.
+    ShardInfoMap info;
+    info["shard0"] = ShardInfo(0, 400, false);
+    info["shard1"] = ShardInfo(0, 100, false);
+
+    DistributionStatus status(info, chunkMap);
+    ASSERT_APPROX_EQUAL(0.8, status.shardLoad("shard0"), 0.001);
+    ASSERT_APPROX_EQUAL(0.2, status.shardLoad("shard1"), 0.001);
+
+    std::unique_ptr<MigrateInfo> byCount(BalancerPolicy::balance("ns", status, 0));
+    ASSERT(!byCount);
+
+    LoadAwareScope loadAware;
+    std::unique_ptr<MigrateInfo> byLoad(BalancerPolicy::balance("ns", status, 0));
+    ASSERT(byLoad);
+    ASSERT_EQUALS("shard0", byLoad->from);
+    ASSERT_EQUALS("shard1", byLoad->to);
+}
+
+TEST(BalancerPolicyTests, LoadAwareMovesFromBusierShard) {
+    ShardToChunksMap chunkMap;
+    chunkMap["shard0"] = makeChunks(0, 10);
+    chunkMap["shard1"] = makeChunks(10, 10);
+    chunkMap["shard2"] = makeChunks(20, 10);
+
+    // Same data sizes, but shard1 serves most of the operations.
+    ShardInfoMap info;
+    info["shard0"] = ShardInfo(0, 100, false);
+    info["shard1"] = ShardInfo(0, 100, false);
+    info["shard2"] = ShardInfo(0, 100, false);
+    info["shard0"].setOpsPerSec(100);
+    info["shard1"].setOpsPerSec(1000);
+    info["shard2"].setOpsPerSec(200);
+
+    DistributionStatus status(info, chunkMap);
+
+    LoadAwareScope loadAware;
+    std::unique_ptr<MigrateInfo> c(BalancerPolicy::balance("ns", status, 0));
+    ASSERT(c);
+    ASSERT_EQUALS("shard1", c->from);
+    ASSERT_EQUALS("shard0", c->to);
+}
+
+TEST(BalancerPolicyTests, LoadAwareBalancedWithinThreshold) {
+    ShardToChunksMap chunkMap;
+    chunkMap["shard0"] = makeChunks(0, 10);
+    chunkMap["shard1"] = makeChunks(10, 2);
+
+    // Different chunk counts, but data size and operation rates are within a few percent.
+    ShardInfoMap info;
+    info["shard0"] = ShardInfo(0, 102, false);
+    info["shard1"] = ShardInfo(0, 98, false);
+    info["shard0"].setOpsPerSec(500);
+    info["shard1"].setOpsPerSec(510);
+
+    DistributionStatus status(info, chunkMap);
+
+    LoadAwareScope loadAware;
+    std::unique_ptr<MigrateInfo> c(BalancerPolicy::balance("ns", status, 0));
+    ASSERT(!c);
+}
+
+TEST(BalancerPolicyTests, LoadAwareSkipsMaxedReceiver) {
+    ShardToChunksMap chunkMap;
+    chunkMap["shard0"] = makeChunks(0, 10);
+    chunkMap["shard1"] = makeChunks(10, 10);
+    chunkMap["shard2"] = makeChunks(20, 10);
+
+    // The least loaded shard cannot take more data, so the next one receives the chunk.
+    ShardInfoMap info;
+    info["shard0"] = ShardInfo(0, 600, false);
+    info["shard1"] = ShardInfo(150, 150, false);
+    info["shard2"] = ShardInfo(0, 250, false);
+
+    DistributionStatus status(info, chunkMap);
+
+    LoadAwareScope loadAware;
+    std::unique_ptr<MigrateInfo> c(BalancerPolicy::balance("ns", status, 0));
+    ASSERT(c);
+    ASSERT_EQUALS("shard0", c->from);
+    ASSERT_EQUALS("shard2", c->to);
+}
+
 }  // namespace
@@ -70,6 +70,17 @@ StatusWith<shared_ptr<DBConfig>> CatalogCache::getDatabase(OperationContext* txn
     return db;
 }
 
+shared_ptr<DBConfig> CatalogCache::getDatabaseIfCached(const string& dbName) {
+    stdx::lock_guard<stdx::mutex> guard(_mutex);
+
+    ShardedDatabasesMap::iterator it = _databases.find(dbName);
+    if (it == _databases.end()) {
+        return nullptr;
+    }
+
+    return it->second;
+}
+
 void CatalogCache::invalidate(const string& dbName) {
     stdx::lock_guard<stdx::mutex> guard(_mutex);
 
@@ -67,6 +67,12 @@ public:
     StatusWith<std::shared_ptr<DBConfig>> getDatabase(OperationContext* txn,
                                                       const std::string& dbName);
 
+    /**
+     * Returns the cached metadata for the specified database, or nullptr if it is not cached.
+     * Unlike getDatabase, never loads it from the config servers.
+     */
+    std::shared_ptr<DBConfig> getDatabaseIfCached(const std::string& dbName);
+
     /**
      * Removes the database information for the specified name from the cache, so that the
      * next time getDatabase is called, it will be reloaded.
@@ -107,7 +107,7 @@ TEST_F(LogActionTest, LogActionNoRetryAfterSuccessfulCreate) {
     expectedActionLog.setServer("server1");
     expectedActionLog.setTime(network()->now());
     expectedActionLog.setWhat("moved a chunk");
-    expectedActionLog.setDetails(boost::none, 0, 1, 1);
+    expectedActionLog.setDetails(boost::none, 0, 1, 1, 0, 1);
 
     auto future = launchAsync([this, &expectedActionLog] {
         catalogManager()->logAction(operationContext(), expectedActionLog);
@@ -137,7 +137,7 @@ TEST_F(LogActionTest, LogActionNoRetryCreateIfAlreadyExists) {
     expectedActionLog.setServer("server1");
     expectedActionLog.setTime(network()->now());
     expectedActionLog.setWhat("moved a chunk");
-    expectedActionLog.setDetails(boost::none, 0, 1, 1);
+    expectedActionLog.setDetails(boost::none, 0, 1, 1, 0, 1);
 
     auto future = launchAsync([this, &expectedActionLog] {
         catalogManager()->logAction(operationContext(), expectedActionLog);
@@ -170,7 +170,7 @@ TEST_F(LogActionTest, LogActionCreateFailure) {
     expectedActionLog.setServer("server1");
     expectedActionLog.setTime(network()->now());
     expectedActionLog.setWhat("moved a chunk");
-    expectedActionLog.setDetails(boost::none, 0, 1, 1);
+    expectedActionLog.setDetails(boost::none, 0, 1, 1, 0, 1);
 
     auto future = launchAsync([this, &expectedActionLog] {
         catalogManager()->logAction(operationContext(), expectedActionLog);
@@ -141,7 +141,9 @@ void ActionLogType::setTime(const Date_t& time) {
 void ActionLogType::setDetails(const boost::optional<std::string>& errMsg,
                                int executionTime,
                                int candidateChunks,
-                               int chunksMoved) {
+                               int chunksMoved,
+                               int migrationTime,
+                               int migrationWaves) {
     BSONObjBuilder builder;
     builder.append("executionTimeMillis", executionTime);
     builder.append("errorOccured", errMsg.is_initialized());
@@ -151,6 +153,8 @@ void ActionLogType::setDetails(const boost::optional<std::string>& errMsg,
     } else {
         builder.append("candidateChunks", candidateChunks);
         builder.append("chunksMoved", chunksMoved);
+        builder.append("migrationTimeMillis", migrationTime);
+        builder.append("migrationWaves", migrationWaves);
     }
 
     _details = builder.obj();
@@ -102,6 +102,8 @@ public:
      * Success: {
      *           "candidateChunks" : ,
      *           "chunksMoved" : ,
+     *           "migrationTimeMillis" : ,
+     *           "migrationWaves" : ,
      *           "executionTimeMillis" : ,
      *           "errorOccured" : false
      *          }
@@ -114,11 +116,15 @@ public:
      * @param executionTime: the time this round took to run
      * @param candidateChunks: the number of chunks identified to be moved
      * @param chunksMoved: the number of chunks moved
+     * @param migrationTime: the part of executionTime spent migrating chunks
+     * @param migrationWaves: the number of waves of concurrent migrations issued
      */
     void setDetails(const boost::optional<std::string>& errMsg,
                     int executionTime,
                     int candidateChunks,
-                    int chunksMoved);
+                    int chunksMoved,
+                    int migrationTime,
+                    int migrationWaves);
 
 private:
     // Convention: (M)andatory, (O)ptional, (S)pecial rule.
@@ -37,12 +37,15 @@
 #include <set>
 
 #include "mongo/bson/util/bson_extract.h"
+#include "mongo/base/counter.h"
 #include "mongo/client/remote_command_targeter.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/s/catalog/catalog_cache.h"
 #include "mongo/s/catalog/catalog_manager.h"
 #include "mongo/s/catalog/type_chunk.h"
@@ -70,15 +73,47 @@ using std::vector;
 
 namespace {
 
+// Chunk keys compare field by field in ascending order, regardless of the shard key pattern.
+const Ordering kAllAscending = Ordering::make(BSONObj());
+
+/**
+ * Encodes a chunk boundary or shard key as a KeyString. KeyString only encodes values, so the
+ * field names are dropped first.
+ */
+void encodeChunkKey(const BSONObj& key, KeyString* out) {
+    BSONObjBuilder values;
+    for (const auto& elem : key) {
+        values.appendAs(elem, "");
+    }
+    out->resetToKey(values.done(), kAllAscending);
+}
+
+// The number of chunk manager loads, the time they took and how many chunks they copied from the
+// previous chunk manager or read from the config server.
+Counter64 chunkManagerLoadStats;
+ServerStatusMetricField<Counter64> displayChunkManagerLoads("chunkManager.loads",
+                                                            &chunkManagerLoadStats);
+Counter64 chunkManagerLoadMillisStats;
+ServerStatusMetricField<Counter64> displayChunkManagerLoadMillis("chunkManager.loadMillis",
+                                                                 &chunkManagerLoadMillisStats);
+Counter64 chunksCopiedStats;
+ServerStatusMetricField<Counter64> displayChunksCopied("chunkManager.chunksCopied",
+                                                       &chunksCopiedStats);
+Counter64 chunksLoadedStats;
+ServerStatusMetricField<Counter64> displayChunksLoaded("chunkManager.chunksLoaded",
+                                                       &chunksLoadedStats);
+
 /**
  * This is an adapter so we can use config diffs - mongos and mongod do them slightly
  * differently
  *
- * The mongos adapter here tracks all shards, and stores ranges by (max, Chunk) in the map.
+ * The mongos adapter here tracks all shards, and stores ranges by (max, Chunk) in the map. The
+ * max key of every chunk it adds is also recorded in loadedChunkMaxes.
  */
 class CMConfigDiffTracker : public ConfigDiffTracker<shared_ptr<Chunk>> {
 public:
-    CMConfigDiffTracker(ChunkManager* manager) : _manager(manager) {}
+    CMConfigDiffTracker(ChunkManager* manager, vector<BSONObj>* loadedChunkMaxes)
+        : _manager(manager), _loadedChunkMaxes(loadedChunkMaxes) {}
 
     bool isTracked(const ChunkType& chunk) const final {
         // Mongos tracks all shards
@@ -92,6 +127,7 @@ public:
     pair<BSONObj, shared_ptr<Chunk>> rangeFor(OperationContext* txn,
                                               const ChunkType& chunk) const final {
         shared_ptr<Chunk> c(new Chunk(txn, _manager, chunk));
+        _loadedChunkMaxes->push_back(c->getMax());
         return make_pair(chunk.getMax(), c);
     }
 
@@ -102,6 +138,7 @@ public:
 
 private:
     ChunkManager* const _manager;
+    vector<BSONObj>* const _loadedChunkMaxes;
 };
 
 
@@ -153,6 +190,49 @@ bool isChunkMapValid(const ChunkMap& chunkMap) {
 #undef ENSURE
 }
 
+/**
+ * Validates a chunk map built by applying config diffs to a copy of a valid chunk map. Only the
+ * chunks that were loaded, given by their max keys, can be misplaced, so it is enough to check the
+ * endpoints and the neighbours of those chunks, instead of walking the whole map.
+ */
+bool isChunkMapValidAround(const ChunkMap& chunkMap, const vector<BSONObj>& loadedChunkMaxes) {
+    if (chunkMap.empty()) {
+        return true;
+    }
+
+    if (!allOfType(MinKey, chunkMap.begin()->second->getMin()) ||
+        !allOfType(MaxKey, boost::prior(chunkMap.end())->second->getMax())) {
+        log() << "ChunkManager::_isValid failed: chunk map does not cover the whole key space";
+        return false;
+    }
+
+    for (const auto& max : loadedChunkMaxes) {
+        ChunkMap::const_iterator it = chunkMap.find(max);
+        if (it == chunkMap.end()) {
+            log() << "ChunkManager::_isValid failed: loaded chunk with max " << max << " missing";
+            return false;
+        }
+
+        if (it != chunkMap.begin()) {
+            ChunkMap::const_iterator last = boost::prior(it);
+            if (!(it->second->getMin() == last->second->getMax())) {
+                log() << "ChunkManager::_isValid failed: " << last->second->toString()
+                      << " is not followed by " << it->second->toString();
+                return false;
+            }
+        }
+
+        ChunkMap::const_iterator next = boost::next(it);
+        if (next != chunkMap.end() && !(next->second->getMin() == it->second->getMax())) {
+            log() << "ChunkManager::_isValid failed: " << it->second->toString()
+                  << " is not followed by " << next->second->toString();
+            return false;
+        }
+    }
+
+    return true;
+}
+
 }  // namespace
 
 AtomicUInt32 ChunkManager::NextSequenceNumber(1U);
@@ -180,22 +260,33 @@ void ChunkManager::loadExistingRanges(OperationContext* txn, const ChunkManager*
         ChunkMap chunkMap;
         set<ShardId> shardIds;
         ShardVersionMap shardVersions;
+        vector<BSONObj> loadedChunkMaxes;
 
         Timer t;
 
-        bool success = _load(txn, chunkMap, shardIds, &shardVersions, oldManager);
+        bool success =
+            _load(txn, chunkMap, shardIds, &shardVersions, &loadedChunkMaxes, oldManager);
         if (success) {
             log() << "ChunkManager: time to load chunks for " << _ns << ": " << t.millis() << "ms"
                   << " sequenceNumber: " << _sequenceNumber << " version: " << _version.toString()
                   << " based on: "
                   << (oldManager ? oldManager->getVersion().toString() : "(empty)");
 
+            chunkManagerLoadStats.increment();
+            chunkManagerLoadMillisStats.increment(t.millis());
+            chunksLoadedStats.increment(loadedChunkMaxes.size());
+            chunksCopiedStats.increment(chunkMap.size() - loadedChunkMaxes.size());
+
             // TODO: Merge into diff code above, so we validate in one place
-            if (isChunkMapValid(chunkMap)) {
+            const bool isValid = loadedChunkMaxes.size() < chunkMap.size()
+                ? isChunkMapValidAround(chunkMap, loadedChunkMaxes)
+                : isChunkMapValid(chunkMap);
+            if (isValid) {
                 _chunkMap.swap(chunkMap);
                 _shardIds.swap(shardIds);
                 _shardVersions.swap(shardVersions);
                 _chunkRanges.reloadAll(_chunkMap);
+                _chunkKeyIndex.reloadAll(_chunkMap);
 
                 return;
             }
@@ -220,6 +311,7 @@ bool ChunkManager::_load(OperationContext* txn,
                          ChunkMap& chunkMap,
                          set<ShardId>& shardIds,
                          ShardVersionMap* shardVersions,
+                         vector<BSONObj>* loadedChunkMaxes,
                          const ChunkManager* oldManager) {
     // Reset the max version, but not the epoch, when we aren't loading from the oldManager
     _version = ChunkVersion(0, 0, _version.epoch());
@@ -246,7 +338,8 @@ bool ChunkManager::_load(OperationContext* txn,
 
             newC->setBytesWritten(oldC->getBytesWritten());
 
-            chunkMap.insert(make_pair(oldC->getMax(), newC));
+            // The old chunks come in key order, so each one goes at the end of the new map.
+            chunkMap.insert(chunkMap.end(), make_pair(oldC->getMax(), newC));
         }
 
         LOG(2) << "loading chunk manager for collection " << _ns
@@ -255,7 +348,7 @@ bool ChunkManager::_load(OperationContext* txn,
     }
 
     // Attach a diff tracker for the versioned chunk data
-    CMConfigDiffTracker differ(this);
+    CMConfigDiffTracker differ(this, loadedChunkMaxes);
     differ.attach(_ns, chunkMap, _version, *shardVersions);
 
     // Diff tracker should *always* find at least one chunk if collection exists
@@ -451,22 +544,14 @@ void ChunkManager::createFirstChunks(OperationContext* txn,
 
 ChunkPtr ChunkManager::findIntersectingChunk(OperationContext* txn, const BSONObj& shardKey) const {
     {
-        BSONObj chunkMin;
-        ChunkPtr chunk;
-        {
-            ChunkMap::const_iterator it = _chunkMap.upper_bound(shardKey);
-            if (it != _chunkMap.end()) {
-                chunkMin = it->first;
-                chunk = it->second;
-            }
-        }
+        ChunkPtr chunk = _chunkKeyIndex.upperBound(shardKey);
 
         if (chunk) {
             if (chunk->containsKey(shardKey)) {
                 return chunk;
             }
 
-            log() << chunkMin;
+            log() << chunk->getMax();
             log() << *chunk;
             log() << shardKey;
 
@@ -481,7 +566,7 @@ ChunkPtr ChunkManager::findIntersectingChunk(OperationContext* txn, const BSONOb
                               << ", number of chunks: " << _chunkMap.size());
 }
 
-void ChunkManager::getShardIdsForQuery(set<ShardId>& shardIds, const BSONObj& query) const {
+BoundList ChunkManager::_getRangesForQuery(const BSONObj& query) const {
     auto statusWithCQ =
         CanonicalQuery::canonicalize(NamespaceString(_ns), query, WhereCallbackNoop());
 
@@ -506,7 +591,11 @@ void ChunkManager::getShardIdsForQuery(set<ShardId>& shardIds, const BSONObj& qu
     //   Key { a : 1, b : 1 }
     //   Bounds { a : [1, 2), b : [3, 4) }
     //   => Ranges { a : 1, b : 3 } => { a : 2, b : 4 }
-    BoundList ranges = _keyPattern.flattenBounds(bounds);
+    return _keyPattern.flattenBounds(bounds);
+}
+
+void ChunkManager::getShardIdsForQuery(set<ShardId>& shardIds, const BSONObj& query) const {
+    BoundList ranges = _getRangesForQuery(query);
 
     for (BoundList::const_iterator it = ranges.begin(); it != ranges.end(); ++it) {
         getShardIdsForRange(shardIds, it->first /*min*/, it->second /*max*/);
@@ -547,6 +636,25 @@ void ChunkManager::getShardIdsForRange(set<ShardId>& shardIds,
     }
 }
 
+void ChunkManager::getChunkCountsForQuery(const BSONObj& query,
+                                          map<ShardId, int>* chunkCounts) const {
+    // Chunks are keyed by their max, so the chunks intersecting [min, max] start at the first
+    // chunk whose max is above min and end at the first chunk whose max is above max.
+    set<BSONObj, BSONObjCmp> counted;
+    for (const auto& range : _getRangesForQuery(query)) {
+        ChunkMap::const_iterator it = _chunkMap.upper_bound(range.first);
+        ChunkMap::const_iterator end = _chunkMap.upper_bound(range.second);
+        if (end != _chunkMap.end())
+            ++end;
+
+        for (; it != end; ++it) {
+            if (counted.insert(it->first).second) {
+                ++(*chunkCounts)[it->second->getShardId()];
+            }
+        }
+    }
+}
+
 void ChunkManager::getAllShardIds(set<ShardId>* all) const {
     dassert(all);
 
@@ -791,6 +899,46 @@ void ChunkRangeManager::reloadAll(const ChunkMap& chunks) {
     DEV assertValid();
 }
 
+void ChunkKeyIndex::reloadAll(const ChunkMap& chunks) {
+    _keys.clear();
+    _keyEnds.clear();
+    _chunks.clear();
+    _keyEnds.reserve(chunks.size());
+    _chunks.reserve(chunks.size());
+
+    KeyString key;
+    for (const auto& entry : chunks) {
+        encodeChunkKey(entry.first, &key);
+        _keys.append(key.getBuffer(), key.getSize());
+        _keyEnds.push_back(_keys.size());
+        _chunks.push_back(entry.second);
+    }
+}
+
+shared_ptr<Chunk> ChunkKeyIndex::upperBound(const BSONObj& shardKey) const {
+    KeyString key;
+    encodeChunkKey(shardKey, &key);
+    const StringData keyData(key.getBuffer(), key.getSize());
+
+    size_t low = 0;
+    size_t high = _chunks.size();
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (_keyAt(mid).compare(keyData) > 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+
+    return low == _chunks.size() ? shared_ptr<Chunk>() : _chunks[low];
+}
+
+StringData ChunkKeyIndex::_keyAt(size_t i) const {
+    const size_t begin = i == 0 ? 0 : _keyEnds[i - 1];
+    return StringData(_keys.data() + begin, _keyEnds[i] - begin);
+}
+
 void ChunkRangeManager::_insertRange(ChunkMap::const_iterator begin,
                                      const ChunkMap::const_iterator end) {
     while (begin != end) {
@@ -91,6 +91,33 @@ private:
 typedef std::map<BSONObj, std::shared_ptr<ChunkRange>, BSONObjCmp> ChunkRangeMap;
 
 
+/**
+ * Read-optimized copy of a ChunkMap for targeting single shard keys. The max keys of the chunks are
+ * KeyString encoded back to back in one buffer, in ChunkMap order, so that a lookup is a binary
+ * search over raw bytes instead of a walk down the map comparing BSONObjs.
+ */
+class ChunkKeyIndex {
+public:
+    void reloadAll(const ChunkMap& chunks);
+
+    /**
+     * Returns the chunk with the smallest max key greater than shardKey, or nullptr if there is
+     * none.
+     */
+    std::shared_ptr<Chunk> upperBound(const BSONObj& shardKey) const;
+
+private:
+    // Returns the encoded max key of the chunk at position i.
+    StringData _keyAt(size_t i) const;
+
+    std::string _keys;
+    // Offset into _keys one past the end of each chunk's key
+    std::vector<size_t> _keyEnds;
+    std::vector<std::shared_ptr<Chunk>> _chunks;
+};
+
+
+
 class ChunkRangeManager {
 public:
     const ChunkRangeMap& ranges() const {
@@ -198,6 +225,14 @@ public:
 
     void getShardIdsForQuery(std::set<ShardId>& shardIds, const BSONObj& query) const;
     void getAllShardIds(std::set<ShardId>* all) const;
+
+    /**
+     * Adds to 'chunkCounts' the number of chunks each shard owns among the chunks which may
+     * contain documents matching 'query'. Shards owning none of them are not added.
+     */
+    void getChunkCountsForQuery(const BSONObj& query,
+                                std::map<ShardId, int>* chunkCounts) const;
+
     /** @param shardIds set to the shard ids for shards
      *         covered by the interval [min, max], see SERVER-4791
      */
@@ -251,11 +286,16 @@ public:
     repl::OpTime getConfigOpTime() const;
 
 private:
-    // returns true if load was consistent
+    // Transforms query into the shard key ranges which may contain documents matching it
+    BoundList _getRangesForQuery(const BSONObj& query) const;
+
+    // returns true if load was consistent. The max keys of the chunks read from the config
+    // server, rather than copied from oldManager, are appended to loadedChunkMaxes.
     bool _load(OperationContext* txn,
                ChunkMap& chunks,
                std::set<ShardId>& shardIds,
                ShardVersionMap* shardVersions,
+               std::vector<BSONObj>* loadedChunkMaxes,
                const ChunkManager* oldManager);
 
 
@@ -271,6 +311,7 @@ private:
 
     ChunkMap _chunkMap;
     ChunkRangeManager _chunkRanges;
+    ChunkKeyIndex _chunkKeyIndex;
 
     std::set<ShardId> _shardIds;
 
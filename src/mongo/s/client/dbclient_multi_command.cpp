@@ -143,6 +143,10 @@ void DBClientMultiCommand::sendAll() {
          it != _pendingCommands.end();
          ++it) {
         PendingCommand* command = *it;
+        if (command->sent)
+            continue;
+
+        command->sent = true;
         dassert(!command->conn);
 
         try {
@@ -210,7 +214,11 @@ Status DBClientMultiCommand::recvAny(ConnectionString* endpoint, BSONSerializabl
 DBClientMultiCommand::PendingCommand::PendingCommand(const ConnectionString& endpoint,
                                                      StringData dbName,
                                                      const BSONObj& cmdObj)
-    : endpoint(endpoint), dbName(dbName.toString()), cmdObj(cmdObj), status(Status::OK()) {}
+    : endpoint(endpoint),
+      dbName(dbName.toString()),
+      cmdObj(cmdObj),
+      status(Status::OK()),
+      sent(false) {}
 
 DBClientMultiCommand::PendingCommand::~PendingCommand() = default;
 
@@ -79,6 +79,9 @@ private:
 
         // If anything goes wrong
         Status status;
+
+        // Whether sendAll() has already tried to send this command
+        bool sent;
     };
 
     typedef std::deque<PendingCommand*> PendingQueue;
@@ -59,9 +59,11 @@ public:
                             const BSONObj& request) = 0;
 
     /**
-     * Sends all the commands in this dispatch to their endpoints, in undefined order and
-     * without waiting for responses.  May block on full send queue (though this should be
-     * rare).
+     * Sends all the commands in this dispatch which have not been sent yet to their endpoints,
+     * in undefined order and without waiting for responses.  May block on full send queue
+     * (though this should be rare).
+     *
+     * More commands may be added and sent while the responses to earlier ones are outstanding.
      *
      * Any error which occurs during sendAll will be reported on recvAny, *does not throw.*
      */
@@ -36,6 +36,7 @@
 
 #include "mongo/db/commands.h"
 #include "mongo/db/lasterror.h"
+#include "mongo/executor/network_interface.h"
 #include "mongo/s/chunk_manager.h"
 #include "mongo/s/client/shard.h"
 #include "mongo/s/client/shard_registry.h"
@@ -121,6 +122,16 @@ public:
         // Thread connection info
         activeClientConnections.appendInfo(result);
 
+        // Connections used by the task executor
+        if (auto shardRegistry = grid.shardRegistry()) {
+            BSONObjBuilder executorBuilder(result.subobjStart("executorHosts"));
+            shardRegistry->getNetwork()->appendConnectionStats(&executorBuilder);
+            executorBuilder.done();
+
+            BSONObjBuilder breakerBuilder(result.subobjStart("executorCircuitBreakers"));
+            shardRegistry->getNetwork()->appendCircuitBreakerStats(&breakerBuilder);
+        }
+
         return true;
     }
 
@@ -182,7 +193,7 @@ public:
                         versionManager.resetShardVersionCB(ss->avail);
                     }
 
-                    delete ss->avail;
+                    shardConnectionPool.discard(addr, ss->avail);
                 } else {
                     release(addr, ss->avail);
                 }
@@ -244,7 +255,7 @@ public:
             }
 
             if (!isConnGood) {
-                delete s->avail;
+                shardConnectionPool.discard(addr, s->avail);
                 s->avail = NULL;
             }
 
@@ -354,7 +365,7 @@ public:
     void clearPool() {
         for (HostMap::iterator iter = _hosts.begin(); iter != _hosts.end(); ++iter) {
             if (iter->second->avail != NULL) {
-                delete iter->second->avail;
+                shardConnectionPool.discard(iter->first, iter->second->avail);
             }
             delete iter->second;
         }
@@ -479,7 +490,7 @@ void ShardConnection::kill() {
             // Let the pool know about the bad connection and also delegate disposal to it.
             ClientConnections::threadInstance()->done(_cs.toString(), _conn);
         } else {
-            delete _conn;
+            shardConnectionPool.discard(_cs.toString(), _conn);
         }
 
         _conn = 0;
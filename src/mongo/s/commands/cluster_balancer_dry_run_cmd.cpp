@@ -0,0 +1,115 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <memory>
+#include <vector>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands.h"
+#include "mongo/s/balance.h"
+#include "mongo/s/balancer_policy.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Reports the chunk migrations the balancer would start if a balancing round ran now, without
+ * moving anything.
+ *
+ * Sample output:
+ *
+ * {
+ *   policy: "load",
+ *   moves: [
+ *     { ns: "test.user", from: "shard0000", to: "shard0001", min: { x: 0 }, max: { x: 10 } }
+ *   ],
+ *   ok: 1
+ * }
+ */
+class BalancerDryRunCmd : public Command {
+public:
+    BalancerDryRunCmd() : Command("balancerDryRun", false) {}
+
+    virtual bool slaveOk() const {
+        return true;
+    }
+
+    virtual bool adminOnly() const {
+        return true;
+    }
+
+    virtual bool isWriteCommandForConfigServer() const {
+        return false;
+    }
+
+    virtual void help(std::stringstream& help) const {
+        help << "shows the chunks the balancer would move if it ran a balancing round now";
+    }
+
+    virtual void addRequiredPrivileges(const std::string& dbname,
+                                       const BSONObj& cmdObj,
+                                       std::vector<Privilege>* out) {
+        ActionSet actions;
+        actions.addAction(ActionType::listShards);
+        out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+    }
+
+    virtual bool run(OperationContext* txn,
+                     const std::string& dbname,
+                     BSONObj& cmdObj,
+                     int options,
+                     std::string& errmsg,
+                     BSONObjBuilder& result) {
+        std::vector<std::shared_ptr<MigrateInfo>> candidateChunks;
+        balancer.planBalanceRound(txn, &candidateChunks);
+
+        result.append("policy", balancerLoadAware ? "load" : "chunkCount");
+
+        BSONArrayBuilder movesBuilder(result.subarrayStart("moves"));
+        for (const auto& migrateInfo : candidateChunks) {
+            BSONObjBuilder moveBuilder(movesBuilder.subobjStart());
+            moveBuilder.append("ns", migrateInfo->ns);
+            moveBuilder.append("from", migrateInfo->from);
+            moveBuilder.append("to", migrateInfo->to);
+            moveBuilder.append("min", migrateInfo->chunk.min);
+            moveBuilder.append("max", migrateInfo->chunk.max);
+            moveBuilder.doneFast();
+        }
+        movesBuilder.doneFast();
+
+        return true;
+    }
+
+} balancerDryRunCmd;
+
+}  // namespace
+}  // namespace mongo
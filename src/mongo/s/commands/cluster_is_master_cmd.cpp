@@ -28,11 +28,13 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/db/client.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/s/catalog/forwarding_catalog_manager.h"
 #include "mongo/s/grid.h"
 #include "mongo/s/write_ops/batched_command_request.h"
+#include "mongo/util/net/message_compressor.h"
 
 namespace mongo {
 namespace {
@@ -77,6 +79,8 @@ public:
         result.append("maxWireVersion", maxWireVersion);
         result.append("minWireVersion", minWireVersion);
 
+        negotiateMessageCompressor(cmdObj, txn->getClient()->port(), &result);
+
         return true;
     }
 
@@ -32,6 +32,8 @@
 
 #include <boost/intrusive_ptr.hpp>
 #include <initializer_list>
+#include <map>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -135,17 +137,17 @@ public:
             return aggPassthrough(txn, conf, cmdObj, result, options);
         }
 
-        // If the first $match stage is an exact match on the shard key, we only have to send it
-        // to one shard, so send the command to that shard.
+        // If the shard key ranges selected by the first $match stage are all owned by one shard,
+        // we only have to send it to that shard, so send the whole command there.
         BSONObj firstMatchQuery = pipeline->getInitialQuery();
         ChunkManagerPtr chunkMgr = conf->getChunkManager(txn, fullns);
-        BSONObj shardKeyMatches = uassertStatusOK(
-            chunkMgr->getShardKeyPattern().extractShardKeyFromQuery(firstMatchQuery));
+        std::set<ShardId> targetedShardIds;
+        chunkMgr->getShardIdsForQuery(targetedShardIds, firstMatchQuery);
 
-        // Don't need to split pipeline if the first $match is an exact match on shard key, unless
-        // there is a stage that needs to be run on the primary shard.
+        // Don't need to split pipeline if the first $match targets a single shard, unless there is
+        // a stage that needs to be run on the primary shard.
         const bool needPrimaryShardMerger = pipeline->needsPrimaryShardMerger();
-        const bool needSplit = shardKeyMatches.isEmpty() || needPrimaryShardMerger;
+        const bool needSplit = targetedShardIds.size() > 1 || needPrimaryShardMerger;
 
         // Split the pipeline into pieces for mongod(s) and this mongos. If needSplit is true,
         // 'pipeline' will become the merger side.
@@ -200,7 +202,16 @@ public:
         }
 
         if (!needSplit) {
-            invariant(shardResults.size() == 1);
+            // The command was retargeted to more shards if chunks moved after we looked at them,
+            // in which case the results of the unsplit pipeline cannot be combined.
+            if (shardResults.size() != 1) {
+                killAllCursors(shardResults);
+                uasserted(28813,
+                          str::stream() << "aggregation on " << fullns << " targeted "
+                                        << shardResults.size()
+                                        << " shards after chunk migrations; please retry");
+            }
+
             const BSONObj reply =
                 uassertStatusOK(storePossibleCursor(shardResults[0].target.toString(),
                                                     shardResults[0].result,
@@ -232,12 +243,12 @@ public:
             outputNsOrEmpty = out->getOutputNs().ns();
         }
 
-        // Run merging command on random shard, unless a stage needs the primary shard. Need to use
-        // ShardConnection so that the merging mongod is sent the config servers on connection init.
-        auto& prng = txn->getClient()->getPrng();
+        // Run merging command on the shard holding the most targeted data, unless a stage needs
+        // the primary shard. Need to use ShardConnection so that the merging mongod is sent the
+        // config servers on connection init.
         const auto& mergingShardId = needPrimaryShardMerger
             ? conf->getPrimaryId()
-            : shardResults[prng.nextInt32(shardResults.size())].shardTargetId;
+            : chooseMergingShard(txn, *chunkMgr, shardQuery, shardResults);
         const auto mergingShard = grid.shardRegistry()->getShard(txn, mergingShardId);
         ShardConnection conn(mergingShard->getConnString(), outputNsOrEmpty);
         BSONObj mergedResults =
@@ -256,6 +267,17 @@ private:
         const vector<Strategy::CommandResult>& shardResults, const string& fullns);
 
     void killAllCursors(const vector<Strategy::CommandResult>& shardResults);
+
+    /**
+     * Returns the shard among 'shardResults' owning the most chunks which may contain documents
+     * matching 'shardQuery', so that the least data has to cross the network to be merged. Ties
+     * are broken randomly, which spreads merges of evenly distributed collections.
+     */
+    ShardId chooseMergingShard(OperationContext* txn,
+                               const ChunkManager& chunkMgr,
+                               const BSONObj& shardQuery,
+                               const vector<Strategy::CommandResult>& shardResults);
+
     void uassertAllShardsSupportExplain(const vector<Strategy::CommandResult>& shardResults);
 
     // These are temporary hacks because the runCommand method doesn't report the exact
@@ -324,6 +346,34 @@ DocumentSourceMergeCursors::CursorIds PipelineCommand::parseCursors(
     }
 }
 
+ShardId PipelineCommand::chooseMergingShard(OperationContext* txn,
+                                            const ChunkManager& chunkMgr,
+                                            const BSONObj& shardQuery,
+                                            const vector<Strategy::CommandResult>& shardResults) {
+    std::map<ShardId, int> chunkCounts;
+    chunkMgr.getChunkCountsForQuery(shardQuery, &chunkCounts);
+
+    auto& prng = txn->getClient()->getPrng();
+    int bestCount = -1;
+    int numTied = 0;
+    ShardId best;
+    for (const auto& shardResult : shardResults) {
+        const auto it = chunkCounts.find(shardResult.shardTargetId);
+        const int count = (it == chunkCounts.end()) ? 0 : it->second;
+        if (count > bestCount) {
+            bestCount = count;
+            numTied = 1;
+            best = shardResult.shardTargetId;
+        } else if (count == bestCount && prng.nextInt32(++numTied) == 0) {
+            // Reservoir sampling keeps each of the tied shards with equal probability.
+            best = shardResult.shardTargetId;
+        }
+    }
+
+    invariant(bestCount >= 0);
+    return best;
+}
+
 void PipelineCommand::uassertAllShardsSupportExplain(
     const vector<Strategy::CommandResult>& shardResults) {
     for (size_t i = 0; i < shardResults.size(); i++) {
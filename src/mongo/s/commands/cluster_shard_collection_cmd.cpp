@@ -264,6 +264,17 @@ public:
                     return false;
                 }
 
+                // Hashed shard keys are always computed with MD5, which an index with another
+                // hash version does not match.
+                if (isHashedShardKey && idx["hashVersion"].numberInt() != Hasher::kMD5Version) {
+                    errmsg = str::stream() << "can't shard collection " << ns
+                                           << " with hashed shard key " << proposedKey
+                                           << " because the hashed index uses hashVersion "
+                                           << idx["hashVersion"].numberInt();
+                    conn.done();
+                    return false;
+                }
+
                 hasUsefulIndexForKey = true;
             }
         }
@@ -0,0 +1,267 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/config_change_listener.h"
+
+#include "mongo/base/counter.h"
+#include "mongo/client/connpool.h"
+#include "mongo/client/dbclientcursor.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/repl/optime.h"
+#include "mongo/db/repl/read_concern_args.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/s/catalog/catalog_cache.h"
+#include "mongo/s/catalog/catalog_manager.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/catalog/type_collection.h"
+#include "mongo/s/client/shard_registry.h"
+#include "mongo/s/config.h"
+#include "mongo/s/grid.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+using std::set;
+using std::string;
+using std::unique_ptr;
+
+namespace {
+
+// Whether mongos follows the config server oplog to refresh its cached routing information as
+// soon as it changes.
+MONGO_EXPORT_SERVER_PARAMETER(configChangeListenerEnabled, bool, false);
+
+const char kOplogNs[] = "local.oplog.rs";
+const char kApplyOpsNs[] = "config.$cmd";
+
+// The oplog cursor blocks for new entries, so this only bounds how long a dead config server
+// primary goes unnoticed.
+const double kSocketTimeoutSecs = 30;
+
+Counter64 configChangeEntries;
+ServerStatusMetricField<Counter64> displayConfigChangeEntries("configChangeListener.entries",
+                                                              &configChangeEntries);
+Counter64 configChangeRefreshes;
+ServerStatusMetricField<Counter64> displayConfigChangeRefreshes("configChangeListener.refreshes",
+                                                                &configChangeRefreshes);
+Counter64 configChangeGaps;
+ServerStatusMetricField<Counter64> displayConfigChangeGaps("configChangeListener.gaps",
+                                                           &configChangeGaps);
+
+/**
+ * Blocks until the config servers have majority committed the oplog entry at 'opTime', so that
+ * the catalog manager, which reads majority committed data, sees its changes.
+ */
+void waitForMajorityCommit(DBClientBase* conn, const repl::OpTime& opTime) {
+    BSONObjBuilder cmdBuilder;
+    cmdBuilder.append("find", NamespaceString(ChunkType::ConfigNS).coll());
+    cmdBuilder.append("filter", BSON("_id"
+                                     << ""));
+    cmdBuilder.append("limit", 1);
+    cmdBuilder.append("singleBatch", true);
+    repl::ReadConcernArgs(opTime, repl::ReadConcernLevel::kMajorityReadConcern)
+        .appendInfo(&cmdBuilder);
+
+    BSONObj result;
+    conn->runCommand("config", cmdBuilder.obj(), result);
+    uassertStatusOK(Command::getStatusFromCommandResult(result));
+}
+
+}  // namespace
+
+void ConfigChangeListener::run() {
+    Client::initThread("ConfigChangeListener");
+
+    Timestamp lastSeen;
+    while (!inShutdown()) {
+        if (!configChangeListenerEnabled) {
+            lastSeen = Timestamp();
+            sleepsecs(1);
+            continue;
+        }
+
+        auto txn = cc().makeOperationContext();
+        try {
+            if (grid.catalogManager(txn.get())->getMode() !=
+                CatalogManager::ConfigServerMode::CSRS) {
+                sleepsecs(10);
+                continue;
+            }
+
+            _listen(txn.get(), &lastSeen);
+        } catch (const DBException& ex) {
+            warning() << "error following config server changes" << causedBy(ex);
+            sleepsecs(1);
+        }
+    }
+}
+
+void ConfigChangeListener::extractChangedNamespaces(const BSONObj& oplogEntry,
+                                                    set<string>* collectionNss,
+                                                    set<string>* chunkNss) {
+    const BSONElement nsElem = oplogEntry["ns"];
+    if (nsElem.type() != String) {
+        return;
+    }
+
+    const StringData ns = nsElem.valueStringData();
+    const BSONObj o = oplogEntry.getObjectField("o");
+
+    if (ns == ChunkType::ConfigNS) {
+        // Inserts and whole document updates, which is how chunks are written, carry the
+        // namespace of the chunk.
+        const BSONElement chunkNs = o[ChunkType::ns.name()];
+        if (chunkNs.type() == String) {
+            chunkNss->insert(chunkNs.String());
+        }
+    } else if (ns == CollectionType::ConfigNS) {
+        // The _id of a collection entry is the namespace of the collection.
+        BSONElement id = oplogEntry.getObjectField("o2")["_id"];
+        if (id.eoo()) {
+            id = o["_id"];
+        }
+        if (id.type() == String) {
+            collectionNss->insert(id.String());
+        }
+    } else if (ns == kApplyOpsNs) {
+        // Splits, merges and migrations commit their chunk changes through applyOps.
+        const BSONElement ops = o["applyOps"];
+        if (ops.type() != Array) {
+            return;
+        }
+        for (const auto& op : ops.Obj()) {
+            if (op.type() == Object) {
+                extractChangedNamespaces(op.Obj(), collectionNss, chunkNss);
+            }
+        }
+    }
+}
+
+void ConfigChangeListener::_listen(OperationContext* txn, Timestamp* lastSeen) {
+    ScopedDbConnection conn(grid.shardRegistry()->getConfigServerConnectionString(),
+                            kSocketTimeoutSecs);
+
+    bool missedChanges = false;
+    if (!lastSeen->isNull()) {
+        // If the entry the listener stopped at has rolled off the oplog, the changes which came
+        // after it can no longer be read.
+        const BSONObj resumeEntry = conn->findOne(
+            kOplogNs, BSON("ts" << BSON("$gte" << *lastSeen)), nullptr, QueryOption_OplogReplay);
+        if (resumeEntry["ts"].timestamp() != *lastSeen) {
+            *lastSeen = Timestamp();
+            missedChanges = true;
+        }
+    }
+
+    if (lastSeen->isNull()) {
+        const BSONObj newest = conn->findOne(kOplogNs, Query().sort(BSON("$natural" << -1)));
+        uassert(ErrorCodes::OperationFailed, "config server oplog is empty", !newest.isEmpty());
+        *lastSeen = newest["ts"].timestamp();
+    }
+
+    if (missedChanges) {
+        log() << "config server oplog no longer has the changes since the last one read, "
+              << "invalidating all cached routing information";
+        grid.catalogCache()->invalidateAll();
+        configChangeGaps.increment();
+    }
+
+    const BSONObj query = BSON("ts" << BSON("$gt" << *lastSeen) << "ns"
+                                    << BSON("$in" << BSON_ARRAY(ChunkType::ConfigNS
+                                                                << CollectionType::ConfigNS
+                                                                << kApplyOpsNs)));
+    unique_ptr<DBClientCursor> cursor =
+        conn->query(kOplogNs,
+                    query,
+                    0,
+                    0,
+                    nullptr,
+                    QueryOption_CursorTailable | QueryOption_AwaitData | QueryOption_OplogReplay);
+    uassert(ErrorCodes::HostUnreachable,
+            "could not open a cursor on the config server oplog",
+            cursor.get());
+
+    LOG(1) << "following config server changes after " << lastSeen->toStringPretty();
+
+    while (!inShutdown() && configChangeListenerEnabled) {
+        if (!cursor->more()) {
+            if (cursor->isDead()) {
+                break;
+            }
+            continue;
+        }
+
+        set<string> collectionNss;
+        set<string> chunkNss;
+        BSONObj entry;
+        do {
+            entry = cursor->nextSafe();
+            configChangeEntries.increment();
+            extractChangedNamespaces(entry, &collectionNss, &chunkNss);
+        } while (cursor->moreInCurrentBatch());
+
+        waitForMajorityCommit(conn.get(), uassertStatusOK(repl::OpTime::parseFromBSON(entry)));
+        *lastSeen = entry["ts"].timestamp();
+
+        auto catalogCache = grid.catalogCache();
+        for (const auto& ns : collectionNss) {
+            LOG(1) << "collection " << ns << " changed on the config servers";
+            catalogCache->invalidate(nsToDatabase(ns));
+            configChangeRefreshes.increment();
+        }
+
+        for (const auto& ns : chunkNss) {
+            auto config = catalogCache->getDatabaseIfCached(nsToDatabase(ns));
+            if (!config || !config->isSharded(ns)) {
+                continue;
+            }
+
+            LOG(1) << "chunks of " << ns << " changed on the config servers";
+            config->getChunkManagerIfExists(txn, ns, true);
+            configChangeRefreshes.increment();
+        }
+    }
+
+    if (cursor->isDead()) {
+        conn.done();
+    } else {
+        conn.kill();
+    }
+}
+
+}  // namespace mongo
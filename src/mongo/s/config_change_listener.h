@@ -0,0 +1,82 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <set>
+#include <string>
+
+#include "mongo/util/background.h"
+
+namespace mongo {
+
+class BSONObj;
+class OperationContext;
+class Timestamp;
+
+/**
+ * Follows the oplog of the config server replica set and refreshes the routing information
+ * this mongos has cached as soon as the chunks or the collection entries it depends on change.
+ *
+ * Without it mongos only notices that its routing table is out of date when a shard rejects a
+ * request with a stale version. The listener only shortens that window: it never loads
+ * metadata which is not already cached and the stale version checks stay authoritative.
+ *
+ * Only runs against config servers which are a replica set, and only while the
+ * configChangeListenerEnabled server parameter is set.
+ */
+class ConfigChangeListener : public BackgroundJob {
+public:
+    // BackgroundJob methods
+
+    virtual void run();
+
+    virtual std::string name() const {
+        return "ConfigChangeListener";
+    }
+
+    /**
+     * Adds to 'collectionNss' the namespaces whose config.collections entry the given config
+     * server oplog entry changes, and to 'chunkNss' the namespaces whose chunks it changes.
+     * Looks into the operations of applyOps entries. Entries which do not name the namespace
+     * they touch, such as chunk deletions, are skipped.
+     */
+    static void extractChangedNamespaces(const BSONObj& oplogEntry,
+                                         std::set<std::string>* collectionNss,
+                                         std::set<std::string>* chunkNss);
+
+private:
+    /**
+     * Tails the config server oplog from the entry after 'lastSeen' and applies the changes it
+     * reads, updating 'lastSeen' as it goes, until the cursor dies, the listener is disabled or
+     * the server shuts down. Throws DBException on network and config server errors.
+     */
+    void _listen(OperationContext* txn, Timestamp* lastSeen);
+};
+
+}  // namespace mongo
@@ -0,0 +1,115 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/config_change_listener.h"
+
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using std::set;
+using std::string;
+
+using namespace mongo;
+
+void extract(const char* oplogEntry, set<string>* collectionNss, set<string>* chunkNss) {
+    ConfigChangeListener::extractChangedNamespaces(fromjson(oplogEntry), collectionNss, chunkNss);
+}
+
+TEST(ConfigChangeListener, ChunkInsert) {
+    set<string> collectionNss;
+    set<string> chunkNss;
+    extract(
+        "{ts: Timestamp(1, 1), op: 'i', ns: 'config.chunks',"
+        " o: {_id: 'test.foo-x_MinKey', ns: 'test.foo', min: {x: {$minKey: 1}}, max: {x: 0}}}",
+        &collectionNss,
+        &chunkNss);
+    ASSERT(collectionNss.empty());
+    ASSERT(set<string>({"test.foo"}) == chunkNss);
+}
+
+TEST(ConfigChangeListener, ChunkDeleteIsSkipped) {
+    set<string> collectionNss;
+    set<string> chunkNss;
+    extract("{ts: Timestamp(1, 1), op: 'd', ns: 'config.chunks', o: {_id: 'test.foo-x_MinKey'}}",
+            &collectionNss,
+            &chunkNss);
+    ASSERT(collectionNss.empty());
+    ASSERT(chunkNss.empty());
+}
+
+TEST(ConfigChangeListener, CollectionUpdateAndDelete) {
+    set<string> collectionNss;
+    set<string> chunkNss;
+    extract(
+        "{ts: Timestamp(1, 1), op: 'u', ns: 'config.collections', o2: {_id: 'test.foo'},"
+        " o: {$set: {dropped: true}}}",
+        &collectionNss,
+        &chunkNss);
+    extract("{ts: Timestamp(1, 2), op: 'd', ns: 'config.collections', o: {_id: 'test.bar'}}",
+            &collectionNss,
+            &chunkNss);
+    ASSERT(set<string>({"test.bar", "test.foo"}) == collectionNss);
+    ASSERT(chunkNss.empty());
+}
+
+TEST(ConfigChangeListener, ApplyOps) {
+    set<string> collectionNss;
+    set<string> chunkNss;
+    extract(
+        "{ts: Timestamp(1, 1), op: 'c', ns: 'config.$cmd', o: {applyOps: ["
+        " {op: 'u', ns: 'config.chunks', o2: {_id: 'test.foo-x_MinKey'},"
+        "  o: {_id: 'test.foo-x_MinKey', ns: 'test.foo', min: {x: {$minKey: 1}}, max: {x: 0}}},"
+        " {op: 'u', ns: 'config.chunks', o2: {_id: 'test.foo-x_0.0'},"
+        "  o: {_id: 'test.foo-x_0.0', ns: 'test.foo', min: {x: 0}, max: {x: {$maxKey: 1}}}},"
+        " {op: 'u', ns: 'config.chunks', o2: {_id: 'test.bar-x_MinKey'},"
+        "  o: {_id: 'test.bar-x_MinKey', ns: 'test.bar', min: {x: {$minKey: 1}}, max: {x: 0}}}]}}",
+        &collectionNss,
+        &chunkNss);
+    ASSERT(collectionNss.empty());
+    ASSERT(set<string>({"test.bar", "test.foo"}) == chunkNss);
+}
+
+TEST(ConfigChangeListener, OtherNamespacesAreSkipped) {
+    set<string> collectionNss;
+    set<string> chunkNss;
+    extract(
+        "{ts: Timestamp(1, 1), op: 'i', ns: 'config.changelog', o: {_id: 'a', ns: 'test.foo'}}",
+        &collectionNss,
+        &chunkNss);
+    extract("{ts: Timestamp(1, 2), op: 'c', ns: 'config.$cmd', o: {create: 'tags'}}",
+            &collectionNss,
+            &chunkNss);
+    ASSERT(collectionNss.empty());
+    ASSERT(chunkNss.empty());
+}
+
+}  // namespace
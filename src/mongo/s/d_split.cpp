@@ -30,6 +30,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <vector>
@@ -48,8 +49,10 @@
 #include "mongo/db/instance.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/s/collection_metadata.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/storage/record_store.h"
 #include "mongo/s/catalog/catalog_manager.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/chunk.h"
@@ -215,6 +218,103 @@ BSONObj prettyKey(const BSONObj& keyPattern, const BSONObj& key) {
     return key.replaceFieldNames(keyPattern).clientReadable();
 }
 
+// If positive, splitVector estimates split points from this many randomly sampled documents of the
+// chunk instead of scanning the shard key index, when the storage engine supports random cursors.
+MONGO_EXPORT_SERVER_PARAMETER(splitVectorSampleSize, int, 0);
+
+// The longest time splitVector spends sampling before it falls back to scanning the index.
+MONGO_EXPORT_SERVER_PARAMETER(splitVectorSampleMaxMillis, int, 1000);
+
+namespace {
+
+// Sampling gives up once it has looked at this many documents per requested sample without
+// collecting enough of them from the chunk, for instance when the chunk is a tiny part of the
+// collection.
+const long long kMaxSampledDocsPerSample = 20;
+
+// The fewest sampled documents from the chunk with which we trust the estimated split points.
+const size_t kMinSampledChunkDocs = 10;
+
+/**
+ * Estimates split points for the chunk [min, max) of 'collection' from a random sample of its
+ * documents, so that each new chunk holds about 'keyCount' documents. An empty 'min' or 'max'
+ * leaves that end of the range open.
+ *
+ * Returns false, leaving 'splitKeys' untouched, if the storage engine cannot sample or too few of
+ * the sampled documents fell in the chunk. The caller should then scan the index.
+ */
+bool sampleSplitKeys(OperationContext* txn,
+                     Collection* collection,
+                     const ShardKeyPattern& shardKeyPattern,
+                     const BSONObj& min,
+                     const BSONObj& max,
+                     long long keyCount,
+                     long long maxSplitPoints,
+                     vector<BSONObj>* splitKeys) {
+    auto cursor = collection->getRecordStore()->getRandomCursor(txn);
+    if (!cursor) {
+        return false;
+    }
+
+    const size_t sampleSize = splitVectorSampleSize;
+    const long long maxSampledDocs = kMaxSampledDocsPerSample * sampleSize;
+
+    Timer timer;
+    long long numSampledDocs = 0;
+    vector<BSONObj> chunkKeys;
+    while (chunkKeys.size() < sampleSize && numSampledDocs < maxSampledDocs &&
+           timer.millis() < splitVectorSampleMaxMillis) {
+        auto record = cursor->next();
+        if (!record) {
+            break;
+        }
+        ++numSampledDocs;
+
+        BSONObj key = shardKeyPattern.extractShardKeyFromDoc(record->data.toBson());
+        if (key.isEmpty() || (!min.isEmpty() && key.woCompare(min, BSONObj(), false) < 0) ||
+            (!max.isEmpty() && key.woCompare(max, BSONObj(), false) >= 0)) {
+            continue;
+        }
+        chunkKeys.push_back(key.getOwned());
+    }
+
+    if (chunkKeys.size() < kMinSampledChunkDocs) {
+        LOG(1) << "only " << chunkKeys.size() << " of " << numSampledDocs
+               << " sampled documents fell in the chunk, scanning the index for split points";
+        return false;
+    }
+
+    // The chunk holds about the same fraction of the collection as it did of the sample.
+    const long long estimatedChunkDocs =
+        collection->numRecords(txn) * chunkKeys.size() / numSampledDocs;
+    long long numSplitPoints = estimatedChunkDocs / keyCount;
+    if (maxSplitPoints && numSplitPoints > maxSplitPoints) {
+        numSplitPoints = maxSplitPoints;
+    }
+
+    std::sort(chunkKeys.begin(), chunkKeys.end(), [](const BSONObj& lhs, const BSONObj& rhs) {
+        return lhs.woCompare(rhs, BSONObj(), false) < 0;
+    });
+
+    // Split at evenly spaced quantiles of the sample, skipping keys equal to the chunk's lower
+    // bound or to the previous split point, as all the documents of a key must stay together.
+    for (long long i = 1; i <= numSplitPoints; ++i) {
+        const BSONObj& key = chunkKeys[i * chunkKeys.size() / (numSplitPoints + 1)];
+        if ((!min.isEmpty() && key.woCompare(min, BSONObj(), false) == 0) ||
+            (!splitKeys->empty() && key.woCompare(splitKeys->back(), BSONObj(), false) == 0)) {
+            continue;
+        }
+        splitKeys->push_back(key);
+    }
+
+    log() << "estimated " << splitKeys->size() << " split points for " << estimatedChunkDocs
+          << " documents from " << chunkKeys.size() << " of " << numSampledDocs
+          << " sampled documents in " << timer.millis() << "ms";
+    return true;
+}
+
+}  // namespace
+
 class SplitVector : public Command {
 public:
     SplitVector() : Command("splitVector", false) {}
@@ -279,6 +379,8 @@ public:
             errmsg = "either provide both min and max or leave both empty";
             return false;
         }
+        const BSONObj shardKeyMin = min;
+        const BSONObj shardKeyMax = max;
 
         long long maxSplitPoints = 0;
         BSONElement maxSplitPointsElem = jsobj["maxSplitPoints"];
@@ -388,6 +490,24 @@ public:
                 keyCount = maxChunkObjects;
             }
 
+            // Estimate the split points from a sample of the chunk if asked to, unless we must find
+            // the exact median.
+            const ShardKeyPattern shardKeyPattern(keyPattern);
+            if (splitVectorSampleSize > 0 && keyCount > 0 && !forceMedianSplit &&
+                shardKeyPattern.isValid() &&
+                sampleSplitKeys(txn,
+                                collection,
+                                shardKeyPattern,
+                                shardKeyMin,
+                                shardKeyMax,
+                                keyCount,
+                                maxSplitPoints,
+                                &splitKeys)) {
+                result.append("sampled", true);
+                result.append("splitKeys", splitKeys);
+                return true;
+            }
+
             //
             // 2. Traverse the index and add the keyCount-th key to the result vector. If that key
             //    appeared in the vector before, we omit it. The invariant here is that all the
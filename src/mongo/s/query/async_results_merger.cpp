@@ -32,10 +32,16 @@
 
 #include "mongo/s/query/async_results_merger.h"
 
+#include <algorithm>
+
+#include "mongo/base/counter.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/killcursors_request.h"
 #include "mongo/executor/remote_command_request.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/rpc/metadata/server_selection_metadata.h"
 #include "mongo/util/assert_util.h"
@@ -43,11 +49,60 @@
 
 namespace mongo {
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryMergerMaxBufferedBytesPerRemote, int, 0);
+
+namespace {
+
+// The number of bytes of documents and sort keys held by all merging cursors, and the number of
+// getMores whose batch size was reduced to bound that.
+Counter64 mergerBufferedBytes;
+ServerStatusMetricField<Counter64> displayMergerBufferedBytes("cursor.merger.bufferedBytes",
+                                                              &mergerBufferedBytes);
+Counter64 mergerFlowControlledGetMores;
+ServerStatusMetricField<Counter64> displayMergerFlowControlledGetMores(
+    "cursor.merger.flowControlledGetMores", &mergerFlowControlledGetMores);
+
+// The number of hedged copies of the command establishing a remote cursor that were sent, and how
+// many of them replied before the original request.
+Counter64 mergerHedgesIssued;
+ServerStatusMetricField<Counter64> displayMergerHedgesIssued("cursor.merger.hedgesIssued",
+                                                             &mergerHedgesIssued);
+Counter64 mergerHedgesWon;
+ServerStatusMetricField<Counter64> displayMergerHedgesWon("cursor.merger.hedgesWon",
+                                                          &mergerHedgesWon);
+
+// An Ordering can hold the direction of at most this many sort fields.
+const int kMaxEncodedSortKeyFields = 32;
+
+boost::optional<Ordering> makeSortKeyOrdering(const BSONObj& sort) {
+    if (sort.isEmpty() || sort.nFields() > kMaxEncodedSortKeyFields) {
+        return boost::none;
+    }
+    return Ordering::make(sort);
+}
+
+/**
+ * Encodes the values of 'sortKey' as a KeyString in 'ordering'. Field names are dropped, as the
+ * sort key is compared by position just like woCompare() does with considerFieldName false.
+ */
+std::string encodeSortKey(const BSONObj& sortKey, Ordering ordering) {
+    BSONObjBuilder values;
+    for (const auto& elem : sortKey) {
+        values.appendAs(elem, "");
+    }
+    KeyString key(values.done(), ordering);
+    return std::string(key.getBuffer(), key.getSize());
+}
+
+}  // namespace
+
 AsyncResultsMerger::AsyncResultsMerger(executor::TaskExecutor* executor,
                                        ClusterClientCursorParams params)
     : _executor(executor),
       _params(std::move(params)),
-      _mergeQueue(MergingComparator(_remotes, _params.sort)) {
+      _sortKeyOrdering(makeSortKeyOrdering(_params.sort)),
+      _mergeQueue(MergingComparator(
+          _remotes, _params.sort, static_cast<bool>(_sortKeyOrdering))) {
     for (const auto& remote : _params.remotes) {
         _remotes.emplace_back(remote);
     }
@@ -67,9 +122,13 @@ AsyncResultsMerger::~AsyncResultsMerger() {
         if (!remote.exhausted()) {
             allExhausted = false;
         }
+        mergerBufferedBytes.decrement(remote.bufferedBytes);
     }
 
-    invariant(allExhausted || _lifecycleState == kKillComplete);
+    // A hedged request which lost the race may still be outstanding after all remotes are
+    // exhausted, in which case the ARM must be killed before it is deleted.
+    invariant((allExhausted && !haveOutstandingBatchRequests_inlock()) ||
+              _lifecycleState == kKillComplete);
 }
 
 bool AsyncResultsMerger::ready() {
@@ -152,7 +211,11 @@ StatusWith<boost::optional<BSONObj>> AsyncResultsMerger::nextReady() {
     }
 
     const bool hasSort = !_params.sort.isEmpty();
-    return hasSort ? nextReadySorted() : nextReadyUnsorted();
+    auto next = hasSort ? nextReadySorted() : nextReadyUnsorted();
+    if (next) {
+        ++_numReturned;
+    }
+    return {std::move(next)};
 }
 
 boost::optional<BSONObj> AsyncResultsMerger::nextReadySorted() {
@@ -169,8 +232,9 @@ boost::optional<BSONObj> AsyncResultsMerger::nextReadySorted() {
     invariant(!_remotes[smallestRemote].docBuffer.empty());
     invariant(_remotes[smallestRemote].status.isOK());
 
-    BSONObj front = _remotes[smallestRemote].docBuffer.front();
-    _remotes[smallestRemote].docBuffer.pop();
+    const long long bufferedBefore = _remotes[smallestRemote].bufferedBytes;
+    BSONObj front = _remotes[smallestRemote].pop();
+    mergerBufferedBytes.decrement(bufferedBefore - _remotes[smallestRemote].bufferedBytes);
 
     // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
     // next result.
@@ -188,8 +252,10 @@ boost::optional<BSONObj> AsyncResultsMerger::nextReadyUnsorted() {
         invariant(_remotes[_gettingFromRemote].status.isOK());
 
         if (_remotes[_gettingFromRemote].hasNext()) {
-            BSONObj front = _remotes[_gettingFromRemote].docBuffer.front();
-            _remotes[_gettingFromRemote].docBuffer.pop();
+            const long long bufferedBefore = _remotes[_gettingFromRemote].bufferedBytes;
+            BSONObj front = _remotes[_gettingFromRemote].pop();
+            mergerBufferedBytes.decrement(bufferedBefore -
+                                          _remotes[_gettingFromRemote].bufferedBytes);
 
             if (_params.isTailable && !_remotes[_gettingFromRemote].hasNext()) {
                 // The cursor is tailable and we're about to return the last buffered result. This
@@ -228,6 +294,28 @@ Status AsyncResultsMerger::askForNextBatch_inlock(size_t remoteIndex) {
         remote.fetchedCount = 0;
     }
 
+    // Bound the size of the batch we will have to buffer for this remote. Until the remote has
+    // returned some documents we have no idea of their size, so the first batch is not bounded.
+    const long long maxBufferedBytes = internalQueryMergerMaxBufferedBytesPerRemote;
+    const long long avgObjSize = remote.avgObjSize();
+    if (remote.cursorId && maxBufferedBytes > 0 && avgObjSize > 0) {
+        const long long maxBatchSize = std::max(1LL, maxBufferedBytes / avgObjSize);
+        if (!adjustedBatchSize || *adjustedBatchSize > maxBatchSize) {
+            adjustedBatchSize = maxBatchSize;
+            mergerFlowControlledGetMores.increment();
+        }
+    }
+
+    // Nor does the remote have to supply more documents than the merged stream still needs, as
+    // its buffer is empty whenever we ask it for more.
+    const auto numRemaining = numRemainingToReturn_inlock();
+    if (remote.cursorId && numRemaining) {
+        const long long maxBatchSize = std::max(1LL, *numRemaining);
+        if (!adjustedBatchSize || *adjustedBatchSize > maxBatchSize) {
+            adjustedBatchSize = maxBatchSize;
+        }
+    }
+
     BSONObj cmdObj = remote.cursorId
         ? GetMoreRequest(_params.nsString, *remote.cursorId, adjustedBatchSize, boost::none)
               .toBSON()
@@ -245,9 +333,86 @@ Status AsyncResultsMerger::askForNextBatch_inlock(size_t remoteIndex) {
     }
 
     remote.cbHandle = callbackStatus.getValue();
+
+    // If the remote is slow to establish the cursor, we will also send the command to its hedge
+    // host. Failing to schedule the timer only means that we do not hedge.
+    if (remote.cmdObj && remote.hedgeHostAndPort && _params.hedgeDelay > Milliseconds(0) &&
+        !remote.hedgeTimerHandle.isValid() && !remote.hedgeCbHandle.isValid()) {
+        auto timerStatus = _executor->scheduleWorkAt(
+            _executor->now() + _params.hedgeDelay,
+            stdx::bind(
+                &AsyncResultsMerger::handleHedgeTimer, this, stdx::placeholders::_1, remoteIndex));
+        if (timerStatus.isOK()) {
+            remote.hedgeTimerHandle = timerStatus.getValue();
+        }
+    }
+
     return Status::OK();
 }
 
+void AsyncResultsMerger::handleHedgeTimer(const executor::TaskExecutor::CallbackArgs& cbData,
+                                          size_t remoteIndex) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    auto& remote = _remotes[remoteIndex];
+    remote.hedgeTimerHandle = executor::TaskExecutor::CallbackHandle();
+
+    if (_lifecycleState != kAlive) {
+        completeKillIfReady_inlock();
+        return;
+    }
+
+    // Nothing to do if the timer was canceled, or if the remote has replied in the meantime.
+    if (!cbData.status.isOK() || !remote.cmdObj || !remote.cbHandle.isValid()) {
+        return;
+    }
+
+    executor::RemoteCommandRequest request(
+        *remote.hedgeHostAndPort, _params.nsString.db().toString(), *remote.cmdObj, _metadataObj);
+
+    auto callbackStatus = _executor->scheduleRemoteCommand(
+        request,
+        stdx::bind(
+            &AsyncResultsMerger::handleBatchResponse, this, stdx::placeholders::_1, remoteIndex));
+    if (!callbackStatus.isOK()) {
+        // We still have the original request to wait for.
+        return;
+    }
+
+    remote.hedgeCbHandle = callbackStatus.getValue();
+    mergerHedgesIssued.increment();
+}
+
+void AsyncResultsMerger::killHedgeLoserCursor_inlock(
+    const executor::TaskExecutor::RemoteCommandCallbackArgs& cbData) {
+    if (!cbData.response.isOK()) {
+        return;
+    }
+
+    auto cursorResponse = CursorResponse::parseFromBSON(cbData.response.getValue().data);
+    if (!cursorResponse.isOK() || cursorResponse.getValue().cursorId == 0) {
+        return;
+    }
+
+    BSONObj cmdObj =
+        KillCursorsRequest(_params.nsString, {cursorResponse.getValue().cursorId}).toBSON();
+
+    executor::RemoteCommandRequest request(
+        cbData.request.target, _params.nsString.db().toString(), cmdObj);
+
+    _executor->scheduleRemoteCommand(
+        request,
+        stdx::bind(&AsyncResultsMerger::handleKillCursorsResponse, stdx::placeholders::_1));
+}
+
+boost::optional<long long> AsyncResultsMerger::numRemainingToReturn_inlock() const {
+    if (!_params.limit) {
+        return boost::none;
+    }
+    const long long total = *_params.limit + _params.skip.value_or(0);
+    return std::max(0LL, total - _numReturned);
+}
+
 StatusWith<executor::TaskExecutor::EventHandle> AsyncResultsMerger::nextEvent() {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
 
@@ -304,50 +469,83 @@ void AsyncResultsMerger::handleBatchResponse(
     auto& remote = _remotes[remoteIndex];
 
     // Clear the callback handle. This indicates that we are no longer waiting on a response from
-    // 'remote'.
-    remote.cbHandle = executor::TaskExecutor::CallbackHandle();
+    // 'remote'. The response to a hedged copy of the command establishing the cursor comes back
+    // under 'hedgeCbHandle' instead.
+    const bool isHedgeResponse =
+        remote.hedgeCbHandle.isValid() && cbData.myHandle == remote.hedgeCbHandle;
+    if (isHedgeResponse) {
+        remote.hedgeCbHandle = executor::TaskExecutor::CallbackHandle();
+    } else {
+        remote.cbHandle = executor::TaskExecutor::CallbackHandle();
+    }
+
+    // The other request has already established the cursor, so this one lost the race.
+    if (isHedgeResponse && !remote.cmdObj) {
+        killHedgeLoserCursor_inlock(cbData);
+        if (_lifecycleState != kAlive) {
+            completeKillIfReady_inlock();
+        }
+        return;
+    }
 
     // If we're in the process of shutting down then there's no need to process the batch.
     if (_lifecycleState != kAlive) {
-        invariant(_lifecycleState == kKillStarted);
-
-        // Make sure to wake up anyone waiting on '_currentEvent' if we're shutting down.
-        signalCurrentEventIfReady_inlock();
-
-        // If we're killed and we're not waiting on any more batches to come back, then we are ready
-        // to kill the cursors on the remote hosts and clean up this cursor. Schedule the
-        // killCursors command and signal that this cursor is safe now safe to destroy. We have to
-        // promise not to touch any members of this class because 'this' could become invalid as
-        // soon as we signal the event.
-        if (!haveOutstandingBatchRequests_inlock()) {
-            // If the event handle is invalid, then the executor is in the middle of shutting down,
-            // and we can't schedule any more work for it to complete.
-            if (_killCursorsScheduledEvent.isValid()) {
-                scheduleKillCursors_inlock();
-                _executor->signalEvent(_killCursorsScheduledEvent);
-            }
-
-            _lifecycleState = kKillComplete;
-        }
+        completeKillIfReady_inlock();
         return;
     }
 
     // Early return from this point on signal anyone waiting on an event, if ready() is true.
     ScopeGuard signaller = MakeGuard(&AsyncResultsMerger::signalCurrentEventIfReady_inlock, this);
 
+    // While both copies of the command establishing the cursor are outstanding, an error from one
+    // of them only means that we wait for the other, which from now on is the remote's request.
+    const bool otherRequestOutstanding = remote.cmdObj &&
+        (isHedgeResponse ? remote.cbHandle.isValid() : remote.hedgeCbHandle.isValid());
+    auto waitForOtherRequest = [&]() {
+        if (!isHedgeResponse) {
+            std::swap(remote.cbHandle, remote.hedgeCbHandle);
+        }
+    };
+
     if (!cbData.response.isOK()) {
-        remote.status = cbData.response.getStatus();
+        if (otherRequestOutstanding) {
+            waitForOtherRequest();
+        } else {
+            remote.status = cbData.response.getStatus();
+        }
         return;
     }
 
     auto getMoreParseStatus = CursorResponse::parseFromBSON(cbData.response.getValue().data);
     if (!getMoreParseStatus.isOK()) {
-        remote.status = getMoreParseStatus.getStatus();
+        if (otherRequestOutstanding) {
+            waitForOtherRequest();
+        } else {
+            remote.status = getMoreParseStatus.getStatus();
+        }
         return;
     }
 
     auto cursorResponse = getMoreParseStatus.getValue();
 
+    if (remote.cmdObj) {
+        // This response establishes the cursor. If it is the hedged request's, the getMores go to
+        // the hedge host, and the original request becomes the one which lost the race.
+        if (isHedgeResponse) {
+            std::swap(remote.cbHandle, remote.hedgeCbHandle);
+        }
+        if (cbData.request.target != remote.hostAndPort) {
+            remote.hostAndPort = cbData.request.target;
+            mergerHedgesWon.increment();
+        }
+
+        // Stop the timer if the hedge has not been sent yet. A request which lost the race is left
+        // to complete, so that the cursor it may open is killed rather than left to time out.
+        if (remote.hedgeTimerHandle.isValid()) {
+            _executor->cancel(remote.hedgeTimerHandle);
+        }
+    }
+
     // If we have a cursor established, and we get a non-zero cursorid that is not equal to the
     // established cursorid, we will fail the operation.
     if (remote.cursorId && cursorResponse.cursorId != 0 &&
@@ -372,7 +570,13 @@ void AsyncResultsMerger::handleBatchResponse(
             return;
         }
 
-        remote.docBuffer.push(obj);
+        const long long bufferedBefore = remote.bufferedBytes;
+        remote.push(obj,
+                    _sortKeyOrdering
+                        ? encodeSortKey(obj[ClusterClientCursorParams::kSortKeyField].Obj(),
+                                        *_sortKeyOrdering)
+                        : std::string());
+        mergerBufferedBytes.increment(remote.bufferedBytes - bufferedBefore);
         ++remote.fetchedCount;
     }
 
@@ -407,6 +611,29 @@ void AsyncResultsMerger::handleBatchResponse(
     signalCurrentEventIfReady_inlock();
 }
 
+void AsyncResultsMerger::completeKillIfReady_inlock() {
+    invariant(_lifecycleState == kKillStarted);
+
+    // Make sure to wake up anyone waiting on '_currentEvent' if we're shutting down.
+    signalCurrentEventIfReady_inlock();
+
+    // If we're killed and we're not waiting on any more batches to come back, then we are ready
+    // to kill the cursors on the remote hosts and clean up this cursor. Schedule the
+    // killCursors command and signal that this cursor is safe now safe to destroy. We have to
+    // promise not to touch any members of this class because 'this' could become invalid as
+    // soon as we signal the event.
+    if (!haveOutstandingBatchRequests_inlock()) {
+        // If the event handle is invalid, then the executor is in the middle of shutting down,
+        // and we can't schedule any more work for it to complete.
+        if (_killCursorsScheduledEvent.isValid()) {
+            scheduleKillCursors_inlock();
+            _executor->signalEvent(_killCursorsScheduledEvent);
+        }
+
+        _lifecycleState = kKillComplete;
+    }
+}
+
 void AsyncResultsMerger::signalCurrentEventIfReady_inlock() {
     if (ready_inlock() && _currentEvent.isValid()) {
         // To prevent ourselves from signalling the event twice, we set '_currentEvent' as
@@ -418,7 +645,8 @@ void AsyncResultsMerger::signalCurrentEventIfReady_inlock() {
 
 bool AsyncResultsMerger::haveOutstandingBatchRequests_inlock() {
     for (const auto& remote : _remotes) {
-        if (remote.cbHandle.isValid()) {
+        if (remote.cbHandle.isValid() || remote.hedgeCbHandle.isValid() ||
+            remote.hedgeTimerHandle.isValid()) {
             return true;
         }
     }
@@ -465,6 +693,12 @@ executor::TaskExecutor::EventHandle AsyncResultsMerger::kill() {
         if (remote.cbHandle.isValid()) {
             _executor->cancel(remote.cbHandle);
         }
+        if (remote.hedgeCbHandle.isValid()) {
+            _executor->cancel(remote.hedgeCbHandle);
+        }
+        if (remote.hedgeTimerHandle.isValid()) {
+            _executor->cancel(remote.hedgeTimerHandle);
+        }
     }
 
     // Make '_killCursorsScheduledEvent', which we will signal as soon as we have scheduled a
@@ -498,9 +732,44 @@ executor::TaskExecutor::EventHandle AsyncResultsMerger::kill() {
 
 AsyncResultsMerger::RemoteCursorData::RemoteCursorData(
     const ClusterClientCursorParams::Remote& params)
-    : hostAndPort(params.hostAndPort), cmdObj(params.cmdObj), cursorId(params.cursorId) {
+    : hostAndPort(params.hostAndPort),
+      cmdObj(params.cmdObj),
+      cursorId(params.cursorId),
+      hedgeHostAndPort(params.hedgeHostAndPort) {
     // Either cmdObj or cursorId can be provided, but not both.
     invariant(static_cast<bool>(cmdObj) != static_cast<bool>(cursorId));
+
+    // Only the command establishing a cursor can be hedged.
+    invariant(!hedgeHostAndPort || cmdObj);
+}
+
+void AsyncResultsMerger::RemoteCursorData::push(BSONObj obj, std::string encodedSortKey) {
+    ++receivedCount;
+    receivedBytes += obj.objsize();
+    bufferedBytes += obj.objsize();
+    docBuffer.push(std::move(obj));
+
+    if (!encodedSortKey.empty()) {
+        bufferedBytes += encodedSortKey.size();
+        sortKeyBuffer.push(std::move(encodedSortKey));
+    }
+}
+
+BSONObj AsyncResultsMerger::RemoteCursorData::pop() {
+    BSONObj front = std::move(docBuffer.front());
+    docBuffer.pop();
+    bufferedBytes -= front.objsize();
+
+    if (!sortKeyBuffer.empty()) {
+        bufferedBytes -= sortKeyBuffer.front().size();
+        sortKeyBuffer.pop();
+    }
+
+    return front;
+}
+
+long long AsyncResultsMerger::RemoteCursorData::avgObjSize() const {
+    return receivedCount ? receivedBytes / receivedCount : 0;
 }
 
 bool AsyncResultsMerger::RemoteCursorData::hasNext() const {
@@ -516,6 +785,10 @@ bool AsyncResultsMerger::RemoteCursorData::exhausted() const {
 //
 
 bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
+    if (_compareEncodedKeys) {
+        return _remotes[lhs].sortKeyBuffer.front() > _remotes[rhs].sortKeyBuffer.front();
+    }
+
     const BSONObj& leftDoc = _remotes[lhs].docBuffer.front();
     const BSONObj& rightDoc = _remotes[rhs].docBuffer.front();
 
@@ -30,11 +30,13 @@
 
 #include <boost/optional.hpp>
 #include <queue>
+#include <string>
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
 #include "mongo/db/cursor_id.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/s/query/cluster_client_cursor_params.h"
@@ -43,6 +45,11 @@
 
 namespace mongo {
 
+// If positive, the getMores sent by an AsyncResultsMerger ask each remote for no more documents
+// than should fit in this many bytes, judging by the average size of the documents it returned so
+// far.
+extern int internalQueryMergerMaxBufferedBytesPerRemote;
+
 /**
  * AsyncResultsMerger is used to generate results from cursor-generating commands on one or more
  * remote hosts. A cursor-generating command (e.g. the find command) is one that establishes a
@@ -61,6 +68,12 @@ namespace mongo {
  * This requires waiting until we have a response from every remote before returning results.
  * Without a sort, we are ready to return results as soon as we have *any* response from a remote.
  *
+ * For a sorted merge, the sort key of each buffered document is encoded as a KeyString when the
+ * document arrives, so that the merge compares keys by their bytes. The getMores sent to each
+ * remote are sized so that the batch buffered for it stays within
+ * internalQueryMergerMaxBufferedBytesPerRemote, if that is set. If there is a limit, no getMore
+ * asks a remote for more documents than the merged stream still needs to return.
+ *
  * On any error, the caller is responsible for shutting down the ARM using the kill() method.
  *
  * Does not throw exceptions.
@@ -179,10 +192,46 @@ private:
         // established but is now exhausted, this member will be set to zero.
         boost::optional<CursorId> cursorId;
 
+        /**
+         * Buffers 'obj', along with 'encodedSortKey' if the merge compares encoded sort keys.
+         */
+        void push(BSONObj obj, std::string encodedSortKey);
+
+        /**
+         * Removes the document at the front of the buffer and returns it.
+         */
+        BSONObj pop();
+
+        /**
+         * Returns the average size of the documents received from this remote so far, or zero if
+         * none have been received.
+         */
+        long long avgObjSize() const;
+
         std::queue<BSONObj> docBuffer;
+
+        // The KeyString-encoded sort keys of the documents in 'docBuffer', in the same order. Empty
+        // if there is no sort or the sort keys are compared as BSON.
+        std::queue<std::string> sortKeyBuffer;
+
+        // Size in bytes of the documents and sort keys currently buffered for this remote.
+        long long bufferedBytes = 0;
+
+        // Count and total size of all documents received from this remote.
+        long long receivedCount = 0;
+        long long receivedBytes = 0;
+
         executor::TaskExecutor::CallbackHandle cbHandle;
         Status status = Status::OK();
 
+        // Another host to send 'cmdObj' to if 'hostAndPort' has not replied after the hedge delay,
+        // and the handles of the timer that sends it and of the hedged request. Whichever of the
+        // two requests replies first establishes the cursor. From then on 'hedgeCbHandle' is the
+        // handle of the request that lost, if it is still outstanding.
+        boost::optional<HostAndPort> hedgeHostAndPort;
+        executor::TaskExecutor::CallbackHandle hedgeTimerHandle;
+        executor::TaskExecutor::CallbackHandle hedgeCbHandle;
+
         // Count of fetched docs during ARM processing of the current batch. Used to reduce the
         // batchSize in getMore when mongod returned less docs than the requested batchSize.
         long long fetchedCount = 0;
@@ -190,8 +239,10 @@ private:
 
     class MergingComparator {
     public:
-        MergingComparator(const std::vector<RemoteCursorData>& remotes, const BSONObj& sort)
-            : _remotes(remotes), _sort(sort) {}
+        MergingComparator(const std::vector<RemoteCursorData>& remotes,
+                          const BSONObj& sort,
+                          bool compareEncodedKeys)
+            : _remotes(remotes), _sort(sort), _compareEncodedKeys(compareEncodedKeys) {}
 
         bool operator()(const size_t& lhs, const size_t& rhs);
 
@@ -199,6 +250,9 @@ private:
         const std::vector<RemoteCursorData>& _remotes;
 
         const BSONObj& _sort;
+
+        // Whether to compare the KeyString-encoded sort keys rather than the BSON ones.
+        const bool _compareEncodedKeys;
     };
 
     enum LifecycleState { kAlive, kKillStarted, kKillComplete };
@@ -219,6 +273,12 @@ private:
      */
     Status askForNextBatch_inlock(size_t remoteIndex);
 
+    /**
+     * Returns how many more documents this ARM has to return to satisfy the limit and skip, or
+     * boost::none if there is no limit.
+     */
+    boost::optional<long long> numRemainingToReturn_inlock() const;
+
     //
     // Helpers for ready().
     //
@@ -245,6 +305,26 @@ private:
     void handleBatchResponse(const executor::TaskExecutor::RemoteCommandCallbackArgs& cbData,
                              size_t remoteIndex);
 
+    /**
+     * Callback run once the hedge delay has passed since the command establishing the cursor was
+     * sent to the remote at 'remoteIndex'. Sends the command to the remote's hedge host as well if
+     * there is still no reply.
+     */
+    void handleHedgeTimer(const executor::TaskExecutor::CallbackArgs& cbData, size_t remoteIndex);
+
+    /**
+     * Schedules a killCursors command for the cursor opened by a hedged request which lost the
+     * race to establish the cursor, if its response has any.
+     */
+    void killHedgeLoserCursor_inlock(
+        const executor::TaskExecutor::RemoteCommandCallbackArgs& cbData);
+
+    /**
+     * Called by the callbacks that run while the ARM is being killed. Once no callback is
+     * outstanding, schedules the killCursors commands and marks the kill as complete.
+     */
+    void completeKillIfReady_inlock();
+
     /**
      * If there is a valid unsignaled event that has been requested via nextReady() and there are
      * buffered results that are ready to return, signals that event.
@@ -269,6 +349,11 @@ private:
 
     ClusterClientCursorParams _params;
 
+    // The ordering used to encode the sort keys of buffered documents. Unset if there is no sort,
+    // or if the sort has too many fields for an Ordering, in which case the BSON sort keys are
+    // compared directly.
+    boost::optional<Ordering> _sortKeyOrdering;
+
     // The metadata obj to pass along with the command request. Used to indicate that the command is
     // ok to run on secondaries.
     BSONObj _metadataObj;
@@ -288,6 +373,9 @@ private:
     // Used only if there is *not* a sort.
     size_t _gettingFromRemote = 0;
 
+    // The number of documents returned from nextReady().
+    long long _numReturned = 0;
+
     Status _status = Status::OK();
 
     executor::TaskExecutor::EventHandle _currentEvent;
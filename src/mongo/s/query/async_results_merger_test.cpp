@@ -39,6 +39,7 @@
 #include "mongo/executor/thread_pool_task_executor_test_fixture.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -174,6 +175,51 @@ protected:
         net->exitNetwork();
     }
 
+    /**
+     * Runs the mock network forward by 'millis', which fires the timers due by then.
+     */
+    void advanceTime(Milliseconds millis) {
+        executor::NetworkInterfaceMock* net = getNet();
+        net->enterNetwork();
+        net->runUntil(net->now() + millis);
+        net->exitNetwork();
+    }
+
+    /**
+     * Schedules the next ready request to fail with 'status', or to be answered with 'obj', after
+     * checking that it is sent to 'target'.
+     */
+    void scheduleResponseFrom(const HostAndPort& target, StatusWith<BSONObj> objOrStatus) {
+        executor::NetworkInterfaceMock* net = getNet();
+        net->enterNetwork();
+        ASSERT_TRUE(net->hasReadyRequests());
+        auto noi = net->getNextReadyRequest();
+        ASSERT_EQ(target, noi->getRequest().target);
+        if (objOrStatus.isOK()) {
+            RemoteCommandResponse response(objOrStatus.getValue(), BSONObj(), Milliseconds(0));
+            net->scheduleResponse(
+                noi, net->now(), executor::TaskExecutor::ResponseStatus(response));
+        } else {
+            net->scheduleResponse(noi, net->now(), objOrStatus.getStatus());
+        }
+        net->runReadyNetworkOperations();
+        net->exitNetwork();
+    }
+
+    /**
+     * Constructs an ARM over a single remote, '_remotes[0]', whose find command is hedged to
+     * '_remotes[1]' after 'hedgeDelay'.
+     */
+    void makeHedgedCursor(const BSONObj& findCmd, Milliseconds hedgeDelay) {
+        params = ClusterClientCursorParams(_nss);
+        params.isSecondaryOk = true;
+        params.hedgeDelay = hedgeDelay;
+        params.remotes.emplace_back(_remotes[0], findCmd);
+        params.remotes.back().hedgeHostAndPort = _remotes[1];
+
+        arm = stdx::make_unique<AsyncResultsMerger>(executor, params);
+    }
+
     const NamespaceString _nss;
     const std::vector<HostAndPort> _remotes;
 
@@ -969,6 +1015,90 @@ TEST_F(AsyncResultsMergerTest, GetMoreBatchSizes) {
     ASSERT(!unittest::assertGet(arm->nextReady()));
 }
 
+TEST_F(AsyncResultsMergerTest, GetMoreBatchSizeBoundedByMaxBufferedBytes) {
+    const int oldMaxBufferedBytes = internalQueryMergerMaxBufferedBytesPerRemote;
+    ON_BLOCK_EXIT([&] { internalQueryMergerMaxBufferedBytesPerRemote = oldMaxBufferedBytes; });
+
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}, batchSize: 2}");
+    makeCursorFromFindCmd(findCmd, {_remotes[0]}, 100LL);
+
+    ASSERT_FALSE(arm->ready());
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    ASSERT_FALSE(arm->ready());
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{_id: 1, $sortKey: {'': 1}}"),
+                                   fromjson("{_id: 2, $sortKey: {'': 2}}")};
+    responses.emplace_back(_nss, CursorId(1), batch1);
+    scheduleNetworkResponses(responses, CursorResponse::ResponseType::InitialResponse);
+    executor->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 1, $sortKey: {'': 1}}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 2, $sortKey: {'': 2}}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_FALSE(arm->ready());
+
+    // Only three documents of the size received so far fit in the buffer.
+    internalQueryMergerMaxBufferedBytesPerRemote = 3 * batch1[0].objsize();
+    readyEvent = unittest::assertGet(arm->nextEvent());
+
+    BSONObj scheduledCmd = getFirstPendingRequest().cmdObj;
+    auto request = GetMoreRequest::parseFromBSON("anydbname", scheduledCmd);
+    ASSERT_OK(request.getStatus());
+    ASSERT_EQ(*request.getValue().batchSize, 3LL);
+
+    responses.clear();
+    std::vector<BSONObj> batch2 = {fromjson("{_id: 3, $sortKey: {'': 3}}")};
+    responses.emplace_back(_nss, CursorId(0), batch2);
+    scheduleNetworkResponses(responses, CursorResponse::ResponseType::SubsequentResponse);
+    executor->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 3, $sortKey: {'': 3}}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_TRUE(arm->ready());
+    ASSERT(!unittest::assertGet(arm->nextReady()));
+}
+
+TEST_F(AsyncResultsMergerTest, GetMoreBatchSizeBoundedByLimit) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', skip: 1, limit: 5, batchSize: 2}");
+    makeCursorFromFindCmd(findCmd, {_remotes[0]}, 10LL);
+
+    ASSERT_FALSE(arm->ready());
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    ASSERT_FALSE(arm->ready());
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{_id: 1}"), fromjson("{_id: 2}")};
+    responses.emplace_back(_nss, CursorId(1), batch1);
+    scheduleNetworkResponses(responses, CursorResponse::ResponseType::InitialResponse);
+    executor->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_FALSE(arm->ready());
+
+    // Only four of the six documents needed for the skip and limit remain to be returned.
+    readyEvent = unittest::assertGet(arm->nextEvent());
+    BSONObj scheduledCmd = getFirstPendingRequest().cmdObj;
+    auto request = GetMoreRequest::parseFromBSON("anydbname", scheduledCmd);
+    ASSERT_OK(request.getStatus());
+    ASSERT_EQ(*request.getValue().batchSize, 4LL);
+
+    responses.clear();
+    std::vector<BSONObj> batch2 = {fromjson("{_id: 3}")};
+    responses.emplace_back(_nss, CursorId(0), batch2);
+    scheduleNetworkResponses(responses, CursorResponse::ResponseType::SubsequentResponse);
+    executor->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 3}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_TRUE(arm->ready());
+    ASSERT(!unittest::assertGet(arm->nextReady()));
+}
+
 TEST_F(AsyncResultsMergerTest, SendsSecondaryOkAsMetadata) {
     BSONObj findCmd = fromjson("{find: 'testcoll', batchSize: 2}");
     const bool isSecondaryOk = true;
@@ -993,6 +1123,137 @@ TEST_F(AsyncResultsMergerTest, SendsSecondaryOkAsMetadata) {
     ASSERT(!unittest::assertGet(arm->nextReady()));
 }
 
+TEST_F(AsyncResultsMergerTest, HedgedFindNotSentIfRemoteRepliesInTime) {
+    BSONObj findCmd = fromjson("{find: 'testcoll'}");
+    makeHedgedCursor(findCmd, Milliseconds(10));
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {fromjson("{_id: 1}")};
+    responses.emplace_back(_nss, CursorId(0), batch1);
+    scheduleNetworkResponses(responses, CursorResponse::ResponseType::InitialResponse);
+    executor->waitForEvent(readyEvent);
+
+    // The timer was canceled, so no hedge goes out once the delay has passed.
+    advanceTime(Milliseconds(20));
+    executor::NetworkInterfaceMock* net = getNet();
+    net->enterNetwork();
+    ASSERT_FALSE(net->hasReadyRequests());
+    net->exitNetwork();
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_TRUE(arm->ready());
+    ASSERT(!unittest::assertGet(arm->nextReady()));
+}
+
+TEST_F(AsyncResultsMergerTest, HedgedFindWonByHedgeHost) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', batchSize: 1}");
+    makeHedgedCursor(findCmd, Milliseconds(10));
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    ASSERT_EQ(_remotes[0], getFirstPendingRequest().target);
+    blackHoleNextRequest();
+
+    // Once the delay has passed, the find is sent to the hedge host too, which replies first.
+    advanceTime(Milliseconds(10));
+    std::vector<BSONObj> batch1 = {fromjson("{_id: 1}")};
+    scheduleResponseFrom(
+        _remotes[1],
+        CursorResponse(_nss, CursorId(123), batch1)
+            .toBSON(CursorResponse::ResponseType::InitialResponse));
+    executor->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_FALSE(arm->ready());
+
+    // The getMore goes to the host which established the cursor.
+    readyEvent = unittest::assertGet(arm->nextEvent());
+    ASSERT_EQ(_remotes[1], getFirstPendingRequest().target);
+    std::vector<BSONObj> batch2 = {fromjson("{_id: 2}")};
+    scheduleResponseFrom(
+        _remotes[1],
+        CursorResponse(_nss, CursorId(0), batch2)
+            .toBSON(CursorResponse::ResponseType::SubsequentResponse));
+    executor->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_TRUE(arm->ready());
+    ASSERT(!unittest::assertGet(arm->nextReady()));
+
+    // The original request, which lost, is canceled once the ARM is killed.
+    auto killedEvent = arm->kill();
+    runReadyNetworkOperations();
+    executor->waitForEvent(killedEvent);
+}
+
+TEST_F(AsyncResultsMergerTest, HedgedFindLoserCursorIsKilled) {
+    BSONObj findCmd = fromjson("{find: 'testcoll'}");
+    makeHedgedCursor(findCmd, Milliseconds(10));
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    executor::NetworkInterfaceMock* net = getNet();
+    net->enterNetwork();
+    auto original = net->getNextReadyRequest();
+    net->exitNetwork();
+
+    // Both requests are outstanding when the original request replies first.
+    advanceTime(Milliseconds(10));
+    net->enterNetwork();
+    auto hedge = net->getNextReadyRequest();
+    ASSERT_EQ(_remotes[1], hedge->getRequest().target);
+    std::vector<BSONObj> batch = {fromjson("{_id: 1}")};
+    RemoteCommandResponse originalResponse(
+        CursorResponse(_nss, CursorId(0), batch)
+            .toBSON(CursorResponse::ResponseType::InitialResponse),
+        BSONObj(),
+        Milliseconds(0));
+    RemoteCommandResponse hedgeResponse(
+        CursorResponse(_nss, CursorId(456), batch)
+            .toBSON(CursorResponse::ResponseType::InitialResponse),
+        BSONObj(),
+        Milliseconds(0));
+    net->scheduleResponse(
+        original, net->now(), executor::TaskExecutor::ResponseStatus(originalResponse));
+    net->scheduleResponse(hedge, net->now(), executor::TaskExecutor::ResponseStatus(hedgeResponse));
+    net->runReadyNetworkOperations();
+    net->exitNetwork();
+    executor->waitForEvent(readyEvent);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()));
+    ASSERT_TRUE(arm->ready());
+    ASSERT(!unittest::assertGet(arm->nextReady()));
+
+    // The cursor the hedge host opened is killed.
+    auto killCmd = getFirstPendingRequest();
+    ASSERT_EQ(_remotes[1], killCmd.target);
+    ASSERT_EQ(BSON("killCursors"
+                   << "testcoll"
+                   << "cursors" << BSON_ARRAY(CursorId(456))),
+              killCmd.cmdObj);
+}
+
+TEST_F(AsyncResultsMergerTest, HedgedFindErrorWaitsForOtherRequest) {
+    BSONObj findCmd = fromjson("{find: 'testcoll'}");
+    makeHedgedCursor(findCmd, Milliseconds(10));
+
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+    blackHoleNextRequest();
+    advanceTime(Milliseconds(10));
+
+    // The hedge host fails, which is not an error while the original request is outstanding.
+    scheduleResponseFrom(_remotes[1], Status(ErrorCodes::HostUnreachable, "host unreachable"));
+    ASSERT_FALSE(arm->ready());
+
+    auto killedEvent = arm->kill();
+    runReadyNetworkOperations();
+    executor->waitForEvent(readyEvent);
+    executor->waitForEvent(killedEvent);
+}
+
 }  // namespace
 
 }  // namespace mongo
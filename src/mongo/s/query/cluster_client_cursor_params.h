@@ -35,6 +35,7 @@
 #include "mongo/db/cursor_id.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/util/net/hostandport.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -76,6 +77,10 @@ struct ClusterClientCursorParams {
         //
         // Exactly one of 'cmdObj' or 'cursorId' must be set.
         boost::optional<CursorId> cursorId;
+
+        // Another member of the remote's replica set to which 'cmdObj' is also sent if the remote
+        // has not replied after 'hedgeDelay'. Optional. Must not be set together with 'cursorId'.
+        boost::optional<HostAndPort> hedgeHostAndPort;
     };
 
     ClusterClientCursorParams() {}
@@ -108,6 +113,10 @@ struct ClusterClientCursorParams {
     // Whether any of the remote nodes might be secondaries due to a read preference mode other
     // than "primary".
     bool isSecondaryOk = false;
+
+    // How long to wait for the reply establishing the cursor on a remote before sending a hedged
+    // copy of the command to its 'hedgeHostAndPort'.
+    Milliseconds hedgeDelay{0};
 };
 
 }  // mongo
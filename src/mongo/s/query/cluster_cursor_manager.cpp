@@ -32,13 +32,27 @@
 
 #include <set>
 
+#include "mongo/base/counter.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/util/clock_source.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
 namespace {
 
+// The number of cursor checkouts and the time they took, including waiting for the partition
+// lock.
+Counter64 cursorCheckOuts;
+ServerStatusMetricField<Counter64> displayCursorCheckOuts("cursor.manager.checkOuts",
+                                                          &cursorCheckOuts);
+Counter64 cursorCheckOutMicros;
+ServerStatusMetricField<Counter64> displayCursorCheckOutMicros("cursor.manager.checkOutMicros",
+                                                               &cursorCheckOutMicros);
+
 //
 // Helpers to construct a user-friendly error Status from a (nss, cursorId) pair.
 //
@@ -73,11 +87,20 @@ uint32_t extractPrefixFromCursorId(CursorId cursorId) {
 ClusterCursorManager::PinnedCursor::PinnedCursor(ClusterCursorManager* manager,
                                                  std::unique_ptr<ClusterClientCursor> cursor,
                                                  const NamespaceString& nss,
-                                                 CursorId cursorId)
-    : _manager(manager), _cursor(std::move(cursor)), _nss(nss), _cursorId(cursorId) {
+                                                 CursorId cursorId,
+                                                 Partition* partition,
+                                                 CursorEntry* entry)
+    : _manager(manager),
+      _cursor(std::move(cursor)),
+      _nss(nss),
+      _cursorId(cursorId),
+      _partition(partition),
+      _entry(entry) {
     invariant(_manager);
     invariant(_cursor);
     invariant(_cursorId);  // Zero is not a valid cursor id.
+    invariant(_partition);
+    invariant(_entry);
 }
 
 ClusterCursorManager::PinnedCursor::~PinnedCursor() {
@@ -91,7 +114,9 @@ ClusterCursorManager::PinnedCursor::PinnedCursor(PinnedCursor&& other)
     : _manager(std::move(other._manager)),
       _cursor(std::move(other._cursor)),
       _nss(std::move(other._nss)),
-      _cursorId(std::move(other._cursorId)) {}
+      _cursorId(std::move(other._cursorId)),
+      _partition(std::move(other._partition)),
+      _entry(std::move(other._entry)) {}
 
 ClusterCursorManager::PinnedCursor& ClusterCursorManager::PinnedCursor::operator=(
     ClusterCursorManager::PinnedCursor&& other) {
@@ -103,6 +128,8 @@ ClusterCursorManager::PinnedCursor& ClusterCursorManager::PinnedCursor::operator
     _cursor = std::move(other._cursor);
     _nss = std::move(other._nss);
     _cursorId = std::move(other._cursorId);
+    _partition = std::move(other._partition);
+    _entry = std::move(other._entry);
     return *this;
 }
 
@@ -120,7 +147,7 @@ void ClusterCursorManager::PinnedCursor::returnCursor(CursorState cursorState) {
     invariant(_cursor);
     // Note that unpinning a cursor transfers ownership of the underlying ClusterClientCursor object
     // back to the manager.
-    _manager->checkInCursor(std::move(_cursor), _nss, _cursorId, cursorState);
+    _manager->checkInCursor(std::move(_cursor), _partition, _entry, cursorState);
     *this = PinnedCursor();
 }
 
@@ -153,14 +180,20 @@ void ClusterCursorManager::PinnedCursor::returnAndKillCursor() {
 }
 
 ClusterCursorManager::ClusterCursorManager(ClockSource* clockSource)
-    : _pseudoRandom(std::unique_ptr<SecureRandom>(SecureRandom::create())->nextInt64()),
-      _clockSource(clockSource) {
+    : _clockSource(clockSource) {
     invariant(_clockSource);
+
+    std::unique_ptr<SecureRandom> secureRandom(SecureRandom::create());
+    for (uint32_t i = 0; i < kNumPartitions; i++) {
+        _partitions.push_back(stdx::make_unique<Partition>(i, secureRandom->nextInt64()));
+    }
 }
 
 ClusterCursorManager::~ClusterCursorManager() {
-    invariant(_cursorIdPrefixToNamespaceMap.empty());
-    invariant(_namespaceToContainerMap.empty());
+    for (const auto& partition : _partitions) {
+        invariant(partition->cursorIdPrefixToNamespaceMap.empty());
+        invariant(partition->namespaceToContainerMap.empty());
+    }
 }
 
 ClusterCursorManager::PinnedCursor ClusterCursorManager::registerCursor(
@@ -168,26 +201,31 @@ ClusterCursorManager::PinnedCursor ClusterCursorManager::registerCursor(
     const NamespaceString& nss,
     CursorType cursorType,
     CursorLifetime cursorLifetime) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    Partition* partition = getPartition(nss);
+    stdx::lock_guard<stdx::mutex> lk(partition->mutex);
 
     invariant(cursor);
 
     // Find the CursorEntryContainer for this namespace.  If none exists, create one.
-    auto nsToContainerIt = _namespaceToContainerMap.find(nss);
-    if (nsToContainerIt == _namespaceToContainerMap.end()) {
+    auto nsToContainerIt = partition->namespaceToContainerMap.find(nss);
+    if (nsToContainerIt == partition->namespaceToContainerMap.end()) {
         uint32_t containerPrefix = 0;
         do {
             // The server has always generated positive values for CursorId (which is a signed
             // type), so we use std::abs() here on the prefix for consistency with this historical
-            // behavior.
-            containerPrefix = static_cast<uint32_t>(std::abs(_pseudoRandom.nextInt32()));
-        } while (_cursorIdPrefixToNamespaceMap.count(containerPrefix) > 0);
-        _cursorIdPrefixToNamespaceMap[containerPrefix] = nss;
+            // behavior.  The low bits of the prefix are the index of the partition.
+            containerPrefix =
+                (static_cast<uint32_t>(std::abs(partition->pseudoRandom.nextInt32())) &
+                 ~(kNumPartitions - 1)) |
+                partition->index;
+        } while (partition->cursorIdPrefixToNamespaceMap.count(containerPrefix) > 0);
+        partition->cursorIdPrefixToNamespaceMap[containerPrefix] = nss;
 
         auto emplaceResult =
-            _namespaceToContainerMap.emplace(nss, CursorEntryContainer(containerPrefix));
+            partition->namespaceToContainerMap.emplace(nss, CursorEntryContainer(containerPrefix));
         invariant(emplaceResult.second);
-        invariant(_namespaceToContainerMap.size() == _cursorIdPrefixToNamespaceMap.size());
+        invariant(partition->namespaceToContainerMap.size() ==
+                  partition->cursorIdPrefixToNamespaceMap.size());
 
         nsToContainerIt = emplaceResult.first;
     } else {
@@ -199,7 +237,7 @@ ClusterCursorManager::PinnedCursor ClusterCursorManager::registerCursor(
     CursorEntryMap& entryMap = container.entryMap;
     CursorId cursorId = 0;
     do {
-        const uint32_t cursorSuffix = static_cast<uint32_t>(_pseudoRandom.nextInt32());
+        const uint32_t cursorSuffix = static_cast<uint32_t>(partition->pseudoRandom.nextInt32());
         cursorId = createCursorId(container.containerPrefix, cursorSuffix);
     } while (cursorId == 0 || entryMap.count(cursorId) > 0);
 
@@ -212,14 +250,21 @@ ClusterCursorManager::PinnedCursor ClusterCursorManager::registerCursor(
     // ClusterClientCursor object to the pin; the CursorEntry is left with a null
     // ClusterClientCursor.
     CursorEntry& entry = emplaceResult.first->second;
-    return PinnedCursor(this, entry.releaseCursor(), nss, cursorId);
+    return PinnedCursor(this, entry.releaseCursor(), nss, cursorId, partition, &entry);
 }
 
 StatusWith<ClusterCursorManager::PinnedCursor> ClusterCursorManager::checkOutCursor(
     const NamespaceString& nss, CursorId cursorId) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    Timer checkOutTimer;
+    ON_BLOCK_EXIT([&checkOutTimer] {
+        cursorCheckOuts.increment();
+        cursorCheckOutMicros.increment(checkOutTimer.micros());
+    });
+
+    Partition* partition = getPartition(nss);
+    stdx::lock_guard<stdx::mutex> lk(partition->mutex);
 
-    CursorEntry* entry = getEntry_inlock(nss, cursorId);
+    CursorEntry* entry = getEntry_inlock(partition, nss, cursorId);
     if (!entry) {
         return cursorNotFoundStatus(nss, cursorId);
     }
@@ -235,20 +280,18 @@ StatusWith<ClusterCursorManager::PinnedCursor> ClusterCursorManager::checkOutCur
 
     // Note that pinning a cursor transfers ownership of the underlying ClusterClientCursor object
     // to the pin; the CursorEntry is left with a null ClusterClientCursor.
-    return PinnedCursor(this, std::move(cursor), nss, cursorId);
+    return PinnedCursor(this, std::move(cursor), nss, cursorId, partition, entry);
 }
 
 void ClusterCursorManager::checkInCursor(std::unique_ptr<ClusterClientCursor> cursor,
-                                         const NamespaceString& nss,
-                                         CursorId cursorId,
+                                         Partition* partition,
+                                         CursorEntry* entry,
                                          CursorState cursorState) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    stdx::lock_guard<stdx::mutex> lk(partition->mutex);
 
     invariant(cursor);
 
-    CursorEntry* entry = getEntry_inlock(nss, cursorId);
-    invariant(entry);
-
+    // A pinned cursor's entry cannot be detached, so 'entry' is still registered.
     entry->returnCursor(std::move(cursor));
 
     if (cursorState == CursorState::NotExhausted || entry->getKillPending()) {
@@ -261,9 +304,10 @@ void ClusterCursorManager::checkInCursor(std::unique_ptr<ClusterClientCursor> cu
 }
 
 Status ClusterCursorManager::killCursor(const NamespaceString& nss, CursorId cursorId) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    Partition* partition = getPartition(nss);
+    stdx::lock_guard<stdx::mutex> lk(partition->mutex);
 
-    CursorEntry* entry = getEntry_inlock(nss, cursorId);
+    CursorEntry* entry = getEntry_inlock(partition, nss, cursorId);
     if (!entry) {
         return cursorNotFoundStatus(nss, cursorId);
     }
@@ -274,82 +318,89 @@ Status ClusterCursorManager::killCursor(const NamespaceString& nss, CursorId cur
 }
 
 void ClusterCursorManager::killMortalCursorsInactiveSince(Date_t cutoff) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-
-    for (auto& nsContainerPair : _namespaceToContainerMap) {
-        for (auto& cursorIdEntryPair : nsContainerPair.second.entryMap) {
-            CursorEntry& entry = cursorIdEntryPair.second;
-            if (entry.getLifetimeType() == CursorLifetime::Mortal &&
-                entry.getLastActive() <= cutoff) {
-                entry.setKillPending();
+    for (const auto& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> lk(partition->mutex);
+
+        for (auto& nsContainerPair : partition->namespaceToContainerMap) {
+            for (auto& cursorIdEntryPair : nsContainerPair.second.entryMap) {
+                CursorEntry& entry = cursorIdEntryPair.second;
+                if (entry.getLifetimeType() == CursorLifetime::Mortal &&
+                    entry.getLastActive() <= cutoff) {
+                    entry.setKillPending();
+                }
             }
         }
     }
 }
 
 void ClusterCursorManager::killAllCursors() {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    for (const auto& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> lk(partition->mutex);
 
-    for (auto& nsContainerPair : _namespaceToContainerMap) {
-        for (auto& cursorIdEntryPair : nsContainerPair.second.entryMap) {
-            cursorIdEntryPair.second.setKillPending();
+        for (auto& nsContainerPair : partition->namespaceToContainerMap) {
+            for (auto& cursorIdEntryPair : nsContainerPair.second.entryMap) {
+                cursorIdEntryPair.second.setKillPending();
+            }
         }
     }
 }
 
 void ClusterCursorManager::reapZombieCursors() {
-    // List all zombie cursors under the manager lock, and kill them one-by-one while not holding
-    // the lock (ClusterClientCursor::kill() is blocking, so we don't want to hold a lock while
-    // issuing the kill).
-
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-    std::vector<std::pair<NamespaceString, CursorId>> zombieCursorDescriptors;
-    for (auto& nsContainerPair : _namespaceToContainerMap) {
-        const NamespaceString& nss = nsContainerPair.first;
-        for (auto& cursorIdEntryPair : nsContainerPair.second.entryMap) {
-            CursorId cursorId = cursorIdEntryPair.first;
-            const CursorEntry& entry = cursorIdEntryPair.second;
-            if (!entry.getKillPending()) {
-                continue;
+    // List all zombie cursors of each partition under its lock, and kill them one-by-one while not
+    // holding the lock (ClusterClientCursor::kill() is blocking, so we don't want to hold a lock
+    // while issuing the kill).
+    for (const auto& partition : _partitions) {
+        stdx::unique_lock<stdx::mutex> lk(partition->mutex);
+        std::vector<std::pair<NamespaceString, CursorId>> zombieCursorDescriptors;
+        for (auto& nsContainerPair : partition->namespaceToContainerMap) {
+            const NamespaceString& nss = nsContainerPair.first;
+            for (auto& cursorIdEntryPair : nsContainerPair.second.entryMap) {
+                CursorId cursorId = cursorIdEntryPair.first;
+                const CursorEntry& entry = cursorIdEntryPair.second;
+                if (!entry.getKillPending()) {
+                    continue;
+                }
+                zombieCursorDescriptors.emplace_back(nss, cursorId);
             }
-            zombieCursorDescriptors.emplace_back(nss, cursorId);
         }
-    }
 
-    for (auto& namespaceCursorIdPair : zombieCursorDescriptors) {
-        StatusWith<std::unique_ptr<ClusterClientCursor>> zombieCursor =
-            detachCursor_inlock(namespaceCursorIdPair.first, namespaceCursorIdPair.second);
-        if (!zombieCursor.isOK()) {
-            // Cursor in use, or has already been deleted.
-            continue;
-        }
+        for (auto& namespaceCursorIdPair : zombieCursorDescriptors) {
+            StatusWith<std::unique_ptr<ClusterClientCursor>> zombieCursor = detachCursor_inlock(
+                partition.get(), namespaceCursorIdPair.first, namespaceCursorIdPair.second);
+            if (!zombieCursor.isOK()) {
+                // Cursor in use, or has already been deleted.
+                continue;
+            }
 
-        lk.unlock();
-        zombieCursor.getValue()->kill();
-        lk.lock();
-        // Cursor deleted as it goes out of scope.
+            lk.unlock();
+            zombieCursor.getValue()->kill();
+            lk.lock();
+            // Cursor deleted as it goes out of scope.
+        }
     }
 }
 
 ClusterCursorManager::Stats ClusterCursorManager::stats() const {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-
     Stats stats;
 
-    for (auto& nsContainerPair : _namespaceToContainerMap) {
-        for (auto& cursorIdEntryPair : nsContainerPair.second.entryMap) {
-            const CursorEntry& entry = cursorIdEntryPair.second;
-
-            if (entry.getKillPending()) {
-                continue;
-            }
-            switch (entry.getCursorType()) {
-                case CursorType::NamespaceNotSharded:
-                    ++stats.cursorsNotSharded;
-                    break;
-                case CursorType::NamespaceSharded:
-                    ++stats.cursorsSharded;
-                    break;
+    for (const auto& partition : _partitions) {
+        stdx::lock_guard<stdx::mutex> lk(partition->mutex);
+
+        for (auto& nsContainerPair : partition->namespaceToContainerMap) {
+            for (auto& cursorIdEntryPair : nsContainerPair.second.entryMap) {
+                const CursorEntry& entry = cursorIdEntryPair.second;
+
+                if (entry.getKillPending()) {
+                    continue;
+                }
+                switch (entry.getCursorType()) {
+                    case CursorType::NamespaceNotSharded:
+                        ++stats.cursorsNotSharded;
+                        break;
+                    case CursorType::NamespaceSharded:
+                        ++stats.cursorsSharded;
+                        break;
+                }
             }
         }
     }
@@ -359,19 +410,26 @@ ClusterCursorManager::Stats ClusterCursorManager::stats() const {
 
 boost::optional<NamespaceString> ClusterCursorManager::getNamespaceForCursorId(
     CursorId cursorId) const {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    const uint32_t prefix = extractPrefixFromCursorId(cursorId);
+    Partition* partition = _partitions[prefix & (kNumPartitions - 1)].get();
+    stdx::lock_guard<stdx::mutex> lk(partition->mutex);
 
-    const auto it = _cursorIdPrefixToNamespaceMap.find(extractPrefixFromCursorId(cursorId));
-    if (it == _cursorIdPrefixToNamespaceMap.end()) {
+    const auto it = partition->cursorIdPrefixToNamespaceMap.find(prefix);
+    if (it == partition->cursorIdPrefixToNamespaceMap.end()) {
         return boost::none;
     }
     return it->second;
 }
 
-ClusterCursorManager::CursorEntry* ClusterCursorManager::getEntry_inlock(const NamespaceString& nss,
-                                                                         CursorId cursorId) {
-    auto nsToContainerIt = _namespaceToContainerMap.find(nss);
-    if (nsToContainerIt == _namespaceToContainerMap.end()) {
+ClusterCursorManager::Partition* ClusterCursorManager::getPartition(
+    const NamespaceString& nss) const {
+    return _partitions[NamespaceString::Hasher()(nss) & (kNumPartitions - 1)].get();
+}
+
+ClusterCursorManager::CursorEntry* ClusterCursorManager::getEntry_inlock(
+    Partition* partition, const NamespaceString& nss, CursorId cursorId) {
+    auto nsToContainerIt = partition->namespaceToContainerMap.find(nss);
+    if (nsToContainerIt == partition->namespaceToContainerMap.end()) {
         return nullptr;
     }
     CursorEntryMap& entryMap = nsToContainerIt->second.entryMap;
@@ -384,8 +442,8 @@ ClusterCursorManager::CursorEntry* ClusterCursorManager::getEntry_inlock(const N
 }
 
 StatusWith<std::unique_ptr<ClusterClientCursor>> ClusterCursorManager::detachCursor_inlock(
-    const NamespaceString& nss, CursorId cursorId) {
-    CursorEntry* entry = getEntry_inlock(nss, cursorId);
+    Partition* partition, const NamespaceString& nss, CursorId cursorId) {
+    CursorEntry* entry = getEntry_inlock(partition, nss, cursorId);
     if (!entry) {
         return cursorNotFoundStatus(nss, cursorId);
     }
@@ -395,8 +453,8 @@ StatusWith<std::unique_ptr<ClusterClientCursor>> ClusterCursorManager::detachCur
         return cursorInUseStatus(nss, cursorId);
     }
 
-    auto nsToContainerIt = _namespaceToContainerMap.find(nss);
-    invariant(nsToContainerIt != _namespaceToContainerMap.end());
+    auto nsToContainerIt = partition->namespaceToContainerMap.find(nss);
+    invariant(nsToContainerIt != partition->namespaceToContainerMap.end());
     CursorEntryMap& entryMap = nsToContainerIt->second.entryMap;
     size_t eraseResult = entryMap.erase(cursorId);
     invariant(1 == eraseResult);
@@ -404,10 +462,11 @@ StatusWith<std::unique_ptr<ClusterClientCursor>> ClusterCursorManager::detachCur
         // This was the last cursor remaining in the given namespace.  Erase all state associated
         // with this namespace.
         size_t numDeleted =
-            _cursorIdPrefixToNamespaceMap.erase(nsToContainerIt->second.containerPrefix);
+            partition->cursorIdPrefixToNamespaceMap.erase(nsToContainerIt->second.containerPrefix);
         invariant(numDeleted == 1);
-        _namespaceToContainerMap.erase(nsToContainerIt);
-        invariant(_namespaceToContainerMap.size() == _cursorIdPrefixToNamespaceMap.size());
+        partition->namespaceToContainerMap.erase(nsToContainerIt);
+        invariant(partition->namespaceToContainerMap.size() ==
+                  partition->cursorIdPrefixToNamespaceMap.size());
     }
 
     return std::move(cursor);
@@ -62,6 +62,10 @@ class StatusWith;
  *
  * No public methods throw exceptions, and all public methods are thread-safe.
  *
+ * Cursors are spread over a fixed number of partitions by namespace, each with its own lock, so
+ * that operations on cursors of different namespaces rarely wait for one another. Methods which
+ * look at all cursors visit the partitions one at a time.
+ *
  * TODO: Add maxTimeMS support.  SERVER-19410.
  * TODO: Add method "size_t killCursorsOnNamespace(const NamespaceString& nss)" for
  *       dropCollection()?
@@ -69,6 +73,10 @@ class StatusWith;
 class ClusterCursorManager {
     MONGO_DISALLOW_COPYING(ClusterCursorManager);
 
+    // Declared here so that PinnedCursor can point into the manager's private state.
+    class CursorEntry;
+    struct Partition;
+
 public:
     //
     // Enum/struct declarations, for use with public methods below.
@@ -191,12 +199,15 @@ public:
         /**
          * Creates a PinnedCursor owning the given cursor, which must be checked out from the given
          * manager.  Does not take ownership of 'manager'.  'manager' and 'cursor' must be non-null,
-         * and 'cursorId' must be non-zero.
+         * and 'cursorId' must be non-zero.  'partition' and 'entry' locate the cursor's entry in
+         * the manager, which stays in place while the cursor is pinned.
          */
         PinnedCursor(ClusterCursorManager* manager,
                      std::unique_ptr<ClusterClientCursor> cursor,
                      const NamespaceString& nss,
-                     CursorId cursorId);
+                     CursorId cursorId,
+                     Partition* partition,
+                     CursorEntry* entry);
 
         /**
          * Informs the manager that the cursor should be killed, and transfers ownership of the
@@ -208,6 +219,8 @@ public:
         std::unique_ptr<ClusterClientCursor> _cursor;
         NamespaceString _nss;
         CursorId _cursorId = 0;
+        Partition* _partition = nullptr;
+        CursorEntry* _entry = nullptr;
     };
 
     /**
@@ -316,30 +329,37 @@ public:
     boost::optional<NamespaceString> getNamespaceForCursorId(CursorId cursorId) const;
 
 private:
-    class CursorEntry;
     using CursorEntryMap = std::unordered_map<CursorId, CursorEntry>;
 
     /**
      * Transfers ownership of the given pinned cursor back to the manager, and moves the cursor to
      * the 'idle' state.  If 'cursorState' is 'Exhausted' and the cursor is not marked as 'kill
      * pending', destroys the cursor (if the cursor is marked as 'kill pending', destruction of the
-     * cursor is delayed until it reaped).  Thread-safe.
+     * cursor is delayed until it reaped).  'partition' and 'entry' are the ones the cursor was
+     * pinned from, so no lookup is needed.  Thread-safe.
      *
      * Intentionally private.  Clients should use public methods on PinnedCursor to check a cursor
      * back in.
      */
     void checkInCursor(std::unique_ptr<ClusterClientCursor> cursor,
-                       const NamespaceString& nss,
-                       CursorId cursorId,
+                       Partition* partition,
+                       CursorEntry* entry,
                        CursorState cursorState);
 
     /**
-     * Returns a pointer to the CursorEntry for the given cursor.  If the given cursor is not
-     * registered, returns null.
+     * Returns the partition holding the cursors on 'nss'.
+     */
+    Partition* getPartition(const NamespaceString& nss) const;
+
+    /**
+     * Returns a pointer to the CursorEntry for the given cursor in 'partition'.  If the given
+     * cursor is not registered, returns null.
      *
-     * Not thread-safe.
+     * Not thread-safe.  The caller must hold the partition's lock.
      */
-    CursorEntry* getEntry_inlock(const NamespaceString& nss, CursorId cursorId);
+    static CursorEntry* getEntry_inlock(Partition* partition,
+                                        const NamespaceString& nss,
+                                        CursorId cursorId);
 
     /**
      * De-registers the given cursor, and returns an owned pointer to the underlying
@@ -348,10 +368,10 @@ private:
      * If the given cursor is pinned, returns an error Status with code CursorInUse.  If the given
      * cursor is not registered, returns an error Status with code CursorNotFound.
      *
-     * Not thread-safe.
+     * Not thread-safe.  The caller must hold the partition's lock.
      */
-    StatusWith<std::unique_ptr<ClusterClientCursor>> detachCursor_inlock(const NamespaceString& nss,
-                                                                         CursorId cursorId);
+    static StatusWith<std::unique_ptr<ClusterClientCursor>> detachCursor_inlock(
+        Partition* partition, const NamespaceString& nss, CursorId cursorId);
 
     /**
      * CursorEntry is a moveable, non-copyable container for a single cursor.
@@ -474,33 +494,53 @@ private:
         CursorEntryMap entryMap;
     };
 
-    // Synchronizes access to all private state.
-    mutable stdx::mutex _mutex;
+    /**
+     * Partition holds the cursors of the namespaces which hash to it, along with the lock
+     * guarding them.
+     */
+    struct Partition {
+        MONGO_DISALLOW_COPYING(Partition);
+
+        Partition(uint32_t index, int64_t seed) : index(index), pseudoRandom(seed) {}
+
+        // Position of this partition in the manager.  The cursor id prefixes of its namespaces
+        // are all equal to it modulo kNumPartitions, so prefixes are unique across partitions.
+        const uint32_t index;
+
+        // Synchronizes access to the state below.
+        stdx::mutex mutex;
+
+        // Randomness source.  Used for cursor id generation.
+        PseudoRandom pseudoRandom;
+
+        // Map from cursor id prefix to associated namespace.  Exists only to provide namespace
+        // lookup for (deprecated) getNamespaceForCursorId() method.
+        //
+        // A CursorId is a 64-bit type, made up of a 32-bit prefix and a 32-bit suffix.  When the
+        // first cursor on a given namespace is registered, it is given a CursorId with a prefix
+        // that is unique to that namespace, and an arbitrary suffix.  Cursors subsequently
+        // registered on that namespace will all share the same prefix.
+        //
+        // Entries are added when the first cursor on the given namespace is registered, and
+        // removed when the last cursor on the given namespace is destroyed.
+        std::unordered_map<uint32_t, NamespaceString> cursorIdPrefixToNamespaceMap;
+
+        // Map from namespace to the CursorEntryContainer for that namespace.
+        //
+        // Entries are added when the first cursor on the given namespace is registered, and
+        // removed when the last cursor on the given namespace is destroyed.
+        std::unordered_map<NamespaceString, CursorEntryContainer, NamespaceString::Hasher>
+            namespaceToContainerMap;
+    };
 
-    // Randomness source.  Used for cursor id generation.
-    PseudoRandom _pseudoRandom;
+    // Number of partitions, a power of two.
+    static const uint32_t kNumPartitions = 16;
 
     // Clock source.  Used when the 'last active' time for a cursor needs to be set/updated.
     ClockSource* _clockSource;
 
-    // Map from cursor id prefix to associated namespace.  Exists only to provide namespace lookup
-    // for (deprecated) getNamespaceForCursorId() method.
-    //
-    // A CursorId is a 64-bit type, made up of a 32-bit prefix and a 32-bit suffix.  When the first
-    // cursor on a given namespace is registered, it is given a CursorId with a prefix that is
-    // unique to that namespace, and an arbitrary suffix.  Cursors subsequently registered on that
-    // namespace will all share the same prefix.
-    //
-    // Entries are added when the first cursor on the given namespace is registered, and removed
-    // when the last cursor on the given namespace is destroyed.
-    std::unordered_map<uint32_t, NamespaceString> _cursorIdPrefixToNamespaceMap;
-
-    // Map from namespace to the CursorEntryContainer for that namespace.
-    //
-    // Entries are added when the first cursor on the given namespace is registered, and removed
-    // when the last cursor on the given namespace is destroyed.
-    std::unordered_map<NamespaceString, CursorEntryContainer, NamespaceString::Hasher>
-        _namespaceToContainerMap;
+    // The partitions, which are created with the manager and never change.
+    std::vector<std::unique_ptr<Partition>> _partitions;
 };
 
 }  // namespace
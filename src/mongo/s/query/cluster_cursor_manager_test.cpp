@@ -34,6 +34,7 @@
 
 #include "mongo/s/query/cluster_client_cursor_mock.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/clock_source_mock.h"
 #include "mongo/unittest/unittest.h"
 
@@ -636,6 +637,74 @@ TEST_F(ClusterCursorManagerTest, GetNamespaceForCursorIdMultipleCursorsDifferent
     }
 }
 
+// Test that cursors on many namespaces, which spread over the manager's partitions, are all
+// counted, killed and reaped.
+TEST_F(ClusterCursorManagerTest, KillAndReapCursorsManyNamespaces) {
+    const size_t numCursors = 100;
+    std::vector<CursorId> cursorIds(numCursors);
+    for (size_t i = 0; i < numCursors; ++i) {
+        NamespaceString cursorNamespace(std::string(str::stream() << "test.collection" << i));
+        auto cursor =
+            getManager()->registerCursor(allocateMockCursor(),
+                                         cursorNamespace,
+                                         ClusterCursorManager::CursorType::NamespaceSharded,
+                                         ClusterCursorManager::CursorLifetime::Mortal);
+        cursorIds[i] = cursor.getCursorId();
+        cursor.returnCursor(ClusterCursorManager::CursorState::NotExhausted);
+    }
+    ASSERT_EQ(numCursors, getManager()->stats().cursorsSharded);
+
+    getManager()->killAllCursors();
+    ASSERT_EQ(0U, getManager()->stats().cursorsSharded);
+    getManager()->reapZombieCursors();
+    for (size_t i = 0; i < numCursors; ++i) {
+        ASSERT(isMockCursorKilled(i));
+        ASSERT_FALSE(getManager()->getNamespaceForCursorId(cursorIds[i]));
+    }
+}
+
+// Test that cursors on different namespaces can be checked out and returned from several threads
+// at once.
+TEST_F(ClusterCursorManagerTest, CheckOutCursorConcurrentNamespaces) {
+    const size_t numThreads = 8;
+    std::vector<std::pair<NamespaceString, CursorId>> cursors;
+    for (size_t i = 0; i < numThreads; ++i) {
+        NamespaceString cursorNamespace(std::string(str::stream() << "test.collection" << i));
+        auto cursor =
+            getManager()->registerCursor(allocateMockCursor(),
+                                         cursorNamespace,
+                                         ClusterCursorManager::CursorType::NamespaceNotSharded,
+                                         ClusterCursorManager::CursorLifetime::Mortal);
+        cursors.emplace_back(cursorNamespace, cursor.getCursorId());
+        cursor.returnCursor(ClusterCursorManager::CursorState::NotExhausted);
+    }
+
+    std::vector<int> failures(numThreads, 0);
+    std::vector<stdx::thread> threads;
+    for (size_t i = 0; i < numThreads; ++i) {
+        threads.emplace_back([this, &cursors, &failures, i] {
+            for (int j = 0; j < 1000; ++j) {
+                auto pinnedCursor =
+                    getManager()->checkOutCursor(cursors[i].first, cursors[i].second);
+                if (!pinnedCursor.isOK()) {
+                    ++failures[i];
+                    continue;
+                }
+                pinnedCursor.getValue().returnCursor(
+                    ClusterCursorManager::CursorState::NotExhausted);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (size_t i = 0; i < numThreads; ++i) {
+        ASSERT_EQ(0, failures[i]);
+        ASSERT_OK(getManager()->checkOutCursor(cursors[i].first, cursors[i].second).getStatus());
+    }
+}
+
 // Test that getting the namespace for an unknown cursor returns boost::none.
 TEST_F(ClusterCursorManagerTest, GetNamespaceForCursorIdUnknown) {
     boost::optional<NamespaceString> cursorNamespace = getManager()->getNamespaceForCursorId(5);
@@ -44,6 +44,8 @@
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/getmore_request.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/executor/network_interface.h"
 #include "mongo/rpc/metadata/server_selection_metadata.h"
 #include "mongo/s/catalog/catalog_cache.h"
 #include "mongo/s/chunk_manager.h"
@@ -61,6 +63,10 @@
 
 namespace mongo {
 
+// If positive, a find which may read from any secondary is also sent to a second member of a
+// shard's replica set when the first has not established the cursor after this many milliseconds.
+MONGO_EXPORT_SERVER_PARAMETER(readHedgingDelayMillis, int, 0);
+
 namespace {
 
 static const BSONObj kSortKeyMetaProjection = BSON("$meta"
@@ -213,6 +219,17 @@ StatusWith<CursorId> runQueryWithoutRetrying(OperationContext* txn,
     params.isTailable = query.getParsed().isTailable();
     params.isSecondaryOk = (readPref.pref != ReadPreference::PrimaryOnly);
 
+    // Reads which do not prefer the primary may go to any of several members of a shard anyway,
+    // so they may be rerouted or hedged. Tailable cursors wait for data on purpose, so are never
+    // hedged.
+    const bool canReroute = readPref.pref == ReadPreference::SecondaryOnly ||
+        readPref.pref == ReadPreference::SecondaryPreferred ||
+        readPref.pref == ReadPreference::Nearest;
+    const bool hedgeReads = readHedgingDelayMillis > 0 && !params.isTailable && canReroute;
+    if (hedgeReads) {
+        params.hedgeDelay = Milliseconds(readHedgingDelayMillis);
+    }
+
     // This is the batchSize passed to each subsequent getMore command issued by the cursor. We
     // usually use the batchSize associated with the initial find, but as it is illegal to send a
     // getMore with a batchSize of 0, we set it to use the default batchSize logic.
@@ -248,6 +265,19 @@ StatusWith<CursorId> runQueryWithoutRetrying(OperationContext* txn,
             return hostAndPort.getStatus();
         }
 
+        // Send reads which may go to any of several members elsewhere if the chosen one would
+        // have its commands rejected by the circuit breaker.
+        if (canReroute && !shardRegistry->getNetwork()->isHostAccepting(hostAndPort.getValue())) {
+            auto rerouted = targeter->findHedgeHost(readPref, hostAndPort.getValue());
+            if (rerouted.isOK() &&
+                shardRegistry->getNetwork()->isHostAccepting(rerouted.getValue())) {
+                LOG(1) << "Rerouting find on " << query.nss() << " from "
+                       << hostAndPort.getValue() << " to " << rerouted.getValue()
+                       << " as the circuit breaker of the former is open";
+                hostAndPort = std::move(rerouted);
+            }
+        }
+
         // Build the find command, and attach shard version if necessary.
         BSONObjBuilder cmdBuilder;
         lpqToForward->asFindCommand(&cmdBuilder);
@@ -257,7 +287,14 @@ StatusWith<CursorId> runQueryWithoutRetrying(OperationContext* txn,
             cmdBuilder.appendArray(LiteParsedQuery::kShardVersionField, shardVersion.toBSON());
         }
 
-        params.remotes.emplace_back(std::move(hostAndPort.getValue()), cmdBuilder.obj());
+        params.remotes.emplace_back(hostAndPort.getValue(), cmdBuilder.obj());
+
+        if (hedgeReads) {
+            auto hedgeHostAndPort = targeter->findHedgeHost(readPref, hostAndPort.getValue());
+            if (hedgeHostAndPort.isOK()) {
+                params.remotes.back().hedgeHostAndPort = std::move(hedgeHostAndPort.getValue());
+            }
+        }
     }
 
     auto ccc =
@@ -47,6 +47,8 @@
 #include "mongo/util/assert_util.h"
 #include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -124,6 +126,8 @@ void Command::execCommandClientBasic(OperationContext* txn,
 
     std::string errmsg;
     bool ok;
+    const Timer runTimer;
+    ON_BLOCK_EXIT([&] { c->_latency.increment(runTimer.micros()); });
     try {
         ok = c->run(txn, dbname, cmdObj, queryOptions, errmsg, result);
     } catch (const DBException& e) {
@@ -56,11 +56,13 @@
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_noop.h"
 #include "mongo/db/startup_warnings_common.h"
+#include "mongo/logger/async_appender.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/s/balance.h"
 #include "mongo/s/catalog/forwarding_catalog_manager.h"
 #include "mongo/s/client/sharding_connection_hook.h"
 #include "mongo/s/config.h"
+#include "mongo/s/config_change_listener.h"
 #include "mongo/s/cursors.h"
 #include "mongo/s/grid.h"
 #include "mongo/s/mongos_options.h"
@@ -122,6 +124,14 @@ static BSONObj buildErrReply(const DBException& ex) {
 }
 
 class ShardedMessageHandler : public MessageHandler {
+    /**
+     * Carries the connection's Client between the threads servicing it.
+     */
+    struct ClientState : public ConnectionState {
+        explicit ClientState(ServiceContext::UniqueClient c) : client(std::move(c)) {}
+        ServiceContext::UniqueClient client;
+    };
+
 public:
     virtual ~ShardedMessageHandler() {}
 
@@ -129,6 +139,14 @@ public:
         Client::initThread("conn", getGlobalServiceContext(), p);
     }
 
+    virtual std::unique_ptr<ConnectionState> detach(AbstractMessagingPort* p) {
+        return stdx::make_unique<ClientState>(Client::releaseCurrent());
+    }
+
+    virtual void attach(AbstractMessagingPort* p, std::unique_ptr<ConnectionState> state) {
+        Client::setCurrent(std::move(static_cast<ClientState*>(state.get())->client));
+    }
+
     virtual void process(Message& m, AbstractMessagingPort* p) {
         verify(p);
         Request r(m, p);
@@ -174,6 +192,9 @@ void start(const MessageServer::Options& opts) {
     cursorCache.startTimeoutThread();
     clusterCursorCleanupJob.go();
 
+    ConfigChangeListener configChangeListener;
+    configChangeListener.go();
+
     UserCacheInvalidator cacheInvalidatorThread(getGlobalAuthorizationManager());
     {
         auto txn = cc().makeOperationContext();
@@ -473,5 +494,6 @@ void mongo::dbexit(ExitCode rc, const char* why) {
 #endif
 
     log() << "dbexit: " << why << " rc:" << rc;
+    logger::AsyncAppender::flushAllAndWriteSynchronously();
     quickExit(rc);
 }
@@ -39,6 +39,8 @@
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/client/connpool.h"
 #include "mongo/client/dbclientcursor.h"
+#include "mongo/client/read_preference.h"
+#include "mongo/client/remote_command_targeter.h"
 #include "mongo/db/audit.h"
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/authorization_session.h"
@@ -49,6 +51,7 @@
 #include "mongo/db/query/lite_parsed_query.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/stats/counters.h"
+#include "mongo/executor/task_executor.h"
 #include "mongo/rpc/metadata/server_selection_metadata.h"
 #include "mongo/s/bson_serializable.h"
 #include "mongo/s/catalog/catalog_cache.h"
@@ -79,6 +82,136 @@ using std::vector;
 
 MONGO_EXPORT_SERVER_PARAMETER(useClusterClientCursor, bool, false);
 
+// Spigot which controls whether the count, distinct and aggregate commands on sharded collections
+// are sent to all shards at once through the shard registry's task executor, with the shard
+// version attached to each command, instead of through versioned shard connections.
+MONGO_EXPORT_SERVER_PARAMETER(useAsyncCommandDispatch, bool, false);
+
+namespace {
+
+/**
+ * Returns whether commandOp may dispatch 'command' through the task executor. The command must
+ * accept a shardVersion field and check it when reading the collection.
+ */
+bool canDispatchAsync(const BSONObj& command) {
+    const StringData commandName = command.firstElementFieldName();
+    return commandName == "count" || commandName == "distinct" || commandName == "aggregate";
+}
+
+/**
+ * Sends 'command' at once to each shard of 'manager' targeted by 'targetingQuery', with the shard
+ * version of that shard attached, and waits for all the responses. Returns SendStaleConfig or
+ * RecvStaleConfig if any shard reported that the version is stale, in which case the results are
+ * incomplete and the command should be retargeted.
+ */
+Status commandOpAsyncWithoutRetrying(OperationContext* txn,
+                                     const string& db,
+                                     const BSONObj& command,
+                                     int options,
+                                     const ChunkManager& manager,
+                                     const BSONObj& targetingQuery,
+                                     vector<Strategy::CommandResult>* results) {
+    auto shardRegistry = grid.shardRegistry();
+    auto executor = shardRegistry->getExecutor();
+
+    set<ShardId> shardIds;
+    manager.getShardIdsForQuery(shardIds, targetingQuery);
+
+    const bool isSecondaryOk = options & QueryOption_SlaveOk;
+    const ReadPreferenceSetting readPref(
+        isSecondaryOk ? ReadPreference::SecondaryPreferred : ReadPreference::PrimaryOnly,
+        TagSet());
+    BSONObjBuilder metadataBuilder;
+    Status status =
+        rpc::ServerSelectionMetadata(isSecondaryOk, boost::none).writeToMetadata(&metadataBuilder);
+    if (!status.isOK()) {
+        return status;
+    }
+    const BSONObj metadata = metadataBuilder.obj();
+
+    // Every remote fills in its own response, so the callbacks need no synchronization.
+    struct Remote {
+        ShardId shardId;
+        HostAndPort host;
+        StatusWith<executor::RemoteCommandResponse> response{
+            Status(ErrorCodes::InternalError, "Internal error running command")};
+    };
+    vector<Remote> remotes(shardIds.size());
+    vector<executor::TaskExecutor::CallbackHandle> handles;
+
+    size_t i = 0;
+    for (const ShardId& shardId : shardIds) {
+        Remote& remote = remotes[i++];
+        remote.shardId = shardId;
+
+        const auto shard = shardRegistry->getShard(txn, shardId);
+        if (!shard) {
+            status = Status(ErrorCodes::ShardNotFound,
+                            str::stream() << "Shard " << shardId << " not found");
+            break;
+        }
+
+        auto host = shard->getTargeter()->findHost(readPref);
+        if (!host.isOK()) {
+            status = host.getStatus();
+            break;
+        }
+        remote.host = std::move(host.getValue());
+
+        BSONObjBuilder cmdBuilder;
+        cmdBuilder.appendElements(command);
+        cmdBuilder.appendArray(LiteParsedQuery::kShardVersionField,
+                               manager.getVersion(shardId).toBSON());
+
+        auto handle = executor->scheduleRemoteCommand(
+            executor::RemoteCommandRequest(remote.host, db, cmdBuilder.obj(), metadata),
+            [&remote](const executor::TaskExecutor::RemoteCommandCallbackArgs& args) {
+                remote.response = args.response;
+            });
+        if (!handle.isOK()) {
+            status = handle.getStatus();
+            break;
+        }
+        handles.push_back(handle.getValue());
+    }
+
+    // The callbacks refer to 'remotes', so wait for every command that was sent, even on error.
+    if (!status.isOK()) {
+        for (const auto& handle : handles) {
+            executor->cancel(handle);
+        }
+    }
+    for (const auto& handle : handles) {
+        executor->wait(handle);
+    }
+    if (!status.isOK()) {
+        return status;
+    }
+
+    for (const Remote& remote : remotes) {
+        if (!remote.response.isOK()) {
+            return remote.response.getStatus();
+        }
+
+        const BSONObj& result = remote.response.getValue().data;
+        const Status commandStatus = Command::getStatusFromCommandResult(result);
+        if (commandStatus == ErrorCodes::SendStaleConfig ||
+            commandStatus == ErrorCodes::RecvStaleConfig) {
+            return commandStatus;
+        }
+
+        Strategy::CommandResult commandResult;
+        commandResult.shardTargetId = remote.shardId;
+        commandResult.target = ConnectionString(remote.host);
+        commandResult.result = result.getOwned();
+        results->push_back(commandResult);
+    }
+
+    return Status::OK();
+}
+
+}  // namespace
+
 static bool _isSystemIndexes(const char* ns) {
     return nsToCollectionSubstring(ns) == "system.indexes";
 }
@@ -476,6 +609,44 @@ void Strategy::commandOp(OperationContext* txn,
                          const string& versionedNS,
                          const BSONObj& targetingQuery,
                          vector<CommandResult>* results) {
+    if (useAsyncCommandDispatch && canDispatchAsync(command)) {
+        const NamespaceString nss(versionedNS);
+        auto status = grid.catalogCache()->getDatabase(txn, nss.db().toString());
+        shared_ptr<ChunkManager> manager;
+        shared_ptr<Shard> primary;
+        if (status.isOK()) {
+            status.getValue()->getChunkManagerOrPrimary(txn, nss.ns(), manager, primary);
+        }
+
+        // Unsharded collections keep going through the versioned connection of the primary
+        // shard, which detects when the collection becomes sharded.
+        if (manager) {
+            for (size_t retries = 1; retries <= ClusterFind::kMaxStaleConfigRetries; ++retries) {
+                vector<CommandResult> shardResults;
+                Status dispatchStatus = commandOpAsyncWithoutRetrying(
+                    txn, db, command, options, *manager, targetingQuery, &shardResults);
+                if (dispatchStatus.isOK()) {
+                    results->insert(results->end(), shardResults.begin(), shardResults.end());
+                    return;
+                }
+
+                if (dispatchStatus != ErrorCodes::SendStaleConfig &&
+                    dispatchStatus != ErrorCodes::RecvStaleConfig) {
+                    uassertStatusOK(dispatchStatus);
+                }
+
+                LOG(1) << "Received stale config for command " << command << " on attempt "
+                       << retries << " of " << ClusterFind::kMaxStaleConfigRetries << ": "
+                       << dispatchStatus.reason();
+                manager = manager->reload(txn);
+            }
+
+            uasserted(ErrorCodes::StaleShardVersion,
+                      str::stream() << "Retried " << ClusterFind::kMaxStaleConfigRetries
+                                    << " times without establishing shard version.");
+        }
+    }
+
     QuerySpec qSpec(db + ".$cmd", command, BSONObj(), 0, 1, options);
 
     ParallelSortClusteredCursor cursor(qSpec, CommandInfo(versionedNS, targetingQuery));
@@ -32,6 +32,8 @@
 
 #include "mongo/s/write_ops/batch_write_exec.h"
 
+#include <algorithm>
+
 #include "mongo/base/error_codes.h"
 #include "mongo/base/owned_pointer_map.h"
 #include "mongo/base/status.h"
@@ -151,19 +153,21 @@ void BatchWriteExec::executeBatch(OperationContext* txn,
         //
         // Send all child batches
         //
+        // Only one batch at a time is sent to each host. As soon as a host has answered, its next
+        // batch is sent, without waiting for the responses of the other hosts.
+        //
 
-        size_t numSent = 0;
-        size_t numToSend = childBatches.size();
         bool remoteMetadataChanging = false;
-        while (numSent != numToSend) {
-            // Collect batches out on the network, mapped by endpoint
-            OwnedHostBatchMap ownedPendingBatches;
-            OwnedHostBatchMap::MapType& pendingBatches = ownedPendingBatches.mutableMap();
 
-            //
-            // Send side
-            //
+        // Collect batches out on the network, mapped by endpoint
+        OwnedHostBatchMap ownedPendingBatches;
+        OwnedHostBatchMap::MapType& pendingBatches = ownedPendingBatches.mutableMap();
+
+        //
+        // Send side
+        //
 
+        const auto sendReadyBatches = [&]() {
             // Get as many batches as we can at once
             for (vector<TargetedWriteBatch*>::iterator it = childBatches.begin();
                  it != childBatches.end();
@@ -199,11 +203,10 @@ void BatchWriteExec::executeBatch(OperationContext* txn,
                     // Clean up when we can't resolve a host
                     delete *it;
                     *it = NULL;
-                    --numToSend;
                     continue;
                 }
 
-                // If we already have a batch for this host, wait until the next time
+                // If we already have a batch for this host, wait until it has answered
                 OwnedHostBatchMap::MapType::iterator pendingIt = pendingBatches.find(shardHost);
                 if (pendingIt != pendingBatches.end())
                     continue;
@@ -237,71 +240,82 @@ void BatchWriteExec::executeBatch(OperationContext* txn,
 
             // Send them all out
             _dispatcher->sendAll();
-            numSent += pendingBatches.size();
+        };
 
-            //
-            // Recv side
-            //
+        sendReadyBatches();
 
-            while (_dispatcher->numPending() > 0) {
-                // Get the response
-                ConnectionString shardHost;
-                BatchedCommandResponse response;
-                Status dispatchStatus = _dispatcher->recvAny(&shardHost, &response);
-
-                // Get the TargetedWriteBatch to find where to put the response
-                dassert(pendingBatches.find(shardHost) != pendingBatches.end());
-                TargetedWriteBatch* batch = pendingBatches.find(shardHost)->second;
-
-                if (dispatchStatus.isOK()) {
-                    TrackedErrors trackedErrors;
-                    trackedErrors.startTracking(ErrorCodes::StaleShardVersion);
-
-                    LOG(4) << "write results received from " << shardHost.toString() << ": "
-                           << response.toString();
-
-                    // Dispatch was ok, note response
-                    batchOp.noteBatchResponse(*batch, response, &trackedErrors);
-
-                    // Note if anything was stale
-                    const vector<ShardError*>& staleErrors =
-                        trackedErrors.getErrors(ErrorCodes::StaleShardVersion);
-
-                    if (staleErrors.size() > 0) {
-                        noteStaleResponses(staleErrors, _targeter);
-                        ++_stats->numStaleBatches;
-                    }
-
-                    // Remember if the shard is actively changing metadata right now
-                    if (isShardMetadataChanging(staleErrors)) {
-                        remoteMetadataChanging = true;
-                    }
-
-                    // Remember that we successfully wrote to this shard
-                    // NOTE: This will record lastOps for shards where we actually didn't update
-                    // or delete any documents, which preserves old behavior but is conservative
-                    _stats->noteWriteAt(shardHost,
-                                        response.isLastOpSet() ? response.getLastOp() : Timestamp(),
-                                        response.isElectionIdSet() ? response.getElectionId()
-                                                                   : OID());
-                } else {
-                    // Error occurred dispatching, note it
-
-                    stringstream msg;
-                    msg << "write results unavailable from " << shardHost.toString()
-                        << causedBy(dispatchStatus.toString());
+        //
+        // Recv side
+        //
 
-                    WriteErrorDetail error;
-                    buildErrorFrom(Status(ErrorCodes::RemoteResultsUnavailable, msg.str()), &error);
+        while (_dispatcher->numPending() > 0) {
+            // Get the response
+            ConnectionString shardHost;
+            BatchedCommandResponse response;
+            Status dispatchStatus = _dispatcher->recvAny(&shardHost, &response);
+
+            // Get the TargetedWriteBatch to find where to put the response
+            OwnedHostBatchMap::MapType::iterator pendingIt = pendingBatches.find(shardHost);
+            dassert(pendingIt != pendingBatches.end());
+            TargetedWriteBatch* batch = pendingIt->second;
+
+            if (dispatchStatus.isOK()) {
+                TrackedErrors trackedErrors;
+                trackedErrors.startTracking(ErrorCodes::StaleShardVersion);
 
-                    LOG(4) << "unable to receive write results from " << shardHost.toString()
-                           << causedBy(dispatchStatus.toString());
+                LOG(4) << "write results received from " << shardHost.toString() << ": "
+                       << response.toString();
 
-                    batchOp.noteBatchError(*batch, error);
+                // Dispatch was ok, note response
+                batchOp.noteBatchResponse(*batch, response, &trackedErrors);
+
+                // Note if anything was stale
+                const vector<ShardError*>& staleErrors =
+                    trackedErrors.getErrors(ErrorCodes::StaleShardVersion);
+
+                if (staleErrors.size() > 0) {
+                    noteStaleResponses(staleErrors, _targeter);
+                    ++_stats->numStaleBatches;
+                }
+
+                // Remember if the shard is actively changing metadata right now
+                if (isShardMetadataChanging(staleErrors)) {
+                    remoteMetadataChanging = true;
                 }
+
+                // Remember that we successfully wrote to this shard
+                // NOTE: This will record lastOps for shards where we actually didn't update
+                // or delete any documents, which preserves old behavior but is conservative
+                _stats->noteWriteAt(shardHost,
+                                    response.isLastOpSet() ? response.getLastOp() : Timestamp(),
+                                    response.isElectionIdSet() ? response.getElectionId() : OID());
+            } else {
+                // Error occurred dispatching, note it
+
+                stringstream msg;
+                msg << "write results unavailable from " << shardHost.toString()
+                    << causedBy(dispatchStatus.toString());
+
+                WriteErrorDetail error;
+                buildErrorFrom(Status(ErrorCodes::RemoteResultsUnavailable, msg.str()), &error);
+
+                LOG(4) << "unable to receive write results from " << shardHost.toString()
+                       << causedBy(dispatchStatus.toString());
+
+                batchOp.noteBatchError(*batch, error);
             }
+
+            // The host is free again, so send it the next batch targeted to it, if any
+            delete batch;
+            pendingBatches.erase(pendingIt);
+            sendReadyBatches();
         }
 
+        // Every batch has now either been sent and answered, or failed to resolve its host
+        dassert(std::all_of(childBatches.begin(),
+                            childBatches.end(),
+                            [](TargetedWriteBatch* batch) { return batch == NULL; }));
+
         ++rounds;
         ++_stats->numRounds;
 
@@ -148,6 +148,43 @@ TEST(BatchWriteExecTests, SingleOpError) {
     ASSERT_EQUALS(stats.numRounds, 1);
 }
 
+TEST(BatchWriteExecTests, TwoBatchesToOneHost) {
+    //
+    // Two endpoints on the same host get their batches one after the other
+    //
+
+    OperationContextNoop txn;
+    NamespaceString nss("foo.bar");
+
+    ShardEndpoint endpointA("shard", ChunkVersion(1, 0, OID()));
+    ShardEndpoint endpointB("shard", ChunkVersion(2, 0, OID()));
+    vector<MockRange*> mockRanges;
+    mockRanges.push_back(new MockRange(endpointA, nss, BSON("x" << MINKEY), BSON("x" << 0)));
+    mockRanges.push_back(new MockRange(endpointB, nss, BSON("x" << 0), BSON("x" << MAXKEY)));
+
+    MockNSTargeter targeter;
+    targeter.init(mockRanges);
+    MockShardResolver resolver;
+    MockMultiWriteCommand dispatcher;
+    BatchWriteExec exec(&targeter, &resolver, &dispatcher);
+
+    BatchedCommandRequest request(BatchedCommandRequest::BatchType_Insert);
+    request.setNS(nss);
+    request.setOrdered(false);
+    request.setWriteConcern(BSONObj());
+    request.getInsertRequest()->addToDocuments(BSON("x" << -1));
+    request.getInsertRequest()->addToDocuments(BSON("x" << 1));
+
+    BatchedCommandResponse response;
+    exec.executeBatch(&txn, request, &response);
+    ASSERT(response.getOk());
+    ASSERT(!response.isErrDetailsSet());
+    ASSERT_EQUALS(dispatcher.numPending(), 0);
+
+    const BatchWriteExecStats& stats = exec.getStats();
+    ASSERT_EQUALS(stats.numRounds, 1);
+}
+
 //
 // Test retryable errors
 //
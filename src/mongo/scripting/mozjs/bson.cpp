@@ -178,7 +178,7 @@ void BSONInfo::resolve(JSContext* cx, JS::HandleObject obj, JS::HandleId id, boo
 
         JS::RootedValue vp(cx);
 
-        ValueReader(cx, &vp).fromBSONElement(elem, holder->_readOnly);
+        ValueReader(cx, &vp).fromBSONElement(elem, holder->_obj, holder->_readOnly);
 
         o.defineProperty(id, vp, JSPROP_ENUMERATE);
 
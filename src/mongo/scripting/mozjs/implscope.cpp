@@ -502,7 +502,7 @@ int MozJSImplScope::invoke(ScriptingFunction func,
             BSONElement next = it.next();
 
             JS::RootedValue value(_context);
-            ValueReader(_context, &value).fromBSONElement(next, readOnlyArgs);
+            ValueReader(_context, &value).fromBSONElement(next, *argsObject, readOnlyArgs);
 
             args.append(value);
         }
@@ -49,6 +49,10 @@ ValueReader::ValueReader(JSContext* cx, JS::MutableHandleValue value, int depth)
     : _context(cx), _value(value), _depth(depth) {}
 
 void ValueReader::fromBSONElement(const BSONElement& elem, bool readOnly) {
+    fromBSONElement(elem, BSONObj(), readOnly);
+}
+
+void ValueReader::fromBSONElement(const BSONElement& elem, const BSONObj& parent, bool readOnly) {
     auto scope = getScope(_context);
 
     switch (elem.type()) {
@@ -92,14 +96,19 @@ void ValueReader::fromBSONElement(const BSONElement& elem, bool readOnly) {
                 sprintf(str, "%i", i++);
                 JS::RootedValue member(_context);
 
-                ValueReader(_context, &member, _depth + 1).fromBSONElement(subElem, readOnly);
+                ValueReader(_context, &member, _depth + 1)
+                    .fromBSONElement(subElem, parent, readOnly);
                 ObjectWrapper(_context, array, _depth + 1).setValue(str, member);
             }
             _value.setObjectOrNull(array);
             return;
         }
         case mongo::Object:
-            fromBSON(elem.embeddedObject(), readOnly);
+            // Subobjects of an owned object hold a reference to its buffer, so wrapping them
+            // doesn't copy them.
+            fromBSON(parent.isOwned() ? BSONObj(parent.sharedBuffer(), elem.value())
+                                      : elem.embeddedObject(),
+                     readOnly);
             return;
         case mongo::Date:
             _value.setObjectOrNull(
@@ -225,7 +234,7 @@ void ValueReader::fromBSON(const BSONObj& obj, bool readOnly) {
             ValueReader(_context, args[0]).fromBSONElement(ref, readOnly);
 
             // id can be a subobject
-            ValueReader(_context, args[1], _depth + 1).fromBSONElement(id, readOnly);
+            ValueReader(_context, args[1], _depth + 1).fromBSONElement(id, obj, readOnly);
 
             JS::RootedObject obj(_context);
 
@@ -48,6 +48,12 @@ public:
     ValueReader(JSContext* cx, JS::MutableHandleValue value, int depth = 0);
 
     void fromBSONElement(const BSONElement& elem, bool readOnly);
+
+    /**
+     * Like fromBSONElement(elem, readOnly), but for an element inside 'parent'. If 'parent' owns
+     * its buffer, objects read out of 'elem' share that buffer rather than copying their bytes.
+     */
+    void fromBSONElement(const BSONElement& elem, const BSONObj& parent, bool readOnly);
     void fromBSON(const BSONObj& obj, bool readOnly);
     void fromStringData(StringData sd);
     void fromDecimal128(Decimal128 decimal);
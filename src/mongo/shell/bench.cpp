@@ -35,10 +35,13 @@
 #include "mongo/shell/bench.h"
 
 #include <pcrecpp.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/platform/random.h"
 #include "mongo/scripting/bson_template_evaluator.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/stdx/thread.h"
@@ -86,11 +89,13 @@ BenchRunEventCounter::~BenchRunEventCounter() {}
 void BenchRunEventCounter::reset() {
     _numEvents = 0;
     _totalTimeMicros = 0;
+    _latencies = LatencyHistogram();
 }
 
 void BenchRunEventCounter::updateFrom(const BenchRunEventCounter& other) {
     _numEvents += other._numEvents;
     _totalTimeMicros += other._totalTimeMicros;
+    _latencies.add(other._latencies);
 }
 
 BenchRunStats::BenchRunStats() {
@@ -110,6 +115,7 @@ void BenchRunStats::reset() {
     deleteCounter.reset();
     queryCounter.reset();
     commandCounter.reset();
+    namedOpCounters.clear();
     trappedErrors.clear();
 }
 
@@ -126,6 +132,9 @@ void BenchRunStats::updateFrom(const BenchRunStats& other) {
     queryCounter.updateFrom(other.queryCounter);
     commandCounter.updateFrom(other.commandCounter);
 
+    for (const auto& namedOp : other.namedOpCounters)
+        namedOpCounters[namedOp.first].updateFrom(namedOp.second);
+
     for (size_t i = 0; i < other.trappedErrors.size(); ++i)
         trappedErrors.push_back(other.trappedErrors[i]);
 }
@@ -142,6 +151,8 @@ void BenchRunConfig::initializeToDefaults() {
 
     parallel = 1;
     seconds = 1.0;
+    warmupSeconds = 0;
+    targetOpsPerSec = 0;
     hideResults = true;
     handleErrors = false;
     hideErrors = false;
@@ -152,6 +163,7 @@ void BenchRunConfig::initializeToDefaults() {
     noWatchPattern.reset();
 
     ops = BSONObj();
+    cumulativeOpWeights.clear();
 
     throwGLE = false;
     breakOnTrap = true;
@@ -182,6 +194,10 @@ void BenchRunConfig::initializeFromBson(const BSONObj& args) {
         this->randomSeed = args["randomSeed"].numberInt();
     if (args["seconds"].isNumber())
         this->seconds = args["seconds"].number();
+    if (args["warmupSeconds"].isNumber())
+        this->warmupSeconds = args["warmupSeconds"].number();
+    if (args["targetOpsPerSec"].isNumber())
+        this->targetOpsPerSec = args["targetOpsPerSec"].number();
     if (!args["hideResults"].eoo())
         this->hideResults = args["hideResults"].trueValue();
     if (!args["handleErrors"].eoo())
@@ -224,6 +240,23 @@ void BenchRunConfig::initializeFromBson(const BSONObj& args) {
     }
 
     this->ops = args["ops"].Obj().getOwned();
+
+    bool hasWeights = false;
+    double totalWeight = 0;
+    for (BSONObjIterator i(this->ops); i.more();) {
+        const BSONElement weight = i.next()["weight"];
+        uassert(28814,
+                "benchRun op weights must be non-negative numbers",
+                weight.eoo() || (weight.isNumber() && weight.number() >= 0));
+        hasWeights = hasWeights || !weight.eoo();
+        totalWeight += weight.eoo() ? 1 : weight.number();
+        this->cumulativeOpWeights.push_back(totalWeight);
+    }
+    if (!hasWeights) {
+        this->cumulativeOpWeights.clear();
+    } else {
+        uassert(28815, "benchRun op weights must not all be 0", totalWeight > 0);
+    }
 }
 
 DBClientBase* BenchRunConfig::createConnection() const {
@@ -373,6 +406,14 @@ void BenchRunWorker::generateLoadOnConnection(DBClientBase* conn) {
         }
     }
 
+    PseudoRandom random(_randomSeed);
+    std::vector<BSONElement> allOps;
+    _config->ops.elems(allOps);
+
+    // In an open loop, the time of 'timer' at which the next op is due, in micros.
+    const double opsPerSecPerWorker = _config->targetOpsPerSec / _config->parallel;
+    double nextArrivalMicros = 0;
+
     while (!shouldStop()) {
         BSONObjIterator i(_config->ops);
         while (i.more()) {
@@ -381,8 +422,38 @@ void BenchRunWorker::generateLoadOnConnection(DBClientBase* conn) {
             auto& stats = shouldCollectStats() ? _stats : _statsBlackHole;
             BSONElement e = i.next();
 
-            string ns = e["ns"].String();
+            if (!_config->cumulativeOpWeights.empty()) {
+                const std::vector<double>& weights = _config->cumulativeOpWeights;
+                const double point = random.nextCanonicalDouble() * weights.back();
+                const size_t index = std::upper_bound(weights.begin(), weights.end(), point) -
+                    weights.begin();
+                e = allOps[std::min(index, allOps.size() - 1)];
+            }
+
+            long long queuedMicros = 0;
+            if (opsPerSecPerWorker > 0) {
+                // Exponential gaps between the arrivals make them a Poisson process.
+                nextArrivalMicros +=
+                    -std::log(1 - random.nextCanonicalDouble()) * 1000000 / opsPerSecPerWorker;
+                const long long arrivalMicros = static_cast<long long>(nextArrivalMicros);
+                while (timer.micros() < arrivalMicros && !shouldStop()) {
+                    sleepmicros(std::min(arrivalMicros - timer.micros(), 100 * 1000LL));
+                }
+                if (shouldStop())
+                    break;
+                queuedMicros = timer.micros() - arrivalMicros;
+            }
+
+            string ns;
+            if (e["ns"].type() == Array) {
+                const std::vector<BSONElement> namespaces = e["ns"].Array();
+                uassert(28816, "benchRun op has an empty array of namespaces", !namespaces.empty());
+                ns = namespaces[random.nextInt32(namespaces.size())].String();
+            } else {
+                ns = e["ns"].String();
+            }
             string op = e["op"].String();
+            const string opName = e["name"].eoo() ? string() : e["name"].String();
 
             int delay = e["delay"].eoo() ? 0 : e["delay"].Int();
 
@@ -417,13 +488,14 @@ void BenchRunWorker::generateLoadOnConnection(DBClientBase* conn) {
                 }
             }
 
+            Timer opTimer;
             try {
                 if (op == "nop") {
                     // do nothing
                 } else if (op == "findOne") {
                     BSONObj result;
                     {
-                        BenchRunEventTrace _bret(&stats.findOneCounter);
+                        BenchRunEventTrace _bret(&stats.findOneCounter, queuedMicros);
                         result =
                             conn->findOne(ns, fixQuery(e["query"].Obj(), bsonTemplateEvaluator));
                     }
@@ -447,7 +519,7 @@ void BenchRunWorker::generateLoadOnConnection(DBClientBase* conn) {
                     bool ok;
                     BSONObj result;
                     {
-                        BenchRunEventTrace _bret(&stats.commandCounter);
+                        BenchRunEventTrace _bret(&stats.commandCounter, queuedMicros);
                         ok = conn->runCommand(ns,
                                               fixQuery(e["command"].Obj(), bsonTemplateEvaluator),
                                               result,
@@ -485,11 +557,11 @@ void BenchRunWorker::generateLoadOnConnection(DBClientBase* conn) {
 
                     // use special query function for exhaust query option
                     if (options & QueryOption_Exhaust) {
-                        BenchRunEventTrace _bret(&stats.queryCounter);
+                        BenchRunEventTrace _bret(&stats.queryCounter, queuedMicros);
                         stdx::function<void(const BSONObj&)> castedDoNothing(doNothing);
                         count = conn->query(castedDoNothing, ns, fixedQuery, &filter, options);
                     } else {
-                        BenchRunEventTrace _bret(&stats.queryCounter);
+                        BenchRunEventTrace _bret(&stats.queryCounter, queuedMicros);
                         cursor =
                             conn->query(ns, fixedQuery, limit, skip, &filter, options, batchSize);
                         count = cursor->itcount();
@@ -526,7 +598,7 @@ void BenchRunWorker::generateLoadOnConnection(DBClientBase* conn) {
                     bool safe = e["safe"].trueValue();
 
                     {
-                        BenchRunEventTrace _bret(&stats.updateCounter);
+                        BenchRunEventTrace _bret(&stats.updateCounter, queuedMicros);
                         BSONObj query = fixQuery(queryOrginal, bsonTemplateEvaluator);
                         BSONObj update = fixQuery(updateOriginal, bsonTemplateEvaluator);
 
@@ -575,7 +647,7 @@ void BenchRunWorker::generateLoadOnConnection(DBClientBase* conn) {
                     BSONObj result;
 
                     {
-                        BenchRunEventTrace _bret(&stats.insertCounter);
+                        BenchRunEventTrace _bret(&stats.insertCounter, queuedMicros);
 
                         BSONObj insertDoc;
                         if (useWriteCmd) {
@@ -641,7 +713,7 @@ void BenchRunWorker::generateLoadOnConnection(DBClientBase* conn) {
                     bool safe = e["safe"].trueValue();
                     BSONObj result;
                     {
-                        BenchRunEventTrace _bret(&stats.deleteCounter);
+                        BenchRunEventTrace _bret(&stats.deleteCounter, queuedMicros);
                         BSONObj predicate = fixQuery(query, bsonTemplateEvaluator);
                         if (useWriteCmd) {
                             // TODO: Replace after SERVER-11774.
@@ -703,6 +775,8 @@ void BenchRunWorker::generateLoadOnConnection(DBClientBase* conn) {
                 }
                 // Count 1 for total ops. Successfully got through the try phrase
                 stats.opCount++;
+                if (!opName.empty())
+                    stats.namedOpCounters[opName].countOne(opTimer.micros() + queuedMicros);
             } catch (DBException& ex) {
                 if (!_config->hideErrors || e["showError"].trueValue()) {
                     bool yesWatch =
@@ -833,6 +907,9 @@ void BenchRunner::start() {
 
         _brState.waitForState(BenchRunState::BRS_RUNNING);
 
+        if (_config->warmupSeconds > 0)
+            sleepmillis(static_cast<long long>(1000 * _config->warmupSeconds));
+
         // initial stats
         _brState.tellWorkersToCollectStats();
         _brTimer = new mongo::Timer();
@@ -891,6 +968,19 @@ static void appendAverageMicrosIfAvailable(BSONObjBuilder& buf,
                    static_cast<double>(counter.getTotalTimeMicros()) / counter.getNumEvents());
 }
 
+static void appendLatencyPercentilesIfAvailable(BSONObjBuilder& buf,
+                                               const std::string& name,
+                                               const BenchRunEventCounter& counter) {
+    if (counter.getNumEvents() > 0) {
+        const LatencyHistogram& latencies = counter.getLatencies();
+        BSONObjBuilder latencyBuilder(buf.subobjStart(name));
+        latencies.append(&latencyBuilder, false);
+        latencyBuilder.appendNumber("p999", latencies.getPercentile(0.999));
+        latencyBuilder.appendNumber("max", latencies.getPercentile(1));
+        latencyBuilder.done();
+    }
+}
+
 BSONObj BenchRunner::finish(BenchRunner* runner) {
     runner->stop();
 
@@ -914,6 +1004,26 @@ BSONObj BenchRunner::finish(BenchRunner* runner) {
     appendAverageMicrosIfAvailable(buf, "queryLatencyAverageMicros", stats.queryCounter);
     appendAverageMicrosIfAvailable(buf, "commandsLatencyAverageMicros", stats.commandCounter);
 
+    // The percentiles are upper bounds, within 25% of the actual latencies.
+    {
+        BSONObjBuilder percentilesBuilder(buf.subobjStart("latencyPercentilesMicros"));
+        appendLatencyPercentilesIfAvailable(percentilesBuilder, "findOne", stats.findOneCounter);
+        appendLatencyPercentilesIfAvailable(percentilesBuilder, "insert", stats.insertCounter);
+        appendLatencyPercentilesIfAvailable(percentilesBuilder, "delete", stats.deleteCounter);
+        appendLatencyPercentilesIfAvailable(percentilesBuilder, "update", stats.updateCounter);
+        appendLatencyPercentilesIfAvailable(percentilesBuilder, "query", stats.queryCounter);
+        appendLatencyPercentilesIfAvailable(percentilesBuilder, "command", stats.commandCounter);
+        percentilesBuilder.done();
+    }
+    if (!stats.namedOpCounters.empty()) {
+        BSONObjBuilder namedOpsBuilder(buf.subobjStart("namedOpLatencyPercentilesMicros"));
+        for (const auto& namedOp : stats.namedOpCounters)
+            appendLatencyPercentilesIfAvailable(namedOpsBuilder, namedOp.first, namedOp.second);
+        namedOpsBuilder.done();
+    }
+    if (runner->_config->targetOpsPerSec > 0)
+        buf.append("targetOpsPerSec", runner->_config->targetOpsPerSec);
+
     buf.append("totalOps", static_cast<long long>(stats.opCount));
 
     auto appendPerSec = [&buf, runner](StringData name, double total) {
@@ -28,10 +28,13 @@
 
 #pragma once
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/stats/latency_histogram.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
@@ -99,6 +102,21 @@ public:
      */
     double seconds;
 
+    /**
+     * Time the workers run before the statistics are collected, in seconds, so the results leave
+     * out the cold caches and connection setup of the start of the run.
+     */
+    double warmupSeconds;
+
+    /**
+     * If positive, the workers issue ops in an open loop, at this total rate with Poisson
+     * arrivals, instead of each issuing its next op as soon as the previous one completes. The
+     * latency of an op then counts from its scheduled arrival, including the time it waited for
+     * the previous ops of its worker, so a slow server shows in the latencies rather than only
+     * in a lower throughput.
+     */
+    double targetOpsPerSec;
+
     /// Base random seed for threads
     int64_t randomSeed;
 
@@ -118,12 +136,22 @@ public:
      * Every thread in a benchRun job will perform these operations in sequence, restarting at
      * the beginning when the end is reached, until the job is stopped.
      *
+     * An op with a "weight" makes the workers pick each op at random, with a probability
+     * proportional to its weight (1 by default), instead. An op whose "ns" is an array runs on one
+     * of its namespaces at random, and the latencies of an op with a "name" are also reported
+     * under that name.
+     *
      * TODO: Document the operation objects.
      *
      * TODO: Introduce support for performing each operation exactly N times.
      */
     BSONObj ops;
 
+    /**
+     * The running sums of the weights of 'ops', if any of them has a weight, or empty otherwise.
+     */
+    std::vector<double> cumulativeOpWeights;
+
     bool throwGLE;
     bool breakOnTrap;
 
@@ -161,6 +189,7 @@ public:
     void countOne(long long timeMicros) {
         ++_numEvents;
         _totalTimeMicros += timeMicros;
+        _latencies.increment(timeMicros);
     }
 
     /**
@@ -177,9 +206,17 @@ public:
         return _numEvents;
     }
 
+    /**
+     * Get the distribution of the durations of the observed events.
+     */
+    const LatencyHistogram& getLatencies() const {
+        return _latencies;
+    }
+
 private:
     unsigned long long _numEvents;
     long long _totalTimeMicros;
+    LatencyHistogram _latencies;
 };
 
 /**
@@ -199,7 +236,12 @@ class BenchRunEventTrace {
     MONGO_DISALLOW_COPYING(BenchRunEventTrace);
 
 public:
-    explicit BenchRunEventTrace(BenchRunEventCounter* eventCounter) {
+    /**
+     * 'queuedMicros' is the time the event waited before it started, which counts in its
+     * duration.
+     */
+    explicit BenchRunEventTrace(BenchRunEventCounter* eventCounter, long long queuedMicros = 0)
+        : _queuedMicros(queuedMicros) {
         initialize(eventCounter, eventCounter, false);
     }
 
@@ -210,7 +252,7 @@ public:
     }
 
     ~BenchRunEventTrace() {
-        (_succeeded ? _successCounter : _failCounter)->countOne(_timer.micros());
+        (_succeeded ? _successCounter : _failCounter)->countOne(_timer.micros() + _queuedMicros);
     }
 
     void succeed() {
@@ -230,6 +272,7 @@ private:
     }
 
     Timer _timer;
+    long long _queuedMicros = 0;
     BenchRunEventCounter* _successCounter;
     BenchRunEventCounter* _failCounter;
     bool _succeeded;
@@ -260,6 +303,9 @@ public:
     BenchRunEventCounter queryCounter;
     BenchRunEventCounter commandCounter;
 
+    // The latencies of the ops with a name, by name.
+    std::map<std::string, BenchRunEventCounter> namedOpCounters;
+
     std::map<std::string, long long> opcounters;
     std::vector<BSONObj> trappedErrors;
 };
@@ -0,0 +1,254 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/unittest/benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <string>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+namespace unittest {
+
+namespace {
+
+// The runs which determine the number of iterations never grow it more than this many times.
+const double kMaxIterationsGrowth = 10.0;
+
+const long long kMaxIterations = 1000LL * 1000 * 1000;
+
+struct RegisteredBenchmark {
+    BenchmarkFunction function;
+    std::vector<int> threadLevels;
+};
+
+typedef std::map<std::string, RegisteredBenchmark> BenchmarkMap;
+
+/**
+ * Constructed on first use, since the benchmarks register during static initialization.
+ */
+BenchmarkMap& registeredBenchmarks() {
+    static BenchmarkMap* benchmarks = new BenchmarkMap();
+    return *benchmarks;
+}
+
+stdx::chrono::nanoseconds runOnce(const BenchmarkFunction& function,
+                                  long long iterations,
+                                  int threads) {
+    BenchmarkState state(iterations, threads);
+    function(state);
+    return state.elapsed();
+}
+
+}  // namespace
+
+const void* volatile benchmarkSink = nullptr;
+
+BenchmarkState::BenchmarkState(long long iterations, int threads)
+    : _iterations(iterations), _threads(threads), _remaining(iterations) {
+    invariant(iterations > 0);
+    invariant(threads > 0);
+}
+
+void BenchmarkState::pauseTiming() {
+    if (_running) {
+        _elapsed += stdx::chrono::duration_cast<stdx::chrono::nanoseconds>(Clock::now() - _start);
+        _running = false;
+    }
+}
+
+void BenchmarkState::resumeTiming() {
+    if (!_running) {
+        _running = true;
+        _start = Clock::now();
+    }
+}
+
+void BenchmarkFixture::runWithSetUp(BenchmarkState& state) {
+    setUp();
+    run(state);
+    tearDown();
+}
+
+BenchmarkRegistration::BenchmarkRegistration(const std::string& name,
+                                             BenchmarkFunction function,
+                                             std::vector<int> threadLevels) {
+    invariant(!threadLevels.empty());
+    RegisteredBenchmark benchmark{std::move(function), std::move(threadLevels)};
+    const bool inserted = registeredBenchmarks().emplace(name, std::move(benchmark)).second;
+    invariant(inserted);
+}
+
+double BenchmarkResult::min() const {
+    return *std::min_element(nanosPerIteration.begin(), nanosPerIteration.end());
+}
+
+double BenchmarkResult::max() const {
+    return *std::max_element(nanosPerIteration.begin(), nanosPerIteration.end());
+}
+
+double BenchmarkResult::mean() const {
+    return std::accumulate(nanosPerIteration.begin(), nanosPerIteration.end(), 0.0) /
+        nanosPerIteration.size();
+}
+
+double BenchmarkResult::median() const {
+    std::vector<double> sorted(nanosPerIteration);
+    std::sort(sorted.begin(), sorted.end());
+    const size_t middle = sorted.size() / 2;
+    return sorted.size() % 2 ? sorted[middle] : (sorted[middle - 1] + sorted[middle]) / 2;
+}
+
+double BenchmarkResult::stddev() const {
+    if (nanosPerIteration.size() < 2) {
+        return 0;
+    }
+
+    const double average = mean();
+    double sumOfSquares = 0;
+    for (double nanos : nanosPerIteration) {
+        sumOfSquares += (nanos - average) * (nanos - average);
+    }
+    return std::sqrt(sumOfSquares / (nanosPerIteration.size() - 1));
+}
+
+BSONObj BenchmarkResult::toBSON() const {
+    BSONObjBuilder threadBuilder;
+    BSONArrayBuilder opsPerSecBuilder(threadBuilder.subarrayStart("ops_per_sec_values"));
+    double sumOpsPerSec = 0;
+    for (double nanos : nanosPerIteration) {
+        const double opsPerSec = nanos > 0 ? 1e9 / nanos : 0;
+        opsPerSecBuilder.append(opsPerSec);
+        sumOpsPerSec += opsPerSec;
+    }
+    opsPerSecBuilder.done();
+    threadBuilder.append("ops_per_sec", sumOpsPerSec / nanosPerIteration.size());
+    threadBuilder.appendNumber("iterations", iterations);
+    threadBuilder.append("ns_per_op_min", min());
+    threadBuilder.append("ns_per_op_max", max());
+    threadBuilder.append("ns_per_op_mean", mean());
+    threadBuilder.append("ns_per_op_median", median());
+    threadBuilder.append("ns_per_op_stddev", stddev());
+    return threadBuilder.obj();
+}
+
+BenchmarkResult runBenchmark(const std::string& name,
+                             const BenchmarkFunction& function,
+                             const BenchmarkOptions& options,
+                             int threads) {
+    invariant(options.repetitions > 0);
+
+    const stdx::chrono::nanoseconds minTime = options.minTime;
+    long long iterations = 1;
+    while (iterations < kMaxIterations) {
+        const stdx::chrono::nanoseconds elapsed = runOnce(function, iterations, threads);
+        if (elapsed >= minTime) {
+            break;
+        }
+
+        // Aim a little past the minimum time, so the next run most likely reaches it.
+        double growth = kMaxIterationsGrowth;
+        if (elapsed.count() > 0) {
+            growth = std::min(growth, 1.4 * minTime.count() / elapsed.count());
+        }
+        iterations = std::min(
+            kMaxIterations, std::max(iterations + 1, static_cast<long long>(iterations * growth)));
+    }
+
+    BenchmarkResult result;
+    result.name = name;
+    result.threads = threads;
+    result.iterations = iterations;
+    for (int i = 0; i < options.repetitions; i++) {
+        const stdx::chrono::nanoseconds elapsed = runOnce(function, iterations, threads);
+        result.nanosPerIteration.push_back(static_cast<double>(elapsed.count()) / iterations);
+    }
+    return result;
+}
+
+std::vector<BenchmarkResult> runBenchmarks(const BenchmarkOptions& options) {
+    std::vector<BenchmarkResult> results;
+    for (const auto& benchmark : registeredBenchmarks()) {
+        if (benchmark.first.find(options.filter) == std::string::npos) {
+            continue;
+        }
+
+        for (int threads : benchmark.second.threadLevels) {
+            log() << "running benchmark " << benchmark.first << " with " << threads << " threads";
+            results.push_back(
+                runBenchmark(benchmark.first, benchmark.second.function, options, threads));
+
+            const BenchmarkResult& result = results.back();
+            std::ostringstream line;
+            line << std::left << std::setw(50) << result.name << std::right << std::setw(4)
+                 << result.threads << " threads" << std::fixed << std::setprecision(1)
+                 << std::setw(14) << result.median() << " ns/op (median)" << std::setw(12)
+                 << result.stddev() << " stddev" << std::setw(14) << result.iterations
+                 << " iterations";
+            log() << line.str();
+        }
+    }
+    return results;
+}
+
+BSONObj benchmarkReport(const std::vector<BenchmarkResult>& results, Date_t start, Date_t end) {
+    BSONObjBuilder builder;
+    builder.append("start", dateToISOStringUTC(start));
+    builder.append("end", dateToISOStringUTC(end));
+
+    BSONArrayBuilder resultsBuilder(builder.subarrayStart("results"));
+    for (size_t i = 0; i < results.size();) {
+        BSONObjBuilder benchmarkBuilder(resultsBuilder.subobjStart());
+        benchmarkBuilder.append("name", results[i].name);
+        BSONObjBuilder threadsBuilder(benchmarkBuilder.subobjStart("results"));
+        const std::string& name = results[i].name;
+        for (; i < results.size() && results[i].name == name; i++) {
+            threadsBuilder.append(std::to_string(results[i].threads), results[i].toBSON());
+        }
+        threadsBuilder.done();
+        benchmarkBuilder.done();
+    }
+    resultsBuilder.done();
+
+    return builder.obj();
+}
+
+}  // namespace unittest
+}  // namespace mongo
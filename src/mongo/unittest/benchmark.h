@@ -0,0 +1,265 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * A framework for microbenchmarks of the code on the hot paths of the server.
+ *
+ * A benchmark times its loop, which the harness runs enough times for each repetition to take at
+ * least the minimum time, and reports the statistics of the repetitions:
+ *
+ *     MONGO_BENCHMARK(BSONObjBuilderAppendInt) {
+ *         while (state.keepRunning()) {
+ *             BSONObjBuilder builder;
+ *             builder.append("a", 1);
+ *             builder.obj();
+ *         }
+ *     }
+ *
+ * A benchmark registered with several thread levels runs once for each of them, and should share
+ * the iterations of each repetition between state.threads() threads, timing them with
+ * state.resumeTiming() and state.pauseTiming() rather than keepRunning().
+ *
+ * Like the unit tests, a benchmark which needs some state built outside of its timed loop can use
+ * a fixture, whose setUp() and tearDown() run once per repetition around the loop:
+ *
+ *     class MyFixture : public mongo::unittest::BenchmarkFixture {
+ *     protected:
+ *         void setUp() override { ... }
+ *     };
+ *
+ *     MONGO_BENCHMARK_F(MyFixture, Lookup) {
+ *         while (state.keepRunning()) { ... }
+ *     }
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/stdx/chrono.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/time_support.h"
+
+/**
+ * Defines a benchmark named 'NAME', whose body takes a 'BenchmarkState& state'.
+ */
+#define MONGO_BENCHMARK(NAME)                                                                 \
+    static void _mongoBenchmark_##NAME(::mongo::unittest::BenchmarkState& state);             \
+    static const ::mongo::unittest::BenchmarkRegistration _mongoBenchmarkRegistration_##NAME( \
+        #NAME, &_mongoBenchmark_##NAME);                                                      \
+    static void _mongoBenchmark_##NAME(::mongo::unittest::BenchmarkState& state)
+
+/**
+ * Defines a benchmark named 'FIXTURE/NAME' which runs as a member of a subclass of 'FIXTURE'.
+ */
+#define MONGO_BENCHMARK_F(FIXTURE, NAME)                                       \
+    class _mongoBenchmark_##FIXTURE##_##NAME : public FIXTURE {                \
+    public:                                                                    \
+        void run(::mongo::unittest::BenchmarkState& state) override;           \
+    };                                                                         \
+    static const ::mongo::unittest::BenchmarkRegistration                      \
+        _mongoBenchmarkRegistration_##FIXTURE##_##NAME(                        \
+            #FIXTURE "/" #NAME, [](::mongo::unittest::BenchmarkState& state) { \
+                _mongoBenchmark_##FIXTURE##_##NAME fixture;                    \
+                fixture.runWithSetUp(state);                                   \
+            });                                                                \
+    void _mongoBenchmark_##FIXTURE##_##NAME::run(::mongo::unittest::BenchmarkState& state)
+
+namespace mongo {
+namespace unittest {
+
+/**
+ * The state of one repetition of a benchmark, which counts and times the iterations of its loop.
+ */
+class BenchmarkState {
+    MONGO_DISALLOW_COPYING(BenchmarkState);
+
+public:
+    typedef stdx::chrono::steady_clock Clock;
+
+    explicit BenchmarkState(long long iterations, int threads = 1);
+
+    /**
+     * Returns true until the loop ran the iterations of this repetition. The first call starts
+     * the timer and the last one stops it.
+     */
+    bool keepRunning() {
+        if (_remaining > 0) {
+            if (_remaining-- == _iterations) {
+                resumeTiming();
+            }
+            return true;
+        }
+        pauseTiming();
+        return false;
+    }
+
+    /**
+     * Excludes the work between pauseTiming() and resumeTiming() from the timing of the loop.
+     */
+    void pauseTiming();
+    void resumeTiming();
+
+    long long iterations() const {
+        return _iterations;
+    }
+
+    /**
+     * The number of threads which share the iterations of this repetition.
+     */
+    int threads() const {
+        return _threads;
+    }
+
+    /**
+     * The time spent in the loop, excluding the pauses.
+     */
+    stdx::chrono::nanoseconds elapsed() const {
+        return _elapsed;
+    }
+
+private:
+    const long long _iterations;
+    const int _threads;
+    long long _remaining;
+
+    bool _running = false;
+    Clock::time_point _start;
+    stdx::chrono::nanoseconds _elapsed{0};
+};
+
+/**
+ * The base class of the fixtures of MONGO_BENCHMARK_F.
+ */
+class BenchmarkFixture {
+    MONGO_DISALLOW_COPYING(BenchmarkFixture);
+
+public:
+    BenchmarkFixture() = default;
+    virtual ~BenchmarkFixture() = default;
+
+    void runWithSetUp(BenchmarkState& state);
+
+protected:
+    virtual void setUp() {}
+    virtual void tearDown() {}
+
+    virtual void run(BenchmarkState& state) = 0;
+};
+
+typedef stdx::function<void(BenchmarkState&)> BenchmarkFunction;
+
+extern const void* volatile benchmarkSink;
+
+/**
+ * Keeps the compiler from optimizing away the computation of 'value' in a benchmark loop, for the
+ * results which are not otherwise used.
+ */
+template <typename T>
+inline void doNotOptimizeAway(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    benchmarkSink = &value;
+#endif
+}
+
+/**
+ * Registers a benchmark when constructed in the static initialization of a benchmark binary. The
+ * benchmark runs once for each of 'threadLevels'.
+ */
+class BenchmarkRegistration {
+    MONGO_DISALLOW_COPYING(BenchmarkRegistration);
+
+public:
+    BenchmarkRegistration(const std::string& name,
+                          BenchmarkFunction function,
+                          std::vector<int> threadLevels = {1});
+};
+
+/**
+ * The statistics of the repetitions of a benchmark, in nanoseconds per iteration.
+ */
+struct BenchmarkResult {
+    std::string name;
+    int threads = 1;
+    long long iterations = 0;
+    std::vector<double> nanosPerIteration;
+
+    double min() const;
+    double max() const;
+    double mean() const;
+    double median() const;
+    double stddev() const;
+
+    /**
+     * The result of this thread level in the format which buildscripts/perf_regression_check.py
+     * reads, whose throughput is the number of iterations per second.
+     */
+    BSONObj toBSON() const;
+};
+
+struct BenchmarkOptions {
+    // Only the benchmarks whose names contain this string run.
+    std::string filter;
+
+    int repetitions = 5;
+
+    // The minimum time of a repetition, which determines the number of iterations of the loop.
+    stdx::chrono::milliseconds minTime{100};
+};
+
+/**
+ * Runs the benchmark 'function' with 'threads' threads, first with more and more iterations until
+ * a run takes at least 'options.minTime', then 'options.repetitions' times with that number of
+ * iterations.
+ */
+BenchmarkResult runBenchmark(const std::string& name,
+                             const BenchmarkFunction& function,
+                             const BenchmarkOptions& options,
+                             int threads = 1);
+
+/**
+ * Runs the registered benchmarks which match 'options.filter', logging their results.
+ */
+std::vector<BenchmarkResult> runBenchmarks(const BenchmarkOptions& options);
+
+/**
+ * Returns the "data" document of a run of perf_regression_check.py, with the results of
+ * 'results', those of the thread levels of a benchmark together, and the start and end times of
+ * the run.
+ */
+BSONObj benchmarkReport(const std::vector<BenchmarkResult>& results,
+                        Date_t start,
+                        Date_t end);
+
+}  // namespace unittest
+}  // namespace mongo
@@ -0,0 +1,151 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <cmath>
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/benchmark.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+using unittest::BenchmarkOptions;
+using unittest::BenchmarkResult;
+using unittest::BenchmarkState;
+
+TEST(BenchmarkTest, StateRunsTheIterations) {
+    BenchmarkState state(3);
+    int runs = 0;
+    while (state.keepRunning()) {
+        runs++;
+    }
+    ASSERT_EQUALS(3, runs);
+    ASSERT_FALSE(state.keepRunning());
+    ASSERT_GREATER_THAN_OR_EQUALS(state.elapsed().count(), 0);
+}
+
+TEST(BenchmarkTest, RunReachesTheMinimumTime) {
+    BenchmarkOptions options;
+    options.repetitions = 3;
+    options.minTime = stdx::chrono::milliseconds(5);
+
+    int repetitions = 0;
+    const BenchmarkResult result =
+        unittest::runBenchmark("sleep",
+                               [&](BenchmarkState& state) {
+                                   if (state.iterations() > 1) {
+                                       repetitions++;
+                                   }
+                                   while (state.keepRunning()) {
+                                       sleepmicros(100);
+                                   }
+                               },
+                               options);
+
+    ASSERT_EQUALS("sleep", result.name);
+    ASSERT_EQUALS(3U, result.nanosPerIteration.size());
+    ASSERT_GREATER_THAN(result.iterations, 1);
+    ASSERT_GREATER_THAN_OR_EQUALS(result.iterations * result.min(), 5 * 1000 * 1000 * 0.5);
+    ASSERT_GREATER_THAN_OR_EQUALS(repetitions, 3);
+}
+
+TEST(BenchmarkTest, PausedTimeIsExcluded) {
+    BenchmarkState state(1);
+    while (state.keepRunning()) {
+        state.pauseTiming();
+        sleepmillis(20);
+        state.resumeTiming();
+    }
+    ASSERT_LESS_THAN(state.elapsed().count(), 10 * 1000 * 1000);
+}
+
+TEST(BenchmarkTest, Statistics) {
+    BenchmarkResult result;
+    result.name = "test";
+    result.iterations = 10;
+    result.nanosPerIteration = {4, 1, 2, 3};
+
+    ASSERT_EQUALS(1, result.min());
+    ASSERT_EQUALS(4, result.max());
+    ASSERT_EQUALS(2.5, result.mean());
+    ASSERT_EQUALS(2.5, result.median());
+    ASSERT_APPROX_EQUAL(1.291, result.stddev(), 0.001);
+
+    const BSONObj thread = result.toBSON();
+    ASSERT_EQUALS(4U, thread["ops_per_sec_values"].Array().size());
+    ASSERT_EQUALS(1e9 / 4, thread["ops_per_sec_values"].Array()[0].Double());
+    ASSERT_APPROX_EQUAL(
+        (1e9 / 4 + 1e9 / 1 + 1e9 / 2 + 1e9 / 3) / 4, thread["ops_per_sec"].Double(), 1);
+    ASSERT_EQUALS(2.5, thread["ns_per_op_median"].Double());
+}
+
+TEST(BenchmarkTest, RunPassesTheThreads) {
+    BenchmarkOptions options;
+    options.repetitions = 1;
+    options.minTime = stdx::chrono::milliseconds(0);
+
+    const BenchmarkResult result = unittest::runBenchmark("threads",
+                                                          [](BenchmarkState& state) {
+                                                              ASSERT_EQUALS(4, state.threads());
+                                                              while (state.keepRunning()) {
+                                                              }
+                                                          },
+                                                          options,
+                                                          4);
+    ASSERT_EQUALS(4, result.threads);
+}
+
+TEST(BenchmarkTest, ReportGroupsTheThreadLevels) {
+    std::vector<BenchmarkResult> results(3);
+    results[0].name = "a";
+    results[1].name = "a";
+    results[1].threads = 4;
+    results[2].name = "b";
+    for (auto& result : results) {
+        result.iterations = 1;
+        result.nanosPerIteration = {1};
+    }
+
+    const BSONObj report =
+        unittest::benchmarkReport(results, Date_t::fromMillisSinceEpoch(0), Date_t::now());
+    ASSERT_EQUALS("1970-01-01T00:00:00.000Z", report["start"].String());
+
+    const std::vector<BSONElement> benchmarks = report["results"].Array();
+    ASSERT_EQUALS(2U, benchmarks.size());
+    ASSERT_EQUALS("a", benchmarks[0]["name"].String());
+    ASSERT_EQUALS(2, benchmarks[0]["results"].Obj().nFields());
+    ASSERT_EQUALS(1e9, benchmarks[0]["results"]["4"]["ops_per_sec"].Double());
+    ASSERT_EQUALS("b", benchmarks[1]["name"].String());
+    ASSERT(benchmarks[1]["results"]["1"].isABSONObj());
+}
+
+}  // namespace
@@ -0,0 +1,64 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mongo {
+
+/**
+ * Counts the bytes allocated by each thread, for the allocators which report their allocations
+ * with recordAllocation(). The tcmalloc builds do once trackThreadAllocations is set at startup,
+ * since it costs a call on every allocation.
+ */
+class AllocationCounter {
+public:
+    /**
+     * Whether the allocator reports its allocations, so that threadBytesAllocated() counts them.
+     */
+    static bool isEnabled();
+
+    /**
+     * Called once by the allocator, before it reports its first allocation.
+     */
+    static void enable();
+
+    /**
+     * Adds 'bytes' to the count of the calling thread.
+     */
+    static void recordAllocation(size_t bytes);
+
+    /**
+     * The bytes the calling thread allocated so far, or 0 if the allocator does not report them.
+     */
+    static uint64_t threadBytesAllocated();
+};
+
+}  // namespace mongo
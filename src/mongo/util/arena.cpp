@@ -0,0 +1,89 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/arena.h"
+
+#include <algorithm>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+const size_t Arena::kAlignment;
+const size_t Arena::kMinBlockBytes;
+const size_t Arena::kMaxBlockBytes;
+
+void* Arena::allocate(size_t bytes) {
+    bytes = std::max(size_t(1), (bytes + kAlignment - 1) & ~(kAlignment - 1));
+    _allocations++;
+
+    if (_blocks.empty() || _blocks.back().size - _offset < bytes) {
+        // Allocations too big for the next block get a block of their own.
+        const size_t nextSize = _blocks.empty()
+            ? kMinBlockBytes
+            : std::min(kMaxBlockBytes, std::max(kMinBlockBytes, _blocks.back().size * 2));
+        Block block;
+        block.size = std::max(nextSize, bytes);
+        block.data.reset(new char[block.size]);
+        _blocks.push_back(std::move(block));
+        _blockAllocations++;
+        _offset = 0;
+    }
+
+    void* result = _blocks.back().data.get() + _offset;
+    _offset += bytes;
+    return result;
+}
+
+Arena::Mark Arena::mark() const {
+    return Mark{_blocks.size(), _offset};
+}
+
+void Arena::release(const Mark& mark) {
+    invariant(mark.numBlocks <= _blocks.size());
+    if (mark.numBlocks == 0) {
+        // Keep the first block, and start over at its beginning.
+        _blocks.resize(std::min(size_t(1), _blocks.size()));
+        _offset = 0;
+        return;
+    }
+    _blocks.resize(mark.numBlocks);
+    _offset = mark.offset;
+}
+
+size_t Arena::bytesReserved() const {
+    size_t bytes = 0;
+    for (const Block& block : _blocks) {
+        bytes += block.size;
+    }
+    return bytes;
+}
+
+}  // namespace mongo
@@ -0,0 +1,213 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+
+namespace mongo {
+
+/**
+ * A bump allocator for memory which is freed all at once, such as the scratch structures of one
+ * operation. Memory is carved from blocks which start at kMinBlockBytes and double up to
+ * kMaxBlockBytes, and is only returned when the arena is destroyed or released back to a mark.
+ * Every allocation is aligned to kAlignment bytes.
+ *
+ * Not thread safe.
+ */
+class Arena {
+    MONGO_DISALLOW_COPYING(Arena);
+
+public:
+    static const size_t kAlignment = 16;
+    static const size_t kMinBlockBytes = 4 * 1024;
+    static const size_t kMaxBlockBytes = 64 * 1024;
+
+    /**
+     * A position in the arena, to release everything allocated after it.
+     */
+    struct Mark {
+        size_t numBlocks;
+        size_t offset;
+    };
+
+    Arena() = default;
+
+    /**
+     * Returns 'bytes' bytes of uninitialized memory, which stays valid until the arena is
+     * destroyed or released to a mark taken before this call.
+     */
+    void* allocate(size_t bytes);
+
+    Mark mark() const;
+
+    /**
+     * Frees everything allocated since 'mark' was taken. Blocks allocated since are returned to
+     * the system, except that the first block is always kept for reuse.
+     */
+    void release(const Mark& mark);
+
+    /**
+     * The number of allocate() calls so far, each of which would otherwise have been a call to
+     * the global allocator.
+     */
+    size_t allocations() const {
+        return _allocations;
+    }
+
+    /**
+     * The number of blocks the arena took from the global allocator so far.
+     */
+    size_t blockAllocations() const {
+        return _blockAllocations;
+    }
+
+    /**
+     * The bytes of the blocks the arena holds now.
+     */
+    size_t bytesReserved() const;
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> _blocks;
+
+    // The bytes used of the last block.
+    size_t _offset = 0;
+
+    size_t _allocations = 0;
+    size_t _blockAllocations = 0;
+};
+
+/**
+ * Releases the memory allocated from an arena while it is in scope when it is destroyed, so that
+ * a long operation reuses the same blocks for each of its scratch structures. Nothing allocated
+ * from the arena in the scope may be used after it. Does nothing if 'arena' is null.
+ */
+class ArenaScope {
+    MONGO_DISALLOW_COPYING(ArenaScope);
+
+public:
+    explicit ArenaScope(Arena* arena) : _arena(arena) {
+        if (_arena) {
+            _mark = _arena->mark();
+        }
+    }
+
+    ~ArenaScope() {
+        if (_arena) {
+            _arena->release(_mark);
+        }
+    }
+
+private:
+    Arena* const _arena;
+    Arena::Mark _mark;
+};
+
+/**
+ * An STL allocator which allocates from an Arena, and never frees what the containers using it
+ * give back. Falls back to the global allocator when constructed without an arena, so that
+ * containers can use it whether or not their caller has one.
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template <typename U>
+    struct rebind {
+        typedef ArenaAllocator<U> other;
+    };
+
+    explicit ArenaAllocator(Arena* arena = nullptr) : _arena(arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other)
+        : _arena(other.arena()) {}
+
+    T* allocate(size_t n) {
+        if (!_arena) {
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T*>(_arena->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        if (!_arena) {
+            ::operator delete(p);
+        }
+    }
+
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    template <typename U>
+    void destroy(U* p) {
+        p->~U();
+    }
+
+    size_t max_size() const {
+        return size_t(-1) / sizeof(T);
+    }
+
+    Arena* arena() const {
+        return _arena;
+    }
+
+private:
+    Arena* _arena;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+    return lhs.arena() == rhs.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+    return !(lhs == rhs);
+}
+
+}  // namespace mongo
@@ -0,0 +1,145 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/arena.h"
+
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+
+TEST(ArenaTest, AllocationsAreAlignedAndDistinct) {
+    Arena arena;
+    char* a = static_cast<char*>(arena.allocate(1));
+    char* b = static_cast<char*>(arena.allocate(17));
+    char* c = static_cast<char*>(arena.allocate(0));
+    ASSERT_EQUALS(0U, reinterpret_cast<uintptr_t>(a) % Arena::kAlignment);
+    ASSERT_EQUALS(0U, reinterpret_cast<uintptr_t>(b) % Arena::kAlignment);
+    ASSERT_EQUALS(0U, reinterpret_cast<uintptr_t>(c) % Arena::kAlignment);
+    ASSERT_EQUALS(a + Arena::kAlignment, b);
+    ASSERT_EQUALS(b + 2 * Arena::kAlignment, c);
+    ASSERT_EQUALS(3U, arena.allocations());
+    ASSERT_EQUALS(1U, arena.blockAllocations());
+    ASSERT_EQUALS(Arena::kMinBlockBytes, arena.bytesReserved());
+}
+
+TEST(ArenaTest, BlocksGrowAndLargeAllocationsGetTheirOwn) {
+    Arena arena;
+    arena.allocate(Arena::kMinBlockBytes);
+    arena.allocate(1);
+    ASSERT_EQUALS(2U, arena.blockAllocations());
+    ASSERT_EQUALS(3 * Arena::kMinBlockBytes, arena.bytesReserved());
+
+    const size_t large = 4 * Arena::kMaxBlockBytes;
+    char* p = static_cast<char*>(arena.allocate(large));
+    memset(p, 'x', large);
+    ASSERT_EQUALS(3U, arena.blockAllocations());
+    ASSERT_EQUALS(3 * Arena::kMinBlockBytes + large, arena.bytesReserved());
+}
+
+TEST(ArenaTest, ReleaseToMark) {
+    Arena arena;
+    arena.allocate(100);
+    const Arena::Mark mark = arena.mark();
+    void* afterMark = arena.allocate(100);
+    for (int i = 0; i < 10; i++) {
+        arena.allocate(Arena::kMaxBlockBytes);
+    }
+    const size_t reservedBeforeMark = Arena::kMinBlockBytes;
+    ASSERT_GREATER_THAN(arena.bytesReserved(), reservedBeforeMark);
+
+    arena.release(mark);
+    ASSERT_EQUALS(reservedBeforeMark, arena.bytesReserved());
+    ASSERT_EQUALS(afterMark, arena.allocate(100));
+}
+
+TEST(ArenaTest, ScopeKeepsFirstBlock) {
+    Arena arena;
+    void* first;
+    {
+        ArenaScope scope(&arena);
+        first = arena.allocate(10);
+        arena.allocate(2 * Arena::kMaxBlockBytes);
+    }
+    ASSERT_EQUALS(Arena::kMinBlockBytes, arena.bytesReserved());
+    {
+        ArenaScope scope(&arena);
+        ASSERT_EQUALS(first, arena.allocate(10));
+    }
+    ASSERT_EQUALS(2U, arena.blockAllocations());
+
+    // A scope without an arena does nothing.
+    ArenaScope noArena(nullptr);
+}
+
+TEST(ArenaAllocatorTest, ContainersAllocateFromArena) {
+    Arena arena;
+    typedef ArenaAllocator<std::pair<const int, int>> MapAllocator;
+    std::unordered_map<int, int, std::hash<int>, std::equal_to<int>, MapAllocator> map(
+        0, std::hash<int>(), std::equal_to<int>(), MapAllocator(&arena));
+    std::vector<int, ArenaAllocator<int>> vec{ArenaAllocator<int>(&arena)};
+    std::list<int, ArenaAllocator<int>> list{ArenaAllocator<int>(&arena)};
+    for (int i = 0; i < 1000; i++) {
+        map[i] = i * 2;
+        vec.push_back(i);
+        list.push_back(i);
+    }
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQUALS(i * 2, map[i]);
+        ASSERT_EQUALS(i, vec[i]);
+    }
+    ASSERT_EQUALS(1000U, list.size());
+    ASSERT_GREATER_THAN(arena.allocations(), 2000U);
+    ASSERT_LESS_THAN(arena.blockAllocations(), arena.allocations() / 10);
+}
+
+TEST(ArenaAllocatorTest, WithoutArenaUsesGlobalAllocator) {
+    std::vector<int, ArenaAllocator<int>> vec;
+    std::list<int, ArenaAllocator<int>> list;
+    for (int i = 0; i < 1000; i++) {
+        vec.push_back(i);
+        list.push_back(i);
+    }
+    ASSERT_EQUALS(999, vec.back());
+    ASSERT_EQUALS(999, list.back());
+    ASSERT(ArenaAllocator<int>() == ArenaAllocator<char>());
+
+    Arena arena;
+    ASSERT(ArenaAllocator<int>(&arena) != ArenaAllocator<int>());
+}
+
+}  // namespace
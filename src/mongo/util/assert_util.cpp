@@ -46,6 +46,7 @@ using namespace std;
 
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/config.h"
+#include "mongo/logger/async_appender.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/debugger.h"
 #include "mongo/util/exit.h"
@@ -147,6 +148,7 @@ NOINLINE_DECL void verifyFailed(const char* expr, const char* file, unsigned lin
 }
 
 NOINLINE_DECL void invariantFailed(const char* expr, const char* file, unsigned line) {
+    logger::AsyncAppender::flushAllAndWriteSynchronously();
     log() << "Invariant failure " << expr << ' ' << file << ' ' << dec << line << endl;
     breakpoint();
     log() << "\n\n***aborting after invariant() failure\n\n" << endl;
@@ -157,6 +159,7 @@ NOINLINE_DECL void invariantOKFailed(const char* expr,
                                      const Status& status,
                                      const char* file,
                                      unsigned line) {
+    logger::AsyncAppender::flushAllAndWriteSynchronously();
     log() << "Invariant failure: " << expr << " resulted in status " << status << " at " << file
           << ' ' << dec << line;
     logContext();
@@ -166,6 +169,7 @@ NOINLINE_DECL void invariantOKFailed(const char* expr,
 }
 
 NOINLINE_DECL void fassertFailed(int msgid) {
+    logger::AsyncAppender::flushAllAndWriteSynchronously();
     log() << "Fatal Assertion " << msgid << endl;
     breakpoint();
     log() << "\n\n***aborting after fassert() failure\n\n" << endl;
@@ -173,6 +177,7 @@ NOINLINE_DECL void fassertFailed(int msgid) {
 }
 
 NOINLINE_DECL void fassertFailedNoTrace(int msgid) {
+    logger::AsyncAppender::flushAllAndWriteSynchronously();
     log() << "Fatal Assertion " << msgid << endl;
     breakpoint();
     log() << "\n\n***aborting after fassert() failure\n\n" << endl;
@@ -180,6 +185,7 @@ NOINLINE_DECL void fassertFailedNoTrace(int msgid) {
 }
 
 MONGO_COMPILER_NORETURN void fassertFailedWithStatus(int msgid, const Status& status) {
+    logger::AsyncAppender::flushAllAndWriteSynchronously();
     log() << "Fatal assertion " << msgid << " " << status;
     logContext();
     breakpoint();
@@ -188,6 +194,7 @@ MONGO_COMPILER_NORETURN void fassertFailedWithStatus(int msgid, const Status& st
 }
 
 MONGO_COMPILER_NORETURN void fassertFailedWithStatusNoTrace(int msgid, const Status& status) {
+    logger::AsyncAppender::flushAllAndWriteSynchronously();
     log() << "Fatal assertion " << msgid << " " << status;
     breakpoint();
     log() << "\n\n***aborting after fassert() failure\n\n" << endl;
@@ -37,14 +37,14 @@
 namespace mongo {
 namespace {
 
-ThreadPool::Options makeOptions(int nThreads, const std::string& threadNamePrefix) {
+WorkStealingThreadPool::Options makeOptions(int nThreads, const std::string& threadNamePrefix) {
     fassert(28706, nThreads > 0);
-    ThreadPool::Options options;
+    WorkStealingThreadPool::Options options;
     if (!threadNamePrefix.empty()) {
         options.threadNamePrefix = threadNamePrefix;
         options.poolName = str::stream() << threadNamePrefix << "Pool";
     }
-    options.maxThreads = options.minThreads = static_cast<size_t>(nThreads);
+    options.numThreads = static_cast<size_t>(nThreads);
     return options;
 }
 
@@ -31,7 +31,7 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/stdx/functional.h"
-#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/concurrency/work_stealing_thread_pool.h"
 
 namespace mongo {
 
@@ -39,7 +39,9 @@ namespace mongo {
  * Implementation of a fixed-size pool of threads that can perform scheduled
  * tasks.
  *
- * Deprecated.  Use ThreadPool from thread_pool.h, instead.
+ * The tasks run on a WorkStealingThreadPool, since the pool never grows or shrinks.
+ *
+ * Deprecated.  Use ThreadPool from thread_pool.h, or WorkStealingThreadPool, instead.
  */
 class OldThreadPool {
     MONGO_DISALLOW_COPYING(OldThreadPool);
@@ -89,7 +91,7 @@ public:
     }
 
 private:
-    ThreadPool _pool;
+    WorkStealingThreadPool _pool;
 };
 
 }  // namespace mongo
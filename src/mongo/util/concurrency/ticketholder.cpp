@@ -33,6 +33,7 @@
 
 #include <iostream>
 
+#include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 
@@ -71,18 +72,7 @@ bool TicketHolder::tryAcquire() {
     return true;
 }
 
-void TicketHolder::waitForTicket() {
-    while (0 != sem_wait(&_sem)) {
-        switch (errno) {
-            case EINTR:
-                break;
-            default:
-                _check(-1);
-        }
-    }
-}
-
-void TicketHolder::release() {
+void TicketHolder::_releaseToPool() {
     _check(sem_post(&_sem));
 }
 
@@ -137,41 +127,35 @@ bool TicketHolder::tryAcquire() {
     return _tryAcquire();
 }
 
-void TicketHolder::waitForTicket() {
-    stdx::unique_lock<stdx::mutex> lk(_mutex);
-
-    while (!_tryAcquire()) {
-        _newTicket.wait(lk);
-    }
+void TicketHolder::_releaseToPool() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _num++;
 }
 
-void TicketHolder::release() {
+Status TicketHolder::resize(int newSize) {
     {
         stdx::lock_guard<stdx::mutex> lk(_mutex);
-        _num++;
-    }
-    _newTicket.notify_one();
-}
 
-Status TicketHolder::resize(int newSize) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
+        int used = _outof.load() - _num;
+        if (used > newSize) {
+            std::stringstream ss;
+            ss << "can't resize since we're using (" << used << ") "
+               << "more than newSize(" << newSize << ")";
 
-    int used = _outof.load() - _num;
-    if (used > newSize) {
-        std::stringstream ss;
-        ss << "can't resize since we're using (" << used << ") "
-           << "more than newSize(" << newSize << ")";
+            std::string errmsg = ss.str();
+            log() << errmsg;
+            return Status(ErrorCodes::BadValue, errmsg);
+        }
 
-        std::string errmsg = ss.str();
-        log() << errmsg;
-        return Status(ErrorCodes::BadValue, errmsg);
+        _outof.store(newSize);
+        _num = _outof.load() - used;
     }
 
-    _outof.store(newSize);
-    _num = _outof.load() - used;
-
-    // Potentially wasteful, but easier to see is correct
-    _newTicket.notify_all();
+    // Waiters are granted tickets under _waitersMutex, which must not be taken under _mutex
+    if (_numWaiters.load() > 0) {
+        stdx::lock_guard<stdx::mutex> lk(_waitersMutex);
+        _grantWaiters_inlock();
+    }
     return Status::OK();
 }
 
@@ -198,4 +182,66 @@ bool TicketHolder::_tryAcquire() {
     return true;
 }
 #endif
+
+const char* TicketHolder::priorityName(Priority priority) {
+    switch (priority) {
+        case Priority::kLow:
+            return "low";
+        case Priority::kNormal:
+            return "normal";
+        case Priority::kHigh:
+            return "high";
+    }
+    MONGO_UNREACHABLE;
+}
+
+void TicketHolder::waitForTicket(Priority priority) {
+    if (tryAcquire()) {
+        return;
+    }
+
+    stdx::unique_lock<stdx::mutex> lk(_waitersMutex);
+
+    // Counting this request as a waiter before trying again guarantees that a ticket is either
+    // taken here or handed to this request by the release that returns it.
+    _numWaiters.fetchAndAdd(1);
+    if (tryAcquire()) {
+        _numWaiters.fetchAndSubtract(1);
+        return;
+    }
+
+    Waiter waiter;
+    _waiters[static_cast<int>(priority)].push_back(&waiter);
+    waiter.granted.wait(lk, [&waiter] { return waiter.isGranted; });
+}
+
+void TicketHolder::release() {
+    _releaseToPool();
+    if (_numWaiters.load() > 0) {
+        stdx::lock_guard<stdx::mutex> lk(_waitersMutex);
+        _grantWaiters_inlock();
+    }
+}
+
+int TicketHolder::waiting(Priority priority) const {
+    stdx::lock_guard<stdx::mutex> lk(_waitersMutex);
+    return _waiters[static_cast<int>(priority)].size();
+}
+
+void TicketHolder::_grantWaiters_inlock() {
+    for (int priority = kNumPriorities - 1; priority >= 0; priority--) {
+        std::deque<Waiter*>& waiters = _waiters[priority];
+        while (!waiters.empty()) {
+            if (!tryAcquire()) {
+                return;
+            }
+
+            Waiter* waiter = waiters.front();
+            waiters.pop_front();
+            _numWaiters.fetchAndSubtract(1);
+            waiter->isGranted = true;
+            waiter->granted.notify_one();
+        }
+    }
+}
 }
@@ -30,23 +30,39 @@
 #include <semaphore.h>
 #endif
 
+#include <deque>
+
 #include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/mutex.h"
 
 namespace mongo {
 
+/**
+ * Counting semaphore handing out a limited number of tickets. Requests which have to wait for a
+ * ticket are queued by priority: released tickets go to the oldest waiting request of the
+ * highest priority. A request that arrives while a ticket is free takes it without queueing.
+ */
 class TicketHolder {
     MONGO_DISALLOW_COPYING(TicketHolder);
 
 public:
+    enum class Priority { kLow = 0, kNormal, kHigh };
+    static const int kNumPriorities = 3;
+
+    /**
+     * Returns the name of the priority, as used in diagnostics and in the $priority option.
+     */
+    static const char* priorityName(Priority priority);
+
     explicit TicketHolder(int num);
     ~TicketHolder();
 
     bool tryAcquire();
 
-    void waitForTicket();
+    void waitForTicket(Priority priority = Priority::kNormal);
 
     void release();
 
@@ -58,7 +74,30 @@ public:
 
     int outof() const;
 
+    /**
+     * Returns how many requests of the given priority are currently waiting for a ticket.
+     */
+    int waiting(Priority priority) const;
+
 private:
+    struct Waiter {
+        stdx::condition_variable granted;
+        bool isGranted = false;
+    };
+
+    // Returns a released ticket to the pool, without handing it to a waiting request
+    void _releaseToPool();
+
+    // Hands tickets from the pool to waiting requests, in priority order, until either runs out
+    void _grantWaiters_inlock();
+
+    mutable stdx::mutex _waitersMutex;
+    std::deque<Waiter*> _waiters[kNumPriorities];
+
+    // Number of queued waiters, readable without _waitersMutex, so that releasing a ticket does
+    // not take the mutex when nobody waits. Only changed under _waitersMutex.
+    AtomicInt32 _numWaiters;
+
 #if defined(__linux__)
     mutable sem_t _sem;
 
@@ -71,7 +110,6 @@ private:
     AtomicInt32 _outof;
     int _num;
     stdx::mutex _mutex;
-    stdx::condition_variable _newTicket;
 #endif
 };
 
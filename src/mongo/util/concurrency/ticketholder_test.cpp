@@ -0,0 +1,121 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/time_support.h"
+
+namespace {
+
+using mongo::TicketHolder;
+
+namespace stdx = mongo::stdx;
+
+typedef TicketHolder::Priority Priority;
+
+TEST(TicketHolderTest, AcquireAndRelease) {
+    TicketHolder holder(2);
+    ASSERT_TRUE(holder.tryAcquire());
+    holder.waitForTicket(Priority::kLow);
+    ASSERT_EQUALS(0, holder.available());
+    ASSERT_EQUALS(2, holder.used());
+    ASSERT_FALSE(holder.tryAcquire());
+
+    holder.release();
+    holder.release();
+    ASSERT_EQUALS(2, holder.available());
+    ASSERT_EQUALS(0, holder.waiting(Priority::kNormal));
+}
+
+TEST(TicketHolderTest, WaitersAreGrantedInPriorityOrder) {
+    TicketHolder holder(1);
+    ASSERT_TRUE(holder.tryAcquire());
+
+    stdx::mutex mutex;
+    std::vector<Priority> grantOrder;
+
+    // Queue the waiters in ascending priority, each with two requests.
+    const Priority priorities[] = {Priority::kLow, Priority::kNormal, Priority::kHigh};
+    std::vector<stdx::thread> threads;
+    for (Priority priority : priorities) {
+        for (int i = 0; i < 2; i++) {
+            threads.emplace_back([&holder, &mutex, &grantOrder, priority] {
+                holder.waitForTicket(priority);
+                {
+                    stdx::lock_guard<stdx::mutex> lk(mutex);
+                    grantOrder.push_back(priority);
+                }
+                holder.release();
+            });
+        }
+
+        while (holder.waiting(priority) < 2) {
+            mongo::sleepmillis(1);
+        }
+    }
+
+    // Each waiter releases its ticket once granted, which hands it on to the next waiter.
+    holder.release();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const std::vector<Priority> expected = {Priority::kHigh,
+                                            Priority::kHigh,
+                                            Priority::kNormal,
+                                            Priority::kNormal,
+                                            Priority::kLow,
+                                            Priority::kLow};
+    ASSERT_TRUE(expected == grantOrder);
+    ASSERT_EQUALS(1, holder.available());
+}
+
+TEST(TicketHolderTest, ResizeGrantsWaiters) {
+    TicketHolder holder(5);
+    for (int i = 0; i < 5; i++) {
+        ASSERT_TRUE(holder.tryAcquire());
+    }
+
+    stdx::thread waiter([&holder] { holder.waitForTicket(Priority::kHigh); });
+    while (holder.waiting(Priority::kHigh) < 1) {
+        mongo::sleepmillis(1);
+    }
+
+    ASSERT_OK(holder.resize(6));
+    waiter.join();
+    ASSERT_EQUALS(0, holder.waiting(Priority::kHigh));
+    ASSERT_EQUALS(6, holder.used());
+}
+
+}  // namespace
@@ -0,0 +1,332 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kExecutor
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/work_stealing_thread_pool.h"
+
+#include "mongo/base/status.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+namespace {
+
+// Counter used to assign unique names to otherwise-unnamed thread pools.
+AtomicInt32 nextUnnamedThreadPoolId{1};
+
+/**
+ * Sets defaults and checks bounds limits on "options", and returns it.
+ */
+WorkStealingThreadPool::Options cleanUpOptions(WorkStealingThreadPool::Options&& options) {
+    if (options.poolName.empty()) {
+        options.poolName = str::stream() << "WorkStealingThreadPool"
+                                         << nextUnnamedThreadPoolId.fetchAndAdd(1);
+    }
+    if (options.threadNamePrefix.empty()) {
+        options.threadNamePrefix = str::stream() << options.poolName << '-';
+    }
+    if (options.numThreads < 1) {
+        severe() << "Tried to create pool " << options.poolName << " with "
+                 << options.numThreads << " threads but it needs at least 1";
+        fassertFailed(28818);
+    }
+    return options;
+}
+
+}  // namespace
+
+MONGO_TRIVIALLY_CONSTRUCTIBLE_THREAD_LOCAL WorkStealingThreadPool::Worker*
+    WorkStealingThreadPool::_currentWorker;
+
+WorkStealingThreadPool::WorkStealingThreadPool(Options options)
+    : _options(cleanUpOptions(std::move(options))), _workers([this] {
+          std::vector<std::unique_ptr<Worker>> workers;
+          for (size_t i = 0; i < _options.numThreads; ++i) {
+              workers.emplace_back(new Worker(this, i));
+          }
+          return workers;
+      }()) {}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+    bool needsJoin;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _shutdown_inlock();
+        needsJoin = (_state != shutdownComplete);
+    }
+    if (needsJoin) {
+        join();
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (shutdownComplete != _state) {
+        severe() << "Failed to shutdown pool during destruction";
+        fassertFailed(28819);
+    }
+    invariant(_threads.empty());
+    for (const auto& worker : _workers) {
+        invariant(worker->tasks.empty());
+    }
+}
+
+void WorkStealingThreadPool::startup() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_state != preStart) {
+        severe() << "Attempting to start pool " << _options.poolName
+                 << ", but it has already started";
+        fassertFailed(28820);
+    }
+    _setState_inlock(running);
+    invariant(_threads.empty());
+    for (const auto& worker : _workers) {
+        const std::string threadName = str::stream() << _options.threadNamePrefix << worker->id;
+        _threads.emplace_back(
+            stdx::bind(&WorkStealingThreadPool::_workerThreadBody, worker.get(), threadName));
+    }
+}
+
+void WorkStealingThreadPool::shutdown() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _shutdown_inlock();
+}
+
+void WorkStealingThreadPool::_shutdown_inlock() {
+    switch (_state) {
+        case preStart:
+        case running:
+            _shutdownRequested.store(1);
+            _setState_inlock(joinRequired);
+            _workAvailable.notify_all();
+            return;
+        case joinRequired:
+        case joining:
+        case shutdownComplete:
+            return;
+    }
+    MONGO_UNREACHABLE;
+}
+
+void WorkStealingThreadPool::join() {
+    try {
+        {
+            stdx::unique_lock<stdx::mutex> lk(_mutex);
+            _stateChange.wait(lk,
+                              [this] {
+                                  switch (_state) {
+                                      case preStart:
+                                      case running:
+                                          return false;
+                                      case joinRequired:
+                                          return true;
+                                      case joining:
+                                      case shutdownComplete:
+                                          severe() << "Attempted to join pool "
+                                                   << _options.poolName << " more than once";
+                                          fassertFailed(28821);
+                                  }
+                                  MONGO_UNREACHABLE;
+                              });
+            _setState_inlock(joining);
+        }
+
+        // Help the workers drain the queues. This also runs the tasks of a pool that was never
+        // started.
+        _consumeTasks(nullptr);
+
+        std::vector<stdx::thread> threadsToJoin;
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            swap(threadsToJoin, _threads);
+        }
+        for (auto& t : threadsToJoin) {
+            t.join();
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        invariant(_state == joining);
+        _setState_inlock(shutdownComplete);
+    } catch (...) {
+        std::terminate();
+    }
+}
+
+Status WorkStealingThreadPool::schedule(Task task) {
+    // Counting the task as unfinished before checking for shutdown guarantees that the workers
+    // and join() wait for it if it is accepted.
+    _numUnfinishedTasks.fetchAndAdd(1);
+    if (_shutdownRequested.load()) {
+        _finishTask();
+        return Status(ErrorCodes::ShutdownInProgress,
+                      str::stream() << "Shutdown of thread pool " << _options.poolName
+                                    << " in progress");
+    }
+
+    Worker* worker = _currentWorker;
+    if (!worker || worker->pool != this) {
+        worker = _workers[_nextWorker.fetchAndAdd(1) % _workers.size()].get();
+    }
+    {
+        stdx::lock_guard<stdx::mutex> lk(worker->mutex);
+        worker->tasks.emplace_back(std::move(task));
+    }
+
+    // A worker increments _numSleepers under _mutex before it checks _numPendingTasks for the last
+    // time, so either it sees this task or this sees it and wakes it up.
+    _numPendingTasks.fetchAndAdd(1);
+    if (_numSleepers.load() > 0) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _workAvailable.notify_one();
+    }
+    return Status::OK();
+}
+
+void WorkStealingThreadPool::waitForIdle() {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    while (_numUnfinishedTasks.load() > 0) {
+        _poolIsIdle.wait(lk);
+    }
+}
+
+WorkStealingThreadPool::Stats WorkStealingThreadPool::getStats() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    Stats result;
+    result.options = _options;
+    result.numThreads = _threads.size();
+    result.numPendingTasks = static_cast<size_t>(std::max(0LL, _numPendingTasks.load()));
+    result.numTasksStolen = _numTasksStolen.load();
+    return result;
+}
+
+void WorkStealingThreadPool::_workerThreadBody(Worker* worker, const std::string& threadName) {
+    const std::string poolName = worker->pool->_options.poolName;
+    setThreadName(threadName);
+    LOG(1) << "starting thread in pool " << poolName;
+    _currentWorker = worker;
+    try {
+        worker->pool->_consumeTasks(worker);
+    } catch (...) {
+        severe() << "Exception reached top of stack in thread pool " << poolName;
+        std::terminate();
+    }
+    _currentWorker = nullptr;
+    LOG(1) << "shutting down thread in pool " << poolName;
+}
+
+void WorkStealingThreadPool::_consumeTasks(Worker* self) {
+    while (true) {
+        Task task;
+        if (_takeTask(self, &task)) {
+            _runTask(&task);
+            continue;
+        }
+
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _numSleepers.fetchAndAdd(1);
+        while (_numPendingTasks.load() <= 0 && !_workerMayExit_inlock()) {
+            _workAvailable.wait(lk);
+        }
+        _numSleepers.fetchAndSubtract(1);
+        if (_numPendingTasks.load() <= 0) {
+            return;
+        }
+    }
+}
+
+bool WorkStealingThreadPool::_takeTask(Worker* self, Task* task) {
+    if (self) {
+        stdx::lock_guard<stdx::mutex> lk(self->mutex);
+        if (!self->tasks.empty()) {
+            *task = std::move(self->tasks.front());
+            self->tasks.pop_front();
+            _numPendingTasks.fetchAndSubtract(1);
+            return true;
+        }
+    }
+
+    // Start with the next worker over, so that idle workers don't all pile onto the first queue.
+    const size_t numWorkers = _workers.size();
+    const size_t first = self ? self->id + 1 : 0;
+    for (size_t i = 0; i < numWorkers; ++i) {
+        Worker* victim = _workers[(first + i) % numWorkers].get();
+        if (victim == self) {
+            continue;
+        }
+        stdx::lock_guard<stdx::mutex> lk(victim->mutex);
+        if (!victim->tasks.empty()) {
+            *task = std::move(victim->tasks.front());
+            victim->tasks.pop_front();
+            _numPendingTasks.fetchAndSubtract(1);
+            _numTasksStolen.fetchAndAdd(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingThreadPool::_runTask(Task* task) {
+    try {
+        LOG(3) << "Executing a task on behalf of pool " << _options.poolName;
+        (*task)();
+    } catch (...) {
+        severe() << "Exception escaped task in thread pool " << _options.poolName;
+        std::terminate();
+    }
+    *task = Task();
+    _finishTask();
+}
+
+void WorkStealingThreadPool::_finishTask() {
+    if (_numUnfinishedTasks.subtractAndFetch(1) > 0) {
+        return;
+    }
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _poolIsIdle.notify_all();
+    if (_shutdownRequested.load()) {
+        // The sleeping workers may exit now.
+        _workAvailable.notify_all();
+    }
+}
+
+bool WorkStealingThreadPool::_workerMayExit_inlock() const {
+    return _shutdownRequested.load() && _numUnfinishedTasks.load() == 0;
+}
+
+void WorkStealingThreadPool::_setState_inlock(const LifecycleState newState) {
+    if (newState == _state) {
+        return;
+    }
+    _state = newState;
+    _stateChange.notify_all();
+}
+
+}  // namespace mongo
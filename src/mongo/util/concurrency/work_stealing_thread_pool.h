@@ -0,0 +1,236 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/thread_pool_interface.h"
+#include "mongo/util/concurrency/threadlocal.h"
+
+namespace mongo {
+
+class Status;
+
+/**
+ * A fixed-size thread pool in which every worker thread owns its own queue of tasks.
+ *
+ * Tasks scheduled by a thread of the pool go to that thread's own queue, and tasks scheduled by
+ * any other thread are spread round-robin over the queues, so schedule() never takes a lock shared
+ * by the whole pool while the workers are busy. A worker whose queue is empty steals the oldest
+ * task from the queues of the other workers, and only sleeps on the pool-wide condition variable
+ * when there is no pending task left anywhere.
+ *
+ * The lifecycle is the same as ThreadPool's: tasks may be scheduled before startup(), are refused
+ * once shutdown() has been called, and every task accepted by schedule() runs before join()
+ * returns.
+ */
+class WorkStealingThreadPool final : public ThreadPoolInterface {
+    MONGO_DISALLOW_COPYING(WorkStealingThreadPool);
+
+public:
+    /**
+     * Structure used to configure an instance of WorkStealingThreadPool.
+     */
+    struct Options {
+        // Name of the thread pool. If this string is empty, the pool will be assigned a
+        // name unique to the current process.
+        std::string poolName;
+
+        // Prefix used to name threads for logging purposes. An integer will be appended to this
+        // string to create the thread name for each thread in the pool. If you leave this empty,
+        // the prefix will be the pool name followed by a hyphen.
+        std::string threadNamePrefix;
+
+        // Number of worker threads, all of which are started by startup() and live until join().
+        size_t numThreads = 8;
+    };
+
+    /**
+     * Structure used to return information about the thread pool via getStats().
+     */
+    struct Stats {
+        // The options for the instance of the pool returning these stats.
+        Options options;
+
+        // The number of threads currently in the pool.
+        size_t numThreads;
+
+        // The number of tasks waiting to be executed by the pool.
+        size_t numPendingTasks;
+
+        // The number of tasks that ran on a thread other than the one whose queue held them.
+        unsigned long long numTasksStolen;
+    };
+
+    /**
+     * Constructs a thread pool, configured with the given "options".
+     */
+    explicit WorkStealingThreadPool(Options options);
+
+    ~WorkStealingThreadPool() override;
+
+    void startup() override;
+    void shutdown() override;
+    void join() override;
+    Status schedule(Task task) override;
+
+    /**
+     * Blocks the caller until every task scheduled so far has finished running.
+     *
+     * Like ThreadPool::waitForIdle, there is no guarantee that the pool is still idle when this
+     * returns unless shutdown() was called first. May not be called by a task in the thread pool.
+     */
+    void waitForIdle();
+
+    /**
+     * Returns statistics about the thread pool's utilization.
+     */
+    Stats getStats();
+
+private:
+    /**
+     * The queue of tasks owned by one worker thread. Its mutex is only contended when another
+     * thread schedules onto, or steals from, this queue.
+     */
+    struct Worker {
+        Worker(WorkStealingThreadPool* pool, size_t id) : pool(pool), id(id) {}
+
+        WorkStealingThreadPool* const pool;
+        const size_t id;
+        stdx::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    /**
+     * Representation of the stage of life of a thread pool. See ThreadPool::LifecycleState.
+     */
+    enum LifecycleState { preStart, running, joinRequired, joining, shutdownComplete };
+
+    /**
+     * This is the thread body for worker threads.
+     */
+    static void _workerThreadBody(Worker* worker, const std::string& threadName);
+
+    /**
+     * This is the run loop of a worker thread, invoked by _workerThreadBody.
+     */
+    void _consumeTasks(Worker* worker);
+
+    /**
+     * Pops the oldest task from the queue of "self", or if that is empty, steals the oldest task
+     * from the queue of another worker. "self" is null when the caller is not a worker thread.
+     * Returns false if every queue was empty.
+     */
+    bool _takeTask(Worker* self, Task* task);
+
+    /**
+     * Runs "task", and wakes up the threads waiting for the pool to drain if it was the last
+     * unfinished one.
+     */
+    void _runTask(Task* task);
+
+    /**
+     * Marks one task accepted by schedule() as done.
+     */
+    void _finishTask();
+
+    /**
+     * Returns true if a worker thread has nothing more to do and may exit. The caller must own
+     * _mutex.
+     */
+    bool _workerMayExit_inlock() const;
+
+    /**
+     * Implementation of shutdown once _mutex is locked.
+     */
+    void _shutdown_inlock();
+
+    /**
+     * Changes the lifecycle state (_state) of the pool and wakes up any threads waiting for a state
+     * change. Has no effect if _state == newState.
+     */
+    void _setState_inlock(LifecycleState newState);
+
+    // The worker whose thread is the current thread, or null if the current thread is not a
+    // worker of any WorkStealingThreadPool.
+    static MONGO_TRIVIALLY_CONSTRUCTIBLE_THREAD_LOCAL Worker* _currentWorker;
+
+    // These are the options with which the pool was configured at construction time.
+    const Options _options;
+
+    // One entry per worker thread. Fixed at construction.
+    const std::vector<std::unique_ptr<Worker>> _workers;
+
+    // Set once shutdown() has been called; read without _mutex by schedule() and the workers.
+    AtomicUInt32 _shutdownRequested;
+
+    // Number of tasks sitting in the workers' queues. May lag behind the queues briefly, or go
+    // negative while a scheduled task is taken before schedule() counts it.
+    AtomicInt64 _numPendingTasks;
+
+    // Number of tasks accepted by schedule() that have not finished running, plus schedule() calls
+    // that have not yet decided whether to accept their task.
+    AtomicInt64 _numUnfinishedTasks;
+
+    // Number of worker threads waiting on _workAvailable.
+    AtomicUInt32 _numSleepers;
+
+    // Round-robin counter used to pick a queue for tasks scheduled by non-worker threads.
+    AtomicUInt64 _nextWorker;
+
+    AtomicUInt64 _numTasksStolen;
+
+    // Mutex guarding _state and _threads, and used by threads that sleep on the condition
+    // variables below.
+    stdx::mutex _mutex;
+
+    LifecycleState _state = preStart;
+
+    // Condition signaled when a task is scheduled while some worker sleeps, when the last
+    // unfinished task is done, or when the pool shuts down.
+    stdx::condition_variable _workAvailable;
+
+    // Condition signaled when the last unfinished task is done.
+    stdx::condition_variable _poolIsIdle;
+
+    // Condition variable signaled whenever _state changes.
+    stdx::condition_variable _stateChange;
+
+    std::vector<stdx::thread> _threads;
+};
+
+}  // namespace mongo
@@ -0,0 +1,194 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+#include "mongo/platform/basic.h"
+
+#include <boost/optional.hpp>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/death_test.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/work_stealing_thread_pool.h"
+#include "mongo/util/time_support.h"
+
+namespace {
+using namespace mongo;
+
+WorkStealingThreadPool::Options makeOptions(size_t numThreads) {
+    WorkStealingThreadPool::Options options;
+    options.numThreads = numThreads;
+    return options;
+}
+
+TEST(WorkStealingThreadPoolTest, UnusedPool) {
+    WorkStealingThreadPool pool((WorkStealingThreadPool::Options()));
+}
+
+TEST(WorkStealingThreadPoolTest, CannotScheduleAfterShutdown) {
+    WorkStealingThreadPool pool((WorkStealingThreadPool::Options()));
+    pool.shutdown();
+    ASSERT_EQ(ErrorCodes::ShutdownInProgress, pool.schedule([] {}));
+}
+
+TEST(WorkStealingThreadPoolTest, StartsAllThreads) {
+    WorkStealingThreadPool pool(makeOptions(5));
+    ASSERT_EQ(0U, pool.getStats().numThreads);
+    pool.startup();
+    ASSERT_EQ(5U, pool.getStats().numThreads);
+}
+
+TEST(WorkStealingThreadPoolTest, RunsTasksScheduledFromManyThreads) {
+    WorkStealingThreadPool pool(makeOptions(4));
+    pool.startup();
+    AtomicUInt32 count;
+    std::vector<stdx::thread> schedulers;
+    for (int i = 0; i < 8; ++i) {
+        schedulers.emplace_back([&] {
+            for (int j = 0; j < 1000; ++j) {
+                ASSERT_OK(pool.schedule([&count] { count.fetchAndAdd(1); }));
+            }
+        });
+    }
+    for (auto& t : schedulers) {
+        t.join();
+    }
+    pool.waitForIdle();
+    ASSERT_EQ(8000U, count.load());
+    ASSERT_EQ(0U, pool.getStats().numPendingTasks);
+}
+
+TEST(WorkStealingThreadPoolTest, TasksScheduledByTasksRun) {
+    WorkStealingThreadPool pool(makeOptions(3));
+    pool.startup();
+    AtomicUInt32 count;
+    stdx::function<void(int)> fanOut = [&](int depth) {
+        count.fetchAndAdd(1);
+        if (depth == 0) {
+            return;
+        }
+        for (int i = 0; i < 3; ++i) {
+            ASSERT_OK(pool.schedule([&fanOut, depth] { fanOut(depth - 1); }));
+        }
+    };
+    ASSERT_OK(pool.schedule([&fanOut] { fanOut(6); }));
+    pool.waitForIdle();
+    // 1 + 3 + 9 + ... + 3^6 tasks.
+    ASSERT_EQ(1093U, count.load());
+}
+
+TEST(WorkStealingThreadPoolTest, IdleWorkersStealFromBlockedWorker) {
+    // The only worker not blocked must run the tasks that a blocked task queued on its own
+    // worker's queue.
+    WorkStealingThreadPool pool(makeOptions(2));
+    pool.startup();
+    stdx::mutex mutex;
+    stdx::condition_variable cv;
+    bool release = false;
+    AtomicUInt32 count;
+    ASSERT_OK(pool.schedule([&] {
+        for (int i = 0; i < 10; ++i) {
+            ASSERT_OK(pool.schedule([&count] { count.fetchAndAdd(1); }));
+        }
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        while (!release) {
+            cv.wait(lk);
+        }
+    }));
+    while (count.load() < 10U) {
+        sleepmillis(10);
+    }
+    ASSERT_GTE(pool.getStats().numTasksStolen, 10U);
+    {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        release = true;
+        cv.notify_all();
+    }
+    pool.waitForIdle();
+}
+
+TEST(WorkStealingThreadPoolTest, PoolDestructorExecutesRemainingTasks) {
+    AtomicUInt32 count;
+    {
+        WorkStealingThreadPool pool(makeOptions(1));
+        for (int i = 0; i < 10; ++i) {
+            ASSERT_OK(pool.schedule([&count] { count.fetchAndAdd(1); }));
+        }
+    }
+    ASSERT_EQ(10U, count.load());
+}
+
+TEST(WorkStealingThreadPoolTest, PoolJoinExecutesRemainingTasks) {
+    WorkStealingThreadPool pool(makeOptions(2));
+    AtomicUInt32 count;
+    pool.startup();
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_OK(pool.schedule([&count] {
+            sleepmillis(1);
+            count.fetchAndAdd(1);
+        }));
+    }
+    pool.shutdown();
+    pool.join();
+    ASSERT_EQ(100U, count.load());
+    ASSERT_EQ(0U, pool.getStats().numThreads);
+}
+
+DEATH_TEST(WorkStealingThreadPoolTest, NoThreadsDies, "but it needs at least 1") {
+    WorkStealingThreadPool pool(makeOptions(0));
+}
+
+DEATH_TEST(WorkStealingThreadPoolTest, DieOnDoubleStartUp, "it has already started") {
+    WorkStealingThreadPool pool((WorkStealingThreadPool::Options()));
+    pool.startup();
+    pool.startup();
+}
+
+DEATH_TEST(WorkStealingThreadPoolTest,
+           DieWhenExceptionBubblesUp,
+           "Exception escaped task in thread pool") {
+    WorkStealingThreadPool pool((WorkStealingThreadPool::Options()));
+    pool.startup();
+    ASSERT_OK(pool.schedule([] { uassertStatusOK(Status({ErrorCodes::BadValue, "No good"})); }));
+    pool.shutdown();
+    pool.join();
+}
+
+DEATH_TEST(WorkStealingThreadPoolTest,
+           DieOnDoubleJoin,
+           "Attempted to join pool DoubleJoinPool more than once") {
+    WorkStealingThreadPool::Options options;
+    options.poolName = "DoubleJoinPool";
+    WorkStealingThreadPool pool(options);
+    pool.shutdown();
+    pool.join();
+    pool.join();
+}
+
+}  // namespace
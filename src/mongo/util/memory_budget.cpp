@@ -0,0 +1,144 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/memory_budget.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+MemoryBudget* MemoryBudget::get() {
+    // Constructed on first use, so that consumers may register from other static initializers.
+    static MemoryBudget globalMemoryBudget;
+    return &globalMemoryBudget;
+}
+
+void MemoryBudget::registerConsumer(StringData name, MemoryConsumer* consumer) {
+    invariant(consumer);
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _consumers.push_back(Registration{name.toString(), consumer});
+}
+
+void MemoryBudget::unregisterConsumer(MemoryConsumer* consumer) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    auto it = std::find_if(_consumers.begin(),
+                           _consumers.end(),
+                           [consumer](const Registration& r) { return r.consumer == consumer; });
+    invariant(it != _consumers.end());
+    _consumers.erase(it);
+}
+
+void MemoryBudget::setLimit(int64_t bytes) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _limit = std::max(int64_t(0), bytes);
+}
+
+int64_t MemoryBudget::getLimit() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _limit;
+}
+
+int64_t MemoryBudget::totalBytesUsed() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    int64_t total = 0;
+    for (const Registration& r : _consumers) {
+        total += r.consumer->bytesUsed();
+    }
+    return total;
+}
+
+int64_t MemoryBudget::enforce() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_limit == 0) {
+        return 0;
+    }
+
+    std::vector<std::pair<int64_t, MemoryConsumer*>> usage;
+    int64_t total = 0;
+    for (const Registration& r : _consumers) {
+        const int64_t bytes = r.consumer->bytesUsed();
+        usage.emplace_back(bytes, r.consumer);
+        total += bytes;
+    }
+
+    const int64_t excess = total - _limit;
+    if (excess <= 0) {
+        return 0;
+    }
+
+    // Freeing from the largest consumers first touches the fewest of them.
+    typedef std::pair<int64_t, MemoryConsumer*> Usage;
+    std::stable_sort(usage.begin(), usage.end(), [](const Usage& a, const Usage& b) {
+        return a.first > b.first;
+    });
+
+    int64_t freed = 0;
+    for (const auto& u : usage) {
+        if (freed >= excess || u.first <= 0) {
+            break;
+        }
+        const int64_t freedByConsumer = u.second->shrink(std::min(excess - freed, u.first));
+        if (freedByConsumer > 0) {
+            freed += freedByConsumer;
+            _shrinks++;
+        }
+    }
+
+    _bytesFreed += freed;
+    return freed;
+}
+
+void MemoryBudget::appendStats(BSONObjBuilder* builder) const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    std::map<std::string, int64_t> bytesByName;
+    int64_t total = 0;
+    for (const Registration& r : _consumers) {
+        const int64_t bytes = r.consumer->bytesUsed();
+        bytesByName[r.name] += bytes;
+        total += bytes;
+    }
+
+    builder->appendNumber("limitBytes", static_cast<long long>(_limit));
+    builder->appendNumber("usedBytes", static_cast<long long>(total));
+    BSONObjBuilder consumersBuilder(builder->subobjStart("consumers"));
+    for (const auto& entry : bytesByName) {
+        consumersBuilder.appendNumber(entry.first, static_cast<long long>(entry.second));
+    }
+    consumersBuilder.doneFast();
+    builder->appendNumber("shrinks", static_cast<long long>(_shrinks));
+    builder->appendNumber("bytesFreed", static_cast<long long>(_bytesFreed));
+}
+
+}  // namespace mongo
@@ -0,0 +1,130 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+class BSONObjBuilder;
+
+/**
+ * A cache, buffer or allocator whose memory the MemoryBudget accounts for.
+ */
+class MemoryConsumer {
+public:
+    virtual ~MemoryConsumer() = default;
+
+    /**
+     * An estimate of the bytes this consumer holds now. Called without any of the consumer's
+     * locks held, so it must take the ones it needs.
+     */
+    virtual int64_t bytesUsed() const = 0;
+
+    /**
+     * Asked under memory pressure to free about 'bytes' bytes, by dropping whatever is cheapest
+     * to rebuild first. Returns the bytes actually freed, which is 0 for consumers which can only
+     * report their usage.
+     */
+    virtual int64_t shrink(int64_t bytes) = 0;
+};
+
+/**
+ * Accounts for the memory held by the server's caches, so that their total stays within one
+ * limit rather than each being sized on its own. Consumers register themselves, and enforce()
+ * asks the largest of them to shrink whenever their total is over the limit.
+ *
+ * All methods are thread safe. shrink() and bytesUsed() are called with the budget's mutex
+ * held, so a consumer must not call back into the budget from them, and unregisterConsumer()
+ * waits for a shrink() of the same consumer to return.
+ */
+class MemoryBudget {
+    MONGO_DISALLOW_COPYING(MemoryBudget);
+
+public:
+    MemoryBudget() = default;
+
+    /**
+     * The budget of the process.
+     */
+    static MemoryBudget* get();
+
+    /**
+     * Accounts for 'consumer' under 'name' until it is unregistered. Several consumers may
+     * share a name, such as the plan caches of every collection, and are reported together.
+     */
+    void registerConsumer(StringData name, MemoryConsumer* consumer);
+    void unregisterConsumer(MemoryConsumer* consumer);
+
+    /**
+     * Sets the bytes the consumers may hold together. 0 means there is no limit, and enforce()
+     * never shrinks anything.
+     */
+    void setLimit(int64_t bytes);
+    int64_t getLimit() const;
+
+    /**
+     * The sum of the bytes used by every registered consumer.
+     */
+    int64_t totalBytesUsed() const;
+
+    /**
+     * If the consumers hold more than the limit, asks them to shrink by the excess, largest
+     * first, until they are within it or each was asked once. Returns the bytes freed.
+     */
+    int64_t enforce();
+
+    /**
+     * Appends the limit, the bytes used by each consumer name and in total, and the number of
+     * shrinks enforce() asked for and the bytes they freed.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
+private:
+    struct Registration {
+        std::string name;
+        MemoryConsumer* consumer;
+    };
+
+    // Protects all below.
+    mutable stdx::mutex _mutex;
+
+    std::vector<Registration> _consumers;
+    int64_t _limit = 0;
+    int64_t _shrinks = 0;
+    int64_t _bytesFreed = 0;
+};
+
+}  // namespace mongo
@@ -0,0 +1,148 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/memory_budget.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+
+/**
+ * Holds 'bytes' bytes and frees at most 'shrinkable' of them when asked.
+ */
+class FakeConsumer : public MemoryConsumer {
+public:
+    FakeConsumer(int64_t bytes, int64_t shrinkable) : bytes(bytes), shrinkable(shrinkable) {}
+
+    int64_t bytesUsed() const override {
+        return bytes;
+    }
+
+    int64_t shrink(int64_t request) override {
+        shrinkRequests++;
+        const int64_t freed = std::min(request, shrinkable);
+        bytes -= freed;
+        shrinkable -= freed;
+        return freed;
+    }
+
+    int64_t bytes;
+    int64_t shrinkable;
+    int shrinkRequests = 0;
+};
+
+TEST(MemoryBudgetTest, UnlimitedNeverShrinks) {
+    MemoryBudget budget;
+    FakeConsumer consumer(1000, 1000);
+    budget.registerConsumer("a", &consumer);
+    ASSERT_EQUALS(1000, budget.totalBytesUsed());
+    ASSERT_EQUALS(0, budget.enforce());
+    ASSERT_EQUALS(0, consumer.shrinkRequests);
+    budget.unregisterConsumer(&consumer);
+}
+
+TEST(MemoryBudgetTest, WithinLimitNeverShrinks) {
+    MemoryBudget budget;
+    budget.setLimit(1000);
+    FakeConsumer consumer(1000, 1000);
+    budget.registerConsumer("a", &consumer);
+    ASSERT_EQUALS(0, budget.enforce());
+    ASSERT_EQUALS(0, consumer.shrinkRequests);
+    budget.unregisterConsumer(&consumer);
+}
+
+TEST(MemoryBudgetTest, ShrinksLargestConsumerFirst) {
+    MemoryBudget budget;
+    budget.setLimit(1000);
+    FakeConsumer small(300, 300);
+    FakeConsumer large(900, 900);
+    budget.registerConsumer("small", &small);
+    budget.registerConsumer("large", &large);
+
+    ASSERT_EQUALS(200, budget.enforce());
+    ASSERT_EQUALS(700, large.bytes);
+    ASSERT_EQUALS(0, small.shrinkRequests);
+    ASSERT_EQUALS(1000, budget.totalBytesUsed());
+
+    budget.unregisterConsumer(&small);
+    budget.unregisterConsumer(&large);
+}
+
+TEST(MemoryBudgetTest, MovesOnWhenConsumerCannotFreeEnough) {
+    MemoryBudget budget;
+    budget.setLimit(1000);
+    FakeConsumer reportOnly(900, 0);
+    FakeConsumer partial(500, 100);
+    FakeConsumer rest(300, 300);
+    budget.registerConsumer("reportOnly", &reportOnly);
+    budget.registerConsumer("partial", &partial);
+    budget.registerConsumer("rest", &rest);
+
+    ASSERT_EQUALS(400, budget.enforce());
+    ASSERT_EQUALS(1, reportOnly.shrinkRequests);
+    ASSERT_EQUALS(400, partial.bytes);
+    ASSERT_EQUALS(0, rest.bytes);
+
+    budget.unregisterConsumer(&reportOnly);
+    budget.unregisterConsumer(&partial);
+    budget.unregisterConsumer(&rest);
+}
+
+TEST(MemoryBudgetTest, StatsGroupConsumersByName) {
+    MemoryBudget budget;
+    budget.setLimit(250);
+    FakeConsumer first(100, 100);
+    FakeConsumer second(200, 200);
+    FakeConsumer other(50, 0);
+    budget.registerConsumer("cache", &first);
+    budget.registerConsumer("cache", &second);
+    budget.registerConsumer("other", &other);
+    ASSERT_EQUALS(100, budget.enforce());
+
+    BSONObjBuilder builder;
+    budget.appendStats(&builder);
+    BSONObj stats = builder.obj();
+    ASSERT_EQUALS(250, stats["limitBytes"].numberLong());
+    ASSERT_EQUALS(250, stats["usedBytes"].numberLong());
+    ASSERT_EQUALS(200, stats["consumers"]["cache"].numberLong());
+    ASSERT_EQUALS(50, stats["consumers"]["other"].numberLong());
+    ASSERT_EQUALS(1, stats["shrinks"].numberLong());
+    ASSERT_EQUALS(100, stats["bytesFreed"].numberLong());
+
+    budget.unregisterConsumer(&first);
+    budget.unregisterConsumer(&second);
+    budget.unregisterConsumer(&other);
+    ASSERT_EQUALS(0, budget.totalBytesUsed());
+}
+
+}  // namespace
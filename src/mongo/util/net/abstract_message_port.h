@@ -32,7 +32,9 @@
 
 #include "mongo/config.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor.h"
 #include "mongo/util/net/sock.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -40,12 +42,19 @@ class AbstractMessagingPort {
     MONGO_DISALLOW_COPYING(AbstractMessagingPort);
 
 public:
-    AbstractMessagingPort() : tag(0), _connectionId(0) {}
+    AbstractMessagingPort()
+        : tag(0), _connectionId(0), _messageCompressor(MessageCompressorId::kNoop) {}
     virtual ~AbstractMessagingPort() {}
     // like the reply below, but doesn't rely on received.data still being available
     virtual void reply(Message& received, Message& response, MSGID responseTo) = 0;
     virtual void reply(Message& received, Message& response) = 0;
 
+    /**
+     * Sends any replies that are being held back to be coalesced with later ones. Callers that
+     * reply and then block without reading from the port must flush first.
+     */
+    virtual void flushWrites() {}
+
     virtual HostAndPort remote() const = 0;
     virtual unsigned remotePort() const = 0;
     virtual SockAddr remoteAddr() const = 0;
@@ -64,15 +73,42 @@ public:
     }
     void setConnectionId(long long connectionId);
 
+    /**
+     * Sets the compressor used for messages sent on this port, as negotiated with the remote
+     * end during the isMaster handshake. Compressed messages are accepted regardless.
+     */
+    void setMessageCompressor(MessageCompressorId compressor) {
+        _messageCompressor = compressor;
+    }
+
+    MessageCompressorId getMessageCompressor() const {
+        return _messageCompressor;
+    }
+
+    /**
+     * Returns how long it took to read the last received message off the network, from the
+     * arrival of its header until the rest of it had been read.
+     */
+    Microseconds getLastReceiveDuration() const {
+        return _lastReceiveDuration;
+    }
+
 public:
     // TODO make this private with some helpers
 
     /* ports can be tagged with various classes.  see closeAllSockets(tag). defaults to 0. */
     unsigned tag;
 
+protected:
+    void setLastReceiveDuration(Microseconds duration) {
+        _lastReceiveDuration = duration;
+    }
+
 private:
     long long _connectionId;
     std::string _x509SubjectName;
+    MessageCompressorId _messageCompressor;
+    Microseconds _lastReceiveDuration{0};
 };
 
 }  // namespace mongo
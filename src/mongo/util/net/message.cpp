@@ -51,6 +51,16 @@ void Message::send(MessagingPort& p, const char* context) {
     }
 }
 
+void Message::appendTo(std::vector<char>* out) const {
+    if (_buf != 0) {
+        out->insert(out->end(), _buf, _buf + MsgData::ConstView(_buf).getLen());
+        return;
+    }
+    for (MsgVec::const_iterator it = _data.begin(); it != _data.end(); ++it) {
+        out->insert(out->end(), it->first, it->first + it->second);
+    }
+}
+
 AtomicWord<MSGID> NextMsgId;
 
 /*struct MsgStart {
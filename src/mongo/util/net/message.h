@@ -40,8 +40,10 @@
 #include "mongo/util/allocator.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/net/hostandport.h"
+#include "mongo/util/net/message_buffer_pool.h"
 #include "mongo/util/net/sock.h"
 #include "mongo/util/print.h"
+#include "mongo/util/shared_buffer.h"
 
 namespace mongo {
 
@@ -67,6 +69,7 @@ enum Operations {
     dbKillCursors = 2007,
     dbCommand = 2008,
     dbCommandReply = 2009,
+    dbCompressed = 2012, /* wraps another message, see message_compressor.h */
 };
 
 bool doesOpGetAResponse(int op);
@@ -95,6 +98,8 @@ inline const char* opToString(int op) {
             return "command";
         case dbCommandReply:
             return "commandReply";
+        case dbCompressed:
+            return "compressed";
         default:
             massert(16141, str::stream() << "cannot translate opcode " << op, !op);
             return "";
@@ -341,11 +346,11 @@ class Message {
 public:
     // we assume here that a vector with initial size 0 does no allocation (0 is the default, but
     // wanted to make it explicit).
-    Message() : _buf(0), _data(0), _freeIt(false) {}
-    Message(void* data, bool freeIt) : _buf(0), _data(0), _freeIt(false) {
+    Message() : _buf(0), _data(0), _freeIt(false), _pooled(false) {}
+    Message(void* data, bool freeIt) : _buf(0), _data(0), _freeIt(false), _pooled(false) {
         _setData(reinterpret_cast<char*>(data), freeIt);
     };
-    Message(Message&& r) : _buf(0), _data(0), _freeIt(false) {
+    Message(Message&& r) : _buf(0), _data(0), _freeIt(false), _pooled(false) {
         *this = std::move(r);
     }
     ~Message() {
@@ -420,26 +425,35 @@ public:
         r._buf = 0;
         if (r._data.size() > 0) {
             _data.swap(r._data);
+            _ownsData.swap(r._ownsData);
+            _holders.swap(r._holders);
         }
+        _pooled = r._pooled;
         r._freeIt = false;
+        r._pooled = false;
         _freeIt = true;
         return *this;
     }
 
     void reset() {
         if (_freeIt) {
-            if (_buf) {
+            if (_pooled) {
+                MessageBufferPool::release(_buf);
+            } else if (_buf) {
                 free(_buf);
             }
-            for (std::vector<std::pair<char*, int>>::const_iterator i = _data.begin();
-                 i != _data.end();
-                 ++i) {
-                free(i->first);
+            for (size_t i = 0; i < _data.size(); ++i) {
+                if (_ownsData[i]) {
+                    free(_data[i].first);
+                }
             }
         }
         _buf = 0;
         _data.clear();
+        _ownsData.clear();
+        _holders.clear();
         _freeIt = false;
+        _pooled = false;
     }
 
     // use to add a buffer
@@ -455,12 +469,26 @@ public:
             return;
         }
         verify(_freeIt);
-        if (_buf) {
-            _data.push_back(std::make_pair(_buf, MsgData::ConstView(_buf).getLen()));
-            _buf = 0;
+        // Pooled buffers must go back to the pool, so they cannot be part of a buffer sequence.
+        verify(!_pooled);
+        _appendSegment(d, size, true);
+    }
+
+    /**
+     * Appends 'size' bytes at 'd' to the message without copying them, so that they are written
+     * out with scatter/gather I/O. The bytes must stay valid for as long as 'holder' is alive;
+     * the message keeps a reference to 'holder' until it is reset. The message must not be
+     * empty, since the first buffer has to contain the message header.
+     */
+    void appendReferencedData(const char* d, int size, SharedBuffer holder) {
+        if (size <= 0) {
+            return;
         }
-        _data.push_back(std::make_pair(d, size));
-        header().setLen(header().getLen() + size);
+        verify(!empty());
+        verify(_freeIt);
+        verify(!_pooled);
+        _appendSegment(const_cast<char*>(d), size, false);
+        _holders.push_back(std::move(holder));
     }
 
     // use to set first buffer if empty
@@ -468,6 +496,15 @@ public:
         verify(empty());
         _setData(d, freeIt);
     }
+    /**
+     * Sets the first buffer to 'd', which must have been obtained from
+     * MessageBufferPool::allocate() and is released to the pool along with the message.
+     */
+    void setPooledData(char* d) {
+        verify(empty());
+        _setData(d, true);
+        _pooled = true;
+    }
     void setData(int operation, const char* msgtxt) {
         setData(operation, msgtxt, strlen(msgtxt) + 1);
     }
@@ -491,11 +528,29 @@ public:
 
     void send(MessagingPort& p, const char* context);
 
+    /**
+     * Appends the wire bytes of this message to 'out', for callers that gather several messages
+     * into a single write.
+     */
+    void appendTo(std::vector<char>* out) const;
+
     std::string toString() const;
 
 private:
+    void _appendSegment(char* d, int size, bool owned) {
+        if (_buf) {
+            _data.push_back(std::make_pair(_buf, MsgData::ConstView(_buf).getLen()));
+            _ownsData.push_back(true);
+            _buf = 0;
+        }
+        _data.push_back(std::make_pair(d, size));
+        _ownsData.push_back(owned);
+        header().setLen(header().getLen() + size);
+    }
+
     void _setData(char* d, bool freeIt) {
         _freeIt = freeIt;
+        _pooled = false;
         _buf = d;
     }
     // if just one buffer, keep it in _buf, otherwise keep a sequence of buffers in _data
@@ -504,7 +559,13 @@ private:
     // instead
     typedef std::vector<std::pair<char*, int>> MsgVec;
     MsgVec _data;
+    // whether each of the buffers in _data is owned by this message, rather than referenced
+    std::vector<bool> _ownsData;
+    // keeps referenced buffers in _data alive
+    std::vector<SharedBuffer> _holders;
     bool _freeIt;
+    // true if _buf came from MessageBufferPool
+    bool _pooled;
 };
 
 
@@ -0,0 +1,201 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_buffer_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/allocator.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/threadlocal.h"
+
+namespace mongo {
+
+namespace {
+
+// Every buffer is preceded by a header recording its size class, so that release() does not
+// need to be told the size. The header is 16 bytes to preserve malloc's alignment guarantees.
+const size_t kHeaderSize = 16;
+
+const int kOversizedClass = -1;
+
+// Size classes are the powers of two from kMinPooledSize up to and including kMaxPooledSize.
+const int kNumClasses = 11;
+static_assert((MessageBufferPool::kMinPooledSize << (kNumClasses - 1)) ==
+                  MessageBufferPool::kMaxPooledSize,
+              "size classes must span kMinPooledSize to kMaxPooledSize");
+
+// Upper bound on the memory a single thread keeps cached for one size class.
+const size_t kMaxCachedBytesPerClass = 1024 * 1024;
+const size_t kMaxCachedBuffersPerClass = 64;
+
+AtomicUInt64 hitCount;
+AtomicUInt64 missCount;
+AtomicUInt64 oversizedCount;
+AtomicInt64 cachedBytes;
+
+size_t classSize(int sizeClass) {
+    return MessageBufferPool::kMinPooledSize << sizeClass;
+}
+
+size_t classCapacity(int sizeClass) {
+    const size_t byBytes = kMaxCachedBytesPerClass / classSize(sizeClass);
+    return std::max<size_t>(1, std::min(byBytes, kMaxCachedBuffersPerClass));
+}
+
+int sizeClassFor(size_t size) {
+    if (size > MessageBufferPool::kMaxPooledSize) {
+        return kOversizedClass;
+    }
+
+    int sizeClass = 0;
+    while (classSize(sizeClass) < size) {
+        ++sizeClass;
+    }
+    return sizeClass;
+}
+
+char* toUser(char* raw) {
+    return raw + kHeaderSize;
+}
+
+char* toRaw(char* buf) {
+    return buf - kHeaderSize;
+}
+
+int& headerClass(char* raw) {
+    return *reinterpret_cast<int*>(raw);
+}
+
+/**
+ * Released buffers cached by one thread, by size class. The buffers are freed when the thread
+ * exits.
+ */
+class ThreadCache {
+    MONGO_DISALLOW_COPYING(ThreadCache);
+
+public:
+    ThreadCache() = default;
+
+    ~ThreadCache() {
+        for (int sizeClass = 0; sizeClass < kNumClasses; ++sizeClass) {
+            for (char* raw : _free[sizeClass]) {
+                cachedBytes.subtractAndFetch(classSize(sizeClass));
+                free(raw);
+            }
+        }
+    }
+
+    char* pop(int sizeClass) {
+        auto& list = _free[sizeClass];
+        if (list.empty()) {
+            return nullptr;
+        }
+
+        char* raw = list.back();
+        list.pop_back();
+        cachedBytes.subtractAndFetch(classSize(sizeClass));
+        return raw;
+    }
+
+    bool push(int sizeClass, char* raw) {
+        auto& list = _free[sizeClass];
+        if (list.size() >= classCapacity(sizeClass)) {
+            return false;
+        }
+
+        list.push_back(raw);
+        cachedBytes.addAndFetch(classSize(sizeClass));
+        return true;
+    }
+
+private:
+    std::vector<char*> _free[kNumClasses];
+};
+
+TSP_DECLARE(ThreadCache, threadCache);
+TSP_DEFINE(ThreadCache, threadCache);
+
+}  // namespace
+
+char* MessageBufferPool::allocate(size_t size) {
+    const int sizeClass = sizeClassFor(size);
+
+    if (sizeClass == kOversizedClass) {
+        oversizedCount.fetchAndAdd(1);
+        char* raw = static_cast<char*>(mongoMalloc(size + kHeaderSize));
+        headerClass(raw) = kOversizedClass;
+        return toUser(raw);
+    }
+
+    char* raw = threadCache.getMake()->pop(sizeClass);
+    if (raw) {
+        hitCount.fetchAndAdd(1);
+    } else {
+        missCount.fetchAndAdd(1);
+        raw = static_cast<char*>(mongoMalloc(classSize(sizeClass) + kHeaderSize));
+        headerClass(raw) = sizeClass;
+    }
+
+    return toUser(raw);
+}
+
+void MessageBufferPool::release(char* buf) {
+    if (!buf) {
+        return;
+    }
+
+    char* raw = toRaw(buf);
+    const int sizeClass = headerClass(raw);
+    if (sizeClass == kOversizedClass) {
+        free(raw);
+        return;
+    }
+
+    invariant(sizeClass >= 0 && sizeClass < kNumClasses);
+    if (!threadCache.getMake()->push(sizeClass, raw)) {
+        free(raw);
+    }
+}
+
+MessageBufferPool::Stats MessageBufferPool::getStats() {
+    Stats stats;
+    stats.hits = hitCount.load();
+    stats.misses = missCount.load();
+    stats.oversized = oversizedCount.load();
+    stats.cachedBytes = cachedBytes.load();
+    return stats;
+}
+
+}  // namespace mongo
@@ -0,0 +1,75 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mongo {
+
+/**
+ * Size-classed allocator for wire protocol message buffers.
+ *
+ * Buffers are rounded up to a power of two between kMinPooledSize and kMaxPooledSize and, when
+ * released, are kept in a small per-thread cache for the next message of the same size class
+ * instead of being returned to the system allocator. Requests larger than kMaxPooledSize bypass
+ * the pool.
+ *
+ * Buffers must be released with release(), never with free().
+ */
+class MessageBufferPool {
+public:
+    static const size_t kMinPooledSize = 1024;
+    static const size_t kMaxPooledSize = 1024 * 1024;
+
+    struct Stats {
+        // Allocations satisfied from a thread cache.
+        uint64_t hits;
+        // Pooled-size allocations which had to go to the system allocator.
+        uint64_t misses;
+        // Allocations larger than kMaxPooledSize.
+        uint64_t oversized;
+        // Bytes currently held in thread caches.
+        int64_t cachedBytes;
+    };
+
+    /**
+     * Returns a buffer with room for at least 'size' bytes.
+     */
+    static char* allocate(size_t size);
+
+    /**
+     * Returns a buffer obtained from allocate() to the pool.
+     */
+    static void release(char* buf);
+
+    static Stats getStats();
+};
+
+}  // namespace mongo
@@ -0,0 +1,107 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_buffer_pool.h"
+
+#include <cstring>
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/net/message.h"
+
+namespace mongo {
+namespace {
+
+TEST(MessageBufferPool, ReleasedBufferIsReusedForSameSizeClass) {
+    char* first = MessageBufferPool::allocate(3000);
+    std::memset(first, 'x', 3000);
+    MessageBufferPool::release(first);
+
+    const auto before = MessageBufferPool::getStats();
+
+    // 4000 bytes rounds up to the same 4KB size class as 3000 bytes.
+    char* second = MessageBufferPool::allocate(4000);
+    ASSERT_EQUALS(first, second);
+
+    const auto after = MessageBufferPool::getStats();
+    ASSERT_EQUALS(before.hits + 1, after.hits);
+    ASSERT_EQUALS(before.misses, after.misses);
+
+    MessageBufferPool::release(second);
+}
+
+TEST(MessageBufferPool, DifferentSizeClassIsAMiss) {
+    char* small = MessageBufferPool::allocate(MessageBufferPool::kMinPooledSize);
+    MessageBufferPool::release(small);
+
+    const auto before = MessageBufferPool::getStats();
+    char* large = MessageBufferPool::allocate(MessageBufferPool::kMinPooledSize * 8);
+    std::memset(large, 'x', MessageBufferPool::kMinPooledSize * 8);
+
+    const auto after = MessageBufferPool::getStats();
+    ASSERT_EQUALS(before.misses + 1, after.misses);
+    ASSERT_EQUALS(before.hits, after.hits);
+
+    MessageBufferPool::release(large);
+}
+
+TEST(MessageBufferPool, OversizedBuffersBypassThePool) {
+    const size_t size = MessageBufferPool::kMaxPooledSize + 1;
+
+    const auto before = MessageBufferPool::getStats();
+    char* buf = MessageBufferPool::allocate(size);
+    std::memset(buf, 'x', size);
+    MessageBufferPool::release(buf);
+
+    const auto after = MessageBufferPool::getStats();
+    ASSERT_EQUALS(before.oversized + 1, after.oversized);
+    ASSERT_EQUALS(before.cachedBytes, after.cachedBytes);
+}
+
+TEST(MessageBufferPool, MessageReleasesPooledBuffer) {
+    char* buf = MessageBufferPool::allocate(MessageBufferPool::kMinPooledSize);
+    {
+        Message m;
+        MsgData::View md = buf;
+        md.setLen(MessageBufferPool::kMinPooledSize);
+        m.setPooledData(md.view2ptr());
+
+        Message moved(std::move(m));
+        ASSERT_TRUE(m.empty());
+        ASSERT_EQUALS(static_cast<int>(MessageBufferPool::kMinPooledSize), moved.size());
+    }
+
+    // The moved-to message must have returned the buffer to the pool.
+    char* reused = MessageBufferPool::allocate(MessageBufferPool::kMinPooledSize);
+    ASSERT_EQUALS(buf, reused);
+    MessageBufferPool::release(reused);
+}
+
+}  // namespace
+}  // namespace mongo
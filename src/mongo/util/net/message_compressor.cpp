@@ -0,0 +1,430 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_compressor.h"
+
+#include <algorithm>
+#include <snappy.h>
+#include <zlib.h>
+
+#include "mongo/base/data_type_endian.h"
+#include "mongo/base/data_view.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/allocator.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/abstract_message_port.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/stringutils.h"
+
+namespace mongo {
+
+namespace {
+
+const char kCompressionFieldName[] = "compression";
+
+// Layout of the fields following the header of a dbCompressed message.
+const size_t kOriginalOpcodeOffset = 0;
+const size_t kUncompressedSizeOffset = 4;
+const size_t kCompressorIdOffset = 8;
+const size_t kCompressedPrefixSize = sizeof(MSGHEADER::Value) + 9;
+
+const MessageCompressorId kAllCompressors[] = {MessageCompressorId::kSnappy,
+                                               MessageCompressorId::kZlib};
+
+std::vector<MessageCompressorId> enabledCompressors;
+
+struct CompressorCounters {
+    AtomicUInt64 compressorBytesIn;
+    AtomicUInt64 compressorBytesOut;
+    AtomicUInt64 decompressorBytesIn;
+    AtomicUInt64 decompressorBytesOut;
+};
+
+CompressorCounters counters[3];
+
+CompressorCounters& countersFor(MessageCompressorId id) {
+    return counters[static_cast<uint8_t>(id)];
+}
+
+bool isValidCompressorId(uint8_t id) {
+    return id <= static_cast<uint8_t>(MessageCompressorId::kZlib);
+}
+
+size_t maxCompressedLength(MessageCompressorId id, size_t inputLength) {
+    switch (id) {
+        case MessageCompressorId::kNoop:
+            return inputLength;
+        case MessageCompressorId::kSnappy:
+            return snappy::MaxCompressedLength(inputLength);
+        case MessageCompressorId::kZlib:
+            // Same bound as zlib's compressBound(), which is not part of the vendored zlib.
+            return inputLength + (inputLength >> 12) + (inputLength >> 14) + (inputLength >> 25) +
+                13;
+    }
+    MONGO_UNREACHABLE;
+}
+
+/**
+ * Compresses 'inputLength' bytes at 'input' into 'output', which must have room for
+ * maxCompressedLength() bytes. Returns the size of the compressed data.
+ */
+StatusWith<size_t> compressBuffer(MessageCompressorId id,
+                                  const char* input,
+                                  size_t inputLength,
+                                  char* output) {
+    switch (id) {
+        case MessageCompressorId::kNoop:
+            memcpy(output, input, inputLength);
+            return inputLength;
+        case MessageCompressorId::kSnappy: {
+            size_t outputLength;
+            snappy::RawCompress(input, inputLength, output, &outputLength);
+            return outputLength;
+        }
+        case MessageCompressorId::kZlib: {
+            z_stream stream;
+            stream.next_in = reinterpret_cast<unsigned char*>(const_cast<char*>(input));
+            stream.avail_in = inputLength;
+            stream.next_out = reinterpret_cast<unsigned char*>(output);
+            stream.avail_out = maxCompressedLength(id, inputLength);
+            stream.zalloc = nullptr;
+            stream.zfree = nullptr;
+            stream.opaque = nullptr;
+
+            int err = deflateInit(&stream, Z_DEFAULT_COMPRESSION);
+            if (err != Z_OK) {
+                return {ErrorCodes::ZLibError, str::stream() << "deflateInit failed with " << err};
+            }
+
+            err = deflate(&stream, Z_FINISH);
+            (void)deflateEnd(&stream);
+            if (err != Z_STREAM_END) {
+                return {ErrorCodes::ZLibError, str::stream() << "deflate failed with " << err};
+            }
+            return static_cast<size_t>(stream.total_out);
+        }
+    }
+    MONGO_UNREACHABLE;
+}
+
+/**
+ * Decompresses 'inputLength' bytes at 'input' into exactly 'outputLength' bytes at 'output'.
+ */
+Status decompressBuffer(MessageCompressorId id,
+                        const char* input,
+                        size_t inputLength,
+                        char* output,
+                        size_t outputLength) {
+    switch (id) {
+        case MessageCompressorId::kNoop:
+            if (inputLength != outputLength) {
+                break;
+            }
+            memcpy(output, input, inputLength);
+            return Status::OK();
+        case MessageCompressorId::kSnappy: {
+            size_t actualLength;
+            if (!snappy::GetUncompressedLength(input, inputLength, &actualLength) ||
+                actualLength != outputLength ||
+                !snappy::RawUncompress(input, inputLength, output)) {
+                break;
+            }
+            return Status::OK();
+        }
+        case MessageCompressorId::kZlib: {
+            z_stream stream;
+            stream.next_in = reinterpret_cast<unsigned char*>(const_cast<char*>(input));
+            stream.avail_in = inputLength;
+            stream.next_out = reinterpret_cast<unsigned char*>(output);
+            stream.avail_out = outputLength;
+            stream.zalloc = nullptr;
+            stream.zfree = nullptr;
+            stream.opaque = nullptr;
+
+            int err = inflateInit(&stream);
+            if (err != Z_OK) {
+                return {ErrorCodes::ZLibError, str::stream() << "inflateInit failed with " << err};
+            }
+
+            err = inflate(&stream, Z_FINISH);
+            (void)inflateEnd(&stream);
+            if (err != Z_STREAM_END || stream.total_out != outputLength) {
+                break;
+            }
+            return Status::OK();
+        }
+    }
+    return {ErrorCodes::BadValue,
+            str::stream() << "invalid " << getMessageCompressorName(id) << " compressed message"};
+}
+
+}  // namespace
+
+StringData getMessageCompressorName(MessageCompressorId id) {
+    switch (id) {
+        case MessageCompressorId::kNoop:
+            return "noop";
+        case MessageCompressorId::kSnappy:
+            return "snappy";
+        case MessageCompressorId::kZlib:
+            return "zlib";
+    }
+    MONGO_UNREACHABLE;
+}
+
+StatusWith<MessageCompressorId> parseMessageCompressorName(StringData name) {
+    for (auto id : kAllCompressors) {
+        if (name == getMessageCompressorName(id)) {
+            return id;
+        }
+    }
+    return {ErrorCodes::BadValue, str::stream() << "unknown network compressor " << name};
+}
+
+StatusWith<std::vector<MessageCompressorId>> parseMessageCompressorList(StringData list) {
+    std::vector<MessageCompressorId> compressors;
+    if (list == "disabled") {
+        return compressors;
+    }
+
+    std::vector<std::string> names;
+    splitStringDelim(list.toString(), &names, ',');
+    for (const auto& name : names) {
+        auto swId = parseMessageCompressorName(name);
+        if (!swId.isOK()) {
+            return swId.getStatus();
+        }
+        if (std::find(compressors.begin(), compressors.end(), swId.getValue()) ==
+            compressors.end()) {
+            compressors.push_back(swId.getValue());
+        }
+    }
+    return compressors;
+}
+
+void setEnabledMessageCompressors(std::vector<MessageCompressorId> compressors) {
+    enabledCompressors = std::move(compressors);
+}
+
+const std::vector<MessageCompressorId>& getEnabledMessageCompressors() {
+    return enabledCompressors;
+}
+
+void appendMessageCompressionRequest(BSONObjBuilder* isMasterCmd) {
+    if (enabledCompressors.empty()) {
+        return;
+    }
+
+    BSONArrayBuilder names(isMasterCmd->subarrayStart(kCompressionFieldName));
+    for (auto id : enabledCompressors) {
+        names.append(getMessageCompressorName(id));
+    }
+    names.done();
+}
+
+void negotiateMessageCompressor(const BSONObj& isMasterCmd,
+                                AbstractMessagingPort* port,
+                                BSONObjBuilder* isMasterResponse) {
+    BSONElement requested = isMasterCmd[kCompressionFieldName];
+    if (!port || requested.type() != Array) {
+        return;
+    }
+
+    for (const auto& elem : requested.Obj()) {
+        if (elem.type() != String) {
+            continue;
+        }
+
+        auto swId = parseMessageCompressorName(elem.valueStringData());
+        if (!swId.isOK()) {
+            continue;
+        }
+
+        const auto id = swId.getValue();
+        if (std::find(enabledCompressors.begin(), enabledCompressors.end(), id) !=
+            enabledCompressors.end()) {
+            BSONArrayBuilder names(isMasterResponse->subarrayStart(kCompressionFieldName));
+            names.append(getMessageCompressorName(id));
+            names.done();
+            port->setMessageCompressor(id);
+            return;
+        }
+    }
+    port->setMessageCompressor(MessageCompressorId::kNoop);
+}
+
+MessageCompressorId getNegotiatedMessageCompressor(const BSONObj& isMasterReply) {
+    BSONElement negotiated = isMasterReply[kCompressionFieldName];
+    if (negotiated.type() != Array) {
+        return MessageCompressorId::kNoop;
+    }
+
+    BSONElement name = negotiated.Obj().firstElement();
+    if (name.type() != String) {
+        return MessageCompressorId::kNoop;
+    }
+
+    auto swId = parseMessageCompressorName(name.valueStringData());
+    if (!swId.isOK() || std::find(enabledCompressors.begin(),
+                                  enabledCompressors.end(),
+                                  swId.getValue()) == enabledCompressors.end()) {
+        return MessageCompressorId::kNoop;
+    }
+    return swId.getValue();
+}
+
+Status compressMessage(MessageCompressorId id, Message& toCompress, Message* compressed) {
+    invariant(compressed->empty());
+
+    toCompress.concat();
+    MsgData::View input = toCompress.singleData();
+    const size_t inputLength = input.dataLen();
+
+    const size_t bufferSize = kCompressedPrefixSize + maxCompressedLength(id, inputLength);
+    if (bufferSize > MaxMessageSizeBytes) {
+        return {ErrorCodes::InvalidLength,
+                str::stream() << "message of " << inputLength << " bytes is too large to compress"};
+    }
+
+    char* buffer = static_cast<char*>(mongoMalloc(bufferSize));
+    ScopeGuard guard = MakeGuard(free, buffer);
+
+    auto swOutputLength =
+        compressBuffer(id, input.data(), inputLength, buffer + kCompressedPrefixSize);
+    if (!swOutputLength.isOK()) {
+        return swOutputLength.getStatus();
+    }
+    const size_t outputLength = swOutputLength.getValue();
+
+    MsgData::View output = buffer;
+    output.setLen(kCompressedPrefixSize + outputLength);
+    output.setId(input.getId());
+    output.setResponseTo(input.getResponseTo());
+    output.setOperation(dbCompressed);
+
+    DataView fields(output.data());
+    fields.write<LittleEndian<int32_t>>(input.getOperation(), kOriginalOpcodeOffset);
+    fields.write<LittleEndian<int32_t>>(inputLength, kUncompressedSizeOffset);
+    fields.write<uint8_t>(static_cast<uint8_t>(id), kCompressorIdOffset);
+
+    guard.Dismiss();
+    compressed->setData(buffer, true);
+
+    auto& idCounters = countersFor(id);
+    idCounters.compressorBytesIn.fetchAndAdd(inputLength);
+    idCounters.compressorBytesOut.fetchAndAdd(outputLength);
+    return Status::OK();
+}
+
+Status decompressMessage(const Message& compressed, Message* decompressed) {
+    invariant(decompressed->empty());
+
+    MsgData::View input = compressed.header();
+    invariant(input.getOperation() == dbCompressed);
+
+    if (static_cast<size_t>(input.getLen()) < kCompressedPrefixSize) {
+        return {ErrorCodes::InvalidLength, "compressed message is too short"};
+    }
+
+    ConstDataView fields(input.data());
+    const int32_t originalOpcode = fields.read<LittleEndian<int32_t>>(kOriginalOpcodeOffset);
+    const int32_t uncompressedSize = fields.read<LittleEndian<int32_t>>(kUncompressedSizeOffset);
+    const uint8_t compressorId = fields.read<uint8_t>(kCompressorIdOffset);
+
+    if (originalOpcode == dbCompressed) {
+        return {ErrorCodes::BadValue, "compressed messages cannot be nested"};
+    }
+    if (uncompressedSize < 0 ||
+        static_cast<size_t>(uncompressedSize) + sizeof(MSGHEADER::Value) > MaxMessageSizeBytes) {
+        return {ErrorCodes::InvalidLength,
+                str::stream() << "invalid uncompressed size " << uncompressedSize};
+    }
+    if (!isValidCompressorId(compressorId)) {
+        return {ErrorCodes::BadValue,
+                str::stream() << "unknown network compressor id "
+                              << static_cast<int>(compressorId)};
+    }
+    const auto id = static_cast<MessageCompressorId>(compressorId);
+
+    const size_t bufferSize = sizeof(MSGHEADER::Value) + uncompressedSize;
+    char* buffer = static_cast<char*>(mongoMalloc(bufferSize));
+    ScopeGuard guard = MakeGuard(free, buffer);
+
+    MsgData::View output = buffer;
+    const size_t inputLength = input.getLen() - kCompressedPrefixSize;
+    Status status = decompressBuffer(id,
+                                     input.view2ptr() + kCompressedPrefixSize,
+                                     inputLength,
+                                     output.data(),
+                                     uncompressedSize);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    output.setLen(bufferSize);
+    output.setId(input.getId());
+    output.setResponseTo(input.getResponseTo());
+    output.setOperation(originalOpcode);
+
+    guard.Dismiss();
+    decompressed->setData(buffer, true);
+
+    auto& idCounters = countersFor(id);
+    idCounters.decompressorBytesIn.fetchAndAdd(inputLength);
+    idCounters.decompressorBytesOut.fetchAndAdd(uncompressedSize);
+    return Status::OK();
+}
+
+void appendMessageCompressionStats(BSONObjBuilder* b) {
+    for (auto id : kAllCompressors) {
+        const auto& idCounters = countersFor(id);
+        BSONObjBuilder compressorBuilder(b->subobjStart(getMessageCompressorName(id)));
+        {
+            BSONObjBuilder sub(compressorBuilder.subobjStart("compressor"));
+            sub.appendNumber("bytesIn",
+                             static_cast<long long>(idCounters.compressorBytesIn.load()));
+            sub.appendNumber("bytesOut",
+                             static_cast<long long>(idCounters.compressorBytesOut.load()));
+        }
+        {
+            BSONObjBuilder sub(compressorBuilder.subobjStart("decompressor"));
+            sub.appendNumber("bytesIn",
+                             static_cast<long long>(idCounters.decompressorBytesIn.load()));
+            sub.appendNumber("bytesOut",
+                             static_cast<long long>(idCounters.decompressorBytesOut.load()));
+        }
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,128 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
+
+namespace mongo {
+
+class AbstractMessagingPort;
+class BSONObj;
+class BSONObjBuilder;
+class Message;
+
+/**
+ * Identifies how the body of a dbCompressed message was compressed. The values are part of the
+ * wire protocol and must not change.
+ *
+ * A dbCompressed message consists of a standard message header, with the same id and
+ * responseTo as the message it wraps, followed by:
+ *
+ *      int32  originalOpcode      opcode of the wrapped message
+ *      int32  uncompressedSize    size of the wrapped message, excluding its header
+ *      uint8  compressorId        a MessageCompressorId
+ *      ...    compressed body of the wrapped message
+ */
+enum class MessageCompressorId : uint8_t {
+    kNoop = 0,
+    kSnappy = 1,
+    kZlib = 2,
+};
+
+/**
+ * Returns the name used for 'id' in configuration and in the isMaster handshake.
+ */
+StringData getMessageCompressorName(MessageCompressorId id);
+
+/**
+ * Parses a compressor name as returned by getMessageCompressorName().
+ */
+StatusWith<MessageCompressorId> parseMessageCompressorName(StringData name);
+
+/**
+ * Parses a comma separated list of compressor names, in order of preference. "disabled" yields
+ * an empty list.
+ */
+StatusWith<std::vector<MessageCompressorId>> parseMessageCompressorList(StringData list);
+
+/**
+ * Sets the compressors this process is willing to use, in order of preference. Compression is
+ * disabled if the list is empty, which is the default. Must only be called during startup.
+ */
+void setEnabledMessageCompressors(std::vector<MessageCompressorId> compressors);
+
+const std::vector<MessageCompressorId>& getEnabledMessageCompressors();
+
+/**
+ * Client side of the negotiation: adds the list of enabled compressors to an isMaster command.
+ * Appends nothing if compression is disabled.
+ */
+void appendMessageCompressionRequest(BSONObjBuilder* isMasterCmd);
+
+/**
+ * Server side of the negotiation: picks the first compressor requested in 'isMasterCmd' that is
+ * also enabled in this process, reports it in 'isMasterResponse' and uses it for the messages
+ * subsequently sent on 'port'. Does nothing if 'isMasterCmd' does not request compression, so
+ * that isMaster commands sent after the handshake do not reset the negotiated compressor.
+ * 'port' may be null for clients that are not connected over the network.
+ */
+void negotiateMessageCompressor(const BSONObj& isMasterCmd,
+                                AbstractMessagingPort* port,
+                                BSONObjBuilder* isMasterResponse);
+
+/**
+ * Client side of the negotiation: returns the compressor picked by the server in its isMaster
+ * reply, or kNoop if the server did not pick one.
+ */
+MessageCompressorId getNegotiatedMessageCompressor(const BSONObj& isMasterReply);
+
+/**
+ * Compresses 'toCompress' with the compressor 'id' into a new dbCompressed message. The
+ * compressed message has the same header id and responseTo as 'toCompress', so they must be
+ * set beforehand. 'toCompress' may consist of several buffers, which are concatenated.
+ */
+Status compressMessage(MessageCompressorId id, Message& toCompress, Message* compressed);
+
+/**
+ * Restores the message wrapped by the dbCompressed message 'compressed' into 'decompressed',
+ * which must be empty.
+ */
+Status decompressMessage(const Message& compressed, Message* decompressed);
+
+/**
+ * Appends the number of bytes that went in and out of each compressor and decompressor.
+ */
+void appendMessageCompressionStats(BSONObjBuilder* b);
+
+}  // namespace mongo
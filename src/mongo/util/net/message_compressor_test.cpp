@@ -0,0 +1,208 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+
+#include "mongo/base/data_type_endian.h"
+#include "mongo/base/data_view.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor.h"
+#include "mongo/util/net/message_port_mock.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Enables the given compressors for the lifetime of the object.
+ */
+class ScopedEnabledCompressors {
+public:
+    explicit ScopedEnabledCompressors(std::vector<MessageCompressorId> compressors)
+        : _saved(getEnabledMessageCompressors()) {
+        setEnabledMessageCompressors(std::move(compressors));
+    }
+
+    ~ScopedEnabledCompressors() {
+        setEnabledMessageCompressors(std::move(_saved));
+    }
+
+private:
+    std::vector<MessageCompressorId> _saved;
+};
+
+void buildMessage(const std::string& body, Message* message) {
+    message->setData(dbQuery, body.c_str(), body.size() + 1);
+    message->header().setId(1234);
+    message->header().setResponseTo(5678);
+}
+
+void assertRoundTrips(MessageCompressorId id) {
+    std::string body;
+    for (int i = 0; i < 1000; ++i) {
+        body += "compress me please ";
+    }
+
+    Message original;
+    buildMessage(body, &original);
+
+    Message compressed;
+    ASSERT_OK(compressMessage(id, original, &compressed));
+    ASSERT_EQUALS(dbCompressed, compressed.operation());
+    ASSERT_EQUALS(1234, compressed.header().getId());
+    ASSERT_EQUALS(5678, compressed.header().getResponseTo());
+    if (id != MessageCompressorId::kNoop) {
+        ASSERT_LESS_THAN(compressed.size(), original.size());
+    }
+
+    Message decompressed;
+    ASSERT_OK(decompressMessage(compressed, &decompressed));
+    ASSERT_EQUALS(dbQuery, decompressed.operation());
+    ASSERT_EQUALS(1234, decompressed.header().getId());
+    ASSERT_EQUALS(5678, decompressed.header().getResponseTo());
+    ASSERT_EQUALS(original.size(), decompressed.size());
+    ASSERT_EQUALS(body, std::string(decompressed.singleData().data()));
+}
+
+TEST(MessageCompressor, NoopRoundTrip) {
+    assertRoundTrips(MessageCompressorId::kNoop);
+}
+
+TEST(MessageCompressor, SnappyRoundTrip) {
+    assertRoundTrips(MessageCompressorId::kSnappy);
+}
+
+TEST(MessageCompressor, ZlibRoundTrip) {
+    assertRoundTrips(MessageCompressorId::kZlib);
+}
+
+TEST(MessageCompressor, CorruptMessageIsRejected) {
+    Message original;
+    buildMessage(std::string(1000, 'x'), &original);
+
+    Message compressed;
+    ASSERT_OK(compressMessage(MessageCompressorId::kSnappy, original, &compressed));
+
+    // Claim a different uncompressed size than the compressed data actually has.
+    char* uncompressedSize = compressed.singleData().data() + 4;
+    DataView(uncompressedSize).write<LittleEndian<int32_t>>(2000);
+
+    Message decompressed;
+    ASSERT_NOT_OK(decompressMessage(compressed, &decompressed));
+    ASSERT_TRUE(decompressed.empty());
+}
+
+TEST(MessageCompressor, TruncatedMessageIsRejected) {
+    Message compressed;
+    compressed.setData(dbCompressed, "abc", 3);
+
+    Message decompressed;
+    ASSERT_EQUALS(ErrorCodes::InvalidLength,
+                  decompressMessage(compressed, &decompressed).code());
+}
+
+TEST(MessageCompressor, ParseCompressorList) {
+    auto swList = parseMessageCompressorList("zlib,snappy,zlib");
+    ASSERT_OK(swList.getStatus());
+    ASSERT_EQUALS(2U, swList.getValue().size());
+    ASSERT(MessageCompressorId::kZlib == swList.getValue()[0]);
+    ASSERT(MessageCompressorId::kSnappy == swList.getValue()[1]);
+
+    swList = parseMessageCompressorList("disabled");
+    ASSERT_OK(swList.getStatus());
+    ASSERT_TRUE(swList.getValue().empty());
+
+    ASSERT_NOT_OK(parseMessageCompressorList("snappy,lz4").getStatus());
+}
+
+TEST(MessageCompressor, NegotiationPicksFirstRequestedEnabledCompressor) {
+    ScopedEnabledCompressors enabled({MessageCompressorId::kSnappy, MessageCompressorId::kZlib});
+
+    MessagingPortMock port;
+    BSONObjBuilder response;
+    negotiateMessageCompressor(
+        BSON("isMaster" << 1 << "compression" << BSON_ARRAY("lz4"
+                                                            << "zlib"
+                                                            << "snappy")),
+        &port,
+        &response);
+
+    ASSERT(MessageCompressorId::kZlib == port.getMessageCompressor());
+    BSONObj reply = response.obj();
+    ASSERT_EQUALS(BSON("compression" << BSON_ARRAY("zlib")), reply);
+    ASSERT(MessageCompressorId::kZlib == getNegotiatedMessageCompressor(reply));
+}
+
+TEST(MessageCompressor, NegotiationWithoutCommonCompressor) {
+    ScopedEnabledCompressors enabled({MessageCompressorId::kSnappy});
+
+    MessagingPortMock port;
+    port.setMessageCompressor(MessageCompressorId::kSnappy);
+    BSONObjBuilder response;
+    negotiateMessageCompressor(
+        BSON("isMaster" << 1 << "compression" << BSON_ARRAY("zlib")), &port, &response);
+
+    ASSERT(MessageCompressorId::kNoop == port.getMessageCompressor());
+    ASSERT_TRUE(response.obj().isEmpty());
+}
+
+TEST(MessageCompressor, IsMasterWithoutCompressionKeepsNegotiatedCompressor) {
+    ScopedEnabledCompressors enabled({MessageCompressorId::kSnappy});
+
+    MessagingPortMock port;
+    port.setMessageCompressor(MessageCompressorId::kSnappy);
+    BSONObjBuilder response;
+    negotiateMessageCompressor(BSON("isMaster" << 1), &port, &response);
+
+    ASSERT(MessageCompressorId::kSnappy == port.getMessageCompressor());
+    ASSERT_TRUE(response.obj().isEmpty());
+}
+
+TEST(MessageCompressor, RequestListsEnabledCompressors) {
+    ScopedEnabledCompressors enabled({MessageCompressorId::kZlib, MessageCompressorId::kSnappy});
+
+    BSONObjBuilder cmd;
+    appendMessageCompressionRequest(&cmd);
+    ASSERT_EQUALS(BSON("compression" << BSON_ARRAY("zlib"
+                                                   << "snappy")),
+                  cmd.obj());
+}
+
+TEST(MessageCompressor, NothingRequestedWhenDisabled) {
+    ScopedEnabledCompressors enabled({});
+
+    BSONObjBuilder cmd;
+    appendMessageCompressionRequest(&cmd);
+    ASSERT_TRUE(cmd.obj().isEmpty());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -37,11 +37,15 @@
 #include <time.h>
 
 #include "mongo/config.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/allocator.h"
 #include "mongo/util/background.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/listen.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor.h"
+#include "mongo/util/net/socket_poll.h"
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/net/ssl_options.h"
 #include "mongo/util/scopeguard.h"
@@ -63,6 +67,22 @@ using std::string;
 // if you want trace output:
 #define mmm(x)
 
+namespace {
+
+// Coalescing buffers that grew past this are released after a flush rather than kept around for
+// the life of the connection.
+const size_t kRetainedCoalescingBufferBytes = 4 * 1024;
+
+struct WriteCoalescingCounters {
+    AtomicUInt64 writes;
+    AtomicUInt64 messages;
+    AtomicUInt64 bytes;
+};
+
+WriteCoalescingCounters coalescingCounters;
+
+}  // namespace
+
 void AbstractMessagingPort::setConnectionId(long long connectionId) {
     verify(_connectionId == 0);
     _connectionId = connectionId;
@@ -128,8 +148,73 @@ MessagingPort::~MessagingPort() {
     ports.erase(this);
 }
 
+void MessagingPort::setWriteCoalescing(bool enabled) {
+    if (!enabled) {
+        flushWrites();
+    }
+    _coalesceWrites = enabled;
+}
+
+void MessagingPort::flushWrites() {
+    if (_pendingWrites.empty()) {
+        return;
+    }
+
+    ON_BLOCK_EXIT([this] {
+        if (_pendingWrites.capacity() > kRetainedCoalescingBufferBytes) {
+            std::vector<char>().swap(_pendingWrites);
+        } else {
+            _pendingWrites.clear();
+        }
+        _pendingMessages = 0;
+    });
+
+    psock->send(_pendingWrites.data(), _pendingWrites.size(), "say");
+
+    coalescingCounters.writes.fetchAndAdd(1);
+    coalescingCounters.messages.fetchAndAdd(_pendingMessages);
+    coalescingCounters.bytes.fetchAndAdd(_pendingWrites.size());
+}
+
+bool MessagingPort::_inputReady() {
+    if (!isPollSupported()) {
+        return false;
+    }
+
+    pollfd pollInfo;
+    pollInfo.fd = psock->rawFD();
+    pollInfo.events = POLLIN;
+    return socketPoll(&pollInfo, 1, 0) > 0;
+}
+
+void MessagingPort::_send(Message& toSend) {
+    if (!_coalesceWrites) {
+        toSend.send(*this, "say");
+        return;
+    }
+
+    if (static_cast<size_t>(toSend.size()) >= kMaxCoalescedMessageBytes) {
+        flushWrites();
+        toSend.send(*this, "say");
+        return;
+    }
+
+    toSend.appendTo(&_pendingWrites);
+    ++_pendingMessages;
+    if (_pendingWrites.size() >= kMaxCoalescedBytes ||
+        _pendingMessages >= kMaxCoalescedMessages) {
+        flushWrites();
+    }
+}
+
 bool MessagingPort::recv(Message& m) {
     try {
+        // Replies held back for coalescing may only wait for requests that have already
+        // arrived. Send them before blocking for the next one.
+        if (!_pendingWrites.empty() && !_inputReady()) {
+            flushWrites();
+        }
+
 #ifdef MONGO_CONFIG_SSL
     again:
 #endif
@@ -137,6 +222,7 @@ bool MessagingPort::recv(Message& m) {
         MSGHEADER::Value header;
         int headerLen = sizeof(MSGHEADER::Value);
         psock->recv((char*)&header, headerLen);
+        const unsigned long long receiveStart = curTimeMicros64();
         int len = header.constView().getMessageLength();
 
         if (len == 542393671) {
@@ -184,19 +270,30 @@ bool MessagingPort::recv(Message& m) {
         }
 
         psock->setHandshakeReceived();
-        int z = (len + 1023) & 0xfffffc00;
-        verify(z >= len);
-        MsgData::View md = reinterpret_cast<char*>(mongoMalloc(z));
-        ScopeGuard guard = MakeGuard(free, md.view2ptr());
+        MsgData::View md = MessageBufferPool::allocate(len);
+        ScopeGuard guard = MakeGuard(MessageBufferPool::release, md.view2ptr());
         verify(md.view2ptr());
 
         memcpy(md.view2ptr(), &header, headerLen);
         int left = len - headerLen;
 
         psock->recv(md.data(), left);
+        setLastReceiveDuration(Microseconds(curTimeMicros64() - receiveStart));
 
         guard.Dismiss();
-        m.setData(md.view2ptr(), true);
+        m.setPooledData(md.view2ptr());
+
+        if (m.operation() == dbCompressed) {
+            Message decompressed;
+            Status status = decompressMessage(m, &decompressed);
+            m.reset();
+            if (!status.isOK()) {
+                LOG(0) << "recv(): failed to decompress message from " << remote() << ": "
+                       << status;
+                return false;
+            }
+            m = std::move(decompressed);
+        }
         return true;
 
     } catch (const SocketException& e) {
@@ -250,7 +347,18 @@ void MessagingPort::say(Message& toSend, int responseTo) {
     mmm(log() << "*  say()  thr:" << GetCurrentThreadId() << endl;)
         toSend.header().setId(nextMessageId());
     toSend.header().setResponseTo(responseTo);
-    toSend.send(*this, "say");
+
+    const MessageCompressorId compressor = getMessageCompressor();
+    if (compressor != MessageCompressorId::kNoop && toSend.operation() != dbCompressed) {
+        Message compressed;
+        Status status = compressMessage(compressor, toSend, &compressed);
+        if (status.isOK()) {
+            _send(compressed);
+            return;
+        }
+        LOG(1) << "sending message uncompressed: " << status;
+    }
+    _send(toSend);
 }
 
 HostAndPort MessagingPort::remote() const {
@@ -269,4 +377,13 @@ SockAddr MessagingPort::localAddr() const {
     return psock->localAddr();
 }
 
+void appendWriteCoalescingStats(BSONObjBuilder* b) {
+    const long long writes = coalescingCounters.writes.load();
+    const long long bytes = coalescingCounters.bytes.load();
+    b->appendNumber("writes", writes);
+    b->appendNumber("messages", static_cast<long long>(coalescingCounters.messages.load()));
+    b->appendNumber("bytes", bytes);
+    b->append("bytesPerWrite", writes ? static_cast<double>(bytes) / writes : 0.0);
+}
+
 }  // namespace mongo
@@ -38,6 +38,7 @@
 
 namespace mongo {
 
+class BSONObjBuilder;
 class MessagingPort;
 
 class MessagingPort : public AbstractMessagingPort {
@@ -67,6 +68,23 @@ public:
 
     void say(Message& toSend, int responseTo = 0);
 
+    /**
+     * Enables coalescing of small outgoing messages. While enabled, say() holds back messages
+     * below kMaxCoalescedMessageBytes and sends them with the next write. Held back messages go
+     * out in a single syscall when recv() finds no further input already waiting, when
+     * kMaxCoalescedBytes or kMaxCoalescedMessages is reached, or on flushWrites().
+     *
+     * Only meant for ports whose owner always returns to recv() after replying, such as the
+     * server side of a client connection.
+     */
+    void setWriteCoalescing(bool enabled);
+
+    void flushWrites() override;
+
+    static const size_t kMaxCoalescedMessageBytes = 16 * 1024;
+    static const size_t kMaxCoalescedBytes = 64 * 1024;
+    static const int kMaxCoalescedMessages = 32;
+
     /**
      * this is used for doing 'async' queries
      * instead of doing call( to , from )
@@ -122,9 +140,24 @@ private:
     // mutable because its initialized only on call to remote()
     mutable HostAndPort _remoteParsed;
 
+    // Sends 'toSend' now, or holds it back if write coalescing is enabled.
+    void _send(Message& toSend);
+
+    // Returns true if input is already waiting to be read, without blocking.
+    bool _inputReady();
+
+    bool _coalesceWrites = false;
+    std::vector<char> _pendingWrites;
+    int _pendingMessages = 0;
+
 public:
     static void closeAllSockets(unsigned tagMask = 0xffffffff);
 };
 
+/**
+ * Appends counters describing coalesced writes on all MessagingPorts to 'b'.
+ */
+void appendWriteCoalescingStats(BSONObjBuilder* b);
+
 
 }  // namespace mongo
@@ -0,0 +1,184 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_port.h"
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/types.h>
+#endif
+
+#include <string>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/socket_poll.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace {
+
+#ifndef _WIN32
+
+/**
+ * A connected pair of ports. 'server' coalesces its writes, 'client' writes through.
+ */
+class PortPair {
+public:
+    PortPair() {
+        int fds[2];
+        ASSERT_EQUALS(0, ::socketpair(PF_LOCAL, SOCK_STREAM, 0, fds));
+        server.reset(new MessagingPort(std::make_shared<Socket>(fds[0], SockAddr())));
+        client.reset(new MessagingPort(std::make_shared<Socket>(fds[1], SockAddr())));
+        server->setWriteCoalescing(true);
+    }
+
+    std::unique_ptr<MessagingPort> server;
+    std::unique_ptr<MessagingPort> client;
+};
+
+bool readable(MessagingPort* port) {
+    pollfd pollInfo;
+    pollInfo.fd = port->psock->rawFD();
+    pollInfo.events = POLLIN;
+    return socketPoll(&pollInfo, 1, 0) > 0;
+}
+
+void sendMessage(MessagingPort* port, const std::string& body) {
+    Message message;
+    message.setData(opReply, body.c_str(), body.size() + 1);
+    port->say(message);
+}
+
+std::string receiveMessage(MessagingPort* port) {
+    Message message;
+    ASSERT_TRUE(port->recv(message));
+    return message.singleData().data();
+}
+
+long long coalescedWrites() {
+    BSONObjBuilder b;
+    appendWriteCoalescingStats(&b);
+    return b.obj()["writes"].numberLong();
+}
+
+TEST(MessagingPortWriteCoalescing, SmallMessagesAreHeldUntilFlushed) {
+    PortPair ports;
+    const long long writesBefore = coalescedWrites();
+
+    sendMessage(ports.server.get(), "one");
+    sendMessage(ports.server.get(), "two");
+    sendMessage(ports.server.get(), "three");
+    ASSERT_FALSE(readable(ports.client.get()));
+
+    ports.server->flushWrites();
+    ASSERT_EQUALS(writesBefore + 1, coalescedWrites());
+    ASSERT_EQUALS("one", receiveMessage(ports.client.get()));
+    ASSERT_EQUALS("two", receiveMessage(ports.client.get()));
+    ASSERT_EQUALS("three", receiveMessage(ports.client.get()));
+}
+
+TEST(MessagingPortWriteCoalescing, LargeMessageFlushesPendingFirst) {
+    PortPair ports;
+
+    const std::string large(MessagingPort::kMaxCoalescedMessageBytes, 'x');
+    sendMessage(ports.server.get(), "small");
+    sendMessage(ports.server.get(), large);
+
+    ASSERT_EQUALS("small", receiveMessage(ports.client.get()));
+    ASSERT_EQUALS(large, receiveMessage(ports.client.get()));
+}
+
+TEST(MessagingPortWriteCoalescing, MessageLimitFlushes) {
+    PortPair ports;
+
+    for (int i = 0; i < MessagingPort::kMaxCoalescedMessages - 1; ++i) {
+        sendMessage(ports.server.get(), "reply");
+    }
+    ASSERT_FALSE(readable(ports.client.get()));
+
+    sendMessage(ports.server.get(), "reply");
+    ASSERT_TRUE(readable(ports.client.get()));
+}
+
+TEST(MessagingPortWriteCoalescing, RecvFlushesOnlyWhenNoInputIsWaiting) {
+    PortPair ports;
+    ports.server->setSocketTimeout(0.1);
+
+    sendMessage(ports.client.get(), "first request");
+    sendMessage(ports.server.get(), "first reply");
+
+    // The request is already waiting, so the reply stays held back.
+    ASSERT_EQUALS("first request", receiveMessage(ports.server.get()));
+    ASSERT_FALSE(readable(ports.client.get()));
+
+    // Nothing else is waiting, so the reply goes out before recv blocks and times out.
+    Message message;
+    ASSERT_FALSE(ports.server->recv(message));
+    ASSERT_EQUALS("first reply", receiveMessage(ports.client.get()));
+}
+
+TEST(MessagingPortWriteCoalescing, DisablingFlushes) {
+    PortPair ports;
+
+    sendMessage(ports.server.get(), "reply");
+    ports.server->setWriteCoalescing(false);
+    ASSERT_EQUALS("reply", receiveMessage(ports.client.get()));
+}
+
+TEST(MessagingPortReceiveDuration, MeasuredFromHeaderArrival) {
+    PortPair ports;
+
+    const std::string body = "request";
+    Message request;
+    request.setData(dbQuery, body.c_str(), body.size() + 1);
+    request.header().setId(1);
+    const char* data = request.buf();
+    const int headerLen = sizeof(MSGHEADER::Value);
+
+    ports.client->send(data, headerLen, "test");
+    stdx::thread sender([&] {
+        sleepmillis(50);
+        ports.client->send(data + headerLen, request.size() - headerLen, "test");
+    });
+
+    Message received;
+    ASSERT_TRUE(ports.server->recv(received));
+    sender.join();
+    ASSERT_EQUALS(body, std::string(received.singleData().data()));
+    ASSERT_GREATER_THAN_OR_EQUALS(ports.server->getLastReceiveDuration(), Milliseconds(40));
+}
+
+#endif  // ndef _WIN32
+
+}  // namespace
+}  // namespace mongo
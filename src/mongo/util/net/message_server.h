@@ -36,10 +36,25 @@
 
 #include "mongo/platform/basic.h"
 
+#include <memory>
+#include <string>
+
 namespace mongo {
 
+class AbstractMessagingPort;
+class Message;
+
 class MessageHandler {
 public:
+    /**
+     * Opaque per-connection state which a handler keeps bound to the thread servicing a
+     * connection (for example the Client). See detach() and attach().
+     */
+    class ConnectionState {
+    public:
+        virtual ~ConnectionState() = default;
+    };
+
     virtual ~MessageHandler() {}
 
     /**
@@ -52,6 +67,22 @@ public:
      * handler is responsible for responding to client
      */
     virtual void process(Message& m, AbstractMessagingPort* p) = 0;
+
+    /**
+     * Called by message servers which multiplex many connections over a fixed set of threads,
+     * when the calling thread stops servicing 'p'. Unbinds any per-connection state from the
+     * calling thread and returns it, so that it can be handed back to attach() on whichever
+     * thread services the next message from 'p'. Destroying the returned state ends the
+     * connection's session.
+     */
+    virtual std::unique_ptr<ConnectionState> detach(AbstractMessagingPort* p) {
+        return {};
+    }
+
+    /**
+     * Rebinds state previously returned by detach() for 'p' to the calling thread.
+     */
+    virtual void attach(AbstractMessagingPort* p, std::unique_ptr<ConnectionState> state) {}
 };
 
 class MessageServer {
@@ -69,6 +100,8 @@ public:
     virtual void setupSockets() = 0;
 };
 
-// TODO use a factory here to decide between port and asio variations
+/**
+ * Creates the message server selected by serverGlobalParams.serviceExecutor.
+ */
 MessageServer* createServer(const MessageServer::Options& opts, MessageHandler* handler);
 }
@@ -0,0 +1,427 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_server_async.h"
+
+#ifndef _WIN32
+#include <asio.hpp>
+#endif
+
+#include <memory>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/config.h"
+#include "mongo/db/server_options.h"
+#include "mongo/db/stats/counters.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/concurrency/threadlocal.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/listen.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/message_port.h"
+#include "mongo/util/net/ssl_options.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+
+bool isAsyncMessageServerSupported() {
+#ifdef _WIN32
+    return false;
+#else
+#ifdef MONGO_CONFIG_SSL
+    if (sslGlobalParams.sslMode.load() != SSLParams::SSLMode_disabled) {
+        return false;
+    }
+#endif
+    return true;
+#endif
+}
+
+#ifdef _WIN32
+
+MessageServer* createAsyncServer(const MessageServer::Options& opts,
+                                 MessageHandler* handler,
+                                 size_t numWorkers) {
+    MONGO_UNREACHABLE;
+}
+
+AsyncWorkerBlockingSection::AsyncWorkerBlockingSection() : _pool(nullptr) {}
+
+AsyncWorkerBlockingSection::~AsyncWorkerBlockingSection() {}
+
+#else
+
+/**
+ * The worker threads of an AsyncMessageServer. Normally there are exactly 'numWorkers' of them,
+ * but while workers are inside an AsyncWorkerBlockingSection, extra workers are started so that
+ * 'numWorkers' threads remain available to other connections, up to a fixed limit. A worker
+ * exits after finishing a handler if there are more runnable workers than needed.
+ */
+class AsyncWorkerPool {
+    MONGO_DISALLOW_COPYING(AsyncWorkerPool);
+
+public:
+    // The total number of workers is capped at this multiple of the configured number.
+    static const size_t kMaxWorkersPerConfiguredWorker = 8;
+
+    AsyncWorkerPool(asio::io_service& ioService, size_t numWorkers)
+        : _ioService(ioService),
+          _numWorkers(numWorkers),
+          _maxWorkers(numWorkers * kMaxWorkersPerConfiguredWorker) {
+        invariant(_numWorkers > 0);
+    }
+
+    void start() {
+        for (size_t i = 0; i < _numWorkers; ++i) {
+            _numRunning.addAndFetch(1);
+            _spawnWorker();
+        }
+    }
+
+    void enterBlockingSection() {
+        const uint32_t blocked = _numBlocked.addAndFetch(1);
+        while (true) {
+            const uint32_t running = _numRunning.load();
+            if (running - blocked >= _numWorkers || running >= _maxWorkers) {
+                return;
+            }
+            if (_numRunning.compareAndSwap(running, running + 1) == running) {
+                _spawnWorker();
+                return;
+            }
+        }
+    }
+
+    void leaveBlockingSection() {
+        _numBlocked.subtractAndFetch(1);
+    }
+
+    static AsyncWorkerPool* current() {
+        return _current;
+    }
+
+private:
+    void _spawnWorker() {
+        const uint64_t workerId = _nextWorkerId.fetchAndAdd(1);
+        try {
+            stdx::thread worker([this, workerId] { _workerLoop(workerId); });
+            worker.detach();
+        } catch (const std::exception& e) {
+            _numRunning.subtractAndFetch(1);
+            if (workerId < _numWorkers) {
+                severe() << "failed to start async worker thread: " << e.what();
+                fassertFailed(28811);
+            }
+            warning() << "failed to start extra async worker thread: " << e.what();
+        }
+    }
+
+    void _workerLoop(uint64_t workerId) {
+        setThreadName(std::string(str::stream() << "asyncWorker" << workerId));
+        _current = this;
+        while (!_ioService.stopped()) {
+            _ioService.run_one();
+            if (_shouldExit()) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * Returns true, and accounts for the exit, if the calling worker is surplus.
+     */
+    bool _shouldExit() {
+        while (true) {
+            const uint32_t running = _numRunning.load();
+            if (running - _numBlocked.load() <= _numWorkers) {
+                return false;
+            }
+            if (_numRunning.compareAndSwap(running, running - 1) == running) {
+                return true;
+            }
+        }
+    }
+
+    static MONGO_TRIVIALLY_CONSTRUCTIBLE_THREAD_LOCAL AsyncWorkerPool* _current;
+
+    asio::io_service& _ioService;
+
+    const size_t _numWorkers;
+    const size_t _maxWorkers;
+
+    AtomicUInt32 _numRunning;
+    AtomicUInt32 _numBlocked;
+    AtomicUInt64 _nextWorkerId;
+};
+
+MONGO_TRIVIALLY_CONSTRUCTIBLE_THREAD_LOCAL AsyncWorkerPool* AsyncWorkerPool::_current;
+
+AsyncWorkerBlockingSection::AsyncWorkerBlockingSection() : _pool(AsyncWorkerPool::current()) {
+    if (_pool) {
+        _pool->enterBlockingSection();
+    }
+}
+
+AsyncWorkerBlockingSection::~AsyncWorkerBlockingSection() {
+    if (_pool) {
+        _pool->leaveBlockingSection();
+    }
+}
+
+namespace {
+
+/**
+ * A connection accepted by the AsyncMessageServer. The session is kept alive by the pending
+ * wait for its next message and by the worker currently servicing it, and closes the
+ * connection when the last reference goes away.
+ *
+ * At most one thread operates on a session at any time, since the next wait is only armed
+ * once the previous message has been fully processed.
+ */
+class Session : public std::enable_shared_from_this<Session> {
+    MONGO_DISALLOW_COPYING(Session);
+
+public:
+    Session(asio::io_service& ioService,
+            MessageHandler* handler,
+            const std::shared_ptr<Socket>& socket,
+            long long connectionId)
+        : _connTicketReleaser(&Listener::globalTicketHolder),
+          _handler(handler),
+          _port(socket),
+          _descriptor(ioService, socket->rawFD()) {
+        _port.setConnectionId(connectionId);
+    }
+
+    ~Session() {
+        // The descriptor is owned by the Socket, so it must not be closed by ASIO.
+        _descriptor.release();
+    }
+
+    /**
+     * Runs the handler's connection setup and starts waiting for the first message.
+     */
+    void start() {
+        try {
+            _handler->connected(&_port);
+            _port.psock->setLogLevel(logger::LogSeverity::Debug(1));
+            _state = _handler->detach(&_port);
+        } catch (const DBException& e) {
+            log() << "DBException setting up client connection, closing it: " << e;
+            _port.shutdown();
+            return;
+        }
+
+        _waitForMessage();
+    }
+
+private:
+    void _waitForMessage() {
+        auto self = shared_from_this();
+        _descriptor.async_wait(asio::posix::descriptor_base::wait_read,
+                               [self](const asio::error_code& ec) { self->_onReadable(ec); });
+    }
+
+    void _onReadable(const asio::error_code& ec) {
+        if (ec || inShutdown()) {
+            _port.shutdown();
+            return;
+        }
+
+        // ASIO puts the descriptor into non-blocking mode to wait on it, but MessagingPort
+        // expects blocking reads and writes.
+        asio::error_code nonBlockingEc;
+        _descriptor.native_non_blocking(false, nonBlockingEc);
+        if (nonBlockingEc) {
+            log() << "failed to make connection " << _port.connectionId()
+                  << " blocking, closing it: " << nonBlockingEc.message();
+            _port.shutdown();
+            return;
+        }
+
+        _handler->attach(&_port, std::move(_state));
+        const bool keepOpen = _processMessage();
+        _state = _handler->detach(&_port);
+
+        if (!keepOpen) {
+            // Destroy the connection's state on this thread, while it is still known.
+            _state.reset();
+            _port.shutdown();
+            return;
+        }
+
+        _waitForMessage();
+    }
+
+    /**
+     * Receives one message and hands it to the handler. Returns false if the connection should
+     * be closed.
+     */
+    bool _processMessage() {
+        try {
+            _message.reset();
+            _port.psock->clearCounters();
+
+            if (!_port.recv(_message)) {
+                if (!serverGlobalParams.quiet) {
+                    int conns = Listener::globalTicketHolder.used() - 1;
+                    const char* word = (conns == 1 ? " connection" : " connections");
+                    log() << "end connection " << _port.psock->remoteString() << " (" << conns
+                          << word << " now open)";
+                }
+                return false;
+            }
+
+            _handler->process(_message, &_port);
+            networkCounter.hit(_port.psock->getBytesIn(), _port.psock->getBytesOut());
+            return true;
+        } catch (AssertionException& e) {
+            log() << "AssertionException handling request, closing client connection: " << e;
+        } catch (SocketException& e) {
+            log() << "SocketException handling request, closing client connection: " << e;
+        } catch (const DBException& e) {
+            // must be right above std::exception to avoid catching subclasses
+            log() << "DBException handling request, closing client connection: " << e;
+        } catch (std::exception& e) {
+            error() << "Uncaught std::exception: " << e.what() << ", terminating";
+            dbexit(EXIT_UNCAUGHT);
+        }
+        return false;
+    }
+
+    TicketHolderReleaser _connTicketReleaser;
+
+    // Not owned.
+    MessageHandler* const _handler;
+
+    MessagingPort _port;
+    asio::posix::stream_descriptor _descriptor;
+
+    Message _message;
+
+    // Handler state for this connection while it is not bound to a worker thread.
+    std::unique_ptr<MessageHandler::ConnectionState> _state;
+};
+
+class AsyncMessageServer : public MessageServer, public Listener {
+public:
+    /**
+     * @param handler the handler to use. Caller is responsible for managing this object
+     *     and should make sure that it lives longer than this server.
+     */
+    AsyncMessageServer(const MessageServer::Options& opts,
+                       MessageHandler* handler,
+                       size_t numWorkers)
+        : Listener("", opts.ipList, opts.port),
+          _handler(handler),
+          _numWorkers(numWorkers),
+          _work(_ioService),
+          _workers(_ioService, numWorkers) {}
+
+    virtual void accepted(std::shared_ptr<Socket> psocket, long long connectionId) {
+        ScopeGuard sleepAfterClosingPort = MakeGuard(sleepmillis, 2);
+
+        if (!Listener::globalTicketHolder.tryAcquire()) {
+            log() << "connection refused because too many open connections: "
+                  << Listener::globalTicketHolder.used();
+            return;
+        }
+
+        std::shared_ptr<Session> session;
+        try {
+            session = std::make_shared<Session>(_ioService, _handler, psocket, connectionId);
+        } catch (...) {
+            Listener::globalTicketHolder.release();
+            log() << "failed to register new connection with the service executor, "
+                  << "closing connection";
+            return;
+        }
+
+        // Connection setup runs handler code, so it is done on a worker rather than on the
+        // listener thread.
+        _ioService.post([session] { session->start(); });
+        sleepAfterClosingPort.Dismiss();
+    }
+
+    virtual void setAsTimeTracker() {
+        Listener::setAsTimeTracker();
+    }
+
+    virtual void setupSockets() {
+        Listener::setupSockets();
+    }
+
+    void run() {
+        log() << "servicing connections with " << _numWorkers << " async worker threads";
+
+        _workers.start();
+        initAndListen();
+    }
+
+    virtual bool useUnixSockets() const {
+        return true;
+    }
+
+private:
+    // Not owned.
+    MessageHandler* const _handler;
+
+    const size_t _numWorkers;
+
+    asio::io_service _ioService;
+
+    // Keeps the workers running while there are no connections.
+    asio::io_service::work _work;
+
+    AsyncWorkerPool _workers;
+};
+
+}  // namespace
+
+MessageServer* createAsyncServer(const MessageServer::Options& opts,
+                                 MessageHandler* handler,
+                                 size_t numWorkers) {
+    invariant(isAsyncMessageServerSupported());
+    return new AsyncMessageServer(opts, handler, numWorkers);
+}
+
+#endif  // _WIN32
+
+}  // namespace mongo
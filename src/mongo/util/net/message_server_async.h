@@ -0,0 +1,79 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/util/net/message_server.h"
+
+namespace mongo {
+
+/**
+ * Returns true if the async message server can be used on this platform with the current
+ * network configuration. It is not available on Windows or when SSL is enabled, since the
+ * readiness of an SSL connection cannot be inferred from the readiness of its socket.
+ */
+bool isAsyncMessageServerSupported();
+
+/**
+ * Creates a message server which, instead of spawning a thread for each accepted connection,
+ * waits for incoming messages on all connections with ASIO and services them on a fixed pool
+ * of 'numWorkers' threads. A worker is only occupied by a connection while a message from it is
+ * being received and processed, so idle connections do not consume threads.
+ *
+ * Must only be used if isAsyncMessageServerSupported() returns true.
+ */
+MessageServer* createAsyncServer(const MessageServer::Options& opts,
+                                 MessageHandler* handler,
+                                 size_t numWorkers);
+
+class AsyncWorkerPool;
+
+/**
+ * Marks a scope in which the current thread waits for something other than CPU, such as the
+ * journal or the replication of a write. If the thread is a worker of an async message server,
+ * the server may start an extra worker while it waits, so that a few long waits do not stall
+ * every other connection. The extra workers exit again once they are no longer needed.
+ *
+ * Has no effect on any other thread.
+ */
+class AsyncWorkerBlockingSection {
+    MONGO_DISALLOW_COPYING(AsyncWorkerBlockingSection);
+
+public:
+    AsyncWorkerBlockingSection();
+    ~AsyncWorkerBlockingSection();
+
+private:
+    // The pool of the worker running this section, or nullptr if it is not an async worker.
+    AsyncWorkerPool* const _pool;
+};
+
+}  // namespace mongo
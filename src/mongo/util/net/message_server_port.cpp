@@ -52,7 +52,9 @@
 #include "mongo/util/net/message.h"
 #include "mongo/util/net/message_port.h"
 #include "mongo/util/net/message_server.h"
+#include "mongo/util/net/message_server_async.h"
 #include "mongo/util/net/ssl_manager.h"
+#include "mongo/util/processinfo.h"
 #include "mongo/util/scopeguard.h"
 
 #ifdef __linux__  // TODO: consider making this ifndef _WIN32
@@ -79,6 +81,7 @@ public:
                              long long connectionId)
         : MessagingPort(socket), _handler(handler) {
         setConnectionId(connectionId);
+        setWriteCoalescing(serverGlobalParams.writeCoalescing);
     }
 
     MessageHandler* getHandler() const {
@@ -264,6 +267,19 @@ private:
 
 
 MessageServer* createServer(const MessageServer::Options& opts, MessageHandler* handler) {
+    if (serverGlobalParams.serviceExecutor == ServerGlobalParams::ServiceExecutor::kAsync) {
+        if (isAsyncMessageServerSupported()) {
+            size_t numWorkers = serverGlobalParams.serviceExecutorThreads;
+            if (numWorkers == 0) {
+                numWorkers = std::max(1U, ProcessInfo().getNumCores());
+            }
+            return createAsyncServer(opts, handler, numWorkers);
+        }
+
+        warning() << "the async service executor is not supported on this platform or with SSL "
+                  << "enabled, falling back to one thread per connection";
+    }
+
     return new PortMessageServer(opts, handler);
 }
 
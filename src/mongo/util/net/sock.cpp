@@ -33,6 +33,8 @@
 
 #include "mongo/util/net/sock.h"
 
+#include <algorithm>
+
 #if !defined(_WIN32)
 #include <sys/socket.h>
 #include <sys/types.h>
@@ -41,6 +43,7 @@
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <errno.h>
+#include <limits.h>
 #include <netdb.h>
 #if defined(__OpenBSD__)
 #include <sys/uio.h>
@@ -429,6 +432,14 @@ const int portSendFlags = 0;
 const int portRecvFlags = 0;
 #endif
 
+#if !defined(_WIN32)
+#if defined(IOV_MAX)
+const size_t kMaxIovecsPerSend = IOV_MAX;
+#else
+const size_t kMaxIovecsPerSend = 1024;
+#endif
+#endif
+
 string SocketException::toString() const {
     stringstream ss;
     ss << _ei.code << " socket exception [" << _getStringType(_type) << "] ";
@@ -690,7 +701,7 @@ void Socket::send(const vector<pair<char*, int>>& data, const char* context) {
     _send(data, context);
 #else
     vector<struct iovec> d(data.size());
-    int i = 0;
+    size_t i = 0;
     for (vector<pair<char*, int>>::const_iterator j = data.begin(); j != data.end(); ++j) {
         if (j->second > 0) {
             d[i].iov_base = j->first;
@@ -699,12 +710,18 @@ void Socket::send(const vector<pair<char*, int>>& data, const char* context) {
             _bytesOut += j->second;
         }
     }
+    if (i == 0) {
+        return;
+    }
+
+    // sendmsg() accepts at most IOV_MAX buffers at a time.
+    size_t remaining = i;
     struct msghdr meta;
     memset(&meta, 0, sizeof(meta));
     meta.msg_iov = &d[0];
-    meta.msg_iovlen = d.size();
+    meta.msg_iovlen = std::min(remaining, kMaxIovecsPerSend);
 
-    while (meta.msg_iovlen > 0) {
+    while (remaining > 0) {
         int ret = -1;
         if (MONGO_FAIL_POINT(throwSockExcep)) {
 #if defined(_WIN32)
@@ -736,9 +753,10 @@ void Socket::send(const vector<pair<char*, int>>& data, const char* context) {
                 } else {
                     ret -= i->iov_len;
                     ++i;
-                    --(meta.msg_iovlen);
+                    --remaining;
                 }
             }
+            meta.msg_iovlen = std::min(remaining, kMaxIovecsPerSend);
         }
     }
 #endif
@@ -35,6 +35,7 @@
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/thread/tss.hpp>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -44,6 +45,7 @@
 #include "mongo/config.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/debug_util.h"
@@ -170,6 +172,101 @@ using UniqueSSLContext = std::unique_ptr<SSL_CTX, decltype(&_free_ssl_context)>;
 static const int BUFFER_SIZE = 8 * 1024;
 static const int DATE_LEN = 128;
 
+struct HandshakeCounters {
+    AtomicUInt64 full;
+    AtomicUInt64 resumed;
+
+    void record(SSL* ssl) {
+        if (SSL_session_reused(ssl)) {
+            resumed.fetchAndAdd(1);
+        } else {
+            full.fetchAndAdd(1);
+        }
+    }
+
+    void append(BSONObjBuilder* b, StringData name) const {
+        BSONObjBuilder sub(b->subobjStart(name));
+        sub.appendNumber("full", static_cast<long long>(full.load()));
+        sub.appendNumber("resumed", static_cast<long long>(resumed.load()));
+    }
+};
+
+HandshakeCounters serverHandshakes;
+HandshakeCounters clientHandshakes;
+
+/**
+ * Remembers the most recent session negotiated with each remote address, so that reconnecting
+ * to it can resume the session with an abbreviated handshake. The server side needs no such
+ * cache, since OpenSSL keeps one per SSL_CTX and also issues session tickets by default.
+ */
+class ClientSessionCache {
+    MONGO_DISALLOW_COPYING(ClientSessionCache);
+
+public:
+    static const size_t kMaxSessions = 1024;
+
+    ClientSessionCache() = default;
+
+    ~ClientSessionCache() {
+        for (auto&& entry : _sessions) {
+            SSL_SESSION_free(entry.second);
+        }
+    }
+
+    /**
+     * Offers the cached session for 'remote', if any, for resumption by 'ssl'. Returns whether
+     * a session was offered.
+     */
+    bool offer(const std::string& remote, SSL* ssl) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto it = _sessions.find(remote);
+        if (it == _sessions.end()) {
+            return false;
+        }
+        // SSL_set_session takes its own reference to the session.
+        return SSL_set_session(ssl, it->second) == 1;
+    }
+
+    /**
+     * Remembers the session negotiated by 'ssl' for future connections to 'remote'.
+     */
+    void store(const std::string& remote, SSL* ssl) {
+        SSL_SESSION* session = SSL_get1_session(ssl);
+        if (!session) {
+            return;
+        }
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto it = _sessions.find(remote);
+        if (it != _sessions.end()) {
+            SSL_SESSION_free(it->second);
+            it->second = session;
+            return;
+        }
+        if (_sessions.size() >= kMaxSessions) {
+            SSL_SESSION_free(_sessions.begin()->second);
+            _sessions.erase(_sessions.begin());
+        }
+        _sessions.emplace(remote, session);
+    }
+
+    /**
+     * Forgets the session for 'remote', e.g. because the handshake that offered it failed.
+     */
+    void forget(const std::string& remote) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        auto it = _sessions.find(remote);
+        if (it != _sessions.end()) {
+            SSL_SESSION_free(it->second);
+            _sessions.erase(it);
+        }
+    }
+
+private:
+    stdx::mutex _mutex;
+    std::map<std::string, SSL_SESSION*> _sessions;
+};
+
 class SSLManager : public SSLManagerInterface {
 public:
     explicit SSLManager(const SSLParams& params, bool isServer);
@@ -218,6 +315,7 @@ private:
     bool _allowInvalidCertificates;
     bool _allowInvalidHostnames;
     SSLConfiguration _sslConfiguration;
+    ClientSessionCache _clientSessions;
 
     /**
      * creates an SSL object to be used for this file descriptor.
@@ -414,6 +512,11 @@ BSONObj SSLConfiguration::getServerStatusBSON() const {
     security.append("SSLServerSubjectName", serverSubjectName);
     security.appendBool("SSLServerHasCertificateAuthority", hasCA);
     security.appendDate("SSLServerCertificateExpirationDate", serverCertificateExpirationDate);
+    {
+        BSONObjBuilder handshakes(security.subobjStart("SSLHandshakes"));
+        serverHandshakes.append(&handshakes, "server");
+        clientHandshakes.append(&handshakes, "client");
+    }
     return security.obj();
 }
 
@@ -570,6 +673,10 @@ Status SSLManager::initSSLContext(SSL_CTX* context, const SSLParams& params) {
                                     << getSSLErrorMessage(ERR_get_error()));
     }
 
+    // Cache sessions on the server side so that reconnecting peers can resume them. Clients
+    // resume through SSLManager's own per-remote cache instead.
+    ::SSL_CTX_set_session_cache_mode(context, SSL_SESS_CACHE_SERVER);
+
     if (!params.sslClusterFile.empty()) {
         ::EVP_set_pw_prompt("Enter cluster certificate passphrase");
         if (!_setupPEM(context, params.sslClusterFile, params.sslClusterPassword)) {
@@ -840,13 +947,25 @@ SSLConnection* SSLManager::connect(Socket* socket) {
     std::unique_ptr<SSLConnection> sslConn =
         stdx::make_unique<SSLConnection>(_clientContext.get(), socket, (const char*)NULL, 0);
 
+    const std::string remote = socket->remoteString();
+    const bool offeredSession = _clientSessions.offer(remote, sslConn->ssl);
+
     int ret;
     do {
         ret = ::SSL_connect(sslConn->ssl);
     } while (!_doneWithSSLOp(sslConn.get(), ret));
 
-    if (ret != 1)
+    if (ret != 1) {
+        if (offeredSession) {
+            _clientSessions.forget(remote);
+        }
         _handleSSLError(SSL_get_error(sslConn.get(), ret), ret);
+    }
+
+    clientHandshakes.record(sslConn->ssl);
+    if (!SSL_session_reused(sslConn->ssl)) {
+        _clientSessions.store(remote, sslConn->ssl);
+    }
 
     return sslConn.release();
 }
@@ -863,6 +982,8 @@ SSLConnection* SSLManager::accept(Socket* socket, const char* initialBytes, int
     if (ret != 1)
         _handleSSLError(SSL_get_error(sslConn.get(), ret), ret);
 
+    serverHandshakes.record(sslConn->ssl);
+
     return sslConn.release();
 }
 
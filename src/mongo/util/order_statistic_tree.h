@@ -0,0 +1,219 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/random.h"
+
+namespace mongo {
+
+/**
+ * An ordered set of unique values that also knows, for any value, how many of its members sort
+ * before it. It is a treap whose nodes keep the size of their subtree, so insert, erase and
+ * countLess are all O(log n) expected.
+ *
+ * This only answers rank queries; it is meant to sit beside a structure that is used for
+ * iteration, such as a std::set holding the same values.
+ */
+template <typename T, typename Less = std::less<T>>
+class OrderStatisticTree {
+    MONGO_DISALLOW_COPYING(OrderStatisticTree);
+
+public:
+    explicit OrderStatisticTree(int32_t seed = 0, Less less = Less())
+        : _random(seed), _less(std::move(less)) {}
+
+    /**
+     * Returns false and does nothing if an equivalent value is already present.
+     */
+    bool insert(T value) {
+        if (contains(value))
+            return false;
+        std::unique_ptr<Node> node(new Node(std::move(value), _random.nextInt32()));
+        insertNode(&_root, std::move(node));
+        return true;
+    }
+
+    /**
+     * Returns false if there was no equivalent value to remove.
+     */
+    bool erase(const T& value) {
+        return eraseFrom(&_root, value);
+    }
+
+    bool contains(const T& value) const {
+        const Node* node = _root.get();
+        while (node) {
+            if (_less(value, node->value)) {
+                node = node->left.get();
+            } else if (_less(node->value, value)) {
+                node = node->right.get();
+            } else {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Returns the number of members that sort strictly before 'value', which need not be a
+     * member itself.
+     */
+    size_t countLess(const T& value) const {
+        size_t count = 0;
+        const Node* node = _root.get();
+        while (node) {
+            if (_less(node->value, value)) {
+                count += sizeOf(node->left.get()) + 1;
+                node = node->right.get();
+            } else {
+                node = node->left.get();
+            }
+        }
+        return count;
+    }
+
+    size_t size() const {
+        return sizeOf(_root.get());
+    }
+
+    bool empty() const {
+        return !_root;
+    }
+
+    void clear() {
+        _root.reset();
+    }
+
+private:
+    struct Node {
+        Node(T value, int32_t priority) : value(std::move(value)), priority(priority) {}
+
+        T value;
+        const int32_t priority;
+        size_t size = 1;
+        std::unique_ptr<Node> left;
+        std::unique_ptr<Node> right;
+    };
+
+    static size_t sizeOf(const Node* node) {
+        return node ? node->size : 0;
+    }
+
+    static void updateSize(Node* node) {
+        node->size = sizeOf(node->left.get()) + 1 + sizeOf(node->right.get());
+    }
+
+    /**
+     * Splits 'node' into the members that sort before 'value' and those that do not.
+     */
+    void split(std::unique_ptr<Node> node,
+               const T& value,
+               std::unique_ptr<Node>* before,
+               std::unique_ptr<Node>* notBefore) const {
+        if (!node) {
+            before->reset();
+            notBefore->reset();
+            return;
+        }
+        if (_less(node->value, value)) {
+            split(std::move(node->right), value, &node->right, notBefore);
+            updateSize(node.get());
+            *before = std::move(node);
+        } else {
+            split(std::move(node->left), value, before, &node->left);
+            updateSize(node.get());
+            *notBefore = std::move(node);
+        }
+    }
+
+    /**
+     * Joins two trees where every member of 'lhs' sorts before every member of 'rhs'.
+     */
+    static std::unique_ptr<Node> merge(std::unique_ptr<Node> lhs, std::unique_ptr<Node> rhs) {
+        if (!lhs)
+            return rhs;
+        if (!rhs)
+            return lhs;
+        if (lhs->priority > rhs->priority) {
+            lhs->right = merge(std::move(lhs->right), std::move(rhs));
+            updateSize(lhs.get());
+            return lhs;
+        }
+        rhs->left = merge(std::move(lhs), std::move(rhs->left));
+        updateSize(rhs.get());
+        return rhs;
+    }
+
+    // The value in 'node' must not already be present.
+    void insertNode(std::unique_ptr<Node>* root, std::unique_ptr<Node> node) {
+        if (!*root || node->priority > (*root)->priority) {
+            split(std::move(*root), node->value, &node->left, &node->right);
+            updateSize(node.get());
+            *root = std::move(node);
+            return;
+        }
+        Node* parent = root->get();
+        std::unique_ptr<Node>* child =
+            _less(node->value, parent->value) ? &parent->left : &parent->right;
+        insertNode(child, std::move(node));
+        parent->size++;
+    }
+
+    bool eraseFrom(std::unique_ptr<Node>* root, const T& value) {
+        Node* node = root->get();
+        if (!node)
+            return false;
+
+        bool erased;
+        if (_less(value, node->value)) {
+            erased = eraseFrom(&node->left, value);
+        } else if (_less(node->value, value)) {
+            erased = eraseFrom(&node->right, value);
+        } else {
+            *root = merge(std::move(node->left), std::move(node->right));
+            return true;
+        }
+
+        if (erased)
+            node->size--;
+        return erased;
+    }
+
+    std::unique_ptr<Node> _root;
+    PseudoRandom _random;
+    Less _less;
+};
+
+}  // namespace mongo
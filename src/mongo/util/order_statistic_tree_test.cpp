@@ -0,0 +1,120 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/order_statistic_tree.h"
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+#include "mongo/platform/random.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(OrderStatisticTree, Empty) {
+    OrderStatisticTree<int> tree;
+    ASSERT_TRUE(tree.empty());
+    ASSERT_EQUALS(0U, tree.size());
+    ASSERT_EQUALS(0U, tree.countLess(5));
+    ASSERT_FALSE(tree.contains(5));
+    ASSERT_FALSE(tree.erase(5));
+}
+
+TEST(OrderStatisticTree, InsertRejectsDuplicates) {
+    OrderStatisticTree<int> tree;
+    ASSERT_TRUE(tree.insert(3));
+    ASSERT_FALSE(tree.insert(3));
+    ASSERT_EQUALS(1U, tree.size());
+    ASSERT_TRUE(tree.contains(3));
+}
+
+TEST(OrderStatisticTree, CountLessOfNonMembers) {
+    OrderStatisticTree<int> tree;
+    for (int i = 0; i < 100; i++) {
+        tree.insert(i * 2);
+    }
+    ASSERT_EQUALS(100U, tree.size());
+    ASSERT_EQUALS(0U, tree.countLess(-1));
+    ASSERT_EQUALS(0U, tree.countLess(0));
+    ASSERT_EQUALS(1U, tree.countLess(1));
+    ASSERT_EQUALS(50U, tree.countLess(100));
+    ASSERT_EQUALS(51U, tree.countLess(101));
+    ASSERT_EQUALS(100U, tree.countLess(1000));
+}
+
+TEST(OrderStatisticTree, EraseUpdatesCounts) {
+    OrderStatisticTree<int> tree;
+    for (int i = 0; i < 10; i++) {
+        tree.insert(i);
+    }
+    ASSERT_TRUE(tree.erase(4));
+    ASSERT_FALSE(tree.erase(4));
+    ASSERT_FALSE(tree.contains(4));
+    ASSERT_EQUALS(9U, tree.size());
+    ASSERT_EQUALS(4U, tree.countLess(5));
+    ASSERT_EQUALS(5U, tree.countLess(6));
+
+    tree.clear();
+    ASSERT_TRUE(tree.empty());
+}
+
+TEST(OrderStatisticTree, MatchesSetUnderRandomOperations) {
+    PseudoRandom random(12345);
+    OrderStatisticTree<int> tree;
+    std::set<int> model;
+
+    for (int i = 0; i < 20000; i++) {
+        const int value = random.nextInt32(1000);
+        if (random.nextInt32(3) == 0) {
+            ASSERT_EQUALS(model.erase(value) == 1, tree.erase(value));
+        } else {
+            ASSERT_EQUALS(model.insert(value).second, tree.insert(value));
+        }
+
+        const int query = random.nextInt32(1002) - 1;
+        ASSERT_EQUALS(static_cast<size_t>(std::distance(model.begin(), model.lower_bound(query))),
+                      tree.countLess(query));
+    }
+    ASSERT_EQUALS(model.size(), tree.size());
+}
+
+TEST(OrderStatisticTree, CustomComparator) {
+    OrderStatisticTree<int, std::greater<int>> tree;
+    for (int i = 0; i < 10; i++) {
+        tree.insert(i);
+    }
+    // With a descending order, the members before 7 are 8 and 9.
+    ASSERT_EQUALS(2U, tree.countLess(7));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -74,6 +74,38 @@ public:
         _cvNoLongerEmpty.notify_one();
     }
 
+    /**
+     * Pushes the items in [begin, end) in order, taking the lock once rather than once per item.
+     * Waits whenever the next item does not fit. Stops early if the queue is cleared while
+     * waiting, and returns the number of items that were pushed.
+     */
+    template <typename Iterator>
+    size_t pushAll(Iterator begin, Iterator end) {
+        stdx::unique_lock<stdx::mutex> l(_lock);
+        _clearing = false;
+        size_t pushed = 0;
+        for (Iterator it = begin; it != end; ++it) {
+            size_t tSize = _getSize(*it);
+            while (_currentSize + tSize > _maxSize) {
+                // Let a consumer take the items pushed so far before waiting for room.
+                if (pushed) {
+                    _cvNoLongerEmpty.notify_one();
+                }
+                _cvNoLongerFull.wait(l);
+                if (_clearing) {
+                    return pushed;
+                }
+            }
+            _queue.push(*it);
+            _currentSize += tSize;
+            ++pushed;
+        }
+        if (pushed) {
+            _cvNoLongerEmpty.notify_one();
+        }
+        return pushed;
+    }
+
     bool empty() const {
         stdx::lock_guard<stdx::mutex> l(_lock);
         return _queue.empty();
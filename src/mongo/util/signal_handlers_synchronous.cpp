@@ -44,6 +44,7 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/string_data.h"
+#include "mongo/logger/async_appender.h"
 #include "mongo/logger/log_domain.h"
 #include "mongo/logger/logger.h"
 #include "mongo/platform/compiler.h"
@@ -167,6 +168,7 @@ int MallocFreeOStreamGuard::terminateDepth = 0;
 
 // must hold MallocFreeOStreamGuard to call
 void writeMallocFreeStreamToLog() {
+    logger::AsyncAppender::flushAllAndWriteSynchronously();
     logger::globalLogDomain()->append(logger::MessageEventEphemeral(
         Date_t::now(), logger::LogSeverity::Severe(), getThreadName(), mallocFreeOStream.str()));
     mallocFreeOStream.rewind();
@@ -0,0 +1,74 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <gperftools/malloc_extension.h>
+
+#include "mongo/base/init.h"
+#include "mongo/util/memory_budget.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Accounts for the memory tcmalloc holds without it being allocated: free pages of the page
+ * heap not yet returned to the system, and the free lists of the central and thread caches.
+ * Shrinking returns page heap pages to the system, which the thread caches also drain into
+ * when their threads go idle.
+ */
+class TcmallocMemoryConsumer : public MemoryConsumer {
+public:
+    int64_t bytesUsed() const override {
+        return getProperty("tcmalloc.pageheap_free_bytes") +
+            getProperty("tcmalloc.central_cache_free_bytes") +
+            getProperty("tcmalloc.current_total_thread_cache_bytes");
+    }
+
+    int64_t shrink(int64_t bytes) override {
+        const int64_t before = getProperty("tcmalloc.pageheap_unmapped_bytes");
+        MallocExtension::instance()->ReleaseToSystem(bytes);
+        return std::max(int64_t(0), getProperty("tcmalloc.pageheap_unmapped_bytes") - before);
+    }
+
+private:
+    static int64_t getProperty(const char* property) {
+        size_t value = 0;
+        MallocExtension::instance()->GetNumericProperty(property, &value);
+        return static_cast<int64_t>(value);
+    }
+} tcmallocMemoryConsumer;
+
+MONGO_INITIALIZER(TcmallocMemoryBudget)(InitializerContext*) {
+    MemoryBudget::get()->registerConsumer("tcmallocFreeBytes", &tcmallocMemoryConsumer);
+    return Status::OK();
+}
+
+}  // namespace
+}  // namespace mongo
@@ -993,8 +993,24 @@ unsigned long long curTimeMicros64() {
     return boost::date_time::winapi::file_time_to_microseconds(computedTime);
 }
 
+long long curThreadCpuTimeMicros() {
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+        return 0;
+    }
+
+    // FILETIME durations are in units of 100 nanoseconds.
+    ULARGE_INTEGER kernel, user;
+    kernel.LowPart = kernelTime.dwLowDateTime;
+    kernel.HighPart = kernelTime.dwHighDateTime;
+    user.LowPart = userTime.dwLowDateTime;
+    user.HighPart = userTime.dwHighDateTime;
+    return static_cast<long long>((kernel.QuadPart + user.QuadPart) / 10);
+}
+
 #else
 #include <sys/time.h>
+#include <time.h>
 unsigned long long curTimeMillis64() {
     timeval tv;
     gettimeofday(&tv, NULL);
@@ -1006,6 +1022,18 @@ unsigned long long curTimeMicros64() {
     gettimeofday(&tv, NULL);
     return (((unsigned long long)tv.tv_sec) * 1000 * 1000) + tv.tv_usec;
 }
+
+long long curThreadCpuTimeMicros() {
+#if defined(CLOCK_THREAD_CPUTIME_ID)
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return static_cast<long long>(ts.tv_sec) * 1000 * 1000 + ts.tv_nsec / 1000;
+#else
+    return 0;
+#endif
+}
 #endif
 
 }  // namespace mongo
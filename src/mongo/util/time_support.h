@@ -365,6 +365,12 @@ Date_t jsTime();
 unsigned long long curTimeMicros64();
 unsigned long long curTimeMillis64();
 
+/**
+ * CPU time consumed by the calling thread, in microseconds, or 0 where it is not available.
+ * Only differences between two calls on the same thread are meaningful.
+ */
+long long curThreadCpuTimeMicros();
+
 // these are so that if you use one of them compilation will fail
 char* asctime(const struct tm* tm);
 char* ctime(const time_t* timep);